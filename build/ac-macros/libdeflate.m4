@@ -0,0 +1,109 @@
+dnl ===================================================================
+dnl   Licensed to the Apache Software Foundation (ASF) under one
+dnl   or more contributor license agreements.  See the NOTICE file
+dnl   distributed with this work for additional information
+dnl   regarding copyright ownership.  The ASF licenses this file
+dnl   to you under the Apache License, Version 2.0 (the
+dnl   "License"); you may not use this file except in compliance
+dnl   with the License.  You may obtain a copy of the License at
+dnl
+dnl     http://www.apache.org/licenses/LICENSE-2.0
+dnl
+dnl   Unless required by applicable law or agreed to in writing,
+dnl   software distributed under the License is distributed on an
+dnl   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+dnl   KIND, either express or implied.  See the License for the
+dnl   specific language governing permissions and limitations
+dnl   under the License.
+dnl ===================================================================
+dnl
+dnl  SVN_LIBDEFLATE
+dnl
+dnl  Check for the optional libdeflate library.  If found, it will be
+dnl  used for whole-buffer zlib-format (de-)compression of svndiff
+dnl  windows; zlib remains required as the fallback implementation.
+dnl
+dnl  The default behaviour is to use pkg-config to look for libdeflate
+dnl  and if that fails to simply try linking -ldeflate.  The user can
+dnl  specify --with-libdeflate=PREFIX to look in PREFIX instead, or
+dnl  --without-libdeflate to skip the check entirely.
+dnl
+
+AC_DEFUN(SVN_LIBDEFLATE,
+[
+  libdeflate_found=no
+  libdeflate_skip=no
+
+  AC_ARG_WITH([libdeflate],
+    [AS_HELP_STRING([--with-libdeflate=PREFIX],
+                    [use libdeflate for svndiff compression])],
+    [
+      if test "$withval" = "yes"; then
+        libdeflate_skip=no
+      elif test "$withval" = "no"; then
+        libdeflate_skip=yes
+      else
+        libdeflate_skip=no
+        libdeflate_prefix="$withval"
+      fi
+    ])
+
+  if test "$libdeflate_skip" != "yes"; then
+    if test -n "$libdeflate_prefix"; then
+      SVN_LIBDEFLATE_PREFIX
+    else
+      SVN_LIBDEFLATE_STD
+    fi
+  fi
+
+  if test "$libdeflate_found" = "yes"; then
+    AC_DEFINE([SVN_HAVE_LIBDEFLATE], [1],
+              [Defined if libdeflate is available])
+  fi
+
+  AC_SUBST(SVN_LIBDEFLATE_INCLUDES)
+  AC_SUBST(SVN_LIBDEFLATE_LIBS)
+])
+
+AC_DEFUN(SVN_LIBDEFLATE_STD,
+[
+  if test -n "$PKG_CONFIG"; then
+    AC_MSG_CHECKING([for libdeflate via pkg-config])
+    if $PKG_CONFIG libdeflate --exists; then
+      AC_MSG_RESULT([yes])
+      libdeflate_found=yes
+      SVN_LIBDEFLATE_INCLUDES=`$PKG_CONFIG libdeflate --cflags`
+      SVN_LIBDEFLATE_LIBS=`$PKG_CONFIG libdeflate --libs`
+      SVN_LIBDEFLATE_LIBS="`SVN_REMOVE_STANDARD_LIB_DIRS($SVN_LIBDEFLATE_LIBS)`"
+    else
+      AC_MSG_RESULT([no])
+    fi
+  fi
+  if test "$libdeflate_found" != "yes"; then
+    AC_MSG_NOTICE([libdeflate configuration without pkg-config])
+    AC_CHECK_HEADER(libdeflate.h, [
+      AC_CHECK_LIB(deflate, libdeflate_zlib_compress, [
+        libdeflate_found=yes
+        SVN_LIBDEFLATE_LIBS="-ldeflate"
+      ])
+    ])
+  fi
+])
+
+AC_DEFUN(SVN_LIBDEFLATE_PREFIX,
+[
+  AC_MSG_NOTICE([libdeflate configuration via prefix])
+  save_cppflags="$CPPFLAGS"
+  CPPFLAGS="$CPPFLAGS -I$libdeflate_prefix/include"
+  save_ldflags="$LDFLAGS"
+  LDFLAGS="$LDFLAGS -L$libdeflate_prefix/lib"
+  AC_CHECK_HEADER(libdeflate.h, [
+    AC_CHECK_LIB(deflate, libdeflate_zlib_compress, [
+      libdeflate_found=yes
+      SVN_LIBDEFLATE_INCLUDES="-I$libdeflate_prefix/include"
+      SVN_LIBDEFLATE_LIBS="`SVN_REMOVE_STANDARD_LIB_DIRS(-L$libdeflate_prefix/lib)` -ldeflate"
+    ])
+  ])
+  LDFLAGS="$save_ldflags"
+  CPPFLAGS="$save_cppflags"
+])
@@ -0,0 +1,109 @@
+dnl ===================================================================
+dnl   Licensed to the Apache Software Foundation (ASF) under one
+dnl   or more contributor license agreements.  See the NOTICE file
+dnl   distributed with this work for additional information
+dnl   regarding copyright ownership.  The ASF licenses this file
+dnl   to you under the Apache License, Version 2.0 (the
+dnl   "License"); you may not use this file except in compliance
+dnl   with the License.  You may obtain a copy of the License at
+dnl
+dnl     http://www.apache.org/licenses/LICENSE-2.0
+dnl
+dnl   Unless required by applicable law or agreed to in writing,
+dnl   software distributed under the License is distributed on an
+dnl   "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+dnl   KIND, either express or implied.  See the License for the
+dnl   specific language governing permissions and limitations
+dnl   under the License.
+dnl ===================================================================
+dnl
+dnl  SVN_ZSTD
+dnl
+dnl  Check for the optional zstd library.  If found, it enables the
+dnl  svndiff3 delta format; without it, svndiff3 data can neither be
+dnl  produced nor read and Subversion sticks to svndiff0/1/2.
+dnl
+dnl  The default behaviour is to use pkg-config to look for libzstd
+dnl  and if that fails to simply try linking -lzstd.  The user can
+dnl  specify --with-zstd=PREFIX to look in PREFIX instead, or
+dnl  --without-zstd to skip the check entirely.
+dnl
+
+AC_DEFUN(SVN_ZSTD,
+[
+  zstd_found=no
+  zstd_skip=no
+
+  AC_ARG_WITH([zstd],
+    [AS_HELP_STRING([--with-zstd=PREFIX],
+                    [use zstd for svndiff3 compression])],
+    [
+      if test "$withval" = "yes"; then
+        zstd_skip=no
+      elif test "$withval" = "no"; then
+        zstd_skip=yes
+      else
+        zstd_skip=no
+        zstd_prefix="$withval"
+      fi
+    ])
+
+  if test "$zstd_skip" != "yes"; then
+    if test -n "$zstd_prefix"; then
+      SVN_ZSTD_PREFIX
+    else
+      SVN_ZSTD_STD
+    fi
+  fi
+
+  if test "$zstd_found" = "yes"; then
+    AC_DEFINE([SVN_HAVE_ZSTD], [1],
+              [Defined if zstd is available])
+  fi
+
+  AC_SUBST(SVN_ZSTD_INCLUDES)
+  AC_SUBST(SVN_ZSTD_LIBS)
+])
+
+AC_DEFUN(SVN_ZSTD_STD,
+[
+  if test -n "$PKG_CONFIG"; then
+    AC_MSG_CHECKING([for zstd via pkg-config])
+    if $PKG_CONFIG libzstd --exists; then
+      AC_MSG_RESULT([yes])
+      zstd_found=yes
+      SVN_ZSTD_INCLUDES=`$PKG_CONFIG libzstd --cflags`
+      SVN_ZSTD_LIBS=`$PKG_CONFIG libzstd --libs`
+      SVN_ZSTD_LIBS="`SVN_REMOVE_STANDARD_LIB_DIRS($SVN_ZSTD_LIBS)`"
+    else
+      AC_MSG_RESULT([no])
+    fi
+  fi
+  if test "$zstd_found" != "yes"; then
+    AC_MSG_NOTICE([zstd configuration without pkg-config])
+    AC_CHECK_HEADER(zstd.h, [
+      AC_CHECK_LIB(zstd, ZSTD_compress, [
+        zstd_found=yes
+        SVN_ZSTD_LIBS="-lzstd"
+      ])
+    ])
+  fi
+])
+
+AC_DEFUN(SVN_ZSTD_PREFIX,
+[
+  AC_MSG_NOTICE([zstd configuration via prefix])
+  save_cppflags="$CPPFLAGS"
+  CPPFLAGS="$CPPFLAGS -I$zstd_prefix/include"
+  save_ldflags="$LDFLAGS"
+  LDFLAGS="$LDFLAGS -L$zstd_prefix/lib"
+  AC_CHECK_HEADER(zstd.h, [
+    AC_CHECK_LIB(zstd, ZSTD_compress, [
+      zstd_found=yes
+      SVN_ZSTD_INCLUDES="-I$zstd_prefix/include"
+      SVN_ZSTD_LIBS="`SVN_REMOVE_STANDARD_LIB_DIRS(-L$zstd_prefix/lib)` -lzstd"
+    ])
+  ])
+  LDFLAGS="$save_ldflags"
+  CPPFLAGS="$save_cppflags"
+])
@@ -112,6 +112,7 @@ public interface ISVNConfig
     public static final String HTTP_BULK_UPDATES         = "http-bulk-updates";
     public static final String HTTP_MAX_CONNECTIONS      = "http-max-connections";
     public static final String HTTP_CHUNKED_REQUESTS     = "http-chunked-requests";
+    public static final String HTTP_PIPELINE_DEPTH       = "http-pipeline-depth";
     public static final String SERF_LOG_COMPONENTS       = "serf-log-components";
     public static final String SERF_LOG_LEVEL            = "serf-log-level";
 
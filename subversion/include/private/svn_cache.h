@@ -179,6 +179,35 @@ typedef struct svn_cache__info_t
    * highest array index.
    */
   apr_uint64_t histogram[32];
+
+  /** Number of entries with this cache instance's key prefix currently
+   * held by the (shared) back-end.
+   * May be 0 if that information is not available.
+   */
+  apr_uint64_t prefix_entries;
+
+  /** Number of data bytes used by @a prefix_entries.
+   * May be 0 if that information is not available.
+   */
+  apr_uint64_t prefix_size;
+
+  /** Number of this instance's entries removed from the back-end so far,
+   * be it evicted to make room for other data or dropped explicitly.
+   */
+  apr_uint64_t evictions;
+
+  /** Number of evicted entries by the time they spent in the cache:
+   * bucket @a i counts entries that were removed after less than 2^i but
+   * at least 2^(i-1) seconds.  Ages larger than the array will saturate
+   * into the highest array index.
+   */
+  apr_uint64_t age_histogram[16];
+
+  /** Number of insertions by serialized item size:  bucket @a i counts
+   * items of less than 2^i but at least 2^(i-1) bytes.  Sizes larger
+   * than the array will saturate into the highest array index.
+   */
+  apr_uint64_t size_histogram[32];
 } svn_cache__info_t;
 
 /**
@@ -310,11 +339,42 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
                                   svn_boolean_t allow_blocking_writes,
                                   apr_pool_t *result_pool);
 
+/**
+ * Like svn_cache__membuffer_cache_create, but place the whole cache state
+ * into a single anonymous shared memory segment and serialize access to
+ * it with cross-process mutexes.  Processes forked *after* this call - as
+ * pre-fork / event httpd children are from the parent - will then operate
+ * on one common, warm cache instead of one cold copy per process.
+ *
+ * The cache is always created thread-safe.  Cross-process access is
+ * exclusive, i.e. there is no read concurrency between processes; prefer
+ * larger @a segment_count values to compensate.  Returns
+ * #SVN_ERR_UNSUPPORTED_FEATURE on platforms without shared memory
+ * support.
+ */
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         svn_boolean_t allow_blocking_writes,
+                                         apr_pool_t *result_pool);
+
 /**
  * @defgroup Standard priority classes for #svn_cache__create_membuffer_cache.
  * @{
  */
 
+/**
+ * Data in this priority class is effectively pinned:  it will never be
+ * evicted in favor of lower-priority data, no matter how much of the
+ * latter is streaming through the cache.  Unused pinned entries slowly
+ * age out of this class, though, so stale data cannot clog the cache
+ * forever.  Reserve this for small metadata that virtually every
+ * operation needs, such as revision roots.
+ */
+#define SVN_CACHE__MEMBUFFER_PINNED_PRIORITY 100000
+
 /**
  * Data in this priority class should not be removed from the cache unless
  * absolutely necessary.  Use of this should be very restricted.
@@ -433,6 +493,25 @@ svn_cache__get(void **value,
                const void *key,
                apr_pool_t *result_pool);
 
+/**
+ * Fetches the values indexed by the @a count elements of @a keys from
+ * @a cache into the respective elements of @a values, setting the
+ * corresponding @a found flag to TRUE iff the key is in the cache.
+ * Individual elements of @a keys may be NULL in which case their
+ * @a found flag will be FALSE.  Backends with a batched getter, such as
+ * memcached, fetch all keys in a single pipelined round trip; for all
+ * others, this is equivalent to calling svn_cache__get() once per key.
+ * The values are copied into @a result_pool using the deserialize
+ * function provided to the cache's constructor.
+ */
+svn_error_t *
+svn_cache__get_multi(void **values,
+                     svn_boolean_t *found,
+                     svn_cache__t *cache,
+                     const void **keys,
+                     apr_size_t count,
+                     apr_pool_t *result_pool);
+
 /**
  * Looks for an entry indexed by @a key in @a cache,  setting @a *found
  * to TRUE if an entry has been found and FALSE otherwise.  @a key may be
@@ -554,6 +633,33 @@ svn_cache__format_info(const svn_cache__info_t *info,
 struct svn_membuffer_t *
 svn_cache__get_global_membuffer_cache(void);
 
+/**
+ * Request that the process-global membuffer cache be created in shared
+ * memory (see svn_cache__membuffer_cache_create_shared) when it gets
+ * allocated.  Must be called before the first call to
+ * svn_cache__get_global_membuffer_cache() in this process; typically,
+ * a pre-fork server parent calls this and then instantiates the cache
+ * so that all children share it.  If the shared cache cannot be created,
+ * cache creation silently falls back to the process-local variant.
+ */
+void
+svn_cache__set_global_membuffer_shared(svn_boolean_t shared);
+
+/**
+ * Request that the process-global membuffer cache be split into
+ * @a segment_count segments, each with its own lock.  A value of 0
+ * (the default) derives the segment count from the cache size.  The
+ * value will be rounded down to a power of two and is capped by the
+ * cache implementation; segments also cannot become smaller than 64kB.
+ * Raising the segment count reduces lock contention on servers with
+ * many concurrent readers.  Must be called before the first call to
+ * svn_cache__get_global_membuffer_cache() in this process.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_cache__set_global_membuffer_segments(apr_size_t segment_count);
+
 /**
  * Return total access and size stats over all membuffer caches as they
  * share the underlying data buffer.  The result will be allocated in POOL.
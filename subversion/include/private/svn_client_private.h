@@ -233,6 +233,81 @@ svn_client__resolve_rev_and_url(svn_client__pathrev_t **resolved_loc_p,
 svn_error_t *
 svn_client__assert_homogeneous_target_type(const apr_array_header_t *targets);
 
+/** Like svn_client_checkout4() with @a depth #svn_depth_infinity, but
+ * transfer the top-level subtrees of @a URL over up to @a thread_count
+ * concurrent RA sessions, each driving its own update editor into the
+ * new working copy.  Useful on high-latency links where a single TCP
+ * stream cannot saturate the available bandwidth.
+ *
+ * The root is checked out sequentially at depth-immediates first; the
+ * subtrees are then partitioned over the extra sessions and completed
+ * by tasks on worker threads, each writing through its own private
+ * wc.db connection.  A final sequential pass bumps the root back to
+ * depth-infinity and processes externals (unless @a ignore_externals).
+ * Notifications are replayed through @a ctx->notify_func2 on the
+ * calling thread only, batched per subtree, in a deterministic order.
+ *
+ * Falls back to a plain sequential checkout when @a thread_count is 1,
+ * when APR lacks thread support, or when @a path already exists and is
+ * not an empty directory (resuming an interrupted checkout).  An
+ * interrupted parallel checkout can be resumed by a sequential one and
+ * vice versa; all passes work towards the same resolved revision.
+ *
+ * @note @a ctx->cancel_func may be invoked from worker threads and
+ * must be thread-safe; the auth baton should hold valid credentials
+ * before the parallel phase starts.  Working copies configured for
+ * exclusive wc.db locking cannot serve the concurrent connections.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_client__checkout_parallel(svn_revnum_t *result_rev,
+                              const char *URL,
+                              const char *path,
+                              const svn_opt_revision_t *peg_revision,
+                              const svn_opt_revision_t *revision,
+                              svn_boolean_t ignore_externals,
+                              svn_boolean_t allow_unver_obstructions,
+                              const svn_version_t *wc_format_version,
+                              svn_tristate_t store_pristine,
+                              apr_int32_t thread_count,
+                              svn_client_ctx_t *ctx,
+                              apr_pool_t *pool);
+
+/** Like svn_client_export5(), but hand the per-file EOL/keyword
+ * translation and disk I/O to a pool of up to @a thread_count worker
+ * threads.  The editor drive buffers each file's raw fulltext and
+ * spawns a writer task per file, so the network transfer no longer
+ * waits for the previous file to reach disk; the amount of buffered
+ * content is capped, with files beyond the cap written synchronously.
+ * Notifications are replayed through @a ctx->notify_func2 on the
+ * calling thread, in the sequential export's order.
+ *
+ * Falls back to svn_client_export5() when @a thread_count is 1, when
+ * APR lacks thread support, for working copy exports, for single-file
+ * exports and for depths other than #svn_depth_infinity.  Externals
+ * are exported sequentially after the main drive.
+ *
+ * @note @a ctx->cancel_func may be invoked from worker threads and
+ * must be thread-safe.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_client__export_parallel(svn_revnum_t *result_rev,
+                            const char *from_path_or_url,
+                            const char *to_path,
+                            const svn_opt_revision_t *peg_revision,
+                            const svn_opt_revision_t *revision,
+                            svn_boolean_t overwrite,
+                            svn_boolean_t ignore_externals,
+                            svn_boolean_t ignore_keywords,
+                            svn_depth_t depth,
+                            const char *native_eol,
+                            apr_int32_t thread_count,
+                            svn_client_ctx_t *ctx,
+                            apr_pool_t *pool);
+
 
 /* Create a svn_client_status_t structure *CST for LOCAL_ABSPATH, shallow
  * copying data from *STATUS wherever possible and retrieving the other values
@@ -30,6 +30,7 @@
 
 #include "svn_types.h"
 #include "svn_io.h"
+#include "svn_diff.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -148,6 +149,51 @@ svn_diff_hunk__create_deletes_single_line(svn_diff_hunk_t **hunk,
 svn_linenum_t
 svn_diff_hunk__get_fuzz_penalty(const svn_diff_hunk_t *hunk);
 
+/** A pair of files to be compared by svn_diff__file_diff_pairs(). */
+typedef struct svn_diff__file_pair_t
+{
+  /** Path of the original file. */
+  const char *original;
+
+  /** Path of the modified file. */
+  const char *modified;
+} svn_diff__file_pair_t;
+
+/** Receiver for the results of svn_diff__file_diff_pairs().  Called
+ * once per file pair, in the order of the pair array, with @a diff
+ * the comparison result for @a pair.  @a diff is only valid for the
+ * duration of the call.
+ *
+ * @a receiver_baton and @a scratch_pool are the usual things.
+ */
+typedef svn_error_t *(*svn_diff__file_pair_receiver_t)(
+  svn_diff_t *diff,
+  const svn_diff__file_pair_t *pair,
+  void *receiver_baton,
+  apr_pool_t *scratch_pool);
+
+/** Compare all elements of @a pairs (an array of
+ * #svn_diff__file_pair_t), distributing tokenization and comparison
+ * over up to @a thread_count worker threads, and call @a receiver
+ * with @a receiver_baton for each result in array order.  With
+ * @a thread_count 1, or if APR was built without thread support, all
+ * pairs are processed in the calling thread.
+ *
+ * Compare the files according to @a options, which may not be @c NULL.
+ *
+ * @a cancel_func, @a cancel_baton and @a scratch_pool are the usual
+ * things.
+ */
+svn_error_t *
+svn_diff__file_diff_pairs(const apr_array_header_t *pairs,
+                          const svn_diff_file_options_t *options,
+                          apr_int32_t thread_count,
+                          svn_diff__file_pair_receiver_t receiver,
+                          void *receiver_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
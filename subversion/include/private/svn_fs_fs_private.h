@@ -364,6 +364,20 @@ typedef struct svn_fs_fs__ioctl_build_rep_cache_input_t
 /* See svn_fs_fs__build_rep_cache(). */
 SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BUILD_REP_CACHE, SVN_FS_TYPE_FSFS, 1004);
 
+typedef struct svn_fs_fs__ioctl_snapshot_freeze_input_t
+{
+  svn_fs_freeze_func_t freeze_func;
+  void *freeze_baton;
+} svn_fs_fs__ioctl_snapshot_freeze_input_t;
+
+/* Invoke FREEZE_FUNC while holding only the pack lock, i.e. without
+ * blocking concurrent commits.  All files belonging to revisions up to
+ * and including the youngest revision at the time of the call remain
+ * physically unchanged for the duration of the callback; concurrent
+ * commits merely add new files.  Unlike svn_fs_freeze(), this does not
+ * prevent revision property changes nor rep-cache.db updates. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_SNAPSHOT_FREEZE, SVN_FS_TYPE_FSFS, 1005);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
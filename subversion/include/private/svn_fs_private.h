@@ -68,6 +68,20 @@ svn_fs__access_get_lock_tokens(svn_fs_access_t *access_ctx);
 svn_error_t *
 svn_fs__path_valid(const char *path, apr_pool_t *pool);
 
+/* Apply all property changes in PROPS, an array of svn_prop_t, to
+ * revision REV in FS.  A NULL value deletes the property.  Backends
+ * that support it perform all changes in a single write of the
+ * revision's property list; others apply the changes one by one.
+ *
+ * Unlike svn_fs_change_rev_prop2(), this provides no base-value
+ * checking.  Use POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs__change_rev_props(svn_fs_t *fs,
+                         svn_revnum_t rev,
+                         const apr_array_header_t *props,
+                         apr_pool_t *pool);
+
 
 
 /** Editors
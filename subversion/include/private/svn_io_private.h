@@ -85,12 +85,64 @@ svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
 
+/** Advise the OS that the @a length bytes starting at @a offset of
+ * @a file will be read in the near future, so it may start fetching
+ * them into the page cache asynchronously.  A @a length of 0 means
+ * "until the end of the file".
+ *
+ * This is merely a hint; implementations may ignore it.  On platforms
+ * without a suitable syscall, this is a no-op.  Errors reported by the
+ * OS for the hint itself are swallowed because the subsequent reads
+ * will either succeed or report a more useful error.
+ */
+svn_error_t *
+svn_io__file_readahead(apr_file_t *file,
+                       apr_off_t offset,
+                       apr_off_t length,
+                       apr_pool_t *scratch_pool);
+
+
+/** Open @a *file as a read/write temporary file in @a dirpath that has
+ * no directory entry, where the platform supports that (O_TMPFILE on
+ * Linux); the file vanishes with its last descriptor and never causes
+ * directory churn.  On other platforms, or when the filesystem refuses
+ * anonymous files, fall back to svn_io_open_unique_file3() with
+ * #svn_io_file_del_on_close.
+ *
+ * If @a dirpath is NULL, use the system temp directory.  If
+ * @a unique_path is not NULL, set @a *unique_path to the name of the
+ * fallback temporary file, or to NULL if the file is anonymous.
+ * The file is closed when @a result_pool is cleared or destroyed.
+ */
+svn_error_t *
+svn_io__open_anonymous_file(apr_file_t **file,
+                            const char **unique_path,
+                            const char *dirpath,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
+
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
  */
 apr_file_t *
 svn_stream__aprfile(svn_stream_t *stream);
 
+/** Return a stream that compresses all data written to it with LZ4
+ * before passing it on to @a stream, and decompresses all data read
+ * through it from @a stream.
+ *
+ * Unlike svn_stream_compressed(), the data is stored as a sequence of
+ * independently compressed blocks, each preceded by its encoded length,
+ * so writing requires only a bounded amount of memory and reading can
+ * stop at any block boundary.  Closing the returned stream flushes any
+ * pending output and closes @a stream.  The returned stream supports
+ * svn_stream_reset(), provided @a stream does.
+ */
+svn_stream_t *
+svn_stream__lz4_compressed(svn_stream_t *stream,
+                           apr_pool_t *pool);
+
 /* Creates as *INSTALL_STREAM a stream that once completed can be installed
    using Windows checkouts much slower than Unix.
 
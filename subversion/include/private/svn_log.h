@@ -85,6 +85,15 @@ svn_log__get_file(const char *path, svn_revnum_t rev,
                   svn_boolean_t want_contents, svn_boolean_t want_props,
                   apr_pool_t *pool);
 
+/**
+ * Return a log string for a get-files action.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_log__get_files(const apr_array_header_t *paths, svn_revnum_t rev,
+                   apr_pool_t *pool);
+
 /**
  * Return a log string for a get-dir action.
  *
@@ -287,6 +287,81 @@ svn_rangelist__merge_many(svn_rangelist_t *merged_rangelist,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+
+/** Compressed revision number sets.
+ *
+ * A revision set stores an arbitrary set of valid revision numbers as a
+ * sequence of containers covering 64k revisions each.  Depending on its
+ * population, a container is represented either as a sorted array of
+ * 16 bit offsets or as a packed bitmap.  This keeps even sets of millions
+ * of revisions compact while making the set operations simple linear
+ * passes - unlike rangelist arithmetic whose cost grows with the product
+ * of the fragment counts.
+ *
+ * Revision sets do not track range inheritability.  Where inheritability
+ * matters, keep inheritable and non-inheritable revisions in separate
+ * sets and attach the flag again upon conversion back to a rangelist.
+ *
+ * @defgroup svn_revset Revision number sets
+ * @{
+ */
+
+/** Opaque data type representing a set of revision numbers. */
+typedef struct svn_revset__t svn_revset__t;
+
+/** Return a new empty revision set allocated in @a result_pool. */
+svn_revset__t *
+svn_revset__create(apr_pool_t *result_pool);
+
+/** Add the revisions @a first through @a last (both inclusive) to @a set.
+ * @a first must be a valid revision number, i.e. larger than 0, and must
+ * not exceed @a last. */
+void
+svn_revset__add_range(svn_revset__t *set,
+                      svn_revnum_t first,
+                      svn_revnum_t last);
+
+/** Add all revisions described by @a rangelist to @a set, ignoring the
+ * inheritability of the respective ranges. */
+void
+svn_revset__add_rangelist(svn_revset__t *set,
+                          const svn_rangelist_t *rangelist);
+
+/** Return whether @a revision is an element of @a set. */
+svn_boolean_t
+svn_revset__contains(const svn_revset__t *set,
+                     svn_revnum_t revision);
+
+/** Return a new set, allocated in @a result_pool, containing all revisions
+ * that are in @a lhs or @a rhs. */
+svn_revset__t *
+svn_revset__union(const svn_revset__t *lhs,
+                  const svn_revset__t *rhs,
+                  apr_pool_t *result_pool);
+
+/** Return a new set, allocated in @a result_pool, containing all revisions
+ * that are in both @a lhs and @a rhs. */
+svn_revset__t *
+svn_revset__intersect(const svn_revset__t *lhs,
+                      const svn_revset__t *rhs,
+                      apr_pool_t *result_pool);
+
+/** Return a new set, allocated in @a result_pool, containing all revisions
+ * that are in @a lhs but not in @a rhs. */
+svn_revset__t *
+svn_revset__minus(const svn_revset__t *lhs,
+                  const svn_revset__t *rhs,
+                  apr_pool_t *result_pool);
+
+/** Return the contents of @a set as a canonical rangelist allocated in
+ * @a result_pool, with all ranges marked as @a inheritable. */
+svn_rangelist_t *
+svn_revset__to_rangelist(const svn_revset__t *set,
+                         svn_boolean_t inheritable,
+                         apr_pool_t *result_pool);
+
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
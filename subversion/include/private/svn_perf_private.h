@@ -0,0 +1,118 @@
+/*
+ * svn_perf_private.h : lightweight hot-path performance counters
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_PERF_PRIVATE_H
+#define SVN_PERF_PRIVATE_H
+
+#include <apr_pools.h>
+#include <apr_time.h>
+
+#include "svn_types.h"
+#include "svn_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* A single named event counter.  COUNT is the number of events seen so
+ * far and USECS the total time attributed to them.  Updates are plain,
+ * unsynchronized 64 bit additions:  under concurrent use, individual
+ * events may get lost, which is acceptable for diagnostic data and
+ * keeps the hot-path cost down to a few machine instructions.
+ */
+typedef struct svn_perf__counter_t svn_perf__counter_t;
+struct svn_perf__counter_t
+{
+  /* Name of the counter, e.g. "fsfs.noderev-read". */
+  const char *name;
+
+  /* Number of events accounted to this counter. */
+  apr_uint64_t count;
+
+  /* Total time in microseconds accounted to this counter. */
+  apr_uint64_t usecs;
+
+  /* Largest time in microseconds accounted to a single event. */
+  apr_uint64_t max_usecs;
+
+  /* Sum over the "units" given for each event, e.g. bytes or rows.
+   * The meaning is up to the instrumented code; see svn_perf__stop2(). */
+  apr_uint64_t units;
+
+  /* Next counter in registration order, NULL for the last one. */
+  svn_perf__counter_t *next;
+};
+
+/* Return TRUE if performance counting has been enabled by setting the
+ * SVN_PERF environment variable to any value.  When enabled, a report
+ * over all counters will be written to stderr upon process exit.
+ */
+svn_boolean_t
+svn_perf__is_enabled(void);
+
+/* Return the current time if performance counting is enabled and 0
+ * otherwise.  The result is to be handed to svn_perf__stop().
+ */
+apr_time_t
+svn_perf__start(void);
+
+/* Account one event plus the time elapsed since START with the counter
+ * registered as NAME.  *COUNTER caches the registration and shall be a
+ * static variable initialized to NULL; NAME must outlive the process.
+ * This is a no-op when START is 0, i.e. when counting is disabled.
+ */
+void
+svn_perf__stop(svn_perf__counter_t **counter,
+               const char *name,
+               apr_time_t start);
+
+/* Like svn_perf__stop() but additionally add UNITS to the counter's
+ * "units" total.  What a unit is - bytes, rows, items - is up to the
+ * caller but should be the same for all events on the same counter.
+ */
+void
+svn_perf__stop2(svn_perf__counter_t **counter,
+                const char *name,
+                apr_time_t start,
+                apr_uint64_t units);
+
+/* Account one untimed event with the counter registered as NAME.
+ * *COUNTER and NAME are handled as in svn_perf__stop().  This is a
+ * no-op when performance counting is disabled.
+ */
+void
+svn_perf__count(svn_perf__counter_t **counter,
+                const char *name);
+
+/* Write a report of all counters registered so far to STREAM.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_perf__write_report(svn_stream_t *stream,
+                       apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_PERF_PRIVATE_H */
@@ -0,0 +1,61 @@
+/*
+ * svn_probes_private.h : static USDT tracepoints for external profilers
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_PROBES_PRIVATE_H
+#define SVN_PROBES_PRIVATE_H
+
+/* Statically defined tracepoints (USDT) in the systemtap / dtrace style,
+ * grouped under the "svn" provider.  External tools such as perf, bpftrace
+ * or systemtap can attach to them to correlate profiling samples with
+ * logical operations - which command is being served, which representation
+ * is being reconstructed, whether a cache lookup hit - without any
+ * cooperation from the process.
+ *
+ * The probes are only compiled in when configuring with --enable-usdt,
+ * which requires <sys/sdt.h>.  Even then, each probe is a single NOP
+ * instruction until a tracer attaches, so they are safe for production
+ * builds.  Without the configure switch, the macros expand to nothing.
+ *
+ * Probe arguments are always evaluated when the probes are compiled in,
+ * so only pass values that are already at hand.
+ */
+
+#ifdef SVN_HAVE_SDT
+
+#include <sys/sdt.h>
+
+#define SVN_PROBE(name)              DTRACE_PROBE(svn, name)
+#define SVN_PROBE1(name, a1)         DTRACE_PROBE1(svn, name, a1)
+#define SVN_PROBE2(name, a1, a2)     DTRACE_PROBE2(svn, name, a1, a2)
+#define SVN_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(svn, name, a1, a2, a3)
+
+#else
+
+#define SVN_PROBE(name)              ((void)0)
+#define SVN_PROBE1(name, a1)         ((void)0)
+#define SVN_PROBE2(name, a1, a2)     ((void)0)
+#define SVN_PROBE3(name, a1, a2, a3) ((void)0)
+
+#endif /* SVN_HAVE_SDT */
+
+#endif /* SVN_PROBES_PRIVATE_H */
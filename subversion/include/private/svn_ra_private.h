@@ -154,6 +154,40 @@ svn_ra__release_operational_lock(svn_ra_session_t *session,
                                  const svn_string_t *mylocktoken,
                                  apr_pool_t *scratch_pool);
 
+/** Callback used by svn_ra__get_files() to open the output stream for
+ * the file at @a path (as passed to svn_ra__get_files()).  Set
+ * @a *stream to a writable stream allocated in @a pool; the caller
+ * will close it once the file's contents have been written.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_ra__open_file_stream_cb_t)(
+  svn_stream_t **stream,
+  void *baton,
+  const char *path,
+  apr_pool_t *pool);
+
+/** Fetch the contents of each path in @a paths (an array of
+ * <tt>const char *</tt> paths relative to the URL of @a session) at
+ * @a revision, in order.  For each file, obtain the output stream by
+ * calling @a open_stream_func with @a open_stream_baton.
+ *
+ * Layers which support batch fetching retrieve all files in a single
+ * round trip; otherwise this is equivalent to calling
+ * svn_ra_get_file() once per path, without props.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra__get_files(svn_ra_session_t *session,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  svn_ra__open_file_stream_cb_t open_stream_func,
+                  void *open_stream_baton,
+                  apr_pool_t *scratch_pool);
+
 /** Register CALLBACKS to be used with the Ev2 shims in RA_SESSION. */
 svn_error_t *
 svn_ra__register_editor_shim_callbacks(svn_ra_session_t *ra_session,
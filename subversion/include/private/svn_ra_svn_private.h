@@ -335,6 +335,19 @@ svn_ra_svn__read_tuple(svn_ra_svn_conn_t *conn,
                        apr_pool_t *pool,
                        const char *fmt, ...);
 
+/** Like svn_ra_svn__read_tuple(), but string values may borrow their
+ * data directly from @a conn's read buffer instead of being copied
+ * into @a pool.  Borrowed values remain valid only until the next
+ * read from @a conn or until @a pool is cleared, whichever comes
+ * first; the caller must copy anything it wants to retain beyond
+ * that.  Intended for command loops where most values are looked at
+ * once and discarded.
+ */
+svn_error_t *
+svn_ra_svn__read_tuple_borrowed(svn_ra_svn_conn_t *conn,
+                                apr_pool_t *pool,
+                                const char *fmt, ...);
+
 /** Parse an array of @c svn_ra_svn__item_t structures as a list of
  * properties, storing the properties in a hash table.
  *
@@ -380,6 +393,75 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
                            svn_boolean_t error_on_disconnect,
                            apr_pool_t *pool);
 
+/** Set @a *secret to a random string suitable as the per-process key
+ * for authentication resumption tickets; see
+ * svn_ra_svn__make_auth_ticket().
+ */
+svn_error_t *
+svn_ra_svn__make_auth_secret(const char **secret,
+                             apr_pool_t *pool);
+
+/** Return a time-limited authentication resumption ticket for @a user
+ * in authentication realm @a realm, valid until @a expiry.  The ticket
+ * carries an HMAC keyed with @a secret; only a holder of the same
+ * secret can mint or verify it.
+ */
+const char *
+svn_ra_svn__make_auth_ticket(const char *user,
+                             const char *realm,
+                             const char *secret,
+                             apr_time_t expiry,
+                             apr_pool_t *pool);
+
+/** Verify the authentication resumption ticket @a ticket against
+ * @a realm and @a secret.  If it is authentic and has not expired yet,
+ * set @a *user to the user name it was issued for and return TRUE.
+ * Otherwise, set @a *user to NULL and return FALSE.
+ */
+svn_boolean_t
+svn_ra_svn__check_auth_ticket(const char **user,
+                              const char *ticket,
+                              const char *realm,
+                              const char *secret,
+                              apr_pool_t *pool);
+
+/** Like svn_ra_svn_cram_server() but, if @a ticket_secret is not NULL,
+ * attach an authentication resumption ticket for @a realm with a
+ * life time of @a ticket_lifetime to the success notification.
+ */
+svn_error_t *
+svn_ra_svn__cram_server2(svn_ra_svn_conn_t *conn,
+                         apr_pool_t *pool,
+                         svn_config_t *pwdb,
+                         const char *ticket_secret,
+                         const char *realm,
+                         apr_time_t ticket_lifetime,
+                         const char **user,
+                         svn_boolean_t *success);
+
+/** Callback invoked by svn_ra_svn__handle_command() after a command has
+ * been dispatched.  @a cmdname is the name of the command (valid only for
+ * the duration of the call), @a duration is the wall-clock time spent in
+ * the command handler, and @a baton is the baton registered with
+ * svn_ra_svn__set_command_hook().
+ *
+ * The callback must not raise errors and should return quickly; it is
+ * intended for instrumentation such as per-command metrics.
+ */
+typedef void
+(*svn_ra_svn__command_hook_t)(const char *cmdname,
+                              apr_time_t duration,
+                              void *baton);
+
+/** Register @a hook to be called with @a baton after each command that
+ * svn_ra_svn__handle_command() dispatches on @a conn.  A NULL @a hook
+ * removes the registration.
+ */
+void
+svn_ra_svn__set_command_hook(svn_ra_svn_conn_t *conn,
+                             svn_ra_svn__command_hook_t hook,
+                             void *baton);
+
 /** Accept commands over the network and handle them according to @a
  * commands.  Command handlers will be passed @a conn, a subpool of @a
  * pool (cleared after each command is handled), the parameters of the
@@ -554,6 +636,19 @@ svn_ra_svn__write_cmd_change_file_prop(svn_ra_svn_conn_t *conn,
                                        const char *name,
                                        const svn_string_t *value);
 
+/** Send a "change-node-props" command over connection @a conn.  Apply
+ * all property changes in @a props, an array of svn_prop_t, to the file
+ * or directory identified by @a token.  A NULL value deletes the
+ * respective property.  The peer must have announced the
+ * #SVN_RA_SVN_CAP_CHANGE_NODE_PROPS capability.
+ * Use @a pool for allocations.
+ */
+svn_error_t *
+svn_ra_svn__write_cmd_change_node_props(svn_ra_svn_conn_t *conn,
+                                        apr_pool_t *pool,
+                                        const svn_string_t *token,
+                                        const apr_array_header_t *props);
+
 /** Send a "close-dir" command over connection @a conn.  Identify the node
  * to close with @a token and provide an optional @a check_sum.  The token
  * will then no longer be associated with that node.
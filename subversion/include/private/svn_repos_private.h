@@ -189,7 +189,7 @@ svn_repos__get_logs_compat(svn_repos_t *repos,
  * from multiple threads.  Configuration objects no longer referenced by
  * any user may linger for a while before being cleaned up.
  */
-typedef svn_object_pool__t svn_repos__config_pool_t;
+typedef struct svn_repos__config_pool_t svn_repos__config_pool_t;
 
 /* Create a new configuration pool object with a lifetime determined by
  * POOL and return it in *CONFIG_POOL.
@@ -369,6 +369,131 @@ svn_repos__dump_node_record(svn_stream_t *dump_stream,
                             svn_boolean_t content_length_always,
                             apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_repos_dump_fs4(), but render independent revisions - their
+ * headers, prop sections and (deltified) text - concurrently on up to
+ * @a thread_count worker threads.  The rendered revisions are written
+ * to @a stream in revision order by the calling thread, so the output
+ * is identical to a sequential dump.  Falls back to the sequential
+ * implementation when @a thread_count is 1 or APR lacks thread support.
+ *
+ * Each worker thread reads from its own private repository instance
+ * opened at the path of @a repos.
+ *
+ * @note @a filter_func and @a cancel_func may be invoked from worker
+ * threads and must be thread-safe.  @a notify_func is only ever called
+ * from the calling thread, in revision order.
+ */
+svn_error_t *
+svn_repos__dump_fs_parallel(svn_repos_t *repos,
+                            svn_stream_t *stream,
+                            svn_revnum_t start_rev,
+                            svn_revnum_t end_rev,
+                            svn_boolean_t incremental,
+                            svn_boolean_t use_deltas,
+                            svn_boolean_t include_revprops,
+                            svn_boolean_t include_changes,
+                            svn_repos_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_repos_dump_filter_func_t filter_func,
+                            void *filter_baton,
+                            apr_int32_t thread_count,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool);
+
+/**
+ * Like svn_repos_load_fs6(), but parse and stage the upcoming revisions
+ * of @a dumpstream on a background thread while the calling thread
+ * builds and commits the transaction for the current one.  The
+ * filesystem is only ever written to from the calling thread, in
+ * dumpstream order, so the loaded result is identical to a sequential
+ * load.  Falls back to the sequential implementation when APR lacks
+ * thread support.
+ *
+ * Whole revisions are staged in memory; expect the peak memory usage to
+ * be roughly the size of the largest revision in @a dumpstream plus a
+ * fixed read-ahead window.
+ *
+ * @note @a notify_func and @a cancel_func are only ever called from the
+ * calling thread.  @a dumpstream is only ever read from the background
+ * thread.
+ */
+svn_error_t *
+svn_repos__load_fs_pipelined(svn_repos_t *repos,
+                             svn_stream_t *dumpstream,
+                             svn_revnum_t start_rev,
+                             svn_revnum_t end_rev,
+                             enum svn_repos_load_uuid uuid_action,
+                             const char *parent_dir,
+                             svn_boolean_t use_pre_commit_hook,
+                             svn_boolean_t use_post_commit_hook,
+                             svn_boolean_t validate_props,
+                             svn_boolean_t ignore_dates,
+                             svn_boolean_t normalize_props,
+                             svn_repos_notify_func_t notify_func,
+                             void *notify_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *pool);
+
+/**
+ * Callback type for svn_repos__replay_range(), invoked before replaying
+ * @a revision.  The callback provides the @a *editor and @a *edit_baton
+ * the revision is replayed into.  @a replay_baton is the baton passed to
+ * svn_repos__replay_range() and @a rev_props contains the revision's
+ * properties.
+ */
+typedef svn_error_t *(*svn_repos__replay_revstart_func_t)(
+  svn_revnum_t revision,
+  void *replay_baton,
+  const svn_delta_editor_t **editor,
+  void **edit_baton,
+  apr_hash_t *rev_props,
+  apr_pool_t *pool);
+
+/**
+ * Callback type for svn_repos__replay_range(), invoked after replaying
+ * @a revision.  The callback is expected to close @a editor.  The other
+ * arguments are as for #svn_repos__replay_revstart_func_t.
+ */
+typedef svn_error_t *(*svn_repos__replay_revfinish_func_t)(
+  svn_revnum_t revision,
+  void *replay_baton,
+  const svn_delta_editor_t *editor,
+  void *edit_baton,
+  apr_hash_t *rev_props,
+  apr_pool_t *pool);
+
+/**
+ * Replay the revisions @a start_rev through @a end_rev (inclusive) of
+ * the repository @a repos, driving one editor per revision.  Before
+ * each revision, @a revstart_func is called to obtain the editor; after
+ * the drive, @a revfinish_func is called to close it.  Both are invoked
+ * with @a replay_baton.
+ *
+ * This is equivalent to opening a revision root and calling
+ * svn_repos_replay2() once per revision, but shares per-revision setup
+ * across the range: each revision's root is kept open and doubles as
+ * the delta base of the next revision's drive.
+ *
+ * @a base_path, @a low_water_mark, @a send_deltas, @a authz_read_func
+ * and @a authz_read_baton are as for svn_repos_replay2().
+ */
+svn_error_t *
+svn_repos__replay_range(svn_repos_t *repos,
+                        const char *base_path,
+                        svn_revnum_t start_rev,
+                        svn_revnum_t end_rev,
+                        svn_revnum_t low_water_mark,
+                        svn_boolean_t send_deltas,
+                        svn_repos__replay_revstart_func_t revstart_func,
+                        svn_repos__replay_revfinish_func_t revfinish_func,
+                        void *replay_baton,
+                        svn_repos_authz_func_t authz_read_func,
+                        void *authz_read_baton,
+                        apr_pool_t *pool);
+
 /**
  * Get a dump editor @a editor along with a @a edit_baton allocated in
  * @a pool.  The editor will write output to @a stream.
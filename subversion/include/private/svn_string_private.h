@@ -324,6 +324,29 @@ int
 svn_prefix_string__compare(const svn_prefix_string__t *lhs,
                            const svn_prefix_string__t *rhs);
 
+/**
+ * Opaque string interning container built on top of a prefix tree.
+ */
+typedef struct svn_prefix_interner__t svn_prefix_interner__t;
+
+/**
+ * Return a new string interner allocated in @a pool.
+ */
+svn_prefix_interner__t *
+svn_prefix_interner__create(apr_pool_t *pool);
+
+/**
+ * Return a copy of the NUL-terminated string @a s with the same lifetime
+ * as @a interner.  All calls for equal values of @a s return the same
+ * pointer, i.e. each distinct value gets stored only once no matter how
+ * often it gets interned.  This is useful for path-like strings that
+ * recur frequently, e.g. the same path being reported as changed in many
+ * revisions.
+ */
+const char *
+svn_prefix_interner__intern(svn_prefix_interner__t *interner,
+                            const char *s);
+
 /** @} */
 
 /** @} */
@@ -113,7 +113,8 @@ svn_filesize_t
 svn_spillbuf__get_memory_size(const svn_spillbuf_t *buf);
 
 /* Retrieve the name of the spill file. The returned value will be
-   NULL if the file has not been created yet. */
+   NULL if the file has not been created yet, or if it is a nameless
+   (anonymous) temporary file; see svn_io__open_anonymous_file(). */
 const char *
 svn_spillbuf__get_filename(const svn_spillbuf_t *buf);
 
@@ -269,6 +270,43 @@ svn_checksum__from_digest_fnv1a_32x4(const unsigned char *digest,
                                      apr_pool_t *result_pool);
 
 
+/**
+ * An #svn_checksum_ctx_t look-alike that may process the data on a
+ * background thread, overlapping hash computation with the I/O performed
+ * by the writing thread.  Small amounts of data get hashed inline; only
+ * bulk contents start a background thread.  Where threading is not
+ * available, all data is hashed inline.
+ */
+typedef struct svn_checksum__async_ctx_t svn_checksum__async_ctx_t;
+
+/**
+ * Create a new checksum context of type @a kind that may hash data in
+ * the background.  Allocate it in @a pool; the hashing thread, if any,
+ * will be stopped when @a pool gets cleaned up.
+ */
+svn_checksum__async_ctx_t *
+svn_checksum__async_ctx_create(svn_checksum_kind_t kind,
+                               apr_pool_t *pool);
+
+/**
+ * Add @a len bytes of @a data to the checksum context @a ctx.
+ * This may return before the data has actually been hashed.
+ */
+svn_error_t *
+svn_checksum__async_update(svn_checksum__async_ctx_t *ctx,
+                           const char *data,
+                           apr_size_t len);
+
+/**
+ * Wait for all data added to @a ctx to be processed and return the
+ * resulting checksum in @a *checksum, allocated in @a result_pool.
+ * Also report any error encountered by the hashing thread.
+ */
+svn_error_t *
+svn_checksum__async_final(svn_checksum_t **checksum,
+                          svn_checksum__async_ctx_t *ctx,
+                          apr_pool_t *result_pool);
+
 /**
  * Return a stream that calculates a checksum of type @a kind over all
  * data written to the @a inner_stream.  When the returned stream gets
@@ -428,6 +466,42 @@ svn_hash__read_entry(svn_hash__entry_t *entry,
                      svn_boolean_t incremental,
                      apr_pool_t *pool);
 
+/** First byte of the binary hash representation written by
+ * svn_hash__write_binary().  The textual hashdump format always starts
+ * with an ASCII letter, so a reader may use this byte to tell the two
+ * representations apart.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_HASH__BINARY_MARKER '\1'
+
+/** Write a binary representation of @a hash, which maps <tt>const char *
+ * </tt> keys to <tt>svn_string_t *</tt> values, to @a stream:
+ * #SVN_HASH__BINARY_MARKER, the entry count and then length-prefixed
+ * key and value data, all integers in 7b/8b encoding.  Entries are
+ * written in lexical key order, so the output is deterministic.
+ * Use @a pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_hash__write_binary(apr_hash_t *hash,
+                       svn_stream_t *stream,
+                       apr_pool_t *pool);
+
+/** Parse the binary representation in @a content, as written by
+ * svn_hash__write_binary(), in a single pass over the buffer and add
+ * the entries to @a hash, allocating keys and values in @a pool.
+ * Return #SVN_ERR_MALFORMED_FILE if @a content does not start with
+ * #SVN_HASH__BINARY_MARKER or is otherwise malformed.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_hash__read_binary(apr_hash_t *hash,
+                      const svn_string_t *content,
+                      apr_pool_t *pool);
+
 /** @} */
 
 /** @} */
@@ -591,6 +665,21 @@ svn__decompress_lz4(const void *data, apr_size_t len,
                     svn_stringbuf_t *out,
                     apr_size_t limit);
 
+/* Same as svn__compress_lz4(), but use zstd compression.  Returns an
+ * error if Subversion was built without zstd support.
+ */
+svn_error_t *
+svn__compress_zstd(const void *data, apr_size_t len,
+                   svn_stringbuf_t *out);
+
+/* Same as svn__decompress_lz4(), but use zstd compression.  Returns an
+ * error if Subversion was built without zstd support.
+ */
+svn_error_t *
+svn__decompress_zstd(const void *data, apr_size_t len,
+                     svn_stringbuf_t *out,
+                     apr_size_t limit);
+
 /** @} */
 
 /**
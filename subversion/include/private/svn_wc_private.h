@@ -399,6 +399,39 @@ svn_wc__status2_from_3(svn_wc_status2_t **status,
                        apr_pool_t *result_pool,
                        apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_wc_walk_status(), but crawl the direct subtrees of
+ * @a local_abspath concurrently on up to @a thread_count worker
+ * threads.  Each worker uses its own read-only wc.db connection;
+ * @a status_func is only ever called on the current thread, and sees
+ * the statuses in the same order the sequential walker would produce.
+ *
+ * Falls back to the sequential walker when @a thread_count is 1, when
+ * APR lacks thread support, when @a depth is not #svn_depth_infinity
+ * or when @a local_abspath is not a versioned directory.
+ *
+ * @note @a cancel_func may be invoked from worker threads and must be
+ * thread-safe.  Working copies configured for exclusive wc.db locking
+ * cannot serve the additional connections and should use the
+ * sequential walker.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_wc__walk_status_parallel(svn_wc_context_t *wc_ctx,
+                             const char *local_abspath,
+                             svn_depth_t depth,
+                             svn_boolean_t get_all,
+                             svn_boolean_t no_ignore,
+                             svn_boolean_t ignore_text_mods,
+                             const apr_array_header_t *ignore_patterns,
+                             apr_int32_t thread_count,
+                             svn_wc_status_func4_t status_func,
+                             void *status_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *scratch_pool);
+
 /**
  * Set @a *children to a new array of the immediate children of the working
  * node at @a dir_abspath.  The elements of @a *children are (const char *)
@@ -725,6 +758,30 @@ svn_wc__release_write_lock(svn_wc_context_t *wc_ctx,
                            const char *local_abspath,
                            apr_pool_t *scratch_pool);
 
+/** Like svn_wc_add_lock2(), but store all the locks in @a locks, a hash
+ * mapping <tt>const char *</tt> local abspaths to <tt>const svn_lock_t
+ * *</tt> structures, with a single working copy transaction per working
+ * copy root instead of one per path.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_wc__add_locks(svn_wc_context_t *wc_ctx,
+                  apr_hash_t *locks,
+                  apr_pool_t *scratch_pool);
+
+/** Like svn_wc_remove_lock2(), but remove the locks for all the local
+ * abspaths in @a local_abspaths with a single working copy transaction
+ * per working copy root instead of one per path, and run the work queue
+ * once at the end.  All paths must belong to the same working copy.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_wc__remove_locks(svn_wc_context_t *wc_ctx,
+                     const apr_array_header_t *local_abspaths,
+                     apr_pool_t *scratch_pool);
+
 /** A callback invoked by the svn_wc__call_with_write_lock() function.  */
 typedef svn_error_t *(*svn_wc__with_write_lock_func_t)(void *baton,
                                                        apr_pool_t *result_pool,
@@ -866,6 +923,23 @@ svn_wc__prop_retrieve_recursive(apr_hash_t **values,
                                 apr_pool_t *result_pool,
                                 apr_pool_t *scratch_pool);
 
+/** Like svn_wc__prop_retrieve_recursive(), but additionally set
+ * @a *repos_relpaths to a mapping of the same const char * local_abspath
+ * keys to each node's const char * repository relpath, gathered from the
+ * same single working copy database query.  Nodes whose repository
+ * relpath cannot be derived from that query are left out of
+ * @a *repos_relpaths; callers should fall back to a per-node lookup
+ * for them.
+ */
+svn_error_t *
+svn_wc__prop_retrieve_recursive2(apr_hash_t **values,
+                                 apr_hash_t **repos_relpaths,
+                                 svn_wc_context_t *wc_ctx,
+                                 const char *local_abspath,
+                                 const char *propname,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
 /**
  * Set @a *iprops_paths to a hash mapping const char * absolute working
  * copy paths to the nodes repository root relative path for each path
@@ -2157,6 +2231,14 @@ svn_wc__working_file_writer_open(svn_wc__working_file_writer_t **writer_p,
 svn_stream_t *
 svn_wc__working_file_writer_get_stream(svn_wc__working_file_writer_t *writer);
 
+/* Get the SHA-1 checksum of the translated contents written through WRITER,
+   i.e. of the data as it will appear on disk.  Returns NULL if the writer
+   does not perform translation, if the written data does not correspond to
+   the on-disk contents (special files), or if the write stream has not been
+   closed yet. */
+const svn_checksum_t *
+svn_wc__working_file_writer_get_checksum(svn_wc__working_file_writer_t *writer);
+
 /* Finalize the content, attributes and the timestamps of the underlying
    temporary file.  Return the properties of the finalized file in MTIME_P
    and SIZE_P.  MTIME_P and SIZE_P both may be NULL. */
@@ -2331,6 +2413,36 @@ svn_wc__upgrade(int *result_format_p,
                 void *notify_baton,
                 apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_wc__upgrade(), but when upgrading a pre-1.7 working copy,
+ * parse the old per-directory metadata and checksum the text-bases on up
+ * to @a thread_count worker threads.  All writes to the new wc.db are
+ * still performed by the current thread, in the order the sequential
+ * upgrade would perform them, so the resulting working copy and the
+ * notifications are identical to a sequential upgrade.
+ *
+ * With a @a thread_count of 1, or without APR thread support, this is
+ * exactly svn_wc__upgrade().
+ *
+ * @note @a cancel_func may be invoked from worker threads and must be
+ * thread-safe.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_wc__upgrade_parallel(int *result_format_p,
+                         svn_wc_context_t *wc_ctx,
+                         const char *local_abspath,
+                         int target_format,
+                         apr_int32_t thread_count,
+                         svn_wc_upgrade_get_repos_info_t repos_info_func,
+                         void *repos_info_baton,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         svn_wc_notify_func2_t notify_func,
+                         void *notify_baton,
+                         apr_pool_t *scratch_pool);
+
 /* Return the working copy settings *FORMAT_P and *STORE_PRISTINE_P for
    LOCAL_ABSPATH in WC_CTX. */
 svn_error_t *
@@ -112,6 +112,8 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS      "http-max-connections"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS     "http-chunked-requests"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_HTTP_PIPELINE_DEPTH       "http-pipeline-depth"
 
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SERF_LOG_COMPONENTS       "serf-log-components"
@@ -161,6 +163,12 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_MEMORY_CACHE_SIZE         "memory-cache-size"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_DIFF_IGNORE_CONTENT_TYPE  "diff-ignore-content-type"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_BLAME_CACHE_DIR           "blame-cache-dir"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_WORKER_THREADS            "worker-threads"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_LOG_CACHE_DIR             "log-cache-dir"
 #define SVN_CONFIG_SECTION_TUNNELS              "tunnels"
 #define SVN_CONFIG_SECTION_AUTO_PROPS           "auto-props"
 /** @since New in 1.8. */
@@ -173,6 +181,10 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_SQLITE_BUSY_TIMEOUT       "busy-timeout"
 /** @since New in 1.15. */
 #define SVN_CONFIG_OPTION_COMPATIBLE_VERSION        "compatible-version"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_PIPELINED_UPDATES         "pipelined-updates"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_COMPRESSED_PRISTINES      "compressed-pristines"
 /** @} */
 
 /** @name Repository conf directory configuration files strings
@@ -237,6 +249,7 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_DEFAULT_OPTION_STORE_SSL_CLIENT_CERT_PP_PLAINTEXT \
                                                              SVN_CONFIG_ASK
 #define SVN_CONFIG_DEFAULT_OPTION_HTTP_MAX_CONNECTIONS       4
+#define SVN_CONFIG_DEFAULT_OPTION_HTTP_PIPELINE_DEPTH        40
 
 /** Read configuration information from the standard sources and merge it
  * into the hash @a *cfg_hash.  If @a config_dir is not NULL it specifies a
@@ -487,6 +487,17 @@ typedef struct svn_diff_file_options_t
    *
    * @since New in 1.9 */
   int context_size;
+
+  /** Whether to use the histogram algorithm instead of the default
+   * Myers LCS algorithm when comparing two sources.  Histogram diff
+   * runs in roughly linear time on typical source changes and anchors
+   * hunks at low-frequency lines, but may produce a non-minimal diff.
+   * Inputs without suitable anchor lines fall back to the Myers
+   * algorithm.  Only two-way comparisons honor this option; three- and
+   * four-way merges always use Myers.  The default is @c FALSE.
+   *
+   * @since New in 1.15. */
+  svn_boolean_t use_histogram_diff;
 } svn_diff_file_options_t;
 
 /** Allocate a @c svn_diff_file_options_t structure in @a pool, initializing
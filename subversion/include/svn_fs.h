@@ -166,6 +166,55 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_LOG_ADDRESSING       "fsfs-log-addressing"
 
+/** Number of shards that svn_fs_pack() may process concurrently,
+ * as a decimal number (@c "4").  The default is @c "1", i.e. strictly
+ * sequential packing.  Values greater than 1 require thread support
+ * and an application that initialized the filesystem for multi-threaded
+ * access.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_PACK_CONCURRENCY     "fsfs-pack-concurrency"
+
+/** Enable / disable pre-loading the L2P and P2L index caches for the
+ * latest shard when opening a FSFS format 7 repository.  This trades a
+ * small amount of I/O at open time for lower latency on the first few
+ * requests, which is useful for short-lived server processes.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_PRELOAD_INDEXES      "fsfs-preload-indexes"
+
+/** Number of rev / pack files that svn_fs_verify() may check concurrently,
+ * as a decimal number (@c "4").  The default is @c "1", i.e. strictly
+ * sequential verification.  Values greater than 1 require thread support
+ * and an application that initialized the filesystem for multi-threaded
+ * access.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_VERIFY_CONCURRENCY   "fsfs-verify-concurrency"
+
+/** Number of pack files that repository statistics gathering, e.g. on
+ * behalf of "svnfsfs stats", may scan concurrently, as a decimal number
+ * (@c "4").  The default is @c "1", i.e. a strictly sequential scan.
+ * Values greater than 1 require thread support and an application that
+ * initialized the filesystem for multi-threaded access.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_STATS_CONCURRENCY    "fsfs-stats-concurrency"
+
+/** Number of revision files that svn_fs_recover2() may scan concurrently
+ * when rebuilding the id counters of older repository formats, as a
+ * decimal number (@c "4").  The default is @c "1", i.e. a strictly
+ * sequential scan.  Values greater than 1 require thread support and an
+ * application that initialized the filesystem for multi-threaded access.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_RECOVER_CONCURRENCY  "fsfs-recover-concurrency"
+
 /* Note to maintainers: if you add further SVN_FS_CONFIG_FSFS_CACHE_* knobs,
    update fs_fs.c:verify_as_revision_before_current_plus_plus(). */
 
@@ -631,9 +680,26 @@ svn_fs_hotcopy(const char *src_path,
  * there is no harm in it, either, and it take very little time.  So
  * it's a fine idea to run recovery when the server process starts,
  * before it begins handling any requests.
+ *
+ * @a fs_config, which may be @c NULL, is a filesystem configuration
+ * hash as accepted by svn_fs_open2() and allows tuning the recovery
+ * run, e.g. via #SVN_FS_CONFIG_FSFS_RECOVER_CONCURRENCY.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_recover2(const char *path,
+                apr_hash_t *fs_config,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *pool);
+
+/** Similar to svn_fs_recover2(), but with @a fs_config always @c NULL.
  *
  * @since New in 1.5.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_fs_recover(const char *path,
                svn_cancel_func_t cancel_func,
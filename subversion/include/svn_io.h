@@ -881,6 +881,18 @@ typedef svn_error_t *(*svn_write_fn_t)(void *baton,
                                        const char *data,
                                        apr_size_t *len);
 
+/** Vectored-write handler function for a generic stream.  The handler
+ * writes the @a nvec buffers in @a vec in order and sets @a *len to the
+ * total number of bytes written.  @see svn_stream_t and
+ * svn_stream_writev().
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_stream_writev_fn_t)(void *baton,
+                                               const svn_string_t *vec,
+                                               apr_size_t nvec,
+                                               apr_size_t *len);
+
 /** Close handler function for a generic stream.  @see svn_stream_t. */
 typedef svn_error_t *(*svn_close_fn_t)(void *baton);
 
@@ -974,6 +986,16 @@ void
 svn_stream_set_write(svn_stream_t *stream,
                      svn_write_fn_t write_fn);
 
+/** Set @a stream's vectored-write function to @a writev_fn.  If no such
+ * function is set, svn_stream_writev() falls back to one
+ * svn_stream_write() call per buffer.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_stream_set_writev(svn_stream_t *stream,
+                      svn_stream_writev_fn_t writev_fn);
+
 /** Set @a stream's close function to @a close_fn */
 void
 svn_stream_set_close(svn_stream_t *stream,
@@ -1363,6 +1385,24 @@ svn_stream_write(svn_stream_t *stream,
                  const char *data,
                  apr_size_t *len);
 
+/** Write the @a nvec buffers in @a vec to a generic @a stream in order,
+ * as if by consecutive svn_stream_write() calls, and set @a *len to the
+ * total number of bytes written.  Stream implementations backed by an
+ * operating system primitive for scatter / gather I/O issue a single
+ * vectored write; others fall back to one write per buffer.
+ *
+ * Just like with svn_stream_write(), a short byte count upon return
+ * without an error indicates that the stream accepted only part of the
+ * data, e.g. on a non-blocking connection.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_stream_writev(svn_stream_t *stream,
+                  const svn_string_t *vec,
+                  apr_size_t nvec,
+                  apr_size_t *len);
+
 /** Close a generic stream. @see svn_stream_t. */
 svn_error_t *
 svn_stream_close(svn_stream_t *stream);
@@ -2383,6 +2423,21 @@ svn_io_file_write_full(apr_file_t *file,
                        apr_size_t *bytes_written,
                        apr_pool_t *pool);
 
+/** Write the @a nvec buffers in @a vec to @a file in order, using a
+ * vectored write where the platform provides one.  All data will have
+ * been written when this returns successfully.  If @a bytes_written is
+ * not NULL, set @a *bytes_written to the number of bytes written before
+ * any error occurred.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_io_file_writev_full(apr_file_t *file,
+                        const svn_string_t *vec,
+                        apr_size_t nvec,
+                        apr_size_t *bytes_written,
+                        apr_pool_t *pool);
+
 /**
  * Writes @a nbytes bytes from @a *buf to a temporary file inside the same
  * directory as @a *final_path. Then syncs the temporary file to disk and
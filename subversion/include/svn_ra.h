@@ -1087,6 +1087,11 @@ svn_ra_get_commit_editor(svn_ra_session_t *session,
  * etc.)  The keys are <tt>const char *</tt>, values are
  * <tt>@c svn_string_t *</tt>.
  *
+ * If both @a stream and @a props are non @c NULL, @a *props is set
+ * before the first byte of content is pushed at @a stream, so the
+ * stream implementation may consult the properties to decide how to
+ * handle the content.
+ *
  * The stream handlers for @a stream may not perform any RA
  * operations using @a session.
  *
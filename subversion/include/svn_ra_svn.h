@@ -50,6 +50,7 @@ extern "C" {
 #define SVN_RA_SVN_CAP_EDIT_PIPELINE "edit-pipeline"
 #define SVN_RA_SVN_CAP_SVNDIFF1 "svndiff1"
 #define SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED "accepts-svndiff2"
+#define SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED "accepts-svndiff3"
 #define SVN_RA_SVN_CAP_ABSENT_ENTRIES "absent-entries"
 /* maps to SVN_RA_CAPABILITY_COMMIT_REVPROPS: */
 #define SVN_RA_SVN_CAP_COMMIT_REVPROPS "commit-revprops"
@@ -71,6 +72,16 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/* The peer understands the TICKET authentication mechanism, i.e.
+ * server-issued, time-limited tickets that let reconnecting clients
+ * skip the challenge-response exchange. */
+#define SVN_RA_SVN_CAP_AUTH_TICKET "auth-ticket"
+/* The server supports the get-files command, i.e. streaming the
+ * contents of several files in a single exchange. */
+#define SVN_RA_SVN_CAP_GET_FILES "get-files"
+/* The peer understands the change-node-props editor command, i.e.
+ * several property changes on one node batched into a single command. */
+#define SVN_RA_SVN_CAP_CHANGE_NODE_PROPS "change-node-props"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
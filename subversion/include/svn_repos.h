@@ -781,8 +781,29 @@ svn_repos_fs_pack(svn_repos_t *repos,
  * by a single threaded process, or by a multi-threaded process when
  * no other threads are accessing the repository.
  *
+ * @a fs_config, which may be @c NULL, is a filesystem configuration
+ * hash as accepted by svn_fs_open2() and allows tuning the recovery
+ * run, e.g. via #SVN_FS_CONFIG_FSFS_RECOVER_CONCURRENCY.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_recover5(const char *path,
+                   svn_boolean_t nonblocking,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void * cancel_baton,
+                   apr_hash_t *fs_config,
+                   apr_pool_t *pool);
+
+/**
+ * Similar to svn_repos_recover5(), but with @a fs_config always @c NULL.
+ *
  * @since New in 1.7.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_recover4(const char *path,
                    svn_boolean_t nonblocking,
@@ -2769,6 +2790,38 @@ svn_repos_fs_change_rev_prop4(svn_repos_t *repos,
                               void *authz_read_baton,
                               apr_pool_t *pool);
 
+/**
+ * Apply all revision property changes in @a props, an array of
+ * #svn_prop_t, to revision @a rev in @a repos's filesystem.  A @c NULL
+ * property value deletes the respective property.
+ *
+ * This behaves like calling svn_repos_fs_change_rev_prop4() once per
+ * element of @a props with @a old_value_p passed as @c NULL, except
+ * that the authorization check runs only once and backends that
+ * support it rewrite the revision's property list on disk only once
+ * for the whole batch.
+ *
+ * The pre- and post-revprop-change hooks only accept a single property
+ * per invocation, so they still run once per element of @a props, in
+ * array order, as specified by @a use_pre_revprop_change_hook and
+ * @a use_post_revprop_change_hook.  If a pre-revprop-change hook
+ * rejects a change, none of the changes are applied.
+ *
+ * Use @a pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_fs_change_rev_props(svn_repos_t *repos,
+                              svn_revnum_t rev,
+                              const char *author,
+                              const apr_array_header_t *props,
+                              svn_boolean_t use_pre_revprop_change_hook,
+                              svn_boolean_t use_post_revprop_change_hook,
+                              svn_repos_authz_func_t authz_read_func,
+                              void *authz_read_baton,
+                              apr_pool_t *pool);
+
 /**
  * Similar to svn_repos_fs_change_rev_prop4(), but with @a old_value_p always
  * set to @c NULL.  (In other words, it is similar to
@@ -36,6 +36,9 @@
 #include "svn_props.h"
 #include "svn_hash.h"
 #include "svn_sorts.h"
+#include "svn_io.h"
+#include "svn_config.h"
+#include "svn_checksum.h"
 
 #include "private/svn_wc_private.h"
 
@@ -123,6 +126,91 @@ struct delta_baton {
 
 
 
+/* --- The on-disk blame cache ---------------------------------------
+
+   When the user configures a "blame-cache-dir" in the miscellany
+   section, we remember the complete blame chain and the file contents
+   of the youngest blamed revision after each forward blame.  A later
+   blame of the same file only has to replay the revisions that arrived
+   since, instead of the entire revision chain.
+
+   One entry is kept per (resolved URL, start revision, diff options)
+   triple, in a file named by the SHA-1 of that key:
+
+       format
+       url
+       start-revision
+       end-revision
+       number-of-chunks
+       one "start revision" line per chunk
+       number-of-revisions-with-props
+       per revision:  a "revision" line, then the revision props in
+                      svn_hash_write2() format
+       text-length
+       the raw file contents at end-revision
+
+   The cache is strictly best-effort: any entry that cannot be read,
+   or does not match the request, simply means a full blame. */
+
+#define BLAME_CACHE_FORMAT 1
+
+/* Set *CACHE_PATH to the path of the cache file in CACHE_DIR for
+   blaming URL from START_REVNUM with DIFF_OPTIONS. */
+static svn_error_t *
+blame_cache_path(const char **cache_path,
+                 const char *cache_dir,
+                 const char *url,
+                 svn_revnum_t start_revnum,
+                 const svn_diff_file_options_t *diff_options,
+                 apr_pool_t *pool)
+{
+  const char *key;
+  svn_checksum_t *checksum;
+
+  key = apr_psprintf(pool, "%s@%ld s%de%df%dc%dh%d", url, start_revnum,
+                     (int)diff_options->ignore_space,
+                     (int)diff_options->ignore_eol_style,
+                     (int)diff_options->show_c_function,
+                     diff_options->context_size,
+                     (int)diff_options->use_histogram);
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, key, strlen(key),
+                       pool));
+
+  *cache_path = svn_dirent_join(svn_dirent_canonicalize(cache_dir, pool),
+                                svn_checksum_to_cstring_display(checksum,
+                                                                pool),
+                                pool);
+  return SVN_NO_ERROR;
+}
+
+/* Read one line from the cache file STREAM into *LINE; it is an error
+   for the file to end here. */
+static svn_error_t *
+read_cache_line(const char **line, svn_stream_t *stream, apr_pool_t *pool)
+{
+  svn_stringbuf_t *sb;
+  svn_boolean_t eof;
+
+  SVN_ERR(svn_stream_readline(stream, &sb, "\n", &eof, pool));
+  if (eof)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+  *line = sb->data;
+  return SVN_NO_ERROR;
+}
+
+/* Read one line from the cache file STREAM and parse it as a number. */
+static svn_error_t *
+read_cache_number(apr_int64_t *number,
+                  svn_stream_t *stream,
+                  apr_pool_t *pool)
+{
+  const char *line;
+
+  SVN_ERR(read_cache_line(&line, stream, pool));
+  return svn_error_trace(svn_cstring_atoi64(number, line));
+}
+
 /* Return a blame chunk associated with REV for a change starting
    at token START, and allocated in CHAIN->mainpool. */
 static struct blame *
@@ -153,6 +241,247 @@ blame_destroy(struct blame_chain *chain,
   chain->avail = blame;
 }
 
+/* Try to load the cache entry at CACHE_PATH for blaming URL from
+   START_REVNUM up to (at most) END_REVNUM.
+
+   On a usable entry, seed FRB->chain and FRB->last_filename with the
+   cached chain and contents and set *CACHED_END to the revision the
+   entry is valid for; otherwise set *CACHED_END to SVN_INVALID_REVNUM.
+   Set *PRESERVE to TRUE when the entry describes a younger revision
+   than END_REVNUM and must not be overwritten by this run. */
+static svn_error_t *
+blame_cache_load(svn_revnum_t *cached_end,
+                 svn_boolean_t *preserve,
+                 struct file_rev_baton *frb,
+                 const char *cache_path,
+                 const char *url,
+                 svn_revnum_t start_revnum,
+                 svn_revnum_t end_revnum,
+                 apr_pool_t *pool)
+{
+  svn_stringbuf_t *content;
+  svn_stream_t *stream;
+  svn_stream_t *tempstream;
+  const char *temppath;
+  const char *line;
+  apr_int64_t number, chunk_count, rev_count, text_len;
+  apr_array_header_t *chunk_starts;
+  apr_array_header_t *chunk_revs;
+  apr_hash_t *revs;
+  struct rev *invalid_rev = NULL;
+  struct blame *head = NULL;
+  struct blame *tail = NULL;
+  svn_node_kind_t kind;
+  char *text;
+  apr_size_t len;
+  int i;
+
+  *cached_end = SVN_INVALID_REVNUM;
+  *preserve = FALSE;
+
+  SVN_ERR(svn_io_check_path(cache_path, &kind, pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_stringbuf_from_file2(&content, cache_path, pool));
+  stream = svn_stream_from_stringbuf(content, pool);
+
+  SVN_ERR(read_cache_number(&number, stream, pool));
+  if (number != BLAME_CACHE_FORMAT)
+    return SVN_NO_ERROR;
+
+  /* The key hash in the file name should make collisions all but
+     impossible, but better not blame the wrong file on one. */
+  SVN_ERR(read_cache_line(&line, stream, pool));
+  if (strcmp(line, url) != 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_cache_number(&number, stream, pool));
+  if (number != start_revnum)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_cache_number(&number, stream, pool));
+  if (number > end_revnum)
+    {
+      /* The entry already describes a younger revision; keep it. */
+      *preserve = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(read_cache_number(&chunk_count, stream, pool));
+  if (chunk_count < 1)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+  chunk_starts = apr_array_make(pool, (int)chunk_count, sizeof(apr_off_t));
+  chunk_revs = apr_array_make(pool, (int)chunk_count, sizeof(svn_revnum_t));
+  for (i = 0; i < chunk_count; i++)
+    {
+      const char *space;
+      apr_int64_t chunk_start, chunk_rev;
+
+      SVN_ERR(read_cache_line(&line, stream, pool));
+      space = strchr(line, ' ');
+      if (!space)
+        return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+      SVN_ERR(svn_cstring_atoi64(&chunk_start,
+                                 apr_pstrmemdup(pool, line, space - line)));
+      SVN_ERR(svn_cstring_atoi64(&chunk_rev, space + 1));
+
+      /* The chunk starts must form a partition of the line range. */
+      if (i == 0 ? chunk_start != 0
+                 : chunk_start <= APR_ARRAY_IDX(chunk_starts, i - 1,
+                                                apr_off_t))
+        return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+      APR_ARRAY_PUSH(chunk_starts, apr_off_t) = (apr_off_t)chunk_start;
+      APR_ARRAY_PUSH(chunk_revs, svn_revnum_t) = (svn_revnum_t)chunk_rev;
+    }
+
+  revs = apr_hash_make(pool);
+  SVN_ERR(read_cache_number(&rev_count, stream, pool));
+  for (i = 0; i < rev_count; i++)
+    {
+      struct rev *rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+      apr_int64_t revision;
+
+      SVN_ERR(read_cache_number(&revision, stream, pool));
+      rev->revision = (svn_revnum_t)revision;
+      rev->rev_props = apr_hash_make(frb->mainpool);
+      SVN_ERR(svn_hash_read2(rev->rev_props, stream, SVN_HASH_TERMINATOR,
+                             frb->mainpool));
+
+      apr_hash_set(revs, &rev->revision, sizeof(rev->revision), rev);
+    }
+
+  SVN_ERR(read_cache_number(&text_len, stream, pool));
+  text = apr_palloc(pool, text_len ? text_len : 1);
+  len = (apr_size_t)text_len;
+  SVN_ERR(svn_stream_read_full(stream, text, &len));
+  if (len != text_len)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+  /* Everything parsed; build the chain and the "previous" file. */
+  for (i = 0; i < chunk_count; i++)
+    {
+      svn_revnum_t revision = APR_ARRAY_IDX(chunk_revs, i, svn_revnum_t);
+      struct rev *rev;
+      struct blame *blame;
+
+      if (SVN_IS_VALID_REVNUM(revision))
+        {
+          rev = apr_hash_get(revs, &revision, sizeof(revision));
+          if (rev == NULL)
+            return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+        }
+      else
+        {
+          /* Lines older than the start revision. */
+          if (invalid_rev == NULL)
+            {
+              invalid_rev = apr_pcalloc(frb->mainpool, sizeof(*invalid_rev));
+              invalid_rev->revision = SVN_INVALID_REVNUM;
+            }
+          rev = invalid_rev;
+        }
+
+      blame = blame_create(frb->chain, rev,
+                           APR_ARRAY_IDX(chunk_starts, i, apr_off_t));
+      if (tail)
+        tail->next = blame;
+      else
+        head = blame;
+      tail = blame;
+    }
+
+  SVN_ERR(svn_stream_open_unique(&tempstream, &temppath, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 frb->mainpool, pool));
+  SVN_ERR(svn_stream_write(tempstream, text, &len));
+  SVN_ERR(svn_stream_close(tempstream));
+
+  frb->chain->blame = head;
+  frb->last_filename = temppath;
+  *cached_end = (svn_revnum_t)number;
+
+  return SVN_NO_ERROR;
+}
+
+/* Store the blame chain BLAME and the contents of LAST_FILENAME, valid
+   for blaming URL from START_REVNUM up to END_REVNUM, at CACHE_PATH. */
+static svn_error_t *
+blame_cache_save(const char *cache_path,
+                 const char *url,
+                 svn_revnum_t start_revnum,
+                 svn_revnum_t end_revnum,
+                 const struct blame *blame,
+                 const char *last_filename,
+                 apr_pool_t *pool)
+{
+  svn_stringbuf_t *content = svn_stringbuf_create_empty(pool);
+  svn_stream_t *stream = svn_stream_from_stringbuf(content, pool);
+  svn_stringbuf_t *text;
+  apr_hash_t *seen = apr_hash_make(pool);
+  const struct blame *walk;
+  apr_size_t len;
+  int chunk_count = 0;
+  int rev_count = 0;
+
+  for (walk = blame; walk; walk = walk->next)
+    {
+      chunk_count++;
+      if (walk->rev && SVN_IS_VALID_REVNUM(walk->rev->revision)
+          && !apr_hash_get(seen, &walk->rev->revision,
+                           sizeof(walk->rev->revision)))
+        {
+          apr_hash_set(seen, &walk->rev->revision,
+                       sizeof(walk->rev->revision), (void *)walk->rev);
+          rev_count++;
+        }
+    }
+
+  SVN_ERR(svn_stream_printf(stream, pool, "%d\n%s\n%ld\n%ld\n%d\n",
+                            BLAME_CACHE_FORMAT, url,
+                            start_revnum, end_revnum, chunk_count));
+
+  for (walk = blame; walk; walk = walk->next)
+    SVN_ERR(svn_stream_printf(stream, pool,
+                              "%" APR_OFF_T_FMT " %ld\n", walk->start,
+                              walk->rev ? walk->rev->revision
+                                        : SVN_INVALID_REVNUM));
+
+  SVN_ERR(svn_stream_printf(stream, pool, "%d\n", rev_count));
+  apr_hash_clear(seen);
+  for (walk = blame; walk; walk = walk->next)
+    {
+      if (!walk->rev || !SVN_IS_VALID_REVNUM(walk->rev->revision)
+          || apr_hash_get(seen, &walk->rev->revision,
+                          sizeof(walk->rev->revision)))
+        continue;
+      apr_hash_set(seen, &walk->rev->revision,
+                   sizeof(walk->rev->revision), (void *)walk->rev);
+
+      SVN_ERR(svn_stream_printf(stream, pool, "%ld\n",
+                                walk->rev->revision));
+      SVN_ERR(svn_hash_write2(walk->rev->rev_props, stream,
+                              SVN_HASH_TERMINATOR, pool));
+    }
+
+  SVN_ERR(svn_stringbuf_from_file2(&text, last_filename, pool));
+  SVN_ERR(svn_stream_printf(stream, pool, "%" APR_SIZE_T_FMT "\n",
+                            text->len));
+  len = text->len;
+  SVN_ERR(svn_stream_write(stream, text->data, &len));
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(cache_path, pool),
+                                      pool));
+  SVN_ERR(svn_io_write_atomic2(cache_path, content->data, content->len,
+                               NULL, FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Return the blame chunk that contains token OFF, starting the search at
    BLAME. */
 static struct blame *
@@ -680,6 +1009,10 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   svn_stream_t *last_stream;
   svn_stream_t *stream;
   const char *target_abspath_or_url;
+  const char *session_url;
+  const char *cache_path = NULL;
+  svn_boolean_t cache_preserve = FALSE;
+  svn_revnum_t cached_end = SVN_INVALID_REVNUM;
 
   if (start->kind == svn_opt_revision_unspecified
       || end->kind == svn_opt_revision_unspecified)
@@ -721,6 +1054,8 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
 
     /* Make the session point to the real URL. */
     SVN_ERR(svn_ra_reparent(ra_session, loc->url, pool));
+
+    session_url = loc->url;
   }
 
   /* We check the mime-type of the yougest revision before getting all
@@ -813,16 +1148,64 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
       frb.prevfilepool = svn_pool_create(pool);
     }
 
+  /* Consult the optional on-disk blame cache.  Backwards and merge-aware
+     blames construct their chains differently and are not cached. */
+  if (!frb.backwards && !include_merged_revisions && ctx->config)
+    {
+      svn_config_t *cfg = svn_hash_gets(ctx->config,
+                                        SVN_CONFIG_CATEGORY_CONFIG);
+      const char *cache_dir = NULL;
+
+      if (cfg)
+        svn_config_get(cfg, &cache_dir, SVN_CONFIG_SECTION_MISCELLANY,
+                       SVN_CONFIG_OPTION_BLAME_CACHE_DIR, NULL);
+
+      if (cache_dir)
+        {
+          svn_error_t *err;
+
+          SVN_ERR(blame_cache_path(&cache_path, cache_dir, session_url,
+                                   start_revnum, diff_options, pool));
+
+          /* An entry we cannot read is just a cache miss. */
+          err = blame_cache_load(&cached_end, &cache_preserve, &frb,
+                                 cache_path, session_url, start_revnum,
+                                 end_revnum, pool);
+          if (err)
+            {
+              svn_error_clear(err);
+              cached_end = SVN_INVALID_REVNUM;
+              frb.chain->blame = NULL;
+              frb.last_filename = NULL;
+            }
+        }
+    }
+
   /* Collect all blame information.
      We need to ensure that we get one revision before the start_rev,
      if available so that we can know what was actually changed in the start
-     revision. */
-  SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
-                                frb.backwards ? start_revnum
-                                              : MAX(0, start_revnum-1),
-                                end_revnum,
-                                include_merged_revisions,
-                                file_rev_handler, &frb, pool));
+     revision.  When resuming from the cache, the revision the cached
+     contents belong to plays that role:  its (empty) diff against the
+     cached contents attributes nothing, and only younger revisions are
+     replayed. */
+  if (cached_end < end_revnum)
+    SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
+                                  SVN_IS_VALID_REVNUM(cached_end)
+                                    ? cached_end
+                                    : (frb.backwards ? start_revnum
+                                                     : MAX(0, start_revnum-1)),
+                                  end_revnum,
+                                  include_merged_revisions,
+                                  file_rev_handler, &frb, pool));
+
+  /* Remember the result for the next blame of this file.  Failure to
+     update the cache does not fail the blame itself. */
+  if (cache_path && !cache_preserve && cached_end < end_revnum
+      && frb.last_filename)
+    svn_error_clear(blame_cache_save(cache_path, session_url,
+                                     start_revnum, end_revnum,
+                                     frb.chain->blame, frb.last_filename,
+                                     pool));
 
   if (end->kind == svn_opt_revision_working)
     {
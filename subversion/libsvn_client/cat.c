@@ -175,6 +175,89 @@ svn_client__get_normalized_stream(svn_stream_t **normal_stream,
   return SVN_NO_ERROR;
 }
 
+/* Baton for open_cat_stream(). */
+struct cat_stream_baton
+{
+  /* The caller's output stream.  Not closed by us. */
+  svn_stream_t *out;
+
+  /* Where svn_ra_get_file() stores the file's properties.  Guaranteed
+     to be filled in by the time the stream is first opened. */
+  apr_hash_t **props;
+
+  const char *url;
+  const char *repos_root_url;
+  svn_boolean_t expand_keywords;
+};
+
+/* Implements svn_stream_lazyopen_func_t.
+ *
+ * svn_ra_get_file() sets *PROPS before it pushes the first byte of
+ * content, so by the time this runs we can decide whether keyword or
+ * EOL translation needs to be interjected.  In the common case of
+ * neither, the content bytes flow straight to the caller's stream
+ * without an intermediate copy. */
+static svn_error_t *
+open_cat_stream(svn_stream_t **stream,
+                void *baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  struct cat_stream_baton *b = baton;
+  apr_hash_t *props = *b->props;
+  svn_string_t *eol_style = svn_hash_gets(props, SVN_PROP_EOL_STYLE);
+  svn_string_t *keywords = svn_hash_gets(props, SVN_PROP_KEYWORDS);
+  svn_subst_eol_style_t eol;
+  const char *eol_str;
+  apr_hash_t *kw;
+
+  if (eol_style)
+    svn_subst_eol_style_from_value(&eol, &eol_str, eol_style->data);
+  else
+    {
+      eol = svn_subst_eol_style_none;
+      eol_str = NULL;
+    }
+
+  if (keywords && b->expand_keywords)
+    {
+      svn_string_t *cmt_rev, *cmt_date, *cmt_author;
+      apr_time_t when = 0;
+
+      cmt_rev = svn_hash_gets(props, SVN_PROP_ENTRY_COMMITTED_REV);
+      cmt_date = svn_hash_gets(props, SVN_PROP_ENTRY_COMMITTED_DATE);
+      cmt_author = svn_hash_gets(props, SVN_PROP_ENTRY_LAST_AUTHOR);
+      if (cmt_date)
+        SVN_ERR(svn_time_from_cstring(&when, cmt_date->data, scratch_pool));
+
+      SVN_ERR(svn_subst_build_keywords3(&kw, keywords->data,
+                                        cmt_rev->data, b->url,
+                                        b->repos_root_url, when,
+                                        cmt_author ?
+                                          cmt_author->data : NULL,
+                                        result_pool));
+    }
+  else
+    kw = NULL;
+
+  if (eol_str == NULL && kw == NULL)
+    {
+      /* No translation needed: connect the content stream straight to
+         the output. */
+      *stream = svn_stream_disown(b->out, result_pool);
+    }
+  else
+    {
+      /* Interject a translating stream */
+      *stream = svn_subst_stream_translated(svn_stream_disown(b->out,
+                                                              result_pool),
+                                            eol_str, FALSE, kw, TRUE,
+                                            result_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_client_cat3(apr_hash_t **returned_props,
                 svn_stream_t *out,
@@ -188,11 +271,10 @@ svn_client_cat3(apr_hash_t **returned_props,
 {
   svn_ra_session_t *ra_session;
   svn_client__pathrev_t *loc;
-  svn_string_t *eol_style;
-  svn_string_t *keywords;
   apr_hash_t *props = NULL;
   const char *repos_root_url;
-  svn_stream_t *output = out;
+  svn_stream_t *output;
+  struct cat_stream_baton csb;
   svn_error_t *err;
 
   /* ### Inconsistent default revision logic in this command. */
@@ -253,9 +335,21 @@ svn_client_cat3(apr_hash_t **returned_props,
   /* Find the repos root URL */
   SVN_ERR(svn_ra_get_repos_root2(ra_session, &repos_root_url, scratch_pool));
 
-  /* Grab some properties we need to know in order to figure out if anything
-     special needs to be done with this file. */
-  err = svn_ra_get_file(ra_session, "", loc->rev, NULL, NULL, &props,
+  /* Grab the properties and the contents in a single round trip.  The
+     RA layer fills in PROPS before it pushes the first byte of content
+     (see svn_ra_get_file()), so the lazily opened output stream can
+     wait until then to decide whether a translating stream needs to be
+     interjected. */
+  csb.out = out;
+  csb.props = &props;
+  csb.url = loc->url;
+  csb.repos_root_url = repos_root_url;
+  csb.expand_keywords = expand_keywords;
+
+  output = svn_stream_lazyopen_create(open_cat_stream, &csb, TRUE,
+                                      scratch_pool);
+
+  err = svn_ra_get_file(ra_session, "", loc->rev, output, NULL, &props,
                         result_pool);
   if (err)
     {
@@ -271,52 +365,9 @@ svn_client_cat3(apr_hash_t **returned_props,
         }
     }
 
-  eol_style = svn_hash_gets(props, SVN_PROP_EOL_STYLE);
-  keywords = svn_hash_gets(props, SVN_PROP_KEYWORDS);
-
-  if (eol_style || keywords)
-    {
-      /* It's a file with no special eol style or keywords. */
-      svn_subst_eol_style_t eol;
-      const char *eol_str;
-      apr_hash_t *kw;
-
-      if (eol_style)
-        svn_subst_eol_style_from_value(&eol, &eol_str, eol_style->data);
-      else
-        {
-          eol = svn_subst_eol_style_none;
-          eol_str = NULL;
-        }
-
-
-      if (keywords && expand_keywords)
-        {
-          svn_string_t *cmt_rev, *cmt_date, *cmt_author;
-          apr_time_t when = 0;
-
-          cmt_rev = svn_hash_gets(props, SVN_PROP_ENTRY_COMMITTED_REV);
-          cmt_date = svn_hash_gets(props, SVN_PROP_ENTRY_COMMITTED_DATE);
-          cmt_author = svn_hash_gets(props, SVN_PROP_ENTRY_LAST_AUTHOR);
-          if (cmt_date)
-            SVN_ERR(svn_time_from_cstring(&when, cmt_date->data, scratch_pool));
-
-          SVN_ERR(svn_subst_build_keywords3(&kw, keywords->data,
-                                            cmt_rev->data, loc->url,
-                                            repos_root_url, when,
-                                            cmt_author ?
-                                              cmt_author->data : NULL,
-                                            scratch_pool));
-        }
-      else
-        kw = NULL;
-
-      /* Interject a translating stream */
-      output = svn_subst_stream_translated(svn_stream_disown(out,
-                                                             scratch_pool),
-                                           eol_str, FALSE, kw, TRUE,
-                                           scratch_pool);
-    }
+  /* Close our stream (and any interjected translation stream with it)
+     to flush pending translation state; the caller's OUT stays open. */
+  SVN_ERR(svn_stream_close(output));
 
   if (returned_props)
     {
@@ -336,12 +387,5 @@ svn_client_cat3(apr_hash_t **returned_props,
       *returned_props = props;
     }
 
-  SVN_ERR(svn_ra_get_file(ra_session, "", loc->rev, output, NULL, NULL,
-                          scratch_pool));
-
-  if (out != output)
-    /* Close the interjected stream */
-    SVN_ERR(svn_stream_close(output));
-
   return SVN_NO_ERROR;
 }
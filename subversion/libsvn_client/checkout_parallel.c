@@ -0,0 +1,493 @@
+/*
+ * checkout_parallel.c:  multi-session parallel checkout
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ==================================================================== */
+
+
+
+/*** Includes. ***/
+
+#include "svn_pools.h"
+#include "svn_wc.h"
+#include "svn_client.h"
+#include "svn_ra.h"
+#include "svn_error.h"
+#include "svn_dirent_uri.h"
+#include "svn_path.h"
+#include "svn_io.h"
+#include "svn_sorts.h"
+#include "client.h"
+
+#include "private/svn_client_private.h"
+#include "private/svn_sorts_private.h"
+#include "private/svn_task.h"
+#include "private/svn_wc_private.h"
+
+#include "svn_private_config.h"
+
+
+/* A parallel checkout proceeds in three passes:
+ *
+ *   1. A sequential depth-immediates checkout of the root over one RA
+ *      session.  This creates the working copy, fetches the root's
+ *      files and creates every top-level directory at depth-empty.
+ *
+ *   2. The top-level directories are partitioned round-robin over up
+ *      to THREAD_COUNT additional RA sessions, and each partition is
+ *      brought to depth-infinity by a task on the shared task runner.
+ *      Each worker thread writes through its own private wc.db
+ *      connection; the partitions are disjoint subtrees, so the only
+ *      point of contention is the SQLite write lock itself.
+ *
+ *   3. A sequential depth-infinity update of the root.  Every subtree
+ *      is already complete, so the server sends next to nothing; this
+ *      merely bumps the root's recorded depth and runs the externals
+ *      handling that the subtree transfers skipped.
+ *
+ * The combination of incomplete nodes and fixed revision numbers makes
+ * this restartable in the same way an interrupted sequential checkout
+ * is:  every pass only ever completes nodes towards the one revision
+ * that pass 1 resolved.
+ */
+
+/* Data shared between all subtree tasks of one parallel checkout. */
+struct parallel_co_baton
+{
+  /* The original client context.  Only touched on the calling thread;
+     workers use the private context from their thread context. */
+  svn_client_ctx_t *ctx;
+
+  /* The revision everything is being checked out at. */
+  svn_revnum_t revnum;
+
+  svn_boolean_t allow_unver_obstructions;
+};
+
+/* A set of top-level subtrees, checked out sequentially over one
+   pre-opened RA session by whichever worker picks up the task. */
+struct subtree_group
+{
+  struct parallel_co_baton *pb;
+
+  /* Dedicated to this group.  Opened (and thus authenticated) on the
+     calling thread before the task run starts; only ever driven by the
+     one task that owns the group. */
+  svn_ra_session_t *ra_session;
+
+  /* Local absolute paths of the subtree roots; all allocated in the
+     pool of the task run and valid throughout it. */
+  apr_array_header_t *subtree_abspaths;
+};
+
+/* The per-worker-thread context:  a private client context, and with
+   it a private wc.db connection, so that disjoint subtrees can be
+   written into the same working copy concurrently. */
+struct co_thread_context
+{
+  svn_client_ctx_t *ctx;
+};
+
+/* Baton for collect_notify_func(). */
+struct collect_notify_baton
+{
+  apr_array_header_t *notifications;  /* of const svn_wc_notify_t * */
+  apr_pool_t *pool;
+};
+
+/* Implements svn_task__thread_context_constructor_t.  Build a private
+   client context for one worker thread from the original context in
+   CONTEXT_BATON. */
+static svn_error_t *
+co_context_constructor(void **thread_context,
+                       void *context_baton,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  svn_client_ctx_t *main_ctx = context_baton;
+  struct co_thread_context *context = apr_pcalloc(result_pool,
+                                                  sizeof(*context));
+
+  SVN_ERR(svn_client_create_context2(&context->ctx, main_ctx->config,
+                                     result_pool));
+  context->ctx->auth_baton = main_ctx->auth_baton;
+  context->ctx->cancel_func = main_ctx->cancel_func;
+  context->ctx->cancel_baton = main_ctx->cancel_baton;
+  context->ctx->client_name = main_ctx->client_name;
+
+  /* The notification, conflict resolution and progress callbacks stay
+     NULL:  they are not expected to be thread-safe.  Notifications are
+     collected per subtree and replayed from the main thread instead;
+     conflicts cannot arise while completing an incomplete checkout. */
+
+  *thread_context = context;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_wc_notify_func2_t.  Stash a deep copy of NOTIFY for
+   later replay through the user's callback on the main thread. */
+static void
+collect_notify_func(void *baton,
+                    const svn_wc_notify_t *notify,
+                    apr_pool_t *scratch_pool)
+{
+  struct collect_notify_baton *cnb = baton;
+
+  APR_ARRAY_PUSH(cnb->notifications, const svn_wc_notify_t *)
+    = svn_wc_dup_notify(notify, cnb->pool);
+}
+
+/* Replay the notifications collected by a worker through the user's
+   callback.  Implements svn_task__output_func_t; runs on the main
+   thread, in the order the sequential checkout would have produced
+   the corresponding subtrees. */
+static svn_error_t *
+group_output_func(svn_task__t *task,
+                  void *result,
+                  void *output_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  struct parallel_co_baton *pb = output_baton;
+  apr_array_header_t *notifications = result;
+  int i;
+
+  if (!pb->ctx->notify_func2)
+    return SVN_NO_ERROR;
+
+  for (i = 0; i < notifications->nelts; i++)
+    pb->ctx->notify_func2(pb->ctx->notify_baton2,
+                          APR_ARRAY_IDX(notifications, i,
+                                        const svn_wc_notify_t *),
+                          scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Bring every subtree of the group given by PROCESS_BATON to
+   depth-infinity over the group's RA session, using the thread's
+   private client context.  Implements svn_task__process_func_t; runs
+   on a worker thread. */
+static svn_error_t *
+group_process_func(void **result,
+                   svn_task__t *task,
+                   void *thread_context,
+                   void *process_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  struct subtree_group *sg = process_baton;
+  struct co_thread_context *context = thread_context;
+  svn_opt_revision_t revision = { svn_opt_revision_number };
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  revision.value.number = sg->pb->revnum;
+  *result = NULL;
+
+  for (i = 0; i < sg->subtree_abspaths->nelts; i++)
+    {
+      const char *subtree_abspath
+        = APR_ARRAY_IDX(sg->subtree_abspaths, i, const char *);
+      struct collect_notify_baton cnb;
+      svn_boolean_t sleep_ignored = FALSE;
+
+      svn_pool_clear(iterpool);
+
+      cnb.notifications = apr_array_make(result_pool, 16,
+                                         sizeof(const svn_wc_notify_t *));
+      cnb.pool = result_pool;
+
+      if (sg->pb->ctx->notify_func2)
+        {
+          context->ctx->notify_func2 = collect_notify_func;
+          context->ctx->notify_baton2 = &cnb;
+        }
+
+      /* The bootstrap pass created this directory at depth-empty;
+         flesh it out completely.  Locking just the subtree itself
+         (INNERUPDATE) keeps the groups from serializing on a write
+         lock of the common parent. */
+      SVN_ERR(svn_client__update_internal(NULL, &sleep_ignored,
+                                          subtree_abspath, &revision,
+                                          svn_depth_infinity,
+                                          TRUE /* depth_is_sticky */,
+                                          TRUE /* ignore_externals */,
+                                          sg->pb->allow_unver_obstructions,
+                                          TRUE /* adds_as_modification */,
+                                          FALSE /* make_parents */,
+                                          TRUE /* innerupdate */,
+                                          sg->ra_session,
+                                          context->ctx, iterpool));
+
+      context->ctx->notify_func2 = NULL;
+      context->ctx->notify_baton2 = NULL;
+
+      /* Flush this subtree's notifications as partial output, so the
+         main thread can start reporting before the whole group is
+         done.  The last subtree's batch travels as the task result. */
+      if (i < sg->subtree_abspaths->nelts - 1)
+        SVN_ERR(svn_task__add(task, svn_task__create_process_pool(task),
+                              cnb.notifications->nelts ? cnb.notifications
+                                                       : NULL,
+                              NULL, NULL, NULL, NULL));
+      else
+        *result = cnb.notifications->nelts ? cnb.notifications : NULL;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Add one sub-task per subtree group in PROCESS_BATON.  Implements
+   svn_task__process_func_t for the root task. */
+static svn_error_t *
+parallel_co_process_func(void **result,
+                         svn_task__t *task,
+                         void *thread_context,
+                         void *process_baton,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *groups = process_baton;
+  int i;
+
+  *result = NULL;
+
+  for (i = 0; i < groups->nelts; i++)
+    {
+      struct subtree_group *sg = APR_ARRAY_IDX(groups, i,
+                                               struct subtree_group *);
+
+      SVN_ERR(svn_task__add(task, svn_task__create_process_pool(task),
+                            NULL, group_process_func, sg,
+                            group_output_func, sg->pb));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* The body of svn_client__checkout_parallel(), after the fallback
+   checks.  LOCAL_ABSPATH does not exist or is an empty directory and
+   THREAD_COUNT is at least 2. */
+static svn_error_t *
+checkout_parallel_internal(svn_revnum_t *result_rev,
+                           svn_boolean_t *timestamp_sleep,
+                           const char *url,
+                           const char *local_abspath,
+                           const svn_opt_revision_t *peg_revision,
+                           const svn_opt_revision_t *revision,
+                           svn_boolean_t ignore_externals,
+                           svn_boolean_t allow_unver_obstructions,
+                           const svn_version_t *wc_format_version,
+                           svn_tristate_t store_pristine,
+                           apr_int32_t thread_count,
+                           svn_client_ctx_t *ctx,
+                           apr_pool_t *scratch_pool)
+{
+  svn_client__pathrev_t *pathrev;
+  svn_ra_session_t *ra_session;
+  svn_opt_revision_t resolved_rev = { svn_opt_revision_number };
+  struct parallel_co_baton pb;
+  apr_hash_t *dirents;
+  apr_array_header_t *sorted;
+  apr_array_header_t *subtree_abspaths;
+  apr_array_header_t *groups;
+  int group_count;
+  int i;
+
+  /* Resolve the peg/operative revision once, so the bootstrap pass,
+     all subtree transfers and the final bump see the very same
+     revision even if HEAD moves while we run. */
+  SVN_ERR(svn_client__ra_session_from_path2(&ra_session, &pathrev,
+                                            url, NULL, peg_revision,
+                                            revision, ctx, scratch_pool));
+  resolved_rev.value.number = pathrev->rev;
+
+  /* Pass 1:  create the working copy and check out the root at
+     depth-immediates, fetching the root's files and creating every
+     top-level directory at depth-empty. */
+  SVN_ERR(svn_client__checkout_internal(NULL, timestamp_sleep,
+                                        pathrev->url, local_abspath,
+                                        &resolved_rev, &resolved_rev,
+                                        svn_depth_immediates,
+                                        TRUE /* ignore_externals */,
+                                        allow_unver_obstructions,
+                                        FALSE /* settings_from_context */,
+                                        wc_format_version, store_pristine,
+                                        ra_session, ctx, scratch_pool));
+
+  /* Partition the top-level directories, in a stable order so that
+     the replayed notifications are deterministic. */
+  SVN_ERR(svn_ra_reparent(ra_session, pathrev->url, scratch_pool));
+  SVN_ERR(svn_ra_get_dir2(ra_session, &dirents, NULL, NULL, "",
+                          pathrev->rev, SVN_DIRENT_KIND, scratch_pool));
+
+  sorted = svn_sort__hash(dirents, svn_sort_compare_items_lexically,
+                          scratch_pool);
+  subtree_abspaths = apr_array_make(scratch_pool, sorted->nelts,
+                                    sizeof(const char *));
+  for (i = 0; i < sorted->nelts; i++)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i,
+                                                    svn_sort__item_t);
+      const svn_dirent_t *dirent = item->value;
+
+      if (dirent->kind == svn_node_dir)
+        APR_ARRAY_PUSH(subtree_abspaths, const char *)
+          = svn_dirent_join(local_abspath, item->key, scratch_pool);
+    }
+
+  pb.ctx = ctx;
+  pb.revnum = pathrev->rev;
+  pb.allow_unver_obstructions = allow_unver_obstructions;
+
+  group_count = MIN(thread_count, subtree_abspaths->nelts);
+  groups = apr_array_make(scratch_pool, group_count,
+                          sizeof(struct subtree_group *));
+  for (i = 0; i < group_count; i++)
+    {
+      struct subtree_group *sg = apr_pcalloc(scratch_pool, sizeof(*sg));
+
+      sg->pb = &pb;
+      sg->subtree_abspaths = apr_array_make(scratch_pool, 4,
+                                            sizeof(const char *));
+
+      /* DAV props are disabled on the group sessions so that their
+         callbacks never reach back into the shared wc context from a
+         worker thread. */
+      SVN_ERR(svn_client__open_ra_session_internal(&sg->ra_session, NULL,
+                                                   pathrev->url, NULL, NULL,
+                                                   FALSE /* write_dav_props */,
+                                                   FALSE /* read_dav_props */,
+                                                   ctx, scratch_pool,
+                                                   scratch_pool));
+      APR_ARRAY_PUSH(groups, struct subtree_group *) = sg;
+    }
+
+  for (i = 0; i < subtree_abspaths->nelts; i++)
+    {
+      struct subtree_group *sg = APR_ARRAY_IDX(groups, i % group_count,
+                                               struct subtree_group *);
+
+      APR_ARRAY_PUSH(sg->subtree_abspaths, const char *)
+        = APR_ARRAY_IDX(subtree_abspaths, i, const char *);
+    }
+
+  /* Pass 2:  the parallel subtree transfers. */
+  if (subtree_abspaths->nelts > 0)
+    SVN_ERR(svn_task__run(thread_count,
+                          parallel_co_process_func, groups,
+                          NULL, NULL,
+                          co_context_constructor, ctx,
+                          ctx->cancel_func, ctx->cancel_baton,
+                          scratch_pool, scratch_pool));
+
+  /* Pass 3:  bump the root to depth-infinity - a cheap drive, since
+     the report already describes every subtree as complete - and run
+     the externals handling that the subtree transfers skipped. */
+  SVN_ERR(svn_client__update_internal(result_rev, timestamp_sleep,
+                                      local_abspath, &resolved_rev,
+                                      svn_depth_infinity,
+                                      TRUE /* depth_is_sticky */,
+                                      ignore_externals,
+                                      allow_unver_obstructions,
+                                      TRUE /* adds_as_modification */,
+                                      FALSE /* make_parents */,
+                                      FALSE /* innerupdate */,
+                                      ra_session, ctx, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_client__checkout_parallel(svn_revnum_t *result_rev,
+                              const char *url,
+                              const char *path,
+                              const svn_opt_revision_t *peg_revision,
+                              const svn_opt_revision_t *revision,
+                              svn_boolean_t ignore_externals,
+                              svn_boolean_t allow_unver_obstructions,
+                              const svn_version_t *wc_format_version,
+                              svn_tristate_t store_pristine,
+                              apr_int32_t thread_count,
+                              svn_client_ctx_t *ctx,
+                              apr_pool_t *pool)
+{
+  const char *local_abspath;
+  svn_node_kind_t kind;
+  svn_boolean_t sleep_here = FALSE;
+  svn_error_t *err;
+
+  SVN_ERR(svn_dirent_get_absolute(&local_abspath, path, pool));
+
+  /* Additional connections only help a full checkout into a pristine
+     target.  Resumed checkouts would have to reconcile existing state
+     in every pass, so they - and obstructed targets, which should get
+     the standard error - take the sequential path. */
+  if (thread_count > 1)
+    {
+      SVN_ERR(svn_io_check_path(local_abspath, &kind, pool));
+      if (kind == svn_node_dir)
+        {
+          apr_hash_t *on_disk;
+
+          SVN_ERR(svn_io_get_dirents3(&on_disk, local_abspath, TRUE,
+                                      pool, pool));
+          if (apr_hash_count(on_disk) > 0)
+            thread_count = 1;
+        }
+      else if (kind != svn_node_none)
+        thread_count = 1;
+    }
+
+  if (thread_count > 1)
+    err = checkout_parallel_internal(result_rev, &sleep_here,
+                                     url, local_abspath,
+                                     peg_revision, revision,
+                                     ignore_externals,
+                                     allow_unver_obstructions,
+                                     wc_format_version, store_pristine,
+                                     thread_count, ctx, pool);
+  else
+    err = svn_client__checkout_internal(result_rev, &sleep_here,
+                                        url, local_abspath,
+                                        peg_revision, revision,
+                                        svn_depth_infinity,
+                                        ignore_externals,
+                                        allow_unver_obstructions,
+                                        FALSE /* settings_from_context */,
+                                        wc_format_version, store_pristine,
+                                        NULL /* ra_session */,
+                                        ctx, pool);
+
+  if (sleep_here)
+    svn_io_sleep_for_timestamps(local_abspath, pool);
+
+  return svn_error_trace(err);
+}
@@ -63,6 +63,11 @@ typedef struct svn_client__private_ctx_t
   /* Total number of bytes transferred over network across all RA sessions. */
   apr_off_t total_progress;
 
+  /* When non-NULL, a memoization of immutable repository lookups that
+     is active for the duration of a single operation.  Managed by
+     svn_client__mergeinfo_memo_begin() and ..._end(); see mergeinfo.h. */
+  struct svn_client__mergeinfo_memo_t *mergeinfo_memo;
+
   /* The public context. */
   svn_client_ctx_t public_ctx;
 } svn_client__private_ctx_t;
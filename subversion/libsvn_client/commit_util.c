@@ -31,6 +31,7 @@
 #include <apr_md5.h>
 
 #include "client.h"
+#include "svn_config.h"
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 #include "svn_types.h"
@@ -366,6 +367,11 @@ bail_on_tree_conflicted_ancestor(svn_wc_context_t *wc_ctx,
    If CANCEL_FUNC is non-null, call it with CANCEL_BATON to see
    if the user has cancelled the operation.
 
+   If THREAD_COUNT is larger than 1, spread the local modification
+   checks of the status walk over up to that many worker threads; see
+   svn_wc__walk_status_parallel().  The harvesting itself always runs
+   on the calling thread.
+
    Any items added to COMMITTABLES are allocated from the COMMITTABLES
    hash pool, not POOL.  SCRATCH_POOL is used for temporary allocations. */
 
@@ -413,6 +419,7 @@ harvest_committables(const char *local_abspath,
                      svn_wc_notify_func2_t notify_func,
                      void *notify_baton,
                      svn_wc_context_t *wc_ctx,
+                     apr_int32_t thread_count,
                      apr_pool_t *result_pool,
                      apr_pool_t *scratch_pool)
 {
@@ -437,17 +444,36 @@ harvest_committables(const char *local_abspath,
 
   baton.skip_below_abspath = NULL;
 
-  SVN_ERR(svn_wc_walk_status(wc_ctx,
-                             local_abspath,
-                             depth,
-                             (copy_mode_relpath != NULL) /* get_all */,
-                             FALSE /* no_ignore */,
-                             FALSE /* ignore_text_mods */,
-                             NULL /* ignore_patterns */,
-                             harvest_status_callback,
-                             &baton,
-                             cancel_func, cancel_baton,
-                             scratch_pool));
+  /* The detranslating file-content checks dominate the walk on large
+     trees; the parallel walker spreads them over THREAD_COUNT worker
+     threads and replays the statuses - and thereby all calls of
+     HARVEST_STATUS_CALLBACK - on this thread in the sequential
+     walker's order. */
+  if (thread_count > 1)
+    SVN_ERR(svn_wc__walk_status_parallel(wc_ctx,
+                                         local_abspath,
+                                         depth,
+                                         (copy_mode_relpath != NULL),
+                                         FALSE /* no_ignore */,
+                                         FALSE /* ignore_text_mods */,
+                                         NULL /* ignore_patterns */,
+                                         thread_count,
+                                         harvest_status_callback,
+                                         &baton,
+                                         cancel_func, cancel_baton,
+                                         scratch_pool));
+  else
+    SVN_ERR(svn_wc_walk_status(wc_ctx,
+                               local_abspath,
+                               depth,
+                               (copy_mode_relpath != NULL) /* get_all */,
+                               FALSE /* no_ignore */,
+                               FALSE /* ignore_text_mods */,
+                               NULL /* ignore_patterns */,
+                               harvest_status_callback,
+                               &baton,
+                               cancel_func, cancel_baton,
+                               scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -1169,6 +1195,11 @@ svn_client__harvest_committables(svn_client__committables_t **committables,
   apr_hash_t *changelist_hash = NULL;
   struct handle_descendants_baton hdb;
   apr_hash_index_t *hi;
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+  apr_int64_t thread_count64;
+  apr_int32_t thread_count;
 
   /* It's possible that one of the named targets has a parent that is
    * itself scheduled for addition or replacement -- that is, the
@@ -1196,6 +1227,12 @@ svn_client__harvest_committables(svn_client__committables_t **committables,
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(base_dir_abspath));
 
+  /* How many worker threads may the status walks below use? */
+  SVN_ERR(svn_config_get_int64(cfg, &thread_count64,
+                               SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_WORKER_THREADS, 1));
+  thread_count = thread_count64 > 1 ? (apr_int32_t)thread_count64 : 1;
+
   /* Create the COMMITTABLES structure. */
   create_committables(committables, result_pool);
 
@@ -1239,7 +1276,8 @@ svn_client__harvest_committables(svn_client__committables_t **committables,
                                    check_url_func, check_url_baton,
                                    ctx->cancel_func, ctx->cancel_baton,
                                    ctx->notify_func2, ctx->notify_baton2,
-                                   ctx->wc_ctx, result_pool, iterpool));
+                                   ctx->wc_ctx, thread_count,
+                                   result_pool, iterpool));
     }
 
   hdb.wc_ctx = ctx->wc_ctx;
@@ -1334,7 +1372,8 @@ harvest_copy_committables(void *baton, void *item, apr_pool_t *pool)
                                btn->ctx->cancel_baton,
                                btn->ctx->notify_func2,
                                btn->ctx->notify_baton2,
-                               btn->ctx->wc_ctx, btn->result_pool, pool));
+                               btn->ctx->wc_ctx, 1 /* thread_count */,
+                               btn->result_pool, pool));
 
   hdb.wc_ctx = btn->ctx->wc_ctx;
   hdb.cancel_func = btn->ctx->cancel_func;
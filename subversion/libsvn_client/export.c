@@ -44,13 +44,23 @@
 
 #include "svn_private_config.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_client_private.h"
 #include "private/svn_delta_private.h"
+#include "private/svn_task.h"
 #include "private/svn_wc_private.h"
 
+#include <apr_atomic.h>
+
 #ifndef ENABLE_EV2_IMPL
 #define ENABLE_EV2_IMPL 0
 #endif
 
+/* Soft cap, in kibibytes, on the file content a parallel export may
+   hold in memory for its writer pool.  Files arriving while more than
+   this much content is in flight are translated and written
+   synchronously on the editor drive thread instead. */
+#define PARALLEL_EXPORT_BUFFER_LIMIT_KB (64 * 1024)
+
 
 /*** Code. ***/
 
@@ -498,6 +508,26 @@ struct edit_baton
   void *cancel_baton;
   svn_wc_notify_func2_t notify_func;
   void *notify_baton;
+
+  /* --- Parallel export state; see svn_client__export_parallel(). ---
+
+     TASK is the editor drive's own task while such a drive is in
+     progress and NULL during a sequential export.  While it is set,
+     NOTIFY_FUNC points at collect_export_notify() and the user's real
+     callback lives in REAL_NOTIFY_FUNC. */
+  svn_task__t *task;
+  svn_wc_notify_func2_t real_notify_func;
+  void *real_notify_baton;
+
+  /* Notifications produced on the drive thread since the last flush,
+     allocated in PENDING_POOL (the drive task's result pool). */
+  apr_array_header_t *pending;
+  apr_pool_t *pending_pool;
+
+  /* Kibibytes of file content currently buffered for the writer pool.
+     Maintained with atomic operations; the drive thread adds, the
+     workers subtract. */
+  volatile apr_uint32_t buffered_kb;
 };
 
 
@@ -533,6 +563,11 @@ struct file_baton
   const char *author;
   apr_time_t date;
 
+  /* When buffering for the writer pool:  the raw fulltext and the
+     sub-task pool it lives in.  Both NULL when writing directly. */
+  svn_stringbuf_t *buffered_content;
+  apr_pool_t *process_pool;
+
   /* Pool associated with this baton. */
   apr_pool_t *pool;
 };
@@ -737,12 +772,29 @@ apply_textdelta(void *file_baton,
                 void **handler_baton)
 {
   struct file_baton *fb = file_baton;
+  struct edit_baton *eb = fb->edit_baton;
   struct handler_baton *hb = apr_palloc(pool, sizeof(*hb));
+  svn_stream_t *target_stream;
+
+  /* With a writer pool present, buffer the raw fulltext and leave the
+     translation and disk I/O to a worker - unless too much content is
+     already in flight, in which case this file is written here, while
+     the incoming data stalls the buffered amount back below the cap. */
+  if (eb->task
+      && apr_atomic_read32(&eb->buffered_kb) < PARALLEL_EXPORT_BUFFER_LIMIT_KB)
+    {
+      fb->process_pool = svn_task__create_process_pool(eb->task);
+      fb->buffered_content = svn_stringbuf_create_empty(fb->process_pool);
+      target_stream = svn_stream_from_stringbuf(fb->buffered_content,
+                                                fb->pool);
+    }
+  else
+    {
+      SVN_ERR(open_working_file_writer(&fb->file_writer, fb, fb->pool, pool));
+      target_stream = svn_wc__working_file_writer_get_stream(fb->file_writer);
+    }
 
-  SVN_ERR(open_working_file_writer(&fb->file_writer, fb, fb->pool, pool));
-
-  svn_txdelta_apply2(svn_stream_empty(pool),
-                     svn_wc__working_file_writer_get_stream(fb->file_writer),
+  svn_txdelta_apply2(svn_stream_empty(pool), target_stream,
                      fb->text_digest, NULL, pool,
                      &hb->apply_handler, &hb->apply_baton);
 
@@ -807,6 +859,114 @@ change_dir_prop(void *dir_baton,
 }
 
 
+/* Implements svn_wc_notify_func2_t.  During a parallel export, stash a
+   deep copy of NOTIFY for ordered replay on the calling thread. */
+static void
+collect_export_notify(void *baton,
+                      const svn_wc_notify_t *notify,
+                      apr_pool_t *scratch_pool)
+{
+  struct edit_baton *eb = baton;
+
+  APR_ARRAY_PUSH(eb->pending, const svn_wc_notify_t *)
+    = svn_wc_dup_notify(notify, eb->pending_pool);
+}
+
+/* Return the notifications collected on the drive thread since the
+   last call, or NULL if there are none, and start a fresh batch. */
+static void *
+take_pending_notifications(struct edit_baton *eb)
+{
+  apr_array_header_t *pending = eb->pending;
+
+  if (!pending || !pending->nelts)
+    return NULL;
+
+  eb->pending = apr_array_make(eb->pending_pool, 16,
+                               sizeof(const svn_wc_notify_t *));
+  return pending;
+}
+
+/* Replay a batch of notifications through the user's callback.
+   Implements svn_task__output_func_t; runs on the calling thread, in
+   the order the sequential export would have produced them. */
+static svn_error_t *
+replay_export_notifications(svn_task__t *task,
+                            void *result,
+                            void *output_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  struct edit_baton *eb = output_baton;
+  apr_array_header_t *notifications = result;
+  int i;
+
+  if (!eb->real_notify_func)
+    return SVN_NO_ERROR;
+
+  for (i = 0; i < notifications->nelts; i++)
+    eb->real_notify_func(eb->real_notify_baton,
+                         APR_ARRAY_IDX(notifications, i,
+                                       const svn_wc_notify_t *),
+                         scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Translate and install one buffered file, given by PROCESS_BATON (a
+   file baton holding only pool-independent copies).  Implements
+   svn_task__process_func_t; runs on a worker thread. */
+static svn_error_t *
+write_buffered_file(void **result,
+                    svn_task__t *task,
+                    void *thread_context,
+                    void *process_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  struct file_baton *fb = process_baton;
+  struct edit_baton *eb = fb->edit_baton;
+  svn_wc__working_file_writer_t *writer;
+  svn_stream_t *stream;
+  const char *target_abspath;
+  apr_size_t len = fb->buffered_content->len;
+
+  *result = NULL;
+
+  SVN_ERR(open_working_file_writer(&writer, fb, scratch_pool, scratch_pool));
+  stream = svn_wc__working_file_writer_get_stream(writer);
+  SVN_ERR(svn_stream_write(stream, fb->buffered_content->data, &len));
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_ERR(svn_dirent_get_absolute(&target_abspath, fb->path, scratch_pool));
+  SVN_ERR(svn_wc__working_file_writer_finalize(NULL, NULL, writer,
+                                               scratch_pool));
+  SVN_ERR(svn_wc__working_file_writer_install(writer, target_abspath,
+                                              scratch_pool));
+
+  apr_atomic_sub32(&eb->buffered_kb,
+                   (apr_uint32_t)(fb->buffered_content->len / 1024 + 1));
+
+  if (eb->real_notify_func)
+    {
+      apr_array_header_t *notifications
+        = apr_array_make(result_pool, 1, sizeof(const svn_wc_notify_t *));
+      svn_wc_notify_t *notify
+        = svn_wc_create_notify(apr_pstrdup(result_pool, fb->path),
+                               svn_wc_notify_update_add, result_pool);
+
+      notify->kind = svn_node_file;
+      APR_ARRAY_PUSH(notifications, const svn_wc_notify_t *) = notify;
+      *result = notifications;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Install the file, and send feedback. */
 static svn_error_t *
 close_file(void *file_baton,
@@ -814,12 +974,13 @@ close_file(void *file_baton,
            apr_pool_t *pool)
 {
   struct file_baton *fb = file_baton;
+  struct edit_baton *eb = fb->edit_baton;
   svn_checksum_t *text_checksum;
   svn_checksum_t *actual_checksum;
   const char *target_abspath;
 
   /* Was a txdelta even sent? */
-  if (! fb->file_writer)
+  if (! fb->file_writer && ! fb->buffered_content)
     return SVN_NO_ERROR;
 
   SVN_ERR(svn_checksum_parse_hex(&text_checksum, svn_checksum_md5, text_digest,
@@ -834,6 +995,42 @@ close_file(void *file_baton,
                                      _("Checksum mismatch for '%s'"),
                                      svn_dirent_local_style(fb->path, pool));
 
+  /* Hand a buffered file over to the writer pool.  FB itself lives in
+     the editor's per-file pool, so the sub-task gets pool-independent
+     copies of everything it needs in its own process pool. */
+  if (fb->buffered_content)
+    {
+      apr_pool_t *process_pool = fb->process_pool;
+      struct file_baton *wfb = apr_pcalloc(process_pool, sizeof(*wfb));
+
+      wfb->edit_baton = eb;
+      wfb->path = apr_pstrdup(process_pool, fb->path);
+      wfb->url = apr_pstrdup(process_pool, fb->url);
+      wfb->repos_root_url = eb->repos_root_url;
+      if (fb->eol_style_val)
+        wfb->eol_style_val = svn_string_dup(fb->eol_style_val, process_pool);
+      if (fb->keywords_val)
+        wfb->keywords_val = svn_string_dup(fb->keywords_val, process_pool);
+      if (fb->executable_val)
+        wfb->executable_val = svn_string_dup(fb->executable_val, process_pool);
+      wfb->special = fb->special;
+      if (fb->revision)
+        wfb->revision = apr_pstrdup(process_pool, fb->revision);
+      if (fb->author)
+        wfb->author = apr_pstrdup(process_pool, fb->author);
+      wfb->date = fb->date;
+      wfb->buffered_content = fb->buffered_content;
+      wfb->pool = process_pool;
+
+      apr_atomic_add32(&eb->buffered_kb,
+                       (apr_uint32_t)(fb->buffered_content->len / 1024 + 1));
+
+      return svn_error_trace(svn_task__add(eb->task, process_pool,
+                                           take_pending_notifications(eb),
+                                           write_buffered_file, wfb,
+                                           replay_export_notifications, eb));
+    }
+
   SVN_ERR(svn_dirent_get_absolute(&target_abspath, fb->path, pool));
 
   SVN_ERR(svn_wc__working_file_writer_finalize(NULL, NULL, fb->file_writer,
@@ -887,7 +1084,8 @@ static svn_error_t *
 get_editor_ev1(const svn_delta_editor_t **export_editor,
                void **edit_baton,
                struct edit_baton *eb,
-               svn_client_ctx_t *ctx,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
                apr_pool_t *result_pool,
                apr_pool_t *scratch_pool)
 {
@@ -902,8 +1100,8 @@ get_editor_ev1(const svn_delta_editor_t **export_editor,
   editor->change_file_prop = change_file_prop;
   editor->change_dir_prop = change_dir_prop;
 
-  SVN_ERR(svn_delta_get_cancellation_editor(ctx->cancel_func,
-                                            ctx->cancel_baton,
+  SVN_ERR(svn_delta_get_cancellation_editor(cancel_func,
+                                            cancel_baton,
                                             editor,
                                             eb,
                                             export_editor,
@@ -1302,7 +1500,8 @@ export_directory(const char *from_url,
   SVN_ERR_ASSERT(svn_path_is_url(from_url));
 
   if (!ENABLE_EV2_IMPL)
-    SVN_ERR(get_editor_ev1(&export_editor, &edit_baton, eb, ctx,
+    SVN_ERR(get_editor_ev1(&export_editor, &edit_baton, eb,
+                           ctx->cancel_func, ctx->cancel_baton,
                            scratch_pool, scratch_pool));
   else
     SVN_ERR(get_editor_ev2(&export_editor, &edit_baton, eb, ctx,
@@ -1588,3 +1787,212 @@ svn_client_export5(svn_revnum_t *result_rev,
   return SVN_NO_ERROR;
 }
 
+/* Parameters of the parallel editor drive, which runs as the root task
+   on one of the worker threads. */
+struct export_drive_baton
+{
+  struct edit_baton *eb;
+
+  /* Opened (and thus authenticated) on the calling thread; only ever
+     driven by the root task. */
+  svn_ra_session_t *ra_session;
+
+  svn_revnum_t revnum;
+};
+
+/* Drive the export editor over the pre-opened RA session, spawning one
+   writer sub-task per buffered file.  Implements
+   svn_task__process_func_t for the root task. */
+static svn_error_t *
+export_drive_process_func(void **result,
+                          svn_task__t *task,
+                          void *thread_context,
+                          void *process_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  struct export_drive_baton *edb = process_baton;
+  struct edit_baton *eb = edb->eb;
+  const svn_delta_editor_t *export_editor;
+  void *edit_baton;
+  const svn_ra_reporter3_t *reporter;
+  void *report_baton;
+
+  eb->task = task;
+  eb->pending_pool = result_pool;
+  eb->pending = apr_array_make(result_pool, 16,
+                               sizeof(const svn_wc_notify_t *));
+
+  SVN_ERR(get_editor_ev1(&export_editor, &edit_baton, eb,
+                         cancel_func, cancel_baton,
+                         scratch_pool, scratch_pool));
+
+  SVN_ERR(svn_ra_do_update3(edb->ra_session,
+                            &reporter, &report_baton,
+                            edb->revnum,
+                            "", /* no sub-target */
+                            svn_depth_infinity,
+                            FALSE, /* don't want copyfrom-args */
+                            FALSE, /* don't want ignore_ancestry */
+                            export_editor, edit_baton,
+                            scratch_pool, scratch_pool));
+
+  SVN_ERR(reporter->set_path(report_baton, "", edb->revnum,
+                             svn_depth_infinity,
+                             TRUE, /* "help, my dir is empty!" */
+                             NULL, scratch_pool));
+
+  SVN_ERR(reporter->finish_report(report_baton, scratch_pool));
+
+  eb->task = NULL;
+  *result = take_pending_notifications(eb);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_client__export_parallel(svn_revnum_t *result_rev,
+                            const char *from_path_or_url,
+                            const char *to_path,
+                            const svn_opt_revision_t *peg_revision,
+                            const svn_opt_revision_t *revision,
+                            svn_boolean_t overwrite,
+                            svn_boolean_t ignore_externals,
+                            svn_boolean_t ignore_keywords,
+                            svn_depth_t depth,
+                            const char *native_eol,
+                            apr_int32_t thread_count,
+                            svn_client_ctx_t *ctx,
+                            apr_pool_t *pool)
+{
+  svn_revnum_t edit_revision = SVN_INVALID_REVNUM;
+  apr_pool_t *drive_pool;
+  svn_client__pathrev_t *loc;
+  svn_ra_session_t *ra_session;
+  svn_node_kind_t kind;
+  struct edit_baton *eb;
+  struct export_drive_baton edb;
+  const char *from_url;
+
+  SVN_ERR_ASSERT(peg_revision != NULL);
+  SVN_ERR_ASSERT(revision != NULL);
+
+  peg_revision = svn_cl__rev_default_to_head_or_working(peg_revision,
+                                                        from_path_or_url);
+  revision = svn_cl__rev_default_to_peg(revision, peg_revision);
+
+  /* The writer pool only helps the full remote directory export with
+     its one-file-at-a-time translation; everything else goes through
+     the sequential engine unchanged. */
+  if (thread_count <= 1
+      || ENABLE_EV2_IMPL
+      || depth != svn_depth_infinity
+      || (!svn_path_is_url(from_path_or_url)
+          && SVN_CLIENT__REVKIND_IS_LOCAL_TO_WC(revision->kind)))
+    return svn_error_trace(svn_client_export5(result_rev, from_path_or_url,
+                                              to_path, peg_revision, revision,
+                                              overwrite, ignore_externals,
+                                              ignore_keywords, depth,
+                                              native_eol, ctx, pool));
+
+  if (svn_path_is_url(to_path))
+    return svn_error_createf(SVN_ERR_ILLEGAL_TARGET, NULL,
+                             _("'%s' is not a local path"), to_path);
+
+  /* Everything the drive thread touches is allocated from a dedicated
+     subpool, so the drive never shares a pool with the notification
+     replay running concurrently on this thread. */
+  drive_pool = svn_pool_create(pool);
+
+  SVN_ERR(svn_client_url_from_path2(&from_url, from_path_or_url,
+                                    ctx, drive_pool, drive_pool));
+
+  SVN_ERR(svn_client__ra_session_from_path2(&ra_session, &loc,
+                                            from_path_or_url, NULL,
+                                            peg_revision,
+                                            revision, ctx, drive_pool));
+
+  SVN_ERR(svn_ra_check_path(ra_session, "", loc->rev, &kind, drive_pool));
+  if (kind != svn_node_dir)
+    {
+      /* Single files (and the error for nonexistent URLs) are the
+         sequential engine's business. */
+      svn_pool_destroy(drive_pool);
+      return svn_error_trace(svn_client_export5(result_rev, from_path_or_url,
+                                                to_path, peg_revision,
+                                                revision, overwrite,
+                                                ignore_externals,
+                                                ignore_keywords, depth,
+                                                native_eol, ctx, pool));
+    }
+
+  eb = apr_pcalloc(drive_pool, sizeof(*eb));
+  SVN_ERR(svn_ra_get_repos_root2(ra_session, &eb->repos_root_url,
+                                 drive_pool));
+  eb->root_path = apr_pstrdup(drive_pool, to_path);
+  eb->root_url = loc->url;
+  eb->overwrite = overwrite;
+  eb->target_revision = &edit_revision;
+  eb->externals = apr_hash_make(drive_pool);
+  eb->native_eol = native_eol;
+  eb->ignore_keywords = ignore_keywords;
+  eb->cancel_func = ctx->cancel_func;
+  eb->cancel_baton = ctx->cancel_baton;
+  if (ctx->notify_func2)
+    {
+      eb->notify_func = collect_export_notify;
+      eb->notify_baton = eb;
+      eb->real_notify_func = ctx->notify_func2;
+      eb->real_notify_baton = ctx->notify_baton2;
+    }
+
+  edb.eb = eb;
+  edb.ra_session = ra_session;
+  edb.revnum = loc->rev;
+
+  SVN_ERR(svn_task__run(thread_count,
+                        export_drive_process_func, &edb,
+                        replay_export_notifications, eb,
+                        NULL, NULL,
+                        ctx->cancel_func, ctx->cancel_baton,
+                        pool, pool));
+
+  /* The empty-dir special case and the externals, exactly like the
+     sequential directory export. */
+  SVN_ERR(svn_io_check_path(to_path, &kind, pool));
+  if (kind == svn_node_none)
+    SVN_ERR(open_root_internal(to_path, overwrite, ctx->notify_func2,
+                               ctx->notify_baton2, pool));
+
+  if (! ignore_externals)
+    {
+      const char *to_abspath;
+
+      SVN_ERR(svn_dirent_get_absolute(&to_abspath, to_path, pool));
+      SVN_ERR(svn_client__export_externals(eb->externals,
+                                           from_url,
+                                           to_abspath, eb->repos_root_url,
+                                           svn_depth_infinity, native_eol,
+                                           ignore_keywords,
+                                           ctx, pool));
+    }
+
+  svn_pool_destroy(drive_pool);
+
+  if (ctx->notify_func2)
+    {
+      svn_wc_notify_t *notify
+        = svn_wc_create_notify(to_path,
+                               svn_wc_notify_update_completed, pool);
+      notify->revision = edit_revision;
+      ctx->notify_func2(ctx->notify_baton2, notify, pool);
+    }
+
+  if (result_rev)
+    *result_rev = edit_revision;
+
+  return SVN_NO_ERROR;
+}
+
@@ -38,9 +38,11 @@
 #include "svn_path.h"
 #include "svn_props.h"
 #include "svn_config.h"
+#include "svn_sorts.h"
 #include "client.h"
 
 #include "svn_private_config.h"
+#include "private/svn_task.h"
 #include "private/svn_wc_private.h"
 
 
@@ -747,25 +749,26 @@ handle_external_item_removal(const svn_client_ctx_t *ctx,
   return svn_error_trace(err);
 }
 
+/* Resolve the URL, operative revision and node kind of the external
+   NEW_ITEM, defined in the directory with URL PARENT_DIR_URL of the
+   repository rooted at REPOS_ROOT_URL.  Set *NEW_URL to the resolved
+   URL, *NEW_LOC to the resolved location and *EXT_KIND to the node's
+   kind in the repository.
+
+   *RA_SESSION may be a session to reuse (it will be reparented as
+   needed) or NULL; if it points to the wrong repository, it is reset
+   to a new session opened for the external's URL. */
 static svn_error_t *
-handle_external_item_change(svn_client_ctx_t *ctx,
-                            const char *repos_root_url,
-                            const char *parent_dir_abspath,
-                            const char *parent_dir_url,
-                            const char *local_abspath,
-                            const char *old_defining_abspath,
-                            const svn_wc_external_item2_t *new_item,
-                            svn_ra_session_t *ra_session,
-                            svn_boolean_t *timestamp_sleep,
-                            apr_pool_t *scratch_pool)
+resolve_external_item(svn_client__pathrev_t **new_loc,
+                      const char **new_url,
+                      svn_node_kind_t *ext_kind,
+                      const svn_wc_external_item2_t *new_item,
+                      const char *repos_root_url,
+                      const char *parent_dir_url,
+                      svn_ra_session_t **ra_session,
+                      svn_client_ctx_t *ctx,
+                      apr_pool_t *scratch_pool)
 {
-  svn_client__pathrev_t *new_loc;
-  const char *new_url;
-  svn_node_kind_t ext_kind;
-
-  SVN_ERR_ASSERT(repos_root_url && parent_dir_url);
-  SVN_ERR_ASSERT(new_item != NULL);
-
   /* Don't bother to check status, since we'll get that for free by
      attempting to retrieve the hash values anyway.  */
 
@@ -773,61 +776,82 @@ handle_external_item_change(svn_client_ctx_t *ctx,
      iterpool, since the hash table values outlive the iterpool and
      any pointers they have should also outlive the iterpool.  */
 
-  SVN_ERR(svn_wc__resolve_relative_external_url(&new_url,
+  SVN_ERR(svn_wc__resolve_relative_external_url(new_url,
                                                 new_item, repos_root_url,
                                                 parent_dir_url,
                                                 scratch_pool, scratch_pool));
 
   /* Determine if the external is a file or directory. */
   /* Get the RA connection, if needed. */
-  if (ra_session)
+  if (*ra_session)
     {
-      svn_error_t *err = svn_ra_reparent(ra_session, new_url, scratch_pool);
+      svn_error_t *err = svn_ra_reparent(*ra_session, *new_url, scratch_pool);
 
       if (err)
         {
           if (err->apr_err == SVN_ERR_RA_ILLEGAL_URL)
             {
               svn_error_clear(err);
-              ra_session = NULL;
+              *ra_session = NULL;
             }
           else
             return svn_error_trace(err);
         }
       else
         {
-          SVN_ERR(svn_client__resolve_rev_and_url(&new_loc,
-                                                  ra_session, new_url,
+          SVN_ERR(svn_client__resolve_rev_and_url(new_loc,
+                                                  *ra_session, *new_url,
                                                   &(new_item->peg_revision),
                                                   &(new_item->revision), ctx,
                                                   scratch_pool));
 
-          SVN_ERR(svn_ra_reparent(ra_session, new_loc->url, scratch_pool));
+          SVN_ERR(svn_ra_reparent(*ra_session, (*new_loc)->url,
+                                  scratch_pool));
         }
     }
 
-  if (!ra_session)
-    SVN_ERR(svn_client__ra_session_from_path2(&ra_session, &new_loc,
-                                              new_url, NULL,
+  if (!*ra_session)
+    SVN_ERR(svn_client__ra_session_from_path2(ra_session, new_loc,
+                                              *new_url, NULL,
                                               &(new_item->peg_revision),
                                               &(new_item->revision), ctx,
                                               scratch_pool));
 
-  SVN_ERR(svn_ra_check_path(ra_session, "", new_loc->rev, &ext_kind,
+  SVN_ERR(svn_ra_check_path(*ra_session, "", (*new_loc)->rev, ext_kind,
                             scratch_pool));
 
-  if (svn_node_none == ext_kind)
+  if (svn_node_none == *ext_kind)
     return svn_error_createf(SVN_ERR_RA_ILLEGAL_URL, NULL,
                              _("URL '%s' at revision %ld doesn't exist"),
-                             new_loc->url, new_loc->rev);
+                             (*new_loc)->url, (*new_loc)->rev);
 
-  if (svn_node_dir != ext_kind && svn_node_file != ext_kind)
+  if (svn_node_dir != *ext_kind && svn_node_file != *ext_kind)
     return svn_error_createf(SVN_ERR_RA_ILLEGAL_URL, NULL,
                              _("URL '%s' at revision %ld is not a file "
                                "or a directory"),
-                             new_loc->url, new_loc->rev);
+                             (*new_loc)->url, (*new_loc)->rev);
 
+  return SVN_NO_ERROR;
+}
 
+/* The second half of handle_external_item_change():  bring the external
+   at LOCAL_ABSPATH in line with NEW_ITEM, whose URL, location and kind
+   have already been resolved to NEW_URL, NEW_LOC and EXT_KIND by
+   resolve_external_item(). */
+static svn_error_t *
+handle_resolved_item_change(svn_client_ctx_t *ctx,
+                            const char *repos_root_url,
+                            const char *parent_dir_abspath,
+                            const char *local_abspath,
+                            const char *old_defining_abspath,
+                            const svn_wc_external_item2_t *new_item,
+                            const char *new_url,
+                            svn_client__pathrev_t *new_loc,
+                            svn_node_kind_t ext_kind,
+                            svn_ra_session_t *ra_session,
+                            svn_boolean_t *timestamp_sleep,
+                            apr_pool_t *scratch_pool)
+{
   /* Not protecting against recursive externals.  Detecting them in
      the global case is hard, and it should be pretty obvious to a
      user when it happens.  Worst case: your disk fills up :-). */
@@ -936,6 +960,38 @@ handle_external_item_change(svn_client_ctx_t *ctx,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+handle_external_item_change(svn_client_ctx_t *ctx,
+                            const char *repos_root_url,
+                            const char *parent_dir_abspath,
+                            const char *parent_dir_url,
+                            const char *local_abspath,
+                            const char *old_defining_abspath,
+                            const svn_wc_external_item2_t *new_item,
+                            svn_ra_session_t *ra_session,
+                            svn_boolean_t *timestamp_sleep,
+                            apr_pool_t *scratch_pool)
+{
+  svn_client__pathrev_t *new_loc;
+  const char *new_url;
+  svn_node_kind_t ext_kind;
+
+  SVN_ERR_ASSERT(repos_root_url && parent_dir_url);
+  SVN_ERR_ASSERT(new_item != NULL);
+
+  SVN_ERR(resolve_external_item(&new_loc, &new_url, &ext_kind, new_item,
+                                repos_root_url, parent_dir_url,
+                                &ra_session, ctx, scratch_pool));
+
+  return svn_error_trace(
+            handle_resolved_item_change(ctx, repos_root_url,
+                                        parent_dir_abspath, local_abspath,
+                                        old_defining_abspath, new_item,
+                                        new_url, new_loc, ext_kind,
+                                        ra_session, timestamp_sleep,
+                                        scratch_pool));
+}
+
 static svn_error_t *
 wrap_external_error(const svn_client_ctx_t *ctx,
                     const char *target_abspath,
@@ -960,6 +1016,434 @@ wrap_external_error(const svn_client_ctx_t *ctx,
   return err;
 }
 
+
+/*** The parallel externals engine. ***/
+
+/* Externals are processed concurrently in much the same way parallel
+ * checkouts transfer their subtrees (see checkout_parallel.c):
+ *
+ *   - While walking the externals definitions, the changed items are
+ *     collected instead of being processed on the spot.
+ *
+ *   - The items are partitioned round-robin over up to THREAD_COUNT
+ *     pre-opened RA sessions, and each partition becomes one task on
+ *     the shared task runner.  Directory externals are independent
+ *     working copies, so a worker can check them out or update them
+ *     through its own private client context; only the registration
+ *     in the defining working copy's wc.db contends on the SQLite
+ *     write lock.
+ *
+ *   - File externals live inside the defining working copy and need
+ *     the write lock our caller already holds, so a worker only
+ *     resolves their kind and hands them back to the calling thread,
+ *     which processes them during output replay.
+ *
+ * Notifications are collected per external and replayed through the
+ * user's callback on the calling thread, so they stay ordered within
+ * each external but may interleave across externals.  A failure of
+ * one external is reported the same way as in the sequential case:
+ * as an svn_wc_notify_failed_external notification, without aborting
+ * the others.
+ */
+
+/* Data shared between all tasks of one parallel externals run. */
+struct parallel_ext_baton
+{
+  /* The original client context.  Only touched on the calling thread;
+     workers use the private context from their thread context. */
+  svn_client_ctx_t *ctx;
+
+  const char *repos_root_url;
+
+  /* The caller's sleep flag.  Only folded into on the calling thread. */
+  svn_boolean_t *timestamp_sleep;
+};
+
+/* One changed external, collected by handle_externals_change(). */
+struct external_item_work
+{
+  struct parallel_ext_baton *pb;
+
+  /* The directory defining the external and its URL. */
+  const char *parent_dir_abspath;
+  const char *parent_dir_url;
+
+  /* The external's target path and, if it was already present, the
+     path of its previous defining directory. */
+  const char *local_abspath;
+  const char *old_defining_abspath;
+
+  const svn_wc_external_item2_t *new_item;
+};
+
+/* What one worker produced for one external; handed to the output
+   function on the calling thread. */
+struct external_item_result
+{
+  struct external_item_work *work;
+
+  /* Notifications collected while processing the external, in order,
+     or NULL if none were produced.  Of const svn_wc_notify_t *. */
+  apr_array_header_t *notifications;
+
+  /* The error the external failed with, or NULL.  Wrapped into a
+     failure notification on the calling thread. */
+  svn_error_t *err;
+
+  /* TRUE if this is a file external that the calling thread still
+     needs to process. */
+  svn_boolean_t deferred;
+
+  svn_boolean_t sleep;
+};
+
+/* A set of externals, processed sequentially over one pre-opened RA
+   session by whichever worker picks up the task. */
+struct external_group
+{
+  struct parallel_ext_baton *pb;
+
+  /* Dedicated to this group.  Opened (and thus authenticated) on the
+     calling thread before the task run starts; only ever driven by
+     the one task that owns the group. */
+  svn_ra_session_t *ra_session;
+
+  /* The group's externals, of struct external_item_work *. */
+  apr_array_header_t *items;
+};
+
+/* The per-worker-thread context:  a private client context, and with
+   it a private wc.db connection for registering directory externals
+   in the defining working copy. */
+struct ext_thread_context
+{
+  svn_client_ctx_t *ctx;
+};
+
+/* Baton for ext_collect_notify_func(). */
+struct ext_collect_notify_baton
+{
+  apr_array_header_t *notifications;  /* of const svn_wc_notify_t * */
+  apr_pool_t *pool;
+};
+
+/* Implements svn_task__thread_context_constructor_t.  Build a private
+   client context for one worker thread from the original context in
+   CONTEXT_BATON. */
+static svn_error_t *
+ext_context_constructor(void **thread_context,
+                        void *context_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  svn_client_ctx_t *main_ctx = context_baton;
+  struct ext_thread_context *context = apr_pcalloc(result_pool,
+                                                   sizeof(*context));
+
+  SVN_ERR(svn_client_create_context2(&context->ctx, main_ctx->config,
+                                     result_pool));
+  context->ctx->auth_baton = main_ctx->auth_baton;
+  context->ctx->cancel_func = main_ctx->cancel_func;
+  context->ctx->cancel_baton = main_ctx->cancel_baton;
+  context->ctx->client_name = main_ctx->client_name;
+
+  /* The notification, conflict resolution and progress callbacks stay
+     NULL:  they are not expected to be thread-safe.  Notifications are
+     collected per external and replayed from the calling thread. */
+
+  *thread_context = context;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_wc_notify_func2_t.  Stash a deep copy of NOTIFY for
+   later replay through the user's callback on the calling thread. */
+static void
+ext_collect_notify_func(void *baton,
+                        const svn_wc_notify_t *notify,
+                        apr_pool_t *scratch_pool)
+{
+  struct ext_collect_notify_baton *cnb = baton;
+
+  APR_ARRAY_PUSH(cnb->notifications, const svn_wc_notify_t *)
+    = svn_wc_dup_notify(notify, cnb->pool);
+}
+
+/* Replay what a worker produced for one external through the user's
+   callbacks, and finish any work that needs the calling thread's
+   client context.  Implements svn_task__output_func_t; runs on the
+   calling thread. */
+static svn_error_t *
+external_item_output_func(svn_task__t *task,
+                          void *result,
+                          void *output_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  struct parallel_ext_baton *pb = output_baton;
+  struct external_item_result *item_result = result;
+  struct external_item_work *work = item_result->work;
+
+  if (item_result->notifications && pb->ctx->notify_func2)
+    {
+      int i;
+
+      for (i = 0; i < item_result->notifications->nelts; i++)
+        pb->ctx->notify_func2(pb->ctx->notify_baton2,
+                              APR_ARRAY_IDX(item_result->notifications, i,
+                                            const svn_wc_notify_t *),
+                              scratch_pool);
+    }
+
+  if (item_result->deferred)
+    {
+      /* A file external:  process it here, under the write lock that
+         our caller holds in the main client context. */
+      SVN_ERR(wrap_external_error(
+                      pb->ctx, work->local_abspath,
+                      handle_external_item_change(pb->ctx,
+                                                  pb->repos_root_url,
+                                                  work->parent_dir_abspath,
+                                                  work->parent_dir_url,
+                                                  work->local_abspath,
+                                                  work->old_defining_abspath,
+                                                  work->new_item,
+                                                  NULL /* ra_session */,
+                                                  pb->timestamp_sleep,
+                                                  scratch_pool),
+                      scratch_pool));
+    }
+  else if (item_result->err)
+    SVN_ERR(wrap_external_error(pb->ctx, work->local_abspath,
+                                item_result->err, scratch_pool));
+
+  if (item_result->sleep)
+    *pb->timestamp_sleep = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Process every external of the group given by PROCESS_BATON over the
+   group's RA session, using the thread's private client context.
+   Implements svn_task__process_func_t; runs on a worker thread. */
+static svn_error_t *
+external_group_process_func(void **result,
+                            svn_task__t *task,
+                            void *thread_context,
+                            void *process_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  struct external_group *group = process_baton;
+  struct ext_thread_context *context = thread_context;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  *result = NULL;
+
+  for (i = 0; i < group->items->nelts; i++)
+    {
+      struct external_item_work *work
+        = APR_ARRAY_IDX(group->items, i, struct external_item_work *);
+      struct external_item_result *item_result
+        = apr_pcalloc(result_pool, sizeof(*item_result));
+      struct ext_collect_notify_baton cnb;
+      svn_ra_session_t *session = group->ra_session;
+      svn_client__pathrev_t *new_loc;
+      const char *new_url;
+      svn_node_kind_t ext_kind;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      item_result->work = work;
+
+      err = resolve_external_item(&new_loc, &new_url, &ext_kind,
+                                  work->new_item, work->pb->repos_root_url,
+                                  work->parent_dir_url, &session,
+                                  context->ctx, iterpool);
+
+      if (!err && ext_kind == svn_node_file)
+        {
+          /* File externals are part of the defining working copy and
+             need the write lock held by the calling thread; hand them
+             back.  The calling thread re-resolves the item, which is
+             cheap compared to transferring it. */
+          item_result->deferred = TRUE;
+        }
+      else if (!err)
+        {
+          cnb.notifications
+            = apr_array_make(result_pool, 16,
+                             sizeof(const svn_wc_notify_t *));
+          cnb.pool = result_pool;
+
+          if (work->pb->ctx->notify_func2)
+            {
+              context->ctx->notify_func2 = ext_collect_notify_func;
+              context->ctx->notify_baton2 = &cnb;
+            }
+
+          err = handle_resolved_item_change(context->ctx,
+                                            work->pb->repos_root_url,
+                                            work->parent_dir_abspath,
+                                            work->local_abspath,
+                                            work->old_defining_abspath,
+                                            work->new_item,
+                                            new_url, new_loc, ext_kind,
+                                            session, &item_result->sleep,
+                                            iterpool);
+
+          context->ctx->notify_func2 = NULL;
+          context->ctx->notify_baton2 = NULL;
+
+          if (cnb.notifications->nelts)
+            item_result->notifications = cnb.notifications;
+        }
+
+      /* Anything but a cancellation is a soft failure of just this
+         external; let the calling thread turn it into a notification. */
+      if (err && err->apr_err == SVN_ERR_CANCELLED)
+        return svn_error_trace(err);
+      item_result->err = err;
+
+      /* Flush this external's result as partial output, so the calling
+         thread can start replaying (and processing deferred file
+         externals) before the whole group is done.  The last result
+         travels as the task result. */
+      if (i < group->items->nelts - 1)
+        SVN_ERR(svn_task__add(task, svn_task__create_process_pool(task),
+                              item_result, NULL, NULL, NULL, NULL));
+      else
+        *result = item_result;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Add one sub-task per external group in PROCESS_BATON.  Implements
+   svn_task__process_func_t for the root task. */
+static svn_error_t *
+parallel_ext_process_func(void **result,
+                          svn_task__t *task,
+                          void *thread_context,
+                          void *process_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *groups = process_baton;
+  int i;
+
+  *result = NULL;
+
+  for (i = 0; i < groups->nelts; i++)
+    {
+      struct external_group *group = APR_ARRAY_IDX(groups, i,
+                                                   struct external_group *);
+
+      SVN_ERR(svn_task__add(task, svn_task__create_process_pool(task),
+                            NULL, external_group_process_func, group,
+                            external_item_output_func, group->pb));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Process the collected externals in ITEMS over up to THREAD_COUNT
+   concurrent RA sessions.  RA_SESSION is the caller's session, reused
+   when the items end up being processed sequentially after all. */
+static svn_error_t *
+run_external_items_in_parallel(apr_array_header_t *items,
+                               const char *repos_root_url,
+                               svn_boolean_t *timestamp_sleep,
+                               apr_int32_t thread_count,
+                               svn_ra_session_t *ra_session,
+                               svn_client_ctx_t *ctx,
+                               apr_pool_t *scratch_pool)
+{
+  struct parallel_ext_baton pb;
+  apr_array_header_t *groups;
+  int group_count;
+  int i;
+
+  /* A single external gains nothing from the task runner. */
+  if (items->nelts == 1)
+    {
+      struct external_item_work *work
+        = APR_ARRAY_IDX(items, 0, struct external_item_work *);
+
+      return svn_error_trace(wrap_external_error(
+                      ctx, work->local_abspath,
+                      handle_external_item_change(ctx, repos_root_url,
+                                                  work->parent_dir_abspath,
+                                                  work->parent_dir_url,
+                                                  work->local_abspath,
+                                                  work->old_defining_abspath,
+                                                  work->new_item, ra_session,
+                                                  timestamp_sleep,
+                                                  scratch_pool),
+                      scratch_pool));
+    }
+
+  pb.ctx = ctx;
+  pb.repos_root_url = repos_root_url;
+  pb.timestamp_sleep = timestamp_sleep;
+
+  for (i = 0; i < items->nelts; i++)
+    APR_ARRAY_IDX(items, i, struct external_item_work *)->pb = &pb;
+
+  group_count = MIN(thread_count, items->nelts);
+  groups = apr_array_make(scratch_pool, group_count,
+                          sizeof(struct external_group *));
+  for (i = 0; i < group_count; i++)
+    {
+      struct external_group *group = apr_pcalloc(scratch_pool,
+                                                 sizeof(*group));
+
+      group->pb = &pb;
+      group->items = apr_array_make(scratch_pool, 4,
+                                    sizeof(struct external_item_work *));
+
+      /* DAV props are disabled on the group sessions so that their
+         callbacks never reach back into the shared wc context from a
+         worker thread. */
+      SVN_ERR(svn_client__open_ra_session_internal(&group->ra_session, NULL,
+                                                   repos_root_url, NULL, NULL,
+                                                   FALSE /* write_dav_props */,
+                                                   FALSE /* read_dav_props */,
+                                                   ctx, scratch_pool,
+                                                   scratch_pool));
+      APR_ARRAY_PUSH(groups, struct external_group *) = group;
+    }
+
+  for (i = 0; i < items->nelts; i++)
+    {
+      struct external_group *group = APR_ARRAY_IDX(groups, i % group_count,
+                                                   struct external_group *);
+
+      APR_ARRAY_PUSH(group->items, struct external_item_work *)
+        = APR_ARRAY_IDX(items, i, struct external_item_work *);
+    }
+
+  return svn_error_trace(svn_task__run(thread_count,
+                                       parallel_ext_process_func, groups,
+                                       NULL, NULL,
+                                       ext_context_constructor, ctx,
+                                       ctx->cancel_func, ctx->cancel_baton,
+                                       scratch_pool, scratch_pool));
+}
+
+
+/* Handle the changed externals defined on LOCAL_ABSPATH.  If
+   PARALLEL_ITEMS is NULL, process each changed item on the spot;
+   otherwise collect the items into PARALLEL_ITEMS (allocated in that
+   array's pool) for a later run_external_items_in_parallel(). */
 static svn_error_t *
 handle_externals_change(svn_client_ctx_t *ctx,
                         const char *repos_root_url,
@@ -970,6 +1454,7 @@ handle_externals_change(svn_client_ctx_t *ctx,
                         svn_depth_t ambient_depth,
                         svn_depth_t requested_depth,
                         svn_ra_session_t *ra_session,
+                        apr_array_header_t *parallel_items,
                         apr_pool_t *scratch_pool)
 {
   apr_array_header_t *new_desc;
@@ -1031,7 +1516,25 @@ handle_externals_change(svn_client_ctx_t *ctx,
 
       old_defining_abspath = svn_hash_gets(old_externals, target_abspath);
 
-      SVN_ERR(wrap_external_error(
+      if (parallel_items)
+        {
+          apr_pool_t *items_pool = parallel_items->pool;
+          struct external_item_work *work = apr_pcalloc(items_pool,
+                                                        sizeof(*work));
+
+          work->parent_dir_abspath = apr_pstrdup(items_pool, local_abspath);
+          work->parent_dir_url = apr_pstrdup(items_pool, url);
+          work->local_abspath = apr_pstrdup(items_pool, target_abspath);
+          work->old_defining_abspath
+            = old_defining_abspath
+              ? apr_pstrdup(items_pool, old_defining_abspath)
+              : NULL;
+          work->new_item = svn_wc_external_item2_dup(new_item, items_pool);
+
+          APR_ARRAY_PUSH(parallel_items, struct external_item_work *) = work;
+        }
+      else
+        SVN_ERR(wrap_external_error(
                       ctx, target_abspath,
                       handle_external_item_change(ctx,
                                                   repos_root_url,
@@ -1068,11 +1571,26 @@ svn_client__handle_externals(apr_hash_t *externals_new,
   apr_hash_t *old_external_defs;
   apr_hash_index_t *hi;
   apr_pool_t *iterpool;
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+  apr_int64_t thread_count64;
+  apr_int32_t thread_count;
+  apr_array_header_t *parallel_items = NULL;
 
   SVN_ERR_ASSERT(repos_root_url);
 
   iterpool = svn_pool_create(scratch_pool);
 
+  /* How many RA sessions may fetch externals concurrently? */
+  SVN_ERR(svn_config_get_int64(cfg, &thread_count64,
+                               SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_WORKER_THREADS, 1));
+  thread_count = thread_count64 > 1 ? (apr_int32_t)thread_count64 : 1;
+  if (thread_count > 1)
+    parallel_items = apr_array_make(scratch_pool, 16,
+                                    sizeof(struct external_item_work *));
+
   SVN_ERR(svn_wc__externals_defined_below(&old_external_defs,
                                           ctx->wc_ctx, target_abspath,
                                           scratch_pool, iterpool));
@@ -1111,9 +1629,14 @@ svn_client__handle_externals(apr_hash_t *externals_new,
                                       local_abspath,
                                       desc_text, old_external_defs,
                                       ambient_depth, requested_depth,
-                                      ra_session, iterpool));
+                                      ra_session, parallel_items, iterpool));
     }
 
+  if (parallel_items && parallel_items->nelts > 0)
+    SVN_ERR(run_external_items_in_parallel(parallel_items, repos_root_url,
+                                           timestamp_sleep, thread_count,
+                                           ra_session, ctx, scratch_pool));
+
   /* Remove the remaining externals */
   for (hi = apr_hash_first(scratch_pool, old_external_defs);
        hi;
@@ -45,10 +45,12 @@
 #include "svn_io.h"
 #include "svn_sorts.h"
 #include "svn_props.h"
+#include "svn_config.h"
 
 #include "client.h"
 #include "private/svn_ra_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_task.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_magic.h"
 
@@ -103,29 +105,22 @@ open_txdelta_stream(svn_txdelta_stream_t **txdelta_stream_p,
   return SVN_NO_ERROR;
 }
 
-/* Apply LOCAL_ABSPATH's contents (as a delta against the empty string) to
-   FILE_BATON in EDITOR.  Use POOL for any temporary allocation.
-   PROPERTIES is the set of node properties set on this file.
-
-   Return the resulting checksum in *RESULT_MD5_CHECKSUM_P. */
-
-/* ### how does this compare against svn_wc_transmit_text_deltas2() ??? */
-
+/* Set *CONTENTS_P to a read stream yielding LOCAL_ABSPATH's contents in
+   repository-normal form:  detranslated according to the EOL-style and
+   keywords in PROPERTIES and, if SPECIAL is set, dereferenced into the
+   special file's representation.  Allocate the stream in POOL. */
 static svn_error_t *
-send_file_contents(svn_checksum_t **result_md5_checksum_p,
-                   const char *local_abspath,
-                   void *file_baton,
-                   const svn_delta_editor_t *editor,
-                   apr_hash_t *properties,
-                   apr_pool_t *pool)
+get_import_file_contents(svn_stream_t **contents_p,
+                         const char *local_abspath,
+                         apr_hash_t *properties,
+                         svn_boolean_t special,
+                         apr_pool_t *pool)
 {
   svn_stream_t *contents;
   const svn_string_t *eol_style_val = NULL, *keywords_val = NULL;
-  svn_boolean_t special = FALSE;
   svn_subst_eol_style_t eol_style;
   const char *eol;
   apr_hash_t *keywords;
-  open_txdelta_stream_baton_t baton = { 0 };
 
   /* If there are properties, look for EOL-style and keywords ones. */
   if (properties)
@@ -134,8 +129,6 @@ send_file_contents(svn_checksum_t **result_md5_checksum_p,
                                    sizeof(SVN_PROP_EOL_STYLE) - 1);
       keywords_val = apr_hash_get(properties, SVN_PROP_KEYWORDS,
                                   sizeof(SVN_PROP_KEYWORDS) - 1);
-      if (svn_hash_gets(properties, SVN_PROP_SPECIAL))
-        special = TRUE;
     }
 
   if (eol_style_val)
@@ -191,6 +184,34 @@ send_file_contents(svn_checksum_t **result_md5_checksum_p,
         }
     }
 
+  *contents_p = contents;
+  return SVN_NO_ERROR;
+}
+
+/* Apply LOCAL_ABSPATH's contents (as a delta against the empty string) to
+   FILE_BATON in EDITOR.  Use POOL for any temporary allocation.
+   PROPERTIES is the set of node properties set on this file.
+
+   Return the resulting checksum in *RESULT_MD5_CHECKSUM_P. */
+
+/* ### how does this compare against svn_wc_transmit_text_deltas2() ??? */
+
+static svn_error_t *
+send_file_contents(svn_checksum_t **result_md5_checksum_p,
+                   const char *local_abspath,
+                   void *file_baton,
+                   const svn_delta_editor_t *editor,
+                   apr_hash_t *properties,
+                   apr_pool_t *pool)
+{
+  svn_stream_t *contents;
+  svn_boolean_t special = properties
+                          && svn_hash_gets(properties, SVN_PROP_SPECIAL);
+  open_txdelta_stream_baton_t baton = { 0 };
+
+  SVN_ERR(get_import_file_contents(&contents, local_abspath, properties,
+                                   special, pool));
+
   /* Arrange the stream to calculate the resulting MD5. */
   contents = svn_stream_checksummed2(contents, result_md5_checksum_p, NULL,
                                      svn_checksum_md5, TRUE, pool);
@@ -605,6 +626,666 @@ import_dir(const svn_delta_editor_t *editor,
 }
 
 
+/*** The pipelined import. ***/
+
+/* A sequential import reads each file from disk while the commit editor
+ * waits, so the editor drive alternates between local I/O and network
+ * writes.  The pipelined import overlaps the two:
+ *
+ *   - The tree is scanned up front on the calling thread, applying the
+ *     same filtering, ignore handling and auto-props lookups as the
+ *     recursive import, and produces an ordered list of operations
+ *     (directory opens and closes, and file sends).
+ *
+ *   - The operations are split into windows of a bounded number of
+ *     prefetchable bytes.  Each window becomes one run on the shared
+ *     task runner:  worker threads read upcoming files and detranslate
+ *     them to repository-normal form into memory buffers, while the
+ *     calling thread replays the completed operations in order and
+ *     drives the commit editor with the buffered contents.
+ *
+ *   - Files larger than the per-file prefetch limit are not buffered;
+ *     the calling thread streams them straight from disk, exactly like
+ *     the sequential import does.
+ *
+ * Since a delta against the empty base is a plain copy of the contents,
+ * buffering the repository-normal text *is* the prefetched delta; the
+ * window chunking of svn_txdelta() over a memory buffer is trivial.
+ * The windowing keeps the look-ahead memory bounded no matter how far
+ * the workers get ahead of the network. */
+
+/* Per-file cap on prefetching:  larger files are streamed from disk by
+   the calling thread instead of being buffered. */
+#define IMPORT_PREFETCH_FILE_LIMIT (16 * 1024 * 1024)
+
+/* Upper bound on the prefetched bytes buffered by one task run. */
+#define IMPORT_PREFETCH_WINDOW_LIMIT (64 * 1024 * 1024)
+
+enum import_op_kind
+{
+  import_op_dir_open,
+  import_op_dir_close,
+  import_op_file
+};
+
+/* One step of the editor drive, produced by the scan. */
+struct import_op
+{
+  enum import_op_kind kind;
+
+  /* The node's on-disk path and its path relative to the edit root.
+     NULL for import_op_dir_close. */
+  const char *local_abspath;
+  const char *edit_path;
+
+  /* The remaining fields are only used for import_op_file. */
+
+  /* The file's auto-props (empty for special files), the mime-type
+     derived from them, and whether the file is special. */
+  apr_hash_t *properties;
+  const char *mimetype;
+  svn_boolean_t special;
+
+  svn_filesize_t filesize;
+};
+
+/* Would the prefetcher buffer OP's contents? */
+#define IMPORT_OP_PREFETCHABLE(op) \
+  ((op)->special || (op)->filesize <= IMPORT_PREFETCH_FILE_LIMIT)
+
+/* The state of the editor drive, only ever touched on the calling
+   thread. */
+struct import_drive_baton
+{
+  const svn_delta_editor_t *editor;
+  import_ctx_t *import_ctx;
+  svn_client_ctx_t *ctx;
+
+  /* The currently open directories, outermost first.  The first frame
+     is the drive's root baton and is never closed by the drive.
+     Of struct import_dir_frame *. */
+  apr_array_header_t *dir_stack;
+
+  /* The pool the stack frames are allocated in. */
+  apr_pool_t *pool;
+};
+
+/* One open directory of the editor drive. */
+struct import_dir_frame
+{
+  void *baton;
+
+  /* The pool the directory baton lives in; destroyed when the
+     directory is closed.  NULL for the root frame. */
+  apr_pool_t *pool;
+};
+
+/* What the prefetch task for one file hands to the output function. */
+struct import_file_result
+{
+  struct import_op *op;
+
+  /* The file's repository-normal contents, or NULL if the file was
+     over the prefetch limit and is to be streamed from disk. */
+  const svn_string_t *contents;
+
+  /* The MD5 of *CONTENTS; NULL iff CONTENTS is NULL. */
+  svn_checksum_t *md5_checksum;
+};
+
+/* Baton for import_prefetch_process_func(). */
+struct import_file_task
+{
+  struct import_op *op;
+  struct import_drive_baton *db;
+};
+
+/* Append a file operation for LOCAL_ABSPATH (imported as EDIT_PATH) to
+   OPS, resolving its auto-props on the spot.  DIRENT is its on-disk
+   dirent.  Allocate the operation in OPS' pool; use SCRATCH_POOL for
+   temporary allocations. */
+static svn_error_t *
+scan_file(apr_array_header_t *ops,
+          const char *local_abspath,
+          const char *edit_path,
+          const svn_io_dirent2_t *dirent,
+          import_ctx_t *import_ctx,
+          svn_client_ctx_t *ctx,
+          apr_pool_t *scratch_pool)
+{
+  apr_pool_t *ops_pool = ops->pool;
+  struct import_op *op = apr_pcalloc(ops_pool, sizeof(*op));
+
+  SVN_ERR(svn_path_check_valid(local_abspath, scratch_pool));
+
+  op->kind = import_op_file;
+  op->local_abspath = apr_pstrdup(ops_pool, local_abspath);
+  op->edit_path = apr_pstrdup(ops_pool, edit_path);
+  op->special = dirent->special;
+  op->filesize = dirent->filesize;
+
+  if (! dirent->special)
+    SVN_ERR(svn_client__get_paths_auto_props(&op->properties, &op->mimetype,
+                                             local_abspath,
+                                             import_ctx->magic_cookie,
+                                             import_ctx->autoprops,
+                                             ctx, ops_pool, scratch_pool));
+  else
+    op->properties = apr_hash_make(ops_pool);
+
+  APR_ARRAY_PUSH(ops, struct import_op *) = op;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+scan_dir(apr_array_header_t *ops,
+         const char *local_abspath,
+         const char *edit_path,
+         svn_depth_t depth,
+         apr_hash_t *excludes,
+         apr_array_header_t *global_ignores,
+         svn_boolean_t ignore_unknown_node_types,
+         svn_client_import_filter_func_t filter_callback,
+         void *filter_baton,
+         import_ctx_t *import_ctx,
+         svn_client_ctx_t *ctx,
+         apr_pool_t *scratch_pool);
+
+/* Append the operations for importing the children DIRENTS of
+   DIR_ABSPATH (imported as EDIT_PATH) to OPS.  The filtering mirrors
+   import_children(), but nothing is sent yet:  skipped nodes are
+   notified right away, everything else becomes an operation. */
+static svn_error_t *
+scan_children(apr_array_header_t *ops,
+              const char *dir_abspath,
+              const char *edit_path,
+              apr_hash_t *dirents,
+              svn_depth_t depth,
+              apr_hash_t *excludes,
+              apr_array_header_t *global_ignores,
+              svn_boolean_t ignore_unknown_node_types,
+              svn_client_import_filter_func_t filter_callback,
+              void *filter_baton,
+              import_ctx_t *import_ctx,
+              svn_client_ctx_t *ctx,
+              apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *sorted_dirents;
+  int i;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  sorted_dirents = svn_sort__hash(dirents, svn_sort_compare_items_lexically,
+                                  scratch_pool);
+  for (i = 0; i < sorted_dirents->nelts; i++)
+    {
+      const char *this_abspath, *this_edit_path;
+      svn_sort__item_t item = APR_ARRAY_IDX(sorted_dirents, i,
+                                            svn_sort__item_t);
+      const char *filename = item.key;
+      const svn_io_dirent2_t *dirent = item.value;
+
+      svn_pool_clear(iterpool);
+
+      if (ctx->cancel_func)
+        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
+
+      this_abspath = svn_dirent_join(dir_abspath, filename, iterpool);
+      this_edit_path = svn_relpath_join(edit_path, filename, iterpool);
+
+      if (dirent->kind == svn_node_dir && depth >= svn_depth_immediates)
+        {
+          svn_depth_t depth_below_here = depth;
+          if (depth == svn_depth_immediates)
+            depth_below_here = svn_depth_empty;
+
+          SVN_ERR(scan_dir(ops, this_abspath, this_edit_path,
+                           depth_below_here, excludes, global_ignores,
+                           ignore_unknown_node_types, filter_callback,
+                           filter_baton, import_ctx, ctx, iterpool));
+        }
+      else if (dirent->kind == svn_node_file && depth >= svn_depth_files)
+        {
+          SVN_ERR(scan_file(ops, this_abspath, this_edit_path, dirent,
+                            import_ctx, ctx, iterpool));
+        }
+      else if (dirent->kind != svn_node_dir && dirent->kind != svn_node_file)
+        {
+          if (ignore_unknown_node_types)
+            {
+              /*## warn about it*/
+              if (ctx->notify_func2)
+                {
+                  svn_wc_notify_t *notify
+                    = svn_wc_create_notify(this_abspath,
+                                           svn_wc_notify_skip, iterpool);
+                  notify->kind = svn_node_dir;
+                  notify->content_state = notify->prop_state
+                    = svn_wc_notify_state_inapplicable;
+                  notify->lock_state = svn_wc_notify_lock_state_inapplicable;
+                  ctx->notify_func2(ctx->notify_baton2, notify, iterpool);
+                }
+            }
+          else
+            return svn_error_createf
+              (SVN_ERR_NODE_UNKNOWN_KIND, NULL,
+               _("Unknown or unversionable type for '%s'"),
+               svn_dirent_local_style(this_abspath, iterpool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Append the operations for importing the directory LOCAL_ABSPATH
+   (imported as EDIT_PATH) and its children to OPS; the counterpart of
+   import_dir(). */
+static svn_error_t *
+scan_dir(apr_array_header_t *ops,
+         const char *local_abspath,
+         const char *edit_path,
+         svn_depth_t depth,
+         apr_hash_t *excludes,
+         apr_array_header_t *global_ignores,
+         svn_boolean_t ignore_unknown_node_types,
+         svn_client_import_filter_func_t filter_callback,
+         void *filter_baton,
+         import_ctx_t *import_ctx,
+         svn_client_ctx_t *ctx,
+         apr_pool_t *scratch_pool)
+{
+  apr_pool_t *ops_pool = ops->pool;
+  apr_hash_t *dirents;
+  struct import_op *op;
+
+  SVN_ERR(svn_path_check_valid(local_abspath, scratch_pool));
+  SVN_ERR(get_filtered_children(&dirents, local_abspath, excludes, NULL,
+                                global_ignores, filter_callback,
+                                filter_baton, ctx, scratch_pool,
+                                scratch_pool));
+
+  op = apr_pcalloc(ops_pool, sizeof(*op));
+  op->kind = import_op_dir_open;
+  op->local_abspath = apr_pstrdup(ops_pool, local_abspath);
+  op->edit_path = apr_pstrdup(ops_pool, edit_path);
+  APR_ARRAY_PUSH(ops, struct import_op *) = op;
+
+  SVN_ERR(scan_children(ops, local_abspath, edit_path, dirents, depth,
+                        excludes, global_ignores,
+                        ignore_unknown_node_types, filter_callback,
+                        filter_baton, import_ctx, ctx, scratch_pool));
+
+  op = apr_pcalloc(ops_pool, sizeof(*op));
+  op->kind = import_op_dir_close;
+  APR_ARRAY_PUSH(ops, struct import_op *) = op;
+
+  return SVN_NO_ERROR;
+}
+
+/* Perform the directory operation OP on the editor drive DB. */
+static svn_error_t *
+apply_dir_op(struct import_drive_baton *db,
+             const struct import_op *op,
+             apr_pool_t *scratch_pool)
+{
+  if (op->kind == import_op_dir_open)
+    {
+      struct import_dir_frame *parent
+        = APR_ARRAY_IDX(db->dir_stack, db->dir_stack->nelts - 1,
+                        struct import_dir_frame *);
+      struct import_dir_frame *frame = apr_pcalloc(db->pool,
+                                                   sizeof(*frame));
+
+      frame->pool = svn_pool_create(db->pool);
+      SVN_ERR(db->editor->add_directory(op->edit_path, parent->baton,
+                                        NULL, SVN_INVALID_REVNUM,
+                                        frame->pool, &frame->baton));
+      APR_ARRAY_PUSH(db->dir_stack, struct import_dir_frame *) = frame;
+
+      db->import_ctx->repos_changed = TRUE;
+
+      if (db->ctx->notify_func2)
+        {
+          svn_wc_notify_t *notify
+            = svn_wc_create_notify(op->local_abspath,
+                                   svn_wc_notify_commit_added,
+                                   scratch_pool);
+          notify->kind = svn_node_dir;
+          notify->content_state = notify->prop_state
+            = svn_wc_notify_state_inapplicable;
+          notify->lock_state = svn_wc_notify_lock_state_inapplicable;
+          db->ctx->notify_func2(db->ctx->notify_baton2, notify,
+                                scratch_pool);
+        }
+    }
+  else
+    {
+      struct import_dir_frame *frame
+        = APR_ARRAY_IDX(db->dir_stack, db->dir_stack->nelts - 1,
+                        struct import_dir_frame *);
+
+      SVN_ERR(db->editor->close_directory(frame->baton, scratch_pool));
+      apr_array_pop(db->dir_stack);
+      svn_pool_destroy(frame->pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Replay the directory operations RESULT holds (of struct import_op *).
+   Implements svn_task__output_func_t for a window task; runs on the
+   calling thread. */
+static svn_error_t *
+import_ops_output_func(svn_task__t *task,
+                       void *result,
+                       void *output_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  struct import_drive_baton *db = output_baton;
+  apr_array_header_t *ops = result;
+  int i;
+
+  for (i = 0; i < ops->nelts; i++)
+    SVN_ERR(apply_dir_op(db, APR_ARRAY_IDX(ops, i, struct import_op *),
+                         scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Read and detranslate the file given by PROCESS_BATON into a memory
+   buffer, unless it exceeds the prefetch limit.  Implements
+   svn_task__process_func_t; runs on a worker thread. */
+static svn_error_t *
+import_prefetch_process_func(void **result,
+                             svn_task__t *task,
+                             void *thread_context,
+                             void *process_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  struct import_file_task *ft = process_baton;
+  struct import_op *op = ft->op;
+  struct import_file_result *fr = apr_pcalloc(result_pool, sizeof(*fr));
+
+  fr->op = op;
+  *result = fr;
+
+  if (IMPORT_OP_PREFETCHABLE(op))
+    {
+      svn_stream_t *contents;
+      svn_string_t *text;
+
+      SVN_ERR(get_import_file_contents(&contents, op->local_abspath,
+                                       op->properties, op->special,
+                                       scratch_pool));
+      SVN_ERR(svn_string_from_stream2(&text, contents,
+                                      (apr_size_t)op->filesize,
+                                      result_pool));
+      SVN_ERR(svn_checksum(&fr->md5_checksum, svn_checksum_md5,
+                           text->data, text->len, result_pool));
+      fr->contents = text;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the file RESULT describes through the commit editor, using the
+   prefetched contents when the worker buffered them.  Implements
+   svn_task__output_func_t; runs on the calling thread, mirroring
+   import_file(). */
+static svn_error_t *
+import_file_output_func(svn_task__t *task,
+                        void *result,
+                        void *output_baton,
+                        svn_cancel_func_t cancel_func,
+                        void *cancel_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  struct import_drive_baton *db = output_baton;
+  struct import_file_result *fr = result;
+  struct import_op *op = fr->op;
+  struct import_dir_frame *parent
+    = APR_ARRAY_IDX(db->dir_stack, db->dir_stack->nelts - 1,
+                    struct import_dir_frame *);
+  svn_checksum_t *result_md5_checksum;
+  void *file_baton;
+  apr_hash_index_t *hi;
+
+  SVN_ERR(db->editor->add_file(op->edit_path, parent->baton, NULL,
+                               SVN_INVALID_REVNUM, scratch_pool,
+                               &file_baton));
+
+  db->import_ctx->repos_changed = TRUE;
+
+  if (op->properties)
+    {
+      for (hi = apr_hash_first(scratch_pool, op->properties);
+           hi;
+           hi = apr_hash_next(hi))
+        {
+          const char *pname = apr_hash_this_key(hi);
+          const svn_string_t *pval = apr_hash_this_val(hi);
+
+          SVN_ERR(db->editor->change_file_prop(file_baton, pname, pval,
+                                               scratch_pool));
+        }
+    }
+
+  if (db->ctx->notify_func2)
+    {
+      svn_wc_notify_t *notify
+        = svn_wc_create_notify(op->local_abspath,
+                               svn_wc_notify_commit_added, scratch_pool);
+      notify->kind = svn_node_file;
+      notify->mime_type = op->mimetype;
+      notify->content_state = notify->prop_state
+        = svn_wc_notify_state_inapplicable;
+      notify->lock_state = svn_wc_notify_lock_state_inapplicable;
+      db->ctx->notify_func2(db->ctx->notify_baton2, notify, scratch_pool);
+    }
+
+  if (op->special)
+    {
+      svn_hash_sets(op->properties, SVN_PROP_SPECIAL,
+                    svn_string_create(SVN_PROP_BOOLEAN_TRUE, scratch_pool));
+      SVN_ERR(db->editor->change_file_prop(file_baton, SVN_PROP_SPECIAL,
+                                           svn_hash_gets(op->properties,
+                                                         SVN_PROP_SPECIAL),
+                                           scratch_pool));
+    }
+
+  if (fr->contents)
+    {
+      open_txdelta_stream_baton_t baton = { 0 };
+
+      baton.need_reset = FALSE;
+      baton.stream = svn_stream_from_string(fr->contents, scratch_pool);
+      SVN_ERR(db->editor->apply_textdelta_stream(db->editor, file_baton,
+                                                 NULL, open_txdelta_stream,
+                                                 &baton, scratch_pool));
+      result_md5_checksum = fr->md5_checksum;
+    }
+  else
+    {
+      /* Over the prefetch limit:  stream it from disk, like the
+         sequential import would. */
+      SVN_ERR(send_file_contents(&result_md5_checksum, op->local_abspath,
+                                 file_baton, db->editor, op->properties,
+                                 scratch_pool));
+    }
+
+  return svn_error_trace(db->editor->close_file(
+                           file_baton,
+                           svn_checksum_to_cstring(result_md5_checksum,
+                                                   scratch_pool),
+                           scratch_pool));
+}
+
+/* Baton for import_window_process_func(). */
+struct import_window
+{
+  /* The operation list and the window's range within it. */
+  apr_array_header_t *ops;
+  int first;
+  int after_last;
+
+  struct import_drive_baton *db;
+};
+
+/* Add one prefetch sub-task per file in the window given by
+   PROCESS_BATON, passing the directory operations in between through
+   as partial output.  Implements svn_task__process_func_t for a
+   window's root task. */
+static svn_error_t *
+import_window_process_func(void **result,
+                           svn_task__t *task,
+                           void *thread_context,
+                           void *process_baton,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  struct import_window *window = process_baton;
+  apr_array_header_t *pending_ops
+    = apr_array_make(result_pool, 8, sizeof(struct import_op *));
+  int i;
+
+  *result = NULL;
+
+  for (i = window->first; i < window->after_last; i++)
+    {
+      struct import_op *op = APR_ARRAY_IDX(window->ops, i,
+                                           struct import_op *);
+
+      if (op->kind == import_op_file)
+        {
+          apr_pool_t *process_pool = svn_task__create_process_pool(task);
+          struct import_file_task *ft = apr_pcalloc(process_pool,
+                                                    sizeof(*ft));
+
+          ft->op = op;
+          ft->db = window->db;
+
+          SVN_ERR(svn_task__add(task, process_pool,
+                                pending_ops->nelts ? pending_ops : NULL,
+                                import_prefetch_process_func, ft,
+                                import_file_output_func, window->db));
+          pending_ops = apr_array_make(result_pool, 8,
+                                       sizeof(struct import_op *));
+        }
+      else
+        APR_ARRAY_PUSH(pending_ops, struct import_op *) = op;
+    }
+
+  if (pending_ops->nelts)
+    *result = pending_ops;
+
+  return SVN_NO_ERROR;
+}
+
+/* Import the children DIRENTS of LOCAL_ABSPATH (imported as EDIT_PATH
+   with the editor directory baton ROOT_BATON) through DB->editor with
+   up to THREAD_COUNT prefetching worker threads; the pipelined
+   counterpart of import_children(). */
+static svn_error_t *
+import_children_pipelined(const svn_delta_editor_t *editor,
+                          void *root_baton,
+                          const char *local_abspath,
+                          const char *edit_path,
+                          apr_hash_t *dirents,
+                          svn_depth_t depth,
+                          apr_hash_t *excludes,
+                          apr_array_header_t *global_ignores,
+                          svn_boolean_t ignore_unknown_node_types,
+                          svn_client_import_filter_func_t filter_callback,
+                          void *filter_baton,
+                          import_ctx_t *import_ctx,
+                          svn_client_ctx_t *ctx,
+                          apr_int32_t thread_count,
+                          apr_pool_t *pool)
+{
+  apr_array_header_t *ops = apr_array_make(pool, 256,
+                                           sizeof(struct import_op *));
+  struct import_drive_baton db;
+  struct import_dir_frame *root_frame;
+  int i;
+
+  SVN_ERR(scan_children(ops, local_abspath, edit_path, dirents, depth,
+                        excludes, global_ignores,
+                        ignore_unknown_node_types, filter_callback,
+                        filter_baton, import_ctx, ctx, pool));
+
+  db.editor = editor;
+  db.import_ctx = import_ctx;
+  db.ctx = ctx;
+  db.pool = pool;
+  db.dir_stack = apr_array_make(pool, 16,
+                                sizeof(struct import_dir_frame *));
+  root_frame = apr_pcalloc(pool, sizeof(*root_frame));
+  root_frame->baton = root_baton;
+  APR_ARRAY_PUSH(db.dir_stack, struct import_dir_frame *) = root_frame;
+
+  /* Process the operations in windows of a bounded prefetch volume. */
+  i = 0;
+  while (i < ops->nelts)
+    {
+      struct import_window window;
+      svn_filesize_t prefetch_bytes = 0;
+      svn_boolean_t any_files = FALSE;
+      int j;
+
+      for (j = i; j < ops->nelts; j++)
+        {
+          struct import_op *op = APR_ARRAY_IDX(ops, j, struct import_op *);
+
+          if (op->kind == import_op_file)
+            {
+              any_files = TRUE;
+              if (IMPORT_OP_PREFETCHABLE(op))
+                prefetch_bytes += op->filesize;
+              if (prefetch_bytes > IMPORT_PREFETCH_WINDOW_LIMIT)
+                {
+                  j++;
+                  break;
+                }
+            }
+        }
+
+      if (!any_files)
+        {
+          /* Only directory operations remain; no point in a task run. */
+          for (; i < j; i++)
+            SVN_ERR(apply_dir_op(&db, APR_ARRAY_IDX(ops, i,
+                                                    struct import_op *),
+                                 pool));
+          continue;
+        }
+
+      window.ops = ops;
+      window.first = i;
+      window.after_last = j;
+      window.db = &db;
+
+      SVN_ERR(svn_task__run(thread_count,
+                            import_window_process_func, &window,
+                            import_ops_output_func, &db,
+                            NULL, NULL,
+                            ctx->cancel_func, ctx->cancel_baton,
+                            pool, pool));
+      i = j;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Recursively import LOCAL_ABSPATH to a repository using EDITOR and
  * EDIT_BATON.  LOCAL_ABSPATH can be a file or directory.
  *
@@ -654,6 +1335,11 @@ import_dir(const svn_delta_editor_t *editor,
  *
  * URL is used only in the 'commit_finalizing' notification.
  *
+ * If THREAD_COUNT is larger than 1 and LOCAL_ABSPATH is a directory,
+ * pipeline the import:  prefetch and detranslate upcoming files on up
+ * to that many worker threads while the editor drive streams the
+ * earlier ones out.
+ *
  * Use POOL for any temporary allocation.
  *
  * Note: the repository directory receiving the import was specified
@@ -679,6 +1365,7 @@ import(svn_boolean_t *updated_repository,
        svn_boolean_t ignore_unknown_node_types,
        svn_client_import_filter_func_t filter_callback,
        void *filter_baton,
+       apr_int32_t thread_count,
        svn_client_ctx_t *ctx,
        apr_pool_t *pool)
 {
@@ -773,11 +1460,20 @@ import(svn_boolean_t *updated_repository,
                                     filter_callback, filter_baton, ctx,
                                     pool, pool));
 
-      SVN_ERR(import_children(local_abspath, edit_path, dirents, editor,
-                              root_baton, depth, excludes, global_ignores,
-                              no_ignore, no_autoprops,
-                              ignore_unknown_node_types, filter_callback,
-                              filter_baton, &import_ctx, ctx, pool));
+      if (thread_count > 1)
+        SVN_ERR(import_children_pipelined(editor, root_baton, local_abspath,
+                                          edit_path, dirents, depth,
+                                          excludes, global_ignores,
+                                          ignore_unknown_node_types,
+                                          filter_callback, filter_baton,
+                                          &import_ctx, ctx, thread_count,
+                                          pool));
+      else
+        SVN_ERR(import_children(local_abspath, edit_path, dirents, editor,
+                                root_baton, depth, excludes, global_ignores,
+                                no_ignore, no_autoprops,
+                                ignore_unknown_node_types, filter_callback,
+                                filter_baton, &import_ctx, ctx, pool));
 
     }
   else if (dirent->kind == svn_node_none
@@ -855,6 +1551,11 @@ svn_client_import5(const char *path,
   apr_array_header_t *inherited_props = NULL;
   apr_hash_t *url_props = NULL;
   svn_boolean_t updated_repository;
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+  apr_int64_t thread_count64;
+  apr_int32_t thread_count;
 
   if (svn_path_is_url(path))
     return svn_error_createf(SVN_ERR_ILLEGAL_TARGET, NULL,
@@ -1018,6 +1719,13 @@ svn_client_import5(const char *path,
         }
     }
 
+  /* How many worker threads may prefetch file contents while the
+     commit editor streams? */
+  SVN_ERR(svn_config_get_int64(cfg, &thread_count64,
+                               SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_WORKER_THREADS, 1));
+  thread_count = thread_count64 > 1 ? (apr_int32_t)thread_count64 : 1;
+
   /* If an error occurred during the commit, properly abort the edit.  */
   err = svn_error_trace(import(&updated_repository,
                                local_abspath, url, new_entries, editor,
@@ -1025,7 +1733,7 @@ svn_client_import5(const char *path,
                                autoprops, local_ignores_arr, global_ignores,
                                no_ignore, no_autoprops,
                                ignore_unknown_node_types, filter_callback,
-                               filter_baton, ctx, iterpool));
+                               filter_baton, thread_count, ctx, iterpool));
 
   svn_pool_destroy(iterpool);
 
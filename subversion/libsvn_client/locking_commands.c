@@ -49,6 +49,13 @@ struct lock_baton
   apr_hash_t *urls_to_paths; /* url -> abspath */
   const char *base_url;
   svn_client_ctx_t *ctx;
+
+  /* Locks to store in resp. remove from the working copy once the
+     whole RA exchange has finished, so that all of them can be written
+     in a single working copy transaction instead of one per path. */
+  apr_hash_t *locks_to_store;          /* abspath -> svn_lock_t * */
+  apr_array_header_t *paths_to_unlock; /* abspath */
+
   apr_pool_t *pool;
 };
 
@@ -57,11 +64,13 @@ struct lock_baton
  * BATON is a 'struct lock_baton *', PATH is the path being locked,
  * and LOCK is the lock itself.
  *
- * If BATON->urls_to_paths is not null, then this function either
- * stores the LOCK on REL_URL or removes any lock tokens from REL_URL
- * (depending on whether DO_LOCK is true or false respectively), but
- * only if RA_ERR is null, or (in the unlock case) is something other
- * than SVN_ERR_FS_LOCK_OWNER_MISMATCH.
+ * If BATON->urls_to_paths is not null, then this function schedules
+ * the LOCK on REL_URL for storage or any lock tokens on REL_URL for
+ * removal (depending on whether DO_LOCK is true or false
+ * respectively), but only if RA_ERR is null, or (in the unlock case)
+ * is something other than SVN_ERR_FS_LOCK_OWNER_MISMATCH.  The caller
+ * performs the scheduled working copy changes in one batch after the
+ * RA exchange has finished.
  *
  * Implements svn_ra_lock_callback_t.
  */
@@ -100,8 +109,11 @@ store_locks_callback(void *baton,
         {
           if (!ra_err && lock)
             {
-              SVN_ERR(svn_wc_add_lock2(lb->ctx->wc_ctx, local_abspath, lock,
-                                       lb->pool));
+              /* Defer the actual working copy write; the caller stores
+                 all received tokens in one batch after the exchange. */
+              svn_hash_sets(lb->locks_to_store,
+                            apr_pstrdup(lb->pool, local_abspath),
+                            svn_lock_dup(lock, lb->pool));
               notify->lock_state = svn_wc_notify_lock_state_locked;
             }
           else
@@ -119,8 +131,9 @@ store_locks_callback(void *baton,
               (ra_err && (ra_err->apr_err != SVN_ERR_FS_LOCK_OWNER_MISMATCH
                           && ra_err->apr_err != SVN_ERR_REPOS_HOOK_FAILURE)))
             {
-              SVN_ERR(svn_wc_remove_lock2(lb->ctx->wc_ctx, local_abspath,
-                                          lb->pool));
+              /* As above, the caller removes all tokens in one batch. */
+              APR_ARRAY_PUSH(lb->paths_to_unlock, const char *)
+                = apr_pstrdup(lb->pool, local_abspath);
               notify->lock_state = svn_wc_notify_lock_state_unlocked;
             }
           else
@@ -549,12 +562,21 @@ svn_client_lock(const apr_array_header_t *targets,
   cb.base_url = common_parent_url;
   cb.urls_to_paths = urls_to_paths;
   cb.ctx = ctx;
+  cb.locks_to_store = apr_hash_make(pool);
+  cb.paths_to_unlock = NULL;
   cb.pool = pool;
 
   /* Lock the paths. */
   err = svn_ra_lock(ra_session, path_revs, comment,
                     steal_lock, store_locks_callback, &cb, pool);
 
+  /* Store all received lock tokens in a single working copy
+     transaction.  Do so even on error; the server may have granted
+     some of the locks before failing. */
+  if (apr_hash_count(cb.locks_to_store))
+    err = svn_error_compose_create(
+            err, svn_wc__add_locks(ctx->wc_ctx, cb.locks_to_store, pool));
+
 release_locks:
   if (lock_abspaths)
     {
@@ -622,12 +644,22 @@ svn_client_unlock(const apr_array_header_t *targets,
   cb.base_url = common_parent_url;
   cb.urls_to_paths = urls_to_paths;
   cb.ctx = ctx;
+  cb.locks_to_store = NULL;
+  cb.paths_to_unlock = apr_array_make(pool, apr_hash_count(path_tokens),
+                                      sizeof(const char *));
   cb.pool = pool;
 
   /* Unlock the paths. */
   err = svn_ra_unlock(ra_session, path_tokens, break_lock,
                       store_locks_callback, &cb, pool);
 
+  /* Remove all released lock tokens in a single working copy
+     transaction.  Do so even on error; the server may have released
+     some of the locks before failing. */
+  if (cb.paths_to_unlock->nelts)
+    err = svn_error_compose_create(
+            err, svn_wc__remove_locks(ctx->wc_ctx, cb.paths_to_unlock, pool));
+
 release_locks:
   if (lock_abspaths)
     {
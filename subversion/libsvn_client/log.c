@@ -36,6 +36,10 @@
 #include "svn_path.h"
 #include "svn_sorts.h"
 #include "svn_props.h"
+#include "svn_string.h"
+#include "svn_io.h"
+#include "svn_config.h"
+#include "svn_checksum.h"
 
 #include "client.h"
 
@@ -299,6 +303,497 @@ limit_receiver(void *baton, svn_log_entry_t *log_entry, apr_pool_t *pool)
   return rb->receiver(rb->baton, log_entry, pool);
 }
 
+
+/* --- The on-disk log cache -----------------------------------------
+
+   When the user configures a "log-cache-dir" in the miscellany
+   section, we remember the log entries received for the plain,
+   unlimited log of a single target over a single descending revision
+   range.  A later log of the same target and older bound only has to
+   ask the server for the revisions committed since, replaying the
+   remainder from disk.
+
+   One entry is kept per (repository UUID, resolved URL, older bound,
+   changed-path and history flags) tuple, in a file named by the SHA-1
+   of that key:
+
+       format
+       uuid
+       url
+       older bound revision
+       flags line
+       youngest revision the entry is valid for
+       number of log entries
+       per log entry, from youngest to oldest:
+           a "revision" line
+           the revision props in svn_hash_write2() format
+           a changed-path count line, -1 when no paths were received
+           per changed path:  a "path" line, an info line holding the
+                              action, node kind and text/prop
+                              modification tristates, a copyfrom
+                              revision line, and a copyfrom path line
+                              (empty when none)
+
+   The cache is strictly best-effort: any entry that cannot be read,
+   or does not match the request, simply means a full fetch.  Revision
+   property edits on the server are not detected; removing the cache
+   directory drops such stale entries. */
+
+#define LOG_CACHE_FORMAT 1
+
+/* Set *CACHE_PATH to the path of the cache file in CACHE_DIR for
+   logging URL in the repository UUID down to OLDEST_REVNUM with
+   DISCOVER_CHANGED_PATHS and STRICT_NODE_HISTORY. */
+static svn_error_t *
+log_cache_path(const char **cache_path,
+               const char *cache_dir,
+               const char *uuid,
+               const char *url,
+               svn_revnum_t oldest_revnum,
+               svn_boolean_t discover_changed_paths,
+               svn_boolean_t strict_node_history,
+               apr_pool_t *pool)
+{
+  const char *key;
+  svn_checksum_t *checksum;
+
+  key = apr_psprintf(pool, "%s|%s@%ld c%dh%d", uuid, url, oldest_revnum,
+                     (int)discover_changed_paths,
+                     (int)strict_node_history);
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, key, strlen(key),
+                       pool));
+
+  *cache_path = svn_dirent_join(svn_dirent_canonicalize(cache_dir, pool),
+                                svn_checksum_to_cstring_display(checksum,
+                                                                pool),
+                                pool);
+  return SVN_NO_ERROR;
+}
+
+/* Read one line from the cache file STREAM into *LINE; it is an error
+   for the file to end here. */
+static svn_error_t *
+read_cache_line(const char **line, svn_stream_t *stream, apr_pool_t *pool)
+{
+  svn_stringbuf_t *sb;
+  svn_boolean_t eof;
+
+  SVN_ERR(svn_stream_readline(stream, &sb, "\n", &eof, pool));
+  if (eof)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+  *line = sb->data;
+  return SVN_NO_ERROR;
+}
+
+/* Read one line from the cache file STREAM and parse it as a number. */
+static svn_error_t *
+read_cache_number(apr_int64_t *number,
+                  svn_stream_t *stream,
+                  apr_pool_t *pool)
+{
+  const char *line;
+
+  SVN_ERR(read_cache_line(&line, stream, pool));
+  return svn_error_trace(svn_cstring_atoi64(number, line));
+}
+
+/* Try to load the cache entry at CACHE_PATH for logging URL in the
+   repository UUID down to OLDEST_REVNUM; FLAGS is the flags line the
+   entry must carry.
+
+   On a usable entry, set *ENTRIES to the cached svn_log_entry_t *'s,
+   ordered from youngest to oldest, and *CACHED_YOUNGEST to the
+   youngest revision the entry is valid for; otherwise set *ENTRIES to
+   NULL and *CACHED_YOUNGEST to SVN_INVALID_REVNUM. */
+static svn_error_t *
+log_cache_load(apr_array_header_t **entries,
+               svn_revnum_t *cached_youngest,
+               const char *cache_path,
+               const char *uuid,
+               const char *url,
+               svn_revnum_t oldest_revnum,
+               const char *flags,
+               apr_pool_t *pool)
+{
+  svn_stringbuf_t *content;
+  svn_stream_t *stream;
+  const char *line;
+  apr_int64_t number, youngest, entry_count;
+  apr_array_header_t *parsed;
+  svn_revnum_t prev_revision = SVN_INVALID_REVNUM;
+  svn_node_kind_t kind;
+  int i;
+
+  *entries = NULL;
+  *cached_youngest = SVN_INVALID_REVNUM;
+
+  SVN_ERR(svn_io_check_path(cache_path, &kind, pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_stringbuf_from_file2(&content, cache_path, pool));
+  stream = svn_stream_from_stringbuf(content, pool);
+
+  SVN_ERR(read_cache_number(&number, stream, pool));
+  if (number != LOG_CACHE_FORMAT)
+    return SVN_NO_ERROR;
+
+  /* The key hash in the file name should make collisions all but
+     impossible, but better not replay the wrong history on one. */
+  SVN_ERR(read_cache_line(&line, stream, pool));
+  if (strcmp(line, uuid) != 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_cache_line(&line, stream, pool));
+  if (strcmp(line, url) != 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_cache_number(&number, stream, pool));
+  if (number != oldest_revnum)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_cache_line(&line, stream, pool));
+  if (strcmp(line, flags) != 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_cache_number(&youngest, stream, pool));
+  SVN_ERR(read_cache_number(&entry_count, stream, pool));
+  if (entry_count < 0)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+  parsed = apr_array_make(pool, (int)entry_count,
+                          sizeof(svn_log_entry_t *));
+  for (i = 0; i < entry_count; i++)
+    {
+      svn_log_entry_t *entry = svn_log_entry_create(pool);
+      apr_int64_t path_count;
+      int j;
+
+      SVN_ERR(read_cache_number(&number, stream, pool));
+      entry->revision = (svn_revnum_t)number;
+
+      /* The entries must run from youngest to oldest. */
+      if (SVN_IS_VALID_REVNUM(prev_revision)
+          && entry->revision >= prev_revision)
+        return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+      prev_revision = entry->revision;
+
+      entry->revprops = apr_hash_make(pool);
+      SVN_ERR(svn_hash_read2(entry->revprops, stream, SVN_HASH_TERMINATOR,
+                             pool));
+
+      SVN_ERR(read_cache_number(&path_count, stream, pool));
+      if (path_count >= 0)
+        {
+          entry->changed_paths2 = apr_hash_make(pool);
+          entry->changed_paths = entry->changed_paths2;
+        }
+
+      for (j = 0; j < path_count; j++)
+        {
+          svn_log_changed_path2_t *change
+            = svn_log_changed_path2_create(pool);
+          const char *path;
+          apr_array_header_t *fields;
+          apr_int64_t field;
+
+          SVN_ERR(read_cache_line(&path, stream, pool));
+
+          SVN_ERR(read_cache_line(&line, stream, pool));
+          fields = svn_cstring_split(line, " ", FALSE, pool);
+          if (fields->nelts != 4
+              || strlen(APR_ARRAY_IDX(fields, 0, const char *)) != 1)
+            return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+          change->action = *APR_ARRAY_IDX(fields, 0, const char *);
+          SVN_ERR(svn_cstring_atoi64(&field,
+                                     APR_ARRAY_IDX(fields, 1, const char *)));
+          change->node_kind = (svn_node_kind_t)field;
+          SVN_ERR(svn_cstring_atoi64(&field,
+                                     APR_ARRAY_IDX(fields, 2, const char *)));
+          change->text_modified = (svn_tristate_t)field;
+          SVN_ERR(svn_cstring_atoi64(&field,
+                                     APR_ARRAY_IDX(fields, 3, const char *)));
+          change->props_modified = (svn_tristate_t)field;
+
+          SVN_ERR(read_cache_number(&field, stream, pool));
+          change->copyfrom_rev = (svn_revnum_t)field;
+          SVN_ERR(read_cache_line(&line, stream, pool));
+          if (*line != '\0')
+            change->copyfrom_path = line;
+
+          svn_hash_sets(entry->changed_paths2, path, change);
+        }
+
+      APR_ARRAY_PUSH(parsed, svn_log_entry_t *) = entry;
+    }
+
+  *entries = parsed;
+  *cached_youngest = (svn_revnum_t)youngest;
+
+  return SVN_NO_ERROR;
+}
+
+/* Store ENTRIES, an array of svn_log_entry_t * ordered from youngest
+   to oldest and valid for logging URL in the repository UUID from
+   YOUNGEST_REVNUM down to OLDEST_REVNUM with the flags line FLAGS, at
+   CACHE_PATH. */
+static svn_error_t *
+log_cache_save(const char *cache_path,
+               const char *uuid,
+               const char *url,
+               svn_revnum_t oldest_revnum,
+               const char *flags,
+               svn_revnum_t youngest_revnum,
+               const apr_array_header_t *entries,
+               apr_pool_t *pool)
+{
+  svn_stringbuf_t *content = svn_stringbuf_create_empty(pool);
+  svn_stream_t *stream = svn_stream_from_stringbuf(content, pool);
+  int i;
+
+  SVN_ERR(svn_stream_printf(stream, pool, "%d\n%s\n%s\n%ld\n%s\n%ld\n%d\n",
+                            LOG_CACHE_FORMAT, uuid, url, oldest_revnum,
+                            flags, youngest_revnum, entries->nelts));
+
+  for (i = 0; i < entries->nelts; i++)
+    {
+      const svn_log_entry_t *entry
+        = APR_ARRAY_IDX(entries, i, svn_log_entry_t *);
+
+      SVN_ERR(svn_stream_printf(stream, pool, "%ld\n", entry->revision));
+      SVN_ERR(svn_hash_write2(entry->revprops
+                                ? entry->revprops
+                                : apr_hash_make(pool),
+                              stream, SVN_HASH_TERMINATOR, pool));
+
+      if (entry->changed_paths2 == NULL)
+        {
+          SVN_ERR(svn_stream_printf(stream, pool, "-1\n"));
+        }
+      else
+        {
+          apr_hash_index_t *hi;
+
+          SVN_ERR(svn_stream_printf(stream, pool, "%u\n",
+                                    apr_hash_count(entry->changed_paths2)));
+          for (hi = apr_hash_first(pool, entry->changed_paths2); hi;
+               hi = apr_hash_next(hi))
+            {
+              const char *path = apr_hash_this_key(hi);
+              const svn_log_changed_path2_t *change = apr_hash_this_val(hi);
+
+              SVN_ERR(svn_stream_printf(stream, pool,
+                                        "%s\n%c %d %d %d\n%ld\n%s\n",
+                                        path, change->action,
+                                        (int)change->node_kind,
+                                        (int)change->text_modified,
+                                        (int)change->props_modified,
+                                        change->copyfrom_rev,
+                                        change->copyfrom_path
+                                          ? change->copyfrom_path : ""));
+            }
+        }
+    }
+
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(cache_path, pool),
+                                      pool));
+  SVN_ERR(svn_io_write_atomic2(cache_path, content->data, content->len,
+                               NULL, FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if REVPROPS requests exactly the standard author, date
+   and log message revision properties, which is what the cache
+   stores. */
+static svn_boolean_t
+requests_standard_revprops(const apr_array_header_t *revprops)
+{
+  svn_boolean_t author = FALSE, date = FALSE, message = FALSE;
+  int i;
+
+  if (revprops == NULL || revprops->nelts != 3)
+    return FALSE;
+
+  for (i = 0; i < revprops->nelts; i++)
+    {
+      const char *name = APR_ARRAY_IDX(revprops, i, const char *);
+
+      if (strcmp(name, SVN_PROP_REVISION_AUTHOR) == 0)
+        author = TRUE;
+      else if (strcmp(name, SVN_PROP_REVISION_DATE) == 0)
+        date = TRUE;
+      else if (strcmp(name, SVN_PROP_REVISION_LOG) == 0)
+        message = TRUE;
+      else
+        return FALSE;
+    }
+
+  return author && date && message;
+}
+
+/* Baton for collecting_log_receiver(). */
+typedef struct collecting_log_receiver_baton_t
+{
+  /* Deep copies of the received entries, youngest first. */
+  apr_array_header_t *entries;
+  apr_pool_t *pool;
+
+  /* The real receiver every entry is forwarded to. */
+  svn_log_entry_receiver_t receiver;
+  void *baton;
+} collecting_log_receiver_baton_t;
+
+/* Remember a deep copy of LOG_ENTRY in BATON->entries before handing
+   it on to the real receiver.  Implements svn_log_entry_receiver_t. */
+static svn_error_t *
+collecting_log_receiver(void *baton, svn_log_entry_t *log_entry,
+                        apr_pool_t *pool)
+{
+  collecting_log_receiver_baton_t *rb = baton;
+  svn_log_entry_t *copy = svn_log_entry_dup(log_entry, rb->pool);
+
+  /* svn_log_entry_dup() does not fill in the deprecated alias. */
+  copy->changed_paths = copy->changed_paths2;
+  APR_ARRAY_PUSH(rb->entries, svn_log_entry_t *) = copy;
+
+  return rb->receiver(rb->baton, log_entry, pool);
+}
+
+/* Run the log of RA_SESSION's URL (open at ACTUAL_LOC) for the single
+   descending revision range RANGE_START:RANGE_END through the on-disk
+   cache in CACHE_DIR, asking the server only for the revisions younger
+   than the cached entry and replaying the rest from disk.
+
+   The DISCOVER_CHANGED_PATHS, STRICT_NODE_HISTORY, REVPROPS,
+   REAL_RECEIVER and REAL_RECEIVER_BATON parameters are all as per the
+   svn_client_log5 API.
+
+   Set *USED to TRUE when the request was served this way; on FALSE the
+   caller must run the uncached code path instead. */
+static svn_error_t *
+run_cached_log(svn_boolean_t *used,
+               svn_ra_session_t *ra_session,
+               svn_client__pathrev_t *actual_loc,
+               svn_revnum_t range_start,
+               svn_revnum_t range_end,
+               const char *cache_dir,
+               svn_boolean_t discover_changed_paths,
+               svn_boolean_t strict_node_history,
+               const apr_array_header_t *revprops,
+               svn_log_entry_receiver_t real_receiver,
+               void *real_receiver_baton,
+               svn_client_ctx_t *ctx,
+               apr_pool_t *scratch_pool)
+{
+  svn_boolean_t has_log_revprops;
+  const char *uuid;
+  const char *flags;
+  const char *cache_path;
+  apr_array_header_t *cached_entries;
+  svn_revnum_t cached_youngest;
+  apr_array_header_t *fetched_entries = NULL;
+  apr_pool_t *iterpool;
+  svn_error_t *err;
+  int i;
+
+  *used = FALSE;
+
+  /* Pre-1.5 servers take the detour through pre_15_receiver(). */
+  SVN_ERR(svn_ra_has_capability(ra_session, &has_log_revprops,
+                                SVN_RA_CAPABILITY_LOG_REVPROPS,
+                                scratch_pool));
+  if (!has_log_revprops)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_ra_get_uuid2(ra_session, &uuid, scratch_pool));
+  flags = apr_psprintf(scratch_pool, "c%dh%d",
+                       (int)discover_changed_paths,
+                       (int)strict_node_history);
+  SVN_ERR(log_cache_path(&cache_path, cache_dir, uuid, actual_loc->url,
+                         range_end, discover_changed_paths,
+                         strict_node_history, scratch_pool));
+
+  /* An entry we cannot read is just a cache miss. */
+  err = log_cache_load(&cached_entries, &cached_youngest, cache_path,
+                       uuid, actual_loc->url, range_end, flags,
+                       scratch_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      cached_entries = NULL;
+      cached_youngest = SVN_INVALID_REVNUM;
+    }
+
+  /* Ask the server only for what arrived after the cached entry. */
+  if (!SVN_IS_VALID_REVNUM(cached_youngest)
+      || cached_youngest < range_start)
+    {
+      collecting_log_receiver_baton_t rb;
+      apr_array_header_t *paths
+        = apr_array_make(scratch_pool, 1, sizeof(const char *));
+
+      APR_ARRAY_PUSH(paths, const char *) = "";
+
+      rb.entries = apr_array_make(scratch_pool, 0,
+                                  sizeof(svn_log_entry_t *));
+      rb.pool = scratch_pool;
+      rb.receiver = real_receiver;
+      rb.baton = real_receiver_baton;
+
+      SVN_ERR(svn_ra_get_log2(ra_session, paths,
+                              range_start,
+                              SVN_IS_VALID_REVNUM(cached_youngest)
+                                ? cached_youngest + 1
+                                : range_end,
+                              0, discover_changed_paths,
+                              strict_node_history,
+                              FALSE /* include_merged_revisions */,
+                              revprops,
+                              collecting_log_receiver, &rb,
+                              scratch_pool));
+
+      fetched_entries = rb.entries;
+    }
+
+  /* Replay the cached remainder of the range. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; cached_entries && i < cached_entries->nelts; i++)
+    {
+      svn_log_entry_t *entry
+        = APR_ARRAY_IDX(cached_entries, i, svn_log_entry_t *);
+
+      if (entry->revision > range_start)
+        continue;
+
+      svn_pool_clear(iterpool);
+
+      if (ctx->cancel_func)
+        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
+
+      SVN_ERR(real_receiver(real_receiver_baton, entry, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Remember the result for the next log of this range.  Failure to
+     update the cache does not fail the log itself. */
+  if (fetched_entries)
+    {
+      if (cached_entries)
+        apr_array_cat(fetched_entries, cached_entries);
+      svn_error_clear(log_cache_save(cache_path, uuid, actual_loc->url,
+                                     range_end, flags, range_start,
+                                     fetched_entries, scratch_pool));
+    }
+
+  *used = TRUE;
+  return SVN_NO_ERROR;
+}
+
 /* Resolve the URLs or WC path in TARGETS as per the svn_client_log5 API.
 
    The limitations on TARGETS specified by svn_client_log5 are enforced here.
@@ -911,6 +1406,41 @@ svn_client_log5(const apr_array_header_t *targets,
   SVN_ERR(svn_client__ensure_ra_session_url(&old_session_url, ra_session,
                                             actual_loc->url, pool));
 
+  /* Consult the optional on-disk log cache.  Merge-aware, limited,
+     ascending, multi-range and multi-path logs, and logs of
+     non-standard revprops, are not cached. */
+  if (ctx->config
+      && limit == 0
+      && !include_merged_revisions
+      && revision_ranges->nelts == 1
+      && relative_targets->nelts == 1
+      && *APR_ARRAY_IDX(relative_targets, 0, const char *) == '\0'
+      && requests_standard_revprops(revprops))
+    {
+      rev_range_t *range = APR_ARRAY_IDX(revision_ranges, 0, rev_range_t *);
+      svn_config_t *cfg = svn_hash_gets(ctx->config,
+                                        SVN_CONFIG_CATEGORY_CONFIG);
+      const char *cache_dir = NULL;
+
+      if (cfg)
+        svn_config_get(cfg, &cache_dir, SVN_CONFIG_SECTION_MISCELLANY,
+                       SVN_CONFIG_OPTION_LOG_CACHE_DIR, NULL);
+
+      if (cache_dir && range->range_start >= range->range_end)
+        {
+          svn_boolean_t used;
+
+          SVN_ERR(run_cached_log(&used, ra_session, actual_loc,
+                                 range->range_start, range->range_end,
+                                 cache_dir, discover_changed_paths,
+                                 strict_node_history, revprops,
+                                 real_receiver, real_receiver_baton,
+                                 ctx, pool));
+          if (used)
+            return SVN_NO_ERROR;
+        }
+    }
+
   /* Save us an RA layer round trip if we are on the repository root and
      know the result in advance, or if we don't need multiple ranges.
      All the revision data has already been validated.
@@ -10545,24 +10545,24 @@ open_target_wc(merge_target_t **target_p,
  *
  * IGNORE_MERGEINFO and DIFF_IGNORE_ANCESTRY are as in do_merge().
  */
-svn_error_t *
-svn_client__merge_locked(svn_client__conflict_report_t **conflict_report,
-                         const char *source1,
-                         const svn_opt_revision_t *revision1,
-                         const char *source2,
-                         const svn_opt_revision_t *revision2,
-                         const char *target_abspath,
-                         svn_depth_t depth,
-                         svn_boolean_t ignore_mergeinfo,
-                         svn_boolean_t diff_ignore_ancestry,
-                         svn_boolean_t force_delete,
-                         svn_boolean_t record_only,
-                         svn_boolean_t dry_run,
-                         svn_boolean_t allow_mixed_rev,
-                         const apr_array_header_t *merge_options,
-                         svn_client_ctx_t *ctx,
-                         apr_pool_t *result_pool,
-                         apr_pool_t *scratch_pool)
+static svn_error_t *
+merge_locked(svn_client__conflict_report_t **conflict_report,
+             const char *source1,
+             const svn_opt_revision_t *revision1,
+             const char *source2,
+             const svn_opt_revision_t *revision2,
+             const char *target_abspath,
+             svn_depth_t depth,
+             svn_boolean_t ignore_mergeinfo,
+             svn_boolean_t diff_ignore_ancestry,
+             svn_boolean_t force_delete,
+             svn_boolean_t record_only,
+             svn_boolean_t dry_run,
+             svn_boolean_t allow_mixed_rev,
+             const apr_array_header_t *merge_options,
+             svn_client_ctx_t *ctx,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
 {
   merge_target_t *target;
   svn_client__pathrev_t *source1_loc, *source2_loc;
@@ -10737,6 +10737,40 @@ svn_client__merge_locked(svn_client__conflict_report_t **conflict_report,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_client__merge_locked(svn_client__conflict_report_t **conflict_report,
+                         const char *source1,
+                         const svn_opt_revision_t *revision1,
+                         const char *source2,
+                         const svn_opt_revision_t *revision2,
+                         const char *target_abspath,
+                         svn_depth_t depth,
+                         svn_boolean_t ignore_mergeinfo,
+                         svn_boolean_t diff_ignore_ancestry,
+                         svn_boolean_t force_delete,
+                         svn_boolean_t record_only,
+                         svn_boolean_t dry_run,
+                         svn_boolean_t allow_mixed_rev,
+                         const apr_array_header_t *merge_options,
+                         svn_client_ctx_t *ctx,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  /* Answer repeated repository lookups from memory for the duration
+     of the merge. */
+  svn_client__mergeinfo_memo_begin(ctx, scratch_pool);
+  err = merge_locked(conflict_report, source1, revision1,
+                     source2, revision2, target_abspath, depth,
+                     ignore_mergeinfo, diff_ignore_ancestry, force_delete,
+                     record_only, dry_run, allow_mixed_rev, merge_options,
+                     ctx, result_pool, scratch_pool);
+  svn_client__mergeinfo_memo_end(ctx);
+
+  return svn_error_trace(err);
+}
+
 /* Set *TARGET_ABSPATH to the absolute path of, and *LOCK_ABSPATH to
  the absolute path to lock for, TARGET_WCPATH. */
 static svn_error_t *
@@ -11344,7 +11378,7 @@ find_unmerged_mergeinfo(svn_mergeinfo_catalog_t *unmerged_to_source_catalog,
                     &source_mergeinfo, source_ra_session,
                     source_pathrev->url, source_pathrev->rev,
                     svn_mergeinfo_inherited, FALSE /*squelch_incapable*/,
-                    iterpool));
+                    ctx, iterpool));
           if (!source_mergeinfo)
             source_mergeinfo = apr_hash_make(iterpool);
         }
@@ -11576,7 +11610,7 @@ calculate_left_hand_side(svn_client__pathrev_t **left_p,
             &mergeinfo_catalog, source_ra_session,
             source_loc->url, source_loc->rev,
             svn_mergeinfo_inherited, FALSE /* squelch_incapable */,
-            TRUE /* include_descendants */, iterpool, iterpool));
+            TRUE /* include_descendants */, ctx, iterpool, iterpool));
 
   if (!mergeinfo_catalog)
     mergeinfo_catalog = apr_hash_make(iterpool);
@@ -11842,16 +11876,16 @@ open_reintegrate_source_and_target(svn_ra_session_t **source_ra_session_p,
 
 /* The body of svn_client_merge_reintegrate(), which see for details. */
 static svn_error_t *
-merge_reintegrate_locked(svn_client__conflict_report_t **conflict_report,
-                         const char *source_path_or_url,
-                         const svn_opt_revision_t *source_peg_revision,
-                         const char *target_abspath,
-                         svn_boolean_t diff_ignore_ancestry,
-                         svn_boolean_t dry_run,
-                         const apr_array_header_t *merge_options,
-                         svn_client_ctx_t *ctx,
-                         apr_pool_t *result_pool,
-                         apr_pool_t *scratch_pool)
+merge_reintegrate_locked_internal(svn_client__conflict_report_t **conflict_report,
+                                  const char *source_path_or_url,
+                                  const svn_opt_revision_t *source_peg_revision,
+                                  const char *target_abspath,
+                                  svn_boolean_t diff_ignore_ancestry,
+                                  svn_boolean_t dry_run,
+                                  const apr_array_header_t *merge_options,
+                                  svn_client_ctx_t *ctx,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool)
 {
   svn_ra_session_t *target_ra_session, *source_ra_session;
   merge_target_t *target;
@@ -11907,6 +11941,36 @@ merge_reintegrate_locked(svn_client__conflict_report_t **conflict_report,
   return SVN_NO_ERROR;
 }
 
+/* Thin wrapper around merge_reintegrate_locked_internal() that keeps
+   the memo of repository lookups active for the duration of the
+   merge. */
+static svn_error_t *
+merge_reintegrate_locked(svn_client__conflict_report_t **conflict_report,
+                         const char *source_path_or_url,
+                         const svn_opt_revision_t *source_peg_revision,
+                         const char *target_abspath,
+                         svn_boolean_t diff_ignore_ancestry,
+                         svn_boolean_t dry_run,
+                         const apr_array_header_t *merge_options,
+                         svn_client_ctx_t *ctx,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  svn_client__mergeinfo_memo_begin(ctx, scratch_pool);
+  err = merge_reintegrate_locked_internal(conflict_report,
+                                          source_path_or_url,
+                                          source_peg_revision,
+                                          target_abspath,
+                                          diff_ignore_ancestry, dry_run,
+                                          merge_options, ctx,
+                                          result_pool, scratch_pool);
+  svn_client__mergeinfo_memo_end(ctx);
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *
 svn_client_merge_reintegrate(const char *source_path_or_url,
                              const svn_opt_revision_t *source_peg_revision,
@@ -11947,22 +12011,22 @@ svn_client_merge_reintegrate(const char *source_path_or_url,
  * IGNORE_MERGEINFO and DIFF_IGNORE_ANCESTRY are as in do_merge().
  */
 static svn_error_t *
-merge_peg_locked(svn_client__conflict_report_t **conflict_report,
-                 const char *source_path_or_url,
-                 const svn_opt_revision_t *source_peg_revision,
-                 const svn_rangelist_t *ranges_to_merge,
-                 const char *target_abspath,
-                 svn_depth_t depth,
-                 svn_boolean_t ignore_mergeinfo,
-                 svn_boolean_t diff_ignore_ancestry,
-                 svn_boolean_t force_delete,
-                 svn_boolean_t record_only,
-                 svn_boolean_t dry_run,
-                 svn_boolean_t allow_mixed_rev,
-                 const apr_array_header_t *merge_options,
-                 svn_client_ctx_t *ctx,
-                 apr_pool_t *result_pool,
-                 apr_pool_t *scratch_pool)
+merge_peg_locked_internal(svn_client__conflict_report_t **conflict_report,
+                          const char *source_path_or_url,
+                          const svn_opt_revision_t *source_peg_revision,
+                          const svn_rangelist_t *ranges_to_merge,
+                          const char *target_abspath,
+                          svn_depth_t depth,
+                          svn_boolean_t ignore_mergeinfo,
+                          svn_boolean_t diff_ignore_ancestry,
+                          svn_boolean_t force_delete,
+                          svn_boolean_t record_only,
+                          svn_boolean_t dry_run,
+                          svn_boolean_t allow_mixed_rev,
+                          const apr_array_header_t *merge_options,
+                          svn_client_ctx_t *ctx,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
 {
   merge_target_t *target;
   svn_client__pathrev_t *source_loc;
@@ -12033,6 +12097,41 @@ merge_peg_locked(svn_client__conflict_report_t **conflict_report,
   return SVN_NO_ERROR;
 }
 
+/* Thin wrapper around merge_peg_locked_internal() that keeps the memo
+   of repository lookups active for the duration of the merge. */
+static svn_error_t *
+merge_peg_locked(svn_client__conflict_report_t **conflict_report,
+                 const char *source_path_or_url,
+                 const svn_opt_revision_t *source_peg_revision,
+                 const svn_rangelist_t *ranges_to_merge,
+                 const char *target_abspath,
+                 svn_depth_t depth,
+                 svn_boolean_t ignore_mergeinfo,
+                 svn_boolean_t diff_ignore_ancestry,
+                 svn_boolean_t force_delete,
+                 svn_boolean_t record_only,
+                 svn_boolean_t dry_run,
+                 svn_boolean_t allow_mixed_rev,
+                 const apr_array_header_t *merge_options,
+                 svn_client_ctx_t *ctx,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  svn_client__mergeinfo_memo_begin(ctx, scratch_pool);
+  err = merge_peg_locked_internal(conflict_report, source_path_or_url,
+                                  source_peg_revision, ranges_to_merge,
+                                  target_abspath, depth, ignore_mergeinfo,
+                                  diff_ignore_ancestry, force_delete,
+                                  record_only, dry_run, allow_mixed_rev,
+                                  merge_options, ctx,
+                                  result_pool, scratch_pool);
+  svn_client__mergeinfo_memo_end(ctx);
+
+  return svn_error_trace(err);
+}
+
 /* Details of an automatic merge. */
 typedef struct automatic_merge_t
 {
@@ -12837,18 +12936,18 @@ client_find_automatic_merge(automatic_merge_t **merge_p,
  * eliminate already-cherry-picked revisions from the source.
  */
 static svn_error_t *
-do_automatic_merge_locked(svn_client__conflict_report_t **conflict_report,
-                          const automatic_merge_t *merge,
-                          const char *target_abspath,
-                          svn_depth_t depth,
-                          svn_boolean_t diff_ignore_ancestry,
-                          svn_boolean_t force_delete,
-                          svn_boolean_t record_only,
-                          svn_boolean_t dry_run,
-                          const apr_array_header_t *merge_options,
-                          svn_client_ctx_t *ctx,
-                          apr_pool_t *result_pool,
-                          apr_pool_t *scratch_pool)
+do_automatic_merge_locked_internal(svn_client__conflict_report_t **conflict_report,
+                                   const automatic_merge_t *merge,
+                                   const char *target_abspath,
+                                   svn_depth_t depth,
+                                   svn_boolean_t diff_ignore_ancestry,
+                                   svn_boolean_t force_delete,
+                                   svn_boolean_t record_only,
+                                   svn_boolean_t dry_run,
+                                   const apr_array_header_t *merge_options,
+                                   svn_client_ctx_t *ctx,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool)
 {
   merge_target_t *target;
   svn_boolean_t reintegrate_like = merge->is_reintegrate_like;
@@ -12965,6 +13064,37 @@ do_automatic_merge_locked(svn_client__conflict_report_t **conflict_report,
   return SVN_NO_ERROR;
 }
 
+/* Thin wrapper around do_automatic_merge_locked_internal() that keeps
+   the memo of repository lookups active for the duration of the
+   merge. */
+static svn_error_t *
+do_automatic_merge_locked(svn_client__conflict_report_t **conflict_report,
+                          const automatic_merge_t *merge,
+                          const char *target_abspath,
+                          svn_depth_t depth,
+                          svn_boolean_t diff_ignore_ancestry,
+                          svn_boolean_t force_delete,
+                          svn_boolean_t record_only,
+                          svn_boolean_t dry_run,
+                          const apr_array_header_t *merge_options,
+                          svn_client_ctx_t *ctx,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  svn_client__mergeinfo_memo_begin(ctx, scratch_pool);
+  err = do_automatic_merge_locked_internal(conflict_report, merge,
+                                           target_abspath, depth,
+                                           diff_ignore_ancestry,
+                                           force_delete, record_only,
+                                           dry_run, merge_options, ctx,
+                                           result_pool, scratch_pool);
+  svn_client__mergeinfo_memo_end(ctx);
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *
 svn_client_get_merging_summary(svn_boolean_t *needs_reintegration,
                                const char **yca_url, svn_revnum_t *yca_rev,
@@ -417,12 +417,18 @@ svn_client__get_wc_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
   if (include_descendants)
     {
       apr_hash_t *mergeinfo_props;
+      apr_hash_t *repos_relpaths;
       apr_hash_index_t *hi;
 
-      SVN_ERR(svn_wc__prop_retrieve_recursive(&mergeinfo_props,
-                                              ctx->wc_ctx, local_abspath,
-                                              SVN_PROP_MERGEINFO,
-                                              scratch_pool, scratch_pool));
+      /* One query fetches the mergeinfo properties of the whole subtree
+         along with each node's repository relpath; issuing a per-node
+         repos info query for every subtree with mergeinfo does not
+         scale to large trees. */
+      SVN_ERR(svn_wc__prop_retrieve_recursive2(&mergeinfo_props,
+                                               &repos_relpaths,
+                                               ctx->wc_ctx, local_abspath,
+                                               SVN_PROP_MERGEINFO,
+                                               result_pool, scratch_pool));
 
       /* Convert *mergeinfo_props into a proper svn_mergeinfo_catalog_t */
       for (hi = apr_hash_first(scratch_pool, mergeinfo_props);
@@ -437,9 +443,12 @@ svn_client__get_wc_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
           if (strcmp(node_abspath, local_abspath) == 0)
             continue; /* Already parsed in svn_client__get_wc_mergeinfo */
 
-          SVN_ERR(svn_wc__node_get_repos_info(NULL, &repos_relpath, NULL, NULL,
-                                              ctx->wc_ctx, node_abspath,
-                                              result_pool, scratch_pool));
+          repos_relpath = svn_hash_gets(repos_relpaths, node_abspath);
+          if (!repos_relpath)
+            SVN_ERR(svn_wc__node_get_repos_info(NULL, &repos_relpath, NULL,
+                                                NULL,
+                                                ctx->wc_ctx, node_abspath,
+                                                result_pool, scratch_pool));
 
           SVN_ERR(svn_mergeinfo_parse(&subtree_mergeinfo, propval->data,
                                       result_pool));
@@ -464,6 +473,7 @@ svn_client__get_repos_mergeinfo(svn_mergeinfo_t *target_mergeinfo,
                                 svn_revnum_t rev,
                                 svn_mergeinfo_inheritance_t inherit,
                                 svn_boolean_t squelch_incapable,
+                                svn_client_ctx_t *ctx,
                                 apr_pool_t *pool)
 {
   svn_mergeinfo_catalog_t tgt_mergeinfo_cat;
@@ -474,7 +484,7 @@ svn_client__get_repos_mergeinfo(svn_mergeinfo_t *target_mergeinfo,
                                                   ra_session,
                                                   url, rev, inherit,
                                                   squelch_incapable, FALSE,
-                                                  pool, pool));
+                                                  ctx, pool, pool));
 
   if (tgt_mergeinfo_cat && apr_hash_count(tgt_mergeinfo_cat))
     {
@@ -497,6 +507,7 @@ svn_client__get_repos_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
                                         svn_mergeinfo_inheritance_t inherit,
                                         svn_boolean_t squelch_incapable,
                                         svn_boolean_t include_descendants,
+                                        svn_client_ctx_t *ctx,
                                         apr_pool_t *result_pool,
                                         apr_pool_t *scratch_pool)
 {
@@ -505,6 +516,22 @@ svn_client__get_repos_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
   apr_array_header_t *rel_paths = apr_array_make(scratch_pool, 1,
                                                  sizeof(const char *));
   const char *old_session_url;
+  const char *memo_key = apr_psprintf(scratch_pool, "cat:%s@%ld i%d s%d d%d",
+                                      url, rev, (int)inherit,
+                                      (int)squelch_incapable,
+                                      (int)include_descendants);
+  const void *memoized;
+  apr_pool_t *memo_pool;
+
+  /* Mergeinfo at a fixed revision cannot change on the server, so an
+     active lookup memo may answer without a round trip. */
+  if (svn_client__mergeinfo_memo_get(&memoized, NULL, ctx, memo_key))
+    {
+      *mergeinfo_cat = memoized
+                       ? svn_mergeinfo_catalog_dup(memoized, result_pool)
+                       : NULL;
+      return SVN_NO_ERROR;
+    }
 
   APR_ARRAY_PUSH(rel_paths, const char *) = "";
 
@@ -521,6 +548,7 @@ svn_client__get_repos_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
         {
           svn_error_clear(err);
           *mergeinfo_cat = NULL;
+          svn_client__mergeinfo_memo_set(ctx, memo_key, NULL, FALSE);
           return SVN_NO_ERROR;
         }
       else
@@ -547,6 +575,16 @@ svn_client__get_repos_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
                                                      result_pool,
                                                      scratch_pool));
     }
+
+  memo_pool = svn_client__mergeinfo_memo_pool(ctx);
+  if (memo_pool)
+    svn_client__mergeinfo_memo_set(ctx, memo_key,
+                                   *mergeinfo_cat
+                                   ? svn_mergeinfo_catalog_dup(*mergeinfo_cat,
+                                                               memo_pool)
+                                   : NULL,
+                                   FALSE);
+
   return SVN_NO_ERROR;
 }
 
@@ -693,7 +731,7 @@ svn_client__get_wc_or_repos_mergeinfo_catalog(
                         &target_mergeinfo_cat_repos, ra_session,
                         url, target_rev, inherit,
                         TRUE, include_descendants,
-                        result_pool, scratch_pool));
+                        ctx, result_pool, scratch_pool));
 
               if (target_mergeinfo_cat_repos
                   && svn_hash_gets(target_mergeinfo_cat_repos, repos_relpath))
@@ -748,6 +786,10 @@ svn_client__get_history_as_mergeinfo(svn_mergeinfo_t *mergeinfo_p,
                                       apr_pool_t *pool)
 {
   apr_array_header_t *segments;
+  const char *memo_key;
+  const void *memoized;
+  svn_boolean_t memoized_flag;
+  apr_pool_t *memo_pool;
 
   /* Fetch the location segments for our URL@PEG_REVNUM. */
   if (! SVN_IS_VALID_REVNUM(range_youngest))
@@ -755,25 +797,44 @@ svn_client__get_history_as_mergeinfo(svn_mergeinfo_t *mergeinfo_p,
   if (! SVN_IS_VALID_REVNUM(range_oldest))
     range_oldest = 0;
 
+  /* The history of URL@PEG_REVNUM cannot change on the server, so an
+     active lookup memo may answer without a round trip. */
+  memo_key = apr_psprintf(pool, "hist:%s@%ld y%ld o%ld",
+                          pathrev->url, pathrev->rev,
+                          range_youngest, range_oldest);
+  if (svn_client__mergeinfo_memo_get(&memoized, &memoized_flag, ctx,
+                                     memo_key))
+    {
+      *mergeinfo_p = svn_mergeinfo_dup((svn_mergeinfo_t)memoized, pool);
+      if (has_rev_zero_history)
+        *has_rev_zero_history = memoized_flag;
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(svn_client__repos_location_segments(&segments, ra_session,
                                               pathrev->url, pathrev->rev,
                                               range_youngest, range_oldest,
                                               ctx, pool));
 
-  if (has_rev_zero_history)
+  memoized_flag = FALSE;
+  if (segments->nelts)
     {
-      *has_rev_zero_history = FALSE;
-        if (segments->nelts)
-          {
-            svn_location_segment_t *oldest_segment =
-              APR_ARRAY_IDX(segments, 0, svn_location_segment_t *);
-            if (oldest_segment->range_start == 0)
-              *has_rev_zero_history = TRUE;
-          }
+      svn_location_segment_t *oldest_segment =
+        APR_ARRAY_IDX(segments, 0, svn_location_segment_t *);
+      if (oldest_segment->range_start == 0)
+        memoized_flag = TRUE;
     }
+  if (has_rev_zero_history)
+    *has_rev_zero_history = memoized_flag;
 
   SVN_ERR(svn_mergeinfo__mergeinfo_from_segments(mergeinfo_p, segments, pool));
 
+  memo_pool = svn_client__mergeinfo_memo_pool(ctx);
+  if (memo_pool)
+    svn_client__mergeinfo_memo_set(ctx, memo_key,
+                                   svn_mergeinfo_dup(*mergeinfo_p, memo_pool),
+                                   memoized_flag);
+
   return SVN_NO_ERROR;
 }
 
@@ -1086,7 +1147,7 @@ get_mergeinfo(svn_mergeinfo_catalog_t *mergeinfo_catalog,
       SVN_ERR(svn_client__get_repos_mergeinfo_catalog(
         mergeinfo_catalog, ra_session, peg_loc->url, peg_loc->rev,
         svn_mergeinfo_inherited, FALSE, include_descendants,
-        result_pool, scratch_pool));
+        ctx, result_pool, scratch_pool));
     }
   else /* ! svn_path_is_url() */
     {
@@ -2088,27 +2149,39 @@ svn_client__mergeinfo_log(svn_boolean_t finding_merged,
     }
   else
     {
-      /* Create the starting rangelist for what might be eligible. */
-      svn_rangelist_t *source_master_rangelist =
-        apr_array_make(scratch_pool, 1, sizeof(svn_merge_range_t *));
-
-      SVN_ERR(svn_rangelist__merge_many(source_master_rangelist,
-                                        source_history,
-                                        scratch_pool, scratch_pool));
+      /* Create the starting revision set for what might be eligible.
+         Revision sets keep this computation linear even when the
+         mergeinfo is fragmented into many thousands of ranges. */
+      svn_revset__t *source_set = svn_revset__create(scratch_pool);
+      svn_revset__t *partial_set = svn_revset__create(scratch_pool);
+      svn_revset__t *full_set = svn_revset__create(scratch_pool);
+      svn_revset__t *eligible_set;
+      svn_rangelist_t *eligible_noninheritable;
 
-      /* From what might be eligible subtract what we know is
-         partially merged and then merge that back. */
-      SVN_ERR(svn_rangelist_remove(&source_master_rangelist,
-                                   master_noninheritable_rangelist,
-                                   source_master_rangelist,
-                                   FALSE, scratch_pool));
-      SVN_ERR(svn_rangelist_merge2(source_master_rangelist,
-                                   master_noninheritable_rangelist,
+      for (hi = apr_hash_first(scratch_pool, source_history);
+           hi;
+           hi = apr_hash_next(hi))
+        svn_revset__add_rangelist(source_set, apr_hash_this_val(hi));
+
+      svn_revset__add_rangelist(partial_set,
+                                master_noninheritable_rangelist);
+      svn_revset__add_rangelist(full_set, master_inheritable_rangelist);
+
+      /* What we know is fully merged is no longer eligible.  What we
+         know is only partially merged remains eligible, albeit as
+         non-inheritable ranges. */
+      eligible_set = svn_revset__minus(svn_revset__minus(source_set,
+                                                         partial_set,
+                                                         scratch_pool),
+                                       full_set, scratch_pool);
+
+      master_inheritable_rangelist
+        = svn_revset__to_rangelist(eligible_set, TRUE, scratch_pool);
+      eligible_noninheritable
+        = svn_revset__to_rangelist(partial_set, FALSE, scratch_pool);
+      SVN_ERR(svn_rangelist_merge2(master_inheritable_rangelist,
+                                   eligible_noninheritable,
                                    scratch_pool, scratch_pool));
-      SVN_ERR(svn_rangelist_remove(&master_inheritable_rangelist,
-                                   master_inheritable_rangelist,
-                                   source_master_rangelist,
-                                   TRUE, scratch_pool));
     }
 
   /* Nothing merged?  Not even when considering shared history if
@@ -2323,3 +2396,122 @@ svn_client__mergeinfo_status(svn_boolean_t *mergeinfo_changes,
 
   return SVN_NO_ERROR;
 }
+
+
+/*** Memoization of immutable repository lookups ***/
+
+/* The lookup memo; see mergeinfo.h.  Hangs off the private client
+   context while active. */
+struct svn_client__mergeinfo_memo_t
+{
+  /* Holds ENTRIES and every memoized result. */
+  apr_pool_t *pool;
+
+  /* Maps a lookup-specific key to a memo_entry_t *. */
+  apr_hash_t *entries;
+
+  /* Number of svn_client__mergeinfo_memo_begin() calls without a
+     matching _end(), so that nested activations are no-ops. */
+  int refcount;
+};
+
+/* A single memoized result; RESULT may legitimately be NULL. */
+typedef struct memo_entry_t
+{
+  const void *result;
+  svn_boolean_t flag;
+} memo_entry_t;
+
+void
+svn_client__mergeinfo_memo_begin(svn_client_ctx_t *ctx,
+                                 apr_pool_t *pool)
+{
+  svn_client__private_ctx_t *const private_ctx =
+    svn_client__get_private_ctx(ctx);
+
+  if (private_ctx->mergeinfo_memo == NULL)
+    {
+      svn_client__mergeinfo_memo_t *memo = apr_pcalloc(pool, sizeof(*memo));
+
+      memo->pool = pool;
+      memo->entries = apr_hash_make(pool);
+      private_ctx->mergeinfo_memo = memo;
+    }
+
+  private_ctx->mergeinfo_memo->refcount++;
+}
+
+void
+svn_client__mergeinfo_memo_end(svn_client_ctx_t *ctx)
+{
+  svn_client__private_ctx_t *const private_ctx =
+    svn_client__get_private_ctx(ctx);
+
+  if (private_ctx->mergeinfo_memo
+      && --private_ctx->mergeinfo_memo->refcount == 0)
+    private_ctx->mergeinfo_memo = NULL;
+}
+
+apr_pool_t *
+svn_client__mergeinfo_memo_pool(svn_client_ctx_t *ctx)
+{
+  if (ctx == NULL)
+    return NULL;
+
+  {
+    svn_client__private_ctx_t *const private_ctx =
+      svn_client__get_private_ctx(ctx);
+
+    return private_ctx->mergeinfo_memo
+           ? private_ctx->mergeinfo_memo->pool
+           : NULL;
+  }
+}
+
+svn_boolean_t
+svn_client__mergeinfo_memo_get(const void **result,
+                               svn_boolean_t *flag,
+                               svn_client_ctx_t *ctx,
+                               const char *key)
+{
+  svn_client__mergeinfo_memo_t *memo;
+  memo_entry_t *entry;
+
+  if (ctx == NULL)
+    return FALSE;
+
+  memo = svn_client__get_private_ctx(ctx)->mergeinfo_memo;
+  if (memo == NULL)
+    return FALSE;
+
+  entry = svn_hash_gets(memo->entries, key);
+  if (entry == NULL)
+    return FALSE;
+
+  *result = entry->result;
+  if (flag)
+    *flag = entry->flag;
+  return TRUE;
+}
+
+void
+svn_client__mergeinfo_memo_set(svn_client_ctx_t *ctx,
+                               const char *key,
+                               const void *result,
+                               svn_boolean_t flag)
+{
+  svn_client__mergeinfo_memo_t *memo;
+  memo_entry_t *entry;
+
+  if (ctx == NULL)
+    return;
+
+  memo = svn_client__get_private_ctx(ctx)->mergeinfo_memo;
+  if (memo == NULL)
+    return;
+
+  entry = apr_palloc(memo->pool, sizeof(*entry));
+  entry->result = result;
+  entry->flag = flag;
+  svn_hash_sets(memo->entries, apr_pstrdup(memo->pool, key), entry);
+}
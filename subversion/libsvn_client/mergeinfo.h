@@ -187,6 +187,10 @@ svn_client__get_wc_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
 
    RA_SESSION is an open RA session to the repository in which URL lives;
    it may be temporarily reparented by this function.
+
+   When the lookup memo on CTX is active (see
+   svn_client__mergeinfo_memo_begin()), repeated lookups are answered
+   from memory without a server round trip.
 */
 svn_error_t *
 svn_client__get_repos_mergeinfo(svn_mergeinfo_t *target_mergeinfo,
@@ -195,6 +199,7 @@ svn_client__get_repos_mergeinfo(svn_mergeinfo_t *target_mergeinfo,
                                 svn_revnum_t rev,
                                 svn_mergeinfo_inheritance_t inherit,
                                 svn_boolean_t squelch_incapable,
+                                svn_client_ctx_t *ctx,
                                 apr_pool_t *pool);
 
 /* If INCLUDE_DESCENDANTS is FALSE, behave exactly like
@@ -215,6 +220,7 @@ svn_client__get_repos_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
                                         svn_mergeinfo_inheritance_t inherit,
                                         svn_boolean_t squelch_incapable,
                                         svn_boolean_t include_descendants,
+                                        svn_client_ctx_t *ctx,
                                         apr_pool_t *result_pool,
                                         apr_pool_t *scratch_pool);
 
@@ -409,4 +415,62 @@ svn_client__mergeinfo_status(svn_boolean_t *mergeinfo_changes,
                              const char *local_abspath,
                              apr_pool_t *scratch_pool);
 
+
+/*** Memoization of immutable repository lookups ***/
+
+/* While a merge runs, the engine asks the repository for the same
+   immutable facts -- mergeinfo catalogs, node histories and youngest
+   common ancestors -- for overlapping subtrees over and over again,
+   each time paying a server round trip.  While the memo below is
+   active on a client context, the helpers that issue those round
+   trips answer repeated lookups from memory instead.
+
+   Only data that cannot change on the server during the operation is
+   memoized.  Working copy mergeinfo is modified by the merge itself
+   and must never be cached here. */
+
+/* The lookup memo; opaque outside mergeinfo.c. */
+typedef struct svn_client__mergeinfo_memo_t svn_client__mergeinfo_memo_t;
+
+/* Activate the lookup memo on CTX, allocating it in POOL, or join an
+   already active memo.  Every call must be paired with a call to
+   svn_client__mergeinfo_memo_end(); the memo is deactivated when the
+   outermost pair ends.  POOL must live until then. */
+void
+svn_client__mergeinfo_memo_begin(svn_client_ctx_t *ctx,
+                                 apr_pool_t *pool);
+
+/* Deactivate (or leave) the lookup memo on CTX.  A no-op when no memo
+   is active. */
+void
+svn_client__mergeinfo_memo_end(svn_client_ctx_t *ctx);
+
+/* Return the pool of the active lookup memo on CTX, or NULL when CTX
+   is NULL or no memo is active.  Results handed to
+   svn_client__mergeinfo_memo_set() must be allocated in (or duplicated
+   into) this pool. */
+apr_pool_t *
+svn_client__mergeinfo_memo_pool(svn_client_ctx_t *ctx);
+
+/* If the active lookup memo on CTX holds a result for KEY, set
+   *RESULT (and, when FLAG is not NULL, *FLAG) to the memoized values
+   and return TRUE.  Return FALSE when CTX is NULL, no memo is active
+   or KEY has not been seen.  The returned result is shared; callers
+   must duplicate it into their own pool. */
+svn_boolean_t
+svn_client__mergeinfo_memo_get(const void **result,
+                               svn_boolean_t *flag,
+                               svn_client_ctx_t *ctx,
+                               const char *key);
+
+/* Memoize RESULT and FLAG for KEY in the active lookup memo on CTX.
+   RESULT may be NULL and must be allocated in the memo's pool; see
+   svn_client__mergeinfo_memo_pool().  A no-op when CTX is NULL or no
+   memo is active. */
+void
+svn_client__mergeinfo_memo_set(svn_client_ctx_t *ctx,
+                               const char *key,
+                               const void *result,
+                               svn_boolean_t flag);
+
 #endif /* SVN_LIBSVN_CLIENT_MERGEINFO_H */
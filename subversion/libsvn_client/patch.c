@@ -43,6 +43,7 @@
 #include "client.h"
 
 #include "svn_private_config.h"
+#include "private/svn_adler32.h"
 #include "private/svn_eol_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_dep_compat.h"
@@ -130,6 +131,16 @@ typedef struct target_content_t {
                          apr_pool_t *scratch_pool);
   void *write_baton;
 
+  /* Maps the hash of a line's text, as it is compared during hunk
+   * matching, to an apr_array_header_t of the svn_linenum_t line
+   * numbers the text appears on.  NULL until built on demand by
+   * ensure_line_index(); used by scan_for_match() to probe only
+   * candidate lines instead of every line. */
+  apr_hash_t *line_index;
+
+  /* The pool LINE_INDEX lives in. */
+  apr_pool_t *line_index_pool;
+
 } target_content_t;
 
 typedef struct prop_patch_target_t {
@@ -762,6 +773,7 @@ init_prop_target(prop_patch_target_t **prop_target,
   content->eol_style = svn_subst_eol_style_none;
   content->lines = apr_array_make(result_pool, 0, sizeof(apr_off_t));
   content->hunks = apr_array_make(result_pool, 0, sizeof(hunk_info_t *));
+  content->line_index_pool = result_pool;
   content->keywords = apr_hash_make(result_pool);
 
   new_prop_target = apr_pcalloc(result_pool, sizeof(*new_prop_target));
@@ -1032,6 +1044,7 @@ init_patch_target(patch_target_t **patch_target,
   content->eol_style = svn_subst_eol_style_none;
   content->lines = apr_array_make(result_pool, 0, sizeof(apr_off_t));
   content->hunks = apr_array_make(result_pool, 0, sizeof(hunk_info_t *));
+  content->line_index_pool = result_pool;
   content->keywords = apr_hash_make(result_pool);
 
   target = apr_pcalloc(result_pool, sizeof(*target));
@@ -1665,6 +1678,236 @@ match_hunk(svn_boolean_t *matched, target_content_t *content,
   return SVN_NO_ERROR;
 }
 
+/* Compute the hash under which LINE is filed in the line index.
+ * This is the same rolling checksum the diff code hashes its tokens
+ * with. */
+static apr_uint32_t
+line_index_hash(const char *line)
+{
+  return svn__adler32(0, line, (apr_off_t)strlen(line));
+}
+
+/* Build CONTENT->LINE_INDEX, if it wasn't built already:  read all of
+ * the unpatched content once and file each line's number under the
+ * hash of its text.  If IGNORE_WHITESPACE is set, hash the lines with
+ * their whitespace collapsed, matching how they will be compared.
+ * When this function returns, neither CONTENT->CURRENT_LINE nor the
+ * file offset in the target file will have changed.
+ * Call cancel CANCEL_FUNC with baton CANCEL_BATON to trigger
+ * cancellation.  Do temporary allocations in SCRATCH_POOL. */
+static svn_error_t *
+ensure_line_index(target_content_t *content,
+                  svn_boolean_t ignore_whitespace,
+                  svn_cancel_func_t cancel_func, void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *pool = content->line_index_pool;
+  svn_linenum_t saved_line;
+  apr_pool_t *iterpool;
+
+  if (content->line_index)
+    return SVN_NO_ERROR;
+
+  content->line_index = apr_hash_make(pool);
+
+  saved_line = content->current_line;
+  SVN_ERR(seek_to_line(content, 1, scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (! content->eof)
+    {
+      svn_linenum_t line_number = content->current_line;
+      const char *line;
+      apr_uint32_t hash;
+      apr_array_header_t *line_numbers;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(readline(content, &line, iterpool, iterpool));
+
+      /* An empty line at EOF, or content we cannot read lines from. */
+      if (content->current_line == line_number)
+        break;
+
+      if (ignore_whitespace)
+        {
+          char *line_trimmed = apr_pstrdup(iterpool, line);
+
+          apr_collapse_spaces(line_trimmed, line_trimmed);
+          line = line_trimmed;
+        }
+
+      hash = line_index_hash(line);
+      line_numbers = apr_hash_get(content->line_index, &hash, sizeof(hash));
+      if (line_numbers == NULL)
+        {
+          apr_uint32_t *key = apr_pmemdup(pool, &hash, sizeof(hash));
+
+          line_numbers = apr_array_make(pool, 4, sizeof(svn_linenum_t));
+          apr_hash_set(content->line_index, key, sizeof(*key), line_numbers);
+        }
+      APR_ARRAY_PUSH(line_numbers, svn_linenum_t) = line_number;
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(seek_to_line(content, saved_line, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Indicate in *TAKEN whether a hunk matched at LINE of CONTENT would
+ * overlap a hunk that was already matched.  MATCH_MODIFIED is as for
+ * match_hunk(). */
+static void
+match_is_taken(svn_boolean_t *taken,
+               const target_content_t *content,
+               svn_linenum_t line,
+               svn_boolean_t match_modified)
+{
+  int i;
+
+  *taken = FALSE;
+
+  /* Don't allow hunks to match at overlapping locations. */
+  for (i = 0; i < content->hunks->nelts; i++)
+    {
+      const hunk_info_t *hi;
+      svn_linenum_t length;
+
+      hi = APR_ARRAY_IDX(content->hunks, i, const hunk_info_t *);
+
+      if (match_modified)
+        length = svn_diff_hunk_get_modified_length(hi->hunk);
+      else
+        length = svn_diff_hunk_get_original_length(hi->hunk);
+
+      *taken = (! hi->rejected &&
+                line >= hi->matched_line &&
+                line < (hi->matched_line + length));
+      if (*taken)
+        break;
+    }
+}
+
+/* The line-index driven implementation of scan_for_match(), which see
+ * for the semantics.  The anchor line of HUNK -- the first line that
+ * even a fuzzy match must reproduce exactly -- is looked up in
+ * CONTENT->LINE_INDEX, and only the candidate positions are verified
+ * with match_hunk().  The caller must ensure that the hunk is long
+ * enough to have an anchor line, i.e. longer than twice the effective
+ * fuzz. */
+static svn_error_t *
+scan_for_match_indexed(svn_linenum_t *matched_line,
+                       target_content_t *content,
+                       svn_diff_hunk_t *hunk, svn_boolean_t match_first,
+                       svn_linenum_t upper_line, svn_linenum_t fuzz,
+                       svn_boolean_t ignore_whitespace,
+                       svn_boolean_t match_modified,
+                       svn_cancel_func_t cancel_func, void *cancel_baton,
+                       apr_pool_t *pool)
+{
+  svn_linenum_t lower_line = content->current_line;
+  svn_linenum_t anchor_pos = fuzz - svn_diff_hunk__get_fuzz_penalty(hunk) + 1;
+  svn_stringbuf_t *hunk_line = NULL;
+  const char *anchor_line;
+  svn_boolean_t hunk_eof;
+  const apr_array_header_t *line_numbers;
+  apr_uint32_t hash;
+  svn_linenum_t i;
+  apr_pool_t *iterpool;
+
+  *matched_line = 0;
+
+  SVN_ERR(ensure_line_index(content, ignore_whitespace,
+                            cancel_func, cancel_baton, pool));
+
+  /* Fetch the anchor line of the hunk. */
+  if (match_modified)
+    svn_diff_hunk_reset_modified_text(hunk);
+  else
+    svn_diff_hunk_reset_original_text(hunk);
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < anchor_pos; i++)
+    {
+      svn_pool_clear(iterpool);
+
+      if (match_modified)
+        SVN_ERR(svn_diff_hunk_readline_modified_text(hunk, &hunk_line,
+                                                     NULL, &hunk_eof,
+                                                     pool, iterpool));
+      else
+        SVN_ERR(svn_diff_hunk_readline_original_text(hunk, &hunk_line,
+                                                     NULL, &hunk_eof,
+                                                     pool, iterpool));
+    }
+
+  /* Contract keywords, if any, like the comparison will. */
+  SVN_ERR(svn_subst_translate_cstring2(hunk_line->data, &anchor_line,
+                                       NULL, FALSE,
+                                       content->keywords, FALSE, pool));
+  if (ignore_whitespace)
+    {
+      char *anchor_line_trimmed = apr_pstrdup(pool, anchor_line);
+
+      apr_collapse_spaces(anchor_line_trimmed, anchor_line_trimmed);
+      anchor_line = anchor_line_trimmed;
+    }
+
+  /* If the anchor line occurs nowhere in the target, the hunk cannot
+   * match at all. */
+  hash = line_index_hash(anchor_line);
+  line_numbers = apr_hash_get(content->line_index, &hash, sizeof(hash));
+  if (line_numbers == NULL)
+    {
+      svn_pool_destroy(iterpool);
+      return SVN_NO_ERROR;
+    }
+
+  /* Verify the candidate positions, in ascending order. */
+  for (i = 0; i < (svn_linenum_t)line_numbers->nelts; i++)
+    {
+      svn_linenum_t anchor_at = APR_ARRAY_IDX(line_numbers, i,
+                                              svn_linenum_t);
+      svn_linenum_t candidate;
+      svn_boolean_t matched;
+      svn_boolean_t taken;
+
+      if (anchor_at < anchor_pos)
+        continue;
+      candidate = anchor_at - (anchor_pos - 1);
+
+      if (candidate < lower_line)
+        continue;
+      if (upper_line > 0 && candidate >= upper_line)
+        break;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(seek_to_line(content, candidate, iterpool));
+      SVN_ERR(match_hunk(&matched, content, hunk, fuzz, ignore_whitespace,
+                         match_modified, iterpool));
+      if (matched)
+        {
+          match_is_taken(&taken, content, candidate, match_modified);
+          if (! taken)
+            {
+              *matched_line = candidate;
+              if (match_first)
+                break;
+            }
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Scan lines of CONTENT for a match of the original text of HUNK,
  * up to but not including the specified UPPER_LINE. Use fuzz factor FUZZ.
  * If UPPER_LINE is zero scan until EOF occurs when reading from TARGET.
@@ -1689,9 +1932,34 @@ scan_for_match(svn_linenum_t *matched_line,
                svn_cancel_func_t cancel_func, void *cancel_baton,
                apr_pool_t *pool)
 {
+  svn_linenum_t fuzz_penalty = svn_diff_hunk__get_fuzz_penalty(hunk);
+  svn_linenum_t hunk_length;
   apr_pool_t *iterpool;
 
   *matched_line = 0;
+
+  /* A hunk whose fuzz penalty exceeds the fuzz factor cannot match
+   * anywhere, so don't bother scanning for it. */
+  if (fuzz_penalty > fuzz)
+    return SVN_NO_ERROR;
+
+  if (match_modified)
+    hunk_length = svn_diff_hunk_get_modified_length(hunk);
+  else
+    hunk_length = svn_diff_hunk_get_original_length(hunk);
+
+  /* If the hunk is long enough to have an anchor line -- a line which
+   * even a fuzzy match must reproduce exactly -- find the candidate
+   * positions through the line index instead of trying every line. */
+  if (hunk_length > 2 * (fuzz - fuzz_penalty))
+    return svn_error_trace(scan_for_match_indexed(matched_line, content,
+                                                  hunk, match_first,
+                                                  upper_line, fuzz,
+                                                  ignore_whitespace,
+                                                  match_modified,
+                                                  cancel_func, cancel_baton,
+                                                  pool));
+
   iterpool = svn_pool_create(pool);
   while ((content->current_line < upper_line || upper_line == 0) &&
          ! content->eof)
@@ -1707,28 +1975,11 @@ scan_for_match(svn_linenum_t *matched_line,
                          match_modified, iterpool));
       if (matched)
         {
-          svn_boolean_t taken = FALSE;
-          int i;
+          svn_boolean_t taken;
 
           /* Don't allow hunks to match at overlapping locations. */
-          for (i = 0; i < content->hunks->nelts; i++)
-            {
-              const hunk_info_t *hi;
-              svn_linenum_t length;
-
-              hi = APR_ARRAY_IDX(content->hunks, i, const hunk_info_t *);
-
-              if (match_modified)
-                length = svn_diff_hunk_get_modified_length(hi->hunk);
-              else
-                length = svn_diff_hunk_get_original_length(hi->hunk);
-
-              taken = (! hi->rejected &&
-                       content->current_line >= hi->matched_line &&
-                       content->current_line < (hi->matched_line + length));
-              if (taken)
-                break;
-            }
+          match_is_taken(&taken, content, content->current_line,
+                         match_modified);
 
           if (! taken)
             {
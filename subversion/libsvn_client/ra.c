@@ -1013,6 +1013,9 @@ svn_client__get_youngest_common_ancestor(svn_client__pathrev_t **ancestor_p,
   apr_hash_t *history1, *history2;
   svn_boolean_t has_rev_zero_history1;
   svn_boolean_t has_rev_zero_history2;
+  const char *memo_key;
+  const void *memoized;
+  apr_pool_t *memo_pool;
 
   if (strcmp(loc1->repos_root_url, loc2->repos_root_url) != 0)
     {
@@ -1020,6 +1023,26 @@ svn_client__get_youngest_common_ancestor(svn_client__pathrev_t **ancestor_p,
       return SVN_NO_ERROR;
     }
 
+  /* The common ancestor of two fixed locations cannot change on the
+     server, so an active lookup memo may answer without the two
+     history round trips.  Normalize the pair's order so that both
+     orderings share one memo entry. */
+  if (strcmp(loc1->url, loc2->url) < 0
+      || (strcmp(loc1->url, loc2->url) == 0 && loc1->rev <= loc2->rev))
+    memo_key = apr_psprintf(scratch_pool, "yca:%s@%ld|%s@%ld",
+                            loc1->url, loc1->rev, loc2->url, loc2->rev);
+  else
+    memo_key = apr_psprintf(scratch_pool, "yca:%s@%ld|%s@%ld",
+                            loc2->url, loc2->rev, loc1->url, loc1->rev);
+
+  if (svn_client__mergeinfo_memo_get(&memoized, NULL, ctx, memo_key))
+    {
+      *ancestor_p = memoized
+                    ? svn_client__pathrev_dup(memoized, result_pool)
+                    : NULL;
+      return SVN_NO_ERROR;
+    }
+
   /* Open an RA session for the two locations. */
   if (session == NULL)
     {
@@ -1054,6 +1077,15 @@ svn_client__get_youngest_common_ancestor(svn_client__pathrev_t **ancestor_p,
                                                     result_pool,
                                                     scratch_pool));
 
+  memo_pool = svn_client__mergeinfo_memo_pool(ctx);
+  if (memo_pool)
+    svn_client__mergeinfo_memo_set(ctx, memo_key,
+                                   *ancestor_p
+                                   ? svn_client__pathrev_dup(*ancestor_p,
+                                                             memo_pool)
+                                   : NULL,
+                                   FALSE);
+
   return SVN_NO_ERROR;
 }
 
@@ -29,6 +29,7 @@
 #include "svn_dirent_uri.h"
 
 #include "private/svn_editor.h"
+#include "private/svn_probes_private.h"
 
 #ifdef SVN_DEBUG
 /* This enables runtime checks of the editor API constraints.  This may
@@ -279,6 +280,8 @@ svn_editor_create(svn_editor_t **editor,
   (*editor)->state_pool = result_pool;
 #endif
 
+  SVN_PROBE1(editor__create, *editor);
+
   return SVN_NO_ERROR;
 }
 
@@ -855,6 +858,8 @@ svn_editor_complete(svn_editor_t *editor)
 {
   svn_error_t *err = SVN_NO_ERROR;
 
+  SVN_PROBE1(editor__complete, editor);
+
   SHOULD_NOT_BE_FINISHED(editor);
 #ifdef ENABLE_ORDERING_CHECK
   SVN_ERR_ASSERT(apr_hash_count(editor->pending_incomplete_children) == 0);
@@ -879,6 +884,8 @@ svn_editor_abort(svn_editor_t *editor)
 {
   svn_error_t *err = SVN_NO_ERROR;
 
+  SVN_PROBE1(editor__abort, editor);
+
   SHOULD_NOT_BE_FINISHED(editor);
 
   if (editor->funcs.cb_abort)
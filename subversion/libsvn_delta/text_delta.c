@@ -629,16 +629,20 @@ static APR_INLINE char *
 patterning_copy(char *target, const char *source, apr_size_t len)
 {
   /* If the source and target overlap, repeat the overlapping pattern
-     in the target buffer. Always copy from the source buffer because
-     presumably it will be in the L1 cache after the first iteration
-     and doing this should avoid pipeline stalls due to write/read
-     dependencies. */
-  const apr_size_t overlap = target - source;
-  while (len > overlap)
+     in the target buffer.  All of [SOURCE, TARGET) contains valid data
+     and every chunk we copy extends that range, so the amount we can
+     transfer per memcpy() doubles with each iteration.  That turns
+     short-period patterns (e.g. runs of a single byte or a small
+     binary motif) from a byte-wise loop into O(lg LEN) block copies,
+     each a forward non-overlapping memcpy() that the C library will
+     execute with vector instructions where available. */
+  apr_size_t chunk = target - source;
+  while (len > chunk)
     {
-      memcpy(target, source, overlap);
-      target += overlap;
-      len -= overlap;
+      memcpy(target, source, chunk);
+      target += chunk;
+      len -= chunk;
+      chunk *= 2;
     }
 
   /* Copy any remaining source pattern. */
@@ -125,11 +125,15 @@ svn_diff__diff(svn_diff__lcs_t *lcs,
 }
 
 
-svn_error_t *
-svn_diff_diff_2(svn_diff_t **diff,
-                void *diff_baton,
-                const svn_diff_fns2_t *vtable,
-                apr_pool_t *pool)
+/* The guts of svn_diff_diff_2() and svn_diff__diff_2_histogram().
+ * If USE_HISTOGRAM is set, try the histogram engine first and fall
+ * back to the Myers LCS when it refuses the input. */
+static svn_error_t *
+diff_2(svn_diff_t **diff,
+       void *diff_baton,
+       const svn_diff_fns2_t *vtable,
+       svn_boolean_t use_histogram,
+       apr_pool_t *pool)
 {
   svn_diff__tree_t *tree;
   svn_diff__position_t *position_list[2];
@@ -185,9 +189,15 @@ svn_diff_diff_2(svn_diff_t **diff,
                                                subpool);
 
   /* Get the lcs */
-  lcs = svn_diff__lcs(position_list[0], position_list[1], token_counts[0],
-                      token_counts[1], num_tokens, prefix_lines,
-                      suffix_lines, subpool);
+  lcs = NULL;
+  if (use_histogram)
+    lcs = svn_diff__lcs_histogram(position_list[0], position_list[1],
+                                  num_tokens, prefix_lines, suffix_lines,
+                                  subpool);
+  if (lcs == NULL)
+    lcs = svn_diff__lcs(position_list[0], position_list[1], token_counts[0],
+                        token_counts[1], num_tokens, prefix_lines,
+                        suffix_lines, subpool);
 
   /* Produce the diff */
   *diff = svn_diff__diff(lcs, 1, 1, TRUE, pool);
@@ -197,3 +207,21 @@ svn_diff_diff_2(svn_diff_t **diff,
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_diff_diff_2(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                apr_pool_t *pool)
+{
+  return svn_error_trace(diff_2(diff, diff_baton, vtable, FALSE, pool));
+}
+
+svn_error_t *
+svn_diff__diff_2_histogram(svn_diff_t **diff,
+                           void *diff_baton,
+                           const svn_diff_fns2_t *vtable,
+                           apr_pool_t *pool)
+{
+  return svn_error_trace(diff_2(diff, diff_baton, vtable, TRUE, pool));
+}
@@ -114,6 +114,33 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
               apr_off_t suffix_lines,
               apr_pool_t *pool);
 
+/*
+ * Like svn_diff__lcs(), but use the histogram algorithm: recursively
+ * anchor the comparison at the least frequent common token, which is
+ * roughly linear on typical source changes but does not guarantee a
+ * minimal diff.  Returns NULL if the input has no suitable anchors
+ * (or nests too deeply), in which case the caller should fall back to
+ * svn_diff__lcs().
+ */
+svn_diff__lcs_t *
+svn_diff__lcs_histogram(svn_diff__position_t *position_list1,
+                        svn_diff__position_t *position_list2,
+                        svn_diff__token_index_t num_tokens,
+                        apr_off_t prefix_lines,
+                        apr_off_t suffix_lines,
+                        apr_pool_t *pool);
+
+/*
+ * Like svn_diff_diff_2(), but compute the comparison with the
+ * histogram engine, falling back to the Myers LCS for inputs that
+ * svn_diff__lcs_histogram() refuses.
+ */
+svn_error_t *
+svn_diff__diff_2_histogram(svn_diff_t **diff,
+                           void *diff_baton,
+                           const svn_diff_fns2_t *vtable,
+                           apr_pool_t *pool);
+
 
 /*
  * Returns number of tokens in a tree
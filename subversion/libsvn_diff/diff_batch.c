@@ -0,0 +1,157 @@
+/*
+ * diff_batch.c :  batched comparison of multiple file pairs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr.h>
+#include <apr_pools.h>
+#include <apr_general.h>
+
+#include "svn_error.h"
+#include "svn_diff.h"
+#include "svn_types.h"
+
+#include "private/svn_diff_private.h"
+#include "private/svn_task.h"
+
+#include "diff.h"
+
+
+/* Data shared by all pairs of one svn_diff__file_diff_pairs() run. */
+typedef struct batch_baton_t
+{
+  const apr_array_header_t *pairs;
+  const svn_diff_file_options_t *options;
+  svn_diff__file_pair_receiver_t receiver;
+  void *receiver_baton;
+} batch_baton_t;
+
+/* Process and output baton for a single file pair. */
+typedef struct pair_baton_t
+{
+  batch_baton_t *batch;
+  const svn_diff__file_pair_t *pair;
+} pair_baton_t;
+
+/* Compare the single pair given by PROCESS_BATON and return the
+ * resulting svn_diff_t in *RESULT.  Implements
+ * svn_task__process_func_t; runs on a worker thread. */
+static svn_error_t *
+pair_process_func(void **result,
+                  svn_task__t *task,
+                  void *thread_context,
+                  void *process_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  pair_baton_t *pb = process_baton;
+  svn_diff_t *diff;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  SVN_ERR(svn_diff_file_diff_2(&diff, pb->pair->original,
+                               pb->pair->modified, pb->batch->options,
+                               result_pool));
+
+  *result = diff;
+  return SVN_NO_ERROR;
+}
+
+/* Forward the comparison RESULT of the pair given by OUTPUT_BATON to
+ * the user's receiver.  Implements svn_task__output_func_t; called in
+ * the order the pairs were added. */
+static svn_error_t *
+pair_output_func(svn_task__t *task,
+                 void *result,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  pair_baton_t *pb = output_baton;
+
+  return svn_error_trace(pb->batch->receiver(result, pb->pair,
+                                             pb->batch->receiver_baton,
+                                             scratch_pool));
+}
+
+/* Root task of a batch run:  spawn one sub-task per file pair in the
+ * PROCESS_BATON's pair array.  Implements svn_task__process_func_t. */
+static svn_error_t *
+batch_process_func(void **result,
+                   svn_task__t *task,
+                   void *thread_context,
+                   void *process_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  batch_baton_t *bb = process_baton;
+  int i;
+
+  for (i = 0; i < bb->pairs->nelts; ++i)
+    {
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      pair_baton_t *pb = apr_palloc(process_pool, sizeof(*pb));
+
+      pb->batch = bb;
+      pb->pair = &APR_ARRAY_IDX(bb->pairs, i, const svn_diff__file_pair_t);
+
+      SVN_ERR(svn_task__add(task, process_pool, NULL,
+                            pair_process_func, pb,
+                            pair_output_func, pb));
+    }
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_diff__file_diff_pairs(const apr_array_header_t *pairs,
+                          const svn_diff_file_options_t *options,
+                          apr_int32_t thread_count,
+                          svn_diff__file_pair_receiver_t receiver,
+                          void *receiver_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool)
+{
+  batch_baton_t bb;
+
+  bb.pairs = pairs;
+  bb.options = options;
+  bb.receiver = receiver;
+  bb.receiver_baton = receiver_baton;
+
+  SVN_ERR(svn_task__run(thread_count,
+                        batch_process_func, &bb,
+                        NULL, NULL,
+                        NULL, NULL,
+                        cancel_func, cancel_baton,
+                        scratch_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
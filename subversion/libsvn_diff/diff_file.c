@@ -1181,6 +1181,7 @@ static const svn_diff_fns2_t svn_diff__file_vtable =
 
 /* Id for the --ignore-eol-style option, which doesn't have a short name. */
 #define SVN_DIFF__OPT_IGNORE_EOL_STYLE 256
+#define SVN_DIFF__OPT_HISTOGRAM_DIFF 257
 
 /* Options supported by svn_diff_file_options_parse(). */
 static const apr_getopt_option_t diff_options[] =
@@ -1188,6 +1189,7 @@ static const apr_getopt_option_t diff_options[] =
   { "ignore-space-change", 'b', 0, NULL },
   { "ignore-all-space", 'w', 0, NULL },
   { "ignore-eol-style", SVN_DIFF__OPT_IGNORE_EOL_STYLE, 0, NULL },
+  { "histogram-diff", SVN_DIFF__OPT_HISTOGRAM_DIFF, 0, NULL },
   { "show-c-function", 'p', 0, NULL },
   /* ### For compatibility; we don't support the argument to -u, because
    * ### we don't have optional argument support. */
@@ -1292,6 +1294,9 @@ svn_diff_file_options_parse(svn_diff_file_options_t *options,
         case SVN_DIFF__OPT_IGNORE_EOL_STYLE:
           options->ignore_eol_style = TRUE;
           break;
+        case SVN_DIFF__OPT_HISTOGRAM_DIFF:
+          options->use_histogram_diff = TRUE;
+          break;
         case 'p':
           options->show_c_function = TRUE;
           break;
@@ -1326,7 +1331,11 @@ svn_diff_file_diff_2(svn_diff_t **diff,
   baton.files[1].path = modified;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff_2(diff, &baton, &svn_diff__file_vtable, pool));
+  if (options->use_histogram_diff)
+    SVN_ERR(svn_diff__diff_2_histogram(diff, &baton, &svn_diff__file_vtable,
+                                       pool));
+  else
+    SVN_ERR(svn_diff_diff_2(diff, &baton, &svn_diff__file_vtable, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -293,6 +293,10 @@ svn_diff_mem_string_diff(svn_diff_t **diff,
 
   baton.normalization_options = options;
 
+  if (options->use_histogram_diff)
+    return svn_diff__diff_2_histogram(diff, &baton, &svn_diff__mem_vtable,
+                                      pool);
+
   return svn_diff_diff_2(diff, &baton, &svn_diff__mem_vtable, pool);
 }
 
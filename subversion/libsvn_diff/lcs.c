@@ -26,6 +26,8 @@
 #include <apr_pools.h>
 #include <apr_general.h>
 
+#include "svn_pools.h"
+
 #include "diff.h"
 
 
@@ -373,3 +375,328 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
   else
     return lcs;
 }
+
+
+/*
+ * Histogram diff.
+ *
+ * Instead of searching for a provably minimal edit script, recursively
+ * anchor the comparison at an occurrence of the least frequent token
+ * common to both (sub)sequences, in the spirit of the patience and
+ * histogram algorithms popularized by git.  Typical source changes are
+ * handled in roughly linear time, and anchoring at rare lines tends to
+ * keep hunks aligned with the logical structure of the file.  The
+ * result is a valid common-subsequence chain, but not necessarily the
+ * longest one; inputs for which no suitable anchors exist are rejected
+ * so that the caller can fall back to the Myers engine above.
+ */
+
+/* Give up on tokens that occur more often than this in the first
+ * sequence; scanning their occurrence chains would degenerate into
+ * the quadratic behavior we are trying to avoid. */
+#define HISTOGRAM_MAX_CHAIN 64
+
+/* Give up when anchor recursion nests deeper than this.  Each level
+ * costs a histogram rebuild of the left subregion, so truly adversarial
+ * inputs are better served by the Myers engine. */
+#define HISTOGRAM_MAX_DEPTH 64
+
+/* A common run emitted by the histogram engine, as indices into the
+ * position arrays of histogram_baton_t. */
+typedef struct histogram_chunk_t
+{
+  apr_off_t a;
+  apr_off_t b;
+  apr_off_t length;
+} histogram_chunk_t;
+
+/* Shared state of one histogram diff run. */
+typedef struct histogram_baton_t
+{
+  /* The two token sequences as random-access arrays, plus their
+   * token indices, extracted once from the position rings. */
+  svn_diff__position_t **pos[2];
+  svn_diff__token_index_t *tok[2];
+
+  /* Per-token occurrence data for the first sequence, valid for the
+   * region whose serial number matches STAMP[token].  FIRST[token] is
+   * the lowest occurrence index and NEXT_OCC[i] links to the next
+   * higher one; COUNT[token] is the number of occurrences. */
+  apr_off_t *first;
+  apr_off_t *count;
+  apr_off_t *stamp;
+  apr_off_t *next_occ;
+  apr_off_t serial;
+
+  /* Common runs found so far, in ascending order. */
+  apr_array_header_t *chunks;
+} histogram_baton_t;
+
+/* Fill HB's occurrence chains for the region [A_LO, A_HI) of the first
+ * sequence.  Chains of earlier regions expire via the serial stamp. */
+static void
+histogram_build(histogram_baton_t *hb, apr_off_t a_lo, apr_off_t a_hi)
+{
+  apr_off_t i;
+
+  ++hb->serial;
+  for (i = a_hi; i-- > a_lo; )
+    {
+      const svn_diff__token_index_t token = hb->tok[0][i];
+
+      if (hb->stamp[token] != hb->serial)
+        {
+          hb->stamp[token] = hb->serial;
+          hb->count[token] = 0;
+          hb->first[token] = -1;
+        }
+
+      hb->next_occ[i] = hb->first[token];
+      hb->first[token] = i;
+      hb->count[token]++;
+    }
+}
+
+/* Find all common runs between [A_LO, A_HI) of the first sequence and
+ * [B_LO, B_HI) of the second and append them to HB->CHUNKS in order.
+ * DEPTH is the current recursion depth.  Return FALSE if the region
+ * has common tokens but no usable anchor (or nests too deeply), i.e.
+ * the whole comparison should be redone with the Myers engine. */
+static svn_boolean_t
+histogram_region(histogram_baton_t *hb,
+                 apr_off_t a_lo, apr_off_t a_hi,
+                 apr_off_t b_lo, apr_off_t b_hi,
+                 int depth)
+{
+  while (a_lo < a_hi && b_lo < b_hi)
+    {
+      svn_boolean_t found_common = FALSE;
+      svn_boolean_t have_anchor = FALSE;
+      apr_off_t best_a = 0, best_b = 0, best_length = 0;
+      apr_off_t best_rarity = HISTOGRAM_MAX_CHAIN + 1;
+      apr_off_t j;
+      histogram_chunk_t *chunk;
+
+      if (depth > HISTOGRAM_MAX_DEPTH)
+        return FALSE;
+
+      histogram_build(hb, a_lo, a_hi);
+
+      /* Pick the anchor:  among all common runs discovered by probing
+       * the occurrence chains, prefer the one built around the rarest
+       * tokens, then the longest. */
+      for (j = b_lo; j < b_hi; )
+        {
+          const svn_diff__token_index_t token = hb->tok[1][j];
+          apr_off_t next_j = j + 1;
+
+          if (hb->stamp[token] == hb->serial && hb->count[token] > 0)
+            {
+              found_common = TRUE;
+              if (hb->count[token] <= HISTOGRAM_MAX_CHAIN
+                  && hb->count[token] <= best_rarity)
+                {
+                  apr_off_t i;
+                  for (i = hb->first[token]; i >= 0; i = hb->next_occ[i])
+                    {
+                      apr_off_t a_start = i, b_start = j;
+                      apr_off_t a_end = i + 1, b_end = j + 1;
+                      apr_off_t rarity = hb->count[token];
+                      apr_off_t k;
+
+                      while (a_start > a_lo && b_start > b_lo
+                             && hb->tok[0][a_start - 1]
+                                == hb->tok[1][b_start - 1])
+                        {
+                          --a_start;
+                          --b_start;
+                        }
+                      while (a_end < a_hi && b_end < b_hi
+                             && hb->tok[0][a_end] == hb->tok[1][b_end])
+                        {
+                          ++a_end;
+                          ++b_end;
+                        }
+
+                      for (k = a_start; k < a_end; ++k)
+                        if (hb->count[hb->tok[0][k]] < rarity)
+                          rarity = hb->count[hb->tok[0][k]];
+
+                      if (!have_anchor
+                          || rarity < best_rarity
+                          || (rarity == best_rarity
+                              && a_end - a_start > best_length))
+                        {
+                          have_anchor = TRUE;
+                          best_a = a_start;
+                          best_b = b_start;
+                          best_length = a_end - a_start;
+                          best_rarity = rarity;
+                        }
+
+                      if (b_end > next_j)
+                        next_j = b_end;
+                    }
+                }
+            }
+
+          j = next_j;
+        }
+
+      if (!have_anchor)
+        return !found_common;
+
+      /* Recurse to the left of the anchor, emit it, then iterate on
+       * the region to its right. */
+      if (!histogram_region(hb, a_lo, best_a, b_lo, best_b, depth + 1))
+        return FALSE;
+
+      chunk = apr_array_push(hb->chunks);
+      chunk->a = best_a;
+      chunk->b = best_b;
+      chunk->length = best_length;
+
+      a_lo = best_a + best_length;
+      b_lo = best_b + best_length;
+    }
+
+  return TRUE;
+}
+
+/* Turn the position ring ending at TAIL into a random-access array.
+ * Store the positions in *POS, their token indices in *TOK and the
+ * element count in *LENGTH; allocate the arrays in POOL. */
+static void
+histogram_read_ring(svn_diff__position_t ***pos,
+                    svn_diff__token_index_t **tok,
+                    apr_off_t *length,
+                    svn_diff__position_t *tail,
+                    apr_pool_t *pool)
+{
+  svn_diff__position_t *current;
+  apr_off_t n = 0;
+  apr_off_t i;
+
+  current = tail;
+  do
+    {
+      ++n;
+      current = current->next;
+    }
+  while (current != tail);
+
+  *pos = apr_palloc(pool, (apr_size_t)n * sizeof(**pos));
+  *tok = apr_palloc(pool, (apr_size_t)n * sizeof(**tok));
+
+  current = tail->next;
+  for (i = 0; i < n; ++i)
+    {
+      (*pos)[i] = current;
+      (*tok)[i] = current->token_index;
+      current = current->next;
+    }
+
+  *length = n;
+}
+
+svn_diff__lcs_t *
+svn_diff__lcs_histogram(svn_diff__position_t *position_list1,
+                        svn_diff__position_t *position_list2,
+                        svn_diff__token_index_t num_tokens,
+                        apr_off_t prefix_lines,
+                        apr_off_t suffix_lines,
+                        apr_pool_t *pool)
+{
+  histogram_baton_t hb;
+  apr_off_t length[2];
+  apr_off_t eof_offset[2];
+  svn_diff__token_index_t token_index;
+  svn_diff__lcs_t *lcs, **lcs_ref;
+  apr_pool_t *scratch_pool;
+  int i;
+
+  /* Empty sequences are cheap for the Myers engine; let it handle
+   * them and keep the code below free of NULL checks. */
+  if (position_list1 == NULL || position_list2 == NULL)
+    return NULL;
+
+  scratch_pool = svn_pool_create(pool);
+
+  histogram_read_ring(&hb.pos[0], &hb.tok[0], &length[0], position_list1,
+                      scratch_pool);
+  histogram_read_ring(&hb.pos[1], &hb.tok[1], &length[1], position_list2,
+                      scratch_pool);
+
+  hb.first = apr_palloc(scratch_pool,
+                        (apr_size_t)num_tokens * sizeof(*hb.first));
+  hb.count = apr_palloc(scratch_pool,
+                        (apr_size_t)num_tokens * sizeof(*hb.count));
+  hb.stamp = apr_palloc(scratch_pool,
+                        (apr_size_t)num_tokens * sizeof(*hb.stamp));
+  hb.next_occ = apr_palloc(scratch_pool,
+                           (apr_size_t)length[0] * sizeof(*hb.next_occ));
+  for (token_index = 0; token_index < num_tokens; token_index++)
+    hb.stamp[token_index] = 0;
+  hb.serial = 0;
+
+  hb.chunks = apr_array_make(scratch_pool, 64, sizeof(histogram_chunk_t));
+
+  if (!histogram_region(&hb, 0, length[0], 0, length[1], 0))
+    {
+      svn_pool_destroy(scratch_pool);
+      return NULL;
+    }
+
+  /* Build the lcs chain from the chunk list, with the same EOF
+   * sentinel and prefix/suffix handling as svn_diff__lcs(). */
+  eof_offset[0] = position_list1->offset + suffix_lines + 1;
+  eof_offset[1] = position_list2->offset + suffix_lines + 1;
+
+  lcs_ref = &lcs;
+  for (i = 0; i < hb.chunks->nelts; ++i)
+    {
+      const histogram_chunk_t *chunk
+        = &APR_ARRAY_IDX(hb.chunks, i, histogram_chunk_t);
+      svn_diff__lcs_t *new_lcs = apr_palloc(pool, sizeof(*new_lcs));
+
+      new_lcs->position[0] = hb.pos[0][chunk->a];
+      new_lcs->position[1] = hb.pos[1][chunk->b];
+      new_lcs->length = chunk->length;
+      new_lcs->refcount = 1;
+
+      *lcs_ref = new_lcs;
+      lcs_ref = &new_lcs->next;
+    }
+
+  if (suffix_lines)
+    *lcs_ref = prepend_lcs(NULL, suffix_lines,
+                           eof_offset[0] - suffix_lines,
+                           eof_offset[1] - suffix_lines,
+                           pool);
+  else
+    *lcs_ref = NULL;
+
+  /* The EOF sentinel. */
+  {
+    svn_diff__lcs_t *eof_lcs = apr_palloc(pool, sizeof(*eof_lcs));
+
+    eof_lcs->position[0] = apr_pcalloc(pool, sizeof(*eof_lcs->position[0]));
+    eof_lcs->position[0]->offset = eof_offset[0];
+    eof_lcs->position[1] = apr_pcalloc(pool, sizeof(*eof_lcs->position[1]));
+    eof_lcs->position[1]->offset = eof_offset[1];
+    eof_lcs->length = 0;
+    eof_lcs->refcount = 1;
+    eof_lcs->next = NULL;
+
+    while (*lcs_ref)
+      lcs_ref = &(*lcs_ref)->next;
+    *lcs_ref = eof_lcs;
+  }
+
+  svn_pool_destroy(scratch_pool);
+
+  if (prefix_lines)
+    return prepend_lcs(lcs, prefix_lines, 1, 1, pool);
+  else
+    return lcs;
+}
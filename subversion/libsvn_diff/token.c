@@ -34,17 +34,20 @@
 
 
 /*
- * Prime number to use as the size of the hash table.  This number was
- * not selected by testing of any kind and may need tweaking.
+ * Initial number of slots in the token table.  Must be a power of two
+ * so that the table can simply double whenever it fills up.
  */
-#define SVN_DIFF__HASH_SIZE 127
+#define SVN_DIFF__INITIAL_HASH_SIZE 1024
+
+/*
+ * Number of token nodes to allocate at once.  Tokenizing large files
+ * creates one node per distinct line; carving them out of blocks
+ * keeps them tightly packed and off the allocator's hot path.
+ */
+#define SVN_DIFF__NODE_BLOCK_SIZE 256
 
 struct svn_diff__node_t
 {
-  svn_diff__node_t       *parent;
-  svn_diff__node_t       *left;
-  svn_diff__node_t       *right;
-
   apr_uint32_t            hash;
   svn_diff__token_index_t index;
   void                   *token;
@@ -52,11 +55,33 @@ struct svn_diff__node_t
 
 struct svn_diff__tree_t
 {
-  svn_diff__node_t       *root[SVN_DIFF__HASH_SIZE];
+  /* Open addressing token table with linear probing.  Slots are
+   * either NULL or point into the node blocks below.  SIZE is always
+   * a power of two and the table is grown before it gets more than
+   * 2/3 full, so probe sequences stay short. */
+  svn_diff__node_t      **slots;
+  apr_size_t              size;
+
+  /* Bump allocator for nodes:  NODES_LEFT unused entries starting at
+   * NEXT_NODE, refilled one block at a time from POOL. */
+  svn_diff__node_t       *next_node;
+  apr_size_t              nodes_left;
+
   apr_pool_t             *pool;
   svn_diff__token_index_t node_count;
 };
 
+/* Map the token HASH to a slot index in a table of SIZE slots.  The
+ * multiplication spreads the entropy of all input bits into the top
+ * bits before we mask, compensating for weak hash functions such as
+ * the adler32 used by the file and memory datasources.
+ */
+static APR_INLINE apr_size_t
+hash_to_slot(apr_uint32_t hash, apr_size_t size)
+{
+  return (hash * 0xd1f3da69) & (size - 1);
+}
+
 
 /*
  * Returns number of tokens in a tree
@@ -76,9 +101,41 @@ svn_diff__tree_create(svn_diff__tree_t **tree, apr_pool_t *pool)
 {
   *tree = apr_pcalloc(pool, sizeof(**tree));
   (*tree)->pool = pool;
+  (*tree)->size = SVN_DIFF__INITIAL_HASH_SIZE;
+  (*tree)->slots = apr_pcalloc(pool,
+                               (*tree)->size * sizeof(*(*tree)->slots));
   (*tree)->node_count = 0;
 }
 
+/* Double the size of TREE's slot table and redistribute all nodes.
+ * The old table is left to TREE->POOL; since the table doubles, the
+ * waste is bounded by the size of the final table.
+ */
+static void
+tree_grow(svn_diff__tree_t *tree)
+{
+  svn_diff__node_t **old_slots = tree->slots;
+  apr_size_t old_size = tree->size;
+  apr_size_t i;
+
+  tree->size = old_size * 2;
+  tree->slots = apr_pcalloc(tree->pool, tree->size * sizeof(*tree->slots));
+
+  for (i = 0; i < old_size; i++)
+    {
+      svn_diff__node_t *node = old_slots[i];
+      apr_size_t slot;
+
+      if (node == NULL)
+        continue;
+
+      slot = hash_to_slot(node->hash, tree->size);
+      while (tree->slots[slot] != NULL)
+        slot = (slot + 1) & (tree->size - 1);
+
+      tree->slots[slot] = node;
+    }
+}
 
 static svn_error_t *
 tree_insert_token(svn_diff__node_t **node, svn_diff__tree_t *tree,
@@ -87,56 +144,59 @@ tree_insert_token(svn_diff__node_t **node, svn_diff__tree_t *tree,
                   apr_uint32_t hash, void *token)
 {
   svn_diff__node_t *new_node;
-  svn_diff__node_t **node_ref;
-  svn_diff__node_t *parent;
+  apr_size_t slot;
   int rv;
 
   SVN_ERR_ASSERT(token);
 
-  parent = NULL;
-  node_ref = &tree->root[hash % SVN_DIFF__HASH_SIZE];
-
-  while (*node_ref != NULL)
+  slot = hash_to_slot(hash, tree->size);
+  while (tree->slots[slot] != NULL)
     {
-      parent = *node_ref;
-
-      rv = hash - parent->hash;
-      if (!rv)
-        SVN_ERR(vtable->token_compare(diff_baton, parent->token, token, &rv));
-
-      if (rv == 0)
-        {
-          /* Discard the previous token.  This helps in cases where
-           * only recently read tokens are still in memory.
-           */
-          if (vtable->token_discard != NULL)
-            vtable->token_discard(diff_baton, parent->token);
-
-          parent->token = token;
-          *node = parent;
+      svn_diff__node_t *probe = tree->slots[slot];
 
-          return SVN_NO_ERROR;
-        }
-      else if (rv > 0)
-        {
-          node_ref = &parent->left;
-        }
-      else
+      if (probe->hash == hash)
         {
-          node_ref = &parent->right;
+          SVN_ERR(vtable->token_compare(diff_baton, probe->token, token,
+                                        &rv));
+          if (rv == 0)
+            {
+              /* Discard the previous token.  This helps in cases where
+               * only recently read tokens are still in memory.
+               */
+              if (vtable->token_discard != NULL)
+                vtable->token_discard(diff_baton, probe->token);
+
+              probe->token = token;
+              *node = probe;
+
+              return SVN_NO_ERROR;
+            }
         }
+
+      slot = (slot + 1) & (tree->size - 1);
     }
 
   /* Create a new node */
-  new_node = apr_palloc(tree->pool, sizeof(*new_node));
-  new_node->parent = parent;
-  new_node->left = NULL;
-  new_node->right = NULL;
+  if (tree->nodes_left == 0)
+    {
+      tree->next_node = apr_palloc(tree->pool,
+                                   SVN_DIFF__NODE_BLOCK_SIZE
+                                     * sizeof(*tree->next_node));
+      tree->nodes_left = SVN_DIFF__NODE_BLOCK_SIZE;
+    }
+
+  new_node = tree->next_node++;
+  tree->nodes_left--;
   new_node->hash = hash;
   new_node->token = token;
   new_node->index = tree->node_count++;
 
-  *node = *node_ref = new_node;
+  tree->slots[slot] = *node = new_node;
+
+  /* Keep the table at most 2/3 full.  Growing after the insertion
+   * means the slot found above is never invalidated mid-probe. */
+  if ((apr_size_t)tree->node_count * 3 > tree->size * 2)
+    tree_grow(tree);
 
   return SVN_NO_ERROR;
 }
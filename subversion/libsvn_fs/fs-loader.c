@@ -82,6 +82,11 @@ static apr_pool_t *common_pool = NULL;
 static svn_mutex__t *common_pool_lock = NULL;
 static svn_atomic_t common_pool_initialized = FALSE;
 
+/* Cache of FS types of repositories opened before, mapping FS path to
+   fs_type string.  Lazily allocated in COMMON_POOL and protected by
+   COMMON_POOL_LOCK.  May be NULL. */
+static apr_hash_t *fs_type_cache = NULL;
+
 
 /* --- Utility functions for the loader --- */
 
@@ -360,6 +365,34 @@ svn_fs_type(const char **fs_type, const char *path, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Set *FS_TYPE to the cached FS type for PATH, or to NULL if the type
+   has not been cached, yet.  To be called with COMMON_POOL_LOCK held. */
+static svn_error_t *
+fs_type_cache_get(const char **fs_type, const char *path)
+{
+  *fs_type = fs_type_cache
+           ? apr_hash_get(fs_type_cache, path, APR_HASH_KEY_STRING)
+           : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Remember FS_TYPE as the type of the filesystem at PATH, or forget any
+   cached type for PATH if FS_TYPE is NULL.  To be called with
+   COMMON_POOL_LOCK held. */
+static svn_error_t *
+fs_type_cache_set(const char *path, const char *fs_type)
+{
+  if (fs_type_cache == NULL)
+    fs_type_cache = apr_hash_make(common_pool);
+
+  apr_hash_set(fs_type_cache, apr_pstrdup(common_pool, path),
+               APR_HASH_KEY_STRING,
+               fs_type ? apr_pstrdup(common_pool, fs_type) : NULL);
+
+  return SVN_NO_ERROR;
+}
+
 /* Fetch the library vtable for an existing FS. */
 static svn_error_t *
 fs_library_vtable(fs_library_vtable_t **vtable, const char *path,
@@ -367,7 +400,26 @@ fs_library_vtable(fs_library_vtable_t **vtable, const char *path,
 {
   const char *fs_type;
 
-  SVN_ERR(svn_fs_type(&fs_type, path, pool));
+  /* Best-effort init, see get_library_vtable_direct. */
+  SVN_ERR(svn_fs_initialize(NULL));
+
+  /* Repeated opens of the same filesystem - in particular by mod_dav_svn,
+     which opens the FS anew for every request - keep re-reading the same
+     fs-type file.  The type of an existing filesystem only changes when
+     it gets deleted and re-created, so cache it per path; the functions
+     that create, delete or hotcopy a filesystem keep the cache in sync. */
+  SVN_MUTEX__WITH_LOCK(common_pool_lock, fs_type_cache_get(&fs_type, path));
+  if (fs_type == NULL)
+    {
+      SVN_ERR(svn_fs_type(&fs_type, path, pool));
+
+      /* Do not cache SVN_FS_TYPE_BDB:  it doubles as the fallback answer
+         for directories without an fs-type file, including directories
+         that are not filesystems at all. */
+      if (strcmp(fs_type, SVN_FS_TYPE_BDB) != 0)
+        SVN_MUTEX__WITH_LOCK(common_pool_lock,
+                             fs_type_cache_set(path, fs_type));
+    }
 
   /* Fetch the library vtable by name, now that we've chosen one. */
   SVN_ERR(get_library_vtable(vtable, fs_type, pool));
@@ -399,6 +451,7 @@ static apr_status_t uninit(void *data)
   common_pool = NULL;
   common_pool_lock = NULL;
   common_pool_initialized = 0;
+  fs_type_cache = NULL;
 
   return APR_SUCCESS;
 }
@@ -538,6 +591,7 @@ svn_fs_create2(svn_fs_t **fs_p,
   /* Create the FS directory and write out the fsap-name file. */
   SVN_ERR(svn_io_dir_make_sgid(path, APR_OS_DEFAULT, scratch_pool));
   SVN_ERR(write_fs_type(path, fs_type, scratch_pool));
+  SVN_MUTEX__WITH_LOCK(common_pool_lock, fs_type_cache_set(path, fs_type));
 
   /* Perform the actual creation. */
   *fs_p = fs_new(fs_config, result_pool);
@@ -641,7 +695,10 @@ svn_fs_delete_fs(const char *path, apr_pool_t *pool)
   fs_library_vtable_t *vtable;
 
   SVN_ERR(fs_library_vtable(&vtable, path, pool));
-  return svn_error_trace(vtable->delete_fs(path, pool));
+  SVN_ERR(vtable->delete_fs(path, pool));
+  SVN_MUTEX__WITH_LOCK(common_pool_lock, fs_type_cache_set(path, NULL));
+
+  return SVN_NO_ERROR;
 }
 
 svn_error_t *
@@ -706,7 +763,11 @@ svn_fs_hotcopy3(const char *src_path, const char *dst_path,
                           incremental, notify_func, notify_baton,
                           cancel_func, cancel_baton, common_pool_lock,
                           scratch_pool, common_pool));
-  return svn_error_trace(write_fs_type(dst_path, src_fs_type, scratch_pool));
+  SVN_ERR(write_fs_type(dst_path, src_fs_type, scratch_pool));
+  SVN_MUTEX__WITH_LOCK(common_pool_lock,
+                       fs_type_cache_set(dst_path, src_fs_type));
+
+  return SVN_NO_ERROR;
 }
 
 svn_error_t *
@@ -730,15 +791,16 @@ svn_fs_pack(const char *path,
 }
 
 svn_error_t *
-svn_fs_recover(const char *path,
-               svn_cancel_func_t cancel_func, void *cancel_baton,
-               apr_pool_t *pool)
+svn_fs_recover2(const char *path,
+                apr_hash_t *fs_config,
+                svn_cancel_func_t cancel_func, void *cancel_baton,
+                apr_pool_t *pool)
 {
   fs_library_vtable_t *vtable;
   svn_fs_t *fs;
 
   SVN_ERR(fs_library_vtable(&vtable, path, pool));
-  fs = fs_new(NULL, pool);
+  fs = fs_new(fs_config, pool);
 
   SVN_ERR(vtable->open_fs_for_recovery(fs, path, common_pool_lock,
                                        pool, common_pool));
@@ -1715,6 +1777,29 @@ svn_fs_change_rev_prop2(svn_fs_t *fs, svn_revnum_t rev, const char *name,
                                                      value, pool));
 }
 
+svn_error_t *
+svn_fs__change_rev_props(svn_fs_t *fs, svn_revnum_t rev,
+                         const apr_array_header_t *props, apr_pool_t *pool)
+{
+  int i;
+
+  if (fs->vtable->change_rev_props)
+    return svn_error_trace(fs->vtable->change_rev_props(fs, rev, props,
+                                                        pool));
+
+  /* The backend cannot apply the changes in a single write; fall back
+     to changing the properties one by one. */
+  for (i = 0; i < props->nelts; i++)
+    {
+      const svn_prop_t *prop = &APR_ARRAY_IDX(props, i, svn_prop_t);
+
+      SVN_ERR(fs->vtable->change_rev_prop(fs, rev, prop->name, NULL,
+                                          prop->value, pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                              svn_fs_root_t *source_root,
@@ -219,6 +219,12 @@ typedef struct fs_vtable_t
                                   const svn_string_t *const *old_value_p,
                                   const svn_string_t *value,
                                   apr_pool_t *pool);
+  /* Apply all PROPS (an array of svn_prop_t) to REV in one write.
+     May be NULL; the loader then falls back to iterating
+     change_rev_prop(). */
+  svn_error_t *(*change_rev_props)(svn_fs_t *fs, svn_revnum_t rev,
+                                   const apr_array_header_t *props,
+                                   apr_pool_t *pool);
   /* There is no get_uuid(); see svn_fs_t.uuid docstring. */
   svn_error_t *(*set_uuid)(svn_fs_t *fs, const char *uuid, apr_pool_t *pool);
   svn_error_t *(*revision_root)(svn_fs_root_t **root_p, svn_fs_t *fs,
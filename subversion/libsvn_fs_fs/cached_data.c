@@ -29,10 +29,13 @@
 #include "svn_sorts.h"
 #include "private/svn_delta_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_perf_private.h"
+#include "private/svn_probes_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_temp_serializer.h"
 
+#include "changes-sidecar.h"
 #include "fs_fs.h"
 #include "id.h"
 #include "index.h"
@@ -512,9 +515,13 @@ svn_fs_fs__get_node_revision(node_revision_t **noderev_p,
                              apr_pool_t *scratch_pool)
 {
   const svn_fs_fs__id_part_t *rev_item = svn_fs_fs__id_rev_item(id);
+  static svn_perf__counter_t *perf_counter = NULL;
+  apr_time_t perf_start = svn_perf__start();
 
   svn_error_t *err = get_node_revision_body(noderev_p, fs, id,
                                             result_pool, scratch_pool);
+
+  svn_perf__stop(&perf_counter, "fsfs.noderev-read", perf_start);
   if (err && err->apr_err == SVN_ERR_FS_CORRUPT)
     {
       svn_string_t *id_string = svn_fs_fs__id_unparse(id, scratch_pool);
@@ -808,9 +815,19 @@ auto_read_diff_version(rep_state_t *rs, apr_pool_t *pool)
   if (rs->ver == -1)
     {
       char buf[4];
-      SVN_ERR(rs_aligned_seek(rs, NULL, rs->start, pool));
-      SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
-                                     sizeof(buf), NULL, NULL, pool));
+      const char *mapped;
+
+      if (svn_fs_fs__rev_file_mapped_range(&mapped, rs->sfile->rfile,
+                                           rs->start, sizeof(buf)))
+        {
+          memcpy(buf, mapped, sizeof(buf));
+        }
+      else
+        {
+          SVN_ERR(rs_aligned_seek(rs, NULL, rs->start, pool));
+          SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
+                                         sizeof(buf), NULL, NULL, pool));
+        }
 
       /* ### Layering violation */
       if (! ((buf[0] == 'S') && (buf[1] == 'V') && (buf[2] == 'N')))
@@ -1422,6 +1439,35 @@ set_cached_combined_window(svn_stringbuf_t *window,
   return SVN_NO_ERROR;
 }
 
+/* Hint to the OS that the raw on-disk extents of all reps in LIST plus
+   SRC_STATE (if not NULL) will be read shortly.  This allows the device
+   to fetch the whole delta chain at full queue depth instead of one
+   synchronous read per window.  Only reps whose file is already open and
+   whose offset is known are hinted; the remaining ones are usually
+   served from cache anyway.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+hint_rep_chain(apr_array_header_t *list,
+               rep_state_t *src_state,
+               apr_pool_t *scratch_pool)
+{
+  int i;
+  for (i = 0; i < list->nelts; ++i)
+    {
+      rep_state_t *rs = APR_ARRAY_IDX(list, i, rep_state_t *);
+      if (rs->sfile->rfile && rs->start != -1)
+        SVN_ERR(svn_io__file_readahead(rs->sfile->rfile->file, rs->start,
+                                       rs->size, scratch_pool));
+    }
+
+  if (src_state && src_state->sfile->rfile && src_state->start != -1)
+    SVN_ERR(svn_io__file_readahead(src_state->sfile->rfile->file,
+                                   src_state->start, src_state->size,
+                                   scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Build an array of rep_state structures in *LIST giving the delta
    reps from first_rep to a plain-text or self-compressed rep.  Set
    *SRC_STATE to the plain-text rep we find at the end of the chain,
@@ -1499,6 +1545,14 @@ build_rep_list(apr_array_header_t **list,
 
       rs = NULL;
     }
+
+  /* Now that the full chain is known, queue readahead for all extents
+     that will have to come from disk.  Skip this if we terminated on a
+     cached combined window because its pseudo rep_state does not
+     describe an on-disk extent. */
+  if (!is_cached)
+    SVN_ERR(hint_rep_chain(*list, *src_state, iterpool));
+
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
@@ -1535,6 +1589,9 @@ rep_read_get_baton(struct rep_read_baton **rb_p,
   b->fulltext_delivered = 0;
   b->current_fulltext = NULL;
 
+  SVN_PROBE3(rep__read__begin, rep->revision, rep->item_index,
+             rep->expanded_size);
+
   /* Save our output baton. */
   *rb_p = b;
 
@@ -1640,6 +1697,7 @@ read_plain_window(svn_stringbuf_t **nwin, rep_state_t *rs,
                   apr_pool_t *scratch_pool)
 {
   apr_off_t offset;
+  const char *mapped;
 
   /* RS->FILE may be shared between RS instances -> make sure we point
    * to the right data. */
@@ -1647,12 +1705,21 @@ read_plain_window(svn_stringbuf_t **nwin, rep_state_t *rs,
   SVN_ERR(auto_set_start_offset(rs, scratch_pool));
 
   offset = rs->start + rs->current;
-  SVN_ERR(rs_aligned_seek(rs, NULL, offset, scratch_pool));
 
-  /* Read the plain data. */
+  /* Read the plain data - directly from the memory mapping, if we have
+   * one, bypassing seek, syscall and read buffer. */
   *nwin = svn_stringbuf_create_ensure(size, result_pool);
-  SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, (*nwin)->data, size,
-                                 NULL, NULL, result_pool));
+  if (svn_fs_fs__rev_file_mapped_range(&mapped, rs->sfile->rfile, offset,
+                                       size))
+    {
+      memcpy((*nwin)->data, mapped, size);
+    }
+  else
+    {
+      SVN_ERR(rs_aligned_seek(rs, NULL, offset, scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, (*nwin)->data,
+                                     size, NULL, NULL, result_pool));
+    }
   (*nwin)->data[size] = 0;
 
   /* Update RS. */
@@ -1792,6 +1859,8 @@ rep_read_contents_close(void *baton)
 {
   struct rep_read_baton *rb = baton;
 
+  SVN_PROBE2(rep__read__end, rb->rep.revision, rb->rep.item_index);
+
   svn_pool_destroy(rb->pool);
   svn_pool_destroy(rb->filehandle_pool);
 
@@ -2101,6 +2170,43 @@ skip_contents(struct rep_read_baton *baton,
   return svn_error_trace(err);
 }
 
+/* Approximate fixed cost of combining a single delta window, expressed
+ * in equivalent "bytes read".  Accounts for the extra seek, window
+ * parsing and copy operations. */
+#define FULLTEXT_CACHE_WINDOW_COST 0x4000
+
+/* Return TRUE if reconstructing the fulltext described by BATON is
+ * expensive enough for the result to merit a fulltext cache entry.
+ * BATON->RS_LIST must already be initialized, i.e. build_rep_list must
+ * have run.
+ *
+ * PLAIN reps and short delta chains get reconstructed about as quickly
+ * as their fulltext could be fetched from the cache.  Caching those
+ * would only evict entries that are expensive to re-create, e.g. the
+ * long-chained medium-sized files that dominate blame-style workloads.
+ */
+static svn_boolean_t
+fulltext_is_worth_caching(struct rep_read_baton *baton)
+{
+  apr_int64_t cost = 0;
+  int i;
+
+  /* Estimate the reconstruction cost as the number of on-disk bytes to
+   * process plus a fixed per-window overhead. */
+  for (i = 0; i < baton->rs_list->nelts; ++i)
+    {
+      rep_state_t *rs = APR_ARRAY_IDX(baton->rs_list, i, rep_state_t *);
+      cost += (apr_int64_t)rs->size + FULLTEXT_CACHE_WINDOW_COST;
+    }
+  if (baton->src_state)
+    cost += (apr_int64_t)baton->src_state->size;
+
+  /* Admit the fulltext once reconstructing it is clearly more expensive
+   * than serving it from the cache.  In particular, this rejects PLAIN
+   * reps and combined windows already found in the window caches. */
+  return cost > (apr_int64_t)baton->len + FULLTEXT_CACHE_WINDOW_COST;
+}
+
 /* BATON is of type `rep_read_baton'; read the next *LEN bytes of the
    representation and store them in *BUF.  Sum as we read and verify
    the MD5 sum at the end.  This is a READ_FULL_FN for svn_stream_t. */
@@ -2111,6 +2217,8 @@ rep_read_contents(void *baton,
 {
   struct rep_read_baton *rb = baton;
   apr_size_t len_requested = *len;
+  static svn_perf__counter_t *perf_counter = NULL;
+  apr_time_t perf_start = svn_perf__start();
 
   /* Get data from the fulltext cache for as long as we can. */
   if (rb->fulltext_cache)
@@ -2118,7 +2226,10 @@ rep_read_contents(void *baton,
       svn_boolean_t cached;
       SVN_ERR(get_contents_from_fulltext(&cached, rb, buf, len));
       if (cached)
-        return SVN_NO_ERROR;
+        {
+          svn_perf__stop(&perf_counter, "fsfs.rep-read", perf_start);
+          return SVN_NO_ERROR;
+        }
 
       /* Cache miss.  From now on, we will never read from the fulltext
        * cache for this representation anymore. */
@@ -2134,6 +2245,12 @@ rep_read_contents(void *baton,
                              &rb->src_state, rb->fs, &rb->rep,
                              rb->filehandle_pool));
 
+      /* Now that the delta chain is known, re-evaluate whether the
+       * reconstructed fulltext is worth a cache entry at all. */
+      if (SVN_IS_VALID_REVNUM(rb->fulltext_cache_key.revision)
+          && !fulltext_is_worth_caching(rb))
+        rb->fulltext_cache_key.revision = SVN_INVALID_REVNUM;
+
       /* In case we did read from the fulltext cache before, make the
        * window stream catch up.  Also, initialize the fulltext buffer
        * if we want to cache the fulltext at the end. */
@@ -2207,6 +2324,8 @@ rep_read_contents(void *baton,
       rb->current_fulltext = NULL;
     }
 
+  svn_perf__stop(&perf_counter, "fsfs.rep-read", perf_start);
+
   return SVN_NO_ERROR;
 }
 
@@ -2978,7 +3097,7 @@ svn_fs_fs__get_proplist(apr_hash_t **proplist_p,
       svn_error_t *err;
       const char *filename
         = svn_fs_fs__path_txn_node_props(fs, noderev->id, pool);
-      proplist = apr_hash_make(pool);
+      proplist = svn_hash__make(pool);
 
       SVN_ERR(svn_stream_open_readonly(&stream, filename, pool, pool));
       err = svn_hash_read2(proplist, stream, SVN_HASH_TERMINATOR, pool);
@@ -3011,7 +3130,7 @@ svn_fs_fs__get_proplist(apr_hash_t **proplist_p,
             return SVN_NO_ERROR;
         }
 
-      proplist = apr_hash_make(pool);
+      proplist = svn_hash__make(pool);
       SVN_ERR(svn_fs_fs__get_contents(&stream, fs, noderev->prop_rep, FALSE,
                                       pool));
       err = svn_hash_read2(proplist, stream, SVN_HASH_TERMINATOR, pool);
@@ -3032,7 +3151,7 @@ svn_fs_fs__get_proplist(apr_hash_t **proplist_p,
   else
     {
       /* return an empty prop list if the node doesn't have any props */
-      proplist = apr_hash_make(pool);
+      proplist = svn_hash__make(pool);
     }
 
   *proplist_p = proplist;
@@ -3085,9 +3204,46 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
 
   if (!found)
     {
+      svn_boolean_t have_sidecar = FALSE;
+
+      /* Packed shards may carry a columnar changed-paths sidecar which
+       * is cheaper to decode than the text records in the pack file and
+       * saves opening the pack file altogether. */
+      if (context->next == 0 && context->revision < ffd->min_unpacked_rev)
+        {
+          svn_error_t *err
+            = svn_fs_fs__changes_sidecar_read(changes, &have_sidecar,
+                                              context->fs, context->revision,
+                                              result_pool, scratch_pool);
+          if (err)
+            {
+              /* The sidecar merely mirrors the change lists in the pack
+               * file, so a damaged one costs performance, not data.
+               * Warn and fall through to the authoritative pack file. */
+              context->fs->warning(context->fs->warning_baton, err);
+              svn_error_clear(err);
+              have_sidecar = FALSE;
+            }
+        }
+
+      if (have_sidecar)
+        {
+          /* The sidecar always delivers the full list in one go. */
+          changes_list = apr_pcalloc(scratch_pool, sizeof(*changes_list));
+          changes_list->count = (*changes)->nelts;
+          changes_list->changes = (change_t **)(*changes)->elts;
+          changes_list->eol = TRUE;
+
+          if (ffd->changes_cache)
+            SVN_ERR(svn_cache__set(ffd->changes_cache, &key, changes_list,
+                                   scratch_pool));
+
+          found = TRUE;
+        }
+
       /* read changes from revision file */
 
-      if (!context->revision_file)
+      if (!found && !context->revision_file)
         {
           SVN_ERR(svn_fs_fs__ensure_revision_exists(context->revision,
                                                     context->fs,
@@ -3099,7 +3255,7 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
                                                    scratch_pool));
         }
 
-      if (use_block_read(context->fs))
+      if (!found && use_block_read(context->fs))
         {
           /* 'block-read' will probably populate the cache with the data
            * that we want.  However, we won't want to force it to process
@@ -3658,6 +3814,72 @@ block_read_noderev(node_revision_t **noderev_p,
   return SVN_NO_ERROR;
 }
 
+/* Maximum number of blocks that adaptive readahead will hint ahead of
+ * a sequential block walk.  With the default 64kB block size, this
+ * amounts to a 1MB readahead window. */
+#define MAX_READAHEAD_BLOCKS 16
+
+/* Adaptive readahead for block-read mode:  called whenever block_read()
+ * is about to process the block starting at BLOCK_START of REVISION_FILE
+ * in FS.  If this continues a strictly forward walk through consecutive
+ * blocks of the same file - checkouts etc. stream items in rough on-disk
+ * order - hint the OS to fetch the following blocks in the background,
+ * overlapping that I/O with parsing the current block.  The window grows
+ * with every sequential access up to MAX_READAHEAD_BLOCKS blocks and
+ * collapses as soon as the pattern breaks, so random accesses don't
+ * trigger any readahead at all.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+adaptive_readahead(svn_fs_t *fs,
+                   svn_fs_fs__revision_file_t *revision_file,
+                   apr_off_t block_start,
+                   apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (   block_start == ffd->ra_expected_block
+      && block_start > 0
+      && revision_file->start_revision == ffd->ra_file_start_revision)
+    {
+      apr_off_t hint_start, hint_end;
+
+      /* Double the window with every sequential access. */
+      if (ffd->ra_window < ffd->block_size)
+        ffd->ra_window = ffd->block_size;
+      else if (ffd->ra_window < MAX_READAHEAD_BLOCKS * ffd->block_size)
+        ffd->ra_window *= 2;
+
+      /* Hint only the part of the window that we did not hint before. */
+      hint_start = block_start + ffd->block_size;
+      hint_end = hint_start + ffd->ra_window;
+      if (hint_start < ffd->ra_hinted_end)
+        hint_start = ffd->ra_hinted_end;
+
+      /* Don't bother reading ahead into the index data at the end of
+       * the file.  The index streams have their own access scheme. */
+      if (revision_file->l2p_offset > 0 && hint_end > revision_file->l2p_offset)
+        hint_end = revision_file->l2p_offset;
+
+      if (hint_start < hint_end)
+        {
+          SVN_ERR(svn_io__file_readahead(revision_file->file, hint_start,
+                                         hint_end - hint_start,
+                                         scratch_pool));
+          ffd->ra_hinted_end = hint_end;
+        }
+    }
+  else
+    {
+      /* Pattern broken (or a different file): start over. */
+      ffd->ra_window = 0;
+      ffd->ra_hinted_end = 0;
+    }
+
+  ffd->ra_file_start_revision = revision_file->start_revision;
+  ffd->ra_expected_block = block_start + ffd->block_size;
+
+  return SVN_NO_ERROR;
+}
+
 /* Read the whole (e.g. 64kB) block containing ITEM_INDEX of REVISION in FS
  * and put all data into cache.  If necessary and depending on heuristics,
  * neighboring blocks may also get read.  The data is being read from
@@ -3701,6 +3923,12 @@ block_read(void **result,
 
   offset = wanted_offset;
 
+  /* If this read continues a forward walk over consecutive blocks, hint
+   * the OS to fetch the next few blocks in the background already. */
+  SVN_ERR(adaptive_readahead(fs, revision_file,
+                             offset - (offset % ffd->block_size),
+                             iterpool));
+
   /* Heuristics:
    *
    * Read this block.  If the last item crosses the block boundary, read
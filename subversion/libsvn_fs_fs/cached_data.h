@@ -172,14 +172,22 @@ svn_fs_fs__get_proplist(apr_hash_t **proplist,
 
 /* Create a changes retrieval context object in *RESULT_POOL and return it
  * in *CONTEXT.  It will allow svn_fs_fs__get_changes to fetch consecutive
- * blocks (one per invocation) from REV's changed paths list in FS. */
+ * blocks (one per invocation) from REV's changed paths list in FS.
+ *
+ * This is the preferred way to access a changed paths list:  memory usage
+ * is bounded by the block size, SVN_FS_FS__CHANGES_BLOCK_SIZE, no matter
+ * how long the on-disk list is.  Callers that keep RESULT_POOL for the
+ * whole iteration and pass a clearable pool to svn_fs_fs__get_changes
+ * (see the changes iterator in tree.c) never materialize more than one
+ * block at a time. */
 svn_error_t *
 svn_fs_fs__create_changes_context(svn_fs_fs__changes_context_t **context,
                                   svn_fs_t *fs,
                                   svn_revnum_t rev,
                                   apr_pool_t *result_pool);
 
-/* Fetch the block of changes from the CONTEXT and return it in *CHANGES.
+/* Fetch the next block of changes from the CONTEXT and return it in
+ * *CHANGES.  The last block has been delivered once CONTEXT->EOL is set.
  * Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporaries.
  */
 svn_error_t *
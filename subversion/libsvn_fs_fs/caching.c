@@ -413,7 +413,9 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        svn_fs_fs__deserialize_id,
                        sizeof(svn_revnum_t),
                        apr_pstrcat(pool, prefix, "RRI", SVN_VA_NULL),
-                       0,
+                       /* Tiny, needed by almost every operation.  Pin it
+                        * so checkout storms can't evict it. */
+                       SVN_CACHE__MEMBUFFER_PINNED_PRIORITY,
                        has_namespace,
                        fs,
                        no_handler,
@@ -435,6 +437,24 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        no_handler,
                        fs->pool, pool));
 
+  /* Root and near-root DAG nodes are on every lookup path; keep them in
+   * a separate, pinned cache so that bulk fulltext / delta traffic with
+   * its much higher volume cannot flush them.  Same layout as the plain
+   * DAG node cache; tree.c routes nodes by path depth. */
+  SVN_ERR(create_cache(&(ffd->rev_node_pinned_cache),
+                       NULL,
+                       membuffer,
+                       1, 8,
+                       svn_fs_fs__dag_serialize,
+                       svn_fs_fs__dag_deserialize,
+                       APR_HASH_KEY_STRING,
+                       apr_pstrcat(pool, prefix, "DAG-ROOT", SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_PINNED_PRIORITY,
+                       has_namespace,
+                       fs,
+                       no_handler,
+                       fs->pool, pool));
+
   /* 1st level DAG node cache */
   ffd->dag_node_cache = svn_fs_fs__create_dag_cache(fs->pool);
 
@@ -673,7 +693,9 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        sizeof(pair_cache_key_t),
                        apr_pstrcat(pool, prefix, "L2P_HEADER",
                                    (char *)NULL),
-                       SVN_CACHE__MEMBUFFER_HIGH_PRIORITY,
+                       /* Needed to locate any item in log addressing
+                        * mode; pin it alongside the revision roots. */
+                       SVN_CACHE__MEMBUFFER_PINNED_PRIORITY,
                        has_namespace,
                        fs,
                        no_handler,
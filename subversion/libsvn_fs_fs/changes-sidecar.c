@@ -0,0 +1,549 @@
+/* changes-sidecar.c : columnar changed-paths storage for pack files
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include "svn_pools.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+
+#include "private/svn_subr_private.h"
+
+#include "svn_private_config.h"
+
+#include "changes-sidecar.h"
+#include "cached_data.h"
+#include "id.h"
+#include "util.h"
+
+/* The sidecar file stores the changed-paths lists of a whole packed
+ * shard column by column so that scans decode compact, homogeneous
+ * data instead of the repeated text records in the pack file:
+ *
+ *   marker byte 'C', version (uint)
+ *   start_rev (uint), revision count N (uint)
+ *   N table records: changes count, ids size, paths size,
+ *                    kinds size, copyfrom size   (all uint)
+ *   ids column:      per revision chunk, per change one prefix-
+ *                    compressed node-rev-id string
+ *   paths column:    per revision chunk, per change one prefix-
+ *                    compressed path
+ *   kinds column:    per revision chunk, per change one uint packing
+ *                    the fixed-size change info (see pack_change_flags)
+ *   copyfrom column: per revision chunk, per change copyfrom rev + 1
+ *                    (uint, 0 for "none") followed by the prefix-
+ *                    compressed copyfrom path, if any
+ *
+ * "uint" is the 7b/8b variable-length encoding of svn__encode_uint().
+ * Strings are prefix-compressed against the previous string in the
+ * same revision chunk of the same column: length of the shared prefix
+ * (uint), length of the remainder (uint), remainder bytes.
+ *
+ * The table at the front gives random access to any revision's chunk
+ * in any column without touching the other revisions. */
+
+#define SIDECAR_MARKER 'C'
+#define SIDECAR_VERSION 1
+
+/* Initial buffer size when parsing the sidecar header.  Large enough
+ * for the table of a default-sized shard in almost all cases. */
+#define SIDECAR_HEADER_BUFFER_SIZE 0x10000
+
+/* Per-revision element of the sidecar offset table. */
+typedef struct rev_sizes_t
+{
+  apr_uint64_t nchanges;
+  apr_uint64_t ids;
+  apr_uint64_t paths;
+  apr_uint64_t kinds;
+  apr_uint64_t copyfrom;
+} rev_sizes_t;
+
+/* Append VALUE in encoded form to BUFFER. */
+static void
+append_uint(svn_stringbuf_t *buffer,
+            apr_uint64_t value)
+{
+  unsigned char encoded[SVN__MAX_ENCODED_UINT_LEN];
+
+  svn_stringbuf_appendbytes(buffer, (const char *)encoded,
+                            svn__encode_uint(encoded, value) - encoded);
+}
+
+/* Append VALUE to COLUMN, prefix-compressed against *PREV, and make
+ * *PREV refer to VALUE for the next call. */
+static void
+append_prefixed_string(svn_stringbuf_t *column,
+                       const char **prev,
+                       const char *value)
+{
+  const char *other = *prev;
+  apr_size_t common = 0;
+
+  while (other[common] && value[common] && other[common] == value[common])
+    ++common;
+
+  append_uint(column, common);
+  append_uint(column, strlen(value) - common);
+  svn_stringbuf_appendcstr(column, value + common);
+
+  *prev = value;
+}
+
+/* Pack the fixed-size parts of INFO into a single integer. */
+static apr_uint64_t
+pack_change_flags(const svn_fs_path_change2_t *info)
+{
+  apr_uint64_t flags = (apr_uint64_t)info->change_kind & 0x7;
+
+  if (info->node_kind == svn_node_file)
+    flags |= 1 << 3;
+  else if (info->node_kind == svn_node_dir)
+    flags |= 2 << 3;
+  else if (info->node_kind == svn_node_none)
+    flags |= 3 << 3;
+
+  if (info->text_mod)
+    flags |= 1 << 5;
+  if (info->prop_mod)
+    flags |= 1 << 6;
+
+  if (info->mergeinfo_mod == svn_tristate_false)
+    flags |= 1 << 7;
+  else if (info->mergeinfo_mod == svn_tristate_true)
+    flags |= 2 << 7;
+
+  if (info->copyfrom_known)
+    flags |= 1 << 9;
+
+  return flags;
+}
+
+/* Unpack FLAGS, created by pack_change_flags(), into INFO. */
+static void
+unpack_change_flags(svn_fs_path_change2_t *info,
+                    apr_uint64_t flags)
+{
+  switch ((flags >> 3) & 0x3)
+    {
+      case 1:  info->node_kind = svn_node_file; break;
+      case 2:  info->node_kind = svn_node_dir; break;
+      case 3:  info->node_kind = svn_node_none; break;
+      default: info->node_kind = svn_node_unknown; break;
+    }
+
+  info->change_kind = (svn_fs_path_change_kind_t)(flags & 0x7);
+  info->text_mod = (flags & (1 << 5)) != 0;
+  info->prop_mod = (flags & (1 << 6)) != 0;
+
+  switch ((flags >> 7) & 0x3)
+    {
+      case 1:  info->mergeinfo_mod = svn_tristate_false; break;
+      case 2:  info->mergeinfo_mod = svn_tristate_true; break;
+      default: info->mergeinfo_mod = svn_tristate_unknown; break;
+    }
+
+  info->copyfrom_known = (flags & (1 << 9)) != 0;
+}
+
+svn_error_t *
+svn_fs_fs__changes_sidecar_write(svn_fs_t *fs,
+                                 const char *pack_file_dir,
+                                 svn_revnum_t start_rev,
+                                 int count,
+                                 svn_boolean_t flush_to_disk,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *ids = svn_stringbuf_create_empty(scratch_pool);
+  svn_stringbuf_t *paths = svn_stringbuf_create_empty(scratch_pool);
+  svn_stringbuf_t *kinds = svn_stringbuf_create_empty(scratch_pool);
+  svn_stringbuf_t *copyfrom = svn_stringbuf_create_empty(scratch_pool);
+  svn_stringbuf_t *header = svn_stringbuf_create_empty(scratch_pool);
+  apr_array_header_t *table = apr_array_make(scratch_pool, count,
+                                             sizeof(rev_sizes_t));
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_file_t *file;
+  const char *file_path;
+  int i;
+
+  /* Collect the change lists of all revisions into the columns,
+   * recording the chunk sizes as we go. */
+  for (i = 0; i < count; ++i)
+    {
+      svn_fs_fs__changes_context_t *context;
+      rev_sizes_t *sizes = &APR_ARRAY_PUSH(table, rev_sizes_t);
+      const char *prev_id = "";
+      const char *prev_path = "";
+      const char *prev_copyfrom = "";
+      apr_size_t ids_start = ids->len;
+      apr_size_t paths_start = paths->len;
+      apr_size_t kinds_start = kinds->len;
+      apr_size_t copyfrom_start = copyfrom->len;
+
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      sizes->nchanges = 0;
+      SVN_ERR(svn_fs_fs__create_changes_context(&context, fs, start_rev + i,
+                                                iterpool));
+      while (!context->eol)
+        {
+          apr_array_header_t *changes;
+          int k;
+
+          SVN_ERR(svn_fs_fs__get_changes(&changes, context, iterpool,
+                                         iterpool));
+          for (k = 0; k < changes->nelts; ++k)
+            {
+              change_t *change = APR_ARRAY_IDX(changes, k, change_t *);
+              svn_fs_path_change2_t *info = &change->info;
+              svn_string_t *id_str
+                = svn_fs_fs__id_unparse(info->node_rev_id, iterpool);
+
+              append_prefixed_string(ids, &prev_id, id_str->data);
+              append_prefixed_string(paths, &prev_path, change->path.data);
+              append_uint(kinds, pack_change_flags(info));
+
+              append_uint(copyfrom,
+                          (apr_uint64_t)(info->copyfrom_rev + 1));
+              if (SVN_IS_VALID_REVNUM(info->copyfrom_rev))
+                append_prefixed_string(copyfrom, &prev_copyfrom,
+                                       info->copyfrom_path);
+
+              ++sizes->nchanges;
+            }
+        }
+
+      sizes->ids = ids->len - ids_start;
+      sizes->paths = paths->len - paths_start;
+      sizes->kinds = kinds->len - kinds_start;
+      sizes->copyfrom = copyfrom->len - copyfrom_start;
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Assemble the header in front of the columns. */
+  svn_stringbuf_appendbyte(header, SIDECAR_MARKER);
+  append_uint(header, SIDECAR_VERSION);
+  append_uint(header, start_rev);
+  append_uint(header, count);
+  for (i = 0; i < count; ++i)
+    {
+      const rev_sizes_t *sizes = &APR_ARRAY_IDX(table, i, rev_sizes_t);
+
+      append_uint(header, sizes->nchanges);
+      append_uint(header, sizes->ids);
+      append_uint(header, sizes->paths);
+      append_uint(header, sizes->kinds);
+      append_uint(header, sizes->copyfrom);
+    }
+
+  /* The pack directory does not become live before the caller switched
+   * the shard over to the packed state, so we may write directly to the
+   * final name. */
+  file_path = svn_dirent_join(pack_file_dir,
+                              SVN_FS_FS__CHANGES_SIDECAR_FILENAME,
+                              scratch_pool);
+  SVN_ERR(svn_io_file_open(&file, file_path,
+                           APR_WRITE | APR_CREATE | APR_EXCL | APR_BUFFERED,
+                           APR_OS_DEFAULT, scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, header->data, header->len, NULL,
+                                 scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, ids->data, ids->len, NULL,
+                                 scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, paths->data, paths->len, NULL,
+                                 scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, kinds->data, kinds->len, NULL,
+                                 scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, copyfrom->data, copyfrom->len, NULL,
+                                 scratch_pool));
+  if (flush_to_disk)
+    SVN_ERR(svn_io_file_flush_to_disk(file, scratch_pool));
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return an error object describing a corrupted sidecar file at PATH. */
+static svn_error_t *
+err_corrupt_sidecar(const char *path,
+                    apr_pool_t *scratch_pool)
+{
+  return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                           _("Corrupt changed-paths sidecar file '%s'"),
+                           svn_dirent_local_style(path, scratch_pool));
+}
+
+/* Decode a prefix-compressed string from the range [*P, END) written by
+ * append_prefixed_string(), using and updating the reconstruction
+ * buffer PREV.  Advance *P past the consumed bytes.  Return an error
+ * for PATH if the data is inconsistent. */
+static svn_error_t *
+read_prefixed_string(svn_stringbuf_t *prev,
+                     const unsigned char **p,
+                     const unsigned char *end,
+                     const char *path,
+                     apr_pool_t *scratch_pool)
+{
+  apr_uint64_t common, remainder;
+
+  *p = svn__decode_uint(&common, *p, end);
+  if (!*p)
+    return err_corrupt_sidecar(path, scratch_pool);
+  *p = svn__decode_uint(&remainder, *p, end);
+  if (!*p || common > prev->len || remainder > (apr_uint64_t)(end - *p))
+    return err_corrupt_sidecar(path, scratch_pool);
+
+  prev->len = (apr_size_t)common;
+  svn_stringbuf_appendbytes(prev, (const char *)*p, (apr_size_t)remainder);
+  *p += remainder;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read LEN bytes at OFFSET from FILE into a buffer allocated in
+ * RESULT_POOL and return it in *DATA. */
+static svn_error_t *
+read_chunk(unsigned char **data,
+           apr_file_t *file,
+           apr_off_t offset,
+           apr_size_t len,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  *data = apr_palloc(result_pool, len);
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, *data, len, NULL, NULL,
+                                 scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__changes_sidecar_read(apr_array_header_t **changes,
+                                svn_boolean_t *found,
+                                svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  const char *file_path
+    = svn_fs_fs__path_rev_packed(fs, rev, SVN_FS_FS__CHANGES_SIDECAR_FILENAME,
+                                 scratch_pool);
+  apr_file_t *file;
+  svn_error_t *err;
+  apr_size_t buffer_size = SIDECAR_HEADER_BUFFER_SIZE;
+  const unsigned char *p, *end;
+  apr_uint64_t version, start_rev, count, nchanges, idx, i;
+  apr_off_t header_size;
+  apr_off_t ids_offset, paths_offset, kinds_offset, copyfrom_offset;
+  rev_sizes_t our_sizes, totals = { 0 };
+  const unsigned char *ids, *paths, *kinds, *copyfrom;
+  const unsigned char *ids_end, *paths_end, *kinds_end, *copyfrom_end;
+  svn_stringbuf_t *prev_id, *prev_path, *prev_copyfrom;
+
+  *found = FALSE;
+
+  err = svn_io_file_open(&file, file_path, APR_READ | APR_BUFFERED,
+                         APR_OS_DEFAULT, scratch_pool);
+  if (err)
+    {
+      /* No sidecar file means the shard was packed without one. */
+      if (APR_STATUS_IS_ENOENT(err->apr_err))
+        {
+          svn_error_clear(err);
+          return SVN_NO_ERROR;
+        }
+
+      return svn_error_trace(err);
+    }
+
+  /* Parse the header.  Its size is not known in advance, so retry with
+   * a larger buffer if the table extends beyond the bytes read. */
+  while (TRUE)
+    {
+      unsigned char *buffer = apr_palloc(scratch_pool, buffer_size);
+      apr_off_t offset = 0;
+      apr_size_t bytes_read;
+      svn_boolean_t hit_eof;
+
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(file, buffer, buffer_size, &bytes_read,
+                                     &hit_eof, scratch_pool));
+
+      p = buffer;
+      end = buffer + bytes_read;
+
+      if (bytes_read < 1 || *p != SIDECAR_MARKER)
+        return err_corrupt_sidecar(file_path, scratch_pool);
+      ++p;
+
+      p = svn__decode_uint(&version, p, end);
+      if (p && version != SIDECAR_VERSION)
+        return err_corrupt_sidecar(file_path, scratch_pool);
+      if (p)
+        p = svn__decode_uint(&start_rev, p, end);
+      if (p)
+        p = svn__decode_uint(&count, p, end);
+
+      if (p)
+        {
+          idx = (apr_uint64_t)rev - start_rev;
+          if ((apr_uint64_t)rev < start_rev || idx >= count)
+            return err_corrupt_sidecar(file_path, scratch_pool);
+
+          memset(&totals, 0, sizeof(totals));
+          memset(&our_sizes, 0, sizeof(our_sizes));
+          ids_offset = paths_offset = kinds_offset = copyfrom_offset = 0;
+
+          for (i = 0; p && i < count; ++i)
+            {
+              rev_sizes_t sizes;
+
+              p = svn__decode_uint(&sizes.nchanges, p, end);
+              if (p)
+                p = svn__decode_uint(&sizes.ids, p, end);
+              if (p)
+                p = svn__decode_uint(&sizes.paths, p, end);
+              if (p)
+                p = svn__decode_uint(&sizes.kinds, p, end);
+              if (p)
+                p = svn__decode_uint(&sizes.copyfrom, p, end);
+              if (!p)
+                break;
+
+              /* Remember where our revision's chunks start within the
+               * columns and how large they are. */
+              if (i < idx)
+                {
+                  ids_offset += sizes.ids;
+                  paths_offset += sizes.paths;
+                  kinds_offset += sizes.kinds;
+                  copyfrom_offset += sizes.copyfrom;
+                }
+              else if (i == idx)
+                our_sizes = sizes;
+
+              totals.ids += sizes.ids;
+              totals.paths += sizes.paths;
+              totals.kinds += sizes.kinds;
+              totals.copyfrom += sizes.copyfrom;
+            }
+        }
+
+      if (p)
+        {
+          header_size = p - buffer;
+          break;
+        }
+
+      /* Growing won't help once the whole file is in the buffer. */
+      if (hit_eof)
+        return err_corrupt_sidecar(file_path, scratch_pool);
+
+      buffer_size *= 2;
+    }
+
+  /* Translate the column-relative offsets into file offsets. */
+  ids_offset += header_size;
+  paths_offset += header_size + totals.ids;
+  kinds_offset += header_size + totals.ids + totals.paths;
+  copyfrom_offset += header_size + totals.ids + totals.paths + totals.kinds;
+
+  /* Fetch our revision's chunk of every column. */
+  SVN_ERR(read_chunk((unsigned char **)&ids, file, ids_offset,
+                     (apr_size_t)our_sizes.ids, scratch_pool, scratch_pool));
+  SVN_ERR(read_chunk((unsigned char **)&paths, file, paths_offset,
+                     (apr_size_t)our_sizes.paths, scratch_pool,
+                     scratch_pool));
+  SVN_ERR(read_chunk((unsigned char **)&kinds, file, kinds_offset,
+                     (apr_size_t)our_sizes.kinds, scratch_pool,
+                     scratch_pool));
+  SVN_ERR(read_chunk((unsigned char **)&copyfrom, file, copyfrom_offset,
+                     (apr_size_t)our_sizes.copyfrom, scratch_pool,
+                     scratch_pool));
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  ids_end = ids + (apr_size_t)our_sizes.ids;
+  paths_end = paths + (apr_size_t)our_sizes.paths;
+  kinds_end = kinds + (apr_size_t)our_sizes.kinds;
+  copyfrom_end = copyfrom + (apr_size_t)our_sizes.copyfrom;
+
+  prev_id = svn_stringbuf_create_empty(scratch_pool);
+  prev_path = svn_stringbuf_create_empty(scratch_pool);
+  prev_copyfrom = svn_stringbuf_create_empty(scratch_pool);
+
+  nchanges = our_sizes.nchanges;
+  *changes = apr_array_make(result_pool, (int)nchanges, sizeof(change_t *));
+  for (i = 0; i < nchanges; ++i)
+    {
+      change_t *change = apr_pcalloc(result_pool, sizeof(*change));
+      svn_fs_path_change2_t *info = &change->info;
+      apr_uint64_t flags, copyfrom_rev;
+      char *id_str;
+
+      SVN_ERR(read_prefixed_string(prev_id, &ids, ids_end, file_path,
+                                   scratch_pool));
+      id_str = apr_pstrmemdup(scratch_pool, prev_id->data, prev_id->len);
+      SVN_ERR(svn_fs_fs__id_parse(&info->node_rev_id, id_str, result_pool));
+      if (info->node_rev_id == NULL)
+        return err_corrupt_sidecar(file_path, scratch_pool);
+
+      SVN_ERR(read_prefixed_string(prev_path, &paths, paths_end, file_path,
+                                   scratch_pool));
+      change->path.data = apr_pstrmemdup(result_pool, prev_path->data,
+                                         prev_path->len);
+      change->path.len = prev_path->len;
+
+      kinds = svn__decode_uint(&flags, kinds, kinds_end);
+      if (!kinds)
+        return err_corrupt_sidecar(file_path, scratch_pool);
+      unpack_change_flags(info, flags);
+
+      copyfrom = svn__decode_uint(&copyfrom_rev, copyfrom, copyfrom_end);
+      if (!copyfrom)
+        return err_corrupt_sidecar(file_path, scratch_pool);
+      if (copyfrom_rev == 0)
+        {
+          info->copyfrom_rev = SVN_INVALID_REVNUM;
+          info->copyfrom_path = NULL;
+        }
+      else
+        {
+          info->copyfrom_rev = (svn_revnum_t)(copyfrom_rev - 1);
+          SVN_ERR(read_prefixed_string(prev_copyfrom, &copyfrom,
+                                       copyfrom_end, file_path,
+                                       scratch_pool));
+          info->copyfrom_path = apr_pstrmemdup(result_pool,
+                                               prev_copyfrom->data,
+                                               prev_copyfrom->len);
+        }
+
+      APR_ARRAY_PUSH(*changes, change_t *) = change;
+    }
+
+  *found = TRUE;
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,67 @@
+/* changes-sidecar.h : columnar changed-paths storage for pack files
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS__CHANGES_SIDECAR_H
+#define SVN_LIBSVN_FS__CHANGES_SIDECAR_H
+
+#include "fs.h"
+
+/* Name of the sidecar file within a pack directory. */
+#define SVN_FS_FS__CHANGES_SIDECAR_FILENAME "changes"
+
+/* Write the columnar changed-paths sidecar file for the COUNT revisions
+ * starting at START_REV into the pack directory PACK_FILE_DIR of
+ * filesystem FS.  The revisions must not have been switched over to the
+ * packed representation yet.  If FLUSH_TO_DISK is set, do not return
+ * until the data has actually been written on the disk.  CANCEL_FUNC
+ * and CANCEL_BATON are what you think they are.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_fs__changes_sidecar_write(svn_fs_t *fs,
+                                 const char *pack_file_dir,
+                                 svn_revnum_t start_rev,
+                                 int count,
+                                 svn_boolean_t flush_to_disk,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *scratch_pool);
+
+/* If the pack directory covering revision REV in FS contains a changed-
+ * paths sidecar file, set *FOUND to TRUE and return the full list of
+ * changes in REV as an array of change_t * in *CHANGES, allocated in
+ * RESULT_POOL.  Set *FOUND to FALSE if there is no sidecar file.
+ * Use SCRATCH_POOL for temporary allocations.
+ *
+ * A malformed sidecar file raises SVN_ERR_FS_CORRUPT.  Since the
+ * sidecar only duplicates data from the pack file, callers should
+ * treat that like a cache miss and read the pack file instead.
+ */
+svn_error_t *
+svn_fs_fs__changes_sidecar_read(apr_array_header_t **changes,
+                                svn_boolean_t *found,
+                                svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
+#endif /* SVN_LIBSVN_FS__CHANGES_SIDECAR_H */
@@ -37,7 +37,9 @@
 #include "tree.h"
 #include "lock.h"
 #include "hotcopy.h"
+#include "batch_fsync.h"
 #include "id.h"
+#include "index.h"
 #include "pack.h"
 #include "recovery.h"
 #include "rep-cache.h"
@@ -226,6 +228,57 @@ fs_freeze(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+/* Body of the snapshot freeze operation, to be run while holding the
+   pack lock.  Implements svn_fs_fs__with_pack_lock()'s BODY signature,
+   taking a fs_freeze_baton_t * in BATON. */
+static svn_error_t *
+fs_snapshot_freeze_body(void *baton,
+                        apr_pool_t *pool)
+{
+  struct fs_freeze_baton_t *b = baton;
+  svn_revnum_t youngest;
+
+  /* Pin the revision view the callback will see.  Concurrent commits
+     may bump 'current' while the callback runs, but they only ever add
+     new files; everything up to and including YOUNGEST stays physically
+     unchanged because we hold the pack lock. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, b->fs, pool));
+
+  SVN_ERR(b->freeze_func(b->freeze_baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements the SVN_FS_FS__IOCTL_SNAPSHOT_FREEZE operation: invoke
+   FREEZE_FUNC with FREEZE_BATON on FS while only the pack lock is held.
+   Use POOL for allocations. */
+static svn_error_t *
+fs_snapshot_freeze(svn_fs_t *fs,
+                   svn_fs_freeze_func_t freeze_func,
+                   void *freeze_baton,
+                   apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  struct fs_freeze_baton_t b;
+
+  b.fs = fs;
+  b.freeze_func = freeze_func;
+  b.freeze_baton = freeze_baton;
+
+  SVN_ERR(svn_fs__check_fs(fs, TRUE));
+
+  /* Without a pack lock, packing is serialized with commits via the
+     write lock and may rewrite committed data at any time, so the only
+     way to get a stable view is the full freeze. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
+    SVN_ERR(svn_fs_fs__with_pack_lock(fs, fs_snapshot_freeze_body, &b,
+                                      pool));
+  else
+    SVN_ERR(fs_freeze_body2(&b, pool));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 fs_info(const void **fsfs_info,
         svn_fs_t *fs,
@@ -328,6 +381,15 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
           *output_p = NULL;
           return SVN_NO_ERROR;
         }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_SNAPSHOT_FREEZE.code)
+        {
+          svn_fs_fs__ioctl_snapshot_freeze_input_t *input = input_void;
+
+          SVN_ERR(fs_snapshot_freeze(fs, input->freeze_func,
+                                     input->freeze_baton, scratch_pool));
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
     }
 
   return svn_error_create(SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE, NULL, NULL);
@@ -340,6 +402,7 @@ static fs_vtable_t fs_vtable = {
   svn_fs_fs__revision_prop,
   svn_fs_fs__get_revision_proplist,
   svn_fs_fs__change_rev_prop,
+  svn_fs_fs__change_rev_props,
   fs_set_uuid,
   svn_fs_fs__revision_root,
   svn_fs_fs__begin_txn,
@@ -439,6 +502,18 @@ fs_open(svn_fs_t *fs,
   SVN_MUTEX__WITH_LOCK(common_pool_lock,
                        fs_serialized_init(fs, common_pool, subpool));
 
+  /* If requested, pre-load the index caches for the latest shard.  This is
+     merely an optimization, so ignore any errors (e.g. for empty repos). */
+  if (((fs_fs_data_t *)fs->fsap_data)->preload_indexes)
+    {
+      svn_revnum_t youngest;
+      svn_error_t *err = svn_fs_fs__youngest_rev(&youngest, fs, subpool);
+      if (!err && youngest > 0)
+        err = svn_fs_fs__warm_index_caches(fs, youngest, subpool);
+
+      svn_error_clear(err);
+    }
+
   svn_pool_destroy(subpool);
 
   return SVN_NO_ERROR;
@@ -705,6 +780,8 @@ svn_fs_fs__init(const svn_version_t *loader_version,
                              loader_version->major);
   SVN_ERR(svn_ver_check_list2(fs_version(), checklist, svn_ver_equal));
 
+  SVN_ERR(svn_fs_fs__batch_fsync_init(common_pool));
+
   *vtable = &library_vtable;
   return SVN_NO_ERROR;
 }
@@ -102,6 +102,7 @@ extern "C" {
 #define CONFIG_OPTION_FAIL_STOP          "fail-stop"
 #define CONFIG_SECTION_REP_SHARING       "rep-sharing"
 #define CONFIG_OPTION_ENABLE_REP_SHARING "enable-rep-sharing"
+#define CONFIG_OPTION_REP_CACHE_BACKEND  "rep-cache-backend"
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
 #define CONFIG_OPTION_ENABLE_DIR_DELTIFICATION   "enable-dir-deltification"
 #define CONFIG_OPTION_ENABLE_PROPS_DELTIFICATION "enable-props-deltification"
@@ -111,10 +112,13 @@ extern "C" {
 #define CONFIG_SECTION_PACKED_REVPROPS   "packed-revprops"
 #define CONFIG_OPTION_REVPROP_PACK_SIZE  "revprop-pack-size"
 #define CONFIG_OPTION_COMPRESS_PACKED_REVPROPS  "compress-packed-revprops"
+#define CONFIG_OPTION_BINARY_REVPROPS    "binary-revprops"
 #define CONFIG_SECTION_IO                "io"
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
+#define CONFIG_OPTION_MEMORY_MAP_REV_FILES "memory-map-rev-files"
+#define CONFIG_OPTION_PACK_CHANGES_SIDECAR "pack-changes-sidecar"
 #define CONFIG_SECTION_DEBUG             "debug"
 #define CONFIG_OPTION_PACK_AFTER_COMMIT  "pack-after-commit"
 #define CONFIG_OPTION_VERIFY_BEFORE_COMMIT "verify-before-commit"
@@ -127,7 +131,7 @@ extern "C" {
    Note: If you bump this, please update the switch statement in
          svn_fs_fs__create() as well.
  */
-#define SVN_FS_FS__FORMAT_NUMBER   8
+#define SVN_FS_FS__FORMAT_NUMBER   9
 
 /* The minimum format number that supports svndiff version 1.  */
 #define SVN_FS_FS__MIN_SVNDIFF1_FORMAT 2
@@ -200,6 +204,12 @@ extern "C" {
     database. */
 #define SVN_FS_FS__MIN_REP_CACHE_SCHEMA_V2_FORMAT 8
 
+/* The minimum format number that may write revision properties in the
+   binary representation.  Reading supports both representations in any
+   format, but only 1.15+ can parse the binary one, so writing it is
+   restricted to formats that old releases reject outright. */
+#define SVN_FS_FS__MIN_BINARY_REVPROP_FORMAT 9
+
 /* On most operating systems apr implements file locks per process, not
    per file.  On Windows apr implements the locking as per file handle
    locks, so we don't have to add our own mutex for just in-process
@@ -315,7 +325,8 @@ typedef enum compression_type_t
 {
   compression_type_none,
   compression_type_zlib,
-  compression_type_lz4
+  compression_type_lz4,
+  compression_type_zstd
 } compression_type_t;
 
 /* Private (non-shared) FSFS-specific data for each svn_fs_t object.
@@ -347,6 +358,45 @@ typedef struct fs_fs_data_t
    * (not just the one bit that we need, atm). */
   svn_boolean_t use_block_read;
 
+  /* Adaptive readahead state for block-read mode; see block_read() in
+   * cached_data.c.  Start offset of the block that a strictly forward
+   * walk through the current rev / pack file would access next, ... */
+  apr_off_t ra_expected_block;
+
+  /* ... the first revision covered by that file (identifying the file), */
+  svn_revnum_t ra_file_start_revision;
+
+  /* ... the current readahead window in bytes (0 until a forward walk
+   * has been detected), */
+  apr_off_t ra_window;
+
+  /* ... and the end of the file region already hinted to the OS. */
+  apr_off_t ra_hinted_end;
+
+  /* If set, attempt to memory-map packed rev files upon opening them and
+   * serve suitable reads directly from the page cache. */
+  svn_boolean_t use_mmap_rev_files;
+
+  /* Number of shards that may be packed concurrently.  1 for strictly
+   * sequential packing. */
+  int pack_concurrency;
+
+  /* Number of rev / pack files that may be verified concurrently.
+   * 1 for strictly sequential verification. */
+  int verify_concurrency;
+
+  /* Number of pack files that statistics gathering may scan concurrently.
+   * 1 for a strictly sequential scan. */
+  int stats_concurrency;
+
+  /* Number of revision files that recovery may scan concurrently for
+   * node / copy ids.  1 for a strictly sequential scan. */
+  int recover_concurrency;
+
+  /* If set, pre-load the L2P and P2L index caches for the latest shard
+   * when the filesystem gets opened. */
+  svn_boolean_t preload_indexes;
+
   /* The revision that was youngest, last time we checked. */
   svn_revnum_t youngest_rev_cache;
 
@@ -371,6 +421,11 @@ typedef struct fs_fs_data_t
      to (dag_node_t *). This is the 2nd level cache for DAG nodes. */
   svn_cache__t *rev_node_cache;
 
+  /* Same as REV_NODE_CACHE but only for root and near-root nodes, which
+     virtually every operation needs.  Uses a pinned priority class so
+     that bulk data traffic cannot evict them. */
+  svn_cache__t *rev_node_pinned_cache;
+
   /* A cache of the contents of immutable directories; maps from
      unparsed FS ID to a apr_hash_t * mapping (const char *) dirent
      names to (svn_fs_dirent_t *). */
@@ -384,6 +439,15 @@ typedef struct fs_fs_data_t
      If this is 0, a new unique prefix must be chosen. */
   apr_uint64_t revprop_prefix;
 
+  /* Memo of the most recently read packed revprop file:  its full path
+     and its uncompressed content.  This allows sequential scans such as
+     'svn log' to read and inflate each pack file only once.  Both members
+     are allocated in REVPROP_MEMO_POOL; PATH is NULL if the memo is empty.
+     The memo gets dropped whenever the revprop caches get reset. */
+  apr_pool_t *revprop_memo_pool;
+  const char *revprop_memo_path;
+  svn_stringbuf_t *revprop_memo_content;
+
   /* Revision property cache.  Maps from (rev,prefix) to apr_hash_t.
      Unparsed svn_string_t representations of the serialized hash
      will be written to the cache but the getter returns apr_hash_t. */
@@ -406,7 +470,10 @@ typedef struct fs_fs_data_t
   svn_cache__t *txdelta_window_cache;
 
   /* Cache for combined windows as svn_stringbuf_t objects;
-     the key is window_cache_key_t */
+     the key is window_cache_key_t.  Entries hold the expanded result
+     of applying a delta chain prefix up to the keyed rep, so sibling
+     files sharing that prefix reconstruct it at most once per cache
+     lifetime; build_rep_list() terminates chain walks on a hit. */
   svn_cache__t *combined_window_cache;
 
   /* Cache for node_revision_t objects; the key is (revision, item_index) */
@@ -459,9 +526,22 @@ typedef struct fs_fs_data_t
   /* Data shared between all svn_fs_t objects for a given filesystem. */
   fs_fs_shared_data_t *shared;
 
-  /* The sqlite database used for rep caching. */
+  /* The sqlite database used for rep caching.  NULL if the hash file
+     backend is being used. */
   svn_sqlite__db_t *rep_cache_db;
 
+  /* Open handle to the rep-cache hash file, if that backend has been
+     selected in the configuration.  NULL until the first access. */
+  apr_file_t *rep_cache_file;
+
+  /* If the hash file backend is used, use it instead of SQLite. */
+  svn_boolean_t rep_cache_file_backend;
+
+  /* TRUE while this process holds the exclusive lock on REP_CACHE_FILE
+     through svn_fs_fs__with_rep_cache_lock().  Writers must not acquire
+     (and, worse, release) the lock a second time in that case. */
+  svn_boolean_t rep_cache_file_locked;
+
   /* Thread-safe boolean */
   svn_atomic_t rep_cache_db_opened;
 
@@ -480,6 +560,16 @@ typedef struct fs_fs_data_t
   /* Whether packed revprop files shall be compressed. */
   svn_boolean_t compress_packed_revprops;
 
+  /* Whether revprops shall be written in the binary hash representation
+   * instead of the textual hashdump format.  Reading supports both,
+   * regardless of this setting. */
+  svn_boolean_t binary_revprops;
+
+  /* Whether packing shall write the columnar changed-paths sidecar file
+   * next to each new pack file.  Reading is governed by the presence of
+   * the sidecar alone, regardless of this setting. */
+  svn_boolean_t pack_changes_sidecar;
+
   /* Whether directory nodes shall be deltified just like file nodes. */
   svn_boolean_t deltify_directories;
 
@@ -693,7 +693,7 @@ parse_compression_option(compression_type_t *compression_type_p,
   int level;
   svn_boolean_t is_valid = TRUE;
 
-  /* compression = none | lz4 | zlib | zlib-1 ... zlib-9 */
+  /* compression = none | lz4 | zstd | zlib | zlib-1 ... zlib-9 */
   if (strcmp(value, "none") == 0)
     {
       type = compression_type_none;
@@ -704,6 +704,11 @@ parse_compression_option(compression_type_t *compression_type_p,
       type = compression_type_lz4;
       level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
     }
+  else if (strcmp(value, "zstd") == 0)
+    {
+      type = compression_type_zstd;
+      level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
+    }
   else if (strncmp(value, "zlib", 4) == 0)
     {
       const char *p = value + 4;
@@ -755,9 +760,27 @@ read_config(fs_fs_data_t *ffd,
 
   /* Initialize ffd->rep_sharing_allowed. */
   if (ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT)
-    SVN_ERR(svn_config_get_bool(config, &ffd->rep_sharing_allowed,
-                                CONFIG_SECTION_REP_SHARING,
-                                CONFIG_OPTION_ENABLE_REP_SHARING, TRUE));
+    {
+      const char *backend;
+
+      SVN_ERR(svn_config_get_bool(config, &ffd->rep_sharing_allowed,
+                                  CONFIG_SECTION_REP_SHARING,
+                                  CONFIG_OPTION_ENABLE_REP_SHARING, TRUE));
+
+      /* Select the rep-cache backend. */
+      svn_config_get(config, &backend,
+                     CONFIG_SECTION_REP_SHARING,
+                     CONFIG_OPTION_REP_CACHE_BACKEND, "sqlite");
+      if (strcmp(backend, "file") == 0)
+        ffd->rep_cache_file_backend = TRUE;
+      else if (strcmp(backend, "sqlite") == 0)
+        ffd->rep_cache_file_backend = FALSE;
+      else
+        return svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                 _("Invalid rep-cache backend: '%s' "
+                                   "(expected 'sqlite' or 'file')"),
+                                 backend);
+    }
   else
     ffd->rep_sharing_allowed = FALSE;
 
@@ -804,11 +827,22 @@ read_config(fs_fs_data_t *ffd,
                                        : 0x10));
 
       ffd->revprop_pack_size *= 1024;
+
+      /* Only 1.15+ can read the binary representation; formats that 1.14
+         and older accept must never contain it, whatever the config says. */
+      if (ffd->format >= SVN_FS_FS__MIN_BINARY_REVPROP_FORMAT)
+        SVN_ERR(svn_config_get_bool(config, &ffd->binary_revprops,
+                                    CONFIG_SECTION_PACKED_REVPROPS,
+                                    CONFIG_OPTION_BINARY_REVPROPS,
+                                    FALSE));
+      else
+        ffd->binary_revprops = FALSE;
     }
   else
     {
       ffd->revprop_pack_size = 0x10000;
       ffd->compress_packed_revprops = FALSE;
+      ffd->binary_revprops = FALSE;
     }
 
   if (ffd->format >= SVN_FS_FS__MIN_LOG_ADDRESSING_FORMAT)
@@ -849,6 +883,32 @@ read_config(fs_fs_data_t *ffd,
       ffd->p2l_page_size = 0x100000;  /* Matches above default in bytes. */
     }
 
+  /* Memory mapping only applies to packed (i.e. immutable) files. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
+    {
+      SVN_ERR(svn_config_get_bool(config, &ffd->use_mmap_rev_files,
+                                  CONFIG_SECTION_IO,
+                                  CONFIG_OPTION_MEMORY_MAP_REV_FILES,
+                                  FALSE));
+    }
+  else
+    {
+      ffd->use_mmap_rev_files = FALSE;
+    }
+
+  /* The changed-paths sidecar is written for pack files only. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
+    {
+      SVN_ERR(svn_config_get_bool(config, &ffd->pack_changes_sidecar,
+                                  CONFIG_SECTION_IO,
+                                  CONFIG_OPTION_PACK_CHANGES_SIDECAR,
+                                  FALSE));
+    }
+  else
+    {
+      ffd->pack_changes_sidecar = FALSE;
+    }
+
   if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
     {
       SVN_ERR(svn_config_get_bool(config, &ffd->pack_after_commit,
@@ -891,6 +951,13 @@ read_config(fs_fs_data_t *ffd,
                                       _("Compression type 'lz4' requires "
                                         "filesystem format 8 or higher"));
             }
+          if (ffd->delta_compression_type == compression_type_zstd &&
+              ffd->format < SVN_FS_FS__MIN_SVNDIFF2_FORMAT)
+            {
+              return svn_error_create(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                      _("Compression type 'zstd' requires "
+                                        "filesystem format 8 or higher"));
+            }
         }
       else if (compression_level_val)
         {
@@ -994,6 +1061,13 @@ write_config(svn_fs_t *fs,
 "### 'svnadmin verify' will check the rep-cache regardless of this setting." NL
 "### rep-sharing is enabled by default."                                     NL
 "# " CONFIG_OPTION_ENABLE_REP_SHARING " = true"                              NL
+"###"                                                                        NL
+"### The shared representations can be tracked either in an SQLite"          NL
+"### database ('sqlite', the default) or in a plain hash file ('file')."     NL
+"### The hash file supports lock-free lookups and avoids the database"       NL
+"### locking and sync overhead under concurrent commits, but cannot be"      NL
+"### read by Subversion 1.14 and older."                                     NL
+"# " CONFIG_OPTION_REP_CACHE_BACKEND " = sqlite"                             NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DELTIFICATION "]"                                         NL
 "### To conserve space, the filesystem stores data as differences against"   NL
@@ -1066,9 +1140,13 @@ write_config(svn_fs_t *fs,
 "### usually lower than the one provided by zlib, but using it can"          NL
 "### significantly speed up commits as well as reading the data."            NL
 "### lz4 compression algorithm is supported, starting from format 8"         NL
-"### repositories, available in Subversion 1.10 and higher."                 NL
+"### repositories, available in Subversion 1.10 and higher.  zstd offers"    NL
+"### compression ratios comparable to zlib at much higher speed; it also"    NL
+"### requires format 8 repositories as well as servers and clients built"    NL
+"### with zstd support."                                                     NL
 "### The syntax of this option is:"                                          NL
-"###   " CONFIG_OPTION_COMPRESSION " = none | lz4 | zlib | zlib-1 ... zlib-9" NL
+"###   " CONFIG_OPTION_COMPRESSION " = none | lz4 | zstd | zlib"             NL
+"###                                  | zlib-1 ... zlib-9"                   NL
 "### Versions prior to Subversion 1.10 will ignore this option."             NL
 "### The default value is 'lz4' if supported by the repository format and"   NL
 "### 'zlib' otherwise.  'zlib' is currently equivalent to 'zlib-5'."         NL
@@ -1101,6 +1179,15 @@ write_config(svn_fs_t *fs,
 "### even more so writing, become significantly more CPU intensive."         NL
 "### Compressing packed revprops is disabled by default."                    NL
 "# " CONFIG_OPTION_COMPRESS_PACKED_REVPROPS " = false"                       NL
+"###"                                                                        NL
+"### Revprops may be written in a compact binary representation that is"     NL
+"### cheaper to parse than the default textual format.  Reading always"      NL
+"### supports both representations, so this option may be toggled at any"    NL
+"### time.  Binary revprops can only be parsed by Subversion 1.15 and"       NL
+"### later, so this option only takes effect in format 9 repositories"       NL
+"### and later; older formats ignore it."                                    NL
+"### Writing binary revprops is disabled by default."                        NL
+"# " CONFIG_OPTION_BINARY_REVPROPS " = false"                                NL
 ""                                                                           NL
 "[" CONFIG_SECTION_IO "]"                                                    NL
 "### Parameters in this section control the data access granularity in"      NL
@@ -1148,6 +1235,25 @@ write_config(svn_fs_t *fs,
 "### Must be a power of 2."                                                  NL
 "### p2l-page-size is given in kBytes and with a default of 1024 kBytes."    NL
 "# " CONFIG_OPTION_P2L_PAGE_SIZE " = 1024"                                   NL
+"###"                                                                        NL
+"### When enabled, pack files will be memory-mapped upon opening them and"   NL
+"### suitable reads will be served directly from the page cache instead"     NL
+"### of copying the data through a read buffer.  This can reduce the CPU"    NL
+"### cost of read-heavy operations on servers with enough RAM to hold the"   NL
+"### hot pack files.  On 32 bit systems or when pack files exceed the"       NL
+"### available address space, the mapping is skipped and the buffered"       NL
+"### read path is used.  Memory mapping is disabled by default."             NL
+"# " CONFIG_OPTION_MEMORY_MAP_REV_FILES " = false"                           NL
+"###"                                                                        NL
+"### When enabled, 'svnadmin pack' will store the changed-paths lists of"    NL
+"### the packed revisions a second time in a compact columnar sidecar"       NL
+"### file next to the pack file.  History scans such as 'svn log -v' then"   NL
+"### decode the compressed columns instead of parsing the text records in"   NL
+"### the pack file, at the expense of slightly larger pack directories."     NL
+"### Readers use the sidecar whenever it is present, so the setting may"     NL
+"### be changed at any time and takes effect at the next pack run."          NL
+"### Writing the changed-paths sidecar is disabled by default."              NL
+"# " CONFIG_OPTION_PACK_CHANGES_SIDECAR " = false"                           NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DEBUG "]"                                                 NL
 "###"                                                                        NL
@@ -1167,10 +1273,67 @@ static svn_error_t *
 read_global_config(svn_fs_t *fs)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
+  const char *pack_concurrency_str;
+  const char *verify_concurrency_str;
+  const char *stats_concurrency_str;
+  const char *recover_concurrency_str;
 
   ffd->use_block_read = svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_FSFS_BLOCK_READ,
                                            FALSE);
+
+  ffd->pack_concurrency = 1;
+  pack_concurrency_str = svn_hash_gets(fs->config,
+                                       SVN_FS_CONFIG_FSFS_PACK_CONCURRENCY);
+  if (pack_concurrency_str)
+    {
+      apr_int64_t val;
+      SVN_ERR(svn_cstring_strtoi64(&val, pack_concurrency_str, 1,
+                                   APR_INT32_MAX, 10));
+
+      ffd->pack_concurrency = (int) val;
+    }
+
+  ffd->verify_concurrency = 1;
+  verify_concurrency_str = svn_hash_gets(fs->config,
+                                         SVN_FS_CONFIG_FSFS_VERIFY_CONCURRENCY);
+  if (verify_concurrency_str)
+    {
+      apr_int64_t val;
+      SVN_ERR(svn_cstring_strtoi64(&val, verify_concurrency_str, 1,
+                                   APR_INT32_MAX, 10));
+
+      ffd->verify_concurrency = (int) val;
+    }
+
+  ffd->stats_concurrency = 1;
+  stats_concurrency_str = svn_hash_gets(fs->config,
+                                        SVN_FS_CONFIG_FSFS_STATS_CONCURRENCY);
+  if (stats_concurrency_str)
+    {
+      apr_int64_t val;
+      SVN_ERR(svn_cstring_strtoi64(&val, stats_concurrency_str, 1,
+                                   APR_INT32_MAX, 10));
+
+      ffd->stats_concurrency = (int) val;
+    }
+
+  ffd->recover_concurrency = 1;
+  recover_concurrency_str = svn_hash_gets(fs->config,
+                                        SVN_FS_CONFIG_FSFS_RECOVER_CONCURRENCY);
+  if (recover_concurrency_str)
+    {
+      apr_int64_t val;
+      SVN_ERR(svn_cstring_strtoi64(&val, recover_concurrency_str, 1,
+                                   APR_INT32_MAX, 10));
+
+      ffd->recover_concurrency = (int) val;
+    }
+
+  ffd->preload_indexes = svn_hash__get_bool(fs->config,
+                                            SVN_FS_CONFIG_FSFS_PRELOAD_INDEXES,
+                                            FALSE);
+
   ffd->flush_to_disk = !svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                                            FALSE);
@@ -1952,6 +2115,13 @@ svn_fs_fs__create(svn_fs_t *fs,
           case 9: format = 7;
                   break;
 
+          case 10:
+          case 11:
+          case 12:
+          case 13:
+          case 14: format = 8;
+                  break;
+
           default:format = SVN_FS_FS__FORMAT_NUMBER;
         }
 
@@ -2284,6 +2454,68 @@ svn_fs_fs__change_rev_prop(svn_fs_t *fs,
   return svn_fs_fs__with_write_lock(fs, change_rev_prop_body, &cb, pool);
 }
 
+/* Baton used for change_rev_props_body below. */
+struct change_rev_props_baton {
+  svn_fs_t *fs;
+  svn_revnum_t rev;
+  const apr_array_header_t *props;
+};
+
+/* The work-horse for svn_fs_fs__change_rev_props, called with the FS
+   write lock.  This implements the svn_fs_fs__with_write_lock()
+   'body' callback type.  BATON is a 'struct change_rev_props_baton *'. */
+static svn_error_t *
+change_rev_props_body(void *baton, apr_pool_t *pool)
+{
+  struct change_rev_props_baton *cb = baton;
+  apr_hash_t *table;
+  svn_boolean_t changed = FALSE;
+  int i;
+
+  /* We always need to read the current revprops from disk.
+   * Hence, always "refresh" here. */
+  SVN_ERR(svn_fs_fs__get_revision_proplist(&table, cb->fs, cb->rev, TRUE,
+                                           pool, pool));
+
+  for (i = 0; i < cb->props->nelts; i++)
+    {
+      const svn_prop_t *prop = &APR_ARRAY_IDX(cb->props, i, svn_prop_t);
+      const svn_string_t *present_value = svn_hash_gets(table, prop->name);
+
+      /* Skip no-op changes. */
+      if ((!present_value && !prop->value)
+          || (present_value && prop->value
+              && svn_string_compare(present_value, prop->value)))
+        continue;
+
+      svn_hash_sets(table, prop->name, prop->value);
+      changed = TRUE;
+    }
+
+  /* Write the revision's property list just once for all changes. */
+  if (!changed)
+    return SVN_NO_ERROR;
+
+  return svn_fs_fs__set_revision_proplist(cb->fs, cb->rev, table, pool);
+}
+
+svn_error_t *
+svn_fs_fs__change_rev_props(svn_fs_t *fs,
+                            svn_revnum_t rev,
+                            const apr_array_header_t *props,
+                            apr_pool_t *pool)
+{
+  struct change_rev_props_baton cb;
+
+  SVN_ERR(svn_fs__check_fs(fs, TRUE));
+
+  cb.fs = fs;
+  cb.rev = rev;
+  cb.props = props;
+
+  return svn_fs_fs__with_write_lock(fs, change_rev_props_body, &cb, pool);
+}
+
 
 svn_error_t *
 svn_fs_fs__info_format(int *fs_format,
@@ -2323,8 +2555,11 @@ svn_fs_fs__info_format(int *fs_format,
     case 8:
       (*supports_version)->minor = 10;
       break;
+    case 9:
+      (*supports_version)->minor = 15;
+      break;
 #ifdef SVN_DEBUG
-# if SVN_FS_FS__FORMAT_NUMBER != 8
+# if SVN_FS_FS__FORMAT_NUMBER != 9
 #  error "Need to add a 'case' statement here"
 # endif
 #endif
@@ -2511,9 +2746,19 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                                                iterpool, iterpool));
       SVN_ERR(svn_fs_fs__rev_get_root(&root_id, fs, rev, iterpool, iterpool));
 
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = reindex_node(fs, root_id, rev, file, cancel_func, cancel_baton, iterpool);
-      SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db, err));
+      if (ffd->rep_cache_db)
+        {
+          SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+          err = reindex_node(fs, root_id, rev, file, cancel_func,
+                             cancel_baton, iterpool);
+          SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db, err));
+        }
+      else
+        {
+          /* The hash file backend needs no transaction batching. */
+          SVN_ERR(reindex_node(fs, root_id, rev, file, cancel_func,
+                               cancel_baton, iterpool));
+        }
 
       SVN_ERR(svn_fs_fs__close_revision_file(file));
     }
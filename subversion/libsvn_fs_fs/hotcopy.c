@@ -988,6 +988,18 @@ hotcopy_body(void *baton, apr_pool_t *pool)
           SVN_ERR(svn_io_set_file_read_write(dst_subdir, FALSE, pool));
           SVN_ERR(svn_fs_fs__del_rep_reference(dst_fs, src_youngest, pool));
         }
+
+      /* Likewise for the hash file backend.  Slots torn by concurrent
+       * writers will simply be ignored by the copy's readers. */
+      src_subdir = svn_dirent_join(src_fs->path, REP_CACHE_FILE_NAME, pool);
+      dst_subdir = svn_dirent_join(dst_fs->path, REP_CACHE_FILE_NAME, pool);
+      SVN_ERR(svn_io_check_path(src_subdir, &kind, pool));
+      if (kind == svn_node_file)
+        {
+          SVN_ERR(svn_io_copy_file(src_subdir, dst_subdir, TRUE, pool));
+          SVN_ERR(svn_io_set_file_read_write(dst_subdir, FALSE, pool));
+          SVN_ERR(svn_fs_fs__del_rep_reference(dst_fs, src_youngest, pool));
+        }
     }
 
   /* Copy the txn-current file. */
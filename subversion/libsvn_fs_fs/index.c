@@ -417,6 +417,39 @@ packed_stream_get(apr_uint64_t *value,
   return SVN_NO_ERROR;
 }
 
+/* Read the next COUNT numbers from STREAM and store them in VALUES, in
+ * stream order.  This extracts whole runs from the decode buffer at a
+ * time instead of paying the per-number call and error-check overhead
+ * of packed_stream_get().
+ */
+static svn_error_t *
+packed_stream_get_batch(apr_uint64_t *values,
+                        apr_size_t count,
+                        svn_fs_fs__packed_number_stream_t *stream)
+{
+  while (count > 0)
+    {
+      apr_size_t available = stream->used - stream->current;
+      apr_size_t chunk = MIN(count, available);
+      apr_size_t i;
+
+      if (chunk == 0)
+        {
+          SVN_ERR(packed_stream_read(stream));
+          continue;
+        }
+
+      for (i = 0; i < chunk; ++i)
+        values[i] = stream->buffer[stream->current + i].value;
+
+      stream->current += chunk;
+      values += chunk;
+      count -= chunk;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Navigate STREAM to packed stream offset OFFSET.  There will be no checks
  * whether the given OFFSET is valid.
  */
@@ -1342,12 +1375,13 @@ get_l2p_page(l2p_page_t **page,
   result->offsets = apr_pcalloc(result_pool, result->entry_count
                                            * sizeof(*result->offsets));
 
-  /* read all page entries (offsets in rev file and container sub-items) */
+  /* read all page entries (offsets in rev file and container sub-items)
+   * in one go, then undeltify them in place */
+  SVN_ERR(packed_stream_get_batch(result->offsets, result->entry_count,
+                                  rev_file->l2p_stream));
   for (i = 0; i < result->entry_count; ++i)
     {
-      apr_uint64_t value = 0;
-      SVN_ERR(packed_stream_get(&value, rev_file->l2p_stream));
-      last_value += decode_int(value);
+      last_value += decode_int(result->offsets[i]);
       result->offsets[i] = last_value - 1;
     }
 
@@ -3090,6 +3124,63 @@ svn_fs_fs__p2l_get_max_offset(apr_off_t *offset,
                                             scratch_pool));
 }
 
+svn_error_t *
+svn_fs_fs__warm_index_caches(svn_fs_t *fs,
+                             svn_revnum_t revision,
+                             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs_fs__revision_file_t *rev_file;
+  apr_off_t max_offset;
+  apr_off_t offset;
+  svn_revnum_t rev;
+  svn_revnum_t last_rev;
+  apr_pool_t *iterpool;
+
+  /* Older formats don't have L2P / P2L indexes. */
+  if (!svn_fs_fs__use_log_addressing(fs))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, revision,
+                                           scratch_pool, scratch_pool));
+  iterpool = svn_pool_create(scratch_pool);
+
+  /* Walk the P2L index in page granularity.  Each lookup parses the
+   * respective index page and adds it to the page cache. */
+  SVN_ERR(svn_fs_fs__p2l_get_max_offset(&max_offset, fs, rev_file, revision,
+                                        iterpool));
+  for (offset = 0; offset < max_offset; offset += ffd->p2l_page_size)
+    {
+      apr_array_header_t *entries;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__p2l_index_lookup(&entries, fs, rev_file, revision,
+                                          offset, ffd->p2l_page_size,
+                                          iterpool, iterpool));
+    }
+
+  /* Touch the L2P index for every revision in REV_FILE.  Resolving the
+   * root node reads the index header and caches the page(s) covering the
+   * start of the respective revision. */
+  last_rev = rev_file->is_packed && ffd->max_files_per_dir
+           ? rev_file->start_revision + ffd->max_files_per_dir
+           : rev_file->start_revision + 1;
+  for (rev = rev_file->start_revision; rev < last_rev; ++rev)
+    {
+      apr_off_t root_offset;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__item_offset(&root_offset, fs, rev_file, rev, NULL,
+                                     SVN_FS_FS__ITEM_INDEX_ROOT_NODE,
+                                     iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  SVN_ERR(svn_fs_fs__close_revision_file(rev_file));
+
+  return SVN_NO_ERROR;
+}
+
 /* Calculate the FNV1 checksum over the offset range in REV_FILE, covered by
  * ENTRY.  Store the result in ENTRY->FNV1_CHECKSUM.  Use SCRATCH_POOL for
  * temporary allocations. */
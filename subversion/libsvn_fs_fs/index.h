@@ -227,6 +227,15 @@ svn_fs_fs__p2l_get_max_offset(apr_off_t *offset,
                               svn_revnum_t revision,
                               apr_pool_t *scratch_pool);
 
+/* Read the L2P and P2L indexes of the rev / pack file containing REVISION
+ * in FS into the respective page caches.  This is a no-op for pre-format 7
+ * repositories.  Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_fs__warm_index_caches(svn_fs_t *fs,
+                             svn_revnum_t revision,
+                             apr_pool_t *scratch_pool);
+
 /* Index (re-)creation utilities.
  */
 
@@ -677,21 +677,45 @@ svn_fs_fs__write_changes(svn_stream_t *stream,
   return SVN_NO_ERROR;
 }
 
-/* Given a revision file FILE that has been pre-positioned at the
-   beginning of a Node-Rev header block, read in that header block and
-   store it in the apr_hash_t HEADERS.  All allocations will be from
-   RESULT_POOL. */
+/* The values of the known headers of a node revision block, as collected
+   by read_noderev_headers().  Pointers are NULL (and flags FALSE) for
+   headers not present in the block; otherwise, they reference the
+   respective line buffers. */
+typedef struct noderev_headers_t
+{
+  char *id;
+  char *type;
+  char *count;
+  char *props;
+  char *text;
+  char *cpath;
+  char *pred;
+  char *copyfrom;
+  char *copyroot;
+  char *minfo_cnt;
+  svn_boolean_t is_fresh_txn_root;
+  svn_boolean_t minfo_here;
+} noderev_headers_t;
+
+/* Given a stream STREAM that has been pre-positioned at the beginning of
+   a Node-Rev header block, read in that header block and fill in
+   *HEADERS.  The field vocabulary is small and fixed, so we dispatch on
+   the first character plus the length of the field name - which already
+   identifies the only possible match - and merely confirm with a single
+   string comparison.  Unknown headers are ignored.  All allocations will
+   be from RESULT_POOL. */
 static svn_error_t *
-read_header_block(apr_hash_t **headers,
-                  svn_stream_t *stream,
-                  apr_pool_t *result_pool)
+read_noderev_headers(noderev_headers_t *headers,
+                     svn_stream_t *stream,
+                     apr_pool_t *result_pool)
 {
-  *headers = svn_hash__make(result_pool);
+  memset(headers, 0, sizeof(*headers));
 
   while (1)
     {
       svn_stringbuf_t *header_str;
-      const char *name, *value;
+      const char *name;
+      char *value;
       apr_size_t i = 0;
       apr_size_t name_len;
       svn_boolean_t eof;
@@ -733,9 +757,66 @@ read_header_block(apr_hash_t **headers,
 
       value = header_str->data + i;
 
-      /* header_str is safely in our pool, so we can use bits of it as
-         key and value. */
-      apr_hash_set(*headers, name, name_len, value);
+      /* Dispatch on the first character and the field name length.
+         Later occurrences of the same header override earlier ones,
+         just like they did with the hash-based parser. */
+      switch (name[0])
+        {
+        case 'i':
+          if (name_len == 2 && strcmp(name, HEADER_ID) == 0)
+            headers->id = value;
+          else if (name_len == 17 && strcmp(name, HEADER_FRESHTXNRT) == 0)
+            headers->is_fresh_txn_root = TRUE;
+          break;
+
+        case 't':
+          /* "type" and "text" are equally long; the 2nd char differs. */
+          if (name_len == 4)
+            {
+              if (name[1] == 'y' && strcmp(name, HEADER_TYPE) == 0)
+                headers->type = value;
+              else if (strcmp(name, HEADER_TEXT) == 0)
+                headers->text = value;
+            }
+          break;
+
+        case 'c':
+          if (name_len == 5)
+            {
+              /* "count" or "cpath" */
+              if (name[1] == 'o' && strcmp(name, HEADER_COUNT) == 0)
+                headers->count = value;
+              else if (strcmp(name, HEADER_CPATH) == 0)
+                headers->cpath = value;
+            }
+          else if (name_len == 8)
+            {
+              /* "copyfrom" and "copyroot" differ in the 5th char only. */
+              if (name[4] == 'f' && strcmp(name, HEADER_COPYFROM) == 0)
+                headers->copyfrom = value;
+              else if (strcmp(name, HEADER_COPYROOT) == 0)
+                headers->copyroot = value;
+            }
+          break;
+
+        case 'p':
+          if (name_len == 5 && strcmp(name, HEADER_PROPS) == 0)
+            headers->props = value;
+          else if (name_len == 4 && strcmp(name, HEADER_PRED) == 0)
+            headers->pred = value;
+          break;
+
+        case 'm':
+          if (name_len == 9 && strcmp(name, HEADER_MINFO_CNT) == 0)
+            headers->minfo_cnt = value;
+          else if (name_len == 10 && strcmp(name, HEADER_MINFO_HERE) == 0)
+            headers->minfo_here = TRUE;
+          break;
+
+        default:
+          /* Unknown header.  Ignore it, like the hash-based parser did. */
+          break;
+        }
     }
 
   return SVN_NO_ERROR;
@@ -920,17 +1001,17 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool)
 {
-  apr_hash_t *headers;
+  noderev_headers_t headers;
   node_revision_t *noderev;
   char *value;
   const char *noderev_id;
 
-  SVN_ERR(read_header_block(&headers, stream, scratch_pool));
+  SVN_ERR(read_noderev_headers(&headers, stream, scratch_pool));
 
   noderev = apr_pcalloc(result_pool, sizeof(*noderev));
 
   /* Read the node-rev id. */
-  value = svn_hash_gets(headers, HEADER_ID);
+  value = headers.id;
   if (value == NULL)
       /* ### More information: filename/offset coordinates */
       return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
@@ -942,7 +1023,7 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
   noderev_id = value; /* for error messages later */
 
   /* Read the type. */
-  value = svn_hash_gets(headers, HEADER_TYPE);
+  value = headers.type;
 
   if ((value == NULL) ||
       (   strcmp(value, SVN_FS_FS__KIND_FILE)
@@ -957,14 +1038,14 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
                 : svn_node_dir;
 
   /* Read the 'count' field. */
-  value = svn_hash_gets(headers, HEADER_COUNT);
+  value = headers.count;
   if (value)
     SVN_ERR(svn_cstring_atoi(&noderev->predecessor_count, value));
   else
     noderev->predecessor_count = 0;
 
   /* Get the properties location. */
-  value = svn_hash_gets(headers, HEADER_PROPS);
+  value = headers.props;
   if (value)
     {
       SVN_ERR(read_rep_offsets(&noderev->prop_rep, value,
@@ -972,7 +1053,7 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
     }
 
   /* Get the data location. */
-  value = svn_hash_gets(headers, HEADER_TEXT);
+  value = headers.text;
   if (value)
     {
       SVN_ERR(read_rep_offsets(&noderev->data_rep, value,
@@ -980,7 +1061,7 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
     }
 
   /* Get the created path. */
-  value = svn_hash_gets(headers, HEADER_CPATH);
+  value = headers.cpath;
   if (value == NULL)
     {
       return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
@@ -998,13 +1079,13 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
     }
 
   /* Get the predecessor ID. */
-  value = svn_hash_gets(headers, HEADER_PRED);
+  value = headers.pred;
   if (value)
     SVN_ERR(svn_fs_fs__id_parse(&noderev->predecessor_id, value,
                                 result_pool));
 
   /* Get the copyroot. */
-  value = svn_hash_gets(headers, HEADER_COPYROOT);
+  value = headers.copyroot;
   if (value == NULL)
     {
       noderev->copyroot_path = apr_pstrdup(result_pool, noderev->created_path);
@@ -1022,7 +1103,7 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
     }
 
   /* Get the copyfrom. */
-  value = svn_hash_gets(headers, HEADER_COPYFROM);
+  value = headers.copyfrom;
   if (value == NULL)
     {
       noderev->copyfrom_path = NULL;
@@ -1040,19 +1121,17 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
     }
 
   /* Get whether this is a fresh txn root. */
-  value = svn_hash_gets(headers, HEADER_FRESHTXNRT);
-  noderev->is_fresh_txn_root = (value != NULL);
+  noderev->is_fresh_txn_root = headers.is_fresh_txn_root;
 
   /* Get the mergeinfo count. */
-  value = svn_hash_gets(headers, HEADER_MINFO_CNT);
+  value = headers.minfo_cnt;
   if (value)
     SVN_ERR(svn_cstring_atoi64(&noderev->mergeinfo_count, value));
   else
     noderev->mergeinfo_count = 0;
 
   /* Get whether *this* node has mergeinfo. */
-  value = svn_hash_gets(headers, HEADER_MINFO_HERE);
-  noderev->has_mergeinfo = (value != NULL);
+  noderev->has_mergeinfo = headers.minfo_here;
 
   *noderev_p = noderev;
 
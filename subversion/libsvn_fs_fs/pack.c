@@ -22,6 +22,8 @@
 #include <assert.h>
 #include <string.h>
 
+#include <apr_thread_proc.h>
+
 #include "svn_pools.h"
 #include "svn_dirent_uri.h"
 #include "svn_sorts.h"
@@ -31,6 +33,7 @@
 #include "private/svn_string_private.h"
 #include "private/svn_io_private.h"
 
+#include "changes-sidecar.h"
 #include "fs_fs.h"
 #include "pack.h"
 #include "util.h"
@@ -82,6 +85,12 @@
  * pack file and writes the temporary index files.
  *
  * Finally, after the last range of revisions, create the final indexes.
+ *
+ * Note that all items are copied verbatim:  unlike the FSX backend, we
+ * cannot pool small noderevs or reps into shared containers because the
+ * FSFS index format has no notion of a sub-item address (see the
+ * "Logical addressing" section of the 'structure' document).  Grouping
+ * related items into the same block is as close as this format can get.
  */
 
 /* Maximum amount of memory we allocate for placement information during
@@ -1992,6 +2001,13 @@ pack_shard(struct pack_baton *baton,
                          baton->max_mem, ffd->flush_to_disk,
                          baton->cancel_func, baton->cancel_baton, pool));
 
+  /* if enabled, store the changed-paths lists in columnar form as well */
+  if (ffd->pack_changes_sidecar)
+    SVN_ERR(svn_fs_fs__changes_sidecar_write(baton->fs, rev_pack_file_dir,
+                  (svn_revnum_t)(baton->shard * ffd->max_files_per_dir),
+                  ffd->max_files_per_dir, ffd->flush_to_disk,
+                  baton->cancel_func, baton->cancel_baton, pool));
+
   /* For newer repo formats, we only acquired the pack lock so far.
      Before modifying the repo state by switching over to the packed
      data, we need to acquire the global (write) lock. */
@@ -2009,6 +2025,169 @@ pack_shard(struct pack_baton *baton,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* Baton for pack_rev_shard_thread(). */
+typedef struct pack_thread_baton_t
+{
+  /* The outer packing context.  Only read-only members may be accessed
+   * from the thread. */
+  struct pack_baton *pb;
+
+  /* Shard to pack and the respective paths. */
+  apr_int64_t shard;
+  const char *rev_pack_file_dir;
+  const char *rev_shard_path;
+
+  /* Error raised by the thread, if any.  To be picked up after join. */
+  svn_error_t *err;
+
+  /* Private pool of this thread.  Created and destroyed by the main
+   * thread; used only by the respective worker in between. */
+  apr_pool_t *pool;
+} pack_thread_baton_t;
+
+/* apr_thread_start_t running the CPU- and I/O-heavy part of packing a
+ * single shard, i.e. pack_rev_shard(), as described by BATON.  Global
+ * state changes (write lock, revprops, min-unpacked-rev) remain with
+ * the main thread. */
+static void * APR_THREAD_FUNC
+pack_rev_shard_thread(apr_thread_t *thread, void *baton)
+{
+  pack_thread_baton_t *b = baton;
+  fs_fs_data_t *ffd = b->pb->fs->fsap_data;
+
+  /* Cancellation is checked by the main thread between shard batches. */
+  b->err = pack_rev_shard(b->pb->fs, b->rev_pack_file_dir,
+                          b->rev_shard_path, b->shard,
+                          ffd->max_files_per_dir, b->pb->max_mem,
+                          ffd->flush_to_disk, NULL, NULL, b->pool);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Pack the shards FIRST_SHARD .. END_SHARD-1, running up to CONCURRENCY
+ * pack_rev_shard() stages in parallel worker threads.  The serialized
+ * state switch (synced_pack_shard) is applied strictly in shard order by
+ * the main thread so that min-unpacked-rev advances monotonically, just
+ * like in the sequential case.  BATON and POOL are as in pack_body(). */
+static svn_error_t *
+pack_shards_concurrently(struct pack_baton *pb,
+                         apr_int64_t first_shard,
+                         apr_int64_t end_shard,
+                         int concurrency,
+                         apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = pb->fs->fsap_data;
+  apr_int64_t shard = first_shard;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  while (shard < end_shard)
+    {
+      int i;
+      int batch = end_shard - shard < concurrency
+                ? (int)(end_shard - shard)
+                : concurrency;
+      apr_thread_t **threads;
+      pack_thread_baton_t *batons;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+      threads = apr_palloc(iterpool, batch * sizeof(*threads));
+      batons = apr_pcalloc(iterpool, batch * sizeof(*batons));
+
+      if (pb->cancel_func)
+        SVN_ERR(pb->cancel_func(pb->cancel_baton));
+
+      /* Set up and start the pack_rev_shard() stage for the whole batch. */
+      for (i = 0; i < batch; ++i)
+        {
+          apr_status_t status;
+          pack_thread_baton_t *b = &batons[i];
+
+          b->pb = pb;
+          b->shard = shard + i;
+
+          /* Root pool with a thread-safe allocator of its own.  A sub-pool
+           * of ITERPOOL would share the caller's allocator, which need not
+           * be thread-safe (e.g. svnadmin's for a single job). */
+          b->pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+          b->rev_pack_file_dir
+            = svn_dirent_join(pb->revs_dir,
+                              apr_psprintf(iterpool,
+                                    "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
+                                    b->shard),
+                              iterpool);
+          b->rev_shard_path
+            = svn_dirent_join(pb->revs_dir,
+                              apr_psprintf(iterpool, "%" APR_INT64_T_FMT,
+                                           b->shard),
+                              iterpool);
+
+          if (pb->notify_func)
+            SVN_ERR(pb->notify_func(pb->notify_baton, b->shard,
+                                    svn_fs_pack_notify_start, iterpool));
+
+          status = apr_thread_create(&threads[i], NULL,
+                                     pack_rev_shard_thread, b, iterpool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create packing thread"));
+        }
+
+      /* Wait for the whole batch and collect the workers' errors. */
+      for (i = 0; i < batch; ++i)
+        {
+          apr_status_t status;
+          apr_thread_join(&status, threads[i]);
+          err = svn_error_compose_create(err, batons[i].err);
+        }
+      if (err)
+        {
+          /* The workers' root pools are not cleaned up with ITERPOOL. */
+          for (i = 0; i < batch; ++i)
+            svn_pool_destroy(batons[i].pool);
+          return svn_error_trace(err);
+        }
+
+      /* Apply the global state switches in shard order. */
+      for (i = 0; i < batch; ++i)
+        {
+          pb->shard = batons[i].shard;
+          pb->rev_shard_path = batons[i].rev_shard_path;
+
+          /* The sidecar is read through the FS caches, so write it on
+           * the main thread while the shard is still unpacked. */
+          if (ffd->pack_changes_sidecar)
+            SVN_ERR(svn_fs_fs__changes_sidecar_write(pb->fs,
+                          batons[i].rev_pack_file_dir,
+                          (svn_revnum_t)(pb->shard * ffd->max_files_per_dir),
+                          ffd->max_files_per_dir, ffd->flush_to_disk,
+                          pb->cancel_func, pb->cancel_baton, iterpool));
+
+          if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
+            SVN_ERR(svn_fs_fs__with_write_lock(pb->fs, synced_pack_shard,
+                                               pb, iterpool));
+          else
+            SVN_ERR(synced_pack_shard(pb, iterpool));
+
+          svn_pool_destroy(batons[i].pool);
+
+          if (pb->notify_func)
+            SVN_ERR(pb->notify_func(pb->notify_baton, pb->shard,
+                                    svn_fs_pack_notify_end, iterpool));
+        }
+
+      shard += batch;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Read the youngest rev and the first non-packed rev info for FS from disk.
    Set *FULLY_PACKED when there is no completed unpacked shard.
    Use SCRATCH_POOL for temporary allocations.
@@ -2080,6 +2259,19 @@ pack_body(void *baton,
     pb->revsprops_dir = svn_dirent_join(pb->fs->path, PATH_REVPROPS_DIR,
                                         pool);
 
+#if APR_HAS_THREADS
+  /* With concurrency configured, run the heavy per-shard packing stage
+   * in parallel worker threads. */
+  if (ffd->pack_concurrency > 1)
+    return svn_error_trace(pack_shards_concurrently(
+                               pb,
+                               ffd->min_unpacked_rev
+                                 / ffd->max_files_per_dir,
+                               completed_shards,
+                               ffd->pack_concurrency,
+                               pool));
+#endif
+
   iterpool = svn_pool_create(pool);
   for (pb->shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
        pb->shard < completed_shards;
@@ -22,6 +22,8 @@
 
 #include "recovery.h"
 
+#include <apr_thread_proc.h>
+
 #include "svn_hash.h"
 #include "svn_pools.h"
 #include "private/svn_string_private.h"
@@ -331,6 +333,156 @@ recover_get_root_offset(apr_off_t *root_offset,
   return SVN_NO_ERROR;
 }
 
+/* Part of the recovery procedure.  Scan the revision file of revision REV
+   in FS for the largest node-id and copy-id in use and increase
+   *MAX_NODE_ID and *MAX_COPY_ID accordingly.  Perform temporary
+   allocation in POOL. */
+static svn_error_t *
+recover_scan_revision(svn_fs_t *fs,
+                      svn_revnum_t rev,
+                      apr_uint64_t *max_node_id,
+                      apr_uint64_t *max_copy_id,
+                      apr_pool_t *pool)
+{
+  svn_fs_fs__revision_file_t *rev_file;
+  apr_off_t root_offset;
+
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, rev, pool, pool));
+  SVN_ERR(recover_get_root_offset(&root_offset, rev, rev_file, pool));
+  SVN_ERR(recover_find_max_ids(fs, rev, rev_file, root_offset,
+                               max_node_id, max_copy_id, pool));
+  SVN_ERR(svn_fs_fs__close_revision_file(rev_file));
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Baton for recover_scan_revision_thread(). */
+typedef struct recover_thread_baton_t
+{
+  /* The filesystem being recovered.  Read-only for the thread. */
+  svn_fs_t *fs;
+
+  /* Revision to scan. */
+  svn_revnum_t rev;
+
+  /* Largest node-id and copy-id found in REV.  Merged by the main
+   * thread after join. */
+  apr_uint64_t max_node_id;
+  apr_uint64_t max_copy_id;
+
+  /* Error raised by the thread, if any.  To be picked up after join. */
+  svn_error_t *err;
+
+  /* Private pool of this thread.  Created and destroyed by the main
+   * thread; used only by the respective worker in between. */
+  apr_pool_t *pool;
+} recover_thread_baton_t;
+
+/* apr_thread_start_t scanning a single revision for the largest node-id
+ * and copy-id in use, as described by BATON. */
+static void * APR_THREAD_FUNC
+recover_scan_revision_thread(apr_thread_t *thread, void *baton)
+{
+  recover_thread_baton_t *b = baton;
+
+  /* Cancellation is checked by the main thread between batches. */
+  b->err = recover_scan_revision(b->fs, b->rev, &b->max_node_id,
+                                 &b->max_copy_id, b->pool);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Scan revisions 0 .. MAX_REV of FS, running up to CONCURRENCY
+ * recover_scan_revision() calls in parallel worker threads, and increase
+ * *MAX_NODE_ID and *MAX_COPY_ID to the largest ids found.  Merging the
+ * per-revision maxima remains with the main thread, as does writing the
+ * new 'current' file later on.  If CANCEL_FUNC is not NULL, call it with
+ * CANCEL_BATON between batches.  Use POOL for temporary allocations. */
+static svn_error_t *
+recover_scan_revisions_concurrently(svn_fs_t *fs,
+                                    svn_revnum_t max_rev,
+                                    apr_uint64_t *max_node_id,
+                                    apr_uint64_t *max_copy_id,
+                                    int concurrency,
+                                    svn_cancel_func_t cancel_func,
+                                    void *cancel_baton,
+                                    apr_pool_t *pool)
+{
+  svn_revnum_t rev = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  while (rev <= max_rev)
+    {
+      int i;
+      int batch = max_rev + 1 - rev < concurrency
+                ? (int)(max_rev + 1 - rev)
+                : concurrency;
+      apr_thread_t **threads;
+      recover_thread_baton_t *batons;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+      threads = apr_palloc(iterpool, batch * sizeof(*threads));
+      batons = apr_pcalloc(iterpool, batch * sizeof(*batons));
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      /* Start the scans for the whole batch. */
+      for (i = 0; i < batch; ++i)
+        {
+          apr_status_t status;
+          recover_thread_baton_t *b = &batons[i];
+
+          b->fs = fs;
+          b->rev = rev + i;
+
+          /* Root pool with a thread-safe allocator of its own.  A sub-pool
+           * of ITERPOOL would share the caller's allocator, which need not
+           * be thread-safe (e.g. svnadmin's for a single job). */
+          b->pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+
+          status = apr_thread_create(&threads[i], NULL,
+                                     recover_scan_revision_thread, b,
+                                     iterpool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create recovery thread"));
+        }
+
+      /* Wait for the whole batch and collect the workers' errors.  The
+       * workers' root pools are not cleaned up with ITERPOOL, so destroy
+       * them here. */
+      for (i = 0; i < batch; ++i)
+        {
+          apr_status_t status;
+          apr_thread_join(&status, threads[i]);
+          err = svn_error_compose_create(err, batons[i].err);
+          svn_pool_destroy(batons[i].pool);
+        }
+      SVN_ERR(err);
+
+      /* Merge the per-revision maxima. */
+      for (i = 0; i < batch; ++i)
+        {
+          if (batons[i].max_node_id > *max_node_id)
+            *max_node_id = batons[i].max_node_id;
+          if (batons[i].max_copy_id > *max_copy_id)
+            *max_copy_id = batons[i].max_copy_id;
+        }
+
+      rev += batch;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Baton used for recover_body below. */
 struct recover_baton {
   svn_fs_t *fs;
@@ -408,28 +560,37 @@ recover_body(void *baton, apr_pool_t *pool)
       /* Next we need to find the maximum node id and copy id in use across the
          filesystem.  Unfortunately, the only way we can get this information
          is to scan all the noderevs of all the revisions and keep track as
-         we go along. */
-      svn_revnum_t rev;
-      apr_pool_t *iterpool = svn_pool_create(pool);
-
-      for (rev = 0; rev <= max_rev; rev++)
+         we go along.  The scans are independent, so they may run in
+         parallel worker threads. */
+#if APR_HAS_THREADS
+      if (ffd->recover_concurrency > 1)
+        {
+          SVN_ERR(recover_scan_revisions_concurrently(fs, max_rev,
+                                                      &next_node_id,
+                                                      &next_copy_id,
+                                                      ffd->recover_concurrency,
+                                                      b->cancel_func,
+                                                      b->cancel_baton,
+                                                      pool));
+        }
+      else
+#endif
         {
-          svn_fs_fs__revision_file_t *rev_file;
-          apr_off_t root_offset;
+          svn_revnum_t rev;
+          apr_pool_t *iterpool = svn_pool_create(pool);
 
-          svn_pool_clear(iterpool);
+          for (rev = 0; rev <= max_rev; rev++)
+            {
+              svn_pool_clear(iterpool);
 
-          if (b->cancel_func)
-            SVN_ERR(b->cancel_func(b->cancel_baton));
+              if (b->cancel_func)
+                SVN_ERR(b->cancel_func(b->cancel_baton));
 
-          SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, rev, pool,
-                                                   iterpool));
-          SVN_ERR(recover_get_root_offset(&root_offset, rev, rev_file, pool));
-          SVN_ERR(recover_find_max_ids(fs, rev, rev_file, root_offset,
-                                       &next_node_id, &next_copy_id, pool));
-          SVN_ERR(svn_fs_fs__close_revision_file(rev_file));
+              SVN_ERR(recover_scan_revision(fs, rev, &next_node_id,
+                                            &next_copy_id, iterpool));
+            }
+          svn_pool_destroy(iterpool);
         }
-      svn_pool_destroy(iterpool);
 
       /* Now that we finally have the maximum revision, node-id and copy-id, we
          can bump the two ids to get the next of each. */
@@ -21,6 +21,7 @@
  */
 
 #include "svn_pools.h"
+#include "svn_io.h"
 
 #include "svn_private_config.h"
 
@@ -28,11 +29,13 @@
 #include "fs_fs.h"
 #include "fs.h"
 #include "rep-cache.h"
+#include "util.h"
 #include "../libsvn_fs/fs-loader.h"
 
 #include "svn_path.h"
 
 #include "private/svn_sqlite.h"
+#include "private/svn_subr_private.h"
 
 #include "rep-cache-db.h"
 
@@ -48,6 +51,659 @@ path_rep_cache_db(const char *fs_path,
   return svn_dirent_join(fs_path, REP_CACHE_DB_NAME, result_pool);
 }
 
+static APR_INLINE const char *
+path_rep_cache_file(const char *fs_path,
+                    apr_pool_t *result_pool)
+{
+  return svn_dirent_join(fs_path, REP_CACHE_FILE_NAME, result_pool);
+}
+
+
+/** The hash file backend. **/
+
+/* The hash file is a single open-addressing hash table with linear
+ * probing, keyed by the SHA-1 fulltext checksum.  It starts with a
+ * RCF_HEADER_SIZE header followed by a power-of-two number of fixed
+ * size slots.  All numbers are stored in little-endian order.
+ *
+ * Readers are lock-free:  each slot carries a FNV-1a checksum, so a
+ * torn or in-flight write is simply skipped during the probe.  Writers
+ * serialize through an exclusive OS-level lock on the file and append
+ * into free slots;  once the load factor limit is exceeded, the table
+ * gets rewritten at double capacity and atomically renamed into place.
+ *
+ * Since the rep cache contents is advisory, a lost entry only costs us
+ * a sharing opportunity;  served entries are protected by the slot
+ * checksum and the usual beyond-HEAD and rep-header validation.
+ */
+
+/* Various layout constants for the hash file. */
+#define RCF_MAGIC "SVN rep-cache 1\n"
+#define RCF_MAGIC_LEN 16
+#define RCF_HEADER_SIZE 64
+#define RCF_SLOT_SIZE 64
+#define RCF_INITIAL_CAPACITY 0x1000
+
+/* Offsets of the entry elements within a slot. */
+#define RCF_SLOT_SHA1 0
+#define RCF_SLOT_REVISION 20
+#define RCF_SLOT_ITEM_INDEX 28
+#define RCF_SLOT_SIZE_MEMBER 36
+#define RCF_SLOT_EXPANDED_SIZE 44
+#define RCF_SLOT_CHECKSUM 52
+
+/* Possible states of a slot, as derived by rcf_classify_slot(). */
+typedef enum rcf_slot_state_t
+{
+  rcf_slot_empty,  /* never used; ends the probe sequence */
+  rcf_slot_used,   /* contains a valid entry */
+  rcf_slot_skip    /* tombstone or torn write; continue probing */
+} rcf_slot_state_t;
+
+/* In-memory representation of the hash file header. */
+typedef struct rcf_header_t
+{
+  /* number of slots in the table */
+  apr_uint64_t capacity;
+
+  /* number of slots in use (approximate; advisory only) */
+  apr_uint64_t used;
+} rcf_header_t;
+
+/* Store the lower 64 bits of VALUE at P in little-endian order. */
+static void
+rcf_write_uint64(unsigned char *p,
+                 apr_uint64_t value)
+{
+  int i;
+  for (i = 0; i < 8; ++i)
+    {
+      p[i] = (unsigned char)(value & 0xff);
+      value >>= 8;
+    }
+}
+
+/* Return the little-endian 64 bit number stored at P. */
+static apr_uint64_t
+rcf_read_uint64(const unsigned char *p)
+{
+  int i;
+  apr_uint64_t value = 0;
+  for (i = 7; i >= 0; --i)
+    value = (value << 8) | p[i];
+
+  return value;
+}
+
+/* Store VALUE at P in little-endian order. */
+static void
+rcf_write_uint32(unsigned char *p,
+                 apr_uint32_t value)
+{
+  int i;
+  for (i = 0; i < 4; ++i)
+    {
+      p[i] = (unsigned char)(value & 0xff);
+      value >>= 8;
+    }
+}
+
+/* Return the little-endian 32 bit number stored at P. */
+static apr_uint32_t
+rcf_read_uint32(const unsigned char *p)
+{
+  int i;
+  apr_uint32_t value = 0;
+  for (i = 3; i >= 0; --i)
+    value = (value << 8) | p[i];
+
+  return value;
+}
+
+/* Return the state of the RCF_SLOT_SIZE bytes at SLOT. */
+static rcf_slot_state_t
+rcf_classify_slot(const unsigned char *slot)
+{
+  static const unsigned char no_sha1[APR_SHA1_DIGESTSIZE] = { 0 };
+  apr_uint32_t stored = rcf_read_uint32(slot + RCF_SLOT_CHECKSUM);
+
+  /* We never add entries with an all-zero SHA-1.  An all-zero checksum
+   * marks a slot that has never been written, anything else in that
+   * combination is a tombstone. */
+  if (memcmp(slot + RCF_SLOT_SHA1, no_sha1, sizeof(no_sha1)) == 0)
+    return stored == 0 ? rcf_slot_empty : rcf_slot_skip;
+
+  return stored == svn__fnv1a_32(slot, RCF_SLOT_CHECKSUM)
+       ? rcf_slot_used
+       : rcf_slot_skip;
+}
+
+/* Read the header of the hash file FILE into *HEADER.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+rcf_read_header(rcf_header_t *header,
+                apr_file_t *file,
+                apr_pool_t *scratch_pool)
+{
+  unsigned char buffer[RCF_HEADER_SIZE];
+  apr_off_t offset = 0;
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, buffer, sizeof(buffer), NULL, NULL,
+                                 scratch_pool));
+
+  header->capacity = rcf_read_uint64(buffer + RCF_MAGIC_LEN);
+  header->used = rcf_read_uint64(buffer + RCF_MAGIC_LEN + 8);
+
+  if (   memcmp(buffer, RCF_MAGIC, RCF_MAGIC_LEN) != 0
+      || header->capacity == 0)
+    return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                            _("Malformed rep-cache hash file header"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Write HEADER to the hash file FILE.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+rcf_write_header(apr_file_t *file,
+                 const rcf_header_t *header,
+                 apr_pool_t *scratch_pool)
+{
+  unsigned char buffer[RCF_HEADER_SIZE] = { 0 };
+  apr_off_t offset = 0;
+
+  memcpy(buffer, RCF_MAGIC, RCF_MAGIC_LEN);
+  rcf_write_uint64(buffer + RCF_MAGIC_LEN, header->capacity);
+  rcf_write_uint64(buffer + RCF_MAGIC_LEN + 8, header->used);
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, buffer, sizeof(buffer), NULL,
+                                 scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Read slot IDX of the hash file FILE into the RCF_SLOT_SIZE bytes at
+ * SLOT.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+rcf_read_slot(unsigned char *slot,
+              apr_file_t *file,
+              apr_uint64_t idx,
+              apr_pool_t *scratch_pool)
+{
+  apr_off_t offset = RCF_HEADER_SIZE + (apr_off_t)idx * RCF_SLOT_SIZE;
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, slot, RCF_SLOT_SIZE, NULL, NULL,
+                                 scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Write the RCF_SLOT_SIZE bytes at SLOT to slot IDX of the hash file
+ * FILE.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+rcf_write_slot(apr_file_t *file,
+               apr_uint64_t idx,
+               const unsigned char *slot,
+               apr_pool_t *scratch_pool)
+{
+  apr_off_t offset = RCF_HEADER_SIZE + (apr_off_t)idx * RCF_SLOT_SIZE;
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, slot, RCF_SLOT_SIZE, NULL,
+                                 scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Serialize REP into the RCF_SLOT_SIZE bytes at SLOT. */
+static void
+rcf_pack_slot(unsigned char *slot,
+              const representation_t *rep)
+{
+  memset(slot, 0, RCF_SLOT_SIZE);
+  memcpy(slot + RCF_SLOT_SHA1, rep->sha1_digest, APR_SHA1_DIGESTSIZE);
+  rcf_write_uint64(slot + RCF_SLOT_REVISION, (apr_uint64_t)rep->revision);
+  rcf_write_uint64(slot + RCF_SLOT_ITEM_INDEX, rep->item_index);
+  rcf_write_uint64(slot + RCF_SLOT_SIZE_MEMBER, rep->size);
+  rcf_write_uint64(slot + RCF_SLOT_EXPANDED_SIZE, rep->expanded_size);
+  rcf_write_uint32(slot + RCF_SLOT_CHECKSUM,
+                   svn__fnv1a_32(slot, RCF_SLOT_CHECKSUM));
+}
+
+/* Deserialize the entry in the RCF_SLOT_SIZE bytes at SLOT into *REP. */
+static void
+rcf_unpack_slot(representation_t *rep,
+                const unsigned char *slot)
+{
+  svn_fs_fs__id_txn_reset(&rep->txn_id);
+  memcpy(rep->sha1_digest, slot + RCF_SLOT_SHA1, APR_SHA1_DIGESTSIZE);
+  rep->has_sha1 = TRUE;
+  rep->revision = (svn_revnum_t)rcf_read_uint64(slot + RCF_SLOT_REVISION);
+  rep->item_index = rcf_read_uint64(slot + RCF_SLOT_ITEM_INDEX);
+  rep->size = rcf_read_uint64(slot + RCF_SLOT_SIZE_MEMBER);
+  rep->expanded_size = rcf_read_uint64(slot + RCF_SLOT_EXPANDED_SIZE);
+}
+
+/* Return the initial probe position for the SHA-1 DIGEST in a table of
+ * CAPACITY slots. */
+static apr_uint64_t
+rcf_bucket(const unsigned char *digest,
+           apr_uint64_t capacity)
+{
+  return rcf_read_uint64(digest) % capacity;
+}
+
+/* Create a new, empty hash file with CAPACITY slots and move it to PATH
+ * within the filesystem FS.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+rcf_create(svn_fs_t *fs,
+           const char *path,
+           apr_uint64_t capacity,
+           apr_pool_t *scratch_pool)
+{
+  apr_file_t *file;
+  const char *tmp_path;
+  rcf_header_t header;
+
+  header.capacity = capacity;
+  header.used = 0;
+
+  SVN_ERR(svn_io_open_unique_file3(&file, &tmp_path, fs->path,
+                                   svn_io_file_del_none,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(rcf_write_header(file, &header, scratch_pool));
+  SVN_ERR(svn_io_file_trunc(file,
+                            RCF_HEADER_SIZE
+                              + (apr_off_t)capacity * RCF_SLOT_SIZE,
+                            scratch_pool));
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+#ifndef WIN32
+  /* We want to extend the permissions that apply to the repository
+     as a whole when creating the rep cache and not simply default
+     to umask. */
+  SVN_ERR(svn_io_copy_perms(svn_fs_fs__path_current(fs, scratch_pool),
+                            tmp_path, scratch_pool));
+#endif
+
+  /* In case of a creation race, the last writer wins.  Since all empty
+     tables are equivalent, losing at most a handful of concurrently
+     added entries is acceptable for an advisory cache. */
+  SVN_ERR(svn_io_file_rename2(tmp_path, path, FALSE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Open, creating if necessary, the rep-cache hash file for FS and store
+ * the open handle in FS.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+rcf_open(svn_fs_t *fs,
+         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *path = path_rep_cache_file(fs->path, scratch_pool);
+  apr_file_t *file;
+  rcf_header_t header;
+  svn_error_t *err;
+
+  /* Open (or create) the hash file.  It will be automatically closed
+     when fs->pool is destroyed. */
+  err = svn_io_file_open(&file, path, APR_FOPEN_READ | APR_FOPEN_WRITE,
+                         APR_OS_DEFAULT, fs->pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      SVN_ERR(rcf_create(fs, path, RCF_INITIAL_CAPACITY, scratch_pool));
+      err = svn_io_file_open(&file, path, APR_FOPEN_READ | APR_FOPEN_WRITE,
+                             APR_OS_DEFAULT, fs->pool);
+    }
+  SVN_ERR(err);
+
+  /* Validate the header before announcing the file as available. */
+  SVN_ERR(rcf_read_header(&header, file, scratch_pool));
+  ffd->rep_cache_file = file;
+
+  return SVN_NO_ERROR;
+}
+
+/* Insert REP into the hash file FILE with header *HEADER, unless an
+ * entry with the same SHA-1 already exists.  Update HEADER->USED but
+ * don't write the header back to the file.  The caller must hold the
+ * exclusive file lock and must have ensured a free slot.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+rcf_insert(apr_file_t *file,
+           rcf_header_t *header,
+           const representation_t *rep,
+           apr_pool_t *scratch_pool)
+{
+  unsigned char slot[RCF_SLOT_SIZE];
+  apr_uint64_t i;
+  apr_uint64_t idx = rcf_bucket(rep->sha1_digest, header->capacity);
+  apr_uint64_t target = header->capacity; /* "none found, yet" */
+
+  for (i = 0; i < header->capacity; ++i, idx = (idx + 1) % header->capacity)
+    {
+      SVN_ERR(rcf_read_slot(slot, file, idx, scratch_pool));
+      switch (rcf_classify_slot(slot))
+        {
+        case rcf_slot_used:
+          /* As with the SQLite backend, the first entry for a given
+           * SHA-1 wins. */
+          if (memcmp(slot + RCF_SLOT_SHA1, rep->sha1_digest,
+                     APR_SHA1_DIGESTSIZE) == 0)
+            return SVN_NO_ERROR;
+          continue;
+
+        case rcf_slot_skip:
+          /* Remember the first reusable slot but keep scanning for an
+           * existing entry further down the probe sequence. */
+          if (target == header->capacity)
+            target = idx;
+          continue;
+
+        default:
+          if (target == header->capacity)
+            target = idx;
+          break;
+        }
+
+      break;
+    }
+
+  if (target == header->capacity)
+    return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                            _("Rep-cache hash file is full"));
+
+  rcf_pack_slot(slot, rep);
+  SVN_ERR(rcf_write_slot(file, target, slot, scratch_pool));
+  ++header->used;
+
+  return SVN_NO_ERROR;
+}
+
+/* Rewrite the hash file of FS at double capacity, re-adding all current
+ * entries, and atomically replace the old file.  *HEADER describes the
+ * current table and will be updated to the new one.  The caller must
+ * hold the exclusive file lock;  upon return, the new file handle in FS
+ * is locked the same way.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+rcf_grow(svn_fs_t *fs,
+         rcf_header_t *header,
+         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *path = path_rep_cache_file(fs->path, scratch_pool);
+  apr_file_t *new_file;
+  const char *tmp_path;
+  rcf_header_t new_header;
+  unsigned char slot[RCF_SLOT_SIZE];
+  apr_uint64_t i;
+
+  new_header.capacity = header->capacity * 2;
+  new_header.used = 0;
+
+  /* Write the larger table to a temporary file. */
+  SVN_ERR(svn_io_open_unique_file3(&new_file, &tmp_path, fs->path,
+                                   svn_io_file_del_none,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(rcf_write_header(new_file, &new_header, scratch_pool));
+  SVN_ERR(svn_io_file_trunc(new_file,
+                            RCF_HEADER_SIZE
+                              + (apr_off_t)new_header.capacity
+                                * RCF_SLOT_SIZE,
+                            scratch_pool));
+
+  /* Re-add all entries. */
+  for (i = 0; i < header->capacity; ++i)
+    {
+      SVN_ERR(rcf_read_slot(slot, ffd->rep_cache_file, i, scratch_pool));
+      if (rcf_classify_slot(slot) == rcf_slot_used)
+        {
+          representation_t rep = { 0 };
+          rcf_unpack_slot(&rep, slot);
+          SVN_ERR(rcf_insert(new_file, &new_header, &rep, scratch_pool));
+        }
+    }
+
+  SVN_ERR(rcf_write_header(new_file, &new_header, scratch_pool));
+  SVN_ERR(svn_io_file_close(new_file, scratch_pool));
+
+#ifndef WIN32
+  SVN_ERR(svn_io_copy_perms(path, tmp_path, scratch_pool));
+#endif
+
+  /* Swap in the new file.  Other processes will pick it up when they
+     re-open the rep cache;  until then, their lookups into the old file
+     merely miss entries added after this point. */
+  SVN_ERR(svn_io_file_rename2(tmp_path, path, FALSE, scratch_pool));
+  SVN_ERR(svn_io_file_close(ffd->rep_cache_file, scratch_pool));
+  SVN_ERR(svn_io_file_open(&ffd->rep_cache_file, path,
+                           APR_FOPEN_READ | APR_FOPEN_WRITE,
+                           APR_OS_DEFAULT, fs->pool));
+
+  /* Replace the lock that closing the old handle released. */
+  SVN_ERR(svn_io_lock_open_file(ffd->rep_cache_file, TRUE, FALSE,
+                                scratch_pool));
+
+  *header = new_header;
+
+  return SVN_NO_ERROR;
+}
+
+/* Look up the entry for the SHA-1 CHECKSUM in the hash file of FS and
+ * return it in *REP_P, allocated in RESULT_POOL.  Set *REP_P to NULL if
+ * there is no such entry.  This is the lock-free reader side. */
+static svn_error_t *
+rcf_get_rep(representation_t **rep_p,
+            svn_fs_t *fs,
+            svn_checksum_t *checksum,
+            apr_pool_t *result_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  rcf_header_t header;
+  unsigned char slot[RCF_SLOT_SIZE];
+  apr_uint64_t i, idx;
+
+  *rep_p = NULL;
+  SVN_ERR(rcf_read_header(&header, ffd->rep_cache_file, result_pool));
+
+  idx = rcf_bucket(checksum->digest, header.capacity);
+  for (i = 0; i < header.capacity; ++i, idx = (idx + 1) % header.capacity)
+    {
+      SVN_ERR(rcf_read_slot(slot, ffd->rep_cache_file, idx, result_pool));
+      switch (rcf_classify_slot(slot))
+        {
+        case rcf_slot_empty:
+          return SVN_NO_ERROR;
+
+        case rcf_slot_used:
+          if (memcmp(slot + RCF_SLOT_SHA1, checksum->digest,
+                     APR_SHA1_DIGESTSIZE) == 0)
+            {
+              representation_t *rep = apr_pcalloc(result_pool,
+                                                  sizeof(*rep));
+              rcf_unpack_slot(rep, slot);
+              *rep_p = rep;
+              return SVN_NO_ERROR;
+            }
+          continue;
+
+        default:
+          continue;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add REP to the hash file of FS, growing the table as necessary.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+rcf_set_rep(svn_fs_t *fs,
+            representation_t *rep,
+            apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  rcf_header_t header;
+  svn_error_t *err;
+
+  /* Serialize with other writers, unless the lock is already being held
+   * through svn_fs_fs__with_rep_cache_lock(). */
+  if (!ffd->rep_cache_file_locked)
+    SVN_ERR(svn_io_lock_open_file(ffd->rep_cache_file, TRUE, FALSE,
+                                  scratch_pool));
+
+  /* The header may have changed since we opened the file. */
+  err = rcf_read_header(&header, ffd->rep_cache_file, scratch_pool);
+
+  /* Keep the load factor below 75%. */
+  if (!err && header.used + 1 > header.capacity - header.capacity / 4)
+    err = rcf_grow(fs, &header, scratch_pool);
+
+  if (!err)
+    err = rcf_insert(ffd->rep_cache_file, &header, rep, scratch_pool);
+  if (!err)
+    err = rcf_write_header(ffd->rep_cache_file, &header, scratch_pool);
+
+  if (ffd->rep_cache_file_locked)
+    return svn_error_trace(err);
+
+  return svn_error_compose_create(err,
+                                  svn_io_unlock_open_file(
+                                    ffd->rep_cache_file, scratch_pool));
+}
+
+/* The hash file implementation of svn_fs_fs__walk_rep_reference(),
+ * with identical semantics. */
+static svn_error_t *
+rcf_walk_rep_reference(svn_fs_t *fs,
+                       svn_revnum_t start,
+                       svn_revnum_t end,
+                       svn_error_t *(*walker)(representation_t *,
+                                              void *,
+                                              svn_fs_t *,
+                                              apr_pool_t *),
+                       void *walker_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  rcf_header_t header;
+  unsigned char slot[RCF_SLOT_SIZE];
+  apr_uint64_t i;
+  int iterations = 0;
+
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(rcf_read_header(&header, ffd->rep_cache_file, pool));
+
+  /* Check global invariants. */
+  if (start == 0)
+    {
+      svn_revnum_t max = SVN_INVALID_REVNUM;
+
+      for (i = 0; i < header.capacity; ++i)
+        {
+          SVN_ERR(rcf_read_slot(slot, ffd->rep_cache_file, i, iterpool));
+          if (rcf_classify_slot(slot) == rcf_slot_used)
+            {
+              svn_revnum_t revision
+                = (svn_revnum_t)rcf_read_uint64(slot + RCF_SLOT_REVISION);
+              if (!SVN_IS_VALID_REVNUM(max) || revision > max)
+                max = revision;
+            }
+        }
+
+      if (SVN_IS_VALID_REVNUM(max))  /* The rep-cache could be empty. */
+        SVN_ERR(svn_fs_fs__ensure_revision_exists(max, fs, iterpool));
+    }
+
+  /* Walk the cache entries. */
+  for (i = 0; i < header.capacity; ++i)
+    {
+      representation_t *rep;
+
+      /* Clear ITERPOOL occasionally. */
+      if (iterations++ % 16 == 0)
+        svn_pool_clear(iterpool);
+
+      /* Check for cancellation. */
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(rcf_read_slot(slot, ffd->rep_cache_file, i, iterpool));
+      if (rcf_classify_slot(slot) != rcf_slot_used)
+        continue;
+
+      rep = apr_pcalloc(iterpool, sizeof(*rep));
+      rcf_unpack_slot(rep, slot);
+      if (rep->revision < start || (SVN_IS_VALID_REVNUM(end)
+                                    && rep->revision > end))
+        continue;
+
+      SVN_ERR(walker(rep, walker_baton, fs, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* The hash file implementation of svn_fs_fs__del_rep_reference(),
+ * with identical semantics. */
+static svn_error_t *
+rcf_del_rep_reference(svn_fs_t *fs,
+                      svn_revnum_t youngest,
+                      apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  rcf_header_t header;
+  unsigned char slot[RCF_SLOT_SIZE];
+  apr_uint64_t i;
+  svn_error_t *err;
+
+  if (!ffd->rep_cache_file_locked)
+    SVN_ERR(svn_io_lock_open_file(ffd->rep_cache_file, TRUE, FALSE,
+                                  scratch_pool));
+
+  err = rcf_read_header(&header, ffd->rep_cache_file, scratch_pool);
+  for (i = 0; !err && i < header.capacity; ++i)
+    {
+      err = rcf_read_slot(slot, ffd->rep_cache_file, i, scratch_pool);
+      if (err || rcf_classify_slot(slot) != rcf_slot_used)
+        continue;
+
+      if ((svn_revnum_t)rcf_read_uint64(slot + RCF_SLOT_REVISION)
+          > youngest)
+        {
+          /* Replace the entry with a tombstone to keep the probe
+           * sequences of the remaining entries intact. */
+          memset(slot, 0, RCF_SLOT_SIZE);
+          rcf_write_uint32(slot + RCF_SLOT_CHECKSUM, 0xffffffffu);
+          err = rcf_write_slot(ffd->rep_cache_file, i, slot, scratch_pool);
+          if (!err)
+            --header.used;
+        }
+    }
+
+  if (!err)
+    err = rcf_write_header(ffd->rep_cache_file, &header, scratch_pool);
+
+  if (ffd->rep_cache_file_locked)
+    return svn_error_trace(err);
+
+  return svn_error_compose_create(err,
+                                  svn_io_unlock_open_file(
+                                    ffd->rep_cache_file, scratch_pool));
+}
+
 
 /** Library-private API's. **/
 
@@ -64,6 +720,9 @@ open_rep_cache(void *baton,
   const char *db_path;
   int version;
 
+  if (ffd->rep_cache_file_backend)
+    return svn_error_trace(rcf_open(fs, pool));
+
   /* Open (or create) the sqlite database.  It will be automatically
      closed when fs->pool is destroyed. */
   db_path = path_rep_cache_db(fs->path, pool);
@@ -124,12 +783,14 @@ svn_fs_fs__open_rep_cache(svn_fs_t *fs,
                           apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
+  const char *path = ffd->rep_cache_file_backend
+                   ? path_rep_cache_file(fs->path, pool)
+                   : path_rep_cache_db(fs->path, pool);
   svn_error_t *err = svn_atomic__init_once(&ffd->rep_cache_db_opened,
                                            open_rep_cache, fs, pool);
   return svn_error_quick_wrapf(err,
                                _("Couldn't open rep-cache database '%s'"),
-                               svn_dirent_local_style(
-                                 path_rep_cache_db(fs->path, pool), pool));
+                               svn_dirent_local_style(path, pool));
 }
 
 svn_error_t *
@@ -144,6 +805,13 @@ svn_fs_fs__close_rep_cache(svn_fs_t *fs)
       ffd->rep_cache_db_opened = 0;
     }
 
+  if (ffd->rep_cache_file)
+    {
+      SVN_ERR(svn_io_file_close(ffd->rep_cache_file, fs->pool));
+      ffd->rep_cache_file = NULL;
+      ffd->rep_cache_db_opened = 0;
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -151,10 +819,13 @@ svn_error_t *
 svn_fs_fs__exists_rep_cache(svn_boolean_t *exists,
                             svn_fs_t *fs, apr_pool_t *pool)
 {
+  fs_fs_data_t *ffd = fs->fsap_data;
   svn_node_kind_t kind;
+  const char *path = ffd->rep_cache_file_backend
+                   ? path_rep_cache_file(fs->path, pool)
+                   : path_rep_cache_db(fs->path, pool);
 
-  SVN_ERR(svn_io_check_path(path_rep_cache_db(fs->path, pool),
-                            &kind, pool));
+  SVN_ERR(svn_io_check_path(path, &kind, pool));
 
   *exists = (kind != svn_node_none);
   return SVN_NO_ERROR;
@@ -183,9 +854,15 @@ svn_fs_fs__walk_rep_reference(svn_fs_t *fs,
   /* Don't check ffd->rep_sharing_allowed. */
   SVN_ERR_ASSERT(ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT);
 
-  if (! ffd->rep_cache_db)
+  if (! ffd->rep_cache_db && ! ffd->rep_cache_file)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
+  if (ffd->rep_cache_file_backend)
+    return svn_error_trace(rcf_walk_rep_reference(fs, start, end,
+                                                  walker, walker_baton,
+                                                  cancel_func, cancel_baton,
+                                                  pool));
+
   /* Check global invariants. */
   if (start == 0)
     {
@@ -272,7 +949,7 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
   representation_t *rep;
 
   SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
-  if (! ffd->rep_cache_db)
+  if (! ffd->rep_cache_db && ! ffd->rep_cache_file)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
   /* We only allow SHA1 checksums in this table. */
@@ -281,26 +958,35 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
                             _("Only SHA1 checksums can be used as keys in the "
                               "rep_cache table.\n"));
 
-  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db, STMT_GET_REP));
-  SVN_ERR(svn_sqlite__bindf(stmt, "s",
-                            svn_checksum_to_cstring(checksum, pool)));
-
-  SVN_ERR(svn_sqlite__step(&have_row, stmt));
-  if (have_row)
+  if (ffd->rep_cache_file_backend)
     {
-      rep = apr_pcalloc(pool, sizeof(*rep));
-      svn_fs_fs__id_txn_reset(&(rep->txn_id));
-      memcpy(rep->sha1_digest, checksum->digest, sizeof(rep->sha1_digest));
-      rep->has_sha1 = TRUE;
-      rep->revision = svn_sqlite__column_revnum(stmt, 0);
-      rep->item_index = svn_sqlite__column_int64(stmt, 1);
-      rep->size = svn_sqlite__column_int64(stmt, 2);
-      rep->expanded_size = svn_sqlite__column_int64(stmt, 3);
+      SVN_ERR(rcf_get_rep(&rep, fs, checksum, pool));
     }
   else
-    rep = NULL;
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                        STMT_GET_REP));
+      SVN_ERR(svn_sqlite__bindf(stmt, "s",
+                                svn_checksum_to_cstring(checksum, pool)));
 
-  SVN_ERR(svn_sqlite__reset(stmt));
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+      if (have_row)
+        {
+          rep = apr_pcalloc(pool, sizeof(*rep));
+          svn_fs_fs__id_txn_reset(&(rep->txn_id));
+          memcpy(rep->sha1_digest, checksum->digest,
+                 sizeof(rep->sha1_digest));
+          rep->has_sha1 = TRUE;
+          rep->revision = svn_sqlite__column_revnum(stmt, 0);
+          rep->item_index = svn_sqlite__column_int64(stmt, 1);
+          rep->size = svn_sqlite__column_int64(stmt, 2);
+          rep->expanded_size = svn_sqlite__column_int64(stmt, 3);
+        }
+      else
+        rep = NULL;
+
+      SVN_ERR(svn_sqlite__reset(stmt));
+    }
 
   if (rep)
     {
@@ -333,7 +1019,7 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
   checksum.digest = rep->sha1_digest;
 
   SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
-  if (! ffd->rep_cache_db)
+  if (! ffd->rep_cache_db && ! ffd->rep_cache_file)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
   /* We only allow SHA1 checksums in this table. */
@@ -342,6 +1028,9 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
                             _("Only SHA1 checksums can be used as keys in the "
                               "rep_cache table.\n"));
 
+  if (ffd->rep_cache_file_backend)
+    return svn_error_trace(rcf_set_rep(fs, rep, pool));
+
   SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db, STMT_SET_REP));
   SVN_ERR(svn_sqlite__bindf(stmt, "siiii",
                             svn_checksum_to_cstring(&checksum, pool),
@@ -365,9 +1054,12 @@ svn_fs_fs__del_rep_reference(svn_fs_t *fs,
   svn_sqlite__stmt_t *stmt;
 
   SVN_ERR_ASSERT(ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT);
-  if (! ffd->rep_cache_db)
+  if (! ffd->rep_cache_db && ! ffd->rep_cache_file)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
+  if (ffd->rep_cache_file_backend)
+    return svn_error_trace(rcf_del_rep_reference(fs, youngest, pool));
+
   SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
                                     STMT_DEL_REPS_YOUNGER_THAN_REV));
   SVN_ERR(svn_sqlite__bindf(stmt, "r", youngest));
@@ -386,9 +1078,17 @@ lock_rep_cache(svn_fs_t *fs,
 {
   fs_fs_data_t *ffd = fs->fsap_data;
 
-  if (! ffd->rep_cache_db)
+  if (! ffd->rep_cache_db && ! ffd->rep_cache_file)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
+  if (ffd->rep_cache_file_backend)
+    {
+      SVN_ERR(svn_io_lock_open_file(ffd->rep_cache_file, TRUE, FALSE,
+                                    pool));
+      ffd->rep_cache_file_locked = TRUE;
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(svn_sqlite__exec_statements(ffd->rep_cache_db, STMT_LOCK_REP));
 
   return SVN_NO_ERROR;
@@ -401,6 +1101,14 @@ unlock_rep_cache(svn_fs_t *fs,
 {
   fs_fs_data_t *ffd = fs->fsap_data;
 
+  if (ffd->rep_cache_file_backend)
+    {
+      SVN_ERR_ASSERT(ffd->rep_cache_file); /* opened by lock_rep_cache() */
+      ffd->rep_cache_file_locked = FALSE;
+      return svn_error_trace(svn_io_unlock_open_file(ffd->rep_cache_file,
+                                                     pool));
+    }
+
   SVN_ERR_ASSERT(ffd->rep_cache_db); /* was opened by lock_rep_cache() */
 
   SVN_ERR(svn_sqlite__exec_statements(ffd->rep_cache_db, STMT_UNLOCK_REP));
@@ -34,6 +34,10 @@ extern "C" {
 
 #define REP_CACHE_DB_NAME        "rep-cache.db"
 
+/* Name of the alternative hash file backend, see the 'rep-cache-backend'
+   option in fsfs.conf. */
+#define REP_CACHE_FILE_NAME      "rep-cache.hash"
+
 /* Open and create, if needed, the rep cache database associated with FS.
    Use POOL for temporary allocations. */
 svn_error_t *
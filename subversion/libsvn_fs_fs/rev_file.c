@@ -20,6 +20,8 @@
  * ====================================================================
  */
 
+#include "svn_pools.h"
+
 #include "rev_file.h"
 #include "fs_fs.h"
 #include "index.h"
@@ -31,6 +33,288 @@
 #include "private/svn_io_private.h"
 #include "svn_private_config.h"
 
+/* A process-global cache of file handles for rev / pack files.  Under
+ * concurrent load, the same pack file gets opened and closed over and
+ * over; keeping a bounded number of recently used handles open removes
+ * most of that open()+close() churn.
+ *
+ * A handle is always used exclusively:  svn_fs_fs__open_pack_or_rev_file
+ * checks it out of the cache and it only returns when the revision file
+ * gets closed - either explicitly or implicitly with its pool.  Hence,
+ * the usual seek-based access patterns remain safe.  Only idle handles
+ * are kept in the cache, LRU-evicted beyond MAX_IDLE_HANDLE_COUNT.
+ * Rev and pack file contents are immutable, but the file under a cached
+ * path may still be replaced wholesale - a background pack, a hotcopy
+ * restored over the repository, a deleted and re-created repository.
+ * Hence, checkout re-validates the handle against the file currently on
+ * disk (device / inode pair) and discards it on mismatch, so long-lived
+ * processes never serve data from a replaced file's old inode.
+ */
+
+/* Maximum number of idle handles kept open, i.e. upper limit to the
+ * number of file descriptors spent on this cache. */
+#define MAX_IDLE_HANDLE_COUNT 32
+
+/* An open rev / pack file handle, either checked out by some reader or
+ * sitting idle in the handle cache. */
+typedef struct cached_handle_t
+{
+  /* full path to the rev / pack file; used as the cache key */
+  const char *path;
+
+  /* the open file, read-only, buffered */
+  apr_file_t *file;
+
+  /* identity of the file that FILE refers to, as reported at open time;
+   * 0 / 0 on platforms that don't provide the respective info */
+  apr_dev_t device;
+  apr_ino_t inode;
+
+  /* private pool holding PATH and FILE; destroying it closes the file */
+  apr_pool_t *pool;
+
+  /* value of HANDLE_CACHE_COUNTER when this handle last became idle */
+  apr_uint64_t last_used;
+
+  /* next idle handle for the same PATH, or NULL if there is none.
+   * Undefined while the handle is checked out. */
+  struct cached_handle_t *next;
+} cached_handle_t;
+
+/* The cache of idle handles, mapping file path to the head of a list of
+ * cached_handle_t.  The hash key is always the head's PATH member.  All
+ * of the following are protected by HANDLE_CACHE_MUTEX. */
+static svn_mutex__t *handle_cache_mutex = NULL;
+static apr_pool_t *handle_cache_pool = NULL;
+static apr_hash_t *handle_cache = NULL;
+static int handle_cache_idle_count = 0;
+static apr_uint64_t handle_cache_counter = 0;
+
+static volatile svn_atomic_t handle_cache_init_status = 0;
+
+/* svn_atomic__init_once callback setting up the handle cache globals. */
+static svn_error_t *
+handle_cache_init_func(void *baton,
+                       apr_pool_t *pool)
+{
+  handle_cache_pool = svn_pool_create(NULL);
+
+  SVN_ERR(svn_mutex__init(&handle_cache_mutex, TRUE, handle_cache_pool));
+  handle_cache = apr_hash_make(handle_cache_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove the idle list head HANDLE for its path from the cache.
+ * To be called with HANDLE_CACHE_MUTEX held. */
+static void
+handle_cache_pop(cached_handle_t *handle)
+{
+  /* Remove the old pair before re-adding the successor:  replacing the
+   * value in place would silently retain the current key string, which
+   * lives in HANDLE's pool. */
+  apr_hash_set(handle_cache, handle->path, APR_HASH_KEY_STRING, NULL);
+  if (handle->next)
+    apr_hash_set(handle_cache, handle->next->path, APR_HASH_KEY_STRING,
+                 handle->next);
+
+  --handle_cache_idle_count;
+}
+
+/* Close and remove the least recently used idle handle, if there is one.
+ * To be called with HANDLE_CACHE_MUTEX held. */
+static void
+handle_cache_evict_one(void)
+{
+  apr_hash_index_t *hi;
+  cached_handle_t *victim = NULL;
+  cached_handle_t *head;
+
+  for (hi = apr_hash_first(NULL, handle_cache); hi; hi = apr_hash_next(hi))
+    {
+      cached_handle_t *handle;
+      for (handle = apr_hash_this_val(hi); handle; handle = handle->next)
+        if (victim == NULL || handle->last_used < victim->last_used)
+          victim = handle;
+    }
+
+  if (victim == NULL)
+    return;
+
+  head = apr_hash_get(handle_cache, victim->path, APR_HASH_KEY_STRING);
+  if (head == victim)
+    {
+      handle_cache_pop(victim);
+    }
+  else
+    {
+      cached_handle_t *prev = head;
+      while (prev->next != victim)
+        prev = prev->next;
+      prev->next = victim->next;
+
+      --handle_cache_idle_count;
+    }
+
+  svn_pool_destroy(victim->pool);
+}
+
+/* Set *HANDLE to an open, read-only, buffered file handle for PATH,
+ * either recycling an idle handle from the cache or opening the file anew.
+ * Use SCRATCH_POOL for temporary allocations.
+ * To be called with HANDLE_CACHE_MUTEX held. */
+static svn_error_t *
+handle_cache_get(cached_handle_t **handle,
+                 const char *path,
+                 apr_pool_t *scratch_pool)
+{
+  cached_handle_t *result = apr_hash_get(handle_cache, path,
+                                         APR_HASH_KEY_STRING);
+  if (result)
+    {
+      apr_finfo_t finfo;
+      apr_dev_t device = 0;
+      apr_ino_t inode = 0;
+
+      handle_cache_pop(result);
+
+      /* The file under PATH may have been replaced since the handle got
+       * cached, e.g. by restoring a hotcopy over the repository.  Compare
+       * the identity of the file currently on disk with the one that the
+       * handle was opened for; toss the handle if in doubt.  A failing
+       * stat falls through to a fresh open, which then raises the
+       * appropriate error. */
+      if (apr_stat(&finfo, path, APR_FINFO_DEV | APR_FINFO_INODE,
+                   scratch_pool) == APR_SUCCESS)
+        {
+          device = finfo.device;
+          inode = finfo.inode;
+        }
+
+      if (device != result->device || inode != result->inode)
+        {
+          svn_pool_destroy(result->pool);
+          result = NULL;
+        }
+    }
+
+  if (result == NULL)
+    {
+      apr_file_t *file;
+      apr_finfo_t finfo;
+      apr_pool_t *subpool = svn_pool_create(handle_cache_pool);
+      svn_error_t *err = svn_io_file_open(&file, path,
+                                          APR_READ | APR_BUFFERED,
+                                          APR_OS_DEFAULT, subpool);
+      if (err)
+        {
+          svn_pool_destroy(subpool);
+          return svn_error_trace(err);
+        }
+
+      result = apr_palloc(subpool, sizeof(*result));
+      result->path = apr_pstrdup(subpool, path);
+      result->file = file;
+      result->pool = subpool;
+      result->last_used = 0;
+      result->next = NULL;
+
+      /* Remember the identity of the file we actually hold open, for
+       * the replacement check above. */
+      result->device = 0;
+      result->inode = 0;
+      if (apr_file_info_get(&finfo, APR_FINFO_DEV | APR_FINFO_INODE, file)
+          == APR_SUCCESS)
+        {
+          result->device = finfo.device;
+          result->inode = finfo.inode;
+        }
+    }
+
+  *handle = result;
+  return SVN_NO_ERROR;
+}
+
+/* Return the checked-out HANDLE to the cache, evicting the least
+ * recently used idle handle if the cache is full.
+ * To be called with HANDLE_CACHE_MUTEX held. */
+static svn_error_t *
+handle_cache_checkin(cached_handle_t *handle)
+{
+  cached_handle_t *head = apr_hash_get(handle_cache, handle->path,
+                                       APR_HASH_KEY_STRING);
+  handle->last_used = ++handle_cache_counter;
+  handle->next = head;
+
+  /* Make HANDLE's own path string the hash key, see handle_cache_pop. */
+  if (head)
+    apr_hash_set(handle_cache, head->path, APR_HASH_KEY_STRING, NULL);
+  apr_hash_set(handle_cache, handle->path, APR_HASH_KEY_STRING, handle);
+
+  if (++handle_cache_idle_count > MAX_IDLE_HANDLE_COUNT)
+    handle_cache_evict_one();
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup handler returning the checked-out handle BATON to the
+ * handle cache. */
+static apr_status_t
+return_handle(void *baton)
+{
+  cached_handle_t *handle = baton;
+  svn_error_t *err = svn_mutex__lock(handle_cache_mutex);
+
+  if (err)
+    {
+      /* Without the lock, we must not touch the cache structures;
+       * at least release the file descriptor. */
+      apr_status_t status = err->apr_err;
+      svn_error_clear(err);
+      apr_file_close(handle->file);
+
+      return status;
+    }
+
+  err = svn_mutex__unlock(handle_cache_mutex,
+                          handle_cache_checkin(handle));
+  if (err)
+    {
+      apr_status_t status = err->apr_err;
+      svn_error_clear(err);
+
+      return status;
+    }
+
+  return APR_SUCCESS;
+}
+
+/* Get a read-only, buffered file handle for the rev / pack file PATH from
+ * the global handle cache and return it in *HANDLE.  Schedule the handle
+ * to be returned to the cache when RESULT_POOL gets cleaned up. */
+static svn_error_t *
+get_cached_handle(cached_handle_t **handle,
+                  const char *path,
+                  apr_pool_t *result_pool)
+{
+  apr_off_t offset = 0;
+
+  SVN_ERR(svn_atomic__init_once(&handle_cache_init_status,
+                                handle_cache_init_func, NULL, NULL));
+
+  SVN_MUTEX__WITH_LOCK(handle_cache_mutex,
+                       handle_cache_get(handle, path, result_pool));
+
+  /* Hand the handle back to the cache together with RESULT_POOL. */
+  apr_pool_cleanup_register(result_pool, *handle, return_handle,
+                            apr_pool_cleanup_null);
+
+  /* A recycled handle remembers its old file position; rewind it to
+   * mimic a freshly opened file. */
+  return svn_error_trace(svn_io_file_seek((*handle)->file, APR_SET,
+                                          &offset, result_pool));
+}
+
 /* Initialize the *FILE structure for REVISION in filesystem FS.  Set its
  * pool member to the provided POOL. */
 static void
@@ -45,9 +329,12 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
   file->start_revision = svn_fs_fs__packed_base_rev(fs, revision);
 
   file->file = NULL;
+  file->cached_handle = NULL;
   file->stream = NULL;
   file->p2l_stream = NULL;
   file->l2p_stream = NULL;
+  file->mmap = NULL;
+  file->mmap_size = 0;
   file->block_size = ffd->block_size;
   file->l2p_offset = -1;
   file->l2p_checksum = NULL;
@@ -57,6 +344,55 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
   file->pool = pool;
 }
 
+/* If enabled in FS and supported by the platform, try to establish a
+ * read-only memory mapping of the whole (packed) file in FILE.  Mapping
+ * failures are not reported; FILE->MMAP simply stays NULL and all reads
+ * go through the buffered file instead. */
+static void
+auto_map_file(svn_fs_fs__revision_file_t *file,
+              svn_fs_t *fs,
+              apr_pool_t *result_pool)
+{
+#if APR_HAS_MMAP
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_finfo_t finfo;
+  apr_mmap_t *mm;
+
+  if (!ffd->use_mmap_rev_files || !file->is_packed)
+    return;
+
+  if (apr_file_info_get(&finfo, APR_FINFO_SIZE, file->file) != APR_SUCCESS)
+    return;
+
+  /* Files larger than the address space cannot be mapped (32 bit). */
+  if (finfo.size != (apr_off_t)(apr_size_t)finfo.size)
+    return;
+
+  if (apr_mmap_create(&mm, file->file, 0, (apr_size_t)finfo.size,
+                      APR_MMAP_READ, result_pool) == APR_SUCCESS)
+    {
+      file->mmap = mm;
+      file->mmap_size = finfo.size;
+    }
+#endif
+}
+
+svn_boolean_t
+svn_fs_fs__rev_file_mapped_range(const char **data,
+                                 svn_fs_fs__revision_file_t *file,
+                                 apr_off_t offset,
+                                 apr_size_t len)
+{
+  if (   file->mmap == NULL
+      || offset < 0
+      || offset > file->mmap_size
+      || (apr_off_t)len > file->mmap_size - offset)
+    return FALSE;
+
+  *data = (const char *)file->mmap->mm + (apr_size_t)offset;
+  return TRUE;
+}
+
 /* Baton type for set_read_only() */
 typedef struct set_read_only_baton_t
 {
@@ -150,8 +486,24 @@ open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
 
       /* open the revision file in buffered r/o or r/w mode */
       if (!err)
-        err = svn_io_file_open(&apr_file, path, flags, APR_OS_DEFAULT,
-                               result_pool);
+        {
+          if (writable)
+            {
+              err = svn_io_file_open(&apr_file, path, flags, APR_OS_DEFAULT,
+                                     result_pool);
+            }
+          else
+            {
+              /* Read-only access goes through the global handle cache. */
+              cached_handle_t *handle;
+              err = get_cached_handle(&handle, path, result_pool);
+              if (!err)
+                {
+                  apr_file = handle->file;
+                  file->cached_handle = handle;
+                }
+            }
+        }
 
       if (!err)
         {
@@ -159,6 +511,8 @@ open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
           file->stream = svn_stream_from_aprfile2(apr_file, TRUE,
                                                   result_pool);
           file->is_packed = svn_fs_fs__is_packed_rev(fs, rev);
+          if (!writable)
+            auto_map_file(file, fs, result_pool);
 
           return SVN_NO_ERROR;
         }
@@ -295,11 +649,30 @@ svn_fs_fs__close_revision_file(svn_fs_fs__revision_file_t *file)
 {
   if (file->stream)
     SVN_ERR(svn_stream_close(file->stream));
-  if (file->file)
-    SVN_ERR(svn_io_file_close(file->file, file->pool));
+#if APR_HAS_MMAP
+  if (file->mmap)
+    apr_mmap_delete(file->mmap);
+#endif
+  if (file->cached_handle)
+    {
+      /* Hand the underlying handle back to the cache instead of
+       * closing it. */
+      apr_status_t status = apr_pool_cleanup_run(file->pool,
+                                                 file->cached_handle,
+                                                 return_handle);
+      if (status)
+        return svn_error_wrap_apr(status, NULL);
+    }
+  else if (file->file)
+    {
+      SVN_ERR(svn_io_file_close(file->file, file->pool));
+    }
 
   file->file = NULL;
+  file->cached_handle = NULL;
   file->stream = NULL;
+  file->mmap = NULL;
+  file->mmap_size = 0;
   file->l2p_stream = NULL;
   file->p2l_stream = NULL;
 
@@ -23,6 +23,8 @@
 #ifndef SVN_LIBSVN_FS__REV_FILE_H
 #define SVN_LIBSVN_FS__REV_FILE_H
 
+#include <apr_mmap.h>
+
 #include "svn_fs.h"
 #include "id.h"
 
@@ -54,9 +56,22 @@ typedef struct svn_fs_fs__revision_file_t
   /* rev / pack file */
   apr_file_t *file;
 
+  /* handle from the global rev / pack file handle cache backing FILE,
+   * or NULL if FILE is privately owned (writable and proto-rev files).
+   * Only ever used within rev_file.c. */
+  void *cached_handle;
+
   /* stream based on FILE and not NULL exactly when FILE is not NULL */
   svn_stream_t *stream;
 
+  /* read-only memory mapping of the whole of FILE, or NULL if memory
+   * mapping is disabled, unsupported or failed for this file.  Only ever
+   * set for packed files, i.e. immutable contents. */
+  apr_mmap_t *mmap;
+
+  /* size of the mapped region; 0 iff MMAP is NULL */
+  apr_off_t mmap_size;
+
   /* the opened P2L index stream or NULL.  Always NULL for txns. */
   svn_fs_fs__packed_number_stream_t *p2l_stream;
 
@@ -120,6 +135,17 @@ svn_fs_fs__open_pack_or_rev_file_writable(svn_fs_fs__revision_file_t **file,
                                           apr_pool_t *result_pool,
                                           apr_pool_t *scratch_pool);
 
+/* If FILE is memory-mapped and the LEN bytes starting at OFFSET lie
+ * completely within the mapping, set *DATA to the respective address
+ * within the mapping and return TRUE.  Return FALSE otherwise, in which
+ * case the caller shall fall back to reading from FILE->FILE.
+ */
+svn_boolean_t
+svn_fs_fs__rev_file_mapped_range(const char **data,
+                                 svn_fs_fs__revision_file_t *file,
+                                 apr_off_t offset,
+                                 apr_size_t len);
+
 /* If the footer data in FILE has not been read, yet, do so now.
  * Index locations will only be read upon request as we assume they get
  * cached and the FILE is usually used for REP data access only.
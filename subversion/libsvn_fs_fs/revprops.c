@@ -196,22 +196,61 @@ parse_revprop(apr_hash_t **properties,
               apr_pool_t *result_pool,
               apr_pool_t *scratch_pool)
 {
-  svn_stream_t *stream = svn_stream_from_string(content, scratch_pool);
   *properties = apr_hash_make(result_pool);
 
-  SVN_ERR_W(svn_hash_read2(*properties, stream, SVN_HASH_TERMINATOR,
-                           result_pool),
-            apr_psprintf(scratch_pool, "Failed to parse revprops for r%ld.",
-                         revision));
+  /* The binary representation identifies itself by its marker byte;
+   * everything else is the textual hashdump format. */
+  if (content->len > 0 && content->data[0] == SVN_HASH__BINARY_MARKER)
+    {
+      SVN_ERR_W(svn_hash__read_binary(*properties, content, result_pool),
+                apr_psprintf(scratch_pool,
+                             "Failed to parse revprops for r%ld.",
+                             revision));
+    }
+  else
+    {
+      svn_stream_t *stream = svn_stream_from_string(content, scratch_pool);
+
+      SVN_ERR_W(svn_hash_read2(*properties, stream, SVN_HASH_TERMINATOR,
+                               result_pool),
+                apr_psprintf(scratch_pool,
+                             "Failed to parse revprops for r%ld.",
+                             revision));
+    }
 
   return SVN_NO_ERROR;
 }
 
+/* Serialize the revision property list PROPLIST to STREAM in the
+ * representation selected by FS's "binary-revprops" setting.
+ * Use POOL for temporary allocations.
+ */
+static svn_error_t *
+serialize_revprops(svn_stream_t *stream,
+                   svn_fs_t *fs,
+                   apr_hash_t *proplist,
+                   apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->binary_revprops)
+    return svn_error_trace(svn_hash__write_binary(proplist, stream, pool));
+
+  return svn_error_trace(svn_hash_write2(proplist, stream,
+                                         SVN_HASH_TERMINATOR, pool));
+}
+
 void
 svn_fs_fs__reset_revprop_cache(svn_fs_t *fs)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   ffd->revprop_prefix = 0;
+
+  /* Also, forget the memoized pack file content; it may be outdated now. */
+  ffd->revprop_memo_path = NULL;
+  ffd->revprop_memo_content = NULL;
+  if (ffd->revprop_memo_pool)
+    svn_pool_clear(ffd->revprop_memo_pool);
 }
 
 /* If FS has not a revprop cache prefix set, generate one.
@@ -440,7 +479,7 @@ same_shard(svn_fs_t *fs,
   return (r1 / ffd->max_files_per_dir) == (r2 / ffd->max_files_per_dir);
 }
 
-/* Given FS and the full packed file content in REVPROPS->PACKED_REVPROPS,
+/* Given FS and the uncompressed packed file content in UNCOMPRESSED,
  * fill the START_REVISION member, and make PACKED_REVPROPS point to the
  * first serialized revprop.  If READ_ALL is set, initialize the SIZES
  * and OFFSETS members as well.  If POPULATE_CACHE is set, cache all
@@ -453,6 +492,7 @@ same_shard(svn_fs_t *fs,
 static svn_error_t *
 parse_packed_revprops(svn_fs_t *fs,
                       packed_revprops_t *revprops,
+                      svn_stringbuf_t *uncompressed,
                       svn_boolean_t read_all,
                       svn_boolean_t populate_cache,
                       apr_pool_t *result_pool,
@@ -467,13 +507,6 @@ parse_packed_revprops(svn_fs_t *fs,
   /* Initial value for the "Leaking bucket" pattern. */
   int bucket = 4;
 
-  /* decompress (even if the data is only "stored", there is still a
-   * length header to remove) */
-  svn_stringbuf_t *compressed = revprops->packed_revprops;
-  svn_stringbuf_t *uncompressed = svn_stringbuf_create_empty(result_pool);
-  SVN_ERR(svn__decompress_zlib(compressed->data, compressed->len,
-                               uncompressed, APR_SIZE_MAX));
-
   /* read first revision number and number of revisions in the pack */
   stream = svn_stream_from_stringbuf(uncompressed, scratch_pool);
   SVN_ERR(svn_fs_fs__read_number_from_stream(&first_rev, NULL, stream,
@@ -613,10 +646,12 @@ read_pack_revprop(packed_revprops_t **revprops,
                   svn_boolean_t populate_cache,
                   apr_pool_t *pool)
 {
+  fs_fs_data_t *ffd = fs->fsap_data;
   apr_pool_t *iterpool = svn_pool_create(pool);
   svn_boolean_t missing = FALSE;
   svn_error_t *err;
   packed_revprops_t *result;
+  svn_stringbuf_t *uncompressed = NULL;
   int i;
 
   /* someone insisted that REV is packed. Double-check if necessary */
@@ -634,7 +669,8 @@ read_pack_revprop(packed_revprops_t **revprops,
   /* try to read the packed revprops. This may require retries if we have
    * concurrent writers. */
   for (i = 0;
-       i < SVN_FS_FS__RECOVERABLE_RETRY_COUNT && !result->packed_revprops;
+       i < SVN_FS_FS__RECOVERABLE_RETRY_COUNT
+         && !result->packed_revprops && !uncompressed;
        ++i)
     {
       const char *file_path;
@@ -647,21 +683,72 @@ read_pack_revprop(packed_revprops_t **revprops,
       file_path  = svn_dirent_join(result->folder,
                                    result->filename,
                                    iterpool);
+
+      /* If we still have the uncompressed content of that very file from
+       * a previous access, use it right away.  Any change to the packed
+       * revprops would have changed the file name in the manifest. */
+      if (!read_all
+          && ffd->revprop_memo_path
+          && strcmp(ffd->revprop_memo_path, file_path) == 0)
+        {
+          uncompressed = ffd->revprop_memo_content;
+          break;
+        }
+
       SVN_ERR(svn_fs_fs__try_stringbuf_from_file(&result->packed_revprops,
                                 &missing,
                                 file_path,
                                 i + 1 < SVN_FS_FS__RECOVERABLE_RETRY_COUNT,
                                 pool));
+
+      if (result->packed_revprops)
+        {
+          /* Uncompress the pack file (even if the data is only "stored",
+           * there is still a length header to remove).  Keep the result
+           * around for follow-up accesses to the same pack file, e.g.
+           * sequential scans like 'svn log'.  Writers, OTOH, may modify
+           * the buffer contents, so don't share it with them. */
+          apr_pool_t *target_pool = pool;
+          if (!read_all)
+            {
+              ffd->revprop_memo_path = NULL;
+              ffd->revprop_memo_content = NULL;
+              if (!ffd->revprop_memo_pool)
+                ffd->revprop_memo_pool = svn_pool_create(fs->pool);
+              else
+                svn_pool_clear(ffd->revprop_memo_pool);
+
+              target_pool = ffd->revprop_memo_pool;
+            }
+
+          uncompressed = svn_stringbuf_create_empty(target_pool);
+          err = svn__decompress_zlib(result->packed_revprops->data,
+                                     result->packed_revprops->len,
+                                     uncompressed, APR_SIZE_MAX);
+          if (err)
+            {
+              svn_pool_destroy(iterpool);
+              return svn_error_createf(SVN_ERR_FS_CORRUPT, err,
+                            _("Revprop pack file for r%ld is corrupt"), rev);
+            }
+
+          if (!read_all)
+            {
+              ffd->revprop_memo_content = uncompressed;
+              ffd->revprop_memo_path
+                = apr_pstrdup(ffd->revprop_memo_pool, file_path);
+            }
+        }
     }
 
   /* the file content should be available now */
-  if (!result->packed_revprops)
+  if (!uncompressed)
     return svn_error_createf(SVN_ERR_FS_PACKED_REVPROP_READ_FAILURE, NULL,
                   _("Failed to read revprop pack file for r%ld"), rev);
 
   /* parse it. RESULT will be complete afterwards. */
-  err = parse_packed_revprops(fs, result, read_all, populate_cache, pool,
-                              iterpool);
+  err = parse_packed_revprops(fs, result, uncompressed, read_all,
+                              populate_cache, pool, iterpool);
   svn_pool_destroy(iterpool);
   if (err)
     return svn_error_createf(SVN_ERR_FS_CORRUPT, err,
@@ -845,7 +932,7 @@ write_non_packed_revprop(const char **final_path,
                                    svn_dirent_dirname(*final_path, pool),
                                    svn_io_file_del_none, pool, pool));
   stream = svn_stream_from_aprfile2(file, TRUE, pool);
-  SVN_ERR(svn_hash_write2(proplist, stream, SVN_HASH_TERMINATOR, pool));
+  SVN_ERR(serialize_revprops(stream, fs, proplist, pool));
   SVN_ERR(svn_stream_close(stream));
 
   /* Flush temporary file to disk and close it. */
@@ -1099,7 +1186,7 @@ write_packed_revprop(const char **final_path,
   /* serialize the new revprops */
   serialized = svn_stringbuf_create_empty(pool);
   stream = svn_stream_from_stringbuf(serialized, pool);
-  SVN_ERR(svn_hash_write2(proplist, stream, SVN_HASH_TERMINATOR, pool));
+  SVN_ERR(serialize_revprops(stream, fs, proplist, pool));
   SVN_ERR(svn_stream_close(stream));
 
   /* calculate the size of the new data */
@@ -20,6 +20,8 @@
  * ====================================================================
  */
 
+#include <apr_thread_proc.h>
+
 #include "svn_dirent_uri.h"
 #include "svn_fs.h"
 #include "svn_pools.h"
@@ -123,6 +125,30 @@ typedef struct rep_ref_t
 
 } rep_ref_t;
 
+/* Identifies a representation by its location.  Used as hash key for the
+ * out-of-range representation proxies kept by concurrent scan workers. */
+typedef struct rep_id_t
+{
+  /* Revision that contains the representation. */
+  svn_revnum_t revision;
+
+  /* Item index of the representation within REVISION. */
+  apr_uint64_t item_index;
+} rep_id_t;
+
+/* A delta chain length that a concurrent scan worker could not determine
+ * because the base representation lies outside the revision range covered
+ * by that worker.  Resolved while merging the worker results. */
+typedef struct chain_fixup_t
+{
+  /* The representation whose CHAIN_LENGTH is yet to be determined. */
+  rep_stats_t *rep;
+
+  /* Location of the base representation. */
+  svn_revnum_t base_revision;
+  apr_uint64_t base_item_index;
+} chain_fixup_t;
+
 /* Represents a single revision.
  * There will be only one instance per revision. */
 typedef struct revision_info_t
@@ -203,6 +229,28 @@ typedef struct query_t
 
   /* Baton for CANCEL_FUNC. */
   void *cancel_baton;
+
+  /* First revision covered by REVISIONS.  This is 0, except for the
+   * worker contexts of a concurrent scan which each cover the revision
+   * range of a single pack file. */
+  svn_revnum_t first_revision;
+
+  /* Number of pack files to scan concurrently; 1 for a sequential scan. */
+  int concurrency;
+
+  /* In worker contexts, proxies for representations in revisions before
+   * FIRST_REVISION, keyed by rep_id_t.  NULL in the main context. */
+  apr_hash_t *proxy_reps;
+
+  /* In worker contexts, the delta chain lengths that could not be
+   * determined, yet.  Array of chain_fixup_t, ordered such that base
+   * representations within this context's range precede their dependents.
+   * NULL in the main context. */
+  apr_array_header_t *chain_fixups;
+
+  /* In worker contexts, the set of rep_stats_t * with a pending entry in
+   * CHAIN_FIXUPS, keyed by the pointer value.  NULL in the main context. */
+  apr_hash_t *pending_chains;
 } query_t;
 
 /* Initialize the LARGEST_CHANGES member in STATS with a capacity of COUNT
@@ -255,20 +303,15 @@ add_to_histogram(svn_fs_fs__histogram_t *histogram,
   histogram->lines[(apr_size_t)shift].sum += size;
 }
 
-/* Update data aggregators in STATS with this representation of type KIND,
- * on-disk REP_SIZE and expanded node size EXPANDED_SIZE for PATH in REVSION.
- * PLAIN_ADDED indicates whether the node has a deltification predecessor.
+/* If the change of REP_SIZE for PATH in REVISION qualifies, insert it into
+ * the "largest changes" list of STATS.
  */
 static void
-add_change(svn_fs_fs__stats_t *stats,
-           apr_uint64_t rep_size,
-           apr_uint64_t expanded_size,
-           svn_revnum_t revision,
-           const char *path,
-           rep_kind_t kind,
-           svn_boolean_t plain_added)
+store_largest_change(svn_fs_fs__stats_t *stats,
+                     apr_uint64_t rep_size,
+                     svn_revnum_t revision,
+                     const char *path)
 {
-  /* identify largest reps */
   if (rep_size >= stats->largest_changes->min_size)
     {
       apr_size_t i;
@@ -291,6 +334,23 @@ add_change(svn_fs_fs__stats_t *stats,
       largest_changes->min_size
         = largest_changes->changes[largest_changes->count-1]->size;
     }
+}
+
+/* Update data aggregators in STATS with this representation of type KIND,
+ * on-disk REP_SIZE and expanded node size EXPANDED_SIZE for PATH in REVSION.
+ * PLAIN_ADDED indicates whether the node has a deltification predecessor.
+ */
+static void
+add_change(svn_fs_fs__stats_t *stats,
+           apr_uint64_t rep_size,
+           apr_uint64_t expanded_size,
+           svn_revnum_t revision,
+           const char *path,
+           rep_kind_t kind,
+           svn_boolean_t plain_added)
+{
+  /* identify largest reps */
+  store_largest_change(stats, rep_size, revision, path);
 
   /* global histograms */
   add_to_histogram(&stats->rep_size_histogram, rep_size);
@@ -393,7 +453,9 @@ find_representation(int *idx,
   info = revision_info ? *revision_info : NULL;
   if (info == NULL || info->revision != revision)
     {
-      info = APR_ARRAY_IDX(query->revisions, revision, revision_info_t*);
+      info = APR_ARRAY_IDX(query->revisions,
+                           revision - query->first_revision,
+                           revision_info_t*);
       if (revision_info)
         *revision_info = info;
     }
@@ -419,6 +481,74 @@ find_representation(int *idx,
   return NULL;
 }
 
+/* In the worker context QUERY, return the proxy object for the
+ * representation REP which lies outside the revision range covered by
+ * QUERY.  Auto-construct the proxy, allocating it in RESULT_POOL, if
+ * this is the first reference we encounter.
+ */
+static rep_stats_t *
+get_proxy_representation(query_t *query,
+                         representation_t *rep,
+                         apr_pool_t *result_pool)
+{
+  rep_stats_t *proxy;
+  rep_id_t rep_id;
+
+  /* make sure the padding bytes are deterministic as well */
+  memset(&rep_id, 0, sizeof(rep_id));
+  rep_id.revision = rep->revision;
+  rep_id.item_index = rep->item_index;
+
+  proxy = apr_hash_get(query->proxy_reps, &rep_id, sizeof(rep_id));
+  if (!proxy)
+    {
+      proxy = apr_pcalloc(result_pool, sizeof(*proxy));
+      proxy->revision = rep->revision;
+      proxy->expanded_size = rep->expanded_size;
+      proxy->item_index = rep->item_index;
+      proxy->size = rep->size;
+
+      /* The representation received its first reference in its own
+       * revision, i.e. in the range of some other context.  Starting at 1
+       * ensures that the "first use" handling in read_noderev() never
+       * triggers for proxies; only the extra references accumulate here. */
+      proxy->ref_count = 1;
+
+      apr_hash_set(query->proxy_reps,
+                   apr_pmemdup(result_pool, &rep_id, sizeof(rep_id)),
+                   sizeof(rep_id), proxy);
+    }
+
+  return proxy;
+}
+
+/* In the worker context QUERY, record that the chain length of REP has
+ * yet to be derived from the base representation at BASE_REVISION,
+ * BASE_ITEM_INDEX.  Allocate the bookkeeping data in RESULT_POOL.
+ */
+static void
+defer_chain_length(query_t *query,
+                   rep_stats_t *rep,
+                   svn_revnum_t base_revision,
+                   apr_uint64_t base_item_index,
+                   apr_pool_t *result_pool)
+{
+  chain_fixup_t fixup;
+
+  fixup.rep = rep;
+  fixup.base_revision = base_revision;
+  fixup.base_item_index = base_item_index;
+  APR_ARRAY_PUSH(query->chain_fixups, chain_fixup_t) = fixup;
+
+  /* Chain lengths derived from REP must be deferred as well. */
+  apr_hash_set(query->pending_chains,
+               apr_pmemdup(result_pool, &rep, sizeof(rep)),
+               sizeof(rep), rep);
+
+  /* Interim value; to be corrected when the fixup gets resolved. */
+  rep->chain_length = 1;
+}
+
 /* Find / auto-construct the representation stats for REP in QUERY and
  * return it in *REPRESENTATION.
  *
@@ -436,6 +566,15 @@ parse_representation(rep_stats_t **representation,
   rep_stats_t *result;
   int idx;
 
+  /* Delegate references into revision ranges covered by other worker
+   * contexts to proxies.  Those references get merged into the actual
+   * representation objects after the concurrent scan completed. */
+  if (rep->revision < query->first_revision)
+    {
+      *representation = get_proxy_representation(query, rep, result_pool);
+      return SVN_NO_ERROR;
+    }
+
   /* read location (revision, offset) and size */
 
   /* look it up */
@@ -473,14 +612,30 @@ parse_representation(rep_stats_t **representation,
           /* Determine length of the delta chain. */
           if (header->type == svn_fs_fs__rep_delta)
             {
-              int base_idx;
-              rep_stats_t *base_rep
-                = find_representation(&base_idx, query, NULL,
-                                      header->base_revision,
-                                      header->base_item_index);
-
-              result->chain_length = 1 + MIN(base_rep->chain_length,
-                                             (apr_byte_t)0xfe);
+              if (header->base_revision < query->first_revision)
+                {
+                  /* The base lies in the range of some other worker
+                   * context. */
+                  defer_chain_length(query, result, header->base_revision,
+                                     header->base_item_index, result_pool);
+                }
+              else
+                {
+                  int base_idx;
+                  rep_stats_t *base_rep
+                    = find_representation(&base_idx, query, NULL,
+                                          header->base_revision,
+                                          header->base_item_index);
+
+                  if (   query->pending_chains
+                      && apr_hash_get(query->pending_chains, &base_rep,
+                                      sizeof(base_rep)))
+                    defer_chain_length(query, result, header->base_revision,
+                                       header->base_item_index, result_pool);
+                  else
+                    result->chain_length = 1 + MIN(base_rep->chain_length,
+                                                   (apr_byte_t)0xfe);
+                }
             }
           else
             {
@@ -940,11 +1095,13 @@ compare_representation_refs(const void *lhs, const void *rhs)
 
 /* Given all the presentations found in a single rev / pack file as
  * rep_ref_t * in REP_REFS, update the delta chain lengths in QUERY.
- * REP_REFS and its contents can then be discarded.
+ * REP_REFS and its contents can then be discarded.  Use RESULT_POOL for
+ * any bookkeeping that needs to outlive this function.
  */
 static svn_error_t *
 resolve_representation_refs(query_t *query,
-                            apr_array_header_t *rep_refs)
+                            apr_array_header_t *rep_refs,
+                            apr_pool_t *result_pool)
 {
   int i;
 
@@ -972,6 +1129,12 @@ resolve_representation_refs(query_t *query,
         {
           rep->chain_length = 1;
         }
+      else if (ref->base_revision < query->first_revision)
+        {
+          /* The base lies in the range of some other worker context. */
+          defer_chain_length(query, rep, ref->base_revision,
+                             ref->base_item_index, result_pool);
+        }
       else
         {
           rep_stats_t *base;
@@ -981,7 +1144,13 @@ resolve_representation_refs(query_t *query,
           SVN_ERR_ASSERT(base);
           SVN_ERR_ASSERT(base->chain_length);
 
-          rep->chain_length = 1 + MIN(base->chain_length, (apr_byte_t)0xfe);
+          if (   query->pending_chains
+              && apr_hash_get(query->pending_chains, &base, sizeof(base)))
+            defer_chain_length(query, rep, ref->base_revision,
+                               ref->base_item_index, result_pool);
+          else
+            rep->chain_length = 1 + MIN(base->chain_length,
+                                        (apr_byte_t)0xfe);
         }
     }
 
@@ -1034,7 +1203,8 @@ read_log_rev_or_packfile(query_t *query,
 
   /* record the whole pack size in the first rev so the total sum will
      still be correct */
-  APR_ARRAY_IDX(query->revisions, base, revision_info_t*)->end = max_offset;
+  APR_ARRAY_IDX(query->revisions, base - query->first_revision,
+                revision_info_t*)->end = max_offset;
 
   /* for all offsets in the file, get the P2L index entries and process
      the interesting items (change lists, noderevs) */
@@ -1070,7 +1240,8 @@ read_log_rev_or_packfile(query_t *query,
             continue;
 
           /* read and process interesting items */
-          info = APR_ARRAY_IDX(query->revisions, entry->item.revision,
+          info = APR_ARRAY_IDX(query->revisions,
+                               entry->item.revision - query->first_revision,
                                revision_info_t*);
 
           if (entry->type == SVN_FS_FS__ITEM_TYPE_NODEREV)
@@ -1126,7 +1297,7 @@ read_log_rev_or_packfile(query_t *query,
     }
 
   /* Resolve the delta chain links. */
-  SVN_ERR(resolve_representation_refs(query, rep_refs));
+  SVN_ERR(resolve_representation_refs(query, rep_refs, result_pool));
 
   /* clean up and close file handles */
   svn_pool_destroy(iterpool);
@@ -1183,6 +1354,339 @@ read_log_revision_file(query_t *query,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* forward declaration */
+static svn_fs_fs__stats_t *
+create_stats(apr_pool_t *result_pool);
+
+/* Add the counters of histogram SOURCE to TARGET.
+ */
+static void
+merge_histogram(svn_fs_fs__histogram_t *target,
+                const svn_fs_fs__histogram_t *source)
+{
+  apr_size_t i;
+
+  target->total.count += source->total.count;
+  target->total.sum += source->total.sum;
+
+  for (i = 0; i < sizeof(source->lines) / sizeof(source->lines[0]); ++i)
+    {
+      target->lines[i].count += source->lines[i].count;
+      target->lines[i].sum += source->lines[i].sum;
+    }
+}
+
+/* Merge the histogram data gathered in SOURCE by some worker context
+ * into TARGET.
+ */
+static void
+merge_stats(svn_fs_fs__stats_t *target,
+            const svn_fs_fs__stats_t *source)
+{
+  apr_size_t i;
+  apr_hash_index_t *hi;
+  apr_pool_t *hash_pool = apr_hash_pool_get(target->by_extension);
+
+  /* candidates for the "largest changes" list */
+  for (i = 0; i < source->largest_changes->count; ++i)
+    {
+      svn_fs_fs__large_change_info_t *change
+        = source->largest_changes->changes[i];
+
+      if (change->revision != SVN_INVALID_REVNUM)
+        store_largest_change(target, change->size, change->revision,
+                             change->path->data);
+    }
+
+  /* global histograms */
+  merge_histogram(&target->rep_size_histogram,
+                  &source->rep_size_histogram);
+  merge_histogram(&target->node_size_histogram,
+                  &source->node_size_histogram);
+  merge_histogram(&target->added_rep_size_histogram,
+                  &source->added_rep_size_histogram);
+  merge_histogram(&target->added_node_size_histogram,
+                  &source->added_node_size_histogram);
+  merge_histogram(&target->unused_rep_histogram,
+                  &source->unused_rep_histogram);
+  merge_histogram(&target->file_histogram, &source->file_histogram);
+  merge_histogram(&target->file_rep_histogram, &source->file_rep_histogram);
+  merge_histogram(&target->file_prop_histogram,
+                  &source->file_prop_histogram);
+  merge_histogram(&target->file_prop_rep_histogram,
+                  &source->file_prop_rep_histogram);
+  merge_histogram(&target->dir_histogram, &source->dir_histogram);
+  merge_histogram(&target->dir_rep_histogram, &source->dir_rep_histogram);
+  merge_histogram(&target->dir_prop_histogram, &source->dir_prop_histogram);
+  merge_histogram(&target->dir_prop_rep_histogram,
+                  &source->dir_prop_rep_histogram);
+
+  /* histograms by extension */
+  for (hi = apr_hash_first(hash_pool, source->by_extension);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      svn_fs_fs__extension_info_t *source_info = apr_hash_this_val(hi);
+
+      /* get / auto-insert entry for this extension */
+      svn_fs_fs__extension_info_t *target_info
+        = apr_hash_get(target->by_extension, source_info->extension,
+                       APR_HASH_KEY_STRING);
+      if (target_info == NULL)
+        {
+          target_info = apr_pcalloc(hash_pool, sizeof(*target_info));
+          target_info->extension = apr_pstrdup(hash_pool,
+                                               source_info->extension);
+
+          apr_hash_set(target->by_extension, target_info->extension,
+                       APR_HASH_KEY_STRING, target_info);
+        }
+
+      merge_histogram(&target_info->node_histogram,
+                      &source_info->node_histogram);
+      merge_histogram(&target_info->rep_histogram,
+                      &source_info->rep_histogram);
+    }
+}
+
+/* Merge the revision info and rep stats collected by the worker context
+ * WORKER into QUERY.  WORKER's revision range must immediately follow the
+ * revisions already merged into QUERY.  Use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+merge_worker_results(query_t *query,
+                     query_t *worker,
+                     apr_pool_t *scratch_pool)
+{
+  int i;
+  apr_hash_index_t *hi;
+
+  /* The merge must proceed in revision order for the revisions array to
+   * remain addressable by revision number. */
+  SVN_ERR_ASSERT(query->revisions->nelts == worker->first_revision);
+  for (i = 0; i < worker->revisions->nelts; ++i)
+    APR_ARRAY_PUSH(query->revisions, revision_info_t *)
+      = APR_ARRAY_IDX(worker->revisions, i, revision_info_t *);
+
+  /* Now that the base representations are available, determine the delta
+   * chain lengths that the worker had to defer.  The fixups are ordered
+   * such that bases within WORKER's own range get resolved before their
+   * dependents. */
+  for (i = 0; i < worker->chain_fixups->nelts; ++i)
+    {
+      int idx;
+      chain_fixup_t *fixup
+        = &APR_ARRAY_IDX(worker->chain_fixups, i, chain_fixup_t);
+      rep_stats_t *base = find_representation(&idx, query, NULL,
+                                              fixup->base_revision,
+                                              fixup->base_item_index);
+      if (base == NULL)
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("No representation found for item %s "
+                                   "in revision %ld"),
+                                 apr_psprintf(scratch_pool,
+                                              "%" APR_UINT64_T_FMT,
+                                              fixup->base_item_index),
+                                 fixup->base_revision);
+
+      fixup->rep->chain_length = 1 + MIN(base->chain_length,
+                                         (apr_byte_t)0xfe);
+    }
+
+  /* Transfer the reference counts accumulated in the worker's proxies to
+   * the actual representation objects. */
+  for (hi = apr_hash_first(scratch_pool, worker->proxy_reps);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      int idx;
+      rep_stats_t *proxy = apr_hash_this_val(hi);
+      rep_stats_t *rep = find_representation(&idx, query, NULL,
+                                             proxy->revision,
+                                             proxy->item_index);
+      if (rep == NULL)
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("No representation found for item %s "
+                                   "in revision %ld"),
+                                 apr_psprintf(scratch_pool,
+                                              "%" APR_UINT64_T_FMT,
+                                              proxy->item_index),
+                                 proxy->revision);
+
+      rep->ref_count += proxy->ref_count - 1;
+    }
+
+  merge_stats(query->stats, worker->stats);
+
+  return SVN_NO_ERROR;
+}
+
+/* apr_pool_cleanup_t tying the lifetime of the root pool DATA to that of
+ * the pool this got registered with. */
+static apr_status_t
+destroy_root_pool(void *data)
+{
+  svn_pool_destroy(data);
+  return APR_SUCCESS;
+}
+
+/* Baton for read_pack_file_thread(). */
+typedef struct stats_thread_baton_t
+{
+  /* Private worker context covering the pack file that starts at BASE.
+   * Fully initialized by the main thread. */
+  query_t query;
+
+  /* First revision of the pack file to process. */
+  svn_revnum_t base;
+
+  /* Error raised by the thread, if any.  To be picked up after join. */
+  svn_error_t *err;
+
+  /* Private pools of this thread.  Created and cleaned up by the main
+   * thread; used only by the respective worker in between.  The contents
+   * of RESULT_POOL must survive until the final stats aggregation. */
+  apr_pool_t *result_pool;
+  apr_pool_t *scratch_pool;
+} stats_thread_baton_t;
+
+/* apr_thread_start_t scanning the single pack file described by BATON.
+ * The collected data gets merged into the main context - and the progress
+ * notification sent - by the main thread, strictly in revision order. */
+static void * APR_THREAD_FUNC
+read_pack_file_thread(apr_thread_t *thread, void *baton)
+{
+  stats_thread_baton_t *b = baton;
+
+  /* Cancellation is checked by the main thread between pack file batches. */
+  if (svn_fs_fs__use_log_addressing(b->query.fs))
+    b->err = read_log_pack_file(&b->query, b->base, b->result_pool,
+                                b->scratch_pool);
+  else
+    b->err = read_phys_pack_file(&b->query, b->base, b->result_pool,
+                                 b->scratch_pool);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Read all packed revisions of QUERY's repository, scanning up to
+ * CONCURRENCY pack files in parallel worker threads.  Merge the results
+ * into QUERY strictly in revision order, streaming the usual per-shard
+ * progress notifications along the way.
+ *
+ * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
+ * temporaries.
+ */
+static svn_error_t *
+read_packed_revisions_concurrently(query_t *query,
+                                   int concurrency,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_revnum_t revision = 0;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *results_root;
+
+  /* The workers allocate their results from different threads, so they
+   * need an allocator with serialization of its own - the caller's may
+   * be mutexless.  The data must survive until the final aggregation,
+   * hence tie the root pool's lifetime to RESULT_POOL; cf. the root
+   * pools in libsvn_subr/task.c. */
+  results_root = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  apr_pool_cleanup_register(result_pool, results_root, destroy_root_pool,
+                            apr_pool_cleanup_null);
+
+  while (revision < query->min_unpacked_rev)
+    {
+      int i, started;
+      apr_thread_t **threads;
+      stats_thread_baton_t *batons;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+      threads = apr_palloc(iterpool, concurrency * sizeof(*threads));
+      batons = apr_pcalloc(iterpool, concurrency * sizeof(*batons));
+
+      if (query->cancel_func)
+        SVN_ERR(query->cancel_func(query->cancel_baton));
+
+      /* Set up and start the scanner threads for the whole batch. */
+      for (started = 0;
+           started < concurrency && revision < query->min_unpacked_rev;
+           ++started)
+        {
+          apr_status_t status;
+          stats_thread_baton_t *b = &batons[started];
+
+          /* The revision info must remain available until the final stats
+           * aggregation.  Hence, allocate it in a sub-pool of RESULTS_ROOT,
+           * created here such that each worker allocates from its own,
+           * private pool only.  Temporaries go into a root pool with a
+           * thread-safe allocator of the worker's own. */
+          b->base = revision;
+          b->result_pool = svn_pool_create(results_root);
+          b->scratch_pool
+            = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+
+          /* The worker context covers just this one pack file and must
+           * not invoke the progress / cancellation callbacks. */
+          b->query = *query;
+          b->query.first_revision = revision;
+          b->query.revisions
+            = apr_array_make(b->result_pool, query->shard_size,
+                             sizeof(revision_info_t *));
+          b->query.stats = create_stats(b->result_pool);
+          b->query.proxy_reps = apr_hash_make(b->result_pool);
+          b->query.chain_fixups
+            = apr_array_make(b->result_pool, 16, sizeof(chain_fixup_t));
+          b->query.pending_chains = apr_hash_make(b->result_pool);
+          b->query.progress_func = NULL;
+          b->query.cancel_func = NULL;
+
+          status = apr_thread_create(&threads[started], NULL,
+                                     read_pack_file_thread, b, iterpool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create stats scanner "
+                                        "thread"));
+
+          revision += query->shard_size;
+        }
+
+      /* Wait for the whole batch and collect the workers' errors.  The
+       * workers' scratch root pools are not cleaned up with ITERPOOL,
+       * so destroy them here. */
+      for (i = 0; i < started; ++i)
+        {
+          apr_status_t status;
+          apr_thread_join(&status, threads[i]);
+          err = svn_error_compose_create(err, batons[i].err);
+          svn_pool_destroy(batons[i].scratch_pool);
+        }
+      SVN_ERR(err);
+
+      /* Merge the batch results in revision order and stream the progress
+       * output just like the single-threaded scan would. */
+      for (i = 0; i < started; ++i)
+        {
+          SVN_ERR(merge_worker_results(query, &batons[i].query, iterpool));
+
+          if (query->progress_func)
+            query->progress_func(batons[i].base, query->progress_baton,
+                                 iterpool);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Read the repository and collect the stats info in QUERY.
  *
  * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
@@ -1194,7 +1698,19 @@ read_revisions(query_t *query,
                apr_pool_t *scratch_pool)
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  svn_revnum_t revision;
+  svn_revnum_t revision = 0;
+
+#if APR_HAS_THREADS
+  /* Read all packed revs, scanning multiple pack files in parallel if so
+   * configured. */
+  if (query->concurrency > 1 && query->shard_size > 0)
+    {
+      SVN_ERR(read_packed_revisions_concurrently(query, query->concurrency,
+                                                 result_pool, scratch_pool));
+      revision = query->min_unpacked_rev;
+    }
+  else
+#endif
 
   /* read all packed revs */
   for ( revision = 0
@@ -1346,6 +1862,8 @@ create_query(query_t **query,
              apr_pool_t *result_pool,
              apr_pool_t *scratch_pool)
 {
+  fs_fs_data_t *ffd = fs->fsap_data;
+
   *query = apr_pcalloc(result_pool, sizeof(**query));
 
   /* Read repository dimensions. */
@@ -1368,6 +1886,7 @@ create_query(query_t **query,
   /* Store other parameters */
   (*query)->fs = fs;
   (*query)->stats = stats;
+  (*query)->concurrency = ffd->stats_concurrency;
   (*query)->progress_func = progress_func;
   (*query)->progress_baton = progress_baton;
   (*query)->cancel_func = cancel_func;
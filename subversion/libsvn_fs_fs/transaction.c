@@ -33,6 +33,7 @@
 #include "svn_dirent_uri.h"
 
 #include "fs_fs.h"
+#include "batch_fsync.h"
 #include "index.h"
 #include "tree.h"
 #include "util.h"
@@ -1935,8 +1936,11 @@ struct rep_write_baton
      writing to it. */
   void *lockcookie;
 
-  svn_checksum_ctx_t *md5_checksum_ctx;
-  svn_checksum_ctx_t *sha1_checksum_ctx;
+  /* MD5 and SHA-1 digests over the expanded contents.  Using separate
+     asynchronous contexts, both may be computed in parallel lanes off
+     the writing thread for bulk contents. */
+  svn_checksum__async_ctx_t *md5_checksum_ctx;
+  svn_checksum__async_ctx_t *sha1_checksum_ctx;
 
   /* calculate a modified FNV-1a checksum of the on-disk representation */
   svn_checksum_ctx_t *fnv1a_checksum_ctx;
@@ -1958,8 +1962,8 @@ rep_write_contents(void *baton,
 {
   struct rep_write_baton *b = baton;
 
-  SVN_ERR(svn_checksum_update(b->md5_checksum_ctx, data, *len));
-  SVN_ERR(svn_checksum_update(b->sha1_checksum_ctx, data, *len));
+  SVN_ERR(svn_checksum__async_update(b->md5_checksum_ctx, data, *len));
+  SVN_ERR(svn_checksum__async_update(b->sha1_checksum_ctx, data, *len));
   b->rep_size += *len;
 
   /* If we are writing a delta, use that stream. */
@@ -2169,7 +2173,12 @@ txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
   fs_fs_data_t *ffd = fs->fsap_data;
   int svndiff_version;
 
-  if (ffd->delta_compression_type == compression_type_lz4)
+  if (ffd->delta_compression_type == compression_type_zstd)
+    {
+      SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF2_FORMAT);
+      svndiff_version = 3;
+    }
+  else if (ffd->delta_compression_type == compression_type_lz4)
     {
       SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF2_FORMAT);
       svndiff_version = 2;
@@ -2208,8 +2217,10 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
 
   b = apr_pcalloc(pool, sizeof(*b));
 
-  b->sha1_checksum_ctx = svn_checksum_ctx_create(svn_checksum_sha1, pool);
-  b->md5_checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5, pool);
+  b->sha1_checksum_ctx = svn_checksum__async_ctx_create(svn_checksum_sha1,
+                                                        pool);
+  b->md5_checksum_ctx = svn_checksum__async_ctx_create(svn_checksum_md5,
+                                                       pool);
 
   b->fs = fs;
   b->result_pool = pool;
@@ -2489,18 +2500,18 @@ get_shared_rep(representation_t **old_rep,
  */
 static svn_error_t *
 digests_final(representation_t *rep,
-              const svn_checksum_ctx_t *md5_ctx,
-              const svn_checksum_ctx_t *sha1_ctx,
+              svn_checksum__async_ctx_t *md5_ctx,
+              svn_checksum__async_ctx_t *sha1_ctx,
               apr_pool_t *pool)
 {
   svn_checksum_t *checksum;
 
-  SVN_ERR(svn_checksum_final(&checksum, md5_ctx, pool));
+  SVN_ERR(svn_checksum__async_final(&checksum, md5_ctx, pool));
   memcpy(rep->md5_digest, checksum->digest, svn_checksum_size(checksum));
   rep->has_sha1 = sha1_ctx != NULL;
   if (rep->has_sha1)
     {
-      SVN_ERR(svn_checksum_final(&checksum, sha1_ctx, pool));
+      SVN_ERR(svn_checksum__async_final(&checksum, sha1_ctx, pool));
       memcpy(rep->sha1_digest, checksum->digest, svn_checksum_size(checksum));
     }
 
@@ -3749,6 +3760,8 @@ commit_body(void *baton, apr_pool_t *pool)
   apr_uint64_t start_copy_id;
   svn_revnum_t old_rev, new_rev;
   apr_file_t *proto_file;
+  apr_file_t *sync_file;
+  svn_fs_fs__batch_fsync_t *batch;
   void *proto_file_lockcookie;
   apr_off_t initial_offset, changed_path_offset;
   const svn_fs_fs__id_part_t *txn_id = svn_fs_fs__txn_get_id(cb->txn);
@@ -3837,8 +3850,11 @@ commit_body(void *baton, apr_pool_t *pool)
                                      NULL, pool));
     }
 
-  if (ffd->flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(proto_file, pool));
+  /* Collect the files to fsync in this batch and flush them all at once,
+     concurrently, just before updating the 'current' file.  Until then,
+     nobody relies on the new revision's data being on disk. */
+  SVN_ERR(svn_fs_fs__batch_fsync_create(&batch, ffd->flush_to_disk, pool));
+
   SVN_ERR(svn_io_file_close(proto_file, pool));
 
   /* We don't unlock the prototype revision file immediately to avoid a
@@ -3891,8 +3907,14 @@ commit_body(void *baton, apr_pool_t *pool)
   rev_filename = svn_fs_fs__path_rev(cb->fs, new_rev, pool);
   proto_filename = svn_fs_fs__path_txn_proto_rev(cb->fs, txn_id, pool);
   SVN_ERR(svn_fs_fs__move_into_place(proto_filename, rev_filename,
-                                     old_rev_filename, ffd->flush_to_disk,
-                                     pool));
+                                     old_rev_filename, FALSE, pool));
+
+  /* Schedule the rev file contents and its directory entry for fsync.
+     The batch run below provides the durability that the flushing
+     rename would have given us. */
+  SVN_ERR(svn_fs_fs__batch_fsync_open_file(&sync_file, batch, rev_filename,
+                                           pool));
+  SVN_ERR(svn_fs_fs__batch_fsync_new_path(batch, rev_filename, pool));
 
   /* Now that we've moved the prototype revision file out of the way,
      we can unlock it (since further attempts to write to the file
@@ -3904,7 +3926,15 @@ commit_body(void *baton, apr_pool_t *pool)
   SVN_ERR_ASSERT(! svn_fs_fs__is_packed_revprop(cb->fs, new_rev));
   revprop_filename = svn_fs_fs__path_revprops(cb->fs, new_rev, pool);
   SVN_ERR(write_final_revprop(revprop_filename, old_rev_filename,
-                              cb->txn, ffd->flush_to_disk, pool));
+                              cb->txn, FALSE, pool));
+  SVN_ERR(svn_fs_fs__batch_fsync_open_file(&sync_file, batch,
+                                           revprop_filename, pool));
+  SVN_ERR(svn_fs_fs__batch_fsync_new_path(batch, revprop_filename, pool));
+
+  /* Make the rev and revprop files durable before the new 'current'
+     contents may hit the disk.  This issues all outstanding fsyncs
+     concurrently and returns once they have all completed. */
+  SVN_ERR(svn_fs_fs__batch_fsync_run(batch, pool));
 
   /* Run paranoia checks. */
   if (ffd->verify_before_commit)
@@ -3999,9 +4029,17 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
       /* ### A commit that touches thousands of files will starve other
              (reader/writer) commits for the duration of the below call.
              Maybe write in batches? */
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
-      err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
+      if (ffd->rep_cache_db)
+        {
+          SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+          err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
+          err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
+        }
+      else
+        {
+          /* The hash file backend needs no transaction batching. */
+          err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
+        }
 
       if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
         {
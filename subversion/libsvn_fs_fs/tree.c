@@ -100,6 +100,7 @@ typedef struct fs_txn_root_data_t
 static svn_error_t * get_dag(dag_node_t **dag_node_p,
                              svn_fs_root_t *root,
                              const char *path,
+                             svn_boolean_t needs_copy,
                              apr_pool_t *pool);
 
 static svn_fs_root_t *make_revision_root(svn_fs_t *fs, svn_revnum_t rev,
@@ -388,6 +389,22 @@ cache_lookup_last_path(fs_fs_dag_cache_t *cache,
 
 /* 2nd level cache */
 
+/* Return whether the canonical PATH (starting with '/') has at most two
+   components, i.e. is the root or close enough to it that virtually
+   every lookup will pass through its DAG node. */
+static svn_boolean_t
+is_near_root(const char *path)
+{
+  int separators = 0;
+  const char *p;
+
+  for (p = path; *p; ++p)
+    if (*p == '/' && ++separators > 2)
+      return FALSE;
+
+  return TRUE;
+}
+
 /* Find and return the DAG node cache for ROOT and the key that
    should be used for PATH.
 
@@ -412,19 +429,27 @@ locate_cache(svn_cache__t **cache,
     {
       fs_fs_data_t *ffd = root->fs->fsap_data;
 
+      /* Root and near-root nodes live in a separate, pinned cache so
+         that bulk data traffic cannot evict them. */
       if (cache)
-        *cache = ffd->rev_node_cache;
+        *cache = path && is_near_root(path)
+               ? ffd->rev_node_pinned_cache
+               : ffd->rev_node_cache;
       if (key && path)
         *key = svn_fs_fs__combine_number_and_string(root->rev, path, pool);
     }
 }
 
 /* In *NODE_P, return the DAG node for PATH from ROOT's node cache, or NULL
-   if the node isn't cached.  *NODE_P is allocated in POOL. */
+   if the node isn't cached.  If NEEDS_COPY is set, *NODE_P is allocated in
+   POOL.  Otherwise, *NODE_P may be the cache's own copy, which remains
+   valid only until the next access to the node cache for ROOT's filesystem
+   - use that mode only if the node gets evaluated right away. */
 static svn_error_t *
 dag_node_cache_get(dag_node_t **node_p,
                    svn_fs_root_t *root,
                    const char *path,
+                   svn_boolean_t needs_copy,
                    apr_pool_t *pool)
 {
   svn_boolean_t found;
@@ -455,7 +480,7 @@ dag_node_cache_get(dag_node_t **node_p,
               cache_insert(ffd->dag_node_cache, root->rev, path, node);
             }
         }
-      else
+      else if (needs_copy)
         {
           /* Copy the node from L1 cache into the passed-in POOL. */
           node = svn_fs_fs__dag_dup(node, pool);
@@ -806,7 +831,7 @@ get_copy_inheritance(copy_id_inherit_t *inherit_p,
   SVN_ERR(svn_fs_fs__dag_get_copyroot(&copyroot_rev, &copyroot_path,
                                       child->node));
   SVN_ERR(svn_fs_fs__revision_root(&copyroot_root, fs, copyroot_rev, pool));
-  SVN_ERR(get_dag(&copyroot_node, copyroot_root, copyroot_path, pool));
+  SVN_ERR(get_dag(&copyroot_node, copyroot_root, copyroot_path, TRUE, pool));
   copyroot_id = svn_fs_fs__dag_get_id(copyroot_node);
 
   if (svn_fs_fs__id_compare(copyroot_id, child_id) == svn_fs_node_unrelated)
@@ -1028,11 +1053,15 @@ open_path(parent_path_t **parent_path_p,
 
       /* Second attempt: Try starting the lookup immediately at the parent
          node.  We will often have recently accessed either a sibling or
-         said parent DIRECTORY itself for the same revision. */
+         said parent DIRECTORY itself for the same revision.  If even the
+         parent is not cached, walk up towards the root and resume the
+         traversal at the nearest ancestor that we still have in cache -
+         never any higher up than necessary. */
       directory = svn_dirent_dirname(path, pool);
-      if (directory[1] != 0) /* root nodes are covered anyway */
+      while (directory[1] != 0) /* root nodes are covered anyway */
         {
-          SVN_ERR(dag_node_cache_get(&here, root, directory, pool));
+          SVN_ERR(dag_node_cache_get(&here, root, directory, TRUE,
+                                     pool));
 
           /* Did the shortcut work? */
           if (here && svn_fs_fs__dag_node_kind(here) == svn_node_dir)
@@ -1040,13 +1069,14 @@ open_path(parent_path_t **parent_path_p,
               apr_size_t dirname_len = strlen(directory);
               path_so_far->len = dirname_len;
               rest = path + dirname_len + 1;
+              break;
             }
           else if (here)
             {
-              /* The parent node is not a directory.  We are looking for some
-                 sub-path, so that sub-path will not exist.  That will be o.k.
-                 if we are just here to check for the path's existence, but
-                 should result in an error otherwise. */
+              /* The ancestor node is not a directory.  We are looking for
+                 some sub-path, so that sub-path will not exist.  That will
+                 be o.k. if we are just here to check for the path's
+                 existence, but should result in an error otherwise. */
               if (flags & open_path_allow_null)
                 {
                   *parent_path_p = NULL;
@@ -1055,6 +1085,9 @@ open_path(parent_path_t **parent_path_p,
               else
                 return svn_error_trace(err_not_directory(root, directory, pool));
             }
+
+          /* Not cached.  Try the next ancestor. */
+          directory = svn_dirent_dirname(directory, pool);
         }
     }
 
@@ -1113,7 +1146,7 @@ open_path(parent_path_t **parent_path_p,
              complete path. */
           if (next || !(flags & open_path_uncached))
             SVN_ERR(dag_node_cache_get(&cached_node, root, path_so_far->data,
-                                       pool));
+                                       TRUE, pool));
           if (cached_node)
             child = cached_node;
           else
@@ -1264,7 +1297,8 @@ make_path_mutable(svn_fs_root_t *root,
                                           parent_path->node));
       SVN_ERR(svn_fs_fs__revision_root(&copyroot_root, root->fs,
                                        copyroot_rev, pool));
-      SVN_ERR(get_dag(&copyroot_node, copyroot_root, copyroot_path, pool));
+      SVN_ERR(get_dag(&copyroot_node, copyroot_root, copyroot_path, TRUE,
+                      pool));
 
       child_id = svn_fs_fs__dag_get_id(parent_path->node);
       copyroot_id = svn_fs_fs__dag_get_id(copyroot_node);
@@ -1300,12 +1334,15 @@ make_path_mutable(svn_fs_root_t *root,
 
 
 /* Open the node identified by PATH in ROOT.  Set DAG_NODE_P to the
-   node we find, allocated in POOL.  Return the error
-   SVN_ERR_FS_NOT_FOUND if this node doesn't exist. */
+   node we find.  If NEEDS_COPY is set, it will be allocated in POOL;
+   otherwise, it may be shared with the node cache and is only valid
+   until the next node cache access - see dag_node_cache_get().
+   Return the error SVN_ERR_FS_NOT_FOUND if this node doesn't exist. */
 static svn_error_t *
 get_dag(dag_node_t **dag_node_p,
         svn_fs_root_t *root,
         const char *path,
+        svn_boolean_t needs_copy,
         apr_pool_t *pool)
 {
   parent_path_t *parent_path;
@@ -1314,7 +1351,7 @@ get_dag(dag_node_t **dag_node_p,
   /* First we look for the DAG in our cache
      (if the path may be canonical). */
   if (*path == '/')
-    SVN_ERR(dag_node_cache_get(&node, root, path, pool));
+    SVN_ERR(dag_node_cache_get(&node, root, path, needs_copy, pool));
 
   if (! node)
     {
@@ -1327,7 +1364,7 @@ get_dag(dag_node_t **dag_node_p,
       if (*path != '/' || !svn_fs__is_canonical_abspath(path))
         {
           path = svn_fs__canonicalize_abspath(path, pool);
-          SVN_ERR(dag_node_cache_get(&node, root, path, pool));
+          SVN_ERR(dag_node_cache_get(&node, root, path, needs_copy, pool));
         }
 
       if (! node)
@@ -1407,7 +1444,7 @@ svn_fs_fs__node_id(const svn_fs_id_t **id_p,
     {
       dag_node_t *node;
 
-      SVN_ERR(get_dag(&node, root, path, pool));
+      SVN_ERR(get_dag(&node, root, path, FALSE, pool));
       *id_p = svn_fs_fs__id_copy(svn_fs_fs__dag_get_id(node), pool);
     }
   return SVN_NO_ERROR;
@@ -1456,11 +1493,11 @@ fs_node_relation(svn_fs_node_relation_t *relation,
 
   /* We checked for all separations between ID spaces (repos, txn).
    * Now, we can simply test for the ID values themselves. */
-  SVN_ERR(get_dag(&node, root_a, path_a, pool));
+  SVN_ERR(get_dag(&node, root_a, path_a, TRUE, pool));
   id_a = svn_fs_fs__dag_get_id(node);
   node_id_a = *svn_fs_fs__id_node_id(id_a);
 
-  SVN_ERR(get_dag(&node, root_b, path_b, pool));
+  SVN_ERR(get_dag(&node, root_b, path_b, FALSE, pool));
   id_b = svn_fs_fs__dag_get_id(node);
   node_id_b = *svn_fs_fs__id_node_id(id_b);
 
@@ -1498,7 +1535,7 @@ svn_fs_fs__node_created_rev(svn_revnum_t *revision,
 {
   dag_node_t *node;
 
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, FALSE, pool));
   return svn_fs_fs__dag_get_revision(revision, node, pool);
 }
 
@@ -1513,7 +1550,7 @@ fs_node_created_path(const char **created_path,
 {
   dag_node_t *node;
 
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, TRUE, pool));
   *created_path = svn_fs_fs__dag_get_created_path(node);
 
   return SVN_NO_ERROR;
@@ -1531,7 +1568,7 @@ svn_fs_fs__check_path(svn_node_kind_t *kind_p,
   dag_node_t *node;
   svn_error_t *err;
 
-  err = get_dag(&node, root, path, pool);
+  err = get_dag(&node, root, path, FALSE, pool);
   if (err &&
       ((err->apr_err == SVN_ERR_FS_NOT_FOUND)
        || (err->apr_err == SVN_ERR_FS_NOT_DIRECTORY)))
@@ -1560,7 +1597,7 @@ fs_node_prop(svn_string_t **value_p,
   dag_node_t *node;
   apr_hash_t *proplist;
 
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, FALSE, pool));
   SVN_ERR(svn_fs_fs__dag_get_proplist(&proplist, node, pool));
   *value_p = NULL;
   if (proplist)
@@ -1583,7 +1620,7 @@ fs_node_proplist(apr_hash_t **table_p,
   apr_hash_t *table;
   dag_node_t *node;
 
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, FALSE, pool));
   SVN_ERR(svn_fs_fs__dag_get_proplist(&table, node, pool));
   *table_p = table ? table : apr_hash_make(pool);
 
@@ -1598,7 +1635,7 @@ fs_node_has_props(svn_boolean_t *has_props,
 {
   dag_node_t *node;
 
-  SVN_ERR(get_dag(&node, root, path, scratch_pool));
+  SVN_ERR(get_dag(&node, root, path, FALSE, scratch_pool));
 
   return svn_error_trace(svn_fs_fs__dag_has_props(has_props, node,
                                                   scratch_pool));
@@ -1717,8 +1754,8 @@ fs_props_changed(svn_boolean_t *changed_p,
       (SVN_ERR_FS_GENERAL, NULL,
        _("Cannot compare property value between two different filesystems"));
 
-  SVN_ERR(get_dag(&node1, root1, path1, pool));
-  SVN_ERR(get_dag(&node2, root2, path2, pool));
+  SVN_ERR(get_dag(&node1, root1, path1, TRUE, pool));
+  SVN_ERR(get_dag(&node2, root2, path2, TRUE, pool));
   return svn_fs_fs__dag_things_different(changed_p, NULL,
                                          node1, node2, strict, pool);
 }
@@ -1731,7 +1768,7 @@ fs_props_changed(svn_boolean_t *changed_p,
 static svn_error_t *
 get_root(dag_node_t **node, svn_fs_root_t *root, apr_pool_t *pool)
 {
-  return get_dag(node, root, "/", pool);
+  return get_dag(node, root, "/", TRUE, pool);
 }
 
 
@@ -2485,7 +2522,7 @@ fs_dir_entries(apr_hash_t **table_p,
   int i;
 
   /* Get the entries for this path in the caller's pool. */
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, TRUE, pool));
   SVN_ERR(svn_fs_fs__dag_dir_entries(&table, node, pool));
 
   /* Convert directory array to hash. */
@@ -2687,7 +2724,7 @@ copy_helper(svn_fs_root_t *from_root,
        _("Copy immutable tree not supported"));
 
   /* Get the NODE for FROM_PATH in FROM_ROOT.*/
-  SVN_ERR(get_dag(&from_node, from_root, from_path, pool));
+  SVN_ERR(get_dag(&from_node, from_root, from_path, TRUE, pool));
 
   /* Build up the parent path from TO_PATH in TO_ROOT.  If the last
      component does not exist, it's not that big a deal.  We'll just
@@ -2764,7 +2801,7 @@ copy_helper(svn_fs_root_t *from_root,
                                             pool));
 
       /* Make a record of this modification in the changes table. */
-      SVN_ERR(get_dag(&new_node, to_root, to_path, pool));
+      SVN_ERR(get_dag(&new_node, to_root, to_path, TRUE, pool));
       SVN_ERR(add_change(to_root->fs, txn_id, to_path,
                          svn_fs_fs__dag_get_id(new_node), kind, FALSE,
                          FALSE, FALSE, svn_fs_fs__dag_node_kind(from_node),
@@ -2845,7 +2882,7 @@ fs_copied_from(svn_revnum_t *rev_p,
 
   /* There is no cached entry, look it up the old-fashioned
       way. */
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, TRUE, pool));
   SVN_ERR(svn_fs_fs__dag_get_copyfrom_rev(rev_p, node));
   SVN_ERR(svn_fs_fs__dag_get_copyfrom_path(path_p, node));
 
@@ -2916,7 +2953,7 @@ fs_file_length(svn_filesize_t *length_p,
   dag_node_t *file;
 
   /* First create a dag_node_t from the root/path pair. */
-  SVN_ERR(get_dag(&file, root, path, pool));
+  SVN_ERR(get_dag(&file, root, path, TRUE, pool));
 
   /* Now fetch its length */
   return svn_fs_fs__dag_file_length(length_p, file, pool);
@@ -2935,7 +2972,7 @@ fs_file_checksum(svn_checksum_t **checksum,
 {
   dag_node_t *file;
 
-  SVN_ERR(get_dag(&file, root, path, pool));
+  SVN_ERR(get_dag(&file, root, path, TRUE, pool));
   return svn_fs_fs__dag_file_checksum(checksum, file, kind, pool);
 }
 
@@ -2954,7 +2991,7 @@ fs_file_contents(svn_stream_t **contents,
   svn_stream_t *file_stream;
 
   /* First create a dag_node_t from the root/path pair. */
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, TRUE, pool));
 
   /* Then create a readable stream from the dag_node_t. */
   SVN_ERR(svn_fs_fs__dag_get_contents(&file_stream, node, pool));
@@ -2977,7 +3014,7 @@ fs_try_process_file_contents(svn_boolean_t *success,
                              apr_pool_t *pool)
 {
   dag_node_t *node;
-  SVN_ERR(get_dag(&node, root, path, pool));
+  SVN_ERR(get_dag(&node, root, path, TRUE, pool));
 
   return svn_fs_fs__dag_try_process_file_contents(success, node,
                                                   processor, baton, pool);
@@ -3287,13 +3324,13 @@ fs_contents_changed(svn_boolean_t *changed_p,
       (SVN_ERR_FS_GENERAL, NULL,
        _("Cannot compare file contents between two different filesystems"));
 
-  SVN_ERR(get_dag(&node1, root1, path1, pool));
+  SVN_ERR(get_dag(&node1, root1, path1, TRUE, pool));
   /* Make sure that path is file. */
   if (svn_fs_fs__dag_node_kind(node1) != svn_node_file)
     return svn_error_createf
       (SVN_ERR_FS_NOT_FILE, NULL, _("'%s' is not a file"), path1);
 
-  SVN_ERR(get_dag(&node2, root2, path2, pool));
+  SVN_ERR(get_dag(&node2, root2, path2, TRUE, pool));
   /* Make sure that path is file. */
   if (svn_fs_fs__dag_node_kind(node2) != svn_node_file)
     return svn_error_createf
@@ -3318,10 +3355,10 @@ fs_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
   dag_node_t *source_node, *target_node;
 
   if (source_root && source_path)
-    SVN_ERR(get_dag(&source_node, source_root, source_path, pool));
+    SVN_ERR(get_dag(&source_node, source_root, source_path, TRUE, pool));
   else
     source_node = NULL;
-  SVN_ERR(get_dag(&target_node, target_root, target_path, pool));
+  SVN_ERR(get_dag(&target_node, target_root, target_path, TRUE, pool));
 
   /* Create a delta stream that turns the source into the target.  */
   return svn_fs_fs__dag_get_file_delta_stream(stream_p, source_node,
@@ -4017,7 +4054,8 @@ history_prev(svn_fs_history_t **prev_history,
 
       SVN_ERR(svn_fs_fs__revision_root(&copyroot_root, fs, copyroot_rev,
                                        scratch_pool));
-      SVN_ERR(get_dag(&node, copyroot_root, copyroot_path, scratch_pool));
+      SVN_ERR(get_dag(&node, copyroot_root, copyroot_path, TRUE,
+                      scratch_pool));
       copy_dst = svn_fs_fs__dag_get_created_path(node);
 
       /* If our current path was the very destination of the copy,
@@ -4221,7 +4259,7 @@ crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
       svn_pool_clear(iterpool);
 
       kid_path = svn_fspath__join(this_path, dirent->name, iterpool);
-      SVN_ERR(get_dag(&kid_dag, root, kid_path, iterpool));
+      SVN_ERR(get_dag(&kid_dag, root, kid_path, TRUE, iterpool));
 
       SVN_ERR(svn_fs_fs__dag_has_mergeinfo(&has_mergeinfo, kid_dag));
       SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down, kid_dag));
@@ -4465,7 +4503,7 @@ add_descendant_mergeinfo(svn_fs_root_t *root,
   dag_node_t *this_dag;
   svn_boolean_t go_down;
 
-  SVN_ERR(get_dag(&this_dag, root, path, scratch_pool));
+  SVN_ERR(get_dag(&this_dag, root, path, TRUE, scratch_pool));
   SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down,
                                                         this_dag));
   if (go_down)
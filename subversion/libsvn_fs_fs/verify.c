@@ -20,6 +20,8 @@
  * ====================================================================
  */
 
+#include <apr_thread_proc.h>
+
 #include "svn_sorts.h"
 #include "svn_checksum.h"
 #include "svn_time.h"
@@ -795,6 +797,201 @@ pack_size(svn_fs_t *fs, svn_revnum_t rev)
   return rev < ffd->min_unpacked_rev ? ffd->max_files_per_dir : 1;
 }
 
+/* Run the metadata checks for the single rev / pack file containing the
+ * COUNT revisions starting at PACK_START in FS, i.e. the index checksums,
+ * the two-way index comparison and the index cross-check against the
+ * actual file contents.  Revprop verification is not covered here.
+ * If given, invoke CANCEL_FUNC with CANCEL_BATON at regular intervals.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+verify_metadata_shard(svn_fs_t *fs,
+                      svn_revnum_t pack_start,
+                      svn_revnum_t count,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool)
+{
+  /* Check for external corruption to the indexes. */
+  SVN_ERR(verify_index_checksums(fs, pack_start, cancel_func, cancel_baton,
+                                 scratch_pool));
+
+  /* two-way index check */
+  SVN_ERR(compare_l2p_to_p2l_index(fs, pack_start, count, cancel_func,
+                                   cancel_baton, scratch_pool));
+  SVN_ERR(compare_p2l_to_l2p_index(fs, pack_start, count, cancel_func,
+                                   cancel_baton, scratch_pool));
+
+  /* verify in-index checksums and types vs. actual rev / pack files */
+  SVN_ERR(compare_p2l_to_rev(fs, pack_start, count, cancel_func,
+                             cancel_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Baton for verify_shard_thread(). */
+typedef struct verify_thread_baton_t
+{
+  /* The filesystem to verify.  Only the thread-safe caches and the
+   * immutable parts of this object may be accessed from the thread. */
+  svn_fs_t *fs;
+
+  /* First revision in the rev / pack file to check and the number of
+   * revisions in that file. */
+  svn_revnum_t pack_start;
+  svn_revnum_t count;
+
+  /* Error raised by the thread, if any.  To be picked up after join. */
+  svn_error_t *err;
+
+  /* Private pool of this thread.  Created and destroyed by the main
+   * thread; used only by the respective worker in between. */
+  apr_pool_t *pool;
+} verify_thread_baton_t;
+
+/* apr_thread_start_t running verify_metadata_shard() for a single
+ * rev / pack file as described by BATON.  Revprop verification remains
+ * with the main thread because it operates on FS-global revprop cache
+ * state. */
+static void * APR_THREAD_FUNC
+verify_shard_thread(apr_thread_t *thread, void *baton)
+{
+  verify_thread_baton_t *b = baton;
+
+  /* Cancellation is checked by the main thread between shard batches. */
+  b->err = verify_metadata_shard(b->fs, b->pack_start, b->count,
+                                 NULL, NULL, b->pool);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Run the metadata consistency checks for revisions START to END in FS,
+ * checking up to CONCURRENCY rev / pack files in parallel worker threads.
+ * Errors found by the workers of a batch are merged into a single report
+ * instead of stopping at the first defective shard.  The remaining
+ * parameters are as in verify_f7_metadata_consistency(). */
+static svn_error_t *
+verify_shards_concurrently(svn_fs_t *fs,
+                           svn_revnum_t start,
+                           svn_revnum_t end,
+                           int concurrency,
+                           svn_fs_progress_notify_func_t notify_func,
+                           void *notify_baton,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_revnum_t revision = start;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  while (revision <= end)
+    {
+      int i;
+      int batch;
+      apr_thread_t **threads;
+      verify_thread_baton_t *batons;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+      threads = apr_palloc(iterpool, concurrency * sizeof(*threads));
+      batons = apr_pcalloc(iterpool, concurrency * sizeof(*batons));
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      /* Set up and start the metadata checks for up to CONCURRENCY
+       * rev / pack files. */
+      for (batch = 0; batch < concurrency && revision <= end; ++batch)
+        {
+          apr_status_t status;
+          verify_thread_baton_t *b = &batons[batch];
+
+          b->fs = fs;
+          b->count = pack_size(fs, revision);
+          b->pack_start = svn_fs_fs__packed_base_rev(fs, revision);
+
+          /* Root pool with a thread-safe allocator of its own.  A sub-pool
+           * of ITERPOOL would share the caller's allocator, which need not
+           * be thread-safe (e.g. svnadmin's for a single job). */
+          b->pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+
+          revision = b->pack_start + b->count;
+
+          status = apr_thread_create(&threads[batch], NULL,
+                                     verify_shard_thread, b, iterpool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create verification thread"));
+        }
+
+      /* Wait for the whole batch to complete. */
+      for (i = 0; i < batch; ++i)
+        {
+          apr_status_t status;
+          apr_thread_join(&status, threads[i]);
+        }
+
+      /* concurrent packing is one of the reasons why verification may
+         fail.  Make sure, we operate on up-to-date information. */
+      for (i = 0; i < batch; ++i)
+        if (batons[i].err)
+          {
+            SVN_ERR(svn_fs_fs__read_min_unpacked_rev(&ffd->min_unpacked_rev,
+                                                     fs, iterpool));
+            break;
+          }
+
+      /* Post-process the batch strictly in shard order: re-check shards
+         that got packed in the meantime, merge the errors of all others
+         and verify the revprops from the main thread. */
+      for (i = 0; i < batch; ++i)
+        {
+          verify_thread_baton_t *b = &batons[i];
+
+          if (b->err && b->count != pack_size(fs, b->pack_start))
+            {
+              /* The shard got packed while we looked at it.  Retry it
+                 with the updated rev / pack file boundaries. */
+              svn_error_clear(b->err);
+
+              b->count = pack_size(fs, b->pack_start);
+              b->pack_start = svn_fs_fs__packed_base_rev(fs, b->pack_start);
+              b->err = verify_metadata_shard(fs, b->pack_start, b->count,
+                                             cancel_func, cancel_baton,
+                                             iterpool);
+            }
+
+          err = svn_error_compose_create(err, b->err);
+          b->err = SVN_NO_ERROR;
+
+          if (!err)
+            {
+              if (notify_func && (b->pack_start % ffd->max_files_per_dir == 0))
+                notify_func(b->pack_start, notify_baton, iterpool);
+
+              /* ensure that revprops are available and accessible */
+              err = verify_revprops(fs, b->pack_start,
+                                    b->pack_start + b->count,
+                                    cancel_func, cancel_baton, iterpool);
+            }
+
+          svn_pool_destroy(b->pool);
+        }
+
+      SVN_ERR(err);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Verify that on-disk representation has not been tempered with (in a way
  * that leaves the repository in a corrupted state).  This compares log-to-
  * phys with phys-to-log indexes, verifies the low-level checksums and
@@ -816,8 +1013,19 @@ verify_f7_metadata_consistency(svn_fs_t *fs,
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   svn_revnum_t revision, next_revision;
-  apr_pool_t *iterpool = svn_pool_create(pool);
-
+  apr_pool_t *iterpool;
+
+#if APR_HAS_THREADS
+  /* With concurrency configured, check multiple rev / pack files in
+   * parallel worker threads. */
+  if (ffd->verify_concurrency > 1)
+    return svn_error_trace(verify_shards_concurrently(
+                               fs, start, end, ffd->verify_concurrency,
+                               notify_func, notify_baton,
+                               cancel_func, cancel_baton, pool));
+#endif
+
+  iterpool = svn_pool_create(pool);
   for (revision = start; revision <= end; revision = next_revision)
     {
       svn_error_t *err = SVN_NO_ERROR;
@@ -831,22 +1039,10 @@ verify_f7_metadata_consistency(svn_fs_t *fs,
       if (notify_func && (pack_start % ffd->max_files_per_dir == 0))
         notify_func(pack_start, notify_baton, iterpool);
 
-      /* Check for external corruption to the indexes. */
-      err = verify_index_checksums(fs, pack_start, cancel_func,
-                                   cancel_baton, iterpool);
-
-      /* two-way index check */
-      if (!err)
-        err = compare_l2p_to_p2l_index(fs, pack_start, pack_end - pack_start,
-                                       cancel_func, cancel_baton, iterpool);
-      if (!err)
-        err = compare_p2l_to_l2p_index(fs, pack_start, pack_end - pack_start,
-                                       cancel_func, cancel_baton, iterpool);
-
-      /* verify in-index checksums and types vs. actual rev / pack files */
-      if (!err)
-        err = compare_p2l_to_rev(fs, pack_start, pack_end - pack_start,
-                                 cancel_func, cancel_baton, iterpool);
+      /* Check the indexes against each other and against the actual
+         rev / pack file contents. */
+      err = verify_metadata_shard(fs, pack_start, pack_end - pack_start,
+                                  cancel_func, cancel_baton, iterpool);
 
       /* ensure that revprops are available and accessible */
       if (!err)
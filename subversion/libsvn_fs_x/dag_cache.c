@@ -232,18 +232,22 @@ typedef struct cache_entry_t
   dag_node_t *node;
 } cache_entry_t;
 
-/* Number of entries in the cache.  Keep this low to keep pressure on the
-   CPU caches low as well.  A binary value is most efficient.  If we walk
-   a directory tree, we want enough entries to store nodes for all files
-   without overwriting the nodes for the parent folder.  That way, there
-   will be no unnecessary misses (except for a few random ones caused by
-   hash collision).
+/* Initial number of entries in the cache.  Keep this low to keep pressure
+   on the CPU caches low as well.  A binary value is most efficient.  If we
+   walk a directory tree, we want enough entries to store nodes for all
+   files without overwriting the nodes for the parent folder.  That way,
+   there will be no unnecessary misses (except for a few random ones caused
+   by hash collision).
 
    The actual number of instances may be higher but entries that got
    overwritten are no longer visible.
  */
 enum { BUCKET_COUNT = 256 };
 
+/* If the working set does not fit the table, the cache will grow by
+   doubling its bucket count - but never beyond this limit. */
+enum { MAX_BUCKET_COUNT = 0x10000 };
+
 /* The actual cache structure.  All nodes will be allocated in POOL.
    When the number of INSERTIONS (i.e. objects created form that pool)
    exceeds a certain threshold, the pool will be cleared and the cache
@@ -251,8 +255,14 @@ enum { BUCKET_COUNT = 256 };
  */
 struct svn_fs_x__dag_cache_t
 {
-  /* fixed number of (possibly empty) cache entries */
-  cache_entry_t buckets[BUCKET_COUNT];
+  /* BUCKET_COUNT (possibly empty) cache entries.  The count is always
+     a power of two and may grow over the lifetime of this cache - see
+     auto_clear_dag_cache(). */
+  cache_entry_t *buckets;
+  apr_size_t bucket_count;
+
+  /* pool that this cache and the bucket arrays are allocated in */
+  apr_pool_t *owner_pool;
 
   /* pool used for all node allocation */
   apr_pool_t *pool;
@@ -270,17 +280,47 @@ struct svn_fs_x__dag_cache_t
      This value is a mere hint for optimistic lookup and any value is
      valid (as long as it is < BUCKET_COUNT). */
   apr_size_t last_non_empty;
+
+  /* total number of lookups that returned a suitable DAG node */
+  apr_uint64_t hits;
+
+  /* total number of lookups that did not */
+  apr_uint64_t misses;
+
+  /* number of times the cache contents got evicted in bulk */
+  apr_uint64_t clears;
+
+  /* lookup hits since the last clear; used to decide upon growth */
+  apr_uint64_t hits_since_clear;
 };
 
 svn_fs_x__dag_cache_t*
 svn_fs_x__create_dag_cache(apr_pool_t *result_pool)
 {
   svn_fs_x__dag_cache_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  result->owner_pool = result_pool;
   result->pool = svn_pool_create(result_pool);
+  result->bucket_count = BUCKET_COUNT;
+  result->buckets = apr_pcalloc(result_pool,
+                                result->bucket_count
+                                  * sizeof(*result->buckets));
 
   return result;
 }
 
+void
+svn_fs_x__dag_cache_get_stats(svn_fs_x__dag_cache_stats_t *stats,
+                              svn_fs_t *fs)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  svn_fs_x__dag_cache_t *cache = ffd->dag_node_cache;
+
+  stats->hits = cache->hits;
+  stats->misses = cache->misses;
+  stats->clears = cache->clears;
+  stats->bucket_count = cache->bucket_count;
+}
+
 /* Clears the CACHE at regular intervals (destroying all cached nodes).
  * Return TRUE if the cache got cleared and previously obtained references
  * to cache contents have become invalid.
@@ -288,13 +328,33 @@ svn_fs_x__create_dag_cache(apr_pool_t *result_pool)
 static svn_boolean_t
 auto_clear_dag_cache(svn_fs_x__dag_cache_t* cache)
 {
-  if (cache->insertions <= BUCKET_COUNT)
+  if (cache->insertions <= cache->bucket_count)
     return FALSE;
 
   svn_pool_clear(cache->pool);
 
-  memset(cache->buckets, 0, sizeof(cache->buckets));
+  /* If entries got replaced more often than they got re-used, the working
+     set does not fit the table.  Double the bucket count (within limits)
+     such that e.g. large checkouts stop thrashing the cache.  The total
+     memory spent on discarded bucket arrays is bounded by the size of the
+     final one. */
+  if (   cache->hits_since_clear < cache->insertions
+      && cache->bucket_count < MAX_BUCKET_COUNT)
+    {
+      cache->bucket_count *= 2;
+      cache->buckets = apr_pcalloc(cache->owner_pool,
+                                   cache->bucket_count
+                                     * sizeof(*cache->buckets));
+    }
+  else
+    {
+      memset(cache->buckets, 0,
+             cache->bucket_count * sizeof(*cache->buckets));
+    }
+
   cache->insertions = 0;
+  cache->hits_since_clear = 0;
+  cache->clears++;
 
   return TRUE;
 }
@@ -325,7 +385,15 @@ cache_lookup(svn_fs_x__dag_cache_t *cache,
     {
       /* Remember the position of the last node we found in this cache. */
       if (result->node)
-        cache->last_non_empty = cache->last_hit;
+        {
+          cache->last_non_empty = cache->last_hit;
+          cache->hits++;
+          cache->hits_since_clear++;
+        }
+      else
+        {
+          cache->misses++;
+        }
 
       return result;
     }
@@ -353,7 +421,8 @@ cache_lookup(svn_fs_x__dag_cache_t *cache,
     hash_value = hash_value * 32 + (hash_value + (apr_byte_t)path->data[i]);
 
   bucket_index = hash_value + (hash_value >> 16);
-  bucket_index = (bucket_index + (bucket_index >> 8)) % BUCKET_COUNT;
+  bucket_index = (bucket_index + (bucket_index >> 8))
+               & (cache->bucket_count - 1); /* count is a power of two */
 
   /* access the corresponding bucket and remember its location */
   result = &cache->buckets[bucket_index];
@@ -379,12 +448,19 @@ cache_lookup(svn_fs_x__dag_cache_t *cache,
       result->node = NULL;
 
       cache->insertions++;
+      cache->misses++;
     }
   else if (result->node)
     {
       /* This bucket is valid & has a suitable DAG node in it.
          Remember its location. */
       cache->last_non_empty = bucket_index;
+      cache->hits++;
+      cache->hits_since_clear++;
+    }
+  else
+    {
+      cache->misses++;
     }
 
   return result;
@@ -449,7 +525,7 @@ svn_fs_x__invalidate_dag_cache(svn_fs_root_t *root,
   svn_fs_x__change_set_t change_set = svn_fs_x__root_change_set(root);
 
   apr_size_t i;
-  for (i = 0; i < BUCKET_COUNT; ++i)
+  for (i = 0; i < cache->bucket_count; ++i)
     {
       cache_entry_t *bucket = &cache->buckets[i];
       if (bucket->change_set == change_set && bucket->node)
@@ -33,6 +33,27 @@ extern "C" {
 svn_fs_x__dag_cache_t*
 svn_fs_x__create_dag_cache(apr_pool_t *result_pool);
 
+/* Performance counters of a DAG node cache. */
+typedef struct svn_fs_x__dag_cache_stats_t
+{
+  /* number of lookups that returned a suitable DAG node */
+  apr_uint64_t hits;
+
+  /* number of lookups that did not */
+  apr_uint64_t misses;
+
+  /* number of times the cache contents got evicted in bulk */
+  apr_uint64_t clears;
+
+  /* current number of buckets; grows on demand */
+  apr_size_t bucket_count;
+} svn_fs_x__dag_cache_stats_t;
+
+/* Fill *STATS with the current counters of FS's DAG node cache. */
+void
+svn_fs_x__dag_cache_get_stats(svn_fs_x__dag_cache_stats_t *stats,
+                              svn_fs_t *fs);
+
 /* Invalidate cache entries for PATH within ROOT and any of its children. */
 void
 svn_fs_x__invalidate_dag_cache(svn_fs_root_t *root,
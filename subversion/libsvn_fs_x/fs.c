@@ -293,6 +293,7 @@ static fs_vtable_t fs_vtable = {
   svn_fs_x__revision_prop,
   x_revision_proplist,
   svn_fs_x__change_rev_prop,
+  svn_fs_x__change_rev_props,
   x_set_uuid,
   svn_fs_x__revision_root,
   x_begin_txn,
@@ -111,6 +111,8 @@ extern "C" {
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
+#define CONFIG_SECTION_PACK              "pack"
+#define CONFIG_OPTION_MAX_CONTAINER_ITEM_SIZE "max-container-item-size"
 #define CONFIG_SECTION_DEBUG             "debug"
 #define CONFIG_OPTION_PACK_AFTER_COMMIT  "pack-after-commit"
 
@@ -274,6 +276,10 @@ typedef struct svn_fs_x__data_t
   /* Rev / pack file granularity covered by phys-to-log index pages */
   apr_int64_t p2l_page_size;
 
+  /* During pack, only representations with an expanded size up to this
+   * many bytes are eligible for pooling into a reps container. */
+  apr_int64_t max_container_item_size;
+
   /* The revision that was youngest, last time we checked. */
   svn_revnum_t youngest_rev_cache;
 
@@ -332,6 +332,16 @@ read_config(svn_fs_x__data_t *ffd,
   ffd->p2l_page_size *= 0x400;
   /* L2P pages are in entries - not in (k)Bytes */
 
+  /* Packing settings in ffd. */
+  SVN_ERR(svn_config_get_int64(config, &ffd->max_container_item_size,
+                               CONFIG_SECTION_PACK,
+                               CONFIG_OPTION_MAX_CONTAINER_ITEM_SIZE,
+                               0));
+  if (ffd->max_container_item_size <= 0)
+    ffd->max_container_item_size = 2 * ffd->block_size;
+  else
+    ffd->max_container_item_size *= 0x400;
+
   /* Debug options. */
   SVN_ERR(svn_config_get_bool(config, &ffd->pack_after_commit,
                               CONFIG_SECTION_DEBUG,
@@ -528,6 +538,20 @@ write_config(svn_fs_t *fs,
 "### Must be a power of 2."                                                  NL
 "### p2l-page-size is given in kBytes and with a default of 1024 kBytes."    NL
 "# " CONFIG_OPTION_P2L_PAGE_SIZE " = 1024"                                   NL
+""                                                                           NL
+"[" CONFIG_SECTION_PACK "]"                                                  NL
+"### During packing, many small node revisions and representations get"      NL
+"### pooled into shared, compressed containers sized to fill one data"       NL
+"### block (see block-size above)."                                          NL
+"### This parameter limits the representations that are eligible for"        NL
+"### pooling:  anything whose expanded content exceeds the threshold is"     NL
+"### stored individually.  Larger values improve the compression of"         NL
+"### medium-sized files at the expense of read latency, because accessing"   NL
+"### any item of a container requires parsing the whole container."          NL
+"### The limit only takes effect at the next 'svnadmin pack'."               NL
+"### max-container-item-size is given in kBytes.  By default, it is twice"   NL
+"### the block-size."                                                        NL
+"# " CONFIG_OPTION_MAX_CONTAINER_ITEM_SIZE " = 128"                          NL
 ;
 #undef NL
   return svn_io_file_create(svn_dirent_join(fs->path, PATH_CONFIG,
@@ -1248,6 +1272,72 @@ svn_fs_x__change_rev_prop(svn_fs_t *fs,
                                    scratch_pool);
 }
 
+/* Baton used for change_rev_props_body below. */
+typedef struct change_rev_props_baton_t {
+  svn_fs_t *fs;
+  svn_revnum_t rev;
+  const apr_array_header_t *props;
+} change_rev_props_baton_t;
+
+/* The work-horse for svn_fs_x__change_rev_props, called with the FS
+   write lock.  This implements the svn_fs_x__with_write_lock()
+   'body' callback type.  BATON is a 'change_rev_props_baton_t *'. */
+static svn_error_t *
+change_rev_props_body(void *baton,
+                      apr_pool_t *scratch_pool)
+{
+  change_rev_props_baton_t *cb = baton;
+  apr_hash_t *table;
+  svn_boolean_t changed = FALSE;
+  int i;
+
+  /* Read current revprop values from disk (never from cache).
+     Even if somehow the cache got out of sync, we want to make sure that
+     we read, update and write up-to-date data. */
+  SVN_ERR(svn_fs_x__get_revision_proplist(&table, cb->fs, cb->rev, TRUE,
+                                          TRUE, scratch_pool, scratch_pool));
+
+  for (i = 0; i < cb->props->nelts; i++)
+    {
+      const svn_prop_t *prop = &APR_ARRAY_IDX(cb->props, i, svn_prop_t);
+      const svn_string_t *present_value = svn_hash_gets(table, prop->name);
+
+      /* Skip no-op changes. */
+      if ((!present_value && !prop->value)
+          || (present_value && prop->value
+              && svn_string_compare(present_value, prop->value)))
+        continue;
+
+      svn_hash_sets(table, prop->name, prop->value);
+      changed = TRUE;
+    }
+
+  /* Write the revision's property list just once for all changes. */
+  if (!changed)
+    return SVN_NO_ERROR;
+
+  return svn_fs_x__set_revision_proplist(cb->fs, cb->rev, table,
+                                         scratch_pool);
+}
+
+svn_error_t *
+svn_fs_x__change_rev_props(svn_fs_t *fs,
+                           svn_revnum_t rev,
+                           const apr_array_header_t *props,
+                           apr_pool_t *scratch_pool)
+{
+  change_rev_props_baton_t cb;
+
+  SVN_ERR(svn_fs__check_fs(fs, TRUE));
+
+  cb.fs = fs;
+  cb.rev = rev;
+  cb.props = props;
+
+  return svn_fs_x__with_write_lock(fs, change_rev_props_body, &cb,
+                                   scratch_pool);
+}
+
 
 svn_error_t *
 svn_fs_x__info_format(int *fs_format,
@@ -201,6 +201,16 @@ svn_fs_x__change_rev_prop(svn_fs_t *fs,
                           const svn_string_t *value,
                           apr_pool_t *scratch_pool);
 
+/* Apply all property changes in PROPS, an array of svn_prop_t, to
+   revision REV in filesystem FS, rewriting the revision's property
+   list only once.  A NULL value deletes the respective property.
+   Do any temporary allocation in SCRATCH_POOL.  */
+svn_error_t *
+svn_fs_x__change_rev_props(svn_fs_t *fs,
+                           svn_revnum_t rev,
+                           const apr_array_header_t *props,
+                           apr_pool_t *scratch_pool);
+
 /* If directory PATH does not exist, create it and give it the same
    permissions as FS_PATH.  Do any temporary allocation in SCRATCH_POOL. */
 svn_error_t *
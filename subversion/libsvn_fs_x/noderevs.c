@@ -24,6 +24,7 @@
 
 #include "private/svn_dep_compat.h"
 #include "private/svn_packed_data.h"
+#include "private/svn_perf_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_temp_serializer.h"
 
@@ -365,6 +366,11 @@ svn_fs_x__noderevs_get(svn_fs_x__noderev_t **noderev_p,
 {
   svn_fs_x__noderev_t *noderev;
   binary_noderev_t *binary_noderev;
+  static svn_perf__counter_t *perf_counter = NULL;
+
+  /* Relating this counter to the container read counter shows how many
+   * noderevs get extracted per container parsed. */
+  svn_perf__count(&perf_counter, "fsx.noderevs-container-get");
 
   /* CONTAINER must be in 'finalized' mode */
   SVN_ERR_ASSERT(container->builder == NULL);
@@ -504,6 +510,11 @@ svn_fs_x__write_noderevs_container(svn_stream_t *stream,
 {
   int i;
 
+  /* Tracks how many containers we write and how well we fill them:
+   * the "units" per event is the number of noderevs in the container. */
+  static svn_perf__counter_t *perf_counter = NULL;
+  apr_time_t perf_start = svn_perf__start();
+
   string_table_t *paths = container->paths
                         ? container->paths
                         : svn_fs_x__string_table_create(container->builder,
@@ -575,6 +586,9 @@ svn_fs_x__write_noderevs_container(svn_stream_t *stream,
   SVN_ERR(svn_fs_x__write_string_table(stream, paths, scratch_pool));
   SVN_ERR(svn_packed__data_write(stream, root, scratch_pool));
 
+  svn_perf__stop2(&perf_counter, "fsx.noderevs-container-write", perf_start,
+                  container->noderevs->nelts);
+
   return SVN_NO_ERROR;
 }
 
@@ -652,6 +666,11 @@ svn_fs_x__read_noderevs_container(svn_fs_x__noderevs_t **container,
   apr_size_t i;
   apr_size_t count;
 
+  /* Tracks how many containers we parse and how many noderevs each of
+   * them carried ("units" per event). */
+  static svn_perf__counter_t *perf_counter = NULL;
+  apr_time_t perf_start = svn_perf__start();
+
   svn_fs_x__noderevs_t *noderevs
     = apr_pcalloc(result_pool, sizeof(*noderevs));
 
@@ -724,6 +743,9 @@ svn_fs_x__read_noderevs_container(svn_fs_x__noderevs_t **container,
       APR_ARRAY_PUSH(noderevs->noderevs, binary_noderev_t) = noderev;
     }
 
+  svn_perf__stop2(&perf_counter, "fsx.noderevs-container-read", perf_start,
+                  noderevs->noderevs->nelts);
+
   *container = noderevs;
 
   return SVN_NO_ERROR;
@@ -817,12 +839,16 @@ svn_fs_x__noderevs_get_func(void **out,
 
   apr_uint32_t idx = *(apr_uint32_t *)baton;
   const svn_fs_x__noderevs_t *container = data;
+  static svn_perf__counter_t *perf_counter = NULL;
 
   /* Resolve all container pointers */
   const string_table_t *paths
     = svn_temp_deserializer__ptr(container,
                          (const void *const *)&container->paths);
 
+  /* Extractions served straight from the cached container. */
+  svn_perf__count(&perf_counter, "fsx.noderevs-container-get-cached");
+
   resolve_apr_array_header(&ids, container, &container->ids);
   resolve_apr_array_header(&reps, container, &container->reps);
   resolve_apr_array_header(&noderevs, container, &container->noderevs);
@@ -1436,7 +1436,7 @@ copy_reps_from_temp(pack_context_t *context,
 
       /* if all reps are short enough put them into one container.
        * Otherwise, just store all containers here. */
-      if (reps_fit_into_containers(selected, 2 * ffd->block_size))
+      if (reps_fit_into_containers(selected, ffd->max_container_item_size))
         SVN_ERR(write_reps_containers(context, rep_parts, temp_file,
                                       context->reps, iterpool));
       else
@@ -170,6 +170,29 @@ match_length(const svn_string_t *lhs,
   return (apr_uint16_t)svn_cstring__match_length(lhs->data, rhs->data, len);
 }
 
+/* Return -1 / 0 / +1 for LHS being smaller than / equal to / larger than
+ * RHS and set *MATCH_LEN to the length of their common prefix.  Noderev
+ * paths tend to share long prefixes, so the chunky scan beats a plain
+ * strcmp() here - and the prefix length falls out of the comparison for
+ * free.
+ */
+static int
+compare_strings(const svn_string_t *lhs,
+                const svn_string_t *rhs,
+                apr_uint16_t *match_len)
+{
+  apr_size_t max = MIN(lhs->len, rhs->len);
+  apr_size_t match = svn_cstring__match_length(lhs->data, rhs->data, max);
+
+  *match_len = (apr_uint16_t)match;
+  if (match < max)
+    return (unsigned char)lhs->data[match] < (unsigned char)rhs->data[match]
+         ? -1
+         : 1;
+
+  return lhs->len == rhs->len ? 0 : (lhs->len < rhs->len ? -1 : 1);
+}
+
 static apr_uint16_t
 insert_string(builder_table_t *table,
               builder_string_t **parent,
@@ -177,7 +200,9 @@ insert_string(builder_table_t *table,
 {
   apr_uint16_t result;
   builder_string_t *current = *parent;
-  int diff = strcmp(current->string.data, to_insert->string.data);
+  apr_uint16_t current_match;
+  int diff = compare_strings(&current->string, &to_insert->string,
+                             &current_match);
   if (diff == 0)
     {
       apr_array_pop(table->short_strings);
@@ -208,9 +233,8 @@ insert_string(builder_table_t *table,
             }
 
           current->previous = to_insert;
-          to_insert->next_match_len
-            = match_length(&current->string, &to_insert->string);
-          current->previous_match_len = to_insert->next_match_len;
+          to_insert->next_match_len = current_match;
+          current->previous_match_len = current_match;
 
           table->max_data_size -= to_insert->string.len;
           if (to_insert->previous == NULL)
@@ -248,9 +272,8 @@ insert_string(builder_table_t *table,
             }
 
           current->next = current->right;
-          to_insert->previous_match_len
-            = match_length(&current->string, &to_insert->string);
-          current->next_match_len = to_insert->previous_match_len;
+          to_insert->previous_match_len = current_match;
+          current->next_match_len = current_match;
 
           table->max_data_size -= to_insert->string.len;
           if (to_insert->next == NULL)
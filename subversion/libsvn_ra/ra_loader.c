@@ -52,6 +52,7 @@
 #include "ra_loader.h"
 #include "deprecated.h"
 
+#include "private/svn_atomic.h"
 #include "private/svn_auth_private.h"
 #include "private/svn_ra_private.h"
 #include "svn_private_config.h"
@@ -68,7 +69,7 @@ static const char * const dav_schemes[] = { "http", "https", NULL };
 static const char * const svn_schemes[] = { "svn", NULL };
 static const char * const local_schemes[] = { "file", NULL };
 
-static const struct ra_lib_defn {
+static struct ra_lib_defn {
   /* the name of this RA library (e.g. "neon" or "local") */
   const char *ra_name;
 
@@ -76,6 +77,12 @@ static const struct ra_lib_defn {
   /* the initialization function if linked in; otherwise, NULL */
   svn_ra__init_func_t initfunc;
   svn_ra_init_func_t compat_initfunc;
+
+  /* the vtable of this library, once resolved; otherwise, NULL.
+   * RA vtables are static data within their libraries and the DSOs
+   * stay loaded for the lifetime of the process, so the first resolved
+   * value remains valid and is memoized here. */
+  void * volatile vtable; /* svn_ra__vtable_t */
 } ra_libraries[] = {
   {
     "svn",
@@ -226,6 +233,49 @@ check_ra_version(const svn_version_t *ra_version, const char *scheme)
   return SVN_NO_ERROR;
 }
 
+/* Resolve the vtable of the RA library DEFN in *VTABLE, or set *VTABLE
+ * to NULL if the library is not available.  The result of the first
+ * successful resolution is memoized process-wide, so only the very
+ * first session to a scheme pays for the DSO probing, initialization
+ * and version check.  NAME is used in error messages only.
+ * Perform temporary allocations in SCRATCH_POOL. */
+static svn_error_t *
+get_ra_library_vtable(const svn_ra__vtable_t **vtable,
+                      struct ra_lib_defn *defn,
+                      const char *name,
+                      apr_pool_t *scratch_pool)
+{
+  svn_ra__init_func_t initfunc;
+  const svn_ra__vtable_t *result;
+
+  /* Most times, we get lucky and the library has been resolved before. */
+  *vtable = svn_atomic_casptr(&defn->vtable, NULL, NULL);
+  if (*vtable)
+    return SVN_NO_ERROR;
+
+  /* O.k., the first access needs to actually load the module, find the
+     vtable and check for version compatibility. */
+  initfunc = defn->initfunc;
+  if (! initfunc)
+    SVN_ERR(load_ra_module(&initfunc, NULL, defn->ra_name, scratch_pool));
+
+  if (! initfunc)
+    {
+      /* Library not found. */
+      *vtable = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(initfunc(svn_ra_version(), &result, scratch_pool));
+  SVN_ERR(check_ra_version(result->get_version(), name));
+
+  /* The vtable will not change.  Remember it. */
+  svn_atomic_casptr(&defn->vtable, (void *)result, NULL);
+  *vtable = result;
+
+  return SVN_NO_ERROR;
+}
+
 /* -------------------------------------------------------------- */
 
 /*** Public Interfaces ***/
@@ -269,7 +319,7 @@ svn_error_t *svn_ra_open5(svn_ra_session_t **session_p,
   apr_pool_t *sesspool = svn_pool_create(pool);
   apr_pool_t *scratch_pool = svn_pool_create(sesspool);
   svn_ra_session_t *session;
-  const struct ra_lib_defn *defn;
+  struct ra_lib_defn *defn;
   const svn_ra__vtable_t *vtable = NULL;
   apr_uri_t repos_URI;
   apr_status_t apr_err;
@@ -341,29 +391,24 @@ svn_error_t *svn_ra_open5(svn_ra_session_t **session_p,
 
       if ((scheme = has_scheme_of(defn->schemes, repos_URL)))
         {
-          svn_ra__init_func_t initfunc = defn->initfunc;
-
 #ifdef CHOOSABLE_DAV_MODULE
           if (defn->schemes == dav_schemes
               && strcmp(defn->ra_name, http_library) != 0)
             continue;
 #endif
 
-          if (! initfunc)
-            SVN_ERR(load_ra_module(&initfunc, NULL, defn->ra_name,
-                                   scratch_pool));
-          if (! initfunc)
+          SVN_ERR(get_ra_library_vtable(&vtable, defn, scheme,
+                                        scratch_pool));
+          if (! vtable)
             /* Library not found. */
             continue;
 
-          SVN_ERR(initfunc(svn_ra_version(), &vtable, scratch_pool));
-
-          SVN_ERR(check_ra_version(vtable->get_version(), scheme));
-
           if (! has_scheme_of(vtable->get_schemes(scratch_pool), repos_URL))
-            /* Library doesn't support the scheme at runtime. */
-            continue;
-
+            {
+              /* Library doesn't support the scheme at runtime. */
+              vtable = NULL;
+              continue;
+            }
 
           break;
         }
@@ -1380,6 +1425,51 @@ svn_ra_fetch_file_contents(svn_ra_session_t *session,
                                               scratch_pool);
 }
 
+svn_error_t *
+svn_ra__get_files(svn_ra_session_t *session,
+                  const apr_array_header_t *paths,
+                  svn_revnum_t revision,
+                  svn_ra__open_file_stream_cb_t open_stream_func,
+                  void *open_stream_baton,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  int i;
+
+  for (i = 0; i < paths->nelts; i++)
+    SVN_ERR_ASSERT(*APR_ARRAY_IDX(paths, i, const char *) != '/');
+
+  if (session->vtable->get_files != NULL)
+    {
+      svn_error_t *err = session->vtable->get_files(session, paths, revision,
+                                                    open_stream_func,
+                                                    open_stream_baton,
+                                                    scratch_pool);
+      if (!err || err->apr_err != SVN_ERR_RA_NOT_IMPLEMENTED)
+        return svn_error_trace(err);
+
+      /* The other side cannot batch the request; fetch the files one
+         by one below. */
+      svn_error_clear(err);
+    }
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_stream_t *stream;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(open_stream_func(&stream, open_stream_baton, path, iterpool));
+      SVN_ERR(session->vtable->get_file(session, path, revision, stream,
+                                        NULL, NULL, iterpool));
+      SVN_ERR(svn_stream_close(stream));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra__get_commit_ev2(svn_editor_t **editor,
                        svn_ra_session_t *session,
@@ -1438,9 +1528,8 @@ svn_error_t *
 svn_ra_print_modules(svn_stringbuf_t *output,
                      apr_pool_t *pool)
 {
-  const struct ra_lib_defn *defn;
+  struct ra_lib_defn *defn;
   const char * const *schemes;
-  svn_ra__init_func_t initfunc;
   const svn_ra__vtable_t *vtable;
   apr_pool_t *iterpool = svn_pool_create(pool);
 
@@ -1450,17 +1539,11 @@ svn_ra_print_modules(svn_stringbuf_t *output,
 
       svn_pool_clear(iterpool);
 
-      initfunc = defn->initfunc;
-      if (! initfunc)
-        SVN_ERR(load_ra_module(&initfunc, NULL, defn->ra_name,
-                               iterpool));
+      SVN_ERR(get_ra_library_vtable(&vtable, defn, defn->ra_name,
+                                    iterpool));
 
-      if (initfunc)
+      if (vtable)
         {
-          SVN_ERR(initfunc(svn_ra_version(), &vtable, iterpool));
-
-          SVN_ERR(check_ra_version(vtable->get_version(), defn->ra_name));
-
           /* Note: if you change the formatting of the description,
              bear in mind that ra_svn's description has multiple lines when
              built with SASL. */
@@ -352,6 +352,15 @@ typedef struct svn_ra__vtable_t {
                                       svn_stream_t *stream,
                                       apr_pool_t *scratch_pool);
 
+  /* See svn_ra__get_files().  May be NULL; the loader then falls back
+     to fetching the files one by one via get_file. */
+  svn_error_t *(*get_files)(svn_ra_session_t *session,
+                            const apr_array_header_t *paths,
+                            svn_revnum_t revision,
+                            svn_ra__open_file_stream_cb_t open_stream_func,
+                            void *open_stream_baton,
+                            apr_pool_t *scratch_pool);
+
   /* Experimental support below here */
 
   /* See svn_ra__register_editor_shim_callbacks() */
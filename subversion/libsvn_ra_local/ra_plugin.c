@@ -1293,6 +1293,12 @@ get_file(svn_ra_session_t *session,
                                _("'%s' is not a file"), abs_path);
     }
 
+  /* Handle props if requested.  Do this before pushing the contents so
+     that callers see *PROPS complete before the first byte arrives at
+     STREAM, as promised by svn_ra_get_file(). */
+  if (props)
+    SVN_ERR(get_node_props(props, root, abs_path, sess->uuid, pool, pool));
+
   if (stream)
     {
       /* Get a stream representing the file's contents. */
@@ -1314,10 +1320,6 @@ get_file(svn_ra_session_t *session,
                                pool));
     }
 
-  /* Handle props if requested. */
-  if (props)
-    SVN_ERR(get_node_props(props, root, abs_path, sess->uuid, pool, pool));
-
   return SVN_NO_ERROR;
 }
 
@@ -1652,7 +1654,21 @@ svn_ra_local__replay_range(svn_ra_session_t *session,
                            void *replay_baton,
                            apr_pool_t *pool)
 {
-  return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL, NULL);
+  svn_ra_local__session_baton_t *sess = session->priv;
+
+  /* The svn_ra callback types match the svn_repos ones, so we can pass
+     them through as they are. */
+  return svn_error_trace(svn_repos__replay_range(sess->repos,
+                                                 sess->fs_path->data,
+                                                 start_revision,
+                                                 end_revision,
+                                                 low_water_mark,
+                                                 send_deltas,
+                                                 revstart_func,
+                                                 revfinish_func,
+                                                 replay_baton,
+                                                 NULL, NULL,
+                                                 pool));
 }
 
 
@@ -1947,6 +1963,7 @@ static const svn_ra__vtable_t ra_local_vtable =
   NULL /* set_svn_ra_open */,
   svn_ra_local__list ,
   svn_ra_local__fetch_file_contents,
+  NULL /* get_files */,
   svn_ra_local__register_editor_shim_callbacks,
   svn_ra_local__get_commit_ev2,
   NULL /* replay_range_ev2 */
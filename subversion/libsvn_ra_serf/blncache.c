@@ -25,6 +25,8 @@
 
 #include "svn_hash.h"
 #include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_string.h"
 #include "svn_types.h"
 #include "svn_pools.h"
 
@@ -50,6 +52,11 @@ struct svn_ra_serf__blncache_t
    * structures. (Allocated from the same pool as 'revnum_to_bc'.)
    */
   apr_hash_t *baseline_info;
+
+  /* TRUE if information was added since the cache was created or loaded,
+   * i.e. if svn_ra_serf__blncache_save has something new to write.
+   */
+  svn_boolean_t modified;
 };
 
 
@@ -129,6 +136,7 @@ svn_ra_serf__blncache_set(svn_ra_serf__blncache_t *blncache,
 
       hash_set_copy(blncache->revnum_to_bc, &revision, sizeof(revision),
                     apr_pstrdup(cache_pool, bc_url));
+      blncache->modified = TRUE;
 
       if (baseline_url)
         {
@@ -177,3 +185,98 @@ svn_ra_serf__blncache_get_baseline_info(const char **bc_url_p,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_serf__blncache_load(svn_ra_serf__blncache_t *blncache,
+                           const char *path,
+                           apr_pool_t *scratch_pool)
+{
+  apr_pool_t *cache_pool = apr_hash_pool_get(blncache->revnum_to_bc);
+  apr_hash_t *stored = apr_hash_make(scratch_pool);
+  svn_stream_t *stream;
+  apr_hash_index_t *hi;
+  svn_error_t *err;
+
+  err = svn_stream_open_readonly(&stream, path, scratch_pool, scratch_pool);
+  if (!err)
+    err = svn_error_compose_create(svn_hash_read2(stored, stream,
+                                                  SVN_HASH_TERMINATOR,
+                                                  scratch_pool),
+                                   svn_stream_close(stream));
+  if (err)
+    {
+      /* A missing, truncated or garbled cache file simply means we start
+       * out with an empty cache, just like the first session did. */
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  for (hi = apr_hash_first(scratch_pool, stored); hi; hi = apr_hash_next(hi))
+    {
+      const char *key = apr_hash_this_key(hi);
+      const svn_string_t *value = apr_hash_this_val(hi);
+      apr_int64_t parsed;
+      svn_revnum_t revision;
+
+      err = svn_cstring_atoi64(&parsed, key);
+      if (err)
+        {
+          /* Not a revision number; skip the entry. */
+          svn_error_clear(err);
+          continue;
+        }
+      revision = (svn_revnum_t)parsed;
+
+      if (!SVN_IS_VALID_REVNUM(revision)
+          || apr_hash_get(blncache->revnum_to_bc, &revision,
+                          sizeof(revision)))
+        continue;
+
+      hash_set_copy(blncache->revnum_to_bc, &revision, sizeof(revision),
+                    apr_pstrdup(cache_pool, value->data));
+    }
+
+  blncache->modified = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__blncache_save(svn_ra_serf__blncache_t *blncache,
+                           const char *path,
+                           apr_pool_t *scratch_pool)
+{
+  apr_hash_t *stored;
+  apr_hash_index_t *hi;
+  svn_stringbuf_t *buf;
+  svn_stream_t *stream;
+
+  if (!blncache->modified)
+    return SVN_NO_ERROR;
+
+  stored = apr_hash_make(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, blncache->revnum_to_bc);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const svn_revnum_t *revision = apr_hash_this_key(hi);
+      const char *bc_url = apr_hash_this_val(hi);
+
+      svn_hash_sets(stored, apr_psprintf(scratch_pool, "%ld", *revision),
+                    svn_string_create(bc_url, scratch_pool));
+    }
+
+  buf = svn_stringbuf_create_empty(scratch_pool);
+  stream = svn_stream_from_stringbuf(buf, scratch_pool);
+  SVN_ERR(svn_hash_write2(stored, stream, SVN_HASH_TERMINATOR, scratch_pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(path, scratch_pool),
+                                      scratch_pool));
+  SVN_ERR(svn_io_write_atomic2(path, buf->data, buf->len, NULL,
+                               FALSE /* flush_to_disk */, scratch_pool));
+
+  blncache->modified = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
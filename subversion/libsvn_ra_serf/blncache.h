@@ -83,6 +83,26 @@ svn_ra_serf__blncache_get_baseline_info(const char **bc_url_p,
                                         const char *baseline_url,
                                         apr_pool_t *pool);
 
+/* Prime BLNCACHE's revision -> baseline collection URL mapping from the
+ * cache file PATH, written by an earlier session's
+ * svn_ra_serf__blncache_save. A missing or unparsable file simply
+ * leaves the cache empty. Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_ra_serf__blncache_load(svn_ra_serf__blncache_t *blncache,
+                           const char *path,
+                           apr_pool_t *scratch_pool);
+
+/* Write BLNCACHE's revision -> baseline collection URL mapping to the
+ * cache file PATH, creating any missing parent directories. Does
+ * nothing if no new information was added since the cache was created
+ * or loaded. Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_ra_serf__blncache_save(svn_ra_serf__blncache_t *blncache,
+                           const char *path,
+                           apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -41,11 +41,36 @@
 
 #include "private/svn_dep_compat.h"
 #include "private/svn_string_private.h"
+#include "private/svn_subr_private.h"
 
 #include "ra_serf.h"
 #include "../libsvn_ra/ra_loader.h"
 
 
+/* The minimum file size (in bytes) before we try to split a fulltext
+   fetch into parallel ranged GETs, and the minimum size of an
+   individual range.  Below these limits, the cost of opening extra
+   connections outweighs any bandwidth gain. */
+#define RANGED_GET_MIN_FILE_SIZE (16 * 1024 * 1024)
+#define RANGED_GET_MIN_RANGE_SIZE (8 * 1024 * 1024)
+
+/* Spill buffer parameters for range bodies that arrive while an
+   earlier range is still in transit: keep up to 1MB per range in
+   memory, spill the rest to disk. */
+#define RANGED_GET_SPILL_BLOCKSIZE (64 * 1024)
+#define RANGED_GET_SPILL_MAXSIZE (1024 * 1024)
+
+/* Like type_and_checksum_props, but additionally asks for the content
+   length so that we can decide whether a ranged fetch is worthwhile. */
+static const svn_ra_serf__dav_props_t type_checksum_length_props[] =
+{
+  { "DAV:", "resourcetype" },
+  { SVN_DAV_PROP_NS_DAV, "sha1-checksum" },
+  { "DAV:", "getcontentlength" },
+  { NULL }
+};
+
+
 
 
 /*
@@ -74,6 +99,22 @@ typedef struct stream_ctx_t {
   /* If we're writing this file to a stream, this will be non-NULL. */
   svn_stream_t *result_stream;
 
+  /* For a ranged GET: the (inclusive) byte range this request covers.
+     Unused for an ordinary full-body GET. */
+  apr_off_t range_start;
+  apr_off_t range_end;
+
+  /* Accept a 206 Partial Content response (we sent a Range header). */
+  svn_boolean_t accept_partial;
+
+  /* Reject a 200 response.  A full body instead of the requested range
+     would end up in the middle of the reassembled file. */
+  svn_boolean_t require_partial;
+
+  /* For ranges that must wait for an earlier range before they may be
+     written out: RESULT_STREAM writes into this spill buffer. */
+  svn_spillbuf_t *spillbuf;
+
 } stream_ctx_t;
 
 
@@ -96,6 +137,27 @@ headers_fetch(serf_bucket_t *headers,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+headers_fetch_range(serf_bucket_t *headers,
+                    void *baton,
+                    apr_pool_t *pool /* request pool */,
+                    apr_pool_t *scratch_pool)
+{
+  stream_ctx_t *fetch_ctx = baton;
+
+  serf_bucket_headers_setn(headers, "Range",
+                           apr_psprintf(pool,
+                                        "bytes=%" APR_OFF_T_FMT
+                                        "-%" APR_OFF_T_FMT,
+                                        fetch_ctx->range_start,
+                                        fetch_ctx->range_end));
+
+  /* Note: no Accept-Encoding here.  Byte ranges address the raw entity;
+     a content-coded response would make the offsets meaningless. */
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 cancel_fetch(serf_request_t *request,
              serf_bucket_t *response,
@@ -199,8 +261,10 @@ handle_stream(serf_request_t *request,
 {
   stream_ctx_t *fetch_ctx = handler_baton;
   apr_status_t status;
+  int code = fetch_ctx->handler->sline.code;
 
-  if (fetch_ctx->handler->sline.code != 200)
+  if (!((code == 200 && !fetch_ctx->require_partial)
+        || (code == 206 && fetch_ctx->accept_partial)))
     return svn_error_trace(svn_ra_serf__unexpected_status(fetch_ctx->handler));
 
   while (1)
@@ -271,6 +335,7 @@ struct file_prop_baton_t
   svn_node_kind_t kind;
   apr_hash_t *props;
   const char *sha1_checksum;
+  apr_off_t content_length;
 };
 
 /* Implements svn_ra_serf__prop_func_t for svn_ra_serf__get_file */
@@ -301,6 +366,18 @@ get_file_prop_cb(void *baton,
     {
       fb->sha1_checksum = apr_pstrdup(fb->result_pool, value->data);
     }
+  else if (strcmp(ns, "DAV:") == 0
+           && strcmp(name, "getcontentlength") == 0)
+    {
+      /* 'getcontentlength' property is empty for directories. */
+      if (value->len)
+        {
+          apr_int64_t length;
+
+          SVN_ERR(svn_cstring_atoi64(&length, value->data));
+          fb->content_length = (apr_off_t)length;
+        }
+    }
 
   if (!fb->props)
     return SVN_NO_ERROR;
@@ -314,6 +391,236 @@ get_file_prop_cb(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* Open additional connections on SESS until it has WANTED of them (but
+ * never more than the compiled-in maximum).  Modeled on
+ * open_connection_if_needed() in update.c.
+ */
+static svn_error_t *
+open_extra_connections(svn_ra_serf__session_t *sess, int wanted)
+{
+  if (wanted > SVN_RA_SERF__MAX_CONNECTIONS_LIMIT)
+    wanted = SVN_RA_SERF__MAX_CONNECTIONS_LIMIT;
+
+  while (sess->num_conns < wanted)
+    {
+      int cur = sess->num_conns;
+      apr_status_t status;
+
+      sess->conns[cur] = apr_pcalloc(sess->pool, sizeof(*sess->conns[cur]));
+      sess->conns[cur]->bkt_alloc = serf_bucket_allocator_create(sess->pool,
+                                                                 NULL, NULL);
+      sess->conns[cur]->last_status_code = -1;
+      sess->conns[cur]->session = sess;
+      status = serf_connection_create2(&sess->conns[cur]->conn,
+                                       sess->context,
+                                       sess->session_url,
+                                       svn_ra_serf__conn_setup,
+                                       sess->conns[cur],
+                                       svn_ra_serf__conn_closed,
+                                       sess->conns[cur],
+                                       sess->pool);
+      if (status)
+        return svn_ra_serf__wrap_err(status, NULL);
+
+      sess->num_conns++;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Fetch the body of FETCH_URL (CONTENT_LENGTH bytes) as a series of
+ * ranged GETs spread over the session's connection pool and write it,
+ * in order, to DST_STREAM (which is left open).
+ *
+ * The first range is requested on its own.  If the server (or an
+ * intermediate proxy) answers it with a plain 200 instead of 206
+ * Partial Content, that response already carries the full body and we
+ * simply deliver it.  Otherwise, the remaining ranges are issued
+ * concurrently, one per connection, and written out in request order;
+ * ranges that complete while an earlier one is still in transit are
+ * spooled through spill buffers.  Range responses are always sent
+ * without content-coding, so this trades compression for connection
+ * parallelism.
+ *
+ * If SHA1_CHECKSUM_PROP is non-NULL, verify the reassembled content
+ * against it.
+ */
+static svn_error_t *
+fetch_file_ranged(svn_ra_serf__session_t *session,
+                  const char *fetch_url,
+                  apr_off_t content_length,
+                  const char *sha1_checksum_prop,
+                  svn_stream_t *dst_stream,
+                  apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *expected_checksum = NULL;
+  svn_checksum_t *actual_checksum = NULL;
+  svn_stream_t *target;
+  stream_ctx_t *probe_ctx;
+  svn_ra_serf__handler_t *handler;
+  apr_off_t range_size;
+  int nranges;
+  int i;
+
+  nranges = (int)((content_length + RANGED_GET_MIN_RANGE_SIZE - 1)
+                  / RANGED_GET_MIN_RANGE_SIZE);
+  if (nranges > session->max_connections)
+    nranges = (int)session->max_connections;
+  if (nranges > SVN_RA_SERF__MAX_CONNECTIONS_LIMIT)
+    nranges = SVN_RA_SERF__MAX_CONNECTIONS_LIMIT;
+  range_size = (content_length + nranges - 1) / nranges;
+
+  /* Reassembling from multiple responses adds a failure mode that a
+     single GET doesn't have, so double-check the result against the
+     server-reported checksum whenever we have one. */
+  if (sha1_checksum_prop)
+    {
+      SVN_ERR(svn_checksum_parse_hex(&expected_checksum, svn_checksum_sha1,
+                                     sha1_checksum_prop, scratch_pool));
+      target = svn_stream_checksummed2(svn_stream_disown(dst_stream,
+                                                         scratch_pool),
+                                       NULL, &actual_checksum,
+                                       svn_checksum_sha1, FALSE,
+                                       scratch_pool);
+    }
+  else
+    target = svn_stream_disown(dst_stream, scratch_pool);
+
+  /* Probe with the first range.  Its body goes straight to the target
+     stream either way: as the first range (206) or, if the server
+     ignores the Range header, as the full body (200). */
+  probe_ctx = apr_pcalloc(scratch_pool, sizeof(*probe_ctx));
+  probe_ctx->result_stream = target;
+  probe_ctx->session = session;
+  probe_ctx->range_start = 0;
+  probe_ctx->range_end = range_size - 1;
+  probe_ctx->accept_partial = TRUE;
+
+  handler = svn_ra_serf__create_handler(session, scratch_pool);
+
+  handler->method = "GET";
+  handler->path = fetch_url;
+
+  handler->custom_accept_encoding = TRUE;
+  handler->no_dav_headers = TRUE;
+
+  handler->header_delegate = headers_fetch_range;
+  handler->header_delegate_baton = probe_ctx;
+
+  handler->response_handler = handle_stream;
+  handler->response_baton = probe_ctx;
+
+  handler->response_error = cancel_fetch;
+  handler->response_error_baton = probe_ctx;
+
+  probe_ctx->handler = handler;
+
+  SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
+
+  if (handler->sline.code == 206)
+    {
+      stream_ctx_t **range_ctxs = apr_palloc(scratch_pool,
+                                             nranges * sizeof(*range_ctxs));
+      apr_pool_t *iterpool;
+
+      SVN_ERR(open_extra_connections(session, nranges));
+
+      /* Queue the remaining ranges, spread over the connection pool. */
+      for (i = 1; i < nranges; i++)
+        {
+          stream_ctx_t *range_ctx;
+
+          range_ctx = apr_pcalloc(scratch_pool, sizeof(*range_ctx));
+          range_ctx->session = session;
+          range_ctx->range_start = (apr_off_t)i * range_size;
+          range_ctx->range_end = range_ctx->range_start + range_size - 1;
+          if (range_ctx->range_end > content_length - 1)
+            range_ctx->range_end = content_length - 1;
+          range_ctx->accept_partial = TRUE;
+          range_ctx->require_partial = TRUE;
+          range_ctx->spillbuf = svn_spillbuf__create(
+                                  RANGED_GET_SPILL_BLOCKSIZE,
+                                  RANGED_GET_SPILL_MAXSIZE,
+                                  scratch_pool);
+          range_ctx->result_stream =
+            svn_stream__from_spillbuf(range_ctx->spillbuf, scratch_pool);
+
+          handler = svn_ra_serf__create_handler(session, scratch_pool);
+
+          handler->method = "GET";
+          handler->path = fetch_url;
+
+          handler->custom_accept_encoding = TRUE;
+          handler->no_dav_headers = TRUE;
+
+          handler->header_delegate = headers_fetch_range;
+          handler->header_delegate_baton = range_ctx;
+
+          handler->response_handler = handle_stream;
+          handler->response_baton = range_ctx;
+
+          handler->response_error = cancel_fetch;
+          handler->response_error_baton = range_ctx;
+
+          handler->conn = session->conns[i % session->num_conns];
+
+          range_ctx->handler = handler;
+          range_ctxs[i] = range_ctx;
+
+          svn_ra_serf__request_create(handler);
+        }
+
+      /* Wait for each range in file order and append its body to the
+         target stream.  While we wait for range I, the event loop keeps
+         all the other requests moving; later ranges accumulate in their
+         spill buffers until it is their turn. */
+      iterpool = svn_pool_create(scratch_pool);
+      for (i = 1; i < nranges; i++)
+        {
+          stream_ctx_t *range_ctx = range_ctxs[i];
+
+          SVN_ERR(svn_ra_serf__context_run_wait(&range_ctx->handler->done,
+                                                session, scratch_pool));
+
+          if (range_ctx->handler->sline.code != 206)
+            return svn_error_trace(
+                     svn_ra_serf__unexpected_status(range_ctx->handler));
+
+          while (TRUE)
+            {
+              const char *data;
+              apr_size_t len;
+
+              svn_pool_clear(iterpool);
+              SVN_ERR(svn_spillbuf__read(&data, &len, range_ctx->spillbuf,
+                                         iterpool));
+              if (data == NULL)
+                break;
+
+              SVN_ERR(svn_stream_write(target, data, &len));
+            }
+        }
+      svn_pool_destroy(iterpool);
+    }
+  else if (handler->sline.code != 200)
+    return svn_error_trace(svn_ra_serf__unexpected_status(handler));
+  /* Else: the server ignored the Range header and sent the whole file,
+     which handle_stream() already delivered.  Nothing more to fetch. */
+
+  SVN_ERR(svn_stream_close(target));
+
+  if (expected_checksum
+      && !svn_checksum_match(expected_checksum, actual_checksum))
+    return svn_error_trace(
+             svn_checksum_mismatch_err(expected_checksum, actual_checksum,
+                                       scratch_pool,
+                                       _("Checksum mismatch while fetching "
+                                         "'%s'"),
+                                       fetch_url));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_serf__get_file(svn_ra_session_t *ra_session,
                       const char *path,
@@ -353,8 +660,8 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
 
   if (props)
       which_props = all_props;
-  else if (stream && session->wc_callbacks->get_wc_contents)
-      which_props = type_and_checksum_props;
+  else if (stream)
+      which_props = type_checksum_length_props;
   else
       which_props = check_path_props;
 
@@ -362,6 +669,7 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
   fb.props = props ? apr_hash_make(result_pool) : NULL;
   fb.kind = svn_node_unknown;
   fb.sha1_checksum = NULL;
+  fb.content_length = -1;
 
   SVN_ERR(svn_ra_serf__create_propfind_handler(&propfind_handler, session,
                                                fetch_url, SVN_INVALID_REVNUM,
@@ -388,7 +696,16 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
                                   scratch_pool));
 
       /* No contents found in the WC, let's fetch from server. */
-      if (!found)
+      if (!found
+          && fb.content_length >= RANGED_GET_MIN_FILE_SIZE
+          && session->max_connections > 1)
+        {
+          /* Big enough that splitting the fetch into parallel ranged
+             GETs over the connection pool pays off. */
+          SVN_ERR(fetch_file_ranged(session, fetch_url, fb.content_length,
+                                    fb.sha1_checksum, stream, scratch_pool));
+        }
+      else if (!found)
         {
           stream_ctx_t *stream_ctx;
           svn_ra_serf__handler_t *handler;
@@ -0,0 +1,166 @@
+/*
+ * propcache.c: DAV property result cache.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+
+#include "svn_hash.h"
+#include "svn_string.h"
+#include "svn_types.h"
+#include "svn_pools.h"
+
+#include "propcache.h"
+
+/* Cached PROPFIND result. */
+typedef struct prop_result_t
+{
+  const void *prop_set; /* identity of the requested property list. */
+  apr_hash_t *props;    /* namespace -> (name -> svn_string_t *). */
+
+} prop_result_t;
+
+/* Module-private structure used to hold the cache. */
+struct svn_ra_serf__propcache_t
+{
+  /* A hash mapping 'const char *' keys built from URL and revision to
+   * 'prop_result_t *' structures.
+   */
+  apr_hash_t *results;
+};
+
+
+/* Return the cache key for the resource URL pinned at REVISION,
+ * allocated in POOL.
+ */
+static const char *
+cache_key(const char *url,
+          svn_revnum_t revision,
+          apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "%ld:%s", revision, url);
+}
+
+/* Return a deep copy of PROPS, allocated in POOL. PROPS maps
+ * 'const char *' namespaces to hashes mapping 'const char *' names to
+ * 'svn_string_t *' values.
+ */
+static apr_hash_t *
+dup_props(apr_hash_t *props,
+          apr_pool_t *pool)
+{
+  apr_hash_t *result = apr_hash_make(pool);
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(pool, props); hi; hi = apr_hash_next(hi))
+    {
+      const char *ns = apr_hash_this_key(hi);
+      apr_hash_t *ns_props = apr_hash_this_val(hi);
+      apr_hash_t *ns_result = apr_hash_make(pool);
+      apr_hash_index_t *hi2;
+
+      for (hi2 = apr_hash_first(pool, ns_props);
+           hi2;
+           hi2 = apr_hash_next(hi2))
+        {
+          const char *name = apr_hash_this_key(hi2);
+          const svn_string_t *value = apr_hash_this_val(hi2);
+
+          svn_hash_sets(ns_result, apr_pstrdup(pool, name),
+                        svn_string_dup(value, pool));
+        }
+
+      svn_hash_sets(result, apr_pstrdup(pool, ns), ns_result);
+    }
+
+  return result;
+}
+
+
+svn_error_t *
+svn_ra_serf__propcache_create(svn_ra_serf__propcache_t **propcache_p,
+                              apr_pool_t *pool)
+{
+  svn_ra_serf__propcache_t *propcache = apr_pcalloc(pool, sizeof(*propcache));
+  apr_pool_t *cache_pool;
+
+  /* Create subpool for cached data. It will be cleared if we reach maximum
+   * cache size.*/
+  cache_pool = svn_pool_create(pool);
+  propcache->results = apr_hash_make(cache_pool);
+
+  *propcache_p = propcache;
+
+  return SVN_NO_ERROR;
+}
+
+#define MAX_CACHE_SIZE 1000
+
+svn_error_t *
+svn_ra_serf__propcache_set(svn_ra_serf__propcache_t *propcache,
+                           const char *url,
+                           svn_revnum_t revision,
+                           const void *prop_set,
+                           apr_hash_t *props,
+                           apr_pool_t *scratch_pool)
+{
+  apr_pool_t *cache_pool = apr_hash_pool_get(propcache->results);
+  prop_result_t *result;
+
+  /* If the cache is too big, delete and recreate it and move along. */
+  if (MAX_CACHE_SIZE < apr_hash_count(propcache->results))
+    {
+      svn_pool_clear(cache_pool);
+      propcache->results = apr_hash_make(cache_pool);
+    }
+
+  result = apr_palloc(cache_pool, sizeof(*result));
+  result->prop_set = prop_set;
+  result->props = dup_props(props, cache_pool);
+
+  svn_hash_sets(propcache->results,
+                cache_key(url, revision, cache_pool), result);
+
+  return SVN_NO_ERROR;
+}
+
+#undef MAX_CACHE_SIZE
+
+svn_error_t *
+svn_ra_serf__propcache_get(apr_hash_t **props_p,
+                           svn_ra_serf__propcache_t *propcache,
+                           const char *url,
+                           svn_revnum_t revision,
+                           const void *prop_set,
+                           apr_pool_t *result_pool)
+{
+  const char *key = cache_key(url, revision, result_pool);
+  prop_result_t *result = svn_hash_gets(propcache->results, key);
+
+  /* A result fetched for a different property list may lack properties
+     the caller asked for, so treat it as missing. */
+  if (result && result->prop_set == prop_set)
+    *props_p = dup_props(result->props, result_pool);
+  else
+    *props_p = NULL;
+
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,84 @@
+/*
+ * propcache.h: DAV property result cache.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_RA_SERF_PROPCACHE_H
+#define SVN_LIBSVN_RA_SERF_PROPCACHE_H
+
+#include <apr_pools.h>
+#include <apr_hash.h>
+
+#include "svn_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Property result cache. Holds the parsed responses of Depth:0 PROPFIND
+ * requests whose target is pinned to a single revision, so that repeating
+ * the same request within one session does not go back to the server.
+ * The caller is responsible for only storing results whose target cannot
+ * change for the lifetime of the session.
+ */
+typedef struct svn_ra_serf__propcache_t svn_ra_serf__propcache_t;
+
+/* Creates new instance of property result cache. Sets PROPCACHE_P with
+ * a pointer to new instance, allocated in POOL.
+ */
+svn_error_t *
+svn_ra_serf__propcache_create(svn_ra_serf__propcache_t **propcache_p,
+                              apr_pool_t *pool);
+
+/* Add the PROPFIND result PROPS for the resource URL pinned at REVISION
+ * (which may be SVN_INVALID_REVNUM if the revision is encoded in URL
+ * itself). PROPS is a hash mapping 'const char *' namespaces to hashes
+ * mapping 'const char *' names to 'svn_string_t *' values; it is deep
+ * copied into the cache's own pool. PROP_SET identifies the property
+ * list the request asked for; pass the same address when looking the
+ * result up again.
+ */
+svn_error_t *
+svn_ra_serf__propcache_set(svn_ra_serf__propcache_t *propcache,
+                           const char *url,
+                           svn_revnum_t revision,
+                           const void *prop_set,
+                           apr_hash_t *props,
+                           apr_pool_t *scratch_pool);
+
+/* Set *PROPS_P to a copy, allocated in RESULT_POOL, of the cached
+ * PROPFIND result for the resource URL pinned at REVISION and the
+ * property list identified by PROP_SET. *PROPS_P will be NULL if the
+ * cache doesn't have such information.
+ */
+svn_error_t *
+svn_ra_serf__propcache_get(apr_hash_t **props_p,
+                           svn_ra_serf__propcache_t *propcache,
+                           const char *url,
+                           svn_revnum_t revision,
+                           const void *prop_set,
+                           apr_pool_t *result_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_RA_SERF_PROPCACHE_H */
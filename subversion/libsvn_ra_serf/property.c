@@ -27,6 +27,9 @@
 
 #include "svn_hash.h"
 #include "svn_path.h"
+#include "svn_auth.h"
+#include "svn_config.h"
+#include "svn_ctype.h"
 #include "svn_base64.h"
 #include "svn_xml.h"
 #include "svn_props.h"
@@ -563,6 +566,29 @@ deliver_node_props(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* Return TRUE if a PROPFIND of URL@REVISION will produce the same
+   response for the lifetime of SESSION, i.e. if the result may be kept
+   in the session's property cache. That is the case when the target is
+   pinned to a single revision, either through an explicit REVISION
+   (sent as a Label: header) or because URL lives below the HTTP v2
+   revision root stub and thus has the revision baked in. Floating
+   (HEAD) resources must always be re-fetched.  */
+static svn_boolean_t
+propfind_is_cacheable(svn_ra_serf__session_t *session,
+                      const char *url,
+                      svn_revnum_t revision)
+{
+  if (SVN_IS_VALID_REVNUM(revision))
+    return TRUE;
+
+  if (SVN_RA_SERF__HAVE_HTTPV2_SUPPORT(session)
+      && session->rev_root_stub
+      && svn_urlpath__skip_ancestor(session->rev_root_stub, url))
+    return TRUE;
+
+  return FALSE;
+}
+
 svn_error_t *
 svn_ra_serf__fetch_node_props(apr_hash_t **results,
                               svn_ra_serf__session_t *session,
@@ -574,6 +600,19 @@ svn_ra_serf__fetch_node_props(apr_hash_t **results,
 {
   apr_hash_t *props;
   svn_ra_serf__handler_t *handler;
+  svn_boolean_t cacheable = propfind_is_cacheable(session, url, revision);
+
+  if (cacheable)
+    {
+      SVN_ERR(svn_ra_serf__propcache_get(&props, session->propcache,
+                                         url, revision, which_props,
+                                         result_pool));
+      if (props)
+        {
+          *results = props;
+          return SVN_NO_ERROR;
+        }
+    }
 
   props = apr_hash_make(result_pool);
 
@@ -584,6 +623,10 @@ svn_ra_serf__fetch_node_props(apr_hash_t **results,
 
   SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
 
+  if (cacheable)
+    SVN_ERR(svn_ra_serf__propcache_set(session->propcache, url, revision,
+                                       which_props, props, scratch_pool));
+
   *results = props;
   return SVN_NO_ERROR;
 }
@@ -772,6 +815,81 @@ svn_ra_serf__get_youngest_revnum(svn_revnum_t *youngest,
 }
 
 
+/* Baton for save_baseline_cache(). */
+typedef struct blncache_cleanup_baton_t {
+  svn_ra_serf__blncache_t *blncache;
+  const char *path;
+} blncache_cleanup_baton_t;
+
+/* APR pool cleanup handler, writing the baseline cache back to disk when
+   the session is destroyed. */
+static apr_status_t
+save_baseline_cache(void *data)
+{
+  blncache_cleanup_baton_t *bcb = data;
+  apr_pool_t *scratch_pool = svn_pool_create(NULL);
+  svn_error_t *err = svn_ra_serf__blncache_save(bcb->blncache, bcb->path,
+                                                scratch_pool);
+
+  /* There is no way to report an error from a pool cleanup, and losing
+     the cache merely costs the next session a few PROPFINDs. */
+  svn_error_clear(err);
+  svn_pool_destroy(scratch_pool);
+
+  return APR_SUCCESS;
+}
+
+/* Prime SESSION->blncache with the revision -> baseline collection URL
+   mappings persisted by earlier sessions against the same repository,
+   and schedule writing the cache back when the session is destroyed.
+   The cache file lives in the user configuration area, keyed by the
+   repository UUID, so that short-lived clients which open a fresh
+   session per command do not repeat the baseline discovery PROPFINDs
+   for pegged revisions. Only the revision-keyed mappings are persisted;
+   they are immutable for a given repository. No-op if the UUID is not
+   (yet) known. */
+static svn_error_t *
+load_persisted_blncache(svn_ra_serf__session_t *session,
+                        apr_pool_t *scratch_pool)
+{
+  const char *config_dir = NULL;
+  const char *path;
+  const char *c;
+  blncache_cleanup_baton_t *bcb;
+
+  if (session->blncache_loaded || !session->uuid)
+    return SVN_NO_ERROR;
+
+  session->blncache_loaded = TRUE;
+
+  /* The UUID becomes a path component below, so don't trust a server
+     that reports something other than hex digits and hyphens. */
+  for (c = session->uuid; *c; c++)
+    if (!svn_ctype_isxdigit(*c) && *c != '-')
+      return SVN_NO_ERROR;
+
+  if (session->auth_baton)
+    config_dir = svn_auth_get_parameter(session->auth_baton,
+                                        SVN_AUTH_PARAM_CONFIG_DIR);
+
+  SVN_ERR(svn_config_get_user_config_path(&path, config_dir,
+                                          "baseline-cache", scratch_pool));
+  if (!path)
+    return SVN_NO_ERROR;
+
+  path = svn_dirent_join(path, session->uuid, session->pool);
+
+  SVN_ERR(svn_ra_serf__blncache_load(session->blncache, path, scratch_pool));
+
+  bcb = apr_palloc(session->pool, sizeof(*bcb));
+  bcb->blncache = session->blncache;
+  bcb->path = path;
+  apr_pool_cleanup_register(session->pool, bcb, save_baseline_cache,
+                            apr_pool_cleanup_null);
+
+  return SVN_NO_ERROR;
+}
+
 /* Set *BC_URL to the baseline collection url for REVISION. If REVISION
    is SVN_INVALID_REVNUM, then the youngest revnum ("HEAD") is used.
 
@@ -814,6 +932,10 @@ get_baseline_info(const char **bc_url,
 
       SVN_ERR(svn_ra_serf__discover_vcc(&vcc_url, session, scratch_pool));
 
+      /* Discovering the VCC also taught us the repository UUID, so the
+         persisted baseline cache can be consulted now. */
+      SVN_ERR(load_persisted_blncache(session, scratch_pool));
+
       if (SVN_IS_VALID_REVNUM(revision))
         {
           /* First check baseline information cache. */
@@ -42,6 +42,7 @@
 #include "private/svn_editor.h"
 
 #include "blncache.h"
+#include "propcache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -91,6 +92,14 @@ typedef struct svn_ra_serf__connection_t {
  */
 #define SVN_RA_SERF__MAX_CONNECTIONS_LIMIT 8
 
+/** Maximum and minimum values we'll allow for the http-pipeline-depth
+ * config option.  The lower bound keeps enough requests in flight for
+ * all connections to stay busy; the upper bound limits the memory
+ * spent on queued requests.
+ */
+#define SVN_RA_SERF__PIPELINE_DEPTH_LIMIT 1000
+#define SVN_RA_SERF__PIPELINE_DEPTH_MIN 10
+
 /*
  * The master serf RA session.
  *
@@ -110,6 +119,10 @@ struct svn_ra_serf__session_t {
      fetch operations (updates, etc.) */
   apr_int64_t max_connections;
 
+  /* The maximum number of GET/PROPFIND requests we'll keep in flight
+     across those connections before we pause issuing new ones. */
+  apr_int64_t pipeline_depth;
+
   /* Are we using ssl */
   svn_boolean_t using_ssl;
 
@@ -243,6 +256,14 @@ struct svn_ra_serf__session_t {
 
   svn_ra_serf__blncache_t *blncache;
 
+  /* Whether we tried to prime BLNCACHE from the persisted baseline cache
+     in the user configuration area (and scheduled writing it back when
+     this session is destroyed). */
+  svn_boolean_t blncache_loaded;
+
+  /* Cache of PROPFIND results for revision-pinned resources. */
+  svn_ra_serf__propcache_t *propcache;
+
   /* Trisate flag that indicates user preference for using bulk updates
      (svn_tristate_true) with all the properties and content in the
      update-report response. If svn_tristate_false, request a skelta
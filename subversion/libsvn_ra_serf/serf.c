@@ -245,6 +245,12 @@ load_config(svn_ra_serf__session_t *session,
                                SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS,
                                SVN_CONFIG_DEFAULT_OPTION_HTTP_MAX_CONNECTIONS));
 
+  /* Load the maximum number of in-flight fetch requests. */
+  SVN_ERR(svn_config_get_int64(config, &session->pipeline_depth,
+                               SVN_CONFIG_SECTION_GLOBAL,
+                               SVN_CONFIG_OPTION_HTTP_PIPELINE_DEPTH,
+                               SVN_CONFIG_DEFAULT_OPTION_HTTP_PIPELINE_DEPTH));
+
   /* Should we use chunked transfer encoding. */
   SVN_ERR(svn_config_get_tristate(config, &chunked_requests,
                                   SVN_CONFIG_SECTION_GLOBAL,
@@ -312,6 +318,13 @@ load_config(svn_ra_serf__session_t *session,
                                    SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS,
                                    session->max_connections));
 
+      /* Load the maximum number of in-flight fetch requests,
+         overriding global values. */
+      SVN_ERR(svn_config_get_int64(config, &session->pipeline_depth,
+                                   server_group,
+                                   SVN_CONFIG_OPTION_HTTP_PIPELINE_DEPTH,
+                                   session->pipeline_depth));
+
       /* Should we use chunked transfer encoding. */
       SVN_ERR(svn_config_get_tristate(config, &chunked_requests,
                                       server_group,
@@ -357,6 +370,12 @@ load_config(svn_ra_serf__session_t *session,
   if (session->max_connections < 2)
     session->max_connections = 2;
 
+  /* Clamp the http-pipeline-depth value for the same reasons. */
+  if (session->pipeline_depth > SVN_RA_SERF__PIPELINE_DEPTH_LIMIT)
+    session->pipeline_depth = SVN_RA_SERF__PIPELINE_DEPTH_LIMIT;
+  if (session->pipeline_depth < SVN_RA_SERF__PIPELINE_DEPTH_MIN)
+    session->pipeline_depth = SVN_RA_SERF__PIPELINE_DEPTH_MIN;
+
   /* Parse the connection timeout value, if any. */
   session->timeout = apr_time_from_sec(DEFAULT_HTTP_TIMEOUT);
   if (timeout_str)
@@ -516,6 +535,8 @@ svn_ra_serf__open(svn_ra_session_t *session,
   SVN_ERR(svn_ra_serf__blncache_create(&serf_sess->blncache,
                                        serf_sess->pool));
 
+  SVN_ERR(svn_ra_serf__propcache_create(&serf_sess->propcache,
+                                        serf_sess->pool));
 
   SVN_ERR(svn_ra_serf__uri_parse(&url, session_URL, serf_sess->pool));
 
@@ -643,6 +664,7 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
                                    result_pool));
 
   /* max_connections */
+  /* pipeline_depth */
   /* using_ssl */
   /* using_compression */
   /* http10 */
@@ -738,6 +760,10 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   /* ### Can we copy this? */
   SVN_ERR(svn_ra_serf__blncache_create(&new_sess->blncache,
                                        new_sess->pool));
+  new_sess->blncache_loaded = FALSE;
+
+  SVN_ERR(svn_ra_serf__propcache_create(&new_sess->propcache,
+                                        new_sess->pool));
 
   if (new_sess->server_allows_bulk)
     new_sess->server_allows_bulk = apr_pstrdup(result_pool,
@@ -1069,6 +1095,7 @@ static const svn_ra__vtable_t serf_vtable = {
   NULL /* set_svn_ra_open */,
   svn_ra_serf__list,
   svn_ra_serf__fetch_file_contents,
+  NULL /* get_files */,
   svn_ra_serf__register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -251,9 +251,10 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
    can make the measurements quite imprecise.
 
    We measure outstanding requests as the sum of NUM_ACTIVE_FETCHES and
-   NUM_ACTIVE_PROPFINDS in the report_context_t structure.  */
-#define REQUEST_COUNT_TO_PAUSE 50
-#define REQUEST_COUNT_TO_RESUME 40
+   NUM_ACTIVE_PROPFINDS in the report_context_t structure.  The limit is
+   the session's PIPELINE_DEPTH, configurable through the
+   http-pipeline-depth option; deep pipelining on few connections is the
+   way to keep a connection-limited server busy with many small files. */
 
 #define SPILLBUF_BLOCKSIZE 4096
 #define SPILLBUF_MAXBUFFSIZE 131072
@@ -619,9 +620,9 @@ get_best_connection(report_context_t *ctx)
 #if SERF_VERSION_AT_LEAST(1, 4, 0)
       /* Often one connection is slower than others, e.g. because the server
          process/thread has to do more work for the particular set of requests.
-         In the worst case, when REQUEST_COUNT_TO_RESUME requests are queued
-         on such a slow connection, ra_serf will completely stop sending
-         requests.
+         In the worst case, when a whole pipeline depth's worth of requests
+         is queued on such a slow connection, ra_serf will completely stop
+         sending requests.
 
          The method used here selects the connection with the least amount of
          pending requests, thereby giving more work to lightly loaded server
@@ -2251,7 +2252,7 @@ update_delay_handler(serf_request_t *request,
         }
 
       while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-                 < REQUEST_COUNT_TO_RESUME)
+                 < udb->report->sess->pipeline_depth)
         {
           const char *data;
           apr_size_t len;
@@ -2335,7 +2336,7 @@ process_pending(update_delay_baton_t *udb,
   serf_bucket_alloc_t *alloc = NULL;
 
   while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-            < REQUEST_COUNT_TO_RESUME)
+            < udb->report->sess->pipeline_depth)
     {
       const char *data;
       apr_size_t len;
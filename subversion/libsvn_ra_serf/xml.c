@@ -65,9 +65,15 @@ struct svn_ra_serf__xml_context_t {
   svn_ra_serf__xml_cdata_t cdata_cb;
   void *baton;
 
-  /* Linked list of free states.  */
+  /* Linked list of free states. Only estates without a pool of their
+     own end up here; they are recycled for sibling elements instead of
+     allocating a new estate per element in the extent pool.  */
   svn_ra_serf__xml_estate_t *free_states;
 
+  /* Whether any element matched a transition. Used to detect an empty
+     document body once the response is complete.  */
+  svn_boolean_t found_element;
+
 #ifdef SVN_DEBUG
   /* Used to verify we are not re-entering a callback, specifically to
      ensure SCRATCH_POOL is not cleared while an outer callback is
@@ -483,9 +489,9 @@ svn_ra_serf__xml_context_done(svn_ra_serf__xml_context_t *xmlctx)
                                _("XML stream truncated: closing '%s' missing"),
                                xmlctx->current->tag.name);
     }
-  else if (! xmlctx->free_states)
+  else if (! xmlctx->found_element)
     {
-      /* If we have no items on the free_states list, we didn't push anything,
+      /* If no element ever matched a transition, we didn't push anything,
          which tells us that we found an empty xml body */
       const svn_ra_serf__xml_transition_t *scan;
       const svn_ra_serf__xml_transition_t *document = NULL;
@@ -689,11 +695,10 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
   SVN_ERR_ASSERT(!scan->collect_cdata || scan->custom_close);
 
   /* Found a transition. Make it happen.  */
+  xmlctx->found_element = TRUE;
 
-  /* ### todo. push state  */
-
-  /* ### how to use free states?  */
-  /* This state should be allocated in the extent pool. If we will be
+  /* This state should be allocated in the extent pool, reusing an
+     estate from the free list when one is available. If we will be
      collecting information for this state, then construct a subpool.
 
      ### potentially optimize away the subpool if none of the
@@ -748,15 +753,35 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
     }
   else
     {
-      /* Prep the new state.  */
-      new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
+      /* Prep the new state, recycling an estate of a previously closed
+         element when we have one. Estates on the free list never carry
+         a pool of their own, so they are safe to reuse.  */
+      if (xmlctx->free_states)
+        {
+          new_xes = xmlctx->free_states;
+          xmlctx->free_states = new_xes->prev;
+          memset(new_xes, 0, sizeof(*new_xes));
+        }
+      else
+        new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
       /* STATE_POOL remains NULL.  */
     }
 
   /* Some basic copies to set up the new estate.  */
   new_xes->state = scan->to_state;
-  new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
-  new_xes->tag.xmlns = apr_pstrdup(new_pool, elemname.xmlns);
+  if (*scan->name != '*')
+    {
+      /* The matched transition holds static strings equal to the
+         expanded name, so the tag can point straight at them rather
+         than duplicating the name for every single element.  */
+      new_xes->tag.name = scan->name;
+      new_xes->tag.xmlns = scan->ns;
+    }
+  else
+    {
+      new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
+      new_xes->tag.xmlns = apr_pstrdup(new_pool, elemname.xmlns);
+    }
   new_xes->custom_close = scan->custom_close;
 
   /* Start with the parent's namespace set.  */
@@ -820,16 +845,20 @@ xml_cb_end(svn_ra_serf__xml_context_t *xmlctx,
   /* Pop the state.  */
   xmlctx->current = xes->prev;
 
-  /* ### not everything should go on the free state list. XES may go
-     ### away with the state pool.  */
-  xes->prev = xmlctx->free_states;
-  xmlctx->free_states = xes;
-
-  /* If there is a STATE_POOL, then toss it. This will get rid of as much
-     memory as possible. Potentially the XES (if we didn't create a pool
-     right away, then XES may be in a parent pool).  */
   if (xes->state_pool)
-    svn_pool_destroy(xes->state_pool);
+    {
+      /* The XES lives in its own STATE_POOL, so tossing the pool gets
+         rid of the XES and all its collected data in one go. It must
+         not go onto the free state list.  */
+      svn_pool_destroy(xes->state_pool);
+    }
+  else
+    {
+      /* The XES was allocated in the extent pool; keep it around for
+         reuse by a sibling element.  */
+      xes->prev = xmlctx->free_states;
+      xmlctx->free_states = xes;
+    }
 
   return SVN_NO_ERROR;
 }
@@ -30,6 +30,7 @@
 #include <apr_general.h>
 #include <apr_strings.h>
 #include <apr_network_io.h>
+#include <apr_portable.h>
 #include <apr_uri.h>
 
 #include "svn_hash.h"
@@ -58,6 +59,19 @@
 
 #include "ra_svn.h"
 
+#ifndef WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#if defined(AF_UNIX) && defined(SCM_RIGHTS)
+/* The client end of the connection broker requires Unix domain sockets
+   and file descriptor passing. */
+#define SVN_RA_SVN__HAVE_CONN_BROKER
+#endif
+#endif /* !WIN32 */
+
 #ifdef SVN_HAVE_SASL
 #define DO_AUTH svn_ra_svn__do_cyrus_auth
 #else
@@ -113,6 +127,174 @@ static void parse_tunnel(const char *url, const char **tunnel,
     }
 }
 
+/* Enable TCP keep-alives and disable Nagle's algorithm on SOCK; see the
+ * comments below for the rationale.  Failures to set either option are
+ * not fatal. */
+static svn_error_t *
+set_socket_options(apr_socket_t *sock)
+{
+  apr_status_t status;
+
+  /* Enable TCP keep-alives on the socket so we time out when
+   * the connection breaks due to network-layer problems.
+   * If the peer has dropped the connection due to a network partition
+   * or a crash, or if the peer no longer considers the connection
+   * valid because we are behind a NAT and our public IP has changed,
+   * it will respond to the keep-alive probe with a RST instead of an
+   * acknowledgment segment, which will cause svn to abort the session
+   * even while it is currently blocked waiting for data from the peer.
+   * See issue #3347. */
+  status = apr_socket_opt_set(sock, APR_SO_KEEPALIVE, 1);
+  if (status)
+    {
+      /* It's not a fatal error if we cannot enable keep-alives. */
+    }
+
+  /* Disable Nagle's algorithm.  The protocol marshaller only puts
+   * complete buffers or explicitly flushed messages on the wire, so
+   * delaying those segments to coalesce them with follow-up data just
+   * stalls every request/response exchange by up to one round trip. */
+  status = apr_socket_opt_set(sock, APR_TCP_NODELAY, 1);
+  if (status)
+    {
+      /* It's not a fatal error if we cannot disable Nagle. */
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#ifdef SVN_RA_SVN__HAVE_CONN_BROKER
+
+/* Pool cleanup handler, closing the socket given as DATA that was
+ * adopted from the connection broker. */
+static apr_status_t
+close_adopted_socket(void *data)
+{
+  return apr_socket_close(data);
+}
+
+/* If the SVN_RA_SVN_CONNECTION_BROKER environment variable names a
+ * Unix domain socket of a connection broker, ask the broker for an
+ * established TCP connection to HOSTNAME:PORT.  On success, return the
+ * adopted connection in *SOCK, allocated in POOL, and set *CONNECTED
+ * to TRUE.  Any failure to talk to the broker sets *CONNECTED to FALSE
+ * so the caller falls back to connecting directly; it is never an
+ * error. */
+static svn_error_t *
+try_broker_connection(apr_socket_t **sock,
+                      svn_boolean_t *connected,
+                      const char *hostname,
+                      unsigned short port,
+                      apr_pool_t *pool)
+{
+  const char *broker_path = getenv("SVN_RA_SVN_CONNECTION_BROKER");
+  struct sockaddr_un addr;
+  struct stat finfo;
+  const char *request;
+  apr_size_t to_send;
+  int broker_sock;
+  int conn_fd = -1;
+  char status_byte;
+  struct msghdr msg = { 0 };
+  struct iovec iov;
+  union {
+    struct cmsghdr align;
+    char buffer[CMSG_SPACE(sizeof(int))];
+  } control;
+  struct cmsghdr *cmsg;
+  ssize_t received;
+  apr_os_sock_t os_sock;
+  apr_status_t apr_status;
+
+  *connected = FALSE;
+  if (!broker_path || !*broker_path
+      || strlen(broker_path) >= sizeof(addr.sun_path))
+    return SVN_NO_ERROR;
+
+  /* Only talk to a broker we own.  The socket path may live in a
+   * world-writable directory where another user could have squatted it
+   * to intercept our traffic, so verify ownership before connecting,
+   * the same way ssh-agent and gpg-agent clients do. */
+  if (stat(broker_path, &finfo) != 0
+      || !S_ISSOCK(finfo.st_mode)
+      || finfo.st_uid != geteuid())
+    return SVN_NO_ERROR;
+
+  broker_sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (broker_sock < 0)
+    return SVN_NO_ERROR;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, broker_path);
+  if (connect(broker_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+      close(broker_sock);
+      return SVN_NO_ERROR;
+    }
+
+  /* Ask for a connection to the target, one "host:port" line. */
+  request = apr_psprintf(pool, "%s:%u\n", hostname, (unsigned)port);
+  to_send = strlen(request);
+  while (to_send > 0)
+    {
+      ssize_t sent = write(broker_sock, request, to_send);
+      if (sent < 0 && errno == EINTR)
+        continue;
+      if (sent <= 0)
+        {
+          close(broker_sock);
+          return SVN_NO_ERROR;
+        }
+      request += sent;
+      to_send -= sent;
+    }
+
+  /* The reply is a single status byte, carrying the connection as
+   * SCM_RIGHTS ancillary data on success. */
+  iov.iov_base = &status_byte;
+  iov.iov_len = 1;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buffer;
+  msg.msg_controllen = sizeof(control.buffer);
+
+  do
+    received = recvmsg(broker_sock, &msg, 0);
+  while (received < 0 && errno == EINTR);
+  close(broker_sock);
+
+  if (received != 1 || status_byte != '1')
+    return SVN_NO_ERROR;
+
+  cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg
+      || cmsg->cmsg_level != SOL_SOCKET
+      || cmsg->cmsg_type != SCM_RIGHTS
+      || cmsg->cmsg_len != CMSG_LEN(sizeof(int)))
+    return SVN_NO_ERROR;
+
+  memcpy(&conn_fd, CMSG_DATA(cmsg), sizeof(conn_fd));
+
+  os_sock = conn_fd;
+  apr_status = apr_os_sock_put(sock, &os_sock, pool);
+  if (apr_status)
+    {
+      close(conn_fd);
+      return SVN_NO_ERROR;
+    }
+
+  /* apr_os_sock_put() does not take ownership; close the connection
+   * with the pool like a natively created socket would be. */
+  apr_pool_cleanup_register(pool, *sock, close_adopted_socket,
+                            apr_pool_cleanup_null);
+
+  *connected = TRUE;
+  return SVN_NO_ERROR;
+}
+
+#endif /* SVN_RA_SVN__HAVE_CONN_BROKER */
+
 static svn_error_t *make_connection(const char *hostname, unsigned short port,
                                     apr_socket_t **sock, apr_pool_t *pool)
 {
@@ -120,6 +302,19 @@ static svn_error_t *make_connection(const char *hostname, unsigned short port,
   apr_status_t status;
   int family = APR_INET;
 
+#ifdef SVN_RA_SVN__HAVE_CONN_BROKER
+  {
+    svn_boolean_t brokered;
+
+    /* An established connection from the per-user broker saves the DNS
+     * lookup and the TCP handshake for every CLI invocation.  Failures
+     * fall back silently to connecting directly. */
+    SVN_ERR(try_broker_connection(sock, &brokered, hostname, port, pool));
+    if (brokered)
+      return svn_error_trace(set_socket_options(*sock));
+  }
+#endif
+
   /* Make sure we have IPV6 support first before giving apr_sockaddr_info_get
      APR_UNSPEC, because it may give us back an IPV6 address even if we can't
      create IPV6 sockets.  */
@@ -169,22 +364,7 @@ static svn_error_t *make_connection(const char *hostname, unsigned short port,
     return svn_error_wrap_apr(status, _("Can't connect to host '%s'"),
                               hostname);
 
-  /* Enable TCP keep-alives on the socket so we time out when
-   * the connection breaks due to network-layer problems.
-   * If the peer has dropped the connection due to a network partition
-   * or a crash, or if the peer no longer considers the connection
-   * valid because we are behind a NAT and our public IP has changed,
-   * it will respond to the keep-alive probe with a RST instead of an
-   * acknowledgment segment, which will cause svn to abort the session
-   * even while it is currently blocked waiting for data from the peer.
-   * See issue #3347. */
-  status = apr_socket_opt_set(*sock, APR_SO_KEEPALIVE, 1);
-  if (status)
-    {
-      /* It's not a fatal error if we cannot enable keep-alives. */
-    }
-
-  return SVN_NO_ERROR;
+  return svn_error_trace(set_socket_options(*sock));
 }
 
 /* Set *DIFFS to an array of svn_prop_t, allocated in POOL, based on the
@@ -549,7 +729,8 @@ static svn_error_t *make_tunnel(const char **args, svn_ra_svn_conn_t **conn,
                                   svn_stream_from_aprfile2(proc->in, FALSE,
                                                            pool),
                                   SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
-                                  0, 0, 0, 0, pool);
+                                  0, SVN_RA_SVN__ERROR_CHECK_INTERVAL,
+                                  0, 0, pool);
   err = svn_ra_svn__skip_leading_garbage(*conn, pool);
   if (err)
     return svn_error_quick_wrap(
@@ -683,7 +864,8 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
 
           conn = svn_ra_svn_create_conn5(NULL, td->response, td->request,
                                          SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
-                                         0, 0, 0, 0, pool);
+                                         0, SVN_RA_SVN__ERROR_CHECK_INTERVAL,
+                                         0, 0, pool);
           SVN_ERR(svn_ra_svn__skip_leading_garbage(conn, pool));
         }
     }
@@ -697,7 +879,8 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
                               &sock, pool));
       conn = svn_ra_svn_create_conn5(sock, NULL, NULL,
                                      SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
-                                     0, 0, 0, 0, pool);
+                                     0, SVN_RA_SVN__ERROR_CHECK_INTERVAL,
+                                     0, 0, pool);
     }
 
   /* Build the useragent string, querying the client for any
@@ -747,15 +930,27 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
    * capability list, and the URL, and subsequently there is an auth
    * request. */
   /* Client-side capabilities list: */
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww)cc(?c)",
+  /* Only advertise accepts-svndiff3 if this build can decode it, i.e.
+   * if it has been compiled against zstd. */
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool,
+#ifdef SVN_HAVE_ZSTD
+                                  "n(wwwwwwwwww)cc(?c)",
+#else
+                                  "n(wwwwwwwww)cc(?c)",
+#endif
                                   (apr_uint64_t) 2,
                                   SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                   SVN_RA_SVN_CAP_SVNDIFF1,
                                   SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+#ifdef SVN_HAVE_ZSTD
+                                  SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED,
+#endif
                                   SVN_RA_SVN_CAP_ABSENT_ENTRIES,
                                   SVN_RA_SVN_CAP_DEPTH,
                                   SVN_RA_SVN_CAP_MERGEINFO,
                                   SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                  SVN_RA_SVN_CAP_AUTH_TICKET,
+                                  SVN_RA_SVN_CAP_CHANGE_NODE_PROPS,
                                   url,
                                   SVN_RA_SVN__DEFAULT_USERAGENT,
                                   client_string));
@@ -3288,6 +3483,122 @@ static svn_error_t *ra_svn_fetch_file_contents(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *ra_svn_get_files(svn_ra_session_t *session,
+                                     const apr_array_header_t *paths,
+                                     svn_revnum_t rev,
+                                     svn_ra__open_file_stream_cb_t open_stream_func,
+                                     void *open_stream_baton,
+                                     apr_pool_t *pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool;
+  int i;
+
+  if (!svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_GET_FILES))
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support the get-files "
+                              "command"));
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w((!", "get-files"));
+  for (i = 0; i < paths->nelts; i++)
+    SVN_ERR(svn_ra_svn__write_cstring(conn, pool,
+                                      reparent_path(session,
+                                                    APR_ARRAY_IDX(paths, i,
+                                                                  const char *),
+                                                    pool)));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)(?r))", rev));
+
+  SVN_ERR(handle_auth_request(sess_baton, pool));
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "r", &rev));
+
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      svn_ra_svn__item_t *item;
+      const char *expected_digest;
+      svn_checksum_t *expected_checksum = NULL;
+      svn_checksum_ctx_t *checksum_ctx = NULL;
+      svn_stream_t *stream;
+      apr_pool_t *chunk_pool;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
+
+      /* The server might have encountered some sort of fatal error in
+         the middle of the file list.  If this happens, it will transmit
+         "done" to end the list early, and then the overall command
+         response will talk about the fatal error. */
+      if (is_done_response(item))
+        break;
+
+      if (item->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("File entry is not a list"));
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "c", &expected_digest));
+
+      SVN_ERR(svn_checksum_parse_hex(&expected_checksum, svn_checksum_md5,
+                                     expected_digest, iterpool));
+      checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5, iterpool);
+
+      SVN_ERR(open_stream_func(&stream, open_stream_baton,
+                               APR_ARRAY_IDX(paths, i, const char *),
+                               iterpool));
+
+      /* Read the file's contents. */
+      chunk_pool = svn_pool_create(iterpool);
+      while (1)
+        {
+          svn_ra_svn__item_t *chunk;
+
+          svn_pool_clear(chunk_pool);
+          SVN_ERR(svn_ra_svn__read_item(conn, chunk_pool, &chunk));
+          if (chunk->kind != SVN_RA_SVN_STRING)
+            return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                    _("Non-string as part of file contents"));
+          if (chunk->u.string.len == 0)
+            break;
+
+          SVN_ERR(svn_checksum_update(checksum_ctx, chunk->u.string.data,
+                                      chunk->u.string.len));
+          SVN_ERR(svn_stream_write(stream, chunk->u.string.data,
+                                   &chunk->u.string.len));
+        }
+      svn_pool_destroy(chunk_pool);
+
+      SVN_ERR(svn_stream_close(stream));
+
+      if (expected_checksum)
+        {
+          svn_checksum_t *checksum;
+
+          SVN_ERR(svn_checksum_final(&checksum, checksum_ctx, iterpool));
+          if (!svn_checksum_match(checksum, expected_checksum))
+            return svn_checksum_mismatch_err(
+                     expected_checksum, checksum, iterpool,
+                     _("Checksum mismatch for '%s'"),
+                     APR_ARRAY_IDX(paths, i, const char *));
+        }
+    }
+
+  /* If the list was not ended early, read the trailing "done". */
+  if (i == paths->nelts)
+    {
+      svn_ra_svn__item_t *item;
+
+      SVN_ERR(svn_ra_svn__read_item(conn, pool, &item));
+      if (!is_done_response(item))
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Didn't receive end marker for file "
+                                  "entries"));
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, ""));
+
+  return SVN_NO_ERROR;
+}
+
 static const svn_ra__vtable_t ra_svn_vtable = {
   svn_ra_svn_version,
   ra_svn_get_description,
@@ -3329,6 +3640,7 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   NULL /* ra_set_svn_ra_open */,
   ra_svn_list,
   ra_svn_fetch_file_contents,
+  ra_svn_get_files,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
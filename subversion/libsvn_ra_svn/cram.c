@@ -131,9 +131,93 @@ static apr_status_t make_nonce(apr_uint64_t *nonce)
 #endif
 }
 
-svn_error_t *svn_ra_svn_cram_server(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
-                                    svn_config_t *pwdb, const char **user,
-                                    svn_boolean_t *success)
+svn_error_t *
+svn_ra_svn__make_auth_secret(const char **secret, apr_pool_t *pool)
+{
+  apr_uint64_t nonces[4];
+  apr_size_t i;
+
+  for (i = 0; i < sizeof(nonces) / sizeof(nonces[0]); i++)
+    {
+      apr_status_t status = make_nonce(&nonces[i]);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't create secret"));
+    }
+
+  *secret = apr_psprintf(pool,
+                         "%016" APR_UINT64_T_HEX_FMT
+                         "%016" APR_UINT64_T_HEX_FMT
+                         "%016" APR_UINT64_T_HEX_FMT
+                         "%016" APR_UINT64_T_HEX_FMT,
+                         nonces[0], nonces[1], nonces[2], nonces[3]);
+
+  return SVN_NO_ERROR;
+}
+
+const char *
+svn_ra_svn__make_auth_ticket(const char *user, const char *realm,
+                             const char *secret, apr_time_t expiry,
+                             apr_pool_t *pool)
+{
+  const char *text = apr_psprintf(pool, "%s\n%s\n%" APR_TIME_T_FMT,
+                                  realm, user, expiry);
+  unsigned char digest[APR_MD5_DIGESTSIZE];
+  char hex[2 * APR_MD5_DIGESTSIZE + 1];
+
+  /* HMAC-MD5 over the ticket contents, keyed with the server secret. */
+  compute_digest(digest, text, secret);
+  hex_encode(hex, digest);
+  hex[sizeof(hex) - 1] = '\0';
+
+  return apr_psprintf(pool, "%s %" APR_TIME_T_FMT " %s", user, expiry, hex);
+}
+
+svn_boolean_t
+svn_ra_svn__check_auth_ticket(const char **user, const char *ticket,
+                              const char *realm, const char *secret,
+                              apr_pool_t *pool)
+{
+  const char *mac_sep, *exp_sep, *head;
+  apr_time_t expiry;
+
+  *user = NULL;
+
+  /* Split "USER EXPIRY MAC" from the right, since USER may contain
+   * spaces. */
+  mac_sep = strrchr(ticket, ' ');
+  if (!mac_sep)
+    return FALSE;
+  head = apr_pstrmemdup(pool, ticket, mac_sep - ticket);
+  exp_sep = strrchr(head, ' ');
+  if (!exp_sep)
+    return FALSE;
+
+  expiry = (apr_time_t)apr_atoi64(exp_sep + 1);
+  if (expiry <= apr_time_now())
+    return FALSE;
+
+  *user = apr_pstrmemdup(pool, head, exp_sep - head);
+
+  /* Re-create the ticket we would have issued for these contents; any
+   * forgery or corruption makes the MACs differ. */
+  if (strcmp(ticket, svn_ra_svn__make_auth_ticket(*user, realm, secret,
+                                                  expiry, pool)) != 0)
+    {
+      *user = NULL;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+svn_error_t *
+svn_ra_svn__cram_server2(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
+                         svn_config_t *pwdb,
+                         const char *ticket_secret,
+                         const char *realm,
+                         apr_time_t ticket_lifetime,
+                         const char **user,
+                         svn_boolean_t *success)
 {
   apr_status_t status;
   apr_uint64_t nonce;
@@ -176,17 +260,40 @@ svn_error_t *svn_ra_svn_cram_server(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
     return fail(conn, pool, "Password incorrect");
 
   *success = TRUE;
+
+  /* Clients which understand tickets get one with the success
+   * notification so that they may skip this exchange next time. */
+  if (ticket_secret)
+    {
+      const char *ticket
+        = svn_ra_svn__make_auth_ticket(*user, realm, ticket_secret,
+                                       apr_time_now() + ticket_lifetime,
+                                       pool);
+      return svn_ra_svn__write_tuple(conn, pool, "w(c)", "success", ticket);
+    }
+
   return svn_ra_svn__write_tuple(conn, pool, "w()", "success");
 }
 
+svn_error_t *svn_ra_svn_cram_server(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
+                                    svn_config_t *pwdb, const char **user,
+                                    svn_boolean_t *success)
+{
+  return svn_error_trace(svn_ra_svn__cram_server2(conn, pool, pwdb, NULL,
+                                                  NULL, 0, user, success));
+}
+
 svn_error_t *svn_ra_svn__cram_client(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                      const char *user, const char *password,
+                                     const char **ticket,
                                      const char **message)
 {
   const char *status, *str, *reply;
   unsigned char digest[APR_MD5_DIGESTSIZE];
   char hex[2 * APR_MD5_DIGESTSIZE + 1];
 
+  *ticket = NULL;
+
   /* Read the server challenge. */
   SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "w(?c)", &status, &str));
   if (strcmp(status, "failure") == 0 && str)
@@ -205,17 +312,20 @@ svn_error_t *svn_ra_svn__cram_client(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   reply = apr_psprintf(pool, "%s %s", user, hex);
   SVN_ERR(svn_ra_svn__write_cstring(conn, pool, reply));
 
-  /* Read the success or failure response from the server. */
+  /* Read the success or failure response from the server.  Servers
+   * which support resumption tickets attach one to the success
+   * notification; see SVN_RA_SVN_CAP_AUTH_TICKET. */
   SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "w(?c)", &status, &str));
   if (strcmp(status, "failure") == 0 && str)
     {
       *message = str;
       return SVN_NO_ERROR;
     }
-  else if (strcmp(status, "success") != 0 || str)
+  else if (strcmp(status, "success") != 0)
     return svn_error_create(SVN_ERR_RA_NOT_AUTHORIZED, NULL,
                             _("Unexpected server response to authentication"));
 
+  *ticket = str;
   *message = NULL;
   return SVN_NO_ERROR;
 }
@@ -33,6 +33,7 @@
 #include "svn_string.h"
 #include "svn_error.h"
 #include "svn_delta.h"
+#include "svn_props.h"
 #include "svn_dirent_uri.h"
 #include "svn_ra_svn.h"
 #include "svn_path.h"
@@ -56,12 +57,32 @@
  * connection; both ends are useful for both server and client.
  */
 
+/* Maximum number of property changes accumulated for a single node
+ * before the batch gets sent, bounding the driver's memory usage. */
+#define MAX_PROP_BATCH 1000
+
+/* Prop values larger than this bypass the batch queue and get written
+ * to the wire directly, because queueing would have to copy them into
+ * the batch pool first. */
+#define MAX_BATCHED_PROP_SIZE 0x10000
+
 typedef struct ra_svn_edit_baton_t {
   svn_ra_svn_conn_t *conn;
   svn_ra_svn_edit_callback callback;    /* Called on successful completion. */
   void *callback_baton;
   apr_uint64_t next_token;
   svn_boolean_t got_status;
+
+  /* If set, the peer understands the change-node-props command and
+   * consecutive prop changes on one node get coalesced into it. */
+  svn_boolean_t batch_props;
+
+  /* Node that the pending prop change batch applies to, or NULL if no
+   * batch is pending.  Allocated in BATCH_POOL, like the batch itself. */
+  svn_string_t *batch_token;
+  svn_boolean_t batch_is_file;
+  apr_array_header_t *batch;            /* svn_prop_t elements */
+  apr_pool_t *batch_pool;               /* cleared after each flush */
 } ra_svn_edit_baton_t;
 
 /* Works for both directories and files. */
@@ -173,12 +194,109 @@ check_for_error(ra_svn_edit_baton_t *eb, apr_pool_t *pool)
     : SVN_NO_ERROR;
 }
 
+/* Send the prop changes accumulated in EB's batch, if any, and reset
+ * the batch.  This must be called before any other editor command gets
+ * written, so that the command order on the wire matches the call order.
+ * Use POOL for temporary allocations. */
+static svn_error_t *
+flush_prop_batch(ra_svn_edit_baton_t *eb, apr_pool_t *pool)
+{
+  if (!eb->batch_token)
+    return SVN_NO_ERROR;
+
+  if (eb->batch->nelts == 1)
+    {
+      /* The batch command has no advantage for a single change; stick
+       * to the classic commands in that case. */
+      const svn_prop_t *prop = &APR_ARRAY_IDX(eb->batch, 0, svn_prop_t);
+
+      if (eb->batch_is_file)
+        SVN_ERR(svn_ra_svn__write_cmd_change_file_prop(eb->conn, pool,
+                                                       eb->batch_token,
+                                                       prop->name,
+                                                       prop->value));
+      else
+        SVN_ERR(svn_ra_svn__write_cmd_change_dir_prop(eb->conn, pool,
+                                                      eb->batch_token,
+                                                      prop->name,
+                                                      prop->value));
+    }
+  else
+    {
+      SVN_ERR(svn_ra_svn__write_cmd_change_node_props(eb->conn, pool,
+                                                      eb->batch_token,
+                                                      eb->batch));
+    }
+
+  eb->batch_token = NULL;
+  eb->batch = NULL;
+  svn_pool_clear(eb->batch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Queue the prop change NAME = VALUE (which may be NULL) for the node
+ * identified by B's token, flushing any batch that accumulated for a
+ * different node first.  IS_FILE tells file and dir tokens apart.
+ * Use POOL for temporary allocations. */
+static svn_error_t *
+queue_prop_change(ra_svn_baton_t *b,
+                  svn_boolean_t is_file,
+                  const char *name,
+                  const svn_string_t *value,
+                  apr_pool_t *pool)
+{
+  ra_svn_edit_baton_t *eb = b->eb;
+  svn_prop_t *prop;
+
+  /* Queueing copies the value into BATCH_POOL because the editor
+   * contract only keeps it alive for the duration of this call.  For
+   * large values that defensive copy costs more than the batching
+   * saves, so flush whatever is queued and serialize such changes to
+   * the wire straight from the caller's buffer. */
+  if (value && value->len > MAX_BATCHED_PROP_SIZE)
+    {
+      SVN_ERR(flush_prop_batch(eb, pool));
+
+      if (is_file)
+        SVN_ERR(svn_ra_svn__write_cmd_change_file_prop(b->conn, pool,
+                                                       b->token, name,
+                                                       value));
+      else
+        SVN_ERR(svn_ra_svn__write_cmd_change_dir_prop(b->conn, pool,
+                                                      b->token, name,
+                                                      value));
+      return SVN_NO_ERROR;
+    }
+
+  if (eb->batch_token && !svn_string_compare(eb->batch_token, b->token))
+    SVN_ERR(flush_prop_batch(eb, pool));
+
+  if (!eb->batch_token)
+    {
+      eb->batch_token = svn_string_dup(b->token, eb->batch_pool);
+      eb->batch_is_file = is_file;
+      eb->batch = apr_array_make(eb->batch_pool, 16, sizeof(svn_prop_t));
+    }
+
+  prop = &APR_ARRAY_PUSH(eb->batch, svn_prop_t);
+  prop->name = apr_pstrdup(eb->batch_pool, name);
+  prop->value = value ? svn_string_dup(value, eb->batch_pool) : NULL;
+
+  /* Bound the memory usage during huge property sweeps. */
+  if (eb->batch->nelts >= MAX_PROP_BATCH)
+    SVN_ERR(flush_prop_batch(eb, pool));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *ra_svn_target_rev(void *edit_baton, svn_revnum_t rev,
                                       apr_pool_t *pool)
 {
   ra_svn_edit_baton_t *eb = edit_baton;
 
   SVN_ERR(check_for_error(eb, pool));
+  SVN_ERR(flush_prop_batch(eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_target_rev(eb->conn, pool, rev));
   return SVN_NO_ERROR;
 }
@@ -190,6 +308,7 @@ static svn_error_t *ra_svn_open_root(void *edit_baton, svn_revnum_t rev,
   svn_string_t *token = make_token('d', eb, pool);
 
   SVN_ERR(check_for_error(eb, pool));
+  SVN_ERR(flush_prop_batch(eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_open_root(eb->conn, pool, rev, token));
   *root_baton = ra_svn_make_baton(eb->conn, pool, eb, token);
   return SVN_NO_ERROR;
@@ -201,6 +320,7 @@ static svn_error_t *ra_svn_delete_entry(const char *path, svn_revnum_t rev,
   ra_svn_baton_t *b = parent_baton;
 
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_delete_entry(b->conn, pool,
                                              path, rev, b->token));
   return SVN_NO_ERROR;
@@ -217,6 +337,7 @@ static svn_error_t *ra_svn_add_dir(const char *path, void *parent_baton,
   SVN_ERR_ASSERT((copy_path && SVN_IS_VALID_REVNUM(copy_rev))
                  || (!copy_path && !SVN_IS_VALID_REVNUM(copy_rev)));
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_add_dir(b->conn, pool, path, b->token,
                                         token, copy_path, copy_rev));
   *child_baton = ra_svn_make_baton(b->conn, pool, b->eb, token);
@@ -231,6 +352,7 @@ static svn_error_t *ra_svn_open_dir(const char *path, void *parent_baton,
   svn_string_t *token = make_token('d', b->eb, pool);
 
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_open_dir(b->conn, pool, path, b->token,
                                          token, rev));
   *child_baton = ra_svn_make_baton(b->conn, pool, b->eb, token);
@@ -244,6 +366,9 @@ static svn_error_t *ra_svn_change_dir_prop(void *dir_baton, const char *name,
   ra_svn_baton_t *b = dir_baton;
 
   SVN_ERR(check_for_error(b->eb, pool));
+  if (b->eb->batch_props)
+    return svn_error_trace(queue_prop_change(b, FALSE, name, value, pool));
+
   SVN_ERR(svn_ra_svn__write_cmd_change_dir_prop(b->conn, pool, b->token,
                                                 name, value));
   return SVN_NO_ERROR;
@@ -254,6 +379,7 @@ static svn_error_t *ra_svn_close_dir(void *dir_baton, apr_pool_t *pool)
   ra_svn_baton_t *b = dir_baton;
 
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_close_dir(b->conn, pool, b->token));
   return SVN_NO_ERROR;
 }
@@ -269,6 +395,7 @@ static svn_error_t *ra_svn_absent_dir(const char *path,
     return SVN_NO_ERROR;
 
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_absent_dir(b->conn, pool, path, b->token));
   return SVN_NO_ERROR;
 }
@@ -286,6 +413,7 @@ static svn_error_t *ra_svn_add_file(const char *path,
   SVN_ERR_ASSERT((copy_path && SVN_IS_VALID_REVNUM(copy_rev))
                  || (!copy_path && !SVN_IS_VALID_REVNUM(copy_rev)));
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_add_file(b->conn, pool,  path, b->token,
                                          token, copy_path, copy_rev));
   *file_baton = ra_svn_make_baton(b->conn, pool, b->eb, token);
@@ -302,6 +430,7 @@ static svn_error_t *ra_svn_open_file(const char *path,
   svn_string_t *token = make_token('c', b->eb, pool);
 
   SVN_ERR(check_for_error(b->eb, b->pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_open_file(b->conn, pool, path, b->token,
                                           token, rev));
   *file_baton = ra_svn_make_baton(b->conn, pool, b->eb, token);
@@ -315,6 +444,7 @@ static svn_error_t *ra_svn_svndiff_handler(void *baton, const char *data,
   svn_string_t str;
 
   SVN_ERR(check_for_error(b->eb, b->pool));
+  SVN_ERR(flush_prop_batch(b->eb, b->pool));
   str.data = data;
   str.len = *len;
   return svn_ra_svn__write_cmd_textdelta_chunk(b->conn, b->pool,
@@ -326,6 +456,7 @@ static svn_error_t *ra_svn_svndiff_close_handler(void *baton)
   ra_svn_baton_t *b = baton;
 
   SVN_ERR(check_for_error(b->eb, b->pool));
+  SVN_ERR(flush_prop_batch(b->eb, b->pool));
   SVN_ERR(svn_ra_svn__write_cmd_textdelta_end(b->conn, b->pool, b->token));
   return SVN_NO_ERROR;
 }
@@ -341,6 +472,7 @@ static svn_error_t *ra_svn_apply_textdelta(void *file_baton,
 
   /* Tell the other side we're starting a text delta. */
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_apply_textdelta(b->conn, pool, b->token,
                                                 base_checksum));
 
@@ -365,6 +497,9 @@ static svn_error_t *ra_svn_change_file_prop(void *file_baton,
   ra_svn_baton_t *b = file_baton;
 
   SVN_ERR(check_for_error(b->eb, pool));
+  if (b->eb->batch_props)
+    return svn_error_trace(queue_prop_change(b, TRUE, name, value, pool));
+
   SVN_ERR(svn_ra_svn__write_cmd_change_file_prop(b->conn, pool,
                                                  b->token, name, value));
   return SVN_NO_ERROR;
@@ -377,6 +512,7 @@ static svn_error_t *ra_svn_close_file(void *file_baton,
   ra_svn_baton_t *b = file_baton;
 
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_close_file(b->conn, pool,
                                            b->token, text_checksum));
   return SVN_NO_ERROR;
@@ -393,6 +529,7 @@ static svn_error_t *ra_svn_absent_file(const char *path,
     return SVN_NO_ERROR;
 
   SVN_ERR(check_for_error(b->eb, pool));
+  SVN_ERR(flush_prop_batch(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_absent_file(b->conn, pool, path, b->token));
   return SVN_NO_ERROR;
 }
@@ -404,6 +541,7 @@ static svn_error_t *ra_svn_close_edit(void *edit_baton, apr_pool_t *pool)
 
   SVN_ERR_ASSERT(!eb->got_status);
   eb->got_status = TRUE;
+  SVN_ERR(flush_prop_batch(eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_close_edit(eb->conn, pool));
   err = svn_error_trace(svn_ra_svn__read_cmd_response(eb->conn, pool, ""));
   if (err)
@@ -424,6 +562,7 @@ static svn_error_t *ra_svn_abort_edit(void *edit_baton, apr_pool_t *pool)
 
   if (eb->got_status)
     return SVN_NO_ERROR;
+  SVN_ERR(flush_prop_batch(eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_abort_edit(eb->conn, pool));
   SVN_ERR(svn_ra_svn__read_cmd_response(eb->conn, pool, ""));
   return SVN_NO_ERROR;
@@ -444,6 +583,11 @@ void svn_ra_svn_get_editor(const svn_delta_editor_t **editor,
   eb->callback_baton = callback_baton;
   eb->next_token = 0;
   eb->got_status = FALSE;
+  eb->batch_props = svn_ra_svn_has_capability(conn,
+                                              SVN_RA_SVN_CAP_CHANGE_NODE_PROPS);
+  eb->batch_token = NULL;
+  eb->batch = NULL;
+  eb->batch_pool = svn_pool_create(pool);
 
   ra_svn_editor->set_target_revision = ra_svn_target_rev;
   ra_svn_editor->open_root = ra_svn_open_root;
@@ -657,6 +801,59 @@ ra_svn_handle_change_dir_prop(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+ra_svn_handle_change_node_props(svn_ra_svn_conn_t *conn,
+                                apr_pool_t *pool,
+                                const svn_ra_svn__list_t *params,
+                                ra_svn_driver_state_t *ds)
+{
+  svn_string_t *token;
+  svn_ra_svn__list_t *prop_list;
+  ra_svn_token_entry_t *entry;
+  apr_pool_t *iterpool;
+  int i;
+
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "sl", &token, &prop_list));
+
+  /* The token may identify either a file or a directory, so we cannot
+   * use lookup_token() with its is_file cross-check here. */
+  if (ds->last_token && svn_string_compare(ds->last_token->token, token))
+    entry = ds->last_token;
+  else
+    {
+      entry = apr_hash_get(ds->tokens, token->data, token->len);
+      ds->last_token = entry;
+    }
+  if (!entry)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Invalid file or dir token during edit"));
+
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < prop_list->nelts; ++i)
+    {
+      svn_ra_svn__item_t *elt = &SVN_RA_SVN__LIST_ITEM(prop_list, i);
+      const char *name;
+      svn_string_t *value;
+
+      if (elt->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Prop change is not a list"));
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__parse_tuple(&elt->u.list, "c(?s)", &name, &value));
+
+      if (entry->is_file)
+        SVN_CMD_ERR(ds->editor->change_file_prop(entry->baton, name, value,
+                                                 iterpool));
+      else
+        SVN_CMD_ERR(ds->editor->change_dir_prop(entry->baton, name, value,
+                                                entry->pool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 ra_svn_handle_close_dir(svn_ra_svn_conn_t *conn,
                         apr_pool_t *pool,
@@ -952,6 +1149,7 @@ static const struct {
   { "add-dir",          ra_svn_handle_add_dir },
   { "open-dir",         ra_svn_handle_open_dir },
   { "change-dir-prop",  ra_svn_handle_change_dir_prop },
+  { "change-node-props", ra_svn_handle_change_node_props },
   { "delete-entry",     ra_svn_handle_delete_entry },
   { "close-dir",        ra_svn_handle_close_dir },
   { "absent-dir",       ra_svn_handle_absent_dir },
@@ -1107,7 +1305,12 @@ svn_error_t *svn_ra_svn_drive_editor2(svn_ra_svn_conn_t *conn,
       if (editor)
         {
           cmd_handler_t handler;
-          SVN_ERR(svn_ra_svn__read_tuple(conn, subpool, "wl", &cmd, &params));
+
+          /* Editor commands are parsed in borrowed mode: the handlers
+           * (and the editor functions they call) copy whatever they
+           * retain, so most strings can stay in the read buffer. */
+          SVN_ERR(svn_ra_svn__read_tuple_borrowed(conn, subpool, "wl",
+                                                  &cmd, &params));
           handler = cmd_lookup(cmd);
 
           if (handler)
@@ -1193,7 +1396,8 @@ svn_error_t *svn_ra_svn_drive_editor2(svn_ra_svn_conn_t *conn,
   while (!state.done)
     {
       svn_pool_clear(subpool);
-      err = svn_ra_svn__read_tuple(conn, subpool, "wl", &cmd, &params);
+      err = svn_ra_svn__read_tuple_borrowed(conn, subpool, "wl",
+                                            &cmd, &params);
       if (err && err->apr_err == SVN_ERR_RA_SVN_CONNECTION_CLOSED)
         {
           /* Other side disconnected; that's no error. */
@@ -29,14 +29,97 @@
 #include <apr_general.h>
 #include <apr_strings.h>
 
+#include <apr_hash.h>
+
 #include "svn_types.h"
 #include "svn_string.h"
 #include "svn_error.h"
+#include "svn_pools.h"
 #include "svn_ra.h"
 #include "svn_ra_svn.h"
 
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+
 #include "ra_svn.h"
 
+/* Process-global cache of authentication resumption tickets, keyed by
+   realmstring.  Tickets let us skip the challenge-response exchange on
+   subsequent connections to the same server; see the "auth-ticket"
+   capability.  The cache pool grows a little with every update, but
+   clients hold tickets for very few realms. */
+static volatile svn_atomic_t ticket_cache_state = 0;
+static apr_pool_t *ticket_cache_pool = NULL;
+static svn_mutex__t *ticket_cache_mutex = NULL;
+static apr_hash_t *ticket_cache = NULL;
+
+/* Implements svn_atomic__err_init_func_t, setting up the ticket cache. */
+static svn_error_t *
+init_ticket_cache(void *baton, apr_pool_t *pool)
+{
+  ticket_cache_pool = svn_pool_create(NULL);
+  SVN_ERR(svn_mutex__init(&ticket_cache_mutex, TRUE, ticket_cache_pool));
+  ticket_cache = apr_hash_make(ticket_cache_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Core of get_cached_ticket(), to be called with the cache mutex held. */
+static svn_error_t *
+get_cached_ticket_locked(const char **ticket,
+                         const char *realmstring,
+                         apr_pool_t *pool)
+{
+  const char *cached = apr_hash_get(ticket_cache, realmstring,
+                                    APR_HASH_KEY_STRING);
+  *ticket = cached ? apr_pstrdup(pool, cached) : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *TICKET to the cached resumption ticket for REALMSTRING, allocated
+   in POOL, or to NULL if we don't hold one. */
+static svn_error_t *
+get_cached_ticket(const char **ticket,
+                  const char *realmstring,
+                  apr_pool_t *pool)
+{
+  SVN_ERR(svn_atomic__init_once(&ticket_cache_state, init_ticket_cache,
+                                NULL, pool));
+  SVN_MUTEX__WITH_LOCK(ticket_cache_mutex,
+                       get_cached_ticket_locked(ticket, realmstring, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Core of set_cached_ticket(), to be called with the cache mutex held. */
+static svn_error_t *
+set_cached_ticket_locked(const char *realmstring,
+                         const char *ticket)
+{
+  apr_hash_set(ticket_cache,
+               apr_pstrdup(ticket_cache_pool, realmstring),
+               APR_HASH_KEY_STRING,
+               ticket ? apr_pstrdup(ticket_cache_pool, ticket) : NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* Remember TICKET as the resumption ticket for REALMSTRING, replacing
+   any previous one.  TICKET may be NULL to forget a rejected ticket. */
+static svn_error_t *
+set_cached_ticket(const char *realmstring,
+                  const char *ticket,
+                  apr_pool_t *pool)
+{
+  SVN_ERR(svn_atomic__init_once(&ticket_cache_state, init_ticket_cache,
+                                NULL, pool));
+  SVN_MUTEX__WITH_LOCK(ticket_cache_mutex,
+                       set_cached_ticket_locked(realmstring, ticket));
+
+  return SVN_NO_ERROR;
+}
+
 svn_boolean_t svn_ra_svn__find_mech(const svn_ra_svn__list_t *mechlist,
                                     const char *mech)
 {
@@ -67,6 +150,26 @@ static svn_error_t *read_success(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Read the server's response to a TICKET authentication attempt.  Set
+   *ACCEPTED to TRUE on success and to FALSE if the server rejected the
+   ticket, in which case the exchange remains open for another mech. */
+static svn_error_t *read_ticket_response(svn_boolean_t *accepted,
+                                         svn_ra_svn_conn_t *conn,
+                                         apr_pool_t *pool)
+{
+  const char *status, *arg;
+
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "w(?c)", &status, &arg));
+  if (strcmp(status, "success") == 0)
+    *accepted = TRUE;
+  else if (strcmp(status, "failure") == 0)
+    *accepted = FALSE;
+  else
+    return svn_error_create(SVN_ERR_RA_NOT_AUTHORIZED, NULL,
+                            _("Unexpected server response to authentication"));
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__do_internal_auth(svn_ra_svn__session_baton_t *sess,
                              const svn_ra_svn__list_t *mechlist,
@@ -93,6 +196,30 @@ svn_ra_svn__do_internal_auth(svn_ra_svn__session_baton_t *sess,
     }
   else if (svn_ra_svn__find_mech(mechlist, "CRAM-MD5"))
     {
+      const char *ticket;
+
+      /* If the server supports session resumption and we still hold a
+         ticket for this realm from an earlier connection, try it before
+         falling back to the full challenge-response exchange. */
+      if (svn_ra_svn__find_mech(mechlist, "TICKET"))
+        {
+          SVN_ERR(get_cached_ticket(&ticket, realmstring, pool));
+          if (ticket)
+            {
+              svn_boolean_t accepted;
+
+              SVN_ERR(svn_ra_svn__auth_response(conn, pool, "TICKET",
+                                                ticket));
+              SVN_ERR(read_ticket_response(&accepted, conn, pool));
+              if (accepted)
+                return SVN_NO_ERROR;
+
+              /* Expired, or voided by a server restart; forget it and
+                 authenticate from scratch. */
+              SVN_ERR(set_cached_ticket(realmstring, NULL, pool));
+            }
+        }
+
       SVN_ERR(svn_auth_first_credentials(&creds, &iterstate,
                                          SVN_AUTH_CRED_SIMPLE, realmstring,
                                          sess->auth_baton, pool));
@@ -104,7 +231,8 @@ svn_ra_svn__do_internal_auth(svn_ra_svn__session_baton_t *sess,
           user = ((svn_auth_cred_simple_t *) creds)->username;
           password = ((svn_auth_cred_simple_t *) creds)->password;
           SVN_ERR(svn_ra_svn__auth_response(conn, pool, "CRAM-MD5", NULL));
-          SVN_ERR(svn_ra_svn__cram_client(conn, pool, user, password, &msg));
+          SVN_ERR(svn_ra_svn__cram_client(conn, pool, user, password,
+                                          &ticket, &msg));
           if (!msg)
             break;
           SVN_ERR(svn_auth_next_credentials(&creds, iterstate, pool));
@@ -114,6 +242,11 @@ svn_ra_svn__do_internal_auth(svn_ra_svn__session_baton_t *sess,
                                 _("Authentication error from server: %s"),
                                 msg);
       SVN_ERR(svn_auth_save_credentials(iterstate, pool));
+
+      /* Remember the resumption ticket, if the server issued one, so
+         that future connections can skip the exchange above. */
+      if (ticket)
+        SVN_ERR(set_cached_ticket(realmstring, ticket, pool));
       return SVN_NO_ERROR;
     }
   else
@@ -38,6 +38,7 @@
 #include "svn_error.h"
 #include "svn_pools.h"
 #include "svn_ra_svn.h"
+#include "svn_props.h"
 #include "svn_private_config.h"
 #include "svn_ctype.h"
 #include "svn_sorts.h"
@@ -48,6 +49,8 @@
 #include "private/svn_string_private.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_error_private.h"
+#include "private/svn_perf_private.h"
+#include "private/svn_probes_private.h"
 #include "private/svn_subr_private.h"
 
 #define svn_iswhitespace(c) ((c) == ' ' || (c) == '\n')
@@ -200,9 +203,17 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
   conn->encrypted = FALSE;
 #endif
   conn->session = NULL;
+  conn->read_buf = apr_palloc(result_pool, SVN_RA_SVN__READBUF_SIZE);
+  conn->read_size = SVN_RA_SVN__READBUF_SIZE;
+  conn->read_fetch_size = SVN_RA_SVN__READBUF_SIZE;
   conn->read_ptr = conn->read_buf;
   conn->read_end = conn->read_buf;
+  conn->write_buf = apr_palloc(result_pool, SVN_RA_SVN__WRITEBUF_SIZE);
+  conn->write_size = SVN_RA_SVN__WRITEBUF_SIZE;
   conn->write_pos = 0;
+  conn->pending_borrows = NULL;
+  conn->borrow_pool = NULL;
+  conn->borrow_reads = FALSE;
   conn->written_since_error_check = 0;
   conn->error_check_interval = error_check_interval;
   conn->may_check_for_error = error_check_interval == 0;
@@ -212,6 +223,8 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
   conn->current_out = 0;
   conn->block_handler = NULL;
   conn->block_baton = NULL;
+  conn->command_hook = NULL;
+  conn->command_hook_baton = NULL;
   conn->capabilities = apr_hash_make(result_pool);
   conn->compression_level = compression_level;
   conn->zero_copy_limit = zero_copy_limit;
@@ -273,6 +286,12 @@ svn_ra_svn__svndiff_version(svn_ra_svn_conn_t *conn)
   if (svn_ra_svn_compression_level(conn) <= 0)
     return 0;
 
+#ifdef SVN_HAVE_ZSTD
+  /* Prefer SVNDIFF3, but only if this build can actually produce it. */
+  if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED))
+    return 3;
+#endif
+
   /* Prefer SVNDIFF2 over SVNDIFF1. */
   if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED))
     return 2;
@@ -330,6 +349,15 @@ svn_ra_svn__set_block_handler(svn_ra_svn_conn_t *conn,
   svn_ra_svn__stream_timeout(conn->stream, get_timeout(conn));
 }
 
+void
+svn_ra_svn__set_command_hook(svn_ra_svn_conn_t *conn,
+                             svn_ra_svn__command_hook_t hook,
+                             void *baton)
+{
+  conn->command_hook = hook;
+  conn->command_hook_baton = baton;
+}
+
 svn_error_t *svn_ra_svn__data_available(svn_ra_svn_conn_t *conn,
                                        svn_boolean_t *data_available)
 {
@@ -416,14 +444,104 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   return SVN_NO_ERROR;
 }
 
+/* Write the NVEC data blocks in VEC to the socket or output file as
+   appropriate, as if by consecutive writebuf_output() calls, but with a
+   single vectored write per attempt where the underlying stream
+   supports it.  VEC gets modified as the data is being consumed. */
+static svn_error_t *writebuf_output_vec(svn_ra_svn_conn_t *conn,
+                                        apr_pool_t *pool,
+                                        svn_string_t *vec,
+                                        apr_size_t nvec)
+{
+  apr_size_t total = 0;
+  apr_size_t count;
+  apr_pool_t *subpool = NULL;
+  svn_ra_svn__session_baton_t *session = conn->session;
+  apr_size_t i;
+
+  for (i = 0; i < nvec; ++i)
+    total += vec[i].len;
+
+  /* Limit the size of the response, if a limit has been configured. */
+  conn->current_out += total;
+  SVN_ERR(check_io_limits(conn));
+
+  while (nvec > 0)
+    {
+      apr_size_t remaining;
+
+      if (session && session->callbacks && session->callbacks->cancel_func)
+        SVN_ERR((session->callbacks->cancel_func)(session->callbacks_baton));
+
+      SVN_ERR(svn_ra_svn__stream_writev(conn->stream, vec, nvec, &count));
+      if (count == 0)
+        {
+          if (!subpool)
+            subpool = svn_pool_create(pool);
+          else
+            svn_pool_clear(subpool);
+          SVN_ERR(conn->block_handler(conn, subpool, conn->block_baton));
+        }
+
+      /* Skip the blocks (and the block part) already written. */
+      remaining = count;
+      while (nvec > 0 && remaining >= vec[0].len)
+        {
+          remaining -= vec[0].len;
+          ++vec;
+          --nvec;
+        }
+      if (remaining > 0)
+        {
+          vec[0].data += remaining;
+          vec[0].len -= remaining;
+        }
+
+      if (session)
+        {
+          const svn_ra_callbacks2_t *cb = session->callbacks;
+          session->bytes_written += count;
+
+          if (cb && cb->progress_func)
+            (cb->progress_func)(session->bytes_written + session->bytes_read,
+                                -1, cb->progress_baton, subpool);
+        }
+    }
+
+  conn->written_since_error_check += total;
+  conn->may_check_for_error
+    = conn->written_since_error_check >= conn->error_check_interval;
+
+  if (subpool)
+    svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
 /* Write data from the write buffer out to the socket. */
 static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 {
+  static svn_perf__counter_t *perf_counter = NULL;
+  apr_time_t perf_start = svn_perf__start();
   apr_size_t write_pos = conn->write_pos;
 
   /* Clear conn->write_pos first in case the block handler does a read. */
   conn->write_pos = 0;
   SVN_ERR(writebuf_output(conn, pool, conn->write_buf, write_pos));
+  svn_perf__stop(&perf_counter, "ra_svn.writebuf-flush", perf_start);
+
+  /* A write buffer that keeps getting flushed (nearly) full indicates
+     sustained output, e.g. an editor drive sending millions of small
+     items.  Grow it, up to a limit, so more of them coalesce into each
+     network write.  Flushes at message boundaries leave the size alone.
+     The old buffer stays allocated from the connection pool but the
+     doubling sizes keep the total below twice the maximum. */
+  if (   write_pos >= conn->write_size - conn->write_size / 8
+      && conn->write_size < SVN_RA_SVN__WRITEBUF_MAX_SIZE)
+    {
+      conn->write_size *= 2;
+      conn->write_buf = apr_palloc(conn->pool, conn->write_size);
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -431,16 +549,31 @@ static svn_error_t *writebuf_write(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                    const char *data, apr_size_t len)
 {
   /* data >= 8k is sent immediately */
-  if (len >= sizeof(conn->write_buf) / 2)
+  if (len >= conn->write_size / 2)
     {
       if (conn->write_pos > 0)
-        SVN_ERR(writebuf_flush(conn, pool));
+        {
+          /* Send the buffered data and the new block with a single
+             vectored write instead of flushing the buffer first. */
+          svn_string_t vec[2];
+          apr_size_t write_pos = conn->write_pos;
+
+          vec[0].data = conn->write_buf;
+          vec[0].len = write_pos;
+          vec[1].data = data;
+          vec[1].len = len;
+
+          /* Clear conn->write_pos first in case the block handler
+             does a read. */
+          conn->write_pos = 0;
+          return writebuf_output_vec(conn, pool, vec, 2);
+        }
 
       return writebuf_output(conn, pool, data, len);
     }
 
   /* ensure room for the data to add */
-  if (conn->write_pos + len > sizeof(conn->write_buf))
+  if (conn->write_pos + len > conn->write_size)
     SVN_ERR(writebuf_flush(conn, pool));
 
   /* buffer the new data block as well */
@@ -461,7 +594,7 @@ static svn_error_t *writebuf_write(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
 static APR_INLINE svn_error_t *
 writebuf_writechar(svn_ra_svn_conn_t *conn, apr_pool_t *pool, char data)
 {
-  if (conn->write_pos < sizeof(conn->write_buf))
+  if (conn->write_pos < conn->write_size)
   {
     conn->write_buf[conn->write_pos] = data;
     conn->write_pos++;
@@ -523,6 +656,29 @@ static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
   return SVN_NO_ERROR;
 }
 
+/* If CONN has string items borrowing their data from the read buffer
+ * (see svn_ra_svn__read_tuple_borrowed), copy them out before the
+ * buffer contents get overwritten. */
+static void
+copy_out_borrows(svn_ra_svn_conn_t *conn)
+{
+  int i;
+
+  if (!conn->pending_borrows)
+    return;
+
+  for (i = 0; i < conn->pending_borrows->nelts; i++)
+    {
+      svn_ra_svn__item_t *item
+        = APR_ARRAY_IDX(conn->pending_borrows, i, svn_ra_svn__item_t *);
+      item->u.string.data = apr_pstrmemdup(conn->borrow_pool,
+                                           item->u.string.data,
+                                           item->u.string.len);
+    }
+
+  conn->pending_borrows->nelts = 0;
+}
+
 /* Treat the next LEN input bytes from CONN as "read" */
 static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
 {
@@ -535,7 +691,8 @@ static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
     if (len == 0)
       break;
 
-    buflen = sizeof(conn->read_buf);
+    copy_out_borrows(conn);
+    buflen = conn->read_size;
     SVN_ERR(svn_ra_svn__stream_read(conn->stream, conn->read_buf, &buflen));
     if (buflen == 0)
       return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
@@ -551,6 +708,8 @@ static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
 /* Read data from the socket into the read buffer, which must be empty. */
 static svn_error_t *readbuf_fill(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 {
+  static svn_perf__counter_t *perf_counter = NULL;
+  apr_time_t perf_start;
   apr_size_t len;
 
   SVN_ERR_ASSERT(conn->read_ptr == conn->read_end);
@@ -561,10 +720,40 @@ static svn_error_t *readbuf_fill(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
     SVN_ERR(writebuf_flush(conn, pool));
 
   /* Fill (some of the) buffer. */
-  len = sizeof(conn->read_buf);
+  copy_out_borrows(conn);
+
+  /* The buffer is empty and any borrowed spans have been copied out,
+   * so this is a safe point to switch to a larger buffer if the last
+   * fills indicated a bulk transfer. */
+  if (conn->read_fetch_size > conn->read_size)
+    {
+      conn->read_buf = apr_palloc(conn->pool, conn->read_fetch_size);
+      conn->read_size = conn->read_fetch_size;
+    }
+
+  len = conn->read_fetch_size;
+  perf_start = svn_perf__start();
   SVN_ERR(readbuf_input(conn, conn->read_buf, &len, pool));
+  svn_perf__stop(&perf_counter, "ra_svn.readbuf-fill", perf_start);
   conn->read_ptr = conn->read_buf;
   conn->read_end = conn->read_buf + len;
+
+  /* Adapt the next request size:  a completely satisfied read means
+   * more data is already waiting in the network buffers, i.e. we are
+   * in a bulk transfer - ask for more next time.  A mostly empty
+   * result means interactive traffic - fall back to the default.
+   * The buffer itself never shrinks; pool memory cannot be returned
+   * anyway and the capacity gets reused by the next bulk transfer. */
+  if (len == conn->read_fetch_size)
+    {
+      if (conn->read_fetch_size < SVN_RA_SVN__READBUF_MAX_SIZE)
+        conn->read_fetch_size *= 2;
+    }
+  else if (len < conn->read_fetch_size / 2)
+    {
+      conn->read_fetch_size = SVN_RA_SVN__READBUF_SIZE;
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -602,7 +791,7 @@ static svn_error_t *readbuf_read(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   data = readbuf_drain(conn, data, end);
 
   /* Read large chunks directly into buffer. */
-  while (end - data > (apr_ssize_t)sizeof(conn->read_buf))
+  while (end - data > (apr_ssize_t)conn->read_size)
     {
       SVN_ERR(writebuf_flush(conn, pool));
       count = end - data;
@@ -624,12 +813,13 @@ static svn_error_t *readbuf_read(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
 static svn_error_t *readbuf_skip_leading_garbage(svn_ra_svn_conn_t *conn,
                                                  apr_pool_t *pool)
 {
-  char buf[256];  /* Must be smaller than sizeof(conn->read_buf) - 1. */
+  char buf[256];  /* Must be smaller than SVN_RA_SVN__READBUF_SIZE - 1. */
   const char *p, *end;
   apr_size_t len;
   svn_boolean_t lparen = FALSE;
 
   SVN_ERR_ASSERT(conn->read_ptr == conn->read_end);
+  copy_out_borrows(conn);
   while (1)
     {
       /* Read some data directly from the connection input source. */
@@ -668,7 +858,7 @@ static svn_error_t *write_number(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
 
   /* SVN_INT64_BUFFER_SIZE includes space for a terminating NUL that
    * svn__ui64toa will always append. */
-  if (conn->write_pos + SVN_INT64_BUFFER_SIZE >= sizeof(conn->write_buf))
+  if (conn->write_pos + SVN_INT64_BUFFER_SIZE >= conn->write_size)
     SVN_ERR(writebuf_flush(conn, pool));
 
   written = svn__ui64toa(conn->write_buf + conn->write_pos, number);
@@ -728,7 +918,7 @@ svn_ra_svn__write_ncstring(svn_ra_svn_conn_t *conn,
 {
   /* Apart from LEN bytes of string contents, we need room for a number,
      a colon and a space. */
-  apr_size_t max_fill = sizeof(conn->write_buf) - SVN_INT64_BUFFER_SIZE - 2;
+  apr_size_t max_fill = conn->write_size - SVN_INT64_BUFFER_SIZE - 2;
 
   /* In most cases, there is enough left room in the WRITE_BUF
      the we can serialize directly into it.  On platforms with
@@ -830,7 +1020,7 @@ svn_error_t *
 svn_ra_svn__start_list(svn_ra_svn_conn_t *conn,
                        apr_pool_t *pool)
 {
-  if (conn->write_pos + 2 <= sizeof(conn->write_buf))
+  if (conn->write_pos + 2 <= conn->write_size)
     {
       conn->write_buf[conn->write_pos] = '(';
       conn->write_buf[conn->write_pos+1] = ' ';
@@ -845,7 +1035,7 @@ svn_error_t *
 svn_ra_svn__end_list(svn_ra_svn_conn_t *conn,
                      apr_pool_t *pool)
 {
-  if (conn->write_pos + 2 <= sizeof(conn->write_buf))
+  if (conn->write_pos + 2 <= conn->write_size)
   {
     conn->write_buf[conn->write_pos] = ')';
     conn->write_buf[conn->write_pos+1] = ' ';
@@ -990,7 +1180,7 @@ write_tuple_string_opt_list(svn_ra_svn_conn_t *conn,
 
   /* If this how far we can fill the WRITE_BUF with string data and still
      guarantee that the length info will fit in as well. */
-  max_fill = sizeof(conn->write_buf)
+  max_fill = conn->write_size
            - 2                       /* open list */
            - SVN_INT64_BUFFER_SIZE   /* string length + separator */
            - 2;                      /* close list */
@@ -1232,7 +1422,16 @@ static svn_error_t *read_string(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   if (len <= buflen)
     {
       item->kind = SVN_RA_SVN_STRING;
-      item->u.string.data = apr_pstrmemdup(pool, conn->read_ptr, len);
+      if (conn->borrow_reads)
+        {
+          /* Hand out a span into the read buffer.  Should the buffer
+             be refilled while the item is live, copy_out_borrows()
+             rescues the data. */
+          item->u.string.data = conn->read_ptr;
+          APR_ARRAY_PUSH(conn->pending_borrows, svn_ra_svn__item_t *) = item;
+        }
+      else
+        item->u.string.data = apr_pstrmemdup(pool, conn->read_ptr, len);
       item->u.string.len = len;
       conn->read_ptr += len;
     }
@@ -1333,6 +1532,16 @@ static svn_error_t *read_item(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
           /* It's a string. */
           SVN_ERR(read_string(conn, pool, item, val));
           SVN_ERR(readbuf_getchar(conn, pool, &c));
+
+          /* A string still borrowing from the read buffer gets
+             NUL-terminated in place, overwriting the separator just
+             consumed.  If reading the separator refilled the buffer,
+             the string has already been copied out (and terminated)
+             by copy_out_borrows(). */
+          if (conn->borrow_reads
+              && item->u.string.data >= conn->read_buf
+              && item->u.string.data < conn->read_buf + conn->read_size)
+            ((char *)item->u.string.data)[item->u.string.len] = '\0';
         }
       else
         {
@@ -1749,6 +1958,56 @@ svn_ra_svn__read_tuple(svn_ra_svn_conn_t *conn,
   return err;
 }
 
+/* Pool cleanup handler: drop CONN's borrowed-item bookkeeping when the
+   pool the borrowed items live in goes away. */
+static apr_status_t
+release_borrows(void *baton)
+{
+  svn_ra_svn_conn_t *conn = baton;
+
+  conn->pending_borrows = NULL;
+  conn->borrow_pool = NULL;
+  conn->borrow_reads = FALSE;
+
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_ra_svn__read_tuple_borrowed(svn_ra_svn_conn_t *conn,
+                                apr_pool_t *pool,
+                                const char *fmt, ...)
+{
+  va_list ap;
+  svn_ra_svn__item_t *item;
+  svn_error_t *err;
+
+  /* Strings handed out by the previous borrowed read on this
+     connection lose their refill protection now. */
+  conn->pending_borrows = apr_array_make(pool, 16,
+                                         sizeof(svn_ra_svn__item_t *));
+  conn->borrow_pool = pool;
+  apr_pool_cleanup_register(pool, conn, release_borrows,
+                            apr_pool_cleanup_null);
+
+  conn->borrow_reads = TRUE;
+  err = svn_ra_svn__read_item(conn, pool, &item);
+  conn->borrow_reads = FALSE;
+
+  if (!err && item->kind != SVN_RA_SVN_LIST)
+    err = svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                           _("Malformed network data"));
+  if (err)
+    {
+      release_borrows(conn);
+      return err;
+    }
+
+  va_start(ap, fmt);
+  err = vparse_tuple(&item->u.list, &fmt, &ap);
+  va_end(ap);
+  return err;
+}
+
 svn_error_t *
 svn_ra_svn__read_command_only(svn_ra_svn_conn_t *conn,
                               apr_pool_t *pool,
@@ -1937,6 +2196,10 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
   command = svn_hash_gets(cmd_hash, cmdname);
   if (command)
     {
+      apr_time_t start = conn->command_hook ? apr_time_now() : 0;
+
+      SVN_PROBE1(command__start, cmdname);
+
       /* Call the standard command handler.
        * If that is not set, then this is a lecagy API call and we invoke
        * the legacy command handler. */
@@ -1952,6 +2215,12 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
                                                baton);
         }
 
+      if (conn->command_hook)
+        conn->command_hook(cmdname, apr_time_now() - start,
+                           conn->command_hook_baton);
+
+      SVN_PROBE2(command__done, cmdname, err ? err->apr_err : 0);
+
       /* The command implementation may have swallowed or wrapped the I/O
        * error not knowing that we may no longer be able to send data.
        *
@@ -2179,6 +2448,32 @@ svn_ra_svn__write_cmd_change_file_prop(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_svn__write_cmd_change_node_props(svn_ra_svn_conn_t *conn,
+                                        apr_pool_t *pool,
+                                        const svn_string_t *token,
+                                        const apr_array_header_t *props)
+{
+  int i;
+
+  SVN_ERR(writebuf_write_literal(conn, pool, "( change-node-props ( "));
+  SVN_ERR(write_tuple_string(conn, pool, token));
+  SVN_ERR(write_tuple_start_list(conn, pool));
+  for (i = 0; i < props->nelts; ++i)
+    {
+      const svn_prop_t *prop = &APR_ARRAY_IDX(props, i, svn_prop_t);
+
+      SVN_ERR(write_tuple_start_list(conn, pool));
+      SVN_ERR(write_tuple_cstring(conn, pool, prop->name));
+      SVN_ERR(write_tuple_string_opt_list(conn, pool, prop->value));
+      SVN_ERR(write_tuple_end_list(conn, pool));
+    }
+  SVN_ERR(write_tuple_end_list(conn, pool));
+  SVN_ERR(writebuf_write_literal(conn, pool, ") ) "));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__write_cmd_close_file(svn_ra_svn_conn_t *conn,
                                  apr_pool_t *pool,
@@ -2845,7 +3140,7 @@ svn_ra_svn__write_data_log_changed_path(svn_ra_svn_conn_t *conn,
   apr_size_t flags_len = flags_str->len;
 
   /* How much buffer space can we use for non-string data (worst case)? */
-  apr_size_t max_fill = sizeof(conn->write_buf)
+  apr_size_t max_fill = conn->write_size
                       - 2                          /* list start */
                       - 2 - SVN_INT64_BUFFER_SIZE  /* path */
                       - 2                          /* action */
@@ -67,6 +67,19 @@ typedef svn_error_t *(*ra_svn_block_handler_t)(svn_ra_svn_conn_t *conn,
 #define SVN_RA_SVN__READBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 #define SVN_RA_SVN__WRITEBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 
+/* The size limit that the write buffer may grow to under sustained
+   output; see writebuf_flush() in marshal.c. */
+#define SVN_RA_SVN__WRITEBUF_MAX_SIZE (64 * SVN_RA_SVN__PAGE_SIZE)
+
+/* The size limit that a single read request may grow to while bulk
+   input keeps the read buffer full; see readbuf_fill() in marshal.c. */
+#define SVN_RA_SVN__READBUF_MAX_SIZE (64 * SVN_RA_SVN__PAGE_SIZE)
+
+/* How many bytes the client may send between polls for an early error
+   report from the server, e.g. while driving a commit editor; see
+   check_for_error() in editorp.c.  0 would poll before every command. */
+#define SVN_RA_SVN__ERROR_CHECK_INTERVAL SVN_RA_SVN__PAGE_SIZE
+
 /* Create forward reference */
 typedef struct svn_ra_svn__session_baton_t svn_ra_svn__session_baton_t;
 
@@ -74,13 +87,33 @@ typedef struct svn_ra_svn__session_baton_t svn_ra_svn__session_baton_t;
  * first few fields during setup and cleanup. */
 struct svn_ra_svn_conn_st {
 
-  /* I/O buffers */
-  char write_buf[SVN_RA_SVN__WRITEBUF_SIZE];
-  char read_buf[SVN_RA_SVN__READBUF_SIZE];
+  /* I/O buffers.  Both buffers start out at their default sizes
+     (SVN_RA_SVN__READBUF_SIZE and SVN_RA_SVN__WRITEBUF_SIZE) and grow
+     up to their _MAX_SIZE counterparts while the connection moves
+     enough data to keep them full.  READ_SIZE is the allocated read
+     buffer capacity; READ_FETCH_SIZE is how much the next fill will
+     request, which falls back to the default when transfers become
+     small again.  See readbuf_fill() and writebuf_flush() in
+     marshal.c. */
+  char *read_buf;
+  apr_size_t read_size;
+  apr_size_t read_fetch_size;
+  char *write_buf;
+  apr_size_t write_size;
   char *read_ptr;
   char *read_end;
   apr_size_t write_pos;
 
+  /* Borrowed-mode parsing state; see svn_ra_svn__read_tuple_borrowed()
+     in marshal.c.  PENDING_BORROWS lists the string items whose data
+     still lives in READ_BUF, BORROW_POOL is the pool to copy them into
+     if the buffer must be refilled while they are live, and
+     BORROW_READS says whether the parse currently in progress may
+     borrow at all. */
+  apr_array_header_t *pending_borrows;
+  apr_pool_t *borrow_pool;
+  svn_boolean_t borrow_reads;
+
   svn_ra_svn__stream_t *stream;
   svn_ra_svn__session_baton_t *session;
 #ifdef SVN_HAVE_SASL
@@ -110,6 +143,11 @@ struct svn_ra_svn_conn_st {
   ra_svn_block_handler_t block_handler;
   void *block_baton;
 
+  /* post-command instrumentation hook; see
+     svn_ra_svn__set_command_hook() */
+  svn_ra_svn__command_hook_t command_hook;
+  void *command_hook_baton;
+
   /* server settings */
   apr_hash_t *capabilities;
   int compression_level;
@@ -181,9 +219,12 @@ svn_error_t *svn_ra_svn__data_available(svn_ra_svn_conn_t *conn,
 void
 svn_ra_svn__reset_command_io_counters(svn_ra_svn_conn_t *conn);
 
-/* CRAM-MD5 client implementation. */
+/* CRAM-MD5 client implementation.  On success, set *TICKET to the auth
+ * resumption ticket attached by the server, or to NULL if it did not
+ * attach one; see SVN_RA_SVN_CAP_AUTH_TICKET. */
 svn_error_t *svn_ra_svn__cram_client(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                      const char *user, const char *password,
+                                     const char **ticket,
                                      const char **message);
 
 /* Return a pointer to the error chain child of ERR which contains the
@@ -222,6 +263,14 @@ svn_ra_svn__stream_t *svn_ra_svn__stream_create(svn_stream_t *in_stream,
 svn_error_t *svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
                                       const char *data, apr_size_t *len);
 
+/* Write the NVEC data blocks in VEC to STREAM with a single vectored
+ * write where possible, returning the total number of bytes written in
+ * *LEN.  Like with svn_ra_svn__stream_write, that count may be short.
+ */
+svn_error_t *svn_ra_svn__stream_writev(svn_ra_svn__stream_t *stream,
+                                       const svn_string_t *vec,
+                                       apr_size_t nvec, apr_size_t *len);
+
 /* Read *LEN bytes from STREAM into DATA, returning the number of bytes
  * read in *LEN.
  */
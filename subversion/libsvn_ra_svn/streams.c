@@ -23,6 +23,9 @@
 
 
 
+#define APR_WANT_IOVEC
+#include <apr_want.h>
+
 #include <apr_general.h>
 #include <apr_network_io.h>
 #include <apr_poll.h>
@@ -135,6 +138,36 @@ sock_write_cb(void *baton, const char *buffer, apr_size_t *len)
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_stream_writev_fn_t */
+static svn_error_t *
+sock_writev_cb(void *baton, const svn_string_t *vec, apr_size_t nvec,
+               apr_size_t *len)
+{
+  /* Number of buffers passed to a single apr_socket_sendv() call. */
+#define MAX_SEND_IOVEC 64
+  sock_baton_t *b = baton;
+  struct iovec iov[MAX_SEND_IOVEC];
+  apr_size_t i;
+  apr_status_t status;
+
+  /* A short write is fine with our callers; they simply retry with the
+     remainder.  So, don't bother looping over longer vectors. */
+  if (nvec > MAX_SEND_IOVEC)
+    nvec = MAX_SEND_IOVEC;
+
+  for (i = 0; i < nvec; ++i)
+    {
+      iov[i].iov_base = (void *)vec[i].data;
+      iov[i].iov_len = vec[i].len;
+    }
+
+  status = apr_socket_sendv(b->sock, iov, (apr_int32_t)nvec, len);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't write to connection"));
+  return SVN_NO_ERROR;
+#undef MAX_SEND_IOVEC
+}
+
 /* Implements ra_svn_timeout_fn_t */
 static void
 sock_timeout_cb(void *baton, apr_interval_time_t interval)
@@ -175,6 +208,7 @@ svn_ra_svn__stream_from_sock(apr_socket_t *sock,
 
   svn_stream_set_read2(sock_stream, sock_read_cb, NULL /* use default */);
   svn_stream_set_write(sock_stream, sock_write_cb);
+  svn_stream_set_writev(sock_stream, sock_writev_cb);
   svn_stream_set_data_available(sock_stream, sock_pending_cb);
 
   return svn_ra_svn__stream_create(sock_stream, sock_stream,
@@ -203,6 +237,15 @@ svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
   return svn_error_trace(svn_stream_write(stream->out_stream, data, len));
 }
 
+svn_error_t *
+svn_ra_svn__stream_writev(svn_ra_svn__stream_t *stream,
+                          const svn_string_t *vec, apr_size_t nvec,
+                          apr_size_t *len)
+{
+  return svn_error_trace(svn_stream_writev(stream->out_stream, vec, nvec,
+                                           len));
+}
+
 svn_error_t *
 svn_ra_svn__stream_read(svn_ra_svn__stream_t *stream, char *data,
                         apr_size_t *len)
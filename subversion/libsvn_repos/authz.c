@@ -1008,6 +1008,148 @@ create_user_authz(authz_full_t *authz,
   return root;
 }
 
+/*** Compiling the filtered tree. ***/
+
+/* A node in the compiled form of the filtered tree.  All nodes of a tree
+ * are stored in a single contiguous array; the sub-nodes of any node form
+ * a consecutive run within that array, sorted by their segment strings.
+ * This keeps the per-segment lookup down to a binary search over adjacent
+ * memory.  The compiled form is immutable once constructed.
+ *
+ * Only trees without pattern rules can be compiled; pattern matching
+ * keeps using the node_t tree walk.
+ */
+typedef struct compiled_node_t
+{
+  /* The segment leading to this node.  Shares the interned string data
+   * with the authz model, which always outlives the compiled tree. */
+  svn_string_t segment;
+
+  /* Immediate access rights at this node and the min / max rights on any
+   * path in this sub-tree.  Same contents as in the node_t source. */
+  limited_rights_t rights;
+
+  /* Index of our first sub-node within the node array.  0 (the root's
+   * index, which is never a sub-node) if there are no sub-nodes. */
+  apr_uint32_t first_sub_node;
+
+  /* Number of sub-nodes. */
+  apr_uint32_t sub_node_count;
+} compiled_node_t;
+
+/* Compare the segment of LHS with the SEGMENT_LEN bytes at SEGMENT_DATA,
+ * using the same ordering as svn_sort_compare_items_lexically().
+ */
+static int
+compare_compiled_segment(const compiled_node_t *lhs,
+                         const char *segment_data,
+                         apr_size_t segment_len)
+{
+  apr_size_t min_len = MIN(lhs->segment.len, segment_len);
+  int result = memcmp(lhs->segment.data, segment_data, min_len);
+
+  if (result == 0)
+    result = lhs->segment.len < segment_len
+           ? -1
+           : (lhs->segment.len > segment_len ? 1 : 0);
+
+  return result;
+}
+
+/* Add the number of nodes in the tree starting at NODE to *COUNT.
+ * Return FALSE, if the tree contains pattern rules and can therefore
+ * not be compiled.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_boolean_t
+count_compilable_nodes(apr_size_t *count,
+                       const node_t *node,
+                       apr_pool_t *scratch_pool)
+{
+  if (node->pattern_sub_nodes)
+    return FALSE;
+
+  ++*count;
+
+  if (node->sub_nodes)
+    {
+      apr_hash_index_t *hi;
+      for (hi = apr_hash_first(scratch_pool, node->sub_nodes);
+           hi;
+           hi = apr_hash_next(hi))
+        if (!count_compilable_nodes(count, apr_hash_this_val(hi),
+                                    scratch_pool))
+          return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Compile the filtered tree starting at ROOT into a contiguous node array
+ * allocated in RESULT_POOL and return it, setting *COUNT to the number of
+ * nodes.  Return NULL, if ROOT contains pattern rules, i.e. cannot be
+ * compiled.  Use SCRATCH_POOL for temporary allocations.
+ */
+static const compiled_node_t *
+compile_user_authz(apr_size_t *count,
+                   const node_t *root,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  compiled_node_t *nodes;
+  apr_array_header_t *sources;
+  apr_size_t next_free;
+  int i;
+  apr_pool_t *iterpool;
+
+  /* Patterns don't fit the compiled form; leave those trees alone. */
+  *count = 0;
+  if (!count_compilable_nodes(count, root, scratch_pool))
+    return NULL;
+
+  nodes = apr_pcalloc(result_pool, *count * sizeof(*nodes));
+
+  /* Breadth-first layout:  we assign node indexes in the order in which
+   * we encounter the nodes, which automatically puts all sub-nodes of a
+   * given node next to each other. */
+  sources = apr_array_make(scratch_pool, (int)*count, sizeof(node_t *));
+  APR_ARRAY_PUSH(sources, const node_t *) = root;
+  next_free = 1;
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < sources->nelts; ++i)
+    {
+      const node_t *source = APR_ARRAY_IDX(sources, i, const node_t *);
+      compiled_node_t *node = &nodes[i];
+
+      node->segment = source->segment;
+      node->rights = source->rights;
+
+      if (source->sub_nodes)
+        {
+          int k;
+          apr_array_header_t *sorted;
+
+          svn_pool_clear(iterpool);
+
+          /* Sub-nodes are sorted such that lookup can bisect them. */
+          sorted = svn_sort__hash(source->sub_nodes,
+                                  svn_sort_compare_items_lexically,
+                                  iterpool);
+
+          node->first_sub_node = (apr_uint32_t)next_free;
+          node->sub_node_count = (apr_uint32_t)sorted->nelts;
+          next_free += sorted->nelts;
+
+          for (k = 0; k < sorted->nelts; ++k)
+            APR_ARRAY_PUSH(sources, const node_t *)
+              = APR_ARRAY_IDX(sorted, k, svn_sort__item_t).value;
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  return nodes;
+}
+
 
 /*** Lookup. ***/
 
@@ -1417,10 +1559,138 @@ lookup(lookup_state_t *state,
   return (state->rights.access.rights & required) == required;
 }
 
+/* The equivalent of lookup() on the compiled form of the filtered tree.
+ * NODES is the compiled node array, SCRATCH_PAD a reusable buffer for
+ * path segments.  Since a pattern-free tree has at most one node per
+ * path, this is a simple walk with one binary search per path segment
+ * instead of the node list juggling that patterns require.
+ * See lookup() for the meaning of PATH, REQUIRED and RECURSIVE.
+ */
+static svn_boolean_t
+compiled_lookup(const compiled_node_t *nodes,
+                svn_stringbuf_t *scratch_pad,
+                const char *path,
+                authz_access_t required,
+                svn_boolean_t recursive,
+                apr_pool_t *scratch_pool)
+{
+  const compiled_node_t *node = &nodes[0];
+  limited_rights_t rights = node->rights;
+
+  /* Create a scratch pad large enough to hold any of PATH's segments. */
+  apr_size_t path_len = strlen(path);
+  svn_stringbuf_ensure(scratch_pad, path_len);
+
+  /* Normalize start and end of PATH.  Most paths will be fully normalized,
+   * so keep the overhead as low as possible. */
+  if (path_len && path[path_len-1] == '/')
+    {
+      do
+      {
+        --path_len;
+      }
+      while (path_len && path[path_len-1] == '/');
+      path = apr_pstrmemdup(scratch_pool, path, path_len);
+    }
+
+  while (path[0] == '/')
+    ++path;
+
+  /* Walk the compiled tree following PATH until we run out of either
+   * tree or PATH. */
+  while (path)
+    {
+      svn_stringbuf_t *segment = scratch_pad;
+      const compiled_node_t *found = NULL;
+      apr_size_t lo, hi;
+
+      /* Shortcut 1: We could nowhere find enough rights in this sub-tree. */
+      if ((rights.max_rights & required) != required)
+        return FALSE;
+
+      /* Shortcut 2: We will find enough rights everywhere in this sub-tree. */
+      if ((rights.min_rights & required) == required)
+        return TRUE;
+
+      /* Extract the next segment. */
+      path = next_segment(segment, path);
+
+      /* Binary search for SEGMENT among NODE's sub-nodes. */
+      for (lo = node->first_sub_node,
+             hi = node->first_sub_node + node->sub_node_count;
+           lo < hi; )
+        {
+          apr_size_t mid = lo + (hi - lo) / 2;
+          int diff = compare_compiled_segment(&nodes[mid], segment->data,
+                                              segment->len);
+          if (diff < 0)
+            lo = mid + 1;
+          else if (diff > 0)
+            hi = mid;
+          else
+            {
+              found = &nodes[mid];
+              break;
+            }
+        }
+
+      if (!found)
+        {
+          /* There are no rules anywhere below this point;  the last
+           * applicable access spec covers the remaining sub-tree. */
+          rights.min_rights = rights.access.rights;
+          rights.max_rights = rights.access.rights;
+          break;
+        }
+
+      /* If no rule applies to FOUND directly, the parent rights will
+       * apply to at least the FOUND node itself and possibly other
+       * parts deeper in its subtree. */
+      node = found;
+      if (has_local_rule(&node->rights))
+        {
+          rights = node->rights;
+        }
+      else
+        {
+          path_access_t inherited = rights.access;
+
+          rights = node->rights;
+          rights.access = inherited;
+          rights.min_rights &= inherited.rights;
+          rights.max_rights |= inherited.rights;
+        }
+    }
+
+  /* If we check recursively, none of the (potential) sub-paths must have
+   * less than the REQUIRED access rights. */
+  if (recursive)
+    return (rights.min_rights & required) == required;
+
+  /* Return whether the access rights on PATH fully include REQUIRED. */
+  return (rights.access.rights & required) == required;
+}
+
 
 
 /*** The authz data structure. ***/
 
+/* The full set of per-user filtered rules as it gets cached in the
+ * FILTERED_POOL:  the filtered tree plus, if the tree could be compiled,
+ * its compiled form. */
+typedef struct filtered_rules_t
+{
+  /* Root of the filtered path rule tree.  Never NULL. */
+  node_t *root;
+
+  /* Contiguous array of the compiled form of the tree, or NULL if the
+   * tree contains pattern rules and could not be compiled. */
+  const compiled_node_t *compiled;
+
+  /* Number of elements in COMPILED. */
+  apr_size_t compiled_count;
+} filtered_rules_t;
+
 /* An entry in svn_authz_t's USER_RULES cache.  All members must be
  * allocated in the POOL and the latter has to be cleared / destroyed
  * before overwriting the entries' contents.
@@ -1442,6 +1712,10 @@ struct authz_user_rules_t
    * Will remain NULL until the first usage. */
   node_t *root;
 
+  /* Compiled form of the tree at ROOT, or NULL if the tree contains
+   * pattern rules.  Only valid once ROOT has been set. */
+  const compiled_node_t *compiled;
+
   /* Reusable lookup state instance. */
   lookup_state_t *lookup_state;
 
@@ -1504,6 +1778,7 @@ get_user_rules(svn_authz_t *authz,
   authz->filtered->user = user ? apr_pstrdup(pool, user) : NULL;
   authz->filtered->lookup_state = create_lookup_state(pool);
   authz->filtered->root = NULL;
+  authz->filtered->compiled = NULL;
 
   svn_authz__get_global_rights(&authz->filtered->global_rights,
                                authz->full, user, repos_name);
@@ -1521,7 +1796,7 @@ filter_tree(svn_authz_t *authz,
   apr_pool_t *pool = authz->filtered->pool;
   const char *repos_name = authz->filtered->repository;
   const char *user = authz->filtered->user;
-  node_t *root;
+  filtered_rules_t *rules;
 
   if (filtered_pool)
     {
@@ -1530,10 +1805,10 @@ filter_tree(svn_authz_t *authz,
                                                  scratch_pool);
 
       /* Cache lookup. */
-      SVN_ERR(svn_object_pool__lookup((void **)&root, filtered_pool, key,
+      SVN_ERR(svn_object_pool__lookup((void **)&rules, filtered_pool, key,
                                       pool));
 
-      if (!root)
+      if (!rules)
         {
           apr_pool_t *item_pool = svn_object_pool__new_item_pool(authz_pool);
           authz_full_t *add_ref = NULL;
@@ -1551,22 +1826,30 @@ filter_tree(svn_authz_t *authz,
                                                   item_pool));
           SVN_ERR_ASSERT(add_ref == authz->full);
 
-          /* Now construct the new filtered tree and cache it. */
-          root = create_user_authz(authz->full, repos_name, user, item_pool,
-                                   scratch_pool);
-          svn_error_clear(svn_object_pool__insert((void **)&root,
-                                                  filtered_pool, key, root,
+          /* Now construct the new filtered tree, compile it and cache it. */
+          rules = apr_pcalloc(item_pool, sizeof(*rules));
+          rules->root = create_user_authz(authz->full, repos_name, user,
+                                          item_pool, scratch_pool);
+          rules->compiled = compile_user_authz(&rules->compiled_count,
+                                               rules->root, item_pool,
+                                               scratch_pool);
+          svn_error_clear(svn_object_pool__insert((void **)&rules,
+                                                  filtered_pool, key, rules,
                                                   item_pool, pool));
         }
      }
   else
     {
-      root = create_user_authz(authz->full, repos_name, user, pool,
-                               scratch_pool);
+      rules = apr_pcalloc(pool, sizeof(*rules));
+      rules->root = create_user_authz(authz->full, repos_name, user, pool,
+                                      scratch_pool);
+      rules->compiled = compile_user_authz(&rules->compiled_count,
+                                           rules->root, pool, scratch_pool);
     }
 
   /* Write a new entry. */
-  authz->filtered->root = root;
+  authz->filtered->root = rules->root;
+  authz->filtered->compiled = rules->compiled;
 
   return SVN_NO_ERROR;
 }
@@ -1766,13 +2049,26 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
   if (!rules->root)
     SVN_ERR(filter_tree(authz, pool));
 
+  /* Sanity check. */
+  SVN_ERR_ASSERT(path[0] == '/');
+
+  /* Pattern-free rule sets have a compiled tree:  check the path with a
+   * plain walk over that instead of the generic node tree lookup. */
+  if (rules->compiled)
+    {
+      *access_granted = compiled_lookup(rules->compiled,
+                                        rules->lookup_state->scratch_pad,
+                                        path, required,
+                                        !!(required_access
+                                           & svn_authz_recursive),
+                                        pool);
+      return SVN_NO_ERROR;
+    }
+
   /* Re-use previous lookup results, if possible. */
   path = init_lockup_state(authz->filtered->lookup_state,
                            authz->filtered->root, path);
 
-  /* Sanity check. */
-  SVN_ERR_ASSERT(path[0] == '/');
-
   /* Determine the granted access for the requested path.
    * PATH does not need to be normalized for lockup(). */
   *access_granted = lookup(rules->lookup_state, path, required,
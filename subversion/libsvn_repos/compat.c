@@ -32,6 +32,7 @@
 #include "repos.h"
 
 #include "private/svn_repos_private.h"
+#include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 
 
@@ -52,6 +53,12 @@ typedef struct log_entry_receiver_baton_t
    * to NULL after the INNER callback has returned. */
   apr_hash_t *changes;
 
+  /* Interned path storage, spanning all revisions of the log request.
+   * The same paths tend to be reported as changed over and over again,
+   * so storing each distinct path only once shrinks the peak footprint
+   * of e.g. 'svn log -v' over large revision ranges considerably. */
+  svn_prefix_interner__t *paths;
+
   /* User-provided callback to send the log entry to. */
   svn_log_entry_receiver_t inner;
   void *inner_baton;
@@ -79,16 +86,16 @@ log4_path_change_receiver(void *baton,
 {
   log_entry_receiver_baton_t *b = baton;
   svn_log_changed_path2_t *change_copy;
-  const char *path = apr_pstrmemdup(b->changes_pool, change->path.data,
-                                    change->path.len);
+  const char *path = svn_prefix_interner__intern(b->paths,
+                                                 change->path.data);
 
   /* Create a deep copy of the temporary CHANGE struct. */
   change_copy = svn_log_changed_path2_create(b->changes_pool);
   change_copy->action = path_change_kind_to_char(change->change_kind);
 
   if (change->copyfrom_path)
-    change_copy->copyfrom_path = apr_pstrdup(b->changes_pool,
-                                             change->copyfrom_path);
+    change_copy->copyfrom_path
+      = svn_prefix_interner__intern(b->paths, change->copyfrom_path);
 
   change_copy->copyfrom_rev = change->copyfrom_rev;
   change_copy->node_kind = change->node_kind;
@@ -159,6 +166,7 @@ svn_repos__get_logs_compat(svn_repos_t *repos,
   log_entry_receiver_baton_t baton;
   baton.changes_pool = changes_pool;
   baton.changes = NULL;
+  baton.paths = svn_prefix_interner__create(pool);
   baton.inner = receiver;
   baton.inner_baton = receiver_baton;
 
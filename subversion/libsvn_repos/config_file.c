@@ -24,10 +24,14 @@
 
 
 
+#include <apr_md5.h>
+
 #include "svn_checksum.h"
 #include "svn_path.h"
 #include "svn_pools.h"
 
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_config_private.h"
@@ -38,6 +42,55 @@
 
 
 
+/* Identification data and content checksum of a cached config file.
+ * In the serialized cache entry, the file contents follow this header
+ * directly.
+ */
+typedef struct content_header_t
+{
+  /* Modification time and size of the file when its contents got cached.
+   * If both still match the on-disk state, we consider the cached contents
+   * valid.  This is the same change detection heuristic that the working
+   * copy applies to its files. */
+  apr_time_t mtime;
+  svn_filesize_t filesize;
+
+  /* MD5 checksum over the file contents. */
+  unsigned char digest[APR_MD5_DIGESTSIZE];
+} content_header_t;
+
+/* Cache of config file contents, keyed by the file path.  This is backed
+ * by the global membuffer cache - which a pre-fork server parent may have
+ * placed in shared memory, in which case one file read serves all server
+ * processes.  NULL if no membuffer cache has been configured. */
+static svn_cache__t *content_cache = NULL;
+static svn_atomic_t content_cache_initialized = FALSE;
+
+/* Implements svn_atomic__err_init_func_t.
+ * Create CONTENT_CACHE on top of the global membuffer cache, if there is
+ * one. */
+static svn_error_t *
+initialize_content_cache(void *baton,
+                         apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+  if (membuffer)
+    {
+      /* Allocate the cache front-end in its own global pool such that it
+       * does not depend on the lifetime of any caller-provided pool.
+       * The backing membuffer is process-global as well. */
+      apr_pool_t *pool = svn_pool_create(NULL);
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                  &content_cache, membuffer, NULL, NULL,
+                  APR_HASH_KEY_STRING, "REPOS_CONFIG_FILE",
+                  SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                  TRUE, FALSE, pool, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 struct config_access_t
 {
   /* The last repository that we found the requested URL in.  May be NULL. */
@@ -285,6 +338,12 @@ get_file_config(svn_stream_t **stream,
 {
   svn_stringbuf_t *contents;
   svn_node_kind_t node_kind;
+  apr_finfo_t finfo;
+  svn_boolean_t have_finfo = FALSE;
+
+  SVN_ERR(svn_atomic__init_once(&content_cache_initialized,
+                                initialize_content_cache, NULL,
+                                scratch_pool));
 
   /* Special case: non-existent paths may be handled as "empty" contents. */
   SVN_ERR(svn_io_check_path(path, &node_kind, scratch_pool));
@@ -292,12 +351,77 @@ get_file_config(svn_stream_t **stream,
     return svn_error_trace(handle_missing_file(stream, checksum, access,
                                                path, must_exist, node_kind));
 
+  /* Unless the file changed since we last read it, serve the contents
+   * from the cache.  That replaces reading and checksumming the whole
+   * file on every access with a single stat() call. */
+  if (content_cache)
+    {
+      svn_error_t *err = svn_io_stat(&finfo, path,
+                                     APR_FINFO_SIZE | APR_FINFO_MTIME,
+                                     scratch_pool);
+      if (err)
+        {
+          /* Just skip the cache; the file read below will report any
+           * persistent problem. */
+          svn_error_clear(err);
+        }
+      else
+        {
+          svn_stringbuf_t *cached;
+          svn_boolean_t found;
+
+          have_finfo = TRUE;
+          SVN_ERR(svn_cache__get((void **)&cached, &found, content_cache,
+                                 path, access->pool));
+          if (found && cached->len >= sizeof(content_header_t))
+            {
+              content_header_t header;
+              memcpy(&header, cached->data, sizeof(header));
+
+              if (   header.mtime == finfo.mtime
+                  && header.filesize == finfo.size)
+                {
+                  svn_string_t *body = apr_palloc(access->pool,
+                                                  sizeof(*body));
+                  body->data = cached->data + sizeof(header);
+                  body->len = cached->len - sizeof(header);
+
+                  *checksum = svn_checksum__from_digest_md5(header.digest,
+                                                            access->pool);
+                  *stream = svn_stream_from_string(body, access->pool);
+
+                  return SVN_NO_ERROR;
+                }
+            }
+        }
+    }
+
   /* Now, we should be able to read the file. */
   SVN_ERR(svn_stringbuf_from_file2(&contents, path, access->pool));
 
   /* calculate MD5 over the whole file contents */
   SVN_ERR(svn_checksum(checksum, svn_checksum_md5,
                        contents->data, contents->len, access->pool));
+
+  /* Cache the contents for the next access - in this or, with a shared
+   * membuffer, any other server process. */
+  if (content_cache && have_finfo)
+    {
+      content_header_t header = { 0 };
+      svn_stringbuf_t *entry
+        = svn_stringbuf_create_ensure(sizeof(header) + contents->len,
+                                      scratch_pool);
+
+      header.mtime = finfo.mtime;
+      header.filesize = finfo.size;
+      memcpy(header.digest, (*checksum)->digest, sizeof(header.digest));
+
+      svn_stringbuf_appendbytes(entry, (const char *)&header,
+                                sizeof(header));
+      svn_stringbuf_appendbytes(entry, contents->data, contents->len);
+      SVN_ERR(svn_cache__set(content_cache, path, entry, scratch_pool));
+    }
+
   *stream = svn_stream_from_stringbuf(contents, access->pool);
 
   return SVN_NO_ERROR;
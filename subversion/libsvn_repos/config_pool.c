@@ -25,9 +25,12 @@
 
 
 #include "svn_checksum.h"
+#include "svn_hash.h"
+#include "svn_io.h"
 #include "svn_path.h"
 #include "svn_pools.h"
 
+#include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_repos_private.h"
 
@@ -35,6 +38,52 @@
 
 #include "config_file.h"
 
+
+/* A configuration pool.  Configuration objects are stored in OBJECT_POOL,
+ * keyed by the checksum of their serialized content.  FILE_INFO remembers
+ * which checksum we derived from a given on-disk file the last time we
+ * read it, so unchanged files need not be re-read, checksummed and parsed
+ * on every access.
+ */
+struct svn_repos__config_pool_t
+{
+  /* the actual configuration object storage */
+  svn_object_pool__t *object_pool;
+
+  /* serializes all access to FILE_INFO */
+  svn_mutex__t *mutex;
+
+  /* maps on-disk config file path (const char *) to the file_info_t
+   * recorded when that file was last parsed */
+  apr_hash_t *file_info;
+
+  /* allocate FILE_INFO and its entries here; same lifetime as the pool
+   * object itself */
+  apr_pool_t *pool;
+};
+
+/* What we know about an on-disk config file from the last time we read
+ * it.  If size and mtime still match, we assume the content - and hence
+ * its CHECKSUM - is unchanged.
+ */
+typedef struct file_info_t
+{
+  apr_time_t mtime;
+  svn_filesize_t size;
+  svn_checksum_t *checksum;
+
+  /* Until this point in time, trust CHECKSUM without re-stat'ing the
+   * file.  Set whenever we verified the entry against the disk. */
+  apr_time_t valid_until;
+} file_info_t;
+
+/* Re-verify a cached config file against the disk at most this often.
+ * Modifications are picked up with at most this delay, which is in the
+ * same ballpark as the mtime resolution of the stat-based check - but
+ * busy servers stop hammering stat() on their conf directories.
+ */
+#define CONFIG_POOL_STAT_INTERVAL apr_time_from_sec(1)
+
 
 /* Return a memory buffer structure allocated in POOL and containing the
  * data from CHECKSUM.
@@ -70,8 +119,8 @@ find_config(svn_config_t **cfg,
 {
   /* First, attempt the cache lookup. */
   svn_membuf_t *key = checksum_as_key(checksum, scratch_pool);
-  SVN_ERR(svn_object_pool__lookup((void **)cfg, config_pool, key,
-                                  result_pool));
+  SVN_ERR(svn_object_pool__lookup((void **)cfg, config_pool->object_pool,
+                                  key, result_pool));
 
   /* Not found? => parse and cache */
   if (!*cfg)
@@ -79,20 +128,143 @@ find_config(svn_config_t **cfg,
       svn_config_t *config;
 
       /* create a pool for the new config object and parse the data into it */
-      apr_pool_t *cfg_pool = svn_object_pool__new_item_pool(config_pool);
+      apr_pool_t *cfg_pool
+        = svn_object_pool__new_item_pool(config_pool->object_pool);
       SVN_ERR(svn_config_parse(&config, stream, FALSE, FALSE, cfg_pool));
 
       /* switch config data to r/o mode to guarantee thread-safe access */
       svn_config__set_read_only(config, cfg_pool);
 
       /* add config in pool, handle loads races and return the right config */
-      SVN_ERR(svn_object_pool__insert((void **)cfg, config_pool, key,
+      SVN_ERR(svn_object_pool__insert((void **)cfg,
+                                      config_pool->object_pool, key,
                                       config, cfg_pool, result_pool));
     }
 
   return SVN_NO_ERROR;
 }
 
+/* If CONFIG_POOL has file information for PATH and it still matches
+ * FINFO's size and mtime, set *CHECKSUM to a copy of the recorded content
+ * checksum, allocated in RESULT_POOL.  Set it to NULL otherwise.
+ *
+ * To be called with CONFIG_POOL->MUTEX held.
+ */
+static svn_error_t *
+find_checksum_internal(svn_checksum_t **checksum,
+                       svn_repos__config_pool_t *config_pool,
+                       const char *path,
+                       const apr_finfo_t *finfo,
+                       apr_pool_t *result_pool)
+{
+  file_info_t *info = svn_hash_gets(config_pool->file_info, path);
+
+  if (info && info->mtime == finfo->mtime && info->size == finfo->size)
+    {
+      *checksum = svn_checksum_dup(info->checksum, result_pool);
+
+      /* We just verified the entry against the disk; don't bother
+       * re-stat'ing the file for a while. */
+      info->valid_until = apr_time_now() + CONFIG_POOL_STAT_INTERVAL;
+    }
+  else
+    *checksum = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Thread-safe wrapper around find_checksum_internal. */
+static svn_error_t *
+find_checksum(svn_checksum_t **checksum,
+              svn_repos__config_pool_t *config_pool,
+              const char *path,
+              const apr_finfo_t *finfo,
+              apr_pool_t *result_pool)
+{
+  SVN_MUTEX__WITH_LOCK(config_pool->mutex,
+                       find_checksum_internal(checksum, config_pool, path,
+                                              finfo, result_pool));
+  return SVN_NO_ERROR;
+}
+
+/* If CONFIG_POOL has file information for PATH that was verified against
+ * the on-disk file recently enough, set *CHECKSUM to a copy of the
+ * recorded content checksum, allocated in RESULT_POOL.  Set it to NULL
+ * otherwise.
+ *
+ * To be called with CONFIG_POOL->MUTEX held.
+ */
+static svn_error_t *
+find_current_checksum_internal(svn_checksum_t **checksum,
+                               svn_repos__config_pool_t *config_pool,
+                               const char *path,
+                               apr_pool_t *result_pool)
+{
+  file_info_t *info = svn_hash_gets(config_pool->file_info, path);
+
+  if (info && apr_time_now() < info->valid_until)
+    *checksum = svn_checksum_dup(info->checksum, result_pool);
+  else
+    *checksum = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Thread-safe wrapper around find_current_checksum_internal. */
+static svn_error_t *
+find_current_checksum(svn_checksum_t **checksum,
+                      svn_repos__config_pool_t *config_pool,
+                      const char *path,
+                      apr_pool_t *result_pool)
+{
+  SVN_MUTEX__WITH_LOCK(config_pool->mutex,
+                       find_current_checksum_internal(checksum, config_pool,
+                                                      path, result_pool));
+  return SVN_NO_ERROR;
+}
+
+/* Record in CONFIG_POOL that PATH, as described by FINFO, had the content
+ * CHECKSUM.  Allocations are made with the config pool's lifetime; config
+ * files change rarely enough that replaced entries are simply abandoned.
+ *
+ * To be called with CONFIG_POOL->MUTEX held.
+ */
+static svn_error_t *
+remember_checksum_internal(svn_repos__config_pool_t *config_pool,
+                           const char *path,
+                           const apr_finfo_t *finfo,
+                           const svn_checksum_t *checksum)
+{
+  file_info_t *info = svn_hash_gets(config_pool->file_info, path);
+
+  if (!info)
+    {
+      info = apr_palloc(config_pool->pool, sizeof(*info));
+      svn_hash_sets(config_pool->file_info,
+                    apr_pstrdup(config_pool->pool, path), info);
+    }
+
+  info->mtime = finfo->mtime;
+  info->size = finfo->size;
+  info->checksum = svn_checksum_dup(checksum, config_pool->pool);
+  info->valid_until = apr_time_now() + CONFIG_POOL_STAT_INTERVAL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Thread-safe wrapper around remember_checksum_internal. */
+static svn_error_t *
+remember_checksum(svn_repos__config_pool_t *config_pool,
+                  const char *path,
+                  const apr_finfo_t *finfo,
+                  const svn_checksum_t *checksum)
+{
+  SVN_MUTEX__WITH_LOCK(config_pool->mutex,
+                       remember_checksum_internal(config_pool, path, finfo,
+                                                  checksum));
+  return SVN_NO_ERROR;
+}
+
 /* API implementation */
 
 svn_error_t *
@@ -100,8 +272,15 @@ svn_repos__config_pool_create(svn_repos__config_pool_t **config_pool,
                               svn_boolean_t thread_safe,
                               apr_pool_t *pool)
 {
-  return svn_error_trace(svn_object_pool__create(config_pool,
-                                                 thread_safe, pool));
+  svn_repos__config_pool_t *result = apr_pcalloc(pool, sizeof(*result));
+
+  SVN_ERR(svn_object_pool__create(&result->object_pool, thread_safe, pool));
+  SVN_ERR(svn_mutex__init(&result->mutex, thread_safe, pool));
+  result->file_info = svn_hash__make(pool);
+  result->pool = pool;
+
+  *config_pool = result;
+  return SVN_NO_ERROR;
 }
 
 svn_error_t *
@@ -114,12 +293,84 @@ svn_repos__config_pool_get(svn_config_t **cfg,
 {
   svn_error_t *err = SVN_NO_ERROR;
   apr_pool_t *scratch_pool = svn_pool_create(pool);
-  config_access_t *access = svn_repos__create_config_access(preferred_repos,
-                                                            scratch_pool);
+  config_access_t *access;
   svn_stream_t *stream;
   svn_checksum_t *checksum;
+  apr_finfo_t finfo;
+  svn_boolean_t have_finfo = FALSE;
 
   *cfg = NULL;
+
+  /* If we verified PATH against the disk only moments ago, skip even the
+   * stat() and serve the cached object directly.  The window for missing
+   * a modification is comparable to the mtime resolution of the stat
+   * check below, but the hot path stays off the filesystem entirely -
+   * which matters for conf directories hosted on NFS. */
+  if (!svn_path_is_url(path))
+    {
+      svn_checksum_t *current_checksum;
+
+      SVN_ERR(find_current_checksum(&current_checksum, config_pool, path,
+                                    scratch_pool));
+      if (current_checksum)
+        SVN_ERR(svn_object_pool__lookup((void **)cfg,
+                                        config_pool->object_pool,
+                                        checksum_as_key(current_checksum,
+                                                        scratch_pool),
+                                        pool));
+
+      if (*cfg)
+        {
+          svn_pool_destroy(scratch_pool);
+
+          /* we need to duplicate the root structure as it contains temp.
+           * buffers */
+          *cfg = svn_config__shallow_copy(*cfg, pool);
+          return SVN_NO_ERROR;
+        }
+    }
+
+  /* For plain files, we may be able to skip reading, checksumming and
+   * parsing the contents entirely:  if size and mtime are unchanged
+   * since we last parsed PATH, reuse the cached object registered under
+   * the content checksum we recorded back then.  A file modified within
+   * the mtime resolution without changing its size will be missed here;
+   * the next actual change to it will be picked up as usual. */
+  if (!svn_path_is_url(path))
+    {
+      svn_error_t *stat_err = svn_io_stat(&finfo, path,
+                                          APR_FINFO_MTIME | APR_FINFO_SIZE,
+                                          scratch_pool);
+      if (stat_err)
+        svn_error_clear(stat_err);
+      else
+        have_finfo = TRUE;
+    }
+
+  if (have_finfo)
+    {
+      svn_checksum_t *cached_checksum;
+      SVN_ERR(find_checksum(&cached_checksum, config_pool, path, &finfo,
+                            scratch_pool));
+      if (cached_checksum)
+        SVN_ERR(svn_object_pool__lookup((void **)cfg,
+                                        config_pool->object_pool,
+                                        checksum_as_key(cached_checksum,
+                                                        scratch_pool),
+                                        pool));
+
+      if (*cfg)
+        {
+          svn_pool_destroy(scratch_pool);
+
+          /* we need to duplicate the root structure as it contains temp.
+           * buffers */
+          *cfg = svn_config__shallow_copy(*cfg, pool);
+          return SVN_NO_ERROR;
+        }
+    }
+
+  access = svn_repos__create_config_access(preferred_repos, scratch_pool);
   err = svn_repos__get_config(&stream, &checksum, access, path, must_exist,
                               scratch_pool);
   if (!err)
@@ -128,6 +379,11 @@ svn_repos__config_pool_get(svn_config_t **cfg,
                                 "Error while parsing config file: '%s':",
                                 path);
 
+  /* Remember which content we just saw on disk, so the next access can
+   * skip straight to the cached object if the file is unchanged. */
+  if (!err && *cfg && have_finfo)
+    err = remember_checksum(config_pool, path, &finfo, checksum);
+
   /* Let the standard implementation handle all the difficult cases.
    * Note that for in-repo configs, there are no further special cases to
    * check for and deal with. */
@@ -23,6 +23,7 @@
 
 
 #include <apr_hash.h>
+#include <apr_strings.h>
 
 #include "svn_hash.h"
 #include "svn_types.h"
@@ -61,6 +62,12 @@ struct context {
   svn_boolean_t text_deltas;
   svn_boolean_t entry_props;
   svn_boolean_t ignore_ancestry;
+
+  /* Directory pairs that have been proven to have equal contents during
+     this traversal, keyed by the concatenation of both node revision IDs.
+     Lets us skip re-proving the same pair when it shows up again under
+     different parents (e.g. through copies). */
+  apr_hash_t *equal_pairs;
 };
 
 
@@ -304,6 +311,7 @@ svn_repos_dir_delta2(svn_fs_root_t *src_root,
   c.text_deltas = text_deltas;
   c.entry_props = entry_props;
   c.ignore_ancestry = ignore_ancestry;
+  c.equal_pairs = apr_hash_make(pool);
 
   /* Get our editor root's revision. */
   rootrev = get_path_revision(src_root, src_parent_dir, pool);
@@ -833,6 +841,104 @@ absent_file_or_dir(struct context *c,
 }
 
 
+/* Set *RESOLVED to the ID of the node revision that PATH under ROOT
+   would have if all trailing unmodified copies were undone.  I.e. while
+   PATH is the unmodified root of a copy, replace it with the copy
+   source and repeat.  ID is the node revision ID of PATH under ROOT.
+   If PATH has been modified since the most recent copy (or never been
+   copied), *RESOLVED is simply ID.  Allocate the result in POOL.  */
+static svn_error_t *
+resolve_unmodified_copy(const svn_fs_id_t **resolved,
+                        svn_fs_root_t *root,
+                        const char *path,
+                        const svn_fs_id_t *id,
+                        apr_pool_t *pool)
+{
+  while (TRUE)
+    {
+      svn_fs_root_t *copy_root;
+      const char *copy_path;
+      svn_fs_root_t *from_root;
+      const char *from_path;
+      svn_revnum_t from_rev;
+      const svn_fs_id_t *copy_id;
+
+      SVN_ERR(svn_fs_closest_copy(&copy_root, &copy_path, root, path, pool));
+
+      /* Only the copy root itself is cheap to map back to its source;
+         nodes below it are covered by plain ID equality anyway. */
+      if (copy_root == NULL || strcmp(copy_path, path) != 0)
+        break;
+
+      /* If the node revision we see is not the one the copy created,
+         the node has been modified since the copy. */
+      SVN_ERR(svn_fs_node_id(&copy_id, copy_root, copy_path, pool));
+      if (svn_fs_compare_ids(copy_id, id) != 0)
+        break;
+
+      SVN_ERR(svn_fs_copied_from(&from_rev, &from_path, copy_root,
+                                 copy_path, pool));
+      if (! SVN_IS_VALID_REVNUM(from_rev) || from_path == NULL)
+        break;
+
+      SVN_ERR(svn_fs_revision_root(&from_root, svn_fs_root_fs(root),
+                                   from_rev, pool));
+      SVN_ERR(svn_fs_node_id(&id, from_root, from_path, pool));
+
+      root = from_root;
+      path = from_path;
+    }
+
+  *resolved = id;
+  return SVN_NO_ERROR;
+}
+
+/* Set *UNCHANGED to TRUE if the related directories S_ENTRY at
+   SOURCE_PATH and T_ENTRY at TARGET_PATH in the context C can be proven
+   to have equal contents without walking their sub-trees, i.e. if both
+   resolve to the same node revision once unmodified copies have been
+   mapped back to their sources.  Proven-equal pairs are remembered in
+   C->EQUAL_PAIRS for the remainder of the traversal.  Use POOL for
+   temporary allocations.  */
+static svn_error_t *
+subtree_unchanged(svn_boolean_t *unchanged,
+                  struct context *c,
+                  const char *source_path,
+                  const char *target_path,
+                  const svn_fs_dirent_t *s_entry,
+                  const svn_fs_dirent_t *t_entry,
+                  apr_pool_t *pool)
+{
+  const svn_fs_id_t *s_resolved, *t_resolved;
+  const char *key;
+
+  *unchanged = FALSE;
+
+  /* Did we already prove this very pair equal during this drive? */
+  key = apr_pstrcat(pool,
+                    svn_fs_unparse_id(s_entry->id, pool)->data, " ",
+                    svn_fs_unparse_id(t_entry->id, pool)->data,
+                    SVN_VA_NULL);
+  if (svn_hash_gets(c->equal_pairs, key))
+    {
+      *unchanged = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(resolve_unmodified_copy(&s_resolved, c->source_root,
+                                  source_path, s_entry->id, pool));
+  SVN_ERR(resolve_unmodified_copy(&t_resolved, c->target_root,
+                                  target_path, t_entry->id, pool));
+  if (svn_fs_compare_ids(s_resolved, t_resolved) != 0)
+    return SVN_NO_ERROR;
+
+  key = apr_pstrdup(apr_hash_pool_get(c->equal_pairs), key);
+  svn_hash_sets(c->equal_pairs, key, key);
+  *unchanged = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
 /* Emit deltas to turn SOURCE_PATH into TARGET_PATH.  Assume that
    DIR_BATON represents the directory we're constructing to the editor
    in the context C.  */
@@ -931,11 +1037,28 @@ delta_dirs(struct context *c,
                 }
               else
                 {
-                  SVN_ERR(replace_file_or_dir(c, dir_baton,
-                                              MAYBE_DEMOTE_DEPTH(depth),
+                  svn_boolean_t unchanged = FALSE;
+
+                  /* Directories with different node revision IDs may
+                     still be unmodified copies of the same node.  Prove
+                     that without walking them, if we can; pruning here
+                     matches the no-op we emit for identical IDs.
+                     With entry props enabled, the replace would emit
+                     committed-rev / committed-date / last-author props,
+                     which differ on copy roots even when the contents
+                     are identical, so never prune in that case. */
+                  if (src_kind == svn_node_dir && tgt_kind == svn_node_dir
+                      && distance == 1 && !c->entry_props)
+                    SVN_ERR(subtree_unchanged(&unchanged, c,
                                               s_fullpath, t_fullpath,
-                                              e_fullpath, tgt_kind,
-                                              subpool));
+                                              s_entry, t_entry, subpool));
+
+                  if (! unchanged)
+                    SVN_ERR(replace_file_or_dir(c, dir_baton,
+                                                MAYBE_DEMOTE_DEPTH(depth),
+                                                s_fullpath, t_fullpath,
+                                                e_fullpath, tgt_kind,
+                                                subpool));
                 }
             }
 
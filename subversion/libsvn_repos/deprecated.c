@@ -179,6 +179,19 @@ recovery_started(void *baton,
     svn_error_clear(rb->start_callback(rb->start_callback_baton));
 }
 
+svn_error_t *
+svn_repos_recover4(const char *path,
+                   svn_boolean_t nonblocking,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool)
+{
+  return svn_repos_recover5(path, nonblocking, notify_func, notify_baton,
+                            cancel_func, cancel_baton, NULL, pool);
+}
+
 svn_error_t *
 svn_repos_recover3(const char *path,
                    svn_boolean_t nonblocking,
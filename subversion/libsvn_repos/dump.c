@@ -45,6 +45,7 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_task.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
@@ -2021,26 +2022,352 @@ dump_filter_authz_func(svn_boolean_t *allowed,
 
 
 
-/* The main dumper. */
-svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
-                   svn_stream_t *stream,
-                   svn_revnum_t start_rev,
-                   svn_revnum_t end_rev,
-                   svn_boolean_t incremental,
-                   svn_boolean_t use_deltas,
-                   svn_boolean_t include_revprops,
-                   svn_boolean_t include_changes,
-                   svn_repos_notify_func_t notify_func,
-                   void *notify_baton,
-                   svn_repos_dump_filter_func_t filter_func,
-                   void *filter_baton,
-                   svn_cancel_func_t cancel_func,
-                   void *cancel_baton,
-                   apr_pool_t *pool)
+/* Dump exactly one revision REV of REPOS to STREAM:  the revision record
+   and, unless REV is 0 or INCLUDE_CHANGES is not set, all node records.
+   This is the per-revision body of the main dump loop; see
+   svn_repos_dump_fs4 for the meaning of the remaining parameters.
+   Allocate temporaries in POOL. */
+static svn_error_t *
+dump_revision(svn_stream_t *stream,
+              svn_repos_t *repos,
+              svn_revnum_t rev,
+              svn_revnum_t start_rev,
+              svn_boolean_t incremental,
+              svn_boolean_t use_deltas,
+              svn_boolean_t include_revprops,
+              svn_boolean_t include_changes,
+              svn_boolean_t *found_old_reference,
+              svn_boolean_t *found_old_mergeinfo,
+              svn_repos_authz_func_t authz_func,
+              void *authz_baton,
+              svn_repos_notify_func_t notify_func,
+              void *notify_baton,
+              apr_pool_t *pool)
 {
+  svn_fs_t *fs = svn_repos_fs(repos);
   const svn_delta_editor_t *dump_editor;
   void *dump_edit_baton = NULL;
+  svn_fs_root_t *to_root;
+  svn_boolean_t use_deltas_for_rev;
+
+  /* Write the revision record. */
+  SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
+                                authz_func, authz_baton, pool));
+
+  /* When dumping revision 0, we just write out the revision record.
+     The parser might want to use its properties.
+     If we don't want revision changes at all, skip in any case. */
+  if (rev == 0 || !include_changes)
+    return SVN_NO_ERROR;
+
+  /* Fetch the editor which dumps nodes to a file.  Regardless of
+     what we've been told, don't use deltas for the first rev of a
+     non-incremental dump. */
+  use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
+  SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
+                          "", stream, found_old_reference,
+                          found_old_mergeinfo, NULL,
+                          notify_func, notify_baton,
+                          start_rev, use_deltas_for_rev, FALSE, FALSE,
+                          pool));
+
+  /* Drive the editor in one way or another. */
+  SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, pool));
+
+  /* If this is the first revision of a non-incremental dump,
+     we're in for a full tree dump.  Otherwise, we want to simply
+     replay the revision.  */
+  if ((rev == start_rev) && (! incremental))
+    {
+      /* Compare against revision 0, so everything appears to be added. */
+      svn_fs_root_t *from_root;
+      SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, pool));
+      SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
+                                   to_root, "",
+                                   dump_editor, dump_edit_baton,
+                                   authz_func, authz_baton,
+                                   FALSE, /* don't send text-deltas */
+                                   svn_depth_infinity,
+                                   FALSE, /* don't send entry props */
+                                   FALSE, /* don't ignore ancestry */
+                                   pool));
+    }
+  else
+    {
+      /* The normal case: compare consecutive revs. */
+      SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
+                                dump_editor, dump_edit_baton,
+                                authz_func, authz_baton, pool));
+
+      /* While our editor close_edit implementation is a no-op, we still
+         do this for completeness. */
+      SVN_ERR(dump_editor->close_edit(dump_edit_baton, pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** Parallel dump engine. ***/
+
+/* Number of revisions to render per task run and thread.  Together with
+   the thread count, this bounds the number of rendered revision buffers
+   that can be in flight at any time. */
+#define DUMP_PARALLEL_WINDOW_PER_THREAD 16
+
+/* State shared by all tasks of one parallel dump. */
+typedef struct dump_parallel_baton_t
+{
+  /* Path to the repository so that workers can open private instances. */
+  const char *repos_path;
+
+  /* The output stream.  Only ever written from the calling thread. */
+  svn_stream_t *stream;
+
+  /* Dump parameters, as for svn_repos_dump_fs4. */
+  svn_revnum_t start_rev;
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+
+  /* Dump filtering, already wrapped as an authz callback.
+     AUTHZ_FUNC may be NULL and may be called from worker threads. */
+  svn_repos_authz_func_t authz_func;
+  void *authz_baton;
+
+  /* User notification callback, invoked on the calling thread only. */
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+
+  /* The caller's aggregated warning flags, updated on the calling
+     thread. */
+  svn_boolean_t *found_old_reference;
+  svn_boolean_t *found_old_mergeinfo;
+
+  /* Reusable dump_rev_end notification.  NULL iff NOTIFY_FUNC is NULL. */
+  svn_repos_notify_t *rev_end_notify;
+} dump_parallel_baton_t;
+
+/* A single revision to render, i.e. the process baton of one task. */
+typedef struct dump_rev_work_t
+{
+  dump_parallel_baton_t *pb;
+  svn_revnum_t rev;
+} dump_rev_work_t;
+
+/* The per-worker-thread context:  a private repository instance, so that
+   workers read the filesystem independently of one another. */
+typedef struct dump_thread_context_t
+{
+  svn_repos_t *repos;
+} dump_thread_context_t;
+
+/* A rendered revision, i.e. the result of one task. */
+typedef struct dump_rev_result_t
+{
+  /* The revision this result is for. */
+  svn_revnum_t rev;
+
+  /* The complete dump stream contents for this revision. */
+  svn_stringbuf_t *dump_text;
+
+  /* Notifications (svn_repos_notify_t *) issued while rendering, to be
+     replayed through the user's callback on the calling thread. */
+  apr_array_header_t *notifications;
+
+  /* Warning flags set while rendering this revision. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_rev_result_t;
+
+/* Baton for dump_collect_notify_func. */
+typedef struct dump_collect_notify_baton_t
+{
+  /* Where to collect the notifications and the pool to copy them into. */
+  apr_array_header_t *notifications;
+  apr_pool_t *pool;
+} dump_collect_notify_baton_t;
+
+/* Implements svn_repos_notify_func_t.  Collect a deep copy of NOTIFY
+   instead of forwarding it, to be replayed on the calling thread. */
+static void
+dump_collect_notify_func(void *baton,
+                         const svn_repos_notify_t *notify,
+                         apr_pool_t *scratch_pool)
+{
+  dump_collect_notify_baton_t *cb = baton;
+  svn_repos_notify_t *copy = apr_pmemdup(cb->pool, notify, sizeof(*notify));
+
+  /* The dump code only ever sets these string members. */
+  if (notify->warning_str)
+    copy->warning_str = apr_pstrdup(cb->pool, notify->warning_str);
+  if (notify->path)
+    copy->path = apr_pstrdup(cb->pool, notify->path);
+
+  APR_ARRAY_PUSH(cb->notifications, svn_repos_notify_t *) = copy;
+}
+
+/* Implements svn_task__thread_context_constructor_t.  Open a private
+   repository instance for this worker thread. */
+static svn_error_t *
+dump_context_constructor(void **thread_context,
+                         void *context_baton,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  dump_parallel_baton_t *pb = context_baton;
+  dump_thread_context_t *context = apr_pcalloc(result_pool,
+                                               sizeof(*context));
+
+  SVN_ERR(svn_repos_open3(&context->repos, pb->repos_path, NULL,
+                          result_pool, scratch_pool));
+
+  *thread_context = context;
+  return SVN_NO_ERROR;
+}
+
+/* Render one revision into a buffer.
+   Implements svn_task__process_func_t; runs on a worker thread. */
+static svn_error_t *
+dump_rev_process_func(void **result,
+                      svn_task__t *task,
+                      void *thread_context,
+                      void *process_baton,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  dump_rev_work_t *work = process_baton;
+  dump_parallel_baton_t *pb = work->pb;
+  dump_thread_context_t *context = thread_context;
+  dump_rev_result_t *r = apr_pcalloc(result_pool, sizeof(*r));
+  dump_collect_notify_baton_t cb;
+  svn_stream_t *buffer_stream;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  r->rev = work->rev;
+  r->dump_text = svn_stringbuf_create_empty(result_pool);
+  r->notifications = apr_array_make(result_pool, 0,
+                                    sizeof(svn_repos_notify_t *));
+  cb.notifications = r->notifications;
+  cb.pool = result_pool;
+
+  buffer_stream = svn_stream_from_stringbuf(r->dump_text, scratch_pool);
+  SVN_ERR(dump_revision(buffer_stream, context->repos, work->rev,
+                        pb->start_rev, pb->incremental, pb->use_deltas,
+                        pb->include_revprops, pb->include_changes,
+                        &r->found_old_reference, &r->found_old_mergeinfo,
+                        pb->authz_func, pb->authz_baton,
+                        pb->notify_func ? dump_collect_notify_func : NULL,
+                        pb->notify_func ? &cb : NULL,
+                        scratch_pool));
+
+  *result = r;
+  return SVN_NO_ERROR;
+}
+
+/* Emit a rendered revision:  write its buffer to the output stream and
+   replay its notifications.
+   Implements svn_task__output_func_t; runs on the calling thread, in
+   revision order. */
+static svn_error_t *
+dump_rev_output_func(svn_task__t *task,
+                     void *result,
+                     void *output_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  dump_rev_result_t *r = result;
+  dump_parallel_baton_t *pb = output_baton;
+  apr_size_t len = r->dump_text->len;
+
+  SVN_ERR(svn_stream_write(pb->stream, r->dump_text->data, &len));
+
+  *pb->found_old_reference |= r->found_old_reference;
+  *pb->found_old_mergeinfo |= r->found_old_mergeinfo;
+
+  if (pb->notify_func)
+    {
+      int i;
+      for (i = 0; i < r->notifications->nelts; ++i)
+        pb->notify_func(pb->notify_baton,
+                        APR_ARRAY_IDX(r->notifications, i,
+                                      svn_repos_notify_t *),
+                        scratch_pool);
+
+      pb->rev_end_notify->revision = r->rev;
+      pb->notify_func(pb->notify_baton, pb->rev_end_notify, scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* The revision range [FIRST, AFTER_LAST) to render in one task run. */
+typedef struct dump_window_t
+{
+  dump_parallel_baton_t *pb;
+  svn_revnum_t first;
+  svn_revnum_t after_last;
+} dump_window_t;
+
+/* Spawn one rendering sub-task per revision in the window.
+   Implements svn_task__process_func_t for the root task. */
+static svn_error_t *
+dump_window_process_func(void **result,
+                         svn_task__t *task,
+                         void *thread_context,
+                         void *process_baton,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  dump_window_t *window = process_baton;
+  svn_revnum_t rev;
+
+  for (rev = window->first; rev < window->after_last; ++rev)
+    {
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      dump_rev_work_t *work = apr_pcalloc(process_pool, sizeof(*work));
+
+      work->pb = window->pb;
+      work->rev = rev;
+      SVN_ERR(svn_task__add(task, process_pool, NULL,
+                            dump_rev_process_func, work,
+                            dump_rev_output_func, window->pb));
+    }
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
+
+/* The main dumper:  the body shared by svn_repos_dump_fs4 and
+   svn_repos__dump_fs_parallel, which see for the parameters. */
+static svn_error_t *
+dump_fs(svn_repos_t *repos,
+        svn_stream_t *stream,
+        svn_revnum_t start_rev,
+        svn_revnum_t end_rev,
+        svn_boolean_t incremental,
+        svn_boolean_t use_deltas,
+        svn_boolean_t include_revprops,
+        svn_boolean_t include_changes,
+        svn_repos_notify_func_t notify_func,
+        void *notify_baton,
+        svn_repos_dump_filter_func_t filter_func,
+        void *filter_baton,
+        apr_int32_t thread_count,
+        svn_cancel_func_t cancel_func,
+        void *cancel_baton,
+        apr_pool_t *pool)
+{
   svn_revnum_t rev;
   svn_fs_t *fs = svn_repos_fs(repos);
   apr_pool_t *iterpool = svn_pool_create(pool);
@@ -2113,77 +2440,70 @@ svn_repos_dump_fs4(svn_repos_t *repos,
     notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
                                      pool);
 
-  /* Main loop:  we're going to dump revision REV.  */
-  for (rev = start_rev; rev <= end_rev; rev++)
+  if (thread_count > 1)
     {
-      svn_fs_root_t *to_root;
-      svn_boolean_t use_deltas_for_rev;
-
-      svn_pool_clear(iterpool);
-
-      /* Check for cancellation. */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* Write the revision record. */
-      SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
-
-      /* When dumping revision 0, we just write out the revision record.
-         The parser might want to use its properties.
-         If we don't want revision changes at all, skip in any case. */
-      if (rev == 0 || !include_changes)
-        goto loop_end;
-
-      /* Fetch the editor which dumps nodes to a file.  Regardless of
-         what we've been told, don't use deltas for the first rev of a
-         non-incremental dump. */
-      use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
-      SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
-                              notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
-
-      /* Drive the editor in one way or another. */
-      SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
-
-      /* If this is the first revision of a non-incremental dump,
-         we're in for a full tree dump.  Otherwise, we want to simply
-         replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
+      /* Parallel dump:  workers render whole revisions into buffers
+         which we emit in revision order.  Process the range in windows
+         to bound the number of buffers in flight. */
+      dump_parallel_baton_t pb = { 0 };
+      svn_revnum_t window_size
+        = (svn_revnum_t)thread_count * DUMP_PARALLEL_WINDOW_PER_THREAD;
+
+      pb.repos_path = svn_repos_path(repos, pool);
+      pb.stream = stream;
+      pb.start_rev = start_rev;
+      pb.incremental = incremental;
+      pb.use_deltas = use_deltas;
+      pb.include_revprops = include_revprops;
+      pb.include_changes = include_changes;
+      pb.authz_func = authz_func;
+      pb.authz_baton = &authz_baton;
+      pb.notify_func = notify_func;
+      pb.notify_baton = notify_baton;
+      pb.found_old_reference = &found_old_reference;
+      pb.found_old_mergeinfo = &found_old_mergeinfo;
+      pb.rev_end_notify = notify_func ? notify : NULL;
+
+      for (rev = start_rev; rev <= end_rev; rev = rev + window_size)
         {
-          /* Compare against revision 0, so everything appears to be added. */
-          svn_fs_root_t *from_root;
-          SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, iterpool));
-          SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
-                                       to_root, "",
-                                       dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
-                                       FALSE, /* don't send text-deltas */
-                                       svn_depth_infinity,
-                                       FALSE, /* don't send entry props */
-                                       FALSE, /* don't ignore ancestry */
-                                       iterpool));
+          dump_window_t window;
+
+          svn_pool_clear(iterpool);
+
+          window.pb = &pb;
+          window.first = rev;
+          window.after_last = MIN(rev + window_size, end_rev + 1);
+          SVN_ERR(svn_task__run(thread_count,
+                                dump_window_process_func, &window,
+                                NULL, NULL,
+                                dump_context_constructor, &pb,
+                                cancel_func, cancel_baton,
+                                iterpool, iterpool));
         }
-      else
+    }
+  else
+    {
+      /* Main loop:  we're going to dump revision REV.  */
+      for (rev = start_rev; rev <= end_rev; rev++)
         {
-          /* The normal case: compare consecutive revs. */
-          SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
-                                    dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
-
-          /* While our editor close_edit implementation is a no-op, we still
-             do this for completeness. */
-          SVN_ERR(dump_editor->close_edit(dump_edit_baton, iterpool));
-        }
+          svn_pool_clear(iterpool);
 
-    loop_end:
-      if (notify_func)
-        {
-          notify->revision = rev;
-          notify_func(notify_baton, notify, iterpool);
+          /* Check for cancellation. */
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          SVN_ERR(dump_revision(stream, repos, rev, start_rev,
+                                incremental, use_deltas, include_revprops,
+                                include_changes, &found_old_reference,
+                                &found_old_mergeinfo,
+                                authz_func, &authz_baton,
+                                notify_func, notify_baton, iterpool));
+
+          if (notify_func)
+            {
+              notify->revision = rev;
+              notify_func(notify_baton, notify, iterpool);
+            }
         }
     }
 
@@ -2225,6 +2545,55 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_repos_dump_fs4(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool)
+{
+  return svn_error_trace(dump_fs(repos, stream, start_rev, end_rev,
+                                 incremental, use_deltas, include_revprops,
+                                 include_changes, notify_func, notify_baton,
+                                 filter_func, filter_baton, 1,
+                                 cancel_func, cancel_baton, pool));
+}
+
+svn_error_t *
+svn_repos__dump_fs_parallel(svn_repos_t *repos,
+                            svn_stream_t *stream,
+                            svn_revnum_t start_rev,
+                            svn_revnum_t end_rev,
+                            svn_boolean_t incremental,
+                            svn_boolean_t use_deltas,
+                            svn_boolean_t include_revprops,
+                            svn_boolean_t include_changes,
+                            svn_repos_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_repos_dump_filter_func_t filter_func,
+                            void *filter_baton,
+                            apr_int32_t thread_count,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
+{
+  return svn_error_trace(dump_fs(repos, stream, start_rev, end_rev,
+                                 incremental, use_deltas, include_revprops,
+                                 include_changes, notify_func, notify_baton,
+                                 filter_func, filter_baton, thread_count,
+                                 cancel_func, cancel_baton, pool));
+}
+
 
 /*----------------------------------------------------------------------*/
 
@@ -36,6 +36,7 @@
 #include "svn_subst.h"
 #include "repos.h"
 #include "svn_private_config.h"
+#include "private/svn_fs_private.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_utf_private.h"
@@ -455,6 +456,97 @@ svn_repos_fs_change_rev_prop4(svn_repos_t *repos,
 }
 
 
+svn_error_t *
+svn_repos_fs_change_rev_props(svn_repos_t *repos,
+                              svn_revnum_t rev,
+                              const char *author,
+                              const apr_array_header_t *props,
+                              svn_boolean_t use_pre_revprop_change_hook,
+                              svn_boolean_t use_post_revprop_change_hook,
+                              svn_repos_authz_func_t authz_read_func,
+                              void *authz_read_baton,
+                              apr_pool_t *pool)
+{
+  svn_repos_revision_access_level_t readability;
+  apr_hash_t *old_props;
+  apr_hash_t *hooks_env = NULL;
+  int i;
+
+  /* Perform the authorization check only once for the whole batch. */
+  SVN_ERR(svn_repos_check_revision_access(&readability, repos, rev,
+                                          authz_read_func, authz_read_baton,
+                                          pool));
+
+  if (readability != svn_repos_revision_access_full)
+    return svn_error_createf
+      (SVN_ERR_AUTHZ_UNREADABLE, NULL,
+       _("Write denied:  not authorized to read all of revision %ld"), rev);
+
+  for (i = 0; i < props->nelts; i++)
+    {
+      const svn_prop_t *prop = &APR_ARRAY_IDX(props, i, svn_prop_t);
+
+      SVN_ERR(svn_repos__validate_prop(prop->name, prop->value, pool));
+    }
+
+  /* Fetch all preexisting values in one go, in order for the ACTION and
+   * OLD_VALUE arguments to the hooks to be accurate. */
+  SVN_ERR(svn_fs_revision_proplist2(&old_props, repos->fs, rev, TRUE,
+                                    pool, pool));
+
+  /* Parse the hooks-env file (if any, and if to be used). */
+  if (use_pre_revprop_change_hook || use_post_revprop_change_hook)
+    SVN_ERR(svn_repos__parse_hooks_env(&hooks_env, repos->hooks_env_path,
+                                       pool, pool));
+
+  /* The hooks accept only a single property per invocation, so they run
+   * once per change even though the filesystem write happens only once. */
+  if (use_pre_revprop_change_hook)
+    for (i = 0; i < props->nelts; i++)
+      {
+        const svn_prop_t *prop = &APR_ARRAY_IDX(props, i, svn_prop_t);
+        const svn_string_t *old_value = svn_hash_gets(old_props, prop->name);
+        char action;
+
+        if (! prop->value)
+          action = 'D';
+        else if (! old_value)
+          action = 'A';
+        else
+          action = 'M';
+
+        SVN_ERR(svn_repos__hooks_pre_revprop_change(repos, hooks_env, rev,
+                                                    author, prop->name,
+                                                    prop->value, action,
+                                                    pool));
+      }
+
+  SVN_ERR(svn_fs__change_rev_props(repos->fs, rev, props, pool));
+
+  if (use_post_revprop_change_hook)
+    for (i = 0; i < props->nelts; i++)
+      {
+        const svn_prop_t *prop = &APR_ARRAY_IDX(props, i, svn_prop_t);
+        const svn_string_t *old_value = svn_hash_gets(old_props, prop->name);
+        char action;
+
+        if (! prop->value)
+          action = 'D';
+        else if (! old_value)
+          action = 'A';
+        else
+          action = 'M';
+
+        SVN_ERR(svn_repos__hooks_post_revprop_change(repos, hooks_env, rev,
+                                                     author, prop->name,
+                                                     old_value, action,
+                                                     pool));
+      }
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_repos_fs_revision_prop(svn_string_t **value_p,
                            svn_repos_t *repos,
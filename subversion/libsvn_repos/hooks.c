@@ -45,6 +45,55 @@
 
 /*** Hook drivers. ***/
 
+/* Append the hook's UTF8_STDERR output, if any, to FAILURE_MESSAGE and
+   return the resulting SVN_ERR_REPOS_HOOK_FAILURE error. */
+static svn_error_t *
+hook_failure_with_output(svn_stringbuf_t *failure_message,
+                         const char *utf8_stderr)
+{
+  if (utf8_stderr[0])
+    {
+      svn_stringbuf_appendcstr(failure_message,
+                               _(" with output:\n"));
+      svn_stringbuf_appendcstr(failure_message, utf8_stderr);
+    }
+  else
+    {
+      svn_stringbuf_appendcstr(failure_message,
+                               _(" with no output."));
+    }
+
+  return svn_error_create(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+                          failure_message->data);
+}
+
+/* Return the message reporting that hook NAME exited with EXITCODE,
+   phrased after the action the hook blocked where applicable. */
+static svn_stringbuf_t *
+hook_exitcode_message(const char *name, int exitcode, apr_pool_t *pool)
+{
+  const char *action;
+
+  if (strcmp(name, "start-commit") == 0
+      || strcmp(name, "pre-commit") == 0)
+    action = _("Commit");
+  else if (strcmp(name, "pre-revprop-change") == 0)
+    action = _("Revprop change");
+  else if (strcmp(name, "pre-lock") == 0)
+    action = _("Lock");
+  else if (strcmp(name, "pre-unlock") == 0)
+    action = _("Unlock");
+  else
+    action = NULL;
+
+  if (action == NULL)
+    return svn_stringbuf_createf(pool, _("%s hook failed (exit code %d)"),
+                                 name, exitcode);
+
+  return svn_stringbuf_createf(pool, _("%s blocked by %s hook (exit code %d)"),
+                               action, name, exitcode);
+}
+
 /* Helper function for run_hook_cmd().  Wait for a hook to finish
    executing and return either SVN_NO_ERROR if the hook script completed
    without error, or an error describing the reason for failure.
@@ -124,42 +173,10 @@ check_hook_result(const char *name, const char *cmd, apr_proc_t *cmd_proc,
     }
   else
     {
-      const char *action;
-      if (strcmp(name, "start-commit") == 0
-          || strcmp(name, "pre-commit") == 0)
-        action = _("Commit");
-      else if (strcmp(name, "pre-revprop-change") == 0)
-        action = _("Revprop change");
-      else if (strcmp(name, "pre-lock") == 0)
-        action = _("Lock");
-      else if (strcmp(name, "pre-unlock") == 0)
-        action = _("Unlock");
-      else
-        action = NULL;
-      if (action == NULL)
-        failure_message = svn_stringbuf_createf(
-            pool, _("%s hook failed (exit code %d)"),
-            name, exitcode);
-      else
-        failure_message = svn_stringbuf_createf(
-            pool, _("%s blocked by %s hook (exit code %d)"),
-            action, name, exitcode);
+      failure_message = hook_exitcode_message(name, exitcode, pool);
     }
 
-  if (utf8_stderr[0])
-    {
-      svn_stringbuf_appendcstr(failure_message,
-                               _(" with output:\n"));
-      svn_stringbuf_appendcstr(failure_message, utf8_stderr);
-    }
-  else
-    {
-      svn_stringbuf_appendcstr(failure_message,
-                               _(" with no output."));
-    }
-
-  return svn_error_create(SVN_ERR_REPOS_HOOK_FAILURE, err,
-                          failure_message->data);
+  return hook_failure_with_output(failure_message, utf8_stderr);
 }
 
 /* Copy the environment given as key/value pairs of ENV_HASH into
@@ -193,18 +210,349 @@ env_from_env_hash(apr_hash_t *env_hash,
   return env;
 }
 
+static const char *
+check_hook_cmd(const char *hook, svn_boolean_t *broken_link,
+               apr_pool_t *pool);
+
+
+/*** The persistent hook runner. ***
+
+   Starting a hook costs a fork and exec per invocation, which is
+   painful when the hooks themselves are written in a language with a
+   slow interpreter start-up.  If the hooks directory contains an
+   executable SVN_REPOS__HOOK_RUNNER program, we start it once per
+   repository object and dispatch individual hook invocations to it
+   over its stdin/stdout pipes, so the runner can keep its interpreter
+   (and any application state) warm across invocations.  If there is
+   no runner, or if talking to it fails, we quietly fall back to the
+   classic one-process-per-hook path.
+
+   The protocol is line- and netstring-oriented.  Each request is:
+
+       hook\n
+       <hook name>\n
+       <hook program path>\n
+       <number of arguments>\n
+       <length>:<argument bytes>          (for each argument)
+       <number of environment settings>\n (-1: inherit the environment)
+       <length>:<NAME=VALUE bytes>        (for each setting)
+       <length>:<stdin bytes>
+
+   and the runner answers with
+
+       <exit code> <stdout length> <stderr length>\n
+
+   followed by the hook's stdout and stderr bytes.  The runner is
+   expected to apply the environment, run the named hook with the given
+   arguments and stdin, and report its exit code and output; whether it
+   does so by exec'ing the hook program or by hosting it in-process is
+   its own business. */
+
+struct svn_repos__hook_runner_t
+{
+  /* The pool holding PROC and its pipes.  Destroying it terminates
+     the runner process. */
+  apr_pool_t *pool;
+
+  /* The running hook runner process. */
+  apr_proc_t proc;
+
+  /* Request and response pipes, i.e. PROC's stdin and stdout. */
+  apr_file_t *to_runner;
+  apr_file_t *from_runner;
+
+  /* True if there is no usable runner, either because the hooks
+     directory does not provide one or because talking to it failed. */
+  svn_boolean_t broken;
+};
+
+/* Limit on the response header line and on each of the two response
+   bodies, as a guard against a confused runner. */
+#define HOOK_RUNNER_MAX_OUTPUT (64 * 1024 * 1024)
+
+/* Set REPOS->hook_runner, starting the runner process on the first
+   call if the hooks directory provides one.  A missing runner or a
+   failure to start it leaves a runner marked broken; it is not an
+   error.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+ensure_hook_runner(svn_repos_t *repos, apr_pool_t *scratch_pool)
+{
+  struct svn_repos__hook_runner_t *runner;
+  svn_boolean_t broken_link;
+  const char *hook;
+  const char *args[2];
+  svn_error_t *err;
+
+  if (repos->hook_runner)
+    return SVN_NO_ERROR;
+
+  runner = apr_pcalloc(repos->pool, sizeof(*runner));
+  runner->broken = TRUE;
+  repos->hook_runner = runner;
+
+  hook = svn_dirent_join(repos->hook_path, SVN_REPOS__HOOK_RUNNER,
+                         scratch_pool);
+  hook = check_hook_cmd(hook, &broken_link, scratch_pool);
+  if (hook == NULL || broken_link)
+    return SVN_NO_ERROR;
+
+  runner->pool = svn_pool_create(repos->pool);
+  hook = apr_pstrdup(runner->pool, hook);
+  args[0] = hook;
+  args[1] = NULL;
+
+  err = svn_io_start_cmd3(&runner->proc, repos->hook_path, hook, args,
+                          NULL, FALSE, TRUE, NULL, TRUE, NULL,
+                          FALSE, NULL, runner->pool);
+  if (err)
+    {
+      /* Treat a runner we cannot start like a missing one. */
+      svn_error_clear(err);
+      svn_pool_destroy(runner->pool);
+      runner->pool = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  runner->to_runner = runner->proc.in;
+  runner->from_runner = runner->proc.out;
+  runner->broken = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Give up on RUNNER, terminating the runner process.  Further hook
+   invocations will use the classic exec path. */
+static void
+break_hook_runner(struct svn_repos__hook_runner_t *runner)
+{
+  runner->broken = TRUE;
+  runner->to_runner = NULL;
+  runner->from_runner = NULL;
+  if (runner->pool)
+    {
+      svn_pool_destroy(runner->pool);
+      runner->pool = NULL;
+    }
+}
+
+/* Write LEN bytes of DATA to FILE as a counted string, i.e. prefixed
+   with "LEN:".  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+runner_write_counted(apr_file_t *file, const char *data, apr_size_t len,
+                     apr_pool_t *scratch_pool)
+{
+  const char *header = apr_psprintf(scratch_pool, "%" APR_SIZE_T_FMT ":",
+                                    len);
+
+  SVN_ERR(svn_io_file_write_full(file, header, strlen(header), NULL,
+                                 scratch_pool));
+  return svn_error_trace(svn_io_file_write_full(file, data, len, NULL,
+                                                scratch_pool));
+}
+
+/* Read the response header line from FILE into *EXITCODE, *STDOUT_LEN
+   and *STDERR_LEN.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+runner_read_header(int *exitcode,
+                   apr_size_t *stdout_len,
+                   apr_size_t *stderr_len,
+                   apr_file_t *file,
+                   apr_pool_t *scratch_pool)
+{
+  char line[128];
+  apr_size_t i;
+  unsigned long out_len, err_len;
+
+  for (i = 0; i < sizeof(line) - 1; i++)
+    {
+      SVN_ERR(svn_io_file_getc(&line[i], file, scratch_pool));
+      if (line[i] == '\n')
+        break;
+    }
+  if (i >= sizeof(line) - 1)
+    return svn_error_create(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+                            _("Malformed response from hook runner"));
+  line[i] = '\0';
+
+  if (sscanf(line, "%d %lu %lu", exitcode, &out_len, &err_len) != 3
+      || out_len > HOOK_RUNNER_MAX_OUTPUT
+      || err_len > HOOK_RUNNER_MAX_OUTPUT)
+    return svn_error_create(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+                            _("Malformed response from hook runner"));
+
+  *stdout_len = (apr_size_t)out_len;
+  *stderr_len = (apr_size_t)err_len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Dispatch one hook invocation to RUNNER.  NAME, CMD and ARGS are as
+   for run_hook_cmd(), HOOK_ENV is the (possibly NULL) environment hash
+   already resolved for this hook, and STDIN_DATA is the content to
+   present on the hook's stdin.  Set *EXITCODE to the hook's exit code
+   and *HOOK_STDOUT and *HOOK_STDERR to its output, allocated in POOL.
+
+   Any error returned here means the conversation with the runner is in
+   an undefined state and the runner must not be used again. */
+static svn_error_t *
+runner_exchange(int *exitcode,
+                svn_stringbuf_t **hook_stdout,
+                svn_stringbuf_t **hook_stderr,
+                struct svn_repos__hook_runner_t *runner,
+                const char *name,
+                const char *cmd,
+                const char **args,
+                apr_hash_t *hook_env,
+                svn_stringbuf_t *stdin_data,
+                apr_pool_t *pool)
+{
+  const char *header;
+  const char **envp = env_from_env_hash(hook_env, pool, pool);
+  int argc, envc, i;
+  apr_size_t stdout_len, stderr_len;
+
+  for (argc = 0; args[argc]; argc++)
+    ;
+  envc = -1;
+  if (envp)
+    for (envc = 0; envp[envc]; envc++)
+      ;
+
+  header = apr_psprintf(pool, "hook\n%s\n%s\n%d\n", name, cmd, argc);
+  SVN_ERR(svn_io_file_write_full(runner->to_runner, header, strlen(header),
+                                 NULL, pool));
+  for (i = 0; i < argc; i++)
+    SVN_ERR(runner_write_counted(runner->to_runner, args[i], strlen(args[i]),
+                                 pool));
+
+  header = apr_psprintf(pool, "%d\n", envc);
+  SVN_ERR(svn_io_file_write_full(runner->to_runner, header, strlen(header),
+                                 NULL, pool));
+  for (i = 0; i < envc; i++)
+    SVN_ERR(runner_write_counted(runner->to_runner, envp[i], strlen(envp[i]),
+                                 pool));
+
+  SVN_ERR(runner_write_counted(runner->to_runner, stdin_data->data,
+                               stdin_data->len, pool));
+  SVN_ERR(svn_io_file_flush(runner->to_runner, pool));
+
+  SVN_ERR(runner_read_header(exitcode, &stdout_len, &stderr_len,
+                             runner->from_runner, pool));
+
+  *hook_stdout = svn_stringbuf_create_ensure(stdout_len, pool);
+  SVN_ERR(svn_io_file_read_full2(runner->from_runner, (*hook_stdout)->data,
+                                 stdout_len, NULL, NULL, pool));
+  (*hook_stdout)->len = stdout_len;
+  (*hook_stdout)->data[stdout_len] = '\0';
+
+  *hook_stderr = svn_stringbuf_create_ensure(stderr_len, pool);
+  SVN_ERR(svn_io_file_read_full2(runner->from_runner, (*hook_stderr)->data,
+                                 stderr_len, NULL, NULL, pool));
+  (*hook_stderr)->len = stderr_len;
+  (*hook_stderr)->data[stderr_len] = '\0';
+
+  return SVN_NO_ERROR;
+}
+
+/* Try to run a hook through REPOS's persistent hook runner.  The
+   arguments are as for run_hook_cmd(), except that HOOK_ENV is the
+   environment hash already resolved for this hook.
+
+   Set *USED to TRUE if the runner handled the invocation, in which
+   case the result is as if run_hook_cmd() had run the hook itself.
+   Set *USED to FALSE if there is no usable runner or talking to it
+   failed; the caller then runs the hook the classic way.  In the
+   latter case STDIN_HANDLE, if non-null, is rewound so the caller can
+   replay it. */
+static svn_error_t *
+run_hook_via_runner(svn_boolean_t *used,
+                    svn_string_t **result,
+                    svn_repos_t *repos,
+                    const char *name,
+                    const char *cmd,
+                    const char **args,
+                    apr_hash_t *hook_env,
+                    apr_file_t *stdin_handle,
+                    apr_pool_t *pool)
+{
+  struct svn_repos__hook_runner_t *runner;
+  svn_stringbuf_t *stdin_data;
+  svn_stringbuf_t *hook_stdout, *hook_stderr;
+  int exitcode;
+  svn_error_t *err;
+
+  *used = FALSE;
+
+  SVN_ERR(ensure_hook_runner(repos, pool));
+  runner = repos->hook_runner;
+  if (runner->broken)
+    return SVN_NO_ERROR;
+
+  /* The runner cannot share STDIN_HANDLE, so read the content up front.
+     All stdin handles passed to hooks are rewindable files. */
+  if (stdin_handle)
+    SVN_ERR(svn_stringbuf_from_aprfile(&stdin_data, stdin_handle, pool));
+  else
+    stdin_data = svn_stringbuf_create_empty(pool);
+
+  err = runner_exchange(&exitcode, &hook_stdout, &hook_stderr, runner,
+                        name, cmd, args, hook_env, stdin_data, pool);
+  if (err)
+    {
+      /* The runner is out of step; drop it and fall back to exec'ing
+         the hook ourselves. */
+      svn_error_clear(err);
+      break_hook_runner(runner);
+      if (stdin_handle)
+        {
+          apr_off_t offset = 0;
+          SVN_ERR(svn_io_file_seek(stdin_handle, APR_SET, &offset, pool));
+        }
+      return SVN_NO_ERROR;
+    }
+
+  *used = TRUE;
+
+  if (exitcode != 0)
+    {
+      const char *utf8_stderr;
+
+      err = svn_utf_cstring_to_utf8(&utf8_stderr, hook_stderr->data, pool);
+      if (err)
+        {
+          svn_error_clear(err);
+          utf8_stderr = _("[Error output could not be translated from the "
+                          "native locale to UTF-8.]");
+        }
+
+      return hook_failure_with_output(hook_exitcode_message(name, exitcode,
+                                                            pool),
+                                      utf8_stderr);
+    }
+
+  if (result)
+    *result = svn_stringbuf__morph_into_string(hook_stdout);
+
+  return SVN_NO_ERROR;
+}
+
+
 /* NAME, CMD and ARGS are the name, path to and arguments for the hook
-   program that is to be run.  The hook's exit status will be checked,
-   and if an error occurred the hook's stderr output will be added to
-   the returned error.
+   program that is to be run for REPOS.  The hook's exit status will be
+   checked, and if an error occurred the hook's stderr output will be
+   added to the returned error.
 
    If STDIN_HANDLE is non-null, pass it as the hook's stdin, else pass
    no stdin to the hook.
 
    If RESULT is non-null, set *RESULT to the stdout of the hook or to
-   a zero-length string if the hook generates no output on stdout. */
+   a zero-length string if the hook generates no output on stdout.
+
+   If REPOS has a persistent hook runner, dispatch the invocation to it
+   instead of starting a new process; see above. */
 static svn_error_t *
 run_hook_cmd(svn_string_t **result,
+             svn_repos_t *repos,
              const char *name,
              const char *cmd,
              const char **args,
@@ -218,6 +566,23 @@ run_hook_cmd(svn_string_t **result,
   apr_proc_t cmd_proc = {0};
   apr_pool_t *cmd_pool;
   apr_hash_t *hook_env = NULL;
+  svn_boolean_t used_runner;
+
+  /* Check if a custom environment is defined for this hook, or else
+   * whether a default environment is defined. */
+  if (hooks_env)
+    {
+      hook_env = svn_hash_gets(hooks_env, name);
+      if (hook_env == NULL)
+        hook_env = svn_hash_gets(hooks_env,
+                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
+    }
+
+  /* Prefer the persistent hook runner, if one is installed. */
+  SVN_ERR(run_hook_via_runner(&used_runner, result, repos, name, cmd,
+                              args, hook_env, stdin_handle, pool));
+  if (used_runner)
+    return SVN_NO_ERROR;
 
   if (result)
     {
@@ -237,16 +602,6 @@ run_hook_cmd(svn_string_t **result,
    * destroy in order to clean up the stderr pipe opened for the process. */
   cmd_pool = svn_pool_create(pool);
 
-  /* Check if a custom environment is defined for this hook, or else
-   * whether a default environment is defined. */
-  if (hooks_env)
-    {
-      hook_env = svn_hash_gets(hooks_env, name);
-      if (hook_env == NULL)
-        hook_env = svn_hash_gets(hooks_env,
-                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
-    }
-
   err = svn_io_start_cmd3(&cmd_proc, ".", cmd, args,
                           env_from_env_hash(hook_env, pool, pool),
                           FALSE, FALSE, stdin_handle, result != NULL,
@@ -491,7 +846,7 @@ svn_repos__hooks_start_commit(svn_repos_t *repos,
       args[4] = txn_name;
       args[5] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_START_COMMIT, hook, args,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_START_COMMIT, hook, args,
                            hooks_env, NULL, pool));
     }
 
@@ -578,7 +933,7 @@ svn_repos__hooks_pre_commit(svn_repos_t *repos,
         SVN_ERR(svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
                                  APR_READ, APR_OS_DEFAULT, pool));
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_PRE_COMMIT, hook, args,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_PRE_COMMIT, hook, args,
                            hooks_env, stdin_handle, pool));
     }
 
@@ -610,7 +965,7 @@ svn_repos__hooks_post_commit(svn_repos_t *repos,
       args[3] = txn_name;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_COMMIT, hook, args,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_COMMIT, hook, args,
                            hooks_env, NULL, pool));
     }
 
@@ -659,7 +1014,8 @@ svn_repos__hooks_pre_revprop_change(svn_repos_t *repos,
       args[5] = action_string;
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_PRE_REVPROP_CHANGE, hook,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_PRE_REVPROP_CHANGE,
+                           hook,
                            args, hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
@@ -722,7 +1078,8 @@ svn_repos__hooks_post_revprop_change(svn_repos_t *repos,
       args[5] = action_string;
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_REVPROP_CHANGE, hook,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_REVPROP_CHANGE,
+                           hook,
                            args, hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
@@ -763,7 +1120,7 @@ svn_repos__hooks_pre_lock(svn_repos_t *repos,
       args[5] = steal_lock ? "1" : "0";
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(&buf, SVN_REPOS__HOOK_PRE_LOCK, hook, args,
+      SVN_ERR(run_hook_cmd(&buf, repos, SVN_REPOS__HOOK_PRE_LOCK, hook, args,
                            hooks_env, NULL, pool));
 
       if (token)
@@ -808,7 +1165,7 @@ svn_repos__hooks_post_lock(svn_repos_t *repos,
       args[3] = NULL;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_LOCK, hook, args,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_LOCK, hook, args,
                            hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
@@ -846,7 +1203,7 @@ svn_repos__hooks_pre_unlock(svn_repos_t *repos,
       args[5] = break_lock ? "1" : "0";
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_PRE_UNLOCK, hook, args,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_PRE_UNLOCK, hook, args,
                            hooks_env, NULL, pool));
     }
 
@@ -884,7 +1241,7 @@ svn_repos__hooks_post_unlock(svn_repos_t *repos,
       args[3] = NULL;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_UNLOCK, hook, args,
+      SVN_ERR(run_hook_cmd(NULL, repos, SVN_REPOS__HOOK_POST_UNLOCK, hook, args,
                            hooks_env, stdin_handle, pool));
 
       SVN_ERR(svn_io_file_close(stdin_handle, pool));
@@ -158,49 +158,80 @@ compare_filtered_dirent(const void *lhs,
   return strcmp(lhs_dirent->dirent->name, rhs_dirent->dirent->name);
 }
 
-/* Core of svn_repos_list with the same parameter list.
- *
- * However, DEPTH is not svn_depth_empty and PATH has already been reported.
- * Therefore, we can call this recursively.
+/* A directory entry on a dir_frame_t, reduced to the bits that the
+ * streaming tree walk still needs after the directory got read, filtered
+ * and sorted. */
+typedef struct frame_entry_t
+{
+  /* Entry name, allocated in the frame's pool. */
+  const char *name;
+
+  /* Node kind of the entry. */
+  svn_node_kind_t kind;
+
+  /* The entry passed the pattern filter, i.e. shall be reported. */
+  svn_boolean_t is_match;
+} frame_entry_t;
+
+/* A directory currently being traversed by do_list.  One of these exists
+ * per tree level on the explicit traversal stack, keeping the memory
+ * footprint at O(depth) plus one directory's worth of entry names. */
+typedef struct dir_frame_t
+{
+  /* Full path of this directory, allocated in POOL. */
+  const char *path;
+
+  /* Filtered, authz-checked and sorted frame_entry_t array. */
+  apr_array_header_t *entries;
+
+  /* Index into ENTRIES of the next entry to process. */
+  int next;
+
+  /* Pool that this frame, PATH and ENTRIES are allocated in.  Destroyed
+   * when the frame is popped off the stack. */
+  apr_pool_t *pool;
+} dir_frame_t;
+
+/* Read the directory PATH under ROOT, filter the entries by DEPTH and
+ * PATTERNS, batch-check authz for the survivors with AUTHZ_READ_FUNC and
+ * AUTHZ_READ_BATON (unless that is NULL), sort them and push the
+ * resulting frame onto STACK.
  *
- * Uses SCRATCH_BUFFER for temporary string contents.
+ * The frame is allocated in a subpool of FRAME_PARENT_POOL; only entry
+ * names, kinds and filter flags are retained.  Use SCRATCH_BUFFER for
+ * temporary string contents and SCRATCH_POOL for other temporaries.
  */
 static svn_error_t *
-do_list(svn_fs_root_t *root,
-        const char *path,
-        const apr_array_header_t *patterns,
-        svn_depth_t depth,
-        svn_boolean_t path_info_only,
-        svn_repos_authz_func_t authz_read_func,
-        void *authz_read_baton,
-        svn_repos_dirent_receiver_t receiver,
-        void *receiver_baton,
-        svn_cancel_func_t cancel_func,
-        void *cancel_baton,
-        svn_membuf_t *scratch_buffer,
-        apr_pool_t *scratch_pool)
+push_dir_frame(apr_array_header_t *stack,
+               svn_fs_root_t *root,
+               const char *path,
+               const apr_array_header_t *patterns,
+               svn_depth_t depth,
+               svn_repos_authz_func_t authz_read_func,
+               void *authz_read_baton,
+               svn_membuf_t *scratch_buffer,
+               apr_pool_t *frame_parent_pool,
+               apr_pool_t *scratch_pool)
 {
-  apr_hash_t *entries;
+  apr_pool_t *frame_pool = svn_pool_create(frame_parent_pool);
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  dir_frame_t *frame = apr_pcalloc(frame_pool, sizeof(*frame));
+  apr_hash_t *entries;
   apr_hash_index_t *hi;
   apr_array_header_t *sorted;
   int i;
 
-  /* Fetch all directory entries, filter and sort them.
-   *
-   * Performance trade-off:
-   * Constructing a full path vs. faster sort due to authz filtering.
-   * We filter according to DEPTH and PATTERNS only because constructing
-   * the full path required for authz is somewhat expensive and we don't
-   * want to do this twice while authz will rarely filter paths out.
-   */
+  frame->pool = frame_pool;
+  frame->path = apr_pstrdup(frame_pool, path);
+  frame->next = 0;
+
+  /* Fetch all directory entries and filter them by DEPTH and PATTERNS. */
   SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
   sorted = apr_array_make(scratch_pool, apr_hash_count(entries),
                           sizeof(filtered_dirent_t));
   for (hi = apr_hash_first(scratch_pool, entries); hi; hi = apr_hash_next(hi))
     {
       filtered_dirent_t filtered;
-      svn_pool_clear(iterpool);
 
       filtered.dirent = apr_hash_this_val(hi);
 
@@ -217,48 +248,130 @@ do_list(svn_fs_root_t *root,
       APR_ARRAY_PUSH(sorted, filtered_dirent_t) = filtered;
     }
 
+  /* Batch the authz checks for this directory:  one tight loop over all
+   * remaining entries before anything gets reported or descended into.
+   * Entries that fail the check are neither reported nor recursed into,
+   * so drop them right here. */
+  if (authz_read_func)
+    {
+      int k = 0;
+
+      for (i = 0; i < sorted->nelts; ++i)
+        {
+          filtered_dirent_t *filtered
+            = &APR_ARRAY_IDX(sorted, i, filtered_dirent_t);
+          const char *sub_path;
+          svn_boolean_t has_access;
+
+          svn_pool_clear(iterpool);
+
+          sub_path = svn_dirent_join(path, filtered->dirent->name, iterpool);
+          SVN_ERR(authz_read_func(&has_access, root, sub_path,
+                                  authz_read_baton, iterpool));
+          if (has_access)
+            APR_ARRAY_IDX(sorted, k++, filtered_dirent_t) = *filtered;
+        }
+
+      sorted->nelts = k;
+    }
+
   svn_sort__array(sorted, compare_filtered_dirent);
 
-  /* Iterate over all remaining directory entries and report them.
-   * Recurse into sub-directories if requested. */
+  /* Retain only what the traversal still needs:  names, kinds and filter
+   * flags.  The raw entries themselves get released with SCRATCH_POOL. */
+  frame->entries = apr_array_make(frame_pool, sorted->nelts,
+                                  sizeof(frame_entry_t));
   for (i = 0; i < sorted->nelts; ++i)
     {
-      const char *sub_path;
-      filtered_dirent_t *filtered;
-      svn_fs_dirent_t *dirent;
+      filtered_dirent_t *filtered
+        = &APR_ARRAY_IDX(sorted, i, filtered_dirent_t);
+      frame_entry_t *entry = &APR_ARRAY_PUSH(frame->entries, frame_entry_t);
 
-      svn_pool_clear(iterpool);
+      entry->name = apr_pstrdup(frame_pool, filtered->dirent->name);
+      entry->kind = filtered->dirent->kind;
+      entry->is_match = filtered->is_match;
+    }
+
+  svn_pool_destroy(iterpool);
+
+  APR_ARRAY_PUSH(stack, dir_frame_t *) = frame;
+
+  return SVN_NO_ERROR;
+}
+
+/* Core of svn_repos_list with the same parameter list.
+ *
+ * However, DEPTH is not svn_depth_empty and PATH has already been reported.
+ *
+ * The tree is walked with an explicit stack of dir_frame_t, emitting each
+ * entry as soon as its directory has been read and sorted.  Only one
+ * directory's worth of entries is held per tree level, so memory usage is
+ * bounded by the tree depth while the first results reach the receiver
+ * before deep sub-trees have even been opened.
+ *
+ * Uses SCRATCH_BUFFER for temporary string contents.
+ */
+static svn_error_t *
+do_list(svn_fs_root_t *root,
+        const char *path,
+        const apr_array_header_t *patterns,
+        svn_depth_t depth,
+        svn_boolean_t path_info_only,
+        svn_repos_authz_func_t authz_read_func,
+        void *authz_read_baton,
+        svn_repos_dirent_receiver_t receiver,
+        void *receiver_baton,
+        svn_cancel_func_t cancel_func,
+        void *cancel_baton,
+        svn_membuf_t *scratch_buffer,
+        apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *stack = apr_array_make(scratch_pool, 16,
+                                             sizeof(dir_frame_t *));
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR(push_dir_frame(stack, root, path, patterns, depth,
+                         authz_read_func, authz_read_baton,
+                         scratch_buffer, scratch_pool, iterpool));
 
-      filtered = &APR_ARRAY_IDX(sorted, i, filtered_dirent_t);
-      dirent = filtered->dirent;
+  while (stack->nelts)
+    {
+      dir_frame_t *frame = APR_ARRAY_IDX(stack, stack->nelts - 1,
+                                         dir_frame_t *);
+      frame_entry_t *entry;
+      const char *sub_path;
 
-      /* Skip paths that we don't have access to? */
-      sub_path = svn_dirent_join(path, dirent->name, iterpool);
-      if (authz_read_func)
+      /* Done with this directory? */
+      if (frame->next == frame->entries->nelts)
         {
-          svn_boolean_t has_access;
-          SVN_ERR(authz_read_func(&has_access, root, sub_path,
-                                  authz_read_baton, iterpool));
-          if (!has_access)
-            continue;
+          apr_array_pop(stack);
+          svn_pool_destroy(frame->pool);
+          continue;
         }
 
-      /* Report entry, if it passed the filter. */
-      if (filtered->is_match)
-        SVN_ERR(report_dirent(root, sub_path, dirent->kind, path_info_only,
+      svn_pool_clear(iterpool);
+
+      entry = &APR_ARRAY_IDX(frame->entries, frame->next, frame_entry_t);
+      frame->next++;
+
+      sub_path = svn_dirent_join(frame->path, entry->name, iterpool);
+
+      /* Report entry, if it passed the filters. */
+      if (entry->is_match)
+        SVN_ERR(report_dirent(root, sub_path, entry->kind, path_info_only,
                               receiver, receiver_baton, iterpool));
 
-      /* Check for cancellation before recursing down.  This should be
+      /* Check for cancellation before descending.  This should be
        * slightly more responsive for deep trees. */
       if (cancel_func)
         SVN_ERR(cancel_func(cancel_baton));
 
-      /* Recurse on directories. */
-      if (depth == svn_depth_infinity && dirent->kind == svn_node_dir)
-        SVN_ERR(do_list(root, sub_path, patterns, svn_depth_infinity,
-                        path_info_only, authz_read_func, authz_read_baton,
-                        receiver, receiver_baton, cancel_func,
-                        cancel_baton, scratch_buffer, iterpool));
+      /* Descend into directories. */
+      if (depth == svn_depth_infinity && entry->kind == svn_node_dir)
+        SVN_ERR(push_dir_frame(stack, root, sub_path, patterns,
+                               svn_depth_infinity, authz_read_func,
+                               authz_read_baton, scratch_buffer,
+                               scratch_pool, iterpool));
     }
 
   svn_pool_destroy(iterpool);
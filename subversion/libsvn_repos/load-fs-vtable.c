@@ -37,12 +37,15 @@
 #include "svn_dirent_uri.h"
 
 #include <apr_lib.h>
+#include <apr_thread_proc.h>
 
+#include "private/svn_atomic.h"
 #include "private/svn_fspath.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_cond.h"
 
 /*----------------------------------------------------------------------*/
 
@@ -1316,6 +1319,774 @@ svn_repos_load_fs6(svn_repos_t *repos,
                                      cancel_func, cancel_baton, pool);
 }
 
+/*----------------------------------------------------------------------*/
+
+/** Pipelined loading **/
+
+/* The pipelined loader runs the dumpstream parser on a background thread.
+   That thread stages each revision - headers, props, svndiff windows and
+   fulltext chunks, already decoded - as an in-memory record sequence and
+   hands complete revisions to the calling thread, which replays them into
+   the commit vtable above.  Reading and decoding revision N+1 thereby
+   overlaps with building and committing the transaction for revision N.
+
+   Transactions cannot be built ahead of time because each one is based
+   on the previously committed revision, so the FS-facing side remains
+   strictly sequential and the loaded result is identical to a serial
+   load. */
+
+#if APR_HAS_THREADS
+
+/* Limit, in bytes, on the content that the parser thread may stage ahead
+   of the commit thread before it blocks.  A single revision may exceed
+   this limit; it will then be the only one staged. */
+#define STAGED_CONTENT_LIMIT (64 * 1024 * 1024)
+
+/* The kinds of parser events that we stage for later replay. */
+typedef enum staged_event_kind_t
+{
+  staged_event_uuid,              /* NAME is the UUID */
+  staged_event_new_revision,      /* HEADERS is the revision header hash */
+  staged_event_revision_prop,     /* NAME, VALUE */
+  staged_event_new_node,          /* HEADERS is the node header hash */
+  staged_event_node_prop,         /* NAME, VALUE */
+  staged_event_delete_node_prop,  /* NAME */
+  staged_event_remove_node_props,
+  staged_event_delta_begin,
+  staged_event_window,            /* WINDOW; NULL ends the delta */
+  staged_event_fulltext_begin,
+  staged_event_fulltext_chunk,    /* VALUE is a content chunk */
+  staged_event_fulltext_end,
+  staged_event_close_node,
+  staged_event_close_revision
+} staged_event_kind_t;
+
+/* A single parser event, to be replayed in the order of staging. */
+typedef struct staged_event_t
+{
+  staged_event_kind_t kind;
+
+  /* Payload; which of these is used depends on KIND, see above.  All of
+     it is allocated in the batch's pool. */
+  apr_hash_t *headers;
+  const char *name;
+  const svn_string_t *value;
+  svn_txdelta_window_t *window;
+
+  struct staged_event_t *next;
+} staged_event_t;
+
+/* A batch of staged events, covering at most one revision. */
+typedef struct staged_batch_t
+{
+  /* Unparented pool holding the whole batch.  The commit thread destroys
+     it after the replay, independently of the parser thread's pools. */
+  apr_pool_t *pool;
+
+  staged_event_t *first;
+  staged_event_t *last;
+
+  /* Approximate memory footprint of this batch. */
+  apr_size_t size;
+
+  struct staged_batch_t *next;
+} staged_batch_t;
+
+/* State shared between the parser thread and the commit thread. */
+typedef struct load_pipeline_t
+{
+  svn_mutex__t *mutex;
+  svn_thread_cond__t *batch_ready;  /* the commit thread sleeps on this */
+  svn_thread_cond__t *batch_taken;  /* the parser thread sleeps on this */
+
+  /* Queue of complete batches, in dumpstream order. */
+  staged_batch_t *first;
+  staged_batch_t *last;
+
+  /* Sum of the SIZE members of all queued batches. */
+  apr_size_t queued_size;
+
+  /* The parser thread sets these, under MUTEX, when it is done. */
+  svn_boolean_t parser_finished;
+  svn_error_t *parser_err;
+
+  /* Set by the commit thread to stop the parser early. */
+  svn_atomic_t aborted;
+} load_pipeline_t;
+
+/* Parser thread state; used as parse / revision / node baton alike. */
+typedef struct staging_baton_t
+{
+  load_pipeline_t *pipeline;
+
+  /* The batch currently being staged, or NULL. */
+  staged_batch_t *batch;
+} staging_baton_t;
+
+/* Append a new event of KIND to the batch currently staged in SB,
+   creating the batch if needed, and return it so that the caller may
+   fill in the payload. */
+static staged_event_t *
+stage_event(staging_baton_t *sb, staged_event_kind_t kind)
+{
+  staged_batch_t *batch = sb->batch;
+  staged_event_t *event;
+
+  if (!batch)
+    {
+      apr_pool_t *pool = svn_pool_create(NULL);
+      batch = apr_pcalloc(pool, sizeof(*batch));
+      batch->pool = pool;
+      sb->batch = batch;
+    }
+
+  event = apr_pcalloc(batch->pool, sizeof(*event));
+  event->kind = kind;
+  if (batch->last)
+    batch->last->next = event;
+  else
+    batch->first = event;
+  batch->last = event;
+  batch->size += sizeof(*event);
+
+  return event;
+}
+
+/* Return a deep copy of the dumpstream header hash HEADERS, allocated
+   in POOL.  Add the size of the copied data to *SIZE. */
+static apr_hash_t *
+copy_headers(apr_hash_t *headers,
+             apr_size_t *size,
+             apr_pool_t *pool)
+{
+  apr_hash_t *copy = apr_hash_make(pool);
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(pool, headers); hi; hi = apr_hash_next(hi))
+    {
+      const char *key = apr_hash_this_key(hi);
+      const char *val = apr_hash_this_val(hi);
+
+      svn_hash_sets(copy, apr_pstrdup(pool, key), apr_pstrdup(pool, val));
+      *size += strlen(key) + strlen(val);
+    }
+
+  return copy;
+}
+
+/* Append BATCH to the queue in PIPELINE and wake the commit thread.
+   Block while enough content is already staged to keep the commit
+   thread busy; always queue at least one batch, though, so that a
+   single over-sized revision cannot deadlock the pipeline.
+
+   This function must be called with PIPELINE->MUTEX acquired. */
+static svn_error_t *
+queue_batch(load_pipeline_t *pipeline,
+            staged_batch_t *batch)
+{
+  while (pipeline->first
+         && pipeline->queued_size >= STAGED_CONTENT_LIMIT
+         && !svn_atomic_read(&pipeline->aborted))
+    SVN_ERR(svn_thread_cond__wait(pipeline->batch_taken, pipeline->mutex));
+
+  if (svn_atomic_read(&pipeline->aborted))
+    {
+      svn_pool_destroy(batch->pool);
+      return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+    }
+
+  if (pipeline->last)
+    pipeline->last->next = batch;
+  else
+    pipeline->first = batch;
+  pipeline->last = batch;
+  pipeline->queued_size += batch->size;
+
+  return svn_thread_cond__signal(pipeline->batch_ready);
+}
+
+/* Hand the batch currently staged in SB, if any, over to the commit
+   thread. */
+static svn_error_t *
+push_batch(staging_baton_t *sb)
+{
+  staged_batch_t *batch = sb->batch;
+
+  if (!batch)
+    return SVN_NO_ERROR;
+  sb->batch = NULL;
+
+  SVN_MUTEX__WITH_LOCK(sb->pipeline->mutex,
+                       queue_batch(sb->pipeline, batch));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.uuid_record for the staging parser. */
+static svn_error_t *
+staging_uuid_record(const char *uuid,
+                    void *parse_baton,
+                    apr_pool_t *pool)
+{
+  staging_baton_t *sb = parse_baton;
+  staged_event_t *event = stage_event(sb, staged_event_uuid);
+
+  event->name = apr_pstrdup(sb->batch->pool, uuid);
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.new_revision_record for the staging
+   parser. */
+static svn_error_t *
+staging_new_revision_record(void **revision_baton,
+                            apr_hash_t *headers,
+                            void *parse_baton,
+                            apr_pool_t *pool)
+{
+  staging_baton_t *sb = parse_baton;
+  staged_event_t *event = stage_event(sb, staged_event_new_revision);
+
+  event->headers = copy_headers(headers, &sb->batch->size, sb->batch->pool);
+  *revision_baton = sb;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.set_revision_property for the staging
+   parser. */
+static svn_error_t *
+staging_set_revision_property(void *baton,
+                              const char *name,
+                              const svn_string_t *value)
+{
+  staging_baton_t *sb = baton;
+  staged_event_t *event = stage_event(sb, staged_event_revision_prop);
+
+  event->name = apr_pstrdup(sb->batch->pool, name);
+  event->value = svn_string_dup(value, sb->batch->pool);
+  sb->batch->size += value->len;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.new_node_record for the staging
+   parser. */
+static svn_error_t *
+staging_new_node_record(void **node_baton,
+                        apr_hash_t *headers,
+                        void *revision_baton,
+                        apr_pool_t *pool)
+{
+  staging_baton_t *sb = revision_baton;
+  staged_event_t *event = stage_event(sb, staged_event_new_node);
+
+  event->headers = copy_headers(headers, &sb->batch->size, sb->batch->pool);
+  *node_baton = sb;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.set_node_property for the staging
+   parser. */
+static svn_error_t *
+staging_set_node_property(void *baton,
+                          const char *name,
+                          const svn_string_t *value)
+{
+  staging_baton_t *sb = baton;
+  staged_event_t *event = stage_event(sb, staged_event_node_prop);
+
+  event->name = apr_pstrdup(sb->batch->pool, name);
+  event->value = svn_string_dup(value, sb->batch->pool);
+  sb->batch->size += value->len;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.delete_node_property for the staging
+   parser. */
+static svn_error_t *
+staging_delete_node_property(void *baton,
+                             const char *name)
+{
+  staging_baton_t *sb = baton;
+  staged_event_t *event = stage_event(sb, staged_event_delete_node_prop);
+
+  event->name = apr_pstrdup(sb->batch->pool, name);
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.remove_node_props for the staging
+   parser. */
+static svn_error_t *
+staging_remove_node_props(void *baton)
+{
+  stage_event(baton, staged_event_remove_node_props);
+  return SVN_NO_ERROR;
+}
+
+/* Window handler staging the decoded svndiff windows.  BATON is the
+   staging_baton_t. */
+static svn_error_t *
+staging_window_handler(svn_txdelta_window_t *window,
+                       void *baton)
+{
+  staging_baton_t *sb = baton;
+  staged_event_t *event = stage_event(sb, staged_event_window);
+
+  if (window)
+    {
+      event->window = svn_txdelta_window_dup(window, sb->batch->pool);
+      sb->batch->size += window->tview_len;
+      if (window->new_data)
+        sb->batch->size += window->new_data->len;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.apply_textdelta for the staging
+   parser. */
+static svn_error_t *
+staging_apply_textdelta(svn_txdelta_window_handler_t *handler,
+                        void **handler_baton,
+                        void *node_baton)
+{
+  stage_event(node_baton, staged_event_delta_begin);
+
+  *handler = staging_window_handler;
+  *handler_baton = node_baton;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_write_fn_t, staging a fulltext content chunk.
+   BATON is the staging_baton_t. */
+static svn_error_t *
+staging_fulltext_write(void *baton,
+                       const char *data,
+                       apr_size_t *len)
+{
+  staging_baton_t *sb = baton;
+  staged_event_t *event = stage_event(sb, staged_event_fulltext_chunk);
+
+  event->value = svn_string_ncreate(data, *len, sb->batch->pool);
+  sb->batch->size += *len;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_close_fn_t, ending a staged fulltext.
+   BATON is the staging_baton_t. */
+static svn_error_t *
+staging_fulltext_close(void *baton)
+{
+  stage_event(baton, staged_event_fulltext_end);
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.set_fulltext for the staging
+   parser. */
+static svn_error_t *
+staging_set_fulltext(svn_stream_t **stream,
+                     void *node_baton)
+{
+  staging_baton_t *sb = node_baton;
+  svn_stream_t *s;
+
+  stage_event(sb, staged_event_fulltext_begin);
+
+  s = svn_stream_create(sb, sb->batch->pool);
+  svn_stream_set_write(s, staging_fulltext_write);
+  svn_stream_set_close(s, staging_fulltext_close);
+  *stream = s;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.close_node for the staging parser. */
+static svn_error_t *
+staging_close_node(void *baton)
+{
+  stage_event(baton, staged_event_close_node);
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_parse_fns3_t.close_revision for the staging
+   parser.  This completes the current batch and hands it over to the
+   commit thread. */
+static svn_error_t *
+staging_close_revision(void *baton)
+{
+  staging_baton_t *sb = baton;
+
+  stage_event(sb, staged_event_close_revision);
+  return svn_error_trace(push_batch(sb));
+}
+
+/* Cancellation function for the parser thread, stopping it as soon as
+   the commit thread has given up.  BATON is the load_pipeline_t. */
+static svn_error_t *
+staging_cancelled(void *baton)
+{
+  load_pipeline_t *pipeline = baton;
+  return svn_atomic_read(&pipeline->aborted)
+       ? svn_error_create(SVN_ERR_CANCELLED, NULL, NULL)
+       : SVN_NO_ERROR;
+}
+
+/* Baton for the parser thread. */
+typedef struct parser_thread_baton_t
+{
+  load_pipeline_t *pipeline;
+  svn_stream_t *dumpstream;
+} parser_thread_baton_t;
+
+/* Parse the whole dumpstream described by PTB, staging batches for the
+   commit thread.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+run_staging_parser(parser_thread_baton_t *ptb,
+                   apr_pool_t *scratch_pool)
+{
+  svn_repos_parse_fns3_t *parser = apr_pcalloc(scratch_pool,
+                                               sizeof(*parser));
+  staging_baton_t *sb = apr_pcalloc(scratch_pool, sizeof(*sb));
+  svn_error_t *err;
+
+  parser->magic_header_record = NULL;
+  parser->uuid_record = staging_uuid_record;
+  parser->new_revision_record = staging_new_revision_record;
+  parser->new_node_record = staging_new_node_record;
+  parser->set_revision_property = staging_set_revision_property;
+  parser->set_node_property = staging_set_node_property;
+  parser->delete_node_property = staging_delete_node_property;
+  parser->remove_node_props = staging_remove_node_props;
+  parser->set_fulltext = staging_set_fulltext;
+  parser->apply_textdelta = staging_apply_textdelta;
+  parser->close_node = staging_close_node;
+  parser->close_revision = staging_close_revision;
+
+  sb->pipeline = ptb->pipeline;
+
+  err = svn_repos_parse_dumpstream3(ptb->dumpstream, parser, sb, FALSE,
+                                    staging_cancelled, ptb->pipeline,
+                                    scratch_pool);
+  if (err)
+    {
+      if (sb->batch)
+        svn_pool_destroy(sb->batch->pool);
+      return svn_error_trace(err);
+    }
+
+  /* Flush anything staged after the last revision, e.g. a trailing
+     UUID record. */
+  return svn_error_trace(push_batch(sb));
+}
+
+/* Record ERR as the parser result in PIPELINE and wake the commit
+   thread.  This function must be called with PIPELINE->MUTEX
+   acquired. */
+static svn_error_t *
+finish_parser(load_pipeline_t *pipeline,
+              svn_error_t *err)
+{
+  pipeline->parser_finished = TRUE;
+  pipeline->parser_err = err;
+  return svn_thread_cond__signal(pipeline->batch_ready);
+}
+
+/* The plain APR thread around the staging parser.
+   DATA is the parser_thread_baton_t to work on. */
+static void * APR_THREAD_FUNC
+parser_thread(apr_thread_t *thread, void *data)
+{
+  parser_thread_baton_t *ptb = data;
+  load_pipeline_t *pipeline = ptb->pipeline;
+  apr_status_t result = APR_SUCCESS;
+  svn_error_t *err;
+  svn_error_t *sync_err;
+
+  /* This thread uses a separate single-threaded pool tree for minimum
+     overhead. */
+  apr_pool_t *pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+
+  err = run_staging_parser(ptb, pool);
+  sync_err = svn_mutex__lock(pipeline->mutex);
+  if (sync_err)
+    {
+      /* Without the mutex, we cannot safely publish ERR.  Report the
+         failure through the thread exit code instead. */
+      err = svn_error_compose_create(sync_err, err);
+      result = err->apr_err;
+      svn_error_clear(err);
+    }
+  else
+    {
+      sync_err = svn_mutex__unlock(pipeline->mutex,
+                                   finish_parser(pipeline, err));
+      if (sync_err)
+        {
+          result = sync_err->apr_err;
+          svn_error_clear(sync_err);
+        }
+    }
+
+  svn_pool_destroy(pool);
+
+  /* End thread explicitly to prevent APR_INCOMPLETE return codes in
+     apr_thread_join(). */
+  apr_thread_exit(thread, result);
+  return NULL;
+}
+
+/* Set *BATCH to the next complete batch from PIPELINE, waiting for the
+   parser thread if necessary, or to NULL if the parser has finished and
+   the queue is empty.  This function must be called with
+   PIPELINE->MUTEX acquired. */
+static svn_error_t *
+take_batch(staged_batch_t **batch,
+           load_pipeline_t *pipeline)
+{
+  while (!pipeline->first && !pipeline->parser_finished)
+    SVN_ERR(svn_thread_cond__wait(pipeline->batch_ready, pipeline->mutex));
+
+  *batch = pipeline->first;
+  if (*batch)
+    {
+      pipeline->first = (*batch)->next;
+      if (!pipeline->first)
+        pipeline->last = NULL;
+      pipeline->queued_size -= (*batch)->size;
+
+      /* The parser may be waiting for staging capacity. */
+      SVN_ERR(svn_thread_cond__signal(pipeline->batch_taken));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Replay the staged events in BATCH into the commit vtable above.
+   PARSE_BATON is the parse baton of that vtable. */
+static svn_error_t *
+replay_batch(staged_batch_t *batch,
+             void *parse_baton)
+{
+  apr_pool_t *node_pool = svn_pool_create(batch->pool);
+  void *rb = NULL;
+  void *nb = NULL;
+  svn_txdelta_window_handler_t handler = NULL;
+  void *handler_baton = NULL;
+  svn_stream_t *text_stream = NULL;
+  staged_event_t *event;
+
+  for (event = batch->first; event; event = event->next)
+    switch (event->kind)
+      {
+      case staged_event_uuid:
+        SVN_ERR(uuid_record(event->name, parse_baton, batch->pool));
+        break;
+
+      case staged_event_new_revision:
+        SVN_ERR(new_revision_record(&rb, event->headers, parse_baton,
+                                    batch->pool));
+        break;
+
+      case staged_event_revision_prop:
+        SVN_ERR(set_revision_property(rb, event->name, event->value));
+        break;
+
+      case staged_event_new_node:
+        svn_pool_clear(node_pool);
+        SVN_ERR(new_node_record(&nb, event->headers, rb, node_pool));
+        break;
+
+      case staged_event_node_prop:
+        SVN_ERR(set_node_property(nb, event->name, event->value));
+        break;
+
+      case staged_event_delete_node_prop:
+        SVN_ERR(delete_node_property(nb, event->name));
+        break;
+
+      case staged_event_remove_node_props:
+        SVN_ERR(remove_node_props(nb));
+        break;
+
+      case staged_event_delta_begin:
+        SVN_ERR(apply_textdelta(&handler, &handler_baton, nb));
+        break;
+
+      case staged_event_window:
+        /* HANDLER is NULL if the target revision is being skipped. */
+        if (handler)
+          SVN_ERR(handler(event->window, handler_baton));
+        if (!event->window)
+          handler = NULL;
+        break;
+
+      case staged_event_fulltext_begin:
+        SVN_ERR(set_fulltext(&text_stream, nb));
+        break;
+
+      case staged_event_fulltext_chunk:
+        /* TEXT_STREAM is NULL if the target revision is being skipped. */
+        if (text_stream)
+          {
+            apr_size_t len = event->value->len;
+            SVN_ERR(svn_stream_write(text_stream, event->value->data, &len));
+          }
+        break;
+
+      case staged_event_fulltext_end:
+        if (text_stream)
+          SVN_ERR(svn_stream_close(text_stream));
+        text_stream = NULL;
+        break;
+
+      case staged_event_close_node:
+        SVN_ERR(close_node(nb));
+        nb = NULL;
+        break;
+
+      case staged_event_close_revision:
+        SVN_ERR(close_revision(rb));
+        rb = NULL;
+        break;
+      }
+
+  svn_pool_destroy(node_pool);
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_error_t *
+svn_repos__load_fs_pipelined(svn_repos_t *repos,
+                             svn_stream_t *dumpstream,
+                             svn_revnum_t start_rev,
+                             svn_revnum_t end_rev,
+                             enum svn_repos_load_uuid uuid_action,
+                             const char *parent_dir,
+                             svn_boolean_t use_pre_commit_hook,
+                             svn_boolean_t use_post_commit_hook,
+                             svn_boolean_t validate_props,
+                             svn_boolean_t ignore_dates,
+                             svn_boolean_t normalize_props,
+                             svn_repos_notify_func_t notify_func,
+                             void *notify_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  const svn_repos_parse_fns3_t *parser;
+  void *parse_baton;
+  load_pipeline_t *pipeline = apr_pcalloc(pool, sizeof(*pipeline));
+  parser_thread_baton_t ptb;
+  apr_thread_t *thread;
+  apr_status_t status;
+  apr_status_t retval;
+  svn_error_t *err = SVN_NO_ERROR;
+  svn_error_t *sync_err;
+
+  /* Build the regular commit vtable.  We replay the staged parser
+     events into it ourselves instead of letting the parser drive it. */
+  SVN_ERR(svn_repos_get_fs_build_parser6(&parser, &parse_baton,
+                                         repos,
+                                         start_rev, end_rev,
+                                         TRUE, /* look for copyfrom revs */
+                                         validate_props,
+                                         uuid_action,
+                                         parent_dir,
+                                         use_pre_commit_hook,
+                                         use_post_commit_hook,
+                                         ignore_dates,
+                                         normalize_props,
+                                         notify_func,
+                                         notify_baton,
+                                         pool));
+
+  SVN_ERR(svn_mutex__init(&pipeline->mutex, TRUE, pool));
+  SVN_ERR(svn_thread_cond__create(&pipeline->batch_ready, pool));
+  SVN_ERR(svn_thread_cond__create(&pipeline->batch_taken, pool));
+
+  ptb.pipeline = pipeline;
+  ptb.dumpstream = dumpstream;
+
+  status = apr_thread_create(&thread, NULL, parser_thread, &ptb, pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Creating parser thread failed"));
+
+  /* Commit staged revisions until the stream - or an error - ends the
+     pipeline.  From here on, we must not return before having joined
+     the parser thread. */
+  while (!err)
+    {
+      staged_batch_t *batch = NULL;
+
+      if (cancel_func)
+        err = cancel_func(cancel_baton);
+
+      if (!err)
+        {
+          err = svn_mutex__lock(pipeline->mutex);
+          if (!err)
+            err = svn_mutex__unlock(pipeline->mutex,
+                                    take_batch(&batch, pipeline));
+        }
+
+      if (err || !batch)
+        break;
+
+      err = replay_batch(batch, parse_baton);
+      svn_pool_destroy(batch->pool);
+    }
+
+  /* Stop the parser; it only takes notice if it is still running.
+     Waking it up matters when it is blocked on a full queue. */
+  svn_atomic_set(&pipeline->aborted, TRUE);
+  sync_err = svn_mutex__lock(pipeline->mutex);
+  if (!sync_err)
+    sync_err = svn_mutex__unlock(
+                 pipeline->mutex,
+                 svn_thread_cond__signal(pipeline->batch_taken));
+  err = svn_error_compose_create(err, sync_err);
+
+  status = apr_thread_join(&retval, thread);
+  if (retval != APR_SUCCESS)
+    err = svn_error_compose_create(err,
+              svn_error_wrap_apr(retval, _("Parser thread returned error")));
+  if (status != APR_SUCCESS)
+    err = svn_error_compose_create(err,
+              svn_error_wrap_apr(status, _("Parser thread join error")));
+
+  /* If the commit side failed first, the parser merely reports that we
+     told it to stop; don't let that noise hide the real error. */
+  if (err && pipeline->parser_err
+      && pipeline->parser_err->apr_err == SVN_ERR_CANCELLED)
+    svn_error_clear(pipeline->parser_err);
+  else
+    err = svn_error_compose_create(err, pipeline->parser_err);
+
+  /* Release any batches the parser staged but we never replayed. */
+  while (pipeline->first)
+    {
+      staged_batch_t *batch = pipeline->first;
+      pipeline->first = batch->next;
+      svn_pool_destroy(batch->pool);
+    }
+
+  return svn_error_trace(err);
+
+#else
+  return svn_error_trace(svn_repos_load_fs6(repos, dumpstream,
+                                            start_rev, end_rev,
+                                            uuid_action, parent_dir,
+                                            use_pre_commit_hook,
+                                            use_post_commit_hook,
+                                            validate_props,
+                                            ignore_dates,
+                                            normalize_props,
+                                            notify_func, notify_baton,
+                                            cancel_func, cancel_baton,
+                                            pool));
+#endif
+}
+
 /*----------------------------------------------------------------------*/
 
 /** The same functionality for revprops only **/
@@ -38,6 +38,8 @@
 #include "svn_props.h"
 #include "svn_mergeinfo.h"
 #include "repos.h"
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_mergeinfo_private.h"
@@ -603,6 +605,171 @@ next_history_rev(const apr_array_header_t *histories)
   return next_rev;
 }
 
+/* Number of bytes in the changed-path Bloom filter of a
+   change_summary_t, and the number of bits it contains. */
+#define CHANGE_SUMMARY_BLOOM_BYTES 1024
+#define CHANGE_SUMMARY_BLOOM_BITS (CHANGE_SUMMARY_BLOOM_BYTES * 8)
+
+/* A compact summary of the changed-paths list of a revision.  It lets
+   path-filtered log operations decide with a single cache probe
+   whether a revision can be relevant at all, instead of re-fetching
+   and scanning the full change list. */
+typedef struct change_summary_t
+{
+  /* TRUE if the revision contains any change that might have modified
+     svn:mergeinfo. */
+  svn_boolean_t any_mergeinfo;
+
+  /* TRUE if the revision contains any copy. */
+  svn_boolean_t any_copy;
+
+  /* Bloom filter over the changed paths and their parent directories.
+     "/" is only inserted when it got changed itself - as the parent of
+     some changed path it would make every ancestry probe match.  If a
+     path P and all its ancestors miss this filter, the revision
+     definitely changed nothing at, above or below P. */
+  apr_byte_t bloom[CHANGE_SUMMARY_BLOOM_BYTES];
+} change_summary_t;
+
+/* Cache of change summaries, keyed by "<uuid>:<rev>".  This is backed
+   by the global membuffer cache - which a pre-fork server parent may
+   have placed in shared memory, in which case one change list scan
+   serves all server processes.  Committed revisions are immutable, so
+   entries never become stale.  NULL if no membuffer cache has been
+   configured. */
+static svn_cache__t *change_summary_cache = NULL;
+static svn_atomic_t change_summary_cache_initialized = FALSE;
+
+/* Implements svn_atomic__err_init_func_t.
+   Create CHANGE_SUMMARY_CACHE on top of the global membuffer cache, if
+   there is one. */
+static svn_error_t *
+initialize_change_summary_cache(void *baton,
+                                apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+  if (membuffer)
+    {
+      /* The cache front-end must not depend on the lifetime of any
+         caller-provided pool, so allocate it in its own global pool. */
+      apr_pool_t *pool = svn_pool_create(NULL);
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                  &change_summary_cache, membuffer, NULL, NULL,
+                  APR_HASH_KEY_STRING, "REPOS_LOG_CHANGE_SUMMARY",
+                  SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                  TRUE, FALSE, pool, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set the Bloom filter bits for PATH in BLOOM. */
+static void
+bloom_insert(apr_byte_t *bloom, const char *path)
+{
+  apr_uint32_t hash = svn__fnv1a_32(path, strlen(path));
+  apr_uint32_t bit1 = hash % CHANGE_SUMMARY_BLOOM_BITS;
+  apr_uint32_t bit2 = (hash >> 16) % CHANGE_SUMMARY_BLOOM_BITS;
+
+  bloom[bit1 / 8] |= (apr_byte_t)(1 << (bit1 % 8));
+  bloom[bit2 / 8] |= (apr_byte_t)(1 << (bit2 % 8));
+}
+
+/* Return TRUE if the Bloom filter bits for PATH are set in BLOOM. */
+static svn_boolean_t
+bloom_match(const apr_byte_t *bloom, const char *path)
+{
+  apr_uint32_t hash = svn__fnv1a_32(path, strlen(path));
+  apr_uint32_t bit1 = hash % CHANGE_SUMMARY_BLOOM_BITS;
+  apr_uint32_t bit2 = (hash >> 16) % CHANGE_SUMMARY_BLOOM_BITS;
+
+  return (bloom[bit1 / 8] & (1 << (bit1 % 8)))
+      && (bloom[bit2 / 8] & (1 << (bit2 % 8)));
+}
+
+/* Insert the changed fspath PATH and its parent directories into
+   BLOOM.  "/" is only inserted if it is PATH itself. */
+static void
+bloom_insert_ancestry(apr_byte_t *bloom, const char *path,
+                      apr_pool_t *scratch_pool)
+{
+  bloom_insert(bloom, path);
+  while (path[1] != '\0')
+    {
+      path = svn_fspath__dirname(path, scratch_pool);
+      if (path[1] == '\0')
+        break;
+      bloom_insert(bloom, path);
+    }
+}
+
+/* Return TRUE if BLOOM matches the fspath PATH or any of its
+   ancestors, i.e. if the summarized revision may contain a change at,
+   above or below PATH. */
+static svn_boolean_t
+bloom_match_ancestry(const apr_byte_t *bloom, const char *path,
+                     apr_pool_t *scratch_pool)
+{
+  while (TRUE)
+    {
+      if (bloom_match(bloom, path))
+        return TRUE;
+      if (path[1] == '\0')
+        return FALSE;
+      path = svn_fspath__dirname(path, scratch_pool);
+    }
+}
+
+/* Set *SUMMARY to the cached change summary for REV in FS, or to NULL
+   if the cache does not hold one.  Allocate the result in POOL. */
+static svn_error_t *
+get_change_summary(change_summary_t **summary,
+                   svn_fs_t *fs,
+                   svn_revnum_t rev,
+                   apr_pool_t *pool)
+{
+  const char *uuid, *key;
+  svn_stringbuf_t *entry;
+  svn_boolean_t found;
+
+  *summary = NULL;
+  SVN_ERR(svn_atomic__init_once(&change_summary_cache_initialized,
+                                initialize_change_summary_cache, NULL,
+                                pool));
+  if (!change_summary_cache)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
+  key = apr_psprintf(pool, "%s:%ld", uuid, rev);
+  SVN_ERR(svn_cache__get((void **)&entry, &found, change_summary_cache,
+                         key, pool));
+  if (found && entry->len == sizeof(change_summary_t))
+    *summary = (change_summary_t *)entry->data;
+
+  return SVN_NO_ERROR;
+}
+
+/* Add SUMMARY as the cached change summary for REV in FS. */
+static svn_error_t *
+set_change_summary(const change_summary_t *summary,
+                   svn_fs_t *fs,
+                   svn_revnum_t rev,
+                   apr_pool_t *scratch_pool)
+{
+  const char *uuid, *key;
+  svn_stringbuf_t *entry;
+
+  if (!change_summary_cache)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_get_uuid(fs, &uuid, scratch_pool));
+  key = apr_psprintf(scratch_pool, "%s:%ld", uuid, rev);
+  entry = svn_stringbuf_ncreate((const char *)summary, sizeof(*summary),
+                                scratch_pool);
+  return svn_error_trace(svn_cache__set(change_summary_cache, key, entry,
+                                        scratch_pool));
+}
+
 /* Set *DELETED_MERGEINFO_CATALOG and *ADDED_MERGEINFO_CATALOG to
    catalogs describing how mergeinfo values on paths (which are the
    keys of those catalogs) were changed in REV. */
@@ -622,6 +789,7 @@ fs_mergeinfo_changed(svn_mergeinfo_catalog_t *deleted_mergeinfo_catalog,
   svn_fs_path_change3_t *change;
   svn_boolean_t any_mergeinfo = FALSE;
   svn_boolean_t any_copy = FALSE;
+  change_summary_t *summary;
 
   /* Initialize return variables. */
   *deleted_mergeinfo_catalog = svn_hash__make(result_pool);
@@ -634,53 +802,77 @@ fs_mergeinfo_changed(svn_mergeinfo_catalog_t *deleted_mergeinfo_catalog,
   /* FS iterators are potentially heavy objects.
    * Hold them in a separate pool to clean them up asap. */
   iterator_pool = svn_pool_create(scratch_pool);
+  iterpool = svn_pool_create(scratch_pool);
 
   /* We're going to use the changed-paths information for REV to
      narrow down our search. */
   SVN_ERR(svn_fs_revision_root(&root, fs, rev, scratch_pool));
-  SVN_ERR(svn_fs_paths_changed3(&iterator, root, iterator_pool,
-                                iterator_pool));
-  SVN_ERR(svn_fs_path_change_get(&change, iterator));
-
-  /* Look for copies and (potential) mergeinfo changes.
-     We will use both flags to take shortcuts further down the road.
 
-     The critical information here is whether there are any copies
-     because that greatly influences the costs for log processing.
-     So, it is faster to iterate over the changes twice - in the worst
-     case b/c most times there is no m/i at all and we exit out early
-     without any overhead.
-   */
-  while (change && (!any_mergeinfo || !any_copy))
+  SVN_ERR(get_change_summary(&summary, fs, rev, scratch_pool));
+  if (summary)
     {
-      /* If there was a prop change and we are not positive that _no_
-         mergeinfo change happened, we must assume that it might have. */
-      if (change->mergeinfo_mod != svn_tristate_false && change->prop_mod)
-        any_mergeinfo = TRUE;
-
-      if (   (change->change_kind == svn_fs_path_change_add)
-          || (change->change_kind == svn_fs_path_change_replace))
-        any_copy = TRUE;
+      /* An earlier scan already summarized this change list; one cache
+         probe replaces re-fetching and scanning it. */
+      any_mergeinfo = summary->any_mergeinfo;
+      any_copy = summary->any_copy;
+    }
+  else
+    {
+      change_summary_t new_summary = { 0 };
 
+      SVN_ERR(svn_fs_paths_changed3(&iterator, root, iterator_pool,
+                                    iterator_pool));
       SVN_ERR(svn_fs_path_change_get(&change, iterator));
+
+      /* Look for copies and (potential) mergeinfo changes.
+         We will use both flags to take shortcuts further down the road.
+
+         The critical information here is whether there are any copies
+         because that greatly influences the costs for log processing.
+         While building the summary, we scan the whole list once - but
+         all future calls for REV are then served from the cache.
+       */
+      while (change)
+        {
+          /* If there was a prop change and we are not positive that _no_
+             mergeinfo change happened, we must assume that it might have. */
+          if (change->mergeinfo_mod != svn_tristate_false && change->prop_mod)
+            any_mergeinfo = TRUE;
+
+          if (   (change->change_kind == svn_fs_path_change_add)
+              || (change->change_kind == svn_fs_path_change_replace))
+            any_copy = TRUE;
+
+          svn_pool_clear(iterpool);
+          bloom_insert_ancestry(new_summary.bloom, change->path.data,
+                                iterpool);
+
+          SVN_ERR(svn_fs_path_change_get(&change, iterator));
+        }
+
+      new_summary.any_mergeinfo = any_mergeinfo;
+      new_summary.any_copy = any_copy;
+      SVN_ERR(set_change_summary(&new_summary, fs, rev, scratch_pool));
+
+      svn_pool_clear(iterator_pool);
     }
 
   /* No potential mergeinfo changes?  We're done. */
   if (! any_mergeinfo)
     {
       svn_pool_destroy(iterator_pool);
+      svn_pool_destroy(iterpool);
       return SVN_NO_ERROR;
     }
 
   /* There is or may be some m/i change. Look closely now. */
-  svn_pool_clear(iterator_pool);
   SVN_ERR(svn_fs_paths_changed3(&iterator, root, iterator_pool,
                                 iterator_pool));
 
   /* Loop over changes, looking for anything that might carry an
      svn:mergeinfo change and is one of our paths of interest, or a
      child or [grand]parent directory thereof. */
-  iterpool = svn_pool_create(scratch_pool);
+  svn_pool_clear(iterpool);
   while (TRUE)
     {
       const char *changed_path;
@@ -900,6 +1092,30 @@ get_combined_mergeinfo_changes(svn_mergeinfo_t *added_mergeinfo,
   if (! paths->nelts)
     return SVN_NO_ERROR;
 
+  /* If a cached change summary proves that REV modified no mergeinfo,
+     or that it changed nothing at, above or below any of our paths,
+     skip it with a single cache probe. */
+  {
+    change_summary_t *summary;
+
+    SVN_ERR(get_change_summary(&summary, fs, rev, scratch_pool));
+    if (summary)
+      {
+        svn_boolean_t relevant = FALSE;
+
+        if (! summary->any_mergeinfo)
+          return SVN_NO_ERROR;
+
+        for (i = 0; i < paths->nelts && !relevant; i++)
+          relevant = bloom_match_ancestry(summary->bloom,
+                                          APR_ARRAY_IDX(paths, i,
+                                                        const char *),
+                                          scratch_pool);
+        if (! relevant)
+          return SVN_NO_ERROR;
+      }
+  }
+
   /* Fetch the mergeinfo changes for REV. */
   err = fs_mergeinfo_changed(&deleted_mergeinfo_catalog,
                              &added_mergeinfo_catalog,
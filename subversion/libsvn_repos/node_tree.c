@@ -50,58 +50,117 @@
 
 
 
+/*** Editor batons. ***/
+
+/* Size, in bytes, of the blocks from which nodes and their names are
+   carved. */
+#define NODE_BLOCK_SIZE 4096
+
+struct edit_baton
+{
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  svn_fs_root_t *base_root;
+  apr_pool_t *node_pool;
+  svn_repos_node_t *node;
+
+  /* The current node allocation block and the number of bytes still
+     unused in it.  Carving nodes and their names out of larger blocks
+     keeps huge change trees from paying per-node allocation overhead. */
+  char *block;
+  apr_size_t block_left;
+};
+
+
+struct node_baton
+{
+  struct edit_baton *edit_baton;
+  struct node_baton *parent_baton;
+
+  /* The change node, or NULL if this node was merely opened and no
+     change has been reported for it (or below it) yet. */
+  svn_repos_node_t *node;
+
+  /* The basename and kind of this node, saved so a merely opened node
+     can be materialized later. */
+  const char *name;
+  svn_node_kind_t kind;
+
+  /* The youngest child node created below this one, so appending to
+     the child list costs no walk over the elder siblings. */
+  svn_repos_node_t *last_child;
+};
+
+
+
 /*** Node creation and assembly structures and routines. ***/
 static svn_repos_node_t *
-create_node(const char *name,
-            svn_repos_node_t *parent,
-            apr_pool_t *pool)
+create_node(struct edit_baton *eb,
+            const char *name,
+            svn_repos_node_t *parent)
 {
-  svn_repos_node_t *node = apr_pcalloc(pool, sizeof(*node));
+  svn_repos_node_t *node;
+  apr_size_t name_len = strlen(name) + 1;
+  apr_size_t size = APR_ALIGN_DEFAULT(sizeof(*node) + name_len);
+
+  /* Carve the node and its name from the current block, fetching a
+     fresh block from the pool when the current one is exhausted. */
+  if (size > eb->block_left)
+    {
+      eb->block_left = size > NODE_BLOCK_SIZE ? size : NODE_BLOCK_SIZE;
+      eb->block = apr_palloc(eb->node_pool, eb->block_left);
+    }
+
+  node = (svn_repos_node_t *)eb->block;
+  eb->block += size;
+  eb->block_left -= size;
+
+  memset(node, 0, sizeof(*node));
   node->action = 'R';
   node->kind = svn_node_unknown;
-  node->name = apr_pstrdup(pool, name);
+  node->name = memcpy((char *)node + sizeof(*node), name, name_len);
   node->parent = parent;
   return node;
 }
 
 
 static svn_repos_node_t *
-create_sibling_node(svn_repos_node_t *elder,
-                    const char *name,
-                    apr_pool_t *pool)
-{
-  svn_repos_node_t *tmp_node;
+add_child_node(struct node_baton *pb,
+               const char *name);
 
-  /* No ELDER sibling?  That's just not gonna work out. */
-  if (! elder)
-    return NULL;
 
-  /* Run to the end of the list of siblings of ELDER. */
-  tmp_node = elder;
-  while (tmp_node->sibling)
-    tmp_node = tmp_node->sibling;
+/* Return the change node for NB, creating it (and the nodes of any
+   not-yet-materialized parents) if NB was merely opened and has not
+   been touched before. */
+static svn_repos_node_t *
+materialize_node(struct node_baton *nb)
+{
+  if (! nb->node)
+    {
+      nb->node = add_child_node(nb->parent_baton, nb->name);
+      nb->node->kind = nb->kind;
+    }
 
-  /* Create a new youngest sibling and return that. */
-  return (tmp_node->sibling = create_node(name, elder->parent, pool));
+  return nb->node;
 }
 
 
+/* Create a new youngest child node named NAME below PB's node and
+   return it. */
 static svn_repos_node_t *
-create_child_node(svn_repos_node_t *parent,
-                  const char *name,
-                  apr_pool_t *pool)
+add_child_node(struct node_baton *pb,
+               const char *name)
 {
-  /* No PARENT node?  That's just not gonna work out. */
-  if (! parent)
-    return NULL;
+  svn_repos_node_t *parent = materialize_node(pb);
+  svn_repos_node_t *node = create_node(pb->edit_baton, name, parent);
 
-  /* If PARENT has no children, create its first one and return that. */
-  if (! parent->child)
-    return (parent->child = create_node(name, parent, pool));
+  if (pb->last_child)
+    pb->last_child->sibling = node;
+  else
+    parent->child = node;
+  pb->last_child = node;
 
-  /* If PARENT already has a child, create a new sibling for its first
-     child and return that. */
-  return create_sibling_node(parent->child, name, pool);
+  return node;
 }
 
 
@@ -177,25 +236,7 @@ find_real_base_location(const char **path_p,
 
 
 
-/*** Editor functions and batons. ***/
-
-struct edit_baton
-{
-  svn_fs_t *fs;
-  svn_fs_root_t *root;
-  svn_fs_root_t *base_root;
-  apr_pool_t *node_pool;
-  svn_repos_node_t *node;
-};
-
-
-struct node_baton
-{
-  struct edit_baton *edit_baton;
-  struct node_baton *parent_baton;
-  svn_repos_node_t *node;
-};
-
+/*** Editor functions. ***/
 
 static svn_error_t *
 delete_entry(const char *path,
@@ -214,9 +255,9 @@ delete_entry(const char *path,
 
   /* Get (or create) the change node and update it. */
   name = svn_relpath_basename(path, pool);
-  node = find_child_by_name(d->node, name);
+  node = find_child_by_name(materialize_node(d), name);
   if (! node)
-    node = create_child_node(d->node, name, eb->node_pool);
+    node = add_child_node(d, name);
   node->action = 'D';
 
   /* We need to look up this node's parents to see what its original
@@ -267,15 +308,25 @@ add_open_helper(const char *path,
 
   nb->edit_baton = eb;
   nb->parent_baton = pb;
+  nb->kind = kind;
 
-  /* Create and populate the node. */
-  nb->node = create_child_node(pb->node, svn_relpath_basename(path, NULL),
-                               eb->node_pool);
-  nb->node->kind = kind;
-  nb->node->action = action;
-  nb->node->copyfrom_rev = copyfrom_rev;
-  nb->node->copyfrom_path =
-    copyfrom_path ? apr_pstrdup(eb->node_pool, copyfrom_path) : NULL;
+  if (action == 'R')
+    {
+      /* The node was merely opened.  Don't materialize it until some
+         change is actually reported for it or below it; POOL outlives
+         any such report, so just remember the name. */
+      nb->name = svn_relpath_basename(path, pool);
+    }
+  else
+    {
+      /* Create and populate the node. */
+      nb->node = add_child_node(pb, svn_relpath_basename(path, NULL));
+      nb->node->kind = kind;
+      nb->node->action = action;
+      nb->node->copyfrom_rev = copyfrom_rev;
+      nb->node->copyfrom_path =
+        copyfrom_path ? apr_pstrdup(eb->node_pool, copyfrom_path) : NULL;
+    }
 
   *child_baton = nb;
   return SVN_NO_ERROR;
@@ -293,7 +344,7 @@ open_root(void *edit_baton,
 
   d->edit_baton = eb;
   d->parent_baton = NULL;
-  d->node = (eb->node = create_node("", NULL, eb->node_pool));
+  d->node = (eb->node = create_node(eb, "", NULL));
   d->node->kind = svn_node_dir;
   d->node->action = 'R';
   *root_baton = d;
@@ -364,7 +415,7 @@ apply_textdelta(void *file_baton,
                 void **handler_baton)
 {
   struct node_baton *fb = file_baton;
-  fb->node->text_mod = TRUE;
+  materialize_node(fb)->text_mod = TRUE;
   *handler = svn_delta_noop_window_handler;
   *handler_baton = NULL;
   return SVN_NO_ERROR;
@@ -379,7 +430,7 @@ change_node_prop(void *node_baton,
                  apr_pool_t *pool)
 {
   struct node_baton *nb = node_baton;
-  nb->node->prop_mod = TRUE;
+  materialize_node(nb)->prop_mod = TRUE;
   return SVN_NO_ERROR;
 }
 
@@ -914,18 +914,25 @@ get_relevant_changes(apr_hash_t **changed_paths,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_repos_replay2(svn_fs_root_t *root,
-                  const char *base_path,
-                  svn_revnum_t low_water_mark,
-                  svn_boolean_t send_deltas,
-                  const svn_delta_editor_t *editor,
-                  void *edit_baton,
-                  svn_repos_authz_func_t authz_read_func,
-                  void *authz_read_baton,
-                  apr_pool_t *pool)
+/* The guts of svn_repos_replay2(), replaying ROOT through EDITOR and
+   EDIT_BATON.
+
+   If COMPARE_ROOT is non-NULL, use it as the delta base instead of
+   opening a fresh root; it must then be the root of ROOT's base
+   revision.  It is ignored unless SEND_DELTAS is set.  The other
+   arguments are as for svn_repos_replay2(). */
+static svn_error_t *
+replay_revision(svn_fs_root_t *root,
+                svn_fs_root_t *compare_root,
+                const char *base_path,
+                svn_revnum_t low_water_mark,
+                svn_boolean_t send_deltas,
+                const svn_delta_editor_t *editor,
+                void *edit_baton,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                apr_pool_t *pool)
 {
-#ifndef USE_EV2_IMPL
   apr_hash_t *changed_paths;
   apr_array_header_t *paths;
   struct path_driver_cb_baton cb_baton;
@@ -964,12 +971,14 @@ svn_repos_replay2(svn_fs_root_t *root,
 
   if (send_deltas)
     {
-      SVN_ERR(svn_fs_revision_root(&cb_baton.compare_root,
-                                   svn_fs_root_fs(root),
-                                   svn_fs_is_revision_root(root)
-                                     ? svn_fs_revision_root_revision(root) - 1
-                                     : svn_fs_txn_root_base_revision(root),
-                                   pool));
+      if (! compare_root)
+        SVN_ERR(svn_fs_revision_root(&compare_root,
+                                     svn_fs_root_fs(root),
+                                     svn_fs_is_revision_root(root)
+                                       ? svn_fs_revision_root_revision(root) - 1
+                                       : svn_fs_txn_root_base_revision(root),
+                                     pool));
+      cb_baton.compare_root = compare_root;
     }
 
   cb_baton.copies = apr_array_make(pool, 4, sizeof(struct copy_info *));
@@ -987,6 +996,25 @@ svn_repos_replay2(svn_fs_root_t *root,
   return svn_delta_path_driver3(editor, edit_baton,
                                 paths, TRUE,
                                 path_driver_cb_func, &cb_baton, pool);
+}
+
+svn_error_t *
+svn_repos_replay2(svn_fs_root_t *root,
+                  const char *base_path,
+                  svn_revnum_t low_water_mark,
+                  svn_boolean_t send_deltas,
+                  const svn_delta_editor_t *editor,
+                  void *edit_baton,
+                  svn_repos_authz_func_t authz_read_func,
+                  void *authz_read_baton,
+                  apr_pool_t *pool)
+{
+#ifndef USE_EV2_IMPL
+  return svn_error_trace(replay_revision(root, NULL, base_path,
+                                         low_water_mark, send_deltas,
+                                         editor, edit_baton,
+                                         authz_read_func, authz_read_baton,
+                                         pool));
 #else
   svn_editor_t *editorv2;
   struct svn_delta__extra_baton *exb;
@@ -1046,6 +1074,89 @@ svn_repos_replay2(svn_fs_root_t *root,
 #endif
 }
 
+svn_error_t *
+svn_repos__replay_range(svn_repos_t *repos,
+                        const char *base_path,
+                        svn_revnum_t start_rev,
+                        svn_revnum_t end_rev,
+                        svn_revnum_t low_water_mark,
+                        svn_boolean_t send_deltas,
+                        svn_repos__replay_revstart_func_t revstart_func,
+                        svn_repos__replay_revfinish_func_t revfinish_func,
+                        void *replay_baton,
+                        svn_repos_authz_func_t authz_read_func,
+                        void *authz_read_baton,
+                        apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_root_t *prev_root = NULL;
+  apr_pool_t *root_pools[2];
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t rev;
+
+  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(start_rev)
+                 && SVN_IS_VALID_REVNUM(end_rev)
+                 && start_rev <= end_rev);
+
+  /* Roots are opened in alternating pools such that each revision's root
+     outlives the next revision's replay, where it serves as the delta
+     base. */
+  root_pools[0] = svn_pool_create(pool);
+  root_pools[1] = svn_pool_create(pool);
+
+  for (rev = start_rev; rev <= end_rev; rev++)
+    {
+      apr_pool_t *root_pool = root_pools[rev & 1];
+      apr_hash_t *rev_props;
+      const svn_delta_editor_t *editor;
+      void *edit_baton;
+
+      svn_pool_clear(iterpool);
+
+      /* This releases the root opened two revisions ago, which nothing
+         references anymore. */
+      svn_pool_clear(root_pool);
+
+      SVN_ERR(svn_fs_revision_proplist2(&rev_props, fs, rev, TRUE,
+                                        iterpool, iterpool));
+      SVN_ERR(revstart_func(rev, replay_baton, &editor, &edit_baton,
+                            rev_props, iterpool));
+
+      if (rev == 0)
+        {
+          /* Special-case r0, which we know is an empty revision. */
+          SVN_ERR(editor->set_target_revision(edit_baton, 0, iterpool));
+        }
+      else
+        {
+          svn_fs_root_t *root;
+
+          SVN_ERR(svn_fs_revision_root(&root, fs, rev, root_pool));
+
+          /* Within the range, the previous revision's root doubles as
+             the delta base, saving one root open - and a cold DAG node
+             cache - per revision. */
+          SVN_ERR(replay_revision(root,
+                                  send_deltas ? prev_root : NULL,
+                                  base_path, low_water_mark, send_deltas,
+                                  editor, edit_baton,
+                                  authz_read_func, authz_read_baton,
+                                  iterpool));
+          prev_root = root;
+        }
+
+      SVN_ERR(revfinish_func(rev, replay_baton, editor, edit_baton,
+                             rev_props, iterpool));
+    }
+
+  svn_pool_destroy(root_pools[0]);
+  svn_pool_destroy(root_pools[1]);
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /*****************************************************************
  *                      Ev2 Implementation                       *
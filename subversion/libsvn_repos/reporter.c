@@ -23,6 +23,7 @@
 
 #include "svn_dirent_uri.h"
 #include "svn_hash.h"
+#include "svn_io.h"
 #include "svn_path.h"
 #include "svn_types.h"
 #include "svn_error.h"
@@ -41,12 +42,17 @@
 
 #define NUM_CACHED_SOURCE_ROOTS 4
 
-/* Theory of operation: we write report operations out to a spill-buffer
-   as we receive them.  When the report is finished, we read the
-   operations back out again, using them to guide the progression of
-   the delta between the source and target revs.
-
-   Spill-buffer content format: we use a simple ad-hoc format to store the
+/* Theory of operation: we write report operations out to an indexed
+   store as we receive them.  The store keeps the serialized operations
+   in memory until they outgrow SPILL_LIMIT and in a temporary file
+   thereafter, and records the start offset of every operation.  When
+   the report is finished, we read the operations back out again, using
+   them to guide the progression of the delta between the source and
+   target revs.  Because the report arrives in depth-first order, the
+   offset index lets the editor drive skip all operations below a
+   directory by bisection instead of parsing each of them.
+
+   Store content format: we use a simple ad-hoc format to store the
    report operations.  Each report operation is the concatenation of
    the following ("+/-" indicates the single character '+' or '-';
    <length> and <revnum> are written out as decimal strings):
@@ -89,6 +95,50 @@ typedef struct path_info_t
   apr_pool_t *pool;            /* Container pool */
 } path_info_t;
 
+/* The amount of report data we keep in memory before spilling the
+   report to a temporary file. */
+#define SPILL_LIMIT 1000000
+
+/* Block size for buffered reads of a stored report. */
+#define STORE_BLOCKSIZE 65536
+
+/* An indexed store of serialized report operations.  While the report
+   is being collected, operations are appended to BUFFER and flushed to
+   FILE once the report outgrows SPILL_LIMIT.  OFFSETS records where
+   each operation starts, allowing the editor drive to reposition
+   without parsing the operations in between. */
+typedef struct report_store_t
+{
+  /* Pool that the store, its offset index and its spill file live in. */
+  apr_pool_t *pool;
+
+  /* Write accumulator; holds the whole report as long as FILE is NULL. */
+  svn_stringbuf_t *buffer;
+
+  /* Spill file, or NULL while the report still fits in memory. */
+  apr_file_t *file;
+
+  /* Total number of bytes written to the store. */
+  apr_off_t size;
+
+  /* Start offset (apr_off_t) of each operation, in write order. */
+  apr_array_header_t *offsets;
+
+  /* Offset of the end marker, valid once the report is complete. */
+  apr_off_t end_offset;
+
+  /* Index into OFFSETS of the next operation that the sequential
+     reader will return. */
+  int next_record;
+
+  /* Current read position, and the window of store data around it
+     that we have buffered. */
+  apr_off_t pos;
+  apr_off_t window_start;
+  apr_size_t window_len;
+  char window[STORE_BLOCKSIZE];
+} report_store_t;
+
 /* Describes the standard revision properties that are relevant for
    reports.  Since a particular revision will often show up more than
    once in the report, we cache these properties for the time of the
@@ -128,8 +178,8 @@ typedef struct report_baton_t
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
 
-  /* The spill-buffer holding the report. */
-  svn_spillbuf_reader_t *reader;
+  /* The indexed store holding the report. */
+  report_store_t *store;
 
   /* For the actual editor drive, we'll need a lookahead path info
      entry, a cache of FS roots, and a pool to store them. */
@@ -164,17 +214,169 @@ static svn_error_t *delta_dirs(report_baton_t *b, svn_revnum_t s_rev,
                                svn_depth_t requested_depth,
                                apr_pool_t *pool);
 
+/* --- THE INDEXED REPORT STORE --- */
+
+/* Create a new, empty report store in POOL. */
+static report_store_t *
+store_create(apr_pool_t *pool)
+{
+  report_store_t *store = apr_pcalloc(pool, sizeof(*store));
+
+  store->pool = pool;
+  store->buffer = svn_stringbuf_create_empty(pool);
+  store->offsets = apr_array_make(pool, 64, sizeof(apr_off_t));
+  return store;
+}
+
+/* Append the contents of STORE->buffer to its spill file, creating
+   the file if it does not exist yet. */
+static svn_error_t *
+store_flush(report_store_t *store, apr_pool_t *scratch_pool)
+{
+  if (!store->file)
+    SVN_ERR(svn_io_open_unique_file3(&store->file, NULL, NULL,
+                                     svn_io_file_del_on_pool_cleanup,
+                                     store->pool, scratch_pool));
+  SVN_ERR(svn_io_file_write_full(store->file, store->buffer->data,
+                                 store->buffer->len, NULL, scratch_pool));
+  svn_stringbuf_setempty(store->buffer);
+  return SVN_NO_ERROR;
+}
+
+/* Append LEN bytes of DATA to STORE. */
+static svn_error_t *
+store_write(report_store_t *store, const char *data, apr_size_t len,
+            apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_appendbytes(store->buffer, data, len);
+  store->size += len;
+  if (store->buffer->len >= SPILL_LIMIT)
+    SVN_ERR(store_flush(store, scratch_pool));
+  return SVN_NO_ERROR;
+}
+
+/* Append the report operation REP of length LEN to STORE, recording
+   its start offset in the index. */
+static svn_error_t *
+store_write_record(report_store_t *store, const char *rep, apr_size_t len,
+                   apr_pool_t *scratch_pool)
+{
+  APR_ARRAY_PUSH(store->offsets, apr_off_t) = store->size;
+  return svn_error_trace(store_write(store, rep, len, scratch_pool));
+}
+
+/* Prepare STORE for reading back the report: flush any outstanding
+   data to the spill file and position the reader at the first
+   operation. */
+static svn_error_t *
+store_rewind(report_store_t *store, apr_pool_t *scratch_pool)
+{
+  if (store->file && store->buffer->len > 0)
+    SVN_ERR(store_flush(store, scratch_pool));
+  store->pos = 0;
+  store->window_start = 0;
+  store->window_len = 0;
+  store->next_record = 0;
+  return SVN_NO_ERROR;
+}
+
+/* Fill STORE's read window with the data starting at OFFSET. */
+static svn_error_t *
+store_refill(report_store_t *store, apr_off_t offset,
+             apr_pool_t *scratch_pool)
+{
+  apr_size_t len;
+
+  if (offset < 0 || offset >= store->size)
+    return svn_error_create(SVN_ERR_REPOS_BAD_REVISION_REPORT, NULL,
+                            _("Unexpected end of report stream"));
+
+  len = (apr_size_t)(store->size - offset);
+  if (len > STORE_BLOCKSIZE)
+    len = STORE_BLOCKSIZE;
+
+  if (store->file)
+    {
+      apr_off_t file_offset = offset;
+
+      SVN_ERR(svn_io_file_seek(store->file, APR_SET, &file_offset,
+                               scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(store->file, store->window, len,
+                                     NULL, NULL, scratch_pool));
+    }
+  else
+    memcpy(store->window, store->buffer->data + offset, len);
+
+  store->window_start = offset;
+  store->window_len = len;
+  return SVN_NO_ERROR;
+}
+
+/* Read the single character at STORE's current position into *C and
+   advance the position. */
+static svn_error_t *
+store_getc(char *c, report_store_t *store, apr_pool_t *scratch_pool)
+{
+  if (store->pos < store->window_start
+      || store->pos >= store->window_start + (apr_off_t)store->window_len)
+    SVN_ERR(store_refill(store, store->pos, scratch_pool));
+
+  *c = store->window[store->pos - store->window_start];
+  store->pos++;
+  return SVN_NO_ERROR;
+}
+
+/* Read SIZE bytes at STORE's current position into BUF and advance
+   the position. */
+static svn_error_t *
+store_read(report_store_t *store, char *buf, apr_size_t size,
+           apr_pool_t *scratch_pool)
+{
+  while (size > 0)
+    {
+      apr_size_t available;
+
+      if (store->pos < store->window_start
+          || store->pos >= store->window_start
+                           + (apr_off_t)store->window_len)
+        SVN_ERR(store_refill(store, store->pos, scratch_pool));
+
+      available = store->window_len
+                  - (apr_size_t)(store->pos - store->window_start);
+      if (available > size)
+        available = size;
+      memcpy(buf, store->window + (store->pos - store->window_start),
+             available);
+      buf += available;
+      size -= available;
+      store->pos += available;
+    }
+  return SVN_NO_ERROR;
+}
+
+/* Position STORE's sequential reader at operation IDX, or at the end
+   marker if IDX is past the last operation. */
+static void
+store_seek_record(report_store_t *store, int idx)
+{
+  if (idx < store->offsets->nelts)
+    store->pos = APR_ARRAY_IDX(store->offsets, idx, apr_off_t);
+  else
+    store->pos = store->end_offset;
+  store->next_record = idx;
+}
+
 /* --- READING PREVIOUSLY STORED REPORT INFORMATION --- */
 
 static svn_error_t *
-read_number(apr_uint64_t *num, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
+read_number(apr_uint64_t *num, report_store_t *store, apr_pool_t *pool)
 {
   char c;
 
   *num = 0;
   while (1)
     {
-      SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+      SVN_ERR(store_getc(&c, store, pool));
       if (c == ':')
         break;
       *num = *num * 10 + (c - '0');
@@ -183,14 +385,13 @@ read_number(apr_uint64_t *num, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
 }
 
 static svn_error_t *
-read_string(const char **str, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
+read_string(const char **str, report_store_t *store, apr_pool_t *pool)
 {
   apr_uint64_t len;
   apr_size_t size;
-  apr_size_t amt;
   char *buf;
 
-  SVN_ERR(read_number(&len, reader, pool));
+  SVN_ERR(read_number(&len, store, pool));
 
   /* Len can never be less than zero.  But could len be so large that
      len + 1 wraps around and we end up passing 0 to apr_palloc(),
@@ -212,25 +413,22 @@ read_string(const char **str, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
   size = (apr_size_t)len;
   buf = apr_palloc(pool, size+1);
   if (size > 0)
-    {
-      SVN_ERR(svn_spillbuf__reader_read(&amt, reader, buf, size, pool));
-      SVN_ERR_ASSERT(amt == size);
-    }
+    SVN_ERR(store_read(store, buf, size, pool));
   buf[len] = 0;
   *str = buf;
   return SVN_NO_ERROR;
 }
 
 static svn_error_t *
-read_rev(svn_revnum_t *rev, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
+read_rev(svn_revnum_t *rev, report_store_t *store, apr_pool_t *pool)
 {
   char c;
   apr_uint64_t num;
 
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  SVN_ERR(store_getc(&c, store, pool));
   if (c == '+')
     {
-      SVN_ERR(read_number(&num, reader, pool));
+      SVN_ERR(read_number(&num, store, pool));
       *rev = (svn_revnum_t) num;
     }
   else
@@ -239,15 +437,15 @@ read_rev(svn_revnum_t *rev, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
 }
 
 /* Read a single character to set *DEPTH (having already read '+')
-   from READER.  PATH is the path to which the depth applies, and is
+   from STORE.  PATH is the path to which the depth applies, and is
    used for error reporting only. */
 static svn_error_t *
-read_depth(svn_depth_t *depth, svn_spillbuf_reader_t *reader, const char *path,
+read_depth(svn_depth_t *depth, report_store_t *store, const char *path,
            apr_pool_t *pool)
 {
   char c;
 
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  SVN_ERR(store_getc(&c, store, pool));
   switch (c)
     {
     case 'X':
@@ -274,16 +472,16 @@ read_depth(svn_depth_t *depth, svn_spillbuf_reader_t *reader, const char *path,
   return SVN_NO_ERROR;
 }
 
-/* Read a report operation *PI out of READER.  Set *PI to NULL if we
+/* Read a report operation *PI out of STORE.  Set *PI to NULL if we
    have reached the end of the report. */
 static svn_error_t *
 read_path_info(path_info_t **pi,
-               svn_spillbuf_reader_t *reader,
+               report_store_t *store,
                apr_pool_t *pool)
 {
   char c;
 
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  SVN_ERR(store_getc(&c, store, pool));
   if (c == '-')
     {
       *pi = NULL;
@@ -291,26 +489,27 @@ read_path_info(path_info_t **pi,
     }
 
   *pi = apr_palloc(pool, sizeof(**pi));
-  SVN_ERR(read_string(&(*pi)->path, reader, pool));
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  SVN_ERR(read_string(&(*pi)->path, store, pool));
+  SVN_ERR(store_getc(&c, store, pool));
   if (c == '+')
-    SVN_ERR(read_string(&(*pi)->link_path, reader, pool));
+    SVN_ERR(read_string(&(*pi)->link_path, store, pool));
   else
     (*pi)->link_path = NULL;
-  SVN_ERR(read_rev(&(*pi)->rev, reader, pool));
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  SVN_ERR(read_rev(&(*pi)->rev, store, pool));
+  SVN_ERR(store_getc(&c, store, pool));
   if (c == '+')
-    SVN_ERR(read_depth(&((*pi)->depth), reader, (*pi)->path, pool));
+    SVN_ERR(read_depth(&((*pi)->depth), store, (*pi)->path, pool));
   else
     (*pi)->depth = svn_depth_infinity;
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  SVN_ERR(store_getc(&c, store, pool));
   (*pi)->start_empty = (c == '+');
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  SVN_ERR(store_getc(&c, store, pool));
   if (c == '+')
-    SVN_ERR(read_string(&(*pi)->lock_token, reader, pool));
+    SVN_ERR(read_string(&(*pi)->lock_token, store, pool));
   else
     (*pi)->lock_token = NULL;
   (*pi)->pool = pool;
+  store->next_record++;
   return SVN_NO_ERROR;
 }
 
@@ -322,7 +521,7 @@ relevant(path_info_t *pi, const char *prefix, apr_size_t plen)
           (!*prefix || pi->path[plen] == '/'));
 }
 
-/* Fetch the next pathinfo from B->reader for a descendant of
+/* Fetch the next pathinfo from B->store for a descendant of
    PREFIX.  If the next pathinfo is for an immediate child of PREFIX,
    set *ENTRY to the path component of the report information and
    *INFO to the path information for that entry.  If the next pathinfo
@@ -369,26 +568,89 @@ fetch_path_info(report_baton_t *b, const char **entry, path_info_t **info,
           *entry = relpath;
           *info = b->lookahead;
           subpool = svn_pool_create(b->pool);
-          SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+          SVN_ERR(read_path_info(&b->lookahead, b->store, subpool));
         }
     }
   return SVN_NO_ERROR;
 }
 
+/* Set *IS_RELEVANT to whether the path of operation IDX in STORE is a
+   child of PREFIX (which has length PLEN), parsing no more of the
+   operation than its leading path. */
+static svn_error_t *
+probe_path_info(svn_boolean_t *is_relevant, report_store_t *store, int idx,
+                const char *prefix, apr_size_t plen, apr_pool_t *pool)
+{
+  const char *path;
+  char c;
+
+  store->pos = APR_ARRAY_IDX(store->offsets, idx, apr_off_t);
+  SVN_ERR(store_getc(&c, store, pool)); /* skip the leading '+' */
+  SVN_ERR(read_string(&path, store, pool));
+  *is_relevant = (strncmp(path, prefix, plen) == 0
+                  && (!*prefix || path[plen] == '/'));
+  return SVN_NO_ERROR;
+}
+
 /* Skip all path info entries relevant to *PREFIX.  Call this when the
-   editor drive skips a directory. */
+   editor drive skips a directory.  The report arrives in depth-first
+   order, so the relevant entries are consecutive, starting at the
+   lookahead; locate the first entry beyond them by bisecting the
+   store's offset index instead of parsing every skipped entry. */
 static svn_error_t *
 skip_path_info(report_baton_t *b, const char *prefix)
 {
   apr_size_t plen = strlen(prefix);
+  report_store_t *store = b->store;
+  apr_pool_t *iterpool;
   apr_pool_t *subpool;
+  svn_boolean_t is_relevant;
+  int low, high, idx, bound;
 
-  while (relevant(b->lookahead, prefix, plen))
+  if (!relevant(b->lookahead, prefix, plen))
+    return SVN_NO_ERROR;
+
+  iterpool = svn_pool_create(b->pool);
+
+  /* The lookahead (entry LOW - 1) is known to be relevant.  Gallop
+     ahead in growing steps until we overshoot the relevant run, then
+     bisect within the last step for the first irrelevant entry. */
+  low = store->next_record;
+  high = store->offsets->nelts;
+  for (bound = 1; low < high; bound *= 2)
     {
-      svn_pool_destroy(b->lookahead->pool);
-      subpool = svn_pool_create(b->pool);
-      SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+      idx = store->next_record - 1 + bound;
+      if (idx >= high)
+        break;
+      svn_pool_clear(iterpool);
+      SVN_ERR(probe_path_info(&is_relevant, store, idx, prefix, plen,
+                              iterpool));
+      if (is_relevant)
+        low = idx + 1;
+      else
+        {
+          high = idx;
+          break;
+        }
     }
+  while (low < high)
+    {
+      idx = low + (high - low) / 2;
+      svn_pool_clear(iterpool);
+      SVN_ERR(probe_path_info(&is_relevant, store, idx, prefix, plen,
+                              iterpool));
+      if (is_relevant)
+        low = idx + 1;
+      else
+        high = idx;
+    }
+  svn_pool_destroy(iterpool);
+
+  /* LOW is the first entry not below PREFIX; make it the new lookahead. */
+  svn_pool_destroy(b->lookahead->pool);
+  store_seek_record(store, low);
+  subpool = svn_pool_create(b->pool);
+  SVN_ERR(read_path_info(&b->lookahead, store, subpool));
   return SVN_NO_ERROR;
 }
 
@@ -1432,12 +1694,14 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
   /* Save our pool to manage the lookahead and fs_root cache with. */
   b->pool = pool;
 
-  /* Add the end marker. */
-  SVN_ERR(svn_spillbuf__reader_write(b->reader, "-", 1, pool));
+  /* Add the end marker and switch the store over to reading. */
+  b->store->end_offset = b->store->size;
+  SVN_ERR(store_write(b->store, "-", 1, pool));
+  SVN_ERR(store_rewind(b->store, pool));
 
   /* Read the first pathinfo from the report and verify that it is a top-level
      set_path entry. */
-  SVN_ERR(read_path_info(&info, b->reader, pool));
+  SVN_ERR(read_path_info(&info, b->store, pool));
   if (!info || strcmp(info->path, b->s_operand) != 0
       || info->link_path || !SVN_IS_VALID_REVNUM(info->rev))
     return svn_error_create(SVN_ERR_REPOS_BAD_REVISION_REPORT, NULL,
@@ -1446,7 +1710,7 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
 
   /* Initialize the lookahead pathinfo. */
   subpool = svn_pool_create(pool);
-  SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+  SVN_ERR(read_path_info(&b->lookahead, b->store, subpool));
 
   if (b->lookahead && strcmp(b->lookahead->path, b->s_operand) == 0)
     {
@@ -1464,7 +1728,7 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
           b->lookahead->depth = info->depth;
         }
       info = b->lookahead;
-      SVN_ERR(read_path_info(&b->lookahead, b->reader, subpool));
+      SVN_ERR(read_path_info(&b->lookahead, b->store, subpool));
     }
 
   /* Open the target root and initialize the source root cache. */
@@ -1487,7 +1751,7 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
 
 /* --- COLLECTING THE REPORT INFORMATION --- */
 
-/* Record a report operation into the spill buffer.  Return an error
+/* Record a report operation into the report store.  Return an error
    if DEPTH is svn_depth_unknown. */
 static svn_error_t *
 write_path_info(report_baton_t *b, const char *path, const char *lpath,
@@ -1527,7 +1791,7 @@ write_path_info(report_baton_t *b, const char *path, const char *lpath,
                      strlen(path), path, lrep, rrep, drep,
                      start_empty ? '+' : '-', ltrep);
   return svn_error_trace(
-            svn_spillbuf__reader_write(b->reader, rep, strlen(rep), pool));
+            store_write_record(b->store, rep, strlen(rep), pool));
 }
 
 svn_error_t *
@@ -1631,9 +1895,7 @@ svn_repos_begin_report3(void **report_baton,
   b->authz_read_baton = authz_read_baton;
   b->revision_infos = svn_hash__make(pool);
   b->pool = pool;
-  b->reader = svn_spillbuf__reader_create(1000 /* blocksize */,
-                                          1000000 /* maxsize */,
-                                          pool);
+  b->store = store_create(pool);
   b->repos_uuid = svn_string_create(uuid, pool);
 
   /* Hand reporter back to client. */
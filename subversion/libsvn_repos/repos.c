@@ -1678,12 +1678,13 @@ svn_repos_fs_type(svn_repos_t *repos,
  */
 
 svn_error_t *
-svn_repos_recover4(const char *path,
+svn_repos_recover5(const char *path,
                    svn_boolean_t nonblocking,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
                    void * cancel_baton,
+                   apr_hash_t *fs_config,
                    apr_pool_t *pool)
 {
   svn_repos_t *repos;
@@ -1712,7 +1713,8 @@ svn_repos_recover4(const char *path,
     }
 
   /* Recover the database to a consistent state. */
-  SVN_ERR(svn_fs_recover(repos->db_path, cancel_func, cancel_baton, subpool));
+  SVN_ERR(svn_fs_recover2(repos->db_path, fs_config,
+                          cancel_func, cancel_baton, subpool));
 
   /* Close shop and free the subpool, to release the exclusive lock. */
   svn_pool_destroy(subpool);
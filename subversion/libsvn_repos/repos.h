@@ -83,6 +83,11 @@ extern "C" {
 #define SVN_REPOS__HOOK_PRE_UNLOCK      "pre-unlock"
 #define SVN_REPOS__HOOK_POST_UNLOCK     "post-unlock"
 
+/* The optional persistent hook runner program in the hooks directory.
+   If present, it is started once and individual hook invocations are
+   dispatched to it over a pipe; see hooks.c for the protocol. */
+#define SVN_REPOS__HOOK_RUNNER          "hook-runner"
+
 
 /* The extension added to the names of example hook scripts. */
 #define SVN_REPOS__HOOK_DESC_EXT        ".tmpl"
@@ -153,6 +158,11 @@ struct svn_repos_t
      those constants' addresses, therefore). */
   apr_hash_t *repository_capabilities;
 
+  /* The persistent hook runner for this repository, started on first
+     hook invocation if the hooks directory provides one, or NULL.
+     See hooks.c. */
+  struct svn_repos__hook_runner_t *hook_runner;
+
   /* Pool from which this structure was allocated.  Also used for
      auxiliary repository-related data that requires a matching
      lifespan.  (As the svn_repos_t structure tends to be relatively
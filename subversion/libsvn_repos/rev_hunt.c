@@ -37,6 +37,8 @@
 #include "svn_props.h"
 #include "svn_mergeinfo.h"
 #include "repos.h"
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
@@ -574,6 +576,54 @@ check_ancestry_of_peg_path(svn_boolean_t *is_ancestor,
 }
 
 
+/* A cached result of svn_repos__prev_location() for some PATH@REVISION.
+   In the serialized cache entry, the previous path follows this header
+   directly, NUL-terminated; it is empty if there is no previous
+   location. */
+typedef struct prev_location_t
+{
+  /* Revision in which PATH@REVISION first appeared at its path, or
+     SVN_INVALID_REVNUM if no copy affected it. */
+  svn_revnum_t appeared_rev;
+
+  /* Revision of the previous location, or SVN_INVALID_REVNUM. */
+  svn_revnum_t prev_rev;
+} prev_location_t;
+
+/* Cache of previous-location lookups, keyed by "<uuid>:<rev>:<path>".
+   This is backed by the global membuffer cache - which a pre-fork
+   server parent may have placed in shared memory, in which case one
+   history walk serves all server processes.  Committed revisions are
+   immutable and new commits only ever extend history, so entries never
+   become stale and no invalidation is required.  NULL if no membuffer
+   cache has been configured. */
+static svn_cache__t *prev_location_cache = NULL;
+static svn_atomic_t prev_location_cache_initialized = FALSE;
+
+/* Implements svn_atomic__err_init_func_t.
+   Create PREV_LOCATION_CACHE on top of the global membuffer cache, if
+   there is one. */
+static svn_error_t *
+initialize_prev_location_cache(void *baton,
+                               apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+  if (membuffer)
+    {
+      /* The cache front-end must not depend on the lifetime of any
+         caller-provided pool, so allocate it in its own global pool.
+         The backing membuffer is process-global as well. */
+      apr_pool_t *pool = svn_pool_create(NULL);
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                  &prev_location_cache, membuffer, NULL, NULL,
+                  APR_HASH_KEY_STRING, "REPOS_PREV_LOCATION",
+                  SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                  TRUE, FALSE, pool, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_repos__prev_location(svn_revnum_t *appeared_rev,
                          const char **prev_path,
@@ -586,6 +636,10 @@ svn_repos__prev_location(svn_revnum_t *appeared_rev,
   svn_fs_root_t *root, *copy_root;
   const char *copy_path, *copy_src_path, *remainder;
   svn_revnum_t copy_src_rev;
+  const char *key = NULL;
+  svn_revnum_t found_appeared_rev = SVN_INVALID_REVNUM;
+  svn_revnum_t found_prev_rev = SVN_INVALID_REVNUM;
+  const char *found_prev_path = NULL;
 
   /* Initialize return variables. */
   if (appeared_rev)
@@ -595,35 +649,92 @@ svn_repos__prev_location(svn_revnum_t *appeared_rev,
   if (prev_path)
     *prev_path = NULL;
 
+  SVN_ERR(svn_atomic__init_once(&prev_location_cache_initialized,
+                                initialize_prev_location_cache, NULL,
+                                pool));
+
+  /* History walks tend to revisit the same locations over and over -
+     every peg revision resolution for a path repeats the walks of all
+     earlier ones.  Committed history is immutable, so a cached result
+     is always current. */
+  if (prev_location_cache)
+    {
+      const char *uuid;
+      svn_stringbuf_t *entry;
+      svn_boolean_t found;
+
+      SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
+      key = apr_psprintf(pool, "%s:%ld:%s", uuid, revision, path);
+      SVN_ERR(svn_cache__get((void **)&entry, &found, prev_location_cache,
+                             key, pool));
+      if (found && entry->len > sizeof(prev_location_t))
+        {
+          prev_location_t header;
+          memcpy(&header, entry->data, sizeof(header));
+
+          if (appeared_rev)
+            *appeared_rev = header.appeared_rev;
+          if (prev_rev)
+            *prev_rev = header.prev_rev;
+          if (prev_path && entry->data[sizeof(header)])
+            *prev_path = entry->data + sizeof(header);
+          return SVN_NO_ERROR;
+        }
+    }
+
   /* Ask about the most recent copy which affected PATH@REVISION.  If
      there was no such copy, we're done.  */
   SVN_ERR(svn_fs_revision_root(&root, fs, revision, pool));
   SVN_ERR(svn_fs_closest_copy(&copy_root, &copy_path, root, path, pool));
-  if (! copy_root)
-    return SVN_NO_ERROR;
-
-  /* Ultimately, it's not the path of the closest copy's source that
-     we care about -- it's our own path's location in the copy source
-     revision.  So we'll tack the relative path that expresses the
-     difference between the copy destination and our path in the copy
-     revision onto the copy source path to determine this information.
-
-     In other words, if our path is "/branches/my-branch/foo/bar", and
-     we know that the closest relevant copy was a copy of "/trunk" to
-     "/branches/my-branch", then that relative path under the copy
-     destination is "/foo/bar".  Tacking that onto the copy source
-     path tells us that our path was located at "/trunk/foo/bar"
-     before the copy.
-  */
-  SVN_ERR(svn_fs_copied_from(&copy_src_rev, &copy_src_path,
-                             copy_root, copy_path, pool));
-  remainder = svn_fspath__skip_ancestor(copy_path, path);
-  if (prev_path)
-    *prev_path = svn_fspath__join(copy_src_path, remainder, pool);
+  if (copy_root)
+    {
+      /* Ultimately, it's not the path of the closest copy's source that
+         we care about -- it's our own path's location in the copy source
+         revision.  So we'll tack the relative path that expresses the
+         difference between the copy destination and our path in the copy
+         revision onto the copy source path to determine this information.
+
+         In other words, if our path is "/branches/my-branch/foo/bar", and
+         we know that the closest relevant copy was a copy of "/trunk" to
+         "/branches/my-branch", then that relative path under the copy
+         destination is "/foo/bar".  Tacking that onto the copy source
+         path tells us that our path was located at "/trunk/foo/bar"
+         before the copy.
+      */
+      SVN_ERR(svn_fs_copied_from(&copy_src_rev, &copy_src_path,
+                                 copy_root, copy_path, pool));
+      remainder = svn_fspath__skip_ancestor(copy_path, path);
+      found_prev_path = svn_fspath__join(copy_src_path, remainder, pool);
+      found_appeared_rev = svn_fs_revision_root_revision(copy_root);
+      found_prev_rev = copy_src_rev;
+    }
+
+  /* Cache the result, negative results included - most locations have
+     no copy in their ancestry at all. */
+  if (prev_location_cache)
+    {
+      prev_location_t header;
+      svn_stringbuf_t *entry;
+      apr_size_t path_len = found_prev_path ? strlen(found_prev_path) : 0;
+
+      header.appeared_rev = found_appeared_rev;
+      header.prev_rev = found_prev_rev;
+      entry = svn_stringbuf_create_ensure(sizeof(header) + path_len + 1,
+                                          pool);
+      svn_stringbuf_appendbytes(entry, (const char *)&header,
+                                sizeof(header));
+      svn_stringbuf_appendbytes(entry,
+                                found_prev_path ? found_prev_path : "",
+                                path_len + 1);
+      SVN_ERR(svn_cache__set(prev_location_cache, key, entry, pool));
+    }
+
   if (appeared_rev)
-    *appeared_rev = svn_fs_revision_root_revision(copy_root);
+    *appeared_rev = found_appeared_rev;
   if (prev_rev)
-    *prev_rev = copy_src_rev;
+    *prev_rev = found_prev_rev;
+  if (prev_path)
+    *prev_path = found_prev_path;
   return SVN_NO_ERROR;
 }
 
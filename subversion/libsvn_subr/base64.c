@@ -36,6 +36,20 @@
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 
+/* The hot encode / decode loops below map naturally onto the SIMD
+ * lookup-shuffle scheme.  Use such an implementation when the target
+ * supports the required instructions unconditionally.
+ */
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define SVN_BASE64_SIMD 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SVN_BASE64_SIMD 1
+#else
+#define SVN_BASE64_SIMD 0
+#endif
+
 /* When asked to format the base64-encoded output as multiple lines,
    we put this many chars in each line (plus one new line char) unless
    we run out of data.
@@ -85,6 +99,80 @@ encode_group(const unsigned char *in, char *out)
   out[3] = base64tab[part2 & 0x3f];
 }
 
+#if defined(__SSSE3__)
+
+/* Base64-encode 12 bytes from IN into 16 chars at OUT.  Reads a full
+   16 bytes from IN; the last 4 bytes are ignored but must be valid
+   memory. */
+static APR_INLINE void
+encode_block(const unsigned char *in, char *out)
+{
+  /* Spread the 12 input bytes over the 16 byte lanes such that every
+     32 bit lane holds one 3-byte group (in big-endian order with the
+     middle byte duplicated). */
+  const __m128i shuf = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                     7, 6, 8, 7, 10, 9, 11, 10);
+
+  /* Offsets to add to a 6-bit value to translate it into its base64
+     char, selected by the value range. */
+  const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4,
+                                    -4, -4, -4, -4, -19, -16, 0, 0);
+
+  __m128i data = _mm_loadu_si128((const __m128i *)in);
+  __m128i indices, offsets, result;
+
+  /* Isolate the four 6-bit units of every group in one byte lane each. */
+  data = _mm_shuffle_epi8(data, shuf);
+  indices = _mm_or_si128(
+      _mm_mulhi_epu16(_mm_and_si128(data, _mm_set1_epi32(0x0fc0fc00)),
+                      _mm_set1_epi32(0x04000040)),
+      _mm_mullo_epi16(_mm_and_si128(data, _mm_set1_epi32(0x003f03f0)),
+                      _mm_set1_epi32(0x01000010)));
+
+  /* Translate the values 0..63 into base64 chars.  The LUT index is 0
+     for 0..25, 1 for 26..51 and 2 + value - 52 otherwise. */
+  offsets = _mm_sub_epi8(_mm_subs_epu8(indices, _mm_set1_epi8(51)),
+                         _mm_cmpgt_epi8(indices, _mm_set1_epi8(25)));
+  result = _mm_add_epi8(indices, _mm_shuffle_epi8(lut, offsets));
+
+  _mm_storeu_si128((__m128i *)out, result);
+}
+
+#elif SVN_BASE64_SIMD
+
+/* Base64-encode 48 bytes from IN into 64 chars at OUT. */
+static APR_INLINE void
+encode_block(const unsigned char *in, char *out)
+{
+  uint8x16x4_t lut, result;
+  uint8x16x3_t data;
+
+  /* The full value -> char table fits into one 4-register lookup. */
+  lut.val[0] = vld1q_u8((const uint8_t *)base64tab);
+  lut.val[1] = vld1q_u8((const uint8_t *)base64tab + 16);
+  lut.val[2] = vld1q_u8((const uint8_t *)base64tab + 32);
+  lut.val[3] = vld1q_u8((const uint8_t *)base64tab + 48);
+
+  /* De-interleave the 3-byte groups, extract the 6-bit units and map
+     them onto their base64 chars in a single table lookup each. */
+  data = vld3q_u8(in);
+  result.val[0] = vqtbl4q_u8(lut, vshrq_n_u8(data.val[0], 2));
+  result.val[1] = vqtbl4q_u8(lut,
+                             vorrq_u8(vshlq_n_u8(vandq_u8(data.val[0],
+                                                          vdupq_n_u8(3)), 4),
+                                      vshrq_n_u8(data.val[1], 4)));
+  result.val[2] = vqtbl4q_u8(lut,
+                             vorrq_u8(vshlq_n_u8(vandq_u8(data.val[1],
+                                                          vdupq_n_u8(0xf)),
+                                                 2),
+                                      vshrq_n_u8(data.val[2], 6)));
+  result.val[3] = vqtbl4q_u8(lut, vandq_u8(data.val[2], vdupq_n_u8(0x3f)));
+
+  vst4q_u8((uint8_t *)out, result);
+}
+
+#endif
+
 /* Base64-encode a line, i.e. BYTES_PER_LINE bytes from DATA into
    BASE64_LINELEN chars and append it to STR.  It does not assume that
    a new line char will be appended, though.
@@ -101,6 +189,18 @@ encode_line(svn_stringbuf_t *str, const char *data)
   char *out = str->data + str->len;
   char *end = out + BASE64_LINELEN;
 
+#if defined(__SSSE3__)
+  /* Encode blocks of 12 bytes at a time.  Stopping a full output block
+     short of the line end keeps the 16-byte loads within this line's
+     BYTES_PER_LINE input bytes. */
+  for ( ; end - out >= 16; in += 12, out += 16)
+    encode_block(in, out);
+#elif SVN_BASE64_SIMD
+  /* Encode one block of 48 bytes at a time. */
+  for ( ; end - out >= 64; in += 48, out += 64)
+    encode_block(in, out);
+#endif
+
   /* We assume that BYTES_PER_LINE is a multiple of 3 and BASE64_LINELEN
      a multiple of 4. */
   for ( ; out != end; in += 3, out += 4)
@@ -361,6 +461,124 @@ decode_group_directly(const unsigned char *in, char *out)
   return (part0 | part1 | part2 | part3) != (unsigned char)(-1);
 }
 
+#if defined(__SSSE3__)
+
+/* Base64-decode 16 chars from IN into 12 bytes at OUT.  Writes a full
+   16 bytes to OUT; the last 4 bytes are garbage but there must be room
+   for them.  Returns FALSE without touching OUT if any input char is
+   not a base64 char. */
+static APR_INLINE svn_boolean_t
+decode_block(const unsigned char *in, char *out)
+{
+  /* Char class bits per low / high nibble.  A char is valid iff the
+     classes selected by its two nibbles do not intersect. */
+  const __m128i lut_lo = _mm_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lut_hi = _mm_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+
+  /* Offset to add to a char to get its 6-bit value, selected by the
+     char's high nibble (with the entry for '/' shifted to index 1). */
+  const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+
+  __m128i data = _mm_loadu_si128((const __m128i *)in);
+  __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(data, 4),
+                                     _mm_set1_epi8(0x0f));
+  __m128i lo_nibbles = _mm_and_si128(data, _mm_set1_epi8(0x0f));
+  __m128i eq_slash = _mm_cmpeq_epi8(data, _mm_set1_epi8(0x2f));
+  __m128i merged;
+
+  if (_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(lut_lo, lo_nibbles),
+                                     _mm_shuffle_epi8(lut_hi, hi_nibbles)),
+                       _mm_setzero_si128())) != 0xffff)
+    return FALSE;
+
+  /* Translate the chars into their 6-bit values ... */
+  data = _mm_add_epi8(data,
+                      _mm_shuffle_epi8(lut_roll,
+                                       _mm_add_epi8(eq_slash, hi_nibbles)));
+
+  /* ... and pack every 4 of them into 3 bytes. */
+  merged = _mm_maddubs_epi16(data, _mm_set1_epi32(0x01400140));
+  merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  merged = _mm_shuffle_epi8(merged,
+                            _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                          14, 13, 12, -1, -1, -1, -1));
+  _mm_storeu_si128((__m128i *)out, merged);
+
+  return TRUE;
+}
+
+#elif SVN_BASE64_SIMD
+
+/* Char class bits per low / high nibble, and the translation offsets
+   per high nibble.  See the SSSE3 variant of decode_block for details. */
+static const apr_byte_t decode_lut_lo[16] = {
+  0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+  0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+};
+static const apr_byte_t decode_lut_hi[16] = {
+  0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+};
+static const apr_byte_t decode_lut_roll[16] = {
+  0, 16, 19, 4, 0xbf, 0xbf, 0xb9, 0xb9, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* Translate the base64 chars in DATA into their 6-bit values.  Flag
+   any non-base64 chars in *INVALID. */
+static APR_INLINE uint8x16_t
+decode_translate(uint8x16_t data, uint8x16_t *invalid)
+{
+  uint8x16_t hi_nibbles = vshrq_n_u8(data, 4);
+  uint8x16_t lo_nibbles = vandq_u8(data, vdupq_n_u8(0x0f));
+  uint8x16_t eq_slash = vceqq_u8(data, vdupq_n_u8(0x2f));
+  uint8x16_t roll;
+
+  *invalid = vorrq_u8(*invalid,
+                      vtstq_u8(vqtbl1q_u8(vld1q_u8(decode_lut_lo),
+                                          lo_nibbles),
+                               vqtbl1q_u8(vld1q_u8(decode_lut_hi),
+                                          hi_nibbles)));
+
+  roll = vqtbl1q_u8(vld1q_u8(decode_lut_roll),
+                    vaddq_u8(hi_nibbles, eq_slash));
+  return vaddq_u8(data, roll);
+}
+
+/* Base64-decode 64 chars from IN into 48 bytes at OUT.  Returns FALSE
+   without touching OUT if any input char is not a base64 char. */
+static APR_INLINE svn_boolean_t
+decode_block(const unsigned char *in, char *out)
+{
+  uint8x16x4_t data = vld4q_u8(in);
+  uint8x16_t invalid = vdupq_n_u8(0);
+  uint8x16_t part0, part1, part2, part3;
+  uint8x16x3_t result;
+
+  part0 = decode_translate(data.val[0], &invalid);
+  part1 = decode_translate(data.val[1], &invalid);
+  part2 = decode_translate(data.val[2], &invalid);
+  part3 = decode_translate(data.val[3], &invalid);
+
+  if (vmaxvq_u8(invalid))
+    return FALSE;
+
+  /* Pack every 4 values into 3 bytes. */
+  result.val[0] = vorrq_u8(vshlq_n_u8(part0, 2), vshrq_n_u8(part1, 4));
+  result.val[1] = vorrq_u8(vshlq_n_u8(part1, 4), vshrq_n_u8(part2, 2));
+  result.val[2] = vorrq_u8(vshlq_n_u8(part2, 6), part3);
+  vst3q_u8((uint8_t *)out, result);
+
+  return TRUE;
+}
+
+#endif
+
 /* Base64-encode up to BASE64_LINELEN chars from *DATA and append it to
    STR.  After the function returns, *DATA will point to the first char
    that has not been translated, yet.  Returns TRUE if all BASE64_LINELEN
@@ -379,6 +597,22 @@ decode_line(svn_stringbuf_t *str, const char **data)
   char *out = str->data + str->len;
   char *end = out + BYTES_PER_LINE;
 
+#if defined(__SSSE3__)
+  /* Decode blocks of 16 chars at a time.  Stopping a full output block
+     short of the line end keeps the 16-byte stores within this line's
+     BYTES_PER_LINE output bytes.  Fall through to the scalar loop upon
+     the first special char. */
+  for (; end - out >= 16; p += 16, out += 12)
+    if (!decode_block(p, out))
+      break;
+#elif SVN_BASE64_SIMD
+  /* Decode one block of 64 chars at a time.  Fall through to the scalar
+     loop upon the first special char. */
+  for (; end - out >= 48; p += 64, out += 48)
+    if (!decode_block(p, out))
+      break;
+#endif
+
   /* We assume that BYTES_PER_LINE is a multiple of 3 and BASE64_LINELEN
      a multiple of 4.  Stop translation as soon as we encounter a special
      char.  Leave the entire group untouched in that case. */
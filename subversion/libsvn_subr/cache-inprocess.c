@@ -23,6 +23,8 @@
 
 #include <assert.h>
 
+#include <apr_hash.h>
+
 #include "svn_pools.h"
 
 #include "svn_private_config.h"
@@ -30,13 +32,25 @@
 #include "cache.h"
 #include "private/svn_mutex.h"
 
+/* The cache is split into multiple independent segments, each with its
+ * own hash, page lists and mutex.  Keys get mapped to segments by their
+ * hash value, so concurrent readers and writers only contend when they
+ * actually access the same segment instead of convoying on a single
+ * cache-global lock.
+ *
+ * Maximum number of segments in a thread-safe cache.  Single-threaded
+ * caches always use one segment.
+ */
+#define MAX_SEGMENT_COUNT 16
+
+struct cache_segment;
+
 /* The (internal) cache object. */
 typedef struct inprocess_cache_t {
   /* A user-defined identifier for this cache instance. */
   const char *id;
 
-  /* HASH maps a key (of size KLEN) to a struct cache_entry. */
-  apr_hash_t *hash;
+  /* Key length used by all segment hashes. */
   apr_ssize_t klen;
 
   /* Used to copy values into the cache. */
@@ -45,64 +59,99 @@ typedef struct inprocess_cache_t {
   /* Used to copy values out of the cache. */
   svn_cache__deserialize_func_t deserialize_func;
 
-  /* Maximum number of pages that this cache instance may allocate */
+  /* Maximum number of pages that this cache instance may allocate,
+   * summed over all segments. */
+  apr_uint64_t total_pages;
+  /* Number of cache entries stored on each page.  Must be at least 1. */
+  apr_uint64_t items_per_page;
+
+  /* Array of SEGMENT_COUNT independent cache segments. */
+  struct cache_segment *segments;
+  apr_uint32_t segment_count;
+
+  /* The pool that the svn_cache__t itself, the segments, hashes and all
+   * pages are allocated in; subpools of this pool are used for the
+   * cache_entry structs, as well as the dup'd values and hash keys.
+   */
+  apr_pool_t *cache_pool;
+} inprocess_cache_t;
+
+/* A single, independently locked segment of the cache.  Each segment
+ * uses a segmented LRU scheme on its pages:  pages that got filled but
+ * never hit afterwards stay on the probationary list and are evicted
+ * first; pages that receive hits move to the protected list.  A single
+ * scan through the cached data can therefore not flush the frequently
+ * used pages. */
+struct cache_segment {
+  /* HASH maps a key (of size KLEN) to a struct cache_entry. */
+  apr_hash_t *hash;
+
+  /* Number of pages this segment may allocate. */
   apr_uint64_t total_pages;
   /* The number of pages we're allowed to allocate before having to
    * try to reuse one. */
   apr_uint64_t unallocated_pages;
-  /* Number of cache entries stored on each page.  Must be at least 1. */
-  apr_uint64_t items_per_page;
 
   /* A dummy cache_page serving as the head of a circular doubly
-   * linked list of cache_pages.  SENTINEL->NEXT is the most recently
-   * used page, and SENTINEL->PREV is the least recently used page.
-   * All pages in this list are "full"; the page currently being
-   * filled (PARTIAL_PAGE) is not in the list. */
+   * linked list of the "protected" cache_pages, i.e. those that
+   * received hits after being filled.  SENTINEL->NEXT is the most
+   * recently used page, and SENTINEL->PREV is the least recently
+   * used page.  All pages in this list are "full"; the page currently
+   * being filled (PARTIAL_PAGE) is in neither list. */
   struct cache_page *sentinel;
 
+  /* Same for the "probationary" pages, i.e. those that have not been
+   * hit since they got filled.  Eviction starts at this list's tail. */
+  struct cache_page *probationary;
+
+  /* Number of pages on the protected list and the maximum number we
+   * allow there before demoting the list tail. */
+  apr_uint64_t protected_count;
+  apr_uint64_t protected_limit;
+
   /* A page currently being filled with entries, or NULL if there's no
-   * partially-filled page.  This page is not in SENTINEL's list. */
+   * partially-filled page.  This page is in neither of the lists. */
   struct cache_page *partial_page;
   /* If PARTIAL_PAGE is not null, this is the number of entries
    * currently on PARTIAL_PAGE. */
   apr_uint64_t partial_page_number_filled;
 
-  /* The pool that the svn_cache__t itself, HASH, and all pages are
-   * allocated in; subpools of this pool are used for the cache_entry
-   * structs, as well as the dup'd values and hash keys.
-   */
-  apr_pool_t *cache_pool;
-
   /* Sum of the SIZE members of all cache_entry elements that are
    * accessible from HASH. This is used to make statistics available
    * even if the sub-pools have already been destroyed.
    */
   apr_size_t data_size;
 
-  /* A lock for intra-process synchronization to the cache, or NULL if
-   * the cache's creator doesn't feel the cache needs to be
+  /* A lock for intra-process synchronization to this segment, or NULL
+   * if the cache's creator doesn't feel the cache needs to be
    * thread-safe. */
   svn_mutex__t *mutex;
-} inprocess_cache_t;
+
+  /* The cache that this segment belongs to. */
+  inprocess_cache_t *cache;
+};
 
 /* A cache page; all items on the page are allocated from the same
  * pool. */
 struct cache_page {
-  /* Pointers for the LRU list anchored at the cache's SENTINEL.
-   * (NULL for the PARTIAL_PAGE.) */
+  /* Pointers for the LRU list anchored at one of the segment's
+   * sentinels.  (NULL for the PARTIAL_PAGE.) */
   struct cache_page *prev;
   struct cache_page *next;
 
+  /* TRUE while the page is on the protected list. */
+  svn_boolean_t promoted;
+
   /* The pool in which cache_entry structs, hash keys, and dup'd
    * values are allocated.  The CACHE_PAGE structs are allocated
    * in CACHE_POOL and have the same lifetime as the cache itself.
    * (The cache will never allocate more than TOTAL_PAGES page
-   * structs (inclusive of the sentinel) from CACHE_POOL.)
+   * structs (exclusive of the sentinels) from CACHE_POOL.)
    */
   apr_pool_t *page_pool;
 
   /* A singly linked list of the entries on this page; used to remove
-   * them from the cache's HASH before reusing the page. */
+   * them from the segment's HASH before reusing the page. */
   struct cache_entry *first_entry;
 };
 
@@ -125,6 +174,21 @@ struct cache_entry {
 };
 
 
+/* Return the segment of CACHE that is responsible for KEY. */
+static struct cache_segment *
+get_segment(inprocess_cache_t *cache,
+            const void *key)
+{
+  apr_ssize_t klen = cache->klen;
+  unsigned int hash;
+
+  if (cache->segment_count == 1)
+    return &cache->segments[0];
+
+  hash = apr_hashfunc_default(key, &klen);
+  return &cache->segments[hash % cache->segment_count];
+}
+
 /* Removes PAGE from the doubly-linked list it is in (leaving its PREV
  * and NEXT fields undefined). */
 static void
@@ -134,34 +198,50 @@ remove_page_from_list(struct cache_page *page)
   page->next->prev = page->prev;
 }
 
-/* Inserts PAGE after CACHE's sentinel. */
+/* Inserts PAGE right after the list head SENTINEL. */
 static void
-insert_page(inprocess_cache_t *cache,
+insert_page(struct cache_page *sentinel,
             struct cache_page *page)
 {
-  struct cache_page *pred = cache->sentinel;
-
-  page->prev = pred;
-  page->next = pred->next;
+  page->prev = sentinel;
+  page->next = sentinel->next;
   page->prev->next = page;
   page->next->prev = page;
 }
 
-/* If PAGE is in the circularly linked list (eg, its NEXT isn't NULL),
- * move it to the front of the list. */
+/* If PAGE is in one of SEGMENT's page lists (eg, its NEXT isn't NULL),
+ * move it to the front of the protected list, demoting another page to
+ * the probationary list if the protected list grew too large. */
 static svn_error_t *
-move_page_to_front(inprocess_cache_t *cache,
-                   struct cache_page *page)
+touch_page(struct cache_segment *segment,
+           struct cache_page *page)
 {
-  /* This function is called whilst CACHE is locked. */
+  /* This function is called whilst SEGMENT is locked. */
 
-  SVN_ERR_ASSERT(page != cache->sentinel);
+  SVN_ERR_ASSERT(page != segment->sentinel
+                 && page != segment->probationary);
 
   if (! page->next)
     return SVN_NO_ERROR;
 
   remove_page_from_list(page);
-  insert_page(cache, page);
+  if (! page->promoted)
+    {
+      page->promoted = TRUE;
+      ++segment->protected_count;
+    }
+  insert_page(segment->sentinel, page);
+
+  /* Keep the protected list from monopolizing the segment. */
+  if (segment->protected_count > segment->protected_limit)
+    {
+      struct cache_page *demoted = segment->sentinel->prev;
+
+      remove_page_from_list(demoted);
+      demoted->promoted = FALSE;
+      --segment->protected_count;
+      insert_page(segment->probationary, demoted);
+    }
 
   return SVN_NO_ERROR;
 }
@@ -182,15 +262,16 @@ duplicate_key(inprocess_cache_t *cache,
 static svn_error_t *
 inprocess_cache_get_internal(char **buffer,
                              apr_size_t *size,
-                             inprocess_cache_t *cache,
+                             struct cache_segment *segment,
                              const void *key,
                              apr_pool_t *result_pool)
 {
-  struct cache_entry *entry = apr_hash_get(cache->hash, key, cache->klen);
+  struct cache_entry *entry = apr_hash_get(segment->hash, key,
+                                           segment->cache->klen);
 
   if (entry)
     {
-      SVN_ERR(move_page_to_front(cache, entry->page));
+      SVN_ERR(touch_page(segment, entry->page));
 
       /* duplicate the buffer entry */
       *buffer = apr_palloc(result_pool, entry->size);
@@ -219,13 +300,14 @@ inprocess_cache_get(void **value_p,
 
   if (key)
     {
+      struct cache_segment *segment = get_segment(cache, key);
       char* buffer;
       apr_size_t size;
 
-      SVN_MUTEX__WITH_LOCK(cache->mutex,
+      SVN_MUTEX__WITH_LOCK(segment->mutex,
                            inprocess_cache_get_internal(&buffer,
                                                         &size,
-                                                        cache,
+                                                        segment,
                                                         key,
                                                         result_pool));
       /* deserialize the buffer content. Usually, this will directly
@@ -247,11 +329,11 @@ inprocess_cache_get(void **value_p,
 
 static svn_error_t *
 inprocess_cache_has_key_internal(svn_boolean_t *found,
-                                 inprocess_cache_t *cache,
+                                 struct cache_segment *segment,
                                  const void *key,
                                  apr_pool_t *scratch_pool)
 {
-  *found = apr_hash_get(cache->hash, key, cache->klen) != NULL;
+  *found = apr_hash_get(segment->hash, key, segment->cache->klen) != NULL;
 
   return SVN_NO_ERROR;
 }
@@ -265,36 +347,45 @@ inprocess_cache_has_key(svn_boolean_t *found,
   inprocess_cache_t *cache = cache_void;
 
   if (key)
-    SVN_MUTEX__WITH_LOCK(cache->mutex,
-                         inprocess_cache_has_key_internal(found,
-                                                          cache,
-                                                          key,
-                                                          scratch_pool));
+    {
+      struct cache_segment *segment = get_segment(cache, key);
+
+      SVN_MUTEX__WITH_LOCK(segment->mutex,
+                           inprocess_cache_has_key_internal(found,
+                                                            segment,
+                                                            key,
+                                                            scratch_pool));
+    }
   else
     *found = FALSE;
 
   return SVN_NO_ERROR;
 }
 
-/* Removes PAGE from the LRU list, removes all of its entries from
- * CACHE's hash, clears its pool, and sets its entry pointer to NULL.
- * Finally, puts it in the "partial page" slot in the cache and sets
+/* Removes PAGE from the list it is on, removes all of its entries from
+ * SEGMENT's hash, clears its pool, and sets its entry pointer to NULL.
+ * Finally, puts it in the "partial page" slot in the segment and sets
  * partial_page_number_filled to 0.  Must be called on a page actually
- * in the list. */
+ * in one of the lists. */
 static void
-erase_page(inprocess_cache_t *cache,
+erase_page(struct cache_segment *segment,
            struct cache_page *page)
 {
   struct cache_entry *e;
 
   remove_page_from_list(page);
+  if (page->promoted)
+    {
+      page->promoted = FALSE;
+      --segment->protected_count;
+    }
 
   for (e = page->first_entry;
        e;
        e = e->next_entry)
     {
-      cache->data_size -= e->size;
-      apr_hash_set(cache->hash, e->key, cache->klen, NULL);
+      segment->data_size -= e->size;
+      apr_hash_set(segment->hash, e->key, segment->cache->klen, NULL);
     }
 
   svn_pool_clear(page->page_pool);
@@ -303,20 +394,21 @@ erase_page(inprocess_cache_t *cache,
   page->prev = NULL;
   page->next = NULL;
 
-  cache->partial_page = page;
-  cache->partial_page_number_filled = 0;
+  segment->partial_page = page;
+  segment->partial_page_number_filled = 0;
 }
 
 
 static svn_error_t *
-inprocess_cache_set_internal(inprocess_cache_t *cache,
+inprocess_cache_set_internal(struct cache_segment *segment,
                              const void *key,
                              void *value,
                              apr_pool_t *scratch_pool)
 {
+  inprocess_cache_t *cache = segment->cache;
   struct cache_entry *existing_entry;
 
-  existing_entry = apr_hash_get(cache->hash, key, cache->klen);
+  existing_entry = apr_hash_get(segment->hash, key, cache->klen);
 
   /* Is it already here, but we can do the one-item-per-page
    * optimization? */
@@ -331,9 +423,9 @@ inprocess_cache_set_internal(inprocess_cache_t *cache,
        * *never* has a partial page (except for in the temporary state
        * that we're about to fake). */
       SVN_ERR_ASSERT(page->next != NULL);
-      SVN_ERR_ASSERT(cache->partial_page == NULL);
+      SVN_ERR_ASSERT(segment->partial_page == NULL);
 
-      erase_page(cache, page);
+      erase_page(segment, page);
       existing_entry = NULL;
     }
 
@@ -342,15 +434,15 @@ inprocess_cache_set_internal(inprocess_cache_t *cache,
     {
       struct cache_page *page = existing_entry->page;
 
-      SVN_ERR(move_page_to_front(cache, page));
-      cache->data_size -= existing_entry->size;
+      SVN_ERR(touch_page(segment, page));
+      segment->data_size -= existing_entry->size;
       if (value)
         {
           SVN_ERR(cache->serialize_func(&existing_entry->value,
                                         &existing_entry->size,
                                         value,
                                         page->page_pool));
-          cache->data_size += existing_entry->size;
+          segment->data_size += existing_entry->size;
           if (existing_entry->size == 0)
             existing_entry->value = NULL;
         }
@@ -365,32 +457,38 @@ inprocess_cache_set_internal(inprocess_cache_t *cache,
 
   /* Do we not have a partial page to put it on, but we are allowed to
    * allocate more? */
-  if (cache->partial_page == NULL && cache->unallocated_pages > 0)
+  if (segment->partial_page == NULL && segment->unallocated_pages > 0)
     {
-      cache->partial_page = apr_pcalloc(cache->cache_pool,
-                                        sizeof(*(cache->partial_page)));
-      cache->partial_page->page_pool = svn_pool_create(cache->cache_pool);
-      cache->partial_page_number_filled = 0;
-      (cache->unallocated_pages)--;
+      segment->partial_page = apr_pcalloc(cache->cache_pool,
+                                          sizeof(*(segment->partial_page)));
+      segment->partial_page->page_pool = svn_pool_create(cache->cache_pool);
+      segment->partial_page_number_filled = 0;
+      (segment->unallocated_pages)--;
     }
 
   /* Do we really not have a partial page to put it on, even after the
    * one-item-per-page optimization and checking the unallocated page
    * count? */
-  if (cache->partial_page == NULL)
+  if (segment->partial_page == NULL)
     {
-      struct cache_page *oldest_page = cache->sentinel->prev;
+      /* Prefer evicting pages that have never been hit; fall back to
+       * the tail of the protected list when everything on probation
+       * has been promoted. */
+      struct cache_page *oldest_page = segment->probationary->prev;
 
-      SVN_ERR_ASSERT(oldest_page != cache->sentinel);
+      if (oldest_page == segment->probationary)
+        oldest_page = segment->sentinel->prev;
 
-      /* Erase the page and put it in cache->partial_page. */
-      erase_page(cache, oldest_page);
+      SVN_ERR_ASSERT(oldest_page != segment->sentinel);
+
+      /* Erase the page and put it in segment->partial_page. */
+      erase_page(segment, oldest_page);
     }
 
-  SVN_ERR_ASSERT(cache->partial_page != NULL);
+  SVN_ERR_ASSERT(segment->partial_page != NULL);
 
   {
-    struct cache_page *page = cache->partial_page;
+    struct cache_page *page = segment->partial_page;
     struct cache_entry *new_entry = apr_pcalloc(page->page_pool,
                                                 sizeof(*new_entry));
 
@@ -402,7 +500,7 @@ inprocess_cache_set_internal(inprocess_cache_t *cache,
                                       &new_entry->size,
                                       value,
                                       page->page_pool));
-        cache->data_size += new_entry->size;
+        segment->data_size += new_entry->size;
         if (new_entry->size == 0)
           new_entry->value = NULL;
       }
@@ -419,16 +517,16 @@ inprocess_cache_set_internal(inprocess_cache_t *cache,
 
     /* Add the entry to the hash, using the *entry's* copy of the
      * key. */
-    apr_hash_set(cache->hash, new_entry->key, cache->klen, new_entry);
+    apr_hash_set(segment->hash, new_entry->key, cache->klen, new_entry);
 
     /* We've added something else to the partial page. */
-    (cache->partial_page_number_filled)++;
+    (segment->partial_page_number_filled)++;
 
-    /* Is it full? */
-    if (cache->partial_page_number_filled >= cache->items_per_page)
+    /* Is it full?  Freshly filled pages start on probation. */
+    if (segment->partial_page_number_filled >= cache->items_per_page)
       {
-        insert_page(cache, page);
-        cache->partial_page = NULL;
+        insert_page(segment->probationary, page);
+        segment->partial_page = NULL;
       }
   }
 
@@ -444,11 +542,15 @@ inprocess_cache_set(void *cache_void,
   inprocess_cache_t *cache = cache_void;
 
   if (key)
-    SVN_MUTEX__WITH_LOCK(cache->mutex,
-                         inprocess_cache_set_internal(cache,
-                                                      key,
-                                                      value,
-                                                      scratch_pool));
+    {
+      struct cache_segment *segment = get_segment(cache, key);
+
+      SVN_MUTEX__WITH_LOCK(segment->mutex,
+                           inprocess_cache_set_internal(segment,
+                                                        key,
+                                                        value,
+                                                        scratch_pool));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -483,12 +585,21 @@ inprocess_cache_iter(svn_boolean_t *completed,
 {
   inprocess_cache_t *cache = cache_void;
   struct cache_iter_baton b;
+  apr_uint32_t i;
+
   b.user_cb = user_cb;
   b.user_baton = user_baton;
 
-  SVN_MUTEX__WITH_LOCK(cache->mutex,
-                       svn_iter_apr_hash(completed, cache->hash,
-                                         iter_cb, &b, scratch_pool));
+  for (i = 0; i < cache->segment_count; ++i)
+    {
+      struct cache_segment *segment = &cache->segments[i];
+
+      SVN_MUTEX__WITH_LOCK(segment->mutex,
+                           svn_iter_apr_hash(completed, segment->hash,
+                                             iter_cb, &b, scratch_pool));
+      if (completed && !*completed)
+        break;
+    }
 
   return SVN_NO_ERROR;
 }
@@ -496,20 +607,21 @@ inprocess_cache_iter(svn_boolean_t *completed,
 static svn_error_t *
 inprocess_cache_get_partial_internal(void **value_p,
                                      svn_boolean_t *found,
-                                     inprocess_cache_t *cache,
+                                     struct cache_segment *segment,
                                      const void *key,
                                      svn_cache__partial_getter_func_t func,
                                      void *baton,
                                      apr_pool_t *result_pool)
 {
-  struct cache_entry *entry = apr_hash_get(cache->hash, key, cache->klen);
+  struct cache_entry *entry = apr_hash_get(segment->hash, key,
+                                           segment->cache->klen);
   if (! entry)
     {
       *found = FALSE;
       return SVN_NO_ERROR;
     }
 
-  SVN_ERR(move_page_to_front(cache, entry->page));
+  SVN_ERR(touch_page(segment, entry->page));
 
   *found = TRUE;
   return func(value_p, entry->value, entry->size, baton, result_pool);
@@ -527,14 +639,18 @@ inprocess_cache_get_partial(void **value_p,
   inprocess_cache_t *cache = cache_void;
 
   if (key)
-    SVN_MUTEX__WITH_LOCK(cache->mutex,
-                         inprocess_cache_get_partial_internal(value_p,
-                                                              found,
-                                                              cache,
-                                                              key,
-                                                              func,
-                                                              baton,
-                                                              result_pool));
+    {
+      struct cache_segment *segment = get_segment(cache, key);
+
+      SVN_MUTEX__WITH_LOCK(segment->mutex,
+                           inprocess_cache_get_partial_internal(value_p,
+                                                                found,
+                                                                segment,
+                                                                key,
+                                                                func,
+                                                                baton,
+                                                                result_pool));
+    }
   else
     *found = FALSE;
 
@@ -542,23 +658,24 @@ inprocess_cache_get_partial(void **value_p,
 }
 
 static svn_error_t *
-inprocess_cache_set_partial_internal(inprocess_cache_t *cache,
+inprocess_cache_set_partial_internal(struct cache_segment *segment,
                                      const void *key,
                                      svn_cache__partial_setter_func_t func,
                                      void *baton,
                                      apr_pool_t *scratch_pool)
 {
-  struct cache_entry *entry = apr_hash_get(cache->hash, key, cache->klen);
+  struct cache_entry *entry = apr_hash_get(segment->hash, key,
+                                           segment->cache->klen);
   if (entry)
     {
-      SVN_ERR(move_page_to_front(cache, entry->page));
+      SVN_ERR(touch_page(segment, entry->page));
 
-      cache->data_size -= entry->size;
+      segment->data_size -= entry->size;
       SVN_ERR(func(&entry->value,
                    &entry->size,
                    baton,
                    entry->page->page_pool));
-      cache->data_size += entry->size;
+      segment->data_size += entry->size;
     }
 
   return SVN_NO_ERROR;
@@ -574,12 +691,16 @@ inprocess_cache_set_partial(void *cache_void,
   inprocess_cache_t *cache = cache_void;
 
   if (key)
-    SVN_MUTEX__WITH_LOCK(cache->mutex,
-                         inprocess_cache_set_partial_internal(cache,
-                                                              key,
-                                                              func,
-                                                              baton,
-                                                              scratch_pool));
+    {
+      struct cache_segment *segment = get_segment(cache, key);
+
+      SVN_MUTEX__WITH_LOCK(segment->mutex,
+                           inprocess_cache_set_partial_internal(segment,
+                                                                key,
+                                                                func,
+                                                                baton,
+                                                                scratch_pool));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -597,20 +718,18 @@ inprocess_cache_is_cachable(void *cache_void, apr_size_t size)
 }
 
 static svn_error_t *
-inprocess_cache_get_info_internal(inprocess_cache_t *cache,
-                                  svn_cache__info_t *info,
-                                  apr_pool_t *result_pool)
+inprocess_cache_get_info_internal(struct cache_segment *segment,
+                                  svn_cache__info_t *info)
 {
-  info->id = apr_pstrdup(result_pool, cache->id);
+  apr_uint64_t entry_count = apr_hash_count(segment->hash);
 
-  info->used_entries = apr_hash_count(cache->hash);
-  info->total_entries = cache->items_per_page * cache->total_pages;
-
-  info->used_size = cache->data_size;
-  info->data_size = cache->data_size;
-  info->total_size = cache->data_size
-                   + cache->items_per_page * sizeof(struct cache_page)
-                   + info->used_entries * sizeof(struct cache_entry);
+  info->used_entries += entry_count;
+  info->used_size += segment->data_size;
+  info->data_size += segment->data_size;
+  info->total_size += segment->data_size
+                    + segment->cache->items_per_page
+                      * sizeof(struct cache_page)
+                    + entry_count * sizeof(struct cache_entry);
 
   return SVN_NO_ERROR;
 }
@@ -623,17 +742,31 @@ inprocess_cache_get_info(void *cache_void,
                          apr_pool_t *result_pool)
 {
   inprocess_cache_t *cache = cache_void;
+  apr_uint32_t i;
+
+  info->id = apr_pstrdup(result_pool, cache->id);
 
-  SVN_MUTEX__WITH_LOCK(cache->mutex,
-                       inprocess_cache_get_info_internal(cache,
-                                                         info,
-                                                         result_pool));
+  info->used_entries = 0;
+  info->total_entries = cache->items_per_page * cache->total_pages;
+  info->used_size = 0;
+  info->data_size = 0;
+  info->total_size = 0;
+
+  for (i = 0; i < cache->segment_count; ++i)
+    {
+      struct cache_segment *segment = &cache->segments[i];
+
+      SVN_MUTEX__WITH_LOCK(segment->mutex,
+                           inprocess_cache_get_info_internal(segment,
+                                                             info));
+    }
 
   return SVN_NO_ERROR;
 }
 
 static svn_cache__vtable_t inprocess_cache_vtable = {
   inprocess_cache_get,
+  NULL,                     /* no batched getter */
   inprocess_cache_has_key,
   inprocess_cache_set,
   inprocess_cache_iter,
@@ -656,12 +789,12 @@ svn_cache__create_inprocess(svn_cache__t **cache_p,
 {
   svn_cache__t *wrapper = apr_pcalloc(pool, sizeof(*wrapper));
   inprocess_cache_t *cache = apr_pcalloc(pool, sizeof(*cache));
+  apr_uint32_t segment_count;
+  apr_uint32_t i;
 
   cache->id = apr_pstrdup(pool, id);
 
   SVN_ERR_ASSERT(klen == APR_HASH_KEY_STRING || klen >= 1);
-
-  cache->hash = apr_hash_make(pool);
   cache->klen = klen;
 
   cache->serialize_func = serialize;
@@ -669,17 +802,50 @@ svn_cache__create_inprocess(svn_cache__t **cache_p,
 
   SVN_ERR_ASSERT(pages >= 1);
   cache->total_pages = pages;
-  cache->unallocated_pages = pages;
   SVN_ERR_ASSERT(items_per_page >= 1);
   cache->items_per_page = items_per_page;
 
-  cache->sentinel = apr_pcalloc(pool, sizeof(*(cache->sentinel)));
-  cache->sentinel->prev = cache->sentinel;
-  cache->sentinel->next = cache->sentinel;
-  /* The sentinel doesn't need a pool.  (We're happy to crash if we
-   * accidentally try to treat it like a real page.) */
+  /* Sharding only makes sense for thread-safe caches and every segment
+   * needs at least one page of its own. */
+  if (thread_safe && pages > 1)
+    segment_count = pages < MAX_SEGMENT_COUNT
+                  ? (apr_uint32_t)pages
+                  : MAX_SEGMENT_COUNT;
+  else
+    segment_count = 1;
 
-  SVN_ERR(svn_mutex__init(&cache->mutex, thread_safe, pool));
+  cache->segment_count = segment_count;
+  cache->segments = apr_pcalloc(pool,
+                                segment_count * sizeof(*cache->segments));
+  for (i = 0; i < segment_count; ++i)
+    {
+      struct cache_segment *segment = &cache->segments[i];
+
+      segment->cache = cache;
+      segment->hash = apr_hash_make(pool);
+
+      /* Spread the page quota evenly over all segments. */
+      segment->total_pages = pages / segment_count
+                           + (i < pages % segment_count ? 1 : 0);
+      segment->unallocated_pages = segment->total_pages;
+
+      /* Let the frequently hit pages occupy at most about half of the
+       * segment. */
+      segment->protected_limit = (segment->total_pages + 1) / 2;
+      segment->protected_count = 0;
+
+      segment->sentinel = apr_pcalloc(pool, sizeof(*(segment->sentinel)));
+      segment->sentinel->prev = segment->sentinel;
+      segment->sentinel->next = segment->sentinel;
+      segment->probationary = apr_pcalloc(pool,
+                                          sizeof(*(segment->probationary)));
+      segment->probationary->prev = segment->probationary;
+      segment->probationary->next = segment->probationary;
+      /* The sentinels don't need a pool.  (We're happy to crash if we
+       * accidentally try to treat one like a real page.) */
+
+      SVN_ERR(svn_mutex__init(&segment->mutex, thread_safe, pool));
+    }
 
   cache->cache_pool = pool;
 
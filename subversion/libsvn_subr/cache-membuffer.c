@@ -23,7 +23,10 @@
 
 #include <assert.h>
 #include <apr_md5.h>
+#include <apr_proc_mutex.h>
+#include <apr_shm.h>
 #include <apr_thread_rwlock.h>
+#include <apr_time.h>
 
 #include "svn_pools.h"
 #include "svn_checksum.h"
@@ -35,6 +38,7 @@
 #include "private/svn_atomic.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_mutex.h"
+#include "private/svn_probes_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 
@@ -240,6 +244,47 @@ typedef struct full_key_t
   svn_membuf_t full_key;
 } full_key_t;
 
+/* Shared-memory representation of a prefix pool.  This lives inside the
+ * shm segment of a shared membuffer cache (see
+ * svn_cache__membuffer_cache_create_shared) such that all processes
+ * using the cache assign the same index to the same prefix string.
+ *
+ * The table is append-only.  Prefix strings are stored NUL-terminated in
+ * an arena that immediately follows the OFFSETS array; OFFSETS[i] is the
+ * arena offset of the string with index i.  Since prefix registration is
+ * a rare operation (once per cache instance), lookup is a simple linear
+ * scan under the cross-process mutex.
+ */
+typedef struct shared_prefix_table_t
+{
+  /* Maximum number of entries that OFFSETS may hold. */
+  apr_uint32_t capacity;
+
+  /* Number of used entries in OFFSETS.  Never exceeds CAPACITY. */
+  apr_uint32_t used;
+
+  /* Size of the string arena in bytes. */
+  apr_uint64_t arena_size;
+
+  /* Number of arena bytes in use. */
+  apr_uint64_t arena_used;
+
+  /* CAPACITY entries; the first USED of them are valid.
+   * The string arena starts at &OFFSETS[CAPACITY]. */
+  apr_uint64_t offsets[1];
+} shared_prefix_table_t;
+
+/* Return the total number of bytes needed for a shared_prefix_table_t
+ * with CAPACITY entries and ARENA_SIZE arena bytes.
+ */
+#define SHARED_PREFIX_TABLE_SIZE(capacity, arena_size)      \
+  (APR_OFFSETOF(shared_prefix_table_t, offsets)             \
+   + (capacity) * sizeof(apr_uint64_t) + (arena_size))
+
+/* Return the start of the string arena of TABLE. */
+#define SHARED_PREFIX_ARENA(table) \
+  ((char *)&(table)->offsets[(table)->capacity])
+
 /* A limited capacity, thread-safe pool of unique C strings.  Operations on
  * this data structure are defined by prefix_pool_* functions.  The only
  * "public" member is VALUES (r/o access only).
@@ -269,6 +314,13 @@ typedef struct prefix_pool_t
 
   /* The serialization object. */
   svn_mutex__t *mutex;
+
+  /* In shared caches, the authoritative prefix-to-index mapping inside
+   * the shm segment.  NULL for process-local caches. */
+  shared_prefix_table_t *shared;
+
+  /* Cross-process serialization for SHARED.  NULL iff SHARED is NULL. */
+  apr_proc_mutex_t *proc_mutex;
 } prefix_pool_t;
 
 /* Set *PREFIX_POOL to a new instance that tries to limit allocation to
@@ -314,6 +366,97 @@ prefix_pool_create(prefix_pool_t **prefix_pool,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_SHARED_MEMORY
+
+/* Variant of prefix_pool_create for shared caches:  Set *PREFIX_POOL to
+ * a new instance whose authoritative state is the SHARED table residing
+ * in shared memory.  If INITIALIZE is set, SHARED is raw memory and will
+ * be set up for CAPACITY entries and ARENA_SIZE arena bytes; otherwise,
+ * it is expected to contain a valid table already.  Serialize access
+ * across processes via a new anonymous process mutex.  Allocate the
+ * result from RESULT_POOL. */
+static svn_error_t *
+prefix_pool_create_shared(prefix_pool_t **prefix_pool,
+                          shared_prefix_table_t *shared,
+                          svn_boolean_t initialize,
+                          apr_uint32_t capacity,
+                          apr_uint64_t arena_size,
+                          apr_pool_t *result_pool)
+{
+  apr_status_t status;
+  prefix_pool_t *result = apr_pcalloc(result_pool, sizeof(*result));
+
+  if (initialize)
+    {
+      memset(shared, 0, SHARED_PREFIX_TABLE_SIZE(capacity, 0));
+      shared->capacity = capacity;
+      shared->arena_size = arena_size;
+    }
+
+  /* The per-process VALUES array caches the prefix strings this process
+   * has looked up so far; see prefix_pool_t. */
+  result->values = capacity
+                 ? apr_pcalloc(result_pool, capacity * sizeof(const char *))
+                 : NULL;
+  result->values_max = capacity;
+  result->shared = shared;
+
+  status = apr_proc_mutex_create(&result->proc_mutex, NULL,
+                                 APR_LOCK_DEFAULT, result_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create cache mutex"));
+
+  SVN_ERR(svn_mutex__init(&result->mutex, TRUE, result_pool));
+
+  *prefix_pool = result;
+  return SVN_NO_ERROR;
+}
+
+/* Implement prefix_pool_get_internal for shared prefix pools:  look up
+ * or append PREFIX in PREFIX_POOL->SHARED, which the caller must have
+ * locked against concurrent modification.  Set *PREFIX_IDX to the entry
+ * found / created or to NO_INDEX upon capacity exhaustion. */
+static svn_error_t *
+prefix_pool_get_shared(apr_uint32_t *prefix_idx,
+                       prefix_pool_t *prefix_pool,
+                       const char *prefix)
+{
+  shared_prefix_table_t *table = prefix_pool->shared;
+  char *arena = SHARED_PREFIX_ARENA(table);
+  apr_size_t prefix_len = strlen(prefix);
+  apr_uint32_t i;
+
+  /* Linear scan.  Prefix registration is rare, the table is small. */
+  for (i = 0; i < table->used; ++i)
+    if (strcmp(arena + table->offsets[i], prefix) == 0)
+      {
+        prefix_pool->values[i] = arena + table->offsets[i];
+        *prefix_idx = i;
+        return SVN_NO_ERROR;
+      }
+
+  /* Capacity checks. */
+  if (   table->used == table->capacity
+      || table->arena_size - table->arena_used < prefix_len + 1)
+    {
+      *prefix_idx = NO_INDEX;
+      return SVN_NO_ERROR;
+    }
+
+  /* Append new entry. */
+  memcpy(arena + table->arena_used, prefix, prefix_len + 1);
+  table->offsets[table->used] = table->arena_used;
+  table->arena_used += prefix_len + 1;
+
+  prefix_pool->values[table->used] = arena + table->offsets[table->used];
+  *prefix_idx = table->used;
+  ++table->used;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_SHARED_MEMORY */
+
 /* Set *PREFIX_IDX to the offset in PREFIX_POOL->VALUES that contains the
  * value PREFIX.  If none exists, auto-insert it.  If we can't due to
  * capacity exhaustion, set *PREFIX_IDX to NO_INDEX.
@@ -378,12 +521,45 @@ prefix_pool_get_internal(apr_uint32_t *prefix_idx,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_SHARED_MEMORY
+/* Cross-process locking wrapper around prefix_pool_get_shared. */
+static svn_error_t *
+prefix_pool_get_shared_locked(apr_uint32_t *prefix_idx,
+                              prefix_pool_t *prefix_pool,
+                              const char *prefix)
+{
+  svn_error_t *err;
+  apr_status_t status = apr_proc_mutex_lock(prefix_pool->proc_mutex);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't lock cache mutex"));
+
+  err = prefix_pool_get_shared(prefix_idx, prefix_pool, prefix);
+
+  status = apr_proc_mutex_unlock(prefix_pool->proc_mutex);
+  if (status && !err)
+    err = svn_error_wrap_apr(status, _("Can't unlock cache mutex"));
+
+  return svn_error_trace(err);
+}
+#endif
+
 /* Thread-safe wrapper around prefix_pool_get_internal. */
 static svn_error_t *
 prefix_pool_get(apr_uint32_t *prefix_idx,
                 prefix_pool_t *prefix_pool,
                 const char *prefix)
 {
+#if APR_HAS_SHARED_MEMORY
+  if (prefix_pool->shared)
+    {
+      SVN_MUTEX__WITH_LOCK(prefix_pool->mutex,
+                           prefix_pool_get_shared_locked(prefix_idx,
+                                                         prefix_pool,
+                                                         prefix));
+      return SVN_NO_ERROR;
+    }
+#endif
+
   SVN_MUTEX__WITH_LOCK(prefix_pool->mutex,
                        prefix_pool_get_internal(prefix_idx, prefix_pool,
                                                 prefix));
@@ -589,6 +765,12 @@ typedef struct entry_t
    * priority items.
    */
   apr_uint32_t priority;
+
+  /* Time this entry's data was written, as seconds since the epoch
+   * truncated to 32 bits.  Used to determine the entry's age when it
+   * gets removed.  Only valid for used entries.
+   */
+  apr_uint32_t insert_time;
 #ifdef SVN_DEBUG_CACHE_MEMBUFFER
   /* Remember type, content and key hashes.
    */
@@ -692,6 +874,36 @@ typedef struct cache_level_t
 
 } cache_level_t;
 
+/* Number of key prefixes that each segment keeps detailed usage
+ * statistics for.  Prefixes with an index beyond this limit - as well as
+ * overlong prefixes, which don't get an index at all - are not tracked
+ * individually.
+ */
+#define TRACKED_PREFIXES 64
+
+/* Detailed usage statistics for a single key prefix, i.e. for a single
+ * cache front-end.  Updated under the segment's write lock.  See
+ * svn_cache__info_t for the bucketing used by the histograms.
+ */
+typedef struct prefix_stats_t
+{
+  /* Number of used entries with the respective prefix. */
+  apr_uint64_t entry_count;
+
+  /* Number of data bytes used by those entries. */
+  apr_uint64_t used_size;
+
+  /* Number of entries with that prefix removed so far, be it evicted to
+   * make room for other data or dropped explicitly. */
+  apr_uint64_t evictions;
+
+  /* log2 histogram of entry ages, in seconds, at removal time. */
+  apr_uint64_t age_histogram[16];
+
+  /* log2 histogram of serialized item sizes at insertion time. */
+  apr_uint64_t size_histogram[32];
+} prefix_stats_t;
+
 /* The cache header structure.
  */
 struct svn_membuffer_t
@@ -796,6 +1008,12 @@ struct svn_membuffer_t
    */
   apr_uint64_t total_hits;
 
+  /* Detailed usage statistics for the first TRACKED_PREFIXES key
+   * prefixes registered with PREFIX_POOL.  Elements for prefixes that
+   * have not been registered, yet, are all zero.
+   */
+  prefix_stats_t prefix_stats[TRACKED_PREFIXES];
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   /* A lock for intra-process synchronization to the cache, or NULL if
    * the cache's creator doesn't feel the cache needs to be
@@ -813,6 +1031,14 @@ struct svn_membuffer_t
   svn_boolean_t allow_blocking_writes;
 #endif
 
+  /* Cross-process lock for shared caches, or NULL for process-local ones.
+   * When set, it is acquired in addition to (and after) the intra-process
+   * LOCK above; cross-process access is always exclusive, i.e. there is
+   * no read concurrency between processes.  Note that in shared caches,
+   * this structure lives in the shm segment while the lock objects remain
+   * per-process copies inherited via fork(). */
+  apr_proc_mutex_t *proc_lock;
+
   /* A write lock counter, must be either 0 or 1.
    * This one is only used in debug assertions to verify that you used
    * the correct multi-threading settings. */
@@ -823,13 +1049,45 @@ struct svn_membuffer_t
  */
 #define ALIGN_VALUE(value) (((value) + ITEM_ALIGNMENT-1) & -ITEM_ALIGNMENT)
 
+/* Acquire CACHE's cross-process lock, if it has one.
+ * Must be called after the intra-process lock has been taken.
+ */
+static svn_error_t *
+proc_lock_cache(svn_membuffer_t *cache)
+{
+  if (cache->proc_lock)
+    {
+      apr_status_t status = apr_proc_mutex_lock(cache->proc_lock);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't lock cache mutex"));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Release CACHE's cross-process lock, if it has one.  Chain ERR.
+ * Must be called before the intra-process lock gets released.
+ */
+static svn_error_t *
+proc_unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
+{
+  if (cache->proc_lock)
+    {
+      apr_status_t status = apr_proc_mutex_unlock(cache->proc_lock);
+      if (status && !err)
+        err = svn_error_wrap_apr(status, _("Can't unlock cache mutex"));
+    }
+
+  return err;
+}
+
 /* If locking is supported for CACHE, acquire a read lock for it.
  */
 static svn_error_t *
 read_lock_cache(svn_membuffer_t *cache)
 {
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
-  return svn_mutex__lock(cache->lock);
+  SVN_ERR(svn_mutex__lock(cache->lock));
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
   if (cache->lock)
   {
@@ -837,11 +1095,9 @@ read_lock_cache(svn_membuffer_t *cache)
     if (status)
       return svn_error_wrap_apr(status, _("Can't lock cache mutex"));
   }
-
-  return SVN_NO_ERROR;
-#else
-  return SVN_NO_ERROR;
 #endif
+
+  return proc_lock_cache(cache);
 }
 
 /* If locking is supported for CACHE, acquire a write lock for it.
@@ -852,7 +1108,7 @@ static svn_error_t *
 write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 {
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
-  return svn_mutex__lock(cache->lock);
+  SVN_ERR(svn_mutex__lock(cache->lock));
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
   if (cache->lock)
     {
@@ -874,12 +1130,15 @@ write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
       if (status)
         return svn_error_wrap_apr(status,
                                   _("Can't write-lock cache mutex"));
-    }
 
-  return SVN_NO_ERROR;
-#else
-  return SVN_NO_ERROR;
+      /* The try-lock attempt failed, i.e. we don't hold the lock at all
+       * and must not attempt to grab the cross-process lock either. */
+      if (!*success)
+        return SVN_NO_ERROR;
+    }
 #endif
+
+  return proc_lock_cache(cache);
 }
 
 /* If locking is supported for CACHE, acquire an unconditional write lock
@@ -889,17 +1148,15 @@ static svn_error_t *
 force_write_lock_cache(svn_membuffer_t *cache)
 {
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
-  return svn_mutex__lock(cache->lock);
+  SVN_ERR(svn_mutex__lock(cache->lock));
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
   apr_status_t status = apr_thread_rwlock_wrlock(cache->lock);
   if (status)
     return svn_error_wrap_apr(status,
                               _("Can't write-lock cache mutex"));
-
-  return SVN_NO_ERROR;
-#else
-  return SVN_NO_ERROR;
 #endif
+
+  return proc_lock_cache(cache);
 }
 
 /* If locking is supported for CACHE, release the current lock
@@ -908,6 +1165,9 @@ force_write_lock_cache(svn_membuffer_t *cache)
 static svn_error_t *
 unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 {
+  /* Release in reverse lock order: cross-process lock first. */
+  err = proc_unlock_cache(cache, err);
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__unlock(cache->lock, err);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -1199,6 +1459,34 @@ unchain_entry(svn_membuffer_t *cache,
     get_entry(cache, entry->next)->previous = entry->previous;
 }
 
+/* Return the index of the log2 histogram bucket that VALUE falls into,
+ * for a histogram of COUNT buckets.  Values beyond the histogram range
+ * saturate into the last bucket.
+ */
+static apr_size_t
+histogram_index(apr_uint64_t value, apr_size_t count)
+{
+  apr_size_t i = 0;
+
+  while (i + 1 < count && value >= ((apr_uint64_t)1 << i))
+    ++i;
+
+  return i;
+}
+
+/* Return the statistics element in CACHE that covers ENTRY's key prefix,
+ * or NULL if that prefix is not being tracked.
+ */
+static prefix_stats_t *
+get_prefix_stats(svn_membuffer_t *cache, const entry_t *entry)
+{
+  apr_uint32_t prefix_idx = entry->key.prefix_idx;
+
+  return prefix_idx == NO_INDEX || prefix_idx >= TRACKED_PREFIXES
+       ? NULL
+       : &cache->prefix_stats[prefix_idx];
+}
+
 /* Remove the used ENTRY from the CACHE, i.e. make it "unused".
  * In contrast to insertion, removal is possible for any entry.
  */
@@ -1216,12 +1504,28 @@ drop_entry(svn_membuffer_t *cache, entry_t *entry)
     + last_group->header.used - 1);
 
   cache_level_t *level = get_cache_level(cache, entry);
+  prefix_stats_t *stats = get_prefix_stats(cache, entry);
 
   /* update global cache usage counters
    */
   cache->used_entries--;
   cache->data_used -= entry->size;
 
+  /* attribute the removal to the entry's key prefix
+   */
+  if (stats)
+    {
+      apr_uint32_t age
+        = (apr_uint32_t)apr_time_sec(apr_time_now()) - entry->insert_time;
+
+      stats->entry_count--;
+      stats->used_size -= entry->size;
+      stats->evictions++;
+      stats->age_histogram[histogram_index(age,
+                                  sizeof(stats->age_histogram)
+                                  / sizeof(stats->age_histogram[0]))]++;
+    }
+
   /* extend the insertion window, if the entry happens to border it
    */
   if (idx == level->next)
@@ -1302,6 +1606,7 @@ insert_entry(svn_membuffer_t *cache, entry_t *entry)
   apr_uint32_t group_index = idx / GROUP_SIZE;
   entry_group_t *group = &cache->directory[group_index];
   cache_level_t *level = get_cache_level(cache, entry);
+  prefix_stats_t *stats = get_prefix_stats(cache, entry);
 
   /* The entry must start at the beginning of the insertion window.
    * It must also be the first unused entry in the group.
@@ -1315,8 +1620,20 @@ insert_entry(svn_membuffer_t *cache, entry_t *entry)
   cache->used_entries++;
   cache->data_used += entry->size;
   entry->hit_count = 0;
+  entry->insert_time = (apr_uint32_t)apr_time_sec(apr_time_now());
   group->header.used++;
 
+  /* attribute the insertion to the entry's key prefix
+   */
+  if (stats)
+    {
+      stats->entry_count++;
+      stats->used_size += entry->size;
+      stats->size_histogram[histogram_index(entry->size,
+                                  sizeof(stats->size_histogram)
+                                  / sizeof(stats->size_histogram[0]))]++;
+    }
+
   /* update entry chain
    */
   chain_entry(cache, level, entry, idx);
@@ -1704,6 +2021,18 @@ ensure_data_insertable_l2(svn_membuffer_t *cache,
           svn_boolean_t keep;
           entry = get_entry(cache, cache->l2.next);
 
+          if (   entry->priority >= SVN_CACHE__MEMBUFFER_PINNED_PRIORITY
+              && entry->priority > to_fit_in->priority)
+            {
+              /* Pinned metadata must survive bulk traffic.  Keep it, and
+               * don't charge the move against the incoming entry either:
+               * streaming data shall still find room elsewhere even if it
+               * keeps shifting the pinned set around.
+               */
+              move_entry(cache, entry);
+              continue;
+            }
+
           if (to_fit_in->priority < SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY)
             {
               /* Low prio items can only be accepted only if the current
@@ -1832,17 +2161,50 @@ ensure_data_insertable_l1(svn_membuffer_t *cache, apr_size_t size)
    * right answer. */
 }
 
-svn_error_t *
-svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
-                                  apr_size_t total_size,
-                                  apr_size_t directory_size,
-                                  apr_size_t segment_count,
-                                  svn_boolean_t thread_safe,
-                                  svn_boolean_t allow_blocking_writes,
-                                  apr_pool_t *pool)
+/* Allocate SIZE bytes for a cache sub-structure:  if *SHM_CURSOR is not
+ * NULL, carve them from the shared memory segment it points into and
+ * advance the cursor; allocate them from POOL otherwise.
+ */
+static void *
+membuffer_alloc(char **shm_cursor,
+                apr_size_t size,
+                apr_pool_t *pool)
+{
+  void *result;
+
+  if (*shm_cursor)
+    {
+      result = *shm_cursor;
+      *shm_cursor += ALIGN_VALUE(size);
+    }
+  else
+    {
+      result = apr_palloc(pool, size);
+    }
+
+  return result;
+}
+
+/* Implementation of svn_cache__membuffer_cache_create and its _shared
+ * variant.  If SHARED is set, place all cache state into a single
+ * anonymous shared memory segment such that processes forked after this
+ * call operate on one common cache, and serialize cross-process access
+ * via process mutexes.
+ */
+static svn_error_t *
+membuffer_cache_create_internal(svn_membuffer_t **cache,
+                                apr_size_t total_size,
+                                apr_size_t directory_size,
+                                apr_size_t segment_count,
+                                svn_boolean_t thread_safe,
+                                svn_boolean_t allow_blocking_writes,
+                                svn_boolean_t shared,
+                                apr_pool_t *pool)
 {
   svn_membuffer_t *c;
-  prefix_pool_t *prefix_pool;
+  prefix_pool_t *prefix_pool = NULL;
+  apr_size_t prefix_bytes;
+  char *shm_cursor = NULL;
 
   apr_uint32_t seg;
   apr_uint32_t group_count;
@@ -1854,9 +2216,8 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
 
   /* Allocate 1% of the cache capacity to the prefix string pool.
    */
-  SVN_ERR(prefix_pool_create(&prefix_pool, total_size / 100, thread_safe,
-                             pool));
-  total_size -= total_size / 100;
+  prefix_bytes = total_size / 100;
+  total_size -= prefix_bytes;
 
   /* Limit the total size (only relevant if we can address > 4GB)
    */
@@ -1910,9 +2271,6 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
          && segment_count < MAX_SEGMENT_COUNT)
     segment_count *= 2;
 
-  /* allocate cache as an array of segments / cache objects */
-  c = apr_palloc(pool, segment_count * sizeof(*c));
-
   /* Split total cache size into segments of equal size
    */
   total_size /= segment_count;
@@ -1963,8 +2321,86 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   assert(spare_group_count > 0 && main_group_count > 0);
 
   group_init_size = 1 + group_count / (8 * GROUP_INIT_GRANULARITY);
+
+  /* Allocate the cache as an array of segments / cache objects - either
+   * from POOL or, for shared caches, from the front of a single anonymous
+   * shared memory segment that also holds all sub-structures.
+   */
+  if (shared)
+    {
+#if APR_HAS_SHARED_MEMORY
+      apr_status_t status;
+      apr_shm_t *shm;
+      shared_prefix_table_t *prefix_table;
+
+      /* Use the same per-entry estimate as prefix_pool_create() does. */
+      apr_uint32_t prefix_capacity
+        = (apr_uint32_t)MIN(APR_UINT32_MAX, prefix_bytes / 120);
+      apr_size_t prefix_table_size
+        = SHARED_PREFIX_TABLE_SIZE(prefix_capacity, prefix_bytes);
+
+      apr_size_t shm_size
+        = ALIGN_VALUE(segment_count * sizeof(*c))
+        + ALIGN_VALUE(prefix_table_size)
+        + segment_count * (  ALIGN_VALUE(group_count
+                                         * sizeof(entry_group_t))
+                           + ALIGN_VALUE(group_init_size)
+                           + (apr_size_t)ALIGN_VALUE(data_size));
+
+      status = apr_shm_create(&shm, shm_size, NULL, pool);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't create shared cache memory"));
+
+      shm_cursor = apr_shm_baseaddr_get(shm);
+
+      c = (svn_membuffer_t *)shm_cursor;
+      shm_cursor += ALIGN_VALUE(segment_count * sizeof(*c));
+
+      prefix_table = (shared_prefix_table_t *)shm_cursor;
+      shm_cursor += ALIGN_VALUE(prefix_table_size);
+
+      SVN_ERR(prefix_pool_create_shared(&prefix_pool, prefix_table, TRUE,
+                                        prefix_capacity, prefix_bytes,
+                                        pool));
+#else
+      return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                              _("Shared memory caches are not supported "
+                                "on this platform"));
+#endif
+    }
+  else
+    {
+      c = apr_palloc(pool, segment_count * sizeof(*c));
+      SVN_ERR(prefix_pool_create(&prefix_pool, prefix_bytes, thread_safe,
+                                 pool));
+    }
+
   for (seg = 0; seg < segment_count; ++seg)
     {
+      apr_pool_t *seg_pool = pool;
+
+      /* For process-local multi-segment caches, back each segment with
+       * its own allocator instead of carving all segments out of POOL's
+       * single arena.  That way, each segment is a distinct set of OS
+       * mappings and - since the directory is not zeroed here and the
+       * data buffer is only written on insertion - most of its pages
+       * remain untouched until a worker thread actually uses the
+       * segment.  On NUMA systems with a first-touch policy, this places
+       * each segment's memory on the node of the threads accessing it,
+       * rather than on the node that happened to create the cache.
+       */
+      if (!shared && segment_count > 1)
+        {
+          apr_allocator_t *allocator = NULL;
+          if (apr_allocator_create(&allocator))
+            return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
+          apr_allocator_max_free_set(allocator, 1);
+          apr_pool_create_ex(&seg_pool, pool, NULL, allocator);
+          apr_allocator_owner_set(allocator, seg_pool);
+        }
+
       /* allocate buffers and initialize cache members
        */
       c[seg].segment_count = (apr_uint32_t)segment_count;
@@ -1978,12 +2414,16 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       /* Allocate but don't clear / zero the directory because it would add
          significantly to the server start-up time if the caches are large.
          Group initialization will take care of that in stead. */
-      c[seg].directory = apr_palloc(pool,
-                                    group_count * sizeof(entry_group_t));
+      c[seg].directory = membuffer_alloc(&shm_cursor,
+                                         group_count
+                                           * sizeof(entry_group_t),
+                                         seg_pool);
 
       /* Allocate and initialize directory entries as "not initialized",
          hence "unused" */
-      c[seg].group_initialized = apr_pcalloc(pool, group_init_size);
+      c[seg].group_initialized = membuffer_alloc(&shm_cursor,
+                                                 group_init_size, seg_pool);
+      memset(c[seg].group_initialized, 0, group_init_size);
 
       /* Allocate 1/4th of the data buffer to L1
        */
@@ -2004,7 +2444,9 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       c[seg].l2.current_data = c[seg].l2.start_offset;
 
       /* This cast is safe because DATA_SIZE <= MAX_SEGMENT_SIZE. */
-      c[seg].data = apr_palloc(pool, (apr_size_t)ALIGN_VALUE(data_size));
+      c[seg].data = membuffer_alloc(&shm_cursor,
+                                    (apr_size_t)ALIGN_VALUE(data_size),
+                                    seg_pool);
       c[seg].data_used = 0;
       c[seg].max_entry_size = max_entry_size;
 
@@ -2012,6 +2454,7 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       c[seg].total_reads = 0;
       c[seg].total_writes = 0;
       c[seg].total_hits = 0;
+      memset(c[seg].prefix_stats, 0, sizeof(c[seg].prefix_stats));
 
       /* were allocations successful?
        * If not, initialize a minimal cache structure.
@@ -2044,6 +2487,23 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
        */
       c[seg].allow_blocking_writes = allow_blocking_writes;
 #endif
+
+      /* Cross-process lock for shared caches.  The mutex objects get
+       * inherited by forked child processes; the pointer stored in the
+       * shm segment is valid in all of them because the mappings are
+       * inherited at the same address. */
+      c[seg].proc_lock = NULL;
+      if (shared)
+        {
+          apr_status_t status = apr_proc_mutex_create(&c[seg].proc_lock,
+                                                      NULL,
+                                                      APR_LOCK_DEFAULT,
+                                                      pool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create cache mutex"));
+        }
+
       /* No writers at the moment. */
       c[seg].write_lock_count = 0;
     }
@@ -2054,6 +2514,37 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
+                                  apr_size_t total_size,
+                                  apr_size_t directory_size,
+                                  apr_size_t segment_count,
+                                  svn_boolean_t thread_safe,
+                                  svn_boolean_t allow_blocking_writes,
+                                  apr_pool_t *pool)
+{
+  return svn_error_trace(membuffer_cache_create_internal(
+                             cache, total_size, directory_size,
+                             segment_count, thread_safe,
+                             allow_blocking_writes, FALSE, pool));
+}
+
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         svn_boolean_t allow_blocking_writes,
+                                         apr_pool_t *pool)
+{
+  /* Fork-based sharing implies that multiple threads may use the cache,
+   * so the intra-process locks are always required. */
+  return svn_error_trace(membuffer_cache_create_internal(
+                             cache, total_size, directory_size,
+                             segment_count, TRUE,
+                             allow_blocking_writes, TRUE, pool));
+}
+
 svn_error_t *
 svn_cache__membuffer_clear(svn_membuffer_t *cache)
 {
@@ -2223,13 +2714,24 @@ membuffer_cache_set_internal(svn_membuffer_t *cache,
    * the old spot, just re-use that space. */
   if (entry && buffer && ALIGN_VALUE(entry->size) >= size)
     {
+      prefix_stats_t *stats = get_prefix_stats(cache, entry);
+
       /* Careful! We need to cast SIZE to the full width of CACHE->DATA_USED
        * lest we run into trouble with 32 bit underflow *not* treated as a
        * negative value.
        */
       cache->data_used += (apr_uint64_t)size - entry->size;
+      if (stats)
+        {
+          stats->used_size += (apr_uint64_t)size - entry->size;
+          stats->size_histogram[histogram_index(size,
+                                  sizeof(stats->size_histogram)
+                                  / sizeof(stats->size_histogram[0]))]++;
+        }
+
       entry->size = size;
       entry->priority = priority;
+      entry->insert_time = (apr_uint32_t)apr_time_sec(apr_time_now());
 
 #ifdef SVN_DEBUG_CACHE_MEMBUFFER
 
@@ -2341,6 +2843,8 @@ membuffer_cache_set(svn_membuffer_t *cache,
   if (item)
     SVN_ERR(serializer(&buffer, &size, item, scratch_pool));
 
+  SVN_PROBE2(membuffer__set, key->entry_key.prefix_idx, size);
+
   /* The actual cache data access needs to sync'ed
    */
   WITH_WRITE_LOCK(cache,
@@ -2462,6 +2966,9 @@ membuffer_cache_get(svn_membuffer_t *cache,
                                               DEBUG_CACHE_MEMBUFFER_TAG
                                               result_pool));
 
+  SVN_PROBE3(membuffer__get, key->entry_key.prefix_idx, buffer != NULL,
+             size);
+
   /* re-construct the original data object from its serialized form.
    */
   if (buffer == NULL)
@@ -3147,6 +3654,34 @@ svn_membuffer_get_segment_info(svn_membuffer_t *segment,
   return SVN_NO_ERROR;
 }
 
+/* Add the statistics that SEGMENT keeps for the key prefix with index
+ * PREFIX_IDX to INFO.  PREFIX_IDX must be lower than TRACKED_PREFIXES.
+ */
+static svn_error_t *
+svn_membuffer_get_prefix_info(svn_membuffer_t *segment,
+                              apr_uint32_t prefix_idx,
+                              svn_cache__info_t *info)
+{
+  const prefix_stats_t *stats = &segment->prefix_stats[prefix_idx];
+  apr_size_t i;
+
+  info->prefix_entries += stats->entry_count;
+  info->prefix_size += stats->used_size;
+  info->evictions += stats->evictions;
+
+  for (i = 0;
+       i < sizeof(stats->age_histogram) / sizeof(stats->age_histogram[0]);
+       ++i)
+    info->age_histogram[i] += stats->age_histogram[i];
+
+  for (i = 0;
+       i < sizeof(stats->size_histogram) / sizeof(stats->size_histogram[0]);
+       ++i)
+    info->size_histogram[i] += stats->size_histogram[i];
+
+  return SVN_NO_ERROR;
+}
+
 /* Implement svn_cache__vtable_t.get_info
  * (thread-safe even without mutex)
  */
@@ -3170,6 +3705,14 @@ svn_membuffer_cache_get_info(void *cache_void,
       svn_membuffer_t *segment = cache->membuffer + i;
       WITH_READ_LOCK(segment,
                      svn_membuffer_get_segment_info(segment, info, FALSE));
+
+      /* add the per-prefix details, if our prefix is being tracked */
+      if (   cache->prefix.prefix_idx != NO_INDEX
+          && cache->prefix.prefix_idx < TRACKED_PREFIXES)
+        WITH_READ_LOCK(segment,
+                       svn_membuffer_get_prefix_info(segment,
+                                                     cache->prefix.prefix_idx,
+                                                     info));
     }
 
   return SVN_NO_ERROR;
@@ -3180,6 +3723,7 @@ svn_membuffer_cache_get_info(void *cache_void,
  */
 static svn_cache__vtable_t membuffer_cache_vtable = {
   svn_membuffer_cache_get,
+  NULL,                     /* no batched getter */
   svn_membuffer_cache_has_key,
   svn_membuffer_cache_set,
   svn_membuffer_cache_iter,
@@ -3293,6 +3837,7 @@ svn_membuffer_cache_set_partial_synced(void *cache_void,
  */
 static svn_cache__vtable_t membuffer_cache_synced_vtable = {
   svn_membuffer_cache_get_synced,
+  NULL,                                   /* no batched getter */
   svn_membuffer_cache_has_key_synced,
   svn_membuffer_cache_set_synced,
   svn_membuffer_cache_iter,               /* no sync required */
@@ -214,6 +214,86 @@ memcache_get(void **value_p,
   return SVN_NO_ERROR;
 }
 
+/* Implement vtable.get_multi.  Fetch all keys with a single pipelined
+ * multi-get request instead of one synchronous round trip per key, so
+ * the per-request network latency is paid only once for the whole batch.
+ */
+static svn_error_t *
+memcache_get_multi(void **values,
+                   svn_boolean_t *found,
+                   void *cache_void,
+                   const void **keys,
+                   apr_size_t count,
+                   apr_pool_t *result_pool)
+{
+  memcache_t *cache = cache_void;
+  apr_hash_t *mc_values = NULL;
+  const char **mc_keys;
+  apr_status_t apr_err;
+  apr_size_t i;
+  apr_pool_t *subpool = svn_pool_create(result_pool);
+
+  /* Build the protocol-level keys and register them for the multi-get.
+   * The fetched data is allocated in RESULT_POOL because the values we
+   * return below reference it, just like in memcache_internal_get(). */
+  mc_keys = apr_palloc(subpool, count * sizeof(*mc_keys));
+  for (i = 0; i < count; ++i)
+    if (keys[i])
+      {
+        SVN_ERR(build_key(&mc_keys[i], cache, keys[i], result_pool));
+        apr_memcache_add_multget_key(result_pool, mc_keys[i], &mc_values);
+      }
+    else
+      mc_keys[i] = NULL;
+
+  /* All keys may have been NULL. */
+  if (mc_values == NULL)
+    {
+      svn_pool_destroy(subpool);
+      return SVN_NO_ERROR;
+    }
+
+  apr_err = apr_memcache_multgetp(cache->memcache, subpool, result_pool,
+                                  mc_values);
+  if (apr_err != APR_SUCCESS)
+    return svn_error_wrap_apr(apr_err,
+                              _("Unknown memcached error while reading"));
+
+  /* De-serialize whatever came back; keys that the servers did not
+   * return simply remain "not found". */
+  for (i = 0; i < count; ++i)
+    {
+      apr_memcache_value_t *mc_value;
+
+      if (mc_keys[i] == NULL)
+        continue;
+
+      mc_value = apr_hash_get(mc_values, mc_keys[i], APR_HASH_KEY_STRING);
+      if (mc_value == NULL || mc_value->status != APR_SUCCESS
+          || mc_value->data == NULL)
+        continue;
+
+      if (cache->deserialize_func)
+        {
+          SVN_ERR((cache->deserialize_func)(&values[i], mc_value->data,
+                                            mc_value->len, result_pool));
+        }
+      else
+        {
+          svn_stringbuf_t *value = svn_stringbuf_create_empty(result_pool);
+          value->data = mc_value->data;
+          value->blocksize = mc_value->len;
+          value->len = mc_value->len - 1; /* account for trailing NUL */
+          values[i] = value;
+        }
+
+      found[i] = TRUE;
+    }
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
 /* Implement vtable.has_key in terms of the getter.
  */
 static svn_error_t *
@@ -392,6 +472,7 @@ memcache_get_info(void *cache_void,
 
 static svn_cache__vtable_t memcache_vtable = {
   memcache_get,
+  memcache_get_multi,
   memcache_has_key,
   memcache_set,
   memcache_iter,
@@ -132,6 +132,7 @@ null_cache_get_info(void *cache_void,
 
 static svn_cache__vtable_t null_cache_vtable = {
   null_cache_get,
+  NULL,                     /* no batched getter */
   null_cache_has_key,
   null_cache_set,
   null_cache_iter,
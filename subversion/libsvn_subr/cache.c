@@ -95,6 +95,60 @@ svn_cache__get(void **value_p,
   return err;
 }
 
+svn_error_t *
+svn_cache__get_multi(void **values,
+                     svn_boolean_t *found,
+                     svn_cache__t *cache,
+                     const void **keys,
+                     apr_size_t count,
+                     apr_pool_t *result_pool)
+{
+  apr_size_t i;
+
+  /* In case any errors happen and are quelched, make sure we start
+     out with all FOUND flags set to false. */
+  for (i = 0; i < count; ++i)
+    {
+      values[i] = NULL;
+      found[i] = FALSE;
+    }
+#ifdef SVN_DEBUG
+  if (cache->pretend_empty)
+    return SVN_NO_ERROR;
+#endif
+
+  cache->reads += count;
+  if (cache->vtable->get_multi)
+    {
+      SVN_ERR(handle_error(cache,
+                           (cache->vtable->get_multi)(values,
+                                                      found,
+                                                      cache->cache_internal,
+                                                      keys,
+                                                      count,
+                                                      result_pool),
+                           result_pool));
+    }
+  else
+    {
+      /* Fall back to fetching the keys one by one. */
+      for (i = 0; i < count; ++i)
+        SVN_ERR(handle_error(cache,
+                             (cache->vtable->get)(&values[i],
+                                                  &found[i],
+                                                  cache->cache_internal,
+                                                  keys[i],
+                                                  result_pool),
+                             result_pool));
+    }
+
+  for (i = 0; i < count; ++i)
+    if (found[i])
+      cache->hits++;
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_cache__has_key(svn_boolean_t *found,
                    svn_cache__t *cache,
@@ -258,6 +312,7 @@ svn_cache__format_info(const svn_cache__info_t *info,
                  / (double)(info->total_entries ? info->total_entries : 1);
 
   const char *histogram = "";
+  const char *prefix_stats = "";
   if (!access_only)
     {
       svn_stringbuf_t *text = svn_stringbuf_create_empty(result_pool);
@@ -277,6 +332,47 @@ svn_cache__format_info(const svn_cache__info_t *info,
       histogram = text->data;
     }
 
+  if (!access_only && (info->prefix_entries || info->evictions))
+    {
+      svn_stringbuf_t *text;
+
+      int i;
+      int count;
+
+      text = svn_stringbuf_createf(result_pool,
+                                   "entries : %" APR_UINT64_T_FMT
+                                   " of this cache"
+                                   ", %" APR_UINT64_T_FMT " MB"
+                                   ", %" APR_UINT64_T_FMT " evicted\n",
+                                   info->prefix_entries,
+                                   info->prefix_size / _1MB,
+                                   info->evictions);
+
+      count = sizeof(info->age_histogram)
+            / sizeof(info->age_histogram[0]);
+      for (i = count - 1; i >= 0; --i)
+        if (info->age_histogram[i] > 0)
+          text = svn_stringbuf_createf(result_pool,
+                                       "%s%12" APR_UINT64_T_FMT
+                                       " evicted aged < %" APR_UINT64_T_FMT
+                                       " s\n",
+                                       text->data, info->age_histogram[i],
+                                       (apr_uint64_t)1 << i);
+
+      count = sizeof(info->size_histogram)
+            / sizeof(info->size_histogram[0]);
+      for (i = count - 1; i >= 0; --i)
+        if (info->size_histogram[i] > 0)
+          text = svn_stringbuf_createf(result_pool,
+                                       "%s%12" APR_UINT64_T_FMT
+                                       " inserted sized < %" APR_UINT64_T_FMT
+                                       " B\n",
+                                       text->data, info->size_histogram[i],
+                                       (apr_uint64_t)1 << i);
+
+      prefix_stats = text->data;
+    }
+
   return access_only
        ? svn_string_createf(result_pool,
                             "%s\n"
@@ -300,7 +396,7 @@ svn_cache__format_info(const svn_cache__info_t *info,
                             " of %" APR_UINT64_T_FMT " MB data cache"
                             " / %" APR_UINT64_T_FMT " MB total cache memory\n"
                             "          %" APR_UINT64_T_FMT " entries (%5.2f%%)"
-                            " of %" APR_UINT64_T_FMT " total\n%s",
+                            " of %" APR_UINT64_T_FMT " total\n%s%s",
 
                             info->id,
 
@@ -315,5 +411,6 @@ svn_cache__format_info(const svn_cache__info_t *info,
 
                             info->used_entries, data_entry_rate,
                             info->total_entries,
-                            histogram);
+                            histogram,
+                            prefix_stats);
 }
@@ -38,6 +38,15 @@ typedef struct svn_cache__vtable_t {
                       const void *key,
                       apr_pool_t *result_pool);
 
+  /* See svn_cache__get_multi().  NULL for implementations without a
+     batched getter; the front-end falls back to individual get() calls. */
+  svn_error_t *(*get_multi)(void **values,
+                            svn_boolean_t *found,
+                            void *cache_implementation,
+                            const void **keys,
+                            apr_size_t count,
+                            apr_pool_t *result_pool);
+
   /* See svn_cache__has_key(). */
   svn_error_t *(*has_key)(svn_boolean_t *found,
                           void *cache_implementation,
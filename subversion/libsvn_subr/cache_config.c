@@ -64,6 +64,17 @@ static svn_cache_config_t cache_settings =
 #endif
 };
 
+/* Whether the global membuffer cache shall be allocated in shared memory.
+ * Must be set before the cache singleton gets created; see
+ * svn_cache__set_global_membuffer_shared(). */
+static svn_boolean_t use_shared_membuffer = FALSE;
+
+/* Number of segments (and hence locks) to use for the global membuffer
+ * cache.  0 means "derive from the cache size".  Must be set before the
+ * cache singleton gets created; see
+ * svn_cache__set_global_membuffer_segments(). */
+static apr_size_t membuffer_segment_count = 0;
+
 /* Get the current FSFS cache configuration. */
 const svn_cache_config_t *
 svn_cache_config_get(void)
@@ -71,6 +82,18 @@ svn_cache_config_get(void)
   return &cache_settings;
 }
 
+void
+svn_cache__set_global_membuffer_shared(svn_boolean_t shared)
+{
+  use_shared_membuffer = shared;
+}
+
+void
+svn_cache__set_global_membuffer_segments(apr_size_t segment_count)
+{
+  membuffer_segment_count = segment_count;
+}
+
 /* Initializer function as required by svn_atomic__init_once.  Allocate
  * the process-global (singleton) membuffer cache and return it in the
  * svn_membuffer_t * in *BATON.  UNUSED_POOL is unused and should be NULL.
@@ -120,14 +143,36 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
         return SVN_NO_ERROR;
       apr_allocator_owner_set(allocator, pool);
 
-      err = svn_cache__membuffer_cache_create(
-          &cache,
-          (apr_size_t)cache_size,
-          (apr_size_t)(cache_size / 5),
-          0,
-          ! svn_cache_config_get()->single_threaded,
-          FALSE,
-          pool);
+      /* Create the cache in shared memory, if so requested.  Failure to
+       * do so (e.g. platform support, shmem limits) is not fatal; simply
+       * fall back to the process-local cache. */
+      err = SVN_NO_ERROR;
+      if (use_shared_membuffer)
+        {
+          err = svn_cache__membuffer_cache_create_shared(
+              &cache,
+              (apr_size_t)cache_size,
+              (apr_size_t)(cache_size / 5),
+              membuffer_segment_count,
+              FALSE,
+              pool);
+          if (err)
+            {
+              svn_error_clear(err);
+              err = SVN_NO_ERROR;
+              cache = NULL;
+            }
+        }
+
+      if (cache == NULL)
+        err = svn_cache__membuffer_cache_create(
+            &cache,
+            (apr_size_t)cache_size,
+            (apr_size_t)(cache_size / 5),
+            membuffer_segment_count,
+            ! svn_cache_config_get()->single_threaded,
+            FALSE,
+            pool);
 
       /* Some error occurred. Most likely it's an OOM error but we don't
        * really care. Simply release all cache memory and disable caching
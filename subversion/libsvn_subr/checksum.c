@@ -27,6 +27,7 @@
 
 #include <apr_md5.h>
 #include <apr_sha1.h>
+#include <apr_thread_proc.h>
 
 #include "svn_checksum.h"
 #include "svn_error.h"
@@ -36,6 +37,9 @@
 #include "checksum.h"
 #include "fnv1a.h"
 
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_cond.h"
 #include "private/svn_subr_private.h"
 
 #include "svn_private_config.h"
@@ -478,6 +482,15 @@ svn_checksum(svn_checksum_t **checksum,
   apr_sha1_ctx_t sha1_ctx;
 
   SVN_ERR(validate_kind(kind));
+
+  /* Empty representations are common enough that skipping the digest
+   * machinery for them is worthwhile. */
+  if (len == 0)
+    {
+      *checksum = svn_checksum_empty_checksum(kind, pool);
+      return SVN_NO_ERROR;
+    }
+
   *checksum = svn_checksum_create(kind, pool);
 
   switch (kind)
@@ -718,6 +731,366 @@ svn_checksum_is_empty_checksum(svn_checksum_t *checksum)
     }
 }
 
+/* Asynchronous checksum contexts.
+ *
+ * Producer / consumer scheme with a single background hashing thread per
+ * context:  the writing thread copies its data into a ring of fixed-size
+ * blocks and the hashing thread feeds them into the wrapped checksum
+ * context.  Hashing a block happens with the mutex released, so both
+ * threads only ever contend for the brief queue state updates.
+ *
+ * The thread gets started lazily once ASYNC_THRESHOLD bytes have been
+ * seen.  That way, the many small contents hashed during a typical
+ * commit stay inline and only bulk contents - where the hash cost is
+ * actually worth hiding behind the I/O - pay for thread creation and
+ * the extra copy.
+ */
+
+#if APR_HAS_THREADS
+
+/* Start offloading to the background thread after this many bytes. */
+#define ASYNC_THRESHOLD (1024 * 1024)
+
+/* Size of each data block handed to the hashing thread. */
+#define ASYNC_BLOCK_SIZE (256 * 1024)
+
+/* Number of blocks in the ring buffer, i.e. upper limit to the amount
+ * of data buffered between the two threads. */
+#define ASYNC_BLOCK_COUNT 8
+
+#endif
+
+struct svn_checksum__async_ctx_t
+{
+  /* The wrapped checksum context.  Used by the writing thread before the
+   * hashing thread has been started, by the hashing thread afterwards,
+   * and by the writing thread again after the join in
+   * svn_checksum__async_final. */
+  svn_checksum_ctx_t *context;
+
+  /* Pool that this context got allocated in. */
+  apr_pool_t *pool;
+
+#if APR_HAS_THREADS
+  /* Total number of bytes hashed inline, so far.  Only used before the
+   * hashing thread has been started. */
+  apr_uint64_t processed;
+
+  /* TRUE while the hashing thread is running, FALSE again after the
+   * join. */
+  svn_boolean_t threaded;
+
+  /* TRUE, if starting the thread failed.  Keep hashing inline, then. */
+  svn_boolean_t thread_failed;
+
+  /* The hashing thread.  Valid iff THREADED is set. */
+  apr_thread_t *thread;
+
+  /* Protects all following members. */
+  svn_mutex__t *mutex;
+
+  /* Signalled when a slot in the ring buffer becomes free. */
+  svn_thread_cond__t *can_produce;
+
+  /* Signalled when a block has been queued or DONE has been set. */
+  svn_thread_cond__t *can_consume;
+
+  /* Ring buffer of data blocks, ASYNC_BLOCK_SIZE bytes each. */
+  char *blocks[ASYNC_BLOCK_COUNT];
+
+  /* Number of valid bytes in the respective BLOCKS element. */
+  apr_size_t filled[ASYNC_BLOCK_COUNT];
+
+  /* Index of the first queued but not yet hashed block. */
+  int first;
+
+  /* Number of queued but not yet hashed blocks. */
+  int count;
+
+  /* Number of bytes the writing thread has put into the currently
+   * filling block, i.e. BLOCKS[(FIRST + COUNT) % ASYNC_BLOCK_COUNT]. */
+  apr_size_t write_pos;
+
+  /* Set by the writing thread when no further data will be queued. */
+  svn_boolean_t done;
+
+  /* Set by the hashing thread if it terminated prematurely.  May be
+   * read without holding MUTEX. */
+  svn_atomic_t aborted;
+
+  /* Error that caused the hashing thread to terminate prematurely.
+   * Only to be accessed after joining the thread. */
+  svn_error_t *worker_err;
+#endif
+};
+
+#if APR_HAS_THREADS
+
+/* Process the blocks queued in CTX until DONE has been set and the queue
+ * has drained.  Returns without holding CTX->MUTEX. */
+static svn_error_t *
+hashing_worker(svn_checksum__async_ctx_t *ctx)
+{
+  svn_error_t *err = svn_mutex__lock(ctx->mutex);
+
+  while (!err)
+    {
+      int idx;
+      svn_error_t *lock_err;
+
+      /* Spurious wakeups are handled implicitly
+       * (check conditions and go back to sleep). */
+      if (ctx->count == 0)
+        {
+          if (ctx->done)
+            break;
+
+          err = svn_thread_cond__wait(ctx->can_consume, ctx->mutex);
+          continue;
+        }
+
+      idx = ctx->first;
+
+      /* Hash the block with the mutex released, so the writing thread
+       * may keep filling the remaining slots in the meantime. */
+      err = svn_mutex__unlock(ctx->mutex, NULL);
+      if (err)
+        return svn_error_trace(err);
+
+      err = svn_checksum_update(ctx->context, ctx->blocks[idx],
+                                ctx->filled[idx]);
+
+      lock_err = svn_mutex__lock(ctx->mutex);
+      if (lock_err)
+        return svn_error_trace(svn_error_compose_create(err, lock_err));
+      if (err)
+        break;
+
+      ctx->first = (ctx->first + 1) % ASYNC_BLOCK_COUNT;
+      ctx->count--;
+      err = svn_thread_cond__signal(ctx->can_produce);
+    }
+
+  return svn_error_trace(svn_mutex__unlock(ctx->mutex, err));
+}
+
+/* The plain APR thread around the worker function.
+ * DATA is the svn_checksum__async_ctx_t to process. */
+static void * APR_THREAD_FUNC
+hashing_thread(apr_thread_t *thread, void *data)
+{
+  svn_checksum__async_ctx_t *ctx = data;
+
+  svn_error_t *err = hashing_worker(ctx);
+  if (err)
+    {
+      /* Remember the error for svn_checksum__async_final and make sure
+       * a potentially waiting writer stops feeding us.  CAN_PRODUCE may
+       * be signalled without holding the mutex. */
+      ctx->worker_err = err;
+      svn_atomic_set(&ctx->aborted, TRUE);
+      svn_error_clear(svn_thread_cond__broadcast(ctx->can_produce));
+    }
+
+  /* End thread explicitly to prevent APR_INCOMPLETE return codes in
+     apr_thread_join(). */
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Pool cleanup handler ensuring that the hashing thread of the given
+ * svn_checksum__async_ctx_t has terminated before the block buffers get
+ * destroyed with the pool. */
+static apr_status_t
+stop_hashing_thread(void *baton)
+{
+  svn_checksum__async_ctx_t *ctx = baton;
+  if (ctx->threaded)
+    {
+      apr_status_t result;
+      svn_error_t *err = svn_mutex__lock(ctx->mutex);
+      if (!err)
+        {
+          ctx->done = TRUE;
+          err = svn_mutex__unlock(ctx->mutex,
+                                  svn_thread_cond__signal(ctx->can_consume));
+        }
+      svn_error_clear(err);
+
+      apr_thread_join(&result, ctx->thread);
+      ctx->threaded = FALSE;
+    }
+
+  svn_error_clear(ctx->worker_err);
+  ctx->worker_err = NULL;
+
+  return APR_SUCCESS;
+}
+
+/* Switch CTX into threaded mode:  allocate the block ring and start the
+ * hashing thread.  Failure to create the thread is not reported; CTX
+ * will simply continue to hash inline. */
+static svn_error_t *
+start_hashing_thread(svn_checksum__async_ctx_t *ctx)
+{
+  int i;
+  apr_status_t status;
+
+  SVN_ERR(svn_mutex__init(&ctx->mutex, TRUE, ctx->pool));
+  SVN_ERR(svn_thread_cond__create(&ctx->can_produce, ctx->pool));
+  SVN_ERR(svn_thread_cond__create(&ctx->can_consume, ctx->pool));
+
+  for (i = 0; i < ASYNC_BLOCK_COUNT; ++i)
+    ctx->blocks[i] = apr_palloc(ctx->pool, ASYNC_BLOCK_SIZE);
+
+  status = apr_thread_create(&ctx->thread, NULL, hashing_thread, ctx,
+                             ctx->pool);
+  if (status)
+    {
+      ctx->thread_failed = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  /* Make sure the thread terminates before its working set does. */
+  apr_pool_cleanup_register(ctx->pool, ctx, stop_hashing_thread,
+                            apr_pool_cleanup_null);
+  ctx->threaded = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy LEN bytes of DATA into the ring buffer of CTX, waiting for the
+ * hashing thread to free up slots as necessary.
+ * To be called with CTX->MUTEX held. */
+static svn_error_t *
+queue_data(svn_checksum__async_ctx_t *ctx,
+           const char *data,
+           apr_size_t len)
+{
+  while (len > 0)
+    {
+      int idx;
+      apr_size_t copied;
+
+      while (   ctx->count == ASYNC_BLOCK_COUNT
+             && !svn_atomic_read(&ctx->aborted))
+        SVN_ERR(svn_thread_cond__wait(ctx->can_produce, ctx->mutex));
+
+      /* If the hashing thread died, drop the data.  Its error will be
+       * reported by svn_checksum__async_final. */
+      if (svn_atomic_read(&ctx->aborted))
+        return SVN_NO_ERROR;
+
+      idx = (ctx->first + ctx->count) % ASYNC_BLOCK_COUNT;
+      copied = MIN(len, ASYNC_BLOCK_SIZE - ctx->write_pos);
+      memcpy(ctx->blocks[idx] + ctx->write_pos, data, copied);
+
+      ctx->write_pos += copied;
+      data += copied;
+      len -= copied;
+
+      /* Hand complete blocks over to the hashing thread. */
+      if (ctx->write_pos == ASYNC_BLOCK_SIZE)
+        {
+          ctx->filled[idx] = ASYNC_BLOCK_SIZE;
+          ctx->count++;
+          ctx->write_pos = 0;
+          SVN_ERR(svn_thread_cond__signal(ctx->can_consume));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Queue the partially filled last block in CTX, if any, and tell the
+ * hashing thread that no further data will arrive.
+ * To be called with CTX->MUTEX held. */
+static svn_error_t *
+finish_queue(svn_checksum__async_ctx_t *ctx)
+{
+  /* WRITE_POS > 0 implies COUNT < ASYNC_BLOCK_COUNT, i.e. the filling
+   * block may always be queued without waiting. */
+  if (ctx->write_pos > 0 && !svn_atomic_read(&ctx->aborted))
+    {
+      ctx->filled[(ctx->first + ctx->count) % ASYNC_BLOCK_COUNT]
+        = ctx->write_pos;
+      ctx->count++;
+      ctx->write_pos = 0;
+    }
+
+  ctx->done = TRUE;
+  return svn_error_trace(svn_thread_cond__signal(ctx->can_consume));
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_checksum__async_ctx_t *
+svn_checksum__async_ctx_create(svn_checksum_kind_t kind,
+                               apr_pool_t *pool)
+{
+  svn_checksum__async_ctx_t *ctx = apr_pcalloc(pool, sizeof(*ctx));
+  ctx->context = svn_checksum_ctx_create(kind, pool);
+  ctx->pool = pool;
+
+  return ctx;
+}
+
+svn_error_t *
+svn_checksum__async_update(svn_checksum__async_ctx_t *ctx,
+                           const char *data,
+                           apr_size_t len)
+{
+#if APR_HAS_THREADS
+  if (ctx->threaded)
+    {
+      SVN_MUTEX__WITH_LOCK(ctx->mutex, queue_data(ctx, data, len));
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_checksum_update(ctx->context, data, len));
+
+  ctx->processed += len;
+  if (ctx->processed >= ASYNC_THRESHOLD && !ctx->thread_failed)
+    SVN_ERR(start_hashing_thread(ctx));
+
+  return SVN_NO_ERROR;
+#else
+  return svn_error_trace(svn_checksum_update(ctx->context, data, len));
+#endif
+}
+
+svn_error_t *
+svn_checksum__async_final(svn_checksum_t **checksum,
+                          svn_checksum__async_ctx_t *ctx,
+                          apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  if (ctx->threaded)
+    {
+      apr_status_t result;
+      apr_status_t status;
+
+      SVN_MUTEX__WITH_LOCK(ctx->mutex, finish_queue(ctx));
+
+      status = apr_thread_join(&result, ctx->thread);
+      ctx->threaded = FALSE;
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't join hashing thread"));
+
+      if (ctx->worker_err)
+        {
+          svn_error_t *err = ctx->worker_err;
+          ctx->worker_err = NULL;
+          return svn_error_trace(err);
+        }
+    }
+#endif
+
+  return svn_error_trace(svn_checksum_final(checksum, ctx->context,
+                                            result_pool));
+}
+
+
 /* Checksum calculating stream wrappers.
  */
 
@@ -731,8 +1104,9 @@ typedef struct stream_baton_t
   /* Stream we are wrapping. Forward write() and close() operations to it. */
   svn_stream_t *inner_stream;
 
-  /* Build the checksum data in here. */
-  svn_checksum_ctx_t *context;
+  /* Build the checksum data in here, hashing bulk contents on a
+   * background thread where possible. */
+  svn_checksum__async_ctx_t *context;
 
   /* Write the final checksum here. May be NULL. */
   svn_checksum_t **checksum;
@@ -754,7 +1128,7 @@ write_handler(void *baton,
 {
   stream_baton_t *b = baton;
 
-  SVN_ERR(svn_checksum_update(b->context, data, *len));
+  SVN_ERR(svn_checksum__async_update(b->context, data, *len));
   SVN_ERR(svn_stream_write(b->inner_stream, data, len));
 
   return SVN_NO_ERROR;
@@ -774,7 +1148,7 @@ close_handler(void *baton)
     b->checksum = &local_checksum;
 
   /* Get the final checksum. */
-  SVN_ERR(svn_checksum_final(b->checksum, b->context, b->pool));
+  SVN_ERR(svn_checksum__async_final(b->checksum, b->context, b->pool));
 
   /* Extract digest, if wanted. */
   if (b->digest)
@@ -806,7 +1180,7 @@ wrap_write_stream(svn_checksum_t **checksum,
 
   stream_baton_t *baton = apr_pcalloc(pool, sizeof(*baton));
   baton->inner_stream = inner_stream;
-  baton->context = svn_checksum_ctx_create(kind, pool);
+  baton->context = svn_checksum__async_ctx_create(kind, pool);
   baton->checksum = checksum;
   baton->digest = digest;
   baton->pool = pool;
@@ -29,6 +29,10 @@
 
 #include "svn_private_config.h"
 
+#ifdef SVN_HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
 const char *
 svn_zlib__compiled_version(void)
 {
@@ -89,10 +93,41 @@ zlib_encode(const char *data,
   else
     {
       int zerr;
+#ifdef SVN_HAVE_LIBDEFLATE
+      struct libdeflate_compressor *compressor;
+#endif
 
       svn_stringbuf_ensure(out, svnCompressBound(len) + intlen);
       endlen = out->blocksize;
 
+#ifdef SVN_HAVE_LIBDEFLATE
+      /* Prefer libdeflate's whole-buffer codec.  It emits the same
+         zlib-wrapped deflate stream that uncompress() and existing
+         clients expect, just faster.  If the compressor cannot be set
+         up (out of memory), quietly fall back to zlib below. */
+      compressor = libdeflate_alloc_compressor(compression_level);
+      if (compressor)
+        {
+          apr_size_t comp_len
+            = libdeflate_zlib_compress(compressor, data, len,
+                                       out->data + intlen,
+                                       out->blocksize - intlen);
+          libdeflate_free_compressor(compressor);
+
+          /* 0 means "output buffer too small", i.e. compression
+             didn't gain anything.  Just append the original text. */
+          if (comp_len == 0 || comp_len >= len)
+            {
+              svn_stringbuf_appendbytes(out, data, len);
+              return SVN_NO_ERROR;
+            }
+
+          out->len = comp_len + intlen;
+          out->data[out->len] = 0;
+          return SVN_NO_ERROR;
+        }
+#endif
+
       zerr = compress2((unsigned char *)out->data + intlen, &endlen,
                        (const unsigned char *)data, len,
                        compression_level);
@@ -157,8 +192,43 @@ zlib_decode(const unsigned char *in, apr_size_t inLen, svn_stringbuf_t *out,
     {
       unsigned long zlen = len;
       int zerr;
+#ifdef SVN_HAVE_LIBDEFLATE
+      struct libdeflate_decompressor *decompressor;
+#endif
 
       svn_stringbuf_ensure(out, len);
+
+#ifdef SVN_HAVE_LIBDEFLATE
+      /* Prefer libdeflate's whole-buffer codec; it consumes the very
+         same zlib-wrapped stream.  If the decompressor cannot be set
+         up (out of memory), quietly fall back to zlib below. */
+      decompressor = libdeflate_alloc_decompressor();
+      if (decompressor)
+        {
+          apr_size_t actual;
+          enum libdeflate_result result
+            = libdeflate_zlib_decompress(decompressor, in, inLen,
+                                         out->data, len, &actual);
+          libdeflate_free_decompressor(decompressor);
+
+          if (result != LIBDEFLATE_SUCCESS)
+            return svn_error_create(
+                     SVN_ERR_SVNDIFF_INVALID_COMPRESSED_DATA, NULL,
+                     _("Decompression of svndiff data failed"));
+
+          if (actual != len)
+            return svn_error_create(SVN_ERR_SVNDIFF_INVALID_COMPRESSED_DATA,
+                                    NULL,
+                                    _("Size of uncompressed data "
+                                      "does not match stored original "
+                                      "length"));
+
+          out->data[len] = 0;
+          out->len = len;
+          return SVN_NO_ERROR;
+        }
+#endif
+
       zerr = uncompress((unsigned char *)out->data, &zlen, in, inLen);
       if (zerr != Z_OK)
         return svn_error_trace(svn_error__wrap_zlib(
@@ -1155,6 +1155,9 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###                              HTTP operation."                   NL
         "###   http-chunked-requests      Whether to use chunked transfer"   NL
         "###                              encoding for HTTP requests body."  NL
+        "###   http-pipeline-depth        Maximum number of file fetch"      NL
+        "###                              requests kept in flight across"    NL
+        "###                              those connections."                NL
         "###   http-auth-types            List of HTTP authentication types."NL
         "###   ssl-authority-files        List of files, each of a trusted CA"
                                                                              NL
@@ -1512,6 +1515,26 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### to show meaningful differences for binary file formats.  [New"  NL
         "### in 1.9]"                                                        NL
         "# diff-ignore-content-type = no"                                    NL
+        "### Set blame-cache-dir to a directory to let 'svn blame' cache"    NL
+        "### its results on disk, so blaming the same file again only"       NL
+        "### processes the revisions committed since the previous blame."    NL
+        "### The cache is unbounded; clean the directory to reclaim the"     NL
+        "### space.  [New in 1.15]"                                          NL
+        "# blame-cache-dir = /path/to/cache"                                 NL
+        "### Set worker-threads to let client operations that support it"    NL
+        "### spread their local work over that many concurrent threads."     NL
+        "### Currently 'svn commit' uses this setting when it looks for"     NL
+        "### local modifications.  The default value of 1 keeps all work"    NL
+        "### on a single thread.  Working copies that use exclusive wc.db"   NL
+        "### locking should keep this at 1.  [New in 1.15]"                  NL
+        "# worker-threads = 4"                                               NL
+        "### Set log-cache-dir to a directory to let 'svn log' cache the"    NL
+        "### received log entries on disk, so asking for the same range"     NL
+        "### again only contacts the server for revisions committed since"   NL
+        "### the previous run.  Revision property edits (e.g. changed log"   NL
+        "### messages) are not detected; clean the directory to drop stale"  NL
+        "### entries and to reclaim the space.  [New in 1.15]"               NL
+        "# log-cache-dir = /path/to/cache"                                   NL
         ""                                                                   NL
         "### Section for configuring automatic properties."                  NL
         "[auto-props]"                                                       NL
@@ -1557,6 +1580,15 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### and upgraded working copies will by default be compatible with" NL
         "### the specified Subversion version."                              NL
         "# compatible-version = 1.8"                                         NL
+        "### Set to true to install incoming files on a worker thread"       NL
+        "### during updates and checkouts, overlapping network transfer"     NL
+        "### with disk I/O.  Requires a client built with thread support."   NL
+        "# pipelined-updates = false"                                        NL
+        "### Set to true to store the pristine copies of files in newly"     NL
+        "### created working copies in an LZ4-compressed format.  The"       NL
+        "### setting takes effect at checkout time and is then fixed for"    NL
+        "### the lifetime of the working copy."                              NL
+        "# compressed-pristines = false"                                     NL
         ;
 
       err = svn_io_file_open(&f, path,
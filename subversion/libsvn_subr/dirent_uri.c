@@ -317,6 +317,43 @@ canonicalize(const char **canonical_path,
         return SVN_NO_ERROR;
     }
 
+  /* In steady state, almost every path handed to us is canonical
+     already.  Confirming that in a single read-only pass is much
+     cheaper than rewriting the path segment by segment, so check
+     first and only fall through to the rewrite when the path turns
+     out not to be canonical after all. */
+  switch (type)
+    {
+    case type_relpath:
+      if (relpath_is_canonical(path))
+        {
+          *canonical_path = apr_pstrdup(pool, path);
+          return SVN_NO_ERROR;
+        }
+      break;
+
+#ifndef SVN_USE_DOS_PATHS
+    case type_dirent:
+      if (svn_dirent_is_canonical(path, pool))
+        {
+          *canonical_path = apr_pstrdup(pool, path);
+          return SVN_NO_ERROR;
+        }
+      break;
+#endif /* !SVN_USE_DOS_PATHS */
+
+    case type_uri:
+      if (svn_uri_is_canonical(path, pool))
+        {
+          *canonical_path = apr_pstrdup(pool, path);
+          return SVN_NO_ERROR;
+        }
+      break;
+
+    default:
+      break;
+    }
+
   dst = canon = apr_pcalloc(pool, strlen(path) + 1);
 
   /* If this is supposed to be an URI, it should start with
@@ -1856,8 +1893,7 @@ static svn_boolean_t
 relpath_is_canonical(const char *relpath)
 {
   const char *dot_pos, *ptr = relpath;
-  apr_size_t i, len;
-  unsigned pattern = 0;
+  apr_size_t len;
 
   /* RELPATH is canonical if it has:
    *  - no '.' segments
@@ -1891,13 +1927,11 @@ relpath_is_canonical(const char *relpath)
     if (dot_pos > ptr && dot_pos[-1] == '/' && dot_pos[1] == '/')
       return FALSE;
 
-  /* Now validate the rest of the path. */
-  for (i = 0; i < len - 1; ++i)
-    {
-      pattern = ((pattern & 0xff) << 8) + (unsigned char)ptr[i];
-      if (pattern == 0x101 * (unsigned char)('/'))
-        return FALSE;
-    }
+  /* Finally, check for "//".  Just like memchr() above, strstr() scans
+     the path a whole machine word or vector register at a time instead
+     of byte by byte. */
+  if (strstr(ptr, "//") != NULL)
+    return FALSE;
 
   return TRUE;
 }
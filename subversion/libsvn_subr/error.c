@@ -23,12 +23,13 @@
 
 
 #include <stdarg.h>
+#include <stdlib.h>
 
 #include <apr_general.h>
 #include <apr_pools.h>
 #include <apr_strings.h>
 
-#if defined(SVN_DEBUG) && APR_HAS_THREADS
+#if APR_HAS_THREADS
 #include <apr_thread_proc.h>
 #endif
 
@@ -45,7 +46,7 @@
 #include "private/svn_error_private.h"
 #include "svn_private_config.h"
 
-#if defined(SVN_DEBUG) && APR_HAS_THREADS
+#if APR_HAS_THREADS
 #include "private/svn_atomic.h"
 #include "pools.h"
 #endif
@@ -159,6 +160,142 @@ static apr_status_t err_abort(void *data)
 #endif
 
 
+/* Recycling cleared error pools.
+ *
+ * Each top-level error owns a root pool whose creation and destruction
+ * go through the globally locked allocator.  Hot paths that use errors
+ * for control flow - ENOENT-style probes during tree walks, for
+ * instance - pay that cost for every expected miss.  Keep a small
+ * per-thread stash of cleared error pools and reuse them, so the common
+ * create-and-clear cycle touches no global state.  The public error
+ * semantics are unchanged; only the pool's lifetime management is.
+ */
+
+/* Number of cleared error pools each thread may retain for reuse. */
+#define ERROR_POOL_STASH_SIZE 4
+
+/* The per-thread stash of cleared, reusable error pools. */
+typedef struct error_pool_stash_t
+{
+  /* number of entries used in POOLS */
+  int count;
+
+  /* the cleared pools, ready for reuse */
+  apr_pool_t *pools[ERROR_POOL_STASH_SIZE];
+} error_pool_stash_t;
+
+#if APR_HAS_THREADS
+
+static apr_threadkey_t *error_pool_stash_key = NULL;
+static volatile svn_atomic_t error_pool_stash_init_state = 0;
+
+/* Destroy all pools cached in the exiting thread's stash DATA and the
+   stash itself.  Implements the destructor interface of
+   apr_threadkey_private_create(). */
+static void
+error_pool_stash_cleanup(void *data)
+{
+  error_pool_stash_t *stash = data;
+
+  while (stash->count > 0)
+    svn_pool_destroy(stash->pools[--stash->count]);
+  free(stash);
+}
+
+/* Implements svn_atomic__str_init_func_t, creating the thread-local
+   storage key for the error pool stashes.  This function will never
+   return an error string. */
+static const char *
+error_pool_stash_init(void *ignored_baton)
+{
+  /* Same deliberate "leak" as in locate_init_once: the key must outlive
+     all threads, so it lives in an unmanaged pool. */
+  apr_pool_t *threadkey_pool = svn_pool__create_unmanaged(TRUE);
+
+  if (apr_threadkey_private_create(&error_pool_stash_key,
+                                   error_pool_stash_cleanup,
+                                   threadkey_pool) != APR_SUCCESS)
+    error_pool_stash_key = NULL;
+
+  return NULL;
+}
+
+/* Return the calling thread's error pool stash, creating it upon the
+   first call.  Returns NULL if thread-local storage is unavailable;
+   callers then simply fall back to plain create / destroy. */
+static error_pool_stash_t *
+get_error_pool_stash(void)
+{
+  void *data;
+
+  svn_atomic__init_once_no_error(&error_pool_stash_init_state,
+                                 error_pool_stash_init, NULL);
+  if (!error_pool_stash_key)
+    return NULL;
+
+  if (apr_threadkey_private_get(&data, error_pool_stash_key) != APR_SUCCESS)
+    return NULL;
+
+  if (!data)
+    {
+      data = calloc(1, sizeof(error_pool_stash_t));
+      if (!data)
+        return NULL;
+
+      if (apr_threadkey_private_set(data, error_pool_stash_key)
+          != APR_SUCCESS)
+        {
+          free(data);
+          return NULL;
+        }
+    }
+
+  return data;
+}
+
+#else  /* !APR_HAS_THREADS */
+
+/* Without threads, a single static stash cannot race with anyone. */
+static error_pool_stash_t error_pool_stash_singleton = { 0 };
+
+static error_pool_stash_t *
+get_error_pool_stash(void)
+{
+  return &error_pool_stash_singleton;
+}
+
+#endif  /* !APR_HAS_THREADS */
+
+/* Return a root pool for a new top-level error, reusing a recycled one
+   if the calling thread has any stashed. */
+static apr_pool_t *
+acquire_error_pool(void)
+{
+  error_pool_stash_t *stash = get_error_pool_stash();
+
+  if (stash && stash->count > 0)
+    return stash->pools[--stash->count];
+
+  return svn_pool_create(NULL);
+}
+
+/* Release the root POOL of an error that has been cleared: stash it for
+   reuse by the calling thread or, if the stash is full, destroy it. */
+static void
+release_error_pool(apr_pool_t *pool)
+{
+  error_pool_stash_t *stash = get_error_pool_stash();
+
+  if (stash && stash->count < ERROR_POOL_STASH_SIZE)
+    {
+      apr_pool_clear(pool);
+      stash->pools[stash->count++] = pool;
+    }
+  else
+    svn_pool_destroy(pool);
+}
+
+
 static svn_error_t *
 make_error_internal(apr_status_t apr_err,
                     svn_error_t *child)
@@ -169,12 +306,12 @@ make_error_internal(apr_status_t apr_err,
   apr_status_t status = APR_ENOTIMPL;
 #endif
 
-  /* Reuse the child's pool, or create our own. */
+  /* Reuse the child's pool, or create / recycle our own. */
   if (child)
     pool = child->pool;
   else
     {
-      pool = svn_pool_create(NULL);
+      pool = acquire_error_pool();
       if (!pool)
         abort();
     }
@@ -408,8 +545,8 @@ svn_error_compose(svn_error_t *chain, svn_error_t *new_err)
                             apr_pool_cleanup_null);
 #endif
 
-  /* Destroy the new error chain. */
-  svn_pool_destroy(oldpool);
+  /* Release the now-copied error chain's pool. */
+  release_error_pool(oldpool);
 }
 
 svn_error_t *
@@ -493,7 +630,7 @@ svn_error_clear(svn_error_t *err)
         err = err->child;
       apr_pool_cleanup_kill(err->pool, err, err_abort);
 #endif
-      svn_pool_destroy(err->pool);
+      release_error_pool(err->pool);
     }
 }
 
@@ -29,6 +29,21 @@
 #include "private/svn_subr_private.h"
 #include "fnv1a.h"
 
+/* The interleaved multi-lane hash below maps naturally onto 4x32 bit
+ * SIMD registers.  Use such an implementation when the target supports
+ * the required instructions unconditionally; both variants need a
+ * little-endian lane layout to match the scalar code.
+ */
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#define SVN_FNV1A_32X4_SIMD 1
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#include <arm_neon.h>
+#define SVN_FNV1A_32X4_SIMD 1
+#else
+#define SVN_FNV1A_32X4_SIMD 0
+#endif
+
 /**
  * See http://www.isthe.com/chongo/tech/comp/fnv/ for more info on FNV-1
  */
@@ -73,6 +88,51 @@ fnv1a_32x4(apr_uint32_t hashes[SCALING], const void *input, apr_size_t len)
      is large enough */
   const unsigned char *data = input;
   const unsigned char *end = data + len;
+
+#if SVN_FNV1A_32X4_SIMD
+  if (data + SCALING <= end)
+    {
+#if defined(__SSE4_1__)
+      __m128i hash = _mm_loadu_si128((const __m128i *)hashes);
+      const __m128i prime = _mm_set1_epi32(FNV1_PRIME_32);
+
+      for (; data + SCALING <= end; data += SCALING)
+        {
+          /* zero-extend the next 4 input bytes into one 32 bit lane
+             each, i.e. lane I gets DATA[I] - just like the scalar
+             code below */
+          apr_uint32_t chunk;
+          __m128i lanes;
+          memcpy(&chunk, data, sizeof(chunk));
+
+          lanes = _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)chunk));
+          hash = _mm_xor_si128(hash, lanes);
+          hash = _mm_mullo_epi32(hash, prime);
+        }
+
+      _mm_storeu_si128((__m128i *)hashes, hash);
+#else /* __ARM_NEON */
+      uint32x4_t hash = vld1q_u32(hashes);
+      const uint32x4_t prime = vdupq_n_u32(FNV1_PRIME_32);
+
+      for (; data + SCALING <= end; data += SCALING)
+        {
+          /* zero-extend the next 4 input bytes into one 32 bit lane
+             each, i.e. lane I gets DATA[I] - just like the scalar
+             code below */
+          apr_uint32_t chunk;
+          uint16x8_t widened;
+          memcpy(&chunk, data, sizeof(chunk));
+
+          widened = vmovl_u8(vcreate_u8((apr_uint64_t)chunk));
+          hash = veorq_u32(hash, vmovl_u16(vget_low_u16(widened)));
+          hash = vmulq_u32(hash, prime);
+        }
+
+      vst1q_u32(hashes, hash);
+#endif
+    }
+#else
   for (; data + SCALING <= end; data += SCALING)
     {
       hashes[0] ^= data[0];
@@ -84,6 +144,7 @@ fnv1a_32x4(apr_uint32_t hashes[SCALING], const void *input, apr_size_t len)
       hashes[3] ^= data[3];
       hashes[3] *= FNV1_PRIME_32;
     }
+#endif
 
   return data - (const unsigned char *)input;
 }
@@ -357,6 +357,99 @@ svn_hash_write_incremental(apr_hash_t *hash, apr_hash_t *oldhash,
 }
 
 
+svn_error_t *
+svn_hash__write_binary(apr_hash_t *hash,
+                       svn_stream_t *stream,
+                       apr_pool_t *pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create_ensure(1024, pool);
+  unsigned char encoded[SVN__MAX_ENCODED_UINT_LEN];
+  apr_array_header_t *list;
+  apr_size_t len;
+  int i;
+
+  svn_stringbuf_appendbyte(buffer, SVN_HASH__BINARY_MARKER);
+
+  /* Sort the entries for deterministic output, just like hash_write(). */
+  list = svn_sort__hash(hash, svn_sort_compare_items_lexically, pool);
+  svn_stringbuf_appendbytes(buffer, (const char *)encoded,
+                            svn__encode_uint(encoded,
+                                             (apr_uint64_t)list->nelts)
+                              - encoded);
+
+  for (i = 0; i < list->nelts; i++)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(list, i, svn_sort__item_t);
+      svn_string_t *valstr = item->value;
+
+      if (item->klen < 0)
+        return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                                _("Cannot serialize negative length"));
+
+      svn_stringbuf_appendbytes(buffer, (const char *)encoded,
+                                svn__encode_uint(encoded,
+                                                 (apr_uint64_t)item->klen)
+                                  - encoded);
+      svn_stringbuf_appendbytes(buffer, item->key, (apr_size_t)item->klen);
+      svn_stringbuf_appendbytes(buffer, (const char *)encoded,
+                                svn__encode_uint(encoded, valstr->len)
+                                  - encoded);
+      svn_stringbuf_appendbytes(buffer, valstr->data, valstr->len);
+    }
+
+  len = buffer->len;
+  return svn_error_trace(svn_stream_write(stream, buffer->data, &len));
+}
+
+
+svn_error_t *
+svn_hash__read_binary(apr_hash_t *hash,
+                      const svn_string_t *content,
+                      apr_pool_t *pool)
+{
+  const unsigned char *p = (const unsigned char *)content->data;
+  const unsigned char *end = p + content->len;
+  apr_uint64_t count;
+  apr_uint64_t i;
+
+  if (p == end || *p != SVN_HASH__BINARY_MARKER)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                            _("Serialized hash missing marker byte"));
+  ++p;
+
+  p = svn__decode_uint(&count, p, end);
+  if (!p)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                            _("Serialized hash malformed"));
+
+  for (i = 0; i < count; i++)
+    {
+      apr_uint64_t keylen;
+      apr_uint64_t vallen;
+      char *key;
+      svn_string_t *value;
+
+      p = svn__decode_uint(&keylen, p, end);
+      if (!p || keylen > (apr_uint64_t)(end - p))
+        return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                                _("Serialized hash malformed"));
+      key = apr_pstrmemdup(pool, (const char *)p, (apr_size_t)keylen);
+      p += keylen;
+
+      p = svn__decode_uint(&vallen, p, end);
+      if (!p || vallen > (apr_uint64_t)(end - p))
+        return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                                _("Serialized hash malformed"));
+      value = svn_string_ncreate((const char *)p, (apr_size_t)vallen, pool);
+      p += vallen;
+
+      apr_hash_set(hash, key, (apr_ssize_t)keylen, value);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_hash_write(apr_hash_t *hash, apr_file_t *destfile, apr_pool_t *pool)
 {
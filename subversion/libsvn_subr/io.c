@@ -29,6 +29,11 @@
 #include <unistd.h>
 #endif
 
+#ifdef HAVE_LINUX_FS_H
+#include <sys/ioctl.h>
+#include <linux/fs.h>  /* for FICLONE */
+#endif
+
 #ifndef APR_STATUS_IS_EPERM
 #include <errno.h>
 #ifdef EPERM
@@ -38,6 +43,9 @@
 #endif
 #endif
 
+#define APR_WANT_IOVEC
+#include <apr_want.h>
+
 #include <apr_lib.h>
 #include <apr_pools.h>
 #include <apr_file_io.h>
@@ -51,6 +59,20 @@
 #include <fcntl.h>
 #endif
 
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#if defined(_DIRENT_HAVE_D_TYPE) && defined(AT_SYMLINK_NOFOLLOW)
+/* Use the plain POSIX directory API in svn_io_get_dirents3().  Unlike
+   apr_dir_read(), it hands us the entry type reported by the kernel
+   (d_type) for free, and it lets us stat the remaining entries
+   relative to the open directory via fstatat(), i.e. without
+   re-resolving the directory path once per entry. */
+#define SVN_IO_POSIX_DIRENTS 1
+#endif
+#endif
+
 #include "svn_hash.h"
 #include "svn_types.h"
 #include "svn_dirent_uri.h"
@@ -894,6 +916,70 @@ copy_contents(apr_file_t *from_file,
               apr_file_t *to_file,
               apr_pool_t *pool)
 {
+#if defined(HAVE_LINUX_FS_H) && defined(FICLONE)
+  /* Try to clone the whole file first.  On reflink-capable file
+     systems, such as XFS and Btrfs, this merely shares the blocks of
+     FROM_FILE instead of copying them.  The ioctl fails cleanly where
+     reflinks are unsupported (e.g. across devices or on ext4) and
+     leaves both files untouched, so we can simply move on to the next
+     strategy. */
+  {
+    apr_os_file_t from_fd;
+    apr_os_file_t to_fd;
+
+    if (   apr_os_file_get(&from_fd, from_file) == APR_SUCCESS
+        && apr_os_file_get(&to_fd, to_file) == APR_SUCCESS
+        && ioctl(to_fd, FICLONE, from_fd) == 0)
+      return APR_SUCCESS;
+  }
+#endif
+
+#if defined(HAVE_COPY_FILE_RANGE) && !defined(WIN32)
+  /* Ask the kernel to transfer the data directly, without moving it
+     through userspace buffers.  On file systems with reflink support,
+     such as XFS and Btrfs, this may not even copy the blocks at all.
+     Not every file (system) combination supports it, so be prepared
+     to fall back to the generic loop below. */
+  {
+    apr_os_file_t from_fd;
+    apr_os_file_t to_fd;
+
+    if (   apr_os_file_get(&from_fd, from_file) == APR_SUCCESS
+        && apr_os_file_get(&to_fd, to_file) == APR_SUCCESS)
+      {
+        svn_boolean_t progress = FALSE;
+
+        while (TRUE)
+          {
+            ssize_t transferred = copy_file_range(from_fd, NULL, to_fd,
+                                                  NULL, (size_t)1 << 30, 0);
+            if (transferred == 0)
+              return APR_SUCCESS;      /* reached EOF */
+
+            if (transferred < 0)
+              {
+                /* If the very first chunk got rejected, the syscall or
+                   the file system combination does not support in-kernel
+                   copies.  Since no data has been moved nor any file
+                   offset changed, yet, we can simply fall through to the
+                   generic loop.  Later errors are real I/O errors. */
+                if (   progress
+                    || !(   errno == EXDEV
+                         || errno == EINVAL
+                         || errno == ENOSYS
+                         || errno == EOPNOTSUPP
+                         || errno == EBADF))
+                  return APR_FROM_OS_ERROR(errno);
+
+                break;
+              }
+
+            progress = TRUE;
+          }
+      }
+  }
+#endif
+
   /* Copy bytes till the cows come home. */
   while (1)
     {
@@ -3092,6 +3178,112 @@ svn_io_get_dirents3(apr_hash_t **dirents,
                     apr_pool_t *result_pool,
                     apr_pool_t *scratch_pool)
 {
+#ifdef SVN_IO_POSIX_DIRENTS
+  const char *path_apr;
+  DIR *this_dir;
+  struct dirent *this_entry;
+  int dir_fd;
+  svn_error_t *err = NULL;
+
+  *dirents = apr_hash_make(result_pool);
+
+  SVN_ERR(cstring_from_utf8(&path_apr, path, scratch_pool));
+
+  this_dir = opendir(path_apr);
+  if (this_dir == NULL)
+    return svn_error_wrap_apr(APR_FROM_OS_ERROR(errno),
+                              _("Can't open directory '%s'"),
+                              svn_dirent_local_style(path, scratch_pool));
+  dir_fd = dirfd(this_dir);
+
+  for (errno = 0; (this_entry = readdir(this_dir)) != NULL; errno = 0)
+    {
+      const char *name;
+      svn_io_dirent2_t *dirent;
+
+      if ((this_entry->d_name[0] == '.')
+          && ((this_entry->d_name[1] == '\0')
+              || ((this_entry->d_name[1] == '.')
+                  && (this_entry->d_name[2] == '\0'))))
+        continue;
+
+      dirent = svn_io_dirent2_create(result_pool);
+
+      err = entry_name_to_utf8(&name, this_entry->d_name, path,
+                               result_pool);
+      if (err)
+        break;
+
+      if (only_check_type && this_entry->d_type != DT_UNKNOWN)
+        {
+          /* The kernel handed us the type with the name; there is no
+             need to stat the entry at all.  Same mapping as
+             map_apr_finfo_to_node_kind(). */
+          switch (this_entry->d_type)
+            {
+            case DT_REG:
+              dirent->kind = svn_node_file;
+              break;
+            case DT_DIR:
+              dirent->kind = svn_node_dir;
+              break;
+            case DT_LNK:
+              dirent->special = TRUE;
+              dirent->kind = svn_node_file;
+              break;
+            default:
+              dirent->kind = svn_node_unknown;
+            }
+        }
+      else
+        {
+          struct stat st;
+
+          if (fstatat(dir_fd, this_entry->d_name, &st,
+                      AT_SYMLINK_NOFOLLOW) != 0)
+            {
+              err = svn_error_wrap_apr(
+                      APR_FROM_OS_ERROR(errno),
+                      _("Can't read directory entry in '%s'"),
+                      svn_dirent_local_style(path, scratch_pool));
+              break;
+            }
+
+          if (S_ISREG(st.st_mode))
+            dirent->kind = svn_node_file;
+          else if (S_ISDIR(st.st_mode))
+            dirent->kind = svn_node_dir;
+          else if (S_ISLNK(st.st_mode))
+            {
+              dirent->special = TRUE;
+              dirent->kind = svn_node_file;
+            }
+          else
+            dirent->kind = svn_node_unknown;
+
+          if (!only_check_type)
+            {
+              dirent->filesize = st.st_size;
+              dirent->mtime = apr_time_make(st.st_mtim.tv_sec,
+                                            st.st_mtim.tv_nsec / 1000);
+            }
+        }
+
+      svn_hash_sets(*dirents, name, dirent);
+    }
+
+  if (!err && errno != 0)
+    err = svn_error_wrap_apr(APR_FROM_OS_ERROR(errno),
+                             _("Can't read directory '%s'"),
+                             svn_dirent_local_style(path, scratch_pool));
+
+  if (closedir(this_dir) != 0 && !err)
+    err = svn_error_wrap_apr(APR_FROM_OS_ERROR(errno),
+                             _("Error closing directory '%s'"),
+                             svn_dirent_local_style(path, scratch_pool));
+
+  return svn_error_trace(err);
+#else /* !SVN_IO_POSIX_DIRENTS */
   apr_status_t status;
   apr_dir_t *this_dir;
   apr_finfo_t this_entry;
@@ -3146,6 +3338,7 @@ svn_io_get_dirents3(apr_hash_t **dirents,
                               svn_dirent_local_style(path, scratch_pool));
 
   return SVN_NO_ERROR;
+#endif /* !SVN_IO_POSIX_DIRENTS */
 }
 
 svn_error_t *
@@ -4189,6 +4382,26 @@ svn_io_file_aligned_seek(apr_file_t *file,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_io__file_readahead(apr_file_t *file,
+                       apr_off_t offset,
+                       apr_off_t length,
+                       apr_pool_t *scratch_pool)
+{
+#if !defined(WIN32) && defined(POSIX_FADV_WILLNEED)
+  apr_os_file_t fd;
+
+  if (apr_os_file_get(&fd, file) == APR_SUCCESS)
+    {
+      /* Just a hint.  If the OS cannot queue the readahead, the regular
+         read path will fetch the data with its usual error reporting. */
+      posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_io_file_write(apr_file_t *file, const void *buf,
@@ -4257,6 +4470,48 @@ svn_io_file_write_full(apr_file_t *file, const void *buf,
      pool));
 }
 
+svn_error_t *
+svn_io_file_writev_full(apr_file_t *file,
+                        const svn_string_t *vec,
+                        apr_size_t nvec,
+                        apr_size_t *bytes_written,
+                        apr_pool_t *pool)
+{
+/* Number of buffers passed to a single apr_file_writev_full() call;
+   longer vectors get split. */
+#define MAXIOVEC 64
+  struct iovec iov[MAXIOVEC];
+  apr_status_t rv = APR_SUCCESS;
+  apr_size_t total = 0;
+  apr_size_t i = 0;
+
+  while (i < nvec && rv == APR_SUCCESS)
+    {
+      apr_size_t chunk;
+      apr_size_t nbytes = 0;
+
+      for (chunk = 0; i < nvec && chunk < MAXIOVEC; ++i, ++chunk)
+        {
+          iov[chunk].iov_base = (void *)vec[i].data;
+          iov[chunk].iov_len = vec[i].len;
+        }
+
+      rv = apr_file_writev_full(file, iov, chunk, &nbytes);
+      total += nbytes;
+    }
+#undef MAXIOVEC
+
+  /* bytes_written may actually be NULL */
+  if (bytes_written)
+    *bytes_written = total;
+
+  return svn_error_trace(do_io_file_wrapper_cleanup(
+     file, rv,
+     N_("Can't write to file '%s'"),
+     N_("Can't write to stream"),
+     pool));
+}
+
 
 svn_error_t *
 svn_io_write_unique(const char **tmp_path,
@@ -5671,6 +5926,69 @@ svn_io_open_unique_file3(apr_file_t **file,
   return SVN_NO_ERROR;
 }
 
+#if defined(O_TMPFILE) && !defined(WIN32) && !defined(__OS2__)
+/* Pool cleanup handler for the apr_file_t created by
+   svn_io__open_anonymous_file().  apr_os_file_put() does not register
+   one itself. */
+static apr_status_t
+close_anonymous_file(void *baton)
+{
+  return apr_file_close(baton);
+}
+#endif
+
+svn_error_t *
+svn_io__open_anonymous_file(apr_file_t **file,
+                            const char **unique_path,
+                            const char *dirpath,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+#if defined(O_TMPFILE) && !defined(WIN32) && !defined(__OS2__)
+  const char *dirpath_apr;
+  int fd;
+
+  if (dirpath == NULL)
+    SVN_ERR(svn_io_temp_dir(&dirpath, scratch_pool));
+
+  SVN_ERR(cstring_from_utf8(&dirpath_apr, dirpath, scratch_pool));
+
+  /* Filesystems without O_TMPFILE support report EOPNOTSUPP (or EISDIR
+     on older kernels); in that case quietly fall through to a named
+     temporary. */
+  fd = open(dirpath_apr, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  if (fd != -1)
+    {
+      apr_status_t status
+        = apr_os_file_put(file, &fd,
+                          APR_READ | APR_WRITE | APR_BUFFERED | APR_BINARY,
+                          result_pool);
+      if (status)
+        {
+          close(fd);
+          return svn_error_wrap_apr(status,
+                                    _("Can't open anonymous temporary "
+                                      "file in '%s'"),
+                                    svn_dirent_local_style(dirpath,
+                                                           scratch_pool));
+        }
+
+      apr_pool_cleanup_register(result_pool, *file, close_anonymous_file,
+                                apr_pool_cleanup_null);
+
+      if (unique_path)
+        *unique_path = NULL;
+      return SVN_NO_ERROR;
+    }
+#endif
+
+  return svn_error_trace(svn_io_open_unique_file3(file, unique_path,
+                                                  dirpath,
+                                                  svn_io_file_del_on_close,
+                                                  result_pool,
+                                                  scratch_pool));
+}
+
 svn_error_t *
 svn_io_file_readline(apr_file_t *file,
                      svn_stringbuf_t **stringbuf,
@@ -5682,66 +6000,102 @@ svn_io_file_readline(apr_file_t *file,
 {
   svn_stringbuf_t *str;
   const char *eol_str;
-  apr_size_t numbytes;
-  char c;
-  apr_size_t len;
+  char buf[4096];
+  apr_off_t start;
+  apr_size_t consumed;
+  apr_size_t fetched;
   svn_boolean_t found_eof;
 
   str = svn_stringbuf_create_ensure(80, result_pool);
 
-  /* Read bytes into STR up to and including, but not storing,
-   * the next EOL sequence. */
+  /* Remember where the line starts so that we can reposition the file
+   * after over-reading beyond the EOL sequence. */
+  SVN_ERR(svn_io_file_get_offset(&start, file, scratch_pool));
+
+  /* Read chunks into STR up to and including, but not storing, the
+   * next EOL sequence.  CONSUMED counts the bytes belonging to the
+   * line, including its EOL; FETCHED counts what we actually pulled
+   * from the file. */
   eol_str = NULL;
-  numbytes = 1;
-  len = 0;
+  consumed = 0;
+  fetched = 0;
   found_eof = FALSE;
-  while (!found_eof)
+  while (!eol_str && !found_eof && consumed < max_len)
     {
-      if (len < max_len)
-        SVN_ERR(svn_io_file_read_full2(file, &c, sizeof(c), &numbytes,
-                                       &found_eof, scratch_pool));
-      len++;
-      if (numbytes != 1 || len > max_len)
+      apr_size_t to_read = sizeof(buf);
+      apr_size_t bytes_read;
+      const char *cr, *lf, *eol_pos;
+
+      if (to_read > max_len - consumed)
+        to_read = max_len - consumed;
+
+      SVN_ERR(svn_io_file_read_full2(file, buf, to_read, &bytes_read,
+                                     &found_eof, scratch_pool));
+      fetched += bytes_read;
+
+      cr = memchr(buf, '\r', bytes_read);
+      lf = memchr(buf, '\n', bytes_read);
+      eol_pos = (cr && (!lf || cr < lf)) ? cr : lf;
+
+      if (eol_pos == NULL)
         {
-          found_eof = TRUE;
-          break;
+          svn_stringbuf_appendbytes(str, buf, bytes_read);
+          consumed += bytes_read;
+          continue;
         }
 
-      if (c == '\n')
+      svn_stringbuf_appendbytes(str, buf, eol_pos - buf);
+      consumed += (eol_pos - buf) + 1;
+
+      if (*eol_pos == '\n')
+        eol_str = "\n";
+      else if (eol_pos + 1 < buf + bytes_read)
         {
-          eol_str = "\n";
+          /* Check for "\r\n" within the chunk. */
+          if (eol_pos[1] == '\n')
+            {
+              eol_str = "\r\n";
+              consumed++;
+            }
+          else
+            eol_str = "\r";
         }
-      else if (c == '\r')
+      else
         {
-          eol_str = "\r";
+          /* "\r" at the end of the chunk;  peek at the next byte
+           * unless we already know there is none. */
+          char c;
 
-          if (!found_eof && len < max_len)
+          eol_str = "\r";
+          if (!found_eof && consumed < max_len)
             {
-              apr_off_t pos;
+              apr_size_t numbytes;
 
-              /* Check for "\r\n" by peeking at the next byte. */
-              SVN_ERR(svn_io_file_get_offset(&pos, file, scratch_pool));
-              SVN_ERR(svn_io_file_read_full2(file, &c, sizeof(c), &numbytes,
-                                             &found_eof, scratch_pool));
+              SVN_ERR(svn_io_file_read_full2(file, &c, sizeof(c),
+                                             &numbytes, &found_eof,
+                                             scratch_pool));
+              fetched += numbytes;
               if (numbytes == 1 && c == '\n')
                 {
                   eol_str = "\r\n";
-                  len++;
-                }
-              else
-                {
-                  /* Pretend we never peeked. */
-                  SVN_ERR(svn_io_file_seek(file, APR_SET, &pos, scratch_pool));
-                  found_eof = FALSE;
-                  numbytes = 1;
+                  consumed++;
                 }
             }
         }
-      else
-        svn_stringbuf_appendbyte(str, c);
 
-      if (eol_str)
-        break;
+      /* Having found the EOL, any EOF we hit while over-reading does
+       * not belong to this line. */
+      found_eof = FALSE;
+    }
+
+  if (!eol_str && consumed >= max_len)
+    found_eof = TRUE;
+
+  /* Reposition the file to the first byte after the line. */
+  if (fetched != consumed)
+    {
+      apr_off_t next = start + consumed;
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &next, scratch_pool));
     }
 
   if (eol)
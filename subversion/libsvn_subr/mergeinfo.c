@@ -1096,6 +1096,11 @@ svn_rangelist_merge2(svn_rangelist_t *rangelist,
   SVN_ERR_ASSERT(rangelist_is_sorted(chg));
 #endif
 
+  /* Merging in nothing changes nothing; don't rebuild a (possibly
+     large) rangelist just to find that out. */
+  if (chg->nelts == 0)
+    return SVN_NO_ERROR;
+
   /* Move the original rangelist aside. A shallow copy suffices,
    * as rangelist_merge() won't modify its inputs. */
   rangelist_orig = apr_array_copy(scratch_pool, rangelist);
@@ -1225,6 +1230,54 @@ svn_mergeinfo__set_inheritance(svn_mergeinfo_t mergeinfo,
   return;
 }
 
+/* Return the smallest index into RANGELIST, no smaller than HINT, whose
+   range ends after REV; return RANGELIST->nelts if there is none.
+
+   Uses exponential probing followed by a binary search, so that skipping
+   a long run of irrelevant ranges costs O(log(run length)) while stepping
+   to an adjacent range still costs O(1).  RANGELIST must be canonical:
+   the search relies on range ends increasing monotonically, which merely
+   sorted rangelists do not guarantee. */
+static int
+rangelist_gallop(const svn_rangelist_t *rangelist,
+                 int hint,
+                 svn_revnum_t rev)
+{
+  int lo, hi, step;
+
+  /* Common case: the very next range already qualifies. */
+  if (hint >= rangelist->nelts
+      || APR_ARRAY_IDX(rangelist, hint, svn_merge_range_t *)->end > rev)
+    return hint;
+
+  /* Probe at exponentially growing offsets from HINT until we overshoot
+     the first qualifying range or run off the end of the list.  The
+     range at LO is always known not to qualify. */
+  lo = hint;
+  step = 1;
+  while (lo + step < rangelist->nelts
+         && APR_ARRAY_IDX(rangelist, lo + step,
+                          svn_merge_range_t *)->end <= rev)
+    {
+      lo += step;
+      step *= 2;
+    }
+  hi = MIN(lo + step, rangelist->nelts);
+
+  /* The answer lies in (LO, HI]; binary-search for it. */
+  lo++;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (APR_ARRAY_IDX(rangelist, mid, svn_merge_range_t *)->end <= rev)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
 /* If DO_REMOVE is true, then remove any overlapping ranges described by
    RANGELIST1 from RANGELIST2 and place the results in *OUTPUT.  When
    DO_REMOVE is true, RANGELIST1 is effectively the "eraser" and RANGELIST2
@@ -1268,6 +1321,15 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
   int i1, i2, lasti2;
   svn_merge_range_t working_elt2;
 
+  /* Galloping over non-intersecting runs is only sound on canonical
+     (disjoint) rangelists, where range ends increase monotonically;
+     this function merely requires sorted input, so check up front.
+     Runs of RANGELIST2 must be copied to *OUTPUT when removing, so
+     only gallop over them when intersecting. */
+  svn_boolean_t gallop1 = svn_rangelist__is_canonical(rangelist1);
+  svn_boolean_t gallop2 = !do_remove
+                          && svn_rangelist__is_canonical(rangelist2);
+
   *output = apr_array_make(pool, 1, sizeof(svn_merge_range_t *));
 
   i1 = 0;
@@ -1393,7 +1455,15 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
              need to output the rangelist2 and increment the
              rangelist2.  */
           if (svn_sort_compare_ranges(&elt1, &elt2) < 0)
-            i1++;
+            {
+              /* ELT1 lies entirely before ELT2, so any following
+                 ranges that end before ELT2 starts cannot intersect
+                 it, nor anything after it; skip them in one go. */
+              if (gallop1)
+                i1 = rangelist_gallop(rangelist1, i1 + 1, elt2->start);
+              else
+                i1++;
+            }
           else
             {
               svn_merge_range_t *lastrange;
@@ -1411,7 +1481,13 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
                   lastrange = svn_merge_range_dup(elt2, pool);
                   APR_ARRAY_PUSH(*output, svn_merge_range_t *) = lastrange;
                 }
-              i2++;
+
+              /* When intersecting, ranges that end before ELT1 starts
+                 contribute nothing; skip them in one go. */
+              if (gallop2)
+                i2 = rangelist_gallop(rangelist2, i2 + 1, elt1->start);
+              else
+                i2++;
             }
         }
     }
@@ -55,18 +55,23 @@ typedef struct object_ref_t
    * Will be destroyed when this instance is cleaned up. */
   apr_pool_t *pool;
 
+  /* once this instance got removed from the index, the next removed one
+   * awaiting destruction; see RETIRED_OBJECTS in svn_object_pool__t */
+  struct object_ref_t *next_retired;
+
   /* Number of references to this data struct */
   volatile svn_atomic_t ref_count;
 } object_ref_t;
 
-
-/* Core data structure.  All access to it must be serialized using MUTEX.
+/* An immutable snapshot of the pool's key -> object_ref_t index.
+ *
+ * Readers pick up the current snapshot with a single atomic pointer read
+ * and may then search it without taking any lock because a published
+ * snapshot will never be modified again - writers construct and publish
+ * a new snapshot instead (RCU style).
  */
-struct svn_object_pool__t
+typedef struct index_snapshot_t
 {
-  /* serialization object for all non-atomic data in this struct */
-  svn_mutex__t *mutex;
-
   /* object_ref_t.KEY -> object_ref_t* mapping.
    *
    * In shared object mode, there is at most one such entry per key and it
@@ -75,6 +80,43 @@ struct svn_object_pool__t
    * instances for the key. */
   apr_hash_t *objects;
 
+  /* sub-pool of the object pool's root pool that this snapshot and
+   * OBJECTS got allocated in */
+  apr_pool_t *pool;
+
+  /* once replaced by a newer snapshot, the previously replaced one;
+   * see RETIRED_SNAPSHOTS in svn_object_pool__t */
+  struct index_snapshot_t *next_retired;
+} index_snapshot_t;
+
+
+/* Core data structure.  Writers must be serialized using MUTEX; readers
+ * only use the atomically published SNAPSHOT plus atomic counters.
+ */
+struct svn_object_pool__t
+{
+  /* serialization object for all modifications of this struct */
+  svn_mutex__t *mutex;
+
+  /* the current index_snapshot_t *.  Read via get_snapshot() from any
+   * thread; replaced - never modified - via set_snapshot() under MUTEX. */
+  void *volatile snapshot;
+
+  /* Number of threads currently inside the lock-free lookup fast path.
+   * Retired snapshots and objects may only be destroyed after this has
+   * been observed as 0, see collect_retired(). */
+  volatile svn_atomic_t reader_count;
+
+  /* Snapshots that have been replaced by newer ones but may still be in
+   * use by readers that entered the fast path before the replacement.
+   * Singly linked list through NEXT_RETIRED; only accessed under MUTEX. */
+  index_snapshot_t *retired_snapshots;
+
+  /* Objects removed from the index that may still be reachable through
+   * retired snapshots - or even got handed out by a racing reader.
+   * Singly linked list through NEXT_RETIRED; only accessed under MUTEX. */
+  object_ref_t *retired_objects;
+
   /* same as objects->count but allows for non-sync'ed access */
   volatile svn_atomic_t object_count;
 
@@ -87,6 +129,100 @@ struct svn_object_pool__t
   apr_pool_t *pool;
 };
 
+/* Return the current index snapshot of OBJECT_POOL.  This is the only
+ * way any code may access the index.
+ */
+static index_snapshot_t *
+get_snapshot(svn_object_pool__t *object_pool)
+{
+  return svn_atomic_casptr(&object_pool->snapshot, NULL, NULL);
+}
+
+/* Atomically publish NEW_SNAPSHOT as the current index of OBJECT_POOL
+ * and move the previous snapshot to the retirement list.
+ *
+ * Requires external serialization on OBJECT_POOL.
+ */
+static void
+set_snapshot(svn_object_pool__t *object_pool,
+             index_snapshot_t *new_snapshot)
+{
+  index_snapshot_t *old_snapshot
+    = svn_atomic_xchgptr(&object_pool->snapshot, new_snapshot);
+
+  /* Readers that entered the fast path before the swap may still use
+   * the old snapshot; keep it alive until they all left. */
+  old_snapshot->next_retired = object_pool->retired_snapshots;
+  object_pool->retired_snapshots = old_snapshot;
+}
+
+/* Return a new, yet unpublished index snapshot containing the same
+ * entries as the currently published one.  The caller may freely modify
+ * the result until passing it to set_snapshot().
+ *
+ * Requires external serialization on OBJECT_POOL.
+ */
+static index_snapshot_t *
+create_snapshot(svn_object_pool__t *object_pool)
+{
+  apr_pool_t *subpool = svn_pool_create(object_pool->pool);
+  index_snapshot_t *result = apr_pcalloc(subpool, sizeof(*result));
+
+  result->pool = subpool;
+  result->objects = apr_hash_copy(subpool,
+                                  get_snapshot(object_pool)->objects);
+
+  return result;
+}
+
+/* Destroy all retired snapshots and objects of OBJECT_POOL that can no
+ * longer be reached by any reader.
+ *
+ * Requires external serialization on OBJECT_POOL.
+ */
+static void
+collect_retired(svn_object_pool__t *object_pool)
+{
+  object_ref_t **next;
+
+  /* If READER_COUNT is 0 right now, everybody who entered the fast path
+   * before the respective entries got retired has left it again - and
+   * later readers only ever saw newer snapshots.  If it is not 0, simply
+   * try again upon the next index modification. */
+  if (svn_atomic_read(&object_pool->reader_count) != 0)
+    return;
+
+  while (object_pool->retired_snapshots)
+    {
+      index_snapshot_t *snapshot = object_pool->retired_snapshots;
+      object_pool->retired_snapshots = snapshot->next_retired;
+
+      svn_pool_destroy(snapshot->pool);
+    }
+
+  /* Unlike snapshots, retired objects may have been handed out by a
+   * reader racing with the removal.  Destroy only those that carry no
+   * references; the others remain in the list until released. */
+  next = &object_pool->retired_objects;
+  while (*next)
+    {
+      object_ref_t *object_ref = *next;
+      if (svn_atomic_read(&object_ref->ref_count) == 0)
+        {
+          *next = object_ref->next_retired;
+
+          svn_atomic_dec(&object_pool->object_count);
+          svn_atomic_dec(&object_pool->unused_count);
+
+          svn_pool_destroy(object_ref->pool);
+        }
+      else
+        {
+          next = &object_ref->next_retired;
+        }
+    }
+}
+
 
 /* Pool cleanup function for the whole object pool.
  */
@@ -109,30 +245,30 @@ object_pool_cleanup(void *baton)
 static void
 remove_unused_objects(svn_object_pool__t *object_pool)
 {
-  apr_pool_t *subpool = svn_pool_create(object_pool->pool);
+  index_snapshot_t *snapshot = create_snapshot(object_pool);
 
   /* process all hash buckets */
   apr_hash_index_t *hi;
-  for (hi = apr_hash_first(subpool, object_pool->objects);
+  for (hi = apr_hash_first(snapshot->pool, snapshot->objects);
        hi != NULL;
        hi = apr_hash_next(hi))
     {
       object_ref_t *object_ref = apr_hash_this_val(hi);
 
-      /* note that we won't hand out new references while access
-         to the hash is serialized */
+      /* note that readers of older snapshots may still hand out new
+         references; collect_retired() will notice that */
       if (svn_atomic_read(&object_ref->ref_count) == 0)
         {
-          apr_hash_set(object_pool->objects, object_ref->key.data,
+          apr_hash_set(snapshot->objects, object_ref->key.data,
                        object_ref->key.size, NULL);
-          svn_atomic_dec(&object_pool->object_count);
-          svn_atomic_dec(&object_pool->unused_count);
 
-          svn_pool_destroy(object_ref->pool);
+          object_ref->next_retired = object_pool->retired_objects;
+          object_pool->retired_objects = object_ref;
         }
     }
 
-  svn_pool_destroy(subpool);
+  set_snapshot(object_pool, snapshot);
+  collect_retired(object_pool);
 }
 
 /* Cleanup function called when an object_ref_t gets released.
@@ -161,7 +297,8 @@ object_ref_cleanup(void *baton)
 /* Handle reference counting for the OBJECT_REF that the caller is about
  * to return.  The reference will be released when POOL gets cleaned up.
  *
- * Requires external serialization on OBJECT_REF->OBJECT_POOL.
+ * May be called from the lock-free lookup path; all counter updates
+ * are atomic.
  */
 static void
 add_object_ref(object_ref_t *object_ref,
@@ -179,32 +316,6 @@ add_object_ref(object_ref_t *object_ref,
   apr_pool_pre_cleanup_register(pool, object_ref, object_ref_cleanup);
 }
 
-/* Actual implementation of svn_object_pool__lookup.
- *
- * Requires external serialization on OBJECT_POOL.
- */
-static svn_error_t *
-lookup(void **object,
-       svn_object_pool__t *object_pool,
-       svn_membuf_t *key,
-       apr_pool_t *result_pool)
-{
-  object_ref_t *object_ref
-    = apr_hash_get(object_pool->objects, key->data, key->size);
-
-  if (object_ref)
-    {
-      *object = object_ref->object;
-      add_object_ref(object_ref, result_pool);
-    }
-  else
-    {
-      *object = NULL;
-    }
-
-  return SVN_NO_ERROR;
-}
-
 /* Actual implementation of svn_object_pool__insert.
  *
  * Requires external serialization on OBJECT_POOL.
@@ -218,7 +329,8 @@ insert(void **object,
        apr_pool_t *result_pool)
 {
   object_ref_t *object_ref
-    = apr_hash_get(object_pool->objects, key->data, key->size);
+    = apr_hash_get(get_snapshot(object_pool)->objects, key->data,
+                   key->size);
   if (object_ref)
     {
       /* Destroy the new one and return a reference to the existing one
@@ -228,6 +340,8 @@ insert(void **object,
     }
   else
     {
+      index_snapshot_t *snapshot = create_snapshot(object_pool);
+
       /* add new index entry */
       object_ref = apr_pcalloc(item_pool, sizeof(*object_ref));
       object_ref->object_pool = object_pool;
@@ -238,7 +352,7 @@ insert(void **object,
       object_ref->key.size = key->size;
       memcpy(object_ref->key.data, key->data, key->size);
 
-      apr_hash_set(object_pool->objects, object_ref->key.data,
+      apr_hash_set(snapshot->objects, object_ref->key.data,
                    object_ref->key.size, object_ref);
       svn_atomic_inc(&object_pool->object_count);
 
@@ -246,6 +360,8 @@ insert(void **object,
        * add_object_ref will update counters again.
        */
       svn_atomic_inc(&object_ref->object_pool->unused_count);
+
+      set_snapshot(object_pool, snapshot);
     }
 
   /* return a reference to the object we just added */
@@ -254,8 +370,10 @@ insert(void **object,
 
   /* limit memory usage */
   if (svn_atomic_read(&object_pool->unused_count) * 2
-      > apr_hash_count(object_pool->objects) + 2)
+      > apr_hash_count(get_snapshot(object_pool)->objects) + 2)
     remove_unused_objects(object_pool);
+  else
+    collect_retired(object_pool);
 
   return SVN_NO_ERROR;
 }
@@ -277,7 +395,18 @@ svn_object_pool__create(svn_object_pool__t **object_pool,
   SVN_ERR(svn_mutex__init(&result->mutex, thread_safe, pool));
 
   result->pool = pool;
-  result->objects = svn_hash__make(result->pool);
+
+  /* set up the initial, empty index snapshot.  No need for atomics here
+   * since nobody else can see the object pool, yet. */
+  {
+    apr_pool_t *subpool = svn_pool_create(pool);
+    index_snapshot_t *snapshot = apr_pcalloc(subpool, sizeof(*snapshot));
+
+    snapshot->pool = subpool;
+    snapshot->objects = svn_hash__make(subpool);
+
+    result->snapshot = snapshot;
+  }
 
   /* make sure we clean up nicely.
    * We need two cleanup functions of which exactly one will be run
@@ -305,9 +434,27 @@ svn_object_pool__lookup(void **object,
                         svn_membuf_t *key,
                         apr_pool_t *result_pool)
 {
+  object_ref_t *object_ref;
+
   *object = NULL;
-  SVN_MUTEX__WITH_LOCK(object_pool->mutex,
-                       lookup(object, object_pool, key, result_pool));
+
+  /* Lock-free fast path:  writers never modify a published snapshot,
+   * so we only need to announce ourselves to keep the snapshot - and
+   * anything we may find in it - from being destroyed under us.  The
+   * counter updates are full barriers, i.e. a writer that read the
+   * counter as 0 knows that we will see the new snapshot. */
+  svn_atomic_inc(&object_pool->reader_count);
+
+  object_ref = apr_hash_get(get_snapshot(object_pool)->objects,
+                            key->data, key->size);
+  if (object_ref)
+    {
+      *object = object_ref->object;
+      add_object_ref(object_ref, result_pool);
+    }
+
+  svn_atomic_dec(&object_pool->reader_count);
+
   return SVN_NO_ERROR;
 }
 
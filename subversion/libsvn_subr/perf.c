@@ -0,0 +1,211 @@
+/*
+ * perf.c :  lightweight hot-path performance counters
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <apr_strings.h>
+
+#include "svn_pools.h"
+#include "svn_string.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_perf_private.h"
+
+#include "svn_private_config.h"
+
+/* Whether the SVN_PERF environment variable was set. */
+static svn_boolean_t perf_enabled = FALSE;
+
+/* Global pool that the counters and their names are allocated in.
+ * Only used when PERF_ENABLED is set. */
+static apr_pool_t *perf_pool;
+
+/* Protects counter registration (not the counter updates themselves). */
+static svn_mutex__t *perf_mutex = NULL;
+
+/* Head of the counter list, newest first.  Entries are never removed,
+ * so readers may walk this list without taking PERF_MUTEX. */
+static svn_perf__counter_t *counters = NULL;
+
+static volatile svn_atomic_t init_status = 0;
+
+static void dump_at_exit(void);
+
+/* Implements svn_atomic__init_once's init_func signature. */
+static svn_error_t *
+atomic_init_func(void *baton,
+                 apr_pool_t *pool)
+{
+  perf_enabled = (getenv("SVN_PERF") != NULL);
+  if (perf_enabled)
+    {
+      perf_pool = svn_pool_create(NULL);
+      SVN_ERR(svn_mutex__init(&perf_mutex, TRUE, perf_pool));
+
+      atexit(dump_at_exit);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static void
+ensure_initialized(void)
+{
+  svn_error_clear(svn_atomic__init_once(&init_status, atomic_init_func,
+                                        NULL, NULL));
+}
+
+svn_boolean_t
+svn_perf__is_enabled(void)
+{
+  ensure_initialized();
+  return perf_enabled;
+}
+
+/* Set *RESULT to the counter registered as NAME, creating it if there
+ * is none yet.  To be called with PERF_MUTEX held. */
+static svn_error_t *
+get_counter_internal(svn_perf__counter_t **result,
+                     const char *name)
+{
+  svn_perf__counter_t *c;
+
+  for (c = counters; c; c = c->next)
+    if (strcmp(c->name, name) == 0)
+      break;
+
+  if (!c)
+    {
+      c = apr_pcalloc(perf_pool, sizeof(*c));
+      c->name = apr_pstrdup(perf_pool, name);
+      c->next = counters;
+      counters = c;
+    }
+
+  *result = c;
+  return SVN_NO_ERROR;
+}
+
+/* If *COUNTER has not been resolved yet, look up or register the
+ * counter named NAME and cache it in *COUNTER. */
+static void
+resolve_counter(svn_perf__counter_t **counter,
+                const char *name)
+{
+  if (*counter == NULL)
+    svn_error_clear(svn_mutex__lock(perf_mutex));
+  else
+    return;
+
+  /* Racing registrations of the same NAME resolve to the same object. */
+  svn_error_clear(get_counter_internal(counter, name));
+  svn_error_clear(svn_mutex__unlock(perf_mutex, SVN_NO_ERROR));
+}
+
+apr_time_t
+svn_perf__start(void)
+{
+  return svn_perf__is_enabled() ? apr_time_now() : 0;
+}
+
+void
+svn_perf__stop(svn_perf__counter_t **counter,
+               const char *name,
+               apr_time_t start)
+{
+  svn_perf__stop2(counter, name, start, 0);
+}
+
+void
+svn_perf__stop2(svn_perf__counter_t **counter,
+                const char *name,
+                apr_time_t start,
+                apr_uint64_t units)
+{
+  apr_uint64_t elapsed;
+
+  if (start == 0)
+    return;
+
+  elapsed = apr_time_now() - start;
+
+  resolve_counter(counter, name);
+  (*counter)->count++;
+  (*counter)->usecs += elapsed;
+  if (elapsed > (*counter)->max_usecs)
+    (*counter)->max_usecs = elapsed;
+  (*counter)->units += units;
+}
+
+void
+svn_perf__count(svn_perf__counter_t **counter,
+                const char *name)
+{
+  if (!svn_perf__is_enabled())
+    return;
+
+  resolve_counter(counter, name);
+  (*counter)->count++;
+}
+
+svn_error_t *
+svn_perf__write_report(svn_stream_t *stream,
+                       apr_pool_t *scratch_pool)
+{
+  const svn_perf__counter_t *c;
+
+  SVN_ERR(svn_stream_printf(stream, scratch_pool,
+                            "%12s %14s %10s %12s  %s\n",
+                            _("count"), _("seconds"), _("max"),
+                            _("units"), _("counter")));
+  for (c = counters; c; c = c->next)
+    SVN_ERR(svn_stream_printf(stream, scratch_pool,
+                              "%12" APR_UINT64_T_FMT " %14.6f %10.6f"
+                              " %12" APR_UINT64_T_FMT "  %s\n",
+                              c->count, c->usecs / 1.0e6,
+                              c->max_usecs / 1.0e6, c->units, c->name));
+
+  return SVN_NO_ERROR;
+}
+
+/* Write the final report to stderr.  Runs at process exit, so only
+ * stdio may be used here. */
+static void
+dump_at_exit(void)
+{
+  const svn_perf__counter_t *c;
+
+  if (!counters)
+    return;
+
+  fprintf(stderr, "\n%12s %14s %10s %12s  %s\n",
+          "count", "seconds", "max", "units", "counter");
+  for (c = counters; c; c = c->next)
+    fprintf(stderr,
+            "%12" APR_UINT64_T_FMT " %14.6f %10.6f %12" APR_UINT64_T_FMT
+            "  %s\n",
+            c->count, c->usecs / 1.0e6, c->max_usecs / 1.0e6, c->units,
+            c->name);
+}
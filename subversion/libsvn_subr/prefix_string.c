@@ -21,6 +21,9 @@
  */
 
 #include <assert.h>
+
+#include <apr_hash.h>
+
 #include "private/svn_string_private.h"
 
 /* A node in the tree represents a common prefix.  The root node is the
@@ -340,3 +343,51 @@ svn_prefix_string__compare(const svn_prefix_string__t *lhs,
   /* at the common root, strings will differ in the first follow-up char */
   return (int)(unsigned char)lhs->data[0] - (int)(unsigned char)rhs->data[0];
 }
+
+/* The prefix tree acts as the deduplicating index:  equal strings map to
+ * the same svn_prefix_string__t.  Since users want plain C strings, we
+ * keep one expanded copy per distinct value, found through EXPANDED.
+ */
+struct svn_prefix_interner__t
+{
+  /* deduplicating index over all strings interned so far */
+  svn_prefix_tree__t *tree;
+
+  /* svn_prefix_string__t * (as key bytes) -> expanded const char *.
+   * Entries are never removed. */
+  apr_hash_t *expanded;
+
+  /* the pool that this structure and all interned strings live in */
+  apr_pool_t *pool;
+};
+
+svn_prefix_interner__t *
+svn_prefix_interner__create(apr_pool_t *pool)
+{
+  svn_prefix_interner__t *result = apr_pcalloc(pool, sizeof(*result));
+  result->tree = svn_prefix_tree__create(pool);
+  result->expanded = apr_hash_make(pool);
+  result->pool = pool;
+
+  return result;
+}
+
+const char *
+svn_prefix_interner__intern(svn_prefix_interner__t *interner,
+                            const char *s)
+{
+  svn_prefix_string__t *string = svn_prefix_string__create(interner->tree,
+                                                           s);
+  const char *result = apr_hash_get(interner->expanded, &string,
+                                    sizeof(string));
+
+  if (result == NULL)
+    {
+      result = svn_prefix_string__expand(string, interner->pool)->data;
+      apr_hash_set(interner->expanded,
+                   apr_pmemdup(interner->pool, &string, sizeof(string)),
+                   sizeof(string), (void *)result);
+    }
+
+  return result;
+}
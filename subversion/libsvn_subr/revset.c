@@ -0,0 +1,810 @@
+/*
+ * revset.c :  implement a compressed revision number set
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "svn_mergeinfo.h"
+#include "svn_pools.h"
+
+#include "private/svn_mergeinfo_private.h"
+
+/* Number of consecutive revisions covered by a single container.
+ * Offsets within a container must fit into 16 bits. */
+#define CONTAINER_SIZE 0x10000
+
+/* Number of 64 bit words in a bitmap container. */
+#define BITMAP_WORDS (CONTAINER_SIZE / 64)
+
+/* Containers with up to this many elements use the sorted offset array
+ * representation; larger containers use the packed bitmap.  At this
+ * threshold, both representations are 8kB in size. */
+#define ARRAY_MAX_CARDINALITY 4096
+
+/* A single container, covering the revisions
+ * [KEY * CONTAINER_SIZE, (KEY + 1) * CONTAINER_SIZE).
+ *
+ * Exactly one of VALUES and BITS is non-NULL and determines the current
+ * representation.  Conceptually, a container is a set of 16 bit offsets
+ * relative to KEY * CONTAINER_SIZE.
+ */
+typedef struct container_t
+{
+  /* Revision number of the first offset, divided by CONTAINER_SIZE. */
+  svn_revnum_t key;
+
+  /* Number of revisions in this container. */
+  apr_uint32_t cardinality;
+
+  /* CARDINALITY offsets in strictly ascending order,
+   * or NULL if this container uses the bitmap representation. */
+  apr_uint16_t *values;
+
+  /* Number of entries allocated to VALUES. */
+  apr_uint32_t capacity;
+
+  /* BITMAP_WORDS words of offset bits,
+   * or NULL if this container uses the array representation. */
+  apr_uint64_t *bits;
+} container_t;
+
+struct svn_revset__t
+{
+  /* The containers (stored by value), in strictly ascending KEY order.
+   * Empty containers may only appear transiently while adding ranges. */
+  apr_array_header_t *containers;
+
+  /* Allocate the containers and their contents from this pool. */
+  apr_pool_t *pool;
+};
+
+/* Return the number of bits set in V. */
+static apr_uint32_t
+popcount64(apr_uint64_t v)
+{
+  v = v - ((v >> 1) & APR_UINT64_C(0x5555555555555555));
+  v = (v & APR_UINT64_C(0x3333333333333333))
+    + ((v >> 2) & APR_UINT64_C(0x3333333333333333));
+  v = (v + (v >> 4)) & APR_UINT64_C(0x0f0f0f0f0f0f0f0f);
+
+  return (apr_uint32_t)((v * APR_UINT64_C(0x0101010101010101)) >> 56);
+}
+
+/* Return whether bit IDX is set in BITS. */
+static svn_boolean_t
+bitmap_get(const apr_uint64_t *bits,
+           apr_uint32_t idx)
+{
+  return (bits[idx / 64] >> (idx % 64)) & 1;
+}
+
+/* Return the index of the first entry in VALUES (containing COUNT sorted
+ * entries) that is not smaller than VALUE.  Returns COUNT if no such
+ * entry exists.  VALUE may be as large as CONTAINER_SIZE. */
+static apr_uint32_t
+array_lower_bound(const apr_uint16_t *values,
+                  apr_uint32_t count,
+                  apr_uint32_t value)
+{
+  apr_uint32_t lo = 0, hi = count;
+  while (lo < hi)
+    {
+      apr_uint32_t mid = (lo + hi) / 2;
+      if (values[mid] < value)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/* Make sure CONTAINER's offset array can hold at least CAPACITY entries,
+ * reallocating it from POOL as necessary. */
+static void
+array_reserve(container_t *container,
+              apr_uint32_t capacity,
+              apr_pool_t *pool)
+{
+  apr_uint16_t *new_values;
+  apr_uint32_t new_capacity = container->capacity ? container->capacity : 16;
+
+  if (capacity <= container->capacity)
+    return;
+
+  while (new_capacity < capacity)
+    new_capacity *= 2;
+
+  new_values = apr_palloc(pool, new_capacity * sizeof(*new_values));
+  if (container->cardinality)
+    memcpy(new_values, container->values,
+           container->cardinality * sizeof(*new_values));
+
+  container->values = new_values;
+  container->capacity = new_capacity;
+}
+
+/* Switch CONTAINER from the array to the bitmap representation,
+ * allocating the bitmap from POOL. */
+static void
+container_to_bitmap(container_t *container,
+                    apr_pool_t *pool)
+{
+  apr_uint64_t *bits = apr_pcalloc(pool, BITMAP_WORDS * sizeof(*bits));
+  apr_uint32_t i;
+
+  for (i = 0; i < container->cardinality; ++i)
+    bits[container->values[i] / 64]
+      |= APR_UINT64_C(1) << (container->values[i] % 64);
+
+  container->bits = bits;
+  container->values = NULL;
+  container->capacity = 0;
+}
+
+/* Switch CONTAINER from the bitmap to the array representation,
+ * allocating the offset array from POOL.  The container's cardinality
+ * must not exceed ARRAY_MAX_CARDINALITY. */
+static void
+container_to_array(container_t *container,
+                   apr_pool_t *pool)
+{
+  apr_uint16_t *values
+    = apr_palloc(pool, container->cardinality * sizeof(*values));
+  apr_uint32_t word, count = 0;
+
+  for (word = 0; word < BITMAP_WORDS; ++word)
+    {
+      apr_uint64_t w = container->bits[word];
+      apr_uint32_t bit;
+
+      if (w == 0)
+        continue;
+
+      for (bit = 0; bit < 64; ++bit)
+        if ((w >> bit) & 1)
+          values[count++] = (apr_uint16_t)(word * 64 + bit);
+    }
+
+  container->values = values;
+  container->capacity = container->cardinality;
+  container->bits = NULL;
+}
+
+/* If CONTAINER uses the bitmap representation but has become sparse,
+ * switch it back to the more compact array representation. */
+static void
+container_normalize(container_t *container,
+                    apr_pool_t *pool)
+{
+  if (container->bits && container->cardinality <= ARRAY_MAX_CARDINALITY)
+    container_to_array(container, pool);
+}
+
+/* Set the offset bits LO through HI (both inclusive) in the bitmap
+ * CONTAINER, updating its cardinality. */
+static void
+bitmap_set_range(container_t *container,
+                 apr_uint32_t lo,
+                 apr_uint32_t hi)
+{
+  apr_uint32_t word;
+  for (word = lo / 64; word <= hi / 64; ++word)
+    {
+      apr_uint64_t mask = ~APR_UINT64_C(0);
+      apr_uint64_t old = container->bits[word];
+
+      if (word == lo / 64)
+        mask &= ~APR_UINT64_C(0) << (lo % 64);
+      if (word == hi / 64)
+        mask &= ~APR_UINT64_C(0) >> (63 - hi % 64);
+
+      container->bits[word] = old | mask;
+      container->cardinality += popcount64((old | mask) ^ old);
+    }
+}
+
+/* Add the offsets LO through HI (both inclusive) to CONTAINER, switching
+ * it to the bitmap representation if the array would grow too large.
+ * Allocate memory from POOL. */
+static void
+container_add_range(container_t *container,
+                    apr_uint32_t lo,
+                    apr_uint32_t hi,
+                    apr_pool_t *pool)
+{
+  apr_uint32_t count = hi - lo + 1;
+  apr_uint32_t i, k, existing, new_cardinality;
+
+  if (container->bits)
+    {
+      bitmap_set_range(container, lo, hi);
+      return;
+    }
+
+  /* Determine the range of existing entries that the new ones replace. */
+  i = array_lower_bound(container->values, container->cardinality, lo);
+  k = array_lower_bound(container->values, container->cardinality, hi + 1);
+  existing = k - i;
+  new_cardinality = container->cardinality + count - existing;
+
+  if (new_cardinality > ARRAY_MAX_CARDINALITY)
+    {
+      container_to_bitmap(container, pool);
+      bitmap_set_range(container, lo, hi);
+      return;
+    }
+
+  array_reserve(container, new_cardinality, pool);
+  memmove(container->values + i + count, container->values + k,
+          (container->cardinality - k) * sizeof(*container->values));
+  for (k = 0; k < count; ++k)
+    container->values[i + k] = (apr_uint16_t)(lo + k);
+
+  container->cardinality = new_cardinality;
+}
+
+/* Return the container for KEY in SET, or NULL if SET contains no
+ * revisions in that key range. */
+static container_t *
+find_container(const svn_revset__t *set,
+               svn_revnum_t key)
+{
+  int lo = 0, hi = set->containers->nelts;
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      container_t *container
+        = &APR_ARRAY_IDX(set->containers, mid, container_t);
+
+      if (container->key < key)
+        lo = mid + 1;
+      else if (container->key > key)
+        hi = mid;
+      else
+        return container;
+    }
+
+  return NULL;
+}
+
+/* Return the container for KEY in SET, creating an empty one at the
+ * right position if necessary. */
+static container_t *
+get_container(svn_revset__t *set,
+              svn_revnum_t key)
+{
+  container_t new_container = { 0 };
+  container_t *container;
+  int idx;
+
+  /* Fast path: ranges tend to be added in ascending order, i.e. to the
+   * last container or past it. */
+  if (set->containers->nelts)
+    {
+      container = &APR_ARRAY_IDX(set->containers,
+                                 set->containers->nelts - 1, container_t);
+      if (container->key == key)
+        return container;
+    }
+
+  if (   set->containers->nelts == 0
+      || APR_ARRAY_IDX(set->containers, set->containers->nelts - 1,
+                       container_t).key < key)
+    {
+      idx = set->containers->nelts;
+    }
+  else
+    {
+      container = find_container(set, key);
+      if (container)
+        return container;
+
+      /* Find the insertion position. */
+      for (idx = 0; idx < set->containers->nelts; ++idx)
+        if (APR_ARRAY_IDX(set->containers, idx, container_t).key > key)
+          break;
+    }
+
+  /* Insert an empty array container at IDX. */
+  new_container.key = key;
+  apr_array_push(set->containers);
+  memmove(&APR_ARRAY_IDX(set->containers, idx + 1, container_t),
+          &APR_ARRAY_IDX(set->containers, idx, container_t),
+          (set->containers->nelts - 1 - idx) * sizeof(container_t));
+  APR_ARRAY_IDX(set->containers, idx, container_t) = new_container;
+
+  return &APR_ARRAY_IDX(set->containers, idx, container_t);
+}
+
+/* Return a deep copy of CONTAINER, allocated in POOL. */
+static container_t
+copy_container(const container_t *container,
+               apr_pool_t *pool)
+{
+  container_t result = *container;
+  if (container->bits)
+    {
+      result.bits = apr_pmemdup(pool, container->bits,
+                                BITMAP_WORDS * sizeof(*result.bits));
+    }
+  else
+    {
+      result.values = apr_pmemdup(pool, container->values,
+                                  container->cardinality
+                                    * sizeof(*result.values));
+      result.capacity = container->cardinality;
+    }
+
+  return result;
+}
+
+svn_revset__t *
+svn_revset__create(apr_pool_t *result_pool)
+{
+  svn_revset__t *set = apr_pcalloc(result_pool, sizeof(*set));
+  set->containers = apr_array_make(result_pool, 16, sizeof(container_t));
+  set->pool = result_pool;
+
+  return set;
+}
+
+void
+svn_revset__add_range(svn_revset__t *set,
+                      svn_revnum_t first,
+                      svn_revnum_t last)
+{
+  assert(first > 0 && first <= last);
+
+  while (first <= last)
+    {
+      svn_revnum_t key = first / CONTAINER_SIZE;
+      svn_revnum_t container_last = (key + 1) * CONTAINER_SIZE - 1;
+      apr_uint32_t lo = (apr_uint32_t)(first % CONTAINER_SIZE);
+      apr_uint32_t hi = (apr_uint32_t)(  (last < container_last ? last
+                                                                : container_last)
+                                       % CONTAINER_SIZE);
+
+      container_add_range(get_container(set, key), lo, hi, set->pool);
+      first = container_last + 1;
+    }
+}
+
+void
+svn_revset__add_rangelist(svn_revset__t *set,
+                          const svn_rangelist_t *rangelist)
+{
+  int i;
+  for (i = 0; i < rangelist->nelts; ++i)
+    {
+      const svn_merge_range_t *range
+        = APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+
+      /* A rangelist entry (START, END] covers START+1 through END. */
+      svn_revset__add_range(set, range->start + 1, range->end);
+    }
+}
+
+svn_boolean_t
+svn_revset__contains(const svn_revset__t *set,
+                     svn_revnum_t revision)
+{
+  const container_t *container;
+  apr_uint32_t offset;
+  apr_uint32_t idx;
+
+  if (revision <= 0)
+    return FALSE;
+
+  container = find_container(set, revision / CONTAINER_SIZE);
+  offset = (apr_uint32_t)(revision % CONTAINER_SIZE);
+  if (container == NULL)
+    return FALSE;
+
+  if (container->bits)
+    return bitmap_get(container->bits, offset);
+
+  idx = array_lower_bound(container->values, container->cardinality, offset);
+  return idx < container->cardinality && container->values[idx] == offset;
+}
+
+/* Return the union of the equal-key containers LHS and RHS, allocated
+ * in POOL. */
+static container_t
+union_containers(const container_t *lhs,
+                 const container_t *rhs,
+                 apr_pool_t *pool)
+{
+  container_t result = { 0 };
+  result.key = lhs->key;
+
+  if (lhs->bits == NULL && rhs->bits == NULL)
+    {
+      /* Merge the two sorted offset arrays. */
+      apr_uint32_t i = 0, k = 0;
+
+      array_reserve(&result, lhs->cardinality + rhs->cardinality, pool);
+      while (i < lhs->cardinality || k < rhs->cardinality)
+        {
+          apr_uint16_t value;
+          if (   k == rhs->cardinality
+              || (i < lhs->cardinality && lhs->values[i] < rhs->values[k]))
+            {
+              value = lhs->values[i++];
+            }
+          else
+            {
+              if (   i < lhs->cardinality
+                  && lhs->values[i] == rhs->values[k])
+                ++i;
+              value = rhs->values[k++];
+            }
+
+          result.values[result.cardinality++] = value;
+        }
+
+      if (result.cardinality > ARRAY_MAX_CARDINALITY)
+        container_to_bitmap(&result, pool);
+    }
+  else
+    {
+      /* At least one bitmap involved -> produce a bitmap. */
+      const container_t *other = lhs->bits ? rhs : lhs;
+      apr_uint32_t i;
+
+      result.bits = apr_pmemdup(pool, lhs->bits ? lhs->bits : rhs->bits,
+                                BITMAP_WORDS * sizeof(*result.bits));
+      if (other->bits)
+        for (i = 0; i < BITMAP_WORDS; ++i)
+          result.bits[i] |= other->bits[i];
+      else
+        for (i = 0; i < other->cardinality; ++i)
+          result.bits[other->values[i] / 64]
+            |= APR_UINT64_C(1) << (other->values[i] % 64);
+
+      for (i = 0; i < BITMAP_WORDS; ++i)
+        result.cardinality += popcount64(result.bits[i]);
+
+      container_normalize(&result, pool);
+    }
+
+  return result;
+}
+
+/* Return the intersection of the equal-key containers LHS and RHS,
+ * allocated in POOL.  The result may be empty. */
+static container_t
+intersect_containers(const container_t *lhs,
+                     const container_t *rhs,
+                     apr_pool_t *pool)
+{
+  container_t result = { 0 };
+  apr_uint32_t i, k;
+
+  result.key = lhs->key;
+
+  if (lhs->bits && rhs->bits)
+    {
+      result.bits = apr_palloc(pool, BITMAP_WORDS * sizeof(*result.bits));
+      for (i = 0; i < BITMAP_WORDS; ++i)
+        {
+          result.bits[i] = lhs->bits[i] & rhs->bits[i];
+          result.cardinality += popcount64(result.bits[i]);
+        }
+
+      container_normalize(&result, pool);
+    }
+  else
+    {
+      /* At least one side is an array; scan the smaller array side and
+       * keep the offsets contained in the other container. */
+      const container_t *array = lhs->bits ? rhs : lhs;
+      const container_t *other = lhs->bits ? lhs : rhs;
+      if (other->bits == NULL && other->cardinality < array->cardinality)
+        {
+          const container_t *t = array;
+          array = other;
+          other = t;
+        }
+
+      array_reserve(&result, array->cardinality, pool);
+      if (other->bits)
+        {
+          for (i = 0; i < array->cardinality; ++i)
+            if (bitmap_get(other->bits, array->values[i]))
+              result.values[result.cardinality++] = array->values[i];
+        }
+      else
+        {
+          for (i = 0, k = 0; i < array->cardinality; ++i)
+            {
+              while (   k < other->cardinality
+                     && other->values[k] < array->values[i])
+                ++k;
+              if (   k < other->cardinality
+                  && other->values[k] == array->values[i])
+                result.values[result.cardinality++] = array->values[i];
+            }
+        }
+    }
+
+  return result;
+}
+
+/* Return the difference LHS minus RHS of the equal-key containers LHS
+ * and RHS, allocated in POOL.  The result may be empty. */
+static container_t
+minus_containers(const container_t *lhs,
+                 const container_t *rhs,
+                 apr_pool_t *pool)
+{
+  container_t result = { 0 };
+  apr_uint32_t i, k;
+
+  result.key = lhs->key;
+
+  if (lhs->bits)
+    {
+      result.bits = apr_pmemdup(pool, lhs->bits,
+                                BITMAP_WORDS * sizeof(*result.bits));
+      if (rhs->bits)
+        for (i = 0; i < BITMAP_WORDS; ++i)
+          result.bits[i] &= ~rhs->bits[i];
+      else
+        for (i = 0; i < rhs->cardinality; ++i)
+          result.bits[rhs->values[i] / 64]
+            &= ~(APR_UINT64_C(1) << (rhs->values[i] % 64));
+
+      for (i = 0; i < BITMAP_WORDS; ++i)
+        result.cardinality += popcount64(result.bits[i]);
+
+      container_normalize(&result, pool);
+    }
+  else
+    {
+      array_reserve(&result, lhs->cardinality, pool);
+      if (rhs->bits)
+        {
+          for (i = 0; i < lhs->cardinality; ++i)
+            if (!bitmap_get(rhs->bits, lhs->values[i]))
+              result.values[result.cardinality++] = lhs->values[i];
+        }
+      else
+        {
+          for (i = 0, k = 0; i < lhs->cardinality; ++i)
+            {
+              while (   k < rhs->cardinality
+                     && rhs->values[k] < lhs->values[i])
+                ++k;
+              if (   k == rhs->cardinality
+                  || rhs->values[k] != lhs->values[i])
+                result.values[result.cardinality++] = lhs->values[i];
+            }
+        }
+    }
+
+  return result;
+}
+
+svn_revset__t *
+svn_revset__union(const svn_revset__t *lhs,
+                  const svn_revset__t *rhs,
+                  apr_pool_t *result_pool)
+{
+  svn_revset__t *result = svn_revset__create(result_pool);
+  int i = 0, k = 0;
+
+  while (i < lhs->containers->nelts || k < rhs->containers->nelts)
+    {
+      const container_t *left = i < lhs->containers->nelts
+        ? &APR_ARRAY_IDX(lhs->containers, i, container_t) : NULL;
+      const container_t *right = k < rhs->containers->nelts
+        ? &APR_ARRAY_IDX(rhs->containers, k, container_t) : NULL;
+
+      if (right == NULL || (left && left->key < right->key))
+        {
+          APR_ARRAY_PUSH(result->containers, container_t)
+            = copy_container(left, result_pool);
+          ++i;
+        }
+      else if (left == NULL || left->key > right->key)
+        {
+          APR_ARRAY_PUSH(result->containers, container_t)
+            = copy_container(right, result_pool);
+          ++k;
+        }
+      else
+        {
+          APR_ARRAY_PUSH(result->containers, container_t)
+            = union_containers(left, right, result_pool);
+          ++i;
+          ++k;
+        }
+    }
+
+  return result;
+}
+
+svn_revset__t *
+svn_revset__intersect(const svn_revset__t *lhs,
+                      const svn_revset__t *rhs,
+                      apr_pool_t *result_pool)
+{
+  svn_revset__t *result = svn_revset__create(result_pool);
+  int i = 0, k = 0;
+
+  while (i < lhs->containers->nelts && k < rhs->containers->nelts)
+    {
+      const container_t *left
+        = &APR_ARRAY_IDX(lhs->containers, i, container_t);
+      const container_t *right
+        = &APR_ARRAY_IDX(rhs->containers, k, container_t);
+
+      if (left->key < right->key)
+        {
+          ++i;
+        }
+      else if (left->key > right->key)
+        {
+          ++k;
+        }
+      else
+        {
+          container_t intersection
+            = intersect_containers(left, right, result_pool);
+          if (intersection.cardinality)
+            APR_ARRAY_PUSH(result->containers, container_t) = intersection;
+          ++i;
+          ++k;
+        }
+    }
+
+  return result;
+}
+
+svn_revset__t *
+svn_revset__minus(const svn_revset__t *lhs,
+                  const svn_revset__t *rhs,
+                  apr_pool_t *result_pool)
+{
+  svn_revset__t *result = svn_revset__create(result_pool);
+  int i, k = 0;
+
+  for (i = 0; i < lhs->containers->nelts; ++i)
+    {
+      const container_t *left
+        = &APR_ARRAY_IDX(lhs->containers, i, container_t);
+      const container_t *right = NULL;
+
+      while (   k < rhs->containers->nelts
+             && APR_ARRAY_IDX(rhs->containers, k, container_t).key
+                < left->key)
+        ++k;
+      if (   k < rhs->containers->nelts
+          && APR_ARRAY_IDX(rhs->containers, k, container_t).key
+             == left->key)
+        right = &APR_ARRAY_IDX(rhs->containers, k, container_t);
+
+      if (right == NULL)
+        {
+          APR_ARRAY_PUSH(result->containers, container_t)
+            = copy_container(left, result_pool);
+        }
+      else
+        {
+          container_t difference
+            = minus_containers(left, right, result_pool);
+          if (difference.cardinality)
+            APR_ARRAY_PUSH(result->containers, container_t) = difference;
+        }
+    }
+
+  return result;
+}
+
+/* Extend the run of consecutive revisions ending at *RUN_LAST by REVISION,
+ * if possible.  Otherwise, append the completed run to RANGELIST as a
+ * merge range with the given INHERITABLE flag, allocated in RESULT_POOL,
+ * and start a new run.  *RUN_FIRST must be SVN_INVALID_REVNUM as long as
+ * no run has been started, yet. */
+static void
+extend_run(svn_rangelist_t *rangelist,
+           svn_revnum_t *run_first,
+           svn_revnum_t *run_last,
+           svn_revnum_t revision,
+           svn_boolean_t inheritable,
+           apr_pool_t *result_pool)
+{
+  if (*run_first != SVN_INVALID_REVNUM && revision == *run_last + 1)
+    {
+      *run_last = revision;
+      return;
+    }
+
+  if (*run_first != SVN_INVALID_REVNUM)
+    {
+      svn_merge_range_t *range = apr_palloc(result_pool, sizeof(*range));
+      range->start = *run_first - 1;
+      range->end = *run_last;
+      range->inheritable = inheritable;
+
+      APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = range;
+    }
+
+  *run_first = revision;
+  *run_last = revision;
+}
+
+svn_rangelist_t *
+svn_revset__to_rangelist(const svn_revset__t *set,
+                         svn_boolean_t inheritable,
+                         apr_pool_t *result_pool)
+{
+  svn_rangelist_t *rangelist
+    = apr_array_make(result_pool, set->containers->nelts,
+                     sizeof(svn_merge_range_t *));
+  svn_revnum_t run_first = SVN_INVALID_REVNUM;
+  svn_revnum_t run_last = SVN_INVALID_REVNUM;
+  int i;
+
+  for (i = 0; i < set->containers->nelts; ++i)
+    {
+      const container_t *container
+        = &APR_ARRAY_IDX(set->containers, i, container_t);
+      svn_revnum_t base = container->key * CONTAINER_SIZE;
+      apr_uint32_t k;
+
+      if (container->bits)
+        {
+          apr_uint32_t word;
+          for (word = 0; word < BITMAP_WORDS; ++word)
+            {
+              apr_uint64_t w = container->bits[word];
+              apr_uint32_t bit;
+
+              if (w == 0)
+                continue;
+
+              for (bit = 0; bit < 64; ++bit)
+                if ((w >> bit) & 1)
+                  extend_run(rangelist, &run_first, &run_last,
+                             base + word * 64 + bit, inheritable,
+                             result_pool);
+            }
+        }
+      else
+        {
+          for (k = 0; k < container->cardinality; ++k)
+            extend_run(rangelist, &run_first, &run_last,
+                       base + container->values[k], inheritable,
+                       result_pool);
+        }
+    }
+
+  /* Flush the last run, if any. */
+  if (run_first != SVN_INVALID_REVNUM)
+    extend_run(rangelist, &run_first, &run_last, SVN_INVALID_REVNUM,
+               inheritable, result_pool);
+
+  return rangelist;
+}
@@ -21,14 +21,31 @@
  * ====================================================================
  */
 
+#include <stdlib.h>
+
+#include <apr_thread_proc.h>
+
 #include "svn_pools.h"
 
 #include "private/svn_subr_private.h"
 #include "private/svn_mutex.h"
 
+/* Number of unused root pools that a single thread may cache privately
+ * in its magazine, i.e. without any synchronization.
+ */
+#define MAGAZINE_SIZE 4
+
+/* Maximum number of unused root pools cached in the shared depot.
+ * Pools released beyond this limit get destroyed, returning their
+ * allocator's memory.  This bounds the total memory retained by an
+ * idle server to roughly this many times the per-allocator limit -
+ * instead of one allocator per connection ever seen in parallel.
+ */
+#define MAX_UNUSED_POOLS 32
+
 struct svn_root_pools__t
 {
-  /* unused pools.
+  /* unused pools that exceeded the per-thread magazines ("depot").
    * Use MUTEX to serialize access to this collection.
    */
   apr_array_header_t *unused_pools;
@@ -36,8 +53,113 @@ struct svn_root_pools__t
   /* Mutex to serialize access to UNUSED_POOLS */
   svn_mutex__t *mutex;
 
+#if APR_HAS_THREADS
+  /* Gives access to the calling thread's magazine_t.  NULL if
+   * thread-local storage is unavailable; exchanges then always go
+   * through MUTEX. */
+  apr_threadkey_t *magazine_key;
+#endif
 };
 
+#if APR_HAS_THREADS
+
+/* A small per-thread cache ("magazine") of unused root pools.  Only the
+ * owning thread ever accesses this structure, so acquisition and release
+ * are lock-free until the magazine over- or underflows and pools get
+ * exchanged with the shared depot in batches.
+ */
+typedef struct magazine_t
+{
+  /* the root pool collection that this magazine caches for */
+  svn_root_pools__t *source;
+
+  /* number of entries used in POOLS */
+  int count;
+
+  /* the cached unused pools */
+  apr_pool_t *pools[MAGAZINE_SIZE];
+} magazine_t;
+
+#endif
+
+/* Put the cleared, unused POOL into the shared depot of POOLS - or
+ * destroy it if the depot is full already.
+ *
+ * To be called with POOLS->MUTEX held.
+ */
+static void
+deposit_pool(svn_root_pools__t *pools,
+             apr_pool_t *pool)
+{
+  if (pools->unused_pools->nelts < MAX_UNUSED_POOLS)
+    APR_ARRAY_PUSH(pools->unused_pools, apr_pool_t *) = pool;
+  else
+    svn_pool_destroy(pool);
+}
+
+#if APR_HAS_THREADS
+
+/* Move all pools cached in the exiting thread's magazine back to the
+ * shared depot and discard the magazine.  Implements the destructor
+ * interface of apr_threadkey_private_create().
+ */
+static void
+magazine_cleanup(void *data)
+{
+  magazine_t *magazine = data;
+  svn_root_pools__t *pools = magazine->source;
+  svn_error_t *err = svn_mutex__lock(pools->mutex);
+
+  if (err)
+    {
+      /* Mutex failure?!  Well, at least don't leak the pools. */
+      svn_error_clear(err);
+      while (magazine->count > 0)
+        svn_pool_destroy(magazine->pools[--magazine->count]);
+    }
+  else
+    {
+      while (magazine->count > 0)
+        deposit_pool(pools, magazine->pools[--magazine->count]);
+      svn_error_clear(svn_mutex__unlock(pools->mutex, SVN_NO_ERROR));
+    }
+
+  free(magazine);
+}
+
+/* Return the calling thread's magazine for POOLS, creating it upon the
+ * first call.  Returns NULL if thread-local storage is unavailable.
+ */
+static magazine_t *
+get_magazine(svn_root_pools__t *pools)
+{
+  void *data;
+
+  if (   pools->magazine_key == NULL
+      || apr_threadkey_private_get(&data, pools->magazine_key))
+    return NULL;
+
+  if (data == NULL)
+    {
+      /* The magazine must survive all of the thread's pools, so it
+       * cannot live in any of them. */
+      magazine_t *magazine = calloc(1, sizeof(*magazine));
+      if (   magazine == NULL
+          || apr_threadkey_private_set(magazine, pools->magazine_key))
+        {
+          free(magazine);
+          return NULL;
+        }
+
+      magazine->source = pools;
+      data = magazine;
+    }
+
+  return data;
+}
+
+#endif
+
 svn_error_t *
 svn_root_pools__create(svn_root_pools__t **pools)
 {
@@ -51,6 +173,14 @@ svn_root_pools__create(svn_root_pools__t **pools)
   SVN_ERR(svn_mutex__init(&result->mutex, TRUE, pool));
   result->unused_pools = apr_array_make(pool, 16, sizeof(apr_pool_t *));
 
+#if APR_HAS_THREADS
+  /* No thread-local storage is no show-stopper; we just lose the
+   * lock-free fast path. */
+  if (apr_threadkey_private_create(&result->magazine_key,
+                                   magazine_cleanup, pool))
+    result->magazine_key = NULL;
+#endif
+
   /* done */
   *pools = result;
 
@@ -64,10 +194,29 @@ static svn_error_t *
 acquire_pool_internal(apr_pool_t **pool,
                       svn_root_pools__t *pools)
 {
+#if APR_HAS_THREADS
+  magazine_t *magazine = get_magazine(pools);
+  if (magazine && magazine->count > 0)
+    {
+      *pool = magazine->pools[--magazine->count];
+      return SVN_NO_ERROR;
+    }
+#endif
+
   SVN_ERR(svn_mutex__lock(pools->mutex));
   *pool = pools->unused_pools->nelts
         ? *(apr_pool_t **)apr_array_pop(pools->unused_pools)
         : apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+
+#if APR_HAS_THREADS
+  /* Restock the magazine while we hold the lock anyway, so the next
+   * few acquisitions won't need to take it at all. */
+  if (magazine)
+    while (magazine->count < MAGAZINE_SIZE && pools->unused_pools->nelts)
+      magazine->pools[magazine->count++]
+        = *(apr_pool_t **)apr_array_pop(pools->unused_pools);
+#endif
+
   SVN_ERR(svn_mutex__unlock(pools->mutex, SVN_NO_ERROR));
 
   return SVN_NO_ERROR;
@@ -93,9 +242,41 @@ svn_root_pools__release_pool(apr_pool_t *pool,
                              svn_root_pools__t *pools)
 {
   svn_error_t *err;
+#if APR_HAS_THREADS
+  magazine_t *magazine;
+#endif
 
   svn_pool_clear(pool);
 
+#if APR_HAS_THREADS
+  magazine = get_magazine(pools);
+  if (magazine)
+    {
+      if (magazine->count < MAGAZINE_SIZE)
+        {
+          magazine->pools[magazine->count++] = pool;
+          return;
+        }
+
+      /* Exchange the full magazine for an empty one:  move everything
+       * to the depot in a single locked section. */
+      err = svn_mutex__lock(pools->mutex);
+      if (err)
+        {
+          svn_error_clear(err);
+          svn_pool_destroy(pool);
+          return;
+        }
+
+      while (magazine->count > 0)
+        deposit_pool(pools, magazine->pools[--magazine->count]);
+      deposit_pool(pools, pool);
+      svn_error_clear(svn_mutex__unlock(pools->mutex, SVN_NO_ERROR));
+
+      return;
+    }
+#endif
+
   err = svn_mutex__lock(pools->mutex);
   if (err)
     {
@@ -104,7 +285,7 @@ svn_root_pools__release_pool(apr_pool_t *pool,
     }
   else
     {
-      APR_ARRAY_PUSH(pools->unused_pools, apr_pool_t *) = pool;
+      deposit_pool(pools, pool);
       svn_error_clear(svn_mutex__unlock(pools->mutex, SVN_NO_ERROR));
     }
 }
@@ -199,14 +199,111 @@ is_valid_iproplist_skel(const svn_skel_t *skel)
 }
 
 
+/* The parser allocates nodes from a contiguous block sized by a
+   counting pre-pass over the input, falling back to individual pool
+   allocations if the pre-pass under-counted (it never does for data
+   that parses successfully, but keeping the fallback means the two
+   passes need not agree on every malformed input). */
+typedef struct parse_arena_t
+{
+  svn_skel_t *nodes;  /* remaining pre-allocated nodes, or NULL */
+  apr_size_t left;    /* number of unused nodes at NODES */
+  apr_pool_t *pool;   /* fallback and block allocator */
+} parse_arena_t;
+
+/* Return a zeroed svn_skel_t, taken from ARENA's pre-allocated block
+   when one is left and from ARENA->pool otherwise. */
+static svn_skel_t *
+alloc_skel(parse_arena_t *arena)
+{
+  if (arena->left > 0)
+    {
+      arena->left--;
+      return arena->nodes++;
+    }
+  return apr_pcalloc(arena->pool, sizeof(svn_skel_t));
+}
+
+/* Return the number of svn_skel_t nodes that parsing the skel at DATA,
+   of length LEN, will produce, or zero if the data is malformed.  This
+   walks the same grammar as parse() below but builds nothing, so that
+   the nodes can then be allocated as one contiguous block.  */
+static apr_size_t
+count_skels(const char *data, apr_size_t len)
+{
+  const char *end = data + len;
+  apr_size_t count = 0;
+  apr_size_t depth = 0;
+
+  if (len <= 0)
+    return 0;
+
+  do
+    {
+      /* Skip any whitespace between elements.  */
+      while (data < end
+             && skel_char_type[(unsigned char) *data] == type_space)
+        data++;
+
+      /* End of data before the outermost list was closed?  */
+      if (data >= end)
+        return 0;
+
+      if (*data == '(')
+        {
+          count++;
+          depth++;
+          data++;
+        }
+      else if (*data == ')')
+        {
+          if (depth == 0)
+            return 0;
+          depth--;
+          data++;
+        }
+      else if (skel_char_type[(unsigned char) *data] == type_name)
+        {
+          /* An atom with implicit length.  */
+          count++;
+          while (++data < end
+                 && skel_char_type[(unsigned char) *data] != type_space
+                 && skel_char_type[(unsigned char) *data] != type_paren)
+            ;
+        }
+      else
+        {
+          /* An atom with explicit length, or malformed data.  */
+          const char *next;
+          apr_size_t size = getsize(data, end - data, &next, end - data);
+
+          data = next;
+          if (! data
+              || data >= end
+              || skel_char_type[(unsigned char) *data] != type_space)
+            return 0;
+          data++;
+
+          if (end - data < size)
+            return 0;
+          data += size;
+          count++;
+        }
+    }
+  while (depth > 0);
+
+  return count;
+}
+
+
 static svn_skel_t *parse(const char *data, apr_size_t len,
-                         apr_pool_t *pool);
+                         parse_arena_t *arena);
 static svn_skel_t *list(const char *data, apr_size_t len,
-                        apr_pool_t *pool);
+                        parse_arena_t *arena);
 static svn_skel_t *implicit_atom(const char *data, apr_size_t len,
-                                 apr_pool_t *pool);
+                                 parse_arena_t *arena);
 static svn_skel_t *explicit_atom(const char *data, apr_size_t len,
-                                 apr_pool_t *pool);
+                                 parse_arena_t *arena);
 
 
 svn_skel_t *
@@ -214,7 +311,17 @@ svn_skel__parse(const char *data,
                 apr_size_t len,
                 apr_pool_t *pool)
 {
-  return parse(data, len, pool);
+  parse_arena_t arena;
+  apr_size_t count = count_skels(data, len);
+
+  /* Each node consumes at least one input byte, so COUNT <= LEN and
+     this multiplication cannot overflow.  */
+  arena.nodes = count ? apr_pcalloc(pool, count * sizeof(svn_skel_t))
+                      : NULL;
+  arena.left = count;
+  arena.pool = pool;
+
+  return parse(data, len, &arena);
 }
 
 
@@ -222,7 +329,7 @@ svn_skel__parse(const char *data,
 static svn_skel_t *
 parse(const char *data,
       apr_size_t len,
-      apr_pool_t *pool)
+      parse_arena_t *arena)
 {
   char c;
 
@@ -234,23 +341,23 @@ parse(const char *data,
 
   /* Is it a list, or an atom?  */
   if (c == '(')
-    return list(data, len, pool);
+    return list(data, len, arena);
 
   /* Is it a string with an implicit length?  */
   if (skel_char_type[(unsigned char) c] == type_name)
-    return implicit_atom(data, len, pool);
+    return implicit_atom(data, len, arena);
 
   /* Otherwise, we assume it's a string with an explicit length;
      svn_skel__getsize will catch the error.  */
   else
-    return explicit_atom(data, len, pool);
+    return explicit_atom(data, len, arena);
 }
 
 
 static svn_skel_t *
 list(const char *data,
      apr_size_t len,
-     apr_pool_t *pool)
+     parse_arena_t *arena)
 {
   const char *end = data + len;
   const char *list_start;
@@ -293,7 +400,7 @@ list(const char *data,
           }
 
         /* Parse the next element in the list.  */
-        element = parse(data, end - data, pool);
+        element = parse(data, end - data, arena);
         if (! element)
           return NULL;
 
@@ -308,7 +415,7 @@ list(const char *data,
 
     /* Construct the return value.  */
     {
-      svn_skel_t *s = apr_pcalloc(pool, sizeof(*s));
+      svn_skel_t *s = alloc_skel(arena);
 
       s->is_atom = FALSE;
       s->data = list_start;
@@ -326,7 +433,7 @@ list(const char *data,
 static svn_skel_t *
 implicit_atom(const char *data,
               apr_size_t len,
-              apr_pool_t *pool)
+              parse_arena_t *arena)
 {
   const char *start = data;
   const char *end = data + len;
@@ -345,7 +452,7 @@ implicit_atom(const char *data,
     ;
 
   /* Allocate the skel representing this string.  */
-  s = apr_pcalloc(pool, sizeof(*s));
+  s = alloc_skel(arena);
   s->is_atom = TRUE;
   s->data = start;
   s->len = data - start;
@@ -359,7 +466,7 @@ implicit_atom(const char *data,
 static svn_skel_t *
 explicit_atom(const char *data,
               apr_size_t len,
-              apr_pool_t *pool)
+              parse_arena_t *arena)
 {
   const char *end = data + len;
   const char *next;
@@ -384,7 +491,7 @@ explicit_atom(const char *data,
     return NULL;
 
   /* Allocate the skel representing this string.  */
-  s = apr_pcalloc(pool, sizeof(*s));
+  s = alloc_skel(arena);
   s->is_atom = TRUE;
   s->data = data;
   s->len = size;
@@ -79,9 +79,11 @@ svn_sort_compare_items_as_paths(const svn_sort__item_t *a,
 }
 
 
-int
-svn_sort_compare_items_lexically(const svn_sort__item_t *a,
-                                 const svn_sort__item_t *b)
+/* Body of svn_sort_compare_items_lexically, as an inlinable function for
+   the specialized sort kernel below. */
+static APR_INLINE int
+compare_items_lexically(const svn_sort__item_t *a,
+                        const svn_sort__item_t *b)
 {
   int val;
   apr_size_t len;
@@ -96,6 +98,13 @@ svn_sort_compare_items_lexically(const svn_sort__item_t *a,
   return (a->klen < b->klen) ? -1 : (a->klen > b->klen) ? 1 : 0;
 }
 
+int
+svn_sort_compare_items_lexically(const svn_sort__item_t *a,
+                                 const svn_sort__item_t *b)
+{
+  return compare_items_lexically(a, b);
+}
+
 
 int
 svn_sort_compare_revisions(const void *a, const void *b)
@@ -144,6 +153,98 @@ svn_sort__array(apr_array_header_t *array,
   qsort(array->elts, array->nelts, array->elt_size, comparison_func);
 }
 
+/* Number of elements up to which insertion sort beats quicksort. */
+#define SMALL_SORT_THRESHOLD 8
+
+/* Sort the NELTS svn_sort__item_t elements at BASE lexically by key.
+ *
+ * This is a median-of-three quicksort with an insertion sort for small
+ * ranges.  Unlike qsort(), it moves whole elements instead of swapping
+ * ELT_SIZE bytes and, most importantly, has the comparison inlined
+ * rather than paying an indirect call per comparison.  On the large
+ * directory and property lists that svn_sort__hash() handles for the
+ * tree serializers, this is a considerable win.
+ */
+static void
+sort_items_lexically(svn_sort__item_t *base, int nelts)
+{
+  int left, right;
+
+  while (nelts > SMALL_SORT_THRESHOLD)
+    {
+      svn_sort__item_t pivot, temp;
+      int lhs;
+      int middle = nelts / 2;
+
+      /* Order the first, middle and last element.  The middle one then
+       * is a median-of-three pivot and the outer two act as sentinels
+       * for the scan loops below. */
+      if (compare_items_lexically(&base[middle], &base[0]) < 0)
+        {
+          temp = base[middle]; base[middle] = base[0]; base[0] = temp;
+        }
+      if (compare_items_lexically(&base[nelts - 1], &base[middle]) < 0)
+        {
+          temp = base[nelts - 1]; base[nelts - 1] = base[middle];
+          base[middle] = temp;
+          if (compare_items_lexically(&base[middle], &base[0]) < 0)
+            {
+              temp = base[middle]; base[middle] = base[0]; base[0] = temp;
+            }
+        }
+
+      /* Hoare partition around the pivot *value*; the scans cannot run
+       * out of bounds because the pivot is taken from the array. */
+      pivot = base[middle];
+      left = -1;
+      right = nelts;
+      for (;;)
+        {
+          do
+            ++left;
+          while (compare_items_lexically(&base[left], &pivot) < 0);
+          do
+            --right;
+          while (compare_items_lexically(&pivot, &base[right]) < 0);
+
+          if (left >= right)
+            break;
+
+          temp = base[left]; base[left] = base[right]; base[right] = temp;
+        }
+
+      /* Recurse into the smaller partition and loop on the larger one
+       * to keep the stack depth logarithmic. */
+      lhs = right + 1;
+      if (lhs < nelts - lhs)
+        {
+          sort_items_lexically(base, lhs);
+          base += lhs;
+          nelts -= lhs;
+        }
+      else
+        {
+          sort_items_lexically(base + lhs, nelts - lhs);
+          nelts = lhs;
+        }
+    }
+
+  /* Insertion sort for the small ranges. */
+  for (right = 1; right < nelts; ++right)
+    {
+      svn_sort__item_t value = base[right];
+
+      for (left = right; left > 0; --left)
+        {
+          if (compare_items_lexically(&value, &base[left - 1]) >= 0)
+            break;
+
+          base[left] = base[left - 1];
+        }
+      base[left] = value;
+    }
+}
+
 apr_array_header_t *
 svn_sort__hash(apr_hash_t *ht,
                int (*comparison_func)(const svn_sort__item_t *,
@@ -182,8 +283,14 @@ svn_sort__hash(apr_hash_t *ht,
 
   /* quicksort the array if it isn't already sorted.  */
   if (!sorted)
-    svn_sort__array(ary,
-          (int (*)(const void *, const void *))comparison_func);
+    {
+      /* Use the specialized kernel for the hot standard comparator. */
+      if (comparison_func == svn_sort_compare_items_lexically)
+        sort_items_lexically((svn_sort__item_t *)ary->elts, ary->nelts);
+      else
+        svn_sort__array(ary,
+              (int (*)(const void *, const void *))comparison_func);
+    }
 
   return ary;
 }
@@ -26,6 +26,7 @@
 #include "svn_io.h"
 #include "svn_pools.h"
 
+#include "private/svn_io_private.h"
 #include "private/svn_subr_private.h"
 
 
@@ -244,13 +245,24 @@ svn_spillbuf__write(svn_spillbuf_t *buf,
   if (buf->spill == NULL
       && ((buf->maxsize - buf->memory_size) < len))
     {
-      SVN_ERR(svn_io_open_unique_file3(&buf->spill,
-                                       &buf->filename,
-                                       buf->dirpath,
-                                       (buf->delete_on_close
-                                        ? svn_io_file_del_on_close
-                                        : svn_io_file_del_none),
-                                       buf->pool, scratch_pool));
+      if (buf->delete_on_close)
+        {
+          /* Nobody will ever see the file; an anonymous temporary
+             avoids the directory churn caused by spill-heavy
+             operations.  BUF->FILENAME stays NULL if we got one. */
+          SVN_ERR(svn_io__open_anonymous_file(&buf->spill,
+                                              &buf->filename,
+                                              buf->dirpath,
+                                              buf->pool, scratch_pool));
+        }
+      else
+        {
+          SVN_ERR(svn_io_open_unique_file3(&buf->spill,
+                                           &buf->filename,
+                                           buf->dirpath,
+                                           svn_io_file_del_none,
+                                           buf->pool, scratch_pool));
+        }
 
       /* Optionally write the memory contents into the file. */
       if (buf->spill_all_contents)
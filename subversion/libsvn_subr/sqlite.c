@@ -39,6 +39,7 @@
 #include "private/svn_token.h"
 #ifdef WIN32
 #include "private/svn_io_private.h"
+#include "private/svn_perf_private.h"
 #include "private/svn_utf_private.h"
 #endif
 
@@ -155,6 +156,13 @@ struct svn_sqlite__stmt_t
   sqlite3_stmt *s3stmt;
   svn_sqlite__db_t *db;
   svn_boolean_t needs_reset;
+
+  /* Name identifying this statement in performance reports, or NULL if
+     performance counting is disabled.  See perf_statement_name(). */
+  const char *perf_name;
+
+  /* The performance counter registered under PERF_NAME, once resolved. */
+  svn_perf__counter_t *perf_counter;
 };
 
 struct svn_sqlite__context_t
@@ -243,6 +251,35 @@ exec_sql2(svn_sqlite__db_t *db, const char *sql, int ignored_err)
 }
 
 
+/* Return a counter name identifying the statement TEXT, allocated in
+   RESULT_POOL.  The name is a fixed prefix followed by the beginning of
+   TEXT with all whitespace runs collapsed into single blanks, which is
+   usually enough to identify the statement in wc-queries.sql et al. */
+static const char *
+perf_statement_name(const char *text, apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *name = svn_stringbuf_create("sqlite:", result_pool);
+  apr_size_t prefix_len = name->len;
+  svn_boolean_t blank = FALSE;
+
+  for (; *text && name->len < 70; ++text)
+    {
+      if (*text == ' ' || *text == '\t' || *text == '\n' || *text == '\r')
+        {
+          blank = TRUE;
+        }
+      else
+        {
+          if (blank && name->len > prefix_len)
+            svn_stringbuf_appendbyte(name, ' ');
+          blank = FALSE;
+          svn_stringbuf_appendbyte(name, *text);
+        }
+    }
+
+  return name->data;
+}
+
 static svn_error_t *
 prepare_statement(svn_sqlite__stmt_t **stmt, svn_sqlite__db_t *db,
                   const char *text, apr_pool_t *result_pool)
@@ -250,8 +287,23 @@ prepare_statement(svn_sqlite__stmt_t **stmt, svn_sqlite__db_t *db,
   *stmt = apr_palloc(result_pool, sizeof(**stmt));
   (*stmt)->db = db;
   (*stmt)->needs_reset = FALSE;
-
+  (*stmt)->perf_name = svn_perf__is_enabled()
+                     ? perf_statement_name(text, result_pool)
+                     : NULL;
+  (*stmt)->perf_counter = NULL;
+
+  /* Our statements stay cached in DB->PREPARED_STMTS for the lifetime
+     of the connection, so tell SQLite they are long-lived.  This makes
+     it store them outside the connection's lookaside buffer, keeping
+     that buffer available for the many short-lived allocations made
+     while stepping. */
+#if SQLITE_VERSION_NUMBER >= 3020000
+  SQLITE_ERR(sqlite3_prepare_v3(db->db3, text, -1,
+                                SQLITE_PREPARE_PERSISTENT,
+                                &(*stmt)->s3stmt, NULL), db);
+#else
   SQLITE_ERR(sqlite3_prepare_v2(db->db3, text, -1, &(*stmt)->s3stmt, NULL), db);
+#endif
 
   return SVN_NO_ERROR;
 }
@@ -344,8 +396,21 @@ svn_sqlite__step_row(svn_sqlite__stmt_t *stmt)
 svn_error_t *
 svn_sqlite__step(svn_boolean_t *got_row, svn_sqlite__stmt_t *stmt)
 {
+  static svn_perf__counter_t *perf_counter = NULL;
+  apr_time_t perf_start = svn_perf__start();
   int sqlite_result = sqlite3_step(stmt->s3stmt);
 
+  svn_perf__stop(&perf_counter, "sqlite.step", perf_start);
+
+  /* Additionally, account this step with the per-statement counter,
+     using the number of rows visited in full table scans as "units".
+     That count is the prime indicator of a query gone off-plan. */
+  if (perf_start && stmt->perf_name)
+    svn_perf__stop2(&stmt->perf_counter, stmt->perf_name, perf_start,
+                    sqlite3_stmt_status(stmt->s3stmt,
+                                        SQLITE_STMTSTATUS_FULLSCAN_STEP,
+                                        TRUE /* resetFlg */));
+
   if (sqlite_result != SQLITE_DONE && sqlite_result != SQLITE_ROW)
     {
       svn_error_t *err1, *err2;
@@ -57,6 +57,7 @@ struct svn_stream_t {
   svn_read_fn_t read_full_fn;
   svn_stream_skip_fn_t skip_fn;
   svn_write_fn_t write_fn;
+  svn_stream_writev_fn_t writev_fn;
   svn_close_fn_t close_fn;
   svn_stream_mark_fn_t mark_fn;
   svn_stream_seek_fn_t seek_fn;
@@ -113,6 +114,13 @@ svn_stream_set_write(svn_stream_t *stream, svn_write_fn_t write_fn)
   stream->write_fn = write_fn;
 }
 
+void
+svn_stream_set_writev(svn_stream_t *stream,
+                      svn_stream_writev_fn_t writev_fn)
+{
+  stream->writev_fn = writev_fn;
+}
+
 void
 svn_stream_set_close(svn_stream_t *stream, svn_close_fn_t close_fn)
 {
@@ -221,6 +229,39 @@ svn_stream_write(svn_stream_t *stream, const char *data, apr_size_t *len)
   return svn_error_trace(stream->write_fn(stream->baton, data, len));
 }
 
+svn_error_t *
+svn_stream_writev(svn_stream_t *stream,
+                  const svn_string_t *vec,
+                  apr_size_t nvec,
+                  apr_size_t *len)
+{
+  apr_size_t total = 0;
+  apr_size_t i;
+
+  if (stream->writev_fn != NULL)
+    return svn_error_trace(stream->writev_fn(stream->baton, vec, nvec,
+                                             len));
+
+  if (stream->write_fn == NULL)
+    return svn_error_create(SVN_ERR_STREAM_NOT_SUPPORTED, NULL, NULL);
+
+  /* Fall back to one write per buffer.  Stop early if the handler
+     accepted a buffer only partially; the caller will retry with the
+     remainder. */
+  for (i = 0; i < nvec; ++i)
+    {
+      apr_size_t chunk = vec[i].len;
+
+      SVN_ERR(stream->write_fn(stream->baton, vec[i].data, &chunk));
+      total += chunk;
+      if (chunk < vec[i].len)
+        break;
+    }
+
+  *len = total;
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_stream_reset(svn_stream_t *stream)
@@ -625,6 +666,15 @@ write_handler_disown(void *baton, const char *buffer, apr_size_t *len)
   return svn_error_trace(svn_stream_write(baton, buffer, len));
 }
 
+static svn_error_t *
+writev_handler_disown(void *baton,
+                      const svn_string_t *vec,
+                      apr_size_t nvec,
+                      apr_size_t *len)
+{
+  return svn_error_trace(svn_stream_writev(baton, vec, nvec, len));
+}
+
 static svn_error_t *
 mark_handler_disown(void *baton, svn_stream_mark_t **mark, apr_pool_t *pool)
 {
@@ -662,6 +712,7 @@ svn_stream_disown(svn_stream_t *stream, apr_pool_t *pool)
   svn_stream_set_read2(s, read_handler_disown, read_full_handler_disown);
   svn_stream_set_skip(s, skip_handler_disown);
   svn_stream_set_write(s, write_handler_disown);
+  svn_stream_set_writev(s, writev_handler_disown);
   svn_stream_set_mark(s, mark_handler_disown);
   svn_stream_set_seek(s, seek_handler_disown);
   svn_stream_set_data_available(s, data_available_disown);
@@ -771,6 +822,19 @@ write_handler_apr(void *baton, const char *data, apr_size_t *len)
   return svn_error_trace(err);
 }
 
+/* Implements svn_stream_writev_fn_t */
+static svn_error_t *
+writev_handler_apr(void *baton,
+                   const svn_string_t *vec,
+                   apr_size_t nvec,
+                   apr_size_t *len)
+{
+  struct baton_apr *btn = baton;
+
+  return svn_error_trace(svn_io_file_writev_full(btn->file, vec, nvec,
+                                                 len, btn->pool));
+}
+
 static svn_error_t *
 close_handler_apr(void *baton)
 {
@@ -1084,6 +1148,7 @@ make_stream_from_apr_file(apr_file_t *file,
   stream = svn_stream_create(baton, pool);
   svn_stream_set_read2(stream, read_handler_apr, read_full_handler_apr);
   svn_stream_set_write(stream, write_handler_apr);
+  svn_stream_set_writev(stream, writev_handler_apr);
 
   if (supports_seek)
     {
@@ -1358,6 +1423,237 @@ svn_stream_compressed(svn_stream_t *stream, apr_pool_t *pool)
   return zstream;
 }
 
+/* LZ4 block-compressed stream support.
+
+   The substream contains a sequence of blocks.  Each block consists of
+   an svn__encode_uint() length prefix followed by that many bytes of
+   svn__compress_lz4() output for up to LZ4BLOCK_SIZE bytes of original
+   data.  An empty substream represents empty contents. */
+
+#define LZ4BLOCK_SIZE (1024 * 1024)
+
+/* The compressed representation of a block cannot legitimately grow
+   beyond the original data by more than the embedded size header plus
+   LZ4's worst-case expansion of one byte per 255-byte chunk. */
+#define LZ4BLOCK_MAX_COMPRESSED_SIZE \
+  (LZ4BLOCK_SIZE + LZ4BLOCK_SIZE / 255 + SVN__MAX_ENCODED_UINT_LEN + 16)
+
+struct lz4_baton {
+  svn_stream_t *substream;      /* Stream with the compressed data. */
+  char *write_buffer;           /* Original data not yet compressed;
+                                   allocated on first write. */
+  apr_size_t write_buffer_used; /* Amount of data in WRITE_BUFFER. */
+  svn_stringbuf_t *compressed;  /* Scratch buffer for compressed blocks. */
+  svn_stringbuf_t *decompressed;/* Original data of the block being read. */
+  apr_size_t read_pos;          /* Read position in DECOMPRESSED. */
+  apr_pool_t *pool;             /* The pool this baton is allocated on. */
+};
+
+/* Compress the pending data in BTN->WRITE_BUFFER, if any, and write it
+   as a single block to the substream. */
+static svn_error_t *
+flush_block_lz4(struct lz4_baton *btn)
+{
+  unsigned char header[SVN__MAX_ENCODED_UINT_LEN];
+  apr_size_t len;
+
+  if (btn->write_buffer_used == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn__compress_lz4(btn->write_buffer, btn->write_buffer_used,
+                            btn->compressed));
+  btn->write_buffer_used = 0;
+
+  len = svn__encode_uint(header, btn->compressed->len) - header;
+  SVN_ERR(svn_stream_write(btn->substream, (const char *)header, &len));
+  len = btn->compressed->len;
+  SVN_ERR(svn_stream_write(btn->substream, btn->compressed->data, &len));
+
+  return SVN_NO_ERROR;
+}
+
+/* Compress data and write it to the substream */
+static svn_error_t *
+write_handler_lz4(void *baton, const char *buffer, apr_size_t *len)
+{
+  struct lz4_baton *btn = baton;
+  apr_size_t remaining = *len;
+
+  if (btn->write_buffer == NULL)
+    {
+      btn->write_buffer = apr_palloc(btn->pool, LZ4BLOCK_SIZE);
+      btn->compressed = svn_stringbuf_create_empty(btn->pool);
+    }
+
+  while (remaining > 0)
+    {
+      apr_size_t chunk = MIN(remaining,
+                             LZ4BLOCK_SIZE - btn->write_buffer_used);
+
+      memcpy(btn->write_buffer + btn->write_buffer_used, buffer, chunk);
+      btn->write_buffer_used += chunk;
+      buffer += chunk;
+      remaining -= chunk;
+
+      if (btn->write_buffer_used == LZ4BLOCK_SIZE)
+        SVN_ERR(flush_block_lz4(btn));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the next block from the substream and decompress it into
+   BTN->DECOMPRESSED.  Set *EOF to TRUE if the substream ended cleanly
+   at a block boundary. */
+static svn_error_t *
+read_block_lz4(svn_boolean_t *eof,
+               struct lz4_baton *btn)
+{
+  apr_uint64_t compressed_len = 0;
+  apr_size_t count;
+  int i;
+
+  *eof = FALSE;
+
+  /* Read the svn__encode_uint() length prefix one byte at a time; we
+     cannot read past it as the substream is not seekable in general. */
+  for (i = 0; ; i++)
+    {
+      unsigned char c;
+
+      count = 1;
+      SVN_ERR(svn_stream_read_full(btn->substream, (char *)&c, &count));
+      if (count == 0)
+        {
+          if (i == 0)
+            {
+              *eof = TRUE;
+              return SVN_NO_ERROR;
+            }
+
+          return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                                  _("Unexpected end of compressed stream"));
+        }
+
+      compressed_len = (compressed_len << 7) | (c & 0x7f);
+      if (!(c & 0x80))
+        break;
+
+      if (i + 1 >= SVN__MAX_ENCODED_UINT_LEN)
+        return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                                _("Invalid block length in compressed "
+                                  "stream"));
+    }
+
+  if (compressed_len == 0
+      || compressed_len > LZ4BLOCK_MAX_COMPRESSED_SIZE)
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Invalid block length in compressed stream"));
+
+  if (btn->compressed == NULL)
+    btn->compressed = svn_stringbuf_create_empty(btn->pool);
+
+  svn_stringbuf_ensure(btn->compressed, (apr_size_t)compressed_len);
+  count = (apr_size_t)compressed_len;
+  SVN_ERR(svn_stream_read_full(btn->substream, btn->compressed->data,
+                               &count));
+  if (count < compressed_len)
+    return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                            _("Unexpected end of compressed stream"));
+  btn->compressed->len = count;
+
+  SVN_ERR(svn__decompress_lz4(btn->compressed->data, btn->compressed->len,
+                              btn->decompressed, LZ4BLOCK_SIZE));
+  btn->read_pos = 0;
+
+  return SVN_NO_ERROR;
+}
+
+/* Handle reading from a compressed stream */
+static svn_error_t *
+read_handler_lz4(void *baton, char *buffer, apr_size_t *len)
+{
+  struct lz4_baton *btn = baton;
+  apr_size_t copied = 0;
+
+  if (btn->decompressed == NULL)
+    btn->decompressed = svn_stringbuf_create_empty(btn->pool);
+
+  while (copied < *len)
+    {
+      apr_size_t chunk;
+
+      if (btn->read_pos == btn->decompressed->len)
+        {
+          svn_boolean_t eof;
+
+          SVN_ERR(read_block_lz4(&eof, btn));
+          if (eof)
+            break;
+        }
+
+      chunk = MIN(*len - copied, btn->decompressed->len - btn->read_pos);
+      memcpy(buffer + copied, btn->decompressed->data + btn->read_pos,
+             chunk);
+      btn->read_pos += chunk;
+      copied += chunk;
+    }
+
+  *len = copied;
+  return SVN_NO_ERROR;
+}
+
+/* Discard any buffered state and rewind the substream. */
+static svn_error_t *
+seek_handler_lz4(void *baton, const svn_stream_mark_t *mark)
+{
+  struct lz4_baton *btn = baton;
+
+  if (mark != NULL)
+    return svn_error_create(SVN_ERR_STREAM_SEEK_NOT_SUPPORTED, NULL, NULL);
+
+  btn->write_buffer_used = 0;
+  btn->read_pos = 0;
+  if (btn->decompressed != NULL)
+    svn_stringbuf_setempty(btn->decompressed);
+
+  return svn_error_trace(svn_stream_reset(btn->substream));
+}
+
+/* Handle flushing and closing the stream */
+static svn_error_t *
+close_handler_lz4(void *baton)
+{
+  struct lz4_baton *btn = baton;
+
+  SVN_ERR(flush_block_lz4(btn));
+
+  return svn_error_trace(svn_stream_close(btn->substream));
+}
+
+svn_stream_t *
+svn_stream__lz4_compressed(svn_stream_t *stream,
+                           apr_pool_t *pool)
+{
+  struct svn_stream_t *lz4stream;
+  struct lz4_baton *baton;
+
+  assert(stream != NULL);
+
+  baton = apr_pcalloc(pool, sizeof(*baton));
+  baton->substream = stream;
+  baton->pool = pool;
+
+  lz4stream = svn_stream_create(baton, pool);
+  svn_stream_set_read2(lz4stream, NULL /* only full read support */,
+                       read_handler_lz4);
+  svn_stream_set_write(lz4stream, write_handler_lz4);
+  svn_stream_set_seek(lz4stream, seek_handler_lz4);
+  svn_stream_set_close(lz4stream, close_handler_lz4);
+
+  return lz4stream;
+}
+
 
 /* Checksummed stream support */
 
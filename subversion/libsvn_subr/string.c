@@ -37,6 +37,20 @@
 
 #include "svn_private_config.h"
 
+/* The match-length scanners below map naturally onto byte-wise vector
+ * compares.  Use such an implementation when the target supports the
+ * required instructions unconditionally.
+ */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SVN_STRING_MATCH_SIMD 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SVN_STRING_MATCH_SIMD 1
+#else
+#define SVN_STRING_MATCH_SIMD 0
+#endif
+
 
 
 /* Allocate the space for a memory buffer from POOL.
@@ -364,10 +378,20 @@ svn_stringbuf__morph_into_string(svn_stringbuf_t *strbuf)
 
 /* svn_stringbuf functions */
 
+/* Minimum payload capacity of a growable stringbuf, including the NUL
+ * terminator.  Most stringbufs that get appended to hold short strings
+ * like path components or header lines.  Since the character buffer is
+ * allocated in one chunk with the header, reserving this much up front
+ * effectively inlines payloads of up to 63 bytes with the struct and
+ * spares them the re-allocation / copy cycles of growing from the
+ * default ~8 usable bytes.
+ */
+#define MIN_STRINGBUF_SIZE 64
+
 svn_stringbuf_t *
 svn_stringbuf_create_empty(apr_pool_t *pool)
 {
-  return svn_stringbuf_create_ensure(0, pool);
+  return svn_stringbuf_create_ensure(MIN_STRINGBUF_SIZE - 1, pool);
 }
 
 svn_stringbuf_t *
@@ -538,6 +562,13 @@ svn_stringbuf_ensure(svn_stringbuf_t *str, apr_size_t minimum_size)
   void *mem = NULL;
   ++minimum_size;  /* + space for '\0' */
 
+  /* Every re-allocation copies the buffer and leaves the old one to
+   * waste pool memory.  So, if we must grow at all, e.g. in a byte-wise
+   * append loop, jump to the small-string threshold right away instead
+   * of re-allocating for every doubling below it. */
+  if (minimum_size > str->blocksize && minimum_size < MIN_STRINGBUF_SIZE)
+    minimum_size = MIN_STRINGBUF_SIZE;
+
   membuf_ensure(&mem, &str->blocksize, minimum_size, str->pool);
   if (mem && mem != str->data)
     {
@@ -1508,6 +1539,30 @@ svn_cstring__match_length(const char *a,
 {
   apr_size_t pos = 0;
 
+#if SVN_STRING_MATCH_SIMD
+
+  /* Compare 16 bytes per step.  Once a block mismatches, fall through
+   * to the scalar loops below to locate the first differing byte.
+   */
+  for (; max_len - pos >= 16; pos += 16)
+    {
+#if defined(__SSE2__)
+      __m128i va = _mm_loadu_si128((const __m128i *)(a + pos));
+      __m128i vb = _mm_loadu_si128((const __m128i *)(b + pos));
+
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff)
+        break;
+#else /* __aarch64__ && __ARM_NEON */
+      uint8x16_t va = vld1q_u8((const unsigned char *)(a + pos));
+      uint8x16_t vb = vld1q_u8((const unsigned char *)(b + pos));
+
+      if (vminvq_u8(vceqq_u8(va, vb)) == 0)
+        break;
+#endif
+    }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Chunky processing is so much faster ...
@@ -1536,6 +1591,33 @@ svn_cstring__reverse_match_length(const char *a,
 {
   apr_size_t pos = 0;
 
+#if SVN_STRING_MATCH_SIMD
+
+  /* Compare 16 bytes per step, walking backwards from A and B.  Once a
+   * block mismatches, fall through to the scalar loops below to locate
+   * the first differing byte.
+   */
+  while (max_len - pos >= 16)
+    {
+#if defined(__SSE2__)
+      __m128i va = _mm_loadu_si128((const __m128i *)(a - pos - 16));
+      __m128i vb = _mm_loadu_si128((const __m128i *)(b - pos - 16));
+
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff)
+        break;
+#else /* __aarch64__ && __ARM_NEON */
+      uint8x16_t va = vld1q_u8((const unsigned char *)(a - pos - 16));
+      uint8x16_t vb = vld1q_u8((const unsigned char *)(b - pos - 16));
+
+      if (vminvq_u8(vceqq_u8(va, vb)) == 0)
+        break;
+#endif
+
+      pos += 16;
+    }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Chunky processing is so much faster ...
@@ -1544,7 +1626,7 @@ svn_cstring__reverse_match_length(const char *a,
    * because A and B will probably have different alignment. So, skipping
    * the first few chars until alignment is reached is not an option.
    */
-  for (pos = sizeof(apr_size_t); pos <= max_len; pos += sizeof(apr_size_t))
+  for (pos += sizeof(apr_size_t); pos <= max_len; pos += sizeof(apr_size_t))
     if (*(const apr_size_t*)(a - pos) != *(const apr_size_t*)(b - pos))
       break;
 
@@ -52,6 +52,20 @@
 #include "private/svn_string_private.h"
 #include "private/svn_eol_private.h"
 
+/* The boring-span scanner in translate_chunk() maps naturally onto
+ * byte-wise vector compares.  Use such an implementation when the
+ * target supports the required instructions unconditionally.
+ */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SVN_SUBST_SCAN_SIMD 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SVN_SUBST_SCAN_SIMD 1
+#else
+#define SVN_SUBST_SCAN_SIMD 0
+#endif
+
 /**
  * The textual elements of a detranslated special file.  One of these
  * strings must appear as the first element of any special file as it
@@ -981,6 +995,77 @@ eol_unchanged(struct translation_baton *b,
   return !b->interesting[(unsigned char)buf[1]] || buf[0] == buf[1];
 }
 
+/* Return the position of the first byte in [START, END) that is marked
+ * in the 256-entry table INTERESTING, or END if there is none.
+ *
+ * The vectorized variants look for the candidate bytes '$', '\r' and
+ * '\n' - a superset of any table configuration produced by
+ * create_translation_baton() - and confirm candidates through the
+ * table, so they stay exact when e.g. only '$' is interesting.
+ */
+static APR_INLINE const char *
+find_interesting(const char *start,
+                 const char *end,
+                 const char *interesting)
+{
+  const char *p = start;
+
+#if SVN_SUBST_SCAN_SIMD
+  for (; p + 16 <= end; p += 16)
+    {
+      const char *q;
+      const char *block_end;
+#if defined(__SSE2__)
+      __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+      __m128i hits
+        = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('$')),
+                       _mm_or_si128(
+                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))));
+
+      if (_mm_movemask_epi8(hits) == 0)
+        continue;
+#else /* __aarch64__ && __ARM_NEON */
+      uint8x16_t chunk = vld1q_u8((const unsigned char *)p);
+      uint8x16_t hits
+        = vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('$')),
+                   vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\r')),
+                            vceqq_u8(chunk, vdupq_n_u8('\n'))));
+
+      if (vmaxvq_u8(hits) == 0)
+        continue;
+#endif
+
+      /* Some candidate byte is in this block.  Locate it and confirm
+         it through the table; keep scanning if all candidates turn
+         out to be uninteresting. */
+      block_end = p + 16;
+      for (q = p; q < block_end; ++q)
+        if (interesting[(unsigned char)*q])
+          return q;
+    }
+#else
+  /* Check 4 bytes at once to allow for efficient pipelining
+     and to reduce loop condition overhead. */
+  while (end - p >= 4)
+    {
+      if (interesting[(unsigned char)p[0]]
+          || interesting[(unsigned char)p[1]]
+          || interesting[(unsigned char)p[2]]
+          || interesting[(unsigned char)p[3]])
+        break;
+
+      p += 4;
+    }
+#endif
+
+  /* Find the exact position in the remaining tail. */
+  while (p < end && !interesting[(unsigned char)*p])
+    ++p;
+
+  return p;
+}
+
 
 /* Translate eols and keywords of a 'chunk' of characters BUF of size BUFLEN
  * according to the settings and state stored in baton B.
@@ -1126,24 +1211,8 @@ translate_chunk(svn_stream_t *dst,
 
               if (b->keywords)
                 {
-                  /* Check 4 bytes at once to allow for efficient pipelining
-                    and to reduce loop condition overhead. */
-                  while ((end - p) >= (len + 4))
-                    {
-                      if (interesting[(unsigned char)p[len]]
-                          || interesting[(unsigned char)p[len+1]]
-                          || interesting[(unsigned char)p[len+2]]
-                          || interesting[(unsigned char)p[len+3]])
-                        break;
-
-                      len += 4;
-                    }
-
-                  /* Found an interesting char or EOF in the next 4 bytes.
-                     Find its exact position. */
-                  while ((p + len) < end
-                         && !interesting[(unsigned char)p[len]])
-                    ++len;
+                  /* Skip the whole run of boring characters at once. */
+                  len = find_interesting(p + len, end, interesting) - p;
                 }
               else
                 {
@@ -1161,8 +1230,7 @@ translate_chunk(svn_stream_t *dst,
                  (end - p) > (len + 2) &&     /* not too close to EOF */
                  eol_unchanged(b, p + len));  /* EOL format already ok */
 
-          while ((p + len) < end && !interesting[(unsigned char)p[len]])
-            len++;
+          len = find_interesting(p + len, end, interesting) - p;
 
           if (len)
             {
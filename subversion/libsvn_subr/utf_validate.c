@@ -60,6 +60,22 @@
 #include "private/svn_eol_private.h"
 #include "private/svn_dep_compat.h"
 
+/* Almost all strings passing through here are plain ASCII, which the
+ * state machine below would grind through a table lookup per byte.
+ * Detecting the first non-ASCII byte maps naturally onto byte-wise
+ * vector compares; use such an implementation when the target supports
+ * the required instructions unconditionally.
+ */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SVN_UTF_VALIDATE_SIMD 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SVN_UTF_VALIDATE_SIMD 1
+#else
+#define SVN_UTF_VALIDATE_SIMD 0
+#endif
+
 /* Lookup table to categorise each octet in the string. */
 static const char octet_category[256] = {
   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, /* 0x00-0x7f */
@@ -258,6 +274,25 @@ static const char machine [9][14] = {
 static const char *
 first_non_fsm_start_char(const char *data, apr_size_t max_len)
 {
+#if SVN_UTF_VALIDATE_SIMD
+
+  /* Scan the input 16 bytes at a time for the first byte with bit 7
+     set; the loops below narrow the result down to the exact byte. */
+  for (; max_len >= 16; data += 16, max_len -= 16)
+    {
+#if defined(__SSE2__)
+      __m128i chunk = _mm_loadu_si128((const __m128i *)data);
+      if (_mm_movemask_epi8(chunk) != 0)
+        break;
+#else /* __aarch64__ && __ARM_NEON */
+      uint8x16_t chunk = vld1q_u8((const unsigned char *)data);
+      if (vmaxvq_u8(chunk) >= 0x80)
+        break;
+#endif
+    }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Scan the input one machine word at a time. */
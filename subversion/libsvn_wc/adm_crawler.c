@@ -306,6 +306,12 @@ svn_wc_restore2(svn_wc_context_t *wc_ctx,
    relative path, the repository root and depth stored on the directory,
    passed here to avoid another database query.
 
+   SUBTREE_CHILDREN maps the relpath of each directory in the crawled
+   subtree (relative to the report anchor) to the children info of that
+   directory, as returned by svn_wc__db_base_get_subtree_children_info().
+   SUBTREE_RELPATH is DIR_ABSPATH's key in that map.  Prefetching the
+   whole subtree in one query avoids a wc.db round trip per directory.
+
    DEPTH_COMPATIBILITY_TRICK means the same thing here as it does
    in svn_wc_crawl_revisions6().
 
@@ -317,6 +323,8 @@ static svn_error_t *
 report_revisions_and_depths(svn_wc__db_t *db,
                             const char *dir_abspath,
                             const char *report_relpath,
+                            apr_hash_t *subtree_children,
+                            const char *subtree_relpath,
                             svn_revnum_t dir_rev,
                             const char *dir_repos_relpath,
                             const char *dir_repos_root,
@@ -343,10 +351,11 @@ report_revisions_and_depths(svn_wc__db_t *db,
 
 
   /* Get both the SVN Entries and the actual on-disk entries.   Also
-     notice that we're picking up hidden entries too (read_children never
-     hides children). */
-  SVN_ERR(svn_wc__db_base_get_children_info(&base_children, db, dir_abspath,
-                                            scratch_pool, iterpool));
+     notice that we're picking up hidden entries too (the subtree query
+     never hides children). */
+  base_children = svn_hash_gets(subtree_children, subtree_relpath);
+  if (base_children == NULL)
+    base_children = apr_hash_make(scratch_pool);
 
   if (restore_files)
     {
@@ -646,6 +655,10 @@ report_revisions_and_depths(svn_wc__db_t *db,
               SVN_ERR(report_revisions_and_depths(db,
                                                   this_abspath,
                                                   this_report_relpath,
+                                                  subtree_children,
+                                                  svn_relpath_join(
+                                                    subtree_relpath, child,
+                                                    iterpool),
                                                   ths->revnum,
                                                   repos_relpath,
                                                   dir_repos_root,
@@ -780,11 +793,25 @@ svn_wc_crawl_revisions6(svn_wc_context_t *wc_ctx,
     {
       if (depth != svn_depth_empty)
         {
+          apr_hash_t *subtree_children;
+
+          /* Pull the BASE children info for the whole subtree in a
+             single query, instead of one query per directory below. */
+          err = svn_wc__db_base_get_subtree_children_info(&subtree_children,
+                                                          wc_ctx->db,
+                                                          local_abspath,
+                                                          scratch_pool,
+                                                          scratch_pool);
+          if (err)
+            goto abort_report;
+
           /* Recursively crawl ROOT_DIRECTORY and report differing
              revisions. */
           err = report_revisions_and_depths(wc_ctx->db,
                                             local_abspath,
                                             "",
+                                            subtree_children,
+                                            "",
                                             target_rev,
                                             repos_relpath,
                                             repos_root_url,
@@ -1040,6 +1040,112 @@ svn_wc_remove_lock2(svn_wc_context_t *wc_ctx,
                                         scratch_pool));
 }
 
+svn_error_t *
+svn_wc__add_locks(svn_wc_context_t *wc_ctx,
+                  apr_hash_t *locks,
+                  apr_pool_t *scratch_pool)
+{
+  apr_hash_t *db_locks = apr_hash_make(scratch_pool);
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  for (hi = apr_hash_first(scratch_pool, locks); hi; hi = apr_hash_next(hi))
+    {
+      const char *local_abspath = apr_hash_this_key(hi);
+      const svn_lock_t *lock = apr_hash_this_val(hi);
+      svn_wc__db_lock_t *db_lock = apr_palloc(scratch_pool,
+                                              sizeof(*db_lock));
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+      SVN_ERR(svn_wc__write_check(wc_ctx->db,
+                                  svn_dirent_dirname(local_abspath, iterpool),
+                                  iterpool));
+
+      db_lock->token = lock->token;
+      db_lock->owner = lock->owner;
+      db_lock->comment = lock->comment;
+      db_lock->date = lock->creation_date;
+      svn_hash_sets(db_locks, local_abspath, db_lock);
+    }
+
+  SVN_ERR(svn_wc__db_lock_add_many(wc_ctx->db, db_locks, scratch_pool));
+
+  /* if svn:needs-lock is present, then make the files read-write. */
+  for (hi = apr_hash_first(scratch_pool, locks); hi; hi = apr_hash_next(hi))
+    {
+      const char *local_abspath = apr_hash_this_key(hi);
+      const svn_string_t *needs_lock;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      err = svn_wc__internal_propget(&needs_lock, wc_ctx->db, local_abspath,
+                                     SVN_PROP_NEEDS_LOCK, iterpool, iterpool);
+      if (err && err->apr_err == SVN_ERR_WC_PATH_UNEXPECTED_STATUS)
+        {
+          /* The node has non wc representation (e.g. deleted), so
+             we don't want to touch the in-wc file */
+          svn_error_clear(err);
+          continue;
+        }
+      SVN_ERR(err);
+
+      if (needs_lock)
+        SVN_ERR(svn_io_set_file_read_write(local_abspath, FALSE, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__remove_locks(svn_wc_context_t *wc_ctx,
+                     const apr_array_header_t *local_abspaths,
+                     apr_pool_t *scratch_pool)
+{
+  apr_hash_t *items = apr_hash_make(scratch_pool);
+  apr_pool_t *iterpool;
+  int i;
+
+  if (local_abspaths->nelts == 0)
+    return SVN_NO_ERROR;
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < local_abspaths->nelts; i++)
+    {
+      const char *local_abspath = APR_ARRAY_IDX(local_abspaths, i,
+                                                const char *);
+      svn_skel_t *work_item;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+      SVN_ERR(svn_wc__write_check(wc_ctx->db,
+                                  svn_dirent_dirname(local_abspath, iterpool),
+                                  iterpool));
+
+      SVN_ERR(svn_wc__wq_build_sync_file_flags(&work_item,
+                                               wc_ctx->db, local_abspath,
+                                               scratch_pool, scratch_pool));
+      svn_hash_sets(items, local_abspath, work_item);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_wc__db_lock_remove_many(wc_ctx->db, items, scratch_pool));
+
+  /* All paths live in the same working copy, so one run handles the
+     work items queued for all of them. */
+  return svn_error_trace(svn_wc__wq_run(wc_ctx->db,
+                                        APR_ARRAY_IDX(local_abspaths, 0,
+                                                      const char *),
+                                        NULL, NULL /* cancel*/,
+                                        scratch_pool));
+}
+
 
 svn_error_t *
 svn_wc_set_changelist2(svn_wc_context_t *wc_ctx,
@@ -681,9 +681,24 @@ svn_wc__ambient_depth_filter_editor(const svn_delta_editor_t **editor,
 {
   svn_delta_editor_t *depth_filter_editor;
   struct edit_baton *eb;
+  svn_boolean_t is_sparse;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(anchor_abspath));
 
+  /* If the working copy records no shallow or excluded nodes below the
+     anchor, every incoming editor call is within the ambient depth and
+     this filter would merely forward it.  Skip the whole editor layer
+     in that common case instead of paying for the indirection on every
+     node of the drive. */
+  SVN_ERR(svn_wc__db_has_sparse_nodes(&is_sparse, db, anchor_abspath,
+                                      result_pool));
+  if (!is_sparse)
+    {
+      *editor = wrapped_editor;
+      *edit_baton = wrapped_edit_baton;
+      return SVN_NO_ERROR;
+    }
+
   depth_filter_editor = svn_delta_default_editor(result_pool);
   depth_filter_editor->set_target_revision = set_target_revision;
   depth_filter_editor->open_root = open_root;
@@ -440,6 +440,19 @@ copy_versioned_dir(svn_wc__db_t *db,
       (*notify_func)(notify_baton, notify, scratch_pool);
     }
 
+  /* For a metadata only copy within one working copy we can usually copy
+     the entire subtree with one pass over each database table, instead of
+     recursing here with one database operation per node. */
+  if (metadata_only && within_one_wc)
+    {
+      svn_boolean_t done;
+
+      SVN_ERR(svn_wc__db_op_copy_subtree(&done, db, src_abspath, dst_abspath,
+                                         scratch_pool));
+      if (done)
+        return SVN_NO_ERROR;
+    }
+
   if (!metadata_only && disk_kind == svn_node_dir)
     /* All filesystem children, versioned and unversioned.  We're only
        interested in their names, so we can pass TRUE as the only_check_type
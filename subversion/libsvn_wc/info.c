@@ -354,6 +354,12 @@ struct found_entry_baton
    * the tree walker.  Map of abspath -> empty string. */
   apr_hash_t *tree_conflicts;
   apr_pool_t *pool;
+
+  /* Per-wcroot constants, cached by bulk_info_receiver() on the first
+   * node it sees.  Unused (wcroot_abspath NULL) on the walker path. */
+  const char *wcroot_abspath;
+  int wc_format;
+  svn_boolean_t store_pristine;
 };
 
 /* Call WALK_BATON->receiver with WALK_BATON->receiver_baton, passing to it
@@ -422,6 +428,81 @@ info_found_node_callback(const char *local_abspath,
 }
 
 
+/* Build an info struct straight from the row streamed for a plain BASE
+ * node, falling back to the per-node queries of build_info_for_node()
+ * for anything more complex.
+ * Implements svn_wc__db_subtree_info_receiver_t. */
+static svn_error_t *
+bulk_info_receiver(void *baton,
+                   const char *local_abspath,
+                   svn_node_kind_t kind,
+                   const svn_wc__db_subtree_info_t *sinfo,
+                   apr_pool_t *scratch_pool)
+{
+  struct found_entry_baton *fe_baton = baton;
+  svn_wc__info2_t *tmpinfo;
+  svn_wc_info_t *wc_info;
+
+  if (sinfo == NULL)
+    return svn_error_trace(info_found_node_callback(local_abspath, kind,
+                                                    fe_baton, scratch_pool));
+
+  if (fe_baton->wcroot_abspath == NULL)
+    {
+      SVN_ERR(svn_wc__db_get_settings(&fe_baton->wc_format,
+                                      &fe_baton->store_pristine,
+                                      fe_baton->db, local_abspath,
+                                      scratch_pool));
+      SVN_ERR(svn_wc__db_get_wcroot(&fe_baton->wcroot_abspath, fe_baton->db,
+                                    local_abspath, fe_baton->pool,
+                                    scratch_pool));
+    }
+
+  tmpinfo = apr_pcalloc(scratch_pool, sizeof(*tmpinfo));
+  wc_info = apr_pcalloc(scratch_pool, sizeof(*wc_info));
+  tmpinfo->wc_info = wc_info;
+
+  tmpinfo->kind = sinfo->kind;
+  tmpinfo->rev = sinfo->revision;
+  tmpinfo->repos_root_URL = sinfo->repos_root_url;
+  tmpinfo->repos_UUID = sinfo->repos_uuid;
+  tmpinfo->URL = svn_path_url_add_component2(sinfo->repos_root_url,
+                                             sinfo->repos_relpath,
+                                             scratch_pool);
+  tmpinfo->last_changed_rev = sinfo->changed_rev;
+  tmpinfo->last_changed_date = sinfo->changed_date;
+  tmpinfo->last_changed_author = sinfo->changed_author;
+  tmpinfo->size = SVN_INVALID_FILESIZE;
+
+  if (sinfo->lock)
+    {
+      tmpinfo->lock = apr_pcalloc(scratch_pool, sizeof(*tmpinfo->lock));
+      tmpinfo->lock->token         = sinfo->lock->token;
+      tmpinfo->lock->owner         = sinfo->lock->owner;
+      tmpinfo->lock->comment       = sinfo->lock->comment;
+      tmpinfo->lock->creation_date = sinfo->lock->date;
+    }
+
+  wc_info->schedule = svn_wc_schedule_normal;
+  wc_info->copyfrom_rev = SVN_INVALID_REVNUM;
+  wc_info->depth = sinfo->depth;
+  wc_info->checksum = sinfo->checksum;
+  wc_info->recorded_size = sinfo->recorded_size;
+  wc_info->recorded_time = sinfo->recorded_time;
+  wc_info->changelist = sinfo->changelist;
+  wc_info->wcroot_abspath = fe_baton->wcroot_abspath;
+  wc_info->wc_format = fe_baton->wc_format;
+  wc_info->store_pristine = fe_baton->store_pristine;
+  wc_info->conflicts = NULL;
+
+  fe_baton->first = FALSE;
+
+  return svn_error_trace(fe_baton->receiver(fe_baton->receiver_baton,
+                                            local_abspath, tmpinfo,
+                                            scratch_pool));
+}
+
+
 /* Return TRUE iff the subtree at ROOT_ABSPATH, restricted to depth DEPTH,
  * would include the path CHILD_ABSPATH of kind CHILD_KIND. */
 static svn_boolean_t
@@ -468,14 +549,35 @@ svn_wc__get_info(svn_wc_context_t *wc_ctx,
   fe_baton.first = TRUE;
   fe_baton.tree_conflicts = apr_hash_make(scratch_pool);
   fe_baton.pool = scratch_pool;
+  fe_baton.wcroot_abspath = NULL;
+  fe_baton.wc_format = 0;
+  fe_baton.store_pristine = FALSE;
 
-  err = svn_wc__internal_walk_children(wc_ctx->db, local_abspath,
-                                       fetch_excluded,
-                                       changelist_filter,
-                                       info_found_node_callback,
-                                       &fe_baton, depth,
-                                       cancel_func, cancel_baton,
-                                       iterpool);
+  if (depth == svn_depth_infinity
+      && (changelist_filter == NULL || changelist_filter->nelts == 0))
+    {
+      /* Bulk path:  stream the whole subtree from one ordered query.
+         The conflict victims arrive from the same pass over ACTUAL_NODE,
+         so no per-directory victim queries are needed. */
+      fe_baton.actual_only = FALSE;
+
+      err = svn_wc__db_read_subtree_info(fetch_actual_only
+                                           ? fe_baton.tree_conflicts
+                                           : NULL,
+                                         wc_ctx->db, local_abspath,
+                                         fetch_excluded,
+                                         bulk_info_receiver, &fe_baton,
+                                         cancel_func, cancel_baton,
+                                         scratch_pool, iterpool);
+    }
+  else
+    err = svn_wc__internal_walk_children(wc_ctx->db, local_abspath,
+                                         fetch_excluded,
+                                         changelist_filter,
+                                         info_found_node_callback,
+                                         &fe_baton, depth,
+                                         cancel_func, cancel_baton,
+                                         iterpool);
 
   /* If the target root node is not present, svn_wc__internal_walk_children()
      returns a PATH_NOT_FOUND error and doesn't call the callback.  If there
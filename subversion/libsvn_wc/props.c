@@ -1530,6 +1530,24 @@ svn_wc__prop_retrieve_recursive(apr_hash_t **values,
                                                result_pool, scratch_pool));
 }
 
+svn_error_t *
+svn_wc__prop_retrieve_recursive2(apr_hash_t **values,
+                                 apr_hash_t **repos_relpaths,
+                                 svn_wc_context_t *wc_ctx,
+                                 const char *local_abspath,
+                                 const char *propname,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(
+            svn_wc__db_prop_retrieve_recursive2(values,
+                                                repos_relpaths,
+                                                wc_ctx->db,
+                                                local_abspath,
+                                                propname,
+                                                result_pool, scratch_pool));
+}
+
 svn_error_t *
 svn_wc_get_pristine_props(apr_hash_t **props,
                           svn_wc_context_t *wc_ctx,
@@ -156,6 +156,43 @@ compare_and_verify(svn_boolean_t *modified_p,
         }
     }
 
+  if (need_translation && !special && !exact_comparison && !props_mod)
+    {
+      const svn_checksum_t *translated_checksum;
+
+      /* If we recorded a checksum of the contents as they were installed,
+         a raw read of the working file is enough to detect the unmodified
+         case: on-disk contents that still match the installed contents
+         detranslate to the pristine by construction.  A mismatch proves
+         nothing (the file may still detranslate to the pristine text), so
+         then we fall through to the translating comparison below. */
+      SVN_ERR(svn_wc__db_read_translated_checksum(&translated_checksum, db,
+                                                  versioned_file_abspath,
+                                                  scratch_pool,
+                                                  scratch_pool));
+      if (translated_checksum)
+        {
+          svn_checksum_t *on_disk_checksum;
+
+          err = svn_io_file_checksum2(&on_disk_checksum,
+                                      versioned_file_abspath,
+                                      translated_checksum->kind,
+                                      scratch_pool);
+          /* Convert EACCESS on working copy path to WC specific error code. */
+          if (err && APR_STATUS_IS_EACCES(err->apr_err))
+            return svn_error_create(SVN_ERR_WC_PATH_ACCESS_DENIED, err, NULL);
+          else
+            SVN_ERR(err);
+
+          if (svn_checksum_match(on_disk_checksum, translated_checksum))
+            {
+              *modified_p = FALSE;
+
+              return SVN_NO_ERROR;
+            }
+        }
+    }
+
   /* ### Other checks possible? */
 
   /* Reading files is necessary. */
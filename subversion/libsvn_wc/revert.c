@@ -290,6 +290,12 @@ revert_wc_data(svn_boolean_t *run_wq,
 
    If INFO is NULL, LOCAL_ABSPATH doesn't exist in DB. Otherwise INFO
    specifies the state of LOCAL_ABSPATH in DB.
+
+   If REVERT_LIST_INFO is non-NULL, it holds the revert list entries
+   for the whole tree, obtained up front with a single call to
+   svn_wc__db_revert_list_read_tree(), and is consulted instead of
+   querying wc.db per node.  Entries are removed from the hash as they
+   are consumed; the caller notifies for whatever remains afterwards.
  */
 static svn_error_t *
 revert_restore(svn_boolean_t *run_wq,
@@ -301,6 +307,7 @@ revert_restore(svn_boolean_t *run_wq,
                svn_boolean_t revert_root,
                svn_boolean_t added_keep_local,
                const struct svn_wc__db_info_t *info,
+               apr_hash_t *revert_list_info,
                svn_cancel_func_t cancel_func,
                void *cancel_baton,
                svn_wc_notify_func2_t notify_func,
@@ -345,11 +352,35 @@ revert_restore(svn_boolean_t *run_wq,
         }
     }
 
-  SVN_ERR(svn_wc__db_revert_list_read(&notify_required,
-                                      &conflict_files,
-                                      &copied_here, &reverted_kind,
-                                      db, local_abspath,
-                                      scratch_pool, scratch_pool));
+  if (revert_list_info)
+    {
+      svn_wc__db_revert_list_info_t *entry = svn_hash_gets(revert_list_info,
+                                                           local_abspath);
+
+      if (entry)
+        {
+          notify_required = entry->reverted;
+          conflict_files = entry->marker_files;
+          copied_here = entry->copied_here;
+          reverted_kind = entry->kind;
+
+          /* Consumed; we notify for this node ourselves below. */
+          svn_hash_sets(revert_list_info, local_abspath, NULL);
+        }
+      else
+        {
+          notify_required = FALSE;
+          conflict_files = NULL;
+          copied_here = FALSE;
+          reverted_kind = svn_node_unknown;
+        }
+    }
+  else
+    SVN_ERR(svn_wc__db_revert_list_read(&notify_required,
+                                        &conflict_files,
+                                        &copied_here, &reverted_kind,
+                                        db, local_abspath,
+                                        scratch_pool, scratch_pool));
 
   if (info)
     {
@@ -370,7 +401,7 @@ revert_restore(svn_boolean_t *run_wq,
                                              scratch_pool),
                         scratch_pool);
 
-          if (notify_func)
+          if (notify_func && !revert_list_info)
             SVN_ERR(svn_wc__db_revert_list_notify(notify_func, notify_baton,
                                                   db, local_abspath,
                                                   scratch_pool));
@@ -464,6 +495,7 @@ revert_restore(svn_boolean_t *run_wq,
                                  use_commit_times, FALSE /* revert root */,
                                  added_keep_local,
                                  apr_hash_this_val(hi),
+                                 revert_list_info,
                                  cancel_func, cancel_baton,
                                  notify_func, notify_baton,
                                  iterpool));
@@ -480,13 +512,72 @@ revert_restore(svn_boolean_t *run_wq,
       svn_pool_destroy(iterpool);
     }
 
-  if (notify_func && (revert_root || kind == svn_node_dir))
+  if (notify_func && (revert_root || kind == svn_node_dir)
+      && !revert_list_info)
     SVN_ERR(svn_wc__db_revert_list_notify(notify_func, notify_baton,
                                           db, local_abspath, scratch_pool));
 
   return SVN_NO_ERROR;
 }
 
+/* Emit the notifications that the per-directory
+   svn_wc__db_revert_list_notify() sweeps would have produced for the
+   entries of REVERT_LIST_INFO that the restore walk did not consume:
+   nodes that no longer exist in the database after the revert (such as
+   reverted additions) and actual-only changes. */
+static svn_error_t *
+revert_notify_unvisited(apr_hash_t *revert_list_info,
+                        svn_wc_notify_func2_t notify_func,
+                        void *notify_baton,
+                        apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *items;
+  apr_pool_t *iterpool;
+  int i;
+
+  items = svn_sort__hash(revert_list_info, svn_sort_compare_items_as_paths,
+                         scratch_pool);
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < items->nelts; i++)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(items, i,
+                                                    svn_sort__item_t);
+      const svn_wc__db_revert_list_info_t *entry = item->value;
+      svn_wc_notify_t *notify;
+
+      svn_pool_clear(iterpool);
+
+      notify = svn_wc_create_notify(item->key, svn_wc_notify_revert,
+                                    iterpool);
+
+      if (entry->have_node_info)
+        notify->kind = entry->kind;
+      else
+        {
+          notify->kind = entry->actual_kind;
+
+          switch (entry->actual_notify)
+            {
+              case 0:
+                continue;
+              case 1:
+                /* standard revert */
+                break;
+              case 2:
+                notify->action = svn_wc_notify_tree_conflict;
+                break;
+              default:
+                SVN_ERR_MALFUNCTION();
+            }
+        }
+
+      notify_func(notify_baton, notify, iterpool);
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Perform the in-working copy revert of LOCAL_ABSPATH, to what is stored in DB */
 static svn_error_t *
 revert_wc_data(svn_boolean_t *run_wq,
@@ -782,6 +873,7 @@ revert(svn_wc__db_t *db,
   svn_error_t *err;
   const struct svn_wc__db_info_t *info = NULL;
   svn_boolean_t run_queue = FALSE;
+  apr_hash_t *revert_list_info = NULL;
 
   SVN_ERR_ASSERT(depth == svn_depth_empty || depth == svn_depth_infinity);
 
@@ -805,6 +897,15 @@ revert(svn_wc__db_t *db,
         svn_wc__db_op_revert(db, local_abspath, depth, clear_changelists,
                              scratch_pool, scratch_pool));
 
+  /* For recursive reverts, fetch the whole revert list in one query
+     up front instead of hitting wc.db once per node during the restore
+     walk below. */
+  if (!err && depth == svn_depth_infinity)
+    err = svn_error_trace(
+            svn_wc__db_revert_list_read_tree(&revert_list_info, db,
+                                             local_abspath,
+                                             scratch_pool, scratch_pool));
+
   if (!err)
     {
       err = svn_error_trace(
@@ -824,7 +925,8 @@ revert(svn_wc__db_t *db,
               revert_restore(&run_queue, db, local_abspath, depth, metadata_only,
                              use_commit_times, TRUE /* revert root */,
                              added_keep_local,
-                             info, cancel_func, cancel_baton,
+                             info, revert_list_info,
+                             cancel_func, cancel_baton,
                              notify_func, notify_baton,
                              scratch_pool));
 
@@ -834,6 +936,15 @@ revert(svn_wc__db_t *db,
                                                   cancel_func, cancel_baton,
                                                   scratch_pool));
 
+  /* Notify for the revert list entries the walk did not visit.  In the
+     per-node case svn_wc__db_revert_list_notify() has already handled
+     these. */
+  if (!err && revert_list_info && notify_func
+      && apr_hash_count(revert_list_info) > 0)
+    err = svn_error_trace(
+            revert_notify_unvisited(revert_list_info, notify_func,
+                                    notify_baton, scratch_pool));
+
   err = svn_error_compose_create(err,
                                  svn_wc__db_revert_list_done(db,
                                                              local_abspath,
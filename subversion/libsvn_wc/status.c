@@ -51,6 +51,7 @@
 #include "private/svn_wc_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_editor.h"
+#include "private/svn_task.h"
 
 
 /* The file internal variant of svn_wc_status3_t, with slightly more
@@ -2735,6 +2736,422 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
   return SVN_NO_ERROR;
 }
 
+/*** The parallel status crawl ***/
+
+/* Data shared between all subtree tasks of one parallel status walk. */
+struct parallel_walk_baton
+{
+  /* Template for the per-task walk status batons.  Tasks replace the
+     DB handle with their worker thread's private connection; the
+     externals hash is only read during the walk and can be shared. */
+  const struct walk_status_baton *wb_template;
+
+  /* The user's status callback.  Only ever called on the main thread,
+     from the task output functions. */
+  svn_wc_status_func4_t status_func;
+  void *status_baton;
+
+  /* One struct subtree_baton * per direct child of the walk target,
+     in the order their statuses must be reported. */
+  apr_array_header_t *subtrees;
+
+  const apr_array_header_t *ignore_patterns;
+  svn_boolean_t get_all;
+  svn_boolean_t no_ignore;
+};
+
+/* One direct child of the walk target, to be crawled by a worker.
+   Everything a worker needs beyond its own wc.db connection; all
+   strings outlive the task run. */
+struct subtree_baton
+{
+  struct parallel_walk_baton *pwb;
+
+  /* The child to crawl and the usual parent context parameters of
+     one_child_status(). */
+  const char *local_abspath;
+  const char *parent_abspath;
+  const char *dir_repos_root_url;
+  const char *dir_repos_relpath;
+  const char *dir_repos_uuid;
+
+  /* The child has a tree conflict but no versioned node. */
+  svn_boolean_t conflicted;
+};
+
+/* The per-worker-thread context:  a private wc.db connection, so that
+   subtrees can be crawled concurrently. */
+struct status_thread_context
+{
+  svn_wc__db_t *db;
+};
+
+/* Baton for status_context_constructor():  the main thread's DB and a
+   path identifying the working copy to snapshot. */
+struct status_context_baton
+{
+  svn_wc__db_t *db;
+  const char *target_abspath;
+};
+
+/* A status reported by a worker, to be replayed on the main thread. */
+struct collected_status
+{
+  const char *local_abspath;
+  svn_wc__internal_status_t *status;
+};
+
+/* Baton for collect_status(). */
+struct collect_baton
+{
+  apr_array_header_t *statuses;  /* of struct collected_status */
+  apr_pool_t *pool;
+};
+
+/* Implements svn_task__thread_context_constructor_t.  Check out a
+   read-only snapshot connection to the walked working copy for one
+   worker thread;  the connection returns to the wcroot's idle pool
+   when the task runner destroys the context. */
+static svn_error_t *
+status_context_constructor(void **thread_context,
+                           void *context_baton,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  struct status_context_baton *b = context_baton;
+  struct status_thread_context *context = apr_pcalloc(result_pool,
+                                                      sizeof(*context));
+
+  SVN_ERR(svn_wc__db_snapshot_open(&context->db, b->db, b->target_abspath,
+                                   result_pool, scratch_pool));
+
+  *thread_context = context;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_wc_status_func4_t.  Stash a deep copy of STATUS for
+   later replay through the user's callback. */
+static svn_error_t *
+collect_status(void *baton,
+               const char *local_abspath,
+               const svn_wc_status3_t *status,
+               apr_pool_t *scratch_pool)
+{
+  struct collect_baton *cb = baton;
+  const svn_wc__internal_status_t *old_status = (const void *)status;
+  svn_wc__internal_status_t *new_status;
+  struct collected_status *collected;
+
+  new_status = (void *)svn_wc_dup_status3(status, cb->pool);
+
+  /* Copy the internal/private data. */
+  new_status->has_descendants = old_status->has_descendants;
+  new_status->op_root = old_status->op_root;
+
+  collected = apr_array_push(cb->statuses);
+  collected->local_abspath = apr_pstrdup(cb->pool, local_abspath);
+  collected->status = new_status;
+
+  return SVN_NO_ERROR;
+}
+
+/* Crawl the subtree given by PROCESS_BATON using the thread's private
+   wc.db connection and return the collected statuses in *RESULT.
+   Implements svn_task__process_func_t; runs on a worker thread. */
+static svn_error_t *
+subtree_process_func(void **result,
+                     svn_task__t *task,
+                     void *thread_context,
+                     void *process_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  struct subtree_baton *sb = process_baton;
+  struct status_thread_context *context = thread_context;
+  struct walk_status_baton wb = *sb->pwb->wb_template;
+  struct collect_baton cb;
+  const struct svn_wc__db_info_t *info;
+  const svn_io_dirent2_t *dirent;
+  apr_array_header_t *collected_ignore_patterns = NULL;
+  svn_error_t *err;
+
+  wb.db = context->db;
+
+  cb.statuses = apr_array_make(result_pool, 16,
+                               sizeof(struct collected_status));
+  cb.pool = result_pool;
+
+  /* The sequential walk gets the child's dirent from the parent's
+     readdir and its info from the parent's read_children_info();
+     re-derive both here so that nothing needs to cross threads. */
+  SVN_ERR(svn_io_stat_dirent2(&dirent, sb->local_abspath,
+                              TRUE /* verify_truename */,
+                              TRUE /* ignore_enoent */,
+                              scratch_pool, scratch_pool));
+  if (dirent && dirent->kind == svn_node_none)
+    dirent = NULL;
+
+  err = svn_wc__db_read_single_info(&info, wb.db, sb->local_abspath,
+                                    !wb.check_working_copy,
+                                    scratch_pool, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_WC_PATH_NOT_FOUND)
+    {
+      svn_error_clear(err);
+      info = NULL;
+    }
+  else
+    SVN_ERR(err);
+
+  SVN_ERR(one_child_status(&wb,
+                           sb->local_abspath,
+                           sb->parent_abspath,
+                           info,
+                           dirent,
+                           sb->dir_repos_root_url,
+                           sb->dir_repos_relpath,
+                           sb->dir_repos_uuid,
+                           sb->conflicted,
+                           &collected_ignore_patterns,
+                           sb->pwb->ignore_patterns,
+                           svn_depth_infinity,
+                           sb->pwb->get_all,
+                           sb->pwb->no_ignore,
+                           collect_status, &cb,
+                           cancel_func, cancel_baton,
+                           scratch_pool,
+                           scratch_pool));
+
+  *result = cb.statuses->nelts ? cb.statuses : NULL;
+  return SVN_NO_ERROR;
+}
+
+/* Replay the statuses collected by a subtree task through the user's
+   callback.  Implements svn_task__output_func_t; called on the main
+   thread, in the order the subtrees were added. */
+static svn_error_t *
+subtree_output_func(svn_task__t *task,
+                    void *result,
+                    void *output_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  struct parallel_walk_baton *pwb = output_baton;
+  apr_array_header_t *statuses = result;
+  int i;
+
+  for (i = 0; i < statuses->nelts; i++)
+    {
+      const struct collected_status *collected
+        = &APR_ARRAY_IDX(statuses, i, struct collected_status);
+
+      SVN_ERR(pwb->status_func(pwb->status_baton,
+                               collected->local_abspath,
+                               &collected->status->s,
+                               scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Root task of a parallel walk:  spawn one sub-task per subtree.
+   Implements svn_task__process_func_t. */
+static svn_error_t *
+spawn_subtrees_func(void **result,
+                    svn_task__t *task,
+                    void *thread_context,
+                    void *process_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  struct parallel_walk_baton *pwb = process_baton;
+  int i;
+
+  for (i = 0; i < pwb->subtrees->nelts; ++i)
+    {
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      struct subtree_baton *sb = APR_ARRAY_IDX(pwb->subtrees, i,
+                                               struct subtree_baton *);
+
+      SVN_ERR(svn_task__add(task, process_pool, NULL,
+                            subtree_process_func, sb,
+                            subtree_output_func, pwb));
+    }
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__walk_status_parallel(svn_wc_context_t *wc_ctx,
+                             const char *local_abspath,
+                             svn_depth_t depth,
+                             svn_boolean_t get_all,
+                             svn_boolean_t no_ignore,
+                             svn_boolean_t ignore_text_mods,
+                             const apr_array_header_t *ignore_patterns,
+                             apr_int32_t thread_count,
+                             svn_wc_status_func4_t status_func,
+                             void *status_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *scratch_pool)
+{
+  svn_wc__db_t *db = wc_ctx->db;
+  struct walk_status_baton wb;
+  struct parallel_walk_baton pwb;
+  struct status_context_baton context_baton;
+  const svn_io_dirent2_t *dirent;
+  const struct svn_wc__db_info_t *dir_info;
+  const char *dir_repos_root_url;
+  const char *dir_repos_relpath;
+  const char *dir_repos_uuid;
+  apr_hash_t *dirents, *nodes, *conflicts, *all_children;
+  apr_array_header_t *sorted_children;
+  svn_error_t *err;
+  int i;
+
+  /* The concurrent crawl only pays off for full-depth walks of a
+     versioned directory;  everything else is served by the sequential
+     walker. */
+  if (thread_count <= 1 || depth != svn_depth_infinity)
+    return svn_error_trace(
+             svn_wc_walk_status(wc_ctx, local_abspath, depth, get_all,
+                                no_ignore, ignore_text_mods,
+                                ignore_patterns, status_func, status_baton,
+                                cancel_func, cancel_baton, scratch_pool));
+
+  err = svn_wc__db_read_single_info(&dir_info, db, local_abspath,
+                                    FALSE /* base_tree_only */,
+                                    scratch_pool, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_WC_PATH_NOT_FOUND)
+    {
+      svn_error_clear(err);
+      dir_info = NULL;
+    }
+  else
+    SVN_ERR(err);
+
+  if (!dir_info
+      || !dir_info->has_descendants
+      || dir_info->status == svn_wc__db_status_not_present
+      || dir_info->status == svn_wc__db_status_excluded
+      || dir_info->status == svn_wc__db_status_server_excluded)
+    return svn_error_trace(
+             svn_wc_walk_status(wc_ctx, local_abspath, depth, get_all,
+                                no_ignore, ignore_text_mods,
+                                ignore_patterns, status_func, status_baton,
+                                cancel_func, cancel_baton, scratch_pool));
+
+  wb.db = db;
+  wb.target_abspath = local_abspath;
+  wb.ignore_text_mods = ignore_text_mods;
+  wb.check_working_copy = TRUE;
+  wb.repos_root = NULL;
+  wb.repos_locks = NULL;
+
+  if (!ignore_patterns)
+    {
+      apr_array_header_t *ignores;
+
+      SVN_ERR(svn_wc_get_default_ignores(&ignores, NULL, scratch_pool));
+      ignore_patterns = ignores;
+    }
+
+  SVN_ERR(svn_wc__db_externals_defined_below(&wb.externals,
+                                             db, local_abspath,
+                                             scratch_pool, scratch_pool));
+
+  SVN_ERR(stat_wc_dirent_case_sensitive(&dirent, db, local_abspath,
+                                        scratch_pool, scratch_pool));
+
+  /* Report the walk target itself, from the main thread. */
+  SVN_ERR(get_dir_status(&wb, local_abspath, FALSE /* skip_this_dir */,
+                         NULL, NULL, NULL, dir_info, dirent,
+                         ignore_patterns, svn_depth_empty, get_all,
+                         no_ignore, status_func, status_baton,
+                         cancel_func, cancel_baton, scratch_pool));
+
+  /* Enumerate the children, as in get_dir_status(). */
+  err = svn_io_get_dirents3(&dirents, local_abspath,
+                            ignore_text_mods /* only_check_type*/,
+                            scratch_pool, scratch_pool);
+  if (err
+      && (APR_STATUS_IS_ENOENT(err->apr_err)
+          || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    {
+      svn_error_clear(err);
+      dirents = apr_hash_make(scratch_pool);
+    }
+  else
+    SVN_ERR(err);
+
+  SVN_ERR(get_repos_root_url_relpath(&dir_repos_relpath,
+                                     &dir_repos_root_url,
+                                     &dir_repos_uuid, dir_info,
+                                     NULL, NULL, NULL,
+                                     db, local_abspath,
+                                     scratch_pool, scratch_pool));
+
+  SVN_ERR(svn_wc__db_read_children_info(&nodes, &conflicts,
+                                        db, local_abspath,
+                                        FALSE /* base_tree_only */,
+                                        scratch_pool, scratch_pool));
+
+  all_children = apr_hash_overlay(scratch_pool, nodes, dirents);
+  if (apr_hash_count(conflicts) > 0)
+    all_children = apr_hash_overlay(scratch_pool, conflicts, all_children);
+
+  sorted_children = svn_sort__hash(all_children,
+                                   svn_sort_compare_items_lexically,
+                                   scratch_pool);
+
+  pwb.wb_template = &wb;
+  pwb.status_func = status_func;
+  pwb.status_baton = status_baton;
+  pwb.ignore_patterns = ignore_patterns;
+  pwb.get_all = get_all;
+  pwb.no_ignore = no_ignore;
+  pwb.subtrees = apr_array_make(scratch_pool, sorted_children->nelts,
+                                sizeof(struct subtree_baton *));
+
+  for (i = 0; i < sorted_children->nelts; i++)
+    {
+      const svn_sort__item_t *item
+        = &APR_ARRAY_IDX(sorted_children, i, svn_sort__item_t);
+      struct subtree_baton *sb = apr_pcalloc(scratch_pool, sizeof(*sb));
+
+      sb->pwb = &pwb;
+      sb->local_abspath = svn_dirent_join(local_abspath, item->key,
+                                          scratch_pool);
+      sb->parent_abspath = local_abspath;
+      sb->dir_repos_root_url = dir_repos_root_url;
+      sb->dir_repos_relpath = dir_repos_relpath;
+      sb->dir_repos_uuid = dir_repos_uuid;
+      sb->conflicted = apr_hash_get(conflicts, item->key, item->klen)
+                         != NULL;
+
+      APR_ARRAY_PUSH(pwb.subtrees, struct subtree_baton *) = sb;
+    }
+
+  context_baton.db = db;
+  context_baton.target_abspath = local_abspath;
+
+  SVN_ERR(svn_task__run(thread_count,
+                        spawn_subtrees_func, &pwb,
+                        NULL, NULL,
+                        status_context_constructor, &context_baton,
+                        cancel_func, cancel_baton,
+                        scratch_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc_walk_status(svn_wc_context_t *wc_ctx,
                    const char *local_abspath,
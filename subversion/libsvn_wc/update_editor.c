@@ -31,6 +31,7 @@
 #include <apr_md5.h>
 #include <apr_tables.h>
 #include <apr_strings.h>
+#include <apr_thread_proc.h>
 
 #include "svn_types.h"
 #include "svn_pools.h"
@@ -40,6 +41,7 @@
 #include "svn_path.h"
 #include "svn_error.h"
 #include "svn_io.h"
+#include "svn_config.h"
 #include "svn_private_config.h"
 #include "svn_time.h"
 
@@ -53,6 +55,8 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_editor.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_cond.h"
 
 /* Checks whether a svn_wc__db_status_t indicates whether a node is
    present in a working copy. Used by the editor implementation */
@@ -150,6 +154,85 @@ path_join_under_root(const char **result_path,
 
 /*** batons ***/
 
+struct handler_baton;
+
+/* Maximum number of bytes of copied delta windows the install pipeline
+   buffers before the editor drive blocks.  Bounds the memory used when
+   the network outpaces the disk. */
+#define PIPELINE_MAX_QUEUED_SIZE (16 * 1024 * 1024)
+
+/* One queued unit of install work: a single delta window (NULL for the
+   end of the delta) of the file identified by HB. */
+struct pipeline_entry
+{
+  struct handler_baton *hb;
+
+  /* The window to apply, copied off the editor drive.  NULL marks the
+     end of the file's delta. */
+  svn_txdelta_window_t *window;
+
+  /* Rough memory footprint of this entry, accounted against the
+     pipeline's QUEUED_SIZE. */
+  apr_size_t size;
+
+  /* The pool holding this entry and WINDOW.  Destroyed by the worker
+     once the entry has been processed. */
+  apr_pool_t *pool;
+
+  struct pipeline_entry *next;
+};
+
+/* The asynchronous file-install pipeline of an edit.  The editor drive
+   enqueues delta windows here and a worker thread applies them to the
+   pristine install stream and the provisioned working file, so network
+   reads and disk writes overlap instead of alternating.
+
+   All wc.db access stays on the editor thread:  the streams are opened
+   before the first window is enqueued and the pristine is registered in
+   the db only after close_file() waited for the worker (see
+   finish_textdelta()). */
+struct install_pipeline
+{
+  /* Guards all following fields. */
+  svn_mutex__t *mutex;
+
+  /* Signalled when the queue gains an entry or TERMINATING is set. */
+  svn_thread_cond__t *has_work;
+
+  /* Signalled whenever the worker completed an entry, i.e. when the
+     queue shrank or a final window has been applied. */
+  svn_thread_cond__t *progress;
+
+  /* Singly linked FIFO of the windows to apply. */
+  struct pipeline_entry *first;
+  struct pipeline_entry *last;
+
+  /* Accumulated SIZE of all queued entries. */
+  apr_size_t queued_size;
+
+  /* The file whose delta is currently in flight, if any.  Used to abort
+     its install when the edit is torn down mid-file. */
+  struct handler_baton *current_hb;
+
+  /* The first error raised by the worker, to be picked up by the editor
+     thread.  FAILED stays set even after ERR has been handed out; the
+     worker stops applying further windows once it is set. */
+  svn_error_t *err;
+  svn_boolean_t failed;
+
+  /* Tells the worker to exit once the queue has drained. */
+  svn_boolean_t terminating;
+
+#if APR_HAS_THREADS
+  apr_thread_t *thread;
+#endif
+
+  /* The root pool of the pipeline.  It uses a serialized allocator;
+     everything both threads touch lives below this pool. */
+  apr_pool_t *pool;
+};
+
+
 struct edit_baton
 {
   /* For updates, the "destination" of the edit is ANCHOR_ABSPATH, the
@@ -262,6 +345,10 @@ struct edit_baton
   /* After closing the root directory a copy of its edited value */
   svn_boolean_t edited;
 
+  /* The asynchronous file-install pipeline, or NULL when file installs
+     happen serially within the editor drive. */
+  struct install_pipeline *pipeline;
+
   apr_pool_t *pool;
 };
 
@@ -435,6 +522,18 @@ struct handler_baton
   /* A calculated SHA-1 of NEW_TEXT_BASE_TMP_ABSPATH, which we'll use for
      eventually writing the pristine. */
   svn_checksum_t * new_text_base_sha1_checksum;
+
+  /* The pipeline applying this delta, or NULL when it is applied
+     serially in window_handler(). */
+  struct install_pipeline *pipeline;
+
+  /* In pipelined mode: set once the first window has arrived and the
+     source and target streams have been opened. */
+  svn_boolean_t delta_started;
+
+  /* In pipelined mode: set by the worker (under the pipeline mutex)
+     once the final window has been applied. */
+  svn_boolean_t done;
 };
 
 
@@ -789,6 +888,15 @@ struct file_baton
 
   /* Writer with the provisioned content of the working file.  May be NULL. */
   svn_wc__working_file_writer_t *file_writer;
+
+  /* In pipelined mode, the in-flight text delta of this file, if any.
+     close_file() waits for it before using the new checksums. */
+  struct handler_baton *pipeline_hb;
+
+  /* In pipelined mode, the pool holding FILE_WRITER.  It lives below the
+     pipeline's serialized allocator because the worker thread writes
+     through the writer's stream.  NULL in sequential mode. */
+  apr_pool_t *writer_pool;
 };
 
 
@@ -986,20 +1094,18 @@ mark_file_edited(struct file_baton *fb, apr_pool_t *scratch_pool)
 }
 
 
-/* Handle the next delta window of the file described by BATON.  If it is
- * the end (WINDOW == NULL), then check the checksum, store the text in the
- * pristine store and write its details into BATON->fb->new_text_base_*. */
+/* Complete the text delta described by HB:  check the source checksum,
+ * store the text in the pristine store and write its details into
+ * HB->fb->new_text_base_*.  ERR is the error raised while applying the
+ * delta, if any; on error, abort the pristine install instead.  Destroys
+ * HB->pool.
+ *
+ * In sequential mode this runs from window_handler(); in pipelined mode
+ * close_file() calls it after waiting for the install worker. */
 static svn_error_t *
-window_handler(svn_txdelta_window_t *window, void *baton)
+finish_textdelta(struct handler_baton *hb, svn_error_t *err)
 {
-  struct handler_baton *hb = baton;
   struct file_baton *fb = hb->fb;
-  svn_error_t *err;
-
-  /* Apply this window.  We may be done at that point.  */
-  err = hb->apply_handler(window, hb->apply_baton);
-  if (window != NULL && !err)
-    return SVN_NO_ERROR;
 
   if (hb->expected_source_checksum)
     {
@@ -1044,6 +1150,12 @@ window_handler(svn_txdelta_window_t *window, void *baton)
           svn_error_clear(svn_wc__working_file_writer_close(fb->file_writer));
           fb->file_writer = NULL;
         }
+
+      if (fb->writer_pool)
+        {
+          svn_pool_destroy(fb->writer_pool);
+          fb->writer_pool = NULL;
+        }
     }
   else
     {
@@ -1067,6 +1179,311 @@ window_handler(svn_txdelta_window_t *window, void *baton)
   return err;
 }
 
+/* Handle the next delta window of the file described by BATON.  If it is
+ * the end (WINDOW == NULL), then check the checksum, store the text in the
+ * pristine store and write its details into BATON->fb->new_text_base_*. */
+static svn_error_t *
+window_handler(svn_txdelta_window_t *window, void *baton)
+{
+  struct handler_baton *hb = baton;
+  svn_error_t *err;
+
+  /* Apply this window.  We may be done at that point.  */
+  err = hb->apply_handler(window, hb->apply_baton);
+  if (window != NULL && !err)
+    return SVN_NO_ERROR;
+
+  return finish_textdelta(hb, err);
+}
+
+
+/* === The file-install pipeline === */
+
+#if APR_HAS_THREADS
+
+/* The install worker's main function, implementing
+   apr_thread_start_t.  DATA is the install_pipeline.
+
+   Pop windows off the queue and apply them until told to terminate.
+   Only stream I/O happens here; everything that touches wc.db runs on
+   the editor thread. */
+static void * APR_THREAD_FUNC
+pipeline_thread(apr_thread_t *thread, void *data)
+{
+  struct install_pipeline *pipeline = data;
+  svn_error_t *err;
+
+  err = svn_mutex__lock(pipeline->mutex);
+  while (!err)
+    {
+      struct pipeline_entry *entry = pipeline->first;
+      struct handler_baton *hb;
+      svn_boolean_t skip;
+      svn_error_t *apply_err = SVN_NO_ERROR;
+
+      if (!entry)
+        {
+          if (pipeline->terminating)
+            break;
+
+          err = svn_thread_cond__wait(pipeline->has_work, pipeline->mutex);
+          continue;
+        }
+
+      pipeline->first = entry->next;
+      if (!pipeline->first)
+        pipeline->last = NULL;
+      pipeline->queued_size -= entry->size;
+
+      /* Once an error has been raised, drain the queue without applying
+         anything further. */
+      hb = entry->hb;
+      skip = pipeline->failed;
+
+      err = svn_mutex__unlock(pipeline->mutex, SVN_NO_ERROR);
+      if (err)
+        break;
+
+      if (!skip)
+        apply_err = hb->apply_handler(entry->window, hb->apply_baton);
+
+      err = svn_mutex__lock(pipeline->mutex);
+      if (err)
+        {
+          svn_error_clear(apply_err);
+          break;
+        }
+
+      if (apply_err)
+        {
+          if (!pipeline->failed)
+            {
+              pipeline->err = apply_err;
+              pipeline->failed = TRUE;
+            }
+          else
+            svn_error_clear(apply_err);
+        }
+
+      if (entry->window == NULL)
+        hb->done = TRUE;
+
+      svn_pool_destroy(entry->pool);
+      svn_error_clear(svn_thread_cond__broadcast(pipeline->progress));
+    }
+
+  if (err)
+    {
+      /* A broken mutex or condition variable; there is no good way to
+         hand this to the editor thread, so record it like a failed
+         window. */
+      svn_error_clear(svn_mutex__lock(pipeline->mutex));
+      if (!pipeline->failed)
+        {
+          pipeline->err = err;
+          pipeline->failed = TRUE;
+        }
+      else
+        svn_error_clear(err);
+      svn_error_clear(svn_thread_cond__broadcast(pipeline->progress));
+      svn_error_clear(svn_mutex__unlock(pipeline->mutex, SVN_NO_ERROR));
+    }
+  else
+    {
+      svn_error_clear(svn_mutex__unlock(pipeline->mutex, SVN_NO_ERROR));
+    }
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Create the install pipeline *PIPELINE_P and start its worker thread.
+   The pipeline lives in its own root pool with a serialized allocator
+   and must be retired with pipeline_shutdown(). */
+static svn_error_t *
+pipeline_create(struct install_pipeline **pipeline_p)
+{
+  apr_pool_t *pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  struct install_pipeline *pipeline = apr_pcalloc(pool, sizeof(*pipeline));
+  svn_error_t *err;
+  apr_status_t status;
+
+  pipeline->pool = pool;
+
+  err = svn_mutex__init(&pipeline->mutex, TRUE, pool);
+  if (!err)
+    err = svn_thread_cond__create(&pipeline->has_work, pool);
+  if (!err)
+    err = svn_thread_cond__create(&pipeline->progress, pool);
+
+  if (!err)
+    {
+      status = apr_thread_create(&pipeline->thread, NULL, pipeline_thread,
+                                 pipeline, pool);
+      if (status)
+        err = svn_error_wrap_apr(status,
+                                 _("Can't create the file install thread"));
+    }
+
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  *pipeline_p = pipeline;
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* Tell PIPELINE's worker to exit once the queue has drained, wait for
+   it and abort the install of any file still in flight.  Return the
+   first error raised by the worker that has not been picked up yet.
+   The caller remains responsible for destroying PIPELINE->pool. */
+static svn_error_t *
+pipeline_shutdown(struct install_pipeline *pipeline)
+{
+  svn_error_t *err;
+
+  SVN_ERR(svn_mutex__lock(pipeline->mutex));
+  pipeline->terminating = TRUE;
+  err = svn_thread_cond__signal(pipeline->has_work);
+  SVN_ERR(svn_mutex__unlock(pipeline->mutex, err));
+
+#if APR_HAS_THREADS
+  {
+    apr_status_t result;
+    apr_status_t status = apr_thread_join(&result, pipeline->thread);
+
+    if (status)
+      return svn_error_wrap_apr(status,
+                                _("Can't join the file install thread"));
+  }
+#endif
+
+  /* The worker is gone; no locking needed from here on. */
+  err = pipeline->err;
+  pipeline->err = SVN_NO_ERROR;
+
+  if (pipeline->current_hb)
+    {
+      struct handler_baton *hb = pipeline->current_hb;
+      struct file_baton *fb = hb->fb;
+
+      if (hb->install_data)
+        svn_error_clear(svn_wc__db_pristine_install_abort(hb->install_data,
+                                                          hb->pool));
+
+      if (fb->file_writer)
+        {
+          svn_error_clear(svn_wc__working_file_writer_close(fb->file_writer));
+          fb->file_writer = NULL;
+        }
+
+      pipeline->current_hb = NULL;
+    }
+
+  return err;
+}
+
+/* An APR pool cleanup handler.  Retires the install pipeline of the
+   edit baton DATA if the edit was torn down without reaching
+   close_edit(). */
+static apr_status_t
+cleanup_pipeline(void *data)
+{
+  struct edit_baton *eb = data;
+
+  if (eb->pipeline)
+    {
+      svn_error_clear(pipeline_shutdown(eb->pipeline));
+      svn_pool_destroy(eb->pipeline->pool);
+      eb->pipeline = NULL;
+    }
+
+  return APR_SUCCESS;
+}
+
+/* Append WINDOW (NULL for the end of the delta) of the file described
+   by HB to PIPELINE's queue, blocking while more than
+   PIPELINE_MAX_QUEUED_SIZE bytes are already buffered.  Runs on the
+   editor thread; returns the first error raised by the worker, if
+   any. */
+static svn_error_t *
+pipeline_enqueue(struct install_pipeline *pipeline,
+                 struct handler_baton *hb,
+                 const svn_txdelta_window_t *window)
+{
+  struct pipeline_entry *entry;
+  apr_pool_t *entry_pool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(pipeline->mutex));
+
+  while (!err
+         && !pipeline->failed
+         && pipeline->queued_size > PIPELINE_MAX_QUEUED_SIZE)
+    err = svn_thread_cond__wait(pipeline->progress, pipeline->mutex);
+
+  if (!err && pipeline->failed)
+    {
+      err = pipeline->err;
+      pipeline->err = SVN_NO_ERROR;
+      if (!err)
+        err = svn_error_create(SVN_ERR_WC_OBSTRUCTED_UPDATE, NULL,
+                               _("The file install worker failed"));
+    }
+
+  if (err)
+    return svn_mutex__unlock(pipeline->mutex, err);
+
+  entry_pool = svn_pool_create(pipeline->pool);
+  entry = apr_pcalloc(entry_pool, sizeof(*entry));
+  entry->pool = entry_pool;
+  entry->hb = hb;
+  if (window)
+    {
+      entry->window = svn_txdelta_window_dup(window, entry_pool);
+      entry->size = sizeof(*window) + window->tview_len;
+    }
+  entry->size += sizeof(*entry);
+
+  if (pipeline->last)
+    pipeline->last->next = entry;
+  else
+    pipeline->first = entry;
+  pipeline->last = entry;
+  pipeline->queued_size += entry->size;
+
+  err = svn_thread_cond__signal(pipeline->has_work);
+
+  return svn_mutex__unlock(pipeline->mutex, err);
+}
+
+/* Wait until PIPELINE's worker has applied the final window of the file
+   described by HB, then pick up and return the worker's error, if
+   any.  Runs on the editor thread. */
+static svn_error_t *
+pipeline_wait_for_file(struct install_pipeline *pipeline,
+                       struct handler_baton *hb)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(pipeline->mutex));
+
+  while (!err && !hb->done)
+    err = svn_thread_cond__wait(pipeline->progress, pipeline->mutex);
+
+  if (!err && pipeline->failed)
+    {
+      err = pipeline->err;
+      pipeline->err = SVN_NO_ERROR;
+    }
+
+  return svn_mutex__unlock(pipeline->mutex, err);
+}
+
 
 /* Find the last-change info within ENTRY_PROPS, and return then in the
    CHANGED_* parameters. Each parameter will be initialized to its "none"
@@ -2626,6 +3043,7 @@ close_directory(void *dir_baton,
       {
         apr_hash_index_t *hi;
         apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+        apr_hash_t *markers = apr_hash_make(scratch_pool);
 
         for (hi = apr_hash_first(scratch_pool, new_children);
              hi;
@@ -2633,7 +3051,6 @@ close_directory(void *dir_baton,
           {
             const char *child_name;
             const char *child_abspath;
-            const char *child_relpath;
             const svn_dirent_t *dirent;
             svn_wc__db_status_t status;
             svn_node_kind_t child_kind;
@@ -2676,59 +3093,36 @@ close_directory(void *dir_baton,
 
             svn_error_clear(err);
 
-            child_relpath = svn_relpath_join(db->new_repos_relpath, child_name,
-                                             iterpool);
-
-            SVN_ERR(svn_wc__db_base_add_not_present_node(eb->db,
-                                                         child_abspath,
-                                                         child_relpath,
-                                                         eb->repos_root,
-                                                         eb->repos_uuid,
-                                                         *eb->target_revision,
-                                                         child_kind,
-                                                         NULL, NULL,
-                                                         iterpool));
+            svn_hash_sets(markers, apr_pstrdup(scratch_pool, child_name),
+                          svn_node_kind_to_word(child_kind));
           }
 
         svn_pool_destroy(iterpool);
+
+        /* Insert all markers in a single transaction. */
+        SVN_ERR(svn_wc__db_base_add_not_present_nodes(eb->db,
+                                                      db->local_abspath,
+                                                      db->new_repos_relpath,
+                                                      eb->repos_root,
+                                                      eb->repos_uuid,
+                                                      *eb->target_revision,
+                                                      markers,
+                                                      scratch_pool));
       }
   }
 
-  if (apr_hash_count(db->not_present_nodes))
-    {
-      apr_hash_index_t *hi;
-      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-
-      /* This should call some new function (which could also be used
-         for new_children above) to add all the names in single
-         transaction, but I can't even trigger it.  I've tried
-         ra_local, ra_svn, ra_neon, ra_serf and they all call
-         close_file before close_dir. */
-      for (hi = apr_hash_first(scratch_pool, db->not_present_nodes);
-           hi;
-           hi = apr_hash_next(hi))
-        {
-          const char *child = apr_hash_this_key(hi);
-          const char *child_abspath, *child_relpath;
-          svn_node_kind_t kind = svn_node_kind_from_word(apr_hash_this_val(hi));
-
-          svn_pool_clear(iterpool);
-
-          child_abspath = svn_dirent_join(db->local_abspath, child, iterpool);
-          child_relpath = svn_dirent_join(db->new_repos_relpath, child, iterpool);
-
-          SVN_ERR(svn_wc__db_base_add_not_present_node(eb->db,
-                                                       child_abspath,
-                                                       child_relpath,
-                                                       eb->repos_root,
-                                                       eb->repos_uuid,
-                                                       *eb->target_revision,
-                                                       kind,
-                                                       NULL, NULL,
-                                                       iterpool));
-        }
-      svn_pool_destroy(iterpool);
-    }
+  /* Add all the names in a single transaction.  This only triggers
+     for children the server could not report on, e.g. after their
+     delete or replace was rejected; the usual editor drives call
+     close_file before close_dir and leave this hash empty. */
+  SVN_ERR(svn_wc__db_base_add_not_present_nodes(eb->db,
+                                                db->local_abspath,
+                                                db->new_repos_relpath,
+                                                eb->repos_root,
+                                                eb->repos_uuid,
+                                                *eb->target_revision,
+                                                db->not_present_nodes,
+                                                scratch_pool));
 
   /* If this directory is merely an anchor for a targeted child, then we
      should not be updating the node at all.  */
@@ -3753,14 +4147,18 @@ lazy_open_source(svn_stream_t **stream,
   return SVN_NO_ERROR;
 }
 
-/* Implements svn_stream_lazyopen_func_t. */
+/* Open the pristine install stream and the working file writer for the
+   text delta described by HB and combine them into *STREAM_P, the
+   target of the delta application.  In sequential mode this runs lazily
+   from lazy_open_target(); in pipelined mode it runs eagerly when the
+   first window arrives, so that all wc.db access stays on the editor
+   thread. */
 static svn_error_t *
-lazy_open_target(svn_stream_t **stream_p,
-                 void *baton,
-                 apr_pool_t *result_pool,
-                 apr_pool_t *scratch_pool)
+open_file_install_streams(svn_stream_t **stream_p,
+                          struct handler_baton *hb,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
 {
-  struct handler_baton *hb = baton;
   struct file_baton *fb = hb->fb;
   svn_wc__db_install_data_t *pristine_install_data;
   svn_stream_t *pristine_install_stream;
@@ -3803,7 +4201,19 @@ lazy_open_target(svn_stream_t **stream_p,
     }
   else
     {
-      SVN_ERR(open_working_file_writer(&file_writer, fb, fb->pool,
+      apr_pool_t *writer_pool = fb->pool;
+
+      /* In pipelined mode the install worker writes through the
+         writer's stream; keep the writer below the pipeline's
+         serialized allocator and pin it until close_file() is done
+         with it. */
+      if (fb->edit_baton->pipeline)
+        {
+          fb->writer_pool = svn_pool_create(fb->edit_baton->pipeline->pool);
+          writer_pool = fb->writer_pool;
+        }
+
+      SVN_ERR(open_working_file_writer(&file_writer, fb, writer_pool,
                                        scratch_pool));
     }
 
@@ -3829,6 +4239,80 @@ lazy_open_target(svn_stream_t **stream_p,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_stream_lazyopen_func_t. */
+static svn_error_t *
+lazy_open_target(svn_stream_t **stream_p,
+                 void *baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  struct handler_baton *hb = baton;
+
+  return svn_error_trace(open_file_install_streams(stream_p, hb,
+                                                   result_pool,
+                                                   scratch_pool));
+}
+
+/* Open the delta source and target of HB and create the apply handler,
+   just as apply_textdelta() does in sequential mode.  In pipelined mode
+   this is deferred until the first window arrives, and it runs on the
+   editor thread so that the wc.db accesses below never happen on the
+   install worker. */
+static svn_error_t *
+start_pipelined_delta(struct handler_baton *hb)
+{
+  struct file_baton *fb = hb->fb;
+  apr_pool_t *scratch_pool = svn_pool_create(hb->pool);
+  svn_stream_t *source;
+  svn_stream_t *target;
+
+  if (! fb->adding_file)
+    SVN_ERR(svn_wc__textbase_get_contents(&source, fb->edit_baton->db,
+                                          fb->local_abspath,
+                                          fb->original_checksum, FALSE,
+                                          hb->pool, scratch_pool));
+  else
+    source = svn_stream_empty(hb->pool);
+
+  /* Checksum the text base while applying deltas */
+  if (hb->expected_source_checksum)
+    {
+      source = svn_stream_checksummed2(source,
+                                       &hb->actual_source_checksum,
+                                       NULL,
+                                       hb->expected_source_checksum->kind,
+                                       TRUE, hb->pool);
+      hb->source_checksum_stream = source;
+    }
+
+  SVN_ERR(open_file_install_streams(&target, hb, hb->pool, scratch_pool));
+
+  /* Prepare to apply the delta.  */
+  svn_txdelta_apply2(svn_stream_disown(source, hb->pool), target,
+                     hb->new_text_base_md5_digest,
+                     fb->local_abspath /* error_info */,
+                     hb->pool,
+                     &hb->apply_handler, &hb->apply_baton);
+
+  svn_pool_destroy(scratch_pool);
+  hb->delta_started = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* A svn_txdelta_window_handler_t handing WINDOW to the install pipeline
+   instead of applying it in place.  Runs on the editor thread. */
+static svn_error_t *
+pipeline_window_handler(svn_txdelta_window_t *window, void *baton)
+{
+  struct handler_baton *hb = baton;
+
+  if (!hb->delta_started)
+    SVN_ERR(start_pipelined_delta(hb));
+
+  return svn_error_trace(pipeline_enqueue(hb->pipeline, hb, window));
+}
+
 /* An svn_delta_editor_t function. */
 static svn_error_t *
 apply_textdelta(void *file_baton,
@@ -3838,9 +4322,13 @@ apply_textdelta(void *file_baton,
                 void **handler_baton)
 {
   struct file_baton *fb = file_baton;
-  apr_pool_t *handler_pool = svn_pool_create(fb->pool);
-  struct handler_baton *hb = apr_pcalloc(handler_pool, sizeof(*hb));
   struct edit_baton *eb = fb->edit_baton;
+  /* In pipelined mode, the worker destroys pools below the handler pool,
+     so it has to live below the pipeline's serialized allocator. */
+  apr_pool_t *handler_pool = svn_pool_create(eb->pipeline
+                                             ? eb->pipeline->pool
+                                             : fb->pool);
+  struct handler_baton *hb = apr_pcalloc(handler_pool, sizeof(*hb));
   const svn_checksum_t *recorded_base_checksum;
   svn_checksum_t *expected_base_checksum;
   svn_stream_t *source;
@@ -3848,6 +4336,7 @@ apply_textdelta(void *file_baton,
 
   if (fb->skip_this)
     {
+      svn_pool_destroy(handler_pool);
       *handler = svn_delta_noop_window_handler;
       *handler_baton = NULL;
       return SVN_NO_ERROR;
@@ -3890,6 +4379,35 @@ apply_textdelta(void *file_baton,
                      svn_checksum_to_cstring_display(recorded_base_checksum,
                                                      pool));
 
+  /* If we don't have a recorded checksum, use the ra provided checksum */
+  if (!recorded_base_checksum)
+    recorded_base_checksum = expected_base_checksum;
+
+  hb->pool = handler_pool;
+  hb->fb = fb;
+  if (recorded_base_checksum)
+    hb->expected_source_checksum = svn_checksum_dup(recorded_base_checksum,
+                                                    handler_pool);
+
+  if (eb->pipeline)
+    {
+      /* Pipelined mode: defer opening the source and target streams to
+         the arrival of the first window (see start_pipelined_delta())
+         and hand the windows to the install worker. */
+      SVN_ERR_ASSERT(fb->adding_file
+                     || !fb->original_checksum
+                     || fb->original_checksum->kind == svn_checksum_sha1);
+
+      hb->pipeline = eb->pipeline;
+      fb->pipeline_hb = hb;
+      eb->pipeline->current_hb = hb;
+
+      *handler_baton = hb;
+      *handler = pipeline_window_handler;
+
+      return SVN_NO_ERROR;
+    }
+
   /* Open the text base for reading, unless this is an added file. */
 
   /*
@@ -3918,21 +4436,15 @@ apply_textdelta(void *file_baton,
       source = svn_stream_empty(handler_pool);
     }
 
-  /* If we don't have a recorded checksum, use the ra provided checksum */
-  if (!recorded_base_checksum)
-    recorded_base_checksum = expected_base_checksum;
-
   /* Checksum the text base while applying deltas */
-  if (recorded_base_checksum)
+  if (hb->expected_source_checksum)
     {
-      hb->expected_source_checksum = svn_checksum_dup(recorded_base_checksum,
-                                                      handler_pool);
-
       /* Wrap stream and store reference to allow calculating the
          checksum. */
       source = svn_stream_checksummed2(source,
                                        &hb->actual_source_checksum,
-                                       NULL, recorded_base_checksum->kind,
+                                       NULL,
+                                       hb->expected_source_checksum->kind,
                                        TRUE, handler_pool);
       hb->source_checksum_stream = source;
     }
@@ -3947,9 +4459,6 @@ apply_textdelta(void *file_baton,
                      handler_pool,
                      &hb->apply_handler, &hb->apply_baton);
 
-  hb->pool = handler_pool;
-  hb->fb = fb;
-
   /* We're all set.  */
   *handler_baton = hb;
   *handler = window_handler;
@@ -4449,6 +4958,21 @@ close_file(void *file_baton,
       return SVN_NO_ERROR;
     }
 
+  /* In pipelined mode, wait until the install worker has applied this
+     file's delta, then run the completion that window_handler() performs
+     in sequential mode: verify the source checksum, install the pristine
+     and record the new checksums in FB. */
+  if (fb->pipeline_hb)
+    {
+      struct handler_baton *hb = fb->pipeline_hb;
+      svn_error_t *err;
+
+      err = pipeline_wait_for_file(eb->pipeline, hb);
+      eb->pipeline->current_hb = NULL;
+      fb->pipeline_hb = NULL;
+      SVN_ERR(finish_textdelta(hb, err));
+    }
+
   if (fb->edited)
     conflict_skel = fb->edit_conflict;
 
@@ -4816,6 +5340,12 @@ close_file(void *file_baton,
       fb->file_writer = NULL;
     }
 
+  if (fb->writer_pool)
+    {
+      svn_pool_destroy(fb->writer_pool);
+      fb->writer_pool = NULL;
+    }
+
   if (conflict_skel && eb->conflict_func)
     SVN_ERR(svn_wc__conflict_invoke_resolver(eb->db, fb->local_abspath,
                                              svn_node_file,
@@ -4968,6 +5498,19 @@ close_edit(void *edit_baton,
   struct edit_baton *eb = edit_baton;
   apr_pool_t *scratch_pool = eb->pool;
 
+  /* In pipelined mode, every close_file() already waited for its own
+     install, so the queue is empty by now; just retire the worker
+     before the revision bump below. */
+  if (eb->pipeline)
+    {
+      struct install_pipeline *pipeline = eb->pipeline;
+      svn_error_t *err = pipeline_shutdown(pipeline);
+
+      eb->pipeline = NULL;
+      svn_pool_destroy(pipeline->pool);
+      SVN_ERR(err);
+    }
+
   /* The editor didn't even open the root; we have to take care of
      some cleanup stuffs. */
   if (! eb->root_opened
@@ -5213,6 +5756,26 @@ make_editor(svn_revnum_t *target_revision,
   apr_pool_cleanup_register(edit_pool, eb, cleanup_edit_baton,
                             apr_pool_cleanup_null);
 
+#if APR_HAS_THREADS
+  {
+    svn_boolean_t pipelined;
+
+    SVN_ERR(svn_config_get_bool(svn_wc__db_get_config(db), &pipelined,
+                                SVN_CONFIG_SECTION_WORKING_COPY,
+                                SVN_CONFIG_OPTION_PIPELINED_UPDATES,
+                                FALSE));
+    if (pipelined)
+      {
+        SVN_ERR(pipeline_create(&eb->pipeline));
+
+        /* Registered after cleanup_edit_baton, so this runs first and
+           the work queue only runs once the worker is gone. */
+        apr_pool_cleanup_register(edit_pool, eb, cleanup_pipeline,
+                                  apr_pool_cleanup_null);
+      }
+  }
+#endif
+
   /* Construct an editor. */
   tree_editor->set_target_revision = set_target_revision;
   tree_editor->open_root = open_root;
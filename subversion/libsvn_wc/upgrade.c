@@ -43,6 +43,7 @@
 #include "svn_private_config.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_sqlite.h"
+#include "private/svn_task.h"
 #include "private/svn_token.h"
 
 /* WC-1.0 administrative area extensions */
@@ -1000,18 +1001,33 @@ remove_suffix(const char *str, const char *suffix, apr_pool_t *result_pool)
   return NULL;
 }
 
-/* Copy all the text-base files from the administrative area of WC directory
-   DIR_ABSPATH into the pristine store of SDB which is located in directory
-   NEW_WCROOT_ABSPATH.
+/* A text-base file that was checksummed and copied out of the old
+   administrative area, but not yet registered in the pristine store. */
+typedef struct pristine_extract_t
+{
+  /* Absolute path of the checksummed copy, outside the pristine store. */
+  const char *temp_abspath;
+
+  /* The checksums and size of the text-base contents. */
+  svn_checksum_t *sha1_checksum;
+  svn_checksum_t *md5_checksum;
+  svn_filesize_t size;
+} pristine_extract_t;
+
+/* Checksum all the text-base files in the administrative area of WC
+   directory DIR_ABSPATH and copy them to uniquely named files in directory
+   NEW_WCROOT_ABSPATH, without touching the new SDB.
 
    Set *TEXT_BASES_INFO to a new hash, allocated in RESULT_POOL, that maps
    (const char *) name of the versioned file to (svn_wc__text_base_info_t *)
-   information about the pristine text. */
+   information about the pristine text.  Set *PRISTINES to an array of
+   (pristine_extract_t *) describing the copies still to be moved into the
+   pristine store by install_text_bases(). */
 static svn_error_t *
-migrate_text_bases(apr_hash_t **text_bases_info,
+extract_text_bases(apr_hash_t **text_bases_info,
+                   apr_array_header_t **pristines,
                    const char *dir_abspath,
                    const char *new_wcroot_abspath,
-                   svn_sqlite__db_t *sdb,
                    apr_pool_t *result_pool,
                    apr_pool_t *scratch_pool)
 {
@@ -1023,6 +1039,7 @@ migrate_text_bases(apr_hash_t **text_bases_info,
                                                 scratch_pool);
 
   *text_bases_info = apr_hash_make(result_pool);
+  *pristines = apr_array_make(result_pool, 0, sizeof(pristine_extract_t *));
 
   /* Iterate over the text-base files */
   SVN_ERR(svn_io_get_dirents3(&dirents, text_base_dir, TRUE,
@@ -1036,12 +1053,11 @@ migrate_text_bases(apr_hash_t **text_bases_info,
 
       svn_pool_clear(iterpool);
 
-      /* Calculate its checksums and copy it to the pristine store */
+      /* Calculate its checksums and create the copy to be installed */
       {
-        const char *pristine_path;
         const char *text_base_path;
         const char *temp_path;
-        svn_sqlite__stmt_t *stmt;
+        pristine_extract_t *extract;
         apr_finfo_t finfo;
         svn_stream_t *read_stream;
         svn_stream_t *result_stream;
@@ -1053,7 +1069,7 @@ migrate_text_bases(apr_hash_t **text_bases_info,
         SVN_ERR(svn_stream_open_unique(&result_stream, &temp_path,
                                        new_wcroot_abspath,
                                        svn_io_file_del_none,
-                                       iterpool, iterpool));
+                                       result_pool, iterpool));
 
         SVN_ERR(svn_stream_open_readonly(&read_stream, text_base_path,
                                            iterpool, iterpool));
@@ -1072,27 +1088,12 @@ migrate_text_bases(apr_hash_t **text_bases_info,
 
         SVN_ERR(svn_io_stat(&finfo, text_base_path, APR_FINFO_SIZE, iterpool));
 
-        /* Insert a row into the pristine table. */
-        SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
-                                          STMT_INSERT_OR_IGNORE_PRISTINE_F31));
-        SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, iterpool));
-        SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, iterpool));
-        SVN_ERR(svn_sqlite__bind_int64(stmt, 3, finfo.size));
-        SVN_ERR(svn_sqlite__insert(NULL, stmt));
-
-        SVN_ERR(svn_wc__db_pristine_get_future_path(&pristine_path,
-                                                    new_wcroot_abspath,
-                                                    sha1_checksum,
-                                                    iterpool, iterpool));
-
-        /* Ensure any sharding directories exist. */
-        SVN_ERR(svn_wc__ensure_directory(svn_dirent_dirname(pristine_path,
-                                                            iterpool),
-                                         iterpool));
-
-        /* Now move the file into the pristine store, overwriting
-           existing files with the same checksum. */
-        SVN_ERR(svn_io_file_move(temp_path, pristine_path, iterpool));
+        extract = apr_pcalloc(result_pool, sizeof(*extract));
+        extract->temp_abspath = temp_path;
+        extract->sha1_checksum = svn_checksum_dup(sha1_checksum, result_pool);
+        extract->md5_checksum = svn_checksum_dup(md5_checksum, result_pool);
+        extract->size = finfo.size;
+        APR_ARRAY_PUSH(*pristines, pristine_extract_t *) = extract;
       }
 
       /* Add the checksums for this text-base to *TEXT_BASES_INFO. */
@@ -1147,6 +1148,82 @@ migrate_text_bases(apr_hash_t **text_bases_info,
   return SVN_NO_ERROR;
 }
 
+/* Register the text-base copies in PRISTINES (an array of
+   (pristine_extract_t *) from extract_text_bases()) in the pristine table
+   of SDB and move them into the pristine store of NEW_WCROOT_ABSPATH. */
+static svn_error_t *
+install_text_bases(const apr_array_header_t *pristines,
+                   const char *new_wcroot_abspath,
+                   svn_sqlite__db_t *sdb,
+                   apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < pristines->nelts; i++)
+    {
+      const pristine_extract_t *extract
+        = APR_ARRAY_IDX(pristines, i, pristine_extract_t *);
+      const char *pristine_path;
+      svn_sqlite__stmt_t *stmt;
+
+      svn_pool_clear(iterpool);
+
+      /* Insert a row into the pristine table. */
+      SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                        STMT_INSERT_OR_IGNORE_PRISTINE_F31));
+      SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, extract->sha1_checksum,
+                                        iterpool));
+      SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, extract->md5_checksum,
+                                        iterpool));
+      SVN_ERR(svn_sqlite__bind_int64(stmt, 3, extract->size));
+      SVN_ERR(svn_sqlite__insert(NULL, stmt));
+
+      SVN_ERR(svn_wc__db_pristine_get_future_path(&pristine_path,
+                                                  new_wcroot_abspath,
+                                                  extract->sha1_checksum,
+                                                  iterpool, iterpool));
+
+      /* Ensure any sharding directories exist. */
+      SVN_ERR(svn_wc__ensure_directory(svn_dirent_dirname(pristine_path,
+                                                          iterpool),
+                                       iterpool));
+
+      /* Now move the file into the pristine store, overwriting
+         existing files with the same checksum. */
+      SVN_ERR(svn_io_file_move(extract->temp_abspath, pristine_path,
+                               iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy all the text-base files from the administrative area of WC directory
+   DIR_ABSPATH into the pristine store of SDB which is located in directory
+   NEW_WCROOT_ABSPATH.
+
+   Set *TEXT_BASES_INFO to a new hash, allocated in RESULT_POOL, that maps
+   (const char *) name of the versioned file to (svn_wc__text_base_info_t *)
+   information about the pristine text. */
+static svn_error_t *
+migrate_text_bases(apr_hash_t **text_bases_info,
+                   const char *dir_abspath,
+                   const char *new_wcroot_abspath,
+                   svn_sqlite__db_t *sdb,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *pristines;
+
+  SVN_ERR(extract_text_bases(text_bases_info, &pristines, dir_abspath,
+                             new_wcroot_abspath, result_pool, scratch_pool));
+
+  return svn_error_trace(install_text_bases(pristines, new_wcroot_abspath,
+                                            sdb, scratch_pool));
+}
+
 svn_error_t *
 svn_wc__upgrade_conflict_skel_from_raw(svn_skel_t **conflicts,
                                        svn_wc__db_t *db,
@@ -1928,6 +2005,378 @@ upgrade_working_copy(void *parent_baton,
 }
 
 
+/* Everything the extraction pass collects about one pre-1.7 directory,
+   handed from a worker thread to the single SDB writer. */
+typedef struct upgrade_extract_t
+{
+  /* Absolute path of the directory. */
+  const char *dir_abspath;
+
+  /* TRUE when the directory is skipped (already a wc-ng working copy, or
+     obstructed by an unversioned directory); the remaining fields are
+     then undefined. */
+  svn_boolean_t skipped;
+
+  /* The old format of this directory. */
+  int old_format;
+
+  /* The parsed entries of this directory. */
+  apr_hash_t *entries;
+
+  /* All wcprops of this directory, or NULL when they are lost. */
+  apr_hash_t *all_wcprops;
+
+  /* Pristine texts still to be installed; see extract_text_bases(). */
+  apr_array_header_t *pristines;
+
+  /* Maps versioned file name to (svn_wc__text_base_info_t *). */
+  apr_hash_t *text_bases_info;
+} upgrade_extract_t;
+
+/* A directory whose entries have been written, kept around while its
+   children are being written. */
+typedef struct written_dir_t
+{
+  const char *dir_abspath;
+  void *dir_baton;      /* from svn_wc__write_upgraded_entries() */
+  apr_pool_t *pool;     /* holds DIR_BATON and this struct */
+} written_dir_t;
+
+/* Output baton for the parallel upgrade: the state of the single thread
+   that performs all writes to the new SDB. */
+struct upgrade_writer_baton
+{
+  svn_wc__db_t *db;
+  const struct upgrade_data_t *data;
+
+  svn_wc_upgrade_get_repos_info_t repos_info_func;
+  void *repos_info_baton;
+  apr_hash_t *repos_cache;
+
+  svn_wc_notify_func2_t notify_func;
+  void *notify_baton;
+
+  /* Stack of (written_dir_t *): the ancestors of the directory currently
+     being written, deepest last. */
+  apr_array_header_t *written_dirs;
+  apr_pool_t *pool;
+};
+
+/* Process baton for one extract_dir_process() task. */
+struct upgrade_extract_baton
+{
+  const char *dir_abspath;
+  const char *new_wcroot_abspath;
+};
+
+/* Thread context for the extraction workers: a private wc.db instance. */
+struct upgrade_thread_context
+{
+  svn_wc__db_t *db;
+};
+
+/* Implements svn_task__thread_context_constructor_t.  Open a private
+   wc.db connection for one worker thread. */
+static svn_error_t *
+upgrade_context_constructor(void **thread_context,
+                            void *context_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  struct upgrade_thread_context *context = apr_pcalloc(result_pool,
+                                                       sizeof(*context));
+
+  SVN_ERR(svn_wc__db_open(&context->db, NULL /* ### config */,
+                          TRUE /* open_without_upgrade */,
+                          FALSE /* enforce_empty_wq */,
+                          result_pool, scratch_pool));
+
+  *thread_context = context;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t; runs on a worker thread.  Collect
+   everything about the directory in PROCESS_BATON that can be had without
+   touching the new SDB, and queue a sub-task for every versioned
+   subdirectory.  The extracted data is handed to the output function
+   before the output of any of the sub-tasks, so the writer sees the
+   directories in the order the sequential upgrade visits them. */
+static svn_error_t *
+extract_dir_process(void **result,
+                    svn_task__t *task,
+                    void *thread_context,
+                    void *process_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  struct upgrade_extract_baton *eb = process_baton;
+  struct upgrade_thread_context *context = thread_context;
+  upgrade_extract_t *extract = apr_pcalloc(result_pool, sizeof(*extract));
+  apr_array_header_t *subdirs = NULL;
+  const char *logfile_path;
+  svn_node_kind_t logfile_on_disk_kind;
+  svn_error_t *err;
+  int i;
+
+  *result = NULL;
+  extract->dir_abspath = apr_pstrdup(result_pool, eb->dir_abspath);
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  SVN_ERR(svn_wc__db_temp_get_format(&extract->old_format, context->db,
+                                     eb->dir_abspath, scratch_pool));
+
+  if (extract->old_format >= SVN_WC__WC_NG_VERSION)
+    extract->skipped = TRUE;
+  else
+    {
+      err = get_versioned_subdirs(&subdirs, NULL, eb->dir_abspath, FALSE,
+                                  scratch_pool, scratch_pool);
+      if (err && (APR_STATUS_IS_ENOENT(err->apr_err)
+                  || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+        {
+          /* An unversioned dir is obstructing a versioned dir */
+          svn_error_clear(err);
+          extract->skipped = TRUE;
+        }
+      else
+        SVN_ERR(err);
+    }
+
+  if (extract->skipped)
+    {
+      *result = extract;
+      return SVN_NO_ERROR;
+    }
+
+  /* Don't try to mess with the WC if there are old log files left. */
+  logfile_path = svn_wc__adm_child(eb->dir_abspath, ADM_LOG, scratch_pool);
+  SVN_ERR(svn_io_check_path(logfile_path, &logfile_on_disk_kind,
+                            scratch_pool));
+  if (logfile_on_disk_kind == svn_node_file)
+    return svn_error_create(SVN_ERR_WC_UNSUPPORTED_FORMAT, NULL,
+                            _("Cannot upgrade with existing logs; run a "
+                              "cleanup operation on this working copy using "
+                              "a client version which is compatible with this "
+                              "working copy's format (such as the version "
+                              "you are upgrading from), then retry the "
+                              "upgrade with the current version"));
+
+  /* Lock this working copy directory, or steal an existing lock. Do this
+     BEFORE we read the entries. We don't want another process to modify the
+     entries after we've read them into memory.  */
+  SVN_ERR(create_physical_lock(eb->dir_abspath, scratch_pool));
+
+  SVN_ERR(svn_wc__read_entries_old(&extract->entries, eb->dir_abspath,
+                                   result_pool, scratch_pool));
+
+  /* If we don't know precisely where the wcprops are, ignore them.  */
+  if (extract->old_format == SVN_WC__WCPROPS_LOST)
+    extract->all_wcprops = NULL;
+  else if (extract->old_format <= SVN_WC__WCPROPS_MANY_FILES_VERSION)
+    SVN_ERR(read_many_wcprops(&extract->all_wcprops, eb->dir_abspath,
+                              result_pool, scratch_pool));
+  else
+    SVN_ERR(read_wcprops(&extract->all_wcprops, eb->dir_abspath,
+                         result_pool, scratch_pool));
+
+  SVN_ERR(extract_text_bases(&extract->text_bases_info, &extract->pristines,
+                             eb->dir_abspath, eb->new_wcroot_abspath,
+                             result_pool, scratch_pool));
+
+  for (i = 0; i < subdirs->nelts; i++)
+    {
+      const char *child_abspath = APR_ARRAY_IDX(subdirs, i, const char *);
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      struct upgrade_extract_baton *child_eb
+        = apr_pcalloc(process_pool, sizeof(*child_eb));
+
+      child_eb->dir_abspath = apr_pstrdup(process_pool, child_abspath);
+      child_eb->new_wcroot_abspath = apr_pstrdup(process_pool,
+                                                 eb->new_wcroot_abspath);
+
+      SVN_ERR(svn_task__add_similar(task, process_pool,
+                                    i == 0 ? extract : NULL, child_eb));
+    }
+
+  if (subdirs->nelts == 0)
+    *result = extract;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t; runs on the main thread.  Write one
+   extracted directory into the new SDB.  This performs the write half of
+   upgrade_to_wcng(). */
+static svn_error_t *
+upgrade_dir_output(svn_task__t *task,
+                   void *result,
+                   void *output_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  struct upgrade_writer_baton *wb = output_baton;
+  upgrade_extract_t *extract = result;
+  const struct upgrade_data_t *data = wb->data;
+  written_dir_t *written;
+  void *parent_baton = NULL;
+  void *dir_baton;
+  const char *parent_abspath;
+  svn_wc_entry_t *this_dir;
+  const char *old_wcroot_abspath, *dir_relpath;
+  apr_pool_t *dir_pool;
+  svn_error_t *err;
+
+  if (extract->skipped)
+    {
+      if (wb->notify_func)
+        wb->notify_func(wb->notify_baton,
+                        svn_wc_create_notify(extract->dir_abspath,
+                                             svn_wc_notify_skip,
+                                             scratch_pool),
+                        scratch_pool);
+      return SVN_NO_ERROR;
+    }
+
+  /* Unwind to the parent of this directory; anything deeper on the stack
+     has no further children to write. */
+  parent_abspath = svn_dirent_dirname(extract->dir_abspath, scratch_pool);
+  while (wb->written_dirs->nelts > 0)
+    {
+      written = APR_ARRAY_IDX(wb->written_dirs, wb->written_dirs->nelts - 1,
+                              written_dir_t *);
+      if (strcmp(written->dir_abspath, parent_abspath) == 0)
+        {
+          parent_baton = written->dir_baton;
+          break;
+        }
+
+      apr_array_pop(wb->written_dirs);
+      svn_pool_destroy(written->pool);
+    }
+
+  this_dir = svn_hash_gets(extract->entries, SVN_WC_ENTRY_THIS_DIR);
+  SVN_ERR(ensure_repos_info(this_dir, extract->dir_abspath,
+                            wb->repos_info_func, wb->repos_info_baton,
+                            wb->repos_cache, scratch_pool, scratch_pool));
+
+  /* Cache repos UUID pairs for when a subdir doesn't have this information */
+  if (!svn_hash_gets(wb->repos_cache, this_dir->repos))
+    {
+      apr_pool_t *hash_pool = apr_hash_pool_get(wb->repos_cache);
+
+      svn_hash_sets(wb->repos_cache,
+                    apr_pstrdup(hash_pool, this_dir->repos),
+                    apr_pstrdup(hash_pool, this_dir->uuid));
+    }
+
+  old_wcroot_abspath = svn_dirent_get_longest_ancestor(extract->dir_abspath,
+                                                       data->root_abspath,
+                                                       scratch_pool);
+  dir_relpath = svn_dirent_skip_ancestor(old_wcroot_abspath,
+                                         extract->dir_abspath);
+
+  /***** TEXT BASES *****/
+  SVN_ERR(install_text_bases(extract->pristines, data->root_abspath,
+                             data->sdb, scratch_pool));
+
+  /***** ENTRIES - WRITE *****/
+  dir_pool = svn_pool_create(wb->pool);
+  err = svn_wc__write_upgraded_entries(&dir_baton, parent_baton, wb->db,
+                                       data->sdb, data->repos_id, data->wc_id,
+                                       extract->dir_abspath,
+                                       data->root_abspath,
+                                       extract->entries,
+                                       extract->text_bases_info,
+                                       dir_pool, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_WC_CORRUPT)
+    return svn_error_quick_wrap(err,
+                                _("This working copy is corrupt and "
+                                  "cannot be upgraded. Please check out "
+                                  "a new working copy."));
+  else
+    SVN_ERR(err);
+
+  written = apr_pcalloc(dir_pool, sizeof(*written));
+  written->dir_abspath = apr_pstrdup(dir_pool, extract->dir_abspath);
+  written->dir_baton = dir_baton;
+  written->pool = dir_pool;
+  APR_ARRAY_PUSH(wb->written_dirs, written_dir_t *) = written;
+
+  /***** WC PROPS *****/
+  if (extract->all_wcprops)
+    SVN_ERR(upgrade_apply_dav_cache(data->sdb, dir_relpath, data->wc_id,
+                                    extract->all_wcprops, scratch_pool));
+
+  /* Upgrade all the properties (including "this dir").
+
+     Note: this must come AFTER the entries have been migrated into the
+     database. The upgrade process needs the children in BASE_NODE and
+     WORKING_NODE, and to examine the resultant WORKING state.  */
+  SVN_ERR(migrate_props(extract->dir_abspath, data->root_abspath, data->sdb,
+                        extract->old_format, data->wc_id, scratch_pool));
+
+  if (wb->notify_func)
+    wb->notify_func(wb->notify_baton,
+                    svn_wc_create_notify(extract->dir_abspath,
+                                         svn_wc_notify_upgraded_path,
+                                         scratch_pool),
+                    scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Parallel replacement for upgrade_working_copy(): extract the old
+   metadata of the directory tree at DIR_ABSPATH on up to THREAD_COUNT
+   worker threads, while this thread performs all writes to the new SDB
+   in the order the sequential upgrade would. */
+static svn_error_t *
+upgrade_working_copy_parallel(apr_int32_t thread_count,
+                              svn_wc__db_t *db,
+                              const char *dir_abspath,
+                              svn_wc_upgrade_get_repos_info_t repos_info_func,
+                              void *repos_info_baton,
+                              apr_hash_t *repos_cache,
+                              const struct upgrade_data_t *data,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              svn_wc_notify_func2_t notify_func,
+                              void *notify_baton,
+                              apr_pool_t *scratch_pool)
+{
+  struct upgrade_writer_baton wb = { 0 };
+  struct upgrade_extract_baton eb;
+
+  wb.db = db;
+  wb.data = data;
+  wb.repos_info_func = repos_info_func;
+  wb.repos_info_baton = repos_info_baton;
+  wb.repos_cache = repos_cache;
+  wb.notify_func = notify_func;
+  wb.notify_baton = notify_baton;
+  wb.written_dirs = apr_array_make(scratch_pool, 16, sizeof(written_dir_t *));
+  wb.pool = svn_pool_create(scratch_pool);
+
+  eb.dir_abspath = dir_abspath;
+  eb.new_wcroot_abspath = data->root_abspath;
+
+  SVN_ERR(svn_task__run(thread_count, extract_dir_process, &eb,
+                        upgrade_dir_output, &wb,
+                        upgrade_context_constructor, NULL,
+                        cancel_func, cancel_baton,
+                        scratch_pool, scratch_pool));
+
+  svn_pool_destroy(wb.pool);
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Return a verbose error if LOCAL_ABSPATH is a not a pre-1.7 working
    copy root */
 static svn_error_t *
@@ -1998,18 +2447,21 @@ is_old_wcroot(const char *local_abspath,
     svn_dirent_local_style(parent_abspath, scratch_pool));
 }
 
-svn_error_t *
-svn_wc__upgrade(int *result_format_p,
-                svn_wc_context_t *wc_ctx,
-                const char *local_abspath,
-                int target_format,
-                svn_wc_upgrade_get_repos_info_t repos_info_func,
-                void *repos_info_baton,
-                svn_cancel_func_t cancel_func,
-                void *cancel_baton,
-                svn_wc_notify_func2_t notify_func,
-                void *notify_baton,
-                apr_pool_t *scratch_pool)
+/* The body of svn_wc__upgrade() and svn_wc__upgrade_parallel(); with a
+   THREAD_COUNT above 1 the old metadata is extracted on worker threads. */
+static svn_error_t *
+upgrade_internal(int *result_format_p,
+                 svn_wc_context_t *wc_ctx,
+                 const char *local_abspath,
+                 int target_format,
+                 apr_int32_t thread_count,
+                 svn_wc_upgrade_get_repos_info_t repos_info_func,
+                 void *repos_info_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 svn_wc_notify_func2_t notify_func,
+                 void *notify_baton,
+                 apr_pool_t *scratch_pool)
 {
   svn_wc__db_t *db;
   struct upgrade_data_t data = { NULL };
@@ -2117,12 +2569,19 @@ svn_wc__upgrade(int *result_format_p,
                                    scratch_pool));
 
   SVN_SQLITE__WITH_LOCK(
-    upgrade_working_copy(NULL, db, local_abspath,
-                         repos_info_func, repos_info_baton,
-                         repos_cache, &data,
-                         cancel_func, cancel_baton,
-                         notify_func, notify_baton,
-                         scratch_pool, scratch_pool),
+    thread_count > 1
+      ? upgrade_working_copy_parallel(thread_count, db, local_abspath,
+                                      repos_info_func, repos_info_baton,
+                                      repos_cache, &data,
+                                      cancel_func, cancel_baton,
+                                      notify_func, notify_baton,
+                                      scratch_pool)
+      : upgrade_working_copy(NULL, db, local_abspath,
+                             repos_info_func, repos_info_baton,
+                             repos_cache, &data,
+                             cancel_func, cancel_baton,
+                             notify_func, notify_baton,
+                             scratch_pool, scratch_pool),
     data.sdb);
 
   /* A workqueue item to move the pristine dir into place */
@@ -2165,6 +2624,51 @@ svn_wc__upgrade(int *result_format_p,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__upgrade(int *result_format_p,
+                svn_wc_context_t *wc_ctx,
+                const char *local_abspath,
+                int target_format,
+                svn_wc_upgrade_get_repos_info_t repos_info_func,
+                void *repos_info_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                svn_wc_notify_func2_t notify_func,
+                void *notify_baton,
+                apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(
+           upgrade_internal(result_format_p, wc_ctx, local_abspath,
+                            target_format, 1 /* thread_count */,
+                            repos_info_func, repos_info_baton,
+                            cancel_func, cancel_baton,
+                            notify_func, notify_baton,
+                            scratch_pool));
+}
+
+svn_error_t *
+svn_wc__upgrade_parallel(int *result_format_p,
+                         svn_wc_context_t *wc_ctx,
+                         const char *local_abspath,
+                         int target_format,
+                         apr_int32_t thread_count,
+                         svn_wc_upgrade_get_repos_info_t repos_info_func,
+                         void *repos_info_baton,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         svn_wc_notify_func2_t notify_func,
+                         void *notify_baton,
+                         apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(
+           upgrade_internal(result_format_p, wc_ctx, local_abspath,
+                            target_format, thread_count,
+                            repos_info_func, repos_info_baton,
+                            cancel_func, cancel_baton,
+                            notify_func, notify_baton,
+                            scratch_pool));
+}
+
 svn_error_t *
 svn_wc__upgrade_add_external_info(svn_wc_context_t *wc_ctx,
                                   const char *local_abspath,
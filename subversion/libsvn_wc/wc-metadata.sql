@@ -713,7 +713,8 @@ WHERE l.op_depth = 0
    - Add the 'hydrated' column to the PRISTINE table.
    - Add the I_PRISTINE_UNREFERENCED index.
    - Add the TEXTBASE_REFS table.
-   - Add the SETTINGS table. */
+   - Add the SETTINGS table.
+   - Add the 'translated_checksum' column to the NODES table. */
 -- STMT_UPGRADE_TO_32
 /* True iff the pristine contents are currently available on disk. */
 ALTER TABLE PRISTINE ADD COLUMN hydrated INTEGER NOT NULL DEFAULT 1;
@@ -765,14 +766,25 @@ BEGIN
     AND op_depth = OLD.op_depth;
 END;
 
+/* Checksum of the file contents as installed in the working copy, i.e.
+   with keyword and eol translation applied.  Only maintained together with
+   translated_size and last_mod_time when a file is installed; NULL when
+   unknown.  Used to detect the unmodified state of translated files
+   without detranslating their contents. */
+ALTER TABLE NODES ADD COLUMN translated_checksum  TEXT;
+
 /* This table contains settings of a working copy, identified by WC_ID. */
 CREATE TABLE SETTINGS (
   wc_id  INTEGER NOT NULL REFERENCES WCROOT (id) PRIMARY KEY,
-  store_pristine  INTEGER
+  store_pristine  INTEGER,
+  /* True iff the pristine files of this working copy are stored in the
+     LZ4 block-compressed format.  Fixed for the lifetime of the working
+     copy, so that the pristine store stays homogeneous. */
+  compress_pristine  INTEGER
 );
 
 /* Migrate existing working copy settings. */
-INSERT OR IGNORE INTO SETTINGS SELECT id, 1 FROM WCROOT;
+INSERT OR IGNORE INTO SETTINGS SELECT id, 1, 0 FROM WCROOT;
 
 PRAGMA user_version = 32;
 
@@ -85,6 +85,18 @@ LEFT OUTER JOIN lock ON nodes.repos_id = lock.repos_id
   AND nodes.repos_path = lock.repos_relpath
 WHERE wc_id = ?1 AND parent_relpath = ?2 AND op_depth = 0
 
+-- STMT_SELECT_BASE_SUBTREE_CHILDREN_INFO_LOCK
+SELECT local_relpath, nodes.repos_id, nodes.repos_path, presence, kind,
+  revision, depth, file_external,
+  lock_token, lock_owner, lock_comment, lock_date
+FROM nodes
+LEFT OUTER JOIN lock ON nodes.repos_id = lock.repos_id
+  AND nodes.repos_path = lock.repos_relpath
+WHERE wc_id = ?1 AND op_depth = 0
+  AND (parent_relpath = ?2
+       OR IS_STRICT_DESCENDANT_OF(parent_relpath, ?2))
+ORDER BY local_relpath
+
 
 -- STMT_SELECT_WORKING_NODE
 SELECT op_depth, presence, kind, checksum, translated_size,
@@ -174,6 +186,27 @@ SELECT local_relpath, changelist, properties, conflict_data
 FROM actual_node
 WHERE wc_id = ?1 AND parent_relpath = ?2
 
+-- STMT_SELECT_SUBTREE_NODE_INFO
+/* The ascending (local_relpath, op_depth) order is the natural order of
+   the primary key, so the whole subtree streams without a sort step and
+   all layers of one node arrive adjacently, deepest layer last. */
+SELECT op_depth, nodes.repos_id, nodes.repos_path, presence, kind, revision,
+  checksum, translated_size, changed_revision, changed_date, changed_author,
+  depth, symlink_target, last_mod_time, properties, lock_token, lock_owner,
+  lock_comment, lock_date, local_relpath, moved_here, moved_to, file_external
+FROM nodes
+LEFT OUTER JOIN lock ON nodes.repos_id = lock.repos_id
+  AND nodes.repos_path = lock.repos_relpath AND nodes.op_depth = 0
+WHERE wc_id = ?1
+  AND (local_relpath = ?2 OR IS_STRICT_DESCENDANT_OF(local_relpath, ?2))
+ORDER BY local_relpath, op_depth
+
+-- STMT_SELECT_SUBTREE_ACTUAL_INFO
+SELECT local_relpath, changelist, conflict_data
+FROM actual_node
+WHERE wc_id = ?1
+  AND (local_relpath = ?2 OR IS_STRICT_DESCENDANT_OF(local_relpath, ?2))
+
 -- STMT_SELECT_REPOSITORY_BY_ID
 SELECT root, uuid FROM repository WHERE id = ?1
 
@@ -351,6 +384,23 @@ WHERE wc_id = ?1
   AND presence IN (MAP_NORMAL, MAP_INCOMPLETE)
 ORDER BY local_relpath
 
+/* Used by the update-move machinery to read a whole layer in one go */
+-- STMT_SELECT_OP_DEPTH_SUBTREE
+SELECT local_relpath, presence, kind, checksum, properties
+FROM nodes
+WHERE wc_id = ?1
+  AND (local_relpath = ?2
+       OR IS_STRICT_DESCENDANT_OF(local_relpath, ?2))
+  AND op_depth = ?3
+  AND presence IN (MAP_NORMAL, MAP_INCOMPLETE)
+ORDER BY local_relpath
+
+-- STMT_SELECT_SHADOWED_DESCENDANTS
+SELECT DISTINCT local_relpath FROM nodes
+WHERE wc_id = ?1
+  AND IS_STRICT_DESCENDANT_OF(local_relpath, ?2)
+  AND op_depth > ?3
+
 /* Used by non-recursive revert to detect higher level children, and
    actual-only rows that would be left orphans, if the revert
    proceeded. */
@@ -566,6 +616,19 @@ WHERE wc_id = ?1 AND local_relpath = ?2
   AND op_depth = (SELECT MAX(op_depth) FROM nodes
                   WHERE wc_id = ?1 AND local_relpath = ?2)
 
+-- STMT_UPDATE_NODE_FILEINFO_F32
+UPDATE nodes SET translated_size = ?3, last_mod_time = ?4,
+                 translated_checksum = ?5
+WHERE wc_id = ?1 AND local_relpath = ?2
+  AND op_depth = (SELECT MAX(op_depth) FROM nodes
+                  WHERE wc_id = ?1 AND local_relpath = ?2)
+
+-- STMT_SELECT_TRANSLATED_CHECKSUM
+SELECT translated_checksum FROM nodes
+WHERE wc_id = ?1 AND local_relpath = ?2
+  AND op_depth = (SELECT MAX(op_depth) FROM nodes
+                  WHERE wc_id = ?1 AND local_relpath = ?2)
+
 -- STMT_INSERT_ACTUAL_CONFLICT
 INSERT INTO actual_node (wc_id, local_relpath, conflict_data, parent_relpath)
 VALUES (?1, ?2, ?3, ?4)
@@ -880,6 +943,9 @@ INSERT INTO work_queue (work) VALUES (?1)
 -- STMT_SELECT_WORK_ITEM
 SELECT id, work FROM work_queue ORDER BY id LIMIT 1
 
+-- STMT_SELECT_WORK_ITEMS
+SELECT id, work FROM work_queue ORDER BY id LIMIT ?1
+
 -- STMT_DELETE_WORK_ITEM
 DELETE FROM work_queue WHERE id = ?1
 
@@ -1148,6 +1214,52 @@ SELECT wc_id, ?3 /*local_relpath*/, ?4 /*op_depth*/, ?5 /*parent_relpath*/,
 FROM nodes
 WHERE wc_id = ?1 AND local_relpath = ?2 AND op_depth = ?7
 
+/* Select anything below ?2 that rules out copying the subtree with a
+   single INSERT per table: nodes belonging to another operation than the
+   ?3 layer, presences the per-node copy code refuses to copy, moved-away
+   nodes and file externals (which are not copied at all). */
+-- STMT_SELECT_COPY_BARRIER_DESCENDANTS
+SELECT local_relpath FROM nodes
+WHERE wc_id = ?1
+  AND IS_STRICT_DESCENDANT_OF(local_relpath, ?2)
+  AND (op_depth != ?3
+       OR presence IN (MAP_SERVER_EXCLUDED, MAP_INCOMPLETE)
+       OR moved_to IS NOT NULL
+       OR file_external IS NOT NULL)
+LIMIT 1
+
+/* Copy the ?3 layer of everything below ?2 to below ?4, as a new layer
+   at op_depth ?5 with moved_here ?6 */
+-- STMT_INSERT_WORKING_NODE_COPY_DESCENDANTS
+INSERT OR REPLACE INTO nodes (
+    wc_id, local_relpath, op_depth, parent_relpath, repos_id,
+    repos_path, revision, presence, depth, moved_here, kind, changed_revision,
+    changed_date, changed_author, checksum, properties, translated_size,
+    last_mod_time, symlink_target )
+SELECT wc_id, RELPATH_SKIP_JOIN(?2, ?4, local_relpath), ?5 /*op_depth*/,
+    RELPATH_SKIP_JOIN(?2, ?4, parent_relpath),
+    repos_id, repos_path, revision, presence, depth,
+    ?6 /*moved_here*/, kind, changed_revision, changed_date,
+    changed_author, checksum, properties, translated_size,
+    last_mod_time, symlink_target
+FROM nodes
+WHERE wc_id = ?1
+  AND IS_STRICT_DESCENDANT_OF(local_relpath, ?2)
+  AND op_depth = ?3
+
+/* Copy the ACTUAL data of everything below ?2 to below ?3, without
+   conflicts */
+-- STMT_INSERT_ACTUAL_NODE_COPY_DESCENDANTS
+INSERT OR REPLACE INTO actual_node (
+    wc_id, local_relpath, parent_relpath, properties, changelist )
+SELECT wc_id, RELPATH_SKIP_JOIN(?2, ?3, local_relpath),
+    RELPATH_SKIP_JOIN(?2, ?3, parent_relpath),
+    properties, changelist
+FROM actual_node
+WHERE wc_id = ?1
+  AND IS_STRICT_DESCENDANT_OF(local_relpath, ?2)
+  AND (properties IS NOT NULL OR changelist IS NOT NULL)
+
 -- STMT_UPDATE_BASE_REVISION
 UPDATE nodes SET revision = ?3
 WHERE wc_id = ?1 AND local_relpath = ?2 AND op_depth = 0
@@ -1291,6 +1403,17 @@ FROM nodes_current n
 WHERE (wc_id = ?1 AND local_relpath = ?2)
    OR (wc_id = ?1 AND IS_STRICT_DESCENDANT_OF(local_relpath, ?2))
 
+-- STMT_SELECT_CURRENT_PROPS_REPOS_RECURSIVE
+/* ### Ugly OR to make sqlite use the proper optimizations */
+SELECT IFNULL((SELECT properties FROM actual_node a
+               WHERE a.wc_id = ?1 AND A.local_relpath = n.local_relpath),
+              properties),
+       local_relpath, repos_path
+FROM nodes_current n
+WHERE (wc_id = ?1 AND local_relpath = ?2)
+   OR (wc_id = ?1 AND IS_STRICT_DESCENDANT_OF(local_relpath, ?2))
+ORDER BY local_relpath
+
 -- STMT_PRAGMA_LOCKING_MODE
 PRAGMA locking_mode = exclusive;
 /* Testing shows DELETE is faster than TRUNCATE on NFS and
@@ -1460,6 +1583,13 @@ FROM revert_list
 WHERE local_relpath = ?1
 ORDER BY actual DESC
 
+-- STMT_SELECT_REVERT_LIST_TREE
+SELECT local_relpath, actual, notify, kind, op_depth, repos_id, conflict_data
+FROM revert_list
+WHERE (local_relpath = ?1
+       OR IS_STRICT_DESCENDANT_OF(local_relpath, ?1))
+ORDER BY local_relpath, actual DESC
+
 -- STMT_SELECT_REVERT_LIST_COPIED_CHILDREN
 SELECT local_relpath, kind
 FROM revert_list
@@ -1856,12 +1986,12 @@ SELECT pristine.checksum, pristine.hydrated, 0, NULL, NULL, NULL
 FROM pristine WHERE refcount = 0
 
 -- STMT_SELECT_SETTINGS
-SELECT store_pristine FROM settings WHERE wc_id = ?1
+SELECT store_pristine, compress_pristine FROM settings WHERE wc_id = ?1
 
 -- STMT_UPSERT_SETTINGS
-INSERT INTO settings (wc_id, store_pristine)
-VALUES (?1, ?2)
-ON CONFLICT(wc_id) DO UPDATE SET store_pristine=?2
+INSERT INTO settings (wc_id, store_pristine, compress_pristine)
+VALUES (?1, ?2, ?3)
+ON CONFLICT(wc_id) DO UPDATE SET store_pristine=?2, compress_pristine=?3
 
 /* ------------------------------------------------------------------------- */
 
@@ -226,6 +226,11 @@ extern "C" {
 /* Starting from this version, the DB stores per-WC settings. */
 #define SVN_WC__HAS_SETTINGS 32
 
+/* Starting from this version, the DB can record a checksum of the
+   translated (on-disk) file contents alongside the recorded size and
+   last-mod-time. */
+#define SVN_WC__HAS_TRANSLATED_CHECKSUM 32
+
 /* Return true iff error E indicates an "is not a working copy" type
    of error, either because something wasn't a working copy at all, or
    because it's a working copy from a previous version (in need of
@@ -1367,6 +1367,7 @@ init_db(/* output values */
         svn_revnum_t root_node_revision,
         svn_depth_t root_node_depth,
         svn_boolean_t store_pristine,
+        svn_boolean_t compress_pristine,
         const char *wcroot_abspath,
         apr_pool_t *scratch_pool)
 {
@@ -1393,7 +1394,8 @@ init_db(/* output values */
   if (target_format >= SVN_WC__HAS_SETTINGS)
     {
       SVN_ERR(svn_sqlite__get_statement(&stmt, db, STMT_UPSERT_SETTINGS));
-      SVN_ERR(svn_sqlite__bindf(stmt, "id", *wc_id, store_pristine));
+      SVN_ERR(svn_sqlite__bindf(stmt, "idd", *wc_id, store_pristine,
+                                compress_pristine));
       SVN_ERR(svn_sqlite__insert(NULL, stmt));
     }
 
@@ -1445,6 +1447,7 @@ create_db(svn_sqlite__db_t **sdb,
           svn_revnum_t root_node_revision,
           svn_depth_t root_node_depth,
           svn_boolean_t store_pristine,
+          svn_boolean_t compress_pristine,
           svn_boolean_t exclusive,
           apr_int32_t timeout,
           apr_pool_t *result_pool,
@@ -1459,7 +1462,8 @@ create_db(svn_sqlite__db_t **sdb,
   SVN_SQLITE__WITH_LOCK(init_db(repos_id, wc_id,
                                 *sdb, target_format, repos_root_url, repos_uuid,
                                 root_node_repos_relpath, root_node_revision,
-                                root_node_depth, store_pristine, dir_abspath,
+                                root_node_depth, store_pristine,
+                                compress_pristine, dir_abspath,
                                 scratch_pool),
                         *sdb);
 
@@ -1484,6 +1488,7 @@ svn_wc__db_init(svn_wc__db_t *db,
   apr_int64_t wc_id;
   svn_wc__db_wcroot_t *wcroot;
   svn_boolean_t sqlite_exclusive = FALSE;
+  svn_boolean_t compress_pristine = FALSE;
   apr_int32_t sqlite_timeout = 0; /* default timeout */
   apr_hash_index_t *hi;
 
@@ -1503,10 +1508,19 @@ svn_wc__db_init(svn_wc__db_t *db,
                               SVN_CONFIG_OPTION_SQLITE_EXCLUSIVE,
                               FALSE));
 
+  /* The pristine storage format is fixed at creation time, so that the
+     store stays homogeneous over the lifetime of the working copy. */
+  if (target_format >= SVN_WC__HAS_SETTINGS)
+    SVN_ERR(svn_config_get_bool(db->config, &compress_pristine,
+                                SVN_CONFIG_SECTION_WORKING_COPY,
+                                SVN_CONFIG_OPTION_COMPRESSED_PRISTINES,
+                                FALSE));
+
   /* Create the SDB and insert the basic rows.  */
   SVN_ERR(create_db(&sdb, &repos_id, &wc_id, target_format, local_abspath,
                     repos_root_url, repos_uuid, SDB_FILE,
                     repos_relpath, initial_rev, depth, store_pristine,
+                    compress_pristine,
                     sqlite_exclusive, sqlite_timeout,
                     db->state_pool, scratch_pool));
 
@@ -1515,7 +1529,7 @@ svn_wc__db_init(svn_wc__db_t *db,
                         apr_pstrdup(db->state_pool, local_abspath),
                         sdb, wc_id, FORMAT_FROM_SDB,
                         FALSE /* auto-upgrade */,
-                        store_pristine,
+                        store_pristine, compress_pristine,
                         db->state_pool, scratch_pool));
 
   /* Any previously cached children may now have a new WCROOT, most likely that
@@ -1541,6 +1555,11 @@ svn_wc__db_init(svn_wc__db_t *db,
         svn_hash_sets(db->dir_data, abspath, NULL);
     }
 
+  /* For the same reason, drop the process-global wcroot location hints:
+     directories below the new root may have been cached as belonging to
+     an outer working copy. */
+  SVN_ERR(svn_wc__db_wcroot_forget_hints(NULL, scratch_pool));
+
   /* The WCROOT is complete. Stash it into DB.  */
   svn_hash_sets(db->dir_data, wcroot->abspath, wcroot);
 
@@ -1660,6 +1679,13 @@ svn_wc__db_get_wcroot(const char **wcroot_abspath,
 }
 
 
+svn_config_t *
+svn_wc__db_get_config(svn_wc__db_t *db)
+{
+  return db->config;
+}
+
+
 svn_error_t *
 svn_wc__db_base_add_directory(svn_wc__db_t *db,
                               const char *local_abspath,
@@ -1799,21 +1825,38 @@ svn_wc__db_base_add_incomplete_directory(svn_wc__db_t *db,
 }
 
 
-/* Record RECORDED_SIZE and RECORDED_TIME into top layer in NODES */
+/* Record RECORDED_SIZE and RECORDED_TIME into top layer in NODES.
+
+   If the working copy format supports it, also record (or clear, when
+   NULL) TRANSLATED_CHECKSUM, the checksum of the translated (on-disk)
+   contents matching the recorded size and time. */
 static svn_error_t *
 db_record_fileinfo(svn_wc__db_wcroot_t *wcroot,
                    const char *local_relpath,
                    apr_int64_t recorded_size,
                    apr_int64_t recorded_time,
+                   const svn_checksum_t *translated_checksum,
                    apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
   int affected_rows;
 
-  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
-                                    STMT_UPDATE_NODE_FILEINFO));
-  SVN_ERR(svn_sqlite__bindf(stmt, "isii", wcroot->wc_id, local_relpath,
-                            recorded_size, recorded_time));
+  if (wcroot->format >= SVN_WC__HAS_TRANSLATED_CHECKSUM)
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_UPDATE_NODE_FILEINFO_F32));
+      SVN_ERR(svn_sqlite__bindf(stmt, "isii", wcroot->wc_id, local_relpath,
+                                recorded_size, recorded_time));
+      SVN_ERR(svn_sqlite__bind_checksum(stmt, 5, translated_checksum,
+                                        scratch_pool));
+    }
+  else
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_UPDATE_NODE_FILEINFO));
+      SVN_ERR(svn_sqlite__bindf(stmt, "isii", wcroot->wc_id, local_relpath,
+                                recorded_size, recorded_time));
+    }
   SVN_ERR(svn_sqlite__update(&affected_rows, stmt));
 
   SVN_ERR_ASSERT(affected_rows == 1);
@@ -1841,6 +1884,8 @@ install_working_file(svn_wc__db_wcroot_t *wcroot,
       SVN_ERR(svn_wc__working_file_writer_finalize(&mtime, &size, file_writer,
                                                    scratch_pool));
       SVN_ERR(db_record_fileinfo(wcroot, local_relpath, size, mtime,
+                                 svn_wc__working_file_writer_get_checksum(
+                                   file_writer),
                                  scratch_pool));
     }
   else
@@ -2159,6 +2204,107 @@ svn_wc__db_base_add_not_present_node(svn_wc__db_t *db,
     kind, svn_wc__db_status_not_present, conflict, work_items, scratch_pool);
 }
 
+/* The body of svn_wc__db_base_add_not_present_nodes(), run inside one
+   transaction on WCROOT:  insert a not-present base node for every
+   child in NODES below PARENT_RELPATH / PARENT_REPOS_RELPATH. */
+static svn_error_t *
+insert_not_present_nodes(svn_wc__db_wcroot_t *wcroot,
+                         const char *parent_relpath,
+                         const char *parent_repos_relpath,
+                         const char *repos_root_url,
+                         const char *repos_uuid,
+                         svn_revnum_t revision,
+                         apr_hash_t *nodes,
+                         apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, nodes);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      insert_base_baton_t ibb;
+      const char *local_relpath;
+
+      svn_pool_clear(iterpool);
+
+      blank_ibb(&ibb);
+
+      /* Calculate repos_id in insert_base_node() to avoid extra
+         transaction */
+      ibb.repos_root_url = repos_root_url;
+      ibb.repos_uuid = repos_uuid;
+
+      ibb.status = svn_wc__db_status_not_present;
+      ibb.kind = svn_node_kind_from_word(apr_hash_this_val(hi));
+      ibb.repos_relpath = svn_relpath_join(parent_repos_relpath, name,
+                                           iterpool);
+      ibb.revision = revision;
+
+      local_relpath = svn_relpath_join(parent_relpath, name, iterpool);
+      SVN_ERR(insert_base_node(&ibb, wcroot, local_relpath, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_base_add_not_present_nodes(svn_wc__db_t *db,
+                                      const char *parent_abspath,
+                                      const char *parent_repos_relpath,
+                                      const char *repos_root_url,
+                                      const char *repos_uuid,
+                                      svn_revnum_t revision,
+                                      apr_hash_t *nodes,
+                                      apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  apr_hash_index_t *hi;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(parent_abspath));
+  SVN_ERR_ASSERT(parent_repos_relpath != NULL);
+  SVN_ERR_ASSERT(svn_uri_is_canonical(repos_root_url, scratch_pool));
+  SVN_ERR_ASSERT(repos_uuid != NULL);
+  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(revision));
+
+  if (apr_hash_count(nodes) == 0)
+    return SVN_NO_ERROR;
+
+  /* As in add_excluded_or_not_present_node(), anchor on the parent so
+     that working copies obstructing a child cannot redirect us. */
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              parent_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_WC__DB_WITH_TXN(
+            insert_not_present_nodes(wcroot, local_relpath,
+                                     parent_repos_relpath, repos_root_url,
+                                     repos_uuid, revision, nodes,
+                                     scratch_pool),
+            wcroot);
+
+  for (hi = apr_hash_first(scratch_pool, nodes);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *child_abspath = svn_dirent_join(parent_abspath,
+                                                  apr_hash_this_key(hi),
+                                                  scratch_pool);
+
+      /* If this used to be a directory we should remove children so
+       * pass depth infinity. */
+      SVN_ERR(flush_entries(wcroot, child_abspath, svn_depth_infinity,
+                            scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Recursively clear moved-here information at the copy-half of the move
  * which moved a node to MOVED_TO_RELPATH. This transforms this side of the
  * move into a simple copy.
@@ -2881,6 +3027,124 @@ svn_wc__db_base_get_children_info(apr_hash_t **nodes,
                                                 scratch_pool));
 }
 
+/* The implementation of svn_wc__db_base_get_subtree_children_info */
+static svn_error_t *
+base_get_subtree_children_info(apr_hash_t **nodes_map,
+                               svn_wc__db_wcroot_t *wcroot,
+                               const char *local_relpath,
+                               apr_pool_t *result_pool,
+                               apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_int64_t last_repos_id = INVALID_REPOS_ID;
+  const char *last_repos_root_url = NULL;
+  const char *last_parent_relpath = NULL;
+  apr_hash_t *last_children = NULL;
+
+  *nodes_map = apr_hash_make(result_pool);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_BASE_SUBTREE_CHILDREN_INFO_LOCK));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      struct svn_wc__db_base_info_t *info;
+      apr_int64_t repos_id;
+      const char *child_relpath = svn_sqlite__column_text(stmt, 0, NULL);
+      const char *name = svn_relpath_basename(child_relpath, result_pool);
+      const char *parent_relpath = svn_relpath_dirname(child_relpath,
+                                                       scratch_pool);
+
+      /* The rows are ordered by path, so consecutive rows usually share
+         their parent directory. */
+      if (last_parent_relpath == NULL
+          || strcmp(parent_relpath, last_parent_relpath) != 0)
+        {
+          const char *key = svn_relpath_skip_ancestor(local_relpath,
+                                                      parent_relpath);
+
+          SVN_ERR_ASSERT(key != NULL);
+
+          last_children = svn_hash_gets(*nodes_map, key);
+          if (last_children == NULL)
+            {
+              last_children = apr_hash_make(result_pool);
+              svn_hash_sets(*nodes_map, apr_pstrdup(result_pool, key),
+                            last_children);
+            }
+          last_parent_relpath = apr_pstrdup(scratch_pool, parent_relpath);
+        }
+
+      info = apr_pcalloc(result_pool, sizeof(*info));
+
+      repos_id = svn_sqlite__column_int64(stmt, 1);
+      info->repos_relpath = svn_sqlite__column_text(stmt, 2, result_pool);
+      info->status = svn_sqlite__column_token(stmt, 3, presence_map);
+      info->kind = svn_sqlite__column_token(stmt, 4, kind_map);
+      info->revnum = svn_sqlite__column_revnum(stmt, 5);
+
+      info->depth = svn_sqlite__column_token_null(stmt, 6, depth_map,
+                                                  svn_depth_unknown);
+
+      info->update_root = svn_sqlite__column_boolean(stmt, 7);
+
+      info->lock = lock_from_columns(stmt, 8, 9, 10, 11, result_pool);
+
+      if (repos_id != last_repos_id)
+        {
+          svn_error_t *err;
+
+          err = svn_wc__db_fetch_repos_info(&last_repos_root_url, NULL,
+                                            wcroot, repos_id,
+                                            result_pool);
+
+          if (err)
+            return svn_error_trace(
+                     svn_error_compose_create(err,
+                                              svn_sqlite__reset(stmt)));
+
+          last_repos_id = repos_id;
+        }
+
+      info->repos_root_url = last_repos_root_url;
+
+      svn_hash_sets(last_children, name, info);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_base_get_subtree_children_info(apr_hash_t **nodes_map,
+                                          svn_wc__db_t *db,
+                                          const char *dir_abspath,
+                                          apr_pool_t *result_pool,
+                                          apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(dir_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              dir_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  return svn_error_trace(base_get_subtree_children_info(nodes_map,
+                                                        wcroot,
+                                                        local_relpath,
+                                                        result_pool,
+                                                        scratch_pool));
+}
+
 
 svn_error_t *
 svn_wc__db_base_get_props(apr_hash_t **props,
@@ -4977,6 +5241,106 @@ svn_wc__db_op_copy(svn_wc__db_t *db,
   return SVN_NO_ERROR;
 }
 
+/* The guts of svn_wc__db_op_copy_subtree(); WCROOT is the common working
+   copy root of SRC_RELPATH and DST_RELPATH. */
+static svn_error_t *
+op_copy_subtree_txn(svn_boolean_t *done,
+                    svn_wc__db_wcroot_t *wcroot,
+                    const char *src_relpath,
+                    const char *dst_relpath,
+                    apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  int src_op_depth;
+  int dst_op_depth;
+  int moved_here;
+
+  SVN_ERR(op_depth_of(&src_op_depth, wcroot, src_relpath));
+
+  /* Off to the node-by-node code when anything below SRC_RELPATH needs
+     more than a plain row copy. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_COPY_BARRIER_DESCENDANTS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "isd", wcroot->wc_id, src_relpath,
+                            src_op_depth));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  SVN_ERR(svn_sqlite__reset(stmt));
+  if (have_row)
+    return SVN_NO_ERROR;
+
+  /* The destination root has already been copied; its children extend the
+     same operation and inherit its moved-here status. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_NODE_INFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, dst_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  SVN_ERR_ASSERT(have_row);
+  dst_op_depth = svn_sqlite__column_int(stmt, 0);
+  moved_here = svn_sqlite__column_boolean(stmt, 15);
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  /* Replace the incomplete children created for DST_RELPATH, and add the
+     rest of the subtree, in one pass per table.  The pristine reference
+     counts are maintained by the insert triggers, just like they are for
+     the per-node copy. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_INSERT_WORKING_NODE_COPY_DESCENDANTS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "isdsdd", wcroot->wc_id, src_relpath,
+                            src_op_depth, dst_relpath, dst_op_depth,
+                            moved_here));
+  SVN_ERR(svn_sqlite__step_done(stmt));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_INSERT_ACTUAL_NODE_COPY_DESCENDANTS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "iss", wcroot->wc_id, src_relpath,
+                            dst_relpath));
+  SVN_ERR(svn_sqlite__step_done(stmt));
+
+  *done = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_op_copy_subtree(svn_boolean_t *done,
+                           svn_wc__db_t *db,
+                           const char *src_abspath,
+                           const char *dst_abspath,
+                           apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *src_wcroot;
+  svn_wc__db_wcroot_t *dst_wcroot;
+  const char *src_relpath;
+  const char *dst_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(src_abspath));
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(dst_abspath));
+
+  *done = FALSE;
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&src_wcroot, &src_relpath,
+                                                db, src_abspath,
+                                                scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(src_wcroot);
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&dst_wcroot, &dst_relpath,
+                                                db, dst_abspath,
+                                                scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(dst_wcroot);
+
+  /* The row copies only work within a single database. */
+  if (src_wcroot != dst_wcroot)
+    return SVN_NO_ERROR;
+
+  SVN_WC__DB_WITH_TXN(
+    op_copy_subtree_txn(done, src_wcroot, src_relpath, dst_relpath,
+                        scratch_pool),
+    src_wcroot);
+
+  return SVN_NO_ERROR;
+}
+
 /* Remove unneeded actual nodes for svn_wc__db_op_copy_layer_internal */
 static svn_error_t *
 clear_or_remove_actual(svn_wc__db_wcroot_t *wcroot,
@@ -6183,8 +6547,12 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  /* Without knowing how the recorded values were obtained we cannot tell
+     whether a previously recorded translated checksum still describes the
+     on-disk contents, so clear it. */
   SVN_ERR(db_record_fileinfo(wcroot, local_relpath,
-                             recorded_size, recorded_time, scratch_pool));
+                             recorded_size, recorded_time, NULL,
+                             scratch_pool));
 
   /* We *totally* monkeyed the entries. Toss 'em.  */
   SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
@@ -6193,6 +6561,44 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
 }
 
 
+svn_error_t *
+svn_wc__db_read_translated_checksum(const svn_checksum_t **translated_checksum,
+                                    svn_wc__db_t *db,
+                                    const char *local_abspath,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  if (wcroot->format < SVN_WC__HAS_TRANSLATED_CHECKSUM)
+    {
+      *translated_checksum = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_TRANSLATED_CHECKSUM));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    SVN_ERR(svn_sqlite__column_checksum(translated_checksum, stmt, 0,
+                                        result_pool));
+  else
+    *translated_checksum = NULL;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+
 /* Set the ACTUAL_NODE properties column for (WC_ID, LOCAL_RELPATH) to
  * PROPS.
  *
@@ -6253,7 +6659,7 @@ svn_wc__db_op_set_props_internal(svn_wc__db_wcroot_t *wcroot,
   if (clear_recorded_info)
     {
       SVN_ERR(db_record_fileinfo(wcroot, local_relpath,
-                                 SVN_INVALID_FILESIZE, 0,
+                                 SVN_INVALID_FILESIZE, 0, NULL,
                                  scratch_pool));
     }
 
@@ -7440,6 +7846,115 @@ svn_wc__db_revert_list_read(svn_boolean_t *reverted,
 }
 
 
+/* The body of svn_wc__db_revert_list_read_tree().
+ */
+static svn_error_t *
+revert_list_read_tree(apr_hash_t **info_hash,
+                      svn_wc__db_wcroot_t *wcroot,
+                      const char *local_relpath,
+                      svn_wc__db_t *db,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  *info_hash = apr_hash_make(result_pool);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_REVERT_LIST_TREE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "s", local_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      const char *row_relpath = svn_sqlite__column_text(stmt, 0, NULL);
+      svn_boolean_t is_actual = svn_sqlite__column_boolean(stmt, 1);
+      const char *abspath = svn_dirent_join(wcroot->abspath, row_relpath,
+                                            result_pool);
+      svn_wc__db_revert_list_info_t *entry;
+
+      entry = svn_hash_gets(*info_hash, abspath);
+      if (!entry)
+        {
+          entry = apr_pcalloc(result_pool, sizeof(*entry));
+          entry->kind = svn_node_unknown;
+          entry->actual_kind = svn_node_unknown;
+          svn_hash_sets(*info_hash, abspath, entry);
+        }
+
+      /* The rows arrive ordered by path with the actual row (if any)
+         before the node row, just like in revert_list_read(). */
+      if (is_actual)
+        {
+          apr_size_t conflict_len;
+          const void *conflict_data;
+
+          conflict_data = svn_sqlite__column_blob(stmt, 6, &conflict_len,
+                                                  scratch_pool);
+          if (conflict_data)
+            {
+              svn_skel_t *conflicts = svn_skel__parse(conflict_data,
+                                                      conflict_len,
+                                                      scratch_pool);
+
+              SVN_ERR(svn_wc__conflict_read_markers(&entry->marker_files,
+                                                    db, wcroot->abspath,
+                                                    conflicts,
+                                                    result_pool,
+                                                    scratch_pool));
+            }
+
+          if (!svn_sqlite__column_is_null(stmt, 2)) /* notify */
+            {
+              entry->reverted = TRUE;
+              entry->actual_notify = svn_sqlite__column_int(stmt, 2);
+            }
+
+          if (!svn_sqlite__column_is_null(stmt, 3)) /* kind */
+            entry->actual_kind = svn_sqlite__column_token(stmt, 3,
+                                                          kind_map_none);
+        }
+      else
+        {
+          entry->reverted = TRUE;
+          entry->have_node_info = TRUE;
+          if (!svn_sqlite__column_is_null(stmt, 5)) /* repos_id */
+            {
+              int op_depth = svn_sqlite__column_int(stmt, 4);
+              entry->copied_here = (op_depth == relpath_depth(row_relpath));
+            }
+          entry->kind = svn_sqlite__column_token(stmt, 3, kind_map);
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_revert_list_read_tree(apr_hash_t **info_hash,
+                                 svn_wc__db_t *db,
+                                 const char *local_abspath,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath,
+                              db, local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_WC__DB_WITH_TXN(
+    revert_list_read_tree(info_hash, wcroot, local_relpath, db,
+                          result_pool, scratch_pool),
+    wcroot);
+  return SVN_NO_ERROR;
+}
+
+
 /* The body of svn_wc__db_revert_list_read_copied_children().
  */
 static svn_error_t *
@@ -9698,6 +10213,255 @@ svn_wc__db_read_children_info(apr_hash_t **nodes,
   return SVN_NO_ERROR;
 }
 
+/* What the ACTUAL_NODE table knows about one subtree path; helper for
+   read_subtree_info(). */
+struct subtree_actual_t
+{
+  const char *changelist;
+  svn_boolean_t conflicted;
+};
+
+/* Implementation of svn_wc__db_read_subtree_info().  ACTUAL maps
+   const char * local_relpath -> struct subtree_actual_t *, pre-read
+   from the ACTUAL_NODE table. */
+static svn_error_t *
+read_subtree_info(svn_wc__db_wcroot_t *wcroot,
+                  const char *local_relpath,
+                  svn_boolean_t show_hidden,
+                  apr_hash_t *actual,
+                  svn_wc__db_subtree_info_receiver_t receiver,
+                  void *receiver_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  const char *cur_relpath = NULL;
+  svn_wc__db_subtree_info_t *cur_info = NULL;
+  svn_node_kind_t cur_kind = svn_node_unknown;
+  svn_boolean_t cur_hidden = FALSE;
+  svn_boolean_t seen_any = FALSE;
+  apr_int64_t last_repos_id = INVALID_REPOS_ID;
+  const char *repos_root_url = NULL;
+  const char *repos_uuid = NULL;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_SUBTREE_NODE_INFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (TRUE)
+    {
+      const char *row_relpath
+        = have_row ? svn_sqlite__column_text(stmt, 19, NULL) : NULL;
+      svn_error_t *err;
+
+      /* All rows of the previous node are in; report it. */
+      if (cur_relpath
+          && (!have_row || strcmp(row_relpath, cur_relpath) != 0))
+        {
+          svn_boolean_t is_target = (strcmp(cur_relpath, local_relpath) == 0);
+
+          if (cancel_func)
+            {
+              err = cancel_func(cancel_baton);
+              if (err)
+                return svn_error_compose_create(err,
+                                                svn_sqlite__reset(stmt));
+            }
+
+          /* The walk target is always reported, so that the caller can
+             distinguish a hidden target from a missing one. */
+          if (!cur_hidden || show_hidden || is_target)
+            {
+              err = receiver(receiver_baton,
+                             svn_dirent_join(wcroot->abspath, cur_relpath,
+                                             iterpool),
+                             (cur_hidden && !show_hidden) ? svn_node_none
+                                                          : cur_kind,
+                             (cur_hidden && !show_hidden) ? NULL : cur_info,
+                             iterpool);
+              if (err)
+                return svn_error_compose_create(err,
+                                                svn_sqlite__reset(stmt));
+            }
+
+          svn_pool_clear(iterpool);
+          cur_relpath = NULL;
+          cur_info = NULL;
+        }
+
+      if (!have_row)
+        break;
+
+      seen_any = TRUE;
+
+      if (cur_relpath == NULL)
+        {
+          /* Deepest (often only) layer of the next node. */
+          int op_depth = svn_sqlite__column_int(stmt, 0);
+          svn_wc__db_status_t presence
+            = svn_sqlite__column_token(stmt, 3, presence_map);
+          struct subtree_actual_t *acts;
+
+          cur_relpath = apr_pstrdup(iterpool, row_relpath);
+          cur_kind = svn_sqlite__column_token(stmt, 4, kind_map);
+          cur_hidden = (presence == svn_wc__db_status_not_present
+                        || presence == svn_wc__db_status_excluded
+                        || presence == svn_wc__db_status_server_excluded);
+
+          acts = svn_hash_gets(actual, cur_relpath);
+
+          if (op_depth == 0
+              && !(acts && acts->conflicted)
+              && (presence == svn_wc__db_status_normal
+                  || presence == svn_wc__db_status_incomplete)
+              && !svn_sqlite__column_is_null(stmt, 1))
+            {
+              apr_int64_t repos_id = svn_sqlite__column_int64(stmt, 1);
+
+              if (repos_root_url == NULL || repos_id != last_repos_id)
+                {
+                  err = svn_wc__db_fetch_repos_info(&repos_root_url,
+                                                    &repos_uuid,
+                                                    wcroot, repos_id,
+                                                    scratch_pool);
+                  if (err)
+                    return svn_error_compose_create(err,
+                                                    svn_sqlite__reset(stmt));
+                  last_repos_id = repos_id;
+                }
+
+              cur_info = apr_pcalloc(iterpool, sizeof(*cur_info));
+              cur_info->status = presence;
+              cur_info->kind = cur_kind;
+              cur_info->revision = svn_sqlite__column_revnum(stmt, 5);
+              cur_info->repos_relpath = svn_sqlite__column_text(stmt, 2,
+                                                                iterpool);
+              cur_info->repos_root_url = repos_root_url;
+              cur_info->repos_uuid = repos_uuid;
+              cur_info->changed_rev = svn_sqlite__column_revnum(stmt, 8);
+              cur_info->changed_date = svn_sqlite__column_int64(stmt, 9);
+              cur_info->changed_author = svn_sqlite__column_text(stmt, 10,
+                                                                 iterpool);
+              if (cur_kind == svn_node_dir)
+                cur_info->depth = svn_sqlite__column_token_null(
+                                    stmt, 11, depth_map, svn_depth_unknown);
+              else
+                cur_info->depth = svn_depth_unknown;
+
+              err = svn_sqlite__column_checksum(&cur_info->checksum, stmt, 6,
+                                                iterpool);
+              if (err)
+                return svn_error_compose_create(err,
+                                                svn_sqlite__reset(stmt));
+
+              cur_info->recorded_size = get_recorded_size(stmt, 7);
+              cur_info->recorded_time = svn_sqlite__column_int64(stmt, 13);
+              cur_info->changelist = acts ? acts->changelist : NULL;
+              cur_info->lock = lock_from_columns(stmt, 15, 16, 17, 18,
+                                                 iterpool);
+            }
+        }
+      else
+        {
+          /* Another layer above the base:  too complex to stream.  The
+             highest op_depth row comes last and is the visible one. */
+          svn_wc__db_status_t presence
+            = svn_sqlite__column_token(stmt, 3, presence_map);
+
+          cur_info = NULL;
+          cur_kind = svn_sqlite__column_token(stmt, 4, kind_map);
+          cur_hidden = (presence == svn_wc__db_status_not_present
+                        || presence == svn_wc__db_status_excluded
+                        || presence == svn_wc__db_status_server_excluded);
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  SVN_ERR(svn_sqlite__reset(stmt));
+  svn_pool_destroy(iterpool);
+
+  if (!seen_any)
+    return svn_error_createf(SVN_ERR_WC_PATH_NOT_FOUND, NULL,
+                             _("The node '%s' was not found."),
+                             path_for_error_message(wcroot, local_relpath,
+                                                    scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_read_subtree_info(apr_hash_t *conflict_victims,
+                             svn_wc__db_t *db,
+                             const char *local_abspath,
+                             svn_boolean_t show_hidden,
+                             svn_wc__db_subtree_info_receiver_t receiver,
+                             void *receiver_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_hash_t *actual = apr_hash_make(scratch_pool);
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                                                local_abspath,
+                                                scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  /* The ACTUAL_NODE rows of a subtree are sparse (changelists and
+     conflicts only), so one pass over them up front is cheap and saves
+     merging two ordered cursors below. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_SUBTREE_ACTUAL_INFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      const char *relpath = svn_sqlite__column_text(stmt, 0, NULL);
+      const char *changelist = svn_sqlite__column_text(stmt, 1, NULL);
+      svn_boolean_t conflicted = !svn_sqlite__column_is_null(stmt, 2);
+
+      if (changelist || conflicted)
+        {
+          struct subtree_actual_t *acts = apr_pcalloc(scratch_pool,
+                                                      sizeof(*acts));
+
+          acts->changelist = changelist ? apr_pstrdup(scratch_pool,
+                                                      changelist)
+                                        : NULL;
+          acts->conflicted = conflicted;
+          svn_hash_sets(actual, apr_pstrdup(scratch_pool, relpath), acts);
+
+          if (conflicted && conflict_victims)
+            svn_hash_sets(conflict_victims,
+                          svn_dirent_join(wcroot->abspath, relpath,
+                                          result_pool),
+                          "");
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  return svn_error_trace(
+           read_subtree_info(wcroot, local_relpath, show_hidden, actual,
+                             receiver, receiver_baton,
+                             cancel_func, cancel_baton, scratch_pool));
+}
+
 /* Implementation of svn_wc__db_read_single_info.
 
    ### This function is very similar to a lot of code inside
@@ -10645,29 +11409,90 @@ svn_wc__db_read_pristine_props(apr_hash_t **props,
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
 
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(db_read_pristine_props(props, wcroot, local_relpath, TRUE,
+                                 result_pool, scratch_pool));
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_prop_retrieve_recursive(apr_hash_t **values,
+                                   svn_wc__db_t *db,
+                                   const char *local_abspath,
+                                   const char *propname,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_pool_t *iterpool;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_CURRENT_PROPS_RECURSIVE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+
+  *values = apr_hash_make(result_pool);
+
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  iterpool = svn_pool_create(scratch_pool);
+  while (have_row)
+  {
+    apr_hash_t *node_props;
+    svn_string_t *value;
+
+    svn_pool_clear(iterpool);
+
+    SVN_ERR(svn_sqlite__column_properties(&node_props, stmt, 0,
+                                          iterpool, iterpool));
+
+    value = (node_props
+                ? svn_hash_gets(node_props, propname)
+                : NULL);
+
+    if (value)
+      {
+        svn_hash_sets(*values,
+                      svn_dirent_join(wcroot->abspath,
+                                      svn_sqlite__column_text(stmt, 1, NULL),
+                                      result_pool),
+                      svn_string_dup(value, result_pool));
+      }
 
-  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
-                              local_abspath, scratch_pool, scratch_pool));
-  VERIFY_USABLE_WCROOT(wcroot);
+    SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  }
 
-  SVN_ERR(db_read_pristine_props(props, wcroot, local_relpath, TRUE,
-                                 result_pool, scratch_pool));
-  return SVN_NO_ERROR;
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
 }
 
 svn_error_t *
-svn_wc__db_prop_retrieve_recursive(apr_hash_t **values,
-                                   svn_wc__db_t *db,
-                                   const char *local_abspath,
-                                   const char *propname,
-                                   apr_pool_t *result_pool,
-                                   apr_pool_t *scratch_pool)
+svn_wc__db_prop_retrieve_recursive2(apr_hash_t **values,
+                                    apr_hash_t **repos_relpaths,
+                                    svn_wc__db_t *db,
+                                    const char *local_abspath,
+                                    const char *propname,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
   svn_sqlite__stmt_t *stmt;
   svn_boolean_t have_row;
+  apr_hash_t *relpaths;
   apr_pool_t *iterpool;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -10677,10 +11502,17 @@ svn_wc__db_prop_retrieve_recursive(apr_hash_t **values,
   VERIFY_USABLE_WCROOT(wcroot);
 
   SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
-                                    STMT_SELECT_CURRENT_PROPS_RECURSIVE));
+                                    STMT_SELECT_CURRENT_PROPS_REPOS_RECURSIVE));
   SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
 
   *values = apr_hash_make(result_pool);
+  *repos_relpaths = apr_hash_make(result_pool);
+
+  /* Maps local_relpath to the repository relpath of every row seen so
+     far.  The rows arrive in path order, so a parent is resolved before
+     its children and rows without a stored repos_path simply inherit
+     from their parent. */
+  relpaths = apr_hash_make(scratch_pool);
 
   SVN_ERR(svn_sqlite__step(&have_row, stmt));
   iterpool = svn_pool_create(scratch_pool);
@@ -10688,11 +11520,44 @@ svn_wc__db_prop_retrieve_recursive(apr_hash_t **values,
   {
     apr_hash_t *node_props;
     svn_string_t *value;
+    const char *child_relpath;
+    const char *repos_path;
 
     svn_pool_clear(iterpool);
 
     SVN_ERR(svn_sqlite__column_properties(&node_props, stmt, 0,
                                           iterpool, iterpool));
+    child_relpath = svn_sqlite__column_text(stmt, 1, scratch_pool);
+    repos_path = svn_sqlite__column_text(stmt, 2, scratch_pool);
+
+    if (!repos_path)
+      {
+        if (strcmp(child_relpath, local_relpath) == 0)
+          {
+            /* The subtree root needs the full ancestor scan; everything
+               below it inherits from the hash. */
+            svn_error_t *err = db_read_repos_info(NULL, &repos_path, NULL,
+                                                  wcroot, local_relpath,
+                                                  scratch_pool, iterpool);
+            if (err)
+              return svn_error_compose_create(err, svn_sqlite__reset(stmt));
+          }
+        else
+          {
+            const char *parent_repos_relpath
+              = svn_hash_gets(relpaths,
+                              svn_relpath_dirname(child_relpath, iterpool));
+
+            if (parent_repos_relpath)
+              repos_path = svn_relpath_join(
+                             parent_repos_relpath,
+                             svn_relpath_basename(child_relpath, NULL),
+                             scratch_pool);
+          }
+      }
+
+    if (repos_path)
+      svn_hash_sets(relpaths, child_relpath, repos_path);
 
     value = (node_props
                 ? svn_hash_gets(node_props, propname)
@@ -10700,11 +11565,15 @@ svn_wc__db_prop_retrieve_recursive(apr_hash_t **values,
 
     if (value)
       {
-        svn_hash_sets(*values,
-                      svn_dirent_join(wcroot->abspath,
-                                      svn_sqlite__column_text(stmt, 1, NULL),
-                                      result_pool),
+        const char *node_abspath = svn_dirent_join(wcroot->abspath,
+                                                   child_relpath,
+                                                   result_pool);
+
+        svn_hash_sets(*values, node_abspath,
                       svn_string_dup(value, result_pool));
+        if (repos_path)
+          svn_hash_sets(*repos_relpaths, node_abspath,
+                        apr_pstrdup(result_pool, repos_path));
       }
 
     SVN_ERR(svn_sqlite__step(&have_row, stmt));
@@ -12608,6 +13477,166 @@ svn_wc__db_lock_remove(svn_wc__db_t *db,
 }
 
 
+/* All lock changes that apply to one working copy root, for
+   svn_wc__db_lock_add_many() and svn_wc__db_lock_remove_many(). */
+typedef struct lock_many_group_t
+{
+  svn_wc__db_wcroot_t *wcroot;
+
+  /* Maps const char * local_relpath to the value from the caller's
+     hash, i.e. the lock to add resp. the work items to install. */
+  apr_hash_t *items;
+} lock_many_group_t;
+
+/* Sort ITEMS, a hash keyed by local abspaths, into per-wcroot
+   lock_many_group_t * groups keyed by the wcroot abspath, and return
+   the groups in *GROUPS, allocated in SCRATCH_POOL. */
+static svn_error_t *
+group_lock_changes(apr_hash_t **groups,
+                   svn_wc__db_t *db,
+                   apr_hash_t *items,
+                   apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  *groups = apr_hash_make(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, items); hi; hi = apr_hash_next(hi))
+    {
+      const char *local_abspath = apr_hash_this_key(hi);
+      svn_wc__db_wcroot_t *wcroot;
+      const char *local_relpath;
+      lock_many_group_t *group;
+
+      SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+      SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath,
+                                                    db, local_abspath,
+                                                    scratch_pool,
+                                                    scratch_pool));
+      VERIFY_USABLE_WCROOT(wcroot);
+
+      group = svn_hash_gets(*groups, wcroot->abspath);
+      if (!group)
+        {
+          group = apr_palloc(scratch_pool, sizeof(*group));
+          group->wcroot = wcroot;
+          group->items = apr_hash_make(scratch_pool);
+          svn_hash_sets(*groups, wcroot->abspath, group);
+        }
+
+      svn_hash_sets(group->items, local_relpath, apr_hash_this_val(hi));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Flush cached entry information for each local abspath key of ITEMS. */
+static svn_error_t *
+flush_lock_changes(svn_wc__db_t *db,
+                   apr_hash_t *items,
+                   apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, items); hi; hi = apr_hash_next(hi))
+    {
+      const char *local_abspath = apr_hash_this_key(hi);
+      svn_wc__db_wcroot_t *wcroot;
+      const char *local_relpath;
+
+      SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath,
+                                                    db, local_abspath,
+                                                    scratch_pool,
+                                                    scratch_pool));
+      SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty,
+                            scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* The body of svn_wc__db_lock_add_many(), applying to one wcroot. */
+static svn_error_t *
+lock_add_many_txn(svn_wc__db_wcroot_t *wcroot,
+                  apr_hash_t *locks,
+                  apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, locks); hi; hi = apr_hash_next(hi))
+    SVN_ERR(lock_add_txn(wcroot, apr_hash_this_key(hi),
+                         apr_hash_this_val(hi), scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_lock_add_many(svn_wc__db_t *db,
+                         apr_hash_t *locks,
+                         apr_pool_t *scratch_pool)
+{
+  apr_hash_t *groups;
+  apr_hash_index_t *hi;
+
+  SVN_ERR(group_lock_changes(&groups, db, locks, scratch_pool));
+
+  for (hi = apr_hash_first(scratch_pool, groups); hi; hi = apr_hash_next(hi))
+    {
+      lock_many_group_t *group = apr_hash_this_val(hi);
+
+      SVN_WC__DB_WITH_TXN(
+        lock_add_many_txn(group->wcroot, group->items, scratch_pool),
+        group->wcroot);
+    }
+
+  /* There may be some entries, and the lock info is now out of date.  */
+  SVN_ERR(flush_lock_changes(db, locks, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* The body of svn_wc__db_lock_remove_many(), applying to one wcroot. */
+static svn_error_t *
+lock_remove_many_txn(svn_wc__db_wcroot_t *wcroot,
+                     apr_hash_t *items,
+                     apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, items); hi; hi = apr_hash_next(hi))
+    SVN_ERR(lock_remove_txn(wcroot, apr_hash_this_key(hi),
+                            apr_hash_this_val(hi), scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_lock_remove_many(svn_wc__db_t *db,
+                            apr_hash_t *items,
+                            apr_pool_t *scratch_pool)
+{
+  apr_hash_t *groups;
+  apr_hash_index_t *hi;
+
+  SVN_ERR(group_lock_changes(&groups, db, items, scratch_pool));
+
+  for (hi = apr_hash_first(scratch_pool, groups); hi; hi = apr_hash_next(hi))
+    {
+      lock_many_group_t *group = apr_hash_this_val(hi);
+
+      SVN_WC__DB_WITH_TXN(
+        lock_remove_many_txn(group->wcroot, group->items, scratch_pool),
+        group->wcroot);
+    }
+
+  /* There may be some entries, and the lock info is now out of date.  */
+  SVN_ERR(flush_lock_changes(db, items, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_wc__db_lock_get(svn_wc__db_lock_t **lock_p,
                     svn_wc__db_t *db,
@@ -13470,6 +14499,7 @@ svn_wc__db_upgrade_begin(svn_sqlite__db_t **sdb,
                     SDB_FILE,
                     NULL, SVN_INVALID_REVNUM, svn_depth_unknown,
                     store_pristine,
+                    FALSE /* compress_pristine; upgraded stores stay raw */,
                     TRUE /* exclusive */,
                     0 /* timeout */,
                     wc_db->state_pool, scratch_pool));
@@ -13479,7 +14509,7 @@ svn_wc__db_upgrade_begin(svn_sqlite__db_t **sdb,
                                                    dir_abspath),
                                        *sdb, *wc_id, FORMAT_FROM_SDB,
                                        FALSE /* auto-upgrade */,
-                                       store_pristine,
+                                       store_pristine, FALSE,
                                        wc_db->state_pool, scratch_pool));
 
   /* The WCROOT is complete. Stash it into DB.  */
@@ -13696,6 +14726,7 @@ wq_record(svn_wc__db_wcroot_t *wcroot,
 
       SVN_ERR(db_record_fileinfo(wcroot, local_relpath,
                                  info->size, info->mtime,
+                                 info->translated_checksum,
                                  iterpool));
     }
 
@@ -13737,6 +14768,134 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
 
 
 
+/* The body of svn_wc__db_wq_fetch_batch().
+ */
+static svn_error_t *
+wq_fetch_batch(apr_array_header_t *items,
+               svn_wc__db_wcroot_t *wcroot,
+               int max_items,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_WORK_ITEMS));
+  SVN_ERR(svn_sqlite__bind_int(stmt, 1, max_items));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      svn_wc__db_wq_item_t *item = apr_palloc(result_pool, sizeof(*item));
+      apr_size_t len;
+      const void *val;
+
+      item->id = svn_sqlite__column_int64(stmt, 0);
+
+      val = svn_sqlite__column_blob(stmt, 1, &len, result_pool);
+      item->work_item = svn_skel__parse(val, len, result_pool);
+
+      APR_ARRAY_PUSH(items, svn_wc__db_wq_item_t *) = item;
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_wq_fetch_batch(apr_array_header_t **items_p,
+                          svn_wc__db_t *db,
+                          const char *wri_abspath,
+                          int max_items,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  apr_array_header_t *items;
+
+  SVN_ERR_ASSERT(items_p != NULL);
+  SVN_ERR_ASSERT(max_items > 0);
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  items = apr_array_make(result_pool, max_items,
+                         sizeof(svn_wc__db_wq_item_t *));
+
+  SVN_WC__DB_WITH_TXN(
+    wq_fetch_batch(items, wcroot, max_items, result_pool, scratch_pool),
+    wcroot);
+
+  *items_p = items;
+  return SVN_NO_ERROR;
+}
+
+/* The body of svn_wc__db_wq_retire_batch().
+ */
+static svn_error_t *
+wq_retire_batch(svn_wc__db_wcroot_t *wcroot,
+                const apr_array_header_t *completed_ids,
+                apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  int i;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_DELETE_WORK_ITEM));
+
+  for (i = 0; i < completed_ids->nelts; i++)
+    {
+      apr_uint64_t id = APR_ARRAY_IDX(completed_ids, i, apr_uint64_t);
+
+      SVN_ERR(svn_sqlite__bind_int64(stmt, 1, id));
+      SVN_ERR(svn_sqlite__step_done(stmt));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_wq_retire_batch(svn_wc__db_t *db,
+                           const char *wri_abspath,
+                           const apr_array_header_t *completed_ids,
+                           apr_hash_t *record_map,
+                           apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  if (completed_ids->nelts == 0 && record_map == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  if (record_map != NULL)
+    {
+      SVN_WC__DB_WITH_TXN(
+        svn_error_compose_create(
+                wq_retire_batch(wcroot, completed_ids, scratch_pool),
+                wq_record(wcroot, record_map, scratch_pool)),
+        wcroot);
+    }
+  else
+    {
+      SVN_WC__DB_WITH_TXN(
+        wq_retire_batch(wcroot, completed_ids, scratch_pool),
+        wcroot);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* ### temporary API. remove before release.  */
 svn_error_t *
 svn_wc__db_temp_get_format(int *format,
@@ -15697,6 +16856,27 @@ has_switched_subtrees(svn_boolean_t *is_switched,
 }
 
 
+svn_error_t *
+svn_wc__db_has_sparse_nodes(svn_boolean_t *is_sparse,
+                            svn_wc__db_t *db,
+                            const char *local_abspath,
+                            apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath,
+                                                db, local_abspath,
+                                                scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  return svn_error_trace(is_sparse_checkout_internal(is_sparse, wcroot,
+                                                     local_relpath,
+                                                     scratch_pool));
+}
+
 svn_error_t *
 svn_wc__db_has_switched_subtrees(svn_boolean_t *is_switched,
                                  svn_wc__db_t *db,
@@ -209,6 +209,10 @@ typedef struct svn_wc__db_fileinfo_t {
 
   /* The size of this file. */
   svn_filesize_t size;
+
+  /* Checksum of the translated (on-disk) contents of the file, or NULL
+     if not known. */
+  const svn_checksum_t *translated_checksum;
 } svn_wc__db_fileinfo_t;
 
 
@@ -278,6 +282,43 @@ svn_error_t *
 svn_wc__db_close(svn_wc__db_t *db);
 
 
+/* Set *SNAPSHOT_DB to a read-only database handle onto the working copy
+   that contains WRI_ABSPATH, for use concurrently with DB and with other
+   snapshots of it.
+
+   The handle is backed by its own read-only SQLite connection, so pure
+   read operations through different snapshots (and through DB itself)
+   run in parallel instead of serializing on DB's connection.  The
+   connections are pooled on the wcroot:  when a snapshot is released,
+   its connection is parked for the next svn_wc__db_snapshot_open() call,
+   and all of them are closed together with DB.
+
+   The working copy must already have been opened through DB on the
+   calling thread; this function itself may be called from several
+   threads at once as long as no other operation is mutating DB.  The
+   snapshot serves only the one working copy containing WRI_ABSPATH and
+   must be used for read operations only.
+
+   The snapshot is allocated in RESULT_POOL and is released when that
+   pool is cleared, or earlier via svn_wc__db_snapshot_close().
+   RESULT_POOL must not outlive DB.  Temporary allocations will be made
+   in SCRATCH_POOL.
+*/
+svn_error_t *
+svn_wc__db_snapshot_open(svn_wc__db_t **snapshot_db,
+                         svn_wc__db_t *db,
+                         const char *wri_abspath,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool);
+
+
+/* Release SNAPSHOT_DB, previously obtained from svn_wc__db_snapshot_open(),
+   returning its SQLite connection to the owning wcroot's idle pool.
+   SNAPSHOT_DB must not be used afterwards. */
+svn_error_t *
+svn_wc__db_snapshot_close(svn_wc__db_t *snapshot_db);
+
+
 /* Initialize the SDB with format TARGET_FORMAT for LOCAL_ABSPATH, which should
    be a working copy path.
 
@@ -386,6 +427,10 @@ svn_wc__db_get_wcroot(const char **wcroot_abspath,
                       apr_pool_t *result_pool,
                       apr_pool_t *scratch_pool);
 
+/* Return the configuration DB was opened with.  May be NULL. */
+svn_config_t *
+svn_wc__db_get_config(svn_wc__db_t *db);
+
 
 /* @} */
 
@@ -707,6 +752,28 @@ svn_wc__db_base_add_not_present_node(svn_wc__db_t *db,
                                      const svn_skel_t *work_items,
                                      apr_pool_t *scratch_pool);
 
+/* Like calling svn_wc__db_base_add_not_present_node() for every child
+   in NODES, but using a single database transaction for the whole
+   batch instead of one per node.
+
+   NODES maps (const char *) basenames of children of PARENT_ABSPATH
+   to their (const char *) node kind, as produced by
+   svn_node_kind_to_word().  Each child's repository location is
+   PARENT_REPOS_RELPATH with its basename appended, in the repository
+   described by <REPOS_ROOT_URL, REPOS_UUID> at revision REVISION.
+
+   All temporary allocations will be made in SCRATCH_POOL.
+*/
+svn_error_t *
+svn_wc__db_base_add_not_present_nodes(svn_wc__db_t *db,
+                                      const char *parent_abspath,
+                                      const char *parent_repos_relpath,
+                                      const char *repos_root_url,
+                                      const char *repos_uuid,
+                                      svn_revnum_t revision,
+                                      apr_hash_t *nodes,
+                                      apr_pool_t *scratch_pool);
+
 /* Remove a node and all its descendants from the BASE tree. This can
    be done in two modes:
 
@@ -845,6 +912,19 @@ svn_wc__db_base_get_children_info(apr_hash_t **nodes,
                                   apr_pool_t *result_pool,
                                   apr_pool_t *scratch_pool);
 
+/* Return in *NODES_MAP a hash mapping the relpath of each directory in the
+   subtree rooted at DIR_ABSPATH (relative to DIR_ABSPATH; "" for the root)
+   to a hash like the one returned by svn_wc__db_base_get_children_info(),
+   gathered with a single query.  Directories without BASE children have no
+   entry in *NODES_MAP.
+ */
+svn_error_t *
+svn_wc__db_base_get_subtree_children_info(apr_hash_t **nodes_map,
+                                          svn_wc__db_t *db,
+                                          const char *dir_abspath,
+                                          apr_pool_t *result_pool,
+                                          apr_pool_t *scratch_pool);
+
 
 /* Set *PROPS to the properties of the node LOCAL_ABSPATH in the BASE tree.
 
@@ -1382,6 +1462,23 @@ svn_wc__db_op_copy(svn_wc__db_t *db,
                    const svn_skel_t *work_items,
                    apr_pool_t *scratch_pool);
 
+/* Try to copy the metadata of all nodes below SRC_ABSPATH to the matching
+ * paths below DST_ABSPATH in a single pass over the NODES and ACTUAL_NODE
+ * tables, instead of one database operation per node.  DST_ABSPATH itself
+ * must already have been copied with svn_wc__db_op_copy().
+ *
+ * Set *DONE to TRUE when the whole subtree was copied.  Set *DONE to FALSE,
+ * without changing the database, when the subtree needs the node-by-node
+ * treatment: when the copy crosses into another working copy, or when the
+ * source subtree contains nested operations, server-excluded or incomplete
+ * nodes, moved-away nodes or file externals. */
+svn_error_t *
+svn_wc__db_op_copy_subtree(svn_boolean_t *done,
+                           svn_wc__db_t *db,
+                           const char *src_abspath,
+                           const char *dst_abspath,
+                           apr_pool_t *scratch_pool);
+
 /* Checks if LOCAL_ABSPATH represents a move back to its original location,
  * and if it is reverts the move while keeping local changes after it has been
  * moved from MOVED_FROM_ABSPATH.
@@ -1730,6 +1827,51 @@ svn_wc__db_revert_list_read(svn_boolean_t *reverted,
                             apr_pool_t *result_pool,
                             apr_pool_t *scratch_pool);
 
+/* One revert list entry as returned by
+ * svn_wc__db_revert_list_read_tree(). */
+typedef struct svn_wc__db_revert_list_info_t {
+  /* TRUE if the path was reverted (like *REVERTED of
+   * svn_wc__db_revert_list_read()). */
+  svn_boolean_t reverted;
+
+  /* Conflict marker files recorded on the path, or NULL. */
+  const apr_array_header_t *marker_files;
+
+  /* TRUE if the reverted node was copied here and is the operation
+   * root of the copy. */
+  svn_boolean_t copied_here;
+
+  /* The node kind of the reverted node, svn_node_unknown if the entry
+   * describes an actual-only change. */
+  svn_node_kind_t kind;
+
+  /* TRUE if the entry stems from a reverted node (as opposed to only
+   * actual-only information such as a marked tree conflict). */
+  svn_boolean_t have_node_info;
+
+  /* For actual-only entries: 0 = nothing to notify for, 1 = notify a
+   * revert, 2 = notify a reverted tree conflict marker. */
+  int actual_notify;
+
+  /* For actual-only entries: the node kind to notify with. */
+  svn_node_kind_t actual_kind;
+} svn_wc__db_revert_list_info_t;
+
+/* Query the revert list for LOCAL_ABSPATH and all its descendants in a
+ * single transaction.  Set *INFO_HASH to a hash mapping const char *
+ * absolute paths to svn_wc__db_revert_list_info_t *.
+ *
+ * Unlike svn_wc__db_revert_list_read() this does not remove the
+ * corresponding rows from the revert list; the caller remains
+ * responsible for notifying and for eventually calling
+ * svn_wc__db_revert_list_done(). */
+svn_error_t *
+svn_wc__db_revert_list_read_tree(apr_hash_t **info_hash,
+                                 svn_wc__db_t *db,
+                                 const char *local_abspath,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
 /* The type of elements in the array returned by
  * svn_wc__db_revert_list_read_copied_children(). */
 typedef struct svn_wc__db_revert_list_copied_child_info_t {
@@ -2083,6 +2225,68 @@ svn_wc__db_read_single_info(const struct svn_wc__db_info_t **info,
                             apr_pool_t *result_pool,
                             apr_pool_t *scratch_pool);
 
+/* Item streamed by svn_wc__db_read_subtree_info() for an unmodified node.
+   The fields match the corresponding svn_wc__db_read_info() output
+   arguments. */
+typedef struct svn_wc__db_subtree_info_t {
+  svn_wc__db_status_t status;   /* normal or incomplete */
+  svn_node_kind_t kind;
+  svn_revnum_t revision;
+  const char *repos_relpath;
+  const char *repos_root_url;
+  const char *repos_uuid;
+  svn_revnum_t changed_rev;
+  apr_time_t changed_date;
+  const char *changed_author;
+  svn_depth_t depth;            /* svn_depth_unknown on non-directories */
+  const svn_checksum_t *checksum;
+  svn_filesize_t recorded_size;
+  apr_time_t recorded_time;
+  const char *changelist;
+  svn_wc__db_lock_t *lock;      /* Repository file lock */
+} svn_wc__db_subtree_info_t;
+
+/* Receiver for svn_wc__db_read_subtree_info().  INFO is NULL when the
+   node at LOCAL_ABSPATH carries working layers, conflicts or an unusual
+   presence and must be read individually; KIND is then the kind of the
+   node's deepest layer.  All arguments are valid only for the duration
+   of the call. */
+typedef svn_error_t *(*svn_wc__db_subtree_info_receiver_t)(
+  void *baton,
+  const char *local_abspath,
+  svn_node_kind_t kind,
+  const svn_wc__db_subtree_info_t *info,
+  apr_pool_t *scratch_pool);
+
+/* Drive RECEIVER with RECEIVER_BATON for every node at and below
+   LOCAL_ABSPATH, in ascending path order, streaming the whole subtree
+   from a single ordered query instead of one query per node.
+
+   Unless SHOW_HIDDEN is TRUE, nodes whose visible layer is not-present,
+   excluded or server-excluded are passed over without a receiver call;
+   LOCAL_ABSPATH itself is always passed to RECEIVER (with a NULL INFO
+   when hidden), so that callers can flag a missing target.
+
+   If CONFLICT_VICTIMS is not NULL, add a const char * local_abspath
+   -> "" mapping to it, with keys allocated in RESULT_POOL, for every
+   path in the subtree that has conflict data recorded, whether
+   versioned or not.  The hash is fully populated before the first
+   receiver call, so receivers may prune it as nodes are visited.
+
+   Returns SVN_ERR_WC_PATH_NOT_FOUND if there is no node at
+   LOCAL_ABSPATH at all. */
+svn_error_t *
+svn_wc__db_read_subtree_info(apr_hash_t *conflict_victims,
+                             svn_wc__db_t *db,
+                             const char *local_abspath,
+                             svn_boolean_t show_hidden,
+                             svn_wc__db_subtree_info_receiver_t receiver,
+                             void *receiver_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
 /* Structure returned by svn_wc__db_read_walker_info.  Only has the
    fields needed by svn_wc__internal_walk_children(). */
 struct svn_wc__db_walker_info_t {
@@ -2297,6 +2501,25 @@ svn_wc__db_prop_retrieve_recursive(apr_hash_t **values,
                                    apr_pool_t *result_pool,
                                    apr_pool_t *scratch_pool);
 
+/** Like svn_wc__db_prop_retrieve_recursive(), but additionally set
+ * *REPOS_RELPATHS to a mapping of the same const char * local_abspath
+ * keys to each node's const char * repository relpath, resolved from
+ * the same single subtree query.  A node whose repository relpath
+ * cannot be derived that way is left out of *REPOS_RELPATHS; callers
+ * fall back to svn_wc__db_read_repos_info() for it.
+ *
+ * Allocate the results in RESULT_POOL, and perform temporary
+ * allocations in SCRATCH_POOL.
+ */
+svn_error_t *
+svn_wc__db_prop_retrieve_recursive2(apr_hash_t **values,
+                                    apr_hash_t **repos_relpaths,
+                                    svn_wc__db_t *db,
+                                    const char *local_abspath,
+                                    const char *propname,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool);
+
 /* Set *CHILDREN to a new array of the (const char *) basenames of the
    immediate children of the working node at LOCAL_ABSPATH in DB.
 
@@ -2666,6 +2889,21 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
                                   apr_time_t recorded_time,
                                   apr_pool_t *scratch_pool);
 
+/* Set *TRANSLATED_CHECKSUM to the recorded checksum of the translated
+   (on-disk) contents of LOCAL_ABSPATH, allocated in RESULT_POOL, or to
+   NULL if no such checksum is recorded or if the working copy format
+   does not store one.
+
+   The checksum describes the contents of the file as it was last
+   installed into the working copy, i.e. with keyword and eol translation
+   applied. */
+svn_error_t *
+svn_wc__db_read_translated_checksum(const svn_checksum_t **translated_checksum,
+                                    svn_wc__db_t *db,
+                                    const char *local_abspath,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool);
+
 
 /* ### post-commit handling.
    ### maybe multiple phases?
@@ -2700,6 +2938,25 @@ svn_wc__db_lock_remove(svn_wc__db_t *db,
                        apr_pool_t *scratch_pool);
 
 
+/* Add or replace all locks in LOCKS, a hash mapping local abspaths to
+   const svn_wc__db_lock_t * structures, to DB.  The locks for each
+   working copy root are added in a single database transaction.  */
+svn_error_t *
+svn_wc__db_lock_add_many(svn_wc__db_t *db,
+                         apr_hash_t *locks,
+                         apr_pool_t *scratch_pool);
+
+
+/* Remove any lock for each local abspath key of ITEMS in DB, installing
+   the corresponding svn_skel_t * work item values (which must not be
+   NULL) as we go.  The locks for each working copy root are removed in
+   a single database transaction.  */
+svn_error_t *
+svn_wc__db_lock_remove_many(svn_wc__db_t *db,
+                            apr_hash_t *items,
+                            apr_pool_t *scratch_pool);
+
+
 /* Fetch the information about the lock which corresponds to REPOS_RELPATH
    within the working copy indicated by WRI_ABSPATH. Set *LOCK_P to NULL
    if there is no such lock.  */
@@ -3047,6 +3304,38 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* A work queue item as returned by svn_wc__db_wq_fetch_batch(): the
+   identifier used to retire the item and the parsed work item data. */
+typedef struct svn_wc__db_wq_item_t {
+  apr_uint64_t id;
+  svn_skel_t *work_item;
+} svn_wc__db_wq_item_t;
+
+/* Fetch up to MAX_ITEMS work items that need to be completed, in the same
+   order they were queued, using a single transaction.  Set *ITEMS_P to an
+   array of svn_wc__db_wq_item_t *, empty if there is no work left.
+
+   RESULT_POOL will be used to allocate the array and the work items, and
+   SCRATCH_POOL will be used for all temporary allocations.  */
+svn_error_t *
+svn_wc__db_wq_fetch_batch(apr_array_header_t **items_p,
+                          svn_wc__db_t *db,
+                          const char *wri_abspath,
+                          int max_items,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool);
+
+/* Mark all the work items whose identifiers are in COMPLETED_IDS (an array
+   of apr_uint64_t) as completed, in a single transaction.  If RECORD_MAP is
+   not NULL, also record timestamps and sizes for the nodes in it, in the
+   same transaction, like svn_wc__db_wq_record_and_fetch_next() does.  */
+svn_error_t *
+svn_wc__db_wq_retire_batch(svn_wc__db_t *db,
+                           const char *wri_abspath,
+                           const apr_array_header_t *completed_ids,
+                           apr_hash_t *record_map,
+                           apr_pool_t *scratch_pool);
+
 
 /* @} */
 
@@ -3409,6 +3698,19 @@ svn_wc__db_min_max_revisions(svn_revnum_t *min_revision,
                              svn_boolean_t committed,
                              apr_pool_t *scratch_pool);
 
+/* Indicate in *IS_SPARSE whether LOCAL_ABSPATH or any node beneath it
+ * has a non-infinite recorded depth or is excluded, using DB.  Use
+ * SCRATCH_POOL for temporary allocations.
+ *
+ * This function provides a subset of the functionality of
+ * svn_wc__db_revision_status() and is more efficient if the caller
+ * doesn't need all information returned by svn_wc__db_revision_status(). */
+svn_error_t *
+svn_wc__db_has_sparse_nodes(svn_boolean_t *is_sparse,
+                            svn_wc__db_t *db,
+                            const char *local_abspath,
+                            apr_pool_t *scratch_pool);
+
 /* Indicate in *IS_SWITCHED whether any node beneath LOCAL_ABSPATH
  * is switched, using DB. Use SCRATCH_POOL for temporary allocations.
  *
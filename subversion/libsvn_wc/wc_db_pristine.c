@@ -209,6 +209,11 @@ pristine_read_txn(svn_stream_t **contents,
           SVN_ERR(svn_io_file_open(&file, pristine_abspath, APR_READ,
                                    APR_OS_DEFAULT, result_pool));
           *contents = svn_stream_from_aprfile2(file, FALSE, result_pool);
+
+          /* In a compressed pristine store, transparently decompress;
+             SIZE still refers to the original contents. */
+          if (wcroot->compress_pristine)
+            *contents = svn_stream__lz4_compressed(*contents, result_pool);
         }
       else
         {
@@ -265,6 +270,10 @@ struct svn_wc__db_install_data_t
 {
   svn_wc__db_wcroot_t *wcroot;
   svn_stream_t *inner_stream;
+  /* The stream the contents are written to: either INNER_STREAM itself
+     or a compression stream stacked onto it.  NULL iff INNER_STREAM
+     is NULL. */
+  svn_stream_t *write_stream;
   apr_off_t size;
 };
 
@@ -273,8 +282,8 @@ install_stream_write_fn(void *baton, const char *data, apr_size_t *len)
 {
   svn_wc__db_install_data_t *install_data = baton;
 
-  if (install_data->inner_stream)
-    SVN_ERR(svn_stream_write(install_data->inner_stream, data, len));
+  if (install_data->write_stream)
+    SVN_ERR(svn_stream_write(install_data->write_stream, data, len));
 
   install_data->size += *len;
 
@@ -289,8 +298,8 @@ install_stream_seek_fn(void *baton, const svn_stream_mark_t *mark)
   if (!mark)
     return svn_error_create(SVN_ERR_STREAM_SEEK_NOT_SUPPORTED, NULL, NULL);
 
-  if (install_data->inner_stream)
-    SVN_ERR(svn_stream_reset(install_data->inner_stream));
+  if (install_data->write_stream)
+    SVN_ERR(svn_stream_reset(install_data->write_stream));
 
   install_data->size = 0;
 
@@ -302,8 +311,10 @@ install_stream_close_fn(void *baton)
 {
   svn_wc__db_install_data_t *install_data = baton;
 
-  if (install_data->inner_stream)
-    SVN_ERR(svn_stream_close(install_data->inner_stream));
+  /* Closing the write stream flushes any compression state onto the
+     inner install stream and closes that stream as well. */
+  if (install_data->write_stream)
+    SVN_ERR(svn_stream_close(install_data->write_stream));
 
   return SVN_NO_ERROR;
 }
@@ -442,10 +453,17 @@ svn_wc__db_pristine_prepare_install_internal(svn_stream_t **stream_p,
                                                temp_dir_abspath,
                                                result_pool, scratch_pool),
                 _("Unable to create pristine install stream"));
+
+      if (wcroot->compress_pristine)
+        install_data->write_stream =
+          svn_stream__lz4_compressed(install_data->inner_stream, result_pool);
+      else
+        install_data->write_stream = install_data->inner_stream;
     }
   else
     {
       install_data->inner_stream = NULL;
+      install_data->write_stream = NULL;
     }
 
   install_data->size = 0;
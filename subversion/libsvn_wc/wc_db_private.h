@@ -30,6 +30,8 @@
 #ifndef WC_DB_PRIVATE_H
 #define WC_DB_PRIVATE_H
 
+#include "private/svn_mutex.h"
+
 #include "wc_db.h"
 
 
@@ -64,6 +66,13 @@ struct svn_wc__db_t {
     svn_node_kind_t kind;
   } parse_cache;
 
+  /* If this DB is a read-only snapshot created by
+     svn_wc__db_snapshot_open(), the wcroot of the parent DB that owns
+     the pooled SQLite connection, and the single wcroot served by the
+     snapshot.  Both are NULL for ordinary DBs. */
+  struct svn_wc__db_wcroot_t *snapshot_parent_wcroot;
+  struct svn_wc__db_wcroot_t *snapshot_wcroot;
+
   /* As we grow the state of this DB, allocate that state here. */
   apr_pool_t *state_pool;
 };
@@ -111,6 +120,19 @@ typedef struct svn_wc__db_wcroot_t {
      to fetch the contents on demand. */
   svn_boolean_t store_pristine;
 
+  /* Whether the pristine files of this working copy are stored in the
+     LZ4 block-compressed format. */
+  svn_boolean_t compress_pristine;
+
+  /* Idle read-only connections to this wcroot's database, handed out by
+     svn_wc__db_snapshot_open().  Elements are svn_sqlite__db_t *.
+     Protected by SNAPSHOT_LOCK.  NULL on snapshot wcroots. */
+  apr_array_header_t *snapshot_sdbs;
+
+  /* Serializes access to SNAPSHOT_SDBS (and the wcroot's pool while a
+     new snapshot connection is opened in it). */
+  svn_mutex__t *snapshot_lock;
+
 } svn_wc__db_wcroot_t;
 
 
@@ -131,6 +153,7 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                              int format,
                              svn_boolean_t verify_format,
                              svn_boolean_t store_pristine,
+                             svn_boolean_t compress_pristine,
                              apr_pool_t *result_pool,
                              apr_pool_t *scratch_pool);
 
@@ -153,6 +176,14 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
                                       apr_pool_t *result_pool,
                                       apr_pool_t *scratch_pool);
 
+/* Remove all entries referring to WCROOT_ABSPATH from the process-global
+   cache of wcroot locations that svn_wc__db_wcroot_parse_local_abspath()
+   maintains, or all entries if WCROOT_ABSPATH is NULL.  Call this whenever
+   a working copy root may have been created, replaced or removed. */
+svn_error_t *
+svn_wc__db_wcroot_forget_hints(const char *wcroot_abspath,
+                               apr_pool_t *scratch_pool);
+
 /* Return an error if the work queue in SDB is non-empty. */
 svn_error_t *
 svn_wc__db_verify_no_work(svn_sqlite__db_t *sdb);
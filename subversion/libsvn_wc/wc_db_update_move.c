@@ -256,8 +256,26 @@ typedef struct update_move_baton_t {
 
   svn_cancel_func_t cancel_func;
   void *cancel_baton;
+
+  /* When non-NULL, complete snapshots of the src and dst NODES layers of
+     the move, keyed on local_relpath and holding layer_node_info_t *, and
+     the set of dst paths shadowed by higher op-depths.  Read up front by
+     update_moved_away_conflict_victim() so that the drive does not have
+     to query wc.db several times per node. */
+  apr_hash_t *src_layer;
+  apr_hash_t *dst_layer;
+  apr_hash_t *shadowed_below_dst;
 } update_move_baton_t;
 
+/* One node of a NODES layer snapshot, as read by read_layer_subtree(). */
+typedef struct layer_node_info_t
+{
+  svn_node_kind_t kind;
+  const svn_checksum_t *checksum;
+  apr_hash_t *props;
+  apr_array_header_t *children;  /* basenames, sorted; NULL unless a dir */
+} layer_node_info_t;
+
 /* Per node flags for tree conflict collection */
 typedef struct node_move_baton_t
 {
@@ -1945,6 +1963,117 @@ tc_incoming_editor_delete(node_move_baton_t *nmb,
  * single-revision.
  */
 
+/* Read the whole NODES layer at OP_DEPTH at and below LOCAL_RELPATH with
+   a single query and return it in *LAYER as a hash keyed on local_relpath,
+   holding layer_node_info_t *.  Mirrors the per-node semantics of
+   get_info(): nodes that are not present at this op-depth are simply
+   absent from the hash, while incomplete nodes are listed as children of
+   their parent but have a kind of svn_node_none themselves. */
+static svn_error_t *
+read_layer_subtree(apr_hash_t **layer,
+                   svn_wc__db_wcroot_t *wcroot,
+                   const char *local_relpath,
+                   int op_depth,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  *layer = apr_hash_make(result_pool);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_OP_DEPTH_SUBTREE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "isd", wcroot->wc_id, local_relpath,
+                            op_depth));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      const char *relpath = svn_sqlite__column_text(stmt, 0, result_pool);
+      svn_wc__db_status_t presence = svn_sqlite__column_token(stmt, 1,
+                                                              presence_map);
+      layer_node_info_t *info = apr_pcalloc(result_pool, sizeof(*info));
+      svn_error_t *err = NULL;
+
+      if (presence == svn_wc__db_status_normal)
+        {
+          info->kind = svn_sqlite__column_token(stmt, 2, kind_map);
+          err = svn_sqlite__column_checksum(&info->checksum, stmt, 3,
+                                            result_pool);
+          if (!err)
+            err = svn_sqlite__column_properties(&info->props, stmt, 4,
+                                                result_pool, scratch_pool);
+        }
+      else
+        {
+          /* Incomplete: the node is listed as a child of its parent, but
+             is itself reported as not there, just like get_info() does. */
+          info->kind = svn_node_none;
+        }
+
+      if (err)
+        return svn_error_compose_create(err, svn_sqlite__reset(stmt));
+
+      if (info->kind == svn_node_dir)
+        info->children = apr_array_make(result_pool, 8, sizeof(const char *));
+
+      svn_hash_sets(*layer, relpath, info);
+
+      if (strcmp(relpath, local_relpath) != 0)
+        {
+          layer_node_info_t *parent
+            = svn_hash_gets(*layer, svn_relpath_dirname(relpath,
+                                                        scratch_pool));
+
+          /* The rows are ordered by path, so a parent always precedes its
+             children and the basenames arrive in sorted order. */
+          if (parent && parent->children)
+            APR_ARRAY_PUSH(parent->children, const char *)
+              = svn_relpath_basename(relpath, result_pool);
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *SHADOWED to the set of paths strictly below LOCAL_RELPATH that
+   have a NODES row above OP_DEPTH, i.e. the paths for which
+   check_node_shadowed() would report TRUE, keyed and valued on the
+   local_relpath. */
+static svn_error_t *
+read_shadowed_descendants(apr_hash_t **shadowed,
+                          svn_wc__db_wcroot_t *wcroot,
+                          const char *local_relpath,
+                          int op_depth,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  *shadowed = apr_hash_make(result_pool);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_SHADOWED_DESCENDANTS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "isd", wcroot->wc_id, local_relpath,
+                            op_depth));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      const char *relpath = svn_sqlite__column_text(stmt, 0, result_pool);
+
+      svn_hash_sets(*shadowed, relpath, relpath);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  return SVN_NO_ERROR;
+}
+
 /* Return *PROPS, *CHECKSUM, *CHILDREN and *KIND for LOCAL_RELPATH at
    OP_DEPTH provided the row exists.  Return *KIND of svn_node_none if
    the row does not exist, or only describes a delete of a lower op-depth.
@@ -2025,6 +2154,37 @@ get_info(apr_hash_t **props,
   return SVN_NO_ERROR;
 }
 
+/* Like get_info(), but answered from the LAYER snapshot produced by
+   read_layer_subtree() instead of querying wc.db. */
+static void
+get_layer_info(apr_hash_t **props,
+               const svn_checksum_t **checksum,
+               apr_array_header_t **children,
+               svn_node_kind_t *kind,
+               apr_hash_t *layer,
+               const char *local_relpath,
+               apr_pool_t *result_pool)
+{
+  layer_node_info_t *info = svn_hash_gets(layer, local_relpath);
+
+  if (info == NULL || info->kind == svn_node_none)
+    {
+      *kind = svn_node_none;
+      *checksum = NULL;
+      *props = NULL;
+      *children = apr_array_make(result_pool, 0, sizeof(const char *));
+      return;
+    }
+
+  *kind = info->kind;
+  *checksum = info->checksum;
+  *props = info->props;
+  if (info->children)
+    *children = info->children;
+  else
+    *children = apr_array_make(result_pool, 0, sizeof(const char *));
+}
+
 /* Return TRUE if SRC_PROPS and DST_PROPS contain the same properties,
    FALSE otherwise. SRC_PROPS and DST_PROPS are standard property
    hashes. */
@@ -2066,13 +2226,23 @@ update_moved_away_node(node_move_baton_t *nmb,
   if (b->cancel_func)
     SVN_ERR(b->cancel_func(b->cancel_baton));
 
-  SVN_ERR(get_info(&src_props, &src_checksum, &src_children, &src_kind,
-                   src_relpath, b->src_op_depth,
-                   wcroot, scratch_pool, scratch_pool));
+  if (b->src_layer)
+    {
+      get_layer_info(&src_props, &src_checksum, &src_children, &src_kind,
+                     b->src_layer, src_relpath, scratch_pool);
+      get_layer_info(&dst_props, &dst_checksum, &dst_children, &dst_kind,
+                     b->dst_layer, dst_relpath, scratch_pool);
+    }
+  else
+    {
+      SVN_ERR(get_info(&src_props, &src_checksum, &src_children, &src_kind,
+                       src_relpath, b->src_op_depth,
+                       wcroot, scratch_pool, scratch_pool));
 
-  SVN_ERR(get_info(&dst_props, &dst_checksum, &dst_children, &dst_kind,
-                   dst_relpath, b->dst_op_depth,
-                   wcroot, scratch_pool, scratch_pool));
+      SVN_ERR(get_info(&dst_props, &dst_checksum, &dst_children, &dst_kind,
+                       dst_relpath, b->dst_op_depth,
+                       wcroot, scratch_pool, scratch_pool));
+    }
 
   if (src_kind == svn_node_none
       || (dst_kind != svn_node_none && src_kind != dst_kind))
@@ -2170,9 +2340,15 @@ update_moved_away_node(node_move_baton_t *nmb,
                                               iterpool);
 
           if (!cnmb.shadowed)
-            SVN_ERR(check_node_shadowed(&cnmb.shadowed, wcroot,
-                                        cnmb.dst_relpath, b->dst_op_depth,
-                                        iterpool));
+            {
+              if (b->shadowed_below_dst)
+                cnmb.shadowed = (svn_hash_gets(b->shadowed_below_dst,
+                                               cnmb.dst_relpath) != NULL);
+              else
+                SVN_ERR(check_node_shadowed(&cnmb.shadowed, wcroot,
+                                            cnmb.dst_relpath, b->dst_op_depth,
+                                            iterpool));
+            }
 
           SVN_ERR(update_moved_away_node(&cnmb, wcroot, cnmb.src_relpath,
                                          cnmb.dst_relpath, iterpool));
@@ -2343,6 +2519,20 @@ update_moved_away_conflict_victim(svn_revnum_t *old_rev,
   if (umb.src_op_depth == 0)
     SVN_ERR(suitable_for_move(wcroot, src_relpath, scratch_pool));
 
+  /* Resolve the full delta up front: snapshot both layers of the move and
+     the set of shadowed destination paths with three queries, instead of
+     querying wc.db several times per node during the drive below.  This is
+     safe because the source layer is never modified by the drive, and the
+     destination layer is only modified for nodes the drive has already
+     visited or decided to skip. */
+  SVN_ERR(read_layer_subtree(&umb.src_layer, wcroot, src_relpath,
+                             umb.src_op_depth, scratch_pool, scratch_pool));
+  SVN_ERR(read_layer_subtree(&umb.dst_layer, wcroot, dst_relpath,
+                             umb.dst_op_depth, scratch_pool, scratch_pool));
+  SVN_ERR(read_shadowed_descendants(&umb.shadowed_below_dst, wcroot,
+                                    dst_relpath, umb.dst_op_depth,
+                                    scratch_pool, scratch_pool));
+
   /* Create a new, and empty, list for notification information. */
   SVN_ERR(svn_sqlite__exec_statements(wcroot->sdb,
                                       STMT_CREATE_UPDATE_MOVE_LIST));
@@ -36,6 +36,9 @@
 #include "wc_db_private.h"
 #include "wc-queries.h"
 
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+
 #include "svn_private_config.h"
 
 /* ### Same values as wc_db.c */
@@ -100,6 +103,304 @@ get_old_version(int *version,
 }
 
 
+/* Process-global cache of previously discovered wcroot locations.
+
+   Consumers that create a fresh svn_wc__db_t per operation lose the
+   per-instance DIR_DATA cache and repeat the upwards scan for
+   ".svn/wc.db" (a stat and a SQLite open attempt per ancestor) on every
+   request.  This cache remembers, per directory identity (device and
+   inode number), where the containing wcroot was found, so that a new
+   svn_wc__db_t instance can try the recorded wcroot directly.
+
+   Entries are only hints: every hit is verified by checking that the
+   recorded wcroot directory still exists with the identity it was
+   recorded with, and the database is always opened (and its actual
+   format read) from disk, so a stale entry at worst causes a fallback
+   to the full scan.  SQLite handles themselves are intentionally NOT
+   shared between svn_wc__db_t instances: they are tied to the owning
+   instance's state pool and working copy lock bookkeeping. */
+typedef struct wcroot_hint_t
+{
+  /* Absolute path of the wcroot directory. */
+  const char *wcroot_abspath;
+
+  /* Identity of the wcroot directory, used to validate the hint. */
+  apr_dev_t device;
+  apr_ino_t inode;
+} wcroot_hint_t;
+
+/* Maximum number of entries in the hint cache.  When the cache would grow
+   beyond this size it is simply emptied; entries are cheap to rebuild. */
+#define WCROOT_HINT_CACHE_MAX_SIZE 256
+
+static volatile svn_atomic_t hint_cache_init_state = 0;
+static svn_mutex__t *hint_cache_mutex = NULL;
+
+/* Subpool holding HINT_CACHE and everything it references; cleared
+   whenever the cache is emptied. */
+static apr_pool_t *hint_cache_pool = NULL;
+
+/* Maps "device:inode" of a directory -> wcroot_hint_t *.  Both the hinted
+   directory itself and its containing wcroot are entered under their own
+   identities.  Protected by HINT_CACHE_MUTEX. */
+static apr_hash_t *hint_cache = NULL;
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+init_hint_cache(void *baton, apr_pool_t *pool)
+{
+  apr_pool_t *global_pool = svn_pool_create(NULL);
+
+  SVN_ERR(svn_mutex__init(&hint_cache_mutex, TRUE, global_pool));
+
+  hint_cache_pool = svn_pool_create(global_pool);
+  hint_cache = apr_hash_make(hint_cache_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the hint cache key for FINFO, which must contain valid device
+   and inode values, allocated in RESULT_POOL. */
+static const char *
+hint_cache_key(const apr_finfo_t *finfo,
+               apr_pool_t *result_pool)
+{
+  return apr_psprintf(result_pool,
+                      "%" APR_UINT64_T_FMT ":%" APR_UINT64_T_FMT,
+                      (apr_uint64_t)finfo->device,
+                      (apr_uint64_t)finfo->inode);
+}
+
+/* Obtain the device/inode identity of ABSPATH in *FINFO.  Set
+   *HAVE_IDENTITY to FALSE, without returning an error, if the identity
+   cannot be obtained, e.g. because ABSPATH does not exist or because the
+   filesystem does not report stable device/inode values. */
+static svn_error_t *
+get_dir_identity(svn_boolean_t *have_identity,
+                 apr_finfo_t *finfo,
+                 const char *abspath,
+                 apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  err = svn_io_stat(finfo, abspath, APR_FINFO_DEV | APR_FINFO_INODE,
+                    scratch_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      *have_identity = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  *have_identity = (finfo->valid & APR_FINFO_DEV)
+                   && (finfo->valid & APR_FINFO_INODE);
+  return SVN_NO_ERROR;
+}
+
+/* Copy the hint for KEY out of the cache, or set *WCROOT_ABSPATH to NULL
+   if there is none.  HINT_CACHE_MUTEX must be held. */
+static svn_error_t *
+hint_lookup_body(const char **wcroot_abspath,
+                 apr_dev_t *device,
+                 apr_ino_t *inode,
+                 const char *key,
+                 apr_pool_t *result_pool)
+{
+  const wcroot_hint_t *hint = svn_hash_gets(hint_cache, key);
+
+  if (hint)
+    {
+      *wcroot_abspath = apr_pstrdup(result_pool, hint->wcroot_abspath);
+      *device = hint->device;
+      *inode = hint->inode;
+    }
+  else
+    *wcroot_abspath = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Enter a hint for KEY into the cache, evicting all existing entries if
+   the cache would otherwise grow too large.  HINT_CACHE_MUTEX must be
+   held. */
+static svn_error_t *
+hint_record_body(const char *key,
+                 const char *wcroot_abspath,
+                 apr_dev_t device,
+                 apr_ino_t inode)
+{
+  wcroot_hint_t *hint;
+
+  if (apr_hash_count(hint_cache) >= WCROOT_HINT_CACHE_MAX_SIZE
+      && !svn_hash_gets(hint_cache, key))
+    {
+      svn_pool_clear(hint_cache_pool);
+      hint_cache = apr_hash_make(hint_cache_pool);
+    }
+
+  hint = apr_palloc(hint_cache_pool, sizeof(*hint));
+  hint->wcroot_abspath = apr_pstrdup(hint_cache_pool, wcroot_abspath);
+  hint->device = device;
+  hint->inode = inode;
+
+  svn_hash_sets(hint_cache, apr_pstrdup(hint_cache_pool, key), hint);
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove all hints referring to WCROOT_ABSPATH, or all hints if
+   WCROOT_ABSPATH is NULL.  HINT_CACHE_MUTEX must be held. */
+static svn_error_t *
+hint_forget_body(const char *wcroot_abspath,
+                 apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  if (wcroot_abspath == NULL)
+    {
+      svn_pool_clear(hint_cache_pool);
+      hint_cache = apr_hash_make(hint_cache_pool);
+      return SVN_NO_ERROR;
+    }
+
+  for (hi = apr_hash_first(scratch_pool, hint_cache);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const wcroot_hint_t *hint = apr_hash_this_val(hi);
+
+      if (strcmp(hint->wcroot_abspath, wcroot_abspath) == 0)
+        svn_hash_sets(hint_cache, apr_hash_this_key(hi), NULL);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Consult the hint cache for DIR_ABSPATH.  If a usable hint exists, set
+   *WCROOT_ABSPATH to the recorded wcroot directory, allocated in
+   RESULT_POOL; otherwise set it to NULL.
+
+   A hint is usable when the recorded wcroot is DIR_ABSPATH itself or one
+   of its ancestors and still exists on disk with the identity it was
+   recorded with; hints failing that test are dropped. */
+static svn_error_t *
+wcroot_hint_lookup(const char **wcroot_abspath,
+                   const char *dir_abspath,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  svn_boolean_t have_identity;
+  apr_finfo_t finfo;
+  const char *key;
+  const char *hinted_abspath;
+  apr_dev_t device;
+  apr_ino_t inode;
+
+  *wcroot_abspath = NULL;
+
+  SVN_ERR(svn_atomic__init_once(&hint_cache_init_state, init_hint_cache,
+                                NULL, scratch_pool));
+
+  SVN_ERR(get_dir_identity(&have_identity, &finfo, dir_abspath,
+                           scratch_pool));
+  if (!have_identity)
+    return SVN_NO_ERROR;
+
+  key = hint_cache_key(&finfo, scratch_pool);
+  SVN_MUTEX__WITH_LOCK(hint_cache_mutex,
+                       hint_lookup_body(&hinted_abspath, &device, &inode,
+                                        key, result_pool));
+  if (!hinted_abspath)
+    return SVN_NO_ERROR;
+
+  if (svn_dirent_skip_ancestor(hinted_abspath, dir_abspath) == NULL)
+    return SVN_NO_ERROR;
+
+  if (strcmp(hinted_abspath, dir_abspath) != 0)
+    {
+      apr_finfo_t wcroot_finfo;
+
+      SVN_ERR(get_dir_identity(&have_identity, &wcroot_finfo,
+                               hinted_abspath, scratch_pool));
+      if (!have_identity
+          || wcroot_finfo.device != device
+          || wcroot_finfo.inode != inode)
+        {
+          /* The recorded wcroot is gone or was replaced. */
+          SVN_MUTEX__WITH_LOCK(hint_cache_mutex,
+                               hint_forget_body(hinted_abspath,
+                                                scratch_pool));
+          return SVN_NO_ERROR;
+        }
+    }
+  else if (finfo.device != device || finfo.inode != inode)
+    {
+      SVN_MUTEX__WITH_LOCK(hint_cache_mutex,
+                           hint_forget_body(hinted_abspath, scratch_pool));
+      return SVN_NO_ERROR;
+    }
+
+  *wcroot_abspath = hinted_abspath;
+  return SVN_NO_ERROR;
+}
+
+/* Record in the hint cache that DIR_ABSPATH is part of the working copy
+   rooted at WCROOT_ABSPATH. */
+static svn_error_t *
+wcroot_hint_record(const char *dir_abspath,
+                   const char *wcroot_abspath,
+                   apr_pool_t *scratch_pool)
+{
+  svn_boolean_t have_identity;
+  apr_finfo_t wcroot_finfo;
+
+  SVN_ERR(svn_atomic__init_once(&hint_cache_init_state, init_hint_cache,
+                                NULL, scratch_pool));
+
+  SVN_ERR(get_dir_identity(&have_identity, &wcroot_finfo, wcroot_abspath,
+                           scratch_pool));
+  if (!have_identity)
+    return SVN_NO_ERROR;
+
+  SVN_MUTEX__WITH_LOCK(hint_cache_mutex,
+                       hint_record_body(hint_cache_key(&wcroot_finfo,
+                                                       scratch_pool),
+                                        wcroot_abspath,
+                                        wcroot_finfo.device,
+                                        wcroot_finfo.inode));
+
+  if (strcmp(dir_abspath, wcroot_abspath) != 0)
+    {
+      apr_finfo_t dir_finfo;
+
+      SVN_ERR(get_dir_identity(&have_identity, &dir_finfo, dir_abspath,
+                               scratch_pool));
+      if (have_identity)
+        SVN_MUTEX__WITH_LOCK(hint_cache_mutex,
+                             hint_record_body(hint_cache_key(&dir_finfo,
+                                                             scratch_pool),
+                                              wcroot_abspath,
+                                              wcroot_finfo.device,
+                                              wcroot_finfo.inode));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_wcroot_forget_hints(const char *wcroot_abspath,
+                               apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_atomic__init_once(&hint_cache_init_state, init_hint_cache,
+                                NULL, scratch_pool));
+
+  SVN_MUTEX__WITH_LOCK(hint_cache_mutex,
+                       hint_forget_body(wcroot_abspath, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+
 /* A helper function to parse_local_abspath() which returns the on-disk KIND
    of LOCAL_ABSPATH, using DB and SCRATCH_POOL as needed.
 
@@ -294,6 +595,175 @@ svn_wc__db_close(svn_wc__db_t *db)
 }
 
 
+/* Pop an idle read-only connection for WCROOT into *SDB, or open a new
+   one with busy timeout TIMEOUT if none is parked.  New connections are
+   allocated in the wcroot's own pool so that they are closed together
+   with the primary connection, whether or not they ever return to the
+   idle list.  Must be called with WCROOT->snapshot_lock held:  neither
+   the idle array nor the wcroot's pool is synchronized by itself. */
+static svn_error_t *
+snapshot_checkout(svn_sqlite__db_t **sdb,
+                  svn_wc__db_wcroot_t *wcroot,
+                  apr_int32_t timeout,
+                  apr_pool_t *scratch_pool)
+{
+  if (wcroot->snapshot_sdbs->nelts > 0)
+    {
+      *sdb = *(svn_sqlite__db_t **)apr_array_pop(wcroot->snapshot_sdbs);
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(
+           svn_wc__db_util_open_db(sdb, wcroot->abspath, SDB_FILE,
+                                   svn_sqlite__mode_readonly,
+                                   FALSE /* exclusive */, timeout,
+                                   NULL /* my_statements */,
+                                   wcroot->snapshot_sdbs->pool,
+                                   scratch_pool));
+}
+
+/* Park SDB on WCROOT's idle list.  Must be called with
+   WCROOT->snapshot_lock held. */
+static svn_error_t *
+snapshot_checkin(svn_wc__db_wcroot_t *wcroot,
+                 svn_sqlite__db_t *sdb)
+{
+  APR_ARRAY_PUSH(wcroot->snapshot_sdbs, svn_sqlite__db_t *) = sdb;
+  return SVN_NO_ERROR;
+}
+
+/* Return SNAPSHOT_DB's connection to the idle list of the parent wcroot
+   and detach it from the snapshot.  A no-op if the connection was
+   already released. */
+static svn_error_t *
+release_snapshot_connection(svn_wc__db_t *snapshot_db)
+{
+  svn_wc__db_wcroot_t *parent = snapshot_db->snapshot_parent_wcroot;
+  svn_sqlite__db_t *sdb = snapshot_db->snapshot_wcroot->sdb;
+
+  if (sdb == NULL)
+    return SVN_NO_ERROR;
+
+  snapshot_db->snapshot_wcroot->sdb = NULL;
+  SVN_MUTEX__WITH_LOCK(parent->snapshot_lock,
+                       snapshot_checkin(parent, sdb));
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup handler:  release the connection of the snapshot DB given
+   by DATA, so that clearing the snapshot's pool recycles it. */
+static apr_status_t
+release_snapshot(void *data)
+{
+  svn_error_t *err = release_snapshot_connection(data);
+
+  if (err)
+    {
+      apr_status_t result = err->apr_err;
+      svn_error_clear(err);
+      return result;
+    }
+
+  return APR_SUCCESS;
+}
+
+
+svn_error_t *
+svn_wc__db_snapshot_open(svn_wc__db_t **snapshot_db,
+                         svn_wc__db_t *db,
+                         const char *wri_abspath,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot = NULL;
+  svn_wc__db_wcroot_t *snapshot_wcroot;
+  svn_sqlite__db_t *sdb;
+  svn_wc__db_t *new_db;
+  const char *scan_abspath;
+
+  SVN_ERR_ASSERT(db->snapshot_parent_wcroot == NULL);
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  /* Find the wcroot without svn_wc__db_wcroot_parse_local_abspath():
+     the parse cache is not safe against concurrent lookups, while pure
+     hash probes of an unchanging DIR_DATA are.  This restricts us to
+     working copies the caller has already opened through DB, which is
+     fine:  a snapshot only ever shadows an existing connection. */
+  scan_abspath = wri_abspath;
+  while (TRUE)
+    {
+      wcroot = svn_hash_gets(db->dir_data, scan_abspath);
+      if (wcroot && wcroot->sdb)
+        break;
+
+      wcroot = NULL;
+      if (svn_dirent_is_root(scan_abspath, strlen(scan_abspath)))
+        break;
+      scan_abspath = svn_dirent_dirname(scan_abspath, scratch_pool);
+    }
+
+  if (wcroot == NULL)
+    return svn_error_createf(SVN_ERR_WC_NOT_WORKING_COPY, NULL,
+                             _("The node '%s' was not opened through this "
+                               "working copy database"),
+                             svn_dirent_local_style(wri_abspath,
+                                                    scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_MUTEX__WITH_LOCK(wcroot->snapshot_lock,
+                       snapshot_checkout(&sdb, wcroot, db->timeout,
+                                         scratch_pool));
+
+  new_db = apr_pcalloc(result_pool, sizeof(*new_db));
+  new_db->config = db->config;
+  new_db->verify_format = db->verify_format;
+  new_db->enforce_empty_wq = FALSE;
+  new_db->timeout = db->timeout;
+  new_db->dir_data = apr_hash_make(result_pool);
+  new_db->state_pool = result_pool;
+  new_db->snapshot_parent_wcroot = wcroot;
+
+  /* The snapshot wcroot shares everything with its parent except the
+     SQLite connection.  It deliberately bypasses
+     svn_wc__db_pdh_create_wcroot():  the connection is owned by the
+     parent wcroot's pool and must not grow a close_wcroot() cleanup of
+     its own. */
+  snapshot_wcroot = apr_pcalloc(result_pool, sizeof(*snapshot_wcroot));
+  snapshot_wcroot->abspath = apr_pstrdup(result_pool, wcroot->abspath);
+  snapshot_wcroot->sdb = sdb;
+  snapshot_wcroot->wc_id = wcroot->wc_id;
+  snapshot_wcroot->format = wcroot->format;
+  snapshot_wcroot->owned_locks = apr_array_make(result_pool, 0,
+                                                sizeof(svn_wc__db_wclock_t));
+  snapshot_wcroot->access_cache = apr_hash_make(result_pool);
+  snapshot_wcroot->store_pristine = wcroot->store_pristine;
+  snapshot_wcroot->compress_pristine = wcroot->compress_pristine;
+  new_db->snapshot_wcroot = snapshot_wcroot;
+
+  svn_hash_sets(new_db->dir_data, snapshot_wcroot->abspath, snapshot_wcroot);
+
+  apr_pool_cleanup_register(result_pool, new_db, release_snapshot,
+                            apr_pool_cleanup_null);
+
+  *snapshot_db = new_db;
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_snapshot_close(svn_wc__db_t *snapshot_db)
+{
+  SVN_ERR_ASSERT(snapshot_db->snapshot_parent_wcroot != NULL);
+
+  SVN_ERR(release_snapshot_connection(snapshot_db));
+  apr_pool_cleanup_kill(snapshot_db->state_pool, snapshot_db,
+                        release_snapshot);
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                              const char *wcroot_abspath,
@@ -302,6 +772,7 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                              int format,
                              svn_boolean_t verify_format,
                              svn_boolean_t store_pristine,
+                             svn_boolean_t compress_pristine,
                              apr_pool_t *result_pool,
                              apr_pool_t *scratch_pool)
 {
@@ -390,6 +861,10 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                                           sizeof(svn_wc__db_wclock_t));
   (*wcroot)->access_cache = apr_hash_make(result_pool);
   (*wcroot)->store_pristine = store_pristine;
+  (*wcroot)->compress_pristine = compress_pristine;
+  (*wcroot)->snapshot_sdbs = apr_array_make(result_pool, 0,
+                                            sizeof(svn_sqlite__db_t *));
+  SVN_ERR(svn_mutex__init(&(*wcroot)->snapshot_lock, TRUE, result_pool));
 
   /* SDB will be NULL for pre-NG working copies. We only need to run a
      cleanup when the SDB is present.  */
@@ -499,6 +974,7 @@ verify_stats_table(svn_sqlite__db_t *sdb,
 /* Read and return the settings for WC_ID in SDB. */
 static svn_error_t *
 read_settings(svn_boolean_t *store_pristine_p,
+              svn_boolean_t *compress_pristine_p,
               svn_sqlite__db_t *sdb,
               int format,
               apr_int64_t wc_id,
@@ -513,12 +989,14 @@ read_settings(svn_boolean_t *store_pristine_p,
       SVN_ERR(svn_sqlite__step_row(stmt));
 
       *store_pristine_p = svn_sqlite__column_boolean(stmt, 0);
+      *compress_pristine_p = svn_sqlite__column_boolean(stmt, 1);
 
       SVN_ERR(svn_sqlite__step_done(stmt));
     }
   else
     {
       *store_pristine_p = TRUE;
+      *compress_pristine_p = FALSE;
     }
 
   return SVN_NO_ERROR;
@@ -531,6 +1009,7 @@ static svn_error_t *
 fetch_sdb_info(apr_int64_t *wc_id,
                int *format,
                svn_boolean_t *store_pristine,
+               svn_boolean_t *compress_pristine,
                svn_sqlite__db_t *sdb,
                apr_pool_t *scratch_pool)
 {
@@ -541,7 +1020,8 @@ fetch_sdb_info(apr_int64_t *wc_id,
         svn_wc__db_util_fetch_wc_id(wc_id, sdb, scratch_pool),
         svn_sqlite__read_schema_version(format, sdb, scratch_pool),
         verify_stats_table(sdb, *format, scratch_pool),
-        read_settings(store_pristine, sdb, *format, *wc_id, scratch_pool),
+        read_settings(store_pristine, compress_pristine,
+                      sdb, *format, *wc_id, scratch_pool),
         sdb);
 
   return SVN_NO_ERROR;
@@ -656,6 +1136,53 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
      database in the right place. If we find it... great! If not, then
      peel off some components, and try again. */
 
+  /* Consult the process-global hint cache before scanning upwards: if this
+     directory was resolved before, possibly by another svn_wc__db_t
+     instance, try opening the database at the recorded wcroot directly. */
+  {
+    const char *hinted_wcroot_abspath;
+
+    SVN_ERR(wcroot_hint_lookup(&hinted_wcroot_abspath, local_abspath,
+                               scratch_pool, scratch_pool));
+    if (hinted_wcroot_abspath)
+      {
+        svn_error_t *err;
+
+        err = svn_wc__db_util_open_db(&sdb, hinted_wcroot_abspath, SDB_FILE,
+                                      svn_sqlite__mode_readwrite,
+                                      db->exclusive, db->timeout, NULL,
+                                      db->state_pool, scratch_pool);
+        if (err)
+          {
+            /* The hint went stale; drop it and fall back to the scan. */
+            svn_error_clear(err);
+            SVN_ERR(svn_wc__db_wcroot_forget_hints(hinted_wcroot_abspath,
+                                                   scratch_pool));
+            sdb = NULL;
+          }
+        else
+          {
+#ifdef SVN_DEBUG
+            /* Install self-verification trigger statements. */
+            err = svn_sqlite__exec_statements(sdb,
+                                              STMT_VERIFICATION_TRIGGERS);
+            if (err && err->apr_err == SVN_ERR_SQLITE_ERROR)
+              {
+                /* Verification triggers can fail to install on old 1.7-dev
+                 * formats which didn't have a NODES table yet. Ignore sqlite
+                 * errors so such working copies can be upgraded. */
+                svn_error_clear(err);
+              }
+            else
+              SVN_ERR(err);
+#endif
+            if (strcmp(local_abspath, hinted_wcroot_abspath) != 0)
+              moved_upwards = TRUE;
+            local_abspath = hinted_wcroot_abspath;
+          }
+      }
+  }
+
   iterpool = svn_pool_create(scratch_pool);
   adm_relpath = svn_wc_get_adm_dir(scratch_pool);
   while (TRUE)
@@ -665,6 +1192,10 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
 
       const char *adm_subdir;
 
+      /* The hint cache already provided an open database. */
+      if (sdb != NULL)
+        break;
+
       svn_pool_clear(iterpool);
 
       adm_subdir = svn_dirent_join(local_abspath, adm_relpath, iterpool);
@@ -795,9 +1326,11 @@ try_symlink_as_dir:
       apr_int64_t wc_id;
       int format;
       svn_boolean_t store_pristine;
+      svn_boolean_t compress_pristine;
       svn_error_t *err;
 
-      err = fetch_sdb_info(&wc_id, &format, &store_pristine, sdb, scratch_pool);
+      err = fetch_sdb_info(&wc_id, &format, &store_pristine,
+                           &compress_pristine, sdb, scratch_pool);
       if (err)
         {
           if (err->apr_err == SVN_ERR_WC_CORRUPT)
@@ -818,7 +1351,7 @@ try_symlink_as_dir:
                                           : local_abspath),
                             sdb, wc_id, format,
                             db->verify_format,
-                            store_pristine,
+                            store_pristine, compress_pristine,
                             db->state_pool, scratch_pool);
       if (err && (err->apr_err == SVN_ERR_WC_UNSUPPORTED_FORMAT ||
                   err->apr_err == SVN_ERR_WC_UPGRADE_REQUIRED) &&
@@ -836,6 +1369,12 @@ try_symlink_as_dir:
              upgrading with exclusive wc locking. */
           return svn_error_compose_create(err, svn_sqlite__close(sdb));
         }
+
+      /* Remember where this working copy's root lives, so that future
+         svn_wc__db_t instances can skip the scan. */
+      if (*wcroot)
+        SVN_ERR(wcroot_hint_record(local_dir_abspath, (*wcroot)->abspath,
+                                   scratch_pool));
     }
   else
     {
@@ -894,7 +1433,7 @@ try_symlink_as_dir:
                                           : local_abspath),
                             NULL, UNKNOWN_WC_ID, wc_format,
                             db->verify_format,
-                            TRUE,
+                            TRUE, FALSE,
                             db->state_pool, scratch_pool));
     }
 
@@ -977,7 +1516,10 @@ try_symlink_as_dir:
               /* This handle was opened in this function but is not going
                  to be used further so close it. */
               if (sdb)
-                SVN_ERR(svn_sqlite__close(sdb));
+                {
+                  SVN_ERR(svn_sqlite__close(sdb));
+                  sdb = NULL;
+                }
               goto try_symlink_as_dir;
             }
         }
@@ -1060,6 +1602,10 @@ svn_wc__db_drop_root(svn_wc__db_t *db,
   if (result != APR_SUCCESS)
     return svn_error_wrap_apr(result, NULL);
 
+  /* The caller is probably about to replace this root; make sure no other
+     svn_wc__db_t instance is directed to it afterwards. */
+  SVN_ERR(svn_wc__db_wcroot_forget_hints(local_abspath, scratch_pool));
+
   return SVN_NO_ERROR;
 }
 
@@ -37,6 +37,11 @@ struct svn_wc__working_file_writer_t
   svn_boolean_t is_special;
   svn_stream_t *install_stream;
   svn_stream_t *write_stream;
+
+  /* Checksum of the translated contents as written to INSTALL_STREAM.
+     Only computed for writers that perform translation; remains NULL
+     until WRITE_STREAM has been closed. */
+  svn_checksum_t *checksum;
 };
 
 static apr_status_t
@@ -83,12 +88,21 @@ svn_wc__working_file_writer_open(svn_wc__working_file_writer_t **writer_p,
   if (final_mtime >= 0)
     svn_stream__install_set_affected_time(install_stream, final_mtime);
 
+  writer = apr_pcalloc(result_pool, sizeof(*writer));
+
   write_stream = install_stream;
 
   if (svn_subst_translation_required(eol_style, eol, keywords,
                                      FALSE /* special */,
                                      TRUE /* force_eol_check */))
     {
+      /* Remember the checksum of the translated contents, so that a
+         text-modified check can recognize an unchanged working file
+         without having to detranslate it. */
+      write_stream = svn_stream_checksummed2(write_stream,
+                                             NULL, &writer->checksum,
+                                             svn_checksum_sha1, TRUE,
+                                             result_pool);
       write_stream = svn_subst_stream_translated(write_stream,
                                                  eol,
                                                  repair_eol,
@@ -97,7 +111,6 @@ svn_wc__working_file_writer_open(svn_wc__working_file_writer_t **writer_p,
                                                  result_pool);
     }
 
-  writer = apr_pcalloc(result_pool, sizeof(*writer));
   writer->pool = result_pool;
   writer->tmp_abspath = apr_pstrdup(result_pool, tmp_abspath);
   writer->is_special = is_special;
@@ -117,6 +130,17 @@ svn_wc__working_file_writer_get_stream(svn_wc__working_file_writer_t *writer)
   return writer->write_stream;
 }
 
+const svn_checksum_t *
+svn_wc__working_file_writer_get_checksum(svn_wc__working_file_writer_t *writer)
+{
+  /* For special files, the written contents do not correspond to what
+     ends up on disk. */
+  if (writer->is_special)
+    return NULL;
+
+  return writer->checksum;
+}
+
 svn_error_t *
 svn_wc__working_file_writer_finalize(apr_time_t *mtime_p,
                                      apr_off_t *size_p,
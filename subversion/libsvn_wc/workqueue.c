@@ -90,7 +90,8 @@ static void
 wq_record_fileinfo(work_item_baton_t *wqb,
                    const char *local_abspath,
                    apr_time_t mtime,
-                   svn_filesize_t size)
+                   svn_filesize_t size,
+                   const svn_checksum_t *translated_checksum)
 {
   svn_wc__db_fileinfo_t *info;
 
@@ -102,6 +103,9 @@ wq_record_fileinfo(work_item_baton_t *wqb,
   info = apr_pcalloc(wqb->result_pool, sizeof(*info));
   info->mtime = mtime;
   info->size = size;
+  if (translated_checksum)
+    info->translated_checksum = svn_checksum_dup(translated_checksum,
+                                                 wqb->result_pool);
 
   svn_hash_sets(wqb->record_map, apr_pstrdup(wqb->result_pool, local_abspath),
                 info);
@@ -555,10 +559,9 @@ run_file_install(work_item_baton_t *wqb,
     }
   else
     {
-      SVN_ERR(svn_wc__db_pristine_get_future_path(&source_abspath,
-                                                  wcroot_abspath,
-                                                  checksum,
-                                                  scratch_pool, scratch_pool));
+      /* Read the contents through the pristine store API below, which
+         transparently decompresses compressed pristine files. */
+      source_abspath = NULL;
     }
 
   /* Where is the Right Place to put a temp file in this working copy?  */
@@ -633,8 +636,21 @@ run_file_install(work_item_baton_t *wqb,
                                            scratch_pool,
                                            scratch_pool));
 
-  SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
-                                   scratch_pool, scratch_pool));
+  if (source_abspath)
+    {
+      SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
+                                       scratch_pool, scratch_pool));
+    }
+  else
+    {
+      SVN_ERR(svn_wc__db_pristine_read(&src_stream, NULL, db, wri_abspath,
+                                       checksum, scratch_pool, scratch_pool));
+      if (!src_stream)
+        return svn_error_createf(SVN_ERR_WC_PRISTINE_DEHYDRATED, NULL,
+                                 _("No local pristine contents for file '%s'"),
+                                 svn_dirent_local_style(local_abspath,
+                                                        scratch_pool));
+    }
 
   SVN_ERR(svn_stream_copy3(src_stream,
                            svn_wc__working_file_writer_get_stream(file_writer),
@@ -659,7 +675,9 @@ run_file_install(work_item_baton_t *wqb,
 
   if (record_fileinfo)
     {
-      wq_record_fileinfo(wqb, local_abspath, record_mtime, record_size);
+      wq_record_fileinfo(wqb, local_abspath, record_mtime, record_size,
+                         svn_wc__working_file_writer_get_checksum(
+                           file_writer));
     }
 
   return SVN_NO_ERROR;
@@ -1255,7 +1273,8 @@ run_record_fileinfo(work_item_baton_t *wqb,
 
   if (dirent->kind == svn_node_file)
     {
-      wq_record_fileinfo(wqb, local_abspath, dirent->mtime, dirent->filesize);
+      wq_record_fileinfo(wqb, local_abspath, dirent->mtime, dirent->filesize,
+                         NULL);
     }
 
   return SVN_NO_ERROR;
@@ -1506,6 +1525,12 @@ dispatch_work_item(work_item_baton_t *wqb,
 }
 
 
+/* The number of work items fetched and retired per wc.db transaction.
+   Executing the file operations of a whole page of items between the
+   fetch and retire transactions keeps the per-item transaction overhead
+   off the hot path when replaying large queues. */
+#define WORKQUEUE_BATCH_SIZE 100
+
 svn_error_t *
 svn_wc__wq_run(svn_wc__db_t *db,
                const char *wri_abspath,
@@ -1514,7 +1539,7 @@ svn_wc__wq_run(svn_wc__db_t *db,
                apr_pool_t *scratch_pool)
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  apr_uint64_t last_id = 0;
+  apr_pool_t *itempool = svn_pool_create(scratch_pool);
   work_item_baton_t wib = { 0 };
   wib.result_pool = svn_pool_create(scratch_pool);
 
@@ -1534,66 +1559,78 @@ svn_wc__wq_run(svn_wc__db_t *db,
 
   while (TRUE)
     {
-      apr_uint64_t id;
-      svn_skel_t *work_item;
-      svn_error_t *err;
+      apr_array_header_t *items;
+      apr_array_header_t *completed_ids;
+      svn_error_t *err = SVN_NO_ERROR;
+      int i;
 
       svn_pool_clear(iterpool);
 
-      if (! wib.used)
-        {
-          /* Make sure to do this *early* in the loop iteration. There may
-             be a LAST_ID that needs to be marked as completed, *before* we
-             start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_fetch_next(&id, &work_item, db, wri_abspath,
-                                           last_id, iterpool, iterpool));
-        }
-      else
+      /* Fetch a page of work items in a single transaction.  The items
+         stay in the queue until they are retired below, so a future
+         'svn cleanup' can continue the processing after an abort.  */
+      SVN_ERR(svn_wc__db_wq_fetch_batch(&items, db, wri_abspath,
+                                        WORKQUEUE_BATCH_SIZE,
+                                        iterpool, iterpool));
+      if (items->nelts == 0)
+        break;
+
+      completed_ids = apr_array_make(iterpool, items->nelts,
+                                     sizeof(apr_uint64_t));
+
+      for (i = 0; i < items->nelts && !err; i++)
         {
-          /* Make sure to do this *early* in the loop iteration. There may
-             be a LAST_ID that needs to be marked as completed, *before* we
-             start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_record_and_fetch_next(&id, &work_item,
-                                                      db, wri_abspath,
-                                                      last_id, wib.record_map,
-                                                      iterpool,
-                                                      wib.result_pool));
-
-          svn_pool_clear(wib.result_pool);
-          wib.record_map = NULL;
-          wib.used = FALSE;
+          const svn_wc__db_wq_item_t *item
+            = APR_ARRAY_IDX(items, i, svn_wc__db_wq_item_t *);
+
+          svn_pool_clear(itempool);
+
+          /* Stop work queue processing, if requested. A future
+             'svn cleanup' should be able to continue the processing.  */
+          if (cancel_func)
+            err = cancel_func(cancel_baton);
+          if (err)
+            break;
+
+          err = dispatch_work_item(&wib, db, wri_abspath, item->work_item,
+                                   cancel_func, cancel_baton, itempool);
+          if (err)
+            {
+              const char *skel
+                = svn_skel__unparse(item->work_item, scratch_pool)->data;
+
+              err = svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
+                                      _("Failed to run the WC DB work queue "
+                                        "associated with '%s', work item "
+                                        "%d %s"),
+                                      svn_dirent_local_style(wri_abspath,
+                                                             scratch_pool),
+                                      (int)item->id, skel);
+              break;
+            }
+
+          /* The work item finished without error. Mark it completed
+             in the retire transaction below.  */
+          APR_ARRAY_PUSH(completed_ids, apr_uint64_t) = item->id;
         }
 
-      /* Stop work queue processing, if requested. A future 'svn cleanup'
-         should be able to continue the processing. Note that we may
-         have WORK_ITEM, but we'll just skip its processing for now.  */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
+      /* Retire the completed items and record the collected file info in
+         a single transaction.  Do this even on failure, so that the items
+         that did complete are not repeated by a later 'svn cleanup'.  */
+      err = svn_error_compose_create(
+              err,
+              svn_wc__db_wq_retire_batch(db, wri_abspath, completed_ids,
+                                         wib.record_map, iterpool));
 
-      /* If we have a WORK_ITEM, then process the sucker. Otherwise,
-         we're done.  */
-      if (work_item == NULL)
-        break;
+      svn_pool_clear(wib.result_pool);
+      wib.record_map = NULL;
+      wib.used = FALSE;
 
-      err = dispatch_work_item(&wib, db, wri_abspath, work_item,
-                               cancel_func, cancel_baton, iterpool);
       if (err)
-        {
-          const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
-
-          return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
-                                   _("Failed to run the WC DB work queue "
-                                     "associated with '%s', work item %d %s"),
-                                   svn_dirent_local_style(wri_abspath,
-                                                          scratch_pool),
-                                   (int)id, skel);
-        }
-
-      /* The work item finished without error. Mark it completed
-         in the next loop.  */
-      last_id = id;
+        return svn_error_trace(err);
     }
 
+  svn_pool_destroy(itempool);
   svn_pool_destroy(iterpool);
   return SVN_NO_ERROR;
 }
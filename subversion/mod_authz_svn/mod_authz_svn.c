@@ -40,6 +40,7 @@
 
 #include "mod_dav_svn.h"
 #include "mod_authz_svn.h"
+#include "svn_hash.h"
 #include "svn_path.h"
 #include "svn_config.h"
 #include "svn_string.h"
@@ -534,6 +535,67 @@ get_access_conf(request_rec *r, authz_svn_config_rec *conf,
   return access_conf;
 }
 
+/* Wrapper around svn_repos_authz_check_access() which memoizes
+ * verdicts in the connection pool.  Each request runs the access check
+ * hook chain up to three times, and the subrequests which mod_dav_svn
+ * issues for per-path authz repeat identical checks many more times,
+ * all on the same connection.
+ *
+ * The parsed authz file is cached in the connection pool as well (see
+ * get_access_conf), so the address of ACCESS_CONF identifies the
+ * generation of the rules a verdict was derived from: a re-read access
+ * file yields a new svn_authz_t and thereby new cache keys.
+ */
+static svn_error_t *
+cached_authz_check_access(svn_boolean_t *access_granted,
+                          svn_authz_t *access_conf,
+                          const char *repos_name,
+                          const char *repos_path,
+                          const char *username,
+                          svn_repos_authz_access_t required_access,
+                          request_rec *r,
+                          apr_pool_t *scratch_pool)
+{
+  static const char cache_key[] = "mod_authz_svn-verdict-cache";
+  apr_hash_t *verdicts;
+  void *user_data;
+  const char *key;
+  const char *verdict;
+
+  apr_pool_userdata_get(&user_data, cache_key, r->connection->pool);
+  verdicts = user_data;
+  if (verdicts == NULL)
+    {
+      verdicts = apr_hash_make(r->connection->pool);
+      apr_pool_userdata_set(verdicts, cache_key, NULL, r->connection->pool);
+    }
+
+  /* The username may contain any character, so separate the fields by
+   * a character that cannot appear in a request URI. */
+  key = apr_psprintf(scratch_pool, "%pp\n%s\n%d\n%s\n%s",
+                     (void *)access_conf,
+                     username ? username : "",
+                     (int)required_access,
+                     repos_name ? repos_name : "",
+                     repos_path ? repos_path : "");
+
+  verdict = svn_hash_gets(verdicts, key);
+  if (verdict)
+    {
+      *access_granted = (*verdict == 'A');
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_repos_authz_check_access(access_conf, repos_name, repos_path,
+                                       username, required_access,
+                                       access_granted, scratch_pool));
+
+  svn_hash_sets(verdicts, apr_pstrdup(r->connection->pool, key),
+                *access_granted ? "A" : "D");
+
+  return SVN_NO_ERROR;
+}
+
 /* Convert TEXT to upper case if TO_UPPERCASE is TRUE, else
    converts it to lower case. */
 static void
@@ -768,12 +830,12 @@ req_check_access(request_rec *r,
   if (repos_path
       || (!repos_path && (authz_svn_type & svn_authz_write)))
     {
-      svn_err = svn_repos_authz_check_access(access_conf, repos_name,
-                                             repos_path,
-                                             username_to_authorize,
-                                             authz_svn_type,
-                                             &authz_access_granted,
-                                             r->pool);
+      svn_err = cached_authz_check_access(&authz_access_granted,
+                                          access_conf, repos_name,
+                                          repos_path,
+                                          username_to_authorize,
+                                          authz_svn_type,
+                                          r, r->pool);
       if (svn_err)
         {
           log_svn_error(APLOG_MARK, r,
@@ -803,14 +865,14 @@ req_check_access(request_rec *r,
      repos_path == NULL (see above for explanations) */
   if (repos_path)
     {
-      svn_err = svn_repos_authz_check_access(access_conf,
-                                             dest_repos_name,
-                                             dest_repos_path,
-                                             username_to_authorize,
-                                             svn_authz_write
-                                             |svn_authz_recursive,
-                                             &authz_access_granted,
-                                             r->pool);
+      svn_err = cached_authz_check_access(&authz_access_granted,
+                                          access_conf,
+                                          dest_repos_name,
+                                          dest_repos_path,
+                                          username_to_authorize,
+                                          svn_authz_write
+                                          |svn_authz_recursive,
+                                          r, r->pool);
       if (svn_err)
         {
           log_svn_error(APLOG_MARK, r,
@@ -867,12 +929,12 @@ subreq_bypass2(request_rec *r,
    */
   if (repos_path)
     {
-      svn_err = svn_repos_authz_check_access(access_conf, repos_name,
-                                             repos_path,
-                                             username_to_authorize,
-                                             svn_authz_none|svn_authz_read,
-                                             &authz_access_granted,
-                                             scratch_pool);
+      svn_err = cached_authz_check_access(&authz_access_granted,
+                                          access_conf, repos_name,
+                                          repos_path,
+                                          username_to_authorize,
+                                          svn_authz_none|svn_authz_read,
+                                          r, scratch_pool);
       if (svn_err)
         {
           log_svn_error(APLOG_MARK, r,
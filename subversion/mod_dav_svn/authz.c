@@ -34,8 +34,8 @@
 #include "dav_svn.h"
 
 
-svn_boolean_t
-dav_svn__allow_read(request_rec *r,
+static svn_boolean_t
+allow_read_internal(request_rec *r,
                     const dav_svn_repos *repos,
                     const char *path,
                     svn_revnum_t rev,
@@ -97,6 +97,20 @@ dav_svn__allow_read(request_rec *r,
   return allowed;
 }
 
+svn_boolean_t
+dav_svn__allow_read(request_rec *r,
+                    const dav_svn_repos *repos,
+                    const char *path,
+                    svn_revnum_t rev,
+                    apr_pool_t *pool)
+{
+  apr_time_t timing_start = dav_svn__timing_start(r);
+  svn_boolean_t allowed = allow_read_internal(r, repos, path, rev, pool);
+
+  dav_svn__timing_stop(r, DAV_SVN__PHASE_AUTHZ, timing_start);
+  return allowed;
+}
+
 
 svn_boolean_t
 dav_svn__allow_list_repos(request_rec *r,
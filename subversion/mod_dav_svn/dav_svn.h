@@ -152,6 +152,13 @@ typedef struct dav_svn_repos {
   /* Cached yongest revision of the repository. SVN_INVALID_REVNUM if
      youngest revision is not fetched yet. */
   svn_revnum_t youngest_rev;
+
+  /* Lazily created cache of the repository data the liveprop code
+     derives property values from, shared by all resources of this
+     request.  A PROPFIND with Depth:1 renders the same properties for
+     every entry of a collection, so the lookups repeat both per
+     property and per entry.  See liveprops.c for the key format. */
+  apr_hash_t *liveprop_cache;
 } dav_svn_repos;
 
 
@@ -347,6 +354,39 @@ dav_svn__get_nodeprop_cache_flag(request_rec *r);
  * request? */
 svn_boolean_t dav_svn__get_block_read_flag(request_rec *r);
 
+/* for the repository referred to by this request, may update-report
+ * responses be generated on a worker thread feeding the connection
+ * through a pipe? */
+svn_boolean_t dav_svn__get_pipelined_updates_flag(request_rec *r);
+
+/* for the repository referred to by this request, shall per-request
+ * timing information be collected and logged? */
+svn_boolean_t dav_svn__get_request_timing_flag(request_rec *r);
+
+/* The request processing phases that per-request timing distinguishes. */
+enum dav_svn__timing_phase {
+  DAV_SVN__PHASE_OPEN,     /* resource lookup, incl. opening the repos */
+  DAV_SVN__PHASE_AUTHZ,    /* path-based authorization subrequests */
+  DAV_SVN__PHASE_DELIVER,  /* GET / PROPFIND response rendering */
+  DAV_SVN__PHASE_REPORT,   /* REPORT response generation */
+  DAV_SVN__PHASE_COUNT     /* size marker, not an actual phase */
+};
+
+/* If SVNRequestTiming is enabled for R, make sure R's main request has
+ * a timing record and return the current time; return 0 otherwise.
+ * The result is to be handed to dav_svn__timing_stop(). */
+apr_time_t dav_svn__timing_start(request_rec *r);
+
+/* Account the time elapsed since START with PHASE in the timing record
+ * of R's main request.  This is a no-op when START is 0. */
+void dav_svn__timing_stop(request_rec *r,
+                          enum dav_svn__timing_phase phase,
+                          apr_time_t start);
+
+/* Return a one-line summary of the timing record of R's main request,
+ * allocated in POOL, or NULL if no timing data has been collected. */
+const char *dav_svn__timing_summary(request_rec *r, apr_pool_t *pool);
+
 /* for the repository referred to by this request, are subrequests bypassed?
  * A function pointer if yes, NULL if not.
  */
@@ -491,6 +531,43 @@ dav_svn__output_pass_brigade(dav_svn__output *output,
                              apr_bucket_brigade *bb);
 
 
+/* A bounded in-memory pipe carrying response data from a generator
+   thread to the request thread.  The generator writes through a piped
+   dav_svn__output while the request thread forwards the pipe's content
+   to the real output, overlapping repository reads with network writes. */
+typedef struct dav_svn__output_pipe dav_svn__output_pipe;
+
+/* Create a pipe with a buffer of CAPACITY bytes in *PIPE_P, allocated
+   in RESULT_POOL.  Writers block while the buffer is full, which bounds
+   the amount of response data a fast generator can accumulate. */
+svn_error_t *
+dav_svn__output_pipe_create(dav_svn__output_pipe **pipe_p,
+                            apr_size_t capacity,
+                            apr_pool_t *result_pool);
+
+/* Create an output wrapper for request R which appends all data to PIPE
+   instead of the filter stack, allocated in POOL.  The returned output
+   has a bucket allocator of its own, so it may be used from a thread
+   other than the one serving R. */
+dav_svn__output *
+dav_svn__output_create_piped(request_rec *r,
+                             dav_svn__output_pipe *pipe,
+                             apr_pool_t *pool);
+
+/* Declare that no further data will be written to PIPE.  The producer
+   must call this exactly once, also after an error. */
+svn_error_t *
+dav_svn__output_pipe_close(dav_svn__output_pipe *pipe);
+
+/* Forward data from PIPE to OUTPUT, buffering it in BB, until the
+   producer closes the pipe.  If OUTPUT fails, mark the pipe as aborted
+   so that further writes into it fail, and return the error. */
+svn_error_t *
+dav_svn__output_pipe_drain(dav_svn__output_pipe *pipe,
+                           dav_svn__output *output,
+                           apr_bucket_brigade *bb);
+
+
 /*** activity.c ***/
 
 /* Create a new transaction based on HEAD in REPOS, setting *PTXN_NAME
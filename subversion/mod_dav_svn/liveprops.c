@@ -32,6 +32,7 @@
 #include <mod_dav.h>
 
 #include "svn_checksum.h"
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_time.h"
 #include "svn_dav.h"
@@ -116,6 +117,77 @@ static const dav_liveprop_spec props[] =
 };
 
 
+/* A revision property value in the request's liveprop cache.  VALUE
+   may be NULL when the revision does not have the property. */
+typedef struct cached_revprop_t
+{
+  svn_string_t *value;
+} cached_revprop_t;
+
+
+/* Return the liveprop cache of RESOURCE's request, creating it if
+   this is the first use. */
+static apr_hash_t *
+get_liveprop_cache(const dav_resource *resource)
+{
+  dav_svn_repos *repos = resource->info->repos;
+
+  if (! repos->liveprop_cache)
+    repos->liveprop_cache = apr_hash_make(repos->pool);
+
+  return repos->liveprop_cache;
+}
+
+
+/* Set *COMMITTED_REV to the created-rev of the node RESOURCE refers
+   to.  Several properties are derived from that one noderev field and
+   a Depth:1 PROPFIND renders each of them for every entry of the
+   collection, so remember the value in the request's liveprop cache.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+get_node_created_rev(svn_revnum_t *committed_rev,
+                     const dav_resource *resource,
+                     apr_pool_t *scratch_pool)
+{
+  dav_svn_repos *repos = resource->info->repos;
+  const char *key = NULL;
+  svn_revnum_t *cached;
+
+  /* Only nodes in revision roots get cache entries; the node behind a
+     path in a transaction root may change within the request. */
+  if (resource->type == DAV_RESOURCE_TYPE_REGULAR
+      && SVN_IS_VALID_REVNUM(resource->info->root.rev)
+      && resource->info->repos_path)
+    key = apr_psprintf(scratch_pool, "cr:%ld:%s",
+                       resource->info->root.rev,
+                       resource->info->repos_path);
+
+  if (key)
+    {
+      cached = svn_hash_gets(get_liveprop_cache(resource), key);
+      if (cached)
+        {
+          *committed_rev = *cached;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  SVN_ERR(svn_fs_node_created_rev(committed_rev,
+                                  resource->info->root.root,
+                                  resource->info->repos_path,
+                                  scratch_pool));
+
+  if (key)
+    {
+      cached = apr_pmemdup(repos->pool, committed_rev, sizeof(*cached));
+      svn_hash_sets(get_liveprop_cache(resource),
+                    apr_pstrdup(repos->pool, key), cached);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Set *PROPVAL to the value for the revision property PROPNAME on
    COMMITTED_REV, in the repository identified by RESOURCE, if
    RESOURCE's path is readable.  If it is not readable, set *PROPVAL
@@ -148,18 +220,43 @@ get_path_revprop(svn_string_t **propval,
                  const char *propname,
                  apr_pool_t *pool)
 {
+  dav_svn_repos *repos = resource->info->repos;
+  cached_revprop_t *cached;
+  const char *key;
+
   *propval = NULL;
 
   if (! dav_svn__allow_read_resource(resource, committed_rev, pool))
     return SVN_NO_ERROR;
 
+  /* Many entries of a collection share their created revision, so the
+     same few revprops are fetched over and over during a Depth:1
+     PROPFIND.  Only the fetch is cached; the path readability above
+     is still checked for each resource. */
+  key = apr_psprintf(pool, "rp:%ld:%s", committed_rev, propname);
+  cached = svn_hash_gets(get_liveprop_cache(resource), key);
+  if (cached)
+    {
+      *propval = cached->value;
+      return SVN_NO_ERROR;
+    }
+
   /* Get the property of the created revision. The authz is already
      performed, so we don't need to do it here too. */
-  return svn_repos_fs_revision_prop(propval,
-                                    resource->info->repos->repos,
-                                    committed_rev,
-                                    propname,
-                                    NULL, NULL, pool);
+  SVN_ERR(svn_repos_fs_revision_prop(propval,
+                                     resource->info->repos->repos,
+                                     committed_rev,
+                                     propname,
+                                     NULL, NULL, pool));
+
+  cached = apr_pcalloc(repos->pool, sizeof(*cached));
+  if (*propval)
+    cached->value = svn_string_dup(*propval, repos->pool);
+  svn_hash_sets(get_liveprop_cache(resource),
+                apr_pstrdup(repos->pool, key), cached);
+  *propval = cached->value;
+
+  return SVN_NO_ERROR;
 }
 
 
@@ -201,9 +298,7 @@ get_last_modified_time(const char **datestring,
            || resource->type == DAV_RESOURCE_TYPE_WORKING
            || resource->type == DAV_RESOURCE_TYPE_VERSION)
     {
-      serr = svn_fs_node_created_rev(&committed_rev,
-                                     resource->info->root.root,
-                                     resource->info->repos_path, pool);
+      serr = get_node_created_rev(&committed_rev, resource, pool);
       if (serr != NULL)
         {
           svn_error_clear(serr);
@@ -380,10 +475,8 @@ insert_prop_internal(const dav_resource *resource,
           {
             /* Get the CR field out of the node's skel.  Notice that the
                root object might be an ID root -or- a revision root. */
-            serr = svn_fs_node_created_rev(&committed_rev,
-                                           resource->info->root.root,
-                                           resource->info->repos_path,
-                                           scratch_pool);
+            serr = get_node_created_rev(&committed_rev, resource,
+                                        scratch_pool);
             if (serr != NULL)
               {
                 ap_log_rerror(APLOG_MARK, APLOG_ERR, serr->apr_err,
@@ -644,10 +737,8 @@ insert_prop_internal(const dav_resource *resource,
 
           /* Get the CR field out of the node's skel.  Notice that the
              root object might be an ID root -or- a revision root. */
-          serr = svn_fs_node_created_rev(&committed_rev,
-                                         resource->info->root.root,
-                                         resource->info->repos_path,
-                                         scratch_pool);
+          serr = get_node_created_rev(&committed_rev, resource,
+                                      scratch_pool);
           if (serr != NULL)
             {
               ap_log_rerror(APLOG_MARK, APLOG_ERR, serr->apr_err,
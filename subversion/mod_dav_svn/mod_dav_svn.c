@@ -42,6 +42,7 @@
 #include "svn_dso.h"
 #include "mod_dav_svn.h"
 
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
 #include "private/svn_subr_private.h"
 
@@ -107,6 +108,9 @@ typedef struct dir_conf_t {
   enum conf_flag revprop_cache;      /* whether to enable revprop caching */
   enum conf_flag nodeprop_cache;     /* whether to enable nodeprop caching */
   enum conf_flag block_read;         /* whether to enable block read mode */
+  enum conf_flag pipelined_updates;  /* whether to generate update reports
+                                        on a worker thread */
+  enum conf_flag request_timing;     /* whether to log per-request timing */
   const char *hooks_env;             /* path to hook script env config file */
 } dir_conf_t;
 
@@ -120,6 +124,11 @@ extern module AP_MODULE_DECLARE_DATA dav_svn_module;
 /* The authz_svn provider for bypassing path authz. */
 static authz_svn__subreq_bypass_func_t pathauthz_bypass_func = NULL;
 
+/* Whether SVNSharedInMemoryCache has been enabled, i.e. whether the
+ * global membuffer cache shall be placed in shared memory and be created
+ * in the parent process such that all httpd children share it. */
+static svn_boolean_t use_shared_inmemory_cache = FALSE;
+
 static int
 init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
 {
@@ -150,6 +159,18 @@ init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
   conf = ap_get_module_config(s->module_config, &dav_svn_module);
   svn_utf_initialize2(conf->use_utf8, p);
 
+  /* If the children shall share one in-memory cache, it must be created
+   * now, i.e. in the parent process before any child gets forked.  The
+   * forked children then inherit the shared memory segment. */
+  if (use_shared_inmemory_cache)
+    {
+      svn_cache__set_global_membuffer_shared(TRUE);
+      if (svn_cache__get_global_membuffer_cache() == NULL)
+        ap_log_perror(APLOG_MARK, APLOG_WARNING, 0, p,
+                      "mod_dav_svn: could not create the shared "
+                      "in-memory cache; using per-process caches");
+    }
+
   return OK;
 }
 
@@ -286,6 +307,9 @@ merge_dir_config(apr_pool_t *p, void *base, void *overrides)
   newconf->revprop_cache = INHERIT_VALUE(parent, child, revprop_cache);
   newconf->nodeprop_cache = INHERIT_VALUE(parent, child, nodeprop_cache);
   newconf->block_read = INHERIT_VALUE(parent, child, block_read);
+  newconf->pipelined_updates = INHERIT_VALUE(parent, child,
+                                             pipelined_updates);
+  newconf->request_timing = INHERIT_VALUE(parent, child, request_timing);
   newconf->root_dir = INHERIT_VALUE(parent, child, root_dir);
   newconf->hooks_env = INHERIT_VALUE(parent, child, hooks_env);
 
@@ -611,6 +635,32 @@ SVNBlockRead_cmd(cmd_parms *cmd, void *config, int arg)
   return NULL;
 }
 
+static const char *
+SVNPipelinedUpdates_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->pipelined_updates = CONF_FLAG_ON;
+  else
+    conf->pipelined_updates = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
+static const char *
+SVNRequestTiming_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->request_timing = CONF_FLAG_ON;
+  else
+    conf->request_timing = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
 static const char *
 SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -631,6 +681,14 @@ SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNSharedInMemoryCache_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  use_shared_inmemory_cache = arg != 0;
+
+  return NULL;
+}
+
 static const char *
 SVNCompressionLevel_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -1034,6 +1092,28 @@ dav_svn__get_block_read_flag(request_rec *r)
   return get_conf_flag(conf->block_read, FALSE);
 }
 
+svn_boolean_t
+dav_svn__get_pipelined_updates_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* pipelined update report generation is disabled by default. */
+  return get_conf_flag(conf->pipelined_updates, FALSE);
+}
+
+svn_boolean_t
+dav_svn__get_request_timing_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* request timing is disabled by default. */
+  return get_conf_flag(conf->request_timing, FALSE);
+}
+
 int
 dav_svn__get_compression_level(request_rec *r)
 {
@@ -1179,6 +1259,135 @@ merge_xml_in_filter(ap_filter_t *f,
 
 
 /* Response handler for POST requests (protocol-v2 commits).  */
+/* Per-request timing record; see dav_svn__timing_start(). */
+typedef struct request_timing_t
+{
+  /* Accumulated time per phase, in microseconds. */
+  apr_uint64_t phase_usecs[DAV_SVN__PHASE_COUNT];
+
+  /* Time the record was created. */
+  apr_time_t start;
+
+  /* Global membuffer cache read / hit totals when the record was
+     created.  The summary reports the difference to the totals at the
+     end of the request.  Note that in threaded servers, concurrent
+     requests of the same process contribute to the same totals. */
+  apr_uint64_t cache_reads;
+  apr_uint64_t cache_hits;
+} request_timing_t;
+
+/* Return the timing record of R's main request, creating it if there
+   is none yet. */
+static request_timing_t *
+get_request_timing(request_rec *r)
+{
+  request_timing_t *timing;
+
+  while (r->main)
+    r = r->main;
+
+  timing = ap_get_module_config(r->request_config, &dav_svn_module);
+  if (!timing)
+    {
+      timing = apr_pcalloc(r->pool, sizeof(*timing));
+      timing->start = apr_time_now();
+
+      if (svn_cache__get_global_membuffer_cache())
+        {
+          svn_cache__info_t *info
+            = svn_cache__membuffer_get_global_info(r->pool);
+
+          timing->cache_reads = info->gets;
+          timing->cache_hits = info->hits;
+        }
+
+      ap_set_module_config(r->request_config, &dav_svn_module, timing);
+    }
+
+  return timing;
+}
+
+apr_time_t
+dav_svn__timing_start(request_rec *r)
+{
+  if (!dav_svn__get_request_timing_flag(r))
+    return 0;
+
+  get_request_timing(r);
+  return apr_time_now();
+}
+
+void
+dav_svn__timing_stop(request_rec *r,
+                     enum dav_svn__timing_phase phase,
+                     apr_time_t start)
+{
+  if (start == 0)
+    return;
+
+  get_request_timing(r)->phase_usecs[phase] += apr_time_now() - start;
+}
+
+const char *
+dav_svn__timing_summary(request_rec *r, apr_pool_t *pool)
+{
+  static const char * const phase_names[DAV_SVN__PHASE_COUNT]
+    = { "open", "authz", "deliver", "report" };
+  const request_timing_t *timing;
+  const char *summary;
+  apr_uint64_t cache_reads = 0;
+  apr_uint64_t cache_hits = 0;
+  int i;
+
+  while (r->main)
+    r = r->main;
+
+  timing = ap_get_module_config(r->request_config, &dav_svn_module);
+  if (!timing)
+    return NULL;
+
+  if (svn_cache__get_global_membuffer_cache())
+    {
+      svn_cache__info_t *info = svn_cache__membuffer_get_global_info(pool);
+
+      cache_reads = info->gets - timing->cache_reads;
+      cache_hits = info->hits - timing->cache_hits;
+    }
+
+  summary = apr_psprintf(pool, "total=%" APR_UINT64_T_FMT "us",
+                         (apr_uint64_t)(apr_time_now() - timing->start));
+  for (i = 0; i < DAV_SVN__PHASE_COUNT; ++i)
+    if (timing->phase_usecs[i] > 0)
+      summary = apr_psprintf(pool, "%s %s=%" APR_UINT64_T_FMT "us",
+                             summary, phase_names[i],
+                             timing->phase_usecs[i]);
+
+  return apr_psprintf(pool,
+                      "%s cache-hits=%" APR_UINT64_T_FMT
+                      "/%" APR_UINT64_T_FMT,
+                      summary, cache_hits, cache_reads);
+}
+
+/* Implements the #log_transaction hook.  If timing data was collected
+ * for R, expose the summary as the 'dav_svn-timing' request note - for
+ * use as %{dav_svn-timing}n in CustomLog formats - and write it to the
+ * error log at INFO level.  Registered as APR_HOOK_FIRST so that the
+ * note is in place before the access loggers run. */
+static int
+log_request_timing(request_rec *r)
+{
+  const char *summary = dav_svn__timing_summary(r, r->pool);
+
+  if (summary)
+    {
+      apr_table_setn(r->notes, "dav_svn-timing", summary);
+      ap_log_rerror(APLOG_MARK, APLOG_INFO, 0, r,
+                    "mod_dav_svn: request timing: %s", summary);
+    }
+
+  return DECLINED;
+}
+
 static int dav_svn__handler(request_rec *r)
 {
   dir_conf_t *conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
@@ -1389,6 +1598,21 @@ static const command_rec cmds[] =
                "caches (see SVNInMemoryCacheSize) have been configured."
                "(default is Off)."),
 
+  /* per directory/location */
+  AP_INIT_FLAG("SVNPipelinedUpdates", SVNPipelinedUpdates_cmd, NULL,
+               ACCESS_CONF|RSRC_CONF,
+               "overlaps repository reads with network writes when "
+               "generating update reports by using a worker thread; "
+               "only takes effect when SVNPathAuthz is Off "
+               "(default is Off)."),
+
+  /* per directory/location */
+  AP_INIT_FLAG("SVNRequestTiming", SVNRequestTiming_cmd, NULL,
+               ACCESS_CONF|RSRC_CONF,
+               "logs a per-request timing breakdown - phase times and "
+               "cache hit counts - to the error log and to the "
+               "'dav_svn-timing' request note (default is Off)."),
+
   /* per server */
   AP_INIT_TAKE1("SVNInMemoryCacheSize", SVNInMemoryCacheSize_cmd, NULL,
                 RSRC_CONF,
@@ -1396,6 +1620,13 @@ static const command_rec cmds[] =
                 "in-memory object cache (default value is 16384; 0 switches "
                 "to dynamically sized caches)."),
   /* per server */
+  AP_INIT_FLAG("SVNSharedInMemoryCache", SVNSharedInMemoryCache_cmd, NULL,
+               RSRC_CONF,
+               "whether Subversion's in-memory object cache shall be "
+               "created in shared memory once in the parent process and "
+               "be shared by all httpd children instead of each child "
+               "keeping its own copy (default is Off)."),
+  /* per server */
   AP_INIT_TAKE1("SVNCompressionLevel", SVNCompressionLevel_cmd, NULL,
                 RSRC_CONF,
                 "specifies the compression level used before sending file "
@@ -1448,6 +1679,7 @@ register_hooks(apr_pool_t *pconf)
 
   /* general request handler for methods which mod_dav DECLINEs. */
   ap_hook_handler(dav_svn__handler, NULL, NULL, APR_HOOK_LAST);
+  ap_hook_log_transaction(log_request_timing, NULL, NULL, APR_HOOK_FIRST);
 
   /* Handler to GET Subversion's FSFS cache stats, a bit like mod_status. */
   ap_hook_handler(dav_svn__status, NULL, NULL, APR_HOOK_MIDDLE);
@@ -23,6 +23,7 @@
 
 #include <apr_pools.h>
 #include <apr_strings.h>
+#include <apr_thread_proc.h>
 #include <apr_xml.h>
 
 #include <http_request.h>
@@ -951,6 +952,302 @@ validate_input_revision(svn_revnum_t revision,
 }
 
 
+/* Complete the report given by RBATON and drive the update editor to
+   generate the response body, writing it to UC->bb / UC->output.  The
+   other arguments mirror the respective locals of
+   dav_svn__update_report().  Allocate everything in POOL, which is the
+   request pool for a sequential response and a thread-private pool for
+   a pipelined one.  RBATON is consumed and must not be aborted by the
+   caller afterwards. */
+static dav_error *
+deliver_report_body(update_ctx_t *uc,
+                    void *rbaton,
+                    const svn_delta_editor_t *editor,
+                    dav_svn__authz_read_baton *arb,
+                    dav_svn_repos *repos,
+                    const char *dst_path,
+                    const char *target,
+                    svn_boolean_t resource_walk,
+                    svn_depth_t requested_depth,
+                    apr_pool_t *pool)
+{
+  svn_error_t *serr;
+
+  /* this will complete the report, and then drive our editor to generate
+     the response to the client. */
+  serr = svn_repos_finish_report(rbaton, pool);
+  if (serr)
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "A failure occurred while "
+                                "driving the update report editor",
+                                pool);
+
+  /* ### Temporarily disable resource_walks for single-file switch
+     operations.  It isn't strictly necessary. */
+  if (dst_path && resource_walk)
+    {
+      /* Sanity check: if we switched a file, we can't do a resource
+         walk.  dir_delta would choke if we pass a filepath as the
+         'target'.  Also, there's no need to do the walk, since the
+         new vsn-rsc-url was already in the earlier part of the report. */
+      svn_node_kind_t dst_kind;
+      if ((serr = svn_fs_check_path(&dst_kind, uc->rev_root, dst_path,
+                                    pool)))
+        return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                    "Failed checking destination path kind",
+                                    pool);
+      if (dst_kind != svn_node_dir)
+        resource_walk = FALSE;
+    }
+
+  /* The potential "resource walk" part of the update-report. */
+  if (dst_path && resource_walk)  /* this was a 'switch' operation */
+    {
+      /* send a second embedded <S:resource-walk> tree that contains
+         the new vsn-rsc-urls for the switched dir.  this walk
+         contains essentially nothing but <add> tags. */
+      svn_fs_root_t *zero_root;
+      serr = svn_fs_revision_root(&zero_root, repos->fs, 0, pool);
+      if (serr)
+        return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                    "Failed to find the revision root",
+                                    pool);
+
+      serr = dav_svn__brigade_puts(uc->bb, uc->output,
+                                   "<S:resource-walk>" DEBUG_CR);
+      if (serr)
+        return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                    "Unable to begin resource walk",
+                                    pool);
+
+      uc->resource_walk = TRUE;
+
+      /* Compare subtree DST_PATH within a pristine revision to
+         revision 0.  This should result in nothing but 'add' calls
+         to the editor. */
+      serr = svn_repos_dir_delta2(zero_root, "", target,
+                                  uc->rev_root, dst_path,
+                                  /* re-use the editor */
+                                  editor, uc,
+                                  dav_svn__authz_read_func(arb),
+                                  arb, FALSE /* text-deltas */,
+                                  requested_depth,
+                                  TRUE /* entryprops */,
+                                  FALSE /* ignore-ancestry */,
+                                  pool);
+
+      if (serr)
+        return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                    "Resource walk failed.",
+                                    pool);
+
+      serr = dav_svn__brigade_puts(uc->bb, uc->output,
+                                   "</S:resource-walk>" DEBUG_CR);
+      if (serr)
+        return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                    "Unable to complete resource walk.",
+                                    pool);
+    }
+
+  /* Close the report body, unless some error prevented it from being
+     started in the first place. */
+  if (uc->started_update)
+    {
+      if ((serr = dav_svn__brigade_puts(uc->bb, uc->output,
+                                        "</S:update-report>" DEBUG_CR)))
+        return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                    "Unable to complete update report.",
+                                    pool);
+    }
+
+  return NULL;
+}
+
+
+#if APR_HAS_THREADS
+
+/* Capacity of the buffer between the generator thread and the request
+   thread: big enough to keep the generator busy across short network
+   stalls, small enough to bound the per-request memory overhead. */
+#define UPDATE_PIPE_CAPACITY (1024 * 1024)
+
+/* Pool cleanup handler: destroy the generator thread's private root
+   pool when the request pool it is registered on goes away. */
+static apr_status_t
+cleanup_worker_pool(void *data)
+{
+  apr_pool_t *worker_pool = data;
+  svn_pool_destroy(worker_pool);
+  return APR_SUCCESS;
+}
+
+/* The state shared with the generator thread of a pipelined
+   update-report. */
+typedef struct report_thread_baton_t
+{
+  /* The arguments of deliver_report_body(), with UC->output and UC->bb
+     already redirected into PIPE. */
+  update_ctx_t *uc;
+  void *rbaton;
+  const svn_delta_editor_t *editor;
+  dav_svn__authz_read_baton *arb;
+  dav_svn_repos *repos;
+  const char *dst_path;
+  const char *target;
+  svn_boolean_t resource_walk;
+  svn_depth_t requested_depth;
+
+  /* The pipe towards the request thread. */
+  dav_svn__output_pipe *pipe;
+
+  /* The thread's private root pool, the only pool it allocates from. */
+  apr_pool_t *pool;
+
+  /* The result of the drive, allocated in POOL. */
+  dav_error *derr;
+} report_thread_baton_t;
+
+/* Thread main function: generate the update-report response body into
+   the pipe described by DATA. */
+static void * APR_THREAD_FUNC
+report_thread(apr_thread_t *thread, void *data)
+{
+  report_thread_baton_t *b = data;
+
+  b->derr = deliver_report_body(b->uc, b->rbaton, b->editor, b->arb,
+                                b->repos, b->dst_path, b->target,
+                                b->resource_walk, b->requested_depth,
+                                b->pool);
+
+  /* Push the data still buffered in the brigade into the pipe. */
+  if (!b->derr)
+    {
+      svn_error_t *serr = dav_svn__output_pass_brigade(b->uc->output,
+                                                       b->uc->bb);
+      if (serr)
+        b->derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                       "A failure occurred while "
+                                       "delivering the update report",
+                                       b->pool);
+    }
+
+  /* Wake the request thread waiting for the end of the response. */
+  svn_error_clear(dav_svn__output_pipe_close(b->pipe));
+
+  return NULL;
+}
+
+/* Like deliver_report_body(), but run the drive on a worker thread
+   which writes into a bounded pipe while the calling thread forwards
+   the pipe's content to OUTPUT.  Fall back to the sequential variant
+   if no thread can be created. */
+static dav_error *
+deliver_report_body_pipelined(update_ctx_t *uc,
+                              void *rbaton,
+                              const svn_delta_editor_t *editor,
+                              dav_svn__authz_read_baton *arb,
+                              dav_svn_repos *repos,
+                              const char *dst_path,
+                              const char *target,
+                              svn_boolean_t resource_walk,
+                              svn_depth_t requested_depth,
+                              dav_svn__output *output)
+{
+  const dav_resource *resource = uc->resource;
+  svn_revnum_t revnum = svn_fs_revision_root_revision(uc->rev_root);
+  apr_bucket_brigade *request_bb = uc->bb;
+  report_thread_baton_t baton = { 0 };
+  dav_svn__output_pipe *pipe;
+  apr_pool_t *worker_pool;
+  apr_thread_t *thread;
+  apr_status_t status, thread_status;
+  svn_error_t *serr;
+
+  /* The worker must not share a pool, and hence an allocator, with the
+     threads serving this connection.  Give it a root pool of its own;
+     the request pool's cleanup destroys it, so any dav_error the
+     worker allocates stays valid until the end of the request. */
+  worker_pool = svn_pool_create(NULL);
+  apr_pool_cleanup_register(resource->pool, worker_pool,
+                            cleanup_worker_pool, apr_pool_cleanup_null);
+
+  serr = dav_svn__output_pipe_create(&pipe, UPDATE_PIPE_CAPACITY,
+                                     resource->pool);
+  if (serr)
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Could not create the update report pipe",
+                                resource->pool);
+
+  /* Reopen the target root in the worker's pool and redirect the
+     editor's output into the pipe, so that everything the drive
+     touches lives in pools only the worker allocates from. */
+  serr = svn_fs_revision_root(&uc->rev_root, repos->fs, revnum,
+                              worker_pool);
+  if (serr)
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "The revision root could not be created.",
+                                resource->pool);
+
+  uc->output = dav_svn__output_create_piped(resource->info->r, pipe,
+                                            worker_pool);
+  uc->bb = apr_brigade_create(worker_pool,
+                              dav_svn__output_get_bucket_alloc(uc->output));
+
+  baton.uc = uc;
+  baton.rbaton = rbaton;
+  baton.editor = editor;
+  baton.arb = arb;
+  baton.repos = repos;
+  baton.dst_path = dst_path;
+  baton.target = target;
+  baton.resource_walk = resource_walk;
+  baton.requested_depth = requested_depth;
+  baton.pipe = pipe;
+  baton.pool = worker_pool;
+
+  status = apr_thread_create(&thread, NULL, report_thread, &baton,
+                             resource->pool);
+  if (status)
+    {
+      /* No worker thread available; generate the response here as
+         usual. */
+      uc->output = output;
+      uc->bb = request_bb;
+      return deliver_report_body(uc, rbaton, editor, arb, repos, dst_path,
+                                 target, resource_walk, requested_depth,
+                                 resource->pool);
+    }
+
+  /* Stream completed chunks to the client while the worker is still
+     producing later parts of the response. */
+  serr = dav_svn__output_pipe_drain(pipe, output, request_bb);
+
+  /* A drain failure has aborted the pipe, which makes the worker's
+     next write fail and unwind the drive; wait for the worker in any
+     case before touching the shared state again. */
+  apr_thread_join(&thread_status, thread);
+
+  uc->output = output;
+  uc->bb = request_bb;
+
+  if (baton.derr)
+    {
+      svn_error_clear(serr);
+      return baton.derr;
+    }
+
+  if (serr)
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "A failure occurred while "
+                                "delivering the update report",
+                                resource->pool);
+
+  return NULL;
+}
+
+#endif /* APR_HAS_THREADS */
+
+
 dav_error *
 dav_svn__update_report(const dav_resource *resource,
                        const apr_xml_doc *doc,
@@ -1444,119 +1741,30 @@ dav_svn__update_report(const dav_resource *resource,
     dav_svn__operational_log(resource->info, action);
   }
 
-  /* this will complete the report, and then drive our editor to generate
-     the response to the client. */
-  serr = svn_repos_finish_report(rbaton, resource->pool);
-
-  /* Whether svn_repos_finish_report returns an error or not we can no
-     longer abort this report as the file has been closed. */
-  rbaton = NULL;
-
-  if (serr)
-    {
-      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                  "A failure occurred while "
-                                  "driving the update report editor",
-                                  resource->pool);
-      goto cleanup;
-    }
-
-  /* ### Temporarily disable resource_walks for single-file switch
-     operations.  It isn't strictly necessary. */
-  if (dst_path && resource_walk)
-    {
-      /* Sanity check: if we switched a file, we can't do a resource
-         walk.  dir_delta would choke if we pass a filepath as the
-         'target'.  Also, there's no need to do the walk, since the
-         new vsn-rsc-url was already in the earlier part of the report. */
-      svn_node_kind_t dst_kind;
-      if ((serr = svn_fs_check_path(&dst_kind, uc.rev_root, dst_path,
-                                    resource->pool)))
-        {
-          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                      "Failed checking destination path kind",
-                                      resource->pool);
-          goto cleanup;
-        }
-      if (dst_kind != svn_node_dir)
-        resource_walk = FALSE;
-    }
-
-  /* The potential "resource walk" part of the update-report. */
-  if (dst_path && resource_walk)  /* this was a 'switch' operation */
+  /* Complete the report and drive our editor to generate the response
+     to the client. */
+#if APR_HAS_THREADS
+  if (dav_svn__get_pipelined_updates_flag(resource->info->r)
+      && dav_svn__authz_read_func(&arb) == NULL)
     {
-      /* send a second embedded <S:resource-walk> tree that contains
-         the new vsn-rsc-urls for the switched dir.  this walk
-         contains essentially nothing but <add> tags. */
-      svn_fs_root_t *zero_root;
-      serr = svn_fs_revision_root(&zero_root, repos->fs, 0,
-                                  resource->pool);
-      if (serr)
-        {
-          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                      "Failed to find the revision root",
-                                      resource->pool);
-          goto cleanup;
-        }
-
-      serr = dav_svn__brigade_puts(uc.bb, uc.output,
-                                   "<S:resource-walk>" DEBUG_CR);
-      if (serr)
-        {
-          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                      "Unable to begin resource walk",
-                                      resource->pool);
-          goto cleanup;
-        }
-
-      uc.resource_walk = TRUE;
-
-      /* Compare subtree DST_PATH within a pristine revision to
-         revision 0.  This should result in nothing but 'add' calls
-         to the editor. */
-      serr = svn_repos_dir_delta2(zero_root, "", target,
-                                  uc.rev_root, dst_path,
-                                  /* re-use the editor */
-                                  editor, &uc,
-                                  dav_svn__authz_read_func(&arb),
-                                  &arb, FALSE /* text-deltas */,
-                                  requested_depth,
-                                  TRUE /* entryprops */,
-                                  FALSE /* ignore-ancestry */,
-                                  resource->pool);
-
-      if (serr)
-        {
-          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                      "Resource walk failed.",
-                                      resource->pool);
-          goto cleanup;
-        }
-
-      serr = dav_svn__brigade_puts(uc.bb, uc.output,
-                                   "</S:resource-walk>" DEBUG_CR);
-      if (serr)
-        {
-          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                      "Unable to complete resource walk.",
-                                      resource->pool);
-          goto cleanup;
-        }
+      /* Path-based authz is off, so the editor drive does not need to
+         run subrequests against this request; it can safely move to a
+         worker thread which overlaps repository reads and svndiff
+         encoding with the network writes done here. */
+      derr = deliver_report_body_pipelined(&uc, rbaton, editor, &arb,
+                                           repos, dst_path, target,
+                                           resource_walk, requested_depth,
+                                           output);
     }
+  else
+#endif
+    derr = deliver_report_body(&uc, rbaton, editor, &arb, repos, dst_path,
+                               target, resource_walk, requested_depth,
+                               resource->pool);
 
-  /* Close the report body, unless some error prevented it from being
-     started in the first place. */
-  if (uc.started_update)
-    {
-      if ((serr = dav_svn__brigade_puts(uc.bb, uc.output,
-                                        "</S:update-report>" DEBUG_CR)))
-        {
-          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                      "Unable to complete update report.",
-                                      resource->pool);
-          goto cleanup;
-        }
-    }
+  /* Whether the drive returned an error or not we can no longer abort
+     this report as the file has been closed. */
+  rbaton = NULL;
 
  cleanup:
 
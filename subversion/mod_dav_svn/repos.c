@@ -63,6 +63,10 @@
 
 #define DEFAULT_ACTIVITY_DB "dav/activities.d"
 
+/* Fulltexts at least this large are spooled to a temporary file and
+   delivered as a file bucket, so httpd can use sendfile. See deliver().  */
+#define DELIVER_SPOOL_THRESHOLD (1024 * 1024)
+
 
 struct dav_stream {
   const dav_resource *res;
@@ -2187,11 +2191,11 @@ parse_querystring(request_rec *r, const char *query,
 }
 
 static dav_error *
-get_resource(request_rec *r,
-             const char *root_path,
-             const char *label,
-             int use_checked_in,
-             dav_resource **resource)
+get_resource_internal(request_rec *r,
+                      const char *root_path,
+                      const char *label,
+                      int use_checked_in,
+                      dav_resource **resource)
 {
   const char *fs_path;
   const char *repo_name;
@@ -2685,6 +2689,24 @@ get_resource(request_rec *r,
                             "software.");
 }
 
+/* Implements the #get_resource method of mod_dav's #dav_hooks_repository
+   vtable; accounts the resource lookup - including opening the
+   repository - with the per-request timing, if enabled. */
+static dav_error *
+get_resource(request_rec *r,
+             const char *root_path,
+             const char *label,
+             int use_checked_in,
+             dav_resource **resource)
+{
+  apr_time_t timing_start = dav_svn__timing_start(r);
+  dav_error *derr = get_resource_internal(r, root_path, label,
+                                          use_checked_in, resource);
+
+  dav_svn__timing_stop(r, DAV_SVN__PHASE_OPEN, timing_start);
+  return derr;
+}
+
 
 /* Helper func:  return the parent of PATH, allocated in POOL.  If
    IS_URLPATH is set, PATH is a urlpath; otherwise, it's either a
@@ -3144,6 +3166,68 @@ seek_stream(dav_stream *stream, apr_off_t abs_position)
        && resource->baselined))
 
 
+/* Set *CREATED_REV to the created-rev of RESOURCE, consulting and
+   filling a small per-connection memo for pegged resources.  Clients
+   polling for changes re-validate the same pegged URLs over keepalive
+   connections between commits, and the created-rev is looked up for
+   both the ETag and the Last-Modified header of every such response.
+   A pegged path's created-rev never changes, so the memo needs no
+   invalidation.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+get_created_rev(svn_revnum_t *created_rev,
+                const dav_resource *resource,
+                apr_pool_t *scratch_pool)
+{
+  static const char cache_key[] = "mod_dav_svn-created-rev-memo";
+  request_rec *r = resource->info->r;
+  apr_hash_t *memo = NULL;
+  const char *key = NULL;
+
+  if (resource->info->idempotent
+      && SVN_IS_VALID_REVNUM(resource->info->root.rev)
+      && resource->info->repos_path)
+    {
+      void *user_data;
+      svn_revnum_t *cached;
+
+      apr_pool_userdata_get(&user_data, cache_key, r->connection->pool);
+      memo = user_data;
+      if (memo == NULL)
+        {
+          memo = apr_hash_make(r->connection->pool);
+          apr_pool_userdata_set(memo, cache_key, NULL, r->connection->pool);
+        }
+
+      /* One connection may serve several repositories (SVNParentPath),
+         so the key must identify the filesystem as well. */
+      key = apr_psprintf(scratch_pool, "%s:%ld:%s",
+                         resource->info->repos->fs_path,
+                         resource->info->root.rev,
+                         resource->info->repos_path);
+      cached = svn_hash_gets(memo, key);
+      if (cached)
+        {
+          *created_rev = *cached;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  SVN_ERR(svn_fs_node_created_rev(created_rev, resource->info->root.root,
+                                  resource->info->repos_path, scratch_pool));
+
+  if (key)
+    {
+      apr_pool_t *conn_pool = r->connection->pool;
+      svn_revnum_t *cached = apr_pmemdup(conn_pool, created_rev,
+                                         sizeof(*cached));
+
+      svn_hash_sets(memo, apr_pstrdup(conn_pool, key), cached);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 const char *
 dav_svn__getetag(const dav_resource *resource, apr_pool_t *pool)
 {
@@ -3155,9 +3239,7 @@ dav_svn__getetag(const dav_resource *resource, apr_pool_t *pool)
 
   /* ### what kind of etag to return for activities, etc.? */
 
-  if ((serr = svn_fs_node_created_rev(&created_rev, resource->info->root.root,
-                                      resource->info->repos_path,
-                                      pool)))
+  if ((serr = get_created_rev(&created_rev, resource, pool)))
     {
       /* ### what to do? */
       svn_error_clear(serr);
@@ -3235,9 +3317,7 @@ set_headers(request_rec *r, const dav_resource *resource)
       svn_revnum_t created_rev;
       svn_string_t *date_str = NULL;
 
-      serr = svn_fs_node_created_rev(&created_rev, resource->info->root.root,
-                                     resource->info->repos_path,
-                                     resource->pool);
+      serr = get_created_rev(&created_rev, resource, resource->pool);
 
       if (serr == NULL)
         {
@@ -3660,7 +3740,7 @@ emit_collection_tail(const dav_resource *resource,
 
 
 static dav_error *
-deliver(const dav_resource *resource, ap_filter_t *unused)
+deliver_internal(const dav_resource *resource, ap_filter_t *unused)
 {
   svn_error_t *serr;
   apr_bucket_brigade *bb;
@@ -3944,6 +4024,7 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
     {
       svn_stream_t *stream;
       char *block;
+      svn_boolean_t translated = FALSE;
 
       serr = svn_fs_file_contents(&stream,
                                   resource->info->root.root,
@@ -4024,6 +4105,68 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
               stream = svn_subst_stream_translated(
                            svn_stream_disown(stream, resource->pool),
                            NULL, FALSE, kw, TRUE, resource->pool);
+              translated = TRUE;
+            }
+        }
+
+      /* For large untranslated fulltexts, spool the contents to an
+         unlinked temporary file and hand httpd a file bucket, so the
+         network delivery can use sendfile instead of copying every
+         byte through the filter chain. The FS layer cannot give us a
+         contiguous on-disk span directly (representations are
+         deltified and compressed), so one spooling copy buys us
+         zero-copy delivery. Keyword-translated contents change size
+         while streaming, so those keep the read/write loop below. */
+      if (!translated)
+        {
+          svn_filesize_t length;
+
+          serr = svn_fs_file_length(&length, resource->info->root.root,
+                                    resource->info->repos_path,
+                                    resource->pool);
+          if (serr != NULL)
+            return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                        "could not determine file length",
+                                        resource->pool);
+
+          if (length >= DELIVER_SPOOL_THRESHOLD)
+            {
+              apr_file_t *spool_file;
+
+              serr = svn_io_open_unique_file3(&spool_file, NULL, NULL,
+                                              svn_io_file_del_on_pool_cleanup,
+                                              resource->pool, resource->pool);
+              if (serr == NULL)
+                serr = svn_stream_copy3(
+                         stream,
+                         svn_stream_from_aprfile2(spool_file, TRUE,
+                                                  resource->pool),
+                         NULL, NULL, resource->pool);
+              if (serr != NULL)
+                return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                            "could not spool the file "
+                                            "contents", resource->pool);
+
+              bb = apr_brigade_create(resource->pool,
+                                      dav_svn__output_get_bucket_alloc(output));
+              apr_brigade_insert_file(bb, spool_file, 0, (apr_off_t)length,
+                                      resource->pool);
+
+              bkt = apr_bucket_eos_create(
+                      dav_svn__output_get_bucket_alloc(output));
+              APR_BRIGADE_INSERT_TAIL(bb, bkt);
+              serr = dav_svn__output_pass_brigade(output, bb);
+              if (serr != NULL)
+                {
+                  apr_brigade_destroy(bb);
+                  return dav_svn__convert_err(serr,
+                                              HTTP_INTERNAL_SERVER_ERROR,
+                                              "Could not write data to "
+                                              "filter.", resource->pool);
+                }
+
+              apr_brigade_destroy(bb);
+              return NULL;
             }
         }
 
@@ -4082,6 +4225,20 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
     }
 }
 
+/* Implements the #deliver method of mod_dav's #dav_hooks_repository
+   vtable; accounts the response rendering with the per-request timing,
+   if enabled. */
+static dav_error *
+deliver(const dav_resource *resource, ap_filter_t *unused)
+{
+  request_rec *r = resource->info->r;
+  apr_time_t timing_start = dav_svn__timing_start(r);
+  dav_error *derr = deliver_internal(resource, unused);
+
+  dav_svn__timing_stop(r, DAV_SVN__PHASE_DELIVER, timing_start);
+  return derr;
+}
+
 
 static dav_error *
 create_collection(dav_resource *resource)
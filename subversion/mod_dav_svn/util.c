@@ -42,6 +42,8 @@
 #include "dav_svn.h"
 #include "private/svn_fspath.h"
 #include "private/svn_string_private.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_cond.h"
 
 dav_error *
 dav_svn__new_error(apr_pool_t *pool,
@@ -473,21 +475,281 @@ dav_svn__find_ns(const apr_array_header_t *namespaces, const char *uri)
 struct dav_svn__output
 {
   request_rec *r;
+
+  /* Where brigade writes end up: the request's filter stack for a
+     plain output, or the pipe for a piped one. */
+  apr_brigade_flush flush_fn;
+  void *flush_ctx;
+
+  /* Allocator for buckets and brigades targeting this output. */
+  apr_bucket_alloc_t *bucket_alloc;
+
+  /* The pipe this output feeds, or NULL for a plain output. */
+  dav_svn__output_pipe *pipe;
 };
 
+/* A fixed-size ring buffer shared between the thread generating a
+   response body and the request thread passing it to the network. */
+struct dav_svn__output_pipe
+{
+  svn_mutex__t *mutex;
+  svn_thread_cond__t *not_full;   /* signalled when buffer space frees up */
+  svn_thread_cond__t *not_empty;  /* signalled when data becomes available */
+
+  /* The buffer, with USED pending bytes starting at offset START and
+     wrapping around at CAPACITY. */
+  char *data;
+  apr_size_t capacity;
+  apr_size_t start;
+  apr_size_t used;
+
+  svn_boolean_t closed;   /* the producer has finished */
+  svn_boolean_t aborted;  /* the consumer failed; stop producing */
+};
+
+/* Core of the pipe write operation, to be called with PIPE->mutex held:
+   append LEN bytes of DATA to PIPE, waiting for the consumer to free up
+   buffer space as necessary. */
+static svn_error_t *
+pipe_write_locked(dav_svn__output_pipe *pipe,
+                  const char *data,
+                  apr_size_t len)
+{
+  while (len > 0)
+    {
+      apr_size_t end, chunk;
+
+      while (pipe->used == pipe->capacity && !pipe->aborted)
+        SVN_ERR(svn_thread_cond__wait(pipe->not_full, pipe->mutex));
+
+      if (pipe->aborted)
+        return svn_error_create(SVN_ERR_APMOD_CONNECTION_ABORTED, NULL,
+                                NULL);
+
+      /* Fill the free space behind the pending bytes, up to the point
+         where the buffer wraps around. */
+      end = (pipe->start + pipe->used) % pipe->capacity;
+      chunk = pipe->capacity - pipe->used;
+      if (chunk > len)
+        chunk = len;
+      if (chunk > pipe->capacity - end)
+        chunk = pipe->capacity - end;
+      memcpy(pipe->data + end, data, chunk);
+
+      pipe->used += chunk;
+      data += chunk;
+      len -= chunk;
+
+      SVN_ERR(svn_thread_cond__signal(pipe->not_empty));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Append LEN bytes of DATA to PIPE, blocking while its buffer is full. */
+static svn_error_t *
+pipe_write(dav_svn__output_pipe *pipe,
+           const char *data,
+           apr_size_t len)
+{
+  SVN_MUTEX__WITH_LOCK(pipe->mutex, pipe_write_locked(pipe, data, len));
+  return SVN_NO_ERROR;
+}
+
+/* Core of the pipe read operation, to be called with PIPE->mutex held:
+   wait for data to become available in PIPE and copy up to *LEN bytes
+   of it into BUFFER.  Upon return, *LEN is the number of bytes copied;
+   0 means the producer has closed the pipe. */
+static svn_error_t *
+pipe_read_locked(dav_svn__output_pipe *pipe,
+                 char *buffer,
+                 apr_size_t *len)
+{
+  apr_size_t remaining = *len;
+
+  while (pipe->used == 0 && !pipe->closed)
+    SVN_ERR(svn_thread_cond__wait(pipe->not_empty, pipe->mutex));
+
+  *len = 0;
+  while (pipe->used > 0 && remaining > 0)
+    {
+      apr_size_t chunk = pipe->used;
+      if (chunk > remaining)
+        chunk = remaining;
+      if (chunk > pipe->capacity - pipe->start)
+        chunk = pipe->capacity - pipe->start;
+      memcpy(buffer + *len, pipe->data + pipe->start, chunk);
+
+      pipe->start = (pipe->start + chunk) % pipe->capacity;
+      pipe->used -= chunk;
+      *len += chunk;
+      remaining -= chunk;
+    }
+
+  return svn_error_trace(svn_thread_cond__signal(pipe->not_full));
+}
+
+/* Mark PIPE as failed, waking up a producer blocked on a full buffer.
+   To be called with PIPE->mutex held. */
+static svn_error_t *
+pipe_abort_locked(dav_svn__output_pipe *pipe)
+{
+  pipe->aborted = TRUE;
+  return svn_error_trace(svn_thread_cond__broadcast(pipe->not_full));
+}
+
+/* Mark PIPE as failed, waking up a producer blocked on a full buffer. */
+static svn_error_t *
+pipe_abort(dav_svn__output_pipe *pipe)
+{
+  SVN_MUTEX__WITH_LOCK(pipe->mutex, pipe_abort_locked(pipe));
+  return SVN_NO_ERROR;
+}
+
+/* Mark PIPE as complete, waking up a consumer waiting for more data.
+   To be called with PIPE->mutex held. */
+static svn_error_t *
+pipe_close_locked(dav_svn__output_pipe *pipe)
+{
+  pipe->closed = TRUE;
+  return svn_error_trace(svn_thread_cond__broadcast(pipe->not_empty));
+}
+
+/* Flush callback for apr_brigade_write() & friends on a piped output:
+   move the content accumulated in BB into the pipe given by CTX. */
+static apr_status_t
+pipe_brigade_flush(apr_bucket_brigade *bb, void *ctx)
+{
+  dav_svn__output_pipe *pipe = ctx;
+  apr_bucket *bucket;
+
+  for (bucket = APR_BRIGADE_FIRST(bb);
+       bucket != APR_BRIGADE_SENTINEL(bb);
+       bucket = APR_BUCKET_NEXT(bucket))
+    {
+      const char *data;
+      apr_size_t len;
+      apr_status_t status;
+      svn_error_t *err;
+
+      if (APR_BUCKET_IS_METADATA(bucket))
+        continue;
+
+      status = apr_bucket_read(bucket, &data, &len, APR_BLOCK_READ);
+      if (status)
+        return status;
+
+      err = pipe_write(pipe, data, len);
+      if (err)
+        {
+          apr_status_t apr_err = err->apr_err;
+          svn_error_clear(err);
+          return apr_err;
+        }
+    }
+
+  apr_brigade_cleanup(bb);
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+dav_svn__output_pipe_create(dav_svn__output_pipe **pipe_p,
+                            apr_size_t capacity,
+                            apr_pool_t *result_pool)
+{
+  dav_svn__output_pipe *pipe = apr_pcalloc(result_pool, sizeof(*pipe));
+
+  SVN_ERR(svn_mutex__init(&pipe->mutex, TRUE, result_pool));
+  SVN_ERR(svn_thread_cond__create(&pipe->not_full, result_pool));
+  SVN_ERR(svn_thread_cond__create(&pipe->not_empty, result_pool));
+  pipe->data = apr_palloc(result_pool, capacity);
+  pipe->capacity = capacity;
+
+  *pipe_p = pipe;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+dav_svn__output_pipe_close(dav_svn__output_pipe *pipe)
+{
+  SVN_MUTEX__WITH_LOCK(pipe->mutex, pipe_close_locked(pipe));
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+dav_svn__output_pipe_drain(dav_svn__output_pipe *pipe,
+                           dav_svn__output *output,
+                           apr_bucket_brigade *bb)
+{
+  char buffer[SVN__STREAM_CHUNK_SIZE];
+
+  while (TRUE)
+    {
+      apr_size_t len = sizeof(buffer);
+      svn_error_t *err;
+
+      SVN_MUTEX__WITH_LOCK(pipe->mutex,
+                           pipe_read_locked(pipe, buffer, &len));
+      if (len == 0)  /* The producer has closed the pipe. */
+        break;
+
+      err = dav_svn__brigade_write(bb, output, buffer, len);
+      if (err)
+        {
+          /* Wake the producer; its next write into the pipe will fail
+             and unwind whatever drive feeds it. */
+          return svn_error_compose_create(err, pipe_abort(pipe));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
 dav_svn__output *
 dav_svn__output_create(request_rec *r,
                        apr_pool_t *pool)
 {
   dav_svn__output *output = apr_pcalloc(pool, sizeof(*output));
   output->r = r;
+  output->flush_fn = ap_filter_flush;
+  output->flush_ctx = r->output_filters;
+  output->bucket_alloc = r->connection->bucket_alloc;
+  return output;
+}
+
+dav_svn__output *
+dav_svn__output_create_piped(request_rec *r,
+                             dav_svn__output_pipe *pipe,
+                             apr_pool_t *pool)
+{
+  dav_svn__output *output = apr_pcalloc(pool, sizeof(*output));
+  output->r = r;
+  output->flush_fn = pipe_brigade_flush;
+  output->flush_ctx = pipe;
+  /* Bucket allocators are not thread-safe, so a piped output must not
+     share the connection's; give it one of its own. */
+  output->bucket_alloc = apr_bucket_alloc_create(pool);
+  output->pipe = pipe;
   return output;
 }
 
 apr_bucket_alloc_t *
 dav_svn__output_get_bucket_alloc(dav_svn__output *output)
 {
-  return output->r->connection->bucket_alloc;
+  return output->bucket_alloc;
+}
+
+/* Return TRUE iff OUTPUT can no longer accept data because its
+   destination has gone away. */
+static svn_boolean_t
+output_aborted(dav_svn__output *output)
+{
+  /* A broken pipe is reported by the flush callback itself; the
+     request's connection belongs to another thread here. */
+  if (output->pipe)
+    return FALSE;
+
+  return output->r->connection->aborted != 0;
 }
 
 svn_error_t *
@@ -496,6 +758,17 @@ dav_svn__output_pass_brigade(dav_svn__output *output,
 {
   apr_status_t status;
 
+  if (output->pipe)
+    {
+      status = pipe_brigade_flush(bb, output->pipe);
+      /* Empty the brigade here, like the filter stack variant below. */
+      apr_brigade_cleanup(bb);
+      if (status)
+        return svn_error_create(status, NULL,
+                                "Could not write data to output pipe");
+      return SVN_NO_ERROR;
+    }
+
   status = ap_pass_brigade(output->r->output_filters, bb);
   /* Empty the brigade here, as required by ap_pass_brigade(). */
   apr_brigade_cleanup(bb);
@@ -520,13 +793,13 @@ dav_svn__brigade_write(apr_bucket_brigade *bb,
                        apr_size_t len)
 {
   apr_status_t apr_err;
-  apr_err = apr_brigade_write(bb, ap_filter_flush,
-                              output->r->output_filters, data, len);
+  apr_err = apr_brigade_write(bb, output->flush_fn,
+                              output->flush_ctx, data, len);
   if (apr_err)
     return svn_error_create(apr_err, 0, NULL);
   /* Check for an aborted connection, since the brigade functions don't
      appear to return useful errors when the connection is dropped. */
-  if (output->r->connection->aborted)
+  if (output_aborted(output))
     return svn_error_create(SVN_ERR_APMOD_CONNECTION_ABORTED, 0, NULL);
   return SVN_NO_ERROR;
 }
@@ -538,13 +811,13 @@ dav_svn__brigade_puts(apr_bucket_brigade *bb,
                       const char *str)
 {
   apr_status_t apr_err;
-  apr_err = apr_brigade_puts(bb, ap_filter_flush,
-                             output->r->output_filters, str);
+  apr_err = apr_brigade_puts(bb, output->flush_fn,
+                             output->flush_ctx, str);
   if (apr_err)
     return svn_error_create(apr_err, 0, NULL);
   /* Check for an aborted connection, since the brigade functions don't
      appear to return useful errors when the connection is dropped. */
-  if (output->r->connection->aborted)
+  if (output_aborted(output))
     return svn_error_create(SVN_ERR_APMOD_CONNECTION_ABORTED, 0, NULL);
   return SVN_NO_ERROR;
 }
@@ -560,14 +833,14 @@ dav_svn__brigade_printf(apr_bucket_brigade *bb,
   va_list ap;
 
   va_start(ap, fmt);
-  apr_err = apr_brigade_vprintf(bb, ap_filter_flush,
-                                output->r->output_filters, fmt, ap);
+  apr_err = apr_brigade_vprintf(bb, output->flush_fn,
+                                output->flush_ctx, fmt, ap);
   va_end(ap);
   if (apr_err)
     return svn_error_create(apr_err, 0, NULL);
   /* Check for an aborted connection, since the brigade functions don't
      appear to return useful errors when the connection is dropped. */
-  if (output->r->connection->aborted)
+  if (output_aborted(output))
     return svn_error_create(SVN_ERR_APMOD_CONNECTION_ABORTED, 0, NULL);
   return SVN_NO_ERROR;
 }
@@ -582,14 +855,14 @@ dav_svn__brigade_putstrs(apr_bucket_brigade *bb,
   va_list ap;
 
   va_start(ap, output);
-  apr_err = apr_brigade_vputstrs(bb, ap_filter_flush,
-                                 output->r->output_filters, ap);
+  apr_err = apr_brigade_vputstrs(bb, output->flush_fn,
+                                 output->flush_ctx, ap);
   va_end(ap);
   if (apr_err)
     return svn_error_create(apr_err, NULL, NULL);
   /* Check for an aborted connection, since the brigade functions don't
      appear to return useful errors when the connection is dropped. */
-  if (output->r->connection->aborted)
+  if (output_aborted(output))
     return svn_error_create(SVN_ERR_APMOD_CONNECTION_ABORTED, NULL, NULL);
   return SVN_NO_ERROR;
 }
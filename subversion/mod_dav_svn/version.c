@@ -1117,10 +1117,10 @@ report_label_header_allowed(const apr_xml_doc *doc)
 
 
 static dav_error *
-deliver_report(request_rec *r,
-               const dav_resource *resource,
-               const apr_xml_doc *doc,
-               ap_filter_t *unused)
+deliver_report_internal(request_rec *r,
+                        const dav_resource *resource,
+                        const apr_xml_doc *doc,
+                        ap_filter_t *unused)
 {
   int ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
 
@@ -1191,6 +1191,22 @@ deliver_report(request_rec *r,
                                 "The requested report is unknown");
 }
 
+/* Implements the #deliver_report method of mod_dav's #dav_hooks_vsn
+   vtable; accounts the report generation with the per-request timing,
+   if enabled. */
+static dav_error *
+deliver_report(request_rec *r,
+               const dav_resource *resource,
+               const apr_xml_doc *doc,
+               ap_filter_t *unused)
+{
+  apr_time_t timing_start = dav_svn__timing_start(r);
+  dav_error *derr = deliver_report_internal(r, resource, doc, unused);
+
+  dav_svn__timing_stop(r, DAV_SVN__PHASE_REPORT, timing_start);
+  return derr;
+}
+
 
 static int
 can_be_activity(const dav_resource *resource)
@@ -159,7 +159,9 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__jobs,
+    svnadmin__snapshot
   };
 
 /* Option codes and descriptions.
@@ -261,12 +263,22 @@ static const apr_getopt_option_t options_table[] =
         "                             minimize redundant operations. Default: 16.\n"
         "                             [used for FSFS repositories only]")},
 
+    {"jobs",          svnadmin__jobs, 1,
+     N_("number of shards to process concurrently.\n"
+        "                             Default: 1, i.e. sequential processing.\n"
+        "                             [used for FSFS repositories only]")},
+
     {"compatible-version",     svnadmin__compatible_version, 1,
      N_("use repository format compatible with Subversion\n"
         "                             version ARG (\"1.5.5\", \"1.7\", etc.)")},
 
     {"file", 'F', 1, N_("read repository paths from file ARG")},
 
+    {"snapshot", svnadmin__snapshot, 0,
+     N_("do not block concurrent commits while PROGRAM\n"
+        "                             runs; only pack operations are delayed\n"
+        "                             [used for FSFS repositories only]")},
+
     {"check-normalization", svnadmin__check_normalization, 0,
      N_("report any names within the same directory or\n"
         "                             svn:mergeinfo property value that differ only\n"
@@ -412,8 +424,14 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "\n"
     "The '--' tells svnadmin to stop looking for svnadmin options and pass\n"
     "all later arguments to PROGRAM even if they begin with '-'.\n"
+    "\n"), N_(
+    "If --snapshot is passed, the repositories are not write-locked:\n"
+    "concurrent commits proceed while PROGRAM runs and only pack operations\n"
+    "are delayed.  PROGRAM sees all data of the revisions present when it\n"
+    "started; later commits merely add new files.  This is supported for\n"
+    "FSFS repositories only.\n"
    )},
-   {'F'},
+   {'F', svnadmin__snapshot},
    {{'F', N_("read repository paths from file ARG")}} },
 
   {"help", subcommand_help, {"?", "h"}, {N_(
@@ -521,7 +539,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Possibly compact the repository into a more efficient storage model.\n"
     "This may not apply to all repositories, in which case, exit.\n"
    )},
-   {'q', 'M'} },
+   {'q', 'M', svnadmin__jobs} },
 
   {"recover", subcommand_recover, {0}, {N_(
     "usage: svnadmin recover REPOS_PATH\n"
@@ -531,7 +549,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Berkeley DB recovery requires exclusive access and will\n"
     "exit if the repository is in use by another process.\n"
    )},
-   {svnadmin__wait} },
+   {svnadmin__wait, svnadmin__jobs} },
 
   {"rev-size", subcommand_rev_size, {0}, {N_(
     "usage: svnadmin rev-size REPOS_PATH -r REVISION\n"
@@ -633,7 +651,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "\n"), N_(
     "Verify the data stored in the repository.\n"
    )},
-   {'t', 'r', 'q', svnadmin__keep_going, 'M',
+   {'t', 'r', 'q', svnadmin__keep_going, 'M', svnadmin__jobs,
     svnadmin__check_normalization, svnadmin__metadata_only} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
@@ -668,10 +686,12 @@ struct svnadmin_opt_state
   svn_boolean_t bypass_prop_validation;             /* --bypass-prop-validation */
   svn_boolean_t ignore_dates;                       /* --ignore-dates */
   svn_boolean_t no_flush_to_disk;                   /* --no-flush-to-disk */
+  svn_boolean_t snapshot;                           /* --snapshot */
   svn_boolean_t normalize_props;                    /* --normalize_props */
   enum svn_repos_load_uuid uuid_action;             /* --ignore-uuid,
                                                        --force-uuid */
   apr_uint64_t memory_cache_size;                   /* --memory-cache-size M */
+  apr_uint64_t jobs;                                /* --jobs N */
   const char *parent_dir;                           /* --parent-dir */
   const char *file;                                 /* --file */
   apr_array_header_t *exclude;                      /* --exclude */
@@ -706,6 +726,12 @@ open_repos(svn_repos_t **repos,
                            use_block_read ? "1" : "0");
   svn_hash_sets(fs_config, SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                            opt_state->no_flush_to_disk ? "1" : "0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_PACK_CONCURRENCY,
+                           apr_psprintf(pool, "%" APR_UINT64_T_FMT,
+                                        opt_state->jobs));
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_VERIFY_CONCURRENCY,
+                           apr_psprintf(pool, "%" APR_UINT64_T_FMT,
+                                        opt_state->jobs));
 
   /* now, open the requested repository */
   SVN_ERR(svn_repos_open3(repos, path, fs_config, pool, pool));
@@ -1567,6 +1593,55 @@ freeze_body(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* Baton for snapshot_freeze_body(). */
+struct snapshot_freeze_baton_t {
+  const apr_array_header_t *paths;
+  int counter;
+  struct svnadmin_opt_state *opt_state;
+  struct freeze_baton_t *fb;
+};
+
+/* Counterpart to svn_repos_freeze() for --snapshot mode:  recursively
+   take the pack lock of each repository in PATHS via the FSFS
+   snapshot-freeze ioctl, then run the user's program.  Implements
+   svn_fs_freeze_func_t. */
+static svn_error_t *
+snapshot_freeze_body(void *baton,
+                     apr_pool_t *pool)
+{
+  struct snapshot_freeze_baton_t *b = baton;
+
+  if (b->counter == b->paths->nelts)
+    {
+      SVN_ERR(freeze_body(b->fb, pool));
+    }
+  else
+    {
+      const char *path = APR_ARRAY_IDX(b->paths, b->counter, const char *);
+      svn_repos_t *repos;
+      svn_fs_fs__ioctl_snapshot_freeze_input_t input = {0};
+      svn_error_t *err;
+
+      ++b->counter;
+
+      SVN_ERR(open_repos(&repos, path, b->opt_state, pool));
+
+      input.freeze_func = snapshot_freeze_body;
+      input.freeze_baton = b;
+      err = svn_fs_ioctl(svn_repos_fs(repos),
+                         SVN_FS_FS__IOCTL_SNAPSHOT_FREEZE, &input, NULL,
+                         check_cancel, NULL, pool, pool);
+      if (err && err->apr_err == SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE)
+        return svn_error_createf(SVN_ERR_UNSUPPORTED_FEATURE, err,
+                                 _("Repository '%s' does not support "
+                                   "snapshot freezing"),
+                                 svn_dirent_local_style(path, pool));
+      SVN_ERR(err);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 subcommand_freeze(apr_getopt_t *os, void *baton, apr_pool_t *pool)
 {
@@ -1604,7 +1679,19 @@ subcommand_freeze(apr_getopt_t *os, void *baton, apr_pool_t *pool)
     b.args[i] = APR_ARRAY_IDX(args, i, const char *);
   b.args[args->nelts] = NULL;
 
-  SVN_ERR(svn_repos_freeze(paths, freeze_body, &b, pool));
+  if (opt_state->snapshot)
+    {
+      struct snapshot_freeze_baton_t sb;
+
+      sb.paths = paths;
+      sb.counter = 0;
+      sb.opt_state = opt_state;
+      sb.fb = &b;
+
+      SVN_ERR(snapshot_freeze_body(&sb, pool));
+    }
+  else
+    SVN_ERR(svn_repos_freeze(paths, freeze_body, &b, pool));
 
   /* Make any non-zero status visible to the user. */
   if (b.status)
@@ -1885,20 +1972,30 @@ subcommand_recover(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   svn_error_t *err;
   struct svnadmin_opt_state *opt_state = baton;
   svn_stream_t *feedback_stream = NULL;
+  apr_hash_t *fs_config = NULL;
 
   /* Expect no more arguments. */
   SVN_ERR(parse_args(NULL, os, 0, 0, pool));
 
   SVN_ERR(svn_stream_for_stdout(&feedback_stream, pool));
 
+  /* Pass the --jobs level on to the FS layer. */
+  if (opt_state->jobs > 1)
+    {
+      fs_config = apr_hash_make(pool);
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_RECOVER_CONCURRENCY,
+                               apr_psprintf(pool, "%" APR_UINT64_T_FMT,
+                                            opt_state->jobs));
+    }
+
   /* Restore default signal handlers until after we have acquired the
    * exclusive lock so that the user interrupt before we actually
    * touch the repository. */
   svn_cmdline__disable_cancellation_handler();
 
-  err = svn_repos_recover4(opt_state->repository_path, TRUE,
+  err = svn_repos_recover5(opt_state->repository_path, TRUE,
                            repos_notify_handler, feedback_stream,
-                           check_cancel, NULL, pool);
+                           check_cancel, NULL, fs_config, pool);
   if (err)
     {
       if (! APR_STATUS_IS_EAGAIN(err->apr_err))
@@ -1914,9 +2011,9 @@ subcommand_recover(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  _("Waiting on repository lock; perhaps"
                                    " another process has it open?\n")));
       SVN_ERR(svn_cmdline_fflush(stdout));
-      SVN_ERR(svn_repos_recover4(opt_state->repository_path, FALSE,
+      SVN_ERR(svn_repos_recover5(opt_state->repository_path, FALSE,
                                  repos_notify_handler, feedback_stream,
-                                 check_cancel, NULL, pool));
+                                 check_cancel, NULL, fs_config, pool));
     }
 
   SVN_ERR(svn_cmdline_printf(pool, _("\nRecovery completed.\n")));
@@ -3085,6 +3182,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.jobs = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -3150,6 +3248,18 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           opt_state.memory_cache_size = 0x100000 * sz_val;
         }
         break;
+      case svnadmin__jobs:
+        {
+          apr_uint64_t jobs_val;
+          SVN_ERR(svn_cstring_atoui64(&jobs_val, opt_arg));
+          if (jobs_val < 1 || jobs_val > APR_INT32_MAX)
+            return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                     _("Invalid number of jobs: %s"),
+                                     opt_arg);
+
+          opt_state.jobs = jobs_val;
+        }
+        break;
       case 'F':
         SVN_ERR(svn_utf_cstring_to_utf8(&(opt_state.file), opt_arg, pool));
         dash_F_arg = TRUE;
@@ -3279,6 +3389,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnadmin__no_flush_to_disk:
         opt_state.no_flush_to_disk = TRUE;
         break;
+      case svnadmin__snapshot:
+        opt_state.snapshot = TRUE;
+        break;
       case svnadmin__normalize_props:
         opt_state.normalize_props = TRUE;
         break;
@@ -3426,7 +3539,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+
+    /* --jobs > 1 runs worker threads that all access the same caches,
+     * so cache locking must stay enabled in that case. */
+    settings.single_threaded = (opt_state.jobs <= 1);
 
     svn_cache_config_set(&settings);
   }
@@ -3455,15 +3571,29 @@ main(int argc, const char *argv[])
   apr_pool_t *pool;
   int exit_code = EXIT_SUCCESS;
   svn_error_t *err;
+  svn_boolean_t threaded = FALSE;
+  int i;
 
   /* Initialize the app. */
   if (svn_cmdline_init("svnadmin", stderr) != EXIT_SUCCESS)
     return EXIT_FAILURE;
 
-  /* Create our top-level pool.  Use a separate mutexless allocator,
-   * given this application is single threaded.
+  /* '--jobs N' with N > 1 starts worker threads that allocate from
+   * sub-pools of the pool created below, so its allocator must be
+   * thread-safe in that case.  Detect the option before the actual
+   * argument parsing, which requires the pool to already exist. */
+  for (i = 1; i < argc; i++)
+    {
+      if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        threaded = (atoi(argv[i + 1]) > 1);
+      else if (strncmp(argv[i], "--jobs=", 7) == 0)
+        threaded = (atoi(argv[i] + 7) > 1);
+    }
+
+  /* Create our top-level pool.  Use a separate mutexless allocator
+   * unless worker threads will share this pool's allocator.
    */
-  pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  pool = apr_allocator_owner_get(svn_pool_create_allocator(threaded));
 
   err = sub_main(&exit_code, argc, argv, pool);
 
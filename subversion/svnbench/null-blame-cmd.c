@@ -39,6 +39,8 @@
 #include "svn_private_config.h"
 #include "private/svn_string_private.h"
 #include "private/svn_client_private.h"
+#include "private/svn_sorts_private.h"
+#include "private/svn_task.h"
 
 struct file_rev_baton {
   apr_int64_t byte_count;
@@ -82,17 +84,18 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   return SVN_NO_ERROR;
 }
 
+/* Fetch all file revisions of TARGET and tally them up in *FRB, which
+   the caller must have initialized to all zeroes. */
 static svn_error_t *
-bench_null_blame(const char *target,
+bench_null_blame(struct file_rev_baton *frb,
+                 const char *target,
                  const svn_opt_revision_t *peg_revision,
                  const svn_opt_revision_t *start,
                  const svn_opt_revision_t *end,
                  svn_boolean_t include_merged_revisions,
-                 svn_boolean_t quiet,
                  svn_client_ctx_t *ctx,
                  apr_pool_t *pool)
 {
-  struct file_rev_baton frb = { 0, 0, 0};
   svn_ra_session_t *ra_session;
   svn_revnum_t start_revnum, end_revnum;
   svn_boolean_t backwards;
@@ -149,16 +152,314 @@ bench_null_blame(const char *target,
                                           : MAX(0, start_revnum-1),
                                 end_revnum,
                                 include_merged_revisions,
-                                file_rev_handler, &frb, pool));
+                                file_rev_handler, frb, pool));
 
-  if (!quiet)
-    SVN_ERR(svn_cmdline_printf(pool,
-                               _("%15s revisions\n"
-                                 "%15s deltas\n"
-                                 "%15s bytes in deltas\n"),
-                               svn__ui64toa_sep(frb.rev_count, ',', pool),
-                               svn__ui64toa_sep(frb.delta_count, ',', pool),
-                               svn__ui64toa_sep(frb.byte_count, ',', pool)));
+  return SVN_NO_ERROR;
+}
+
+
+/*** Parallel operation. ***/
+
+/* Parameters of a single parallel blame request. */
+typedef struct blame_task_baton_t
+{
+  /* Target path or URL with any peg revision already split off. */
+  const char *target;
+
+  /* Revision range to blame, already resolved for this target. */
+  svn_opt_revision_t peg_revision;
+  svn_opt_revision_t start_revision;
+  svn_opt_revision_t end_revision;
+
+  svn_boolean_t include_merged_revisions;
+} blame_task_baton_t;
+
+/* Outcome of a single parallel blame request. */
+typedef struct blame_task_result_t
+{
+  /* Wall-clock duration of the request. */
+  apr_time_t taken;
+
+  /* What the request fetched. */
+  struct file_rev_baton frb;
+
+  /* If the target turned out not to exist, the error saying so.
+     Hard errors are returned from the task instead. */
+  svn_error_t *err;
+} blame_task_result_t;
+
+/* Accumulates the results of all parallel blame requests. */
+typedef struct blame_output_baton_t
+{
+  /* Latency of each successful request (apr_time_t elements). */
+  apr_array_header_t *latencies;
+
+  /* Totals over all successful requests. */
+  struct file_rev_baton totals;
+
+  svn_boolean_t seen_nonexistent_target;
+} blame_output_baton_t;
+
+/* Everything the root task needs to spawn the individual requests. */
+typedef struct blame_root_baton_t
+{
+  /* The requests to issue (blame_task_baton_t * elements). */
+  apr_array_header_t *task_batons;
+
+  /* Where the sub-tasks shall deliver their results. */
+  blame_output_baton_t *output_baton;
+} blame_root_baton_t;
+
+/* Implements svn_task__thread_context_constructor_t.
+   Set *THREAD_CONTEXT to a worker-private copy of the svn_client_ctx_t
+   given as CONTEXT_BATON, allocated in RESULT_POOL. */
+static svn_error_t *
+blame_context_constructor(void **thread_context,
+                          void *context_baton,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_client_ctx_t *main_ctx = context_baton;
+  svn_client_ctx_t *ctx;
+
+  /* Client contexts are not thread-safe, so each worker gets its own.
+     The auth baton, however, is shared such that all sessions draw on
+     the same credentials. */
+  SVN_ERR(svn_client_create_context2(&ctx, main_ctx->config, result_pool));
+  ctx->auth_baton = main_ctx->auth_baton;
+  ctx->cancel_func = main_ctx->cancel_func;
+  ctx->cancel_baton = main_ctx->cancel_baton;
+  ctx->client_name = main_ctx->client_name;
+
+  *thread_context = ctx;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.
+   Issue the single blame request described by the blame_task_baton_t
+   given as PROCESS_BATON and return a blame_task_result_t in *RESULT. */
+static svn_error_t *
+blame_task_process(void **result,
+                   svn_task__t *task,
+                   void *thread_context,
+                   void *process_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  blame_task_baton_t *btb = process_baton;
+  svn_client_ctx_t *ctx = thread_context;
+  blame_task_result_t *task_result = apr_pcalloc(result_pool,
+                                                 sizeof(*task_result));
+  apr_time_t start = apr_time_now();
+  svn_error_t *err;
+
+  err = bench_null_blame(&task_result->frb, btb->target,
+                         &btb->peg_revision, &btb->start_revision,
+                         &btb->end_revision, btb->include_merged_revisions,
+                         ctx, scratch_pool);
+  task_result->taken = apr_time_now() - start;
+
+  if (err && (err->apr_err == SVN_ERR_WC_PATH_NOT_FOUND
+              || err->apr_err == SVN_ERR_ENTRY_NOT_FOUND
+              || err->apr_err == SVN_ERR_FS_NOT_FILE
+              || err->apr_err == SVN_ERR_FS_NOT_FOUND))
+    {
+      /* A missing target is only a warning.  Hand the error to the
+         output function so it does not abort the whole run and gets
+         reported from the main thread. */
+      task_result->err = err;
+      err = SVN_NO_ERROR;
+    }
+
+  *result = task_result;
+
+  return svn_error_trace(err);
+}
+
+/* Implements svn_task__output_func_t.
+   Fold the blame_task_result_t given as RESULT into the
+   blame_output_baton_t given as OUTPUT_BATON. */
+static svn_error_t *
+blame_task_output(svn_task__t *task,
+                  void *result,
+                  void *output_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  blame_output_baton_t *ob = output_baton;
+  blame_task_result_t *task_result = result;
+
+  if (task_result->err)
+    {
+      svn_handle_warning2(stderr, task_result->err, "svn: ");
+      svn_error_clear(task_result->err);
+      ob->seen_nonexistent_target = TRUE;
+
+      return SVN_NO_ERROR;
+    }
+
+  APR_ARRAY_PUSH(ob->latencies, apr_time_t) = task_result->taken;
+  ob->totals.rev_count += task_result->frb.rev_count;
+  ob->totals.delta_count += task_result->frb.delta_count;
+  ob->totals.byte_count += task_result->frb.byte_count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.
+   Spawn one sub-task per request listed in the blame_root_baton_t
+   given as PROCESS_BATON. */
+static svn_error_t *
+blame_root_process(void **result,
+                   svn_task__t *task,
+                   void *thread_context,
+                   void *process_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  blame_root_baton_t *rb = process_baton;
+  int i;
+
+  *result = NULL;
+  for (i = 0; i < rb->task_batons->nelts; i++)
+    {
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      SVN_ERR(svn_task__add(task, process_pool, NULL,
+                            blame_task_process,
+                            APR_ARRAY_IDX(rb->task_batons, i,
+                                          blame_task_baton_t *),
+                            blame_task_output, rb->output_baton));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Comparison function for svn_sort__array over apr_time_t elements. */
+static int
+compare_latencies(const void *a,
+                  const void *b)
+{
+  const apr_time_t *lhs = a;
+  const apr_time_t *rhs = b;
+
+  if (*lhs < *rhs)
+    return -1;
+
+  return *lhs > *rhs;
+}
+
+/* Return the PERCENTILE-th latency from the ascendingly sorted,
+   non-empty LATENCIES array, in seconds. */
+static double
+latency_percentile(const apr_array_header_t *latencies,
+                   int percentile)
+{
+  int idx = latencies->nelts * percentile / 100;
+
+  if (idx >= latencies->nelts)
+    idx = latencies->nelts - 1;
+
+  return APR_ARRAY_IDX(latencies, idx, apr_time_t) / 1.0e6;
+}
+
+/* Blame all TARGETS over up to OPT_STATE->PARALLEL concurrent sessions
+   and print aggregate throughput and latency percentiles.  The caller
+   has already defaulted the revision range in OPT_STATE except when
+   END_REVISION_UNSPECIFIED, in which case the end revision is derived
+   per target.  Set *SEEN_NONEXISTENT_TARGET if any target was found to
+   not exist. */
+static svn_error_t *
+parallel_null_blame(const apr_array_header_t *targets,
+                    svn_cl__opt_state_t *opt_state,
+                    svn_boolean_t end_revision_unspecified,
+                    svn_boolean_t *seen_nonexistent_target,
+                    svn_client_ctx_t *ctx,
+                    apr_pool_t *pool)
+{
+  blame_root_baton_t rb;
+  blame_output_baton_t ob = { NULL };
+  apr_time_t start;
+  double taken;
+  int i;
+
+  ob.latencies = apr_array_make(pool, targets->nelts, sizeof(apr_time_t));
+
+  rb.task_batons = apr_array_make(pool, targets->nelts,
+                                  sizeof(blame_task_baton_t *));
+  rb.output_baton = &ob;
+
+  for (i = 0; i < targets->nelts; i++)
+    {
+      const char *target = APR_ARRAY_IDX(targets, i, const char *);
+      blame_task_baton_t *btb = apr_pcalloc(pool, sizeof(*btb));
+
+      /* Check for a peg revision. */
+      SVN_ERR(svn_opt_parse_path(&btb->peg_revision, &btb->target, target,
+                                 pool));
+
+      btb->start_revision = opt_state->start_revision;
+      btb->end_revision = opt_state->end_revision;
+      if (end_revision_unspecified)
+        {
+          if (btb->peg_revision.kind != svn_opt_revision_unspecified)
+            btb->end_revision = btb->peg_revision;
+          else if (svn_path_is_url(target))
+            btb->end_revision.kind = svn_opt_revision_head;
+          else
+            btb->end_revision.kind = svn_opt_revision_working;
+        }
+
+      btb->include_merged_revisions = opt_state->use_merge_history;
+
+      APR_ARRAY_PUSH(rb.task_batons, blame_task_baton_t *) = btb;
+    }
+
+  start = apr_time_now();
+  SVN_ERR(svn_task__run(opt_state->parallel,
+                        blame_root_process, &rb,
+                        NULL, NULL,
+                        blame_context_constructor, ctx,
+                        ctx->cancel_func, ctx->cancel_baton,
+                        pool, pool));
+  taken = (apr_time_now() - start) / 1.0e6;
+
+  *seen_nonexistent_target = ob.seen_nonexistent_target;
+
+  if (!opt_state->quiet && ob.latencies->nelts > 0)
+    {
+      svn_sort__array(ob.latencies, compare_latencies);
+
+      SVN_ERR(svn_cmdline_printf(pool,
+                                 _("%15s revisions\n"
+                                   "%15s deltas\n"
+                                   "%15s bytes in deltas\n"),
+                                 svn__ui64toa_sep(ob.totals.rev_count, ',',
+                                                  pool),
+                                 svn__ui64toa_sep(ob.totals.delta_count, ',',
+                                                  pool),
+                                 svn__ui64toa_sep(ob.totals.byte_count, ',',
+                                                  pool)));
+      SVN_ERR(svn_cmdline_printf(pool,
+                                 _("%15.6f seconds taken\n"
+                                   "%15.2f requests per second\n"
+                                   "%15.6f seconds latency (p50)\n"
+                                   "%15.6f seconds latency (p90)\n"
+                                   "%15.6f seconds latency (p99)\n"
+                                   "%15.6f seconds latency (max)\n"),
+                                 taken,
+                                 ob.latencies->nelts / taken,
+                                 latency_percentile(ob.latencies, 50),
+                                 latency_percentile(ob.latencies, 90),
+                                 latency_percentile(ob.latencies, 99),
+                                 latency_percentile(ob.latencies, 100)));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -207,6 +508,21 @@ svn_cl__null_blame(apr_getopt_t *os,
       opt_state->start_revision.value.number = 1;
     }
 
+  if (opt_state->parallel > 1)
+    {
+      SVN_ERR(parallel_null_blame(targets, opt_state,
+                                  end_revision_unspecified,
+                                  &seen_nonexistent_target, ctx, pool));
+
+      if (seen_nonexistent_target)
+        return svn_error_create(
+          SVN_ERR_ILLEGAL_TARGET, NULL,
+          _("Could not perform blame on all targets because some "
+            "targets don't exist"));
+      else
+        return SVN_NO_ERROR;
+    }
+
   /* The final conclusion from issue #2431 is that blame info
      is client output (unlike 'svn cat' which plainly cats the file),
      so the EOL style should be the platform local one.
@@ -219,6 +535,7 @@ svn_cl__null_blame(apr_getopt_t *os,
       const char *target = APR_ARRAY_IDX(targets, i, const char *);
       const char *parsed_path;
       svn_opt_revision_t peg_revision;
+      struct file_rev_baton frb = { 0, 0, 0 };
 
       svn_pool_clear(iterpool);
       SVN_ERR(svn_cl__check_cancel(ctx->cancel_baton));
@@ -237,12 +554,12 @@ svn_cl__null_blame(apr_getopt_t *os,
             opt_state->end_revision.kind = svn_opt_revision_working;
         }
 
-      err = bench_null_blame(parsed_path,
+      err = bench_null_blame(&frb,
+                             parsed_path,
                              &peg_revision,
                              &opt_state->start_revision,
                              &opt_state->end_revision,
                              opt_state->use_merge_history,
-                             opt_state->quiet,
                              ctx,
                              iterpool);
 
@@ -263,6 +580,19 @@ svn_cl__null_blame(apr_getopt_t *os,
               return svn_error_trace(err);
             }
         }
+      else if (!opt_state->quiet)
+        {
+          SVN_ERR(svn_cmdline_printf(iterpool,
+                                 _("%15s revisions\n"
+                                   "%15s deltas\n"
+                                   "%15s bytes in deltas\n"),
+                                 svn__ui64toa_sep(frb.rev_count, ',',
+                                                  iterpool),
+                                 svn__ui64toa_sep(frb.delta_count, ',',
+                                                  iterpool),
+                                 svn__ui64toa_sep(frb.byte_count, ',',
+                                                  iterpool)));
+        }
     }
   svn_pool_destroy(iterpool);
 
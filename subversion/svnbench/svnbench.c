@@ -70,7 +70,9 @@ typedef enum svn_cl__longopt_t {
   opt_trust_server_cert,
   opt_trust_server_cert_failures,
   opt_changelist,
-  opt_search
+  opt_search,
+  opt_runs,
+  opt_parallel
 } svn_cl__longopt_t;
 
 
@@ -171,6 +173,18 @@ const apr_getopt_option_t svn_cl__options[] =
                        "history")},
   {"search", opt_search, 1,
                        N_("use ARG as search pattern (glob syntax)")},
+  {"runs",   opt_runs, 1,
+                       N_("repeat the operation ARG times and report the\n"
+                       "                             "
+                       "first (cold) run separately from the remaining\n"
+                       "                             "
+                       "(steady-state) runs")},
+  {"parallel", opt_parallel, 1,
+                       N_("issue up to ARG requests concurrently and report\n"
+                       "                             "
+                       "aggregate throughput and per-request latency\n"
+                       "                             "
+                       "percentiles (default is 1, i.e. sequential)")},
 
   /* Long-opt Aliases
    *
@@ -203,7 +217,7 @@ const int svn_cl__global_options[] =
 { opt_auth_username, opt_auth_password, opt_auth_password_from_stdin,
   opt_no_auth_cache, opt_non_interactive,
   opt_trust_server_cert, opt_trust_server_cert_failures,
-  opt_config_dir, opt_config_options, 0
+  opt_config_dir, opt_config_options, opt_runs, 0
 };
 
 const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
@@ -233,8 +247,12 @@ const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
      "  looked up.\n"
      "\n"), N_(
      "  Write the annotated result to standard output.\n"
+     "\n"), N_(
+     "  With --parallel N, blame all targets (e.g. a file list given via\n"
+     "  --targets) over up to N concurrent sessions and report aggregate\n"
+     "  throughput as well as per-target latency percentiles.\n"
     )},
-    {'r', 'g'} },
+    {'r', 'g', opt_targets, opt_parallel} },
 
   { "null-export", svn_cl__null_export, {0}, {N_(
      "Create an unversioned copy of a tree.\n"
@@ -316,6 +334,21 @@ const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
     {'r', 'R', opt_depth, opt_targets, opt_changelist}
   },
 
+  { "null-update", svn_cl__null_update, {0}, {N_(
+     "Fetch an update delta without applying it.\n"
+     "usage: null-update [-r [BASEREV:]REV] URL[@PEGREV]\n"
+     "\n"), N_(
+     "  Describe a synthetic working copy that is uniformly at BASEREV to\n"
+     "  the repository and receive the delta that an update to REV would\n"
+     "  apply, counting its contents instead of writing them to disk.\n"
+     "  With '-r REV', update from REV-1 to REV; the default is an update\n"
+     "  from HEAD-1 to HEAD.\n"
+     "\n"), N_(
+     "  If specified, PEGREV determines in which revision the target is first\n"
+     "  looked up.\n"
+    )},
+    {'r', 'q', 'N', opt_depth} },
+
   { NULL, NULL, {0}, {NULL}, {0} }
 };
 
@@ -401,7 +434,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_config_t *cfg_config;
   svn_boolean_t descend = TRUE;
   svn_boolean_t use_notifier = TRUE;
-  apr_time_t start_time, time_taken;
+  apr_time_t start_time, first_run_time, time_taken;
+  int runs;
   ra_progress_baton_t ra_progress_baton = {0};
   svn_membuf_t buf;
   svn_boolean_t read_pass_from_stdin = FALSE;
@@ -644,6 +678,36 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                                  apr_pstrdup(pool, utf8_opt_arg),
                                  pool);
         break;
+      case opt_runs:
+        {
+          err = svn_cstring_atoi(&opt_state.runs, opt_arg);
+          if (err)
+            {
+              return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, err,
+                                      _("Non-numeric runs argument given"));
+            }
+          if (opt_state.runs <= 0)
+            {
+              return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                                      _("Argument to --runs must be positive"));
+            }
+        }
+        break;
+      case opt_parallel:
+        {
+          err = svn_cstring_atoi(&opt_state.parallel, opt_arg);
+          if (err)
+            {
+              return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, err,
+                                      _("Non-numeric parallel argument given"));
+            }
+          if (opt_state.parallel <= 0)
+            {
+              return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                                  _("Argument to --parallel must be positive"));
+            }
+        }
+        break;
       default:
         /* Hmmm. Perhaps this would be a good place to squirrel away
            opts that commands like svn diff might need. Hmmm indeed. */
@@ -924,10 +988,40 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       ctx->progress_baton = &ra_progress_baton;
     }
 
-  /* And now we finally run the subcommand. */
-  start_time = apr_time_now();
-  err = (*subcommand->cmd_func)(os, &command_baton, pool);
-  time_taken = apr_time_now() - start_time;
+  /* And now we finally run the subcommand, repeating it if several runs
+   * were requested to tell the first (cold cache) run apart from the
+   * steady-state behavior. */
+  runs = opt_state.runs > 1 ? opt_state.runs : 1;
+  {
+    svn_boolean_t quiet = opt_state.quiet;
+    int first_ind = os->ind;
+    int run;
+
+    err = SVN_NO_ERROR;
+    first_run_time = 0;
+    time_taken = 0;
+
+    for (run = 0; run < runs && !err; ++run)
+      {
+        apr_time_t run_time;
+
+        /* Repeated runs shall parse the operands anew but report their
+         * per-item statistics only once. */
+        os->ind = first_ind;
+        opt_state.quiet = quiet || run > 0;
+
+        start_time = apr_time_now();
+        err = (*subcommand->cmd_func)(os, &command_baton, pool);
+        run_time = apr_time_now() - start_time;
+
+        if (run == 0)
+          first_run_time = run_time;
+        else
+          time_taken += run_time;
+      }
+
+    opt_state.quiet = quiet;
+  }
 
   if (err)
     {
@@ -961,9 +1055,18 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     {
       /* This formatting lines up nicely with the output of our sub-commands
        * and gives musec resolution while not overflowing for 30 years. */
-      SVN_ERR(svn_cmdline_printf(pool,
-                                _("%15.6f seconds taken\n"),
-                                time_taken / 1.0e6));
+      if (runs == 1)
+        SVN_ERR(svn_cmdline_printf(pool,
+                                  _("%15.6f seconds taken\n"),
+                                  first_run_time / 1.0e6));
+      else
+        SVN_ERR(svn_cmdline_printf(pool,
+                                  _("%15.6f seconds taken (first run)\n"
+                                    "%15.6f seconds taken (average of %d"
+                                    " steady-state runs)\n"),
+                                  first_run_time / 1.0e6,
+                                  time_taken / (1.0e6 * (runs - 1)),
+                                  runs - 1));
 
       /* Report how many bytes transferred over network if RA layer provided
          this information. */
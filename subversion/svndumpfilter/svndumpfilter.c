@@ -32,6 +32,7 @@
 #include "svn_string.h"
 #include "svn_opt.h"
 #include "svn_utf.h"
+#include "svn_io.h"
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 #include "svn_hash.h"
@@ -200,6 +201,10 @@ struct parse_baton_t
   /* The oldest original revision, greater than r0, in the input
      stream which was not filtered. */
   svn_revnum_t oldest_original_rev;
+  /* Has the stream header already been written to the output?  Set by
+     the index-assisted filter, which emits the header itself and then
+     parses the input in several separate runs. */
+  svn_boolean_t headers_written;
 };
 
 struct revision_baton_t
@@ -272,7 +277,9 @@ magic_header_record(int version, void *parse_baton, apr_pool_t *pool)
   if (version >= SVN_REPOS_DUMPFILE_FORMAT_VERSION_DELTAS)
     pb->allow_deltas = TRUE;
 
-  SVN_ERR(svn_repos__dump_magic_header_record(pb->out_stream, version, pool));
+  if (! pb->headers_written)
+    SVN_ERR(svn_repos__dump_magic_header_record(pb->out_stream, version,
+                                                pool));
 
   return SVN_NO_ERROR;
 }
@@ -446,7 +453,8 @@ uuid_record(const char *uuid, void *parse_baton, apr_pool_t *pool)
 {
   struct parse_baton_t *pb = parse_baton;
 
-  SVN_ERR(svn_repos__dump_uuid_header_record(pb->out_stream, uuid, pool));
+  if (! pb->headers_written)
+    SVN_ERR(svn_repos__dump_uuid_header_record(pb->out_stream, uuid, pool));
   return SVN_NO_ERROR;
 }
 
@@ -914,6 +922,421 @@ static svn_repos_parse_fns3_t filtering_vtable =
   };
 
 
+
+/** Index-assisted filtering. **/
+
+/* When the input is a seekable file, we scan it once up front and build
+   an index of the revisions it contains.  Revisions whose nodes would
+   all pass through the filter unmodified are then copied to the output
+   verbatim, and only the remaining revisions are fed through the
+   regular parsing filter above.  The scan reads record headers only and
+   seeks over property and text payloads, so it is cheap even for very
+   large dump files. */
+
+/* One revision of the input dump file, as recorded by the pre-scan. */
+struct rev_index_t
+{
+  svn_revnum_t rev;
+
+  /* The revision's byte extent in the file: START is the offset of its
+     Revision-number header, END the offset just past its last byte. */
+  apr_off_t start;
+  apr_off_t end;
+
+  /* Would the filter leave this revision untouched? */
+  svn_boolean_t copyable;
+};
+
+/* If LINE is a dumpfile header with key KEY, return a pointer to its
+   value within LINE->data; return NULL otherwise. */
+static const char *
+parse_header_line(const svn_stringbuf_t *line, const char *key)
+{
+  apr_size_t key_len = strlen(key);
+
+  if (line->len >= key_len + 2
+      && strncmp(line->data, key, key_len) == 0
+      && line->data[key_len] == ':'
+      && line->data[key_len + 1] == ' ')
+    return line->data + key_len + 2;
+
+  return NULL;
+}
+
+/* Read the remaining headers of the record whose first header has just
+   been consumed from FILE, then seek over the record's content.  If
+   COPYFROM_PATH is not NULL and the record carries a Node-copyfrom-path
+   header, return its value in *COPYFROM_PATH, allocated in RESULT_POOL. */
+static svn_error_t *
+skip_record_remainder(apr_file_t *file,
+                      const char **copyfrom_path,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  svn_filesize_t content_length = 0;
+  svn_filesize_t prop_length = 0;
+  svn_filesize_t text_length = 0;
+  svn_boolean_t has_content_length = FALSE;
+
+  while (1)
+    {
+      svn_stringbuf_t *line;
+      svn_boolean_t eof;
+      const char *value;
+
+      SVN_ERR(svn_io_file_readline(file, &line, NULL, &eof, APR_SIZE_MAX,
+                                   scratch_pool, scratch_pool));
+      if (eof || line->len == 0)
+        break;
+
+      if ((value = parse_header_line(line, SVN_REPOS_DUMPFILE_CONTENT_LENGTH)))
+        {
+          content_length = svn__atoui64(value);
+          has_content_length = TRUE;
+        }
+      else if ((value = parse_header_line(
+                          line, SVN_REPOS_DUMPFILE_PROP_CONTENT_LENGTH)))
+        prop_length = svn__atoui64(value);
+      else if ((value = parse_header_line(
+                          line, SVN_REPOS_DUMPFILE_TEXT_CONTENT_LENGTH)))
+        text_length = svn__atoui64(value);
+      else if (copyfrom_path
+               && (value = parse_header_line(
+                             line, SVN_REPOS_DUMPFILE_NODE_COPYFROM_PATH)))
+        *copyfrom_path = apr_pstrdup(result_pool, value);
+    }
+
+  /* Old dump formats may lack the overall Content-length header. */
+  if (! has_content_length)
+    content_length = prop_length + text_length;
+
+  if (content_length > 0)
+    {
+      apr_off_t offset = (apr_off_t)content_length;
+
+      SVN_ERR(svn_io_file_seek(file, APR_CUR, &offset, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Scan the dump file FILE, which must be positioned at its start, and
+   set *INDEX to an array of struct rev_index_t covering every revision
+   in it.  A revision is marked copyable iff filtering it with the
+   prefixes and options in PB would keep all of its nodes unmodified.
+   Set *VERSION to the dump format version and *UUID to the UUID from
+   the stream header, or to NULL if the stream carries none. */
+static svn_error_t *
+build_revision_index(apr_array_header_t **index,
+                     int *version,
+                     const char **uuid,
+                     apr_file_t *file,
+                     struct parse_baton_t *pb,
+                     apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_stringbuf_t *line;
+  svn_boolean_t eof;
+  const char *value;
+  struct rev_index_t *entry = NULL;
+  svn_boolean_t entry_has_nodes = FALSE;
+
+  *index = apr_array_make(pool, 64, sizeof(struct rev_index_t));
+  *uuid = NULL;
+
+  /* The stream must open with the format version record. */
+  SVN_ERR(svn_io_file_readline(file, &line, NULL, &eof, APR_SIZE_MAX,
+                               iterpool, iterpool));
+  value = parse_header_line(line, SVN_REPOS_DUMPFILE_MAGIC_HEADER);
+  if (eof || value == NULL)
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Malformed dumpfile header"));
+  *version = atoi(value);
+
+  while (1)
+    {
+      apr_off_t line_start = 0;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_io_file_seek(file, APR_CUR, &line_start, iterpool));
+      SVN_ERR(svn_io_file_readline(file, &line, NULL, &eof, APR_SIZE_MAX,
+                                   iterpool, iterpool));
+      if (eof && line->len == 0)
+        {
+          if (entry)
+            entry->end = line_start;
+          break;
+        }
+
+      if (line->len == 0)
+        continue;  /* A blank separator line. */
+
+      if ((value = parse_header_line(line,
+                                     SVN_REPOS_DUMPFILE_REVISION_NUMBER)))
+        {
+          if (entry)
+            {
+              entry->end = line_start;
+
+              /* An originally empty revision may get dropped; let the
+                 regular filter decide about it. */
+              if (pb->drop_all_empty_revs && ! entry_has_nodes
+                  && entry->rev > 0)
+                entry->copyable = FALSE;
+            }
+
+          entry = &APR_ARRAY_PUSH(*index, struct rev_index_t);
+          entry->rev = SVN_STR_TO_REV(value);
+          entry->start = line_start;
+          entry->copyable = TRUE;
+          entry_has_nodes = FALSE;
+
+          SVN_ERR(skip_record_remainder(file, NULL, NULL, iterpool));
+        }
+      else if ((value = parse_header_line(line, SVN_REPOS_DUMPFILE_NODE_PATH)))
+        {
+          const char *node_path = value;
+          const char *copyfrom_path = NULL;
+
+          if (! entry)
+            return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                                    _("Unexpected node record before "
+                                      "first revision record"));
+          entry_has_nodes = TRUE;
+
+          /* NODE_PATH points into LINE, which lives in the iterpool
+             until the end of this iteration. */
+          SVN_ERR(skip_record_remainder(file, &copyfrom_path, iterpool,
+                                        iterpool));
+
+          if (node_path[0] != '/')
+            node_path = apr_pstrcat(iterpool, "/", node_path, SVN_VA_NULL);
+          if (copyfrom_path && copyfrom_path[0] != '/')
+            copyfrom_path = apr_pstrcat(iterpool, "/", copyfrom_path,
+                                        SVN_VA_NULL);
+
+          /* A dropped node, or a kept node copied from a dropped
+             source, means the revision cannot be copied verbatim. */
+          if (skip_path(node_path, pb->prefixes, pb->do_exclude, pb->glob)
+              || (copyfrom_path
+                  && skip_path(copyfrom_path, pb->prefixes,
+                               pb->do_exclude, pb->glob)))
+            entry->copyable = FALSE;
+        }
+      else if ((value = parse_header_line(line, SVN_REPOS_DUMPFILE_UUID)))
+        {
+          if (*uuid == NULL)
+            *uuid = apr_pstrdup(pool, value);
+        }
+      else
+        return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                                _("Unrecognized record type in stream"));
+    }
+
+  if (entry && pb->drop_all_empty_revs && ! entry_has_nodes
+      && entry->rev > 0)
+    entry->copyable = FALSE;
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Copy the bytes [START, END) of FILE to OUT, seeking FILE to START
+   first. */
+static svn_error_t *
+copy_range(apr_file_t *file,
+           svn_stream_t *out,
+           apr_off_t start,
+           apr_off_t end,
+           apr_pool_t *pool)
+{
+  char buffer[16384];
+  svn_filesize_t remaining = end - start;
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &start, pool));
+  while (remaining > 0)
+    {
+      apr_size_t chunk = sizeof(buffer);
+
+      if ((svn_filesize_t)chunk > remaining)
+        chunk = (apr_size_t)remaining;
+      SVN_ERR(svn_io_file_read_full2(file, buffer, chunk, NULL, NULL, pool));
+      SVN_ERR(svn_stream_write(out, buffer, &chunk));
+      remaining -= chunk;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* The baton of a ranged-read substream: a synthesized stream header
+   followed by a byte range of the underlying dump file. */
+struct ranged_read_baton_t
+{
+  /* The unconsumed part of the synthesized header. */
+  const char *header;
+  apr_size_t header_left;
+
+  /* The underlying file, positioned within the range, and the number
+     of range bytes not yet read. */
+  apr_file_t *file;
+  svn_filesize_t range_left;
+
+  /* For error allocation only. */
+  apr_pool_t *pool;
+};
+
+/* Implements svn_read_fn_t, reading from a ranged_read_baton_t. */
+static svn_error_t *
+ranged_read_fn(void *baton, char *buffer, apr_size_t *len)
+{
+  struct ranged_read_baton_t *b = baton;
+  apr_size_t total = 0;
+
+  if (b->header_left > 0)
+    {
+      apr_size_t chunk = *len;
+
+      if (chunk > b->header_left)
+        chunk = b->header_left;
+      memcpy(buffer, b->header, chunk);
+      b->header += chunk;
+      b->header_left -= chunk;
+      total = chunk;
+    }
+
+  if (total < *len && b->range_left > 0)
+    {
+      apr_size_t chunk = *len - total;
+
+      if ((svn_filesize_t)chunk > b->range_left)
+        chunk = (apr_size_t)b->range_left;
+      SVN_ERR(svn_io_file_read_full2(b->file, buffer + total, chunk,
+                                     NULL, NULL, b->pool));
+      b->range_left -= chunk;
+      total += chunk;
+    }
+
+  *len = total;
+  return SVN_NO_ERROR;
+}
+
+/* Return a read-only stream yielding HEADER followed by the next LEN
+   bytes of FILE, which must already be positioned appropriately. */
+static svn_stream_t *
+ranged_read_stream(apr_file_t *file,
+                   const char *header,
+                   svn_filesize_t len,
+                   apr_pool_t *pool)
+{
+  struct ranged_read_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  svn_stream_t *stream = svn_stream_create(b, pool);
+
+  b->header = header;
+  b->header_left = strlen(header);
+  b->file = file;
+  b->range_left = len;
+  b->pool = pool;
+
+  svn_stream_set_read2(stream, ranged_read_fn, ranged_read_fn);
+  return stream;
+}
+
+/* Filter the seekable dump file INPUT_FILE into PB->OUT_STREAM with the
+   help of a revision index:  revisions the filter would leave untouched
+   are copied to the output verbatim, and only the remaining revisions
+   are run through the regular parsing filter.  This must not be used
+   when revision renumbering or merge source skipping is active, since
+   those may modify revisions whose nodes all survive the filter. */
+static svn_error_t *
+filter_with_index(struct parse_baton_t *pb,
+                  apr_file_t *input_file,
+                  apr_pool_t *pool)
+{
+  apr_array_header_t *index;
+  int version;
+  const char *uuid;
+  const char *run_header;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(build_revision_index(&index, &version, &uuid, input_file,
+                               pb, pool));
+
+  /* Emit the stream header ourselves, and keep the per-run parses
+     below from emitting it again. */
+  SVN_ERR(svn_repos__dump_magic_header_record(pb->out_stream, version, pool));
+  if (uuid)
+    SVN_ERR(svn_repos__dump_uuid_header_record(pb->out_stream, uuid, pool));
+  pb->headers_written = TRUE;
+  if (version >= SVN_REPOS_DUMPFILE_FORMAT_VERSION_DELTAS)
+    pb->allow_deltas = TRUE;
+
+  /* Each parse run below gets this header prepended so that the
+     parser accepts it as a complete dumpstream. */
+  run_header = apr_psprintf(pool, "%s: %d\n\n",
+                            SVN_REPOS_DUMPFILE_MAGIC_HEADER, version);
+  if (uuid)
+    run_header = apr_psprintf(pool, "%s%s: %s\n\n", run_header,
+                              SVN_REPOS_DUMPFILE_UUID, uuid);
+
+  i = 0;
+  while (i < index->nelts)
+    {
+      struct rev_index_t *entry = &APR_ARRAY_IDX(index, i,
+                                                 struct rev_index_t);
+
+      svn_pool_clear(iterpool);
+
+      if (entry->copyable)
+        {
+          SVN_ERR(copy_range(input_file, pb->out_stream,
+                             entry->start, entry->end, iterpool));
+
+          /* Stash the oldest original rev not dropped, as
+             output_revision() would. */
+          if (entry->rev > 0
+              && !SVN_IS_VALID_REVNUM(pb->oldest_original_rev))
+            pb->oldest_original_rev = entry->rev;
+
+          if (! pb->quiet)
+            SVN_ERR(svn_cmdline_fprintf(stderr, iterpool,
+                                        _("Revision %ld committed as %ld.\n"),
+                                        entry->rev, entry->rev));
+          i++;
+        }
+      else
+        {
+          /* Run the regular filter over the maximal run of revisions
+             that need it. */
+          struct rev_index_t *last = entry;
+          svn_stream_t *run_stream;
+          apr_off_t start = entry->start;
+
+          while (i + 1 < index->nelts
+                 && !APR_ARRAY_IDX(index, i + 1,
+                                   struct rev_index_t).copyable)
+            {
+              i++;
+              last = &APR_ARRAY_IDX(index, i, struct rev_index_t);
+            }
+
+          SVN_ERR(svn_io_file_seek(input_file, APR_SET, &start, iterpool));
+          run_stream = ranged_read_stream(input_file, run_header,
+                                          last->end - entry->start,
+                                          iterpool);
+          SVN_ERR(svn_repos_parse_dumpstream3(run_stream, &filtering_vtable,
+                                              pb, TRUE, NULL, NULL,
+                                              iterpool));
+          i++;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+
 
 /** Subcommands. **/
 
@@ -971,6 +1394,12 @@ static const apr_getopt_option_t options_table[] =
     {"targets", svndumpfilter__targets, 1,
      N_("Read additional prefixes, one per line, from\n"
         "                             file ARG.")},
+    {"file",    'F', 1,
+     N_("Read the dumpstream from file ARG instead of\n"
+        "                             standard input.  Revisions that the filter\n"
+        "                             would pass through unchanged are then copied\n"
+        "                             to the output verbatim, without parsing\n"
+        "                             their contents.")},
     {NULL}
   };
 
@@ -988,7 +1417,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
       svndumpfilter__renumber_revs,
       svndumpfilter__skip_missing_merge_sources, svndumpfilter__targets,
       svndumpfilter__preserve_revprops, svndumpfilter__quiet,
-      svndumpfilter__glob} },
+      svndumpfilter__glob, 'F'} },
 
     {"include", subcommand_include, {0}, {N_(
         "Filter out nodes without given prefixes from dumpstream.\n"
@@ -998,7 +1427,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
       svndumpfilter__renumber_revs,
       svndumpfilter__skip_missing_merge_sources, svndumpfilter__targets,
       svndumpfilter__preserve_revprops, svndumpfilter__quiet,
-      svndumpfilter__glob} },
+      svndumpfilter__glob, 'F'} },
 
     {"help", subcommand_help, {"?", "h"}, {N_(
         "Describe the usage of this program or its subcommands.\n"
@@ -1026,6 +1455,7 @@ struct svndumpfilter_opt_state
   svn_boolean_t skip_missing_merge_sources;
                                          /* --skip-missing-merge-sources */
   const char *targets_file;              /* --targets-file       */
+  const char *input_file;                /* -F, --file          */
   apr_array_header_t *prefixes;          /* mainargs.           */
 };
 
@@ -1065,6 +1495,7 @@ parse_baton_initialize(struct parse_baton_t **pb,
   baton->last_live_revision = SVN_INVALID_REVNUM;
   baton->oldest_original_rev = SVN_INVALID_REVNUM;
   baton->allow_deltas = FALSE;
+  baton->headers_written = FALSE;
 
   *pb = baton;
   return SVN_NO_ERROR;
@@ -1121,6 +1552,7 @@ do_filter(apr_getopt_t *os,
 {
   struct svndumpfilter_opt_state *opt_state = baton;
   struct parse_baton_t *pb;
+  apr_file_t *input_file = NULL;
   apr_hash_index_t *hi;
   apr_array_header_t *keys;
   int i, num_keys;
@@ -1173,8 +1605,29 @@ do_filter(apr_getopt_t *os,
     }
 
   SVN_ERR(parse_baton_initialize(&pb, opt_state, do_exclude, pool));
-  SVN_ERR(svn_repos_parse_dumpstream3(pb->in_stream, &filtering_vtable, pb,
-                                      TRUE, NULL, NULL, pool));
+
+  if (opt_state->input_file)
+    SVN_ERR(svn_io_file_open(&input_file, opt_state->input_file,
+                             APR_READ | APR_BUFFERED, APR_OS_DEFAULT, pool));
+
+  /* With a seekable input we can index the revisions up front and copy
+     those the filter would not modify straight through.  Renumbering
+     and merge source skipping may rewrite revisions whose nodes all
+     survive the filter, so they disable the fast path. */
+  if (input_file
+      && ! pb->do_renumber_revs
+      && ! pb->skip_missing_merge_sources)
+    {
+      SVN_ERR(filter_with_index(pb, input_file, pool));
+    }
+  else
+    {
+      if (input_file)
+        pb->in_stream = svn_stream_from_aprfile2(input_file, FALSE, pool);
+
+      SVN_ERR(svn_repos_parse_dumpstream3(pb->in_stream, &filtering_vtable,
+                                          pb, TRUE, NULL, NULL, pool));
+    }
 
   /* The rest of this is just reporting.  If we aren't reporting, get
      outta here. */
@@ -1379,6 +1832,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           SVN_ERR(svn_utf_cstring_to_utf8(&opt_state.targets_file,
                                           opt_arg, pool));
           break;
+        case 'F':
+          SVN_ERR(svn_utf_cstring_to_utf8(&opt_state.input_file,
+                                          opt_arg, pool));
+          break;
         default:
           {
             SVN_ERR(subcommand_help(NULL, NULL, pool));
@@ -0,0 +1,225 @@
+/* optimize-cmd.c -- implements the optimize sub-command.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_strings.h>
+
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+
+#include "private/svn_fs_fs_private.h"
+#include "private/svn_sorts_private.h"
+
+#include "svn_private_config.h"
+
+#include "svnfsfs.h"
+
+/* Number of bytes we copy from the old to the new pack file at a time. */
+#define COPY_BUFFER_SIZE 0x40000
+
+/* Baton type to be used with collect_index_entry. */
+typedef struct collect_baton_t
+{
+  /* Array of svn_fs_fs__p2l_entry_t *, one element per index entry. */
+  apr_array_header_t *entries;
+
+  /* Allocate the entries here. */
+  apr_pool_t *pool;
+} collect_baton_t;
+
+/* Implements svn_fs_fs__dump_index_func_t, appending a copy of ENTRY to
+ * the array in BATON.  Padding entries are not collected because the
+ * reordered pack file will be written without gaps. */
+static svn_error_t *
+collect_index_entry(const svn_fs_fs__p2l_entry_t *entry,
+                    void *baton,
+                    apr_pool_t *scratch_pool)
+{
+  collect_baton_t *b = baton;
+
+  /* Type 0 is "none", i.e. padding. */
+  if (entry->type != 0)
+    APR_ARRAY_PUSH(b->entries, svn_fs_fs__p2l_entry_t *)
+      = apr_pmemdup(b->pool, entry, sizeof(*entry));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements the comparison function for svn_sort__array.  Order the
+ * svn_fs_fs__p2l_entry_t * elements by revision in descending order,
+ * i.e. the most recent revision first.  Within the same revision, keep
+ * the original on-disk order. */
+static int
+compare_access_order(const void *lhs,
+                     const void *rhs)
+{
+  const svn_fs_fs__p2l_entry_t *lhs_entry
+    = *(const svn_fs_fs__p2l_entry_t *const *)lhs;
+  const svn_fs_fs__p2l_entry_t *rhs_entry
+    = *(const svn_fs_fs__p2l_entry_t *const *)rhs;
+
+  if (lhs_entry->item.revision != rhs_entry->item.revision)
+    return lhs_entry->item.revision > rhs_entry->item.revision ? -1 : 1;
+
+  if (lhs_entry->offset != rhs_entry->offset)
+    return lhs_entry->offset < rhs_entry->offset ? -1 : 1;
+
+  return 0;
+}
+
+/* Copy the contents of the pack file at PACK_PATH into a temporary file
+ * in the same directory, placing the items in the order given by ENTRIES
+ * and updating the offsets in ENTRIES to their new values.  Then rename
+ * the result over PACK_PATH.  Use POOL for allocations. */
+static svn_error_t *
+rewrite_pack_file(const char *pack_path,
+                  apr_array_header_t *entries,
+                  apr_pool_t *pool)
+{
+  apr_file_t *old_file;
+  apr_file_t *new_file;
+  const char *new_path;
+  char *buffer = apr_palloc(pool, COPY_BUFFER_SIZE);
+  apr_off_t new_offset = 0;
+  int i;
+
+  SVN_ERR(svn_io_file_open(&old_file, pack_path,
+                           APR_READ | APR_BUFFERED, APR_OS_DEFAULT, pool));
+  SVN_ERR(svn_io_open_unique_file3(&new_file, &new_path,
+                                   svn_dirent_dirname(pack_path, pool),
+                                   svn_io_file_del_none, pool, pool));
+
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      svn_fs_fs__p2l_entry_t *entry
+        = APR_ARRAY_IDX(entries, i, svn_fs_fs__p2l_entry_t *);
+      apr_off_t offset = entry->offset;
+      apr_off_t remaining = entry->size;
+
+      SVN_ERR(check_cancel(NULL));
+      SVN_ERR(svn_io_file_seek(old_file, APR_SET, &offset, pool));
+
+      while (remaining > 0)
+        {
+          apr_size_t to_copy = remaining > COPY_BUFFER_SIZE
+                             ? COPY_BUFFER_SIZE
+                             : (apr_size_t)remaining;
+
+          SVN_ERR(svn_io_file_read_full2(old_file, buffer, to_copy,
+                                         NULL, NULL, pool));
+          SVN_ERR(svn_io_file_write_full(new_file, buffer, to_copy,
+                                         NULL, pool));
+          remaining -= to_copy;
+        }
+
+      entry->offset = new_offset;
+      new_offset += entry->size;
+    }
+
+  SVN_ERR(svn_io_file_close(old_file, pool));
+  SVN_ERR(svn_io_file_close(new_file, pool));
+  SVN_ERR(svn_io_file_rename2(new_path, pack_path, TRUE, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Reorder the pack file of the repository at PATH that contains REVISION
+ * and rebuild its indexes.  Unless QUIET is set, write a summary line to
+ * console.  Use POOL for allocations. */
+static svn_error_t *
+optimize(const char *path,
+         svn_revnum_t revision,
+         svn_boolean_t quiet,
+         apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  int shard_size;
+  svn_revnum_t min_unpacked_rev;
+  svn_revnum_t shard;
+  const char *pack_path;
+  collect_baton_t baton;
+  svn_fs_fs__ioctl_dump_index_input_t dump_input = {0};
+  svn_fs_fs__ioctl_load_index_input_t load_input = {0};
+
+  /* Check repository type and open it. */
+  SVN_ERR(open_fs(&fs, path, NULL, pool));
+
+  /* We only rewrite pack files, so the shard must already be packed. */
+  SVN_ERR(get_shard_size(&shard_size, path, pool));
+  SVN_ERR(get_min_unpacked_rev(&min_unpacked_rev, path, pool));
+
+  shard = revision / shard_size;
+  if ((shard + 1) * shard_size > min_unpacked_rev)
+    return svn_error_createf(SVN_ERR_FS_UNSUPPORTED_FORMAT, NULL,
+                             _("The shard containing r%ld has not been "
+                               "packed yet; run 'svnadmin pack' first"),
+                             revision);
+
+  pack_path = svn_dirent_join_many(pool, path, "db", "revs",
+                                   apr_psprintf(pool, "%ld.pack", shard),
+                                   "pack", SVN_VA_NULL);
+
+  /* Collect the current index contents of the pack file. */
+  baton.entries = apr_array_make(pool, 16, sizeof(void *));
+  baton.pool = pool;
+
+  dump_input.revision = revision;
+  dump_input.callback_func = collect_index_entry;
+  dump_input.callback_baton = &baton;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_DUMP_INDEX, &dump_input, NULL,
+                       check_cancel, NULL, pool, pool));
+
+  /* Determine the new physical order and rewrite the pack file to match
+   * it, updating the offsets in the entries as we go. */
+  svn_sort__array(baton.entries, compare_access_order);
+  SVN_ERR(rewrite_pack_file(pack_path, baton.entries, pool));
+
+  /* Make the indexes reflect the new item locations. */
+  load_input.revision = revision;
+  load_input.entries = baton.entries;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_LOAD_INDEX, &load_input, NULL,
+                       NULL, NULL, pool, pool));
+
+  if (!quiet)
+    printf(_("Reordered %d items in pack file for revisions r%ld to r%ld.\n"),
+           baton.entries->nelts, shard * shard_size,
+           (shard + 1) * shard_size - 1);
+
+  return SVN_NO_ERROR;
+}
+
+/* This implements `svn_opt_subcommand_t'. */
+svn_error_t *
+subcommand__optimize(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  svnfsfs__opt_state *opt_state = baton;
+
+  if (opt_state->start_revision.kind != svn_opt_revision_number)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("Revision argument required"));
+
+  SVN_ERR(optimize(opt_state->repository_path,
+                   opt_state->start_revision.value.number,
+                   opt_state->quiet, pool));
+
+  return SVN_NO_ERROR;
+}
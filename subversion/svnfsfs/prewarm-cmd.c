@@ -0,0 +1,314 @@
+/* prewarm-cmd.c -- implements the prewarm sub-command.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_strings.h>
+
+#include "svn_dirent_uri.h"
+#include "svn_fs.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+
+#include "private/svn_fs_fs_private.h"
+#include "private/svn_fspath.h"
+
+#include "svn_private_config.h"
+
+#include "svnfsfs.h"
+
+/* Number of bytes we read from a revision / pack file at a time. */
+#define READ_BUFFER_SIZE 0x40000
+
+/* svn_fs_fs__p2l_entry_t.type value for file representations, i.e. the
+ * (deltified) file contents.  Those are skipped in the metadata pass. */
+#define ITEM_TYPE_FILE_REP 1
+
+/* Baton type to be used with collect_metadata_entry. */
+typedef struct collect_baton_t
+{
+  /* Array of svn_fs_fs__p2l_entry_t *, one element per metadata item. */
+  apr_array_header_t *entries;
+
+  /* Only collect items belonging to revisions in [LOWER, UPPER]. */
+  svn_revnum_t lower;
+  svn_revnum_t upper;
+
+  /* Allocate the entries here. */
+  apr_pool_t *pool;
+} collect_baton_t;
+
+/* Implements svn_fs_fs__dump_index_func_t, appending a copy of ENTRY to
+ * the array in BATON if it is a metadata item within the revision range.
+ * Type 0 is "none", i.e. padding. */
+static svn_error_t *
+collect_metadata_entry(const svn_fs_fs__p2l_entry_t *entry,
+                       void *baton,
+                       apr_pool_t *scratch_pool)
+{
+  collect_baton_t *b = baton;
+
+  if (   entry->type != 0
+      && entry->type != ITEM_TYPE_FILE_REP
+      && entry->item.revision >= b->lower
+      && entry->item.revision <= b->upper)
+    APR_ARRAY_PUSH(b->entries, svn_fs_fs__p2l_entry_t *)
+      = apr_pmemdup(b->pool, entry, sizeof(*entry));
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the byte ranges given by the svn_fs_fs__p2l_entry_t * elements in
+ * ENTRIES from the file at FILE_PATH, bringing them into the OS file
+ * cache.  Read no more than *REMAINING bytes in total and decrement
+ * *REMAINING by the number of bytes actually read, which also gets added
+ * to *TOTAL_READ.  Use POOL for allocations. */
+static svn_error_t *
+read_ranges(const char *file_path,
+            apr_array_header_t *entries,
+            apr_uint64_t *remaining,
+            apr_uint64_t *total_read,
+            apr_pool_t *pool)
+{
+  apr_file_t *file;
+  char *buffer = apr_palloc(pool, READ_BUFFER_SIZE);
+  int i;
+
+  SVN_ERR(svn_io_file_open(&file, file_path,
+                           APR_READ | APR_BUFFERED, APR_OS_DEFAULT, pool));
+
+  for (i = 0; i < entries->nelts && *remaining > 0; ++i)
+    {
+      svn_fs_fs__p2l_entry_t *entry
+        = APR_ARRAY_IDX(entries, i, svn_fs_fs__p2l_entry_t *);
+      apr_off_t offset = entry->offset;
+      apr_uint64_t to_read = (apr_uint64_t)entry->size > *remaining
+                           ? *remaining
+                           : (apr_uint64_t)entry->size;
+
+      SVN_ERR(check_cancel(NULL));
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, pool));
+
+      while (to_read > 0)
+        {
+          apr_size_t chunk = to_read > READ_BUFFER_SIZE
+                           ? READ_BUFFER_SIZE
+                           : (apr_size_t)to_read;
+
+          SVN_ERR(svn_io_file_read_full2(file, buffer, chunk,
+                                         NULL, NULL, pool));
+          to_read -= chunk;
+          *remaining -= chunk;
+          *total_read += chunk;
+        }
+    }
+
+  SVN_ERR(svn_io_file_close(file, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Walk the directory PATH under ROOT recursively and read the contents
+ * of all files encountered.  Read no more than *REMAINING bytes and
+ * decrement *REMAINING by the number of bytes actually read, which also
+ * gets added to *TOTAL_READ.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+warm_tree(svn_fs_root_t *root,
+          const char *path,
+          apr_uint64_t *remaining,
+          apr_uint64_t *total_read,
+          apr_pool_t *scratch_pool)
+{
+  apr_hash_t *entries;
+  apr_hash_index_t *hi;
+  char *buffer = apr_palloc(scratch_pool, READ_BUFFER_SIZE);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
+  for (hi = apr_hash_first(scratch_pool, entries);
+       hi && *remaining > 0;
+       hi = apr_hash_next(hi))
+    {
+      svn_fs_dirent_t *dirent = apr_hash_this_val(hi);
+      const char *child;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(check_cancel(NULL));
+
+      child = svn_fspath__join(path, dirent->name, iterpool);
+      if (dirent->kind == svn_node_dir)
+        {
+          SVN_ERR(warm_tree(root, child, remaining, total_read, iterpool));
+        }
+      else
+        {
+          svn_stream_t *stream;
+          SVN_ERR(svn_fs_file_contents(&stream, root, child, iterpool));
+
+          while (*remaining > 0)
+            {
+              apr_size_t len = *remaining > READ_BUFFER_SIZE
+                             ? READ_BUFFER_SIZE
+                             : (apr_size_t)*remaining;
+
+              SVN_ERR(svn_stream_read_full(stream, buffer, &len));
+              *remaining -= len;
+              *total_read += len;
+
+              if (len < READ_BUFFER_SIZE)
+                break;
+            }
+
+          SVN_ERR(svn_stream_close(stream));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Prewarm the repository at PATH for the revision range and byte budget
+ * given by OPT_STATE:  read all metadata items within the range, newest
+ * revision / pack file first, then the file contents of HEAD.  Unless
+ * OPT_STATE->QUIET is set, write a summary line to console.  Use POOL
+ * for allocations. */
+static svn_error_t *
+prewarm(const char *path,
+        svnfsfs__opt_state *opt_state,
+        apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  int shard_size;
+  svn_revnum_t min_unpacked_rev;
+  svn_revnum_t youngest;
+  svn_revnum_t lower;
+  svn_revnum_t upper;
+  svn_revnum_t rev;
+  apr_uint64_t remaining = opt_state->prewarm_budget
+                         ? opt_state->prewarm_budget
+                         : APR_UINT64_MAX;
+  apr_uint64_t metadata_bytes = 0;
+  apr_uint64_t fulltext_bytes = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Check repository type and open it. */
+  SVN_ERR(open_fs(&fs, path, opt_state, pool));
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
+  SVN_ERR(get_shard_size(&shard_size, path, pool));
+  SVN_ERR(get_min_unpacked_rev(&min_unpacked_rev, path, pool));
+
+  /* Determine the revision range to prewarm.  UPPER defaults to HEAD,
+   * LOWER to the start of the shard containing UPPER. */
+  upper = opt_state->end_revision.kind == svn_opt_revision_number
+        ? opt_state->end_revision.value.number
+        : youngest;
+  lower = opt_state->start_revision.kind == svn_opt_revision_number
+        ? opt_state->start_revision.value.number
+        : (upper / shard_size) * shard_size;
+
+  if (lower > upper || upper > youngest)
+    return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                             _("Revision range %ld:%ld is not a valid range "
+                               "within the repository's history"),
+                             lower, upper);
+
+  /* Read the metadata of all revision / pack files in the range, newest
+   * first, so a tight byte budget gets spent on the hottest data. */
+  rev = upper;
+  while (rev >= lower && remaining > 0)
+    {
+      const char *file_path;
+      svn_revnum_t covered_first;
+      collect_baton_t baton;
+      svn_fs_fs__ioctl_dump_index_input_t input = {0};
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(check_cancel(NULL));
+
+      if (rev < min_unpacked_rev)
+        {
+          /* The pack file covers the whole shard. */
+          svn_revnum_t shard = rev / shard_size;
+          covered_first = shard * shard_size;
+          file_path = svn_dirent_join_many(iterpool, path, "db", "revs",
+                                           apr_psprintf(iterpool, "%ld.pack",
+                                                        shard),
+                                           "pack", SVN_VA_NULL);
+        }
+      else
+        {
+          covered_first = rev;
+          file_path = svn_dirent_join_many(iterpool, path, "db", "revs",
+                                           apr_psprintf(iterpool, "%ld",
+                                                        rev / shard_size),
+                                           apr_psprintf(iterpool, "%ld", rev),
+                                           SVN_VA_NULL);
+        }
+
+      /* Collect the metadata items of the revision / pack file.  The
+       * index lists them ordered by their location in the file, so we
+       * read them in a single forward sweep. */
+      baton.entries = apr_array_make(iterpool, 16, sizeof(void *));
+      baton.lower = lower;
+      baton.upper = upper;
+      baton.pool = iterpool;
+
+      input.revision = rev;
+      input.callback_func = collect_metadata_entry;
+      input.callback_baton = &baton;
+      SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_DUMP_INDEX, &input, NULL,
+                           check_cancel, NULL, iterpool, iterpool));
+
+      SVN_ERR(read_ranges(file_path, baton.entries, &remaining,
+                          &metadata_bytes, iterpool));
+
+      rev = covered_first - 1;
+    }
+
+  /* Spend the rest of the budget on the file contents of HEAD. */
+  if (remaining > 0)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, fs, youngest, pool));
+      SVN_ERR(warm_tree(root, "/", &remaining, &fulltext_bytes, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  if (!opt_state->quiet)
+    printf(_("Prewarmed %" APR_UINT64_T_FMT " kB of metadata for r%ld to "
+             "r%ld and %" APR_UINT64_T_FMT " kB of HEAD file contents.\n"),
+           metadata_bytes / 1024, lower, upper, fulltext_bytes / 1024);
+
+  return SVN_NO_ERROR;
+}
+
+/* This implements `svn_opt_subcommand_t'. */
+svn_error_t *
+subcommand__prewarm(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  svnfsfs__opt_state *opt_state = baton;
+
+  SVN_ERR(prewarm(opt_state->repository_path, opt_state, pool));
+
+  return SVN_NO_ERROR;
+}
@@ -505,7 +505,7 @@ subcommand__stats(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   svn_fs_fs__ioctl_get_stats_output_t *output;
 
   printf("Reading revisions\n");
-  SVN_ERR(open_fs(&fs, opt_state->repository_path, pool));
+  SVN_ERR(open_fs(&fs, opt_state->repository_path, opt_state, pool));
 
   input.progress_func = print_progress;
   SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_GET_STATS, &input, (void **)&output,
@@ -21,9 +21,16 @@
  * ====================================================================
  */
 
+#include <string.h>
+
+#include <apr_strings.h>
+
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_cmdline.h"
+#include "svn_io.h"
 #include "svn_opt.h"
+#include "svn_string.h"
 #include "svn_utf.h"
 #include "svn_path.h"
 #include "svn_dirent_uri.h"
@@ -76,7 +83,9 @@ check_lib_versions(void)
 
 enum svnfsfs__cmdline_options_t
   {
-    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID
+    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID,
+    svnfsfs__budget,
+    svnfsfs__jobs
   };
 
 /* Option codes and descriptions.
@@ -104,6 +113,14 @@ static const apr_getopt_option_t options_table[] =
      N_("size of the extra in-memory cache in MB used to\n"
         "                             minimize redundant operations. Default: 16.")},
 
+    {"budget",        svnfsfs__budget, 1,
+     N_("stop prewarming after reading ARG MB of data.\n"
+        "                             Default: no limit.")},
+
+    {"jobs",          svnfsfs__jobs, 1,
+     N_("number of pack files to process concurrently.\n"
+        "                             Default: 1, i.e. sequential processing.")},
+
     {NULL}
   };
 
@@ -162,23 +179,106 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
    )},
    {'M'} },
 
+  {"optimize", subcommand__optimize, {0}, {N_(
+    "usage: svnfsfs optimize REPOS_PATH -r REV\n"
+    "\n"), N_(
+    "Reorder the contents of the pack file containing revision REV such that\n"
+    "items belonging to recent revisions come first, and rebuild its indexes\n"
+    "accordingly.  Reading back recent history, e.g. checking out HEAD, then\n"
+    "becomes a mostly sequential scan of the pack file instead of a series of\n"
+    "scattered seeks.  This is only available for FSFS format 7 (SVN 1.9+)\n"
+    "repositories and only for shards that have already been packed.\n"
+    "\n"), N_(
+    "The repository must not be accessed by any other process while this\n"
+    "command is running.\n"
+   )},
+   {'r', 'q', 'M'} },
+
+  {"prewarm", subcommand__prewarm, {0}, {N_(
+    "usage: svnfsfs prewarm REPOS_PATH [-r LOWER[:UPPER]] [--budget ARG]\n"
+    "\n"), N_(
+    "Read the hot parts of the repository into the operating system's file\n"
+    "cache, e.g. on a standby server before it takes traffic.  Driven by the\n"
+    "P2L index, all metadata items (node revisions, directories, properties\n"
+    "and changed-paths lists) of the given revision range are read first,\n"
+    "newest revision / pack file first, followed by the file contents of the\n"
+    "youngest revision.  UPPER defaults to the youngest revision, LOWER to\n"
+    "the first revision of the shard containing UPPER.  Use --budget to limit\n"
+    "the total amount of data read; the budget is spent on the newest data\n"
+    "first.  This is only available for FSFS format 7 (SVN 1.9+) repositories.\n"
+   )},
+   {'r', 'q', 'M', svnfsfs__budget} },
+
   {"stats", subcommand__stats, {0}, {N_(
     "usage: svnfsfs stats REPOS_PATH\n"
     "\n"), N_(
     "Write object size statistics to console.\n"
    )},
-   {'M'} },
+   {'M', svnfsfs__jobs} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
 
 
+svn_error_t *
+get_shard_size(int *shard_size,
+               const char *path,
+               apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *contents;
+  apr_array_header_t *lines;
+  int i;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents,
+                                   svn_dirent_join_many(scratch_pool, path,
+                                                        "db", "format",
+                                                        SVN_VA_NULL),
+                                   scratch_pool));
+  lines = svn_cstring_split(contents->data, "\n", TRUE, scratch_pool);
+
+  for (i = 0; i < lines->nelts; ++i)
+    {
+      const char *line = APR_ARRAY_IDX(lines, i, const char *);
+      if (strncmp(line, "layout sharded ", 15) == 0)
+        {
+          *shard_size = atoi(line + 15);
+          if (*shard_size > 0)
+            return SVN_NO_ERROR;
+        }
+    }
+
+  return svn_error_createf(SVN_ERR_FS_UNSUPPORTED_FORMAT, NULL,
+                           _("Repository '%s' does not use a sharded "
+                             "layout"), path);
+}
+
+svn_error_t *
+get_min_unpacked_rev(svn_revnum_t *min_unpacked_rev,
+                     const char *path,
+                     apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *contents;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents,
+                                   svn_dirent_join_many(scratch_pool, path,
+                                                        "db",
+                                                        "min-unpacked-rev",
+                                                        SVN_VA_NULL),
+                                   scratch_pool));
+  svn_stringbuf_strip_whitespace(contents);
+
+  return svn_error_trace(svn_revnum_parse(min_unpacked_rev, contents->data,
+                                          NULL));
+}
+
 svn_error_t *
 open_fs(svn_fs_t **fs,
         const char *path,
+        const svnfsfs__opt_state *opt_state,
         apr_pool_t *pool)
 {
   const char *fs_type;
+  apr_hash_t *fs_config = NULL;
 
   /* Verify that we can handle the repository type. */
   path = svn_dirent_join(path, "db", pool);
@@ -188,8 +288,17 @@ open_fs(svn_fs_t **fs,
                              _("%s repositories are not supported"),
                              fs_type);
 
+  /* Pass the --jobs level on to the FS layer. */
+  if (opt_state && opt_state->jobs > 1)
+    {
+      fs_config = apr_hash_make(pool);
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_STATS_CONCURRENCY,
+                               apr_psprintf(pool, "%" APR_UINT64_T_FMT,
+                                            opt_state->jobs));
+    }
+
   /* Now open it. */
-  SVN_ERR(svn_fs_open2(fs, path, NULL, pool, pool));
+  SVN_ERR(svn_fs_open2(fs, path, fs_config, pool, pool));
   svn_fs_set_warning_func(*fs, warning_func, NULL);
 
   return SVN_NO_ERROR;
@@ -259,6 +368,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.jobs = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -320,6 +430,26 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           opt_state.memory_cache_size = 0x100000 * sz_val;
         }
         break;
+      case svnfsfs__budget:
+        {
+          apr_uint64_t sz_val;
+          SVN_ERR(svn_cstring_atoui64(&sz_val, opt_arg));
+
+          opt_state.prewarm_budget = 0x100000 * sz_val;
+        }
+        break;
+      case svnfsfs__jobs:
+        {
+          apr_uint64_t jobs_val;
+          SVN_ERR(svn_cstring_atoui64(&jobs_val, opt_arg));
+          if (jobs_val < 1 || jobs_val > APR_INT32_MAX)
+            return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                     _("Invalid number of jobs: %s"),
+                                     opt_arg);
+
+          opt_state.jobs = jobs_val;
+        }
+        break;
       case svnfsfs__version:
         opt_state.version = TRUE;
         break;
@@ -449,7 +579,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+
+    /* --jobs > 1 runs worker threads that all access the same caches,
+     * so cache locking must stay enabled in that case. */
+    settings.single_threaded = (opt_state.jobs <= 1);
 
     svn_cache_config_set(&settings);
   }
@@ -478,15 +611,29 @@ main(int argc, const char *argv[])
   apr_pool_t *pool;
   int exit_code = EXIT_SUCCESS;
   svn_error_t *err;
+  svn_boolean_t threaded = FALSE;
+  int i;
 
   /* Initialize the app. */
   if (svn_cmdline_init("svnfsfs", stderr) != EXIT_SUCCESS)
     return EXIT_FAILURE;
 
-  /* Create our top-level pool.  Use a separate mutexless allocator,
-   * given this application is single threaded.
+  /* '--jobs N' with N > 1 starts worker threads that allocate from
+   * sub-pools of the pool created below, so its allocator must be
+   * thread-safe in that case.  Detect the option before the actual
+   * argument parsing, which requires the pool to already exist. */
+  for (i = 1; i < argc; i++)
+    {
+      if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        threaded = (atoi(argv[i + 1]) > 1);
+      else if (strncmp(argv[i], "--jobs=", 7) == 0)
+        threaded = (atoi(argv[i] + 7) > 1);
+    }
+
+  /* Create our top-level pool.  Use a separate mutexless allocator
+   * unless worker threads will share this pool's allocator.
    */
-  pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  pool = apr_allocator_owner_get(svn_pool_create_allocator(threaded));
 
   err = sub_main(&exit_code, argc, argv, pool);
 
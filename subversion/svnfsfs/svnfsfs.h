@@ -45,6 +45,9 @@ typedef struct svnfsfs__opt_state
   svn_boolean_t version;                            /* --version */
   svn_boolean_t quiet;                              /* --quiet */
   apr_uint64_t memory_cache_size;                   /* --memory-cache-size M */
+  apr_uint64_t prewarm_budget;                      /* --budget, in bytes;
+                                                       0 means "no limit" */
+  apr_uint64_t jobs;                                /* --jobs N */
 } svnfsfs__opt_state;
 
 /* Declare all the command procedures */
@@ -52,16 +55,36 @@ svn_opt_subcommand_t
   subcommand__help,
   subcommand__dump_index,
   subcommand__load_index,
+  subcommand__optimize,
+  subcommand__prewarm,
   subcommand__stats;
 
 
-/* Check that the filesystem at PATH is an FSFS repository and then open it.
+/* Check that the filesystem at PATH is an FSFS repository and then open it,
+ * applying the relevant parts of OPT_STATE to the FS configuration.
+ * OPT_STATE may be NULL for subcommands without FS-level options.
  * Return the filesystem in *FS, allocated in POOL. */
 svn_error_t *
 open_fs(svn_fs_t **fs,
         const char *path,
+        const svnfsfs__opt_state *opt_state,
         apr_pool_t *pool);
 
+/* Scan the FSFS format file of the repository at PATH for the shard size
+ * and return it in *SHARD_SIZE.  Return an error for non-sharded layouts
+ * as those never contain pack files.  Use SCRATCH_POOL for temporaries. */
+svn_error_t *
+get_shard_size(int *shard_size,
+               const char *path,
+               apr_pool_t *scratch_pool);
+
+/* Set *MIN_UNPACKED_REV to the first revision in the repository at PATH
+ * that is not covered by a pack file.  Use SCRATCH_POOL for temporaries. */
+svn_error_t *
+get_min_unpacked_rev(svn_revnum_t *min_unpacked_rev,
+                     const char *path,
+                     apr_pool_t *scratch_pool);
+
 /* Our cancellation callback. */
 extern svn_cancel_func_t check_cancel;
 
@@ -28,11 +28,19 @@
 #include <apr_pools.h>
 #include <apr_time.h>
 #include <apr_file_io.h>
+#include <apr_network_io.h>
+#include <apr_thread_proc.h>
+#include <apr_portable.h>
 
 #define APR_WANT_STDIO
 #define APR_WANT_STRFUNC
 #include <apr_want.h>
 
+#if APR_HAVE_SOCKADDR_UN
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
 #include "svn_hash.h"
 #include "svn_cmdline.h"
 #include "svn_types.h"
@@ -83,6 +91,7 @@ static svn_opt_subcommand_t
   subcommand_log,
   subcommand_pget,
   subcommand_plist,
+  subcommand_serve,
   subcommand_tree,
   subcommand_uuid,
   subcommand_youngest;
@@ -327,6 +336,25 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
    {'r', 't', 'v', svnlook__revprop_opt, svnlook__xml_opt,
     svnlook__show_inherited_props} },
 
+  {"serve", subcommand_serve, {0}, {N_(
+      "usage: svnlook serve REPOS_PATH SOCKET_PATH\n"
+      "\n"), N_(
+      "Keep the repository open and answer svnlook queries arriving on the\n"
+      "unix domain socket SOCKET_PATH.  Each connection carries a single\n"
+      "request: one line holding a subcommand with its options and paths,\n"
+      "but without the repository argument, e.g. \"changed -t 2a-15\".\n"
+      "The response is the output the equivalent svnlook invocation would\n"
+      "have printed, after which the connection is closed.  Because the\n"
+      "repository stays open across requests, its caches stay warm, which\n"
+      "speeds up hook scripts that query the repository many times.\n"
+      "\n"
+      "Any user who can connect to SOCKET_PATH can read the entire\n"
+      "repository, so the socket is created accessible to its owner only.\n"
+      "Place it in a directory that other users cannot rename or delete\n"
+      "entries in, such as one with mode 0700.\n"
+   )},
+   {'M'} },
+
   {"tree", subcommand_tree, {0}, {N_(
       "usage: svnlook tree REPOS_PATH [PATH_IN_REPOS]\n"
       "\n"), N_(
@@ -382,6 +410,8 @@ struct svnlook_opt_state
   svn_boolean_t show_inherited_props; /*  --show-inherited-props */
   svn_boolean_t no_newline;       /* --no-newline */
   apr_uint64_t memory_cache_size; /* --memory-cache-size */
+  svn_repos_t *repos;             /* Pre-opened repository, if serving
+                                     requests in server mode. */
 };
 
 
@@ -2099,8 +2129,13 @@ get_ctxt_baton(svnlook_ctxt_t **baton_p,
 {
   svnlook_ctxt_t *baton = apr_pcalloc(pool, sizeof(*baton));
 
-  SVN_ERR(svn_repos_open3(&(baton->repos), opt_state->repos_path, NULL,
-                          pool, pool));
+  /* In server mode, the repository has been opened once for all
+     requests; opening it anew here would throw its caches away. */
+  if (opt_state->repos)
+    baton->repos = opt_state->repos;
+  else
+    SVN_ERR(svn_repos_open3(&(baton->repos), opt_state->repos_path, NULL,
+                            pool, pool));
   baton->fs = svn_repos_fs(baton->repos);
   svn_fs_set_warning_func(baton->fs, warning_func, NULL);
   baton->show_ids = opt_state->show_ids;
@@ -2407,6 +2442,378 @@ subcommand_plist(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+#if APR_HAVE_SOCKADDR_UN
+
+/* Maximum length of one request line in server mode. */
+#define SVNLOOK_REQUEST_MAXLEN 65536
+
+/* Read one LF-terminated request line from SOCK into *LINE.  A missing
+   trailing newline at connection shutdown is tolerated; a CR before the
+   LF is stripped. */
+static svn_error_t *
+read_request_line(svn_stringbuf_t **line,
+                  apr_socket_t *sock,
+                  apr_pool_t *pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+
+  while (1)
+    {
+      char c;
+      apr_size_t len = 1;
+      apr_status_t apr_err = apr_socket_recv(sock, &c, &len);
+
+      if (apr_err && !APR_STATUS_IS_EOF(apr_err))
+        return svn_error_wrap_apr(apr_err, _("Error reading request"));
+      if (len == 0 || c == '\n')
+        break;
+      if (c != '\r')
+        svn_stringbuf_appendbyte(buffer, c);
+      if (buffer->len > SVNLOOK_REQUEST_MAXLEN)
+        return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                _("Request line too long"));
+      if (apr_err)  /* EOF, with this byte being the last one. */
+        break;
+    }
+
+  *line = buffer;
+  return SVN_NO_ERROR;
+}
+
+/* Parse and execute the single server-mode request REQUEST.  REPOS is
+   the pre-opened repository at REPOS_PATH.  All output goes to stdout,
+   which the caller has pointed at the client connection. */
+static svn_error_t *
+handle_request(svn_repos_t *repos,
+               const char *repos_path,
+               const char *request,
+               apr_pool_t *pool)
+{
+  struct svnlook_opt_state opt_state;
+  const svn_opt_subcommand_desc3_t *subcommand;
+  const char *subcommand_name;
+  apr_getopt_t *os;
+  char **req_argv;
+  const char **argv;
+  int argc;
+  apr_status_t apr_err;
+
+  /* Split the request into words, honoring quoting, and prepend a
+     dummy program name so that apr_getopt accepts the result. */
+  apr_err = apr_tokenize_to_argv(request, &req_argv, pool);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Error parsing request"));
+  for (argc = 0; req_argv[argc]; argc++)
+    ;
+  argv = apr_palloc(pool, (argc + 2) * sizeof(*argv));
+  argv[0] = "svnlook";
+  memcpy(argv + 1, req_argv, (argc + 1) * sizeof(*argv));
+  argc++;
+
+  apr_err = apr_getopt_init(&os, pool, argc, argv);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Error parsing request"));
+
+  memset(&opt_state, 0, sizeof(opt_state));
+  opt_state.rev = SVN_INVALID_REVNUM;
+  opt_state.repos = repos;
+  opt_state.repos_path = repos_path;
+
+  os->interleave = 1;
+  while (1)
+    {
+      int opt_id;
+      const char *opt_arg;
+
+      apr_err = apr_getopt_long(os, options_table, &opt_id, &opt_arg);
+      if (APR_STATUS_IS_EOF(apr_err))
+        break;
+      else if (apr_err)
+        return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                _("Error parsing request options"));
+
+      switch (opt_id)
+        {
+        case 'r':
+          {
+            char *digits_end = NULL;
+            opt_state.rev = strtol(opt_arg, &digits_end, 10);
+            if ((! SVN_IS_VALID_REVNUM(opt_state.rev))
+                || (! digits_end)
+                || *digits_end)
+              return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                      _("Invalid revision number supplied"));
+          }
+          break;
+
+        case 't':
+          opt_state.txn = opt_arg;
+          break;
+
+        case 'N':
+          opt_state.non_recursive = TRUE;
+          break;
+
+        case 'v':
+          opt_state.verbose = TRUE;
+          break;
+
+        case 'l':
+          {
+            char *end;
+            opt_state.limit = strtol(opt_arg, &end, 10);
+            if (end == opt_arg || *end != '\0')
+              return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                      _("Non-numeric limit argument given"));
+            if (opt_state.limit <= 0)
+              return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                                    _("Argument to --limit must be positive"));
+          }
+          break;
+
+        case 'x':
+          opt_state.extensions = opt_arg;
+          break;
+
+        case svnlook__revprop_opt:
+          opt_state.revprop = TRUE;
+          break;
+
+        case svnlook__xml_opt:
+          opt_state.xml = TRUE;
+          break;
+
+        case svnlook__show_ids:
+          opt_state.show_ids = TRUE;
+          break;
+
+        case svnlook__no_diff_deleted:
+          opt_state.no_diff_deleted = TRUE;
+          break;
+
+        case svnlook__no_diff_added:
+          opt_state.no_diff_added = TRUE;
+          break;
+
+        case svnlook__diff_copy_from:
+          opt_state.diff_copy_from = TRUE;
+          break;
+
+        case svnlook__full_paths:
+          opt_state.full_paths = TRUE;
+          break;
+
+        case svnlook__copy_info:
+          opt_state.copy_info = TRUE;
+          break;
+
+        case svnlook__ignore_properties:
+          opt_state.ignore_properties = TRUE;
+          break;
+
+        case svnlook__properties_only:
+          opt_state.properties_only = TRUE;
+          break;
+
+        case svnlook__diff_cmd:
+          opt_state.diff_cmd = opt_arg;
+          break;
+
+        case svnlook__show_inherited_props:
+          opt_state.show_inherited_props = TRUE;
+          break;
+
+        case svnlook__no_newline:
+          opt_state.no_newline = TRUE;
+          break;
+
+        default:
+          return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                  _("Option not supported in server mode"));
+        }
+    }
+
+  /* The --transaction and --revision options may not co-exist. */
+  if ((opt_state.rev != SVN_INVALID_REVNUM) && opt_state.txn)
+    return svn_error_create
+                (SVN_ERR_CL_MUTUALLY_EXCLUSIVE_ARGS, NULL,
+                 _("The '--transaction' (-t) and '--revision' (-r) arguments "
+                   "cannot co-exist"));
+
+  if (os->ind >= os->argc)
+    return svn_error_create(SVN_ERR_CL_INSUFFICIENT_ARGS, NULL,
+                            _("Subcommand argument required"));
+
+  SVN_ERR(svn_utf_cstring_to_utf8(&subcommand_name, os->argv[os->ind++],
+                                  pool));
+  subcommand = svn_opt_get_canonical_subcommand3(cmd_table, subcommand_name);
+  if (subcommand == NULL)
+    return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                             _("Unknown subcommand: '%s'"), subcommand_name);
+  if (subcommand->cmd_func == subcommand_serve)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            _("Cannot run 'serve' within server mode"));
+
+  /* Unlike the command line, requests do not carry the repository
+     path; the remaining operands are arg1 and arg2 directly. */
+  if (os->ind < os->argc)
+    {
+      const char *arg1;
+
+      SVN_ERR(svn_utf_cstring_to_utf8(&arg1, os->argv[os->ind++], pool));
+      opt_state.arg1 = svn_dirent_internal_style(arg1, pool);
+    }
+  if (os->ind < os->argc)
+    {
+      const char *arg2;
+
+      SVN_ERR(svn_utf_cstring_to_utf8(&arg2, os->argv[os->ind++], pool));
+      opt_state.arg2 = svn_dirent_internal_style(arg2, pool);
+    }
+  if (os->ind < os->argc)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("Too many arguments given"));
+
+  return (*subcommand->cmd_func)(os, &opt_state, pool);
+}
+
+/* Answer one client connection CONN: read its request line, execute it
+   with stdout temporarily pointed at the connection, and report any
+   request-level failure to the client rather than to our caller. */
+static svn_error_t *
+serve_connection(svn_repos_t *repos,
+                 const char *repos_path,
+                 apr_socket_t *conn,
+                 apr_pool_t *pool)
+{
+  svn_stringbuf_t *request;
+  apr_os_sock_t sock_fd;
+  int saved_stdout;
+  svn_error_t *err;
+  apr_status_t apr_err;
+
+  SVN_ERR(read_request_line(&request, conn, pool));
+  if (request->len == 0)
+    return SVN_NO_ERROR;
+
+  apr_err = apr_os_sock_get(&sock_fd, conn);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Can't get socket descriptor"));
+
+  /* Point stdout at the connection while the subcommand runs, so that
+     the existing subcommand implementations need no changes. */
+  fflush(stdout);
+  saved_stdout = dup(STDOUT_FILENO);
+  if (saved_stdout == -1 || dup2(sock_fd, STDOUT_FILENO) == -1)
+    return svn_error_wrap_apr(apr_get_os_error(),
+                              _("Can't redirect output to the connection"));
+
+  err = handle_request(repos, repos_path, request->data, pool);
+
+  /* Report request failures to the client, then carry on serving. */
+  if (err)
+    {
+      svn_handle_error2(err, stdout, FALSE, "svnlook: ");
+      svn_error_clear(err);
+    }
+
+  fflush(stdout);
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdout);
+
+  return SVN_NO_ERROR;
+}
+
+/* The main loop of server mode:  open the repository at
+   OPT_STATE->REPOS_PATH once, listen on the unix domain socket at
+   OPT_STATE->ARG1, and answer one request per connection until the
+   process is interrupted. */
+static svn_error_t *
+serve_requests(struct svnlook_opt_state *opt_state, apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  apr_socket_t *listener;
+  apr_sockaddr_t *sa;
+  apr_status_t apr_err;
+  apr_pool_t *iterpool;
+  mode_t old_umask;
+
+  /* Open the repository once; every request shares it, which is what
+     keeps the FS caches warm between requests. */
+  SVN_ERR(svn_repos_open3(&repos, opt_state->repos_path, NULL, pool, pool));
+  svn_fs_set_warning_func(svn_repos_fs(repos), warning_func, NULL);
+
+  /* Bind the rendezvous socket, replacing a stale one if present. */
+  SVN_ERR(svn_io_remove_file2(opt_state->arg1, TRUE, pool));
+  apr_err = apr_sockaddr_info_get(&sa, opt_state->arg1, APR_UNIX, 0, 0,
+                                  pool);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Can't resolve socket path '%s'"),
+                              opt_state->arg1);
+  apr_err = apr_socket_create(&listener, sa->family, SOCK_STREAM, 0, pool);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Can't create server socket"));
+  /* Anyone who can connect to the socket can read the whole repository,
+     so restrict it to the owning user regardless of the process umask.
+     The permissions must be in place before listen() makes the socket
+     connectable, hence the umask dance instead of a chmod afterwards. */
+  old_umask = umask(0077);
+  apr_err = apr_socket_bind(listener, sa);
+  umask(old_umask);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Can't bind server socket to '%s'"),
+                              opt_state->arg1);
+  apr_err = apr_socket_listen(listener, 7);
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Can't listen on server socket"));
+
+  iterpool = svn_pool_create(pool);
+  while (1)
+    {
+      apr_socket_t *conn;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(check_cancel(NULL));
+
+      apr_err = apr_socket_accept(&conn, listener, iterpool);
+      if (APR_STATUS_IS_EINTR(apr_err))
+        continue;
+      if (apr_err)
+        return svn_error_wrap_apr(apr_err, _("Error accepting connection"));
+
+      err = serve_connection(repos, opt_state->repos_path, conn, iterpool);
+      if (err)
+        {
+          /* A broken connection must not bring the server down. */
+          svn_handle_error2(err, stderr, FALSE, "svnlook: ");
+          svn_error_clear(err);
+        }
+      apr_socket_close(conn);
+    }
+
+  /* NOTREACHED */
+}
+
+#endif /* APR_HAVE_SOCKADDR_UN */
+
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_serve(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  struct svnlook_opt_state *opt_state = baton;
+
+  SVN_ERR(check_number_of_args(opt_state, 1));
+
+#if APR_HAVE_SOCKADDR_UN
+  return serve_requests(opt_state, pool);
+#else
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("This platform does not support "
+                            "unix domain sockets"));
+#endif
+}
+
 /* This implements `svn_opt_subcommand_t'. */
 static svn_error_t *
 subcommand_tree(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -24,6 +24,8 @@
 
 #include "svn_types.h"
 #include "svn_props.h"
+#include "svn_hash.h"
+#include "svn_dirent_uri.h"
 #include "svn_ra.h"
 #include "svn_io.h"
 #include "svn_delta.h"
@@ -35,11 +37,201 @@
 #include <assert.h>
 
 
+/* The most entries the delta base cache will hold before it starts
+   evicting the least recently used ones. */
+#define SVNRDUMP_MAX_CACHED_BASES 1024
+
+/* One cached fulltext:  the contents some repository path had at some
+   revision, spooled into a temporary file. */
+struct cached_base {
+  /* The spool file holding the fulltext. */
+  const char *filename;
+
+  /* The revision the fulltext is valid for.  Because the replay visits
+     every revision in order and every text change passes through the
+     recording editor below, the entry remains a valid base for any
+     later revision until it is replaced or forgotten. */
+  svn_revnum_t revision;
+
+  /* Logical timestamp of the last lookup resp. store, for eviction. */
+  apr_uint64_t last_used;
+};
+
+/* A cache of delta bases held locally, keyed by repository relpath.
+   It spans the revisions of one contiguous replay range, saving one
+   svn_ra_get_file() round-trip for every file that is modified more
+   than once within the range. */
+struct svn_rdump__base_cache_t {
+  /* Repository relpath -> struct cached_base *. */
+  apr_hash_t *entries;
+
+  /* The pool holding ENTRIES and the spool files' lifetime. */
+  apr_pool_t *pool;
+
+  /* Source of LAST_USED timestamps. */
+  apr_uint64_t tick;
+};
+
+svn_rdump__base_cache_t *
+svn_rdump__base_cache_create(apr_pool_t *pool)
+{
+  svn_rdump__base_cache_t *cache = apr_pcalloc(pool, sizeof(*cache));
+
+  cache->entries = apr_hash_make(pool);
+  cache->pool = pool;
+
+  return cache;
+}
+
+/* Return the cache entry that can serve as the base of PATH at REVISION,
+   or NULL if the cache holds none. */
+static struct cached_base *
+base_cache_lookup(svn_rdump__base_cache_t *cache,
+                  const char *path,
+                  svn_revnum_t revision)
+{
+  struct cached_base *entry = svn_hash_gets(cache->entries, path);
+
+  if (entry && entry->revision <= revision)
+    {
+      entry->last_used = ++cache->tick;
+      return entry;
+    }
+
+  return NULL;
+}
+
+/* Remember FILENAME as the fulltext of PATH at REVISION, replacing and
+   deleting any older fulltext cached for PATH.  If the cache is full,
+   evict the least recently used entry first.  Returns the entry. */
+static struct cached_base *
+base_cache_store(svn_rdump__base_cache_t *cache,
+                 const char *path,
+                 svn_revnum_t revision,
+                 const char *filename,
+                 apr_pool_t *scratch_pool)
+{
+  struct cached_base *entry = svn_hash_gets(cache->entries, path);
+
+  if (! entry)
+    {
+      if (apr_hash_count(cache->entries) >= SVNRDUMP_MAX_CACHED_BASES)
+        {
+          apr_hash_index_t *hi;
+          const char *oldest_path = NULL;
+          struct cached_base *oldest = NULL;
+
+          for (hi = apr_hash_first(scratch_pool, cache->entries); hi;
+               hi = apr_hash_next(hi))
+            {
+              struct cached_base *candidate = apr_hash_this_val(hi);
+
+              if (! oldest || candidate->last_used < oldest->last_used)
+                {
+                  oldest_path = apr_hash_this_key(hi);
+                  oldest = candidate;
+                }
+            }
+
+          /* The spool file also has a delete-on-cleanup registration on
+             CACHE->POOL, so a failure here merely delays the deletion. */
+          svn_error_clear(svn_io_remove_file2(oldest->filename, TRUE,
+                                              scratch_pool));
+          svn_hash_sets(cache->entries, oldest_path, NULL);
+        }
+
+      entry = apr_palloc(cache->pool, sizeof(*entry));
+      svn_hash_sets(cache->entries, apr_pstrdup(cache->pool, path), entry);
+    }
+  else
+    {
+      svn_error_clear(svn_io_remove_file2(entry->filename, TRUE,
+                                          scratch_pool));
+    }
+
+  entry->filename = filename;
+  entry->revision = revision;
+  entry->last_used = ++cache->tick;
+
+  return entry;
+}
+
+/* Forget the cached fulltext of PATH and, if SUBTREE is set, of
+   everything below it. */
+static void
+base_cache_forget(svn_rdump__base_cache_t *cache,
+                  const char *path,
+                  svn_boolean_t subtree,
+                  apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, cache->entries); hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *key = apr_hash_this_key(hi);
+
+      if (strcmp(key, path) == 0
+          || (subtree && svn_relpath_skip_ancestor(path, key)))
+        {
+          struct cached_base *entry = apr_hash_this_val(hi);
+
+          svn_error_clear(svn_io_remove_file2(entry->filename, TRUE,
+                                              scratch_pool));
+          svn_hash_sets(cache->entries, key, NULL);
+        }
+    }
+}
+
+/* Fetch the fulltext of PATH at REVISION over RA_SESSION into a new
+   cache entry of CACHE and return it in *ENTRY.  If the path does not
+   exist at that revision, set *ENTRY to NULL. */
+static svn_error_t *
+base_cache_fetch(struct cached_base **entry,
+                 svn_rdump__base_cache_t *cache,
+                 svn_ra_session_t *ra_session,
+                 const char *path,
+                 svn_revnum_t revision,
+                 apr_pool_t *scratch_pool)
+{
+  svn_stream_t *fstream;
+  const char *filename;
+  svn_error_t *err;
+
+  SVN_ERR(svn_stream_open_unique(&fstream, &filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 cache->pool, scratch_pool));
+
+  err = svn_ra_get_file(ra_session, path, revision,
+                        fstream, NULL, NULL, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_FS_NOT_FOUND)
+    {
+      svn_error_clear(err);
+      SVN_ERR(svn_stream_close(fstream));
+      svn_error_clear(svn_io_remove_file2(filename, TRUE, scratch_pool));
+
+      *entry = NULL;
+      return SVN_NO_ERROR;
+    }
+  else if (err)
+    return svn_error_trace(err);
+
+  SVN_ERR(svn_stream_close(fstream));
+
+  *entry = base_cache_store(cache, path, revision, filename, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 /* The baton used by the dump editor. */
 struct dump_edit_baton {
   /* A backdoor ra session to fetch additional information during the edit. */
   svn_ra_session_t *ra_session;
 
+  /* The delta base cache shared by the revisions of one replay range,
+     or NULL to fetch every base over RA_SESSION. */
+  svn_rdump__base_cache_t *base_cache;
+
   /* The revision we're currently dumping. */
   svn_revnum_t current_revision;
 };
@@ -62,6 +254,19 @@ fetch_base_func(const char **filename,
   if (! SVN_IS_VALID_REVNUM(base_revision))
     base_revision = eb->current_revision - 1;
 
+  if (eb->base_cache)
+    {
+      struct cached_base *entry;
+
+      entry = base_cache_lookup(eb->base_cache, path, base_revision);
+      if (! entry)
+        SVN_ERR(base_cache_fetch(&entry, eb->base_cache, eb->ra_session,
+                                 path, base_revision, scratch_pool));
+
+      *filename = entry ? entry->filename : NULL;
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(svn_stream_open_unique(&fstream, filename, NULL,
                                  svn_io_file_del_on_pool_cleanup,
                                  result_pool, scratch_pool));
@@ -150,12 +355,480 @@ fetch_kind_func(svn_node_kind_t *kind,
   return SVN_NO_ERROR;
 }
 
+#ifdef ENABLE_EV2_SHIMS
+
+/* In shimmed builds the Ev1->Ev2 conversion calls fetch_base_func for
+   every modified file, so the replay repeatedly downloads fulltexts that
+   an earlier revision of the same run already produced.  The recording
+   editor below is a transparent wrapper around the shimmed dump editor
+   that additionally applies each incoming text delta against the locally
+   held base and stores the resulting fulltext in the delta base cache,
+   where the next revision's fetch_base_func will find it. */
+
+/* The recording editor's edit baton. */
+struct cache_edit_baton {
+  const svn_delta_editor_t *wrapped_editor;
+  void *wrapped_edit_baton;
+
+  /* The dump editor's baton, for the cache, the backdoor session and
+     the current revision. */
+  struct dump_edit_baton *de_baton;
+};
+
+struct cache_dir_baton {
+  struct cache_edit_baton *eb;
+  void *wrapped_dir_baton;
+};
+
+struct cache_file_baton {
+  struct cache_edit_baton *eb;
+  void *wrapped_file_baton;
+
+  /* The file's repository relpath, i.e. its cache key. */
+  const char *path;
+
+  /* The base the server deltifies against:  PATH at BASE_REVISION for
+     an opened file, COPYFROM_PATH at COPYFROM_REV for a copy, and the
+     empty fulltext for a plain add. */
+  svn_revnum_t base_revision;
+  const char *copyfrom_path;
+  svn_revnum_t copyfrom_rev;
+  svn_boolean_t added;
+};
+
+/* The window handler baton used to tee the incoming delta into the
+   wrapped editor and the local application. */
+struct cache_window_baton {
+  svn_txdelta_window_handler_t wrapped_handler;
+  void *wrapped_baton;
+
+  /* The local application, or NULL if the delta is not being recorded. */
+  svn_txdelta_window_handler_t apply_handler;
+  void *apply_baton;
+
+  /* Where to file the result once the delta is complete. */
+  struct cache_file_baton *fb;
+  const char *result_filename;
+
+  /* The pool the handler chain was allocated in. */
+  apr_pool_t *pool;
+};
+
+/* Return PATH without its leading '/', if any. */
+static const char *
+strip_leading_slash(const char *path)
+{
+  return path[0] == '/' ? path + 1 : path;
+}
+
+static svn_error_t *
+cache_set_target_revision(void *edit_baton,
+                          svn_revnum_t target_revision,
+                          apr_pool_t *pool)
+{
+  struct cache_edit_baton *eb = edit_baton;
+
+  return eb->wrapped_editor->set_target_revision(eb->wrapped_edit_baton,
+                                                 target_revision, pool);
+}
+
+static svn_error_t *
+cache_open_root(void *edit_baton,
+                svn_revnum_t base_revision,
+                apr_pool_t *pool,
+                void **root_baton)
+{
+  struct cache_edit_baton *eb = edit_baton;
+  struct cache_dir_baton *db = apr_palloc(pool, sizeof(*db));
+
+  SVN_ERR(eb->wrapped_editor->open_root(eb->wrapped_edit_baton,
+                                        base_revision, pool,
+                                        &db->wrapped_dir_baton));
+
+  db->eb = eb;
+  *root_baton = db;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+cache_delete_entry(const char *path,
+                   svn_revnum_t base_revision,
+                   void *parent_baton,
+                   apr_pool_t *pool)
+{
+  struct cache_dir_baton *pb = parent_baton;
+  struct cache_edit_baton *eb = pb->eb;
+
+  base_cache_forget(eb->de_baton->base_cache, strip_leading_slash(path),
+                    TRUE, pool);
+
+  return eb->wrapped_editor->delete_entry(path, base_revision,
+                                          pb->wrapped_dir_baton, pool);
+}
+
+static svn_error_t *
+cache_add_directory(const char *path,
+                    void *parent_baton,
+                    const char *copyfrom_path,
+                    svn_revnum_t copyfrom_revision,
+                    apr_pool_t *pool,
+                    void **child_baton)
+{
+  struct cache_dir_baton *pb = parent_baton;
+  struct cache_edit_baton *eb = pb->eb;
+  struct cache_dir_baton *db = apr_palloc(pool, sizeof(*db));
+
+  SVN_ERR(eb->wrapped_editor->add_directory(path, pb->wrapped_dir_baton,
+                                            copyfrom_path,
+                                            copyfrom_revision, pool,
+                                            &db->wrapped_dir_baton));
+
+  db->eb = eb;
+  *child_baton = db;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+cache_open_directory(const char *path,
+                     void *parent_baton,
+                     svn_revnum_t base_revision,
+                     apr_pool_t *pool,
+                     void **child_baton)
+{
+  struct cache_dir_baton *pb = parent_baton;
+  struct cache_edit_baton *eb = pb->eb;
+  struct cache_dir_baton *db = apr_palloc(pool, sizeof(*db));
+
+  SVN_ERR(eb->wrapped_editor->open_directory(path, pb->wrapped_dir_baton,
+                                             base_revision, pool,
+                                             &db->wrapped_dir_baton));
+
+  db->eb = eb;
+  *child_baton = db;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+cache_change_dir_prop(void *dir_baton,
+                      const char *name,
+                      const svn_string_t *value,
+                      apr_pool_t *pool)
+{
+  struct cache_dir_baton *db = dir_baton;
+
+  return db->eb->wrapped_editor->change_dir_prop(db->wrapped_dir_baton,
+                                                 name, value, pool);
+}
+
+static svn_error_t *
+cache_close_directory(void *dir_baton,
+                      apr_pool_t *pool)
+{
+  struct cache_dir_baton *db = dir_baton;
+
+  return db->eb->wrapped_editor->close_directory(db->wrapped_dir_baton,
+                                                 pool);
+}
+
+static svn_error_t *
+cache_absent_directory(const char *path,
+                       void *dir_baton,
+                       apr_pool_t *pool)
+{
+  struct cache_dir_baton *db = dir_baton;
+
+  return db->eb->wrapped_editor->absent_directory(path,
+                                                  db->wrapped_dir_baton,
+                                                  pool);
+}
+
+static svn_error_t *
+cache_add_file(const char *path,
+               void *parent_baton,
+               const char *copyfrom_path,
+               svn_revnum_t copyfrom_revision,
+               apr_pool_t *pool,
+               void **file_baton)
+{
+  struct cache_dir_baton *pb = parent_baton;
+  struct cache_edit_baton *eb = pb->eb;
+  struct cache_file_baton *fb = apr_pcalloc(pool, sizeof(*fb));
+
+  SVN_ERR(eb->wrapped_editor->add_file(path, pb->wrapped_dir_baton,
+                                       copyfrom_path, copyfrom_revision,
+                                       pool, &fb->wrapped_file_baton));
+
+  fb->eb = eb;
+  fb->path = strip_leading_slash(path);
+  fb->base_revision = SVN_INVALID_REVNUM;
+  if (copyfrom_path)
+    {
+      fb->copyfrom_path = strip_leading_slash(copyfrom_path);
+      fb->copyfrom_rev = copyfrom_revision;
+    }
+  else
+    fb->added = TRUE;
+
+  /* Whatever the cache held under this path belonged to a predecessor
+     that no longer exists. */
+  base_cache_forget(eb->de_baton->base_cache, fb->path, FALSE, pool);
+
+  *file_baton = fb;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+cache_open_file(const char *path,
+                void *parent_baton,
+                svn_revnum_t base_revision,
+                apr_pool_t *pool,
+                void **file_baton)
+{
+  struct cache_dir_baton *pb = parent_baton;
+  struct cache_edit_baton *eb = pb->eb;
+  struct cache_file_baton *fb = apr_pcalloc(pool, sizeof(*fb));
+
+  SVN_ERR(eb->wrapped_editor->open_file(path, pb->wrapped_dir_baton,
+                                        base_revision, pool,
+                                        &fb->wrapped_file_baton));
+
+  fb->eb = eb;
+  fb->path = strip_leading_slash(path);
+  fb->base_revision = base_revision;
+  fb->copyfrom_rev = SVN_INVALID_REVNUM;
+
+  *file_baton = fb;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_window_handler_t:  forward WINDOW to the
+   wrapped editor's handler, apply it locally, and file the finished
+   fulltext into the cache. */
+static svn_error_t *
+cache_window_handler(svn_txdelta_window_t *window,
+                     void *baton)
+{
+  struct cache_window_baton *wb = baton;
+
+  SVN_ERR(wb->wrapped_handler(window, wb->wrapped_baton));
+
+  if (wb->apply_handler)
+    {
+      SVN_ERR(wb->apply_handler(window, wb->apply_baton));
+
+      if (window == NULL)
+        {
+          struct cache_file_baton *fb = wb->fb;
+
+          base_cache_store(fb->eb->de_baton->base_cache, fb->path,
+                           fb->eb->de_baton->current_revision,
+                           wb->result_filename, wb->pool);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+cache_apply_textdelta(void *file_baton,
+                      const char *base_checksum,
+                      apr_pool_t *pool,
+                      svn_txdelta_window_handler_t *handler,
+                      void **handler_baton)
+{
+  struct cache_file_baton *fb = file_baton;
+  struct dump_edit_baton *de_baton = fb->eb->de_baton;
+  svn_rdump__base_cache_t *cache = de_baton->base_cache;
+  struct cache_window_baton *wb = apr_pcalloc(pool, sizeof(*wb));
+  svn_stream_t *source;
+  svn_stream_t *target;
+
+  /* Resolve the delta's base locally before handing the call on:  the
+     wrapped editor's shims will ask fetch_base_func for the very same
+     base, and by filling the cache first we pay for at most one fetch. */
+  if (fb->added)
+    source = svn_stream_empty(pool);
+  else
+    {
+      const char *base_path;
+      svn_revnum_t base_revision;
+      struct cached_base *entry;
+
+      if (fb->copyfrom_path)
+        {
+          base_path = fb->copyfrom_path;
+          base_revision = fb->copyfrom_rev;
+        }
+      else
+        {
+          base_path = fb->path;
+          base_revision = SVN_IS_VALID_REVNUM(fb->base_revision)
+                            ? fb->base_revision
+                            : de_baton->current_revision - 1;
+        }
+
+      entry = base_cache_lookup(cache, base_path, base_revision);
+      if (! entry)
+        SVN_ERR(base_cache_fetch(&entry, cache, de_baton->ra_session,
+                                 base_path, base_revision, pool));
+
+      if (entry)
+        SVN_ERR(svn_stream_open_readonly(&source, entry->filename,
+                                         pool, pool));
+      else
+        source = svn_stream_empty(pool);
+    }
+
+  SVN_ERR(fb->eb->wrapped_editor->apply_textdelta(fb->wrapped_file_baton,
+                                                  base_checksum, pool,
+                                                  &wb->wrapped_handler,
+                                                  &wb->wrapped_baton));
+
+  SVN_ERR(svn_stream_open_unique(&target, &wb->result_filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 cache->pool, pool));
+  svn_txdelta_apply(source, target, NULL, NULL, pool,
+                    &wb->apply_handler, &wb->apply_baton);
+
+  wb->fb = fb;
+  wb->pool = pool;
+  *handler = cache_window_handler;
+  *handler_baton = wb;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+cache_apply_textdelta_stream(const svn_delta_editor_t *editor,
+                             void *file_baton,
+                             const char *base_checksum,
+                             svn_txdelta_stream_open_func_t open_func,
+                             void *open_baton,
+                             apr_pool_t *scratch_pool)
+{
+  struct cache_file_baton *fb = file_baton;
+  struct cache_edit_baton *eb = fb->eb;
+
+  /* The delta does not pass through a window handler of ours, so the
+     best we can do is invalidate what we hold for the file. */
+  base_cache_forget(eb->de_baton->base_cache, fb->path, FALSE,
+                    scratch_pool);
+
+  return eb->wrapped_editor->apply_textdelta_stream(eb->wrapped_editor,
+                                                    fb->wrapped_file_baton,
+                                                    base_checksum,
+                                                    open_func, open_baton,
+                                                    scratch_pool);
+}
+
+static svn_error_t *
+cache_change_file_prop(void *file_baton,
+                       const char *name,
+                       const svn_string_t *value,
+                       apr_pool_t *pool)
+{
+  struct cache_file_baton *fb = file_baton;
+
+  return fb->eb->wrapped_editor->change_file_prop(fb->wrapped_file_baton,
+                                                  name, value, pool);
+}
+
+static svn_error_t *
+cache_close_file(void *file_baton,
+                 const char *text_checksum,
+                 apr_pool_t *pool)
+{
+  struct cache_file_baton *fb = file_baton;
+
+  return fb->eb->wrapped_editor->close_file(fb->wrapped_file_baton,
+                                            text_checksum, pool);
+}
+
+static svn_error_t *
+cache_absent_file(const char *path,
+                  void *file_baton,
+                  apr_pool_t *pool)
+{
+  struct cache_file_baton *fb = file_baton;
+
+  return fb->eb->wrapped_editor->absent_file(path, fb->wrapped_file_baton,
+                                             pool);
+}
+
+static svn_error_t *
+cache_close_edit(void *edit_baton,
+                 apr_pool_t *pool)
+{
+  struct cache_edit_baton *eb = edit_baton;
+
+  return eb->wrapped_editor->close_edit(eb->wrapped_edit_baton, pool);
+}
+
+static svn_error_t *
+cache_abort_edit(void *edit_baton,
+                 apr_pool_t *pool)
+{
+  struct cache_edit_baton *eb = edit_baton;
+
+  return eb->wrapped_editor->abort_edit(eb->wrapped_edit_baton, pool);
+}
+
+/* Wrap WRAPPED_EDITOR / WRAPPED_EDIT_BATON in the recording editor,
+   returning the result in *EDITOR and *EDIT_BATON, allocated in POOL.
+   DE_BATON is the dump editor's baton; its cache must be non-NULL. */
+static svn_error_t *
+get_base_cache_editor(const svn_delta_editor_t **editor,
+                      void **edit_baton,
+                      const svn_delta_editor_t *wrapped_editor,
+                      void *wrapped_edit_baton,
+                      struct dump_edit_baton *de_baton,
+                      apr_pool_t *pool)
+{
+  svn_delta_editor_t *cache_editor = svn_delta_default_editor(pool);
+  struct cache_edit_baton *eb = apr_palloc(pool, sizeof(*eb));
+
+  cache_editor->set_target_revision = cache_set_target_revision;
+  cache_editor->open_root = cache_open_root;
+  cache_editor->delete_entry = cache_delete_entry;
+  cache_editor->add_directory = cache_add_directory;
+  cache_editor->open_directory = cache_open_directory;
+  cache_editor->change_dir_prop = cache_change_dir_prop;
+  cache_editor->close_directory = cache_close_directory;
+  cache_editor->absent_directory = cache_absent_directory;
+  cache_editor->add_file = cache_add_file;
+  cache_editor->open_file = cache_open_file;
+  cache_editor->apply_textdelta = cache_apply_textdelta;
+  cache_editor->apply_textdelta_stream = cache_apply_textdelta_stream;
+  cache_editor->change_file_prop = cache_change_file_prop;
+  cache_editor->close_file = cache_close_file;
+  cache_editor->absent_file = cache_absent_file;
+  cache_editor->close_edit = cache_close_edit;
+  cache_editor->abort_edit = cache_abort_edit;
+
+  eb->wrapped_editor = wrapped_editor;
+  eb->wrapped_edit_baton = wrapped_edit_baton;
+  eb->de_baton = de_baton;
+
+  *editor = cache_editor;
+  *edit_baton = eb;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* ENABLE_EV2_SHIMS */
+
 svn_error_t *
 svn_rdump__get_dump_editor(const svn_delta_editor_t **editor,
                            void **edit_baton,
                            svn_revnum_t revision,
                            svn_stream_t *stream,
                            svn_ra_session_t *ra_session,
+                           svn_rdump__base_cache_t *base_cache,
                            const char *update_anchor_relpath,
                            svn_cancel_func_t cancel_func,
                            void *cancel_baton,
@@ -167,6 +840,7 @@ svn_rdump__get_dump_editor(const svn_delta_editor_t **editor,
 
   eb = apr_pcalloc(pool, sizeof(struct dump_edit_baton));
   eb->ra_session = ra_session;
+  eb->base_cache = base_cache;
   eb->current_revision = revision;
 
   SVN_ERR(svn_repos__get_dump_editor(editor, edit_baton,
@@ -186,5 +860,13 @@ svn_rdump__get_dump_editor(const svn_delta_editor_t **editor,
   SVN_ERR(svn_editor__insert_shims(editor, edit_baton, *editor, *edit_baton,
                                    NULL, NULL, shim_callbacks, pool, pool));
 
+#ifdef ENABLE_EV2_SHIMS
+  /* Only shimmed builds fetch delta bases, so only they can profit from
+     recording the fulltexts the replay produces. */
+  if (base_cache)
+    SVN_ERR(get_base_cache_editor(editor, edit_baton, *editor, *edit_baton,
+                                  eb, pool));
+#endif
+
   return SVN_NO_ERROR;
 }
@@ -23,6 +23,7 @@
  */
 
 #include <apr_uri.h>
+#include <apr_thread_proc.h>
 
 #include "svn_pools.h"
 #include "svn_cmdline.h"
@@ -65,6 +66,7 @@ enum svn_svnrdump__longopt_t
     opt_skip_revprop,
     opt_force_interactive,
     opt_incremental,
+    opt_jobs,
     opt_trust_server_cert,
     opt_trust_server_cert_failures,
     opt_version
@@ -90,7 +92,7 @@ static const svn_opt_subcommand_desc3_t svnrdump__cmd_table[] =
        "in a 'dumpfile' portable format.  If only LOWER is given, dump that\n"
        "one revision.\n"
     )},
-    { 'r', 'q', opt_incremental, 'F', SVN_SVNRDUMP__BASE_OPTIONS },
+    { 'r', 'q', opt_incremental, opt_jobs, 'F', SVN_SVNRDUMP__BASE_OPTIONS },
     {{'F', N_("write to file ARG instead of stdout")}} },
   { "load", load_cmd, { 0 }, {N_(
        "usage: svnrdump load URL\n"
@@ -116,6 +118,12 @@ static const apr_getopt_option_t svnrdump__options[] =
                       N_("no progress (only errors) to stderr")},
     {"incremental",   opt_incremental, 0,
                       N_("dump incrementally")},
+    {"jobs",          opt_jobs, 1,
+                      N_("dump up to ARG revision ranges concurrently,\n"
+                         "                             "
+                         "each over its own connection.  Default: 1,\n"
+                         "                             "
+                         "i.e. a single sequential dump")},
     {"skip-revprop",  opt_skip_revprop, 1,
                       N_("skip revision property ARG (e.g., \"svn:author\")")},
     {"config-dir",    opt_config_dir, 1,
@@ -179,6 +187,10 @@ struct replay_baton {
   /* The output stream */
   svn_stream_t *stdout_stream;
 
+  /* The delta base cache shared by the revisions this baton replays,
+     or NULL. */
+  svn_rdump__base_cache_t *base_cache;
+
   /* Whether to be quiet. */
   svn_boolean_t quiet;
 };
@@ -195,6 +207,7 @@ typedef struct opt_baton_t {
   svn_opt_revision_t end_revision;
   svn_boolean_t quiet;
   svn_boolean_t incremental;
+  int jobs;
   apr_hash_t *skip_revprops;
 } opt_baton_t;
 
@@ -221,6 +234,7 @@ replay_revstart(svn_revnum_t revision,
 
   SVN_ERR(svn_rdump__get_dump_editor(editor, edit_baton, revision,
                                      rb->stdout_stream, rb->extra_ra_session,
+                                     rb->base_cache,
                                      NULL, check_cancel, NULL, pool));
 
   return SVN_NO_ERROR;
@@ -297,6 +311,214 @@ replay_revend_v2(svn_revnum_t revision,
 }
 #endif
 
+#if APR_HAS_THREADS && !defined(USE_EV2_IMPL)
+
+/* How many consecutive revisions one worker renders before its chunk is
+   spliced into the output.  Small enough to bound the spool space the
+   pending chunks occupy, large enough to amortize the per-slice setup. */
+#define SVNRDUMP_SLICE_LENGTH 64
+
+/* The state of one worker of a parallel dump:  a pair of private RA
+   sessions, the revision slice currently assigned to the worker, and
+   the spool file its dumpstream chunk is rendered into. */
+struct dump_slice_baton {
+  /* The worker's replay session and backdoor session.  Only ever used
+     by one thread at a time. */
+  svn_ra_session_t *session;
+  svn_ra_session_t *extra_session;
+
+  /* The slice to render, inclusive on both ends. */
+  svn_revnum_t start_revision;
+  svn_revnum_t end_revision;
+
+  /* Where the rendered chunk goes resp. went. */
+  svn_stream_t *spool_stream;
+  const char *spool_abspath;
+
+  /* The slice's result. */
+  svn_error_t *err;
+
+  /* The worker's private root pool, with its own allocator, holding the
+     sessions.  WINDOW_POOL is a subpool of it, cleared by the main
+     thread between two windows. */
+  apr_pool_t *pool;
+  apr_pool_t *window_pool;
+};
+
+/* Render the slice currently assigned to SB into its spool file.
+   Runs on a worker thread; stores the slice's result in SB->ERR. */
+static void
+dump_slice(struct dump_slice_baton *sb)
+{
+  struct replay_baton *rb = apr_pcalloc(sb->window_pool, sizeof(*rb));
+
+  rb->extra_ra_session = sb->extra_session;
+  rb->stdout_stream = sb->spool_stream;
+  /* The slice's revisions are contiguous, so its editors may share one
+     delta base cache.  It must not outlive the slice:  the revisions
+     in between two of the worker's slices belong to other workers, so
+     entries carried across would go stale unnoticed. */
+  rb->base_cache = svn_rdump__base_cache_create(sb->window_pool);
+  /* The main thread prints the progress messages, in revision order. */
+  rb->quiet = TRUE;
+
+  sb->err = svn_ra_replay_range(sb->session, sb->start_revision,
+                                sb->end_revision, 0, TRUE,
+                                replay_revstart, replay_revend,
+                                rb, sb->window_pool);
+  sb->err = svn_error_compose_create(sb->err,
+                                     svn_stream_close(sb->spool_stream));
+}
+
+/* Thread entry point wrapper around dump_slice().  DATA is the
+   worker's dump_slice_baton. */
+static void * APR_THREAD_FUNC
+dump_slice_thread(apr_thread_t *thread, void *data)
+{
+  dump_slice(data);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Pool cleanup handler: destroy the worker pool given as DATA. */
+static apr_status_t
+cleanup_slice_pool(void *data)
+{
+  apr_pool_t *slice_pool = data;
+
+  svn_pool_destroy(slice_pool);
+  return APR_SUCCESS;
+}
+
+/* Dump revisions START_REVISION thru END_REVISION (inclusive) of the
+ * repository at URL to OUTPUT_STREAM like the svn_ra_replay_range call
+ * in replay_revisions() would, but over up to JOBS concurrent session
+ * pairs.  The range is processed in windows:  each worker renders a
+ * slice of SVNRDUMP_SLICE_LENGTH consecutive revisions into a spool
+ * file, and the main thread splices the finished chunks into
+ * OUTPUT_STREAM in revision order, so the result is byte-identical to
+ * a sequential dump.  REPOS_ROOT is the repository root URL to which
+ * the workers' backdoor sessions get reparented; CTX is used to open
+ * the sessions, on the calling thread.
+ */
+static svn_error_t *
+replay_revisions_parallel(svn_client_ctx_t *ctx,
+                          const char *url,
+                          const char *repos_root,
+                          svn_revnum_t start_revision,
+                          svn_revnum_t end_revision,
+                          svn_boolean_t quiet,
+                          int jobs,
+                          svn_stream_t *output_stream,
+                          apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  struct dump_slice_baton **slices
+    = apr_palloc(pool, jobs * sizeof(*slices));
+  apr_thread_t **threads = apr_palloc(pool, jobs * sizeof(*threads));
+  int i;
+
+  /* Open each worker's pair of sessions up front, on this thread.
+     The worker pools get their own allocators because the workers
+     allocate from them concurrently. */
+  for (i = 0; i < jobs; i++)
+    {
+      apr_pool_t *slice_pool = svn_pool_create(NULL);
+      struct dump_slice_baton *sb = apr_pcalloc(slice_pool, sizeof(*sb));
+
+      apr_pool_cleanup_register(pool, slice_pool, cleanup_slice_pool,
+                                apr_pool_cleanup_null);
+
+      sb->pool = slice_pool;
+      sb->window_pool = svn_pool_create(slice_pool);
+      SVN_ERR(svn_client_open_ra_session2(&sb->session, url, NULL, ctx,
+                                          slice_pool, iterpool));
+      SVN_ERR(svn_client_open_ra_session2(&sb->extra_session, url, NULL, ctx,
+                                          slice_pool, iterpool));
+      SVN_ERR(svn_ra_reparent(sb->extra_session, repos_root, iterpool));
+
+      slices[i] = sb;
+    }
+
+  while (start_revision <= end_revision)
+    {
+      int nslices = 0;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(check_cancel(NULL));
+
+      /* Carve the next window of the range into per-worker slices. */
+      for (i = 0; i < jobs && start_revision <= end_revision; i++)
+        {
+          struct dump_slice_baton *sb = slices[i];
+
+          svn_pool_clear(sb->window_pool);
+
+          sb->start_revision = start_revision;
+          sb->end_revision = start_revision + SVNRDUMP_SLICE_LENGTH - 1;
+          if (sb->end_revision > end_revision)
+            sb->end_revision = end_revision;
+          start_revision = sb->end_revision + 1;
+
+          SVN_ERR(svn_stream_open_unique(&sb->spool_stream,
+                                         &sb->spool_abspath, NULL,
+                                         svn_io_file_del_on_pool_cleanup,
+                                         sb->window_pool, iterpool));
+          sb->err = SVN_NO_ERROR;
+          nslices++;
+        }
+
+      /* Render the slices concurrently.  If a thread cannot be
+         created, render that slice right here instead. */
+      for (i = 0; i < nslices; i++)
+        if (apr_thread_create(&threads[i], NULL, dump_slice_thread,
+                              slices[i], iterpool))
+          {
+            threads[i] = NULL;
+            dump_slice(slices[i]);
+          }
+
+      for (i = 0; i < nslices; i++)
+        if (threads[i])
+          {
+            apr_status_t thread_status;
+
+            apr_thread_join(&thread_status, threads[i]);
+          }
+
+      for (i = 0; i < nslices; i++)
+        err = svn_error_compose_create(err, slices[i]->err);
+      SVN_ERR(err);
+
+      /* Splice the chunks into the real output, in revision order. */
+      for (i = 0; i < nslices; i++)
+        {
+          struct dump_slice_baton *sb = slices[i];
+          svn_stream_t *chunk;
+          svn_revnum_t rev;
+
+          SVN_ERR(svn_stream_open_readonly(&chunk, sb->spool_abspath,
+                                           iterpool, iterpool));
+          SVN_ERR(svn_stream_copy3(chunk,
+                                   svn_stream_disown(output_stream, iterpool),
+                                   check_cancel, NULL, iterpool));
+
+          if (! quiet)
+            for (rev = sb->start_revision; rev <= sb->end_revision; rev++)
+              SVN_ERR(svn_cmdline_fprintf(stderr, iterpool,
+                                          "* Dumped revision %lu.\n", rev));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS && !USE_EV2_IMPL */
+
 /* Initialize the RA layer, and set *CTX to a new client context baton
  * allocated from POOL.  Use CONFIG_DIR and pass USERNAME, PASSWORD,
  * CONFIG_DIR and NO_AUTH_CACHE to initialize the authorization baton.
@@ -448,7 +670,7 @@ dump_initial_full_revision(svn_ra_session_t *session,
      delta between nothing and everything-at-REV is, effectively, a
      full dump of REV. */
   SVN_ERR(svn_rdump__get_dump_editor(&dump_editor, &dump_baton, revision,
-                                     stdout_stream, extra_ra_session,
+                                     stdout_stream, extra_ra_session, NULL,
                                      source_relpath, check_cancel, NULL, pool));
   SVN_ERR(svn_ra_do_update3(session, &reporter, &report_baton, revision,
                             "", svn_depth_infinity, FALSE, FALSE,
@@ -469,15 +691,21 @@ dump_initial_full_revision(svn_ra_session_t *session,
  * the repository URL at which SESSION is rooted, using callbacks
  * which generate Subversion repository dumpstreams describing the
  * changes made in those revisions.  If QUIET is set, don't generate
- * progress messages.
+ * progress messages.  If JOBS is greater than 1, replay up to JOBS
+ * revision slices concurrently, each over its own pair of sessions
+ * opened to URL resp. REPOS_ROOT via CTX.
  */
 static svn_error_t *
 replay_revisions(svn_ra_session_t *session,
                  svn_ra_session_t *extra_ra_session,
+                 svn_client_ctx_t *ctx,
+                 const char *url,
+                 const char *repos_root,
                  svn_revnum_t start_revision,
                  svn_revnum_t end_revision,
                  svn_boolean_t quiet,
                  svn_boolean_t incremental,
+                 int jobs,
                  const char *dumpfile,
                  apr_pool_t *pool)
 {
@@ -497,6 +725,9 @@ replay_revisions(svn_ra_session_t *session,
   replay_baton = apr_pcalloc(pool, sizeof(*replay_baton));
   replay_baton->stdout_stream = output_stream;
   replay_baton->extra_ra_session = extra_ra_session;
+  /* A sequential replay covers one contiguous range, so a single delta
+     base cache can span all of its revisions. */
+  replay_baton->base_cache = svn_rdump__base_cache_create(pool);
   replay_baton->quiet = quiet;
 
   /* Write the magic header and UUID */
@@ -537,6 +768,13 @@ replay_revisions(svn_ra_session_t *session,
   if (start_revision <= end_revision)
     {
 #ifndef USE_EV2_IMPL
+#if APR_HAS_THREADS
+      if (jobs > 1)
+        SVN_ERR(replay_revisions_parallel(ctx, url, repos_root,
+                                          start_revision, end_revision,
+                                          quiet, jobs, output_stream, pool));
+      else
+#endif
       SVN_ERR(svn_ra_replay_range(session, start_revision, end_revision,
                                   0, TRUE, replay_revstart, replay_revend,
                                   replay_baton, pool));
@@ -645,10 +883,11 @@ dump_cmd(apr_getopt_t *os,
   SVN_ERR(svn_ra_reparent(extra_ra_session, repos_root, pool));
 
   return replay_revisions(opt_baton->session, extra_ra_session,
+                          opt_baton->ctx, opt_baton->url, repos_root,
                           opt_baton->start_revision.value.number,
                           opt_baton->end_revision.value.number,
                           opt_baton->quiet, opt_baton->incremental,
-                          opt_baton->dumpfile, pool);
+                          opt_baton->jobs, opt_baton->dumpfile, pool);
 }
 
 /* Handle the "load" subcommand.  Implements `svn_opt_subcommand_t'.  */
@@ -811,6 +1050,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_baton->start_revision.kind = svn_opt_revision_unspecified;
   opt_baton->end_revision.kind = svn_opt_revision_unspecified;
   opt_baton->url = NULL;
+  opt_baton->jobs = 1;
   opt_baton->skip_revprops = apr_hash_make(pool);
   opt_baton->dumpfile = NULL;
 
@@ -900,6 +1140,16 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
         case opt_incremental:
           opt_baton->incremental = TRUE;
           break;
+        case opt_jobs:
+          {
+            SVN_ERR(svn_utf_cstring_to_utf8(&opt_arg, opt_arg, pool));
+            SVN_ERR(svn_cstring_atoi(&opt_baton->jobs, opt_arg));
+            if (opt_baton->jobs < 1)
+              return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                       _("Invalid number of jobs: %s"),
+                                       opt_arg);
+          }
+          break;
         case opt_skip_revprop:
           SVN_ERR(svn_utf_cstring_to_utf8(&opt_arg, opt_arg, pool));
           svn_hash_sets(opt_baton->skip_revprops, opt_arg, opt_arg);
@@ -39,10 +39,30 @@ extern "C" {
 #endif /* __cplusplus */
 
 
+/**
+ * A cache of delta base fulltexts held in local temporary files,
+ * shared by the dump editors of one contiguous replay range so that
+ * each of them can resolve delta bases the preceding revisions already
+ * produced without asking the server again.
+ */
+typedef struct svn_rdump__base_cache_t svn_rdump__base_cache_t;
+
+/**
+ * Return a new, empty delta base cache allocated in @a pool.  The
+ * cache's spool files live until @a pool is cleared or destroyed.
+ */
+svn_rdump__base_cache_t *
+svn_rdump__base_cache_create(apr_pool_t *pool);
+
 /**
  * Get a dump editor @a editor along with a @a edit_baton allocated in
  * @a pool.  The editor will write output to @a stream.
  *
+ * @a base_cache, if not @c NULL, is the delta base cache shared by the
+ * revisions of the replay range @a revision belongs to.  It must only
+ * be shared by editors whose drives cover a contiguous, ascending
+ * range of revisions, and only by one thread at a time.
+ *
  * @a update_anchor_relpath is the repository relative path of the
  * anchor of the update-style drive which will happen on @a *editor;
  * if a replay-style drive will instead be used, it should be passed
@@ -57,6 +77,7 @@ svn_rdump__get_dump_editor(const svn_delta_editor_t **editor,
                            svn_revnum_t revision,
                            svn_stream_t *stream,
                            svn_ra_session_t *ra_session,
+                           svn_rdump__base_cache_t *base_cache,
                            const char *update_anchor_relpath,
                            svn_cancel_func_t cancel_func,
                            void *cancel_baton,
@@ -40,6 +40,22 @@
 #include <unistd.h>   /* For getpid() */
 #endif
 
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+
+/* Capacity of each of the two buffers used in asynchronous mode.
+ * Messages that don't fit into the accumulation buffer get dropped
+ * (and accounted for) instead of blocking the request path.
+ */
+#define ASYNC_BUFFER_SIZE 65536
+
+/* Interval between flushes of the accumulation buffer in asynchronous
+ * mode.  Also the worst-case delay at process shutdown.
+ */
+#define ASYNC_FLUSH_INTERVAL apr_time_from_msec(200)
+
+#endif
+
 struct logger_t
 {
   /* actual log file / stream object */
@@ -50,8 +66,175 @@ struct logger_t
 
   /* private pool used for temporary allocations */
   apr_pool_t *pool;
+
+#if APR_HAS_THREADS
+  /* thread flushing the write buffer; NULL in synchronous mode */
+  apr_thread_t *writer;
+
+  /* in asynchronous mode, messages accumulate here instead of being
+     written to STREAM directly; NULL in synchronous mode.
+     Protected by MUTEX. */
+  char *write_buffer;
+
+  /* buffer currently being written out by WRITER; the two buffers get
+     swapped under MUTEX on every flush */
+  char *flush_buffer;
+
+  /* number of bytes used in WRITE_BUFFER; protected by MUTEX */
+  apr_size_t buffered;
+
+  /* number of messages dropped due to buffer overflow since the last
+     flush; protected by MUTEX */
+  apr_uint64_t dropped;
+
+  /* set under MUTEX to make WRITER flush once more and terminate */
+  svn_boolean_t terminating;
+#endif
 };
 
+/* Append the LEN bytes of ERRSTR to LOGGER's output - directly to the
+ * stream in synchronous mode, into the accumulation buffer otherwise.
+ * To be called with LOGGER->MUTEX held.
+ */
+static svn_error_t *
+write_locked(logger_t *logger,
+             const char *errstr,
+             apr_size_t len)
+{
+#if APR_HAS_THREADS
+  if (logger->write_buffer)
+    {
+      if (len <= ASYNC_BUFFER_SIZE - logger->buffered)
+        {
+          memcpy(logger->write_buffer + logger->buffered, errstr, len);
+          logger->buffered += len;
+        }
+      else
+        {
+          /* Never block the request path on a full buffer. */
+          logger->dropped++;
+        }
+
+      return SVN_NO_ERROR;
+    }
+#endif
+
+  return svn_stream_write(logger->stream, errstr, &len);
+}
+
+#if APR_HAS_THREADS
+
+/* Thread routine flushing LOGGER's accumulation buffer in regular
+ * intervals until LOGGER->TERMINATING gets set.
+ */
+static void * APR_THREAD_FUNC writer_thread(apr_thread_t *thread,
+                                            void *data)
+{
+  logger_t *logger = data;
+  svn_boolean_t terminating = FALSE;
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  while (!terminating)
+    {
+      char *full_buffer;
+      apr_size_t len;
+      apr_uint64_t dropped;
+
+      apr_sleep(ASYNC_FLUSH_INTERVAL);
+
+      /* Swap buffers such that new messages accumulate while we write
+         the old ones out. */
+      svn_error_clear(svn_mutex__lock(logger->mutex));
+      full_buffer = logger->write_buffer;
+      logger->write_buffer = logger->flush_buffer;
+      logger->flush_buffer = full_buffer;
+      len = logger->buffered;
+      logger->buffered = 0;
+      dropped = logger->dropped;
+      logger->dropped = 0;
+      terminating = logger->terminating;
+      svn_error_clear(svn_mutex__unlock(logger->mutex, SVN_NO_ERROR));
+
+      if (len)
+        svn_error_clear(svn_stream_write(logger->stream, full_buffer, &len));
+
+      if (dropped)
+        {
+          const char *warning
+            = apr_psprintf(pool,
+                           "%" APR_PID_T_FMT " %s - - - WARN"
+                           " dropped %" APR_UINT64_T_FMT
+                           " log messages" APR_EOL_STR,
+                           getpid(),
+                           svn_time_to_cstring(apr_time_now(), pool),
+                           dropped);
+          apr_size_t warning_len = strlen(warning);
+
+          svn_error_clear(svn_stream_write(logger->stream, warning,
+                                           &warning_len));
+          svn_pool_clear(pool);
+        }
+    }
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(thread, APR_SUCCESS);
+
+  return NULL;
+}
+
+/* Pool cleanup handler: stop the writer thread of the logger_t given
+ * in DATA, flushing all pending output.
+ */
+static apr_status_t
+terminate_writer(void *data)
+{
+  logger_t *logger = data;
+  apr_status_t result;
+
+  svn_error_clear(svn_mutex__lock(logger->mutex));
+  logger->terminating = TRUE;
+  svn_error_clear(svn_mutex__unlock(logger->mutex, SVN_NO_ERROR));
+
+  apr_thread_join(&result, logger->writer);
+
+  return APR_SUCCESS;
+}
+
+#endif
+
+void
+logger__enable_async(logger_t *logger,
+                     apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  apr_status_t status;
+  apr_threadattr_t *tattr;
+  char *buffers;
+
+  if (!logger || logger->write_buffer)
+    return;
+
+  buffers = apr_palloc(pool, 2 * ASYNC_BUFFER_SIZE);
+  logger->write_buffer = buffers;
+  logger->flush_buffer = buffers + ASYNC_BUFFER_SIZE;
+
+  status = apr_threadattr_create(&tattr, pool);
+  if (!status)
+    status = apr_thread_create(&logger->writer, tattr, writer_thread,
+                               logger, pool);
+  if (status)
+    {
+      /* No writer, no buffering:  stay synchronous. */
+      logger->write_buffer = NULL;
+      logger->flush_buffer = NULL;
+      return;
+    }
+
+  apr_pool_cleanup_register(pool, logger, terminate_writer,
+                            apr_pool_cleanup_null);
+#endif
+}
+
 svn_error_t *
 logger__create_for_stderr(logger_t **logger,
                           apr_pool_t *pool)
@@ -141,7 +324,7 @@ log_message(logger_t *logger,
           memcpy(errstr + len, APR_EOL_STR, sizeof(APR_EOL_STR));
           len += sizeof(APR_EOL_STR) -1;  /* add NL, ex terminating NUL */
 
-          svn_error_clear(svn_stream_write(logger->stream, errstr, &len));
+          svn_error_clear(write_locked(logger, errstr, len));
 
           continuation = "-";
           err = err->child;
@@ -177,6 +360,6 @@ logger__write(logger_t *logger,
               apr_size_t len)
 {
   SVN_MUTEX__WITH_LOCK(logger->mutex,
-                       svn_stream_write(logger->stream, errstr, &len));
+                       write_locked(logger, errstr, len));
   return SVN_NO_ERROR;
 }
@@ -54,6 +54,20 @@ logger__create(logger_t **logger,
                const char *filename,
                apr_pool_t *pool);
 
+/* Switch LOGGER to asynchronous mode:  messages accumulate in a bounded
+ * in-memory buffer and a dedicated thread, allocated in POOL, writes them
+ * to the log file in regular intervals.  Messages that would overflow the
+ * buffer get dropped and a drop count gets logged instead.  POOL must not
+ * get destroyed before the pool LOGGER was created in.
+ *
+ * Call this at most once per process and only after any fork(), because
+ * the writer thread does not survive one.  This is a no-op if APR does
+ * not support threads or the writer thread cannot be created.
+ */
+void
+logger__enable_async(logger_t *logger,
+                     apr_pool_t *pool);
+
 /* Write the first LEN bytes from ERRSTR to the log file managed by LOGGER.
  */
 svn_error_t *
@@ -0,0 +1,337 @@
+/*
+ * metrics.c : Implementation of the svnserve metrics collector
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+
+#define APR_WANT_STRFUNC
+#include <apr_want.h>
+
+#include "svn_error.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+
+#include "private/svn_cache.h"
+#include "private/svn_mutex.h"
+
+#include "svn_private_config.h"
+#include "metrics.h"
+
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+
+/* Interval between rewrites of the dump file. */
+#define METRICS_DUMP_INTERVAL apr_time_from_sec(15)
+
+#endif
+
+/* Upper limits, in microseconds, of the finite latency histogram
+ * buckets.  Durations larger than the last limit fall into the
+ * implicit "+Inf" bucket.
+ */
+static const apr_time_t bucket_limits[] =
+{
+  1000, 4000, 16000, 64000, 256000, 1024000, 4096000, 16384000
+};
+
+#define NUM_FINITE_BUCKETS (sizeof(bucket_limits) / sizeof(bucket_limits[0]))
+
+/* The corresponding "le" label values, in seconds, as required by the
+ * Prometheus exposition format.
+ */
+static const char *const bucket_labels[] =
+{
+  "0.001", "0.004", "0.016", "0.064", "0.256", "1.024", "4.096", "16.384"
+};
+
+/* Per-command aggregates.  The bucket counters are *not* cumulative;
+ * they get accumulated when the data is being dumped.
+ */
+typedef struct command_metrics_t
+{
+  apr_uint64_t count;
+  apr_uint64_t sum;     /* total handler time in microseconds */
+  apr_uint64_t buckets[NUM_FINITE_BUCKETS + 1];  /* last one is "+Inf" */
+} command_metrics_t;
+
+struct metrics_t
+{
+  /* path of the dump file */
+  const char *filename;
+
+  /* mutex used to serialize access to COMMANDS */
+  svn_mutex__t *mutex;
+
+  /* maps command name to the respective command_metrics_t; both keys
+     and values are allocated in POOL.  Protected by MUTEX. */
+  apr_hash_t *commands;
+
+  /* pool that this structure and its hash entries live in */
+  apr_pool_t *pool;
+
+#if APR_HAS_THREADS
+  /* thread periodically rewriting the dump file; NULL until
+     metrics__start_dumping() got called */
+  apr_thread_t *dumper;
+
+  /* set under MUTEX to make DUMPER write once more and terminate */
+  svn_boolean_t terminating;
+#endif
+};
+
+svn_error_t *
+metrics__create(metrics_t **metrics,
+                const char *filename,
+                apr_pool_t *pool)
+{
+  metrics_t *result = apr_pcalloc(pool, sizeof(*result));
+
+  result->filename = apr_pstrdup(pool, filename);
+  result->commands = apr_hash_make(pool);
+  result->pool = pool;
+  SVN_ERR(svn_mutex__init(&result->mutex, TRUE, pool));
+
+  *metrics = result;
+
+  return SVN_NO_ERROR;
+}
+
+void
+metrics__record_command(const char *cmdname,
+                        apr_time_t duration,
+                        void *baton)
+{
+  metrics_t *metrics = baton;
+  command_metrics_t *entry;
+  apr_size_t i;
+
+  for (i = 0; i < NUM_FINITE_BUCKETS; i++)
+    if (duration <= bucket_limits[i])
+      break;
+
+  svn_error_clear(svn_mutex__lock(metrics->mutex));
+
+  entry = svn_hash_gets(metrics->commands, cmdname);
+  if (!entry)
+    {
+      /* CMDNAME lives in the command pool; copy it for the table. */
+      entry = apr_pcalloc(metrics->pool, sizeof(*entry));
+      svn_hash_sets(metrics->commands,
+                    apr_pstrdup(metrics->pool, cmdname), entry);
+    }
+
+  entry->count++;
+  entry->sum += (apr_uint64_t)duration;
+  entry->buckets[i]++;
+
+  svn_error_clear(svn_mutex__unlock(metrics->mutex, SVN_NO_ERROR));
+}
+
+/* Append the latency histograms and call counters of all commands
+ * recorded in METRICS to BUFFER in Prometheus exposition format.
+ * Temporaries are allocated in POOL.
+ */
+static void
+dump_command_metrics(svn_stringbuf_t *buffer,
+                     metrics_t *metrics,
+                     apr_pool_t *pool)
+{
+  apr_hash_index_t *hi;
+
+  svn_stringbuf_appendcstr(buffer,
+      "# HELP svnserve_command_duration_seconds"
+      " Wall-clock time spent in ra_svn command handlers.\n"
+      "# TYPE svnserve_command_duration_seconds histogram\n");
+
+  svn_error_clear(svn_mutex__lock(metrics->mutex));
+
+  for (hi = apr_hash_first(pool, metrics->commands);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *cmdname = apr_hash_this_key(hi);
+      command_metrics_t *entry = apr_hash_this_val(hi);
+      apr_uint64_t cumulative = 0;
+      apr_size_t i;
+
+      for (i = 0; i < NUM_FINITE_BUCKETS; i++)
+        {
+          cumulative += entry->buckets[i];
+          svn_stringbuf_appendcstr(buffer,
+              apr_psprintf(pool,
+                           "svnserve_command_duration_seconds_bucket"
+                           "{command=\"%s\",le=\"%s\"} %" APR_UINT64_T_FMT
+                           "\n",
+                           cmdname, bucket_labels[i], cumulative));
+        }
+
+      svn_stringbuf_appendcstr(buffer,
+          apr_psprintf(pool,
+                       "svnserve_command_duration_seconds_bucket"
+                       "{command=\"%s\",le=\"+Inf\"} %" APR_UINT64_T_FMT "\n"
+                       "svnserve_command_duration_seconds_sum"
+                       "{command=\"%s\"} %f\n"
+                       "svnserve_command_duration_seconds_count"
+                       "{command=\"%s\"} %" APR_UINT64_T_FMT "\n",
+                       cmdname, entry->count,
+                       cmdname, (double)entry->sum / 1000000.0,
+                       cmdname, entry->count));
+    }
+
+  svn_error_clear(svn_mutex__unlock(metrics->mutex, SVN_NO_ERROR));
+}
+
+/* Append the aggregated statistics of the global membuffer cache - the
+ * backend of all FSFS caches in this process - to BUFFER in Prometheus
+ * exposition format.  Temporaries are allocated in POOL.
+ */
+static void
+dump_cache_metrics(svn_stringbuf_t *buffer,
+                   apr_pool_t *pool)
+{
+  svn_cache__info_t *info = svn_cache__membuffer_get_global_info(pool);
+
+  if (!info)
+    return;
+
+  svn_stringbuf_appendcstr(buffer,
+      apr_psprintf(pool,
+          "# HELP svnserve_cache_gets_total"
+          " Lookups in the global membuffer cache.\n"
+          "# TYPE svnserve_cache_gets_total counter\n"
+          "svnserve_cache_gets_total %" APR_UINT64_T_FMT "\n"
+          "# HELP svnserve_cache_hits_total"
+          " Lookups in the global membuffer cache that returned data.\n"
+          "# TYPE svnserve_cache_hits_total counter\n"
+          "svnserve_cache_hits_total %" APR_UINT64_T_FMT "\n"
+          "# HELP svnserve_cache_sets_total"
+          " Insertions into the global membuffer cache.\n"
+          "# TYPE svnserve_cache_sets_total counter\n"
+          "svnserve_cache_sets_total %" APR_UINT64_T_FMT "\n"
+          "# HELP svnserve_cache_used_bytes"
+          " Bytes currently stored in the global membuffer cache.\n"
+          "# TYPE svnserve_cache_used_bytes gauge\n"
+          "svnserve_cache_used_bytes %" APR_UINT64_T_FMT "\n"
+          "# HELP svnserve_cache_total_bytes"
+          " Memory reserved for the global membuffer cache.\n"
+          "# TYPE svnserve_cache_total_bytes gauge\n"
+          "svnserve_cache_total_bytes %" APR_UINT64_T_FMT "\n"
+          "# HELP svnserve_cache_used_entries"
+          " Entries currently in the global membuffer cache.\n"
+          "# TYPE svnserve_cache_used_entries gauge\n"
+          "svnserve_cache_used_entries %" APR_UINT64_T_FMT "\n",
+          info->gets, info->hits, info->sets,
+          info->used_size, info->total_size, info->used_entries));
+}
+
+/* Rewrite the dump file of METRICS with the current counter values.
+ * Temporaries are allocated in POOL.
+ */
+static void
+dump_metrics(metrics_t *metrics,
+             apr_pool_t *pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+
+  dump_command_metrics(buffer, metrics, pool);
+  dump_cache_metrics(buffer, pool);
+
+  /* Scrapers must never see a partially written file. */
+  svn_error_clear(svn_io_write_atomic2(metrics->filename,
+                                       buffer->data, buffer->len,
+                                       NULL, FALSE, pool));
+}
+
+#if APR_HAS_THREADS
+
+/* Thread routine rewriting the dump file of METRICS in regular
+ * intervals until METRICS->TERMINATING gets set.
+ */
+static void * APR_THREAD_FUNC dumper_thread(apr_thread_t *thread,
+                                            void *data)
+{
+  metrics_t *metrics = data;
+  svn_boolean_t terminating = FALSE;
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  while (!terminating)
+    {
+      apr_sleep(METRICS_DUMP_INTERVAL);
+
+      svn_error_clear(svn_mutex__lock(metrics->mutex));
+      terminating = metrics->terminating;
+      svn_error_clear(svn_mutex__unlock(metrics->mutex, SVN_NO_ERROR));
+
+      dump_metrics(metrics, pool);
+      svn_pool_clear(pool);
+    }
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(thread, APR_SUCCESS);
+
+  return NULL;
+}
+
+/* Pool cleanup handler: stop the dump thread of the metrics_t given in
+ * DATA, writing a final dump.
+ */
+static apr_status_t
+terminate_dumper(void *data)
+{
+  metrics_t *metrics = data;
+  apr_status_t result;
+
+  svn_error_clear(svn_mutex__lock(metrics->mutex));
+  metrics->terminating = TRUE;
+  svn_error_clear(svn_mutex__unlock(metrics->mutex, SVN_NO_ERROR));
+
+  apr_thread_join(&result, metrics->dumper);
+
+  return APR_SUCCESS;
+}
+
+#endif
+
+void
+metrics__start_dumping(metrics_t *metrics,
+                       apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  apr_status_t status;
+  apr_threadattr_t *tattr;
+
+  if (!metrics || metrics->dumper)
+    return;
+
+  status = apr_threadattr_create(&tattr, pool);
+  if (!status)
+    status = apr_thread_create(&metrics->dumper, tattr, dumper_thread,
+                               metrics, pool);
+  if (status)
+    return;
+
+  apr_pool_cleanup_register(pool, metrics, terminate_dumper,
+                            apr_pool_cleanup_null);
+#endif
+}
@@ -0,0 +1,79 @@
+/*
+ * metrics.h : Public definitions for the svnserve metrics collector
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "svn_types.h"
+
+
+
+/* Opaque svnserve metrics collector.  It aggregates per-command call
+ * counts and latency histograms as well as global cache statistics and
+ * periodically rewrites them to a text file in Prometheus exposition
+ * format.  All member functions are thread-safe.
+ */
+typedef struct metrics_t metrics_t;
+
+/* In POOL, create a metrics collector that will dump its data to
+ * FILENAME and return it in *METRICS.  Collection starts immediately;
+ * the dump file only gets written once metrics__start_dumping() has
+ * been called.
+ */
+svn_error_t *
+metrics__create(metrics_t **metrics,
+                const char *filename,
+                apr_pool_t *pool);
+
+/* Account for one execution of the ra_svn command CMDNAME that took
+ * DURATION to complete.  BATON is the metrics_t object.  The signature
+ * matches svn_ra_svn__command_hook_t, so this can be registered with
+ * svn_ra_svn__set_command_hook() directly.
+ */
+void
+metrics__record_command(const char *cmdname,
+                        apr_time_t duration,
+                        void *baton);
+
+/* Start the thread, allocated in POOL, that periodically rewrites the
+ * dump file of METRICS.  A final dump gets written when POOL is being
+ * cleaned up.  POOL must not get destroyed before the pool METRICS was
+ * created in.
+ *
+ * Call this at most once per process and only after any fork(), because
+ * the dump thread does not survive one.  This is a no-op if APR does
+ * not support threads or the thread cannot be created.
+ */
+void
+metrics__start_dumping(metrics_t *metrics,
+                       apr_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* METRICS_H */
@@ -32,6 +32,7 @@
 #include <apr_general.h>
 #include <apr_lib.h>
 #include <apr_strings.h>
+#include <apr_thread_proc.h>
 
 #include "svn_compat.h"
 #include "svn_private_config.h"  /* For SVN_PATH_LOCAL_SEPARATOR */
@@ -62,6 +63,7 @@
 
 #include "server.h"
 #include "logger.h"
+#include "metrics.h"
 
 typedef struct commit_callback_baton_t {
   apr_pool_t *pool;
@@ -86,6 +88,7 @@ typedef struct report_driver_baton_t {
 typedef struct log_baton_t {
   const char *fs_path;
   svn_ra_svn_conn_t *conn;
+  server_baton_t *server;
   int stack_depth;
 
   /* Set to TRUE when at least one changed path has been sent. */
@@ -94,6 +97,7 @@ typedef struct log_baton_t {
 
 typedef struct file_revs_baton_t {
   svn_ra_svn_conn_t *conn;
+  server_baton_t *server;
   apr_pool_t *pool;  /* Pool provided in the handler call. */
 } file_revs_baton_t;
 
@@ -574,6 +578,19 @@ current_access(server_baton_t *b)
                               : b->repository->anon_access;
 }
 
+/* How long an authentication resumption ticket issued with a CRAM-MD5
+   success notification remains valid. */
+#define AUTH_TICKET_LIFETIME apr_time_from_sec(3600)
+
+/* Return whether resumption tickets may be used on CONN for B, i.e.
+   whether we have a secret and the client understands the mechanism. */
+static svn_boolean_t
+auth_tickets_enabled(svn_ra_svn_conn_t *conn, server_baton_t *b)
+{
+  return b->auth_ticket_secret != NULL
+      && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_AUTH_TICKET);
+}
+
 /* Send authentication mechs for ACCESS_TYPE to the client.  If NEEDS_USERNAME
    is true, don't send anonymous mech even if that would give the desired
    access. */
@@ -586,7 +603,11 @@ static svn_error_t *send_mechs(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   if (b->client_info->tunnel_user && b->repository->auth_access >= required)
     SVN_ERR(svn_ra_svn__write_word(conn, pool, "EXTERNAL"));
   if (b->repository->pwdb && b->repository->auth_access >= required)
-    SVN_ERR(svn_ra_svn__write_word(conn, pool, "CRAM-MD5"));
+    {
+      if (auth_tickets_enabled(conn, b))
+        SVN_ERR(svn_ra_svn__write_word(conn, pool, "TICKET"));
+      SVN_ERR(svn_ra_svn__write_word(conn, pool, "CRAM-MD5"));
+    }
   return SVN_NO_ERROR;
 }
 
@@ -676,11 +697,40 @@ static svn_error_t *auth(svn_boolean_t *success,
       return SVN_NO_ERROR;
     }
 
+  if (b->repository->auth_access >= required
+      && b->repository->pwdb && strcmp(mech, "TICKET") == 0
+      && auth_tickets_enabled(conn, b) && mecharg)
+    {
+      if (svn_ra_svn__check_auth_ticket(&user, mecharg,
+                                        b->repository->realm,
+                                        b->auth_ticket_secret,
+                                        scratch_pool))
+        {
+          b->client_info->user = apr_pstrdup(b->pool, user);
+          SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w()",
+                                          "success"));
+          *success = TRUE;
+          return SVN_NO_ERROR;
+        }
+
+      /* The client falls back to one of the other mechanisms. */
+      return svn_ra_svn__write_tuple(conn, scratch_pool, "w(c)", "failure",
+                                     "Authentication ticket invalid or"
+                                     " expired");
+    }
+
   if (b->repository->auth_access >= required
       && b->repository->pwdb && strcmp(mech, "CRAM-MD5") == 0)
     {
-      SVN_ERR(svn_ra_svn_cram_server(conn, scratch_pool, b->repository->pwdb,
-                                     &user, success));
+      const char *secret = auth_tickets_enabled(conn, b)
+                         ? b->auth_ticket_secret
+                         : NULL;
+
+      SVN_ERR(svn_ra_svn__cram_server2(conn, scratch_pool,
+                                       b->repository->pwdb, secret,
+                                       b->repository->realm,
+                                       AUTH_TICKET_LIFETIME,
+                                       &user, success));
       b->client_info->user = apr_pstrdup(b->pool, user);
       return SVN_NO_ERROR;
     }
@@ -1711,6 +1761,129 @@ get_file(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+get_files(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton)
+{
+  server_baton_t *b = baton;
+  svn_ra_svn__list_t *path_list;
+  apr_array_header_t *full_paths;
+  svn_revnum_t rev;
+  svn_fs_root_t *root;
+  apr_pool_t *iterpool;
+  svn_error_t *err, *write_err;
+  int i;
+
+  /* Parse arguments. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "l(?r)", &path_list, &rev));
+
+  full_paths = apr_array_make(pool, path_list->nelts, sizeof(const char *));
+  for (i = 0; i < path_list->nelts; i++)
+    {
+      svn_ra_svn__item_t *item = &SVN_RA_SVN__LIST_ITEM(path_list, i);
+      const char *canonical_path, *full_path;
+
+      if (item->kind != SVN_RA_SVN_STRING)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Path is not a string"));
+      SVN_ERR(svn_relpath_canonicalize_safe(&canonical_path, NULL,
+                                            item->u.string.data, pool, pool));
+      full_path = svn_fspath__join(b->repository->fs_path->data,
+                                   canonical_path, pool);
+      APR_ARRAY_PUSH(full_paths, const char *) = full_path;
+    }
+
+  /* Check authorizations.  Since we can only send a single auth reply
+     per request, we request blanket read access up front and fail the
+     whole command if any particular path is not readable. */
+  SVN_ERR(must_have_access(conn, pool, b, svn_authz_read, NULL, FALSE));
+  for (i = 0; i < full_paths->nelts; i++)
+    {
+      const char *full_path = APR_ARRAY_IDX(full_paths, i, const char *);
+
+      if (! lookup_access(pool, b, svn_authz_read, full_path, FALSE))
+        SVN_CMD_ERR(error_create_and_log(SVN_ERR_RA_NOT_AUTHORIZED,
+                                         NULL, NULL, b));
+    }
+
+  if (!SVN_IS_VALID_REVNUM(rev))
+    SVN_CMD_ERR(svn_fs_youngest_rev(&rev, b->repository->fs, pool));
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__get_files(full_paths, rev, pool)));
+
+  SVN_CMD_ERR(svn_fs_revision_root(&root, b->repository->fs, rev, pool));
+
+  /* Send successful command response with the revision. */
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, "r", rev));
+
+  /* Now send one entry per path: a tuple with the checksum, followed by
+     the contents as a series of strings terminated by the empty string.
+     An error ends the list early; the second command response below
+     reports it to the client. */
+  iterpool = svn_pool_create(pool);
+  err = SVN_NO_ERROR;
+  for (i = 0; i < full_paths->nelts && !err; i++)
+    {
+      const char *full_path = APR_ARRAY_IDX(full_paths, i, const char *);
+      svn_checksum_t *checksum;
+      svn_stream_t *contents;
+      svn_string_t write_str;
+      char buf[4096];
+      apr_size_t len;
+
+      svn_pool_clear(iterpool);
+
+      err = svn_fs_file_checksum(&checksum, svn_checksum_md5, root,
+                                 full_path, TRUE, iterpool);
+      if (!err)
+        err = svn_fs_file_contents(&contents, root, full_path, iterpool);
+      if (err)
+        break;
+
+      SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "(c)",
+                                      svn_checksum_to_cstring_display(
+                                        checksum, iterpool)));
+
+      while (1)
+        {
+          len = sizeof(buf);
+          err = svn_stream_read_full(contents, buf, &len);
+          if (err)
+            break;
+          if (len > 0)
+            {
+              write_str.data = buf;
+              write_str.len = len;
+              SVN_ERR(svn_ra_svn__write_string(conn, iterpool, &write_str));
+            }
+          if (len < sizeof(buf))
+            {
+              err = svn_stream_close(contents);
+              break;
+            }
+        }
+
+      /* Terminate the contents even if reading them failed so that the
+         client can still parse the early "done" below. */
+      SVN_ERR(svn_ra_svn__write_cstring(conn, iterpool, ""));
+    }
+  svn_pool_destroy(iterpool);
+
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+
+  return SVN_NO_ERROR;
+}
+
 /* Translate all the words in DIRENT_FIELDS_LIST into the flags in
  * DIRENT_FIELDS_P.  If DIRENT_FIELDS_LIST is NULL, set all flags. */
 static svn_error_t *
@@ -2299,6 +2472,33 @@ get_mergeinfo(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Bulk scanning commands (log, blame) stream arbitrarily many items for
+   a single request and would otherwise occupy their thread without ever
+   reaching a natural scheduling point.  To keep short interactive
+   commands on other connections responsive, we yield the processor at
+   item boundaries - rarely while the connection is still within its
+   "small request" budget, frequently once it has exceeded it. */
+#define BULK_YIELD_INTERVAL 1024
+#define BULK_YIELD_BUDGET (64 * BULK_YIELD_INTERVAL)
+#define BULK_YIELD_INTERVAL_THROTTLED 64
+
+/* Account for one item streamed by a bulk scanning command on the
+   connection behind B and yield the processor at batch boundaries.
+   No-op in thread-less builds where connections are separate processes
+   and the kernel schedules them. */
+static void
+bulk_scan_tick(server_baton_t *b)
+{
+#if APR_HAS_THREADS
+  apr_uint64_t interval = b->bulk_work < BULK_YIELD_BUDGET
+                        ? BULK_YIELD_INTERVAL
+                        : BULK_YIELD_INTERVAL_THROTTLED;
+
+  if (++b->bulk_work % interval == 0)
+    apr_thread_yield();
+#endif
+}
+
 /* Send a changed paths list entry to the client.
    This implements svn_repos_path_change_receiver_t. */
 static svn_error_t *
@@ -2311,6 +2511,8 @@ path_change_receiver(void *baton,
   log_baton_t *b = baton;
   svn_ra_svn_conn_t *conn = b->conn;
 
+  bulk_scan_tick(b->server);
+
   /* Sanitize and convert change kind to ra-svn level action.
 
      Pushing that conversion down into libsvn_ra_svn would add yet another
@@ -2355,6 +2557,8 @@ revision_receiver(void *baton,
   const svn_string_t *author, *date, *message;
   unsigned revprop_count;
 
+  bulk_scan_tick(b->server);
+
   if (log_entry->revision == SVN_INVALID_REVNUM)
     {
       /* If the stack depth is zero, we've seen the last revision, so don't
@@ -2514,6 +2718,7 @@ log_cmd(svn_ra_svn_conn_t *conn,
   /* Get logs.  (Can't report errors back to the client at this point.) */
   lb.fs_path = b->repository->fs_path->data;
   lb.conn = conn;
+  lb.server = b;
   lb.stack_depth = 0;
   lb.started = FALSE;
   err = svn_repos_get_logs5(b->repository->repos, full_paths, start_rev,
@@ -2862,6 +3067,8 @@ static svn_error_t *file_rev_handler(void *baton, const char *path,
   file_revs_baton_t *frb = baton;
   svn_stream_t *stream;
 
+  bulk_scan_tick(frb->server);
+
   SVN_ERR(svn_ra_svn__write_tuple(frb->conn, pool, "cr(!",
                                   path, rev));
   SVN_ERR(svn_ra_svn__write_proplist(frb->conn, pool, rev_props));
@@ -2930,6 +3137,7 @@ get_file_revs(svn_ra_svn_conn_t *conn,
                                              pool)));
 
   frb.conn = conn;
+  frb.server = b;
   frb.pool = NULL;
 
   err = svn_repos_get_file_revs2(b->repository->repos, full_path, start_rev,
@@ -3790,6 +3998,7 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "rev-prop",        rev_prop },
   { "commit",          commit },
   { "get-file",        get_file },
+  { "get-files",       get_files },
   { "get-dir",         get_dir },
   { "update",          update },
   { "switch",          switch_cmd },
@@ -4231,19 +4440,29 @@ construct_server_baton(server_baton_t **baton,
   b->read_only = params->read_only;
   b->pool = conn_pool;
   b->vhost = params->vhost;
+  b->auth_ticket_secret = params->auth_ticket_secret;
 
   b->logger = params->logger;
   b->client_info = get_client_info(conn, params, conn_pool);
 
   /* Send greeting.  We don't support version 1 any more, so we can
    * send an empty mechlist. */
+  /* accepts-svndiff3 is only advertised when this server build can
+   * actually decode it, i.e. when compiled against zstd. */
   if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+#ifdef SVN_HAVE_ZSTD
+                                           "nn()(wwwwwwwwwwwwwwwww)",
+#else
+                                           "nn()(wwwwwwwwwwwwwwww)",
+#endif
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
                                            SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+#ifdef SVN_HAVE_ZSTD
+                                           SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED,
+#endif
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
                                            SVN_RA_SVN_CAP_COMMIT_REVPROPS,
                                            SVN_RA_SVN_CAP_DEPTH,
@@ -4253,11 +4472,14 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_AUTH_TICKET,
+                                           SVN_RA_SVN_CAP_GET_FILES,
+                                           SVN_RA_SVN_CAP_CHANGE_NODE_PROPS
                                            ));
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4269,7 +4491,10 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_AUTH_TICKET,
+                                           SVN_RA_SVN_CAP_GET_FILES,
+                                           SVN_RA_SVN_CAP_CHANGE_NODE_PROPS
                                            ));
 
   /* Read client response, which we assume to be in version 2 format:
@@ -4467,6 +4692,15 @@ serve_interruptable(svn_boolean_t *terminate_p,
           /* It's not a fatal error if we cannot enable keep-alives. */
         }
 
+      /* Disable Nagle's algorithm.  Responses leave the marshaller as
+       * complete buffers or explicitly flushed messages, so delaying
+       * those segments only adds latency to every exchange. */
+      ar = apr_socket_opt_set(connection->usock, APR_TCP_NODELAY, 1);
+      if (ar)
+        {
+          /* It's not a fatal error if we cannot disable Nagle. */
+        }
+
       /* create the connection, configure ports etc. */
       connection->conn
         = svn_ra_svn_create_conn5(connection->usock, NULL, NULL,
@@ -4477,6 +4711,11 @@ serve_interruptable(svn_boolean_t *terminate_p,
                                   connection->params->max_response_size,
                                   connection->pool);
 
+      if (connection->params->metrics)
+        svn_ra_svn__set_command_hook(connection->conn,
+                                     metrics__record_command,
+                                     connection->params->metrics);
+
       /* Construct server baton and open the repository for the first time. */
       err = construct_server_baton(&connection->baton, connection->conn,
                                    connection->params, pool);
@@ -4535,6 +4774,10 @@ svn_error_t *serve(svn_ra_svn_conn_t *conn,
 {
   server_baton_t *baton = NULL;
 
+  if (params->metrics)
+    svn_ra_svn__set_command_hook(conn, metrics__record_command,
+                                 params->metrics);
+
   SVN_ERR(construct_server_baton(&baton, conn, params, pool));
   return svn_ra_svn__handle_commands2(conn, pool, main_commands, baton, FALSE);
 }
@@ -90,6 +90,11 @@ typedef struct server_baton_t {
                               May be NULL even if log_file is not. */
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
+  const char *auth_ticket_secret; /* Key for auth resumption tickets;
+                                     NULL disables the TICKET mech. */
+  apr_uint64_t bulk_work; /* Number of items streamed by bulk scanning
+                             commands (log, blame) on this connection.
+                             Used for cooperative yielding. */
   apr_pool_t *pool;
 } server_baton_t;
 
@@ -124,6 +129,14 @@ typedef struct serve_params_t {
   /* logging data structure; possibly NULL. */
   struct logger_t *logger;
 
+  /* metrics collector; possibly NULL. */
+  struct metrics_t *metrics;
+
+  /* Per-process key for authentication resumption tickets.  All
+     processes serving the same address must share it.  NULL disables
+     the TICKET mechanism. */
+  const char *auth_ticket_secret;
+
   /* all configurations should be opened through this factory */
   svn_repos__config_pool_t *config_pool;
 
@@ -31,6 +31,7 @@
 #include <apr_signal.h>
 #include <apr_thread_proc.h>
 #include <apr_portable.h>
+#include <apr_poll.h>
 
 #include <locale.h>
 
@@ -49,13 +50,16 @@
 #include "svn_version.h"
 #include "svn_io.h"
 #include "svn_hash.h"
+#include "svn_user.h"
 
 #include "svn_private_config.h"
 
 #include "private/svn_dep_compat.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
 #include "private/svn_subr_private.h"
 
 #if APR_HAS_THREADS
@@ -68,8 +72,22 @@
 #include <unistd.h>   /* For getpid() */
 #endif
 
+#ifndef WIN32
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* The tunnel broker passes the stdio descriptors of a 'svnserve -t'
+   process to a long-running sibling over a Unix domain socket. */
+#if defined(AF_UNIX) && defined(SCM_RIGHTS)
+#define SVN_HAVE_TUNNEL_BROKER
+#endif
+#endif
+
 #include "server.h"
 #include "logger.h"
+#include "metrics.h"
 
 /* The strategy for handling incoming connections.  Some of these may be
    unavailable due to platform limitations. */
@@ -85,6 +103,7 @@ enum run_mode {
   run_mode_inetd,
   run_mode_daemon,
   run_mode_tunnel,
+  run_mode_tunnel_broker,
   run_mode_listen_once,
   run_mode_service
 };
@@ -145,6 +164,13 @@ enum run_mode {
  */
 #define THREADPOOL_THREAD_IDLE_LIMIT 1000000
 
+/* Capacity of the pollset in which idle connections get parked while the
+ * server is busy.  Parked connections hold on to their connection pool
+ * but no thread and no thread pool task, so this may safely exceed
+ * THREADPOOL_MAX_SIZE by a wide margin.
+ */
+#define IDLE_POLLSET_SIZE 16384
+
 /* Number of client to server connections that may concurrently in the
  * TCP 3-way handshake state, i.e. are in the process of being created.
  *
@@ -222,6 +248,10 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_ACCEPTORS       277
+#define SVNSERVE_OPT_METRICS_FILE    278
+#define SVNSERVE_OPT_TUNNEL_BROKER   279
+#define SVNSERVE_OPT_CACHE_SEGMENTS  280
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -325,6 +355,20 @@ static const apr_getopt_option_t svnserve__options[] =
         "Default is yes.\n"
         "                             "
         "[used for FSFS repositories only]")},
+    {"cache-segments", SVNSERVE_OPT_CACHE_SEGMENTS, 1,
+     N_("number of segments to split the in-memory cache\n"
+        "                             "
+        "into.  Each segment uses a separate lock, so\n"
+        "                             "
+        "larger values reduce lock contention on servers\n"
+        "                             "
+        "with many CPU cores.  Will be rounded down to a\n"
+        "                             "
+        "power of two.\n"
+        "                             "
+        "Default is 0, i.e. derive from the cache size.\n"
+        "                             "
+        "[used for FSFS and FSX repositories only]")},
     {"client-speed", SVNSERVE_OPT_CLIENT_SPEED, 1,
      N_("Optimize network handling based on the assumption\n"
         "                             "
@@ -362,6 +406,22 @@ static const apr_getopt_option_t svnserve__options[] =
         "                             "
         "Default is " APR_STRINGIFY(THREADPOOL_MAX_SIZE) "."
         ONLY_AVAILABLE_WITH_THEADS)},
+#endif
+#if APR_HAS_FORK
+    {"acceptors",        SVNSERVE_OPT_ACCEPTORS, 1,
+     N_("Number of acceptor processes.  Each acceptor\n"
+        "                             "
+        "binds its own listening socket with SO_REUSEPORT,\n"
+        "                             "
+        "so the kernel spreads incoming connections across\n"
+        "                             "
+        "all of them instead of serializing them through\n"
+        "                             "
+        "a single accept loop.  Requires SO_REUSEPORT\n"
+        "                             "
+        "support; default is 1.\n"
+        "                             "
+        "[mode: daemon]")},
 #endif
     {"max-request-size", SVNSERVE_OPT_MAX_REQUEST, 1,
      N_("Maximum acceptable size of a client request in MB.\n"
@@ -396,6 +456,16 @@ static const apr_getopt_option_t svnserve__options[] =
         "process (useful for debugging)")},
     {"log-file",         SVNSERVE_OPT_LOG_FILE, 1,
      N_("svnserve log file")},
+#if APR_HAS_THREADS
+    {"metrics-file",     SVNSERVE_OPT_METRICS_FILE, 1,
+     N_("Periodically rewrite this file with per-command\n"
+        "                             "
+        "call counts, latency histograms and cache\n"
+        "                             "
+        "statistics in Prometheus exposition format.\n"
+        "                             "
+        "[mode: daemon with threads]")},
+#endif
     {"pid-file",         SVNSERVE_OPT_PID_FILE, 1,
 #ifdef WIN32
      N_("write server process ID to file ARG\n"
@@ -410,6 +480,20 @@ static const apr_getopt_option_t svnserve__options[] =
      N_("tunnel username (default is current uid's name)\n"
         "                             "
         "[mode: tunnel]")},
+#ifndef WIN32
+    {"tunnel-broker",    SVNSERVE_OPT_TUNNEL_BROKER, 1,
+     N_("with --tunnel, hand the connection over to the\n"
+        "                             "
+        "broker listening on the Unix domain socket ARG\n"
+        "                             "
+        "instead of serving it in this process; if no\n"
+        "                             "
+        "broker is listening, serve as usual.  Without\n"
+        "                             "
+        "--tunnel, run as that broker daemon, keeping\n"
+        "                             "
+        "caches warm across tunnel connections.")},
+#endif
     {"help",             'h', 0, N_("display this help")},
     {"virtual-host",     SVNSERVE_OPT_VIRTUAL_HOST, 0,
      N_("virtual host mode (look for repo in directory\n"
@@ -522,6 +606,338 @@ static apr_status_t redirect_stdout(void *arg)
   return apr_file_dup2(out_file, err_file, pool);
 }
 
+#ifdef SVN_HAVE_TUNNEL_BROKER
+
+/* Fill ADDR with the Unix domain socket address for BROKER_PATH.
+ * Error out if the path does not fit the address structure. */
+static svn_error_t *
+broker_sockaddr(struct sockaddr_un *addr,
+                const char *broker_path)
+{
+  if (strlen(broker_path) >= sizeof(addr->sun_path))
+    return svn_error_createf(SVN_ERR_BAD_FILENAME, NULL,
+                             _("Tunnel broker socket path '%s' is too long"),
+                             broker_path);
+
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  strcpy(addr->sun_path, broker_path);
+
+  return SVN_NO_ERROR;
+}
+
+/* Try to hand the tunnel connection on our stdin / stdout over to the
+ * broker listening on the Unix domain socket BROKER_PATH, announcing
+ * TUNNEL_USER as the authenticated user.  Set *HANDED_OFF accordingly.
+ *
+ * An unreachable broker is not an error:  the caller simply serves the
+ * connection in this process, as without a broker.  Once the handoff
+ * succeeded, block until the broker closes the control connection, i.e.
+ * until the session ended, so that the SSH channel stays up.
+ */
+static svn_error_t *
+hand_off_to_broker(svn_boolean_t *handed_off,
+                   const char *broker_path,
+                   const char *tunnel_user,
+                   apr_pool_t *pool)
+{
+  int sock;
+  struct sockaddr_un addr;
+  struct msghdr msg = { 0 };
+  struct iovec iov;
+  union {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE(2 * sizeof(int))];
+  } cmsg_buf;
+  struct cmsghdr *cmsg;
+  int fds[2] = { STDIN_FILENO, STDOUT_FILENO };
+  ssize_t sent;
+  char dummy;
+
+  *handed_off = FALSE;
+
+  SVN_ERR(broker_sockaddr(&addr, broker_path));
+
+  sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0)
+    return SVN_NO_ERROR;
+
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+      close(sock);
+      return SVN_NO_ERROR;
+    }
+
+  iov.iov_base = (void *)tunnel_user;
+  iov.iov_len = strlen(tunnel_user) + 1;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cmsg_buf.buf;
+  msg.msg_controllen = CMSG_SPACE(2 * sizeof(int));
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+  memcpy(CMSG_DATA(cmsg), fds, 2 * sizeof(int));
+
+  do
+    sent = sendmsg(sock, &msg, 0);
+  while (sent < 0 && errno == EINTR);
+
+  if (sent < 0)
+    {
+      close(sock);
+      return SVN_NO_ERROR;
+    }
+
+  /* The broker now serves duplicates of our stdio descriptors.  Wait
+   * for it to close the control connection at the end of the session;
+   * exiting earlier would make the login agent tear down the tunnel. */
+  while (TRUE)
+    {
+      ssize_t received = read(sock, &dummy, 1);
+
+      if (received < 0 && errno == EINTR)
+        continue;
+      if (received <= 0)
+        break;
+    }
+
+  close(sock);
+  *handed_off = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* A tunnel connection handed over to the broker. */
+typedef struct broker_connection_t
+{
+  /* private copy of the server-global parameters with the connection's
+     tunnel user filled in */
+  serve_params_t params;
+
+  /* stdio descriptors received from the 'svnserve -t' process */
+  int stdin_fd;
+  int stdout_fd;
+
+  /* control connection to that process; closing it tells the process
+     that the session ended and it may exit */
+  int control_fd;
+
+  /* pool holding this structure; see connection_t for the ref-counting
+     scheme used to release it */
+  apr_pool_t *pool;
+  svn_atomic_t ref_count;
+} broker_connection_t;
+
+/* Release a reference to CONNECTION, destroying its pool with the last
+ * reference. */
+static void
+release_broker_connection(broker_connection_t *connection)
+{
+  if (svn_atomic_dec(&connection->ref_count) == 0)
+    svn_pool_destroy(connection->pool);
+}
+
+/* Serve the brokered tunnel connection CONNECTION just like 'svnserve -t'
+ * would have, reading from its stdin descriptor and writing to its stdout
+ * descriptor. */
+static svn_error_t *
+broker_serve_connection(broker_connection_t *connection,
+                        apr_pool_t *pool)
+{
+  apr_file_t *in_file, *out_file;
+  apr_os_file_t os_file;
+  svn_stream_t *in_stream, *out_stream;
+  svn_ra_svn_conn_t *conn;
+  apr_status_t status;
+
+  os_file = connection->stdin_fd;
+  status = apr_os_file_put(&in_file, &os_file, APR_READ, pool);
+  if (!status)
+    {
+      os_file = connection->stdout_fd;
+      status = apr_os_file_put(&out_file, &os_file, APR_WRITE, pool);
+    }
+  if (status)
+    return svn_error_wrap_apr(status,
+                              _("Can't wrap brokered tunnel connection"));
+
+  in_stream = svn_stream_from_aprfile2(in_file, TRUE, pool);
+  out_stream = svn_stream_from_aprfile2(out_file, TRUE, pool);
+
+  conn = svn_ra_svn_create_conn5(NULL, in_stream, out_stream,
+                                 connection->params.compression_level,
+                                 connection->params.zero_copy_limit,
+                                 connection->params.error_check_interval,
+                                 connection->params.max_request_size,
+                                 connection->params.max_response_size,
+                                 pool);
+
+  return svn_error_trace(serve(conn, &connection->params, pool));
+}
+
+/* Thread routine serving the brokered tunnel connection DATA.  Also
+ * called directly when threads are unavailable. */
+static void * APR_THREAD_FUNC
+broker_serve_thread(apr_thread_t *tid, void *data)
+{
+  broker_connection_t *connection = data;
+  svn_error_t *err = broker_serve_connection(connection, connection->pool);
+
+  if (err)
+    {
+      logger__log_error(connection->params.logger, err, NULL, NULL);
+      svn_error_clear(err);
+    }
+
+  close(connection->stdin_fd);
+  close(connection->stdout_fd);
+  close(connection->control_fd);
+  release_broker_connection(connection);
+
+  return NULL;
+}
+
+/* Run the tunnel broker daemon:  accept handoffs from 'svnserve -t'
+ * processes on the Unix domain socket BROKER_PATH and serve them with
+ * the shared PARAMS, so that repository caches stay warm across tunnel
+ * connections instead of being rebuilt by every process start. */
+static svn_error_t *
+run_tunnel_broker(const char *broker_path,
+                  serve_params_t *params,
+                  apr_pool_t *pool)
+{
+  int listen_fd;
+  struct sockaddr_un addr;
+
+  SVN_ERR(broker_sockaddr(&addr, broker_path));
+
+  /* A socket file left behind by a previous broker would make bind()
+   * fail; nobody can be listening on it anymore. */
+  unlink(broker_path);
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+    return svn_error_wrap_apr(apr_get_netos_error(),
+                              _("Can't create tunnel broker socket"));
+
+  if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+      || listen(listen_fd, ACCEPT_BACKLOG) != 0)
+    return svn_error_wrap_apr(apr_get_netos_error(),
+                              _("Can't listen on tunnel broker socket '%s'"),
+                              broker_path);
+
+  while (TRUE)
+    {
+      int client_fd;
+      char user_buf[256];
+      struct msghdr msg = { 0 };
+      struct iovec iov;
+      union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+      } cmsg_buf;
+      struct cmsghdr *cmsg;
+      ssize_t received;
+      int fds[2] = { -1, -1 };
+      apr_pool_t *connection_pool;
+      broker_connection_t *connection;
+
+      do
+        client_fd = accept(listen_fd, NULL, NULL);
+      while (client_fd < 0 && errno == EINTR
+#if APR_HAVE_SIGACTION
+             && !sigtermint_seen
+#endif
+            );
+
+#if APR_HAVE_SIGACTION
+      if (sigtermint_seen)
+        {
+          if (client_fd >= 0)
+            close(client_fd);
+          break;
+        }
+#endif
+      if (client_fd < 0)
+        continue;
+
+      iov.iov_base = user_buf;
+      iov.iov_len = sizeof(user_buf) - 1;
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      msg.msg_control = cmsg_buf.buf;
+      msg.msg_controllen = sizeof(cmsg_buf.buf);
+
+      do
+        received = recvmsg(client_fd, &msg, 0);
+      while (received < 0 && errno == EINTR);
+
+      cmsg = (received > 0) ? CMSG_FIRSTHDR(&msg) : NULL;
+      if (cmsg && cmsg->cmsg_level == SOL_SOCKET
+          && cmsg->cmsg_type == SCM_RIGHTS
+          && cmsg->cmsg_len == CMSG_LEN(2 * sizeof(int)))
+        memcpy(fds, CMSG_DATA(cmsg), 2 * sizeof(int));
+
+      if (fds[0] < 0 || fds[1] < 0)
+        {
+          /* Malformed handoff; drop it. */
+          if (fds[0] >= 0)
+            close(fds[0]);
+          if (fds[1] >= 0)
+            close(fds[1]);
+          close(client_fd);
+          continue;
+        }
+
+      user_buf[received] = '\0';
+
+      connection_pool = svn_pool_create(pool);
+      connection = apr_pcalloc(connection_pool, sizeof(*connection));
+      connection->pool = connection_pool;
+      connection->params = *params;
+      connection->params.tunnel = TRUE;
+      connection->params.tunnel_user
+        = user_buf[0] ? apr_pstrdup(connection_pool, user_buf) : NULL;
+      connection->stdin_fd = fds[0];
+      connection->stdout_fd = fds[1];
+      connection->control_fd = client_fd;
+
+#if APR_HAS_THREADS
+      {
+        apr_threadattr_t *tattr;
+        apr_thread_t *tid;
+        apr_status_t status;
+
+        connection->ref_count = 2;
+        apr_threadattr_create(&tattr, connection_pool);
+        apr_threadattr_detach_set(tattr, 1);
+        status = apr_thread_create(&tid, tattr, broker_serve_thread,
+                                   connection, connection_pool);
+        if (status)
+          {
+            /* No thread; serve the connection in the accept loop. */
+            connection->ref_count = 1;
+            broker_serve_thread(NULL, connection);
+          }
+        else
+          release_broker_connection(connection);
+      }
+#else
+      connection->ref_count = 1;
+      broker_serve_thread(NULL, connection);
+#endif
+    }
+
+  close(listen_fd);
+  unlink(broker_path);
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* SVN_HAVE_TUNNEL_BROKER */
+
 /* Wait for the next client connection to come in from SOCK.  Allocate
  * the connection in a root pool from CONNECTION_POOLS and assign PARAMS.
  * Return the connection object in *CONNECTION.
@@ -632,6 +1048,31 @@ static svn_root_pools__t *connection_pools;
 /* The global thread pool serving all connections. */
 static apr_thread_pool_t *threads;
 
+/* The pollset in which idle connections get parked while the server is
+   busy.  Parked connections occupy neither a worker thread nor a task
+   queue entry; the watcher thread re-schedules them when data arrives
+   on their socket.  NULL if parking is unavailable on this system. */
+static apr_pollset_t *idle_pollset;
+
+/* Park CONNECTION in IDLE_POLLSET until its socket becomes readable.
+   Return FALSE if the connection could not be parked; the caller must
+   then keep it in the task queue instead. */
+static svn_boolean_t
+park_connection(connection_t *connection)
+{
+  apr_pollfd_t pfd = { 0 };
+
+  if (!idle_pollset)
+    return FALSE;
+
+  pfd.desc_type = APR_POLL_SOCKET;
+  pfd.desc.s = connection->usock;
+  pfd.reqevents = APR_POLLIN | APR_POLLHUP | APR_POLLERR;
+  pfd.client_data = connection;
+
+  return apr_pollset_add(idle_pollset, &pfd) == APR_SUCCESS;
+}
+
 /* Very simple load determination callback for serve_interruptable:
    With less than half the threads in THREADS in use, we can afford to
    wait in the socket read() function.  Otherwise, poll them round-robin. */
@@ -648,6 +1089,7 @@ is_busy(connection_t *connection)
 static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 {
   svn_boolean_t done;
+  svn_boolean_t has_command = TRUE;
   connection_t *connection = data;
   svn_error_t *err;
 
@@ -663,17 +1105,69 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
       svn_error_clear(err);
       done = TRUE;
     }
+
+  /* Unless the session ended, check whether the next command is already
+     waiting in our receive buffers.  If it isn't, the connection may be
+     parked instead of being cycled through the worker threads. */
+  if (!done)
+    {
+      err = svn_ra_svn__has_command(&has_command, &done, connection->conn,
+                                    pool);
+      if (err)
+        {
+          logger__log_error(connection->params->logger, err, NULL,
+                            get_client_info(connection->conn,
+                                            connection->params, pool));
+          svn_error_clear(err);
+          done = TRUE;
+        }
+    }
   svn_root_pools__release_pool(pool, connection_pools);
 
-  /* Close or re-schedule connection. */
+  /* Close, park or re-schedule the connection. */
   if (done)
     close_connection(connection);
-  else
+  else if (has_command || !park_connection(connection))
     apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
 
   return NULL;
 }
 
+/* Thread routine watching IDLE_POLLSET.  Hand parked connections back
+   to the worker pool as soon as their sockets become readable or get
+   closed by the peer. */
+static void * APR_THREAD_FUNC watch_idle_connections(apr_thread_t *tid,
+                                                     void *data)
+{
+  while (TRUE)
+    {
+      apr_int32_t descriptor_count;
+      const apr_pollfd_t *descriptors;
+      apr_int32_t i;
+      apr_status_t status;
+
+      status = apr_pollset_poll(idle_pollset, -1, &descriptor_count,
+                                &descriptors);
+      if (status)
+        {
+          /* EINTR is routine; don't spin on persistent poll failures. */
+          if (!APR_STATUS_IS_EINTR(status))
+            apr_sleep(apr_time_from_sec(1));
+          continue;
+        }
+
+      for (i = 0; i < descriptor_count; ++i)
+        {
+          connection_t *connection = descriptors[i].client_data;
+
+          apr_pollset_remove(idle_pollset, &descriptors[i]);
+          apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+        }
+    }
+
+  return NULL;
+}
+
 #endif
 
 /* Write the PID of the current process as a decimal number, followed by a
@@ -696,6 +1190,89 @@ static svn_error_t *write_pid_file(const char *filename, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Enable SO_REUSEPORT on the APR socket SOCK so that several processes
+ * can bind listening sockets to the same address and have the kernel
+ * distribute incoming connections between them.  Returns APR_ENOTIMPL
+ * on platforms without SO_REUSEPORT support.
+ */
+static apr_status_t
+enable_reuse_port(apr_socket_t *sock)
+{
+#ifdef SO_REUSEPORT
+  apr_os_sock_t fd;
+  int on = 1;
+  apr_status_t status = apr_os_sock_get(&fd, sock);
+
+  if (status)
+    return status;
+
+  if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)))
+    return apr_get_netos_error();
+
+  return APR_SUCCESS;
+#else
+  return APR_ENOTIMPL;
+#endif
+}
+
+/* Create a listening stream socket for address SA in *SOCK, allocated
+ * in POOL.  Enable address reuse and, if REUSE_PORT is set, SO_REUSEPORT
+ * before binding.
+ */
+static svn_error_t *
+create_listen_socket(apr_socket_t **sock,
+                     apr_sockaddr_t *sa,
+                     svn_boolean_t reuse_port,
+                     apr_pool_t *pool)
+{
+  apr_status_t status;
+
+#ifdef MAX_SECS_TO_LINGER
+  /* ### old APR interface */
+  status = apr_socket_create(sock, sa->family, SOCK_STREAM, pool);
+#else
+  status = apr_socket_create(sock, sa->family, SOCK_STREAM, APR_PROTO_TCP,
+                             pool);
+#endif
+  if (status)
+    {
+      return svn_error_wrap_apr(status, _("Can't create server socket"));
+    }
+
+  /* Prevents "socket in use" errors when server is killed and quickly
+   * restarted. */
+  status = apr_socket_opt_set(*sock, APR_SO_REUSEADDR, 1);
+  if (status)
+    {
+      return svn_error_wrap_apr(status, _("Can't set options on server socket"));
+    }
+
+  if (reuse_port)
+    {
+      status = enable_reuse_port(*sock);
+      if (status)
+        {
+          return svn_error_wrap_apr(status,
+                                    _("Can't enable port sharing on server "
+                                      "socket"));
+        }
+    }
+
+  status = apr_socket_bind(*sock, sa);
+  if (status)
+    {
+      return svn_error_wrap_apr(status, _("Can't bind server socket"));
+    }
+
+  status = apr_socket_listen(*sock, ACCEPT_BACKLOG);
+  if (status)
+    {
+      return svn_error_wrap_apr(status, _("Can't listen on server socket"));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Version compatibility check */
 static svn_error_t *
 check_lib_versions(void)
@@ -743,6 +1320,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_boolean_t cache_txdeltas = TRUE;
   svn_boolean_t cache_revprops = FALSE;
   svn_boolean_t use_block_read = FALSE;
+  apr_uint64_t cache_segments = 0;
   apr_uint16_t port = SVN_RA_SVN_PORT;
   const char *host = NULL;
   int family = APR_INET;
@@ -756,10 +1334,13 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   int handling_opt_count = 0;
   const char *config_filename = NULL;
   const char *pid_filename = NULL;
+  const char *tunnel_broker_path = NULL;
   const char *log_filename = NULL;
+  const char *metrics_filename = NULL;
   svn_node_kind_t kind;
   apr_size_t min_thread_count = THREADPOOL_MIN_SIZE;
   apr_size_t max_thread_count = THREADPOOL_MAX_SIZE;
+  int num_acceptors = 1;
 #ifdef SVN_HAVE_SASL
   SVN_ERR(cyrus_init(pool));
 #endif
@@ -783,6 +1364,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.cfg = NULL;
   params.compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
   params.logger = NULL;
+  params.metrics = NULL;
+  params.auth_ticket_secret = NULL;
   params.config_pool = NULL;
   params.fs_config = NULL;
   params.vhost = FALSE;
@@ -878,6 +1461,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           params.tunnel_user = arg;
           break;
 
+        case SVNSERVE_OPT_TUNNEL_BROKER:
+          SVN_ERR(svn_utf_cstring_to_utf8(&tunnel_broker_path, arg, pool));
+          tunnel_broker_path = svn_dirent_internal_style(tunnel_broker_path,
+                                                         pool);
+          SVN_ERR(svn_dirent_get_absolute(&tunnel_broker_path,
+                                          tunnel_broker_path, pool));
+          break;
+
         case 'X':
           if (run_mode != run_mode_listen_once)
             {
@@ -943,6 +1534,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           cache_nodeprops = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
 
+        case SVNSERVE_OPT_CACHE_SEGMENTS:
+          SVN_ERR(svn_cstring_atoui64(&cache_segments, arg));
+          break;
+
         case SVNSERVE_OPT_BLOCK_READ:
           use_block_read = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
@@ -980,6 +1575,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           max_thread_count = (apr_size_t)apr_strtoi64(arg, NULL, 0);
           break;
 
+#if APR_HAS_FORK
+        case SVNSERVE_OPT_ACCEPTORS:
+          num_acceptors = (int)apr_strtoi64(arg, NULL, 0);
+          if (num_acceptors < 1)
+            num_acceptors = 1;
+          break;
+#endif
+
 #ifdef WIN32
         case SVNSERVE_OPT_SERVICE:
           if (run_mode != run_mode_service)
@@ -1013,6 +1616,16 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           SVN_ERR(svn_dirent_get_absolute(&log_filename, log_filename, pool));
           break;
 
+#if APR_HAS_THREADS
+         case SVNSERVE_OPT_METRICS_FILE:
+          SVN_ERR(svn_utf_cstring_to_utf8(&metrics_filename, arg, pool));
+          metrics_filename = svn_dirent_internal_style(metrics_filename,
+                                                       pool);
+          SVN_ERR(svn_dirent_get_absolute(&metrics_filename,
+                                          metrics_filename, pool));
+          break;
+#endif
+
         }
     }
 
@@ -1029,6 +1642,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       return SVN_NO_ERROR;
     }
 
+  /* --tunnel-broker on its own selects broker daemon mode; combined
+   * with --tunnel it requests a handoff to a running broker. */
+  if (tunnel_broker_path && mode_opt_count == 0)
+    {
+      run_mode = run_mode_tunnel_broker;
+      mode_opt_count++;
+    }
+
   if (mode_opt_count != 1)
     {
       svn_error_clear(svn_cmdline_fputs(
@@ -1091,12 +1712,50 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   else if (run_mode == run_mode_listen_once)
     SVN_ERR(logger__create_for_stderr(&params.logger, pool));
 
+  if (metrics_filename)
+    SVN_ERR(metrics__create(&params.metrics, metrics_filename, pool));
+
+  /* Key for authentication resumption tickets.  Generated before any
+     fork() so that all connection and acceptor processes share it; it
+     does not survive a server restart, which merely voids the issued
+     tickets.  If we can't get one, clients simply keep using the full
+     challenge-response exchange. */
+  err = svn_ra_svn__make_auth_secret(&params.auth_ticket_secret, pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      params.auth_ticket_secret = NULL;
+    }
+
   if (params.tunnel_user && run_mode != run_mode_tunnel)
     {
       return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
                _("Option --tunnel-user is only valid in tunnel mode"));
     }
 
+  if (tunnel_broker_path
+      && run_mode != run_mode_tunnel && run_mode != run_mode_tunnel_broker)
+    {
+      return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+               _("Option --tunnel-broker is only valid in tunnel mode "
+                 "or on its own"));
+    }
+
+  if (run_mode == run_mode_tunnel_broker)
+    {
+#ifdef SVN_HAVE_TUNNEL_BROKER
+      params.tunnel = TRUE;
+      apr_pool_cleanup_register(pool, pool, apr_pool_cleanup_null,
+                                redirect_stdout);
+
+      return svn_error_trace(run_tunnel_broker(tunnel_broker_path, &params,
+                                               pool));
+#else
+      return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+               _("The tunnel broker requires Unix domain socket support"));
+#endif
+    }
+
   if (run_mode == run_mode_inetd || run_mode == run_mode_tunnel)
     {
       apr_pool_t *connection_pool;
@@ -1105,6 +1764,24 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       svn_stream_t *stdout_stream;
 
       params.tunnel = (run_mode == run_mode_tunnel);
+
+#ifdef SVN_HAVE_TUNNEL_BROKER
+      if (params.tunnel && tunnel_broker_path)
+        {
+          svn_boolean_t handed_off;
+
+          SVN_ERR(hand_off_to_broker(&handed_off, tunnel_broker_path,
+                                     params.tunnel_user
+                                       ? params.tunnel_user
+                                       : svn_user_get_name(pool),
+                                     pool));
+          if (handed_off)
+            return SVN_NO_ERROR;
+
+          /* No broker is listening; serve the connection ourselves. */
+        }
+#endif
+
       apr_pool_cleanup_register(pool, pool, apr_pool_cleanup_null,
                                 redirect_stdout);
 
@@ -1222,37 +1899,20 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     }
 
 
-#ifdef MAX_SECS_TO_LINGER
-  /* ### old APR interface */
-  status = apr_socket_create(&sock, sa->family, SOCK_STREAM, pool);
-#else
-  status = apr_socket_create(&sock, sa->family, SOCK_STREAM, APR_PROTO_TCP,
-                             pool);
-#endif
-  if (status)
-    {
-      return svn_error_wrap_apr(status, _("Can't create server socket"));
-    }
+  /* Multi-acceptor mode only applies to the daemon's accept loop. */
+  if (run_mode != run_mode_daemon)
+    num_acceptors = 1;
 
-  /* Prevents "socket in use" errors when server is killed and quickly
-   * restarted. */
-  status = apr_socket_opt_set(sock, APR_SO_REUSEADDR, 1);
-  if (status)
+  err = create_listen_socket(&sock, sa, num_acceptors > 1, pool);
+  if (err && num_acceptors > 1)
     {
-      return svn_error_wrap_apr(status, _("Can't set options on server socket"));
-    }
-
-  status = apr_socket_bind(sock, sa);
-  if (status)
-    {
-      return svn_error_wrap_apr(status, _("Can't bind server socket"));
-    }
-
-  status = apr_socket_listen(sock, ACCEPT_BACKLOG);
-  if (status)
-    {
-      return svn_error_wrap_apr(status, _("Can't listen on server socket"));
+      /* SO_REUSEPORT is unavailable here; fall back to a single
+         accept loop. */
+      svn_error_clear(err);
+      num_acceptors = 1;
+      err = create_listen_socket(&sock, sa, FALSE, pool);
     }
+  SVN_ERR(err);
 
 #if APR_HAS_FORK
   if (run_mode != run_mode_listen_once && !foreground)
@@ -1287,6 +1947,38 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     winservice_running();
 #endif
 
+#if APR_HAS_FORK
+  /* Spawn the additional acceptor processes.  Each child replaces the
+     inherited socket with its own SO_REUSEPORT-bound one, so the kernel
+     hashes incoming connections across all acceptors instead of pushing
+     them through a single accept loop.  Caches - for repositories,
+     configs and FS data - are per process, so every acceptor re-uses
+     its own FS objects across the connections it accepted. */
+  if (num_acceptors > 1)
+    {
+      int i;
+
+      for (i = 1; i < num_acceptors; i++)
+        {
+          apr_proc_t acceptor;
+
+          status = apr_proc_fork(&acceptor, pool);
+          if (status == APR_INCHILD)
+            {
+              apr_socket_close(sock);
+              SVN_ERR(create_listen_socket(&sock, sa, TRUE, pool));
+              break;
+            }
+          else if (status != APR_INPARENT)
+            {
+              err = svn_error_wrap_apr(status, "apr_proc_fork");
+              logger__log_error(params.logger, err, NULL, NULL);
+              svn_error_clear(err);
+            }
+        }
+    }
+#endif
+
   /* Configure FS caches for maximum efficiency with svnserve.
    * For pre-forked (i.e. multi-processed) mode of operation,
    * keep the per-process caches smaller than the default.
@@ -1297,6 +1989,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     if (params.memory_cache_size != -1)
       settings.cache_size = params.memory_cache_size;
 
+    if (cache_segments)
+      svn_cache__set_global_membuffer_segments((apr_size_t)cache_segments);
+
     settings.single_threaded = TRUE;
     if (handling_mode == connection_mode_thread)
       {
@@ -1341,6 +2036,41 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
       /* don't queue requests unless we reached the worker thread limit */
       apr_thread_pool_threshold_set(threads, 0);
+
+      /* Set up the parking lot for idle connections: a pollset plus a
+         single thread watching it.  Without it, a busy server would
+         keep cycling idle connections through the worker threads just
+         to find out that there is nothing to do for them.  If any of
+         this fails, we simply fall back to that round-robin mode. */
+      status = apr_pollset_create(&idle_pollset, IDLE_POLLSET_SIZE, pool,
+                                  APR_POLLSET_THREADSAFE);
+      if (status == APR_SUCCESS)
+        {
+          apr_thread_t *watcher;
+          apr_threadattr_t *tattr;
+
+          status = apr_threadattr_create(&tattr, pool);
+          if (status == APR_SUCCESS)
+            status = apr_thread_create(&watcher, tattr,
+                                       watch_idle_connections, NULL, pool);
+          if (status)
+            {
+              apr_pollset_destroy(idle_pollset);
+              idle_pollset = NULL;
+            }
+        }
+      else
+        {
+          idle_pollset = NULL;
+        }
+
+      /* Take log I/O off the request paths.  In fork mode, this would
+         be futile because the writer thread would not make it into the
+         per-connection child processes. */
+      logger__enable_async(params.logger, pool);
+
+      /* Same story for the metrics dump thread. */
+      metrics__start_dumping(params.metrics, pool);
     }
   else
     {
@@ -38,12 +38,15 @@
 #include "private/svn_opt_private.h"
 #include "private/svn_ra_private.h"
 #include "private/svn_cmdline_private.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_cond.h"
 
 #include "sync.h"
 
 #include "svn_private_config.h"
 
 #include <apr_uuid.h>
+#include <apr_thread_proc.h>
 
 static svn_opt_subcommand_t initialize_cmd,
                             synchronize_cmd,
@@ -71,7 +74,8 @@ enum svnsync__opt {
   svnsync_opt_trust_server_cert_failures_dst,
   svnsync_opt_allow_non_empty,
   svnsync_opt_skip_unchanged,
-  svnsync_opt_steal_lock
+  svnsync_opt_steal_lock,
+  svnsync_opt_pipeline
 };
 
 #define SVNSYNC_OPTS_DEFAULT svnsync_opt_non_interactive, \
@@ -131,7 +135,8 @@ static const svn_opt_subcommand_desc3_t svnsync_cmd_table[] =
          "DEST_URL repository.\n"
       )},
       { SVNSYNC_OPTS_DEFAULT, svnsync_opt_source_prop_encoding, 'q',
-        svnsync_opt_disable_locking, svnsync_opt_steal_lock, 'M' } },
+        svnsync_opt_disable_locking, svnsync_opt_steal_lock,
+        svnsync_opt_pipeline, 'M' } },
     { "copy-revprops", copy_revprops_cmd, { 0 }, {N_(
          "usage:\n"
          "\n"), N_(
@@ -279,6 +284,12 @@ static const apr_getopt_option_t svnsync_options[] =
                           "and is not being concurrently accessed by another\n"
                           "                             "
                           "svnsync instance.")},
+    {"pipeline",       svnsync_opt_pipeline, 0,
+                       N_("overlap fetching the next revision from the\n"
+                          "                             "
+                          "source with committing the previous one to the\n"
+                          "                             "
+                          "mirror, using a second thread")},
     {"memory-cache-size", 'M', 1,
                        N_("size of the extra in-memory cache in MB used to\n"
                           "                             "
@@ -316,6 +327,7 @@ typedef struct opt_baton_t {
   svn_boolean_t quiet;
   svn_boolean_t allow_non_empty;
   svn_boolean_t skip_unchanged;
+  svn_boolean_t pipeline;
   svn_boolean_t version;
   svn_boolean_t help;
   svn_opt_revision_t start_rev;
@@ -425,6 +437,7 @@ typedef struct subcommand_baton_t {
 
   /* synchronize only */
   svn_revnum_t committed_rev;
+  svn_boolean_t pipeline; /* Overlap source fetches and mirror commits. */
 
   /* copy-revprops only */
   svn_revnum_t start_rev;
@@ -766,6 +779,7 @@ make_subcommand_baton(opt_baton_t *opt_baton,
   b->sync_callbacks.auth_baton = opt_baton->sync_auth_baton;
   b->quiet = opt_baton->quiet;
   b->skip_unchanged = opt_baton->skip_unchanged;
+  b->pipeline = opt_baton->pipeline;
   b->allow_non_empty = opt_baton->allow_non_empty;
   b->to_url = to_url;
   b->source_prop_encoding = opt_baton->source_prop_encoding;
@@ -1424,6 +1438,344 @@ replay_rev_finished(svn_revnum_t revision,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* How many fully buffered revisions may sit between the fetching main
+   thread and the committing worker thread.  Each waiting revision spools
+   its text deltas to temporary files, so keep the window small. */
+#define SVNSYNC_PIPELINE_DEPTH 2
+
+/* State shared between the fetching (main) thread and the committing
+   (worker) thread in pipelined synchronization mode. */
+typedef struct pipeline_baton_t {
+  svn_mutex__t *mutex;
+  svn_thread_cond__t *not_full;   /* signalled when a queue slot opens */
+  svn_thread_cond__t *not_empty;  /* signalled when a record is queued */
+
+  /* Ring buffer of buffered revisions awaiting their mirror commit. */
+  svnsync_edit_record_t *queue[SVNSYNC_PIPELINE_DEPTH];
+  int start;
+  int used;
+
+  /* The record the replay is currently filling, not queued yet.
+     Accessed by the main thread only. */
+  svnsync_edit_record_t *current;
+
+  /* Set by the main thread once the replay has ended. */
+  svn_boolean_t fetch_done;
+
+  /* First error hit by the committer thread, or NULL.  Only the
+     committer thread writes this; the main thread reads it under MUTEX
+     while the committer is alive. */
+  svn_error_t *commit_err;
+
+  replay_baton_t *rb;
+} pipeline_baton_t;
+
+/* Return an error if the committer thread has already failed, so that
+   the caller aborts the replay.  Called with PB->MUTEX held. */
+static svn_error_t *
+pipeline_check_failed_locked(pipeline_baton_t *pb)
+{
+  if (pb->commit_err)
+    return svn_error_create(SVN_ERR_CANCELLED, NULL,
+                            _("Error while committing to the mirror "
+                              "repository; aborting replay"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Append RECORD to PB's queue, waiting for a free slot if necessary.
+   Called with PB->MUTEX held. */
+static svn_error_t *
+pipeline_push_locked(pipeline_baton_t *pb,
+                     svnsync_edit_record_t *record)
+{
+  while (pb->used == SVNSYNC_PIPELINE_DEPTH && !pb->commit_err)
+    SVN_ERR(svn_thread_cond__wait(pb->not_full, pb->mutex));
+
+  SVN_ERR(pipeline_check_failed_locked(pb));
+
+  pb->queue[(pb->start + pb->used) % SVNSYNC_PIPELINE_DEPTH] = record;
+  pb->used++;
+
+  return svn_thread_cond__signal(pb->not_empty);
+}
+
+/* Set *RECORD to the next queued revision, or to NULL once the replay
+   has ended and the queue has drained.  Called with PB->MUTEX held. */
+static svn_error_t *
+pipeline_pop_locked(svnsync_edit_record_t **record,
+                    pipeline_baton_t *pb)
+{
+  while (pb->used == 0 && !pb->fetch_done)
+    SVN_ERR(svn_thread_cond__wait(pb->not_empty, pb->mutex));
+
+  if (pb->used == 0)
+    {
+      *record = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  *record = pb->queue[pb->start];
+  pb->start = (pb->start + 1) % SVNSYNC_PIPELINE_DEPTH;
+  pb->used--;
+
+  return svn_thread_cond__signal(pb->not_full);
+}
+
+/* Remember ERR as the committer thread's error and wake up the main
+   thread in case it is waiting for a queue slot.  Called with PB->MUTEX
+   held. */
+static svn_error_t *
+pipeline_set_commit_err_locked(pipeline_baton_t *pb,
+                               svn_error_t *err)
+{
+  pb->commit_err = svn_error_compose_create(pb->commit_err, err);
+
+  return svn_thread_cond__broadcast(pb->not_full);
+}
+
+/* Tell the committer thread that no further records will be queued.
+   Called with PB->MUTEX held. */
+static svn_error_t *
+pipeline_fetch_done_locked(pipeline_baton_t *pb)
+{
+  pb->fetch_done = TRUE;
+
+  return svn_thread_cond__signal(pb->not_empty);
+}
+
+/* Mutex-acquiring wrappers around the _locked functions above. */
+
+static svn_error_t *
+pipeline_check_failed(pipeline_baton_t *pb)
+{
+  SVN_MUTEX__WITH_LOCK(pb->mutex, pipeline_check_failed_locked(pb));
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+pipeline_push(pipeline_baton_t *pb,
+              svnsync_edit_record_t *record)
+{
+  SVN_MUTEX__WITH_LOCK(pb->mutex, pipeline_push_locked(pb, record));
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+pipeline_pop(svnsync_edit_record_t **record,
+             pipeline_baton_t *pb)
+{
+  SVN_MUTEX__WITH_LOCK(pb->mutex, pipeline_pop_locked(record, pb));
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+pipeline_set_commit_err(pipeline_baton_t *pb,
+                        svn_error_t *err)
+{
+  SVN_MUTEX__WITH_LOCK(pb->mutex, pipeline_set_commit_err_locked(pb, err));
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+pipeline_fetch_done(pipeline_baton_t *pb)
+{
+  SVN_MUTEX__WITH_LOCK(pb->mutex, pipeline_fetch_done_locked(pb));
+  return SVN_NO_ERROR;
+}
+
+/* Commit the buffered revision RECORD to the mirror, reusing the
+   unpipelined replay callbacks so that both modes share the exact same
+   commit and revprop copying logic. */
+static svn_error_t *
+commit_edit_record(replay_baton_t *rb,
+                   svnsync_edit_record_t *record,
+                   apr_pool_t *pool)
+{
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+
+  SVN_ERR(replay_rev_started(record->revision, rb, &editor, &edit_baton,
+                             record->rev_props, pool));
+  SVN_ERR(svnsync_replay_edit_record(record, editor, edit_baton, pool));
+  SVN_ERR(replay_rev_finished(record->revision, rb, editor, edit_baton,
+                              record->rev_props, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Commit buffered revisions in order until the queue drains after the
+   end of the replay.  After the first failure, keep draining the queue
+   but merely discard the remaining records, so that the main thread
+   never blocks on a full queue. */
+static svn_error_t *
+pipeline_commit_loop(pipeline_baton_t *pb,
+                     apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  while (TRUE)
+    {
+      svnsync_edit_record_t *record;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(pipeline_pop(&record, pb));
+      if (record == NULL)
+        break;
+
+      /* We are the only writer of COMMIT_ERR, so reading it without the
+         mutex is safe here. */
+      err = pb->commit_err ? SVN_NO_ERROR
+                           : commit_edit_record(pb->rb, record, iterpool);
+      svn_pool_destroy(record->pool);
+
+      if (err)
+        SVN_ERR(pipeline_set_commit_err(pb, err));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Committer thread entry point.  DATA is the pipeline_baton_t. */
+static void * APR_THREAD_FUNC
+pipeline_commit_thread(apr_thread_t *thread, void *data)
+{
+  pipeline_baton_t *pb = data;
+
+  /* Use a root pool with its own allocator: the allocator behind the
+     main thread's pools is not safe for concurrent allocations. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+  svn_error_t *err = pipeline_commit_loop(pb, pool);
+
+  if (err)
+    svn_error_clear(pipeline_set_commit_err(pb, err));
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(thread, APR_SUCCESS);
+
+  return NULL;
+}
+
+/* Callback function for svn_ra_replay_range in pipelined mode, invoked
+ * when starting to parse a replay report.  Buffers the revision instead
+ * of committing it directly.
+ */
+static svn_error_t *
+pipeline_rev_started(svn_revnum_t revision,
+                     void *replay_baton,
+                     const svn_delta_editor_t **editor,
+                     void **edit_baton,
+                     apr_hash_t *rev_props,
+                     apr_pool_t *pool)
+{
+  pipeline_baton_t *pb = replay_baton;
+  const svn_delta_editor_t *buffering_editor;
+  void *buffering_baton;
+  apr_pool_t *record_pool;
+
+  SVN_ERR(pipeline_check_failed(pb));
+
+  /* Each record lives in a root pool with its own allocator because it
+     is handed over to the committer thread. */
+  record_pool = svn_pool_create(NULL);
+  pb->current = svnsync_edit_record_create(revision, rev_props, record_pool);
+
+  SVN_ERR(svnsync_get_buffering_editor(&buffering_editor, &buffering_baton,
+                                       pb->current, record_pool));
+  SVN_ERR(svn_delta_get_cancellation_editor(check_cancel, NULL,
+                                            buffering_editor, buffering_baton,
+                                            editor, edit_baton,
+                                            pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Callback function for svn_ra_replay_range in pipelined mode, invoked
+ * when finishing parsing a replay report.  Hands the buffered revision
+ * to the committer thread.
+ */
+static svn_error_t *
+pipeline_rev_finished(svn_revnum_t revision,
+                      void *replay_baton,
+                      const svn_delta_editor_t *editor,
+                      void *edit_baton,
+                      apr_hash_t *rev_props,
+                      apr_pool_t *pool)
+{
+  pipeline_baton_t *pb = replay_baton;
+  svnsync_edit_record_t *record = pb->current;
+  svn_error_t *err;
+
+  pb->current = NULL;
+  err = pipeline_push(pb, record);
+  if (err)
+    {
+      svn_pool_destroy(record->pool);
+      return svn_error_trace(err);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Replay and commit the revisions START_REVISION to END_REVISION like
+ * svn_ra_replay_range with the replay_rev_started / replay_rev_finished
+ * callbacks would, but overlap the two halves of the work: the main
+ * thread keeps fetching upcoming revisions from the source into
+ * buffered edit records while a worker thread commits the already
+ * buffered revisions to the mirror.
+ */
+static svn_error_t *
+replay_range_pipelined(replay_baton_t *rb,
+                       svn_ra_session_t *from_session,
+                       svn_revnum_t start_revision,
+                       svn_revnum_t end_revision,
+                       apr_pool_t *pool)
+{
+  pipeline_baton_t *pb = apr_pcalloc(pool, sizeof(*pb));
+  apr_thread_t *thread;
+  apr_status_t thread_status;
+  svn_error_t *err;
+
+  SVN_ERR(svn_mutex__init(&pb->mutex, TRUE, pool));
+  SVN_ERR(svn_thread_cond__create(&pb->not_full, pool));
+  SVN_ERR(svn_thread_cond__create(&pb->not_empty, pool));
+  pb->rb = rb;
+
+  if (apr_thread_create(&thread, NULL, pipeline_commit_thread, pb, pool))
+    {
+      /* No thread, no pipeline: fall back to the sequential replay. */
+      return svn_error_trace(
+               svn_ra_replay_range(from_session, start_revision, end_revision,
+                                   0, TRUE, replay_rev_started,
+                                   replay_rev_finished, rb, pool));
+    }
+
+  err = svn_ra_replay_range(from_session, start_revision, end_revision,
+                            0, TRUE, pipeline_rev_started,
+                            pipeline_rev_finished, pb, pool);
+
+  /* Tell the committer that no more records are coming, then wait for
+     it to finish the revisions it already received. */
+  err = svn_error_compose_create(err, pipeline_fetch_done(pb));
+  apr_thread_join(&thread_status, thread);
+
+  /* If the replay failed mid-revision, its unfinished record was never
+     handed to the committer thread. */
+  if (pb->current)
+    svn_pool_destroy(pb->current->pool);
+
+  /* The committer has exited, so its error can be picked up lock-free. */
+  return svn_error_compose_create(pb->commit_err, err);
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Synchronize the repository associated with RA session TO_SESSION,
  * using information found in BATON.
  *
@@ -1556,6 +1908,12 @@ do_synchronize(svn_ra_session_t *to_session,
 
   SVN_ERR(check_cancel(NULL));
 
+#if APR_HAS_THREADS
+  if (baton->pipeline)
+    SVN_ERR(replay_range_pipelined(rb, from_session, start_revision,
+                                   end_revision, pool));
+  else
+#endif
   SVN_ERR(svn_ra_replay_range(from_session, start_revision, end_revision,
                               0, TRUE, replay_rev_started,
                               replay_rev_finished, rb, pool));
@@ -2130,6 +2488,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
             opt_baton.skip_unchanged = TRUE;
             break;
 
+          case svnsync_opt_pipeline:
+            opt_baton.pipeline = TRUE;
+            break;
+
           case 'q':
             opt_baton.quiet = TRUE;
             break;
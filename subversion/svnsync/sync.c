@@ -22,6 +22,7 @@
 #include "svn_hash.h"
 #include "svn_cmdline.h"
 #include "svn_config.h"
+#include "svn_io.h"
 #include "svn_pools.h"
 #include "svn_delta.h"
 #include "svn_dirent_uri.h"
@@ -756,3 +757,521 @@ svnsync_get_sync_editor(const svn_delta_editor_t *wrapped_editor,
   return SVN_NO_ERROR;
 }
 
+
+/*** Buffering Editor ***/
+
+/* This editor does not forward the drive anywhere.  It serializes the
+ * calls it receives into an svnsync_edit_record_t, from which the same
+ * drive can be reproduced later - possibly on another thread.  Node
+ * batons are represented by small integer ids; text deltas are spooled
+ * to temporary files in svndiff format so that arbitrarily large
+ * revisions don't have to fit into memory.
+ */
+
+/* The individual editor calls a record consists of. */
+typedef enum record_op_code_t
+{
+  record_op_set_target_revision,
+  record_op_open_root,
+  record_op_delete_entry,
+  record_op_add_directory,
+  record_op_open_directory,
+  record_op_change_dir_prop,
+  record_op_close_directory,
+  record_op_absent_directory,
+  record_op_add_file,
+  record_op_open_file,
+  record_op_apply_textdelta,
+  record_op_change_file_prop,
+  record_op_close_file,
+  record_op_absent_file
+} record_op_code_t;
+
+/* One recorded editor call.  Which of the fields carry data depends on
+ * CODE; unused fields are NULL, SVN_INVALID_REVNUM or -1, respectively.
+ * All pointers reference memory in the record's pool. */
+typedef struct record_op_t
+{
+  record_op_code_t code;
+
+  /* The node the call was made on: the node itself for change / close /
+   * textdelta calls, the parent directory for delete / absent / add /
+   * open calls.  -1 for calls on the edit baton. */
+  int node_id;
+
+  /* The id assigned to the node produced by open_root, add_* and
+   * open_* calls. */
+  int new_id;
+
+  const char *path;            /* path argument */
+  const char *copyfrom_path;   /* already in URL form, or NULL */
+  svn_revnum_t revision;       /* target / base / copyfrom revision */
+  const char *name;            /* property name */
+  const svn_string_t *value;   /* property value, may be NULL */
+  const char *checksum;        /* base / result checksum, may be NULL */
+  const char *delta_abspath;   /* spool file with the svndiff data */
+} record_op_t;
+
+/* Per-node baton of the buffering editor. */
+typedef struct record_node_baton_t
+{
+  svnsync_edit_record_t *record;
+  int id;
+} record_node_baton_t;
+
+
+/* Append a new operation with code CODE, made on node NODE_ID, to
+ * RECORD and return it for the caller to fill in further. */
+static record_op_t *
+record_op(svnsync_edit_record_t *record,
+          record_op_code_t code,
+          int node_id)
+{
+  record_op_t *op = apr_array_push(record->ops);
+
+  op->code = code;
+  op->node_id = node_id;
+  op->new_id = -1;
+  op->path = NULL;
+  op->copyfrom_path = NULL;
+  op->revision = SVN_INVALID_REVNUM;
+  op->name = NULL;
+  op->value = NULL;
+  op->checksum = NULL;
+  op->delta_abspath = NULL;
+
+  return op;
+}
+
+/* Allocate a node baton for the node with id ID in RECORD from POOL. */
+static record_node_baton_t *
+make_record_node_baton(svnsync_edit_record_t *record,
+                       int id,
+                       apr_pool_t *pool)
+{
+  record_node_baton_t *nb = apr_palloc(pool, sizeof(*nb));
+
+  nb->record = record;
+  nb->id = id;
+
+  return nb;
+}
+
+
+/*** Buffering editor vtable functions ***/
+
+static svn_error_t *
+record_set_target_revision(void *edit_baton,
+                           svn_revnum_t target_revision,
+                           apr_pool_t *pool)
+{
+  svnsync_edit_record_t *record = edit_baton;
+  record_op_t *op = record_op(record, record_op_set_target_revision, -1);
+
+  op->revision = target_revision;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_root(void *edit_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *pool,
+                 void **root_baton)
+{
+  svnsync_edit_record_t *record = edit_baton;
+  record_op_t *op = record_op(record, record_op_open_root, -1);
+
+  op->revision = base_revision;
+  op->new_id = record->next_id++;
+
+  *root_baton = make_record_node_baton(record, op->new_id, pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_delete_entry(const char *path,
+                    svn_revnum_t base_revision,
+                    void *parent_baton,
+                    apr_pool_t *pool)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_op_t *op = record_op(pb->record, record_op_delete_entry, pb->id);
+
+  op->path = apr_pstrdup(pb->record->pool, path);
+  op->revision = base_revision;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_add_directory(const char *path,
+                     void *parent_baton,
+                     const char *copyfrom_path,
+                     svn_revnum_t copyfrom_rev,
+                     apr_pool_t *pool,
+                     void **child_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  svnsync_edit_record_t *record = pb->record;
+  record_op_t *op = record_op(record, record_op_add_directory, pb->id);
+
+  op->path = apr_pstrdup(record->pool, path);
+  if (copyfrom_path)
+    op->copyfrom_path = apr_pstrdup(record->pool, copyfrom_path);
+  op->revision = copyfrom_rev;
+  op->new_id = record->next_id++;
+
+  *child_baton = make_record_node_baton(record, op->new_id, pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_directory(const char *path,
+                      void *parent_baton,
+                      svn_revnum_t base_revision,
+                      apr_pool_t *pool,
+                      void **child_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  svnsync_edit_record_t *record = pb->record;
+  record_op_t *op = record_op(record, record_op_open_directory, pb->id);
+
+  op->path = apr_pstrdup(record->pool, path);
+  op->revision = base_revision;
+  op->new_id = record->next_id++;
+
+  *child_baton = make_record_node_baton(record, op->new_id, pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_change_dir_prop(void *dir_baton,
+                       const char *name,
+                       const svn_string_t *value,
+                       apr_pool_t *pool)
+{
+  record_node_baton_t *db = dir_baton;
+  record_op_t *op = record_op(db->record, record_op_change_dir_prop, db->id);
+
+  op->name = apr_pstrdup(db->record->pool, name);
+  if (value)
+    op->value = svn_string_dup(value, db->record->pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_directory(void *dir_baton,
+                       apr_pool_t *pool)
+{
+  record_node_baton_t *db = dir_baton;
+
+  record_op(db->record, record_op_close_directory, db->id);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_absent_directory(const char *path,
+                        void *parent_baton,
+                        apr_pool_t *pool)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_op_t *op = record_op(pb->record, record_op_absent_directory, pb->id);
+
+  op->path = apr_pstrdup(pb->record->pool, path);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_add_file(const char *path,
+                void *parent_baton,
+                const char *copyfrom_path,
+                svn_revnum_t copyfrom_rev,
+                apr_pool_t *pool,
+                void **file_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  svnsync_edit_record_t *record = pb->record;
+  record_op_t *op = record_op(record, record_op_add_file, pb->id);
+
+  op->path = apr_pstrdup(record->pool, path);
+  if (copyfrom_path)
+    op->copyfrom_path = apr_pstrdup(record->pool, copyfrom_path);
+  op->revision = copyfrom_rev;
+  op->new_id = record->next_id++;
+
+  *file_baton = make_record_node_baton(record, op->new_id, pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_file(const char *path,
+                 void *parent_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *pool,
+                 void **file_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  svnsync_edit_record_t *record = pb->record;
+  record_op_t *op = record_op(record, record_op_open_file, pb->id);
+
+  op->path = apr_pstrdup(record->pool, path);
+  op->revision = base_revision;
+  op->new_id = record->next_id++;
+
+  *file_baton = make_record_node_baton(record, op->new_id, pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_apply_textdelta(void *file_baton,
+                       const char *base_checksum,
+                       apr_pool_t *pool,
+                       svn_txdelta_window_handler_t *handler,
+                       void **handler_baton)
+{
+  record_node_baton_t *fb = file_baton;
+  svnsync_edit_record_t *record = fb->record;
+  record_op_t *op = record_op(record, record_op_apply_textdelta, fb->id);
+  svn_stream_t *spool;
+
+  if (base_checksum)
+    op->checksum = apr_pstrdup(record->pool, base_checksum);
+
+  /* Spool the delta windows to a temporary file in uncompressed svndiff
+     format.  The file is removed together with the record's pool. */
+  SVN_ERR(svn_stream_open_unique(&spool, &op->delta_abspath, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 record->pool, pool));
+  svn_txdelta_to_svndiff3(handler, handler_baton, spool, 0,
+                          SVN_DELTA_COMPRESSION_LEVEL_NONE, pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_change_file_prop(void *file_baton,
+                        const char *name,
+                        const svn_string_t *value,
+                        apr_pool_t *pool)
+{
+  record_node_baton_t *fb = file_baton;
+  record_op_t *op = record_op(fb->record, record_op_change_file_prop, fb->id);
+
+  op->name = apr_pstrdup(fb->record->pool, name);
+  if (value)
+    op->value = svn_string_dup(value, fb->record->pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_file(void *file_baton,
+                  const char *text_checksum,
+                  apr_pool_t *pool)
+{
+  record_node_baton_t *fb = file_baton;
+  record_op_t *op = record_op(fb->record, record_op_close_file, fb->id);
+
+  if (text_checksum)
+    op->checksum = apr_pstrdup(fb->record->pool, text_checksum);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_absent_file(const char *path,
+                   void *file_baton,
+                   apr_pool_t *pool)
+{
+  record_node_baton_t *fb = file_baton;
+  record_op_t *op = record_op(fb->record, record_op_absent_file, fb->id);
+
+  op->path = apr_pstrdup(fb->record->pool, path);
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** Buffering editor factory and replay functions ***/
+
+svnsync_edit_record_t *
+svnsync_edit_record_create(svn_revnum_t revision,
+                           apr_hash_t *rev_props,
+                           apr_pool_t *pool)
+{
+  svnsync_edit_record_t *record = apr_pcalloc(pool, sizeof(*record));
+
+  record->pool = pool;
+  record->revision = revision;
+  record->rev_props = svn_prop_hash_dup(rev_props, pool);
+  record->ops = apr_array_make(pool, 64, sizeof(record_op_t));
+
+  return record;
+}
+
+svn_error_t *
+svnsync_get_buffering_editor(const svn_delta_editor_t **editor,
+                             void **edit_baton,
+                             svnsync_edit_record_t *record,
+                             apr_pool_t *pool)
+{
+  svn_delta_editor_t *buffering_editor = svn_delta_default_editor(pool);
+
+  buffering_editor->set_target_revision = record_set_target_revision;
+  buffering_editor->open_root = record_open_root;
+  buffering_editor->delete_entry = record_delete_entry;
+  buffering_editor->add_directory = record_add_directory;
+  buffering_editor->open_directory = record_open_directory;
+  buffering_editor->change_dir_prop = record_change_dir_prop;
+  buffering_editor->close_directory = record_close_directory;
+  buffering_editor->absent_directory = record_absent_directory;
+  buffering_editor->add_file = record_add_file;
+  buffering_editor->open_file = record_open_file;
+  buffering_editor->apply_textdelta = record_apply_textdelta;
+  buffering_editor->change_file_prop = record_change_file_prop;
+  buffering_editor->close_file = record_close_file;
+  buffering_editor->absent_file = record_absent_file;
+
+  /* close_edit and abort_edit keep their no-op defaults; the replay
+     driver never calls them on the editor it is handed. */
+
+  *editor = buffering_editor;
+  *edit_baton = record;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svnsync_replay_edit_record(const svnsync_edit_record_t *record,
+                           const svn_delta_editor_t *editor,
+                           void *edit_baton,
+                           apr_pool_t *pool)
+{
+  apr_array_header_t *batons
+    = apr_array_make(pool, record->next_id, sizeof(void *));
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < record->next_id; i++)
+    APR_ARRAY_PUSH(batons, void *) = NULL;
+
+  for (i = 0; i < record->ops->nelts; i++)
+    {
+      const record_op_t *op = &APR_ARRAY_IDX(record->ops, i, record_op_t);
+      void *node = op->node_id >= 0
+                 ? APR_ARRAY_IDX(batons, op->node_id, void *)
+                 : NULL;
+
+      svn_pool_clear(iterpool);
+
+      switch (op->code)
+        {
+        case record_op_set_target_revision:
+          SVN_ERR(editor->set_target_revision(edit_baton, op->revision,
+                                              iterpool));
+          break;
+
+        case record_op_open_root:
+          /* Like all node batons, the root baton must survive until its
+             closing call, hence POOL rather than ITERPOOL. */
+          SVN_ERR(editor->open_root(edit_baton, op->revision, pool,
+                                    &APR_ARRAY_IDX(batons, op->new_id,
+                                                   void *)));
+          break;
+
+        case record_op_delete_entry:
+          SVN_ERR(editor->delete_entry(op->path, op->revision, node,
+                                       iterpool));
+          break;
+
+        case record_op_add_directory:
+          SVN_ERR(editor->add_directory(op->path, node, op->copyfrom_path,
+                                        op->revision, pool,
+                                        &APR_ARRAY_IDX(batons, op->new_id,
+                                                       void *)));
+          break;
+
+        case record_op_open_directory:
+          SVN_ERR(editor->open_directory(op->path, node, op->revision, pool,
+                                         &APR_ARRAY_IDX(batons, op->new_id,
+                                                        void *)));
+          break;
+
+        case record_op_change_dir_prop:
+          SVN_ERR(editor->change_dir_prop(node, op->name, op->value,
+                                          iterpool));
+          break;
+
+        case record_op_close_directory:
+          SVN_ERR(editor->close_directory(node, iterpool));
+          break;
+
+        case record_op_absent_directory:
+          SVN_ERR(editor->absent_directory(op->path, node, iterpool));
+          break;
+
+        case record_op_add_file:
+          SVN_ERR(editor->add_file(op->path, node, op->copyfrom_path,
+                                   op->revision, pool,
+                                   &APR_ARRAY_IDX(batons, op->new_id,
+                                                  void *)));
+          break;
+
+        case record_op_open_file:
+          SVN_ERR(editor->open_file(op->path, node, op->revision, pool,
+                                    &APR_ARRAY_IDX(batons, op->new_id,
+                                                   void *)));
+          break;
+
+        case record_op_apply_textdelta:
+          {
+            svn_txdelta_window_handler_t handler;
+            void *handler_baton;
+            svn_stream_t *source;
+
+            SVN_ERR(editor->apply_textdelta(node, op->checksum, iterpool,
+                                            &handler, &handler_baton));
+
+            /* Push the spooled svndiff data back through the handler.
+               svn_stream_copy3 closes both streams, and closing the
+               parser stream delivers the final NULL window. */
+            SVN_ERR(svn_stream_open_readonly(&source, op->delta_abspath,
+                                             iterpool, iterpool));
+            SVN_ERR(svn_stream_copy3(source,
+                                     svn_txdelta_parse_svndiff(handler,
+                                                               handler_baton,
+                                                               TRUE,
+                                                               iterpool),
+                                     NULL, NULL, iterpool));
+          }
+          break;
+
+        case record_op_change_file_prop:
+          SVN_ERR(editor->change_file_prop(node, op->name, op->value,
+                                           iterpool));
+          break;
+
+        case record_op_close_file:
+          SVN_ERR(editor->close_file(node, op->checksum, iterpool));
+          break;
+
+        case record_op_absent_file:
+          SVN_ERR(editor->absent_file(op->path, node, iterpool));
+          break;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
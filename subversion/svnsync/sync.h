@@ -78,6 +78,62 @@ svnsync_get_sync_editor(const svn_delta_editor_t *wrapped_editor,
                         apr_pool_t *pool);
 
 
+/* A buffered record of a single editor drive, i.e. of one replayed
+ * revision.  Structural operations are kept in memory while text deltas
+ * are spooled to temporary files, so a record can be built on one thread
+ * and applied to another editor on a different thread later on.
+ */
+typedef struct svnsync_edit_record_t {
+  /* The pool the record, including its spool files, lives in.  Destroying
+   * it releases everything the record holds. */
+  apr_pool_t *pool;
+
+  /* The revision the recorded drive represents. */
+  svn_revnum_t revision;
+
+  /* The source revision properties, deep-copied into POOL. */
+  apr_hash_t *rev_props;
+
+  /* The recorded operations and the next unused node id.  Internal to
+   * the buffering editor; do not inspect. */
+  apr_array_header_t *ops;
+  int next_id;
+} svnsync_edit_record_t;
+
+
+/* Return a new, empty edit record for REVISION, allocated in POOL.
+ * REV_PROPS is deep-copied into POOL.
+ */
+svnsync_edit_record_t *
+svnsync_edit_record_create(svn_revnum_t revision,
+                           apr_hash_t *rev_props,
+                           apr_pool_t *pool);
+
+
+/* Set EDITOR and EDIT_BATON to an editor/baton pair that buffers the
+ * drive it receives in RECORD instead of forwarding it anywhere.
+ * Allocate the editor in POOL; the buffered data itself goes into
+ * RECORD->POOL.
+ */
+svn_error_t *
+svnsync_get_buffering_editor(const svn_delta_editor_t **editor,
+                             void **edit_baton,
+                             svnsync_edit_record_t *record,
+                             apr_pool_t *pool);
+
+
+/* Drive EDITOR / EDIT_BATON with the operations buffered in RECORD, in
+ * the order they were recorded.  Does not call close_edit or abort_edit;
+ * that is left to the caller, mirroring how svn_ra_replay_range leaves
+ * it to the replay callbacks.  Use POOL for temporary allocations.
+ */
+svn_error_t *
+svnsync_replay_edit_record(const svnsync_edit_record_t *record,
+                           const svn_delta_editor_t *editor,
+                           void *edit_baton,
+                           apr_pool_t *pool);
+
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,186 @@
+/* delta-bench.c -- microbenchmarks for the text delta and diff kernels
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#define APR_WANT_STDIO
+#include <apr_want.h>
+
+#include <apr_general.h>
+#include <apr_strings.h>
+
+#include "svn_delta.h"
+#include "svn_diff.h"
+#include "svn_error.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+
+/* Size of the synthetic corpus. */
+#define LINE_COUNT 100000
+
+/* Every Nth line differs between the two corpus versions, roughly the
+ * shape of a typical commit against a large file. */
+#define CHANGE_INTERVAL 50
+
+/* Number of timed passes over the corpus. */
+#define REPETITIONS 10
+
+/* Simple linear congruential generator so that every run processes the
+ * exact same corpus, regardless of platform and libc. */
+static apr_uint32_t prng_state = 0x12345678;
+
+static apr_uint32_t
+prng(void)
+{
+  prng_state = prng_state * 1664525u + 1013904223u;
+  return prng_state;
+}
+
+/* Build the two versions of the corpus in *SOURCE and *TARGET:  TARGET
+ * equals SOURCE except that every CHANGE_INTERVAL-th line is replaced.
+ * Allocate both in POOL. */
+static void
+build_corpus(svn_stringbuf_t **source,
+             svn_stringbuf_t **target,
+             apr_pool_t *pool)
+{
+  svn_stringbuf_t *s = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *t = svn_stringbuf_create_empty(pool);
+  int i;
+
+  for (i = 0; i < LINE_COUNT; ++i)
+    {
+      const char *line = apr_psprintf(pool, "line %8d, filler %08x\n",
+                                      i, (unsigned)prng());
+      svn_stringbuf_appendcstr(s, line);
+
+      if (i % CHANGE_INTERVAL == 0)
+        line = apr_psprintf(pool, "line %8d, changed %07x\n",
+                            i, (unsigned)prng());
+      svn_stringbuf_appendcstr(t, line);
+    }
+
+  *source = s;
+  *target = t;
+}
+
+/* Measure the throughput of the xdelta kernel by producing the full
+ * txdelta window stream for TARGET against SOURCE, REPETITIONS times.
+ * Use POOL for allocations. */
+static svn_error_t *
+bench_xdelta(svn_stringbuf_t *source,
+             svn_stringbuf_t *target,
+             apr_pool_t *pool)
+{
+  apr_time_t start, taken;
+  int run;
+
+  start = apr_time_now();
+  for (run = 0; run < REPETITIONS; ++run)
+    {
+      apr_pool_t *subpool = svn_pool_create(pool);
+      apr_pool_t *wpool = svn_pool_create(pool);
+      svn_txdelta_stream_t *delta_stream;
+      svn_txdelta_window_t *window;
+
+      svn_txdelta2(&delta_stream,
+                   svn_stream_from_stringbuf(source, subpool),
+                   svn_stream_from_stringbuf(target, subpool),
+                   FALSE,
+                   subpool);
+      do
+        {
+          SVN_ERR(svn_txdelta_next_window(&window, delta_stream, wpool));
+          svn_pool_clear(wpool);
+        }
+      while (window != NULL);
+
+      svn_pool_destroy(wpool);
+      svn_pool_destroy(subpool);
+    }
+  taken = apr_time_now() - start;
+
+  printf("xdelta, %2.0f MB corpus:   %10.1f MB/s\n",
+         target->len / 1048576.0,
+         (REPETITIONS * (double)target->len)
+           / (1048576.0 * taken / 1.0e6));
+
+  return SVN_NO_ERROR;
+}
+
+/* Measure the throughput of the LCS-based diff kernel by diffing the
+ * two corpus versions in memory, REPETITIONS times.  Use POOL for
+ * allocations. */
+static svn_error_t *
+bench_lcs(svn_stringbuf_t *source,
+          svn_stringbuf_t *target,
+          apr_pool_t *pool)
+{
+  const svn_string_t *original = svn_string_create_from_buf(source, pool);
+  const svn_string_t *modified = svn_string_create_from_buf(target, pool);
+  apr_time_t start, taken;
+  int run;
+
+  start = apr_time_now();
+  for (run = 0; run < REPETITIONS; ++run)
+    {
+      apr_pool_t *subpool = svn_pool_create(pool);
+      svn_diff_t *diff;
+
+      SVN_ERR(svn_diff_mem_string_diff(&diff, original, modified,
+                                       svn_diff_file_options_create(subpool),
+                                       subpool));
+
+      svn_pool_destroy(subpool);
+    }
+  taken = apr_time_now() - start;
+
+  printf("lcs diff, %6d lines: %10.0f lines/s\n",
+         LINE_COUNT,
+         (REPETITIONS * (double)LINE_COUNT) / (taken / 1.0e6));
+
+  return SVN_NO_ERROR;
+}
+
+int
+main(int argc, char **argv)
+{
+  apr_pool_t *pool;
+  svn_stringbuf_t *source;
+  svn_stringbuf_t *target;
+  svn_error_t *err;
+
+  apr_initialize();
+  pool = svn_pool_create(NULL);
+
+  build_corpus(&source, &target, pool);
+
+  err = bench_xdelta(source, target, pool);
+  if (!err)
+    err = bench_lcs(source, target, pool);
+
+  if (err)
+    svn_handle_error2(err, stderr, TRUE, "delta-bench: ");
+
+  svn_pool_destroy(pool);
+  apr_terminate();
+
+  return 0;
+}
@@ -28,6 +28,7 @@
 #include "svn_pools.h"
 #include "svn_utf.h"
 
+#include "private/svn_diff_private.h"
 #include "private/svn_string_private.h"
 
 /* Used to terminate lines in large multi-line string literals. */
@@ -3065,6 +3066,208 @@ three_way_double_add(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_two_way_histogram(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *diff_opts = svn_diff_file_options_create(pool);
+  svn_stringbuf_t *original, *modified, *expected;
+  int i;
+
+  diff_opts->use_histogram_diff = TRUE;
+
+  /* A simple change produces the same hunk as the Myers engine. */
+  SVN_ERR(two_way_diff("foo18a", "bar18a",
+                       "Aa\n"
+                       "Bb\n"
+                       "Cc\n",
+
+                       "Aa\n"
+                       "Xx\n"
+                       "Cc\n",
+
+                       "--- foo18a"       NL
+                       "+++ bar18a"       NL
+                       "@@ -1,3 +1,3 @@"  NL
+                       " Aa\n"
+                       "-Bb\n"
+                       "+Xx\n"
+                       " Cc\n",
+                       diff_opts, pool));
+
+  /* Reordered blocks anchor at the first rare run. */
+  SVN_ERR(two_way_diff("foo18b", "bar18b",
+                       "Aa\n"
+                       "Bb\n"
+                       "Cc\n"
+                       "Dd\n"
+                       "Ee\n"
+                       "Ff\n",
+
+                       "Dd\n"
+                       "Ee\n"
+                       "Ff\n"
+                       "Aa\n"
+                       "Bb\n"
+                       "Cc\n",
+
+                       "--- foo18b"       NL
+                       "+++ bar18b"       NL
+                       "@@ -1,6 +1,6 @@"  NL
+                       "-Aa\n"
+                       "-Bb\n"
+                       "-Cc\n"
+                       " Dd\n"
+                       " Ee\n"
+                       " Ff\n"
+                       "+Aa\n"
+                       "+Bb\n"
+                       "+Cc\n",
+                       diff_opts, pool));
+
+  /* Files without any common line never need an anchor. */
+  SVN_ERR(two_way_diff("foo18c", "bar18c",
+                       "Aa\n"
+                       "Bb\n",
+
+                       "Xx\n"
+                       "Yy\n",
+
+                       "--- foo18c"       NL
+                       "+++ bar18c"       NL
+                       "@@ -1,2 +1,2 @@"  NL
+                       "-Aa\n"
+                       "-Bb\n"
+                       "+Xx\n"
+                       "+Yy\n",
+                       diff_opts, pool));
+
+  /* When the only common line repeats too often to serve as an anchor,
+     the comparison falls back to the Myers engine and must still give
+     the classic result. */
+  original = svn_stringbuf_create("Aa\n", pool);
+  modified = svn_stringbuf_create("Cc\n", pool);
+  for (i = 0; i < 65; i++)
+    {
+      svn_stringbuf_appendcstr(original, "Xx\n");
+      svn_stringbuf_appendcstr(modified, "Xx\n");
+    }
+  svn_stringbuf_appendcstr(original, "Bb\n");
+  svn_stringbuf_appendcstr(modified, "Dd\n");
+
+  expected = svn_stringbuf_create("--- foo18d"       NL
+                                  "+++ bar18d"       NL
+                                  "@@ -1,4 +1,4 @@"  NL
+                                  "-Aa\n"
+                                  "+Cc\n"
+                                  " Xx\n"
+                                  " Xx\n"
+                                  " Xx\n"
+                                  "@@ -64,4 +64,4 @@" NL
+                                  " Xx\n"
+                                  " Xx\n"
+                                  " Xx\n"
+                                  "-Bb\n"
+                                  "+Dd\n",
+                                  pool);
+
+  SVN_ERR(two_way_diff("foo18d", "bar18d",
+                       original->data, modified->data, expected->data,
+                       diff_opts, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Receiver baton for test_batch_file_diff(). */
+struct batch_diff_baton
+{
+  svn_stringbuf_t *actual;
+  int count;
+};
+
+/* Append the unified output for DIFF to the baton's buffer, labelled
+   with the pair's position in the batch.  Implements
+   svn_diff__file_pair_receiver_t. */
+static svn_error_t *
+batch_diff_receiver(svn_diff_t *diff,
+                    const svn_diff__file_pair_t *pair,
+                    void *receiver_baton,
+                    apr_pool_t *scratch_pool)
+{
+  struct batch_diff_baton *bdb = receiver_baton;
+  svn_stream_t *ostream;
+  const char *label1 = apr_psprintf(scratch_pool, "o%d", bdb->count);
+  const char *label2 = apr_psprintf(scratch_pool, "m%d", bdb->count);
+
+  bdb->count++;
+
+  ostream = svn_stream_from_stringbuf(bdb->actual, scratch_pool);
+  SVN_ERR(svn_diff_file_output_unified2(ostream, diff,
+                                        pair->original, pair->modified,
+                                        label1, label2,
+                                        SVN_APR_LOCALE_CHARSET,
+                                        scratch_pool));
+  SVN_ERR(svn_stream_close(ostream));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_batch_file_diff(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *diff_opts = svn_diff_file_options_create(pool);
+  apr_array_header_t *pairs
+    = apr_array_make(pool, 3, sizeof(svn_diff__file_pair_t));
+  struct batch_diff_baton bdb;
+  const char *expected;
+  int i;
+
+  static const char *originals[] = { "Aa\n", "Xx\nBb\n", "Cc\n" };
+  static const char *modifieds[] = { "Zz\n", "Xx\nQq\n", "Cc\n" };
+
+  for (i = 0; i < 3; i++)
+    {
+      svn_diff__file_pair_t *pair = apr_array_push(pairs);
+
+      pair->original
+        = svn_test_data_path(apr_psprintf(pool, "batch-o%d", i), pool);
+      pair->modified
+        = svn_test_data_path(apr_psprintf(pool, "batch-m%d", i), pool);
+
+      SVN_ERR(make_file(pair->original, originals[i], pool));
+      SVN_ERR(make_file(pair->modified, modifieds[i], pool));
+    }
+
+  bdb.actual = svn_stringbuf_create_empty(pool);
+  bdb.count = 0;
+
+  SVN_ERR(svn_diff__file_diff_pairs(pairs, diff_opts, 2,
+                                    batch_diff_receiver, &bdb,
+                                    NULL, NULL, pool));
+
+  expected = "--- o0"           NL
+             "+++ m0"           NL
+             "@@ -1 +1 @@"      NL
+             "-Aa\n"
+             "+Zz\n"
+             "--- o1"           NL
+             "+++ m1"           NL
+             "@@ -1,2 +1,2 @@"  NL
+             " Xx\n"
+             "-Bb\n"
+             "+Qq\n";
+
+  if (bdb.count != 3)
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                             "expected 3 results, got %d", bdb.count);
+
+  if (strcmp(bdb.actual->data, expected) != 0)
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                             "batch outputs differ.\nEXPECTED:\n%s\n"
+                             "ACTUAL:\n%s\n", expected, bdb.actual->data);
+
+  return SVN_NO_ERROR;
+}
+
 /* ========================================================================== */
 
 
@@ -3109,6 +3312,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "2-way issue #3362 test v2"),
     SVN_TEST_XFAIL2(three_way_double_add,
                    "3-way merge, double add"),
+    SVN_TEST_PASS2(test_two_way_histogram,
+                   "2-way diff using the histogram algorithm"),
+    SVN_TEST_PASS2(test_batch_file_diff,
+                   "batched diff of multiple file pairs"),
     SVN_TEST_NULL
   };
 
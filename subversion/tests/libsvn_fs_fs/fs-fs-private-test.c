@@ -28,6 +28,7 @@
 #include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
+#include "svn_dirent_uri.h"
 #include "svn_fs.h"
 
 #include "private/svn_string_private.h"
@@ -499,6 +500,187 @@ build_rep_cache(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* On-disk layout constants of the rep-cache hash file, mirroring the
+ * rcf_* backend in libsvn_fs_fs/rep-cache.c.  The test below builds and
+ * corrupts files of that format byte by byte. */
+#define RCF_MAGIC "SVN rep-cache 1\n"
+#define RCF_HEADER_SIZE 64
+#define RCF_SLOT_SIZE 64
+#define RCF_CAPACITY_OFFSET 16
+#define RCF_SLOT_REVISION 20
+
+/* Overwrite the byte at OFFSET in the file at PATH with VALUE. */
+static svn_error_t *
+poke_file_byte(const char *path,
+               apr_off_t offset,
+               unsigned char value,
+               apr_pool_t *scratch_pool)
+{
+  apr_file_t *file;
+
+  SVN_ERR(svn_io_file_open(&file, path, APR_FOPEN_READ | APR_FOPEN_WRITE,
+                           APR_OS_DEFAULT, scratch_pool));
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, &value, 1, NULL, scratch_pool));
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements the walker of svn_fs_fs__walk_rep_reference(), counting
+ * the entries in *BATON. */
+static svn_error_t *
+count_reps_walker(representation_t *rep,
+                  void *baton,
+                  svn_fs_t *fs,
+                  apr_pool_t *scratch_pool)
+{
+  int *count = baton;
+
+  ++*count;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+rep_cache_file_backend(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  svn_boolean_t exists;
+  const char *fs_path = "test-repo-rep-cache-file-backend";
+  const char *cache_path;
+  svn_stringbuf_t *contents;
+  representation_t rep = { 0 };
+  representation_t *found;
+  svn_checksum_t checksum;
+  unsigned char digest[APR_SHA1_DIGESTSIZE] = { 0 };
+  int count;
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support FSFS rep-sharing");
+
+  /* Create a filesystem and select the hash file backend. */
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, pool));
+  ffd = fs->fsap_data;
+  ffd->rep_cache_file_backend = TRUE;
+
+  /* Add the Greek tree.  The commit creates the hash file on demand and
+     populates it through the regular write path. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  SVN_ERR(svn_fs_fs__exists_rep_cache(&exists, fs, pool));
+  SVN_TEST_ASSERT(exists);
+
+  /* A checksum never added must miss without an error. */
+  checksum.kind = svn_checksum_sha1;
+  checksum.digest = digest;
+  digest[0] = 0xaa;
+  SVN_ERR(svn_fs_fs__get_rep_reference(&found, fs, &checksum, pool));
+  SVN_TEST_ASSERT(found == NULL);
+
+  /* Replace the cache with an empty table of just 4 slots so that a
+     handful of insertions already exceeds the load factor limit. */
+  cache_path = svn_dirent_join(fs_path, "rep-cache.hash", pool);
+  SVN_ERR(svn_fs_fs__close_rep_cache(fs));
+  contents = svn_stringbuf_create(RCF_MAGIC, pool);
+  svn_stringbuf_appendbyte(contents, 4);   /* capacity, little-endian */
+  while (contents->len < RCF_HEADER_SIZE + 4 * RCF_SLOT_SIZE)
+    svn_stringbuf_appendbyte(contents, 0);
+  SVN_ERR(svn_io_file_create_bytes(cache_path, contents->data,
+                                   contents->len, pool));
+
+  /* Insert 4 entries.  Entry I hashes to bucket I, so the small table
+     fills up and the 4th insertion must double it. */
+  for (i = 1; i <= 4; i++)
+    {
+      memset(digest, 0, sizeof(digest));
+      digest[0] = (unsigned char)i;
+      memcpy(rep.sha1_digest, digest, sizeof(digest));
+      rep.has_sha1 = TRUE;
+      rep.revision = rev;
+      rep.item_index = 10 + i;
+      rep.size = 100 + i;
+      rep.expanded_size = 200 + i;
+      SVN_ERR(svn_fs_fs__set_rep_reference(fs, &rep, pool));
+    }
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, cache_path, pool));
+  SVN_TEST_INT_ASSERT((unsigned char)contents->data[RCF_CAPACITY_OFFSET], 8);
+  SVN_TEST_INT_ASSERT((int)contents->len,
+                      RCF_HEADER_SIZE + 8 * RCF_SLOT_SIZE);
+
+  /* All entries must have survived the growth. */
+  for (i = 1; i <= 4; i++)
+    {
+      memset(digest, 0, sizeof(digest));
+      digest[0] = (unsigned char)i;
+      SVN_ERR(svn_fs_fs__get_rep_reference(&found, fs, &checksum, pool));
+      SVN_TEST_ASSERT(found != NULL);
+      SVN_TEST_INT_ASSERT((int)found->revision, (int)rev);
+      SVN_TEST_INT_ASSERT((int)found->item_index, 10 + i);
+      SVN_TEST_INT_ASSERT((int)found->size, 100 + i);
+      SVN_TEST_INT_ASSERT((int)found->expanded_size, 200 + i);
+    }
+
+  count = 0;
+  SVN_ERR(svn_fs_fs__walk_rep_reference(fs, 0, SVN_INVALID_REVNUM,
+                                        count_reps_walker, &count,
+                                        NULL, NULL, pool));
+  SVN_TEST_INT_ASSERT(count, 4);
+
+  /* Corrupt the slot of the first entry, i.e. slot 1 of the grown
+     table.  Lookups must skip the damaged slot instead of erroring
+     out, and re-inserting the entry must reuse it. */
+  SVN_ERR(svn_fs_fs__close_rep_cache(fs));
+  SVN_ERR(poke_file_byte(cache_path,
+                         RCF_HEADER_SIZE + RCF_SLOT_SIZE + RCF_SLOT_REVISION,
+                         0xff, pool));
+
+  memset(digest, 0, sizeof(digest));
+  digest[0] = 1;
+  SVN_ERR(svn_fs_fs__get_rep_reference(&found, fs, &checksum, pool));
+  SVN_TEST_ASSERT(found == NULL);
+
+  digest[0] = 2;
+  SVN_ERR(svn_fs_fs__get_rep_reference(&found, fs, &checksum, pool));
+  SVN_TEST_ASSERT(found != NULL);
+
+  digest[0] = 1;
+  memcpy(rep.sha1_digest, digest, sizeof(digest));
+  rep.item_index = 11;
+  rep.size = 101;
+  rep.expanded_size = 201;
+  SVN_ERR(svn_fs_fs__set_rep_reference(fs, &rep, pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&found, fs, &checksum, pool));
+  SVN_TEST_ASSERT(found != NULL);
+  SVN_TEST_INT_ASSERT((int)found->item_index, 11);
+
+  /* A damaged header must surface as a corruption error. */
+  SVN_ERR(svn_fs_fs__close_rep_cache(fs));
+  SVN_ERR(poke_file_byte(cache_path, 0, 'X', pool));
+  SVN_TEST_ASSERT_ERROR(svn_fs_fs__get_rep_reference(&found, fs, &checksum,
+                                                     pool),
+                        SVN_ERR_FS_CORRUPT);
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* The test table.  */
@@ -516,6 +698,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "load the P2L index"),
     SVN_TEST_OPTS_PASS(build_rep_cache,
                        "build the representation cache"),
+    SVN_TEST_OPTS_PASS(rep_cache_file_backend,
+                       "rep-cache hash file backend"),
     SVN_TEST_NULL
   };
 
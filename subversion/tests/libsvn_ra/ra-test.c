@@ -37,9 +37,13 @@
 #include "svn_dirent_uri.h"
 #include "svn_hash.h"
 
+#include "private/svn_ra_private.h"
+
 #include "../svn_test.h"
 #include "../svn_test_fs.h"
 #include "../../libsvn_ra_local/ra_local.h"
+#include "../../libsvn_ra/ra_loader.h"
+#include "../../libsvn_ra_svn/ra_svn.h"
 
 /*-------------------------------------------------------------------*/
 
@@ -1612,6 +1616,153 @@ tunnel_run_checkout(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Baton for get_files_open_stream(). */
+struct get_files_baton_t
+{
+  /* Path -> svn_stringbuf_t * mapping of the contents received so far. */
+  apr_hash_t *contents;
+  apr_pool_t *pool;
+};
+
+/* Implements svn_ra__open_file_stream_cb_t, collecting each file's
+   contents in BATON->contents. */
+static svn_error_t *
+get_files_open_stream(svn_stream_t **stream,
+                      void *baton,
+                      const char *path,
+                      apr_pool_t *pool)
+{
+  struct get_files_baton_t *b = baton;
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(b->pool);
+
+  svn_hash_sets(b->contents, apr_pstrdup(b->pool, path), buffer);
+  *stream = svn_stream_from_stringbuf(buffer, pool);
+  return SVN_NO_ERROR;
+}
+
+/* Commit r1, adding files "f" and "g" with distinct contents. */
+static svn_error_t *
+commit_file_contents(svn_ra_session_t *session,
+                     apr_pool_t *pool)
+{
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  void *root_baton, *file_baton;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  SVN_ERR(svn_ra_get_commit_editor3(session, &editor, &edit_baton,
+                                    apr_hash_make(pool),
+                                    NULL, NULL, NULL, TRUE, pool));
+  SVN_ERR(editor->open_root(edit_baton, SVN_INVALID_REVNUM,
+                            pool, &root_baton));
+  SVN_ERR(editor->add_file("f", root_baton, NULL, SVN_INVALID_REVNUM,
+                           pool, &file_baton));
+  SVN_ERR(editor->apply_textdelta(file_baton, NULL, pool, &handler,
+                                  &handler_baton));
+  SVN_ERR(svn_txdelta_send_string(svn_string_create("f's contents", pool),
+                                  handler, handler_baton, pool));
+  SVN_ERR(editor->close_file(file_baton, NULL, pool));
+  SVN_ERR(editor->add_file("g", root_baton, NULL, SVN_INVALID_REVNUM,
+                           pool, &file_baton));
+  SVN_ERR(editor->apply_textdelta(file_baton, NULL, pool, &handler,
+                                  &handler_baton));
+  SVN_ERR(svn_txdelta_send_string(svn_string_create("g's contents", pool),
+                                  handler, handler_baton, pool));
+  SVN_ERR(editor->close_file(file_baton, NULL, pool));
+  SVN_ERR(editor->close_directory(root_baton, pool));
+  SVN_ERR(editor->close_edit(edit_baton, pool));
+  return SVN_NO_ERROR;
+}
+
+/* Fetch "f" and "g"@1 through svn_ra__get_files() on SESSION and
+   verify the contents committed by commit_file_contents(). */
+static svn_error_t *
+check_get_files(svn_ra_session_t *session,
+                apr_pool_t *pool)
+{
+  struct get_files_baton_t b;
+  apr_array_header_t *paths = apr_array_make(pool, 2, sizeof(const char *));
+  svn_stringbuf_t *buffer;
+
+  b.contents = apr_hash_make(pool);
+  b.pool = pool;
+  APR_ARRAY_PUSH(paths, const char *) = "f";
+  APR_ARRAY_PUSH(paths, const char *) = "g";
+
+  SVN_ERR(svn_ra__get_files(session, paths, 1, get_files_open_stream, &b,
+                            pool));
+
+  SVN_TEST_INT_ASSERT(apr_hash_count(b.contents), 2);
+  buffer = svn_hash_gets(b.contents, "f");
+  SVN_TEST_ASSERT(buffer);
+  SVN_TEST_STRING_ASSERT(buffer->data, "f's contents");
+  buffer = svn_hash_gets(b.contents, "g");
+  SVN_TEST_ASSERT(buffer);
+  SVN_TEST_STRING_ASSERT(buffer->data, "g's contents");
+
+  return SVN_NO_ERROR;
+}
+
+/* Round-trip test for svn_ra__get_files() over ra_svn: once batched
+   via the get-files command and once over the single-file fallback
+   that kicks in when the server lacks the capability. */
+static svn_error_t *
+tunnel_get_files(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  tunnel_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  const char *url;
+  svn_ra_callbacks2_t *cbtable;
+  svn_ra_session_t *session;
+  svn_ra_svn__session_baton_t *sess_baton;
+  const char tunnel_repos_name[] = "test-get_files";
+
+  b->magic = TUNNEL_MAGIC;
+
+  SVN_ERR(svn_test__create_repos(NULL, tunnel_repos_name, opts, scratch_pool));
+
+  /* Immediately close the repository to avoid race condition with svnserve
+     (and then the cleanup code) with BDB when our pool is cleared. */
+  svn_pool_clear(scratch_pool);
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", tunnel_repos_name,
+                    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = b;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+                                         TRUE  /* non_interactive */,
+                                         "jrandom", "rayjandom",
+                                         NULL,
+                                         TRUE  /* no_auth_cache */,
+                                         FALSE /* trust_server_cert */,
+                                         FALSE, FALSE, FALSE, FALSE,
+                                         NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open5(&session, NULL, NULL, url, NULL, cbtable, NULL, NULL,
+                       scratch_pool));
+
+  SVN_ERR(commit_file_contents(session, pool));
+
+  /* The server announces the get-files capability, so this round trip
+     uses the batched wire command. */
+  SVN_ERR(check_get_files(session, pool));
+
+  /* Drop the capability from the connection to mimic a pre-1.15 server;
+     svn_ra__get_files() must now fall back to fetching the files one by
+     one and still deliver the same results. */
+  sess_baton = session->priv;
+  svn_hash_sets(sess_baton->conn->capabilities, SVN_RA_SVN_CAP_GET_FILES,
+                NULL);
+  SVN_ERR(check_get_files(session, pool));
+
+  svn_pool_destroy(scratch_pool);
+  return SVN_NO_ERROR;
+}
+
 /* Implements svn_log_entry_receiver_t for commit_empty_last_change */
 static svn_error_t *
 AA_receiver(void *baton,
@@ -1909,6 +2060,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "check list has_props performance"),
     SVN_TEST_OPTS_PASS(tunnel_run_checkout,
                        "verify checkout over a tunnel"),
+    SVN_TEST_OPTS_PASS(tunnel_get_files,
+                       "test svn_ra__get_files over a tunnel"),
     SVN_TEST_OPTS_PASS(commit_empty_last_change,
                        "check how last change applies to empty commit"),
     SVN_TEST_OPTS_PASS(commit_locked_file,
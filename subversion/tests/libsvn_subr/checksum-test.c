@@ -27,6 +27,9 @@
 
 #include "svn_error.h"
 #include "svn_io.h"
+#include "svn_sorts.h"
+
+#include "private/svn_subr_private.h"
 
 #include "../svn_test.h"
 
@@ -364,6 +367,45 @@ test_checksummed_stream_reset(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_checksummed_stream_bulk_write(apr_pool_t *pool)
+{
+  /* Large enough to push the write stream into background hashing. */
+  apr_size_t total = 4 * 1024 * 1024;
+  svn_stringbuf_t *data = svn_stringbuf_create_ensure(total, pool);
+  svn_checksum_kind_t kind;
+  apr_size_t i;
+
+  for (i = 0; i < total; ++i)
+    data->data[i] = (char)(i * 2654435761u >> 13);
+  data->len = total;
+
+  for (kind = svn_checksum_md5; kind <= svn_checksum_sha1; ++kind)
+    {
+      svn_stream_t *stream;
+      svn_checksum_t *expected_checksum;
+      svn_checksum_t *actual_checksum;
+      apr_size_t chunk = 100001;  /* not block-aligned on purpose */
+
+      stream = svn_checksum__wrap_write_stream(&actual_checksum,
+                                               svn_stream_empty(pool),
+                                               kind, pool);
+      for (i = 0; i < total; i += chunk)
+        {
+          apr_size_t len = MIN(chunk, total - i);
+          SVN_ERR(svn_stream_write(stream, data->data + i, &len));
+        }
+
+      SVN_ERR(svn_stream_close(stream));
+
+      SVN_ERR(svn_checksum(&expected_checksum, kind,
+                           data->data, data->len, pool));
+      SVN_TEST_ASSERT(svn_checksum_match(expected_checksum, actual_checksum));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* An array of all test functions */
 
 static int max_threads = 1;
@@ -389,6 +431,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "read from checksummed stream"),
     SVN_TEST_PASS2(test_checksummed_stream_reset,
                    "reset checksummed stream"),
+    SVN_TEST_PASS2(test_checksummed_stream_bulk_write,
+                   "bulk write through checksummed stream"),
     SVN_TEST_NULL
   };
 
@@ -36,6 +36,9 @@
 #include "svn_error.h"
 #include "svn_hash.h"
 
+#include "private/svn_string_private.h"
+#include "private/svn_subr_private.h"
+
 
 /* Our own global variables */
 static apr_hash_t *proplist, *new_proplist;
@@ -230,6 +233,50 @@ read_hash_buffered_test(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+binary_roundtrip_test(apr_pool_t *pool)
+{
+  apr_hash_t *ht;
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+  svn_string_t *content;
+
+  /* Write hash table in the binary representation. */
+  ht = apr_hash_make(pool);
+  svn_hash_sets(ht, "color", svn_string_create("red", pool));
+  svn_hash_sets(ht, "wine review", svn_string_create(review, pool));
+  svn_hash_sets(ht, "price", svn_string_create("US $6.50", pool));
+  svn_hash_sets(ht, "empty", svn_string_create("", pool));
+  svn_hash_sets(ht, "binary",
+                svn_string_ncreate("\0\1\2\3", 4, pool));
+
+  SVN_ERR(svn_hash__write_binary(ht, svn_stream_from_stringbuf(buffer, pool),
+                                 pool));
+
+  /* Read it back and compare. */
+  content = svn_stringbuf__morph_into_string(buffer);
+  ht = apr_hash_make(pool);
+  SVN_ERR(svn_hash__read_binary(ht, content, pool));
+
+  SVN_TEST_STRING_ASSERT(hash_gets_stringt(ht, "color"), "red");
+  SVN_TEST_STRING_ASSERT(hash_gets_stringt(ht, "wine review"), review);
+  SVN_TEST_STRING_ASSERT(hash_gets_stringt(ht, "price"), "US $6.50");
+  SVN_TEST_STRING_ASSERT(hash_gets_stringt(ht, "empty"), "");
+  SVN_TEST_ASSERT(svn_string_compare(svn_hash_gets(ht, "binary"),
+                                     svn_string_ncreate("\0\1\2\3", 4,
+                                                        pool)));
+  SVN_TEST_ASSERT(apr_hash_count(ht) == 5);
+
+  /* The textual hashdump format must not be mistaken for binary data. */
+  ht = apr_hash_make(pool);
+  SVN_TEST_ASSERT_ERROR(svn_hash__read_binary(
+                          ht, svn_string_create("K 3\nfoo\nV 3\nbar\nEND\n",
+                                                pool),
+                          pool),
+                        SVN_ERR_MALFORMED_FILE);
+
+  return SVN_NO_ERROR;
+}
+
 
 /*
    ====================================================================
@@ -252,6 +299,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "write hash out, read back in, compare"),
     SVN_TEST_PASS2(read_hash_buffered_test,
                    "read hash from buffered file"),
+    SVN_TEST_PASS2(binary_roundtrip_test,
+                   "write binary hash out, read back in, compare"),
     SVN_TEST_NULL
   };
 
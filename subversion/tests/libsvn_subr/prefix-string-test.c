@@ -135,6 +135,28 @@ test_string_comparison(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_string_interning(apr_pool_t *pool)
+{
+  svn_prefix_interner__t *interner = svn_prefix_interner__create(pool);
+  const char *interned[TEST_CASE_COUNT];
+  int i;
+
+  /* intern all test strings */
+  for (i = 0; i < TEST_CASE_COUNT; ++i)
+    {
+      interned[i] = svn_prefix_interner__intern(interner, test_cases[i]);
+      SVN_TEST_STRING_ASSERT(interned[i], test_cases[i]);
+    }
+
+  /* interning them again must yield the same pointers */
+  for (i = 0; i < TEST_CASE_COUNT; ++i)
+    SVN_TEST_ASSERT(interned[i]
+                    == svn_prefix_interner__intern(interner, test_cases[i]));
+
+  return SVN_NO_ERROR;
+}
+
 /* An array of all test functions */
 
 static int max_threads = 1;
@@ -148,6 +170,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "create many strings"),
     SVN_TEST_PASS2(test_string_comparison,
                    "compare strings"),
+    SVN_TEST_PASS2(test_string_interning,
+                   "intern strings"),
     SVN_TEST_NULL
   };
 
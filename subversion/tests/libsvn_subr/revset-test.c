@@ -0,0 +1,190 @@
+/*
+ * revset-test.c:  a collection of svn_revset__* tests
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ====================================================================
+   To add tests, look toward the bottom of this file.
+
+*/
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <apr_pools.h>
+
+#include "../svn_test.h"
+
+#include "svn_error.h"
+#include "svn_mergeinfo.h"
+#include "private/svn_mergeinfo_private.h"
+
+/* Check that converting SET with the given INHERITABLE flag results in
+ * the rangelist described by EXPECTED (in mergeinfo rangelist syntax). */
+static svn_error_t *
+expect_rangelist(const svn_revset__t *set,
+                 svn_boolean_t inheritable,
+                 const char *expected,
+                 apr_pool_t *pool)
+{
+  svn_string_t *actual;
+  svn_rangelist_t *rangelist = svn_revset__to_rangelist(set, inheritable,
+                                                        pool);
+
+  SVN_ERR(svn_rangelist_to_string(&actual, rangelist, pool));
+  SVN_TEST_STRING_ASSERT(actual->data, expected);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_empty_set(apr_pool_t *pool)
+{
+  svn_revset__t *set = svn_revset__create(pool);
+
+  SVN_TEST_ASSERT(!svn_revset__contains(set, 1));
+  SVN_TEST_ASSERT(svn_revset__to_rangelist(set, TRUE, pool)->nelts == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_add_and_contains(apr_pool_t *pool)
+{
+  svn_revset__t *set = svn_revset__create(pool);
+
+  /* Adjacent, overlapping and detached ranges. */
+  svn_revset__add_range(set, 3, 5);
+  svn_revset__add_range(set, 5, 9);
+  svn_revset__add_range(set, 12, 12);
+
+  SVN_TEST_ASSERT(!svn_revset__contains(set, 2));
+  SVN_TEST_ASSERT(svn_revset__contains(set, 3));
+  SVN_TEST_ASSERT(svn_revset__contains(set, 9));
+  SVN_TEST_ASSERT(!svn_revset__contains(set, 10));
+  SVN_TEST_ASSERT(svn_revset__contains(set, 12));
+
+  SVN_ERR(expect_rangelist(set, TRUE, "3-9,12", pool));
+
+  /* A range spanning a container boundary. */
+  svn_revset__add_range(set, 0xffff, 0x10001);
+
+  SVN_TEST_ASSERT(!svn_revset__contains(set, 0xfffe));
+  SVN_TEST_ASSERT(svn_revset__contains(set, 0xffff));
+  SVN_TEST_ASSERT(svn_revset__contains(set, 0x10000));
+  SVN_TEST_ASSERT(svn_revset__contains(set, 0x10001));
+  SVN_TEST_ASSERT(!svn_revset__contains(set, 0x10002));
+
+  SVN_ERR(expect_rangelist(set, TRUE, "3-9,12,65535-65537", pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_set_operations(apr_pool_t *pool)
+{
+  svn_revset__t *lhs = svn_revset__create(pool);
+  svn_revset__t *rhs = svn_revset__create(pool);
+
+  svn_revset__add_range(lhs, 1, 10);
+  svn_revset__add_range(lhs, 100000, 100010);
+  svn_revset__add_range(rhs, 5, 200);
+
+  SVN_ERR(expect_rangelist(svn_revset__union(lhs, rhs, pool), TRUE,
+                           "1-200,100000-100010", pool));
+  SVN_ERR(expect_rangelist(svn_revset__intersect(lhs, rhs, pool), TRUE,
+                           "5-10", pool));
+  SVN_ERR(expect_rangelist(svn_revset__minus(lhs, rhs, pool), TRUE,
+                           "1-4,100000-100010", pool));
+  SVN_ERR(expect_rangelist(svn_revset__minus(rhs, lhs, pool), TRUE,
+                           "11-200", pool));
+
+  /* Non-inheritable ranges get flagged upon conversion. */
+  SVN_ERR(expect_rangelist(svn_revset__minus(lhs, rhs, pool), FALSE,
+                           "1-4*,100000-100010*", pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dense_sets(apr_pool_t *pool)
+{
+  svn_revset__t *odd = svn_revset__create(pool);
+  svn_revset__t *low = svn_revset__create(pool);
+  svn_revset__t *result;
+  svn_revnum_t revision;
+
+  /* 10000 separate elements force the bitmap representation. */
+  for (revision = 1; revision < 20000; revision += 2)
+    svn_revset__add_range(odd, revision, revision);
+
+  for (revision = 1; revision < 20000; revision += 2)
+    {
+      SVN_TEST_ASSERT(svn_revset__contains(odd, revision));
+      SVN_TEST_ASSERT(!svn_revset__contains(odd, revision + 1));
+    }
+
+  SVN_TEST_ASSERT(svn_revset__to_rangelist(odd, TRUE, pool)->nelts == 10000);
+
+  /* Operations between sparse and dense sets. */
+  svn_revset__add_range(low, 1, 9999);
+
+  result = svn_revset__minus(odd, low, pool);
+  SVN_TEST_ASSERT(!svn_revset__contains(result, 9999));
+  SVN_TEST_ASSERT(svn_revset__contains(result, 10001));
+  SVN_TEST_ASSERT(svn_revset__to_rangelist(result, TRUE, pool)->nelts
+                  == 5000);
+
+  result = svn_revset__intersect(odd, low, pool);
+  SVN_TEST_ASSERT(svn_revset__contains(result, 9999));
+  SVN_TEST_ASSERT(!svn_revset__contains(result, 10001));
+  SVN_TEST_ASSERT(svn_revset__to_rangelist(result, TRUE, pool)->nelts
+                  == 5000);
+
+  result = svn_revset__union(odd, low, pool);
+  SVN_TEST_ASSERT(svn_revset__contains(result, 9998));
+  SVN_TEST_ASSERT(!svn_revset__contains(result, 10000));
+  SVN_TEST_ASSERT(svn_revset__to_rangelist(result, TRUE, pool)->nelts
+                  == 5001);
+
+  return SVN_NO_ERROR;
+}
+
+/* An array of all test functions */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(test_empty_set,
+                   "check empty sets"),
+    SVN_TEST_PASS2(test_add_and_contains,
+                   "add ranges and query containment"),
+    SVN_TEST_PASS2(test_set_operations,
+                   "union / intersect / minus"),
+    SVN_TEST_PASS2(test_dense_sets,
+                   "operations on dense sets"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
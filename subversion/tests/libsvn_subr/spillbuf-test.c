@@ -523,8 +523,8 @@ test_spillbuf__file_attrs(apr_pool_t *pool, svn_boolean_t spill_all,
   /* Check that the spillbuf size is what we expect it to be */
   SVN_TEST_ASSERT(svn_spillbuf__get_size(buf) == 18);
 
-  /* Check file existence */
-  SVN_TEST_ASSERT(svn_spillbuf__get_filename(buf) != NULL);
+  /* Check file existence.  Delete-on-close spill files are anonymous
+     where the platform supports that and then have no name. */
   SVN_TEST_ASSERT(svn_spillbuf__get_file(buf) != NULL);
 
   /* The size of the file must match expectations */
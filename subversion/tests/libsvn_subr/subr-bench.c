@@ -0,0 +1,204 @@
+/* subr-bench.c -- microbenchmarks for libsvn_subr hot kernels
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#define APR_WANT_STDIO
+#include <apr_want.h>
+
+#include <apr_general.h>
+#include <apr_strings.h>
+
+#include "svn_error.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+
+#include "private/svn_cache.h"
+
+/* Total payload per stringbuf benchmark pass. */
+#define STRINGBUF_TOTAL 0x4000000
+
+/* Geometry of the membuffer benchmark. */
+#define MEMBUFFER_SIZE 0x4000000
+#define ENTRY_COUNT 0x10000
+#define VALUE_SIZE 256
+#define GET_ROUNDS 8
+
+/* Simple linear congruential generator so that every run processes the
+ * exact same corpus, regardless of platform and libc. */
+static apr_uint32_t prng_state = 0x12345678;
+
+static apr_uint32_t
+prng(void)
+{
+  prng_state = prng_state * 1664525u + 1013904223u;
+  return prng_state;
+}
+
+/* Fill the LEN bytes at BUFFER with printable pseudo-random data. */
+static void
+fill_buffer(char *buffer, apr_size_t len)
+{
+  apr_size_t i;
+  for (i = 0; i < len; ++i)
+    buffer[i] = (char)(' ' + (prng() % 94));
+}
+
+/* Measure svn_stringbuf_appendbytes() throughput for various chunk
+ * sizes.  Use POOL for allocations. */
+static svn_error_t *
+bench_stringbuf(apr_pool_t *pool)
+{
+  static const apr_size_t chunk_sizes[] = { 1, 16, 4096 };
+  unsigned i;
+
+  for (i = 0; i < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); ++i)
+    {
+      apr_size_t chunk_size = chunk_sizes[i];
+      char *chunk = apr_palloc(pool, chunk_size);
+      apr_pool_t *subpool = svn_pool_create(pool);
+      svn_stringbuf_t *target = svn_stringbuf_create_empty(subpool);
+      apr_size_t appended;
+      apr_time_t start, taken;
+
+      fill_buffer(chunk, chunk_size);
+
+      start = apr_time_now();
+      for (appended = 0; appended < STRINGBUF_TOTAL; appended += chunk_size)
+        svn_stringbuf_appendbytes(target, chunk, chunk_size);
+      taken = apr_time_now() - start;
+
+      printf("stringbuf append, %5d byte chunks: %10.1f MB/s\n",
+             (int)chunk_size,
+             STRINGBUF_TOTAL / (1048576.0 * taken / 1.0e6));
+
+      svn_pool_destroy(subpool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__serialize_func_t for fixed-size blobs. */
+static svn_error_t *
+serialize_blob(void **data,
+               apr_size_t *data_len,
+               void *in,
+               apr_pool_t *pool)
+{
+  *data_len = VALUE_SIZE;
+  *data = apr_pmemdup(pool, in, *data_len);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t for fixed-size blobs. */
+static svn_error_t *
+deserialize_blob(void **out,
+                 void *data,
+                 apr_size_t data_len,
+                 apr_pool_t *pool)
+{
+  *out = data;
+
+  return SVN_NO_ERROR;
+}
+
+/* Measure membuffer cache store and lookup throughput.  Use POOL for
+ * allocations. */
+static svn_error_t *
+bench_membuffer(apr_pool_t *pool)
+{
+  svn_membuffer_t *membuffer;
+  svn_cache__t *cache;
+  char *value = apr_palloc(pool, VALUE_SIZE);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_time_t start, taken;
+  int i, round;
+
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, MEMBUFFER_SIZE,
+                                            MEMBUFFER_SIZE / 5, 0,
+                                            FALSE, FALSE, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(&cache, membuffer,
+                                            serialize_blob,
+                                            deserialize_blob,
+                                            APR_HASH_KEY_STRING,
+                                            "bench:",
+                                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            FALSE, FALSE, pool, pool));
+
+  fill_buffer(value, VALUE_SIZE);
+
+  start = apr_time_now();
+  for (i = 0; i < ENTRY_COUNT; ++i)
+    {
+      const char *key;
+
+      svn_pool_clear(iterpool);
+      key = apr_psprintf(iterpool, "key-%d", i);
+      SVN_ERR(svn_cache__set(cache, key, value, iterpool));
+    }
+  taken = apr_time_now() - start;
+
+  printf("membuffer store, %3d byte values:   %10.0f entries/s\n",
+         VALUE_SIZE, ENTRY_COUNT / (taken / 1.0e6));
+
+  start = apr_time_now();
+  for (round = 0; round < GET_ROUNDS; ++round)
+    for (i = 0; i < ENTRY_COUNT; ++i)
+      {
+        const char *key;
+        void *data;
+        svn_boolean_t found;
+
+        svn_pool_clear(iterpool);
+        key = apr_psprintf(iterpool, "key-%d", i);
+        SVN_ERR(svn_cache__get(&data, &found, cache, key, iterpool));
+      }
+  taken = apr_time_now() - start;
+
+  printf("membuffer lookup:                   %10.0f entries/s\n",
+         (GET_ROUNDS * (double)ENTRY_COUNT) / (taken / 1.0e6));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+int
+main(int argc, char **argv)
+{
+  apr_pool_t *pool;
+  svn_error_t *err;
+
+  apr_initialize();
+  pool = svn_pool_create(NULL);
+
+  err = bench_stringbuf(pool);
+  if (!err)
+    err = bench_membuffer(pool);
+
+  if (err)
+    svn_handle_error2(err, stderr, TRUE, "subr-bench: ");
+
+  svn_pool_destroy(pool);
+  apr_terminate();
+
+  return 0;
+}
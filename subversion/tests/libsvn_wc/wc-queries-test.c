@@ -254,6 +254,8 @@ stmt_matches_wc_format(int stmt_num,
     case STMT_TEXTBASE_SYNC:
     case STMT_SELECT_SETTINGS:
     case STMT_UPSERT_SETTINGS:
+    case STMT_UPDATE_NODE_FILEINFO_F32:
+    case STMT_SELECT_TRANSLATED_CHECKSUM:
       return (wc_format >= 32);
     }
   return TRUE;
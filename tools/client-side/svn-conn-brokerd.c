@@ -0,0 +1,447 @@
+/* svn-conn-brokerd.c -- hold warm TCP connections for svn:// clients
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* This is a small per-user helper daemon that keeps established TCP
+ * connections to svnserve hosts and hands them to svn client processes
+ * on request, saving the DNS lookup and TCP handshake that every CLI
+ * invocation would otherwise pay.
+ *
+ * Usage: svn-conn-brokerd SOCKET_PATH [--idle-timeout SECONDS]
+ *
+ * The daemon listens on the Unix domain socket at SOCKET_PATH.  Clients
+ * (libsvn_ra_svn, when the SVN_RA_SVN_CONNECTION_BROKER environment
+ * variable names that socket) connect, send a single "host:port\n" line
+ * and receive a one byte reply: '1' with the connected TCP socket
+ * attached as SCM_RIGHTS ancillary data, or '0' if no connection could
+ * be provided.  After handing out a connection, the daemon immediately
+ * opens a replacement so the next invocation for the same host finds a
+ * warm spare again.
+ *
+ * Spare connections that have been idle for longer than the idle
+ * timeout (default 300 seconds) are closed.  A spare on which the peer
+ * has sent data or an EOF is stale -- the svn protocol server speaks
+ * first, so an unclaimed greeting would confuse the next client -- and
+ * is discarded instead of handed out.
+ *
+ * Note that only the TCP connection is reused.  Protocol greeting,
+ * authentication and any TLS-like state are per-process and are
+ * re-established by the client on the warm socket.
+ *
+ * The listening socket is created accessible to its owner only:  any
+ * user who could connect would be able to drain the warm spares or use
+ * the daemon as a relay for outbound TCP connections.  Clients in turn
+ * refuse broker sockets not owned by themselves, so SOCKET_PATH should
+ * point into a directory other users cannot write to, e.g. one created
+ * with mode 0700.
+ */
+
+#include <stdio.h>
+
+#ifdef WIN32
+
+int main(void)
+{
+  fprintf(stderr, "svn-conn-brokerd is not supported on this platform\n");
+  return 1;
+}
+
+#else /* !WIN32 */
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* Maximum number of spare connections held at any one time. */
+#define MAX_SPARES 32
+
+/* Maximum length of a "host:port" request line, including terminator. */
+#define MAX_REQUEST 1024
+
+/* A warm spare connection to one host:port target. */
+typedef struct spare_t
+{
+  char target[MAX_REQUEST];   /* "host:port"; empty means slot unused */
+  int fd;                     /* the connected TCP socket */
+  time_t created;             /* when the connection was established */
+} spare_t;
+
+static spare_t spares[MAX_SPARES];
+
+/* Path of our listening socket, for cleanup on exit. */
+static const char *socket_path;
+
+/* Set by the termination signal handlers. */
+static volatile sig_atomic_t terminated = 0;
+
+static void
+handle_term_signal(int signum)
+{
+  (void)signum;
+  terminated = 1;
+}
+
+/* Open a TCP connection to TARGET, a "host:port" string.  Return the
+ * connected socket or -1 on failure. */
+static int
+open_connection(const char *target)
+{
+  char host[MAX_REQUEST];
+  const char *colon = strrchr(target, ':');
+  struct addrinfo hints;
+  struct addrinfo *result, *ai;
+  int fd = -1;
+
+  if (!colon || colon == target || !colon[1]
+      || (size_t)(colon - target) >= sizeof(host))
+    return -1;
+
+  memcpy(host, target, colon - target);
+  host[colon - target] = '\0';
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host, colon + 1, &hints, &result) != 0)
+    return -1;
+
+  for (ai = result; ai; ai = ai->ai_next)
+    {
+      fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd < 0)
+        continue;
+
+      if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+        break;
+
+      close(fd);
+      fd = -1;
+    }
+
+  freeaddrinfo(result);
+  return fd;
+}
+
+/* Return TRUE iff the spare connection FD is still usable, i.e. the
+ * peer has neither closed it nor sent unclaimed data. */
+static int
+spare_is_live(int fd)
+{
+  struct pollfd pfd;
+
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  if (poll(&pfd, 1, 0) < 0)
+    return 0;
+
+  /* Readable means either EOF or data we cannot attribute. */
+  return (pfd.revents & (POLLIN | POLLERR | POLLHUP)) == 0;
+}
+
+/* Release the spare in SLOT. */
+static void
+drop_spare(spare_t *slot)
+{
+  close(slot->fd);
+  slot->target[0] = '\0';
+}
+
+/* Close all spares idle for longer than IDLE_TIMEOUT seconds. */
+static void
+sweep_spares(int idle_timeout)
+{
+  time_t now = time(NULL);
+  int i;
+
+  for (i = 0; i < MAX_SPARES; ++i)
+    if (spares[i].target[0] && now - spares[i].created > idle_timeout)
+      drop_spare(&spares[i]);
+}
+
+/* Remember FD as a spare connection to TARGET, replacing the oldest
+ * spare if the table is full. */
+static void
+add_spare(const char *target, int fd)
+{
+  spare_t *oldest = &spares[0];
+  int i;
+
+  for (i = 0; i < MAX_SPARES; ++i)
+    {
+      if (!spares[i].target[0])
+        {
+          oldest = &spares[i];
+          break;
+        }
+      if (spares[i].created < oldest->created)
+        oldest = &spares[i];
+    }
+
+  if (oldest->target[0])
+    drop_spare(oldest);
+
+  strcpy(oldest->target, target);
+  oldest->fd = fd;
+  oldest->created = time(NULL);
+}
+
+/* Take a live spare connection to TARGET out of the table and return
+ * its socket, or -1 if there is none.  Stale spares found on the way
+ * are dropped. */
+static int
+take_spare(const char *target)
+{
+  int i;
+
+  for (i = 0; i < MAX_SPARES; ++i)
+    {
+      if (!spares[i].target[0] || strcmp(spares[i].target, target) != 0)
+        continue;
+
+      if (spare_is_live(spares[i].fd))
+        {
+          int fd = spares[i].fd;
+          spares[i].target[0] = '\0';
+          return fd;
+        }
+
+      drop_spare(&spares[i]);
+    }
+
+  return -1;
+}
+
+/* Read one '\n'-terminated request line from CLIENT_FD into TARGET,
+ * stripping the terminator.  Return 0 on success, -1 on failure. */
+static int
+read_request(int client_fd, char *target)
+{
+  size_t len = 0;
+
+  while (len < MAX_REQUEST - 1)
+    {
+      char c;
+      ssize_t received = read(client_fd, &c, 1);
+
+      if (received < 0 && errno == EINTR)
+        continue;
+      if (received <= 0)
+        return -1;
+      if (c == '\n')
+        {
+          target[len] = '\0';
+          return len ? 0 : -1;
+        }
+
+      target[len++] = c;
+    }
+
+  return -1;
+}
+
+/* Send the one byte reply STATUS to CLIENT_FD, attaching CONN_FD as
+ * SCM_RIGHTS ancillary data if it is not -1. */
+static void
+send_reply(int client_fd, char status, int conn_fd)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  union {
+    struct cmsghdr align;
+    char buffer[CMSG_SPACE(sizeof(int))];
+  } control;
+  ssize_t sent;
+
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base = &status;
+  iov.iov_len = 1;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  if (conn_fd != -1)
+    {
+      struct cmsghdr *cmsg;
+
+      memset(control.buffer, 0, sizeof(control.buffer));
+      msg.msg_control = control.buffer;
+      msg.msg_controllen = sizeof(control.buffer);
+      cmsg = CMSG_FIRSTHDR(&msg);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_RIGHTS;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+      memcpy(CMSG_DATA(cmsg), &conn_fd, sizeof(conn_fd));
+    }
+
+  do
+    sent = sendmsg(client_fd, &msg, 0);
+  while (sent < 0 && errno == EINTR);
+}
+
+/* Answer the request pending on CLIENT_FD: hand out a spare or freshly
+ * opened connection and warm a replacement for the next invocation. */
+static void
+handle_client(int client_fd)
+{
+  char target[MAX_REQUEST];
+  int conn_fd;
+  int replacement;
+
+  if (read_request(client_fd, target) < 0)
+    {
+      send_reply(client_fd, '0', -1);
+      return;
+    }
+
+  conn_fd = take_spare(target);
+  if (conn_fd == -1)
+    conn_fd = open_connection(target);
+
+  send_reply(client_fd, conn_fd == -1 ? '0' : '1', conn_fd);
+
+  if (conn_fd != -1)
+    {
+      close(conn_fd);
+
+      /* The client got its connection; open the spare for next time. */
+      replacement = open_connection(target);
+      if (replacement != -1)
+        add_spare(target, replacement);
+    }
+}
+
+int
+main(int argc, const char *argv[])
+{
+  int idle_timeout = 300;
+  int listen_fd;
+  struct sockaddr_un addr;
+  struct sigaction sa;
+  mode_t old_umask;
+  int bound;
+  int i;
+
+  if (argc < 2 || argc > 4
+      || (argc >= 3 && strcmp(argv[2], "--idle-timeout") != 0)
+      || (argc == 3))
+    {
+      fprintf(stderr,
+              "usage: svn-conn-brokerd SOCKET_PATH "
+              "[--idle-timeout SECONDS]\n");
+      return 1;
+    }
+
+  socket_path = argv[1];
+  if (argc == 4)
+    {
+      idle_timeout = atoi(argv[3]);
+      if (idle_timeout <= 0)
+        {
+          fprintf(stderr, "svn-conn-brokerd: invalid idle timeout '%s'\n",
+                  argv[3]);
+          return 1;
+        }
+    }
+
+  if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+      fprintf(stderr, "svn-conn-brokerd: socket path too long\n");
+      return 1;
+    }
+
+  /* A handed-out connection may be closed by the client at any time. */
+  signal(SIGPIPE, SIG_IGN);
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = handle_term_signal;
+  sigaction(SIGTERM, &sa, NULL);
+  sigaction(SIGINT, &sa, NULL);
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+    {
+      perror("svn-conn-brokerd: socket");
+      return 1;
+    }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socket_path);
+  unlink(socket_path);
+
+  /* Restrict the socket to the owning user regardless of the inherited
+   * umask; the permissions must be in place before listen() makes the
+   * socket connectable. */
+  old_umask = umask(0077);
+  bound = bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+  umask(old_umask);
+  if (bound < 0
+      || listen(listen_fd, 8) < 0)
+    {
+      perror("svn-conn-brokerd: bind");
+      close(listen_fd);
+      return 1;
+    }
+
+  while (!terminated)
+    {
+      struct pollfd pfd;
+      int ready;
+
+      pfd.fd = listen_fd;
+      pfd.events = POLLIN;
+
+      /* Wake up at least once per second to sweep idle spares. */
+      ready = poll(&pfd, 1, 1000);
+      if (ready < 0 && errno != EINTR)
+        break;
+
+      sweep_spares(idle_timeout);
+
+      if (ready > 0 && (pfd.revents & POLLIN))
+        {
+          int client_fd = accept(listen_fd, NULL, NULL);
+
+          if (client_fd >= 0)
+            {
+              handle_client(client_fd);
+              close(client_fd);
+            }
+        }
+    }
+
+  for (i = 0; i < MAX_SPARES; ++i)
+    if (spares[i].target[0])
+      drop_spare(&spares[i]);
+
+  close(listen_fd);
+  unlink(socket_path);
+  return 0;
+}
+
+#endif /* WIN32 */
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+#
+# gen_corpus.py: synthesize a repository dump stream for benchmarking
+#
+# ====================================================================
+#    Licensed to the Apache Software Foundation (ASF) under one
+#    or more contributor license agreements.  See the NOTICE file
+#    distributed with this work for additional information
+#    regarding copyright ownership.  The ASF licenses this file
+#    to you under the Apache License, Version 2.0 (the
+#    "License"); you may not use this file except in compliance
+#    with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing,
+#    software distributed under the License is distributed on an
+#    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#    KIND, either express or implied.  See the License for the
+#    specific language governing permissions and limitations
+#    under the License.
+# ====================================================================
+#
+# Writes a deterministic "SVN-fs-dump-format-version: 2" stream to
+# stdout (or --output), suitable for piping into 'svnadmin load'.
+# The same seed and parameters always produce the same repository,
+# so benchmark runs on different builds measure the same data.
+#
+# The generated layout is trunk/ plus a tags/ directory that receives
+# a cheap copy of trunk every --tag-every revisions.  Revision 1 adds
+# the whole tree; every later revision modifies a random sample of
+# files, mimicking ordinary development history.  File sizes follow a
+# log-normal distribution around --file-size, which matches the long
+# tail seen in real repositories better than a fixed size does.
+#
+# Example, a ~100k file repository with 1000 revisions of history:
+#
+#   gen_corpus.py --depth 3 --dirs-per-dir 10 --files-per-dir 100 \
+#                 --revisions 1000 | svnadmin load --quiet repo
+
+import argparse
+import hashlib
+import math
+import random
+import sys
+
+SVN_DATE = '2004-01-01T00:00:00.000000Z'
+
+
+def svn_props(props):
+  """Serialize the PROPS dict in hash-dump format, as bytes."""
+  chunks = []
+  for key, value in props.items():
+    key = key.encode('utf-8')
+    value = value.encode('utf-8')
+    chunks.append(b'K %d\n%s\nV %d\n%s\n' % (len(key), key,
+                                             len(value), value))
+  chunks.append(b'PROPS-END\n')
+  return b''.join(chunks)
+
+
+def file_content(rng, size):
+  """Return SIZE bytes of reproducible line-structured text."""
+  lines = []
+  remaining = size
+  while remaining > 0:
+    line = ('%08x %08x %08x %08x %08x %08x %08x\n'
+            % tuple(rng.getrandbits(32) for _ in range(7)))
+    line = line[:remaining]
+    lines.append(line)
+    remaining -= len(line)
+  return ''.join(lines).encode('utf-8')
+
+
+class DumpWriter:
+  """Writes dump records for one repository to OUT."""
+
+  def __init__(self, out):
+    self.out = out
+    self.revision = 0
+    out.write(b'SVN-fs-dump-format-version: 2\n\n')
+
+  def start_revision(self, log):
+    self.revision += 1
+    props = svn_props({'svn:log': log,
+                       'svn:author': 'corpus',
+                       'svn:date': SVN_DATE})
+    self.out.write(b'Revision-number: %d\n' % self.revision)
+    self.out.write(b'Prop-content-length: %d\n' % len(props))
+    self.out.write(b'Content-length: %d\n\n' % len(props))
+    self.out.write(props)
+    self.out.write(b'\n')
+
+  def add_dir(self, path):
+    self.out.write(b'Node-path: %s\n' % path.encode('utf-8'))
+    self.out.write(b'Node-kind: dir\nNode-action: add\n\n\n')
+
+  def copy_dir(self, path, from_path, from_rev):
+    self.out.write(b'Node-path: %s\n' % path.encode('utf-8'))
+    self.out.write(b'Node-kind: dir\nNode-action: add\n')
+    self.out.write(b'Node-copyfrom-rev: %d\n' % from_rev)
+    self.out.write(b'Node-copyfrom-path: %s\n\n\n'
+                   % from_path.encode('utf-8'))
+
+  def put_file(self, path, content, action):
+    self.out.write(b'Node-path: %s\n' % path.encode('utf-8'))
+    self.out.write(b'Node-kind: file\n')
+    self.out.write(b'Node-action: %s\n' % action.encode('utf-8'))
+    self.out.write(b'Text-content-length: %d\n' % len(content))
+    self.out.write(b'Text-content-md5: %s\n'
+                   % hashlib.md5(content).hexdigest().encode('utf-8'))
+    self.out.write(b'Content-length: %d\n\n' % len(content))
+    self.out.write(content)
+    self.out.write(b'\n\n')
+
+
+def tree_paths(args):
+  """Return (dirs, files) path lists for the configured tree shape."""
+  dirs = ['trunk']
+  files = []
+
+  def populate(parent, depth):
+    for f in range(args.files_per_dir):
+      files.append('%s/file%03d.txt' % (parent, f))
+    if depth < args.depth:
+      for d in range(args.dirs_per_dir):
+        child = '%s/dir%03d' % (parent, d)
+        dirs.append(child)
+        populate(child, depth + 1)
+
+  populate('trunk', 1)
+  return dirs, files
+
+
+def pick_size(rng, args):
+  """Draw one file size from the configured log-normal distribution."""
+  size = int(rng.lognormvariate(math.log(args.file_size), args.size_sigma))
+  return max(1, min(size, args.max_file_size))
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description='Generate a deterministic repository dump stream.')
+  parser.add_argument('--depth', type=int, default=3,
+                      help='directory nesting levels [%(default)s]')
+  parser.add_argument('--dirs-per-dir', type=int, default=10,
+                      help='subdirectories per directory [%(default)s]')
+  parser.add_argument('--files-per-dir', type=int, default=100,
+                      help='files per directory [%(default)s]')
+  parser.add_argument('--revisions', type=int, default=1000,
+                      help='total number of revisions [%(default)s]')
+  parser.add_argument('--changes-per-rev', type=int, default=10,
+                      help='files modified per revision [%(default)s]')
+  parser.add_argument('--file-size', type=int, default=2048,
+                      help='median file size in bytes [%(default)s]')
+  parser.add_argument('--size-sigma', type=float, default=1.0,
+                      help='log-normal sigma of the size distribution '
+                           '[%(default)s]')
+  parser.add_argument('--max-file-size', type=int, default=4 * 1024 * 1024,
+                      help='upper bound on file sizes [%(default)s]')
+  parser.add_argument('--tag-every', type=int, default=100,
+                      help='copy trunk to a tag every N revisions, '
+                           '0 disables [%(default)s]')
+  parser.add_argument('--seed', type=int, default=42,
+                      help='random seed [%(default)s]')
+  parser.add_argument('--output', default=None,
+                      help='write the dump here instead of stdout')
+  args = parser.parse_args()
+
+  rng = random.Random(args.seed)
+  out = open(args.output, 'wb') if args.output else sys.stdout.buffer
+  dump = DumpWriter(out)
+  dirs, files = tree_paths(args)
+
+  # r1: the full tree.
+  dump.start_revision('Initial import of %d files.' % len(files))
+  dump.add_dir('tags')
+  for path in dirs:
+    dump.add_dir(path)
+  for path in files:
+    dump.put_file(path, file_content(rng, pick_size(rng, args)), 'add')
+
+  # r2..N: routine development plus the occasional tag.
+  tag = 0
+  for rev in range(2, args.revisions + 1):
+    if args.tag_every and rev % args.tag_every == 0:
+      tag += 1
+      dump.start_revision('Tag %d.' % tag)
+      dump.copy_dir('tags/tag-%04d' % tag, 'trunk', dump.revision - 1)
+      continue
+
+    dump.start_revision('Change %d.' % rev)
+    for path in rng.sample(files, min(args.changes_per_rev, len(files))):
+      dump.put_file(path, file_content(rng, pick_size(rng, args)), 'change')
+
+  out.flush()
+  sys.stderr.write('%d revisions, %d files, %d tags\n'
+                   % (dump.revision, len(files), tag))
+
+
+if __name__ == '__main__':
+  main()
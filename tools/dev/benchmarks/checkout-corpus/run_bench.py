@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+#
+# run_bench.py: end-to-end client performance suite over a synthetic corpus
+#
+# ====================================================================
+#    Licensed to the Apache Software Foundation (ASF) under one
+#    or more contributor license agreements.  See the NOTICE file
+#    distributed with this work for additional information
+#    regarding copyright ownership.  The ASF licenses this file
+#    to you under the Apache License, Version 2.0 (the
+#    "License"); you may not use this file except in compliance
+#    with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing,
+#    software distributed under the License is distributed on an
+#    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#    KIND, either express or implied.  See the License for the
+#    specific language governing permissions and limitations
+#    under the License.
+# ====================================================================
+#
+# Loads a repository generated by gen_corpus.py (cached between runs,
+# keyed by the generator parameters), serves it over svn:// and times
+# checkout, update, commit, log -v and blame with the binaries from a
+# build tree.  Results can be recorded as a baseline JSON file and
+# later runs compared against it; a run that is slower than baseline
+# by more than --tolerance fails, making the suite usable as a release
+# gate:
+#
+#   make perfcheck PERF_ARGS=--record     # once, on pinned hardware
+#   make perfcheck                        # per candidate build
+#
+# Baselines are only meaningful on the hardware that recorded them;
+# the host name is stored alongside the numbers and mismatches are
+# reported as a warning, not an error.
+
+import argparse
+import hashlib
+import json
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import time
+
+GEN_ARGS = ['--depth', '2', '--dirs-per-dir', '10',
+            '--files-per-dir', '50', '--revisions', '500']
+PORT = 54329
+
+
+def run(cmd, **kwargs):
+  subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL,
+                 stderr=subprocess.DEVNULL, **kwargs)
+
+
+def timed(cmd, repeats):
+  """Return the median wall time of CMD over REPEATS runs."""
+  times = []
+  for _ in range(repeats):
+    start = time.monotonic()
+    run(cmd)
+    times.append(time.monotonic() - start)
+  return sorted(times)[len(times) // 2]
+
+
+class Suite:
+  def __init__(self, args):
+    self.args = args
+    self.bin = lambda name: os.path.join(args.build_dir, name, name)
+    self.svn = self.bin('svn')
+    self.work = os.path.abspath(args.work_dir)
+    self.repo = os.path.join(self.work, 'repo')
+    self.wc = os.path.join(self.work, 'wc')
+    self.url = 'svn://127.0.0.1:%d/repo' % args.port
+
+  def ensure_corpus(self):
+    """(Re)create the repository unless a cached one matches."""
+    stamp = os.path.join(self.repo, 'corpus-stamp')
+    key = hashlib.md5(' '.join(GEN_ARGS).encode('utf-8')).hexdigest()
+    if os.path.exists(stamp) and open(stamp).read() == key:
+      # The commit measurement appends revisions; only reuse the cached
+      # repository while it is still in its pristine state.
+      youngest = subprocess.run([self.bin('svnlook'), 'youngest', self.repo],
+                                capture_output=True, text=True).stdout.strip()
+      if youngest == GEN_ARGS[GEN_ARGS.index('--revisions') + 1]:
+        return
+    shutil.rmtree(self.repo, ignore_errors=True)
+    os.makedirs(self.work, exist_ok=True)
+    run([self.bin('svnadmin'), 'create', self.repo])
+    gen = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                       'gen_corpus.py')
+    generator = subprocess.Popen([sys.executable, gen] + GEN_ARGS,
+                                 stdout=subprocess.PIPE,
+                                 stderr=subprocess.DEVNULL)
+    run([self.bin('svnadmin'), 'load', '--quiet', self.repo],
+        stdin=generator.stdout)
+    if generator.wait() != 0:
+      raise subprocess.CalledProcessError(generator.returncode, gen)
+    with open(os.path.join(self.repo, 'conf', 'svnserve.conf'), 'w') as f:
+      f.write('[general]\nanon-access = write\n')
+    with open(stamp, 'w') as f:
+      f.write(key)
+
+  def start_server(self):
+    self.server = subprocess.Popen(
+        [self.bin('svnserve'), '-d', '--foreground', '-r', self.work,
+         '--listen-host', '127.0.0.1', '--listen-port', str(self.args.port)])
+    for _ in range(100):
+      try:
+        socket.create_connection(('127.0.0.1', self.args.port), 1).close()
+        return
+      except OSError:
+        time.sleep(0.1)
+    raise RuntimeError('svnserve did not come up')
+
+  def stop_server(self):
+    self.server.terminate()
+    self.server.wait()
+
+  def measure(self):
+    repeats = self.args.runs
+    results = {}
+
+    # Fresh checkout of HEAD, the big streaming read.
+    shutil.rmtree(self.wc, ignore_errors=True)
+    results['checkout'] = timed(
+        [self.svn, 'checkout', '-q', self.url, self.wc], 1)
+
+    # Update across half the history and back: delta application.
+    half = int(GEN_ARGS[GEN_ARGS.index('--revisions') + 1]) // 2
+    run([self.svn, 'update', '-q', '-r%d' % half, self.wc])
+    results['update'] = timed([self.svn, 'update', '-q', self.wc], 1)
+
+    # Commit a small change: the interactive write path.
+    victim = None
+    for dirpath, _, names in os.walk(os.path.join(self.wc, 'trunk')):
+      for name in names:
+        if name.endswith('.txt'):
+          victim = os.path.join(dirpath, name)
+          break
+      if victim:
+        break
+    with open(victim, 'a') as f:
+      f.write('benchmark change\n')
+    results['commit'] = timed(
+        [self.svn, 'commit', '-q', '-m', 'benchmark change', self.wc], 1)
+
+    # History scans.
+    results['log'] = timed([self.svn, 'log', '-v', '-q', self.url], repeats)
+    results['blame'] = timed(
+        [self.svn, 'blame', self.url + '/'
+         + os.path.relpath(victim, self.wc).replace(os.sep, '/')], repeats)
+
+    return results
+
+  def run_suite(self):
+    self.ensure_corpus()
+    self.start_server()
+    try:
+      return self.measure()
+    finally:
+      self.stop_server()
+
+
+def compare(results, baseline_file, tolerance):
+  with open(baseline_file) as f:
+    baseline = json.load(f)
+  if baseline.get('host') != socket.gethostname():
+    sys.stderr.write('WARNING: baseline was recorded on %r, this is %r;'
+                     ' numbers are not comparable\n'
+                     % (baseline.get('host'), socket.gethostname()))
+  failed = False
+  for name, seconds in results.items():
+    base = baseline['results'].get(name)
+    if base is None:
+      print('%-10s %7.3fs  (no baseline)' % (name, seconds))
+      continue
+    delta = (seconds - base) / base * 100
+    marker = ''
+    if delta > tolerance * 100:
+      marker = '  REGRESSION'
+      failed = True
+    print('%-10s %7.3fs  baseline %7.3fs  %+6.1f%%%s'
+          % (name, seconds, base, delta, marker))
+  return failed
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description='End-to-end client performance suite.')
+  parser.add_argument('--build-dir', default='subversion',
+                      help='build tree containing svn/svn, '
+                           'svnadmin/svnadmin and svnserve/svnserve '
+                           '[%(default)s]')
+  parser.add_argument('--work-dir', default='perf-corpus-work',
+                      help='scratch directory for repository and working '
+                           'copies [%(default)s]')
+  parser.add_argument('--baseline', default='perf-baseline.json',
+                      help='baseline file to record or compare against '
+                           '[%(default)s]')
+  parser.add_argument('--record', action='store_true',
+                      help='write the baseline instead of comparing')
+  parser.add_argument('--tolerance', type=float, default=0.10,
+                      help='fractional slowdown treated as a regression '
+                           '[%(default)s]')
+  parser.add_argument('--runs', type=int, default=3,
+                      help='repetitions for the cheap operations '
+                           '[%(default)s]')
+  parser.add_argument('--port', type=int, default=PORT,
+                      help='svnserve port [%(default)s]')
+  args = parser.parse_args()
+
+  results = Suite(args).run_suite()
+
+  if args.record:
+    with open(args.baseline, 'w') as f:
+      json.dump({'host': socket.gethostname(), 'results': results},
+                f, indent=2)
+    print('Baseline recorded in %s:' % args.baseline)
+    for name, seconds in results.items():
+      print('%-10s %7.3fs' % (name, seconds))
+    return 0
+
+  if not os.path.exists(args.baseline):
+    sys.stderr.write('No baseline %r; run with --record first.\n'
+                     % args.baseline)
+    for name, seconds in results.items():
+      print('%-10s %7.3fs' % (name, seconds))
+    return 1
+
+  return 1 if compare(results, args.baseline, args.tolerance) else 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())